@@ -1,2 +1,2 @@
-../../iree-build/tools/iree-run-pim --device=PIM --function=gpt2block --module=./compiler-artifact/gpt_125M_end_pim.vmfb --meta_data=./compiler-artifact/meta_data.json
+../../iree-build/tools/iree-run-pim --device=PIM --function=gpt2block --module=./compiler-artifact/gpt_125M_end_pim.vmfb
 
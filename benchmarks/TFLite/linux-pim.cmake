@@ -0,0 +1,85 @@
+# Copyright 2023 The IREE Authors
+#
+# Licensed under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+################################################################################
+#                                                                              #
+# Default benchmark configurations                                             #
+#                                                                              #
+# Each suite benchmarks a list of modules with configurations specifying a     #
+# target architecture and runtime characteristics (e.g. threads/cores). These  #
+# benchmarks only configure IREE compilation and runtime flags for the target  #
+# architecture and do *not* include any non-default flags. No non-default      #
+# flags should be added here.                                                  #
+#                                                                              #
+################################################################################
+
+set(LINUX_PIM_COMPILATION_FLAGS
+  "--iree-input-type=tosa"
+)
+
+# PIM, 1/2/4 PIM modules, full-inference. Every module count runs on the PIM
+# SDK and on the latency model of the `pim-sim` driver so that compiler changes
+# can be compared without PIM hardware.
+foreach(_DEVICE_COUNT IN ITEMS 1 2 4)
+  foreach(_MODULE_VAR IN ITEMS
+      GPT2_125M_FP32_MODULE GPT2_350M_FP32_MODULE GPT2_774M_FP32_MODULE)
+    if(NOT DEFINED ${_MODULE_VAR})
+      continue()
+    endif()
+
+    iree_benchmark_suite(
+      GROUP_NAME
+        "linux-pim"
+
+      MODULES
+        "${${_MODULE_VAR}}"
+
+      BENCHMARK_MODES
+        "${_DEVICE_COUNT}-device,full-inference,default-flags"
+      TARGET_BACKEND
+        "pim"
+      TARGET_ARCHITECTURE
+        "PIM"
+      COMPILATION_FLAGS
+        ${LINUX_PIM_COMPILATION_FLAGS}
+        "--iree-pim-device-count=${_DEVICE_COUNT}"
+      BENCHMARK_TOOL
+        iree-benchmark-module
+      CONFIG
+        "iree-pim"
+      DRIVER
+        "PIM"
+      RUNTIME_FLAGS
+        "--pim_queue_count=${_DEVICE_COUNT}"
+    )
+
+    iree_benchmark_suite(
+      GROUP_NAME
+        "linux-pim"
+
+      MODULES
+        "${${_MODULE_VAR}}"
+
+      BENCHMARK_MODES
+        "${_DEVICE_COUNT}-device,full-inference,default-flags"
+      TARGET_BACKEND
+        "pim"
+      TARGET_ARCHITECTURE
+        "PIM"
+      COMPILATION_FLAGS
+        ${LINUX_PIM_COMPILATION_FLAGS}
+        "--iree-pim-device-count=${_DEVICE_COUNT}"
+      BENCHMARK_TOOL
+        iree-benchmark-module
+      CONFIG
+        "iree-pim-sim"
+      DRIVER
+        "pim-sim"
+      RUNTIME_FLAGS
+        "--pim_queue_count=${_DEVICE_COUNT}"
+    )
+  endforeach()
+endforeach()
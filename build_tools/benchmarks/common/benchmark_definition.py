@@ -76,6 +76,10 @@ IREE_DRIVERS_INFOS = {
         DriverInfo("IREE-Vulkan", "GPU", "vulkan", ""),
     "iree-cuda":
         DriverInfo("IREE-CUDA", "GPU", "cuda", ""),
+    "iree-pim":
+        DriverInfo("IREE-PIM", "PIM", "PIM", ""),
+    "iree-pim-sim":
+        DriverInfo("IREE-PIM-Sim", "PIM", "pim-sim", ""),
 }
 
 IREE_PRETTY_NAME_TO_DRIVER_NAME = {
@@ -317,6 +321,9 @@ class BenchmarkInfo:
       target_arch = "GPU-" + self.device_info.gpu_name
     elif self.driver_info.device_type == 'CPU':
       target_arch = "CPU-" + self.device_info.get_detailed_cpu_arch_name()
+    elif self.driver_info.device_type == 'PIM':
+      # PIM modules aren't described by the host device info.
+      target_arch = "PIM"
     else:
       raise ValueError(
           f"Unrecognized device type '{self.driver_info.device_type}' of the driver '{self.driver_info.pretty_name}'"
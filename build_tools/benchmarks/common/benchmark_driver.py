@@ -241,8 +241,8 @@ class BenchmarkDriver(object):
         available_drivers.append("local-sync")
       elif name == "IREE_HAL_DRIVER_LOCAL_TASK":
         available_drivers.append("local-task")
-      elif name == "IREE_HAL_DRIVER_VULKAN":
-        available_drivers.append("vulkan")
+      elif name == "IREE_HAL_DRIVER_PIM":
+        available_drivers.append("PIM")
       elif name == "IREE_HAL_EXECUTABLE_LOADER_EMBEDDED_ELF":
         available_loaders.append("embedded-elf")
       elif name == "IREE_HAL_EXECUTABLE_LOADER_SYSTEM_LIBRARY":
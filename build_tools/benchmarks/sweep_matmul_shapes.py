@@ -0,0 +1,347 @@
+#!/usr/bin/env python3
+# Copyright 2023 The IREE Authors
+#
+# Licensed under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+"""Benchmarks matmuls over a sweep of shapes and types on several backends.
+
+This is the performance companion of the e2e matmul tests checked by
+`iree-e2e-matmul-test`: it generates one module with a static
+`linalg.matmul` function per shape and type, compiles it once per backend
+configuration and measures every function with `iree-benchmark-module`. The
+results are reported as GFLOP/s and GB/s so that backends can be compared per
+shape class.
+
+Shapes are given as MxKxN (the LHS is MxK, the RHS is KxN) through `--shapes`
+or taken from the matrix-vector products of a PIM SDK `meta_data.json` with
+`--meta_data`, such as the GPT-2 `1x768x2304`, `1x768x3072` and `1x3072x768`
+layers.
+
+Example usage:
+  sweep_matmul_shapes.py --tools_dir=build/tools \\
+      --meta_data=PIM-sdk/compiler-artifact/meta_data.json \\
+      --shapes 256x256x256 --types f32 i8 \\
+      --configs llvm-cpu llvm-cpu-ukernels pim --output=/tmp/sweep.json
+"""
+
+import argparse
+import dataclasses
+import json
+import pathlib
+import subprocess
+import sys
+import tempfile
+from typing import Any, Dict, List, Optional, Sequence
+
+from tune_dispatch_benchmarks import parse_benchmark_results
+
+# Accumulator type of each LHS/RHS type, as in generate_e2e_matmul_tests.py.
+ACC_TYPES = {"f32": "f32", "f16": "f16", "i8": "i32"}
+
+TYPE_BYTES = {"f32": 4, "f16": 2, "i8": 1, "i32": 4}
+
+
+@dataclasses.dataclass(frozen=True)
+class MatmulShape:
+  """A matmul of a {m}x{k} LHS and a {k}x{n} RHS."""
+  m: int
+  k: int
+  n: int
+
+  def __str__(self) -> str:
+    return f"{self.m}x{self.k}x{self.n}"
+
+
+@dataclasses.dataclass(frozen=True)
+class BackendConfig:
+  """Compiler flags and the device to run the compiled module on."""
+  compile_flags: List[str]
+  device: str
+
+
+BACKEND_CONFIGS = {
+    "llvm-cpu":
+        BackendConfig(compile_flags=[
+            "--iree-hal-target-backends=llvm-cpu",
+            "--iree-llvm-target-cpu=host",
+        ],
+                      device="local-task"),
+    "llvm-cpu-ukernels":
+        BackendConfig(compile_flags=[
+            "--iree-hal-target-backends=llvm-cpu",
+            "--iree-llvm-target-cpu=host",
+            "--iree-flow-enable-data-tiling",
+            "--iree-llvm-enable-microkernels",
+        ],
+                      device="local-task"),
+    "cuda":
+        BackendConfig(compile_flags=["--iree-hal-target-backends=cuda"],
+                      device="cuda"),
+    "pim":
+        BackendConfig(compile_flags=["--iree-hal-target-backends=pim"],
+                      device="PIM"),
+}
+
+
+@dataclasses.dataclass(frozen=True)
+class MatmulCase:
+  """A benchmarked function of the generated module."""
+  shape: MatmulShape
+  lhs_rhs_type: str
+
+  @property
+  def acc_type(self) -> str:
+    return ACC_TYPES[self.lhs_rhs_type]
+
+  @property
+  def function(self) -> str:
+    return f"matmul_{self.shape}_{self.lhs_rhs_type}_{self.acc_type}"
+
+  @property
+  def flops(self) -> int:
+    return 2 * self.shape.m * self.shape.k * self.shape.n
+
+  @property
+  def bytes(self) -> int:
+    """Bytes of the operands read and the result written once."""
+    shape = self.shape
+    return ((shape.m * shape.k + shape.k * shape.n) *
+            TYPE_BYTES[self.lhs_rhs_type] +
+            2 * shape.m * shape.n * TYPE_BYTES[self.acc_type])
+
+  def tensor_types(self) -> List[str]:
+    shape = self.shape
+    return [
+        f"{shape.m}x{shape.k}x{self.lhs_rhs_type}",
+        f"{shape.k}x{shape.n}x{self.lhs_rhs_type}",
+        f"{shape.m}x{shape.n}x{self.acc_type}",
+    ]
+
+  def benchmark_inputs(self) -> List[str]:
+    """Splat inputs for `iree-benchmark-module --input=`."""
+    return [f"{tensor_type}=1" for tensor_type in self.tensor_types()]
+
+
+def parse_shape(text: str) -> MatmulShape:
+  dims = text.split("x")
+  if len(dims) != 3 or not all(dim.isdigit() and int(dim) > 0 for dim in dims):
+    raise argparse.ArgumentTypeError(
+        f"Invalid shape '{text}'; expected MxKxN (such as 1x768x2304)")
+  return MatmulShape(*(int(dim) for dim in dims))
+
+
+def shapes_from_meta_data(meta_data: Dict[str, Any]) -> List[MatmulShape]:
+  """Returns the matrix-vector products of the layers in a PIM SDK
+  meta_data.json: each KxN weight with a 1xK activation is a 1xKxN matmul.
+  Batched operands (such as the attention heads) are not matmuls and ignored.
+  """
+  matrices = [
+      tuple(entry["shape"])
+      for entry in meta_data.values()
+      if isinstance(entry, dict) and entry.get("rank") == 2
+  ]
+  vectors = {cols for rows, cols in matrices if rows == 1}
+  shapes = {
+      MatmulShape(m=1, k=rows, n=cols)
+      for rows, cols in matrices
+      if rows != 1 and rows in vectors
+  }
+  return sorted(shapes, key=lambda shape: (shape.k, shape.n))
+
+
+def generate_module(cases: Sequence[MatmulCase]) -> str:
+  """Returns a module with one static matmul function per case."""
+  functions = []
+  for case in cases:
+    lhs, rhs, acc = (f"tensor<{tensor_type}>"
+                     for tensor_type in case.tensor_types())
+    functions.append(
+        f"func.func @{case.function}(%lhs: {lhs}, %rhs: {rhs}, "
+        f"%acc: {acc}) -> {acc} {{\n"
+        f"  %result = linalg.matmul ins(%lhs, %rhs: {lhs}, {rhs}) "
+        f"outs(%acc: {acc}) -> {acc}\n"
+        f"  return %result: {acc}\n"
+        f"}}\n")
+  return "\n".join(functions)
+
+
+def make_result(config: str, case: MatmulCase,
+                time_ms: Optional[float]) -> Dict[str, Any]:
+  result = {
+      "config": config,
+      "shape": str(case.shape),
+      "type": case.lhs_rhs_type,
+  }
+  if time_ms is None:
+    return result
+  seconds = time_ms * 1e-3
+  result.update({
+      "time_ms": time_ms,
+      "gflops": case.flops / seconds * 1e-9,
+      "gbps": case.bytes / seconds * 1e-9,
+  })
+  return result
+
+
+def format_table(results: Sequence[Dict[str, Any]]) -> str:
+  """Formats |results| with one row per case and config, grouped by case."""
+  lines = [
+      f"{'shape':>16} {'type':>4} {'config':>18} {'time (ms)':>10} "
+      f"{'GFLOP/s':>9} {'GB/s':>8}"
+  ]
+  for result in sorted(results,
+                       key=lambda result:
+                       (result["shape"], result["type"], result["config"])):
+    prefix = f"{result['shape']:>16} {result['type']:>4} {result['config']:>18}"
+    if "time_ms" not in result:
+      lines.append(f"{prefix} {'failed':>10}")
+      continue
+    lines.append(f"{prefix} {result['time_ms']:>10.4f} "
+                 f"{result['gflops']:>9.2f} {result['gbps']:>8.2f}")
+  return "\n".join(lines)
+
+
+class Sweeper(object):
+  """Compiles the sweep module per backend config and measures its cases."""
+
+  def __init__(self, args: argparse.Namespace, work_dir: pathlib.Path):
+    self._args = args
+    self._work_dir = work_dir
+    self._tools_dir = pathlib.Path(args.tools_dir)
+
+  def _run(self, command: List[str]) -> str:
+    if self._args.verbose:
+      print(" ".join(command), file=sys.stderr)
+    return subprocess.run(command,
+                          check=True,
+                          capture_output=True,
+                          text=True).stdout
+
+  def sweep(self, config: str, backend: BackendConfig,
+            module_path: pathlib.Path,
+            cases: Sequence[MatmulCase]) -> List[Dict[str, Any]]:
+    vmfb_path = self._work_dir / f"{config}.vmfb"
+    try:
+      self._run([
+          str(self._tools_dir / "iree-compile"),
+          str(module_path), f"-o={vmfb_path}"
+      ] + backend.compile_flags + self._args.compile_flags)
+    except subprocess.CalledProcessError as e:
+      print(f"{config}: compilation failed, skipped", file=sys.stderr)
+      if self._args.verbose:
+        print(e.stderr, file=sys.stderr)
+      return [make_result(config, case, None) for case in cases]
+
+    results = []
+    for case in cases:
+      command = [
+          str(self._tools_dir / "iree-benchmark-module"),
+          f"--module={vmfb_path}", f"--device={backend.device}",
+          f"--function={case.function}", "--benchmark_format=json",
+          f"--benchmark_repetitions={self._args.repetitions}"
+      ] + [f"--input={value}" for value in case.benchmark_inputs()]
+      try:
+        measurement = parse_benchmark_results(self._run(command),
+                                              case.function)
+        time_ms = measurement.median_ms
+      except (subprocess.CalledProcessError, ValueError) as e:
+        # Keep going; backends need not support every shape or type.
+        if self._args.verbose:
+          print(getattr(e, "stderr", e), file=sys.stderr)
+        time_ms = None
+      results.append(make_result(config, case, time_ms))
+    return results
+
+
+def parse_device(text: str) -> List[str]:
+  config, sep, device = text.partition("=")
+  if not sep or config not in BACKEND_CONFIGS or not device:
+    raise argparse.ArgumentTypeError(
+        f"Invalid device override '{text}'; expected CONFIG=DEVICE with a "
+        f"config in {sorted(BACKEND_CONFIGS)}")
+  return [config, device]
+
+
+def parse_arguments():
+  parser = argparse.ArgumentParser(
+      description="Benchmarks matmuls over a sweep of shapes and types on "
+      "several backends and reports GFLOP/s and GB/s.")
+  parser.add_argument("--tools_dir",
+                      required=True,
+                      help="Directory with iree-compile and "
+                      "iree-benchmark-module.")
+  parser.add_argument("--shapes",
+                      type=parse_shape,
+                      nargs="*",
+                      default=[],
+                      help="Shapes to benchmark as MxKxN.")
+  parser.add_argument("--meta_data",
+                      type=pathlib.Path,
+                      help="PIM SDK meta_data.json to take the matrix-vector "
+                      "shapes of the model layers from.")
+  parser.add_argument("--types",
+                      nargs="+",
+                      choices=sorted(ACC_TYPES),
+                      default=["f32"],
+                      help="LHS/RHS types to benchmark.")
+  parser.add_argument("--configs",
+                      nargs="+",
+                      choices=list(BACKEND_CONFIGS),
+                      default=["llvm-cpu", "llvm-cpu-ukernels"],
+                      help="Backend configurations to compile for.")
+  parser.add_argument("--device",
+                      type=parse_device,
+                      action="append",
+                      default=[],
+                      help="Overrides the device of a config as "
+                      "CONFIG=DEVICE (such as pim=pim-sim).")
+  parser.add_argument("--repetitions",
+                      type=int,
+                      default=10,
+                      help="Benchmark repetitions per function.")
+  parser.add_argument("--output",
+                      type=pathlib.Path,
+                      help="JSON file to write the results to.")
+  parser.add_argument("--verbose",
+                      action="store_true",
+                      help="Prints the commands run and their errors.")
+  parser.add_argument("compile_flags",
+                      nargs="*",
+                      help="Extra iree-compile flags for every config.")
+  args = parser.parse_args()
+  if args.meta_data:
+    args.shapes += shapes_from_meta_data(json.loads(args.meta_data.read_text()))
+  if not args.shapes:
+    parser.error("no shapes given with --shapes or --meta_data")
+  return args
+
+
+def main(args: argparse.Namespace):
+  shapes = list(dict.fromkeys(args.shapes))
+  cases = [
+      MatmulCase(shape=shape, lhs_rhs_type=lhs_rhs_type)
+      for shape in shapes
+      for lhs_rhs_type in args.types
+  ]
+  devices = dict(args.device)
+
+  results = []
+  with tempfile.TemporaryDirectory() as work_dir:
+    work_dir = pathlib.Path(work_dir)
+    module_path = work_dir / "matmul_sweep.mlir"
+    module_path.write_text(generate_module(cases))
+    sweeper = Sweeper(args, work_dir)
+    for config in args.configs:
+      backend = BACKEND_CONFIGS[config]
+      if config in devices:
+        backend = dataclasses.replace(backend, device=devices[config])
+      results += sweeper.sweep(config, backend, module_path, cases)
+
+  print(format_table(results))
+  if args.output:
+    args.output.write_text(json.dumps({"results": results}, indent=2))
+
+
+if __name__ == "__main__":
+  main(parse_arguments())
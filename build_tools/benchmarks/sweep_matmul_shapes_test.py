@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+# Copyright 2023 The IREE Authors
+#
+# Licensed under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+import argparse
+import unittest
+
+from sweep_matmul_shapes import MatmulCase, MatmulShape
+import sweep_matmul_shapes
+
+META_DATA = {
+    "1": {
+        "rank": 2,
+        "shape": [1, 768]
+    },
+    "2": {
+        "rank": 2,
+        "shape": [768, 2304]
+    },
+    "3": {
+        "rank": 2,
+        "shape": [1, 2304]
+    },
+    "4": {
+        "rank": 3,
+        "shape": [12, 64, 1024]
+    },
+    "8": {
+        "rank": 2,
+        "shape": [768, 3072]
+    },
+    "9": {
+        "rank": 2,
+        "shape": [1, 3072]
+    },
+    "10": {
+        "rank": 2,
+        "shape": [3072, 768]
+    },
+    "11": {
+        "rank": 2,
+        "shape": [1, 768]
+    },
+    "n_layer": 12,
+}
+
+
+class SweepMatmulShapesTest(unittest.TestCase):
+
+  def test_parse_shape(self):
+    self.assertEqual(sweep_matmul_shapes.parse_shape("1x768x2304"),
+                     MatmulShape(m=1, k=768, n=2304))
+    for text in ["1x768", "1x0x4", "axbxc"]:
+      with self.assertRaises(argparse.ArgumentTypeError):
+        sweep_matmul_shapes.parse_shape(text)
+
+  def test_shapes_from_meta_data(self):
+    shapes = sweep_matmul_shapes.shapes_from_meta_data(META_DATA)
+
+    self.assertEqual(shapes, [
+        MatmulShape(m=1, k=768, n=2304),
+        MatmulShape(m=1, k=768, n=3072),
+        MatmulShape(m=1, k=3072, n=768),
+    ])
+
+  def test_generate_module(self):
+    case = MatmulCase(shape=MatmulShape(m=1, k=768, n=2304), lhs_rhs_type="i8")
+
+    self.assertEqual(case.function, "matmul_1x768x2304_i8_i32")
+    self.assertEqual(case.benchmark_inputs(),
+                     ["1x768xi8=1", "768x2304xi8=1", "1x2304xi32=1"])
+    self.assertEqual(
+        sweep_matmul_shapes.generate_module([case]),
+        "func.func @matmul_1x768x2304_i8_i32(%lhs: tensor<1x768xi8>, "
+        "%rhs: tensor<768x2304xi8>, %acc: tensor<1x2304xi32>) -> "
+        "tensor<1x2304xi32> {\n"
+        "  %result = linalg.matmul ins(%lhs, %rhs: tensor<1x768xi8>, "
+        "tensor<768x2304xi8>) outs(%acc: tensor<1x2304xi32>) -> "
+        "tensor<1x2304xi32>\n"
+        "  return %result: tensor<1x2304xi32>\n"
+        "}\n")
+
+  def test_make_result(self):
+    case = MatmulCase(shape=MatmulShape(m=1, k=1000, n=500),
+                      lhs_rhs_type="f32")
+
+    result = sweep_matmul_shapes.make_result("llvm-cpu", case, time_ms=0.5)
+
+    # 2*1*1000*500 flops; (1000 + 500000) * 4 + 2 * 500 * 4 bytes.
+    self.assertEqual(result["config"], "llvm-cpu")
+    self.assertEqual(result["shape"], "1x1000x500")
+    self.assertAlmostEqual(result["gflops"], 2.0)
+    self.assertAlmostEqual(result["gbps"], 4.016)
+
+  def test_make_result_failed(self):
+    case = MatmulCase(shape=MatmulShape(m=2, k=2, n=2), lhs_rhs_type="f16")
+
+    result = sweep_matmul_shapes.make_result("pim", case, time_ms=None)
+
+    self.assertEqual(result, {"config": "pim", "shape": "2x2x2", "type": "f16"})
+    self.assertIn("failed", sweep_matmul_shapes.format_table([result]))
+
+
+if __name__ == "__main__":
+  unittest.main()
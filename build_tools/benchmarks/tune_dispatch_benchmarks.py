@@ -0,0 +1,460 @@
+#!/usr/bin/env python3
+# Copyright 2023 The IREE Authors
+#
+# Licensed under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+"""Autotunes the lowering configuration of dumped dispatch benchmarks.
+
+Each module produced by `iree-compile --iree-hal-dump-executable-benchmarks-to=`
+holds one executable variant and a benchmark function per dispatch site. For
+every benchmark function this tool:
+
+1. Queries the default lowering configuration chosen by the compiler heuristics.
+2. Generates candidates by scaling the distribution and vector tile sizes (and
+   toggling microkernels on backends that support them).
+3. Compiles each candidate through a single entry tuning database passed with
+   `--iree-codegen-tuning-database=` and measures it with
+   `iree-benchmark-module --benchmark_repetitions=`.
+4. Keeps the candidate with the lowest median time if it beats the default
+   configuration by more than `--min_speedup` and the noise of both
+   measurements.
+
+The winners are merged into the tuning database given by `--output` which can
+be passed to `iree-compile --iree-codegen-tuning-database=` when compiling the
+full model.
+
+Example usage:
+  iree-compile model.mlir --iree-hal-target-backends=llvm-cpu \
+      --iree-hal-dump-executable-benchmarks-to=/tmp/benchmarks -o /dev/null
+  tune_dispatch_benchmarks.py --benchmark_dir=/tmp/benchmarks \
+      --tools_dir=build/tools --output=/tmp/tuning_db.json -- \
+      --iree-hal-target-backends=llvm-cpu
+"""
+
+import argparse
+import dataclasses
+import itertools
+import json
+import pathlib
+import re
+import statistics
+import subprocess
+import sys
+import tempfile
+from typing import Any, Dict, List, Optional, Sequence, Tuple
+
+DATABASE_VERSION = 1
+
+# Backends that can switch microkernels on and off per dispatch.
+UKERNEL_BACKENDS = ["vmvx"]
+
+# Passes used to query the default configuration of a variant.
+CONFIGURATION_PASSES = {
+    "llvm-cpu": "iree-llvmcpu-lower-executable-target",
+    "vmvx": "iree-llvmcpu-lower-executable-target",
+    "pim": "iree-pim-lower-executable-target",
+}
+
+TIME_UNIT_TO_MS = {"ns": 1e-6, "us": 1e-3, "ms": 1.0, "s": 1e3}
+
+
+@dataclasses.dataclass(frozen=True)
+class DispatchBenchmark:
+  """A benchmark function in a dumped benchmark module."""
+  function: str
+  export: str
+  target: str
+
+
+@dataclasses.dataclass(frozen=True)
+class LoweringConfig:
+  """The parts of a compilation_info attribute the tuner varies."""
+  tile_sizes: Tuple[Tuple[int, ...], ...]
+  translation_info: str
+  workgroup_size: Tuple[int, ...] = ()
+  ukernels: Optional[bool] = None
+
+  def to_compilation_info(self) -> str:
+    tile_sizes = ", ".join(
+        "[" + ", ".join(str(size) for size in level) + "]"
+        for level in self.tile_sizes)
+    workgroup_size = ", ".join(str(size) for size in self.workgroup_size)
+    return (f"#iree_codegen.compilation_info<"
+            f"lowering_config = <tile_sizes = [{tile_sizes}]>, "
+            f"translation_info = <{self.translation_info}>, "
+            f"workgroup_size = [{workgroup_size}]>")
+
+
+@dataclasses.dataclass(frozen=True)
+class Measurement:
+  """Statistics of repeated benchmark runs in milliseconds."""
+  median_ms: float
+  stddev_ms: float
+
+
+def parse_benchmark_module(text: str) -> List[DispatchBenchmark]:
+  """Returns the dispatch benchmark functions of a dumped benchmark module."""
+  executable = re.search(r"hal\.executable (?:private |public )?@([\w$.-]+)",
+                         text)
+  variant = re.search(
+      r"hal\.executable\.variant (?:public )?@([\w$.-]+), target = ([^\s{]+)",
+      text)
+  if not executable or not variant:
+    return []
+  target_text = variant.group(2)
+  if target_text.startswith("#"):
+    alias = re.search(rf"^{re.escape(target_text)} = (.*)$", text, re.MULTILINE)
+    target_text = alias.group(1) if alias else ""
+  target = re.search(r"<\"([\w-]+)\"", target_text)
+  if not target:
+    return []
+
+  prefix = f"{executable.group(1)}_{variant.group(1)}_"
+  exports = re.findall(r"hal\.executable\.export (?:public )?@([\w$.-]+)",
+                       text)
+  benchmarks = []
+  for function in re.findall(r"func\.func @([\w$.-]+)\(%\w+: i32\)", text):
+    if not function.startswith(prefix):
+      continue
+    suffix = function[len(prefix):]
+    # Prefer the longest export name in case one is a prefix of another.
+    matches = [
+        export for export in exports
+        if suffix == export or suffix.startswith(export + "_")
+    ]
+    if matches:
+      benchmarks.append(
+          DispatchBenchmark(function=function,
+                            export=max(matches, key=len),
+                            target=target.group(1)))
+  return benchmarks
+
+
+def parse_default_config(text: str, export: str) -> Optional[LoweringConfig]:
+  """Parses the configuration the compiler chose for the root op of |export|.
+
+  |text| is the IR printed by the configuration pass of the backend with
+  `test-lowering-configuration=true`. The root op is taken to be the op with
+  the most tiling levels, which is the one the compiler configured first; the
+  other ops get their configuration propagated from it.
+  """
+  export_op = re.search(
+      rf"hal\.executable\.export (?:public )?@{re.escape(export)}\b[^\n]*",
+      text)
+  if not export_op:
+    return None
+  translation_info = _resolve_attr(text, export_op.group(0),
+                                   r"translation_info = ([^\s,}]+)",
+                                   "#iree_codegen.translation_info")
+  if not translation_info:
+    return None
+  workgroup_size = re.search(r"workgroup_size = \[([^\]]*)\]",
+                             export_op.group(0))
+  workgroup_size = tuple(
+      int(size.split(":")[0])
+      for size in workgroup_size.group(1).split(",")) if workgroup_size else ()
+
+  tile_sizes = None
+  for match in re.finditer(r"tile_sizes = (\[\[[\d\s,\[\]]*\]\])", text):
+    levels = tuple(tuple(level) for level in json.loads(match.group(1)))
+    if tile_sizes is None or len(levels) > len(tile_sizes):
+      tile_sizes = levels
+  if tile_sizes is None:
+    return None
+  return LoweringConfig(tile_sizes=tile_sizes,
+                        translation_info=translation_info,
+                        workgroup_size=workgroup_size)
+
+
+def _resolve_attr(text: str, op_text: str, pattern: str,
+                  prefix: str) -> Optional[str]:
+  """Returns the body of the |prefix|<...> attribute |pattern| refers to."""
+  match = re.search(pattern, op_text)
+  if not match:
+    return None
+  value = match.group(1)
+  if value.startswith("#") and not value.startswith(prefix):
+    alias = re.search(rf"^{re.escape(value)} = (.*)$", text, re.MULTILINE)
+    if not alias:
+      return None
+    value = alias.group(1)
+  if value.startswith(prefix + "<"):
+    value = value[len(prefix) + 1:]
+    return value[:value.rindex(">")] if ">" in value else None
+  return value.strip("<>")
+
+
+def generate_candidates(default_config: LoweringConfig,
+                        target: str,
+                        tile_factors: Sequence[float],
+                        vector_factors: Sequence[float],
+                        max_candidates: int) -> List[LoweringConfig]:
+  """Generates configurations to try in place of |default_config|.
+
+  The distribution tile sizes (level 0) are scaled by |tile_factors| and the
+  vector tile sizes (the last level) by |vector_factors|. Candidates where a
+  vector tile is larger than the enclosing distribution tile are dropped.
+  """
+
+  def scale(level: Tuple[int, ...], factor: float) -> Tuple[int, ...]:
+    return tuple(max(1, int(size * factor)) if size else 0 for size in level)
+
+  candidates = []
+  seen = {default_config.tile_sizes}
+  tile_sizes = default_config.tile_sizes
+  for tile_factor, vector_factor in itertools.product(tile_factors,
+                                                       vector_factors):
+    levels = list(tile_sizes)
+    levels[0] = scale(tile_sizes[0], tile_factor)
+    if len(levels) > 1:
+      levels[-1] = scale(tile_sizes[-1], vector_factor)
+      outer, inner = levels[0], levels[-1]
+      if any(o and i > o for o, i in zip(outer, inner)):
+        continue
+    levels = tuple(levels)
+    if levels in seen:
+      continue
+    seen.add(levels)
+    candidates.append(dataclasses.replace(default_config, tile_sizes=levels))
+
+  if target in UKERNEL_BACKENDS:
+    candidates = [
+        dataclasses.replace(config, ukernels=ukernels)
+        for config in [default_config] + candidates
+        for ukernels in (False, True)
+    ]
+  return candidates[:max_candidates]
+
+
+def parse_benchmark_results(text: str, function: str) -> Measurement:
+  """Parses the median and standard deviation of |function| from the output of
+  `iree-benchmark-module --benchmark_format=json --benchmark_repetitions=N`."""
+  results = json.loads(text)
+  times = []
+  aggregates = {}
+  for benchmark in results.get("benchmarks", []):
+    if function not in benchmark.get("name", ""):
+      continue
+    time_ms = benchmark["real_time"] * TIME_UNIT_TO_MS[benchmark.get(
+        "time_unit", "ns")]
+    if benchmark.get("run_type") == "aggregate":
+      aggregates[benchmark["aggregate_name"]] = time_ms
+    else:
+      times.append(time_ms)
+  if "median" in aggregates:
+    return Measurement(median_ms=aggregates["median"],
+                       stddev_ms=aggregates.get("stddev", 0.0))
+  if not times:
+    raise ValueError(f"No results for benchmark function '{function}'")
+  return Measurement(
+      median_ms=statistics.median(times),
+      stddev_ms=statistics.stdev(times) if len(times) > 1 else 0.0)
+
+
+def is_improvement(baseline: Measurement, candidate: Measurement,
+                   min_speedup: float) -> bool:
+  """Returns true if |candidate| is faster than |baseline| by |min_speedup|
+  and the difference is larger than the noise of the measurements."""
+  if candidate.median_ms * min_speedup > baseline.median_ms:
+    return False
+  noise_ms = baseline.stddev_ms + candidate.stddev_ms
+  return baseline.median_ms - candidate.median_ms > noise_ms
+
+
+def make_database_entry(benchmark: DispatchBenchmark,
+                        config: Optional[LoweringConfig],
+                        time_ms: Optional[float] = None,
+                        baseline_ms: Optional[float] = None) -> Dict[str, Any]:
+  entry = {"target": benchmark.target, "dispatch": benchmark.export}
+  if config:
+    entry["compilation_info"] = config.to_compilation_info()
+    if config.ukernels is not None:
+      entry["ukernels"] = config.ukernels
+  if time_ms is not None:
+    entry["time_ms"] = time_ms
+  if baseline_ms is not None:
+    entry["baseline_ms"] = baseline_ms
+  return entry
+
+
+def merge_database(database: Dict[str, Any],
+                   entries: Sequence[Dict[str, Any]]) -> Dict[str, Any]:
+  """Returns |database| with |entries| replacing entries for the same
+  dispatch."""
+  merged = {(entry["target"], entry["dispatch"]): entry
+            for entry in database.get("entries", [])}
+  for entry in entries:
+    merged[(entry["target"], entry["dispatch"])] = entry
+  return {
+      "version": DATABASE_VERSION,
+      "entries": sorted(merged.values(),
+                        key=lambda entry:
+                        (entry["target"], entry["dispatch"])),
+  }
+
+
+class Tuner(object):
+  """Compiles and measures candidates for dispatch benchmarks."""
+
+  def __init__(self, args: argparse.Namespace, work_dir: pathlib.Path):
+    self._args = args
+    self._work_dir = work_dir
+    self._tools_dir = pathlib.Path(args.tools_dir)
+
+  def _run(self, command: List[str]) -> str:
+    if self._args.verbose:
+      print(" ".join(command), file=sys.stderr)
+    return subprocess.run(command,
+                          check=True,
+                          capture_output=True,
+                          text=True).stdout
+
+  def query_default_config(self, module_path: pathlib.Path,
+                           benchmark: DispatchBenchmark
+                          ) -> Optional[LoweringConfig]:
+    pass_name = CONFIGURATION_PASSES.get(benchmark.target)
+    if not pass_name:
+      return None
+    pipeline = (f"builtin.module(hal.executable(hal.executable.variant("
+                f"{pass_name}{{test-lowering-configuration=true}})))")
+    text = self._run([
+        str(self._tools_dir / "iree-opt"), f"--pass-pipeline={pipeline}",
+        str(module_path)
+    ])
+    return parse_default_config(text, benchmark.export)
+
+  def measure(self, module_path: pathlib.Path, benchmark: DispatchBenchmark,
+              config: Optional[LoweringConfig]) -> Measurement:
+    vmfb_path = self._work_dir / "candidate.vmfb"
+    command = [
+        str(self._tools_dir / "iree-compile"),
+        str(module_path), f"-o={vmfb_path}"
+    ] + self._args.compile_flags
+    if config:
+      database_path = self._work_dir / "candidate.json"
+      database_path.write_text(
+          json.dumps(merge_database({}, [make_database_entry(benchmark,
+                                                              config)])))
+      command.append(f"--iree-codegen-tuning-database={database_path}")
+    self._run(command)
+    output = self._run([
+        str(self._tools_dir / "iree-benchmark-module"), f"--module={vmfb_path}",
+        f"--device={self._args.device}", f"--function={benchmark.function}",
+        "--benchmark_format=json",
+        f"--benchmark_repetitions={self._args.repetitions}"
+    ])
+    return parse_benchmark_results(output, benchmark.function)
+
+  def tune(self, module_path: pathlib.Path,
+           benchmark: DispatchBenchmark) -> Optional[Dict[str, Any]]:
+    default_config = self.query_default_config(module_path, benchmark)
+    if not default_config:
+      print(f"{benchmark.function}: no tunable configuration, skipped")
+      return None
+    baseline = self.measure(module_path, benchmark, None)
+    best_config, best = None, baseline
+    candidates = generate_candidates(default_config, benchmark.target,
+                                     self._args.tile_factors,
+                                     self._args.vector_factors,
+                                     self._args.max_candidates)
+    for config in candidates:
+      try:
+        measurement = self.measure(module_path, benchmark, config)
+      except subprocess.CalledProcessError as e:
+        # Not every candidate is legal for the op or the pipeline.
+        if self._args.verbose:
+          print(e.stderr, file=sys.stderr)
+        continue
+      if is_improvement(best, measurement, self._args.min_speedup):
+        best_config, best = config, measurement
+
+    print(f"{benchmark.function}: {baseline.median_ms:.4f} ms -> "
+          f"{best.median_ms:.4f} ms ({len(candidates)} candidates)")
+    if not best_config:
+      return None
+    return make_database_entry(benchmark, best_config, best.median_ms,
+                               baseline.median_ms)
+
+
+def parse_arguments():
+  parser = argparse.ArgumentParser(
+      description="Autotunes the lowering configuration of dispatch "
+      "benchmarks and writes the winners to a tuning database.")
+  parser.add_argument(
+      "--benchmark_dir",
+      type=pathlib.Path,
+      required=True,
+      help="Directory written by --iree-hal-dump-executable-benchmarks-to.")
+  parser.add_argument("--tools_dir",
+                      required=True,
+                      help="Directory with iree-compile, iree-opt and "
+                      "iree-benchmark-module.")
+  parser.add_argument("--output",
+                      type=pathlib.Path,
+                      required=True,
+                      help="Tuning database to create or update.")
+  parser.add_argument("--device",
+                      default="local-task",
+                      help="Device to benchmark on.")
+  parser.add_argument("--repetitions",
+                      type=int,
+                      default=10,
+                      help="Benchmark repetitions per candidate.")
+  parser.add_argument("--min_speedup",
+                      type=float,
+                      default=1.05,
+                      help="Speedup over the default configuration a "
+                      "candidate needs to be recorded.")
+  parser.add_argument("--max_candidates",
+                      type=int,
+                      default=16,
+                      help="Maximum number of candidates per dispatch.")
+  parser.add_argument("--tile_factors",
+                      type=float,
+                      nargs="+",
+                      default=[0.5, 1, 2],
+                      help="Factors to scale distribution tile sizes by.")
+  parser.add_argument("--vector_factors",
+                      type=float,
+                      nargs="+",
+                      default=[0.5, 1, 2],
+                      help="Factors to scale vector tile sizes by.")
+  parser.add_argument("--filter",
+                      default="",
+                      help="Only tune benchmark functions matching the regex.")
+  parser.add_argument("--verbose", action="store_true")
+  parser.add_argument("compile_flags",
+                      nargs="*",
+                      help="Flags passed to iree-compile (after --).")
+  return parser.parse_args()
+
+
+def main(args: argparse.Namespace):
+  database = {}
+  if args.output.exists():
+    database = json.loads(args.output.read_text())
+
+  entries = []
+  tuned = set()
+  with tempfile.TemporaryDirectory() as work_dir:
+    tuner = Tuner(args, pathlib.Path(work_dir))
+    for module_path in sorted(args.benchmark_dir.glob("*.mlir")):
+      for benchmark in parse_benchmark_module(module_path.read_text()):
+        if not re.search(args.filter, benchmark.function):
+          continue
+        # Configurations are per export so only the first workload is tuned.
+        if (benchmark.target, benchmark.export) in tuned:
+          continue
+        tuned.add((benchmark.target, benchmark.export))
+        entry = tuner.tune(module_path, benchmark)
+        if entry:
+          entries.append(entry)
+
+  args.output.write_text(json.dumps(merge_database(database, entries),
+                                    indent=2))
+  print(f"Wrote {len(entries)} tuned dispatches to {args.output}")
+
+
+if __name__ == "__main__":
+  main(parse_arguments())
@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+# Copyright 2023 The IREE Authors
+#
+# Licensed under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+import json
+import unittest
+
+from tune_dispatch_benchmarks import DispatchBenchmark, LoweringConfig, Measurement
+import tune_dispatch_benchmarks
+
+BENCHMARK_MODULE = """
+#executable_target_embedded_elf_x86_64_ = #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64", {target_triple = "x86_64-unknown-unknown-eabi-elf"}>
+module attributes {hal.device.targets = [#device_target_llvm_cpu]} {
+  hal.executable private @main_dispatch_0 {
+    hal.executable.variant public @embedded_elf_x86_64, target = #executable_target_embedded_elf_x86_64_ {
+      hal.executable.export public @main_dispatch_0_matmul_128x256x512 ordinal(0) layout(#pipeline_layout) {
+      }
+    }
+  }
+  func.func @main_dispatch_0_embedded_elf_x86_64_main_dispatch_0_matmul_128x256x512_4x8x1(%arg0: i32) attributes {iree.abi.stub} {
+    return
+  }
+}
+"""
+
+CONFIGURED_MODULE = """
+#config = #iree_codegen.lowering_config<tile_sizes = [[64, 64, 0], [8, 32, 0], [0, 0, 16]]>
+#config1 = #iree_codegen.lowering_config<tile_sizes = [[64, 64], [8, 32]]>
+#translation = #iree_codegen.translation_info<CPUDoubleTilingExpert>
+hal.executable private @main_dispatch_0 {
+  hal.executable.variant public @embedded_elf_x86_64, target = #executable_target_embedded_elf_x86_64_ {
+    hal.executable.export public @main_dispatch_0_matmul_128x256x512 ordinal(0) layout(#pipeline_layout) attributes {translation_info = #translation} {
+    }
+  }
+}
+"""
+
+
+class TuneDispatchBenchmarksTest(unittest.TestCase):
+
+  def test_parse_benchmark_module(self):
+    benchmarks = tune_dispatch_benchmarks.parse_benchmark_module(
+        BENCHMARK_MODULE)
+
+    self.assertEqual(benchmarks, [
+        DispatchBenchmark(
+            function=
+            "main_dispatch_0_embedded_elf_x86_64_main_dispatch_0_matmul_128x256x512_4x8x1",
+            export="main_dispatch_0_matmul_128x256x512",
+            target="llvm-cpu")
+    ])
+
+  def test_parse_default_config(self):
+    config = tune_dispatch_benchmarks.parse_default_config(
+        CONFIGURED_MODULE, "main_dispatch_0_matmul_128x256x512")
+
+    self.assertEqual(
+        config,
+        LoweringConfig(tile_sizes=((64, 64, 0), (8, 32, 0), (0, 0, 16)),
+                       translation_info="CPUDoubleTilingExpert"))
+    self.assertEqual(
+        config.to_compilation_info(),
+        "#iree_codegen.compilation_info<"
+        "lowering_config = <tile_sizes = [[64, 64, 0], [8, 32, 0], [0, 0, 16]]>, "
+        "translation_info = <CPUDoubleTilingExpert>, workgroup_size = []>")
+
+  def test_generate_candidates(self):
+    config = LoweringConfig(tile_sizes=((64, 64, 0), (0, 0, 16)),
+                            translation_info="CPUDoubleTilingExpert")
+
+    candidates = tune_dispatch_benchmarks.generate_candidates(
+        config,
+        "llvm-cpu",
+        tile_factors=[0.5, 1],
+        vector_factors=[1, 2],
+        max_candidates=10)
+
+    self.assertEqual([candidate.tile_sizes for candidate in candidates], [
+        ((32, 32, 0), (0, 0, 16)),
+        ((32, 32, 0), (0, 0, 32)),
+        ((64, 64, 0), (0, 0, 32)),
+    ])
+
+  def test_generate_candidates_drops_vector_tiles_larger_than_workgroup(self):
+    config = LoweringConfig(tile_sizes=((16, 16), (16, 16)),
+                            translation_info="CPUDoubleTilingExpert")
+
+    candidates = tune_dispatch_benchmarks.generate_candidates(
+        config,
+        "llvm-cpu",
+        tile_factors=[1],
+        vector_factors=[0.5, 2],
+        max_candidates=10)
+
+    self.assertEqual([candidate.tile_sizes for candidate in candidates],
+                     [((16, 16), (8, 8))])
+
+  def test_generate_candidates_toggles_ukernels(self):
+    config = LoweringConfig(tile_sizes=((64,),),
+                            translation_info="VMVXDefault")
+
+    candidates = tune_dispatch_benchmarks.generate_candidates(
+        config,
+        "vmvx",
+        tile_factors=[1],
+        vector_factors=[1],
+        max_candidates=10)
+
+    self.assertEqual([candidate.ukernels for candidate in candidates],
+                     [False, True])
+
+  def test_parse_benchmark_results(self):
+    results = {
+        "benchmarks": [{
+            "name": "BM_foo/process_time/real_time",
+            "run_type": "iteration",
+            "real_time": 1000.0,
+            "time_unit": "ns"
+        }, {
+            "name": "BM_foo/process_time/real_time_median",
+            "run_type": "aggregate",
+            "aggregate_name": "median",
+            "real_time": 2.0,
+            "time_unit": "us"
+        }, {
+            "name": "BM_foo/process_time/real_time_stddev",
+            "run_type": "aggregate",
+            "aggregate_name": "stddev",
+            "real_time": 100.0,
+            "time_unit": "ns"
+        }]
+    }
+
+    measurement = tune_dispatch_benchmarks.parse_benchmark_results(
+        json.dumps(results), "foo")
+
+    self.assertAlmostEqual(measurement.median_ms, 2e-3)
+    self.assertAlmostEqual(measurement.stddev_ms, 1e-4)
+
+  def test_is_improvement(self):
+    baseline = Measurement(median_ms=1.0, stddev_ms=0.01)
+
+    self.assertTrue(
+        tune_dispatch_benchmarks.is_improvement(
+            baseline, Measurement(median_ms=0.8, stddev_ms=0.01), 1.05))
+    self.assertFalse(
+        tune_dispatch_benchmarks.is_improvement(
+            baseline, Measurement(median_ms=0.98, stddev_ms=0.0), 1.05))
+    self.assertFalse(
+        tune_dispatch_benchmarks.is_improvement(
+            baseline, Measurement(median_ms=0.8, stddev_ms=0.3), 1.05))
+
+  def test_merge_database(self):
+    old_entry = {"target": "llvm-cpu", "dispatch": "a", "time_ms": 2.0}
+    other_entry = {"target": "llvm-cpu", "dispatch": "b", "time_ms": 3.0}
+    new_entry = {"target": "llvm-cpu", "dispatch": "a", "time_ms": 1.0}
+
+    database = tune_dispatch_benchmarks.merge_database(
+        {
+            "version": 1,
+            "entries": [other_entry, old_entry]
+        }, [new_entry])
+
+    self.assertEqual(database, {
+        "version": 1,
+        "entries": [new_entry, other_entry]
+    })
+
+
+if __name__ == "__main__":
+  unittest.main()
@@ -61,6 +61,8 @@ IREE_TFLITE_MODEL_SOURCE_URL = {
         'https://www.tensorflow.org/lite/performance/gpu#demo_app_tutorials',
     'PoseNet':
         'https://tfhub.dev/tensorflow/lite-model/posenet/mobilenet/float/075/1/default/1',
+    'GPT2':
+        'https://huggingface.co/gpt2',
 }
 
 
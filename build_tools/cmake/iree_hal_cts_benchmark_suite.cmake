@@ -0,0 +1,74 @@
+# Copyright 2023 The IREE Authors
+#
+# Licensed under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+include(CMakeParseArguments)
+
+# iree_hal_cts_benchmark_suite()
+#
+# Creates a benchmark binary measuring the overhead of common Hardware
+# Abstraction Layer (HAL) operations for a provided driver. Every driver runs
+# the same benchmarks from `iree/hal/cts/cts_benchmarks.c` so that their
+# reports can be compared side by side.
+#
+# Parameters:
+#   DRIVER_NAME: The name of the driver to benchmark. Used for both target names
+#       and for `iree_hal_driver_registry_try_create()` within benchmark code.
+#   VARIANT_SUFFIX: Suffix to add to the target name, separate from the driver
+#       name. Useful when linking the same driver with different `DEPS`.
+#   DRIVER_REGISTRATION_HDR: The C #include path for `DRIVER_REGISTRATION_FN`.
+#   DRIVER_REGISTRATION_FN: The C function which registers `DRIVER_NAME`.
+#   DEPS: List of other libraries to link in to the binary target (typically
+#       the dependency for `DRIVER_REGISTRATION_HDR`).
+#   LABELS: Additional labels to forward to `iree_cc_binary_benchmark`. The
+#     package path and "driver=${DRIVER}" are added automatically.
+function(iree_hal_cts_benchmark_suite)
+  if(NOT IREE_BUILD_TESTS)
+    return()
+  endif()
+
+  cmake_parse_arguments(
+    _RULE
+    ""
+    "DRIVER_NAME;VARIANT_SUFFIX;DRIVER_REGISTRATION_HDR;DRIVER_REGISTRATION_FN"
+    "DEPS;LABELS"
+    ${ARGN}
+  )
+
+  list(APPEND _RULE_LABELS "driver=${_RULE_DRIVER_NAME}")
+
+  if(DEFINED _RULE_VARIANT_SUFFIX)
+    set(_BENCHMARK_TARGET_NAME "${_RULE_DRIVER_NAME}_${_RULE_VARIANT_SUFFIX}_cts_benchmark")
+  else()
+    set(_BENCHMARK_TARGET_NAME "${_RULE_DRIVER_NAME}_cts_benchmark")
+  endif()
+  set(_BENCHMARK_SOURCE_NAME "${_BENCHMARK_TARGET_NAME}.c")
+
+  set(IREE_CTS_DRIVER_REGISTRATION_HDR "${_RULE_DRIVER_REGISTRATION_HDR}")
+  set(IREE_CTS_DRIVER_REGISTRATION_FN "${_RULE_DRIVER_REGISTRATION_FN}")
+  set(IREE_CTS_DRIVER_NAME "${_RULE_DRIVER_NAME}")
+
+  configure_file(
+    "${IREE_ROOT_DIR}/runtime/src/iree/hal/cts/cts_benchmark_template.c.in"
+    ${_BENCHMARK_SOURCE_NAME}
+  )
+
+  iree_cc_binary_benchmark(
+    NAME
+      ${_BENCHMARK_TARGET_NAME}
+    SRCS
+      "${CMAKE_CURRENT_BINARY_DIR}/${_BENCHMARK_SOURCE_NAME}"
+    DEPS
+      ${_RULE_DEPS}
+      iree::base
+      iree::base::internal::flags
+      iree::hal
+      iree::hal::cts::cts_benchmarks
+      iree::testing::benchmark
+    LABELS
+      ${_RULE_LABELS}
+    TESTONLY
+  )
+endfunction()
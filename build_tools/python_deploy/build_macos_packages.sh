@@ -81,14 +81,14 @@ function run() {
 }
 
 function build_iree_runtime() {
-  IREE_HAL_DRIVER_VULKAN=ON \
+  IREE_HAL_DRIVER_PIM=ON \
   python3 -m pip wheel -v -w $output_dir $repo_root/runtime/
 }
 
 function build_iree_runtime_instrumented() {
   # TODO: Bundled tracy client on MacOS not yet supported.
   # Add IREE_BUILD_TRACY=ON once it is.
-  IREE_HAL_DRIVER_VULKAN=ON IREE_ENABLE_RUNTIME_TRACING=ON \
+  IREE_HAL_DRIVER_PIM=ON IREE_ENABLE_RUNTIME_TRACING=ON \
   IREE_RUNTIME_CUSTOM_PACKAGE_SUFFIX="-instrumented" \
   python3 -m pip wheel -v -w $output_dir $repo_root/runtime/
 }
@@ -369,6 +369,42 @@ static func::FuncOp createExportWrapperFunc(
     resultStorages[outputAttr.getInt()] = storageArg;
   }
 
+  // Inputs donated to a result have their backing buffer reused as the storage
+  // of that result. The caller must not use the input after the call.
+  for (unsigned i = 0; i < exportOp.getNumArguments(); ++i) {
+    auto donateAttr =
+        exportOp.getArgAttrOfType<IntegerAttr>(i, "iree.abi.donate");
+    if (!donateAttr) continue;
+    int64_t resultIndex = donateAttr.getInt();
+    if (resultIndex < 0 ||
+        resultIndex >= static_cast<int64_t>(oldExportType.getNumResults())) {
+      exportOp.emitError() << "donated argument " << i
+                           << " references invalid result " << resultIndex;
+      return {};
+    }
+    // The input and result must be of the same static type so that the
+    // result is known to fit in the donated storage.
+    auto argType = oldExportType.getInput(i).dyn_cast<RankedTensorType>();
+    if (!argType || !argType.hasStaticShape() ||
+        argType != oldExportType.getResult(resultIndex)) {
+      exportOp.emitError() << "donated argument " << i << " has type "
+                           << oldExportType.getInput(i)
+                           << " that does not match result " << resultIndex
+                           << "; must be the same statically-shaped tensor";
+      return {};
+    }
+    if (resultStorages[resultIndex]) {
+      exportOp.emitError() << "result " << resultIndex
+                           << " has multiple storage arguments";
+      return {};
+    }
+    auto donatedArg = entryBlock->getArgument(i);
+    resultStorages[resultIndex] =
+        entryBuilder.create<IREE::HAL::BufferViewBufferOp>(
+            donatedArg.getLoc(),
+            IREE::HAL::BufferType::get(exportOp.getContext()), donatedArg);
+  }
+
   // Build a map of each I/O argument to the fence that covers them.
   // TODO(benvanik): actually support a map; for now we just handle the 1:M
   // coarse mode where all inputs are covered by a single wait fence and all
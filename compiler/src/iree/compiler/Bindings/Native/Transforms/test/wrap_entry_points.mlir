@@ -57,6 +57,22 @@ func.func @outputStorage(%arg0: tensor<?x8x8x3xf32>, %ret1: !hal.buffer {iree.ab
 
 // -----
 
+// CHECK-LABEL: func.func @donatedInput(
+//  CHECK-SAME:   %[[ARG0:.+]]: !hal.buffer_view {iree.abi.donate = 0 : index}
+//  CHECK-NEXT:   %[[ARG0_STORAGE:.+]] = hal.buffer_view.buffer<%[[ARG0]] : !hal.buffer_view> : !hal.buffer
+//  CHECK-NEXT:   %[[ARG0_TENSOR:.+]] = hal.tensor.import %[[ARG0]] : !hal.buffer_view -> tensor<4xf32>
+//  CHECK-NEXT:   %[[RET_TENSOR:.+]] = call @_donatedInput(%[[ARG0_TENSOR]])
+//  CHECK-NEXT:   %[[RET_VIEW:.+]] = hal.tensor.export %[[RET_TENSOR]] into %[[ARG0_STORAGE]] : tensor<4xf32> -> !hal.buffer_view
+//  CHECK-NEXT:   return %[[RET_VIEW]] : !hal.buffer_view
+
+// CHECK-LABEL: func.func private @_donatedInput(
+func.func @donatedInput(%arg0: tensor<4xf32> {iree.abi.donate = 0 : index}) -> tensor<4xf32> {
+  %0 = arith.addf %arg0, %arg0 : tensor<4xf32>
+  return %0 : tensor<4xf32>
+}
+
+// -----
+
 // CHECK-LABEL: func.func @wrappedAlready
 //  CHECK-SAME: (%arg0: !hal.buffer_view) -> !hal.buffer_view
 //  CHECK-SAME: attributes {iree.abi.stub}
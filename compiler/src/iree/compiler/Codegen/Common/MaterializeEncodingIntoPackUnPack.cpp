@@ -292,6 +292,21 @@ Optional<MatmulType> getMatmulType(TensorEncoding encoding) {
     case TensorEncoding::MATMUL_I8I8I32_RHS_TRANSPOSE:
     case TensorEncoding::MATMUL_I8I8I32_RESULT:
       return MatmulType::I8I8I32;
+    case TensorEncoding::MATMUL_F16F16F32_LHS:
+    case TensorEncoding::MATMUL_F16F16F32_RHS:
+    case TensorEncoding::MATMUL_F16F16F32_RHS_TRANSPOSE:
+    case TensorEncoding::MATMUL_F16F16F32_RESULT:
+      return MatmulType::F16F16F32;
+    case TensorEncoding::MATMUL_F16F16F16_LHS:
+    case TensorEncoding::MATMUL_F16F16F16_RHS:
+    case TensorEncoding::MATMUL_F16F16F16_RHS_TRANSPOSE:
+    case TensorEncoding::MATMUL_F16F16F16_RESULT:
+      return MatmulType::F16F16F16;
+    case TensorEncoding::MATMUL_BF16BF16F32_LHS:
+    case TensorEncoding::MATMUL_BF16BF16F32_RHS:
+    case TensorEncoding::MATMUL_BF16BF16F32_RHS_TRANSPOSE:
+    case TensorEncoding::MATMUL_BF16BF16F32_RESULT:
+      return MatmulType::BF16BF16F32;
     default:
       return std::nullopt;
   }
@@ -301,15 +316,27 @@ Optional<MatmulOperandRole> getMatmulOperandRole(TensorEncoding encoding) {
   switch (encoding) {
     case TensorEncoding::MATMUL_F32F32F32_LHS:
     case TensorEncoding::MATMUL_I8I8I32_LHS:
+    case TensorEncoding::MATMUL_F16F16F32_LHS:
+    case TensorEncoding::MATMUL_F16F16F16_LHS:
+    case TensorEncoding::MATMUL_BF16BF16F32_LHS:
       return MatmulOperandRole::LHS;
     case TensorEncoding::MATMUL_F32F32F32_RHS:
     case TensorEncoding::MATMUL_I8I8I32_RHS:
+    case TensorEncoding::MATMUL_F16F16F32_RHS:
+    case TensorEncoding::MATMUL_F16F16F16_RHS:
+    case TensorEncoding::MATMUL_BF16BF16F32_RHS:
       return MatmulOperandRole::RHS;
     case TensorEncoding::MATMUL_F32F32F32_RHS_TRANSPOSE:
     case TensorEncoding::MATMUL_I8I8I32_RHS_TRANSPOSE:
+    case TensorEncoding::MATMUL_F16F16F32_RHS_TRANSPOSE:
+    case TensorEncoding::MATMUL_F16F16F16_RHS_TRANSPOSE:
+    case TensorEncoding::MATMUL_BF16BF16F32_RHS_TRANSPOSE:
       return MatmulOperandRole::RHS_TRANSPOSE;
     case TensorEncoding::MATMUL_F32F32F32_RESULT:
     case TensorEncoding::MATMUL_I8I8I32_RESULT:
+    case TensorEncoding::MATMUL_F16F16F32_RESULT:
+    case TensorEncoding::MATMUL_F16F16F16_RESULT:
+    case TensorEncoding::MATMUL_BF16BF16F32_RESULT:
       return MatmulOperandRole::RESULT;
     default:
       return std::nullopt;
@@ -352,6 +379,12 @@ chooseDynamicEncodingInfoVMVXMicrokernels(RankedTensorType tensorType,
     flags |= IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_F32F32F32;
   } else if (*matmulType == MatmulType::I8I8I32) {
     flags |= IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_I8I8I32;
+  } else if (*matmulType == MatmulType::F16F16F32) {
+    flags |= IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_F16F16F32;
+  } else if (*matmulType == MatmulType::F16F16F16) {
+    flags |= IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_F16F16F16;
+  } else if (*matmulType == MatmulType::BF16BF16F32) {
+    flags |= IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_BF16BF16F32;
   } else {
     return failure();
   }
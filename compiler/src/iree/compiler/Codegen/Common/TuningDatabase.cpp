@@ -0,0 +1,138 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Codegen/Common/TuningDatabase.h"
+
+#include <mutex>
+#include <string>
+
+#include "iree/compiler/Dialect/HAL/IR/HALTypes.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "mlir/AsmParser/AsmParser.h"
+
+namespace mlir {
+namespace iree_compiler {
+
+static llvm::cl::opt<std::string> clTuningDatabase(
+    "iree-codegen-tuning-database",
+    llvm::cl::desc("JSON file with per-dispatch lowering configurations that "
+                   "override the default heuristics (as produced by "
+                   "tune_dispatch_benchmarks.py)"),
+    llvm::cl::init(""));
+
+namespace {
+
+struct DatabaseEntry {
+  std::string compilationInfo;
+  std::optional<bool> ukernels;
+};
+
+/// Contents of a tuning database file keyed by `<target>:<dispatch>`.
+struct Database {
+  std::string error;
+  llvm::StringMap<DatabaseEntry> entries;
+};
+
+}  // namespace
+
+static std::string getEntryKey(StringRef target, StringRef dispatch) {
+  return (target + ":" + dispatch).str();
+}
+
+static Database loadDatabase(StringRef path) {
+  Database database;
+  auto fileOr = llvm::MemoryBuffer::getFile(path, /*IsText=*/true);
+  if (!fileOr) {
+    database.error = "failed to open tuning database '" + path.str() +
+                     "': " + fileOr.getError().message();
+    return database;
+  }
+  llvm::Expected<llvm::json::Value> json =
+      llvm::json::parse(fileOr.get()->getBuffer());
+  if (!json) {
+    database.error = "failed to parse tuning database '" + path.str() +
+                     "': " + llvm::toString(json.takeError());
+    return database;
+  }
+  const llvm::json::Object *root = json->getAsObject();
+  const llvm::json::Array *entries =
+      root ? root->getArray("entries") : nullptr;
+  if (!entries || root->getInteger("version") != 1) {
+    database.error = "tuning database '" + path.str() +
+                     "' is not a version 1 database with an 'entries' array";
+    return database;
+  }
+  for (const llvm::json::Value &value : *entries) {
+    const llvm::json::Object *entry = value.getAsObject();
+    if (!entry || !entry->getString("target") ||
+        !entry->getString("dispatch")) {
+      database.error = "tuning database '" + path.str() +
+                       "' has an entry without 'target' and 'dispatch'";
+      return database;
+    }
+    auto target = entry->getString("target");
+    auto dispatch = entry->getString("dispatch");
+    DatabaseEntry &databaseEntry =
+        database.entries[getEntryKey(*target, *dispatch)];
+    if (auto compilationInfo = entry->getString("compilation_info")) {
+      databaseEntry.compilationInfo = compilationInfo->str();
+    }
+    if (auto ukernels = entry->getBoolean("ukernels")) {
+      databaseEntry.ukernels = *ukernels;
+    }
+  }
+  return database;
+}
+
+/// Returns the database at `path`, loading it on first use. Databases are
+/// shared across all compilations in the process.
+static const Database &getDatabase(StringRef path) {
+  static std::mutex mutex;
+  static llvm::StringMap<Database> databases;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = databases.find(path);
+  if (it == databases.end()) {
+    it = databases.insert({path, loadDatabase(path)}).first;
+  }
+  return it->second;
+}
+
+FailureOr<std::optional<TunedConfig>> lookupTunedConfig(
+    func::FuncOp entryPointFn) {
+  if (clTuningDatabase.empty()) return std::optional<TunedConfig>();
+  auto targetAttr = IREE::HAL::ExecutableTargetAttr::lookup(entryPointFn);
+  if (!targetAttr) return std::optional<TunedConfig>();
+
+  const Database &database = getDatabase(clTuningDatabase);
+  if (!database.error.empty()) {
+    entryPointFn.emitError(database.error);
+    return failure();
+  }
+  auto it = database.entries.find(getEntryKey(
+      targetAttr.getBackend().getValue(), entryPointFn.getName()));
+  if (it == database.entries.end()) return std::optional<TunedConfig>();
+
+  TunedConfig config;
+  config.ukernels = it->second.ukernels;
+  if (!it->second.compilationInfo.empty()) {
+    Attribute attr = parseAttribute(it->second.compilationInfo,
+                                    entryPointFn.getContext());
+    config.compilationInfo =
+        attr.dyn_cast_or_null<IREE::Codegen::CompilationInfoAttr>();
+    if (!config.compilationInfo) {
+      entryPointFn.emitError("invalid compilation_info in tuning database: ")
+          << it->second.compilationInfo;
+      return failure();
+    }
+  }
+  return std::optional<TunedConfig>(config);
+}
+
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -0,0 +1,57 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_COMPILER_CODEGEN_COMMON_TUNINGDATABASE_H_
+#define IREE_COMPILER_CODEGEN_COMMON_TUNINGDATABASE_H_
+
+#include <optional>
+
+#include "iree/compiler/Codegen/Dialect/LoweringConfig.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+
+namespace mlir {
+namespace iree_compiler {
+
+/// Configuration recorded for one dispatch in a tuning database.
+///
+/// The database is a JSON file produced by
+/// build_tools/benchmarks/tune_dispatch_benchmarks.py:
+///
+/// ```json
+/// {
+///   "version": 1,
+///   "entries": [
+///     {
+///       "target": "llvm-cpu",
+///       "dispatch": "main_dispatch_0_matmul_128x256x512_f32",
+///       "compilation_info": "#iree_codegen.compilation_info<...>",
+///       "ukernels": false
+///     }
+///   ]
+/// }
+/// ```
+///
+/// Entries are matched by the backend of the executable target and the name of
+/// the exported function. Other fields (such as the measured times) are
+/// ignored by the compiler.
+struct TunedConfig {
+  /// Configuration to use in place of the heuristics, if any.
+  IREE::Codegen::CompilationInfoAttr compilationInfo;
+  /// Overrides whether microkernels are used, if set.
+  std::optional<bool> ukernels;
+};
+
+/// Returns the entry of the tuning database passed with
+/// `--iree-codegen-tuning-database` for `entryPointFn`, or std::nullopt if no
+/// database is used or it has no entry for the function. Fails with an error
+/// on `entryPointFn` if the database cannot be read or parsed.
+FailureOr<std::optional<TunedConfig>> lookupTunedConfig(
+    func::FuncOp entryPointFn);
+
+}  // namespace iree_compiler
+}  // namespace mlir
+
+#endif  // IREE_COMPILER_CODEGEN_COMMON_TUNINGDATABASE_H_
@@ -293,6 +293,15 @@ FailureOr<func::CallOp> UKernelMmt4DOp::lowerToFunctionCall(
     case MatmulType::F32F32F32:
       fnName.append("f32.f32.f32");
       break;
+    case MatmulType::F16F16F32:
+      fnName.append("f16.f16.f32");
+      break;
+    case MatmulType::F16F16F16:
+      fnName.append("f16.f16.f16");
+      break;
+    case MatmulType::BF16BF16F32:
+      fnName.append("bf16.bf16.f32");
+      break;
   }
 
   // Create the function type.
@@ -597,6 +597,8 @@ void registerBufferizationInterfaces(DialectRegistry &registry) {
         LinalgExtOpInterface<IREE::LinalgExt::SortOp>>(*ctx);
     IREE::LinalgExt::TopkOp::attachInterface<
         LinalgExtOpInterface<IREE::LinalgExt::TopkOp>>(*ctx);
+    IREE::LinalgExt::SampleOp::attachInterface<
+        LinalgExtOpInterface<IREE::LinalgExt::SampleOp>>(*ctx);
     IREE::LinalgExt::WinogradInputTransformOp::attachInterface<
         LinalgExtOpInterface<IREE::LinalgExt::WinogradInputTransformOp>>(*ctx);
     IREE::LinalgExt::WinogradOutputTransformOp::attachInterface<
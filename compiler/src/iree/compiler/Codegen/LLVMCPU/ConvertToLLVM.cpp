@@ -535,6 +535,12 @@ void ConvertToLLVMPass::runOnOperation() {
   populateLinalgToLLVMConversionPatterns(typeConverter, patterns);
   populateReconcileUnrealizedCastsPatterns(patterns);
 
+  // Exported dispatch functions are converted by ConvertHALEntryPointFuncOp.
+  SmallVector<std::string> exportNames;
+  for (auto funcOp : module.getOps<func::FuncOp>()) {
+    if (funcOp.isPublic()) exportNames.push_back(funcOp.getName().str());
+  }
+
   HALDispatchABI abi(&typeConverter);
   // clang-format off
   patterns.insert<
@@ -569,6 +575,17 @@ void ConvertToLLVMPass::runOnOperation() {
       return signalPassFailure();
   }
 
+  // Have the exported dispatch functions loop over the workgroup range they
+  // are called with. This is done after all ABI loads have been emitted in the
+  // functions executing a single workgroup.
+  if (hasWorkgroupRanges(IREE::HAL::ExecutableTargetAttr::lookup(module))) {
+    for (auto exportName : exportNames) {
+      auto funcOp = module.lookupSymbol<LLVM::LLVMFuncOp>(exportName);
+      if (!funcOp || funcOp.isExternal()) continue;
+      HALDispatchABI::buildWorkgroupRangeLoop(funcOp, &typeConverter);
+    }
+  }
+
   // Post conversion patterns.
   {
     RewritePatternSet postPatterns(&getContext());
@@ -298,6 +298,8 @@ LLVM::DIDerivedTypeAttr ExecutableLibraryDI::getWorkgroupStateV0T() {
               getMemberOf("processor_id", getUint32T(), &offsetInBits),
               getMemberOf("local_memory", getVoidPtr(), &offsetInBits),
               getMemberOf("local_memory_size", getUint32T(), &offsetInBits),
+              getMemberOf("workgroup_range_count", getUint32T(),
+                          &offsetInBits),
           }));
 }
 
@@ -459,6 +461,9 @@ LLVM::LLVMStructType HALDispatchABI::getWorkgroupStateType(
   fieldTypes.push_back(LLVM::LLVMPointerType::get(int8PtrType));
   fieldTypes.push_back(uint32Type);
 
+  // uint32_t workgroup_range_count;
+  fieldTypes.push_back(uint32Type);
+
   LogicalResult bodySet = structType.setBody(fieldTypes, /*isPacked=*/false);
   assert(succeeded(bodySet) &&
          "could not set the body of an identified struct");
@@ -537,6 +542,143 @@ LLVM::DISubprogramAttr HALDispatchABI::buildScopeAttr(
       subroutineTypeAttr);
 }
 
+// static
+LLVM::LLVMFuncOp HALDispatchABI::buildWorkgroupRangeLoop(
+    LLVM::LLVMFuncOp funcOp, LLVMTypeConverter *typeConverter) {
+  auto *context = &typeConverter->getContext();
+  auto dispatchStateType = getDispatchStateType(context, typeConverter);
+  auto workgroupStateType = getWorkgroupStateType(context, typeConverter);
+  auto int16Type = IntegerType::get(context, 16);
+  auto int32Type = IntegerType::get(context, 32);
+
+  // The debug info attached to the workgroup body (including the variables of
+  // its arguments) stays with it and the loop is emitted without a scope of
+  // its own; the scope attrs are uniqued by name and can't be shared.
+  Location loc = funcOp.getLoc();
+  if (auto scopeLoc =
+          loc.dyn_cast<mlir::FusedLocWith<LLVM::DISubprogramAttr>>()) {
+    loc = scopeLoc.getLocations().front();
+  }
+
+  // Move the workgroup body to an internal function.
+  std::string exportName = funcOp.getName().str();
+  std::string workgroupName = exportName + "_workgroup";
+  funcOp.setSymName(workgroupName);
+  funcOp.setLinkageAttr(
+      LLVM::LinkageAttr::get(context, LLVM::Linkage::Internal));
+
+  OpBuilder builder(context);
+  builder.setInsertionPointAfter(funcOp);
+  auto rangeFuncOp = builder.create<LLVM::LLVMFuncOp>(
+      loc, exportName, funcOp.getFunctionType(), LLVM::Linkage::External,
+      /*dso_local=*/false, /*cconv*/ LLVM::CConv::C);
+  for (unsigned i = 0; i <= 2; ++i) {
+    rangeFuncOp.setArgAttr(i, LLVM::LLVMDialect::getNoAliasAttrName(),
+                           builder.getUnitAttr());
+    rangeFuncOp.setArgAttr(i, LLVM::LLVMDialect::getAlignAttrName(),
+                           builder.getI64IntegerAttr(16));
+  }
+
+  Block *entryBlock = rangeFuncOp.addEntryBlock();
+  Region &body = rangeFuncOp.getBody();
+  Type loopArgTypes[] = {workgroupStateType, int32Type};
+  Location loopArgLocs[] = {loc, loc};
+  Block *loopBlock =
+      builder.createBlock(&body, body.end(), loopArgTypes, loopArgLocs);
+  Block *nextBlock = builder.createBlock(&body, body.end());
+  Block *advanceBlock = builder.createBlock(&body, body.end());
+  Type exitArgTypes[] = {int32Type};
+  Block *exitBlock = builder.createBlock(&body, body.end(), exitArgTypes, loc);
+  Value environment = entryBlock->getArgument(0);
+  Value dispatchState = entryBlock->getArgument(1);
+  Value workgroupState = entryBlock->getArgument(2);
+  auto getStateField = [&](Value state, WorkgroupStateField field) -> Value {
+    return builder.create<LLVM::ExtractValueOp>(loc, state,
+                                                static_cast<int64_t>(field));
+  };
+
+  // Copy the workgroup state so that the workgroup ID can be advanced.
+  builder.setInsertionPointToStart(entryBlock);
+  Value zero = builder.create<LLVM::ConstantOp>(
+      loc, int32Type, builder.getI32IntegerAttr(0));
+  Value one = builder.create<LLVM::ConstantOp>(loc, int32Type,
+                                               builder.getI32IntegerAttr(1));
+  Value statePtr = builder.create<LLVM::AllocaOp>(
+      loc, LLVM::LLVMPointerType::get(workgroupStateType), one,
+      /*alignment=*/16);
+  Value initialState = builder.create<LLVM::LoadOp>(loc, workgroupState);
+  Value dispatchStateValue = builder.create<LLVM::LoadOp>(loc, dispatchState);
+  Value workgroupCountX = builder.create<LLVM::ExtractValueOp>(
+      loc, dispatchStateValue,
+      static_cast<int64_t>(DispatchStateField::workgroup_count_x));
+  Value workgroupCountY = builder.create<LLVM::ExtractValueOp>(
+      loc, dispatchStateValue,
+      static_cast<int64_t>(DispatchStateField::workgroup_count_y));
+  builder.create<LLVM::BrOp>(
+      loc,
+      ValueRange{initialState,
+                 getStateField(initialState,
+                               WorkgroupStateField::workgroup_range_count)},
+      loopBlock);
+
+  // Execute the current workgroup and bail on failure.
+  builder.setInsertionPointToStart(loopBlock);
+  Value state = loopBlock->getArgument(0);
+  Value remaining = loopBlock->getArgument(1);
+  builder.create<LLVM::StoreOp>(loc, state, statePtr);
+  auto callOp = builder.create<LLVM::CallOp>(
+      loc, funcOp, ValueRange{environment, dispatchState, statePtr});
+  Value failed = builder.create<LLVM::ICmpOp>(loc, LLVM::ICmpPredicate::ne,
+                                              callOp.getResult(), zero);
+  builder.create<LLVM::CondBrOp>(loc, failed, exitBlock,
+                                 ValueRange{callOp.getResult()}, nextBlock,
+                                 ValueRange{});
+
+  builder.setInsertionPointToStart(nextBlock);
+  Value hasNext = builder.create<LLVM::ICmpOp>(loc, LLVM::ICmpPredicate::ugt,
+                                               remaining, one);
+  builder.create<LLVM::CondBrOp>(loc, hasNext, advanceBlock, ValueRange{},
+                                 exitBlock, ValueRange{zero});
+
+  // Advance the workgroup ID in x-fastest order.
+  builder.setInsertionPointToStart(advanceBlock);
+  Value nextX = builder.create<LLVM::AddOp>(
+      loc, getStateField(state, WorkgroupStateField::workgroup_id_x), one);
+  Value carryX = builder.create<LLVM::ICmpOp>(loc, LLVM::ICmpPredicate::eq,
+                                              nextX, workgroupCountX);
+  nextX = builder.create<LLVM::SelectOp>(loc, carryX, zero, nextX);
+  Value nextY = builder.create<LLVM::AddOp>(
+      loc, getStateField(state, WorkgroupStateField::workgroup_id_y),
+      builder.create<LLVM::ZExtOp>(loc, int32Type, carryX));
+  Value carryY = builder.create<LLVM::AndOp>(
+      loc, carryX,
+      builder.create<LLVM::ICmpOp>(loc, LLVM::ICmpPredicate::eq, nextY,
+                                   workgroupCountY));
+  nextY = builder.create<LLVM::SelectOp>(loc, carryY, zero, nextY);
+  Value nextZ = builder.create<LLVM::AddOp>(
+      loc, getStateField(state, WorkgroupStateField::workgroup_id_z),
+      builder.create<LLVM::ZExtOp>(loc, int16Type, carryY));
+  Value nextState = state;
+  nextState = builder.create<LLVM::InsertValueOp>(
+      loc, nextState, nextX,
+      static_cast<int64_t>(WorkgroupStateField::workgroup_id_x));
+  nextState = builder.create<LLVM::InsertValueOp>(
+      loc, nextState, nextY,
+      static_cast<int64_t>(WorkgroupStateField::workgroup_id_y));
+  nextState = builder.create<LLVM::InsertValueOp>(
+      loc, nextState, nextZ,
+      static_cast<int64_t>(WorkgroupStateField::workgroup_id_z));
+  builder.create<LLVM::BrOp>(
+      loc,
+      ValueRange{nextState, builder.create<LLVM::SubOp>(loc, remaining, one)},
+      loopBlock);
+
+  builder.setInsertionPointToStart(exitBlock);
+  builder.create<LLVM::ReturnOp>(loc, exitBlock->getArgument(0));
+
+  return rangeFuncOp;
+}
+
 // Returns the most local DISubprogramAttr starting from |forOp|.
 static LLVM::DISubprogramAttr getLocalScopeAttr(Operation *forOp) {
   auto funcOp = forOp->getParentOfType<LLVM::LLVMFuncOp>();
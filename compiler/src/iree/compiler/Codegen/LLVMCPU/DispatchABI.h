@@ -182,6 +182,7 @@ class HALDispatchABI {
     /*uint32_t*/ processor_id,
     /*intptr_t*/ local_memory,
     /*uint32_t*/ local_memory_size,
+    /*uint32_t*/ workgroup_range_count,
   };
   friend WorkgroupStateField operator+(WorkgroupStateField lhs, int32_t rhs) {
     return static_cast<WorkgroupStateField>(static_cast<int32_t>(lhs) + rhs);
@@ -206,6 +207,31 @@ class HALDispatchABI {
       mlir::ModuleOp moduleOp, StringRef funcName,
       LLVMTypeConverter *typeConverter);
 
+  // Wraps the exported dispatch function |funcOp| executing a single workgroup
+  // in one that executes the workgroup_range_count workgroups starting at the
+  // workgroup ID in x-fastest order. |funcOp| is renamed to an internal
+  // `<name>_workgroup` function that LLVM can inline into the loop:
+  //   int name(environment, dispatch_state, workgroup_state) {
+  //     iree_hal_executable_workgroup_state_v0_t state = *workgroup_state;
+  //     uint32_t remaining = state.workgroup_range_count;
+  //     do {
+  //       int ret = name_workgroup(environment, dispatch_state, &state);
+  //       if (ret) return ret;
+  //       if (++state.workgroup_id_x == dispatch_state->workgroup_count_x) {
+  //         state.workgroup_id_x = 0;
+  //         if (++state.workgroup_id_y == dispatch_state->workgroup_count_y) {
+  //           state.workgroup_id_y = 0;
+  //           ++state.workgroup_id_z;
+  //         }
+  //       }
+  //     } while (--remaining > 0);
+  //     return 0;
+  //   }
+  // A workgroup_range_count of 0 executes a single workgroup.
+  // Returns the new exported function.
+  static LLVM::LLVMFuncOp buildWorkgroupRangeLoop(
+      LLVM::LLVMFuncOp funcOp, LLVMTypeConverter *typeConverter);
+
   explicit HALDispatchABI(LLVMTypeConverter *typeConverter)
       : context(&typeConverter->getContext()),
         typeConverter(typeConverter),
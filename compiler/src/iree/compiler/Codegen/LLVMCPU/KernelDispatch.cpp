@@ -10,6 +10,7 @@
 
 #include "iree-dialects/Dialect/LinalgExt/IR/LinalgExtOps.h"
 #include "iree/compiler/Codegen/Common/LinalgOpInfo.h"
+#include "iree/compiler/Codegen/Common/TuningDatabase.h"
 #include "iree/compiler/Codegen/Common/UserConfig.h"
 #include "iree/compiler/Codegen/LLVMCPU/TargetMLTransformInfo.h"
 #include "iree/compiler/Codegen/TransformDialectStrategies/CPU/Common.h"
@@ -890,6 +891,33 @@ static SmallVector<int64_t> getMatmulWorkgroupSizes(func::FuncOp entryPointFn,
   return tileSizes;
 }
 
+/// Returns true if an input of |op| is dequantized within the dispatch, that is
+/// produced by an elementwise op converting integers to floats.
+static bool hasDequantizedInput(linalg::LinalgOp op) {
+  return llvm::any_of(op.getDpsInputOperands(), [](OpOperand *operand) {
+    auto producer = operand->get().getDefiningOp<linalg::GenericOp>();
+    if (!producer || producer.getNumReductionLoops() != 0) return false;
+    if (!getElementTypeOrSelf(operand->get().getType()).isa<FloatType>()) {
+      return false;
+    }
+    return llvm::any_of(producer.getDpsInputOperands(), [](OpOperand *input) {
+      return getElementTypeOrSelf(input->get().getType()).isa<IntegerType>();
+    });
+  });
+}
+
+/// Returns true if the outermost loop of |op| is parallel and indexes all of
+/// its operands, i.e. it is a batch dimension.
+static bool isOuterBatchDim(linalg::LinalgOp op) {
+  if (!linalg::isParallelIterator(op.getIteratorTypesArray().front())) {
+    return false;
+  }
+  AffineExpr batchDim = getAffineDimExpr(0, op.getContext());
+  return llvm::all_of(op.getIndexingMapsArray(), [&](AffineMap map) {
+    return llvm::is_contained(map.getResults(), batchDim);
+  });
+}
+
 /// Sets the lowering configuration for dispatch region with root op that
 /// implements the contraction operation interface.
 static LogicalResult setRootConfig(
@@ -929,7 +957,11 @@ static LogicalResult setRootConfig(
     defaultMaxSize = 128;
   }
 
-  bool isBM = isa<linalg::BatchMatmulOp>(contractionOp.getOperation());
+  // Batch matmuls and matmuls whose reduction was split along a new outer
+  // parallel dimension (split-K) distribute one batch per workgroup so that
+  // the batch carries the parallelism of skinny shapes.
+  bool isBM = isa<linalg::BatchMatmulOp>(contractionOp.getOperation()) ||
+              (numLoops == 4 && isOuterBatchDim(linalgOp));
   SmallVector<int64_t> maxTileSizes(numLoops, defaultMaxSize);
   if (isBM) {
     maxTileSizes[0] = 1;
@@ -940,6 +972,13 @@ static LogicalResult setRootConfig(
   // scheduling, e.g., transform dialect.
   SmallVector<int64_t> flowTileSizes;
   auto preProcStrategy = getVectorPreProcStrategy(linalgOp);
+  // The padding pipeline tiles the reduction without fusing producers, which
+  // would materialize a whole workgroup tile of dequantized weights. The
+  // default pipeline fuses the dequantization into the innermost tiles.
+  if (preProcStrategy == VectorPreProcStrategy::Padding &&
+      hasDequantizedInput(linalgOp)) {
+    preProcStrategy = VectorPreProcStrategy::None;
+  }
   bool usePaddingPipeline = preProcStrategy == VectorPreProcStrategy::Padding;
 
   LLVM_DEBUG(KD_DBGS() << "Vector pre-processing strategy: " << preProcStrategy
@@ -1141,6 +1180,44 @@ static LogicalResult setRootConfig(
                                                pipeline);
 }
 
+/// Sets the lowering configuration for dispatch region for linalg_ext.attention
+/// root op. Each workgroup computes one block of queries of a single batch
+/// with an online softmax over key blocks of the same size (see
+/// TileAndDecomposeAttention), so only one block of scores is materialized at
+/// a time. The block must divide the sequence length; dynamic sequences are
+/// computed in a single block.
+static LogicalResult setRootConfig(
+    func::FuncOp entryPointFn, IREE::LinalgExt::AttentionOp attnOp,
+    DispatchLoweringPassPipeline pipeline =
+        DispatchLoweringPassPipeline::CPUDefault) {
+  int64_t sequenceLength = attnOp.getQueryType().getDimSize(1);
+  int64_t blockSize = 0;
+  if (!ShapedType::isDynamic(sequenceLength)) {
+    blockSize = std::min<int64_t>(defaultWorkgroupTileSize, sequenceLength);
+    while (sequenceLength % blockSize != 0) --blockSize;
+  }
+  TileSizesListType tileSizes = {{1, blockSize}};
+  return setOpConfigAndEntryPointFnTranslation(entryPointFn, attnOp, tileSizes,
+                                               pipeline);
+}
+
+/// Sets the lowering configuration for dispatch regions rooted on the input
+/// or output transform of a Winograd convolution. Each workgroup transforms
+/// all tiles of a block of channels of one image.
+static LogicalResult setWinogradRootConfig(func::FuncOp entryPointFn,
+                                           TilingInterface op) {
+  SmallVector<int64_t> workgroupTileSizes =
+      getLinalgExtDefaultWorkgroupTileSizes(op, defaultWorkgroupTileSize);
+  // The iteration domain of both transforms is (N, C).
+  if (workgroupTileSizes.size() != 2) return failure();
+  workgroupTileSizes[0] = 1;
+  workgroupTileSizes[1] = std::min<int64_t>(workgroupTileSizes[1], 32);
+  TileSizesListType tileSizes = {workgroupTileSizes};
+  return setOpConfigAndEntryPointFnTranslation(
+      entryPointFn, op, tileSizes,
+      DispatchLoweringPassPipeline::CPUWinogradVectorize);
+}
+
 static void setX86WorkgroupTileSizes(
     linalg::GenericOp genericOp, unsigned numLoops,
     ArrayRef<int64_t> flowTileSizes, ArrayRef<int64_t> minTileSizes,
@@ -1706,7 +1783,8 @@ static LogicalResult setRootConfigImpl(
           return setRootConfig(entryPointFn, op, LinalgOpInfo(op),
                                targetMLTransInfo);
         })
-        .Case<IREE::LinalgExt::FftOp, linalg::Mmt4DOp, linalg::Conv2DNhwcHwcfOp,
+        .Case<IREE::LinalgExt::AttentionOp, IREE::LinalgExt::FftOp,
+              linalg::Mmt4DOp, linalg::Conv2DNhwcHwcfOp,
               linalg::Conv2DNchwFchwOp, linalg::PoolingNhwcSumOp,
               linalg::PoolingNhwcMaxOp, linalg::PoolingNhwcMaxUnsignedOp,
               linalg::PoolingNhwcMinOp, linalg::PoolingNhwcMinUnsignedOp,
@@ -1717,6 +1795,9 @@ static LogicalResult setRootConfigImpl(
             [&](auto op) { return setPackOpRootConfig(entryPointFn, op); })
         .Case<IREE::LinalgExt::UnPackOp, tensor::UnPackOp>(
             [&](auto op) { return setUnPackOpRootConfig(entryPointFn, op); })
+        .Case<IREE::LinalgExt::WinogradInputTransformOp,
+              IREE::LinalgExt::WinogradOutputTransformOp>(
+            [&](auto op) { return setWinogradRootConfig(entryPointFn, op); })
         .Case<linalg::ContractionOpInterface>(
             [&](auto op) { return setRootConfig(entryPointFn, op); })
         .Case<linalg::LinalgOp>(
@@ -1841,6 +1922,22 @@ static LogicalResult setTranslationInfoAndRootConfig(
     }
   }
 
+  // Then check if a tuning database has a configuration for the root op.
+  if (!getTranslationInfo(entryPointFn)) {
+    FailureOr<std::optional<TunedConfig>> tunedConfig =
+        lookupTunedConfig(entryPointFn);
+    if (failed(tunedConfig)) return failure();
+    if (*tunedConfig && tunedConfig->value().compilationInfo) {
+      FailureOr<Operation *> rootOp = getRootOperation(computeOps);
+      if (failed(rootOp)) return failure();
+      if (*rootOp &&
+          failed(setUserConfig(entryPointFn, *rootOp,
+                               tunedConfig->value().compilationInfo))) {
+        return failure();
+      }
+    }
+  }
+
   // Next set the configuration of the operations.
   return setRootConfig(entryPointFn, computeOps);
 }
@@ -6,6 +6,7 @@
 
 #include "iree-dialects/Dialect/LinalgExt/IR/LinalgExtDialect.h"
 #include "iree-dialects/Dialect/LinalgTransform/LinalgTransformOps.h"
+#include "iree/compiler/Codegen/Common/TuningDatabase.h"
 #include "iree/compiler/Codegen/Dialect/IREECodegenDialect.h"
 #include "iree/compiler/Codegen/LLVMCPU/KernelDispatch.h"
 #include "iree/compiler/Codegen/PassDetail.h"
@@ -187,6 +188,16 @@ void LLVMCPULowerExecutableTargetPass::runOnOperation() {
       auto target = variantOp.getTarget();
       bool lowerToAVX2 = hasAVX2Feature(target);
       bool enableMicrokernels = hasMicrokernels(target);
+      // A tuning database may decide microkernel use per dispatch; the
+      // pipeline is shared by the whole variant so any entry applies to it.
+      for (auto funcOp : moduleOp.getOps<func::FuncOp>()) {
+        FailureOr<std::optional<TunedConfig>> tunedConfig =
+            lookupTunedConfig(funcOp);
+        if (failed(tunedConfig)) return signalPassFailure();
+        if (*tunedConfig && tunedConfig->value().ukernels) {
+          enableMicrokernels = *tunedConfig->value().ukernels;
+        }
+      }
       if (!testLoweringConfiguration) {
         switch (translationInfo.value().getDispatchLoweringPassPipeline()) {
           case IREE::Codegen::DispatchLoweringPassPipeline::CPUDefault:
@@ -233,6 +244,10 @@ void LLVMCPULowerExecutableTargetPass::runOnOperation() {
           case IREE::Codegen::DispatchLoweringPassPipeline::CPUDataTiling:
             addCPUDataTilingPipeline(executableLoweringPipeline);
             break;
+          case IREE::Codegen::DispatchLoweringPassPipeline::
+              CPUWinogradVectorize:
+            addCPUWinogradVectorizePassPipeline(executableLoweringPipeline);
+            break;
           case IREE::Codegen::DispatchLoweringPassPipeline::VMVXDefault:
             addVMVXDefaultPassPipeline(executableLoweringPipeline,
                                        enableMicrokernels);
@@ -71,6 +71,15 @@ static FailureOr<IREE::Codegen::UKernelOpInterface> matchDAGForUKernel(
     case MatmulType::F32F32F32:
       fnName = "vmvx.matmul.f32.f32.f32";
       break;
+    case MatmulType::F16F16F32:
+      fnName = "vmvx.matmul.f16.f16.f32";
+      break;
+    case MatmulType::F16F16F16:
+      fnName = "vmvx.matmul.f16.f16.f16";
+      break;
+    case MatmulType::BF16BF16F32:
+      fnName = "vmvx.matmul.bf16.bf16.f32";
+      break;
   }
 
   // check if the result has to be accumulated into a buffer.
@@ -42,6 +42,16 @@ static MatmulTileParams chooseMatmulTileParamsAArch64(
         return {8, 4, 8};
       }
       return {8, 1, 8};
+    case MatmulType::F16F16F32:
+    case MatmulType::F16F16F16:
+      // Aim to use FMLAL/FMLAL2 for f16f16f32 and FMLA (f16) for f16f16f16.
+      return {8, 1, 8};
+    case MatmulType::BF16BF16F32:
+      if (hasFeature(target, "+bf16")) {
+        // Aim to use BFMMLA.
+        return {8, 4, 8};
+      }
+      return {8, 1, 8};
     default:
       assert(false);
       return {};
@@ -77,6 +87,18 @@ static MatmulTileParams chooseMatmulTileParamsX86_64(
       }
       // SSE fallback. Aim to use PMADDWD (xmm).
       return {8, 2, 4};
+    case MatmulType::F16F16F32:
+    case MatmulType::F16F16F16:
+      // f16 operands are converted to f32, so use the f32 layout.
+      if (hasFeature(target, "+avx512f")) return {16, 1, 16};
+      return {8, 1, 8};
+    case MatmulType::BF16BF16F32:
+      if (hasFeature(target, "+avx512bf16")) {
+        // Aim to use VDPBF16PS.
+        return {16, 2, 16};
+      }
+      if (hasFeature(target, "+avx512f")) return {16, 1, 16};
+      return {8, 1, 8};
     default:
       assert(false);
       return {};
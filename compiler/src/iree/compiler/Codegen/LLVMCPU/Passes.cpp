@@ -670,6 +670,31 @@ void addCPUDataTilingPipeline(OpPassManager &passManager) {
       createSplitFullPartialTransferPass("linalg-copy"));
 }
 
+void addCPUWinogradVectorizePassPipeline(OpPassManager &passManager) {
+  // The transforms are tiled and decomposed along with the distribution to
+  // workgroups, leaving matmuls of static tile sizes in the loops over tiles.
+  addTileAndDistributePasses(passManager);
+  OpPassManager &nestedModulePM = passManager.nest<ModuleOp>();
+  nestedModulePM.addPass(memref::createResolveShapedTypeResultDimsPass());
+  nestedModulePM.addPass(createCanonicalizerPass());
+  nestedModulePM.addPass(createCSEPass());
+  nestedModulePM.addNestedPass<func::FuncOp>(createGPUVectorizationPass());
+  nestedModulePM.addNestedPass<func::FuncOp>(createForOpCanonicalizationPass());
+  nestedModulePM.addPass(createCanonicalizerPass());
+  nestedModulePM.addPass(createCSEPass());
+
+  addBufferizePasses(nestedModulePM);
+
+  nestedModulePM.addNestedPass<func::FuncOp>(
+      createRemoveSingleIterationLoopPass());
+  {
+    OpPassManager &nestedFuncPassManager = nestedModulePM.nest<func::FuncOp>();
+    LinalgCPUVectorLoweringPassOptions options;
+    options.splitVectorTransfersTo = "linalg-copy";
+    addLowerToVectorTransforms(nestedFuncPassManager, options);
+  }
+}
+
 void addCPUDefaultPassPipeline(OpPassManager &passManager) {
   addTileAndDistributePasses(passManager);
   OpPassManager &nestedModulePM = passManager.nest<ModuleOp>();
@@ -0,0 +1,68 @@
+// RUN: iree-opt --split-input-file --pass-pipeline='builtin.module(hal.executable(hal.executable.variant(builtin.module(iree-convert-to-llvm))))' %s | FileCheck %s
+
+#pipeline_layout = #hal.pipeline.layout<push_constants = 0, sets = [
+  #hal.descriptor_set.layout<0, bindings = [
+    #hal.descriptor_set.binding<0, storage_buffer>
+  ]>
+]>
+#executable_target_embedded_elf_x86_64_ = #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64", {
+  data_layout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128",
+  native_vector_size = 16 : index,
+  target_triple = "x86_64-unknown-unknown-eabi-elf",
+  workgroup_ranges = true
+}>
+hal.executable private @workgroup_ranges {
+  hal.executable.variant public @embedded_elf_x86_64, target = #executable_target_embedded_elf_x86_64_ {
+    hal.executable.export public @workgroup_ranges ordinal(0) layout(#pipeline_layout)
+    builtin.module {
+      func.func @workgroup_ranges() {
+        %c0 = arith.constant 0 : index
+        %c1 = arith.constant 1.0 : f32
+        %0 = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) alignment(64) offset(%c0) : memref<?xf32>
+        %1 = hal.interface.workgroup.id[0] : index
+        memref.store %c1, %0[%1] : memref<?xf32>
+        return
+      }
+    }
+  }
+}
+
+// The workgroup body is moved to an internal function.
+//      CHECK: llvm.func internal @workgroup_ranges_workgroup(
+//      CHECK:   llvm.extractvalue %{{.+}}[0] : !llvm.struct<"iree_hal_executable_workgroup_state_v0_t"
+
+// The export loops over the range in the workgroup state.
+//      CHECK: llvm.func @workgroup_ranges(
+// CHECK-SAME:     %[[ENVIRONMENT:[a-zA-Z0-9]+]]: !llvm.ptr<struct<"iree_hal_executable_environment_v0_t", {{[^\{]+}}>> {llvm.align = 16 : i64, llvm.noalias},
+// CHECK-SAME:     %[[DISPATCH_STATE:[a-zA-Z0-9]+]]: !llvm.ptr<struct<"iree_hal_executable_dispatch_state_v0_t", {{[^\{]+}}>> {llvm.align = 16 : i64, llvm.noalias},
+// CHECK-SAME:     %[[WORKGROUP_STATE:[a-zA-Z0-9]+]]: !llvm.ptr<struct<"iree_hal_executable_workgroup_state_v0_t", {{[^\{]+}}>> {llvm.align = 16 : i64, llvm.noalias}) -> i32
+//      CHECK:   %[[ZERO:.+]] = llvm.mlir.constant(0 : i32) : i32
+//      CHECK:   %[[ONE:.+]] = llvm.mlir.constant(1 : i32) : i32
+//      CHECK:   %[[STATE_PTR:.+]] = llvm.alloca %[[ONE]] x !llvm.struct<"iree_hal_executable_workgroup_state_v0_t"
+//      CHECK:   %[[INITIAL_STATE:.+]] = llvm.load %[[WORKGROUP_STATE]]
+//      CHECK:   %[[DISPATCH:.+]] = llvm.load %[[DISPATCH_STATE]]
+//      CHECK:   %[[COUNT_X:.+]] = llvm.extractvalue %[[DISPATCH]][4]
+//      CHECK:   %[[COUNT_Y:.+]] = llvm.extractvalue %[[DISPATCH]][5]
+//      CHECK:   %[[RANGE_COUNT:.+]] = llvm.extractvalue %[[INITIAL_STATE]][7]
+//      CHECK:   llvm.br ^[[LOOP:.+]](%[[INITIAL_STATE]], %[[RANGE_COUNT]]
+//      CHECK: ^[[LOOP]](%[[STATE:.+]]: !llvm.struct<"iree_hal_executable_workgroup_state_v0_t"{{.+}}>, %[[REMAINING:.+]]: i32):
+//      CHECK:   llvm.store %[[STATE]], %[[STATE_PTR]]
+//      CHECK:   %[[RET:.+]] = llvm.call @workgroup_ranges_workgroup(%[[ENVIRONMENT]], %[[DISPATCH_STATE]], %[[STATE_PTR]])
+//      CHECK:   %[[FAILED:.+]] = llvm.icmp "ne" %[[RET]], %[[ZERO]]
+//      CHECK:   llvm.cond_br %[[FAILED]], ^[[EXIT:.+]](%[[RET]] : i32), ^[[NEXT:.+]]
+//      CHECK: ^[[NEXT]]:
+//      CHECK:   %[[HAS_NEXT:.+]] = llvm.icmp "ugt" %[[REMAINING]], %[[ONE]]
+//      CHECK:   llvm.cond_br %[[HAS_NEXT]], ^[[ADVANCE:.+]], ^[[EXIT]](%[[ZERO]] : i32)
+//      CHECK: ^[[ADVANCE]]:
+//      CHECK:   %[[X:.+]] = llvm.extractvalue %[[STATE]][0]
+//      CHECK:   %[[X1:.+]] = llvm.add %[[X]], %[[ONE]]
+//      CHECK:   %[[CARRY_X:.+]] = llvm.icmp "eq" %[[X1]], %[[COUNT_X]]
+//      CHECK:   llvm.select %[[CARRY_X]], %[[ZERO]], %[[X1]]
+//      CHECK:   llvm.icmp "eq" %{{.+}}, %[[COUNT_Y]]
+//      CHECK:   llvm.insertvalue %{{.+}}, %[[STATE]][0]
+//      CHECK:   llvm.insertvalue
+//      CHECK:   llvm.insertvalue
+//      CHECK:   %[[REMAINING1:.+]] = llvm.sub %[[REMAINING]], %[[ONE]]
+//      CHECK:   llvm.br ^[[LOOP]](%{{.+}}, %[[REMAINING1]]
+//      CHECK: ^[[EXIT]](%[[RESULT:.+]]: i32):
+//      CHECK:   llvm.return %[[RESULT]] : i32
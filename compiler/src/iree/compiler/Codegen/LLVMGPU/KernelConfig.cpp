@@ -362,6 +362,26 @@ static LogicalResult setFftConfig(func::FuncOp entryPoint,
       workgroupSize);
 }
 
+/// Each workgroup computes one block of queries of a single batch with an
+/// online softmax over key blocks of the same size (see
+/// TileAndDecomposeAttention). The block must divide the sequence length;
+/// dynamic sequences are computed in a single block.
+static LogicalResult setAttentionConfig(func::FuncOp entryPoint,
+                                        IREE::LinalgExt::AttentionOp op) {
+  int64_t sequenceLength = op.getQueryType().getDimSize(1);
+  int64_t blockSize = 0;
+  if (!ShapedType::isDynamic(sequenceLength)) {
+    blockSize = std::min<int64_t>(cudaWarpSize, sequenceLength);
+    while (sequenceLength % blockSize != 0) --blockSize;
+  }
+  TileSizesListType tileSizes = {{1, blockSize}};
+  SmallVector<int64_t, 3> workgroupSize = {cudaWarpSize, 1, 1};
+  return setOpConfigAndEntryPointFnTranslation(
+      entryPoint, op, tileSizes,
+      IREE::Codegen::DispatchLoweringPassPipeline::LLVMGPUDistribute,
+      workgroupSize);
+}
+
 static LogicalResult setSortConfig(func::FuncOp entryPoint, Operation *op) {
   TileSizesListType tileSizes;
   auto interfaceOp = cast<PartitionableLoopsInterface>(*op);
@@ -540,6 +560,12 @@ static LogicalResult setReductionTransformDialectConfig(
     return setTranslationInfo(entryPoint, translationInfo);
   }
 
+  // Softmax-like row normalizations chain several reductions and are matched
+  // as a whole before the single reduction strategies.
+  if (succeeded(iree_compiler::gpu::matchAndSetSoftmaxStrategy(entryPoint))) {
+    return setTranslationInfo(entryPoint, translationInfo);
+  }
+
   iree_compiler::gpu::GPUModel gpuModel;
   if (failed(iree_compiler::gpu::matchAndSetReductionStrategy(entryPoint, op,
                                                               gpuModel)))
@@ -905,6 +931,9 @@ static LogicalResult setRootConfig(func::FuncOp entryPointFn,
     llvm::outs() << "setFftConfig\n";
     return setFftConfig(entryPointFn, fftOp);
   }
+  if (auto attnOp = dyn_cast<IREE::LinalgExt::AttentionOp>(computeOp)) {
+    return setAttentionConfig(entryPointFn, attnOp);
+  }
   if (auto sortOp = dyn_cast<IREE::LinalgExt::SortOp>(computeOp)) {
     llvm::outs() << "setSortConfig\n";
     return setSortConfig(entryPointFn, sortOp);
@@ -231,6 +231,9 @@ struct LLVMGPUTileAndDistributePass
                                               std::move(promotionPatterns)))) {
         return signalPassFailure();
       }
+      // Compute fused elementwise producers of the operands tile by tile
+      // straight into shared memory.
+      fuseProducersIntoSharedMemoryCopy(funcOp);
       // Insert barriers before and after copies to workgroup memory.
       insertBarriersAroundSharedMemoryCopy(funcOp);
     }
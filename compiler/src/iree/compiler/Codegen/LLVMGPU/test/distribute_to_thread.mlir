@@ -439,3 +439,93 @@ hal.executable private @contract_4d  {
 
 // Check that we are able to distribute correctly
 // CHECK-LABEL: func.func @contract_4d
+
+// -----
+
+#config = #iree_codegen.lowering_config<tile_sizes = [[2, 256, 4]]>
+#translation = #iree_codegen.translation_info<LLVMGPUMatmulSimt>
+#executable_target_cuda_nvptx_fb = #hal.executable.target<"cuda", "cuda-nvptx-fb">
+#pipeline_layout = #hal.pipeline.layout<push_constants = 0, sets = [
+  #hal.descriptor_set.layout<0, bindings = [
+    #hal.descriptor_set.binding<0, storage_buffer>,
+    #hal.descriptor_set.binding<1, storage_buffer>,
+    #hal.descriptor_set.binding<2, storage_buffer>,
+    #hal.descriptor_set.binding<3, storage_buffer>
+  ]>
+]>
+#map0 = affine_map<()[s0] -> (s0 * 2)>
+#map1 = affine_map<()[s0] -> (s0 * 256)>
+#map4 = affine_map<(d0, d1)[s0] -> (d0 * 1024 + s0 + d1)>
+#map5 = affine_map<(d0, d1) -> (d0, d1)>
+#map6 = affine_map<(d0, d1) -> (d1)>
+hal.executable private @scaled_dot_dispatch_0  {
+  hal.executable.variant @cuda, target = #executable_target_cuda_nvptx_fb {
+    hal.executable.export @scaled_dot_dispatch_0 layout(#pipeline_layout) attributes {
+      translation_info = #translation,
+      workgroup_size = [64 : index, 1 : index, 1 : index]
+    }
+    builtin.module {
+      func.func @scaled_dot_dispatch_0() {
+        %cst = arith.constant 0.000000e+00 : f32
+        %c0 = arith.constant 0 : index
+        %c1024 = arith.constant 1024 : index
+        %0 = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) : memref<1024x1024xf32>
+        %1 = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) : memref<1024xf32>
+        %2 = hal.interface.binding.subspan set(0) binding(2) type(storage_buffer) : memref<1024x1024xf32>
+        %3 = hal.interface.binding.subspan set(0) binding(3) type(storage_buffer) : memref<1024x1024xf32>
+        %workgroup_id_x = hal.interface.workgroup.id[0] : index
+        %workgroup_count_x = hal.interface.workgroup.count[0] : index
+        %workgroup_id_y = hal.interface.workgroup.id[1] : index
+        %workgroup_count_y = hal.interface.workgroup.count[1] : index
+        %4 = affine.apply #map0()[%workgroup_id_y]
+        %5 = affine.apply #map0()[%workgroup_count_y]
+        scf.for %arg0 = %4 to %c1024 step %5 {
+          %6 = affine.apply #map1()[%workgroup_id_x]
+          %7 = affine.apply #map1()[%workgroup_count_x]
+          scf.for %arg1 = %6 to %c1024 step %7 {
+            %8 = memref.subview %0[%arg0, 0] [2, 1024] [1, 1]
+                : memref<1024x1024xf32> to memref<2x1024xf32, #map4>
+            %scaled = memref.alloc() : memref<2x1024xf32>
+            linalg.generic {indexing_maps = [#map5, #map6, #map5], iterator_types = ["parallel", "parallel"]}
+                ins(%8, %1 : memref<2x1024xf32, #map4>, memref<1024xf32>)
+                outs(%scaled : memref<2x1024xf32>) {
+            ^bb0(%in: f32, %scale: f32, %out: f32):
+              %12 = arith.mulf %in, %scale : f32
+              linalg.yield %12 : f32
+            }
+            %10 = memref.subview %2[0, %arg1] [1024, 256] [1, 1]
+                : memref<1024x1024xf32> to memref<1024x256xf32, #map4>
+            %11 = memref.subview %3[%arg0, %arg1] [2, 256] [1, 1]
+                : memref<1024x1024xf32> to memref<2x256xf32, #map4>
+            linalg.fill {lowering_config = #config} ins(%cst : f32) outs(%11 : memref<2x256xf32, #map4>)
+            linalg.matmul {lowering_config = #config}
+                ins(%scaled, %10 : memref<2x1024xf32>, memref<1024x256xf32, #map4>)
+                outs(%11 : memref<2x256xf32, #map4>)
+          }
+        }
+        return
+      }
+    }
+  }
+}
+
+// The elementwise producer of the LHS computes each K tile straight into
+// shared memory instead of materializing the whole workgroup tile.
+//   CHECK-LABEL: hal.executable private @scaled_dot_dispatch_0
+//     CHECK-DAG:  %[[C4:.+]] = arith.constant 4 : index
+//     CHECK-DAG:  %[[SCALE:.+]] = hal.interface.binding.subspan set(0) binding(1)
+//     CHECK-DAG:  %[[BUFFER1:.+]] = memref.alloc() : memref<2x4xf32, #gpu.address_space<workgroup>>
+//     CHECK-NOT:  memref.alloc() : memref<2x1024xf32>
+//         CHECK:  scf.for %[[K:.+]] = %{{.+}} to %{{.+}} step %[[C4]] {
+//     CHECK-DAG:    %[[IN:.+]] = memref.subview %{{.+}}[0, %[[K]]] [2, 4] [1, 1]
+//     CHECK-DAG:    %[[SCALE_TILE:.+]] = memref.subview %[[SCALE]][%[[K]]] [4] [1]
+//         CHECK:    gpu.barrier
+//         CHECK:    linalg.generic
+//    CHECK-SAME:        __internal_linalg_transform__ = "copy_to_workgroup_memory"
+//    CHECK-SAME:        ins(%[[IN]], %[[SCALE_TILE]]
+//    CHECK-SAME:        outs(%[[BUFFER1]]
+//         CHECK:      arith.mulf
+//     CHECK-NOT:    gpu.barrier
+//         CHECK:    memref.copy {{.*}}, {{.*}} {__internal_linalg_transform__ = "copy_to_workgroup_memory"} : memref<4x256xf32, strided<[1024, 1], offset: ?>> to memref<4x256xf32, #gpu.address_space<workgroup>>
+//         CHECK:    gpu.barrier
+//         CHECK:    linalg.matmul
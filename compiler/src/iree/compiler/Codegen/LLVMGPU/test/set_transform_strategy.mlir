@@ -235,3 +235,72 @@ hal.executable.variant public @cuda_nvptx_fb, target = <"cuda", "cuda-nvptx-fb",
 //         CHECK:   transform.structured.tile_to_forall_op %{{.*}}   num_threads [0, 1024] tile_sizes [](mapping = [#gpu.thread<x>])
 //         CHECK:   transform.iree.map_nested_forall_to_gpu_threads %{{.*}} {workgroup_size = [1024, 1, 1]}
 //         CHECK:   transform.iree.vector.to_warp_execute_on_lane_0{{.*}}{warp_size = 1024 : i64}
+
+// -----
+
+hal.executable @softmax {
+hal.executable.variant public @cuda_nvptx_fb, target = <"cuda", "cuda-nvptx-fb", {target_arch = "sm_35"}> {
+  hal.executable.export public @softmax ordinal(0) layout(#hal.pipeline.layout<push_constants = 0, sets = [<0, bindings = [<0, storage_buffer, ReadOnly>, <1, storage_buffer>]>]>) {
+  ^bb0(%arg0: !hal.device, %arg1: index, %arg2: index):
+    %x, %y, %z = flow.dispatch.workgroup_count_from_dag_root %arg1, %arg2
+    hal.return %x, %y, %z : index, index, index
+  }
+  builtin.module {
+    func.func @softmax() {
+      %c0 = arith.constant 0 : index
+      %cst = arith.constant -3.40282347E+38 : f32
+      %cst_0 = arith.constant 0.000000e+00 : f32
+      %0 = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) alignment(64) offset(%c0) : !flow.dispatch.tensor<readonly:tensor<16x128x256xf32>>
+      %1 = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) alignment(64) offset(%c0) : !flow.dispatch.tensor<writeonly:tensor<16x128x256xf32>>
+      %2 = flow.dispatch.tensor.load %0, offsets = [0, 0, 0], sizes = [16, 128, 256], strides = [1, 1, 1] : !flow.dispatch.tensor<readonly:tensor<16x128x256xf32>> -> tensor<16x128x256xf32>
+      %3 = tensor.empty() : tensor<16x128xf32>
+      %4 = tensor.empty() : tensor<16x128x256xf32>
+      %5 = linalg.fill ins(%cst : f32) outs(%3 : tensor<16x128xf32>) -> tensor<16x128xf32>
+      %6 = linalg.generic {indexing_maps = [affine_map<(d0, d1, d2) -> (d0, d1, d2)>, affine_map<(d0, d1, d2) -> (d0, d1)>], iterator_types = ["parallel", "parallel", "reduction"]} ins(%2 : tensor<16x128x256xf32>) outs(%5 : tensor<16x128xf32>) {
+      ^bb0(%in: f32, %out: f32):
+        %11 = arith.maxf %in, %out : f32
+        linalg.yield %11 : f32
+      } -> tensor<16x128xf32>
+      %7 = linalg.fill ins(%cst_0 : f32) outs(%3 : tensor<16x128xf32>) -> tensor<16x128xf32>
+      %8 = linalg.generic {indexing_maps = [affine_map<(d0, d1, d2) -> (d0, d1, d2)>, affine_map<(d0, d1, d2) -> (d0, d1)>, affine_map<(d0, d1, d2) -> (d0, d1)>], iterator_types = ["parallel", "parallel", "reduction"]} ins(%2, %6 : tensor<16x128x256xf32>, tensor<16x128xf32>) outs(%7 : tensor<16x128xf32>) {
+      ^bb0(%in: f32, %in_1: f32, %out: f32):
+        %11 = arith.subf %in, %in_1 : f32
+        %12 = math.exp %11 : f32
+        %13 = arith.addf %12, %out : f32
+        linalg.yield %13 : f32
+      } -> tensor<16x128xf32>
+      %9 = linalg.generic {indexing_maps = [affine_map<(d0, d1, d2) -> (d0, d1, d2)>, affine_map<(d0, d1, d2) -> (d0, d1)>, affine_map<(d0, d1, d2) -> (d0, d1)>, affine_map<(d0, d1, d2) -> (d0, d1, d2)>], iterator_types = ["parallel", "parallel", "parallel"]} ins(%2, %6, %8 : tensor<16x128x256xf32>, tensor<16x128xf32>, tensor<16x128xf32>) outs(%4 : tensor<16x128x256xf32>) {
+      ^bb0(%in: f32, %in_1: f32, %in_2: f32, %out: f32):
+        %11 = arith.subf %in, %in_1 : f32
+        %12 = math.exp %11 : f32
+        %13 = arith.divf %12, %in_2 : f32
+        linalg.yield %13 : f32
+      } -> tensor<16x128x256xf32>
+      flow.dispatch.tensor.store %9, %1, offsets = [0, 0, 0], sizes = [16, 128, 256], strides = [1, 1, 1] : tensor<16x128x256xf32> -> !flow.dispatch.tensor<writeonly:tensor<16x128x256xf32>>
+      return
+    }
+  }
+}
+}
+
+// Each block processes 4 rows of 256 elements, one per warp, with 8 elements
+// per lane.
+
+//   CHECK-LABEL: func.func @softmax
+//         CHECK:   transform.structured.canonicalized_sequence failures(propagate)
+//         CHECK:   transform.split_handles %{{.*}} in [5]
+//         CHECK:   transform.iree.tile_to_forall_and_workgroup_count_region %{{.*}} num_threads [] tile_sizes [1, 4](mapping = [#gpu.block<x>, #gpu.block<y>])
+// CHECK-COUNT-4:   transform.structured.fuse_into_containing_op
+//         CHECK:   transform.iree.share_forall_operands
+//         CHECK:   transform.split_handles %{{.*}} in [5]
+//         CHECK:   transform.merge_handles
+//         CHECK:   transform.structured.tile_to_forall_op %{{.*}}   num_threads [] tile_sizes [0, 1](mapping = [#gpu.thread<y>])
+//         CHECK:   transform.merge_handles
+//         CHECK:   transform.structured.tile_to_forall_op %{{.*}}   num_threads [0, 4] tile_sizes [](mapping = [#gpu.thread<y>])
+//         CHECK:   transform.structured.tile_to_forall_op %{{.*}}   num_threads [0, 4, 32] tile_sizes [](mapping = [#gpu.thread<y>, #gpu.thread<x>])
+//         CHECK:   transform.iree.apply_patterns %{{.*}} {rank_reducing_linalg, rank_reducing_vector}
+//         CHECK:   transform.structured.vectorize
+//         CHECK:   transform.iree.bufferize {target_gpu}
+//         CHECK:   transform.iree.map_nested_forall_to_gpu_threads %{{.*}} {workgroup_size = [32, 4, 1]}
+//         CHECK:   transform.iree.vector.to_warp_execute_on_lane_0 %{{.*}} {warp_size = 32 : i64}
+//         CHECK:   transform.iree.vector.warp_distribute
@@ -11,12 +11,14 @@
 //===----------------------------------------------------------------------===//
 
 #include <tuple>
-#include <iostream>
+#include <map>
 
+#include "iree-dialects/Dialect/LinalgExt/IR/LinalgExtOps.h"
 #include "iree/compiler/Codegen/Dialect/LoweringConfig.h"
 #include "iree/compiler/Codegen/PassDetail.h"
 #include "iree/compiler/Codegen/Passes.h"
 #include "iree/compiler/Codegen/Utils/MarkerUtils.h"
+#include "iree/compiler/Codegen/Utils/Utils.h"
 #include "iree/compiler/Dialect/HAL/IR/HALOps.h"
 #include "iree/compiler/Dialect/Util/IR/UtilOps.h"
 #include "iree/compiler/Dialect/Flow/IR/FlowDialect.h"
@@ -30,6 +32,7 @@
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/Debug.h"
 #include "mlir/Dialect/Arith/Transforms/Passes.h"
 #include "mlir/Dialect/Arith/Utils/Utils.h"
 #include "mlir/Dialect/Bufferization/IR/Bufferization.h"
@@ -38,6 +41,7 @@
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Math/Transforms/Passes.h"
 #include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "mlir/Dialect/Vector/IR/VectorOps.h"
 #include "mlir/Dialect/Math/IR/Math.h"
 #include "mlir/IR/Builders.h"
@@ -50,8 +54,8 @@
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
-#include "json/json.h"
-#include <fstream>
+
+#define DEBUG_TYPE "iree-convert-to-pim"
 
 using namespace std;
 
@@ -63,6 +67,121 @@ namespace {
 // Resource utilities
 //===----------------------------------------------------------------------===//
 
+// Operand slot of the result of each stage of a fused decoder block or
+// std::nullopt if it has no data on the device. Non-negative slots are binding
+// ordinals and slot -1 - i is the resident result of instruction i.
+using StageSlotMap = std::map<int64_t, Optional<int32_t>>;
+
+// Resolves the operand slot |value| is read from by an op in |stage|. Values
+// produced within the stage itself (and values that carry no data such as
+// tensor.empty) have no slot.
+static Optional<int32_t> resolveOperandSlot(
+    Value value, const DenseMap<Operation *, int64_t> &stageOf,
+    const StageSlotMap &stageSlots, int64_t stage) {
+  while (Operation *defOp = value.getDefiningOp()) {
+    if (auto loadOp = dyn_cast<IREE::Flow::DispatchTensorLoadOp>(defOp)) {
+      auto subspanOp = loadOp.getSource()
+                           .getDefiningOp<IREE::HAL::InterfaceBindingSubspanOp>();
+      if (!subspanOp) return std::nullopt;
+      return static_cast<int32_t>(subspanOp.getBinding().getSExtValue());
+    }
+    auto stageIt = stageOf.find(defOp);
+    if (stageIt != stageOf.end()) {
+      if (stageIt->second == stage) return std::nullopt;
+      auto slotIt = stageSlots.find(stageIt->second);
+      if (slotIt == stageSlots.end()) return std::nullopt;
+      return slotIt->second;
+    }
+    // Reshapes and slices read the same data.
+    if (isa<tensor::ExpandShapeOp, tensor::CollapseShapeOp,
+            tensor::ExtractSliceOp, tensor::CastOp>(defOp)) {
+      value = defOp->getOperand(0);
+      continue;
+    }
+    return std::nullopt;
+  }
+  return std::nullopt;
+}
+
+// Returns the string entry |name| of the PIM |partition| or an empty string.
+static string getPartitionString(DictionaryAttr partition, StringRef name) {
+  if (!partition) return "";
+  auto value = partition.getAs<StringAttr>(name);
+  return value ? value.getValue().str() : "";
+}
+
+// Returns the binding ordinal the results of |ops| are stored to, if any.
+static Optional<int32_t> getStoredBindingOrdinal(ArrayRef<Operation *> ops) {
+  for (Operation *op : ops) {
+    for (Operation *user : op->getUsers()) {
+      auto storeOp = dyn_cast<IREE::Flow::DispatchTensorStoreOp>(user);
+      if (!storeOp) continue;
+      auto subspanOp = storeOp.getTarget()
+                           .getDefiningOp<IREE::HAL::InterfaceBindingSubspanOp>();
+      if (subspanOp) {
+        return static_cast<int32_t>(subspanOp.getBinding().getSExtValue());
+      }
+    }
+  }
+  return std::nullopt;
+}
+
+// Returns the element type names of the PIM instruction encoding (see
+// getPIMElementType).
+static StringRef getPIMElementTypeName(int64_t elementType) {
+  switch (elementType) {
+    case 1: return "f16";
+    case 2: return "bf16";
+    case 3: return "i8";
+    default: return "f32";
+  }
+}
+
+// Returns true if the devices |targetAttr| is specialized for compute in the
+// element type of every PIM instruction of |moduleOp|. Targets without an
+// `element_types` list (see --iree-pim-element-types) support all of them.
+static bool hasSupportedElementTypes(ModuleOp moduleOp,
+                                     IREE::HAL::ExecutableTargetAttr targetAttr) {
+  if (!targetAttr || !targetAttr.getConfiguration()) return true;
+  auto supported =
+      targetAttr.getConfiguration().getAs<ArrayAttr>("element_types");
+  if (!supported) return true;
+  auto isSupported = [&](int64_t elementType) {
+    StringRef name = getPIMElementTypeName(elementType);
+    return llvm::any_of(supported, [&](Attribute attr) {
+      auto typeAttr = attr.dyn_cast<StringAttr>();
+      return typeAttr && typeAttr.getValue() == name;
+    });
+  };
+  auto result = moduleOp.walk([&](Operation *op) {
+    auto typeAttr = op->getAttrOfType<IntegerAttr>("pim.element_type");
+    if (typeAttr && !isSupported(typeAttr.getInt())) {
+      return WalkResult::interrupt();
+    }
+    return WalkResult::advance();
+  });
+  return !result.wasInterrupted();
+}
+
+// Returns true if the decoder |layer| is left to the host by |targetAttr| (see
+// --iree-pim-host-layers). Names match the layer with or without the index of
+// its occurrence in the block so that `layernorm` covers both layer norms.
+static bool isHostLayer(IREE::HAL::ExecutableTargetAttr targetAttr,
+                        StringRef layer) {
+  if (!targetAttr || !targetAttr.getConfiguration() || layer.empty()) {
+    return false;
+  }
+  auto hostLayers =
+      targetAttr.getConfiguration().getAs<ArrayAttr>("host_layers");
+  if (!hostLayers) return false;
+  StringRef baseLayer = layer.rtrim("0123456789");
+  return llvm::any_of(hostLayers, [&](Attribute attr) {
+    auto nameAttr = attr.dyn_cast<StringAttr>();
+    return nameAttr && (nameAttr.getValue() == layer ||
+                        nameAttr.getValue() == baseLayer);
+  });
+}
+
 } // namespace
 //===----------------------------------------------------------------------===//
 // Conversion patterns
@@ -96,75 +215,258 @@ class ConvertToPIMPass : public ConvertToPIMBase<ConvertToPIMPass> {
  private:
   const std::vector<std::string> fused_matmul_pattern = {"matmul", "generic"};  // Softmax pattern
 
-  bool doesModuleContainMatmulGenericPattern(mlir::ModuleOp moduleOp) {
+  bool doOpsMatchMatmulGenericPattern(ArrayRef<Operation *> ops) {
     std::vector<std::string> operationSequence;
-    moduleOp.walk([&](Operation *op) {
+    for (Operation *op : ops) {
       if ( isa<mlir::linalg::MatmulOp>(op) ||  isa<mlir::linalg::BatchMatmulOp>(op)) {
         operationSequence.push_back("matmul");
       }
       else if (isa<mlir::linalg::GenericOp>(op)) {
         operationSequence.push_back("generic");
       }
-    });
+    }
     if (operationSequence == fused_matmul_pattern)
       return true; // Pattern found
     return false; // Pattern not found
   }
 
+  bool doesModuleContainMatmulGenericPattern(mlir::ModuleOp moduleOp) {
+    SmallVector<Operation *> ops;
+    moduleOp.walk([&](Operation *op) { ops.push_back(op); });
+    return doOpsMatchMatmulGenericPattern(ops);
+  }
+
+  LogicalResult convertFusedDecoderBlock(ModuleOp moduleOp, int num_device,
+                                         std::vector<int> config);
+
+  // Erases the PIM instructions of |moduleOp| if any of them computes in an
+  // element type the target devices don't support. The dispatch is then left
+  // to the fallback variant (see markIfUnsupported).
+  void eraseIfUnsupportedElementTypes(
+      ModuleOp moduleOp, IREE::HAL::ExecutableTargetAttr targetAttr) {
+    if (hasSupportedElementTypes(moduleOp, targetAttr)) return;
+    LLVM_DEBUG(llvm::dbgs() << "Unsupported PIM element type\n");
+    SmallVector<Operation *> pimOps;
+    moduleOp.walk([&](Operation *op) {
+      if (isa_and_nonnull<IREE::PIM::PIMDialect>(op->getDialect())) {
+        pimOps.push_back(op);
+      }
+    });
+    for (Operation *op : pimOps) op->erase();
+  }
+
+  // Marks |moduleOp| with `hal.executable.unsupported` if none of its linalg
+  // or LinalgExt ops (such as iree_linalg_ext.sample) were lowered to PIM
+  // instructions. The variant is then dropped in favor of a fallback variant
+  // of the executable if the module is also compiled for one (see
+  // --iree-hal-fallback-target-backends).
+  void markIfUnsupported(ModuleOp moduleOp) {
+    bool hasPIMOps = false;
+    bool hasLinalgOps = false;
+    moduleOp.walk([&](Operation *op) {
+      if (isa_and_nonnull<IREE::PIM::PIMDialect>(op->getDialect())) {
+        hasPIMOps = true;
+        return WalkResult::interrupt();
+      }
+      if (isa<linalg::LinalgOp, IREE::LinalgExt::LinalgExtOp>(op)) {
+        hasLinalgOps = true;
+      }
+      return WalkResult::advance();
+    });
+    if (!hasPIMOps && hasLinalgOps) {
+      moduleOp->setAttr("hal.executable.unsupported",
+                        UnitAttr::get(moduleOp.getContext()));
+    }
+  }
+
 };
 
 } // namespace
 
+/// Converts a decoder block fused into a single dispatch (see
+/// iree-flow-pim-fuse-decoder-block) stage by stage using the layer recorded
+/// in the partitioning of each stage. Every generated PIM instruction is tagged
+/// with the operand slots it reads followed by the slot of its result so that
+/// the runtime can chain the instructions with intermediates kept resident on
+/// the device. Stages without an instruction forward their first operand.
+LogicalResult ConvertToPIMPass::convertFusedDecoderBlock(
+    ModuleOp moduleOp, int num_device, std::vector<int> config) {
+  MLIRContext *context = &getContext();
+
+  DenseMap<Operation *, int64_t> stageOf;
+  std::map<int64_t, SmallVector<Operation *>> stages;
+  moduleOp.walk([&](linalg::LinalgOp op) {
+    auto stageAttr = op->getAttrOfType<IntegerAttr>("pim.block_stage");
+    if (!stageAttr) return;
+    stageOf[op] = stageAttr.getInt();
+    stages[stageAttr.getInt()].push_back(op);
+  });
+
+  ConversionTarget target(getContext());
+  target.addLegalDialect<IREE::PIM::PIMDialect>();
+  target.addLegalDialect<mlir::arith::ArithDialect>();
+
+  Builder builder(context);
+  StageSlotMap stageSlots;
+  int32_t instruction_count = 0;
+  std::vector<std::pair<int, int>> hal_buffer_info;
+  Operation *prev_op = nullptr;
+  SmallVector<int32_t> prev_slots;
+  int32_t prev_result_slot = 0;
+  for (auto &[stage, ops] : stages) {
+    DictionaryAttr partition =
+        ops.front()->getAttrOfType<DictionaryAttr>("pim.partition");
+    string layer = getPartitionString(partition, "layer");
+    string sync = getPartitionString(partition, "sync");
+    LLVM_DEBUG(llvm::dbgs() << "Stage " << stage << " layer: " << layer
+                            << "\n");
+
+    SmallVector<int32_t> slots;
+    for (Operation *op : ops) {
+      for (Value operand : op->getOperands()) {
+        Optional<int32_t> slot =
+            resolveOperandSlot(operand, stageOf, stageSlots, stage);
+        if (slot && !llvm::is_contained(slots, *slot)) slots.push_back(*slot);
+      }
+    }
+
+    llvm::DenseSet<Operation *> existing_ops;
+    moduleOp.walk([&](Operation *op) {
+      if (isa_and_nonnull<IREE::PIM::PIMDialect>(op->getDialect())) {
+        existing_ops.insert(op);
+      }
+    });
+
+    RewritePatternSet patterns(context);
+    populateLinalgToPIMPatterns(context, patterns,
+                                doOpsMatchMatmulGenericPattern(ops),
+                                hal_buffer_info, layer, sync, num_device,
+                                config);
+    if (failed(applyPartialConversion(ops, target, std::move(patterns)))) {
+      return failure();
+    }
+
+    SmallVector<Operation *> stage_ops;
+    moduleOp.walk([&](Operation *op) {
+      if (isa_and_nonnull<IREE::PIM::PIMDialect>(op->getDialect()) &&
+          !existing_ops.contains(op)) {
+        stage_ops.push_back(op);
+      }
+    });
+    if (stage_ops.empty()) {
+      stageSlots[stage] =
+          slots.empty() ? Optional<int32_t>() : Optional<int32_t>(slots[0]);
+      continue;
+    }
+    if (stage_ops.size() != 1) {
+      return stage_ops.back()->emitOpError()
+             << "expected one PIM instruction per decoder block stage";
+    }
+
+    // A layer normalization repeating the previous instruction on the same
+    // operands (as left behind when the stages of separate dispatches are
+    // fused) reuses its resident result. Folding happens here as the
+    // instruction numbering of the resident slots is assigned below.
+    Optional<int32_t> binding = getStoredBindingOrdinal(ops);
+    Operation *pim_op = stage_ops.front();
+    if (prev_op && !binding &&
+        isa<IREE::PIM::LayerNorm1Op, IREE::PIM::LayerNorm2Op,
+            IREE::PIM::RMSNormOp>(pim_op) &&
+        IREE::PIM::isDuplicateInstruction(prev_op, pim_op) &&
+        slots == prev_slots &&
+        !llvm::is_contained(prev_slots, prev_result_slot)) {
+      LLVM_DEBUG(llvm::dbgs() << "Stage " << stage << " folded\n");
+      pim_op->erase();
+      stageSlots[stage] = prev_result_slot;
+      continue;
+    }
+
+    // Intermediates stay on the device unless they leave the dispatch.
+    int32_t result_slot = binding ? *binding : -1 - instruction_count;
+    prev_op = pim_op;
+    prev_slots = slots;
+    prev_result_slot = result_slot;
+    slots.push_back(result_slot);
+    pim_op->setAttr("pim.operand_slots", builder.getDenseI32ArrayAttr(slots));
+    stageSlots[stage] = result_slot;
+    ++instruction_count;
+  }
+  return success();
+}
 
 void ConvertToPIMPass::runOnOperation() {
-  // std::cout << "\nConvertToPIMPass\n";
   MLIRContext *context = &getContext();
   // context->getOrLoadDialect<IREE::PIM::PIMDialect>();
   RewritePatternSet patterns(&getContext());
   ModuleOp moduleOp = getOperation();
 
-  std::string disp_num;
-  for (auto funcOp : moduleOp.getOps<func::FuncOp>()) {
-    std::string input = funcOp.getName().str();
-    std::string key = "dispatch_";
-    size_t startPos = input.find(key);
-    if (startPos != std::string::npos) {
-        startPos += key.length(); // Start after "dispatch_"
-        size_t endPos = input.find('_', startPos);
-        disp_num = input.substr(startPos, endPos - startPos);
-    }
-  }
-
-  Json::Value root;
-  Json::Reader reader;
-  // llvm::outs() << "Open executable map json\n";
-  std::ifstream json("exe_map.json", ifstream::binary);
-  reader.parse(json, root);
-  string layer, sync;
-  int num_device;
+  // The partitioning recorded by the flow dispatch region formation (see
+  // GenerateMetaData) is shared by all ops of the dispatch. Stages of a fused
+  // decoder block carry their own and are looked up per stage.
+  DictionaryAttr partition;
+  moduleOp.walk([&](linalg::LinalgOp op) {
+    partition = op->getAttrOfType<DictionaryAttr>("pim.partition");
+    return partition ? WalkResult::interrupt() : WalkResult::advance();
+  });
+
+  string workload = getPartitionString(partition, "workload");
+  string layer = "normal";
+  string sync = getPartitionString(partition, "sync");
+  int num_device = 1;
+  if (partition) {
+    if (auto numDevice = partition.getAs<IntegerAttr>("num_device")) {
+      num_device = numDevice.getInt();
+    }
+  }
+  // The device count of the target (see --iree-pim-device-count) takes
+  // precedence as in the kernel configuration.
+  auto targetAttr = IREE::HAL::ExecutableTargetAttr::lookup(moduleOp);
+  if (targetAttr) {
+    if (auto numDevice = getConfigIntegerAttr(targetAttr, "num_device")) {
+      num_device = numDevice->getInt();
+    }
+  }
+  // Pipelined layers run whole on the module of their stage (see
+  // --iree-flow-pim-pipeline-stages).
+  if (partition && partition.get("pipelined")) num_device = 1;
   std::vector<int> config;
-  
-  num_device = std::stoi(root["num_device"].asString());
-  if (root["workload"]=="decoder") {
-    layer = root[disp_num]["layer"].asString();
-    sync = root[disp_num]["sync"].asString();
-    config.push_back(root["config"]["d_model"].asInt()); // d_model
-    config.push_back(root["config"]["n_head"].asInt()); // n_head
-    config.push_back(root["config"]["d_head"].asInt()); // d_head
-    config.push_back(root["config"]["token"].asInt()); // token
+  if (workload == "decoder") {
+    layer = getPartitionString(partition, "layer");
+    // d_model, n_head, d_head, token
+    if (auto configAttr = partition.getAs<DenseI32ArrayAttr>("config")) {
+      config.assign(configAttr.asArrayRef().begin(),
+                    configAttr.asArrayRef().end());
+    }
+  } else if (workload == "lm_head") {
+    layer = "lm_head";
   }
 
-  else {
-    layer = "normal";
-    sync = root[disp_num].asString();
+  // Host layers are left to the fallback variant and run by the runtime on
+  // the host while independent PIM dispatches of the same submission execute.
+  if (workload == "decoder" &&
+      getPartitionString(partition, "fusion") != "block" &&
+      isHostLayer(targetAttr, layer)) {
+    LLVM_DEBUG(llvm::dbgs() << "Host layer: " << layer << "\n");
+    moduleOp->setAttr("hal.executable.unsupported", UnitAttr::get(context));
+    return;
   }
-  
-  llvm::outs() << "Layer: " << layer << "\n";
-  llvm::outs() << "Communication type: " << sync << "\n";
+
+  if (workload == "decoder" &&
+      getPartitionString(partition, "fusion") == "block") {
+    if (failed(convertFusedDecoderBlock(moduleOp, num_device, config))) {
+      signalPassFailure();
+      return;
+    }
+    eraseIfUnsupportedElementTypes(moduleOp, targetAttr);
+    markIfUnsupported(moduleOp);
+    return;
+  }
+
+  LLVM_DEBUG(llvm::dbgs() << "Layer: " << layer << "\n");
+  LLVM_DEBUG(llvm::dbgs() << "Communication type: " << sync << "\n");
 
   bool is_fused_matmul = doesModuleContainMatmulGenericPattern(moduleOp);
   
-  // std::cout<< "Is fused matmul : "<< is_fused_matmul << std::endl;
   // Declare a vector to store pairs of int values.
   std::vector<std::pair<int, int>> hal_buffer_info;
 
@@ -175,34 +477,24 @@ void ConvertToPIMPass::runOnOperation() {
     int offset_val = 0;
     if (auto constantOp = byte_offset.getDefiningOp<mlir::arith::ConstantIndexOp>()) {
       offset_val = constantOp.value();
-      // llvm::outs() << "Offset Value: " << offset_val << "\n";
     }
     int buffer_type = 2;
     if(auto DescriptorFlagsAttr = subspanOp.getDescriptorFlagsAttr()) {
       int32_t intValue = DescriptorFlagsAttr.getInt();
       switch (intValue) {
         case 0x0000:
-          // llvm::outs() << "The descriptor flag is None.\n";
           buffer_type = 0;
           break;
         case 0x0001:
-          // llvm::outs() << "The descriptor flag is ReadOnly.\n";
           buffer_type = 1;
           break;
-        
-        // default:
-          // llvm::outs() << "Unknown descriptor flag with value: " << intValue << ".\n";
-          // break;
       }
     }
-    else {
-      // llvm::outs() << "Is Write Only.\n\n";
-    }
     // Add the pair to the vector.
     hal_buffer_info.push_back({buffer_type, offset_val});
     // Print out the pairs.
     for (const auto& info : hal_buffer_info) {
-      llvm::outs() << "(buffer_type: " << info.first << ", offset: " << info.second << ")\n";
+      LLVM_DEBUG(llvm::dbgs() << "(buffer_type: " << info.first << ", offset: " << info.second << ")\n");
     }
   }
   });*/
@@ -221,7 +513,10 @@ void ConvertToPIMPass::runOnOperation() {
   // Apply the conversion patterns.
   if (failed(applyPartialConversion(getOperation(), target, std::move(patterns)))) {
     signalPassFailure();
+    return;
   }
+  eraseIfUnsupportedElementTypes(moduleOp, targetAttr);
+  markIfUnsupported(moduleOp);
 
 }
 
@@ -10,10 +10,12 @@
 
 #include "iree-dialects/Dialect/LinalgExt/IR/LinalgExtOps.h"
 #include "iree/compiler/Codegen/Common/LinalgOpInfo.h"
+#include "iree/compiler/Codegen/Common/TuningDatabase.h"
 #include "iree/compiler/Codegen/Common/UserConfig.h"
 #include "iree/compiler/Codegen/Dialect/LoweringConfig.h"
 #include "iree/compiler/Codegen/LLVMGPU/TransposeUtils.h"
 #include "iree/compiler/Codegen/TransformDialectStrategies/GPU/Common.h"
+#include "iree/compiler/Codegen/Utils/Utils.h"
 #include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
@@ -23,16 +25,15 @@
 #include "mlir/IR/Matchers.h"
 #include "mlir/IR/Types.h"
 #include "mlir/IR/Value.h"
-#include "json/json.h"
 #include <vector>
-#include <fstream>
+
+#define DEBUG_TYPE "iree-pim-kernel-config"
 
 using namespace mlir;
 using namespace mlir::iree_compiler;
 using namespace std;
 
 static constexpr unsigned cudaWarpSize = 32;
-static constexpr StringLiteral kCudaTarget = "cuda";
 namespace mlir {
 namespace iree_compiler {
 
@@ -42,82 +43,232 @@ namespace iree_compiler {
 namespace {
 
 /// Structure to represent target features.
+/// The hardware parameters default to a single PIM device and may be
+/// overridden by the `bank_count`, `row_buffer_bytes`, `device_capacity_bytes`
+/// and `num_device` entries of the hal.executable.target configuration set
+/// by the --iree-pim-* options of the PIM target backend. The
+/// `partition_search` entry ignores the flow partitioning of matmuls.
 struct TargetInfo {
   int device_num = 1;
   string workload = "normal";
   std::vector<string> layer_info;
+  // Number of banks computing in parallel on one device.
+  int64_t bank_count = 512;
+  // Size of the row buffer of one bank in bytes.
+  int64_t row_buffer_bytes = 2048;
+  // Memory available for the weights of one dispatch on one device in bytes.
+  int64_t device_capacity_bytes = int64_t(1) << 30;
+  // Picks the split of every matmul by cost instead of the flow partitioning.
+  bool partition_search = false;
 };
 
-struct TileWorkgroupSizePair {
-  // How many scalar elements each workgroup should handle along each dimension.
-  std::array<int64_t, 3> tileSize;
-  std::array<int64_t, 3> workgroupSize;
+/// How a matmul is partitioned across devices.
+enum class PIMSplit {
+  // Every device computes the whole matmul.
+  None,
+  // Devices own a slice of N; results are all-gathered.
+  RowWise,
+  // Devices own a slice of K; partial sums are all-reduced.
+  ColWise,
 };
 
-string extractNumberAfterDispatch(const std::string& input) {
-    std::string key = "dispatch_";
-    size_t startPos = input.find(key);
-    if (startPos != std::string::npos) {
-        startPos += key.length(); // Start after "dispatch_"
-        size_t endPos = input.find('_', startPos);
-        string numberStr = input.substr(startPos, endPos - startPos);
-        return numberStr; // Convert to integer
-    }
-    return "none"; // Return -1 or some error value if "dispatch_" is not found
+// Returns the PIM partitioning recorded on |op| by the flow dispatch region
+// formation (see GenerateMetaData) or null if it has none.
+DictionaryAttr getPIMPartition(Operation *op) {
+    return op->getAttrOfType<DictionaryAttr>("pim.partition");
+}
+
+// Returns the string entry |name| of |partition| or an empty string.
+string getPartitionString(DictionaryAttr partition, StringRef name) {
+    if (!partition) return "";
+    auto value = partition.getAs<StringAttr>(name);
+    return value ? value.getValue().str() : "";
 }
 
-// Get partining and sync info from json file
-std::vector<string> getDecoderLayerInfo(Json::Value root, string disp_num) {
+// Get partitioning and sync info of a decoder layer
+std::vector<string> getDecoderLayerInfo(DictionaryAttr partition) {
     std::vector<string> layer_info;
-    string layer = root[disp_num]["layer"].asString();
-    string partitioning = root[disp_num]["partioning"].asString();
-    string sync = root[disp_num]["sync"].asString();
-    layer_info.push_back(layer);
-    layer_info.push_back(partitioning);
-    layer_info.push_back(sync);
+    layer_info.push_back(getPartitionString(partition, "layer"));
+    layer_info.push_back(getPartitionString(partition, "partitioning"));
+    layer_info.push_back(getPartitionString(partition, "sync"));
     return layer_info;
 }
 
-// Software pipeline depths
-constexpr unsigned softwarePipelineDepthTensorCore = 4;
 // Simt codegen does not do software pipelining.
 constexpr unsigned softwarePipelineDepthSimt = 0;
 }  // namespace
 
-/// Return the best combination of tile size and wg size. It will then used to
-/// pick the best size aligned with the shape dimension.
-static void getMatmulConfig(SmallVectorImpl<TileWorkgroupSizePair> &tileSizes) {
-  // Pick tile size so that M*K and K*N dividible by wgSize * \*vecSize=*\4.
-  // This way workgroup memory copy don't need to be masked. Once we support
-  // masked load we can get performance out of more configuration.
-  tileSizes.push_back(TileWorkgroupSizePair({{32, 128, 32}, {32, 8, 1}}));
-  tileSizes.push_back(TileWorkgroupSizePair({{128, 64, 8}, {16, 8, 1}}));
-  tileSizes.push_back(TileWorkgroupSizePair({{16, 256, 32}, {64, 2, 1}}));
-  tileSizes.push_back(TileWorkgroupSizePair({{8, 32, 32}, {8, 8, 1}}));
-
-  tileSizes.push_back(TileWorkgroupSizePair({{32, 128, 4}, {32, 8, 1}}));
-  tileSizes.push_back(TileWorkgroupSizePair({{8, 128, 4}, {32, 1, 1}}));
-  tileSizes.push_back(TileWorkgroupSizePair({{16, 64, 4}, {16, 2, 1}}));
-  tileSizes.push_back(TileWorkgroupSizePair({{1, 128, 8}, {32, 1, 1}}));
-}
+// PIM dispatches are not distributed over workgroups; the tiles map to
+// devices instead.
+static constexpr std::array<int64_t, 3> kPIMWorkgroupSize = {1, 1, 1};
+
+// Relative cost of moving one row buffer of data between devices through the
+// host compared to one row-parallel compute step on the banks.
+static constexpr int64_t kSyncCostPerRow = 8;
 
-static TargetInfo getTargetInfo(func::FuncOp entryPoint, string workload, std::vector<string> layer_info) {
+static TargetInfo getTargetInfo(func::FuncOp entryPoint,
+                                Operation *computeOp) {
   TargetInfo info;
-  int num_device;
-
-  Json::Value root;
-  Json::Reader reader;
-  // llvm::outs() << "Open executable map json\n";
-  std::ifstream json("exe_map.json", ifstream::binary);
-  reader.parse(json, root);
-  num_device = std::stoi(root["num_device"].asString());
-
-  info.device_num = num_device;
-  info.workload = workload;
-  info.layer_info = layer_info;
+  // Ops without a partitioning run unsplit.
+  DictionaryAttr partition = getPIMPartition(computeOp);
+  info.layer_info = getDecoderLayerInfo(partition);
+  if (partition) {
+    if (auto numDevice = partition.getAs<IntegerAttr>("num_device")) {
+      info.device_num = numDevice.getInt();
+    }
+    info.workload = getPartitionString(partition, "workload");
+  }
+  auto targetAttr = IREE::HAL::ExecutableTargetAttr::lookup(entryPoint);
+  if (!targetAttr) return info;
+  if (auto attr = getConfigIntegerAttr(targetAttr, "num_device")) {
+    info.device_num = attr->getInt();
+  }
+  if (auto attr = getConfigIntegerAttr(targetAttr, "bank_count")) {
+    info.bank_count = attr->getInt();
+  }
+  if (auto attr = getConfigIntegerAttr(targetAttr, "row_buffer_bytes")) {
+    info.row_buffer_bytes = attr->getInt();
+  }
+  if (auto attr = getConfigIntegerAttr(targetAttr, "device_capacity_bytes")) {
+    info.device_capacity_bytes = attr->getInt();
+  }
+  if (auto attr = getConfigBoolAttr(targetAttr, "partition_search")) {
+    info.partition_search = attr->getValue();
+  }
+  // Pipelined layers run whole on the module of their stage.
+  if (partition && partition.get("pipelined")) info.device_num = 1;
   return info;
 }
 
+// Estimates the cost of an MxNxK f32 matmul split across the devices of
+// |targetInfo| with |split|, in units of one row-parallel bank step.
+// Returns std::nullopt if the split does not divide the problem or the weight
+// slice of one device does not fit in its capacity.
+//
+// Each device streams its M rows through the banks, which process
+// bank_count * row_buffer_bytes of weights per step. Row-wise splits then
+// all-gather the (d-1)/d of the output the device did not compute while
+// col-wise splits all-reduce the whole output.
+static std::optional<int64_t> estimateMatmulCost(const TargetInfo &targetInfo,
+                                                 PIMSplit split, int64_t sizeM,
+                                                 int64_t sizeN, int64_t sizeK) {
+  const int64_t devices = targetInfo.device_num;
+  int64_t devN = sizeN;
+  int64_t devK = sizeK;
+  if (split == PIMSplit::RowWise) {
+    if (sizeN % devices != 0) return std::nullopt;
+    devN = sizeN / devices;
+  } else if (split == PIMSplit::ColWise) {
+    if (sizeK % devices != 0) return std::nullopt;
+    devK = sizeK / devices;
+  }
+  const int64_t elementBytes = sizeof(float);
+  if (devN * devK * elementBytes > targetInfo.device_capacity_bytes) {
+    return std::nullopt;
+  }
+  const int64_t rowElements =
+      std::max<int64_t>(targetInfo.row_buffer_bytes / elementBytes, 1);
+  const int64_t stepElements =
+      std::max<int64_t>(targetInfo.bank_count, 1) * rowElements;
+  int64_t cost = sizeM * llvm::divideCeil(devN * devK, stepElements);
+  int64_t syncElements = 0;
+  if (split == PIMSplit::RowWise) {
+    syncElements = sizeM * sizeN * (devices - 1) / devices;
+  } else if (split == PIMSplit::ColWise) {
+    syncElements = sizeM * sizeN * (devices - 1);
+  }
+  cost += llvm::divideCeil(syncElements, rowElements) * kSyncCostPerRow;
+  return cost;
+}
+
+static const char *getSplitName(PIMSplit split) {
+  switch (split) {
+    case PIMSplit::None:
+      return "none";
+    case PIMSplit::RowWise:
+      return "row-wise";
+    case PIMSplit::ColWise:
+      return "col-wise";
+  }
+  return "?";
+}
+
+// Emits a remark on |op| with the split picked by the partitioning search and
+// the estimated cost of every candidate so that the plan of a model can be
+// reviewed (and recorded in the flow partitioning) without debug builds.
+static void emitPartitionSearchRemark(Operation *op,
+                                      const TargetInfo &targetInfo,
+                                      PIMSplit split, int64_t sizeM,
+                                      int64_t sizeN, int64_t sizeK) {
+  auto diag = op->emitRemark()
+              << "PIM partition search: layer=" << targetInfo.layer_info[0]
+              << " devices=" << targetInfo.device_num << " split="
+              << getSplitName(split) << " costs=(";
+  llvm::interleaveComma(
+      ArrayRef<PIMSplit>{PIMSplit::RowWise, PIMSplit::ColWise, PIMSplit::None},
+      diag, [&](PIMSplit candidate) {
+        diag << getSplitName(candidate) << ":";
+        std::optional<int64_t> cost =
+            estimateMatmulCost(targetInfo, candidate, sizeM, sizeN, sizeK);
+        if (cost) {
+          diag << *cost;
+        } else {
+          diag << "infeasible";
+        }
+      });
+  diag << ")";
+}
+
+// Picks how to split an MxNxK matmul across devices. An explicit row-wise or
+// col-wise partitioning from the flow metadata is honored when feasible unless
+// the partitioning search is enabled, otherwise the cheapest feasible split
+// under estimateMatmulCost is used.
+static PIMSplit selectMatmulSplit(Operation *op, const TargetInfo &targetInfo,
+                                  int64_t sizeM, int64_t sizeN,
+                                  int64_t sizeK) {
+  if (targetInfo.device_num <= 1) return PIMSplit::None;
+  if (ShapedType::isDynamic(sizeN) || ShapedType::isDynamic(sizeK)) {
+    return PIMSplit::None;
+  }
+  // M is the number of tokens of the batch and may only be known at runtime.
+  // Splits divide the weights and every term of the cost scales with M so the
+  // choice doesn't depend on it.
+  if (ShapedType::isDynamic(sizeM)) sizeM = 1;
+
+  const string &hint = targetInfo.layer_info[1];
+  if (!targetInfo.partition_search &&
+      (hint == "row-wise" || hint == "col-wise")) {
+    PIMSplit split = hint == "row-wise" ? PIMSplit::RowWise : PIMSplit::ColWise;
+    if (estimateMatmulCost(targetInfo, split, sizeM, sizeN, sizeK)) {
+      return split;
+    }
+    LLVM_DEBUG(llvm::dbgs() << "KernelConfig.cpp: " << hint
+                            << " partitioning is infeasible, ignoring it\n");
+  }
+
+  PIMSplit best = PIMSplit::None;
+  std::optional<int64_t> bestCost;
+  for (PIMSplit split :
+       {PIMSplit::RowWise, PIMSplit::ColWise, PIMSplit::None}) {
+    std::optional<int64_t> cost =
+        estimateMatmulCost(targetInfo, split, sizeM, sizeN, sizeK);
+    LLVM_DEBUG(llvm::dbgs() << "KernelConfig.cpp: split " << int(split)
+                            << " cost " << (cost ? *cost : -1) << "\n");
+    if (cost && (!bestCost || *cost < *bestCost)) {
+      best = split;
+      bestCost = cost;
+    }
+  }
+  // Nothing fits; splitting N still shrinks the per-device weights the most.
+  if (!bestCost && sizeN % targetInfo.device_num == 0) {
+    best = PIMSplit::RowWise;
+  }
+  if (targetInfo.partition_search) {
+    emitPartitionSearchRemark(op, targetInfo, best, sizeM, sizeN, sizeK);
+  }
+  return best;
+}
+
 static LogicalResult setMatmulTileConfig(func::FuncOp entryPoint,
                                        linalg::LinalgOp op,
                                        const TargetInfo &targetInfo) {
@@ -192,74 +343,24 @@ static LogicalResult setMatmulTileConfig(func::FuncOp entryPoint,
       }
     }
   }
-  bool isStaticSize = sizeM != ShapedType::kDynamic &&
-                      sizeN != ShapedType::kDynamic &&
-                      sizeK != ShapedType::kDynamic;
-
-  int dev_num = targetInfo.device_num;
-  // If we haven't found any config, use the best tile size hoping that
-  // the workgroup specialization handles the main tile path efficiently.
-  SmallVector<TileWorkgroupSizePair> tileSizeConfig;
-  // Query the best configuration.
-  getMatmulConfig(tileSizeConfig);
-  constexpr size_t configIndex = 0;
-  const TileWorkgroupSizePair &config = tileSizeConfig[configIndex];
-  
-  /*
-  const int64_t tileX = config.tileSize[0];
-  const int64_t tileY = config.tileSize[1];
-  int64_t tileK = config.tileSize[2];*/
-
-  // Default spliting: row-wise (all-gather)
-  int64_t tileX = sizeM;
-  int64_t tileY = sizeN/dev_num;
+  // All tokens of a batch are processed by one workgroup so that they share a
+  // single pass over the weights; a dynamic M is left untiled.
+  int64_t tileX = ShapedType::isDynamic(sizeM) ? 0 : sizeM;
+  int64_t tileY = sizeN;
   int64_t tileK = sizeK;
-  
-  if (targetInfo.workload == "decoder") {
-    llvm::outs() << "is decoder\n";
-    string split = targetInfo.layer_info[1];
-    string sync = targetInfo.layer_info[2];
-    llvm::outs() << split << sync << "\n";
-    if (split == "row-wise") {
-      llvm::outs() << "KernelConfig.cpp: MatmulTileConfig: row-wise partitioning\n";
-      tileX = sizeM;
-      tileY = sizeN/dev_num;
-      tileK = sizeK;
-    }
-    else if (split == "col-wise") {
-      llvm::outs() << "KernelConfig.cpp: MatmulTileConfig: col-wise partitioning\n";
-      tileX = sizeM;
-      tileY = sizeN;
-      tileK = sizeK/dev_num;
-    }
-  }
-
-  else if (targetInfo.workload == "normal") {
-    llvm::outs() << "is decoder\n";
-    string split = targetInfo.layer_info[1];
-    string sync = targetInfo.layer_info[2];
-    llvm::outs() << split << sync << "\n";
-    if (split == "row-wise") {
-      llvm::outs() << "KernelConfig.cpp: MatmulTileConfig: row-wise partitioning\n";
-      tileX = sizeM;
-      tileY = sizeN/dev_num;
-      tileK = sizeK;
-    }
-    else if (split == "col-wise") {
-      llvm::outs() << "KernelConfig.cpp: MatmulTileConfig: col-wise partitioning\n";
-      tileX = sizeM;
-      tileY = sizeN;
-      tileK = sizeK/dev_num;
-    }
+  switch (selectMatmulSplit(op, targetInfo, sizeM, sizeN, sizeK)) {
+    case PIMSplit::RowWise:
+      LLVM_DEBUG(llvm::dbgs() << "KernelConfig.cpp: MatmulTileConfig: row-wise partitioning\n");
+      tileY = sizeN / targetInfo.device_num;
+      break;
+    case PIMSplit::ColWise:
+      LLVM_DEBUG(llvm::dbgs() << "KernelConfig.cpp: MatmulTileConfig: col-wise partitioning\n");
+      tileK = sizeK / targetInfo.device_num;
+      break;
+    case PIMSplit::None:
+      break;
   }
 
-  /*
-  if ((sizeK == sizeN * 4)) {
-    tileY = sizeN;
-    tileK = sizeK/dev_num;
-    llvm::outs() << "Second matmul of the FFN - col-wise partitioning\n";
-  }*/
-
   // Since specialization doesn't work for K loop and peeling is not enabled yet
   // we pick a tileK size that is aligned on the K size.
   if (ShapedType::isDynamic(sizeK)) tileK = 1;
@@ -267,16 +368,13 @@ static LogicalResult setMatmulTileConfig(func::FuncOp entryPoint,
     tileK >>= 1;
   }
   
-  llvm::outs() << "KernelConfig.cpp: MatmulTileConfig: Tile size MNK : ";
-  llvm::outs() << tileX << " ";
-  llvm::outs() << tileY << " ";
-  llvm::outs() << tileK << "\n";
-
-  const std::array<int64_t, 3> workgroupSize{config.workgroupSize[0],
-                                             config.workgroupSize[1],
-                                             config.workgroupSize[2]};
+  LLVM_DEBUG(llvm::dbgs() << "KernelConfig.cpp: MatmulTileConfig: Tile size MNK : ");
+  LLVM_DEBUG(llvm::dbgs() << tileX << " ");
+  LLVM_DEBUG(llvm::dbgs() << tileY << " ");
+  LLVM_DEBUG(llvm::dbgs() << tileK << "\n");
+
   return setMatmulConfig(
-      tileX, tileY, tileK, workgroupSize, softwarePipelineDepthSimt,
+      tileX, tileY, tileK, kPIMWorkgroupSize, softwarePipelineDepthSimt,
       IREE::Codegen::DispatchLoweringPassPipeline::PIMMatmul);
 }
 
@@ -298,15 +396,15 @@ static LogicalResult setBatchMatmulTileConfig(func::FuncOp entryPoint,
                          IREE::Codegen::DispatchLoweringPassPipeline pipeline) {
         TileSizesListType tileSizes;
         unsigned numParallelLoops = op.getNumParallelLoops();
-        llvm::outs() << "numParallelLoops: " << numParallelLoops << "\n";
+        LLVM_DEBUG(llvm::dbgs() << "numParallelLoops: " << numParallelLoops << "\n");
         SmallVector<int64_t> workgroupTileSizes(numParallelLoops - 2, tileB);
         
         /*
-        llvm::outs() << "workgroupTileSizes: ";
+        LLVM_DEBUG(llvm::dbgs() << "workgroupTileSizes: ");
         for (const auto& element : workgroupTileSizes) {
-          llvm::outs() << element << " ";
+          LLVM_DEBUG(llvm::dbgs() << element << " ");
         }
-        llvm::outs() << "\n";
+        LLVM_DEBUG(llvm::dbgs() << "\n");
         */
 
         workgroupTileSizes.append({tileX, tileY});
@@ -342,12 +440,12 @@ static LogicalResult setBatchMatmulTileConfig(func::FuncOp entryPoint,
   int64_t sizeK = ShapedType::kDynamic;
   auto outputMap = op.getMatchingIndexingMap(op.getDpsInitOperand(0));
   sizeB = lhsShape[0];
-  llvm::outs() << "KernelConfig.cpp: setBatchMatmulTileConfig: sizeB: " << sizeB << "\n";
+  LLVM_DEBUG(llvm::dbgs() << "KernelConfig.cpp: setBatchMatmulTileConfig: sizeB: " << sizeB << "\n");
   for (unsigned i = 0; i < lhsShape.size(); i++) {
     if (op.getMatchingIndexingMap(op.getDpsInputOperand(0)).getDimPosition(i) ==
         outputMap.getDimPosition(outputMap.getNumResults() - 2)) {
       sizeM = lhsShape[i];
-      llvm::outs() << "KernelConfig.cpp: setBatchMatmulTileConfig: sizeM: " << sizeM << "\n";
+      LLVM_DEBUG(llvm::dbgs() << "KernelConfig.cpp: setBatchMatmulTileConfig: sizeM: " << sizeM << "\n");
       break;
     }
   }
@@ -355,7 +453,7 @@ static LogicalResult setBatchMatmulTileConfig(func::FuncOp entryPoint,
     if (op.getMatchingIndexingMap(op.getDpsInputOperand(1)).getDimPosition(i) ==
         outputMap.getDimPosition(outputMap.getNumResults() - 1)) {
       sizeN = rhsShape[i];
-      llvm::outs() << "KernelConfig.cpp: setBatchMatmulTileConfig: sizeN: " << sizeN << "\n";
+      LLVM_DEBUG(llvm::dbgs() << "KernelConfig.cpp: setBatchMatmulTileConfig: sizeN: " << sizeN << "\n");
       break;
     }
   }
@@ -366,7 +464,7 @@ static LogicalResult setBatchMatmulTileConfig(func::FuncOp entryPoint,
       if (op.getMatchingIndexingMap(op.getDpsInputOperand(0))
               .getDimPosition(i) == exprs[0]) {
         sizeK = lhsShape[i];
-        llvm::outs() << "KernelConfig.cpp: setBatchMatmulTileConfig: sizeK: " << sizeK << "\n";
+        LLVM_DEBUG(llvm::dbgs() << "KernelConfig.cpp: setBatchMatmulTileConfig: sizeK: " << sizeK << "\n");
         break;
       }
     }
@@ -376,18 +474,6 @@ static LogicalResult setBatchMatmulTileConfig(func::FuncOp entryPoint,
                       sizeK != ShapedType::kDynamic;
 
   int dev_num = targetInfo.device_num;
-  // If we haven't found any config, use the best tile size hoping that
-  // the workgroup specialization handles the main tile path efficiently.
-  SmallVector<TileWorkgroupSizePair> tileSizeConfig;
-  // Query the best configuration.
-  getMatmulConfig(tileSizeConfig);
-  constexpr size_t configIndex = 0;
-  const TileWorkgroupSizePair &config = tileSizeConfig[configIndex];
-  
-  /*
-  const int64_t tileX = config.tileSize[0];
-  const int64_t tileY = config.tileSize[1];
-  int64_t tileK = config.tileSize[2];*/
   int64_t tileB = sizeB/dev_num;
   int64_t tileX = sizeM;
   int64_t tileY = sizeN;
@@ -397,7 +483,7 @@ static LogicalResult setBatchMatmulTileConfig(func::FuncOp entryPoint,
     string split = targetInfo.layer_info[1];
     string sync = targetInfo.layer_info[2];
     if (split == "head-wise") {
-      llvm::outs() << "KernelConfig.cpp: setBatchMatmulTileConfig: head-wise partitioning\n";
+      LLVM_DEBUG(llvm::dbgs() << "KernelConfig.cpp: setBatchMatmulTileConfig: head-wise partitioning\n");
       tileB = sizeB/dev_num;
       tileX = sizeM;
       tileY = sizeN;
@@ -405,24 +491,29 @@ static LogicalResult setBatchMatmulTileConfig(func::FuncOp entryPoint,
     }
   }
 
+  // Dynamic dims (the cached sequence length of incremental decode) are left
+  // untiled so that one PIM instruction covers the whole cached prefix.
+  if (ShapedType::isDynamic(sizeM)) tileX = 0;
+  if (ShapedType::isDynamic(sizeN)) tileY = 0;
+
   // Since specialization doesn't work for K loop and peeling is not enabled yet
   // we pick a tileK size that is aligned on the K size.
-  if (ShapedType::isDynamic(sizeK)) tileK = 1;
-  while (sizeK % tileK != 0) {
-    tileK >>= 1;
+  if (ShapedType::isDynamic(sizeK)) {
+    tileK = 0;
+  } else {
+    while (sizeK % tileK != 0) {
+      tileK >>= 1;
+    }
   }
   
-  llvm::outs() << "KernelConfig.cpp: setBatchMatmulTileConfig: Tile size BMNK : ";
-  llvm::outs() << tileB << " ";
-  llvm::outs() << tileX << " ";
-  llvm::outs() << tileY << " ";
-  llvm::outs() << tileK << "\n";
-
-  const std::array<int64_t, 3> workgroupSize{config.workgroupSize[0],
-                                             config.workgroupSize[1],
-                                             config.workgroupSize[2]};
+  LLVM_DEBUG(llvm::dbgs() << "KernelConfig.cpp: setBatchMatmulTileConfig: Tile size BMNK : ");
+  LLVM_DEBUG(llvm::dbgs() << tileB << " ");
+  LLVM_DEBUG(llvm::dbgs() << tileX << " ");
+  LLVM_DEBUG(llvm::dbgs() << tileY << " ");
+  LLVM_DEBUG(llvm::dbgs() << tileK << "\n");
+
   return setBatchMatmulConfig(
-      tileB, tileX, tileY, tileK, workgroupSize, softwarePipelineDepthSimt,
+      tileB, tileX, tileY, tileK, kPIMWorkgroupSize, softwarePipelineDepthSimt,
       IREE::Codegen::DispatchLoweringPassPipeline::PIMMatmul);
 }
 
@@ -557,64 +648,69 @@ static bool hasTwoOrThreeLoopsInfo(linalg::LinalgOp linalgOp) {
 static LogicalResult setRootConfig(func::FuncOp entryPointFn,
                                    Operation *computeOp) {
 
-  llvm::outs() << "KernelConfig.cpp: setRootConfig\n";
-
-  ////////////////////////////////////////////////////////////////////////////
-  llvm::outs() << "KernelConfig.cpp: setRootConfig: funcOp name: " << entryPointFn.getName() << "\n";
-  string dispatch_num = extractNumberAfterDispatch(entryPointFn.getName().str());
-  llvm::outs() << "KernelConfig.cpp: setRootConfig: dispatch_num: " << dispatch_num << "\n";
+  LLVM_DEBUG(llvm::dbgs() << "KernelConfig.cpp: setRootConfig\n");
 
-  Json::Value root;
-  Json::Reader reader;
-  ifstream json("exe_map.json", ifstream::binary);
-  reader.parse(json, root);
-  string workload;
-  std::vector<string> layer_info;
-  if (root["workload"].asString() == "decoder") {
-    // llvm::outs() << "is decoder\n";
-    workload = "decoder";
-    layer_info = getDecoderLayerInfo(root, dispatch_num);
-  }
-  ////////////////////////////////////////////////////////////////////////////
-
-  TargetInfo targetInfo = getTargetInfo(entryPointFn, workload, layer_info);
+  TargetInfo targetInfo = getTargetInfo(entryPointFn, computeOp);
   if (IREE::Codegen::CompilationInfoAttr compilationInfo =
           getCompilationInfo(computeOp)) {
     // If the op already has a lowering config coming from the IR use this and
     // bypass the heuristic.
-    // llvm::outs() << "compilationInfo\n";
     return setUserConfig(entryPointFn, computeOp, compilationInfo);
   }
+  // Otherwise prefer a configuration found by tuning this dispatch.
+  FailureOr<std::optional<TunedConfig>> tunedConfig =
+      lookupTunedConfig(entryPointFn);
+  if (failed(tunedConfig)) return failure();
+  if (*tunedConfig && tunedConfig->value().compilationInfo) {
+    return setUserConfig(entryPointFn, computeOp,
+                         tunedConfig->value().compilationInfo);
+  }
   if (auto linalgOp = dyn_cast<linalg::LinalgOp>(computeOp)) {
 
     if (succeeded(setMatmulTileConfig(entryPointFn, linalgOp, targetInfo))) {
-      llvm::outs() << "KernelConfig.cpp: setMatmulTileConfig\n";
+      LLVM_DEBUG(llvm::dbgs() << "KernelConfig.cpp: setMatmulTileConfig\n");
       return success();
     }
     if (succeeded(setBatchMatmulTileConfig(entryPointFn, linalgOp, targetInfo))) {
-      llvm::outs() << "KernelConfig.cpp: setBatchMatmulTileConfig\n";
+      LLVM_DEBUG(llvm::dbgs() << "KernelConfig.cpp: setBatchMatmulTileConfig\n");
       return success();
     }
     if (succeeded(setGenericConfig(entryPointFn, linalgOp, targetInfo))) {
-      llvm::outs() << "KernelConfig.cpp: setGenericConfig\n";
+      LLVM_DEBUG(llvm::dbgs() << "KernelConfig.cpp: setGenericConfig\n");
       return success();
     }
     /*
     auto genericOp = dyn_cast<linalg::GenericOp>(computeOp);
     if (genericOp && succeeded(setTransposeConfig(entryPointFn, genericOp))) {
-      llvm::outs() << "setTransposeConfig\n";
+      LLVM_DEBUG(llvm::dbgs() << "setTransposeConfig\n");
       return success();
     }*/
   }
-  llvm::outs() << "KernelConfig.cpp: setRootDefaultConfig\n";
+  LLVM_DEBUG(llvm::dbgs() << "KernelConfig.cpp: setRootDefaultConfig\n");
   return setRootDefaultConfig(entryPointFn, computeOp);
 }
 
+// Returns true if |computeOps| come from several stages of a decoder block
+// fused into one dispatch region (see iree-flow-pim-fuse-decoder-block).
+static bool isFusedDecoderBlock(ArrayRef<Operation *> computeOps) {
+  Optional<int64_t> firstStage;
+  for (Operation *op : computeOps) {
+    auto stageAttr = op->getAttrOfType<IntegerAttr>("pim.block_stage");
+    if (!stageAttr) continue;
+    if (!firstStage) {
+      firstStage = stageAttr.getInt();
+    } else if (*firstStage != stageAttr.getInt()) {
+      return true;
+    }
+  }
+  return false;
+}
+
 namespace mlir {
 namespace iree_compiler {
 
 LogicalResult initPIMLaunchConfig(ModuleOp moduleOp) {
-  llvm::outs() << "initPIMLaunchConfig\n";
+  LLVM_DEBUG(llvm::dbgs() << "initPIMLaunchConfig\n");
   llvm::StringMap<IREE::HAL::ExecutableExportOp> exportOps =
       getAllEntryPoints(moduleOp);
 
@@ -630,6 +726,19 @@ LogicalResult initPIMLaunchConfig(ModuleOp moduleOp) {
       return funcOp.emitOpError("failed to get compute ops");
     }
 
+    // The stages of a fused decoder block have unrelated iteration spaces so
+    // no op is tiled; the whole block runs as a single PIM program.
+    if (isFusedDecoderBlock(computeOps)) {
+      if (failed(setDispatchConfig(funcOp, {1, 1, 1}, std::nullopt)))
+        return failure();
+      auto translationInfo = IREE::Codegen::TranslationInfoAttr::get(
+          funcOp.getContext(),
+          IREE::Codegen::DispatchLoweringPassPipeline::PIMMatmul);
+      if (failed(setTranslationInfo(funcOp, translationInfo)))
+        return failure();
+      continue;
+    }
+
     Operation *rootOperation = nullptr;
     // Find the root operation. linalg.generic and linalg.fill are not root
     // operations if there are other compute operations present.
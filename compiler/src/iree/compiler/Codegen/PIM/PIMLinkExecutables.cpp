@@ -0,0 +1,90 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Codegen/PassDetail.h"
+#include "iree/compiler/Codegen/Passes.h"
+#include "iree/compiler/Codegen/Utils/LinkingUtils.h"
+#include "iree/compiler/Utils/ModuleUtils.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "mlir/Pass/Pass.h"
+
+namespace mlir {
+namespace iree_compiler {
+
+namespace {
+
+static bool isPIMTarget(IREE::HAL::ExecutableTargetAttr targetAttr) {
+  return targetAttr.getBackend().getValue() == "pim";
+}
+
+// Links all PIM executables into one so that the runtime loads and verifies a
+// single PIMExecutableDef with one code range per entry point instead of one
+// executable per dispatch.
+struct PIMLinkExecutablesPass
+    : public PIMLinkExecutablesBase<PIMLinkExecutablesPass> {
+  PIMLinkExecutablesPass() = default;
+  void runOnOperation() override {
+    auto moduleOp = getOperation();
+    auto moduleBuilder = OpBuilder::atBlockBegin(moduleOp.getBody());
+
+    // Executables only targeting other backends (such as host fallbacks) are
+    // linked by those backends.
+    SmallVector<IREE::HAL::ExecutableOp, 8> sourceExecutableOps;
+    for (auto executableOp : moduleOp.getOps<IREE::HAL::ExecutableOp>()) {
+      if (llvm::any_of(executableOp.getOps<IREE::HAL::ExecutableVariantOp>(),
+                       [](IREE::HAL::ExecutableVariantOp variantOp) {
+                         return isPIMTarget(variantOp.getTarget());
+                       })) {
+        sourceExecutableOps.push_back(executableOp);
+      }
+    }
+    if (sourceExecutableOps.size() <= 1) return;
+
+    // Guess a module name, if needed, to make the output files readable.
+    auto moduleName = guessModuleName(moduleOp, "pim_module");
+
+    // Create our new "linked" hal.executable.
+    std::string linkedExecutableName =
+        llvm::formatv("{0}_linked_{1}", moduleName, "pim");
+    auto linkedExecutableOp = moduleBuilder.create<IREE::HAL::ExecutableOp>(
+        moduleOp.getLoc(), linkedExecutableName);
+    linkedExecutableOp.setVisibility(
+        sourceExecutableOps.front().getVisibility());
+    auto executableBuilder =
+        OpBuilder::atBlockBegin(&linkedExecutableOp.getBlock());
+
+    // Gather all unique executable targets - we may have multiple.
+    auto executableTargetAttrs = gatherExecutableTargets(sourceExecutableOps);
+    for (auto executableTargetAttr : executableTargetAttrs) {
+      if (!isPIMTarget(executableTargetAttr)) continue;
+
+      // Add our hal.executable.variant with an empty module.
+      auto linkedTargetOp =
+          executableBuilder.create<IREE::HAL::ExecutableVariantOp>(
+              moduleOp.getLoc(), executableTargetAttr.getSymbolNameFragment(),
+              executableTargetAttr);
+      auto targetBuilder = OpBuilder::atBlockBegin(&linkedTargetOp.getBlock());
+      targetBuilder.create<mlir::ModuleOp>(moduleOp.getLoc());
+
+      // Try linking together all executables in moduleOp.
+      if (failed(linkExecutablesInto(
+              moduleOp, sourceExecutableOps, linkedExecutableOp, linkedTargetOp,
+              [](mlir::ModuleOp moduleOp) { return moduleOp; },
+              targetBuilder))) {
+        return signalPassFailure();
+      }
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<OperationPass<mlir::ModuleOp>> createPIMLinkExecutablesPass() {
+  return std::make_unique<PIMLinkExecutablesPass>();
+}
+
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -13,6 +13,7 @@
 #include "iree/compiler/Codegen/Passes.h"
 #include "iree/compiler/Dialect/HAL/IR/HALDialect.h"
 #include "iree/compiler/Dialect/HAL/IR/HALOps.h"
+#include "llvm/Support/Debug.h"
 #include "mlir/Dialect/GPU/IR/GPUDialect.h"
 #include "mlir/Dialect/NVGPU/IR/NVGPUDialect.h"
 #include "mlir/Dialect/PDL/IR/PDL.h"
@@ -24,6 +25,8 @@
 #include "mlir/Pass/PassRegistry.h"
 #include "mlir/Transforms/Passes.h"
 
+#define DEBUG_TYPE "iree-pim-lower-executable-target"
+
 namespace mlir {
 namespace iree_compiler {
 
@@ -119,12 +122,13 @@ static LogicalResult verifyEntryPoint(
 
 void PIMLowerExecutableTargetPass::runOnOperation() {
   // DBG
-  llvm::outs() << "PIMLowerExecutableTargetPass::runOnOperation\n";
+  LLVM_DEBUG(llvm::dbgs() << "PIMLowerExecutableTargetPass::runOnOperation\n");
   IREE::HAL::ExecutableVariantOp variantOp = getOperation();
   ModuleOp moduleOp = variantOp.getInnerModule();
-  // DBG
-  moduleOp.print(llvm::outs());
-  llvm::outs() << "\n";
+  LLVM_DEBUG({
+    moduleOp.print(llvm::dbgs());
+    llvm::dbgs() << "\n";
+  });
   
   /*
   std::size_t found;
@@ -143,8 +147,6 @@ void PIMLowerExecutableTargetPass::runOnOperation() {
     return signalPassFailure();
   }
   // DBG
-  // moduleOp.print(llvm::outs());
-  // llvm::outs() << "\n";
 
   // There might be multiple entry points in the module. Currently, all of
   // them need to have the same pipeline.
@@ -0,0 +1,132 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <map>
+#include <tuple>
+
+#include "iree/compiler/Codegen/PassDetail.h"
+#include "iree/compiler/Codegen/Passes.h"
+#include "iree/compiler/Dialect/HAL/IR/HALOps.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/Pass/Pass.h"
+
+#define DEBUG_TYPE "iree-pim-materialize-binding-views"
+
+namespace mlir {
+namespace iree_compiler {
+
+namespace {
+
+// Returns the byte offset of a binding view as encoded in the binding_offsets
+// of the PIM executable: the offset itself if it is constant or -1 - c if it
+// is read from push constant c. Returns std::nullopt for offsets computed in
+// any other way.
+static Optional<int32_t> getViewByteOffset(Value byteOffset) {
+  if (!byteOffset) return 0;
+  APInt value;
+  if (matchPattern(byteOffset, m_ConstantInt(&value))) {
+    if (value.isNegative() || !value.isSignedIntN(32)) return std::nullopt;
+    return static_cast<int32_t>(value.getSExtValue());
+  }
+  // Offsets are packed into 32-bit push constants by
+  // iree-stream-pack-dispatch-operands.
+  while (Operation *defOp = byteOffset.getDefiningOp()) {
+    if (!isa<arith::IndexCastOp, arith::IndexCastUIOp>(defOp)) break;
+    byteOffset = defOp->getOperand(0);
+  }
+  auto loadOp = byteOffset.getDefiningOp<IREE::HAL::InterfaceConstantLoadOp>();
+  if (!loadOp || !loadOp.getType().isInteger(32)) return std::nullopt;
+  return -1 - static_cast<int32_t>(loadOp.getIndex().getZExtValue());
+}
+
+// A tensor bound at |byteOffset| of binding |binding|.
+struct BindingView {
+  int64_t binding;
+  int32_t byteOffset;
+  bool operator<(const BindingView &other) const {
+    return std::tie(binding, byteOffset) <
+           std::tie(other.binding, other.byteOffset);
+  }
+};
+
+// Renumbers the binding subspans of functions whose bindings were fused by
+// iree-stream-fuse-dispatch-bindings so that each tensor they hold (such as
+// the weights and biases of a layer) becomes a binding of its own. The PIM
+// program addresses whole bindings so fused bindings are read through the
+// views listed in the pim.binding_views attribute of the function as pairs of
+// dispatch binding ordinals and byte offsets (see binding_sources and
+// binding_offsets in pim_executable_def.fbs).
+struct PIMMaterializeBindingViewsPass
+    : public PIMMaterializeBindingViewsBase<PIMMaterializeBindingViewsPass> {
+  void runOnOperation() override {
+    for (auto funcOp : getOperation().getOps<func::FuncOp>()) {
+      if (failed(materializeBindingViews(funcOp))) return signalPassFailure();
+    }
+  }
+
+  LogicalResult materializeBindingViews(func::FuncOp funcOp) {
+    SmallVector<IREE::HAL::InterfaceBindingSubspanOp> subspanOps;
+    std::map<BindingView, int64_t> viewOrdinals;
+    SmallVector<BindingView> subspanViews;
+    bool hasOffsets = false;
+    WalkResult walkResult =
+        funcOp.walk([&](IREE::HAL::InterfaceBindingSubspanOp subspanOp) {
+          Optional<int32_t> byteOffset =
+              getViewByteOffset(subspanOp.getByteOffset());
+          if (!byteOffset) {
+            subspanOp.emitOpError()
+                << "byte offset must be a constant or a push constant to "
+                   "be addressed by a PIM program";
+            return WalkResult::interrupt();
+          }
+          BindingView view = {subspanOp.getBinding().getSExtValue(),
+                              *byteOffset};
+          viewOrdinals.emplace(view, 0);
+          subspanOps.push_back(subspanOp);
+          subspanViews.push_back(view);
+          hasOffsets |= *byteOffset != 0;
+          return WalkResult::advance();
+        });
+    if (walkResult.wasInterrupted()) return failure();
+
+    // Bindings holding a single tensor at their start are bound as-is.
+    if (!hasOffsets) return success();
+
+    // Views are ordered by the bindings they view so that the result binding
+    // stays last.
+    SmallVector<int32_t> viewAttrs;
+    for (auto &[view, ordinal] : viewOrdinals) {
+      ordinal = viewAttrs.size() / 2;
+      viewAttrs.push_back(static_cast<int32_t>(view.binding));
+      viewAttrs.push_back(view.byteOffset);
+    }
+    Builder builder(funcOp.getContext());
+    for (auto [subspanOp, view] : llvm::zip_equal(subspanOps, subspanViews)) {
+      subspanOp.setBindingAttr(builder.getIndexAttr(viewOrdinals[view]));
+      subspanOp.getByteOffsetMutable().clear();
+    }
+    funcOp->setAttr("pim.binding_views",
+                    builder.getDenseI32ArrayAttr(viewAttrs));
+    LLVM_DEBUG(llvm::dbgs() << "materialized " << viewOrdinals.size()
+                            << " binding views in @" << funcOp.getName()
+                            << "\n");
+    return success();
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<OperationPass<ModuleOp>>
+createPIMMaterializeBindingViewsPass() {
+  return std::make_unique<PIMMaterializeBindingViewsPass>();
+}
+
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -33,7 +33,6 @@
 #include "mlir/Pass/PassRegistry.h"
 #include "mlir/Transforms/Passes.h"
 
-#include <iostream>
 
 #define DEBUG_TYPE "iree-pim-lowering-pass-pipeline"
 
@@ -81,9 +80,13 @@ static void addPIMLoweringPasses(OpPassManager &pm) {
 
   pm.addPass(createLowerAffinePass());
 
+  // Operands of fused bindings are read through views of the bindings.
+  pm.addPass(createPIMMaterializeBindingViewsPass());
+
   pm.addPass(createConvertToPIMPass());
 
-  // TODO: additional optimization passes for PIM operations
+  // Folds repeated PIM instructions.
+  pm.addPass(createCanonicalizerPass());
 
 }
 
@@ -107,7 +110,7 @@ void addPIMMatmulPassPipeline(OpPassManager &pm) {
 //===----------------------------------------------------------------------===//
 
 void buildPIMCodegenPassPipeline(OpPassManager &pm) {
-  std::cout << "PIMLowerExecutableTarget.cpp: PIMCodegenPassPipeline\n";
+  LLVM_DEBUG(llvm::dbgs() << "PIMLowerExecutableTarget.cpp: PIMCodegenPassPipeline\n");
   pm.nest<ModuleOp>().nest<func::FuncOp>().addPass(createTypePropagationPass());
   pm.nest<ModuleOp>().addPass(createBufferizeCopyOnlyDispatchesPass());
   pm.nest<ModuleOp>().addNestedPass<func::FuncOp>(
@@ -130,5 +133,16 @@ void buildPIMCodegenPassPipeline(OpPassManager &pm) {
   });
 }
 
+// NOTE: this runs on the top-level program module containing all
+// hal.executable ops.
+void buildPIMLinkingPassPipeline(OpPassManager &passManager) {
+  // Link together executables. This may produce some IR duplication.
+  passManager.addPass(createPIMLinkExecutablesPass());
+
+  // Cleanup IR duplication.
+  passManager.addNestedPass<IREE::HAL::ExecutableOp>(
+      mlir::createCanonicalizerPass());
+}
+
 }  // namespace iree_compiler
 }  // namespace mlir
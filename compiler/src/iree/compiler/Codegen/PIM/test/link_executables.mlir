@@ -0,0 +1,67 @@
+// RUN: iree-opt --split-input-file --iree-pim-link-executables %s | FileCheck %s
+
+#pim_target = #hal.executable.target<"pim", "pim-isr-fb">
+#cpu_target = #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64">
+#pipeline_layout = #hal.pipeline.layout<push_constants = 0, sets = [
+  #hal.descriptor_set.layout<0, bindings = [
+    #hal.descriptor_set.binding<0, storage_buffer>,
+    #hal.descriptor_set.binding<1, storage_buffer>
+  ]>
+]>
+
+hal.executable private @dispatch_0 {
+  hal.executable.variant @pim, target = #pim_target {
+    hal.executable.export @dispatch_0 ordinal(0) layout(#pipeline_layout)
+    builtin.module {
+      func.func @dispatch_0() {
+        return
+      }
+    }
+  }
+}
+hal.executable private @dispatch_1 {
+  hal.executable.variant @pim, target = #pim_target {
+    hal.executable.export @dispatch_1 ordinal(0) layout(#pipeline_layout)
+    builtin.module {
+      func.func @dispatch_1() {
+        return
+      }
+    }
+  }
+}
+hal.executable private @dispatch_2 {
+  hal.executable.variant @cpu, target = #cpu_target {
+    hal.executable.export @dispatch_2 ordinal(0) layout(#pipeline_layout)
+    builtin.module {
+      func.func @dispatch_2() {
+        return
+      }
+    }
+  }
+}
+func.func @basic_linking(%cmd: !hal.command_buffer) {
+  %c1 = arith.constant 1 : index
+  hal.command_buffer.dispatch.symbol<%cmd : !hal.command_buffer> target(@dispatch_0::@pim::@dispatch_0) workgroups([%c1, %c1, %c1])
+  hal.command_buffer.dispatch.symbol<%cmd : !hal.command_buffer> target(@dispatch_1::@pim::@dispatch_1) workgroups([%c1, %c1, %c1])
+  hal.command_buffer.dispatch.symbol<%cmd : !hal.command_buffer> target(@dispatch_2::@cpu::@dispatch_2) workgroups([%c1, %c1, %c1])
+  return
+}
+
+// PIM executables are linked into one with an export per dispatch while
+// executables of other backends are left to those backends.
+// CHECK-NOT: hal.executable private @dispatch_0
+// CHECK-NOT: hal.executable private @dispatch_1
+// CHECK:       hal.executable private @link_executables_linked_pim {
+// CHECK-NEXT:    hal.executable.variant public @pim_isr_fb, target = #executable_target_pim_isr_fb {
+// CHECK-NEXT:      hal.executable.export public @dispatch_0 ordinal(0)
+// CHECK-NEXT:      hal.executable.export public @dispatch_1 ordinal(1)
+// CHECK-NEXT:      module {
+// CHECK-NEXT:        func.func @dispatch_0()
+//      CHECK:        func.func @dispatch_1()
+//      CHECK:  hal.executable private @dispatch_2
+// CHECK-NEXT:    hal.executable.variant public @cpu
+//
+// CHECK:       func.func @basic_linking
+// CHECK:         hal.command_buffer.dispatch.symbol<%{{.+}} : !hal.command_buffer> target(@link_executables_linked_pim::@pim_isr_fb::@dispatch_0)
+// CHECK-NEXT:    hal.command_buffer.dispatch.symbol<%{{.+}} : !hal.command_buffer> target(@link_executables_linked_pim::@pim_isr_fb::@dispatch_1)
+// CHECK-NEXT:    hal.command_buffer.dispatch.symbol<%{{.+}} : !hal.command_buffer> target(@dispatch_2::@cpu::@dispatch_2)
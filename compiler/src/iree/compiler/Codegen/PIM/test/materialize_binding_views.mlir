@@ -0,0 +1,47 @@
+// RUN: iree-opt --split-input-file --iree-pim-materialize-binding-views --verify-diagnostics %s | FileCheck %s
+
+// Tests that the weights and biases of a layer bound through one fused binding
+// become views of their own ahead of the result binding.
+
+// CHECK-LABEL: func.func @fusedWeightsAndBiases
+// CHECK-SAME: pim.binding_views = array<i32: 0, -1, 0, 0, 0, 3072, 1, 0>
+func.func @fusedWeightsAndBiases() {
+  %c0 = arith.constant 0 : index
+  %c3072 = arith.constant 3072 : index
+  %0 = hal.interface.constant.load[0] : i32
+  %1 = arith.index_castui %0 : i32 to index
+  // CHECK: hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) flags(ReadOnly) : !flow.dispatch.tensor<readonly:tensor<768x768xf32>>
+  %weights = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) offset(%c0) flags(ReadOnly) : !flow.dispatch.tensor<readonly:tensor<768x768xf32>>
+  // CHECK: hal.interface.binding.subspan set(0) binding(2) type(storage_buffer) flags(ReadOnly) : !flow.dispatch.tensor<readonly:tensor<768xf32>>
+  %biases = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) offset(%c3072) flags(ReadOnly) : !flow.dispatch.tensor<readonly:tensor<768xf32>>
+  // CHECK: hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) flags(ReadOnly) : !flow.dispatch.tensor<readonly:tensor<1x768xf32>>
+  %input = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) offset(%1) flags(ReadOnly) : !flow.dispatch.tensor<readonly:tensor<1x768xf32>>
+  // CHECK: hal.interface.binding.subspan set(0) binding(3) type(storage_buffer) : !flow.dispatch.tensor<writeonly:tensor<1x768xf32>>
+  %result = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) offset(%c0) : !flow.dispatch.tensor<writeonly:tensor<1x768xf32>>
+  return
+}
+
+// -----
+
+// Tests that bindings holding a single tensor are left as-is.
+
+// CHECK-LABEL: func.func @unfusedBindings()
+// CHECK-NOT: pim.binding_views
+func.func @unfusedBindings() {
+  %c0 = arith.constant 0 : index
+  // CHECK: hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) offset(%{{.+}})
+  %input = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) offset(%c0) flags(ReadOnly) : !flow.dispatch.tensor<readonly:tensor<768xf32>>
+  // CHECK: hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) offset(%{{.+}})
+  %result = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) offset(%c0) : !flow.dispatch.tensor<writeonly:tensor<768xf32>>
+  return
+}
+
+// -----
+
+func.func @dynamicOffset(%offset: index) {
+  %c64 = arith.constant 64 : index
+  %0 = arith.muli %offset, %c64 : index
+  // expected-error @+1 {{byte offset must be a constant or a push constant to be addressed by a PIM program}}
+  %input = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) offset(%0) flags(ReadOnly) : !flow.dispatch.tensor<readonly:tensor<768xf32>>
+  return
+}
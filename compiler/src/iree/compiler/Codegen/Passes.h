@@ -323,6 +323,11 @@ void addCPUDefaultPassPipeline(OpPassManager &passManager);
 /// Populates the passes to lower ops through data tiling transformations.
 void addCPUDataTilingPipeline(OpPassManager &passManager);
 
+/// Populates the passes to lower Winograd input and output transforms by
+/// decomposing them into matmuls with the transform matrices on each tile
+/// and vectorizing these.
+void addCPUWinogradVectorizePassPipeline(OpPassManager &passManager);
+
 /// Populates the passes to lower to tiled/distributed/bufferized ops,
 /// suitable for library call dispatch and lowering to loops.
 void addVMVXDefaultPassPipeline(OpPassManager &passManager,
@@ -555,6 +560,11 @@ std::unique_ptr<OperationPass<func::FuncOp>> createSPIRVTileAndDistributePass();
 std::unique_ptr<OperationPass<func::FuncOp>> createSPIRVTileAndPromotePass(
     bool promoteCMatrix = false, bool skipThreadLevel = false);
 
+/// Pass to pad matmuls with tensor semantics whose static shapes are not
+/// multiples of their cooperative matrix workgroup and reduction tile sizes.
+std::unique_ptr<OperationPass<func::FuncOp>>
+createSPIRVPadCooperativeMatmulPass();
+
 /// Pass to tile Linalg ops with buffer semantics suitable for lowering to
 /// SPIR-V cooperative ops.
 std::unique_ptr<OperationPass<func::FuncOp>>
@@ -669,6 +679,17 @@ std::unique_ptr<OperationPass<IREE::HAL::ExecutableVariantOp>>
 createPIMLowerExecutableTargetPass();
 void addPIMMatmulPassPipeline(OpPassManager &pm);
 
+/// Renumbers the binding subspans of fused bindings into views of the
+/// bindings at their byte offsets so that PIM programs address each tensor as
+/// a binding of its own.
+std::unique_ptr<OperationPass<ModuleOp>> createPIMMaterializeBindingViewsPass();
+
+/// Links PIM HAL executables within the top-level program module.
+std::unique_ptr<OperationPass<mlir::ModuleOp>> createPIMLinkExecutablesPass();
+
+/// Populates passes needed to link HAL executables across PIM targets.
+void buildPIMLinkingPassPipeline(OpPassManager &passManager);
+
 //------------------------------------------------------------------------------
 // Test passes
 //------------------------------------------------------------------------------
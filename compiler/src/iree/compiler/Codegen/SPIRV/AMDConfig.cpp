@@ -28,19 +28,19 @@ namespace detail {
 constexpr unsigned AMDSimtSoftwarePipelineDepth = 2;
 constexpr unsigned AMDSimtSoftwarePipelineStoreStage = 0;
 
-constexpr unsigned AMDCoopMatrixSoftwarePipelineDepth = 1;
-constexpr unsigned AMDCoopMatrixSoftwarePipelineStoreStage = 0;
-
-constexpr unsigned AMDNumSubgroupsPerWorkgroup = 4;
-// The number of tiles along M and N dimensions per workgroup.
-constexpr unsigned AMDNumMNTilesPerSubgroup = 8;
+// Cooperative matrix configurations keyed by the LHS element bitwidth. The
+// pipeline depth is an upper bound lowered until the multi-buffered tiles fit
+// in shared memory; RDNA3 keeps two K tiles in flight for f16 when they fit.
+static const CooperativeMatrixTuning AMDCoopMatrixTuningTable[] = {
+    // {lhsBitwidth, #subgroups, #MN tiles per subgroup, depth, store stage}
+    {8, 4, 8, 1, 0},
+    {16, 4, 8, 2, 0},
+};
 
 static LogicalResult setAMDMatmulConfig(linalg::LinalgOp op,
                                         const spirv::TargetEnv &targetEnv) {
-  if (failed(setCooperativeMatrixConfig(
-          targetEnv, op, AMDNumSubgroupsPerWorkgroup, AMDNumMNTilesPerSubgroup,
-          AMDCoopMatrixSoftwarePipelineDepth,
-          AMDCoopMatrixSoftwarePipelineStoreStage)))
+  if (failed(setCooperativeMatrixConfig(targetEnv, op,
+                                        AMDCoopMatrixTuningTable)))
     return failure();
   if (getLoweringConfig(op)) return success();
 
@@ -693,12 +693,14 @@ struct CooperativeMatrixSize {
 };
 
 /// Returns the cooperative matrix (M, N, K) sizes that are supported by the
-/// target environment and match the given parameters.
+/// target environment and match the given parameters. If `allowPadding` is
+/// true, (M, N, K) that are not multiples of the cooperative matrix sizes are
+/// rounded up to them.
 static Optional<CooperativeMatrixSize> getCooperativeMatrixSize(
     spirv::ResourceLimitsAttr resourceLimits,
     const unsigned numSubgroupsPerWorkgroup,
     const unsigned numMNTilesPerSubgroup, Type aType, Type bType, Type cType,
-    int64_t m, int64_t n, int64_t k) {
+    int64_t m, int64_t n, int64_t k, bool allowPadding) {
   auto properties = resourceLimits.getCooperativeMatrixPropertiesNv()
                         .getAsRange<spirv::CooperativeMatrixPropertiesNVAttr>();
   for (auto property : properties) {
@@ -711,10 +713,17 @@ static Optional<CooperativeMatrixSize> getCooperativeMatrixSize(
     const unsigned matmulM = property.getMSize();
     const unsigned matmulN = property.getNSize();
     const unsigned matmulK = property.getKSize();
-    if (m % matmulM != 0 || n % matmulN != 0 || k % matmulK != 0) continue;
+    if (m % matmulM != 0 || n % matmulN != 0 || k % matmulK != 0) {
+      // Padding problems smaller than a single cooperative matrix would mostly
+      // compute zeros; leave them to the SIMT pipeline.
+      if (!allowPadding || m < matmulM || n < matmulN || k < matmulK) continue;
+    }
+    const int64_t paddedM = llvm::alignTo(m, matmulM);
+    const int64_t paddedN = llvm::alignTo(n, matmulN);
+    const int64_t paddedK = llvm::alignTo(k, matmulK);
 
-    uint64_t nTotalTileCount = n / matmulN;
-    uint64_t mTotalTileCount = m / matmulM;
+    uint64_t nTotalTileCount = paddedN / matmulN;
+    uint64_t mTotalTileCount = paddedM / matmulM;
 
     uint64_t remainingWarps = numSubgroupsPerWorkgroup;
     uint64_t remainingTiles = numMNTilesPerSubgroup;
@@ -769,7 +778,7 @@ static Optional<CooperativeMatrixSize> getCooperativeMatrixSize(
       mTileCount = mGCD.getSExtValue();
     }
 
-    const uint64_t kTotalTileCount = k / matmulK;
+    const uint64_t kTotalTileCount = paddedK / matmulK;
     APInt kGCD = GreatestCommonDivisor(APInt(64, kTotalTileCount),
                                        APInt(64, numTilesPerSubgroupDimK));
     int64_t kTileCount = kGCD.getSExtValue();
@@ -837,11 +846,23 @@ LogicalResult setCooperativeMatrixConfig(
   };
 
   spirv::ResourceLimitsAttr limits = targetEnv.getResourceLimits();
+  // Prefer cooperative matrix sizes that need no padding.
+  bool needsPadding = false;
   Optional<CooperativeMatrixSize> coopMatSize = getCooperativeMatrixSize(
       limits, numSubgroupsPerWorkgroup, numMNTilesPerSubgroup,
       getElementType(lhs), getElementType(rhs), getElementType(init), dimM,
-      dimN, dimK);
+      dimN, dimK, /*allowPadding=*/false);
+  if (!coopMatSize) {
+    coopMatSize = getCooperativeMatrixSize(
+        limits, numSubgroupsPerWorkgroup, numMNTilesPerSubgroup,
+        getElementType(lhs), getElementType(rhs), getElementType(init), dimM,
+        dimN, dimK, /*allowPadding=*/true);
+    needsPadding = coopMatSize.has_value();
+  }
   if (!coopMatSize) return success();
+  LLVM_DEBUG({
+    if (needsPadding) llvm::dbgs() << "padding to cooperative matrix sizes\n";
+  });
 
   auto pipeline = IREE::Codegen::DispatchLoweringPassPipeline::
       SPIRVCooperativeMatrixVectorize;
@@ -896,11 +917,20 @@ LogicalResult setCooperativeMatrixConfig(
     pipelineDepth = 0;
     storeStage = 0;
   }
+  // Only keep more than one extra stage in flight when the reduction loop has
+  // enough iterations to fill them.
+  const int64_t kIterationCount =
+      llvm::alignTo(dimK, reductionTileSizes[kIndex]) /
+      reductionTileSizes[kIndex];
+  if (pipelineDepth > 1 && kIterationCount - 1 < pipelineDepth) {
+    pipelineDepth = std::max<int64_t>(kIterationCount - 1, 1);
+  }
 
   // Check if the C matrix will be promoted for computing shared memory usage.
   auto matmulResult = op.getDpsInitOperand(0)->get();
+  // Padded results are sliced before being stored so C is always promoted.
   bool promoteC =
-      !matmulResult.hasOneUse() ||
+      needsPadding || !matmulResult.hasOneUse() ||
       !isa<IREE::Flow::DispatchTensorStoreOp>(*matmulResult.getUsers().begin());
 
   // Decrease pipeline depth until it fits in shared memory.
@@ -921,6 +951,22 @@ LogicalResult setCooperativeMatrixConfig(
       workgroupSize, subgroupSize, pipelineDepth, storeStage);
 }
 
+LogicalResult setCooperativeMatrixConfig(
+    const spirv::TargetEnv &targetEnv, linalg::LinalgOp op,
+    ArrayRef<CooperativeMatrixTuning> tuningTable) {
+  auto lhsType = op.getDpsInputOperand(0)->get().getType().cast<ShapedType>();
+  if (!lhsType.getElementType().isIntOrFloat()) return success();
+  unsigned lhsBitwidth = lhsType.getElementType().getIntOrFloatBitWidth();
+  for (const CooperativeMatrixTuning &tuning : tuningTable) {
+    if (tuning.lhsBitwidth != lhsBitwidth) continue;
+    return setCooperativeMatrixConfig(
+        targetEnv, op, tuning.numSubgroupsPerWorkgroup,
+        tuning.numMNTilesPerSubgroup, tuning.softwarePipelineDepth,
+        tuning.softwarePipelineStoreStage);
+  }
+  return success();
+}
+
 }  // namespace detail
 
 //===----------------------------------------------------------------------===//
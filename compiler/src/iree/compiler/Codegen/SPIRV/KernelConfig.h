@@ -63,7 +63,8 @@ LogicalResult setMatmulOpConfig(
 
 /// Sets CodeGen configurations via attributes to the given matmul `linalgOp`
 /// with tile sizes for cooperative matrix, if possible for the given matmul
-/// size.
+/// size. Static shapes not aligned to the cooperative matrix sizes are padded
+/// up to whole cooperative matrices by the pipeline.
 LogicalResult setCooperativeMatrixConfig(
     const spirv::TargetEnv &targetEnv, linalg::LinalgOp op,
     const unsigned numSubgroupsPerWorkgroup,
@@ -72,6 +73,23 @@ LogicalResult setCooperativeMatrixConfig(
     unsigned softwarePipelineStoreStage =
         defaultCoopMatrixSoftwarePipelineStoreStage);
 
+/// Cooperative matrix pipeline parameters for matmuls whose LHS element type
+/// has `lhsBitwidth` bits.
+struct CooperativeMatrixTuning {
+  unsigned lhsBitwidth;
+  unsigned numSubgroupsPerWorkgroup;
+  unsigned numMNTilesPerSubgroup;
+  unsigned softwarePipelineDepth;
+  unsigned softwarePipelineStoreStage;
+};
+
+/// Sets CodeGen configurations via attributes to the given matmul `linalgOp`
+/// with tile sizes for cooperative matrix using the entry of `tuningTable`
+/// matching its LHS element bitwidth, if any.
+LogicalResult setCooperativeMatrixConfig(
+    const spirv::TargetEnv &targetEnv, linalg::LinalgOp op,
+    ArrayRef<CooperativeMatrixTuning> tuningTable);
+
 /// Sets CodeGen configuration for GPUs from a specific vendor.
 ///
 /// If the given `rootOp` has known good CodeGen configuration, attaches a
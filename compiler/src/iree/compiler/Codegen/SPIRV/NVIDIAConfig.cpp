@@ -24,21 +24,26 @@
 
 using llvm::APIntOps::GreatestCommonDivisor;
 
-constexpr unsigned NVIDIANumSubgroupsPerWorkgroup = 4;
-// The number of tiles along M and N dimensions per workgroup.
-constexpr unsigned NVIDIANumMNTilesPerSubgroup = 4;
-
 namespace mlir {
 namespace iree_compiler {
 namespace detail {
 
+// Cooperative matrix configurations keyed by the LHS element bitwidth. The
+// pipeline depth is an upper bound lowered until the multi-buffered tiles fit
+// in shared memory; f16 keeps two K tiles in flight to hide global memory
+// latency behind the tensor core math.
+static const CooperativeMatrixTuning NVIDIACoopMatrixTuningTable[] = {
+    // {lhsBitwidth, #subgroups, #MN tiles per subgroup, depth, store stage}
+    {8, 4, 4, 1, 0},
+    {16, 4, 4, 2, 0},
+};
+
 static LogicalResult setNVIDIAMatmulConfig(linalg::LinalgOp op,
                                            const spirv::TargetEnv &targetEnv) {
   // First try to see if we can use tensor cores.
   spirv::ResourceLimitsAttr limits = targetEnv.getResourceLimits();
   if (failed(setCooperativeMatrixConfig(targetEnv, op,
-                                        NVIDIANumSubgroupsPerWorkgroup,
-                                        NVIDIANumMNTilesPerSubgroup)))
+                                        NVIDIACoopMatrixTuningTable)))
     return failure();
   if (getLoweringConfig(op)) return success();
 
@@ -279,8 +279,12 @@ void addSPIRVBaseVectorizePassPipeline(OpPassManager &pm) {
 void addSPIRVCooperativeMatrixVectorizePassPipeline(OpPassManager &pm,
                                                     unsigned pipelineDepth,
                                                     unsigned storeStage) {
+  // Pad unaligned matmuls to whole cooperative matrix tiles before tiling so
+  // that every workgroup sees the same static shape.
+  pm.nest<ModuleOp>().addNestedPass<func::FuncOp>(
+      createSPIRVPadCooperativeMatmulPass());
   addTileAndDistributeToWorkgroupsPasses(
-      pm, /*useFuseTensorPadWithConsumerPass=*/false,
+      pm, /*useFuseTensorPadWithConsumerPass=*/true,
       /*useWARForCooperativeMatrixCodegen=*/true);
 
   auto &nestedModulePM = pm.nest<ModuleOp>();
@@ -0,0 +1,165 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//===----------------------------------------------------------------------===//
+//
+// This file implements a pass to pad matmuls lowered to cooperative matrix ops
+// whose static shapes are not multiples of their workgroup and reduction tile
+// sizes. The operands are padded with zeros up to the tile sizes chosen by the
+// kernel configuration so that every workgroup computes whole cooperative
+// matrices, and the original shape is sliced out of the padded result.
+//
+//===----------------------------------------------------------------------===//
+
+#include "iree/compiler/Codegen/Dialect/LoweringConfig.h"
+#include "iree/compiler/Codegen/PassDetail.h"
+#include "iree/compiler/Codegen/Passes.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Linalg/Utils/Utils.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/PatternMatch.h"
+
+#define DEBUG_TYPE "iree-spirv-pad-cooperative-matmul"
+
+namespace mlir {
+namespace iree_compiler {
+
+namespace {
+
+/// Returns the static loop ranges of `linalgOp` rounded up to multiples of its
+/// workgroup tile sizes for parallel loops and its reduction tile sizes for
+/// reduction loops. Returns std::nullopt if no loop needs padding.
+static Optional<SmallVector<int64_t>> getPaddedLoopRanges(
+    linalg::LinalgOp linalgOp) {
+  if (linalgOp.hasDynamicShape()) return std::nullopt;
+  // Tiling levels of the SPIRVCooperativeMatrixVectorize pipeline.
+  SmallVector<int64_t> workgroupTileSizes = getTileSizes(linalgOp, 0);
+  SmallVector<int64_t> reductionTileSizes = getTileSizes(linalgOp, 2);
+
+  SmallVector<int64_t> loopRanges = linalgOp.getStaticLoopRanges();
+  bool needsPadding = false;
+  for (unsigned i = 0, e = loopRanges.size(); i < e; ++i) {
+    int64_t tileSize = 0;
+    if (i < workgroupTileSizes.size()) tileSize = workgroupTileSizes[i];
+    if (tileSize == 0 && i < reductionTileSizes.size()) {
+      tileSize = reductionTileSizes[i];
+    }
+    if (tileSize <= 0 || loopRanges[i] % tileSize == 0) continue;
+    loopRanges[i] = llvm::alignTo(loopRanges[i], tileSize);
+    needsPadding = true;
+  }
+  if (!needsPadding) return std::nullopt;
+  return loopRanges;
+}
+
+/// Pads all operands of `linalgOp` to `paddedLoopRanges` and replaces it with
+/// a clone computing on the padded operands.
+static LogicalResult padToLoopRanges(IRRewriter &rewriter,
+                                     linalg::LinalgOp linalgOp,
+                                     ArrayRef<int64_t> paddedLoopRanges) {
+  Location loc = linalgOp.getLoc();
+  rewriter.setInsertionPoint(linalgOp);
+
+  SmallVector<Value> paddedOperands;
+  paddedOperands.reserve(linalgOp->getNumOperands());
+  for (OpOperand &opOperand : linalgOp->getOpOperands()) {
+    auto tensorType = opOperand.get().getType().dyn_cast<RankedTensorType>();
+    if (!tensorType) {
+      return rewriter.notifyMatchFailure(linalgOp, "expected tensor operands");
+    }
+    AffineMap indexingMap = linalgOp.getMatchingIndexingMap(&opOperand);
+    SmallVector<int64_t> paddedShape;
+    for (AffineExpr expr : indexingMap.getResults()) {
+      auto dimExpr = expr.dyn_cast<AffineDimExpr>();
+      if (!dimExpr) {
+        return rewriter.notifyMatchFailure(
+            linalgOp, "expected projected permutation indexing maps");
+      }
+      paddedShape.push_back(paddedLoopRanges[dimExpr.getPosition()]);
+    }
+
+    Value paddingValue = rewriter.create<arith::ConstantOp>(
+        loc, rewriter.getZeroAttr(tensorType.getElementType()));
+    auto paddedType =
+        RankedTensorType::get(paddedShape, tensorType.getElementType());
+    paddedOperands.push_back(linalg::makeComposedPadHighOp(
+        rewriter, loc, paddedType, opOperand.get(), paddingValue,
+        /*nofold=*/false));
+  }
+
+  auto resultTypes = ValueRange(paddedOperands)
+                         .take_back(linalgOp.getNumDpsInits())
+                         .getTypes();
+  linalg::LinalgOp paddedOp =
+      mlir::clone(rewriter, linalgOp, resultTypes, paddedOperands);
+
+  // Slice the original shapes out of the padded results for the consumers.
+  SmallVector<Value> results;
+  for (auto [result, paddedResult] :
+       llvm::zip(linalgOp->getResults(), paddedOp->getResults())) {
+    auto resultType = result.getType().cast<RankedTensorType>();
+    int64_t rank = resultType.getRank();
+    SmallVector<OpFoldResult> offsets(rank, rewriter.getIndexAttr(0));
+    SmallVector<OpFoldResult> sizes;
+    for (int64_t size : resultType.getShape()) {
+      sizes.push_back(rewriter.getIndexAttr(size));
+    }
+    SmallVector<OpFoldResult> strides(rank, rewriter.getIndexAttr(1));
+    results.push_back(rewriter.create<tensor::ExtractSliceOp>(
+        loc, resultType, paddedResult, offsets, sizes, strides));
+  }
+  rewriter.replaceOp(linalgOp, results);
+  return success();
+}
+
+struct SPIRVPadCooperativeMatmulPass
+    : public SPIRVPadCooperativeMatmulBase<SPIRVPadCooperativeMatmulPass> {
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<arith::ArithDialect, tensor::TensorDialect>();
+  }
+
+  void runOnOperation() override {
+    func::FuncOp funcOp = getOperation();
+
+    SmallVector<linalg::LinalgOp> candidates;
+    funcOp.walk([&](linalg::LinalgOp linalgOp) {
+      if (linalgOp.hasTensorSemantics() && getLoweringConfig(linalgOp) &&
+          linalg::isaContractionOpInterface(linalgOp)) {
+        candidates.push_back(linalgOp);
+      }
+    });
+
+    IRRewriter rewriter(funcOp.getContext());
+    for (linalg::LinalgOp linalgOp : candidates) {
+      Optional<SmallVector<int64_t>> paddedLoopRanges =
+          getPaddedLoopRanges(linalgOp);
+      if (!paddedLoopRanges) continue;
+      LLVM_DEBUG({
+        llvm::dbgs() << "padding loop ranges of " << linalgOp << " to (";
+        llvm::interleaveComma(*paddedLoopRanges, llvm::dbgs());
+        llvm::dbgs() << ")\n";
+      });
+      if (failed(padToLoopRanges(rewriter, linalgOp, *paddedLoopRanges))) {
+        linalgOp->emitOpError("failed to pad to cooperative matrix tiles");
+        return signalPassFailure();
+      }
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<OperationPass<func::FuncOp>>
+createSPIRVPadCooperativeMatmulPass() {
+  return std::make_unique<SPIRVPadCooperativeMatmulPass>();
+}
+
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -227,6 +227,10 @@ void SPIRVTileAndPromotePass::runOnOperation() {
       return signalPassFailure();
     }
 
+    // Compute fused elementwise producers of the operands tile by tile
+    // straight into shared memory.
+    fuseProducersIntoSharedMemoryCopy(funcOp);
+
     // Insert barriers before and after copies to workgroup memory.
     insertBarriersAroundSharedMemoryCopy(funcOp);
 
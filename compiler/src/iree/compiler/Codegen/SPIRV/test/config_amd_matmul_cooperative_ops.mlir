@@ -332,3 +332,62 @@ hal.executable public @matmul_256x1024x8 {
 //   CHECK-NOT:   subgroup_size =
 //  CHECK-SAME:   translation_info = #[[$TRANSLATION]]
 //   CHECK-NOT:   subgroup_size =
+
+// -----
+
+// Unaligned M, N and K dims are padded up to whole cooperative matrices.
+
+#pipeline_layout = #hal.pipeline.layout<push_constants = 0, sets = [
+  #hal.descriptor_set.layout<0, bindings = [
+    #hal.descriptor_set.binding<0, storage_buffer>,
+    #hal.descriptor_set.binding<1, storage_buffer>,
+    #hal.descriptor_set.binding<2, storage_buffer>
+  ]>
+]>
+hal.executable public @matmul_250x1020x120 {
+  hal.executable.variant @vulkan, target = <"vulkan-spirv", "vulkan-spirv-fb", {
+    spirv.target_env = #spirv.target_env<
+      #spirv.vce<v1.6,
+      [Shader, Float16, StorageBuffer16BitAccess, StorageUniform16, CooperativeMatrixNV],
+      [SPV_KHR_variable_pointers, SPV_NV_cooperative_matrix]>, AMD:DiscreteGPU,
+      #spirv.resource_limits<
+        cooperative_matrix_properties_nv = [
+          #spirv.coop_matrix_props<
+            a_type = f16, b_type = f16, c_type = f16, k_size = 16,
+            m_size = 16, n_size = 16, result_type = f16, scope = <Subgroup>>
+        ],
+        max_compute_shared_memory_size = 65536,
+        max_compute_workgroup_invocations = 1024,
+        max_compute_workgroup_size = [1024, 1024, 1024],
+        subgroup_size = 64, min_subgroup_size = 32, max_subgroup_size = 64>
+       >}> {
+    hal.executable.export public @matmul_250x1020x120 layout(#pipeline_layout)
+    builtin.module {
+      func.func @matmul_250x1020x120() {
+        %c0 = arith.constant 0 : index
+        %cst = arith.constant 0.000000e+00 : f16
+        %0 = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) : !flow.dispatch.tensor<readonly:tensor<250x120xf16>>
+        %1 = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) : !flow.dispatch.tensor<readonly:tensor<120x1020xf16>>
+        %2 = hal.interface.binding.subspan set(0) binding(2) type(storage_buffer) : !flow.dispatch.tensor<writeonly:tensor<250x1020xf16>>
+        %3 = flow.dispatch.tensor.load %0, offsets = [0, 0], sizes = [250, 120], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<250x120xf16>> -> tensor<250x120xf16>
+        %4 = flow.dispatch.tensor.load %1, offsets = [0, 0], sizes = [120, 1020], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<120x1020xf16>> -> tensor<120x1020xf16>
+        %5 = tensor.empty() : tensor<250x1020xf16>
+        %6 = linalg.fill ins(%cst : f16) outs(%5 : tensor<250x1020xf16>) -> tensor<250x1020xf16>
+        %7 = linalg.matmul ins(%3, %4 : tensor<250x120xf16>, tensor<120x1020xf16>) outs(%6 : tensor<250x1020xf16>) -> tensor<250x1020xf16>
+        flow.dispatch.tensor.store %7, %2, offsets = [0, 0], sizes = [250, 1020], strides = [1, 1]
+            : tensor<250x1020xf16> -> !flow.dispatch.tensor<writeonly:tensor<250x1020xf16>>
+        return
+      }
+    }
+  }
+}
+
+//  CHECK-DAG: #[[$CONFIG:.+]] = #iree_codegen.lowering_config<tile_sizes = {{\[}}[64, 128], [32, 64], [0, 0, 32], [16, 16, 16]{{\]}}>
+//  CHECK-DAG: #[[$TRANSLATION:.+]] = #iree_codegen.translation_info<SPIRVCooperativeMatrixVectorize pipeline_depth = 1 store_stage = 0>
+//CHECK-LABEL: hal.executable.export public @matmul_250x1020x120
+// CHECK-SAME:   subgroup_size = 32 : index
+// CHECK-SAME:   translation_info = #[[$TRANSLATION]]
+// CHECK-SAME:   workgroup_size = [64 : index, 2 : index, 1 : index]
+//      CHECK: func.func @matmul_250x1020x120()
+//      CHECK:   linalg.matmul
+// CHECK-SAME:     lowering_config = #[[$CONFIG]]
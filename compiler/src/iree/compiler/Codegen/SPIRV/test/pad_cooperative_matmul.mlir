@@ -0,0 +1,62 @@
+// RUN: iree-opt --split-input-file --pass-pipeline='builtin.module(func.func(iree-spirv-pad-cooperative-matmul))' %s | FileCheck %s
+
+#config = #iree_codegen.lowering_config<tile_sizes = [[64, 64], [32, 32], [0, 0, 32], [16, 16, 16]]>
+func.func @matmul_250x1020x120() {
+  %c0 = arith.constant 0 : index
+  %cst = arith.constant 0.000000e+00 : f16
+  %0 = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) : !flow.dispatch.tensor<readonly:tensor<250x120xf16>>
+  %1 = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) : !flow.dispatch.tensor<readonly:tensor<120x1020xf16>>
+  %2 = hal.interface.binding.subspan set(0) binding(2) type(storage_buffer) : !flow.dispatch.tensor<writeonly:tensor<250x1020xf16>>
+  %3 = flow.dispatch.tensor.load %0, offsets = [0, 0], sizes = [250, 120], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<250x120xf16>> -> tensor<250x120xf16>
+  %4 = flow.dispatch.tensor.load %1, offsets = [0, 0], sizes = [120, 1020], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<120x1020xf16>> -> tensor<120x1020xf16>
+  %5 = tensor.empty() : tensor<250x1020xf16>
+  %6 = linalg.fill ins(%cst : f16) outs(%5 : tensor<250x1020xf16>) -> tensor<250x1020xf16>
+  %7 = linalg.matmul {lowering_config = #config}
+      ins(%3, %4 : tensor<250x120xf16>, tensor<120x1020xf16>) outs(%6 : tensor<250x1020xf16>) -> tensor<250x1020xf16>
+  flow.dispatch.tensor.store %7, %2, offsets = [0, 0], sizes = [250, 1020], strides = [1, 1] : tensor<250x1020xf16> -> !flow.dispatch.tensor<writeonly:tensor<250x1020xf16>>
+  return
+}
+
+// CHECK-LABEL: func.func @matmul_250x1020x120()
+//       CHECK:   %[[LHS:.+]] = flow.dispatch.tensor.load {{.+}} -> tensor<250x120xf16>
+//       CHECK:   %[[RHS:.+]] = flow.dispatch.tensor.load {{.+}} -> tensor<120x1020xf16>
+//       CHECK:   %[[FILL:.+]] = linalg.fill
+//       CHECK:   %[[PAD_LHS:.+]] = tensor.pad %[[LHS]] low[0, 0] high[6, 8]
+//       CHECK:     -> tensor<256x128xf16>
+//       CHECK:   %[[PAD_RHS:.+]] = tensor.pad %[[RHS]] low[0, 0] high[8, 4]
+//       CHECK:     -> tensor<128x1024xf16>
+//       CHECK:   %[[PAD_INIT:.+]] = tensor.pad %[[FILL]] low[0, 0] high[6, 4]
+//       CHECK:     -> tensor<256x1024xf16>
+//       CHECK:   %[[MATMUL:.+]] = linalg.matmul
+//  CHECK-SAME:     ins(%[[PAD_LHS]], %[[PAD_RHS]] : tensor<256x128xf16>, tensor<128x1024xf16>)
+//  CHECK-SAME:     outs(%[[PAD_INIT]] : tensor<256x1024xf16>)
+//       CHECK:   %[[SLICE:.+]] = tensor.extract_slice %[[MATMUL]][0, 0] [250, 1020] [1, 1]
+//  CHECK-SAME:     : tensor<256x1024xf16> to tensor<250x1020xf16>
+//       CHECK:   flow.dispatch.tensor.store %[[SLICE]]
+
+// -----
+
+#config = #iree_codegen.lowering_config<tile_sizes = [[64, 64], [32, 32], [0, 0, 32], [16, 16, 16]]>
+func.func @matmul_256x1024x128() {
+  %c0 = arith.constant 0 : index
+  %cst = arith.constant 0.000000e+00 : f16
+  %0 = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) : !flow.dispatch.tensor<readonly:tensor<256x128xf16>>
+  %1 = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) : !flow.dispatch.tensor<readonly:tensor<128x1024xf16>>
+  %2 = hal.interface.binding.subspan set(0) binding(2) type(storage_buffer) : !flow.dispatch.tensor<writeonly:tensor<256x1024xf16>>
+  %3 = flow.dispatch.tensor.load %0, offsets = [0, 0], sizes = [256, 128], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<256x128xf16>> -> tensor<256x128xf16>
+  %4 = flow.dispatch.tensor.load %1, offsets = [0, 0], sizes = [128, 1024], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<128x1024xf16>> -> tensor<128x1024xf16>
+  %5 = tensor.empty() : tensor<256x1024xf16>
+  %6 = linalg.fill ins(%cst : f16) outs(%5 : tensor<256x1024xf16>) -> tensor<256x1024xf16>
+  %7 = linalg.matmul {lowering_config = #config}
+      ins(%3, %4 : tensor<256x128xf16>, tensor<128x1024xf16>) outs(%6 : tensor<256x1024xf16>) -> tensor<256x1024xf16>
+  flow.dispatch.tensor.store %7, %2, offsets = [0, 0], sizes = [256, 1024], strides = [1, 1] : tensor<256x1024xf16> -> !flow.dispatch.tensor<writeonly:tensor<256x1024xf16>>
+  return
+}
+
+// Aligned shapes are left untouched.
+
+// CHECK-LABEL: func.func @matmul_256x1024x128()
+//   CHECK-NOT:   tensor.pad
+//       CHECK:   linalg.matmul
+//  CHECK-SAME:     outs(%{{.+}} : tensor<256x1024xf16>)
+//   CHECK-NOT:   tensor.extract_slice
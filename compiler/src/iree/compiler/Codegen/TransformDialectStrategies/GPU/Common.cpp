@@ -12,6 +12,7 @@
 #include "iree/compiler/Codegen/TransformDialectStrategies/Common/Common.h"
 #include "iree/compiler/Codegen/TransformDialectStrategies/GPU/AbstractReductionStrategy.h"
 #include "iree/compiler/Codegen/TransformDialectStrategies/GPU/SmallReductionStrategy.h"
+#include "iree/compiler/Codegen/TransformDialectStrategies/GPU/SoftmaxStrategy.h"
 #include "iree/compiler/Codegen/TransformDialectStrategies/GPU/StagedReductionStrategy.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
@@ -52,6 +53,7 @@ using iree_compiler::gpu::build1DSplittingStrategyWithOptionalThreadMapping;
 using iree_compiler::gpu::buildCommonTrailingStrategy;
 using iree_compiler::gpu::buildMapToBlockAndThreads;
 using iree_compiler::gpu::buildSmallReductionStrategy;
+using iree_compiler::gpu::buildSoftmaxStrategy;
 using iree_compiler::gpu::buildStagedReductionStrategy;
 using iree_compiler::gpu::GPUModel;
 using iree_compiler::gpu::kCudaMaxNumThreads;
@@ -61,6 +63,7 @@ using iree_compiler::gpu::ReductionConfig;
 using iree_compiler::gpu::ReductionStrategy;
 using iree_compiler::gpu::scaleUpByBitWidth;
 using iree_compiler::gpu::SmallReductionStrategy;
+using iree_compiler::gpu::SoftmaxStrategy;
 using iree_compiler::gpu::StagedReductionStrategy;
 
 //===----------------------------------------------------------------------===//
@@ -413,3 +416,18 @@ LogicalResult mlir::iree_compiler::gpu::matchAndSetReductionStrategy(
 
   return success();
 }
+
+LogicalResult mlir::iree_compiler::gpu::matchAndSetSoftmaxStrategy(
+    func::FuncOp entryPoint) {
+  // 1. Match the softmax-like ops and configure the strategy.
+  FailureOr<SoftmaxStrategy> strategy = SoftmaxStrategy::create(entryPoint);
+  if (failed(strategy)) return failure();
+
+  // 2. Build strategy embedded into the IR.
+  auto strategyBuilder = [&](ImplicitLocOpBuilder &b, Value variant) {
+    return buildSoftmaxStrategy(b, variant, *strategy);
+  };
+  createTransformRegion(entryPoint, strategyBuilder);
+
+  return success();
+}
@@ -107,6 +107,14 @@ LogicalResult matchAndSetReductionStrategy(func::FuncOp entryPoint,
                                            linalg::LinalgOp op,
                                            const GPUModel& gpuModel);
 
+/// Map a softmax-like row normalization (e.g. softmax, LayerNorm): a chain of
+/// N-D parallel, 1-D reductions along the most minor dimension and
+/// elementwise operations sharing the same static iteration space, ended by an
+/// elementwise operation. Return failure if matching fails. On a successful
+/// match, construct transform dialect IR that maps each row to a warp and adds
+/// it in a top-level ModuleOp after the `entryPoint` func::FuncOp.
+LogicalResult matchAndSetSoftmaxStrategy(func::FuncOp entryPoint);
+
 }  // namespace gpu
 }  // namespace iree_compiler
 }  // namespace mlir
@@ -0,0 +1,288 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Codegen/TransformDialectStrategies/GPU/SoftmaxStrategy.h"
+
+#include "iree-dialects/Dialect/LinalgTransform/StructuredTransformOpsExt.h"
+#include "iree/compiler/Codegen/Common/TransformExtensions/CommonExtensions.h"
+#include "iree/compiler/Codegen/LLVMGPU/TransformExtensions/LLVMGPUExtensions.h"
+#include "iree/compiler/Codegen/TransformDialectStrategies/Common/Common.h"
+#include "iree/compiler/Codegen/TransformDialectStrategies/GPU/Common.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/GPU/IR/GPUDialect.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Linalg/TransformOps/LinalgTransformOps.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/Dialect/Transform/IR/TransformDialect.h"
+#include "mlir/Dialect/Transform/IR/TransformOps.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
+#include "mlir/IR/ImplicitLocOpBuilder.h"
+#include "mlir/Interfaces/TilingInterface.h"
+
+using namespace mlir;
+
+#define DEBUG_TYPE "iree-transform-builder"
+#define DBGS() (llvm::dbgs() << "[" DEBUG_TYPE "]: ")
+
+// TODO: significantly better namespacing.
+using iree_compiler::IREE::transform_dialect::ApplyPatternsOp;
+using iree_compiler::IREE::transform_dialect::ApplyPatternsOpPatterns;
+using iree_compiler::IREE::transform_dialect::ShareForallOperandsOp;
+using transform::FuseIntoContainingOp;
+using transform::MatchOp;
+using transform::MergeHandlesOp;
+using transform::SplitHandlesOp;
+
+using iree_compiler::buildTileFuseDistToForallAndWorkgroupCountWithTileSizes;
+using iree_compiler::buildTileFuseDistToForallWithNumThreads;
+using iree_compiler::buildTileFuseDistToForallWithTileSizes;
+using iree_compiler::maxDivisorOfValueBelowLimit;
+using iree_compiler::gpu::buildDistributeVectors;
+using iree_compiler::gpu::buildMapToBlockAndThreads;
+using iree_compiler::gpu::kCudaMaxVectorLoadBitWidth;
+using iree_compiler::gpu::kCudaWarpSize;
+using iree_compiler::gpu::SoftmaxOpRole;
+using iree_compiler::gpu::SoftmaxStrategy;
+
+/// Upper bound on the number of rows, i.e. warps, processed by a block.
+static constexpr int64_t kMaxNumRowsPerBlock = 4;
+
+/// Upper bound on the bits of a row held by each lane of a warp. This keeps the
+/// register footprint of a row to a few 128-bit vectors per lane.
+static constexpr int64_t kMaxRowBitsPerLane = 8 * kCudaMaxVectorLoadBitWidth;
+
+/// Return true if the loops of `op` are all parallel, with identity output
+/// maps and projected permutation input maps.
+static bool isRowElementwise(linalg::GenericOp op) {
+  if (op.getNumLoops() != op.getNumParallelLoops()) return false;
+  return llvm::all_of(op->getOpOperands(), [&](OpOperand &operand) {
+    AffineMap map = op.getMatchingIndexingMap(&operand);
+    return op.isDpsInit(&operand) ? map.isIdentity()
+                                  : map.isProjectedPermutation();
+  });
+}
+
+/// Return true if `op` has a single result reducing its most minor loop, all
+/// the other loops being parallel, and projected permutation input maps.
+static bool isRowReduction(linalg::GenericOp op) {
+  int64_t numLoops = op.getNumLoops();
+  if (numLoops < 2 || op.getNumReductionLoops() != 1) return false;
+  if (op.getIteratorTypesArray().back() != utils::IteratorType::reduction)
+    return false;
+  if (op.getNumDpsInits() != 1) return false;
+  AffineMap rowMap =
+      AffineMap::getMultiDimIdentityMap(numLoops, op.getContext())
+          .dropResult(numLoops - 1);
+  if (op.getMatchingIndexingMap(op.getDpsInitOperand(0)) != rowMap)
+    return false;
+  return llvm::all_of(op.getDpsInputOperands(), [&](OpOperand *operand) {
+    return op.getMatchingIndexingMap(operand).isProjectedPermutation();
+  });
+}
+
+FailureOr<SoftmaxStrategy> mlir::iree_compiler::gpu::SoftmaxStrategy::create(
+    func::FuncOp entryPoint) {
+  SmallVector<Operation *> computeOps;
+  entryPoint.walk([&](TilingInterface op) { computeOps.push_back(op); });
+  if (computeOps.empty()) return failure();
+
+  // The trailing elementwise op defines the iteration space of all the row
+  // ops.
+  auto rootOp = dyn_cast<linalg::GenericOp>(computeOps.back());
+  if (!rootOp || !isRowElementwise(rootOp) || rootOp.hasDynamicShape())
+    return failure();
+  SmallVector<int64_t> loopRanges = rootOp.getStaticLoopRanges();
+  int64_t numParallelLoops = loopRanges.size() - 1;
+  // All parallel loops are mapped to blocks.
+  if (numParallelLoops < 1 || numParallelLoops > 3) return failure();
+  ArrayRef<int64_t> rowRanges = ArrayRef<int64_t>(loopRanges).drop_back();
+
+  SoftmaxStrategy strategy(entryPoint.getContext());
+  strategy.numParallelLoops = numParallelLoops;
+  int64_t numReductions = 0;
+  int64_t maxBitWidth = 0;
+  for (Operation *op : computeOps) {
+    if (auto fillOp = dyn_cast<linalg::FillOp>(op)) {
+      auto fillType = fillOp->getResult(0).getType().cast<ShapedType>();
+      if (fillType.getShape() != rowRanges) return failure();
+      strategy.opRoles.push_back(SoftmaxOpRole::Fill);
+      continue;
+    }
+    auto genericOp = dyn_cast<linalg::GenericOp>(op);
+    if (!genericOp || genericOp.getStaticLoopRanges() != loopRanges)
+      return failure();
+    for (OpOperand *init : genericOp.getDpsInitOperands()) {
+      Type elementType = getElementTypeOrSelf(init->get());
+      if (!elementType.isIntOrFloat()) return failure();
+      maxBitWidth = std::max<int64_t>(maxBitWidth,
+                                      elementType.getIntOrFloatBitWidth());
+    }
+    if (genericOp == rootOp) {
+      strategy.opRoles.push_back(SoftmaxOpRole::Root);
+    } else if (isRowReduction(genericOp)) {
+      ++numReductions;
+      strategy.opRoles.push_back(SoftmaxOpRole::Row);
+    } else if (isRowElementwise(genericOp)) {
+      strategy.opRoles.push_back(SoftmaxOpRole::Row);
+    } else {
+      return failure();
+    }
+  }
+  // Single reductions are handled by the reduction strategies.
+  if (numReductions < 2) return failure();
+
+  // Each lane of the warp owning a row processes a contiguous slice of it.
+  int64_t rowSize = loopRanges.back();
+  if (rowSize % kCudaWarpSize != 0) return failure();
+  strategy.vectorSize = rowSize / kCudaWarpSize;
+  if (strategy.vectorSize * maxBitWidth > kMaxRowBitsPerLane) return failure();
+
+  // Block-level
+  // ===========
+  // Tile the leading parallel dimensions to 1 and give each block a few rows
+  // of the most minor parallel dimension, one per warp.
+  FailureOr<int64_t> maybeNumRows =
+      maxDivisorOfValueBelowLimit(rowRanges.back(), kMaxNumRowsPerBlock);
+  strategy.numRowsPerBlock = succeeded(maybeNumRows) ? *maybeNumRows : 1;
+  strategy.workgroupTileSizes.append(numParallelLoops - 1, 1);
+  strategy.workgroupTileSizes.push_back(strategy.numRowsPerBlock);
+
+  LLVM_DEBUG(DBGS() << "use GPU softmax strategy with "
+                    << strategy.numRowsPerBlock << " rows per block and "
+                    << strategy.vectorSize << " elements per lane\n");
+  return strategy;
+}
+
+std::array<int64_t, 3>
+mlir::iree_compiler::gpu::SoftmaxStrategy::getNumThreadsInBlock() const {
+  return {kCudaWarpSize, numRowsPerBlock, 1};
+}
+
+/// Match the linalg.fill and linalg.generic ops under `variantH` and split
+/// them into one handle per op, in program order.
+static SmallVector<Value> matchAndSplitSoftmaxOps(
+    ImplicitLocOpBuilder &b, Value variantH,
+    const SoftmaxStrategy &strategy) {
+  Value opsH = b.create<MatchOp>(
+      variantH, ArrayRef<StringRef>{linalg::FillOp::getOperationName(),
+                                    linalg::GenericOp::getOperationName()});
+  auto splitOp = b.create<SplitHandlesOp>(
+      opsH, /*numHandles=*/strategy.opRoles.size());
+  return llvm::to_vector(splitOp->getResults());
+}
+
+/// Merge the handles of `opsH` whose role is `role` into a single handle.
+static Value mergeHandlesWithRole(ImplicitLocOpBuilder &b, ValueRange opsH,
+                                  const SoftmaxStrategy &strategy,
+                                  SoftmaxOpRole role) {
+  SmallVector<Value> handles;
+  for (auto [opH, opRole] : llvm::zip(opsH, strategy.opRoles))
+    if (opRole == role) handles.push_back(opH);
+  if (handles.size() <= 1) return handles.empty() ? Value() : handles.front();
+  return b.create<MergeHandlesOp>(handles, /*deduplicate=*/true);
+}
+
+void mlir::iree_compiler::gpu::buildSoftmaxStrategy(
+    ImplicitLocOpBuilder &b, Value variantH,
+    const SoftmaxStrategy &strategy) {
+  MLIRContext *ctx = b.getContext();
+  auto blockAttr = [&](mlir::gpu::Blocks dim) -> Attribute {
+    return mlir::gpu::GPUBlockMappingAttr::get(ctx, dim);
+  };
+  auto threadAttr = [&](mlir::gpu::Threads dim) -> Attribute {
+    return mlir::gpu::GPUThreadMappingAttr::get(ctx, dim);
+  };
+  SmallVector<Attribute> allBlockAttrs = {
+      blockAttr(mlir::gpu::Blocks::DimX), blockAttr(mlir::gpu::Blocks::DimY),
+      blockAttr(mlir::gpu::Blocks::DimZ)};
+  Attribute threadX = threadAttr(mlir::gpu::Threads::DimX);
+  Attribute threadY = threadAttr(mlir::gpu::Threads::DimY);
+  // Loops of the leading parallel dimensions have a single iteration within a
+  // block and are left untiled at the thread level.
+  SmallVector<int64_t> untiledLeadingDims(strategy.numParallelLoops - 1, 0);
+
+  // Step 1. Tile the trailing op to blocks and fuse all the other ops into the
+  // resulting scf.forall, one at a time and in reverse order.
+  SmallVector<Value> opsH = matchAndSplitSoftmaxOps(b, variantH, strategy);
+  TileToForallAndFuseAndDistributeResult blockResult =
+      buildTileFuseDistToForallAndWorkgroupCountWithTileSizes(
+          /*builder=*/b,
+          /*rootH=*/opsH.back(),
+          /*opsToFuseH=*/{},
+          /*tileSizes=*/
+          getAsOpFoldResult(b.getI64ArrayAttr(strategy.workgroupTileSizes)),
+          /*threadDimMapping=*/
+          b.getArrayAttr(ArrayRef<Attribute>(allBlockAttrs)
+                             .take_front(strategy.numParallelLoops)));
+  for (Value opH : llvm::reverse(ArrayRef<Value>(opsH).drop_back()))
+    b.create<FuseIntoContainingOp>(opH, blockResult.forallH);
+  // By default, fusion into scf.forall does not promote captured values to
+  // shared. Each block only accesses its own slice of the results of the row
+  // ops, so all the operands of the scf.forall can be shared.
+  auto forallType =
+      transform::OperationType::get(ctx, scf::ForallOp::getOperationName());
+  Value forallH = b.create<transform::CastOp>(forallType, blockResult.forallH);
+  b.create<ShareForallOperandsOp>(forallType, forallH, ArrayRef<int64_t>{});
+
+  // Step 2. Map the rows to warps.
+  // Leaving the row ops untiled on threadIdx.x makes them sequential on
+  // threadIdx.x. After distribution, predication by `if (threadIdx.x == 0)` is
+  // introduced and the vector ops of each row are distributed across the lanes
+  // of the warp, with shuffles for the reductions.
+  opsH = matchAndSplitSoftmaxOps(b, variantH, strategy);
+  SmallVector<int64_t> rowTileSizes = untiledLeadingDims;
+  rowTileSizes.push_back(1);
+  buildTileFuseDistToForallWithTileSizes(
+      /*b=*/b,
+      /*rootH=*/mergeHandlesWithRole(b, opsH, strategy, SoftmaxOpRole::Row),
+      /*opsHToFuse=*/{},
+      /*tileSizes=*/getAsOpFoldResult(b.getI64ArrayAttr(rowTileSizes)),
+      /*threadDimMapping=*/b.getArrayAttr({threadY}));
+  if (Value fillH =
+          mergeHandlesWithRole(b, opsH, strategy, SoftmaxOpRole::Fill)) {
+    SmallVector<int64_t> fillNumThreads = untiledLeadingDims;
+    fillNumThreads.push_back(strategy.numRowsPerBlock);
+    buildTileFuseDistToForallWithNumThreads(
+        /*b=*/b,
+        /*rootH=*/fillH,
+        /*opsHToFuse=*/{},
+        /*numThreads=*/getAsOpFoldResult(b.getI64ArrayAttr(fillNumThreads)),
+        /*threadDimMapping=*/b.getArrayAttr({threadY}));
+  }
+  // The trailing op is split in contiguous slices of `vectorSize` elements
+  // along the row, the same slices that vector distribution assigns to each
+  // lane.
+  SmallVector<int64_t> rootNumThreads = untiledLeadingDims;
+  rootNumThreads.append({strategy.numRowsPerBlock, kCudaWarpSize});
+  buildTileFuseDistToForallWithNumThreads(
+      /*b=*/b,
+      /*rootH=*/opsH.back(),
+      /*opsHToFuse=*/{},
+      /*numThreads=*/getAsOpFoldResult(b.getI64ArrayAttr(rootNumThreads)),
+      /*threadDimMapping=*/b.getArrayAttr({threadY, threadX}));
+
+  // Step 3. Rank-reduce and vectorize.
+  Value funcH = b.create<MatchOp>(variantH, func::FuncOp::getOperationName());
+  ApplyPatternsOpPatterns patterns;
+  patterns.rankReducingLinalg = true;
+  patterns.rankReducingVector = true;
+  funcH = b.create<ApplyPatternsOp>(funcH, patterns);
+  funcH = iree_compiler::buildVectorize(b, funcH);
+
+  // Step 4. Bufferize and drop HAL descriptor from memref ops.
+  variantH = iree_compiler::buildBufferize(b, variantH, /*targetGpu=*/true);
+
+  // Step 5. Post-bufferization mapping to blocks and threads.
+  funcH = b.create<MatchOp>(variantH, func::FuncOp::getOperationName());
+  funcH = buildMapToBlockAndThreads(b, funcH, strategy.getNumThreadsInBlock());
+
+  // Step 6. Post-bufferization vector distribution of each row to its warp.
+  buildDistributeVectors(b, variantH, funcH, kCudaWarpSize);
+
+  // Step 7. Apply clean up of memory operations.
+  funcH = b.create<MatchOp>(variantH, func::FuncOp::getOperationName());
+  iree_compiler::buildMemoryOptimizations(b, funcH);
+}
@@ -0,0 +1,92 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_COMPILER_CODEGEN_TRANSFORM_DIALECT_STRATEGIES_GPU_SOFTMAX_STRATEGY_H_
+#define IREE_COMPILER_CODEGEN_TRANSFORM_DIALECT_STRATEGIES_GPU_SOFTMAX_STRATEGY_H_
+
+#include <array>
+
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/ImplicitLocOpBuilder.h"
+
+namespace mlir {
+namespace iree_compiler {
+namespace gpu {
+
+/// Role played by each op of a softmax-like dispatch in the strategy.
+enum class SoftmaxOpRole {
+  /// linalg.fill initializing the accumulator of a row reduction.
+  Fill,
+  /// Row reduction, or row-wise elementwise op consumed by a row reduction.
+  /// Each row is owned by a single warp.
+  Row,
+  /// Trailing elementwise op producing the normalized rows.
+  Root,
+};
+
+/// Encode a warp-per-row strategy for softmax-like row normalizations
+/// (softmax, LayerNorm, RMSNorm): a chain of N-D parallel, 1-D reductions
+/// along the most minor dimension that share the same iteration space, ended
+/// by an elementwise op of that iteration space.
+///
+/// Each block processes `numRowsPerBlock` consecutive rows with one warp per
+/// row (threadIdx.y selects the row, threadIdx.x the lane):
+///   1. every row op is tiled to threadIdx.y and vectorized along the row.
+///      Post-bufferization vector distribution splits the row across the lanes
+///      of the warp, so that each lane loads `getVectorSize()` contiguous
+///      elements with the widest possible transfers, and reduces them with
+///      warp shuffles.
+///   2. the per-row reduction results are shared with the other ops of the
+///      row through workgroup memory.
+///   3. the trailing op is tiled to (threadIdx.y, threadIdx.x) with the same
+///      contiguous per-lane slices.
+/// Rows are bounded so that a whole row fits in the registers of a warp: each
+/// row op is a single pass over the row, without any loop or global memory
+/// round trip for partial results.
+class SoftmaxStrategy {
+ public:
+  /// Matches the softmax-like ops of `entryPoint` and configures the strategy
+  /// for them. Returns failure if the dispatch is not a static softmax-like
+  /// row normalization that fits the strategy.
+  static FailureOr<SoftmaxStrategy> create(func::FuncOp entryPoint);
+
+  std::array<int64_t, 3> getNumThreadsInBlock() const;
+
+  /// Number of elements of each row processed by each lane.
+  int64_t getVectorSize() const { return vectorSize; }
+
+  MLIRContext *context;
+
+  /// Roles of the linalg.fill and linalg.generic ops in the dispatch, in
+  /// program order.
+  SmallVector<SoftmaxOpRole> opRoles;
+
+  /// Number of parallel loops of the row ops, the row loop being the most
+  /// minor one.
+  int64_t numParallelLoops;
+
+  /// Tile sizes of the parallel loops for the block level.
+  SmallVector<int64_t> workgroupTileSizes;
+
+  /// Number of rows (i.e. warps) per block.
+  int64_t numRowsPerBlock;
+
+ private:
+  explicit SoftmaxStrategy(MLIRContext *context) : context(context) {}
+
+  int64_t vectorSize;
+};
+
+/// Entry point to build the transform IR corresponding to the softmax
+/// strategy.
+void buildSoftmaxStrategy(ImplicitLocOpBuilder &b, Value variantH,
+                          const SoftmaxStrategy &strategy);
+
+}  // namespace gpu
+}  // namespace iree_compiler
+}  // namespace mlir
+
+#endif  // IREE_COMPILER_CODEGEN_TRANSFORM_DIALECT_STRATEGIES_GPU_SOFTMAX_STRATEGY_H_
@@ -25,6 +25,21 @@ std::optional<MatmulType> getMatmulType(Type lhsElementType,
     return MatmulType::F32F32F32;
   }
 
+  if (lhsElementType.isF16() && rhsElementType.isF16() &&
+      resultElementType.isF32()) {
+    return MatmulType::F16F16F32;
+  }
+
+  if (lhsElementType.isF16() && rhsElementType.isF16() &&
+      resultElementType.isF16()) {
+    return MatmulType::F16F16F16;
+  }
+
+  if (lhsElementType.isBF16() && rhsElementType.isBF16() &&
+      resultElementType.isF32()) {
+    return MatmulType::BF16BF16F32;
+  }
+
   return std::nullopt;
 }
 
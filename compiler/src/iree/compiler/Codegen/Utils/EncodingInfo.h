@@ -16,6 +16,9 @@ namespace iree_compiler {
 enum class MatmulType {
   F32F32F32,
   I8I8I32,
+  F16F16F32,
+  F16F16F16,
+  BF16BF16F32,
 };
 
 std::optional<MatmulType> getMatmulType(Type lhsElementType,
@@ -7,6 +7,7 @@
 #include "iree/compiler/Codegen/Utils/GPUUtils.h"
 
 #include "iree/compiler/Codegen/Utils/MarkerUtils.h"
+#include "llvm/ADT/SetVector.h"
 #include "llvm/Support/Debug.h"
 #include "mlir/Dialect/Affine/IR/AffineOps.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
@@ -271,6 +272,164 @@ void propagateSharedMemoryCopy(func::FuncOp funcOp) {
   for (Operation *op : toDelete) op->erase();
 }
 
+/// Returns true if `buffer` or any view of it is written by an op other than
+/// `writer`.
+static bool isWrittenByOtherOps(Value buffer, Operation *writer) {
+  SmallVector<Value> worklist = {buffer};
+  while (!worklist.empty()) {
+    Value view = worklist.pop_back_val();
+    for (OpOperand &use : view.getUses()) {
+      Operation *user = use.getOwner();
+      if (user == writer) continue;
+      if (auto subview = dyn_cast<memref::SubViewOp>(user)) {
+        worklist.push_back(subview.getResult());
+        continue;
+      }
+      if (auto linalgOp = dyn_cast<linalg::LinalgOp>(user)) {
+        if (linalgOp.isDpsInit(&use)) return true;
+        continue;
+      }
+      if (auto copyOp = dyn_cast<memref::CopyOp>(user)) {
+        if (copyOp.getTarget() == view) return true;
+        continue;
+      }
+      if (!isa<memref::LoadOp, memref::DimOp, vector::TransferReadOp>(user)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/// Returns the buffer `value` is a view of.
+static Value getViewSource(Value value) {
+  while (auto subview = value.getDefiningOp<memref::SubViewOp>()) {
+    value = subview.getSource();
+  }
+  return value;
+}
+
+/// Returns the fully parallel linalg.generic computing the whole buffer a tile
+/// of which is copied by `copyOp`, if it can be recomputed for that tile alone
+/// in place of the copy.
+static linalg::GenericOp getFusableCopySourceProducer(memref::CopyOp copyOp) {
+  auto subview = copyOp.getSource().getDefiningOp<memref::SubViewOp>();
+  if (!subview || !subview.hasUnitStride() ||
+      subview.getSourceType().getRank() != subview.getType().getRank()) {
+    return nullptr;
+  }
+  Value buffer = subview.getSource();
+  if (!buffer.getDefiningOp<memref::AllocOp>()) return nullptr;
+
+  // The buffer must only be written by the producer and only read through
+  // tiles copied to shared memory.
+  linalg::GenericOp producer;
+  for (Operation *user : buffer.getUsers()) {
+    if (auto genericOp = dyn_cast<linalg::GenericOp>(user)) {
+      if (producer) return nullptr;
+      producer = genericOp;
+      continue;
+    }
+    auto tile = dyn_cast<memref::SubViewOp>(user);
+    if (!tile || !llvm::all_of(tile->getUsers(), [](Operation *tileUser) {
+          return isa<memref::CopyOp>(tileUser) &&
+                 hasMarker(tileUser, getCopyToWorkgroupMemoryMarker());
+        })) {
+      return nullptr;
+    }
+  }
+  if (!producer || producer.getNumDpsInits() != 1 ||
+      producer.getNumParallelLoops() != producer.getNumLoops()) {
+    return nullptr;
+  }
+  OpOperand *init = producer.getDpsInitOperand(0);
+  if (init->get() != buffer ||
+      !producer.getMatchingIndexingMap(init).isIdentity() ||
+      producer.payloadUsesValueFromOperand(init)) {
+    return nullptr;
+  }
+
+  // The producer must run before the copy and its inputs must still hold the
+  // same values when the copy runs.
+  Operation *copyAncestor =
+      producer->getBlock()->findAncestorOpInBlock(*copyOp);
+  if (!copyAncestor || !producer->isBeforeInBlock(copyAncestor)) {
+    return nullptr;
+  }
+  for (OpOperand *input : producer.getDpsInputOperands()) {
+    if (!input->get().getType().isa<MemRefType>()) continue;
+    if (!producer.getMatchingIndexingMap(input).isProjectedPermutation() ||
+        isWrittenByOtherOps(getViewSource(input->get()), producer)) {
+      return nullptr;
+    }
+  }
+  return producer;
+}
+
+/// Replaces `copyOp` with a clone of `producer` computing only the copied tile
+/// directly into shared memory.
+static void fuseProducerIntoCopy(linalg::GenericOp producer,
+                                 memref::CopyOp copyOp) {
+  auto subview = copyOp.getSource().getDefiningOp<memref::SubViewOp>();
+  SmallVector<OpFoldResult> offsets = subview.getMixedOffsets();
+  SmallVector<OpFoldResult> sizes = subview.getMixedSizes();
+
+  OpBuilder builder(copyOp);
+  Location loc = producer.getLoc();
+  SmallVector<Value> operands;
+  for (OpOperand *input : producer.getDpsInputOperands()) {
+    auto inputType = input->get().getType().dyn_cast<MemRefType>();
+    if (!inputType || inputType.getRank() == 0) {
+      operands.push_back(input->get());
+      continue;
+    }
+    // The output indexing map is the identity, so the loop dimensions index
+    // the copied tile directly.
+    SmallVector<OpFoldResult> inputOffsets, inputSizes;
+    for (AffineExpr expr :
+         producer.getMatchingIndexingMap(input).getResults()) {
+      unsigned dim = expr.cast<AffineDimExpr>().getPosition();
+      inputOffsets.push_back(offsets[dim]);
+      inputSizes.push_back(sizes[dim]);
+    }
+    SmallVector<OpFoldResult> strides(inputOffsets.size(),
+                                      builder.getIndexAttr(1));
+    operands.push_back(builder.create<memref::SubViewOp>(
+        loc, input->get(), inputOffsets, inputSizes, strides));
+  }
+  operands.push_back(copyOp.getTarget());
+  linalg::GenericOp fusedOp =
+      mlir::clone(builder, producer, TypeRange{}, operands);
+  setMarker(fusedOp, getCopyToWorkgroupMemoryMarker());
+  copyOp->erase();
+}
+
+void fuseProducersIntoSharedMemoryCopy(func::FuncOp funcOp) {
+  SmallVector<memref::CopyOp> copyOps;
+  funcOp.walk([&copyOps](memref::CopyOp copyOp) {
+    if (hasMarker(copyOp, getCopyToWorkgroupMemoryMarker())) {
+      copyOps.push_back(copyOp);
+    }
+  });
+  llvm::SetVector<Operation *> producers;
+  for (memref::CopyOp copyOp : copyOps) {
+    linalg::GenericOp producer = getFusableCopySourceProducer(copyOp);
+    if (!producer) continue;
+    fuseProducerIntoCopy(producer, copyOp);
+    producers.insert(producer);
+  }
+  // Drop the producers once every tile of their result is computed in place;
+  // their buffers are then dead and left for canonicalization.
+  for (Operation *producer : producers) {
+    Value buffer = producer->getOperands().back();
+    if (llvm::all_of(buffer.getUsers(), [&](Operation *user) {
+          return user == producer || user->use_empty();
+        })) {
+      producer->erase();
+    }
+  }
+}
+
 void insertBarriersAroundSharedMemoryCopy(func::FuncOp funcOp) {
   OpBuilder builder(funcOp.getContext());
   // Insert barriers before and after copies to workgroup memory and skip
@@ -74,6 +74,12 @@ LogicalResult copyToWorkgroupMemory(OpBuilder &builder, Value src, Value dst);
 /// linalg.generic when possible.
 void propagateSharedMemoryCopy(func::FuncOp funcOp);
 
+/// Replaces copies of tiles to shared memory with the fully parallel
+/// linalg.generic producing the copied buffer, restricted to the tile. This
+/// computes fused elementwise producers of promoted operands tile by tile
+/// within the reduction loop instead of materializing their whole result.
+void fuseProducersIntoSharedMemoryCopy(func::FuncOp funcOp);
+
 /// Inserts barriers before and after shared memory copy.
 void insertBarriersAroundSharedMemoryCopy(func::FuncOp funcOp);
 
@@ -146,6 +146,11 @@ bool hasMicrokernels(IREE::HAL::ExecutableTargetAttr targetAttr) {
   return enableMicrokernels && enableMicrokernels->getValue();
 }
 
+bool hasWorkgroupRanges(IREE::HAL::ExecutableTargetAttr targetAttr) {
+  auto workgroupRangesAttr = getConfigBoolAttr(targetAttr, "workgroup_ranges");
+  return workgroupRangesAttr && workgroupRangesAttr->getValue();
+}
+
 bool preferIntrinsicsOverAsm(IREE::HAL::ExecutableTargetAttr targetAttr) {
   auto intrinsicsAttr =
       getConfigBoolAttr(targetAttr, "prefer_intrinsics_over_asm");
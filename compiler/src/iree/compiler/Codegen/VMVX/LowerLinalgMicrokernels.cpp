@@ -632,6 +632,18 @@ struct LinalgBinaryGenericConversion
               }
               return std::nullopt;
             })
+            .Case([&](arith::MaxFOp op) -> Optional<BinaryEmitter> {
+              if (resultType.getIntOrFloatBitWidth() == 32) {
+                return configureGenericBinary(op, "max");
+              }
+              return std::nullopt;
+            })
+            .Case([&](arith::MinFOp op) -> Optional<BinaryEmitter> {
+              if (resultType.getIntOrFloatBitWidth() == 32) {
+                return configureGenericBinary(op, "min");
+              }
+              return std::nullopt;
+            })
             .Case([&](arith::MulFOp op) -> Optional<BinaryEmitter> {
               if (resultType.getIntOrFloatBitWidth() == 32) {
                 return configureGenericBinary(op, "mul");
@@ -796,6 +808,12 @@ struct LinalgUnaryGenericConversion
               }
               return std::nullopt;
             })
+            .Case([&](math::TanhOp op) -> Optional<UnaryEmitter> {
+              if (resultType.getIntOrFloatBitWidth() == 32) {
+                return configureGenericUnary(op, "tanh");
+              }
+              return std::nullopt;
+            })
             .Default([](Operation *) { return std::nullopt; });
 
     // Determine op type to lower to.
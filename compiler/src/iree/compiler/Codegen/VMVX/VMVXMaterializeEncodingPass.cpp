@@ -36,7 +36,10 @@ static MatmulTileParams chooseMicrokernelMatmulTileParams() {
 
 static MatmulTileParams chooseMatmulTileParams(MatmulType type,
                                                ExecutableTargetAttr target) {
-  if (hasMicrokernels(target)) {
+  // VMVX only has microkernel imports for the f32 and i8 matmul types; other
+  // types are lowered through the generic path and use static tile sizes.
+  if (hasMicrokernels(target) &&
+      (type == MatmulType::F32F32F32 || type == MatmulType::I8I8I32)) {
     return chooseMicrokernelMatmulTileParams();
   }
   return chooseMatmulTileParamsGeneric();
@@ -451,6 +451,30 @@ func.func @divf(%arg0 : memref<64x64xf32>, %arg1 : memref<64xf32>) {
   func.return
 }
 
+// CHECK-LABEL: @maxf
+// CHECK: vmvx.binary op("max" : f32)
+func.func @maxf(%arg0 : memref<64x64xf32>, %arg1 : memref<64xf32>) {
+  linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d1)>, affine_map<(d0, d1) -> (d0, d1)>], iterator_types = ["parallel", "parallel"]}
+    ins(%arg1 : memref<64xf32>) outs(%arg0 : memref<64x64xf32>) {
+  ^bb0(%arg2: f32, %arg3: f32):
+    %12 = arith.maxf %arg2, %arg3 : f32
+    linalg.yield %12 : f32
+  }
+  func.return
+}
+
+// CHECK-LABEL: @minf
+// CHECK: vmvx.binary op("min" : f32)
+func.func @minf(%arg0 : memref<64x64xf32>, %arg1 : memref<64xf32>) {
+  linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d1)>, affine_map<(d0, d1) -> (d0, d1)>], iterator_types = ["parallel", "parallel"]}
+    ins(%arg1 : memref<64xf32>) outs(%arg0 : memref<64x64xf32>) {
+  ^bb0(%arg2: f32, %arg3: f32):
+    %12 = arith.minf %arg2, %arg3 : f32
+    linalg.yield %12 : f32
+  }
+  func.return
+}
+
 // CHECK-LABEL: @mulf
 // CHECK: vmvx.binary op("mul" : f32)
 func.func @mulf(%arg0 : memref<64x64xf32>, %arg1 : memref<64xf32>) {
@@ -560,6 +584,18 @@ func.func @rsqrt(%arg0 : memref<64x64xf32>, %arg1 : memref<64xf32>) {
   func.return
 }
 
+// CHECK-LABEL: @tanh
+// CHECK: vmvx.unary op("tanh" : f32)
+func.func @tanh(%arg0 : memref<64x64xf32>, %arg1 : memref<64xf32>) {
+  linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d1)>, affine_map<(d0, d1) -> (d0, d1)>], iterator_types = ["parallel", "parallel"]}
+    ins(%arg1 : memref<64xf32>) outs(%arg0 : memref<64x64xf32>) {
+  ^bb0(%arg2: f32, %arg3: f32):
+    %12 = math.tanh %arg2 : f32
+    linalg.yield %12 : f32
+  }
+  func.return
+}
+
 // CHECK-LABEL: @pack_i8i8
 //   CHECK-DAG: %[[BB0:.*]], %[[OFFSET0:.*]], %[[SIZES0:.*]]:2, %[[STRIDES0:.*]]:2 = vmvx.get_buffer_descriptor %arg0
 //   CHECK-DAG: %[[BB1:.*]], %[[OFFSET1:.*]], %[[SIZES1:.*]]:4, %[[STRIDES1:.*]]:4 = vmvx.get_buffer_descriptor %arg1
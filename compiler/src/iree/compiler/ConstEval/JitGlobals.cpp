@@ -10,6 +10,7 @@
 #include "iree/compiler/Pipelines/Pipelines.h"
 #include "iree/compiler/Utils/PassUtils.h"
 #include "llvm/ADT/DenseSet.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
@@ -25,6 +26,13 @@ namespace mlir {
 namespace iree_compiler {
 namespace ConstEval {
 
+static llvm::cl::opt<int64_t> clMaxUniquedByteSize(
+    "iree-consteval-jit-max-uniqued-byte-size",
+    llvm::cl::desc(
+        "Evaluated globals larger than this many bytes are stored as resource "
+        "blobs instead of uniqued dense attributes (-1 to always unique)."),
+    llvm::cl::init(1024 * 1024));
+
 namespace {
 
 struct ProgramExtractor {
@@ -216,6 +224,7 @@ struct JitGlobalsPass : public JitGlobalsBase<JitGlobalsPass> {
     if (failed(binary.translateFromModule(innerModule))) {
       return signalPassFailure();
     }
+    binary.setMaxUniquedByteSize(clMaxUniquedByteSize);
 
     // Kill the temporary program we constructed.
     innerModule.erase();
@@ -8,6 +8,7 @@
 
 #include "iree/compiler/Dialect/VM/Target/Bytecode/BytecodeModuleTarget.h"
 #include "iree/hal/drivers/local_task/registration/driver_module.h"
+#include "mlir/IR/AsmState.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/BuiltinTypes.h"
 
@@ -40,7 +41,8 @@ Type mapElementType(Location loc, iree_hal_element_type_t halElementType) {
 
 static Attribute createAttributeFromRawData(Location loc,
                                             RankedTensorType tensorType,
-                                            MutableArrayRef<char> rawBuffer) {
+                                            MutableArrayRef<char> rawBuffer,
+                                            int64_t maxUniquedByteSize) {
   Type elementType = tensorType.getElementType();
   // For numeric types that are byte-width aligned, we just use the raw buffer
   // loading support of DenseElementsAttr.
@@ -49,6 +51,17 @@ static Attribute createAttributeFromRawData(Location loc,
     bool detectedSplat = false;
     if (DenseElementsAttr::isValidRawBuffer(tensorType, rawBuffer,
                                             detectedSplat)) {
+      // Large non-splat results are copied once into a resource blob instead
+      // of being hashed and uniqued in the context, which for multi-GB weights
+      // dominates both compile time and peak memory. The blob is written
+      // as-is when the global is serialized.
+      if (!detectedSplat && maxUniquedByteSize >= 0 &&
+          static_cast<int64_t>(rawBuffer.size()) > maxUniquedByteSize) {
+        return DenseResourceElementsAttr::get(
+            tensorType, "jit_global",
+            HeapAsmResourceBlob::allocateAndCopy(
+                rawBuffer, /*align=*/alignof(uint64_t)));
+      }
       return DenseElementsAttr::getFromRawBuffer(tensorType, rawBuffer);
     } else {
       emitError(loc) << "mapped memory region was not valid for constructing "
@@ -176,6 +189,9 @@ bool CompiledBinary::isSupportedResultType(Type type) {
 
   // Support tensors.
   if (auto tt = type.dyn_cast<RankedTensorType>()) {
+    // Encoded tensors have a target-specific layout that is only known once
+    // the executables are materialized and cannot be evaluated here.
+    if (tt.getEncoding()) return false;
     return isSupportedResultType(tt.getElementType());
   }
 
@@ -241,8 +257,8 @@ Attribute CompiledBinary::convertVariantToAttribute(
       MutableArrayRef<char> rawBufferArray(
           reinterpret_cast<char*>(mapping.contents.data),
           mapping.contents.data_length);
-      auto convertedAttr =
-          createAttributeFromRawData(loc, tensorType, rawBufferArray);
+      auto convertedAttr = createAttributeFromRawData(
+          loc, tensorType, rawBufferArray, maxUniquedByteSize);
       iree_hal_buffer_unmap_range(&mapping);
       return convertedAttr;
     } else {
@@ -39,6 +39,12 @@ class CompiledBinary {
   // Whether the given type is supported in *AsAttribute methods.
   static bool isSupportedResultType(Type type);
 
+  // Sets the size in bytes above which non-splat tensor results of the
+  // *AsAttribute methods are returned as DenseResourceElementsAttrs owning
+  // their data rather than as uniqued DenseElementsAttrs. A negative size
+  // always uniques them.
+  void setMaxUniquedByteSize(int64_t size) { maxUniquedByteSize = size; }
+
  protected:
   CompiledBinary();
   void initialize(void* data, size_t length);
@@ -52,6 +58,7 @@ class CompiledBinary {
   iree::vm::ref<iree_vm_module_t> hal_module;
   iree::vm::ref<iree_vm_module_t> main_module;
   iree::vm::ref<iree_vm_context_t> context;
+  int64_t maxUniquedByteSize = -1;
 };
 
 // An in-memory compiled binary and accessors for working with it.
@@ -1,4 +1,5 @@
 // RUN: iree-opt --split-input-file --iree-consteval-jit-globals %s | FileCheck %s
+// RUN: iree-opt --split-input-file --iree-consteval-jit-globals --iree-consteval-jit-max-uniqued-byte-size=64 %s | FileCheck %s --check-prefix=RESOURCE
 
 // TODO(laurenzo): Full type matrix for tests.
 
@@ -57,6 +58,50 @@ module @eval_splat_detection {
 }
 
 
+// -----
+// CHECK-LABEL: @tensor_pack_jit
+// CHECK: util.global private @{{.*}} = dense<{{\[}}[{{\[}}[0, 1, 2, 3], [8, 9, 10, 11]], {{\[}}[4, 5, 6, 7], [12, 13, 14, 15]]], {{\[}}[{{\[}}[16, 17, 18, 19], [24, 25, 26, 27]], {{\[}}[20, 21, 22, 23], [28, 29, 30, 31]]]]> : tensor<2x2x2x4xi32>
+// RESOURCE-LABEL: @tensor_pack_jit
+// RESOURCE: util.global private @{{.*}} = dense_resource<jit_global> : tensor<2x2x2x4xi32>
+module @tensor_pack_jit {
+  util.global private @hoisted : tensor<2x2x2x4xi32>
+  func.func @main() -> tensor<2x2x2x4xi32> {
+    %hoisted = util.global.load @hoisted : tensor<2x2x2x4xi32>
+    return %hoisted : tensor<2x2x2x4xi32>
+  }
+  // CHECK-NOT: util.initializer
+  util.initializer {
+    %cst = arith.constant dense<[[0, 1, 2, 3, 4, 5, 6, 7], [8, 9, 10, 11, 12, 13, 14, 15], [16, 17, 18, 19, 20, 21, 22, 23], [24, 25, 26, 27, 28, 29, 30, 31]]> : tensor<4x8xi32>
+    %0 = tensor.empty() : tensor<2x2x2x4xi32>
+    %1 = tensor.pack %cst inner_dims_pos = [0, 1] inner_tiles = [2, 4] into %0 : tensor<4x8xi32> -> tensor<2x2x2x4xi32>
+    util.global.store %1, @hoisted : tensor<2x2x2x4xi32>
+    util.initializer.return
+  }
+}
+
+// -----
+// Encoded globals have a target-specific layout and are left to be packed by
+// the executables at load time.
+// CHECK-LABEL: @skip_encoded_global
+// CHECK: util.global private @hoisted : tensor<4x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS_TRANSPOSE>>
+// CHECK-NOT: = dense
+// CHECK: util.initializer
+// CHECK: iree_linalg_ext.set_encoding
+// CHECK: util.global.store
+module @skip_encoded_global {
+  util.global private @hoisted : tensor<4x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS_TRANSPOSE>>
+  func.func @main() -> tensor<4x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS_TRANSPOSE>> {
+    %hoisted = util.global.load @hoisted : tensor<4x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS_TRANSPOSE>>
+    return %hoisted : tensor<4x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS_TRANSPOSE>>
+  }
+  util.initializer {
+    %cst = arith.constant dense<[[0.0, 1.0, 2.0, 3.0], [4.0, 5.0, 6.0, 7.0], [8.0, 9.0, 10.0, 11.0], [12.0, 13.0, 14.0, 15.0]]> : tensor<4x4xf32>
+    %0 = iree_linalg_ext.set_encoding %cst : tensor<4x4xf32> -> tensor<4x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS_TRANSPOSE>>
+    util.global.store %0, @hoisted : tensor<4x4xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS_TRANSPOSE>>
+    util.initializer.return
+  }
+}
+
 // -----
 // CHECK-LABEL: @eval_f16_tensor
 // Not currently supported (initializer should remain)
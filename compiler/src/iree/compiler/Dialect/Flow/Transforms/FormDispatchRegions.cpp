@@ -14,7 +14,9 @@
 #include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
 #include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
 #include "iree/compiler/Dialect/Flow/Transforms/RegionOpUtils.h"
+#include "iree/compiler/Dialect/HAL/IR/HALDialect.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/TypeSwitch.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
@@ -41,7 +43,6 @@
 #include "mlir/Pass/Pass.h"
 #include "mlir/Support/LLVM.h"
 #include "mlir/Transforms/TopologicalSortUtils.h"
-#include "json/json.h"
 
 #include <fstream>
 #include <iostream>
@@ -58,8 +59,40 @@ static llvm::cl::opt<int> clInlineConstantByteLength(
                    "into a dispatch region or 0 to disable inlining."),
     llvm::cl::init(256));
 
+static llvm::cl::opt<bool> clCloneDequantizationOps(
+    "iree-flow-clone-dequantization-ops",
+    llvm::cl::desc("Clones ops dequantizing weights into the dispatches of "
+                   "their consumers so that the weights are read quantized "
+                   "and dequantized on the fly."),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<bool> clFuseElementwiseProducersIntoMatmul(
+    "iree-flow-fuse-elementwise-producers-into-matmul",
+    llvm::cl::desc("Fuses elementwise producers of matmul operands, such as "
+                   "the scale and shift of a normalization, into the matmul "
+                   "dispatch so that GPU backends compute them tile by tile "
+                   "in the GEMM prologue."),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<bool> clPIMFuseDecoderBlock(
+    "iree-flow-pim-fuse-decoder-block",
+    llvm::cl::desc("Forms a single dispatch region per matched GPT decoder "
+                   "block so that it is lowered to one multi-instruction PIM "
+                   "executable."),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<int> clPIMPipelineStages(
+    "iree-flow-pim-pipeline-stages",
+    llvm::cl::desc("Places consecutive decoder layers on this many PIM "
+                   "modules (device queues) instead of splitting every "
+                   "projection across all of them; 0 disables pipelining."),
+    llvm::cl::init(0));
+
 static const char kRootOpAttr[] = "__root_op__";
 static const char kFusionGroupsAttr[] = "__fused_op__";
+// Position of the dispatch region a linalg op was formed in within a fused
+// decoder block. Used by PIM codegen to group the ops of each stage.
+static const char kPIMBlockStageAttr[] = "pim.block_stage";
 
 namespace mlir {
 
@@ -208,6 +241,42 @@ static bool isRootOp(Operation *op) {
          isa<LinalgExt::SetEncodingOp, LinalgExt::UnsetEncodingOp>(op);
 }
 
+bool isDequantizationLikeOp(Operation *op) {
+  auto genericOp = dyn_cast<linalg::GenericOp>(op);
+  if (!genericOp || genericOp.getNumDpsInits() != 1 ||
+      genericOp.getNumParallelLoops() != genericOp.getNumLoops()) {
+    return false;
+  }
+  OpOperand *initOperand = genericOp.getDpsInitOperand(0);
+  if (!getElementTypeOrSelf(initOperand->get().getType()).isa<FloatType>() ||
+      !genericOp.getMatchingIndexingMap(initOperand).isIdentity()) {
+    return false;
+  }
+
+  // The quantized tensor is read in full; everything else (scales and zero
+  // points) is broadcast along at least one dimension.
+  bool hasQuantizedInput = false;
+  for (OpOperand *input : genericOp.getDpsInputOperands()) {
+    AffineMap map = genericOp.getMatchingIndexingMap(input);
+    if (!map.isProjectedPermutation()) return false;
+    if (!map.isPermutation()) continue;
+    auto intType =
+        getElementTypeOrSelf(input->get().getType()).dyn_cast<IntegerType>();
+    if (!intType || intType.getWidth() > 8 || hasQuantizedInput) return false;
+    hasQuantizedInput = true;
+  }
+
+  // Only conversions and the arithmetic applying the scales are allowed.
+  for (Operation &bodyOp : genericOp.getBody()->without_terminator()) {
+    if (!isa<arith::ExtSIOp, arith::ExtUIOp, arith::SIToFPOp, arith::UIToFPOp,
+             arith::ExtFOp, arith::TruncFOp, arith::SubIOp, arith::SubFOp,
+             arith::MulFOp>(bodyOp)) {
+      return false;
+    }
+  }
+  return hasQuantizedInput;
+}
+
 /// Operations that are cloned into dispatch regions formed with other
 /// operations as roots.
 bool isClonableIntoDispatchOp(Operation *op) {
@@ -237,6 +306,11 @@ bool isClonableIntoDispatchOp(Operation *op) {
       return true;
     }
   }
+  // Dequantizing in the consumer reads the narrow weights instead of their
+  // dequantized copy.
+  if (clCloneDequantizationOps && isDequantizationLikeOp(op)) {
+    return true;
+  }
   if (llvm::all_of(op->getOperands(),
                    [&](Value v) { return v.getType().isIntOrFloat(); }) &&
       llvm::all_of(op->getResults(),
@@ -576,8 +650,8 @@ static void fuseRootsWithConsumers(MLIRContext *context,
       }
       /*
       if (rootPattern == ffnPattern) {
-        llvm::outs() << "Pattern matched!\n";
-        llvm::outs() << root->getName() << "\n";
+        LLVM_DEBUG(llvm::dbgs() << "Pattern matched!\n");
+        LLVM_DEBUG(llvm::dbgs() << root->getName() << "\n");
         updateRootTo(root);
         workList.push_back(root);
       }*/
@@ -585,6 +659,22 @@ static void fuseRootsWithConsumers(MLIRContext *context,
   }
 }
 
+/// Returns true if `operand` is a matmul operand computed by an elementwise op
+/// that can be recomputed for each tile of it used by the matmul.
+static bool isFusableMatmulOperandProducer(OpOperand &operand) {
+  if (!isa<linalg::MatmulOp, linalg::BatchMatmulOp>(operand.getOwner())) {
+    return false;
+  }
+  auto producer = operand.get().getDefiningOp<linalg::GenericOp>();
+  if (!producer || !linalg::isElementwise(producer) ||
+      producer.getNumDpsInits() != 1) {
+    return false;
+  }
+  OpOperand *init = producer.getDpsInitOperand(0);
+  return producer.getMatchingIndexingMap(init).isIdentity() &&
+         !producer.payloadUsesValueFromOperand(init);
+}
+
 /// Method to check if the consumer of a use can be fused with its producer.
 static bool isFusableWithProducer(
     OpOperand &operand, const llvm::SmallBitVector &rootOuterParallelLoops,
@@ -606,6 +696,10 @@ static bool isFusableWithProducer(
 
   auto consumerLinalgOp = cast<linalg::LinalgOp>(consumer);
   if (consumerLinalgOp.isDpsInput(&operand)) {
+    if (clFuseElementwiseProducersIntoMatmul &&
+        isFusableMatmulOperandProducer(operand)) {
+      return true;
+    }
     // Only fuse on inputs if both ops are generic ops.
     if (!aggressiveFusion || !isa<linalg::GenericOp>(consumer) ||
         !isa<linalg::GenericOp>(producer)) {
@@ -686,20 +780,20 @@ static unsigned decideFusableLinalgOps(FunctionOpInterface funcOp,
     for (Operation &op : llvm::reverse(block)) {
       // Start with a root operation and fuse its producers.
       if (hasFusionGroupsAttribute(&op) || !isRootOp(&op)) continue;
-      llvm::outs() << op.getName() << " is a root op candidate" << "\n";
+      LLVM_DEBUG(llvm::dbgs() << op.getName() << " is a root op candidate" << "\n");
       root_candidates.push_back(&op);
     }
 
-    llvm::outs() << "Pattern matching\n";
+    LLVM_DEBUG(llvm::dbgs() << "Pattern matching\n");
     for (size_t i = 0; i < root_candidates.size(); ++i) {
-      llvm::outs() << "Root candidate " << i << "\n";
+      LLVM_DEBUG(llvm::dbgs() << "Root candidate " << i << "\n");
       linalgPattern.push_back(root_candidates[i]->getName().getStringRef().str());
       if (linalgPattern == ffnPattern) {
-        llvm::outs() << "FFN pattern matched!\n";
+        LLVM_DEBUG(llvm::dbgs() << "FFN pattern matched!\n");
 
-        llvm::outs() << "setRootAttribute\n";
+        LLVM_DEBUG(llvm::dbgs() << "setRootAttribute\n");
         Operation* op = root_candidates[i];
-        llvm::outs() << op->getName() << " is a root op" << "\n";
+        LLVM_DEBUG(llvm::dbgs() << op->getName() << " is a root op" << "\n");
         unsigned newGroup = numRootOps++;
         setRootAttribute(context, op, newGroup);
         fuseRootsWithProducers(context, op, newGroup, dominanceInfo,
@@ -715,7 +809,7 @@ static unsigned decideFusableLinalgOps(FunctionOpInterface funcOp,
       // Start with a root operation and fuse its producers.
       if (hasFusionGroupsAttribute(&op) || !isRootOp(&op)) continue;
       unsigned newGroup = numRootOps++;
-      llvm::outs() << op.getName() << " is a root op" << "\n";
+      LLVM_DEBUG(llvm::dbgs() << op.getName() << " is a root op" << "\n");
       setRootAttribute(context, &op, newGroup);
       fuseRootsWithProducers(context, &op, newGroup, dominanceInfo,
                              aggressiveFusion);
@@ -726,7 +820,7 @@ static unsigned decideFusableLinalgOps(FunctionOpInterface funcOp,
     fuseRootsWithConsumers(context, roots, dominanceInfo, aggressiveFusion);
   }
 
-  llvm::outs() << "putGenericOps\n";
+  LLVM_DEBUG(llvm::dbgs() << "putGenericOps\n");
   // Once all root linalg ops have been tagged, put all remaining generic ops
   // into their own dispatches.
   for (Block &block : funcOp.getFunctionBody()) {
@@ -734,7 +828,7 @@ static unsigned decideFusableLinalgOps(FunctionOpInterface funcOp,
     for (Operation &op : llvm::reverse(block)) {
       // If it is part of a fusion group or root op, ignore it.
       if (hasRootOpAttribute(&op)) {
-        llvm::outs() << "hasRootOpAttribute: " << op.getName() << "\n";
+        LLVM_DEBUG(llvm::dbgs() << "hasRootOpAttribute: " << op.getName() << "\n");
       }
       if (hasFusionGroupsAttribute(&op) || hasRootOpAttribute(&op)) {
         continue;
@@ -746,8 +840,16 @@ static unsigned decideFusableLinalgOps(FunctionOpInterface funcOp,
           isa<linalg::FillOp>(op)) {
         continue;
       }
+      // Dequantization ops are cloned into the dispatches of their consumers
+      // and only need their own dispatch if a consumer is left outside.
+      if (isClonableIntoDispatchOp(&op) &&
+          llvm::all_of(op.getUsers(), [](Operation *user) {
+            return hasFusionGroupsAttribute(user) || hasRootOpAttribute(user);
+          })) {
+        continue;
+      }
       
-      llvm::outs() << op.getName() << " is a root op" << "\n";
+      LLVM_DEBUG(llvm::dbgs() << op.getName() << " is a root op" << "\n");
       unsigned newGroup = numRootOps++;
       setRootAttribute(context, &op, newGroup);
       roots.push_back(&op);
@@ -801,6 +903,77 @@ FailureOr<Flow::WorkloadBuilder> getWorkloadBuilder(OpBuilder &builder,
   return result;
 }
 
+/// Merges all dispatch regions of |funcOp| into the last one so that a matched
+/// decoder block is lowered to a single executable. Linalg ops are tagged with
+/// the position of the region they were formed in first. Reshapes in between
+/// the regions are moved along with them; the fusion is skipped if any other op
+/// in between uses a value produced by one of the regions.
+static LogicalResult fuseDecoderBlockRegions(RewriterBase &rewriter,
+                                             FunctionOpInterface funcOp) {
+  SmallVector<Flow::DispatchRegionOp> regionOps;
+  funcOp.walk([&](Flow::DispatchRegionOp op) { regionOps.push_back(op); });
+  if (regionOps.size() < 2) return success();
+  Flow::DispatchRegionOp fusedOp = regionOps.back();
+  Block *block = fusedOp->getBlock();
+  for (Flow::DispatchRegionOp regionOp : regionOps) {
+    if (regionOp->getBlock() != block) return success();
+  }
+
+  SmallVector<Operation *> opsToMove;
+  for (Operation *op = regionOps.front(); op != fusedOp.getOperation();
+       op = op->getNextNode()) {
+    if (isa<Flow::DispatchRegionOp, tensor::ExpandShapeOp,
+            tensor::CollapseShapeOp>(op)) {
+      opsToMove.push_back(op);
+    }
+  }
+  llvm::SmallPtrSet<Operation *, 16> opsToMoveSet(opsToMove.begin(),
+                                                  opsToMove.end());
+  for (Operation *op : opsToMove) {
+    for (Operation *user : op->getUsers()) {
+      Operation *ancestor = block->findAncestorOpInBlock(*user);
+      if (!ancestor) return success();
+      if (ancestor == fusedOp.getOperation() ||
+          opsToMoveSet.contains(ancestor) ||
+          fusedOp->isBeforeInBlock(ancestor)) {
+        continue;
+      }
+      LLVM_DEBUG(llvm::dbgs() << "decoder block not fused due to " << *user
+                              << "\n");
+      return success();
+    }
+  }
+
+  MLIRContext *context = funcOp->getContext();
+  for (const auto &it : llvm::enumerate(regionOps)) {
+    auto stageAttr = IntegerAttr::get(IntegerType::get(context, 64), it.index());
+    it.value().getBody().walk([&](linalg::LinalgOp linalgOp) {
+      linalgOp->setAttr(kPIMBlockStageAttr, stageAttr);
+    });
+  }
+
+  // Moving each op to the front of the fused region in reverse order keeps
+  // the original program order.
+  for (Operation *op : llvm::reverse(opsToMove)) {
+    auto newRegionOp =
+        movePrecedingOpIntoDispatchRegion(rewriter, op, fusedOp);
+    if (failed(newRegionOp)) return failure();
+    fusedOp = *newRegionOp;
+  }
+
+  // Inline the moved regions into the fused one.
+  for (auto nestedOp :
+       llvm::to_vector(fusedOp.getBody().getOps<Flow::DispatchRegionOp>())) {
+    Block &nestedBody = nestedOp.getBody().front();
+    auto returnOp = cast<Flow::ReturnOp>(nestedBody.getTerminator());
+    SmallVector<Value> results(returnOp.getOperands());
+    rewriter.mergeBlockBefore(&nestedBody, nestedOp);
+    rewriter.eraseOp(returnOp);
+    rewriter.replaceOp(nestedOp, results);
+  }
+  return success();
+}
+
 /// Create Flow::DispatchGroupsOps based on a fusion heuristic.
 static LogicalResult createFusionGroups(TensorDimTrackingRewriter &rewriter,
                                         FunctionOpInterface funcOp,
@@ -881,7 +1054,11 @@ static LogicalResult createFusionGroups(TensorDimTrackingRewriter &rewriter,
   }
 
   // Generate meta data file
-  GenerateMetaData(funcOp);
+  bool isDecoderBlock =
+      GenerateMetaData(funcOp, clPIMFuseDecoderBlock, clPIMPipelineStages);
+  if (isDecoderBlock && clPIMFuseDecoderBlock) {
+    if (failed(fuseDecoderBlockRegions(rewriter, funcOp))) return failure();
+  }
 
   LLVM_DEBUG({
     llvm::dbgs() << "\n--- After creating flow.dispatch.region ---\n";
@@ -898,8 +1075,8 @@ struct FormDispatchRegionsPass
     : public FormDispatchRegionsBase<FormDispatchRegionsPass> {
   void getDependentDialects(DialectRegistry &registry) const override {
     registry
-        .insert<AffineDialect, IREE::Flow::FlowDialect, linalg::LinalgDialect,
-                scf::SCFDialect, tensor::TensorDialect>();
+        .insert<AffineDialect, IREE::Flow::FlowDialect, IREE::HAL::HALDialect,
+                linalg::LinalgDialect, scf::SCFDialect, tensor::TensorDialect>();
   }
   FormDispatchRegionsPass(bool aggressiveFusion, bool generateWorkloadRegion) {
     this->aggressiveFusion = aggressiveFusion;
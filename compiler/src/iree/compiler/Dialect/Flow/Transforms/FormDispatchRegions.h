@@ -41,7 +41,32 @@ namespace Flow {
 /// into a dispatch region.
 bool isClonableIntoDispatchOp(Operation *op);
 
-void GenerateMetaData(FunctionOpInterface funcOp);
+/// Returns true if |op| is an elementwise `linalg.generic` that dequantizes a
+/// tensor of integers of at most 8 bits to floats, optionally using broadcast
+/// scales and zero points (such as per-group weight scales).
+bool isDequantizationLikeOp(Operation *op);
+
+/// Records the PIM partitioning of the dispatch regions of |funcOp| as a
+/// `pim.partition` dictionary on their linalg ops. Regions are classified by
+/// the structure of their linalg ops and grouped into norm, attention and MLP
+/// blocks. The dictionary holds the `workload`, `num_device`, `block` and the
+/// `partitioning` and `sync` of block projections and, for decoder blocks, the
+/// `layer`, `fusion` and `config` (d_model, n_head, d_head, token, n_kv_head)
+/// read by PIM codegen. The vocabulary projection following the final norm
+/// gets the `lm_head` workload and is split row-wise across the PIM modules.
+/// Returns true if the regions form a single GPT or LLaMA decoder block.
+/// |fuseDecoderBlock| records that the block is lowered to a single
+/// executable.
+///
+/// With |pipelineStages| > 1 the decoder layers of other graphs are placed on
+/// that many PIM modules in order instead: every region gets the
+/// `stream.affinity` queue of its layer and a `pipelined` partition entry so
+/// that it is lowered for a single module without splits or syncs.
+///
+/// Nothing recorded identifies a particular dispatch or layer: structurally
+/// identical layers are outlined to identical executables and deduplicated.
+bool GenerateMetaData(FunctionOpInterface funcOp, bool fuseDecoderBlock,
+                      int pipelineStages = 0);
 /// Computes the workload and provides a workload region builder for the given
 /// root op.
 FailureOr<Flow::WorkloadBuilder> getWorkloadBuilder(OpBuilder &builder,
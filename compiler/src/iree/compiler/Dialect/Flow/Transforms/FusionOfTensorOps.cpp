@@ -12,6 +12,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "iree/compiler/Dialect/Flow/Transforms/FormDispatchRegions.h"
 #include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
 #include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
 #include "llvm/Support/Debug.h"
@@ -238,6 +239,14 @@ struct FusionOfTensorOpsPass
                             consumer->operand_end());
             if (operands.size() >= kIreeMaxOperandCount) return false;
 
+            // Keep dequantization out of contractions so that the consumer is
+            // still recognized as one; dispatch region formation clones the
+            // dequantization into the consumer dispatch instead.
+            if (isDequantizationLikeOp(producer) &&
+                cast<linalg::LinalgOp>(consumer).getNumReductionLoops() != 0) {
+              return false;
+            }
+
             return areFusableOps(context, producer, consumer);
           };
       linalg::populateElementwiseOpsFusionPatterns(fusionPatterns,
@@ -8,6 +8,7 @@
 #include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
 #include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
 #include "iree/compiler/Dialect/Flow/Transforms/RegionOpUtils.h"
+#include "iree/compiler/Dialect/HAL/IR/HALTypes.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/TypeSwitch.h"
 #include "llvm/Support/CommandLine.h"
@@ -35,338 +36,480 @@
 #include "mlir/Pass/Pass.h"
 #include "mlir/Support/LLVM.h"
 #include "mlir/Transforms/TopologicalSortUtils.h"
-#include "json/json.h"
 
-#include <fstream>
-#include <iostream>
 #include <string>
 
+#define DEBUG_TYPE "iree-flow-generate-metadata"
+
 namespace mlir {
 
 namespace iree_compiler {
 namespace IREE {
 namespace Flow {
-  
-void GenerateMetaData(FunctionOpInterface funcOp)
-{
-    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    std::vector<std::string> op_pattern;
-
-    const std::vector<std::string> gpt_decoder_pattern
-        = {"arith.addf", "linalg.generic", "flow.dispatch.region", // layernorm
-        "arith.divf", "arith.subf", "linalg.generic", "flow.dispatch.region", // layernorm
-        "arith.mulf", "arith.addf", "linalg.generic", "flow.dispatch.region", // layernorm
-        "arith.divf", "arith.addf", "math.rsqrt", "arith.mulf", "linalg.generic", "flow.dispatch.region", // layernorm
-        "arith.mulf", "arith.addf", "linalg.matmul", "arith.addf", "linalg.generic", "flow.dispatch.region", // c_attn
-        "arith.mulf", "arith.addf", "linalg.batch_matmul", "flow.dispatch.region", // QK
-        "arith.maxf", "linalg.generic", "arith.subf", "linalg.generic", "flow.dispatch.region", // softmax
-        "arith.addf", "linalg.generic", "arith.divf", "linalg.generic", "flow.dispatch.region", // softmax
-        "arith.mulf", "arith.addf", "linalg.batch_matmul", "flow.dispatch.region", // SV
-        "arith.mulf", "arith.addf", "linalg.matmul", "arith.addf", "arith.addf", "linalg.generic", "flow.dispatch.region", // c_proj+shortcut
-        "arith.addf", "linalg.generic", "flow.dispatch.region", // layernorm
-        "arith.divf", "arith.subf", "linalg.generic", "flow.dispatch.region", // layernorm
-        "arith.mulf", "arith.addf", "linalg.generic", "flow.dispatch.region", // layernorm
-        "arith.divf", "arith.addf", "math.rsqrt", "arith.mulf", "linalg.generic", "flow.dispatch.region", // layernorm
-        "arith.mulf", "arith.addf", "linalg.matmul", "arith.addf", "linalg.generic", "flow.dispatch.region", // fc1
-        "arith.mulf", "arith.addf", "linalg.matmul", "arith.addf", "arith.addf", "linalg.generic", "flow.dispatch.region" // fc2+shortcut
-    };
 
-    const std::vector<std::string> layernorm_pattern
-        = {"arith.addf", "linalg.generic", "flow.dispatch.region",
-        "arith.divf", "arith.subf", "linalg.generic", "flow.dispatch.region",
-        "arith.mulf", "arith.addf", "linalg.generic", "flow.dispatch.region",
-        "arith.divf", "arith.addf", "math.rsqrt", "arith.mulf", "linalg.generic", "flow.dispatch.region"
-    };
+// Records |partition| on the linalg ops of |regionOp|. The attribute moves
+// with the ops into the outlined executable where PIM codegen reads it.
+static void setPIMPartition(IREE::Flow::DispatchRegionOp regionOp,
+                            DictionaryAttr partition) {
+    regionOp->walk([&](linalg::LinalgOp op) {
+        op->setAttr("pim.partition", partition);
+    });
+}
 
-    const std::vector<std::string> matmul_pattern
-        = {"arith.mulf", "arith.addf", "linalg.matmul", "arith.addf", "linalg.generic", "flow.dispatch.region"
-    };
+namespace {
 
-    const std::vector<std::string> qk_pattern
-        = {"arith.mulf", "arith.addf", "linalg.batch_matmul", "flow.dispatch.region"};
-    
-    const std::vector<std::string> softmax_pattern
-        = {"arith.maxf", "linalg.generic", "arith.subf", "linalg.generic", "flow.dispatch.region",
-        "arith.addf", "linalg.generic", "arith.divf", "linalg.generic", "flow.dispatch.region"};
-
-    const std::vector<std::string> sv_pattern
-        = {"arith.mulf", "arith.addf", "linalg.batch_matmul", "flow.dispatch.region"};
-    
-    const std::vector<std::string> matmul_shortcut_pattern
-        = {"arith.mulf", "arith.addf", "linalg.matmul", "arith.addf", "arith.addf", "linalg.generic", "flow.dispatch.region"};
-
-
-    // std::string file_path = "pattern.txt";
-    // std::ofstream file(file_path/*, std::ios::app*/);
-
-    // funcOp->print(llvm::dbgs(), OpPrintingFlags().useLocalScope());
-
-    funcOp.walk([&](Operation *op) {
-        // Check if the file is open
-        // if (file.is_open()) {
-        // Write the string to the file
-        if(isa<linalg::LinalgOp>(op) && !isa<linalg::FillOp/*, linalg::GenericOp*/>(op))
-            // file << op->getName().getStringRef().str() <<std::endl;
-            op_pattern.push_back(op->getName().getStringRef().str());
-        else if(isa<arith::AddFOp, arith::AddIOp, arith::SubFOp, arith::SubIOp,
-                arith::DivFOp, arith::DivSIOp, arith::DivUIOp, arith::NegFOp,
-                arith::TruncFOp, arith::TruncIOp, arith::ExtFOp, arith::ExtSIOp,
-                arith::ExtUIOp, arith::FPToSIOp, arith::FPToUIOp, arith::SIToFPOp,
-                arith::UIToFPOp, arith::MulFOp, arith::MaxFOp, math::RsqrtOp>(op))
-            // file << op->getName().getStringRef().str() <<std::endl;
-            op_pattern.push_back(op->getName().getStringRef().str());
-        else if(isa<IREE::Flow::DispatchRegionOp>(op))
-            // file << op->getName().getStringRef().str() <<std::endl;
-            op_pattern.push_back(op->getName().getStringRef().str());
-
-        // std::cout << "File saved successfully." << std::endl;
-        // }
-    });
+// Role of a dispatch region in a transformer graph. Regions are classified by
+// the structure of their linalg ops (contractions, reductions and the ops in
+// their bodies) so that variants of the same block, e.g. LayerNorm and
+// RMSNorm or GeLU and SiLU MLPs, are recognized alike.
+enum class RegionKind {
+    // 2-D contraction, optionally with a fused elementwise epilogue.
+    Matmul,
+    // Contraction with batch dimensions (attention scores and context).
+    BatchMatmul,
+    // Region applying a reciprocal square root: the end of a norm.
+    Normalize,
+    // Max reduction or exponential: the start of a softmax.
+    Softmax,
+    // Any other region with a reduction (mean, variance, sum).
+    Reduction,
+    // Region without reductions (activations, residuals, rotary embedding).
+    Elementwise,
+};
 
-    int matmul_cnt = 0;
-    int batch_matmul_cnt = 0;
-    int d_model, n_head, d_head, token;
-    if (op_pattern == gpt_decoder_pattern) {
-        Json::Value root;
-        Json::Value input, weight, weight_bm, bias;
-        root["workload"] = "decoder";
-        root["n_layer"] = "12";
-        llvm::outs() << "Decoder pattern matched!\n";
-        funcOp.walk([&](Operation *op_) {
-        // if(isa<linalg::MatmulOp>(op_)) {
-        if(auto op = dyn_cast<linalg::MatmulOp>(op_)) {
-            // Get tensor shape
-            mlir::Value inputTensor_l = op.getDpsInputOperands()[0]->get();
-            mlir::ShapedType inputType_l = inputTensor_l.getType().cast<mlir::ShapedType>();
-            mlir::ArrayRef<int64_t> shape_l = inputType_l.getShape();
-            mlir::Value inputTensor_r = op.getDpsInputOperands()[1]->get();
-            mlir::ShapedType inputType_r = inputTensor_r.getType().cast<mlir::ShapedType>();
-            mlir::ArrayRef<int64_t> shape_r = inputType_r.getShape();
-            /*
-            for (int64_t dim : shape_l) {
-            llvm::outs() << dim << " ";
-            }
-            for (int64_t dim : shape_r) {
-            llvm::outs() << dim << " ";
-            }*/ 
-            switch (matmul_cnt) {
-            case 0:
-                input["shape"][0] = shape_l[0];
-                input["shape"][1] = shape_l[1];
-                input["rank"] = 2;
-                root["1"] = (input);
-                d_model = shape_l[1];
-
-                weight["shape"][0] = shape_r[0];
-                weight["shape"][1] = shape_r[1];
-                weight["rank"] = 2;
-                root["2"] = (weight);
-
-                bias["shape"][0] = 1;
-                bias["shape"][1] = shape_r[1];
-                bias["rank"] = 2;
-                root["3"] = (bias);
-                break;
-            
-            case 1:
-                weight["shape"][0] = shape_r[0];
-                weight["shape"][1] = shape_r[1];
-                weight["rank"] = 2;
-                root["6"] = (weight);
-
-                bias["shape"][0] = 1;
-                bias["shape"][1] = shape_r[1];
-                bias["rank"] = 2;
-                root["7"] = (bias);
-                break;
-
-            case 2:
-                weight["shape"][0] = shape_r[0];
-                weight["shape"][1] = shape_r[1];
-                weight["rank"] = 2;
-                root["8"] = (weight);
-
-                bias["shape"][0] = 1;
-                bias["shape"][1] = shape_r[1];
-                bias["rank"] = 2;
-                root["9"] = (bias);
-                break;
-            case 3:
-                weight["shape"][0] = shape_r[0];
-                weight["shape"][1] = shape_r[1];
-                weight["rank"] = 2;
-                root["10"] = (weight);
-
-                bias["shape"][0] = 1;
-                bias["shape"][1] = shape_r[1];
-                bias["rank"] = 2;
-                root["11"] = (bias);
-                break;
-            }
-            matmul_cnt++;
-        }
+struct ClassifiedRegion {
+    IREE::Flow::DispatchRegionOp op;
+    RegionKind kind;
+    // The contraction of Matmul and BatchMatmul regions.
+    linalg::LinalgOp contraction;
+    // True if a linalg op of the region subtracts, e.g. the mean of a
+    // LayerNorm. RMSNorm does not center its input.
+    bool hasSubtraction = false;
+    // True if a linalg op of the region multiplies, e.g. by the sin and cos of
+    // a rotary embedding. Copies and broadcasts do not.
+    bool hasMultiplication = false;
+};
 
-        if(auto op = dyn_cast<linalg::BatchMatmulOp>(op_)) {
-            // Get tensor shape
-            mlir::Value inputTensor_l = op.getDpsInputOperands()[0]->get();
-            mlir::ShapedType inputType_l = inputTensor_l.getType().cast<mlir::ShapedType>();
-            mlir::ArrayRef<int64_t> shape_l = inputType_l.getShape();
-            mlir::Value inputTensor_r = op.getDpsInputOperands()[1]->get();
-            mlir::ShapedType inputType_r = inputTensor_r.getType().cast<mlir::ShapedType>();
-            mlir::ArrayRef<int64_t> shape_r = inputType_r.getShape();
-            /*
-            for (int64_t dim : shape_l) {
-            llvm::outs() << dim << " ";
-            }
-            for (int64_t dim : shape_r) {
-            llvm::outs() << dim << " ";
-            }*/ 
-            switch (batch_matmul_cnt) {
-            case 0:
-                weight_bm["shape"][0] = shape_r[0];
-                weight_bm["shape"][1] = shape_r[1];
-                weight_bm["shape"][2] = shape_r[2];
-                weight_bm["rank"] = 3;
-                root["4"] = (weight_bm);
-                n_head = shape_r[0];
-                d_head = shape_r[1];
-                token = shape_r[2];
-                break;
-            
-            case 1:
-                weight_bm["shape"][0] = shape_r[0];
-                weight_bm["shape"][1] = shape_r[1];
-                weight_bm["shape"][2] = shape_r[2];
-                weight_bm["rank"] = 3;
-                root["5"] = (weight_bm);
-                break;
-            }
-            batch_matmul_cnt++;
-        }
+// Contiguous range [begin, end) of classified regions forming one block.
+struct RegionRange {
+    size_t begin = 0;
+    size_t end = 0;
+};
 
-        }); // funcOp.walk
-        std::ofstream outFile("meta_data.json", std::ios::out);
-        outFile << root;
-        outFile.close();
-
-        // Executable json
-        Json::Value root_exe;
-        Json::Value exe;
-        Json::Value config;
-        root_exe["workload"] = "decoder";
-        root_exe["num_device"] = "1";
-        config["d_model"] = d_model;
-        config["n_head"] = n_head;
-        config["d_head"] = d_head;
-        config["token"] = token;
-        root_exe["config"] = config;
-
-        int num_exe = 16;
-        for (int i=0; i<num_exe; i++) {
-        if (i>=0 && i<3) {
-            exe["layer"] = "layernorm1-empty";
-            exe["partioning"] = "copy";
-            exe["sync"] = "none";
-        }
-        if (i==3) {
-            exe["layer"] = "layernorm1";
-            exe["partioning"] = "copy";
-            exe["sync"] = "none";
-        }
-        if (i>9 && i<13) {
-            exe["layer"] = "layernorm2-empty";
-            exe["partioning"] = "copy";
-            exe["sync"] = "none";
-        }
-        if (i==13) {
-            exe["layer"] = "layernorm2";
-            exe["partioning"] = "copy";
-            exe["sync"] = "none";
+struct NormBlock {
+    RegionRange regions;
+    bool isLayerNorm = false;
+};
+
+struct AttentionBlock {
+    RegionRange regions;
+    size_t qkv = 0, qk = 0, sv = 0, proj = 0;
+    // Regions other than the softmax in between the contractions, e.g. rotary
+    // embeddings, which the PIM decoder lowering does not implement.
+    bool hasExtraRegions = false;
+};
+
+struct MLPBlock {
+    RegionRange regions;
+    size_t up = 0, down = 0;
+    // The gate projection of a gated MLP (SwiGLU) preceding the up projection.
+    size_t gate = 0;
+    bool isGated = false;
+    // Elementwise regions in between the projections, e.g. a gated activation.
+    bool hasExtraRegions = false;
+};
+
+}  // namespace
+
+template <typename... OpTys>
+static bool bodyContains(linalg::LinalgOp op) {
+    return llvm::any_of(op.getBlock()->getOperations(),
+                        [](Operation &bodyOp) { return isa<OpTys...>(bodyOp); });
+}
+
+static ClassifiedRegion classifyRegion(IREE::Flow::DispatchRegionOp regionOp) {
+    ClassifiedRegion region{regionOp, RegionKind::Elementwise, nullptr};
+    bool hasNormalize = false, hasSoftmax = false, hasReduction = false;
+    regionOp->walk([&](linalg::LinalgOp op) {
+        if (isa<linalg::FillOp>(op)) return;
+        if (linalg::isaContractionOpInterface(op)) {
+            if (!region.contraction) region.contraction = op;
+            return;
         }
-        else if (i==4) {
-            exe["layer"] = "c_attn";
-            exe["partioning"] = "row-wise";
-            exe["sync"] = "none";
+        if (bodyContains<arith::SubFOp>(op)) region.hasSubtraction = true;
+        if (bodyContains<arith::MulFOp>(op)) region.hasMultiplication = true;
+        if (bodyContains<math::RsqrtOp, math::SqrtOp>(op)) hasNormalize = true;
+        if (bodyContains<math::ExpOp>(op)) hasSoftmax = true;
+        if (op.getNumReductionLoops() > 0) {
+            hasReduction = true;
+            if (bodyContains<arith::MaxFOp>(op)) hasSoftmax = true;
         }
-        else if (i==5) {
-            exe["layer"] = "qk";
-            exe["partioning"] = "head-wise";
-            exe["sync"] = "none";
+    });
+    if (region.contraction) {
+        // Matmuls have the M and N parallel dimensions, anything beyond that is
+        // a batch dimension.
+        region.kind = region.contraction.getNumParallelLoops() > 2
+                          ? RegionKind::BatchMatmul
+                          : RegionKind::Matmul;
+    } else if (hasNormalize) {
+        region.kind = RegionKind::Normalize;
+    } else if (hasSoftmax) {
+        region.kind = RegionKind::Softmax;
+    } else if (hasReduction) {
+        region.kind = RegionKind::Reduction;
+    }
+    return region;
+}
+
+static bool isContraction(RegionKind kind) {
+    return kind == RegionKind::Matmul || kind == RegionKind::BatchMatmul;
+}
+
+// Skips elementwise regions starting at |i|.
+static size_t skipElementwise(ArrayRef<ClassifiedRegion> regions, size_t i) {
+    while (i < regions.size() && regions[i].kind == RegionKind::Elementwise) ++i;
+    return i;
+}
+
+// norm := (Reduction | Elementwise)* Normalize
+static Optional<NormBlock> matchNorm(ArrayRef<ClassifiedRegion> regions,
+                                     size_t begin) {
+    NormBlock norm;
+    for (size_t i = begin; i < regions.size(); ++i) {
+        RegionKind kind = regions[i].kind;
+        norm.isLayerNorm |= regions[i].hasSubtraction;
+        if (kind == RegionKind::Normalize) {
+            norm.regions = {begin, i + 1};
+            return norm;
         }
-        else if ((i==6)) {
-            exe["layer"] = "softmax-empty";
-            exe["partioning"] = "head-wise";
-            exe["sync"] = "none";
+        if (kind != RegionKind::Reduction && kind != RegionKind::Elementwise) {
+            return std::nullopt;
         }
-        else if ((i==7)) {
-            exe["layer"] = "softmax";
-            exe["partioning"] = "head-wise";
-            exe["sync"] = "none";
+    }
+    return std::nullopt;
+}
+
+// attention := Matmul Elementwise* BatchMatmul (non-contraction)+ BatchMatmul
+//              Elementwise* Matmul
+// At least one region in between the batch matmuls must be a softmax.
+static Optional<AttentionBlock> matchAttention(
+    ArrayRef<ClassifiedRegion> regions, size_t begin) {
+    AttentionBlock attn;
+    size_t i = begin;
+    if (i >= regions.size() || regions[i].kind != RegionKind::Matmul) {
+        return std::nullopt;
+    }
+    attn.qkv = i++;
+    size_t next = skipElementwise(regions, i);
+    attn.hasExtraRegions |= next != i;
+    i = next;
+    if (i >= regions.size() || regions[i].kind != RegionKind::BatchMatmul) {
+        return std::nullopt;
+    }
+    attn.qk = i++;
+    bool hasSoftmax = false;
+    while (i < regions.size() && !isContraction(regions[i].kind)) {
+        hasSoftmax |= regions[i].kind == RegionKind::Softmax;
+        ++i;
+    }
+    if (!hasSoftmax || i >= regions.size() ||
+        regions[i].kind != RegionKind::BatchMatmul) {
+        return std::nullopt;
+    }
+    attn.sv = i++;
+    next = skipElementwise(regions, i);
+    attn.hasExtraRegions |= next != i;
+    i = next;
+    if (i >= regions.size() || regions[i].kind != RegionKind::Matmul) {
+        return std::nullopt;
+    }
+    attn.proj = i++;
+    attn.regions = {begin, i};
+    return attn;
+}
+
+// Returns true if the contractions of |lhs| and |rhs| read the same
+// activations.
+static bool isSameActivation(const ClassifiedRegion &lhs,
+                             const ClassifiedRegion &rhs) {
+    return lhs.contraction.getDpsInputOperand(0)->get() ==
+           rhs.contraction.getDpsInputOperand(0)->get();
+}
+
+// mlp := Matmul Elementwise* Matmul
+// gated_mlp := Matmul Elementwise* Matmul Elementwise* Matmul
+// The gate and up projections of a gated MLP read the same activations.
+static Optional<MLPBlock> matchMLP(ArrayRef<ClassifiedRegion> regions,
+                                   size_t begin) {
+    MLPBlock mlp;
+    size_t i = begin;
+    if (i >= regions.size() || regions[i].kind != RegionKind::Matmul) {
+        return std::nullopt;
+    }
+    mlp.up = i++;
+    size_t next = skipElementwise(regions, i);
+    mlp.hasExtraRegions = next != i;
+    i = next;
+    if (i >= regions.size() || regions[i].kind != RegionKind::Matmul) {
+        return std::nullopt;
+    }
+    if (isSameActivation(regions[mlp.up], regions[i])) {
+        mlp.gate = mlp.up;
+        mlp.up = i++;
+        mlp.isGated = true;
+        next = skipElementwise(regions, i);
+        mlp.hasExtraRegions |= next != i;
+        i = next;
+        if (i >= regions.size() || regions[i].kind != RegionKind::Matmul) {
+            return std::nullopt;
         }
-        else if (i==8) {
-            exe["layer"] = "sv";
-            exe["partioning"] = "head-wise";
-            exe["sync"] = "none";
+    }
+    mlp.down = i++;
+    mlp.regions = {begin, i};
+    return mlp;
+}
+
+// lm_head := Normalize Elementwise* Matmul
+// The vocabulary projection is the last contraction of the graph and reads the
+// output of the final norm. Regions consuming the logits (such as a top-k or
+// sampling) have no contraction. Returns the index of the projection.
+static Optional<size_t> matchLMHead(ArrayRef<ClassifiedRegion> regions) {
+    auto last = llvm::find_if(llvm::reverse(regions),
+                              [](const ClassifiedRegion &region) {
+                                  return isContraction(region.kind);
+                              });
+    if (last == regions.rend() || last->kind != RegionKind::Matmul) {
+        return std::nullopt;
+    }
+    size_t index = std::distance(last, regions.rend()) - 1;
+    size_t i = index;
+    while (i > 0 && regions[i - 1].kind == RegionKind::Elementwise) --i;
+    if (i == 0 || regions[i - 1].kind != RegionKind::Normalize) {
+        return std::nullopt;
+    }
+    return index;
+}
+
+// Places the decoder layers of |regions| on |stageCount| PIM modules in
+// order. A layer ends with the MLP following its attention (or with the
+// attention if no MLP follows), so the norm ahead of each attention stays with
+// its layer and regions past the last layer, e.g. a final norm and the
+// logits, stay on the last module. Activations cross modules once per stage
+// boundary instead of being all-reduced after every projection.
+static void placePipelineStages(ArrayRef<ClassifiedRegion> regions,
+                                int stageCount) {
+    SmallVector<size_t> layerEnds;
+    for (size_t i = 0; i < regions.size();) {
+        Optional<AttentionBlock> attn = matchAttention(regions, i);
+        if (!attn) {
+            ++i;
+            continue;
         }
-        else if (i==9) {
-            exe["layer"] = "c_proj+residual";
-            exe["partioning"] = "col-wise";
-            exe["sync"] = "reduce";
+        i = attn->regions.end;
+        Optional<NormBlock> norm = matchNorm(regions, i);
+        Optional<MLPBlock> mlp =
+            norm ? matchMLP(regions, norm->regions.end) : matchMLP(regions, i);
+        if (mlp) i = mlp->regions.end;
+        layerEnds.push_back(i);
+    }
+    if (layerEnds.empty()) return;
+    LLVM_DEBUG(llvm::dbgs() << "Pipelining " << layerEnds.size()
+                            << " decoder layers over " << stageCount
+                            << " PIM modules\n");
+
+    MLIRContext *context = regions.front().op.getContext();
+    Builder b(context);
+    size_t layer = 0;
+    for (size_t i = 0; i < regions.size(); ++i) {
+        while (layer + 1 < layerEnds.size() && i >= layerEnds[layer]) ++layer;
+        int stage = static_cast<int>(layer * stageCount / layerEnds.size());
+        regions[i].op->setAttr(
+            "stream.affinity",
+            IREE::HAL::AffinityQueueAttr::get(context, int64_t(1) << stage));
+        // The stage is only carried by the affinity of the dispatch so that
+        // the same layer placed on different modules outlines to identical
+        // executables and is deduplicated.
+        setPIMPartition(regions[i].op, b.getDictionaryAttr({
+            b.getNamedAttr("workload", b.getStringAttr("normal")),
+            b.getNamedAttr("num_device", b.getI32IntegerAttr(1)),
+            b.getNamedAttr("pipelined", b.getUnitAttr())}));
+    }
+}
+
+bool GenerateMetaData(FunctionOpInterface funcOp, bool fuseDecoderBlock,
+                      int pipelineStages)
+{
+    SmallVector<ClassifiedRegion> regions;
+    funcOp.walk([&](IREE::Flow::DispatchRegionOp regionOp) {
+        regions.push_back(classifyRegion(regionOp));
+    });
+    LLVM_DEBUG({
+        llvm::dbgs() << "Dispatch region kinds:";
+        for (const ClassifiedRegion &region : regions) {
+            llvm::dbgs() << " " << static_cast<int>(region.kind);
         }
-        else if (i==14) {
-            exe["layer"] = "fc1";
-            exe["partioning"] = "row-wise";
-            exe["sync"] = "none";
+        llvm::dbgs() << "\n";
+    });
+
+    // A decoder block is norm, attention, norm, MLP covering every region of
+    // the function. The PIM decoder lowering implements GPT blocks (LayerNorm
+    // and a single activation fused into the first MLP projection) and LLaMA
+    // blocks (RMSNorm, rotary embeddings of the queries and keys ahead of
+    // Query*Key and a SwiGLU MLP), so only blocks of those forms are lowered
+    // as one.
+    Optional<NormBlock> norm1 = matchNorm(regions, 0);
+    Optional<AttentionBlock> attn =
+        norm1 ? matchAttention(regions, norm1->regions.end) : std::nullopt;
+    Optional<NormBlock> norm2 =
+        attn ? matchNorm(regions, attn->regions.end) : std::nullopt;
+    Optional<MLPBlock> mlp =
+        norm2 ? matchMLP(regions, norm2->regions.end) : std::nullopt;
+    bool isBlock = mlp && mlp->regions.end == regions.size();
+    bool isGPTDecoder = isBlock && norm1->isLayerNorm && norm2->isLayerNorm &&
+                        !attn->hasExtraRegions && !mlp->hasExtraRegions &&
+                        !mlp->isGated;
+    bool isLlamaDecoder = isBlock && !norm1->isLayerNorm &&
+                          !norm2->isLayerNorm && attn->proj == attn->sv + 1 &&
+                          mlp->isGated;
+
+    Builder b(funcOp.getContext());
+    if (isGPTDecoder || isLlamaDecoder) {
+        LLVM_DEBUG(llvm::dbgs() << (isLlamaDecoder ? "LLaMA" : "GPT")
+                                << " decoder pattern matched!\n");
+        linalg::LinalgOp c_attn = regions[attn->qkv].contraction;
+        linalg::LinalgOp qk = regions[attn->qk].contraction;
+
+        ArrayRef<int64_t> shape_x =
+            c_attn.getDpsInputOperand(0)->get().getType().cast<ShapedType>().getShape();
+        ArrayRef<int64_t> shape_k =
+            qk.getDpsInputOperand(1)->get().getType().cast<ShapedType>().getShape();
+        int d_model = shape_x[1];
+        int n_head = shape_k[0];
+        int d_head = shape_k[1];
+        // Dynamic sequence lengths are read from push constants by the
+        // instructions and recorded as -1.
+        int token = ShapedType::isDynamic(shape_k[2]) ? -1 : shape_k[2];
+        // The QKV projection produces n_head query heads followed by the key
+        // and value heads. Fewer key and value heads than query heads are
+        // shared by groups of query heads (grouped-query attention).
+        ArrayRef<int64_t> shape_qkv =
+            c_attn.getDpsInitOperand(0)->get().getType().cast<ShapedType>().getShape();
+        int n_kv_head = (shape_qkv[1] / d_head - n_head) / 2;
+        if (n_kv_head <= 0 || n_head % n_kv_head != 0) n_kv_head = n_head;
+
+        // Partitioning of each dispatch region. When fused the layers below
+        // are stages of a single executable instead of separate dispatches.
+        SmallVector<NamedAttribute> common = {
+            b.getNamedAttr("workload", b.getStringAttr("decoder")),
+            b.getNamedAttr("num_device", b.getI32IntegerAttr(1)),
+            b.getNamedAttr("fusion", b.getStringAttr(fuseDecoderBlock ? "block" : "none")),
+            b.getNamedAttr("config", b.getDenseI32ArrayAttr({d_model, n_head, d_head, token, n_kv_head}))};
+        auto setLayer = [&](size_t index, StringRef block, StringRef layer,
+                            StringRef partitioning, StringRef sync) {
+            SmallVector<NamedAttribute> attrs(common);
+            attrs.push_back(b.getNamedAttr("block", b.getStringAttr(block)));
+            attrs.push_back(b.getNamedAttr("layer", b.getStringAttr(layer)));
+            attrs.push_back(b.getNamedAttr("partitioning", b.getStringAttr(partitioning)));
+            attrs.push_back(b.getNamedAttr("sync", b.getStringAttr(sync)));
+            setPIMPartition(regions[index].op, b.getDictionaryAttr(attrs));
+        };
+        // Only the last region of a norm or softmax emits the PIM command; the
+        // preceding "-empty" regions forward their input.
+        auto setNorm = [&](const NormBlock &norm, StringRef layer) {
+            std::string empty = (layer + "-empty").str();
+            for (size_t i = norm.regions.begin; i + 1 < norm.regions.end; ++i) {
+                setLayer(i, "norm", empty, "copy", "none");
+            }
+            setLayer(norm.regions.end - 1, "norm", layer, "copy", "none");
+        };
+        setNorm(*norm1, isLlamaDecoder ? "rmsnorm1" : "layernorm1");
+        setLayer(attn->qkv, "attention", "c_attn", "row-wise", "none");
+        // Rotary embeddings multiply the queries and keys by the sin and cos
+        // of their positions. Broadcasts of shared key and value heads are
+        // read ungrouped by the attention instructions.
+        for (size_t i = attn->qkv + 1; i < attn->qk; ++i) {
+            setLayer(i, "attention",
+                     regions[i].hasMultiplication ? "rope" : "rope-empty",
+                     "head-wise", "none");
         }
-        else if (i==15) {
-            exe["layer"] = "fc2+residual";
-            exe["partioning"] = "col-wise";
-            exe["sync"] = "reduce";
+        setLayer(attn->qk, "attention", "qk", "head-wise", "none");
+        for (size_t i = attn->qk + 1; i + 1 < attn->sv; ++i) {
+            setLayer(i, "attention", "softmax-empty", "head-wise", "none");
         }
-        root_exe[std::to_string(i)] = (exe);
+        setLayer(attn->sv - 1, "attention", "softmax", "head-wise", "none");
+        setLayer(attn->sv, "attention", "sv", "head-wise", "none");
+        setLayer(attn->proj, "attention", "c_proj+residual", "col-wise", "reduce");
+        setNorm(*norm2, isLlamaDecoder ? "rmsnorm2" : "layernorm2");
+        if (mlp->isGated) {
+            // The SiLU of the gate and its product with the up projection are
+            // computed by the projection instructions.
+            setLayer(mlp->gate, "mlp", "fc1_gate", "row-wise", "none");
+            for (size_t i = mlp->gate + 1; i < mlp->down; ++i) {
+                if (i == mlp->up) continue;
+                setLayer(i, "mlp", "swiglu-empty", "row-wise", "none");
+            }
+            setLayer(mlp->up, "mlp", "fc1+swiglu", "row-wise", "none");
+        } else {
+            setLayer(mlp->up, "mlp", "fc1", "row-wise", "none");
         }
-        std::ofstream outFile2("exe_map.json", std::ios::out);
-        outFile2 << root_exe;
-        outFile2.close();
-
-    } // if decoder pattern
-
-    else {
-        Json::Value root;
-        root["workload"] = "normal";
-        llvm::outs() << "Normal graph pattern\n";
-        funcOp.walk([&](Operation *op_) {
-        // if(isa<linalg::MatmulOp>(op_)) {
-        if(auto op = dyn_cast<linalg::MatmulOp>(op_)) {
-            // Get tensor shape
-            mlir::Value inputTensor_l = op.getDpsInputOperands()[0]->get();
-            mlir::ShapedType inputType_l = inputTensor_l.getType().cast<mlir::ShapedType>();
-            mlir::ArrayRef<int64_t> shape_l = inputType_l.getShape();
-            mlir::Value inputTensor_r = op.getDpsInputOperands()[1]->get();
-            mlir::ShapedType inputType_r = inputTensor_r.getType().cast<mlir::ShapedType>();
-            mlir::ArrayRef<int64_t> shape_r = inputType_r.getShape();
-            switch (matmul_cnt) {
-            case 0:
-                root["0"] = "gather";
-                break;
-            case 1:
-                root["1"] = "reduce";
-                break;
+        setLayer(mlp->down, "mlp", "fc2+residual", "col-wise", "reduce");
+        return true;
+    }
+
+    if (pipelineStages > 1) {
+        placePipelineStages(regions, std::min(pipelineStages, 64));
+        return false;
+    }
+
+    // Anything else is lowered dispatch by dispatch. The projections of each
+    // attention or MLP block are split as a pair: the first one row-wise with
+    // its slices gathered for the next dispatch, the second col-wise with its
+    // partial sums reduced. Contractions outside of a block run unsplit.
+    LLVM_DEBUG(llvm::dbgs() << "Normal graph pattern\n");
+    auto setMatmul = [&](size_t index, StringRef block, StringRef partitioning,
+                         StringRef sync) {
+        setPIMPartition(regions[index].op, b.getDictionaryAttr({
+            b.getNamedAttr("workload", b.getStringAttr("normal")),
+            b.getNamedAttr("num_device", b.getI32IntegerAttr(1)),
+            b.getNamedAttr("block", b.getStringAttr(block)),
+            b.getNamedAttr("partitioning", b.getStringAttr(partitioning)),
+            b.getNamedAttr("sync", b.getStringAttr(sync))}));
+    };
+    for (size_t i = 0; i < regions.size();) {
+        if (Optional<AttentionBlock> block = matchAttention(regions, i)) {
+            LLVM_DEBUG(llvm::dbgs() << "Attention block at region " << i << "\n");
+            setMatmul(block->qkv, "attention", "row-wise", "gather");
+            setMatmul(block->proj, "attention", "col-wise", "reduce");
+            i = block->regions.end;
+        } else if (Optional<MLPBlock> block = matchMLP(regions, i)) {
+            LLVM_DEBUG(llvm::dbgs() << "MLP block at region " << i << "\n");
+            if (block->isGated) {
+                setMatmul(block->gate, "mlp", "row-wise", "gather");
             }
-            matmul_cnt++;
+            setMatmul(block->up, "mlp", "row-wise", "gather");
+            setMatmul(block->down, "mlp", "col-wise", "reduce");
+            i = block->regions.end;
+        } else {
+            ++i;
         }
-        }); // funcOp.walk
-        std::ofstream outFile("exe_map.json", std::ios::out);
-        outFile << root;
-        outFile.close();
-    } // else (decoder pattern)
-
-    // Close the file
-    // file.close();
     }
 
+    // The vocabulary projection is the largest weight read of a decode step.
+    // Its vocabulary (N) is sharded row-wise across the PIM modules and the
+    // logits are all-gathered.
+    if (Optional<size_t> lmHead = matchLMHead(regions)) {
+        LLVM_DEBUG(llvm::dbgs() << "LM head at region " << *lmHead << "\n");
+        setPIMPartition(regions[*lmHead].op, b.getDictionaryAttr({
+            b.getNamedAttr("workload", b.getStringAttr("lm_head")),
+            b.getNamedAttr("num_device", b.getI32IntegerAttr(1)),
+            b.getNamedAttr("block", b.getStringAttr("lm_head")),
+            b.getNamedAttr("partitioning", b.getStringAttr("row-wise")),
+            b.getNamedAttr("sync", b.getStringAttr("gather"))}));
+    }
+    return false;
+}
+
 }  // namespace Flow
 }  // namespace IREE
 }  // namespace iree_compiler
-}  // namespace mlir
\ No newline at end of file
+}  // namespace mlir
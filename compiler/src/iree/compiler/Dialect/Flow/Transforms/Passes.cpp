@@ -102,6 +102,42 @@ static llvm::cl::opt<bool> clZeroFillEmptyTensors(
         "Zero fill empty tensors instead of leaving them uninitialized"),
     llvm::cl::init(false));
 
+static llvm::cl::opt<bool> clRaiseAttention(
+    "iree-flow-raise-attention",
+    llvm::cl::desc("Raises matmul-softmax-matmul attention chains to a single "
+                   "fused attention op computed with an online softmax. "
+                   "Disabled for PIM which lowers the chain op by op."),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<bool> clEnableConvWinogradTransform(
+    "iree-flow-enable-conv-winograd-transform",
+    llvm::cl::desc("Computes 3x3 stride 1 convolutions with constant filters "
+                   "with the Winograd algorithm as input and output transforms "
+                   "around a batch matmul. Meant for CPU targets."),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<int64_t> clWinogradOutputTileSize(
+    "iree-flow-winograd-output-tile-size",
+    llvm::cl::desc("Size of the output tiles of Winograd convolutions: 4 for "
+                   "F(4x4, 3x3) or 6 for the cheaper but less accurate "
+                   "F(6x6, 3x3)."),
+    llvm::cl::init(4));
+
+static llvm::cl::opt<bool> clPropagateTransposes(
+    "iree-flow-propagate-transposes",
+    llvm::cl::desc("Folds transposes into the indexing maps of the ops "
+                   "producing and consuming them instead of dispatching them "
+                   "as copies. Disabled for PIM which matches named batch "
+                   "matmuls and identity-mapped elementwise ops."),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<bool> clPIMSpecializeDecode(
+    "iree-flow-pim-specialize-decode",
+    llvm::cl::desc("Emits a single-token decode variant of PIM dispatches "
+                   "with a dynamic token count next to their prefill "
+                   "variant and selects between them at dispatch time."),
+    llvm::cl::init(false));
+
 namespace mlir {
 namespace iree_compiler {
 namespace IREE {
@@ -191,6 +227,8 @@ void buildFlowTransformPassPipeline(OpPassManager &passManager,
   passManager.addPass(IREE::Flow::createExpandTensorShapesPass());
   buildGlobalOptimizationPassPipeline(passManager, transformOptions);
 
+  bool enableDataTiling = clEnableDataTiling || transformOptions.dataTiling;
+
   // Pad tensors.
   passManager.addPass(IREE::Flow::createTensorPadToTensorInsertSlicePass(
       /*skipSingleLinalgOpUses=*/clEnableFusePaddingIntoLinalgConsumerOps));
@@ -201,8 +239,17 @@ void buildFlowTransformPassPipeline(OpPassManager &passManager,
       // - Remove unit-extent dimensions.
       .addPass(mlir::createConvertElementwiseToLinalgPass)
       .addPass(mlir::createLinalgFoldUnitExtentDimsPass)
-      .addPass(createRaiseSpecialOps)
+      .addPredicatedPass(clEnableConvWinogradTransform,
+                         []() {
+                           return IREE::LinalgExt::
+                               createConvertConv2DToWinogradPass(
+                                   clWinogradOutputTileSize);
+                         })
+      .addPass([&]() { return createRaiseSpecialOps(clRaiseAttention); })
       .addPass(createInterchangeGenericOpsPass)
+      // Fold transposes away before fusion so that they don't form copy
+      // dispatches between the ops they sit between.
+      .addPredicatedPass(clPropagateTransposes, createPropagateTransposesPass)
       .addPass(memref::createResolveShapedTypeResultDimsPass)
       .addPass(mlir::createCanonicalizerPass)
       .addPass(mlir::createCSEPass)
@@ -225,7 +272,16 @@ void buildFlowTransformPassPipeline(OpPassManager &passManager,
       .addPredicatedPass(clNormalizeInputIndexingMap,
                          createInterchangeTransposeGenericOpsPass)
       // Enable data tiling after all linalg level transformations.
-      .addPredicatedPass(clEnableDataTiling, createSetEncodingPass)
+      .addPredicatedPass(enableDataTiling, createSetEncodingPass);
+
+  // Hoist the encodings of constant operands (weights) into globals so that
+  // they are packed once at program load instead of on every invocation.
+  // Const-eval cannot fold these as the packed layout is chosen per target.
+  if (enableDataTiling && transformOptions.constExprHoisting) {
+    passManager.addPass(IREE::Util::createHoistIntoGlobalsPass());
+  }
+
+  FunctionLikeNest(passManager)
       ////////////////////////////////////////////////////////////////////////
       // Dispatch region formation.
       .addPredicatedPass(!clDispatchTransformFileName.empty(),
@@ -267,6 +323,12 @@ void buildFlowTransformPassPipeline(OpPassManager &passManager,
   // Cleanup identity ops that clutter up the IR and canonicalize.
   FunctionLikeNest(passManager).addPass(mlir::createCanonicalizerPass);
 
+  // Specialize PIM dispatches for decode; the duplicates this creates across
+  // layers are removed below.
+  if (clPIMSpecializeDecode) {
+    passManager.addPass(IREE::Flow::createSpecializePIMDecodeDispatchesPass());
+  }
+
   // Deduplicate executables created from dispatch regions.
   // Note: this only deduplicates equivalent executables. We could in addition
   // generalize executables to prune further (e.g. by promoting a dimension to
@@ -30,6 +30,11 @@ struct TransformOptions : public PassPipelineOptions<TransformOptions> {
   // become the default.
   bool constExprHoisting = false;
 
+  // Enables data tiling of contractions via tensor encodings. Only valid when
+  // all target backends materialize encodings. Constant operands are packed
+  // once at program load when constExprHoisting is also enabled.
+  bool dataTiling = false;
+
   // Enables passes to perform numeric precision reduction.
   bool numericPrecisionReduction = false;
 
@@ -111,6 +116,11 @@ std::unique_ptr<Pass> createInterchangeGenericOpsPass();
 // identity.
 std::unique_ptr<Pass> createInterchangeTransposeGenericOpsPass();
 
+// Create a pass to fold transposes into the indexing maps of the linalg ops
+// producing and consuming them so that they don't need dispatches of their
+// own.
+std::unique_ptr<Pass> createPropagateTransposesPass();
+
 // Create a pass to convert operations to `flow` ops. This pass is currently
 // only used for testing, since the conversion to Flow ops happens within
 // dispatch region formation.
@@ -192,8 +202,14 @@ std::unique_ptr<OperationPass<mlir::ModuleOp>>
 createDeduplicateExecutablesPass();
 
 // Create a pass to raise sequence of ops to higher level linalg.ext
-// representation.
-std::unique_ptr<Pass> createRaiseSpecialOps();
+// representation. Attention chains are only raised with |raiseAttention|.
+std::unique_ptr<Pass> createRaiseSpecialOps(bool raiseAttention = false);
+
+// Clones executables whose PIM contractions read a dynamic token count into a
+// variant with the count folded to 1 and selects between the original
+// (prefill) and the decode variant at each dispatch site.
+std::unique_ptr<OperationPass<mlir::ModuleOp>>
+createSpecializePIMDecodeDispatchesPass();
 
 // Create a pass to split reduction dimension.
 std::unique_ptr<Pass> createSplitReductionPass();
@@ -0,0 +1,216 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//===--------------- PropagateTransposes.cpp ------------------------------===//
+//
+// Folds transposes into the indexing maps of the ops producing and consuming
+// them so that they don't form full-tensor copy dispatches of their own.
+//
+//===----------------------------------------------------------------------===//
+
+#include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
+#include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Linalg/Transforms/Transforms.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/Dialect/Tensor/Utils/Utils.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Flow {
+
+namespace {
+
+// A transpose reading |source| with the permutation |inputMap| from the
+// transposed dims to the dims of |source|.
+struct Transpose {
+  Value source;
+  AffineMap inputMap;
+};
+
+// Matches |op| as a transpose, either as a linalg.transpose or as the
+// equivalent generic copying its input with a permuted indexing map.
+static Optional<Transpose> matchTranspose(Operation *op) {
+  if (auto transposeOp = dyn_cast<linalg::TransposeOp>(op)) {
+    if (!transposeOp.hasTensorSemantics()) return std::nullopt;
+    SmallVector<unsigned> permutation(transposeOp.getPermutation().begin(),
+                                      transposeOp.getPermutation().end());
+    return Transpose{transposeOp.getInput(),
+                     inversePermutation(AffineMap::getPermutationMap(
+                         permutation, op->getContext()))};
+  }
+  auto genericOp = dyn_cast<linalg::GenericOp>(op);
+  if (!genericOp || !genericOp.hasTensorSemantics() ||
+      genericOp.getNumDpsInputs() != 1 || genericOp.getNumDpsInits() != 1 ||
+      genericOp.getNumParallelLoops() != genericOp.getNumLoops()) {
+    return std::nullopt;
+  }
+  Block *body = genericOp.getBlock();
+  if (!llvm::hasSingleElement(*body) ||
+      body->getTerminator()->getOperand(0) != body->getArgument(0)) {
+    return std::nullopt;
+  }
+  SmallVector<AffineMap> maps = genericOp.getIndexingMapsArray();
+  if (!maps[0].isPermutation() || maps[0].isIdentity() ||
+      !maps[1].isIdentity()) {
+    return std::nullopt;
+  }
+  return Transpose{genericOp.getDpsInputOperand(0)->get(), maps[0]};
+}
+
+// Returns |linalgOp| as a generic op, generalizing named contractions such as
+// the batch matmuls of attention. Other named ops are left as-is.
+static FailureOr<linalg::GenericOp> getAsGenericOp(
+    PatternRewriter &rewriter, linalg::LinalgOp linalgOp) {
+  if (auto genericOp = dyn_cast<linalg::GenericOp>(linalgOp.getOperation())) {
+    return genericOp;
+  }
+  if (!linalg::isaContractionOpInterface(linalgOp)) return failure();
+  return linalg::generalizeNamedOp(rewriter, linalgOp);
+}
+
+// Reads the sources of transposed operands directly by composing the
+// transpose into the indexing map of the operand:
+//
+//   %kt = linalg.transpose ins(%k) permutation = [0, 2, 1]
+//   linalg.batch_matmul ins(%q, %kt)
+//
+// becomes a generic reading %k with the (b, m, n, k) -> (b, n, k) map.
+struct FoldTransposeIntoConsumer
+    : public OpInterfaceRewritePattern<linalg::LinalgOp> {
+  using OpInterfaceRewritePattern<linalg::LinalgOp>::OpInterfaceRewritePattern;
+  LogicalResult matchAndRewrite(linalg::LinalgOp linalgOp,
+                                PatternRewriter &rewriter) const override {
+    if (!linalgOp.hasTensorSemantics()) {
+      return rewriter.notifyMatchFailure(linalgOp, "no tensor semantics");
+    }
+    SmallVector<std::pair<unsigned, Transpose>> transposedOperands;
+    for (OpOperand *operand : linalgOp.getDpsInputOperands()) {
+      Operation *producer = operand->get().getDefiningOp();
+      if (!producer) continue;
+      if (auto transpose = matchTranspose(producer)) {
+        transposedOperands.emplace_back(operand->getOperandNumber(),
+                                        *transpose);
+      }
+    }
+    if (transposedOperands.empty()) {
+      return rewriter.notifyMatchFailure(linalgOp, "no transposed operands");
+    }
+
+    FailureOr<linalg::GenericOp> genericOp =
+        getAsGenericOp(rewriter, linalgOp);
+    if (failed(genericOp)) {
+      return rewriter.notifyMatchFailure(linalgOp, "not a contraction");
+    }
+    SmallVector<AffineMap> maps = genericOp->getIndexingMapsArray();
+    rewriter.updateRootInPlace(*genericOp, [&]() {
+      for (auto &[operandNumber, transpose] : transposedOperands) {
+        maps[operandNumber] = transpose.inputMap.compose(maps[operandNumber]);
+        genericOp->getOperation()->setOperand(operandNumber, transpose.source);
+      }
+      genericOp->setIndexingMapsAttr(rewriter.getAffineMapArrayAttr(maps));
+    });
+    return success();
+  }
+};
+
+// Writes the result of ops only read by a transpose in the transposed layout
+// by composing the inverse of the transpose into their result indexing map.
+// Results accumulated into a fill (as contractions are) get a fill of the
+// transposed shape.
+struct FoldTransposeIntoProducer
+    : public OpInterfaceRewritePattern<linalg::LinalgOp> {
+  using OpInterfaceRewritePattern<linalg::LinalgOp>::OpInterfaceRewritePattern;
+  LogicalResult matchAndRewrite(linalg::LinalgOp transposeOp,
+                                PatternRewriter &rewriter) const override {
+    Optional<Transpose> transpose = matchTranspose(transposeOp);
+    if (!transpose) return rewriter.notifyMatchFailure(transposeOp, "no match");
+    auto producerOp = transpose->source.getDefiningOp<linalg::LinalgOp>();
+    if (!producerOp || !producerOp.hasTensorSemantics() ||
+        producerOp->getNumResults() != 1 || !transpose->source.hasOneUse() ||
+        matchTranspose(producerOp)) {
+      return rewriter.notifyMatchFailure(transposeOp, "no single-use producer");
+    }
+
+    // The initial contents of the result must not depend on its layout.
+    OpOperand *initOperand = producerOp.getDpsInitOperand(0);
+    auto fillOp = initOperand->get().getDefiningOp<linalg::FillOp>();
+    if (!fillOp && producerOp.payloadUsesValueFromOperand(initOperand)) {
+      return rewriter.notifyMatchFailure(transposeOp, "result is accumulated");
+    }
+
+    FailureOr<linalg::GenericOp> genericOp =
+        getAsGenericOp(rewriter, producerOp);
+    if (failed(genericOp)) {
+      return rewriter.notifyMatchFailure(transposeOp, "not a contraction");
+    }
+
+    // Dim i of the transposed result is the dim of the result the transpose
+    // reads for it.
+    Location loc = genericOp->getLoc();
+    rewriter.setInsertionPoint(*genericOp);
+    Value init = genericOp->getDpsInitOperand(0)->get();
+    SmallVector<OpFoldResult> sizes =
+        tensor::getMixedSizes(rewriter, loc, init);
+    SmallVector<OpFoldResult> transposedSizes(sizes.size());
+    for (unsigned i = 0; i < transpose->inputMap.getNumResults(); ++i) {
+      transposedSizes[transpose->inputMap.getDimPosition(i)] = sizes[i];
+    }
+    Value transposedInit = rewriter.create<tensor::EmptyOp>(
+        loc, transposedSizes, getElementTypeOrSelf(init.getType()));
+    if (fillOp) {
+      transposedInit =
+          rewriter
+              .create<linalg::FillOp>(loc, fillOp.getDpsInputOperand(0)->get(),
+                                      transposedInit)
+              .getResult(0);
+    }
+
+    SmallVector<AffineMap> maps = genericOp->getIndexingMapsArray();
+    maps.back() = inversePermutation(transpose->inputMap).compose(maps.back());
+    auto transposedOp = rewriter.create<linalg::GenericOp>(
+        loc, transposedInit.getType(), genericOp->getInputs(),
+        transposedInit, maps, genericOp->getIteratorTypesArray());
+    rewriter.inlineRegionBefore(genericOp->getRegion(),
+                                transposedOp.getRegion(),
+                                transposedOp.getRegion().begin());
+    rewriter.replaceOp(transposeOp, transposedOp->getResults());
+    rewriter.eraseOp(*genericOp);
+    return success();
+  }
+};
+
+struct PropagateTransposesPass
+    : public PropagateTransposesBase<PropagateTransposesPass> {
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<linalg::LinalgDialect, tensor::TensorDialect>();
+  }
+
+  void runOnOperation() override {
+    RewritePatternSet patterns(&getContext());
+    patterns.add<FoldTransposeIntoConsumer, FoldTransposeIntoProducer>(
+        &getContext());
+    linalg::GenericOp::getCanonicalizationPatterns(patterns, &getContext());
+    if (failed(applyPatternsAndFoldGreedily(getOperation(),
+                                            std::move(patterns)))) {
+      return signalPassFailure();
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<Pass> createPropagateTransposesPass() {
+  return std::make_unique<PropagateTransposesPass>();
+}
+
+}  // namespace Flow
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
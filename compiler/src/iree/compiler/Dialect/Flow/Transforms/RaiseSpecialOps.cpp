@@ -11,8 +11,11 @@
 #include "iree-dialects/Transforms/TransformMatchers.h"
 #include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
 #include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/Dialect/Tensor/Utils/Utils.h"
+#include "mlir/IR/Matchers.h"
 #include "mlir/IR/PatternMatch.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
@@ -27,7 +30,203 @@ namespace Flow {
 
 namespace {
 
+//===----------------------------------------------------------------------===//
+// Attention
+//===----------------------------------------------------------------------===//
+
+// Returns true if |value| is a tensor filled with zeros.
+static bool isZeroFill(Value value) {
+  auto fillOp = value.getDefiningOp<linalg::FillOp>();
+  return fillOp &&
+         matchPattern(fillOp.getDpsInputOperand(0)->get(), m_AnyZeroFloat());
+}
+
+// Returns the source of |value| if it only swaps the two inner dimensions of a
+// rank-3 tensor, either as a linalg.transpose or as the equivalent generic.
+static Value getInnerTransposeSource(Value value) {
+  if (auto transposeOp = value.getDefiningOp<linalg::TransposeOp>()) {
+    if (!llvm::equal(transposeOp.getPermutation(),
+                     ArrayRef<int64_t>{0, 2, 1})) {
+      return nullptr;
+    }
+    return transposeOp.getInput();
+  }
+  auto genericOp = value.getDefiningOp<linalg::GenericOp>();
+  if (!genericOp || genericOp.getNumDpsInputs() != 1 ||
+      genericOp.getNumDpsInits() != 1 || genericOp.getNumLoops() != 3 ||
+      genericOp.getNumParallelLoops() != 3) {
+    return nullptr;
+  }
+  Block *body = genericOp.getBlock();
+  auto yieldOp = cast<linalg::YieldOp>(body->getTerminator());
+  if (!llvm::hasSingleElement(*body) ||
+      yieldOp.getOperand(0) != body->getArgument(0)) {
+    return nullptr;
+  }
+  MLIRContext *context = genericOp.getContext();
+  AffineExpr d0, d1, d2;
+  bindDims(context, d0, d1, d2);
+  SmallVector<AffineMap> maps = genericOp.getIndexingMapsArray();
+  if (maps[0] != AffineMap::get(3, 0, {d0, d2, d1}, context) ||
+      !maps[1].isIdentity()) {
+    return nullptr;
+  }
+  return genericOp.getDpsInputOperand(0)->get();
+}
+
+// Scaling of the attention scores by a constant, as in the division by the
+// square root of the head dimension.
+struct ScoreScale {
+  Value source;
+  Value factor;
+  bool isDivision = false;
+};
+
+// Matches |value| computed as an elementwise multiplication or division of a
+// tensor by a scalar constant.
+static Optional<ScoreScale> matchScoreScale(Value value) {
+  auto genericOp = value.getDefiningOp<linalg::GenericOp>();
+  if (!genericOp || genericOp.getNumDpsInputs() != 1 ||
+      genericOp.getNumDpsInits() != 1 ||
+      genericOp.getNumLoops() != genericOp.getNumParallelLoops() ||
+      !llvm::all_of(genericOp.getIndexingMapsArray(),
+                    [](AffineMap map) { return map.isIdentity(); })) {
+    return std::nullopt;
+  }
+  Block *body = genericOp.getBlock();
+  if (body->getOperations().size() != 2) return std::nullopt;
+  Operation *scaleOp = &body->front();
+  if (!isa<arith::MulFOp, arith::DivFOp>(scaleOp) ||
+      body->getTerminator()->getOperand(0) != scaleOp->getResult(0)) {
+    return std::nullopt;
+  }
+  ScoreScale scale;
+  scale.source = genericOp.getDpsInputOperand(0)->get();
+  scale.isDivision = isa<arith::DivFOp>(scaleOp);
+  Value lhs = scaleOp->getOperand(0);
+  Value rhs = scaleOp->getOperand(1);
+  if (lhs == body->getArgument(0)) {
+    scale.factor = rhs;
+  } else if (!scale.isDivision && rhs == body->getArgument(0)) {
+    scale.factor = lhs;
+  } else {
+    return std::nullopt;
+  }
+  if (!matchPattern(scale.factor, m_Constant())) return std::nullopt;
+  return scale;
+}
+
+// Operands of a matmul-softmax-matmul chain computing
+// batch_matmul(softmax(batch_matmul(Q, transpose(K)) [* or / s]), V).
+struct AttentionChain {
+  Value query;
+  Value key;
+  Value value;
+  Value output;
+  Optional<ScoreScale> scale;
+  // Ops computing the scores and their softmax, starting at the softmax.
+  SmallVector<Operation *> intermediateOps;
+};
+
+// Matches the attention chain ending in |svOp|. Only chains the
+// iree_linalg_ext.attention op can represent are matched: all of Q, K, V and
+// the result have the same static BxNxd type, both contractions accumulate into
+// zeros and the intermediates are not used elsewhere.
+static Optional<AttentionChain> matchAttentionChain(
+    linalg::BatchMatmulOp svOp) {
+  auto softmaxOp =
+      svOp.getDpsInputOperand(0)->get().getDefiningOp<LinalgExt::SoftmaxOp>();
+  if (!softmaxOp || softmaxOp.getDimension() != 2 ||
+      !softmaxOp->hasOneUse() ||
+      !isZeroFill(svOp.getDpsInitOperand(0)->get())) {
+    return std::nullopt;
+  }
+  AttentionChain chain;
+  chain.intermediateOps.push_back(softmaxOp);
+  Value scores = softmaxOp.input();
+  chain.scale = matchScoreScale(scores);
+  if (chain.scale) {
+    if (!scores.hasOneUse()) return std::nullopt;
+    chain.intermediateOps.push_back(scores.getDefiningOp());
+    scores = chain.scale->source;
+  }
+  auto qkOp = scores.getDefiningOp<linalg::BatchMatmulOp>();
+  if (!qkOp || !scores.hasOneUse() ||
+      !isZeroFill(qkOp.getDpsInitOperand(0)->get())) {
+    return std::nullopt;
+  }
+  Value transposedKey = qkOp.getDpsInputOperand(1)->get();
+  chain.query = qkOp.getDpsInputOperand(0)->get();
+  chain.key = getInnerTransposeSource(transposedKey);
+  chain.value = svOp.getDpsInputOperand(1)->get();
+  chain.output = svOp.getDpsInitOperand(0)->get();
+  if (!chain.key || !transposedKey.hasOneUse()) return std::nullopt;
+  chain.intermediateOps.push_back(qkOp);
+  chain.intermediateOps.push_back(transposedKey.getDefiningOp());
+  // The tiling of the attention op only handles static key shapes.
+  auto queryType = chain.query.getType().cast<ShapedType>();
+  if (!queryType.hasStaticShape() ||
+      !queryType.getElementType().isa<FloatType>() ||
+      chain.key.getType() != queryType || chain.value.getType() != queryType ||
+      svOp->getResult(0).getType() != queryType) {
+    return std::nullopt;
+  }
+  return chain;
+}
+
+// Replaces |svOp| and the intermediates of |chain| with an attention op. A
+// scaling of the scores is applied to the query instead as
+// softmax((Q * s) K^T) is softmax(s * Q K^T).
+static void raiseAttentionChain(IRRewriter &rewriter,
+                                linalg::BatchMatmulOp svOp,
+                                const AttentionChain &chain) {
+  Location loc = svOp.getLoc();
+  rewriter.setInsertionPoint(svOp);
+  Value query = chain.query;
+  if (chain.scale) {
+    auto queryType = query.getType().cast<ShapedType>();
+    Value empty = rewriter.create<tensor::EmptyOp>(
+        loc, tensor::createDimValues(rewriter, loc, query),
+        queryType.getElementType());
+    AffineMap identityMap =
+        rewriter.getMultiDimIdentityMap(queryType.getRank());
+    SmallVector<utils::IteratorType> iteratorTypes(
+        queryType.getRank(), utils::IteratorType::parallel);
+    query = rewriter
+                .create<linalg::GenericOp>(
+                    loc, queryType, query, empty,
+                    ArrayRef<AffineMap>{identityMap, identityMap},
+                    iteratorTypes,
+                    [&](OpBuilder &b, Location loc, ValueRange args) {
+                      Value result =
+                          chain.scale->isDivision
+                              ? b.create<arith::DivFOp>(loc, args[0],
+                                                        chain.scale->factor)
+                                    .getResult()
+                              : b.create<arith::MulFOp>(loc, args[0],
+                                                        chain.scale->factor)
+                                    .getResult();
+                      b.create<linalg::YieldOp>(loc, result);
+                    })
+                .getResult(0);
+  }
+  rewriter.replaceOpWithNewOp<LinalgExt::AttentionOp>(
+      svOp, TypeRange{svOp->getResult(0).getType()},
+      ValueRange{query, chain.key, chain.value}, ValueRange{chain.output});
+  for (Operation *op : chain.intermediateOps) rewriter.eraseOp(op);
+}
+
+//===----------------------------------------------------------------------===//
+// Pass
+//===----------------------------------------------------------------------===//
+
 struct RaiseSpecialOpsPass : public RaiseSpecialOpsBase<RaiseSpecialOpsPass> {
+  RaiseSpecialOpsPass(bool raiseAttention) {
+    this->raiseAttention = raiseAttention;
+  }
+  RaiseSpecialOpsPass(const RaiseSpecialOpsPass &pass)
+      : RaiseSpecialOpsPass(pass.raiseAttention) {}
+
   void getDependentDialects(DialectRegistry &registry) const override {
     registry.insert<IREE::LinalgExt::IREELinalgExtDialect>();
   }
@@ -54,13 +253,26 @@ struct RaiseSpecialOpsPass : public RaiseSpecialOpsBase<RaiseSpecialOpsPass> {
       rewriter.replaceOpWithNewOp<IREE::LinalgExt::SoftmaxOp>(
           op, src, op.getDpsInitOperand(0)->get(), op.getNumLoops() - 1);
     }
+
+    // Attention chains are raised once their softmax has been. Chains are
+    // matched one at a time as raising one may feed the next.
+    if (!raiseAttention) return;
+    SmallVector<linalg::BatchMatmulOp> svOps;
+    getOperation()->walk(
+        [&](linalg::BatchMatmulOp op) { svOps.push_back(op); });
+    IRRewriter rewriter(&getContext());
+    for (linalg::BatchMatmulOp op : svOps) {
+      if (Optional<AttentionChain> chain = matchAttentionChain(op)) {
+        raiseAttentionChain(rewriter, op, *chain);
+      }
+    }
   }
 };
 
 }  // namespace
 
-std::unique_ptr<Pass> createRaiseSpecialOps() {
-  return std::make_unique<RaiseSpecialOpsPass>();
+std::unique_ptr<Pass> createRaiseSpecialOps(bool raiseAttention) {
+  return std::make_unique<RaiseSpecialOpsPass>(raiseAttention);
 }
 
 }  // namespace Flow
@@ -163,6 +163,21 @@ struct SetMatmulEncoding : public OpRewritePattern<linalg::MatmulOp> {
       lhsEncoding = TensorEncoding::MATMUL_I8I8I32_LHS;
       rhsEncoding = TensorEncoding::MATMUL_I8I8I32_RHS_TRANSPOSE;
       outEncoding = TensorEncoding::MATMUL_I8I8I32_RESULT;
+    } else if (lhsElemType.isF16() && rhsElemType.isF16() &&
+               outElemType.isF32()) {
+      lhsEncoding = TensorEncoding::MATMUL_F16F16F32_LHS;
+      rhsEncoding = TensorEncoding::MATMUL_F16F16F32_RHS_TRANSPOSE;
+      outEncoding = TensorEncoding::MATMUL_F16F16F32_RESULT;
+    } else if (lhsElemType.isF16() && rhsElemType.isF16() &&
+               outElemType.isF16()) {
+      lhsEncoding = TensorEncoding::MATMUL_F16F16F16_LHS;
+      rhsEncoding = TensorEncoding::MATMUL_F16F16F16_RHS_TRANSPOSE;
+      outEncoding = TensorEncoding::MATMUL_F16F16F16_RESULT;
+    } else if (lhsElemType.isBF16() && rhsElemType.isBF16() &&
+               outElemType.isF32()) {
+      lhsEncoding = TensorEncoding::MATMUL_BF16BF16F32_LHS;
+      rhsEncoding = TensorEncoding::MATMUL_BF16BF16F32_RHS_TRANSPOSE;
+      outEncoding = TensorEncoding::MATMUL_BF16BF16F32_RESULT;
     } else {
       return rewriter.notifyMatchFailure(
           matmulOp,
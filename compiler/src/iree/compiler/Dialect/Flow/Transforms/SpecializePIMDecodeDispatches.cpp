@@ -0,0 +1,168 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
+#include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
+#include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+
+#define DEBUG_TYPE "iree-flow-specialize-pim-decode-dispatches"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Flow {
+
+namespace {
+
+// Partitioning set by GenerateMetaData on the ops offloaded to PIM.
+static const char kPIMPartitionAttr[] = "pim.partition";
+
+// Returns the index of the argument of |funcOp| providing the token count of
+// its PIM contractions: M of the projection and FFN matmuls and the query
+// count of the attention batch matmuls. Returns std::nullopt if the token
+// count is static or the contractions don't share one.
+static std::optional<unsigned> findTokenCountArgument(func::FuncOp funcOp) {
+  std::optional<unsigned> argIndex;
+  bool isAmbiguous = false;
+  funcOp.walk([&](linalg::LinalgOp op) {
+    if (!op->hasAttr(kPIMPartitionAttr)) return;
+    int64_t dim = 0;
+    if (isa<linalg::MatmulOp>(op)) {
+      dim = 0;
+    } else if (isa<linalg::BatchMatmulOp>(op)) {
+      dim = 1;
+    } else {
+      return;
+    }
+    Value lhs = op.getDpsInputOperand(0)->get();
+    auto loadOp = lhs.getDefiningOp<DispatchTensorLoadOp>();
+    if (!loadOp) return;
+    SmallVector<OpFoldResult> sizes = loadOp.getMixedSizes();
+    if (sizes.size() != static_cast<size_t>(loadOp.getType().getRank())) {
+      return;
+    }
+    auto arg = sizes[dim].dyn_cast<Value>().dyn_cast_or_null<BlockArgument>();
+    if (!arg || arg.getOwner() != &funcOp.front()) return;
+    if (argIndex && *argIndex != arg.getArgNumber()) isAmbiguous = true;
+    argIndex = arg.getArgNumber();
+  });
+  if (isAmbiguous) return std::nullopt;
+  return argIndex;
+}
+
+// Returns the function implementing the only export of |executableOp|.
+static func::FuncOp getEntryFunction(ExecutableOp executableOp) {
+  auto exportOps = executableOp.getBlock().getOps<ExecutableExportOp>();
+  if (!llvm::hasSingleElement(exportOps)) return {};
+  return executableOp.getInnerModule().lookupSymbol<func::FuncOp>(
+      (*exportOps.begin()).getFunctionRef());
+}
+
+class SpecializePIMDecodeDispatchesPass
+    : public SpecializePIMDecodeDispatchesBase<
+          SpecializePIMDecodeDispatchesPass> {
+ public:
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<arith::ArithDialect, scf::SCFDialect>();
+  }
+
+  void runOnOperation() override {
+    auto moduleOp = getOperation();
+    MLIRContext *context = &getContext();
+    SymbolTable symbolTable(moduleOp);
+
+    RewritePatternSet patterns(context);
+    for (auto *dialect : context->getLoadedDialects()) {
+      dialect->getCanonicalizationPatterns(patterns);
+    }
+    for (RegisteredOperationName op : context->getRegisteredOperations()) {
+      op.getCanonicalizationPatterns(patterns, context);
+    }
+    FrozenRewritePatternSet frozenPatterns(std::move(patterns));
+
+    for (auto executableOp : llvm::to_vector(moduleOp.getOps<ExecutableOp>())) {
+      func::FuncOp funcOp = getEntryFunction(executableOp);
+      if (!funcOp) continue;
+      std::optional<unsigned> argIndex = findTokenCountArgument(funcOp);
+      if (!argIndex) continue;
+
+      // The decode variant processes a single token: fold the token count to
+      // 1 so that the instructions and their tiling are fully static.
+      auto decodeOp = cast<ExecutableOp>(executableOp->clone());
+      decodeOp.setName((executableOp.getName() + "_decode").str());
+      symbolTable.insert(decodeOp, std::next(Block::iterator(executableOp)));
+      func::FuncOp decodeFuncOp = getEntryFunction(decodeOp);
+      auto builder = OpBuilder::atBlockBegin(&decodeFuncOp.front());
+      Value one =
+          builder.create<arith::ConstantIndexOp>(decodeFuncOp.getLoc(), 1);
+      decodeFuncOp.getArgument(*argIndex).replaceAllUsesWith(one);
+      if (failed(applyPatternsAndFoldGreedily(decodeFuncOp, frozenPatterns))) {
+        decodeOp.emitError("failed to specialize the decode variant");
+        return signalPassFailure();
+      }
+      LLVM_DEBUG(llvm::dbgs() << "Specialized " << decodeOp.getName()
+                              << " for a single token\n");
+
+      // Dispatch the decode variant when a single token is processed and the
+      // original (prefill) executable otherwise.
+      auto exportOp = *decodeOp.getBlock().getOps<ExecutableExportOp>().begin();
+      auto decodeEntryPoint =
+          SymbolRefAttr::get(decodeOp.getNameAttr(),
+                             {FlatSymbolRefAttr::get(exportOp.getNameAttr())});
+      SmallVector<DispatchOp> dispatchOps;
+      for (auto funcLikeOp : moduleOp.getOps<FunctionOpInterface>()) {
+        funcLikeOp->walk([&](DispatchOp dispatchOp) {
+          if (dispatchOp.getEntryPoint().getRootReference() ==
+              executableOp.getNameAttr()) {
+            dispatchOps.push_back(dispatchOp);
+          }
+        });
+      }
+      for (auto dispatchOp : dispatchOps) {
+        Location loc = dispatchOp.getLoc();
+        OpBuilder siteBuilder(dispatchOp);
+        Value tokenCount = dispatchOp.getArguments()[*argIndex];
+        Value isDecode = siteBuilder.create<arith::CmpIOp>(
+            loc, arith::CmpIPredicate::eq, tokenCount,
+            siteBuilder.create<arith::ConstantIndexOp>(loc, 1));
+        auto ifOp = siteBuilder.create<scf::IfOp>(
+            loc, dispatchOp.getResultTypes(), isDecode,
+            /*withElseRegion=*/true);
+        auto thenBuilder = ifOp.getThenBodyBuilder();
+        auto decodeDispatchOp =
+            cast<DispatchOp>(thenBuilder.clone(*dispatchOp.getOperation()));
+        decodeDispatchOp.setEntryPointAttr(decodeEntryPoint);
+        thenBuilder.create<scf::YieldOp>(loc, decodeDispatchOp.getResults());
+        auto elseBuilder = ifOp.getElseBodyBuilder();
+        auto prefillDispatchOp = elseBuilder.clone(*dispatchOp.getOperation());
+        elseBuilder.create<scf::YieldOp>(loc, prefillDispatchOp->getResults());
+        dispatchOp.replaceAllUsesWith(ifOp.getResults());
+        dispatchOp.erase();
+      }
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<OperationPass<mlir::ModuleOp>>
+createSpecializePIMDecodeDispatchesPass() {
+  return std::make_unique<SpecializePIMDecodeDispatchesPass>();
+}
+
+}  // namespace Flow
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
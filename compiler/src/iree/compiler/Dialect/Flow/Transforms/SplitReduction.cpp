@@ -29,11 +29,53 @@ static llvm::cl::opt<int64_t> splitReductionRatio(
     "iree-flow-split-matmul-reduction", llvm::cl::desc("split ratio"),
     llvm::cl::init(1));
 
+static llvm::cl::opt<int64_t> skinnyMatmulSplitReductionRatio(
+    "iree-flow-split-skinny-matmul-reduction",
+    llvm::cl::desc(
+        "split ratio for matmuls with a small M or N dimension (such as the "
+        "GEMVs of decode steps) that do not have enough parallel work on "
+        "their own; lowered to the largest divisor of K that keeps at least "
+        "iree-flow-split-skinny-matmul-min-k elements per split"),
+    llvm::cl::init(1));
+
+static llvm::cl::opt<int64_t> skinnyMatmulSplitMinK(
+    "iree-flow-split-skinny-matmul-min-k",
+    llvm::cl::desc("minimum reduction size of each split of a skinny matmul"),
+    llvm::cl::init(128));
+
 static llvm::cl::list<int64_t> topkSplitReductionRatio(
     "iree-flow-topk-split-reduction",
     llvm::cl::desc("comma separated list of split ratios"),
     llvm::cl::CommaSeparated);
 
+// Matmuls with an M or N dimension at most this size are considered skinny.
+static constexpr int64_t kSkinnyMatmulMaxSize = 4;
+
+/// Returns the split ratio to use for the reduction of |matmulOp| if it is a
+/// skinny matmul or 0 if it should not be split.
+static int64_t getSkinnyMatmulSplitRatio(linalg::MatmulOp matmulOp) {
+  if (skinnyMatmulSplitReductionRatio <= 1) return 0;
+  auto lhsType = matmulOp.getDpsInputOperand(0)->get().getType();
+  auto rhsType = matmulOp.getDpsInputOperand(1)->get().getType();
+  auto lhsShape = lhsType.cast<ShapedType>().getShape();
+  auto rhsShape = rhsType.cast<ShapedType>().getShape();
+  int64_t sizeM = lhsShape[0], sizeK = lhsShape[1], sizeN = rhsShape[1];
+  if (ShapedType::isDynamic(sizeK)) return 0;
+  bool isSkinny = (!ShapedType::isDynamic(sizeM) &&
+                   sizeM <= kSkinnyMatmulMaxSize) ||
+                  (!ShapedType::isDynamic(sizeN) &&
+                   sizeN <= kSkinnyMatmulMaxSize);
+  if (!isSkinny) return 0;
+  // Use the largest ratio that divides K evenly and leaves enough work in each
+  // split to amortize the final reduction.
+  for (int64_t ratio = skinnyMatmulSplitReductionRatio; ratio > 1; --ratio) {
+    if (sizeK % ratio == 0 && sizeK / ratio >= skinnyMatmulSplitMinK) {
+      return ratio;
+    }
+  }
+  return 0;
+}
+
 namespace {
 /// Pattern to wrap splitReduction transformation. This also propagates
 /// attributes to allow compilation info attribute to not be lost.
@@ -83,6 +125,7 @@ struct SplitReductionPass : public SplitReductionBase<SplitReductionPass> {
 
   void runOnOperation() override {
     if (splitReductionRatio.getValue() <= 1 &&
+        skinnyMatmulSplitReductionRatio.getValue() <= 1 &&
         topkSplitReductionRatio.empty()) {
       return;
     }
@@ -93,8 +136,12 @@ struct SplitReductionPass : public SplitReductionBase<SplitReductionPass> {
         [&](linalg::LinalgOp op) -> linalg::SplitReductionOptions {
           // For matmul make the new parallel dimension first so that it looks
           // like a batch_matmul and can follow the same codegen.
-          if (isa<linalg::MatmulOp>(op))
-            return {int64_t(splitReductionRatio), 0, /*innerParallel=*/false};
+          if (auto matmulOp = dyn_cast<linalg::MatmulOp>(op.getOperation())) {
+            int64_t ratio = splitReductionRatio > 1
+                                ? int64_t(splitReductionRatio)
+                                : getSkinnyMatmulSplitRatio(matmulOp);
+            return {ratio, 0, /*innerParallel=*/false};
+          }
           // Currently disable spliting reduction for non-matmul op. This will
           // get enabled after once tests are ready.
           return {int64_t(0), 0, /*innerParallel=*/false};
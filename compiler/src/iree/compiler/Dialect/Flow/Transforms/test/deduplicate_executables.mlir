@@ -376,3 +376,50 @@ flow.executable @block_successors_ex_with_swapped_cond_br {
     }
   }
 }
+
+// -----
+
+// Layers only differ in the numbering of their dispatches and share the PIM
+// partitioning of their ops.
+
+// CHECK-LABEL: flow.executable public @pim_layer_ex_0
+flow.executable @pim_layer_ex_0 {
+  flow.executable.export @pim_layer_dispatch_0
+  builtin.module {
+    func.func @pim_layer_dispatch_0(%lhs: tensor<4x8xf32>, %rhs: tensor<8x16xf32>, %init: tensor<4x16xf32>) -> tensor<4x16xf32> {
+      %0 = linalg.matmul {pim.partition = {block = "mlp", num_device = 1 : i32, partitioning = "row-wise", sync = "gather", workload = "normal"}} ins(%lhs, %rhs : tensor<4x8xf32>, tensor<8x16xf32>) outs(%init : tensor<4x16xf32>) -> tensor<4x16xf32>
+      return %0 : tensor<4x16xf32>
+    }
+  }
+}
+// CHECK-NOT: flow.executable public @pim_layer_ex_1
+flow.executable @pim_layer_ex_1 {
+  flow.executable.export @pim_layer_dispatch_1
+  builtin.module {
+    func.func @pim_layer_dispatch_1(%lhs: tensor<4x8xf32>, %rhs: tensor<8x16xf32>, %init: tensor<4x16xf32>) -> tensor<4x16xf32> {
+      %0 = linalg.matmul {pim.partition = {block = "mlp", num_device = 1 : i32, partitioning = "row-wise", sync = "gather", workload = "normal"}} ins(%lhs, %rhs : tensor<4x8xf32>, tensor<8x16xf32>) outs(%init : tensor<4x16xf32>) -> tensor<4x16xf32>
+      return %0 : tensor<4x16xf32>
+    }
+  }
+}
+// CHECK-LABEL: flow.executable public @pim_layer_ex_2
+flow.executable @pim_layer_ex_2 {
+  flow.executable.export @pim_layer_dispatch_2
+  builtin.module {
+    func.func @pim_layer_dispatch_2(%lhs: tensor<4x8xf32>, %rhs: tensor<8x16xf32>, %init: tensor<4x16xf32>) -> tensor<4x16xf32> {
+      %0 = linalg.matmul {pim.partition = {block = "mlp", num_device = 1 : i32, partitioning = "col-wise", sync = "reduce", workload = "normal"}} ins(%lhs, %rhs : tensor<4x8xf32>, tensor<8x16xf32>) outs(%init : tensor<4x16xf32>) -> tensor<4x16xf32>
+      return %0 : tensor<4x16xf32>
+    }
+  }
+}
+// CHECK-LABEL: func.func @pim_layers
+func.func @pim_layers(%lhs: tensor<4x8xf32>, %rhs: tensor<8x16xf32>, %init: tensor<4x16xf32>) -> (tensor<4x16xf32>, tensor<4x16xf32>, tensor<4x16xf32>) {
+  %c1 = arith.constant 1 : index
+  // CHECK: flow.dispatch @pim_layer_ex_0::@pim_layer_dispatch_0
+  %0 = flow.dispatch @pim_layer_ex_0::@pim_layer_dispatch_0[%c1](%lhs, %rhs, %init) : (tensor<4x8xf32>, tensor<8x16xf32>, tensor<4x16xf32>) -> tensor<4x16xf32>
+  // CHECK: flow.dispatch @pim_layer_ex_0::@pim_layer_dispatch_0
+  %1 = flow.dispatch @pim_layer_ex_1::@pim_layer_dispatch_1[%c1](%lhs, %rhs, %init) : (tensor<4x8xf32>, tensor<8x16xf32>, tensor<4x16xf32>) -> tensor<4x16xf32>
+  // CHECK: flow.dispatch @pim_layer_ex_2::@pim_layer_dispatch_2
+  %2 = flow.dispatch @pim_layer_ex_2::@pim_layer_dispatch_2[%c1](%lhs, %rhs, %init) : (tensor<4x8xf32>, tensor<8x16xf32>, tensor<4x16xf32>) -> tensor<4x16xf32>
+  return %0, %1, %2 : tensor<4x16xf32>, tensor<4x16xf32>, tensor<4x16xf32>
+}
@@ -0,0 +1,61 @@
+// RUN: iree-opt --split-input-file --iree-flow-clone-dequantization-ops --pass-pipeline="builtin.module(func.func(iree-flow-form-dispatch-regions, iree-flow-form-dispatch-workgroups), cse, canonicalize, cse)" %s | FileCheck %s
+
+func.func @dequant_matmul(%lhs: tensor<1x768xf32>, %weights: tensor<768x3072xi8>, %scales: tensor<3072xf32>) -> tensor<1x3072xf32> {
+  %cst = arith.constant 0.000000e+00 : f32
+  %0 = tensor.empty() : tensor<768x3072xf32>
+  %dequant = linalg.generic {
+      indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>,
+                       affine_map<(d0, d1) -> (d1)>,
+                       affine_map<(d0, d1) -> (d0, d1)>],
+      iterator_types = ["parallel", "parallel"]}
+      ins(%weights, %scales : tensor<768x3072xi8>, tensor<3072xf32>)
+      outs(%0 : tensor<768x3072xf32>) {
+  ^bb0(%in: i8, %scale: f32, %out: f32):
+    %1 = arith.sitofp %in : i8 to f32
+    %2 = arith.mulf %1, %scale : f32
+    linalg.yield %2 : f32
+  } -> tensor<768x3072xf32>
+  %3 = tensor.empty() : tensor<1x3072xf32>
+  %4 = linalg.fill ins(%cst : f32) outs(%3 : tensor<1x3072xf32>) -> tensor<1x3072xf32>
+  %5 = linalg.matmul ins(%lhs, %dequant : tensor<1x768xf32>, tensor<768x3072xf32>) outs(%4 : tensor<1x3072xf32>) -> tensor<1x3072xf32>
+  return %5 : tensor<1x3072xf32>
+}
+// The weights enter the dispatch quantized and are dequantized within it.
+// CHECK-LABEL: func.func @dequant_matmul
+//       CHECK:   flow.dispatch.workgroups
+//  CHECK-SAME:       tensor<768x3072xi8>
+//       CHECK:     linalg.generic
+//  CHECK-SAME:       ins(%{{.+}}, %{{.+}} : tensor<768x3072xi8>, tensor<3072xf32>)
+//       CHECK:     linalg.matmul
+//   CHECK-NOT:   flow.dispatch.workgroups
+
+// -----
+
+func.func @dequant_returned(%lhs: tensor<1x768xf32>, %weights: tensor<768x3072xi8>, %scales: tensor<3072xf32>) -> (tensor<1x3072xf32>, tensor<768x3072xf32>) {
+  %cst = arith.constant 0.000000e+00 : f32
+  %0 = tensor.empty() : tensor<768x3072xf32>
+  %dequant = linalg.generic {
+      indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>,
+                       affine_map<(d0, d1) -> (d1)>,
+                       affine_map<(d0, d1) -> (d0, d1)>],
+      iterator_types = ["parallel", "parallel"]}
+      ins(%weights, %scales : tensor<768x3072xi8>, tensor<3072xf32>)
+      outs(%0 : tensor<768x3072xf32>) {
+  ^bb0(%in: i8, %scale: f32, %out: f32):
+    %1 = arith.sitofp %in : i8 to f32
+    %2 = arith.mulf %1, %scale : f32
+    linalg.yield %2 : f32
+  } -> tensor<768x3072xf32>
+  %3 = tensor.empty() : tensor<1x3072xf32>
+  %4 = linalg.fill ins(%cst : f32) outs(%3 : tensor<1x3072xf32>) -> tensor<1x3072xf32>
+  %5 = linalg.matmul ins(%lhs, %dequant : tensor<1x768xf32>, tensor<768x3072xf32>) outs(%4 : tensor<1x3072xf32>) -> tensor<1x3072xf32>
+  return %5, %dequant : tensor<1x3072xf32>, tensor<768x3072xf32>
+}
+// A dequantized result used outside of dispatches still gets its own.
+// CHECK-LABEL: func.func @dequant_returned
+//       CHECK:   %[[DEQUANT:.+]] = flow.dispatch.workgroups
+//       CHECK:     linalg.generic
+//       CHECK:   flow.dispatch.workgroups
+//  CHECK-SAME:       %[[DEQUANT]]
+//   CHECK-NOT:     linalg.generic
+//       CHECK:     linalg.matmul
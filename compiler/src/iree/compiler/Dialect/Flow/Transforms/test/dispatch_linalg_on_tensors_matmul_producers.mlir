@@ -0,0 +1,33 @@
+// RUN: iree-opt --split-input-file --iree-flow-fuse-elementwise-producers-into-matmul --pass-pipeline="builtin.module(func.func(iree-flow-form-dispatch-regions, iree-flow-form-dispatch-workgroups), cse, canonicalize, cse)" %s | FileCheck %s
+
+func.func @scale_shift_matmul(%lhs: tensor<128x768xf32>, %gamma: tensor<768xf32>, %beta: tensor<768xf32>, %rhs: tensor<768x3072xf32>) -> tensor<128x3072xf32> {
+  %cst = arith.constant 0.000000e+00 : f32
+  %0 = tensor.empty() : tensor<128x768xf32>
+  %normalized = linalg.generic {
+      indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>,
+                       affine_map<(d0, d1) -> (d1)>,
+                       affine_map<(d0, d1) -> (d1)>,
+                       affine_map<(d0, d1) -> (d0, d1)>],
+      iterator_types = ["parallel", "parallel"]}
+      ins(%lhs, %gamma, %beta : tensor<128x768xf32>, tensor<768xf32>, tensor<768xf32>)
+      outs(%0 : tensor<128x768xf32>) {
+  ^bb0(%in: f32, %scale: f32, %shift: f32, %out: f32):
+    %1 = arith.mulf %in, %scale : f32
+    %2 = arith.addf %1, %shift : f32
+    linalg.yield %2 : f32
+  } -> tensor<128x768xf32>
+  %3 = tensor.empty() : tensor<128x3072xf32>
+  %4 = linalg.fill ins(%cst : f32) outs(%3 : tensor<128x3072xf32>) -> tensor<128x3072xf32>
+  %5 = linalg.matmul ins(%normalized, %rhs : tensor<128x768xf32>, tensor<768x3072xf32>) outs(%4 : tensor<128x3072xf32>) -> tensor<128x3072xf32>
+  return %5 : tensor<128x3072xf32>
+}
+// The scale and shift are computed within the matmul dispatch.
+// CHECK-LABEL: func.func @scale_shift_matmul
+//       CHECK:   flow.dispatch.workgroups
+//       CHECK:     %[[NORMALIZED:.+]] = linalg.generic
+//       CHECK:       arith.mulf
+//       CHECK:       arith.addf
+//       CHECK:     linalg.matmul
+//  CHECK-SAME:       ins(%[[NORMALIZED]],
+//   CHECK-NOT:   flow.dispatch.workgroups
+
@@ -0,0 +1,182 @@
+// RUN: iree-opt --pass-pipeline="builtin.module(func.func(iree-flow-form-dispatch-regions))" --iree-flow-pim-pipeline-stages=2 %s | FileCheck %s
+// RUN: iree-opt --pass-pipeline="builtin.module(func.func(iree-flow-form-dispatch-regions))" --iree-flow-pim-pipeline-stages=100 %s | FileCheck %s --check-prefix=CAP
+
+// Two decoder layers (norm, attention, norm, MLP) placed on PIM modules. Each
+// layer gets the queue affinity of its stage and every contraction is lowered
+// unsplit for a single module. With more than 64 stages requested the stages
+// are spread over the 64 queues an affinity can address.
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+#map3 = affine_map<(d0, d1, d2) -> (d0, d1, d2)>
+
+// CHECK-LABEL: func.func @two_layers
+// CAP-LABEL: func.func @two_layers
+func.func @two_layers(%x: tensor<4x8xf32>, %w: tensor<8x8xf32>, %k: tensor<2x4x4xf32>, %v: tensor<2x4x4xf32>) -> (tensor<4x8xf32>, tensor<2x4x4xf32>, tensor<2x4x4xf32>) {
+  %cst = arith.constant 0.000000e+00 : f32
+
+  // Layer 0: every region is placed on the first module.
+  //      CHECK: flow.dispatch.region {stream.affinity = #hal.affinity.queue<[0]>}
+  //      CHECK:   math.rsqrt
+  //      CHECK: flow.dispatch.region {stream.affinity = #hal.affinity.queue<[0]>}
+  //      CHECK:   linalg.matmul {pim.partition = {num_device = 1 : i32, pipelined, workload = "normal"}}
+  //      CHECK: flow.dispatch.region {stream.affinity = #hal.affinity.queue<[0]>}
+  //      CHECK:   linalg.batch_matmul {pim.partition = {num_device = 1 : i32, pipelined, workload = "normal"}}
+  //      CHECK: flow.dispatch.region {stream.affinity = #hal.affinity.queue<[0]>}
+  //      CHECK:   math.exp
+  //      CHECK: flow.dispatch.region {stream.affinity = #hal.affinity.queue<[0]>}
+  //      CHECK:   linalg.batch_matmul
+  //      CHECK: flow.dispatch.region {stream.affinity = #hal.affinity.queue<[0]>}
+  //      CHECK:   linalg.matmul
+  //      CHECK: flow.dispatch.region {stream.affinity = #hal.affinity.queue<[0]>}
+  //      CHECK:   math.rsqrt
+  //      CHECK: flow.dispatch.region {stream.affinity = #hal.affinity.queue<[0]>}
+  //      CHECK:   linalg.matmul
+  //      CHECK: flow.dispatch.region {stream.affinity = #hal.affinity.queue<[0]>}
+  //      CHECK:   linalg.matmul {pim.partition = {num_device = 1 : i32, pipelined, workload = "normal"}}
+  //  CAP-COUNT-9: flow.dispatch.region {stream.affinity = #hal.affinity.queue<[0]>}
+  %norm0 = flow.dispatch.region -> (tensor<4x8xf32>) {
+    %empty = tensor.empty() : tensor<4x8xf32>
+    %1 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]} ins(%x : tensor<4x8xf32>) outs(%empty : tensor<4x8xf32>) {
+    ^bb0(%in: f32, %out: f32):
+      %2 = math.rsqrt %in : f32
+      linalg.yield %2 : f32
+    } -> tensor<4x8xf32>
+    flow.return %1 : tensor<4x8xf32>
+  }
+  %qkv0 = flow.dispatch.region -> (tensor<4x8xf32>) {
+    %empty = tensor.empty() : tensor<4x8xf32>
+    %fill = linalg.fill ins(%cst : f32) outs(%empty : tensor<4x8xf32>) -> tensor<4x8xf32>
+    %1 = linalg.matmul ins(%norm0, %w : tensor<4x8xf32>, tensor<8x8xf32>) outs(%fill : tensor<4x8xf32>) -> tensor<4x8xf32>
+    flow.return %1 : tensor<4x8xf32>
+  }
+  %qk0 = flow.dispatch.region -> (tensor<2x4x4xf32>) {
+    %empty = tensor.empty() : tensor<2x4x4xf32>
+    %fill = linalg.fill ins(%cst : f32) outs(%empty : tensor<2x4x4xf32>) -> tensor<2x4x4xf32>
+    %1 = linalg.batch_matmul ins(%k, %v : tensor<2x4x4xf32>, tensor<2x4x4xf32>) outs(%fill : tensor<2x4x4xf32>) -> tensor<2x4x4xf32>
+    flow.return %1 : tensor<2x4x4xf32>
+  }
+  %softmax0 = flow.dispatch.region -> (tensor<2x4x4xf32>) {
+    %empty = tensor.empty() : tensor<2x4x4xf32>
+    %1 = linalg.generic {indexing_maps = [#map3, #map3], iterator_types = ["parallel", "parallel", "parallel"]} ins(%qk0 : tensor<2x4x4xf32>) outs(%empty : tensor<2x4x4xf32>) {
+    ^bb0(%in: f32, %out: f32):
+      %2 = math.exp %in : f32
+      linalg.yield %2 : f32
+    } -> tensor<2x4x4xf32>
+    flow.return %1 : tensor<2x4x4xf32>
+  }
+  %sv0 = flow.dispatch.region -> (tensor<2x4x4xf32>) {
+    %empty = tensor.empty() : tensor<2x4x4xf32>
+    %fill = linalg.fill ins(%cst : f32) outs(%empty : tensor<2x4x4xf32>) -> tensor<2x4x4xf32>
+    %1 = linalg.batch_matmul ins(%softmax0, %v : tensor<2x4x4xf32>, tensor<2x4x4xf32>) outs(%fill : tensor<2x4x4xf32>) -> tensor<2x4x4xf32>
+    flow.return %1 : tensor<2x4x4xf32>
+  }
+  %proj0 = flow.dispatch.region -> (tensor<4x8xf32>) {
+    %empty = tensor.empty() : tensor<4x8xf32>
+    %fill = linalg.fill ins(%cst : f32) outs(%empty : tensor<4x8xf32>) -> tensor<4x8xf32>
+    %1 = linalg.matmul ins(%qkv0, %w : tensor<4x8xf32>, tensor<8x8xf32>) outs(%fill : tensor<4x8xf32>) -> tensor<4x8xf32>
+    flow.return %1 : tensor<4x8xf32>
+  }
+  %norm1 = flow.dispatch.region -> (tensor<4x8xf32>) {
+    %empty = tensor.empty() : tensor<4x8xf32>
+    %1 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]} ins(%proj0 : tensor<4x8xf32>) outs(%empty : tensor<4x8xf32>) {
+    ^bb0(%in: f32, %out: f32):
+      %2 = math.rsqrt %in : f32
+      linalg.yield %2 : f32
+    } -> tensor<4x8xf32>
+    flow.return %1 : tensor<4x8xf32>
+  }
+  %up0 = flow.dispatch.region -> (tensor<4x8xf32>) {
+    %empty = tensor.empty() : tensor<4x8xf32>
+    %fill = linalg.fill ins(%cst : f32) outs(%empty : tensor<4x8xf32>) -> tensor<4x8xf32>
+    %1 = linalg.matmul ins(%norm1, %w : tensor<4x8xf32>, tensor<8x8xf32>) outs(%fill : tensor<4x8xf32>) -> tensor<4x8xf32>
+    flow.return %1 : tensor<4x8xf32>
+  }
+  %down0 = flow.dispatch.region -> (tensor<4x8xf32>) {
+    %empty = tensor.empty() : tensor<4x8xf32>
+    %fill = linalg.fill ins(%cst : f32) outs(%empty : tensor<4x8xf32>) -> tensor<4x8xf32>
+    %1 = linalg.matmul ins(%up0, %w : tensor<4x8xf32>, tensor<8x8xf32>) outs(%fill : tensor<4x8xf32>) -> tensor<4x8xf32>
+    flow.return %1 : tensor<4x8xf32>
+  }
+
+  // Layer 1: the second module, or queue 64 * 1 / 2 with the stage count
+  // capped to 64.
+  //      CHECK: flow.dispatch.region {stream.affinity = #hal.affinity.queue<[1]>}
+  //      CHECK:   math.rsqrt
+  //      CHECK: flow.dispatch.region {stream.affinity = #hal.affinity.queue<[1]>}
+  //      CHECK:   linalg.matmul {pim.partition = {num_device = 1 : i32, pipelined, workload = "normal"}}
+  //      CHECK: flow.dispatch.region {stream.affinity = #hal.affinity.queue<[1]>}
+  //      CHECK: flow.dispatch.region {stream.affinity = #hal.affinity.queue<[1]>}
+  //      CHECK: flow.dispatch.region {stream.affinity = #hal.affinity.queue<[1]>}
+  //      CHECK: flow.dispatch.region {stream.affinity = #hal.affinity.queue<[1]>}
+  //      CHECK: flow.dispatch.region {stream.affinity = #hal.affinity.queue<[1]>}
+  //      CHECK: flow.dispatch.region {stream.affinity = #hal.affinity.queue<[1]>}
+  //      CHECK: flow.dispatch.region {stream.affinity = #hal.affinity.queue<[1]>}
+  //      CHECK:   linalg.matmul {pim.partition = {num_device = 1 : i32, pipelined, workload = "normal"}}
+  //      CHECK: return
+  //  CAP-COUNT-9: flow.dispatch.region {stream.affinity = #hal.affinity.queue<[32]>}
+  //      CAP: return
+  %norm2 = flow.dispatch.region -> (tensor<4x8xf32>) {
+    %empty = tensor.empty() : tensor<4x8xf32>
+    %1 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]} ins(%down0 : tensor<4x8xf32>) outs(%empty : tensor<4x8xf32>) {
+    ^bb0(%in: f32, %out: f32):
+      %2 = math.rsqrt %in : f32
+      linalg.yield %2 : f32
+    } -> tensor<4x8xf32>
+    flow.return %1 : tensor<4x8xf32>
+  }
+  %qkv1 = flow.dispatch.region -> (tensor<4x8xf32>) {
+    %empty = tensor.empty() : tensor<4x8xf32>
+    %fill = linalg.fill ins(%cst : f32) outs(%empty : tensor<4x8xf32>) -> tensor<4x8xf32>
+    %1 = linalg.matmul ins(%norm2, %w : tensor<4x8xf32>, tensor<8x8xf32>) outs(%fill : tensor<4x8xf32>) -> tensor<4x8xf32>
+    flow.return %1 : tensor<4x8xf32>
+  }
+  %qk1 = flow.dispatch.region -> (tensor<2x4x4xf32>) {
+    %empty = tensor.empty() : tensor<2x4x4xf32>
+    %fill = linalg.fill ins(%cst : f32) outs(%empty : tensor<2x4x4xf32>) -> tensor<2x4x4xf32>
+    %1 = linalg.batch_matmul ins(%k, %v : tensor<2x4x4xf32>, tensor<2x4x4xf32>) outs(%fill : tensor<2x4x4xf32>) -> tensor<2x4x4xf32>
+    flow.return %1 : tensor<2x4x4xf32>
+  }
+  %softmax1 = flow.dispatch.region -> (tensor<2x4x4xf32>) {
+    %empty = tensor.empty() : tensor<2x4x4xf32>
+    %1 = linalg.generic {indexing_maps = [#map3, #map3], iterator_types = ["parallel", "parallel", "parallel"]} ins(%qk1 : tensor<2x4x4xf32>) outs(%empty : tensor<2x4x4xf32>) {
+    ^bb0(%in: f32, %out: f32):
+      %2 = math.exp %in : f32
+      linalg.yield %2 : f32
+    } -> tensor<2x4x4xf32>
+    flow.return %1 : tensor<2x4x4xf32>
+  }
+  %sv1 = flow.dispatch.region -> (tensor<2x4x4xf32>) {
+    %empty = tensor.empty() : tensor<2x4x4xf32>
+    %fill = linalg.fill ins(%cst : f32) outs(%empty : tensor<2x4x4xf32>) -> tensor<2x4x4xf32>
+    %1 = linalg.batch_matmul ins(%softmax1, %v : tensor<2x4x4xf32>, tensor<2x4x4xf32>) outs(%fill : tensor<2x4x4xf32>) -> tensor<2x4x4xf32>
+    flow.return %1 : tensor<2x4x4xf32>
+  }
+  %proj1 = flow.dispatch.region -> (tensor<4x8xf32>) {
+    %empty = tensor.empty() : tensor<4x8xf32>
+    %fill = linalg.fill ins(%cst : f32) outs(%empty : tensor<4x8xf32>) -> tensor<4x8xf32>
+    %1 = linalg.matmul ins(%qkv1, %w : tensor<4x8xf32>, tensor<8x8xf32>) outs(%fill : tensor<4x8xf32>) -> tensor<4x8xf32>
+    flow.return %1 : tensor<4x8xf32>
+  }
+  %norm3 = flow.dispatch.region -> (tensor<4x8xf32>) {
+    %empty = tensor.empty() : tensor<4x8xf32>
+    %1 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]} ins(%proj1 : tensor<4x8xf32>) outs(%empty : tensor<4x8xf32>) {
+    ^bb0(%in: f32, %out: f32):
+      %2 = math.rsqrt %in : f32
+      linalg.yield %2 : f32
+    } -> tensor<4x8xf32>
+    flow.return %1 : tensor<4x8xf32>
+  }
+  %up1 = flow.dispatch.region -> (tensor<4x8xf32>) {
+    %empty = tensor.empty() : tensor<4x8xf32>
+    %fill = linalg.fill ins(%cst : f32) outs(%empty : tensor<4x8xf32>) -> tensor<4x8xf32>
+    %1 = linalg.matmul ins(%norm3, %w : tensor<4x8xf32>, tensor<8x8xf32>) outs(%fill : tensor<4x8xf32>) -> tensor<4x8xf32>
+    flow.return %1 : tensor<4x8xf32>
+  }
+  %down1 = flow.dispatch.region -> (tensor<4x8xf32>) {
+    %empty = tensor.empty() : tensor<4x8xf32>
+    %fill = linalg.fill ins(%cst : f32) outs(%empty : tensor<4x8xf32>) -> tensor<4x8xf32>
+    %1 = linalg.matmul ins(%up1, %w : tensor<4x8xf32>, tensor<8x8xf32>) outs(%fill : tensor<4x8xf32>) -> tensor<4x8xf32>
+    flow.return %1 : tensor<4x8xf32>
+  }
+  return %down1, %sv0, %sv1 : tensor<4x8xf32>, tensor<2x4x4xf32>, tensor<2x4x4xf32>
+}
@@ -0,0 +1,107 @@
+// RUN: iree-opt --split-input-file --iree-flow-propagate-transposes --canonicalize -cse %s | FileCheck %s
+
+func.func @batch_matmul_transposed_rhs(%q: tensor<12x128x64xf32>, %k: tensor<12x128x64xf32>) -> tensor<12x128x128xf32> {
+  %cst = arith.constant 0.000000e+00 : f32
+  %kt_init = tensor.empty() : tensor<12x64x128xf32>
+  %kt = linalg.transpose ins(%k : tensor<12x128x64xf32>) outs(%kt_init : tensor<12x64x128xf32>) permutation = [0, 2, 1]
+  %init = tensor.empty() : tensor<12x128x128xf32>
+  %fill = linalg.fill ins(%cst : f32) outs(%init : tensor<12x128x128xf32>) -> tensor<12x128x128xf32>
+  %qk = linalg.batch_matmul ins(%q, %kt : tensor<12x128x64xf32>, tensor<12x64x128xf32>) outs(%fill : tensor<12x128x128xf32>) -> tensor<12x128x128xf32>
+  return %qk : tensor<12x128x128xf32>
+}
+
+// Check that the batch matmul reads K directly instead of its transpose.
+
+//  CHECK-DAG: #[[$MAP0:.+]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d3)>
+//  CHECK-DAG: #[[$MAP1:.+]] = affine_map<(d0, d1, d2, d3) -> (d0, d2, d3)>
+//  CHECK-DAG: #[[$MAP2:.+]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2)>
+// CHECK-LABEL: func.func @batch_matmul_transposed_rhs
+// CHECK-SAME:     %[[Q:[a-zA-Z0-9]+]]: tensor<12x128x64xf32>
+// CHECK-SAME:     %[[K:[a-zA-Z0-9]+]]: tensor<12x128x64xf32>
+//  CHECK-NOT:   linalg.transpose
+//      CHECK:   %[[FILL:.+]] = linalg.fill
+//      CHECK:   %[[QK:.+]] = linalg.generic
+// CHECK-SAME:     indexing_maps = [#[[$MAP0]], #[[$MAP1]], #[[$MAP2]]]
+// CHECK-SAME:     ins(%[[Q]], %[[K]] :
+// CHECK-SAME:     outs(%[[FILL]] :
+//      CHECK:   return %[[QK]]
+
+// -----
+
+func.func @transposed_elementwise_operand(%a: tensor<64x128xf32>, %b: tensor<128x64xf32>) -> tensor<128x64xf32> {
+  %at_init = tensor.empty() : tensor<128x64xf32>
+  %at = linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d1, d0)>, affine_map<(d0, d1) -> (d0, d1)>], iterator_types = ["parallel", "parallel"]} ins(%a : tensor<64x128xf32>) outs(%at_init : tensor<128x64xf32>) {
+  ^bb0(%arg0: f32, %arg1: f32):
+    linalg.yield %arg0 : f32
+  } -> tensor<128x64xf32>
+  %init = tensor.empty() : tensor<128x64xf32>
+  %add = linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (d0, d1)>], iterator_types = ["parallel", "parallel"]} ins(%at, %b : tensor<128x64xf32>, tensor<128x64xf32>) outs(%init : tensor<128x64xf32>) {
+  ^bb0(%arg0: f32, %arg1: f32, %arg2: f32):
+    %0 = arith.addf %arg0, %arg1 : f32
+    linalg.yield %0 : f32
+  } -> tensor<128x64xf32>
+  return %add : tensor<128x64xf32>
+}
+
+// Check that the transpose is read through the indexing map of the add.
+
+//  CHECK-DAG: #[[$MAP0:.+]] = affine_map<(d0, d1) -> (d1, d0)>
+//  CHECK-DAG: #[[$MAP1:.+]] = affine_map<(d0, d1) -> (d0, d1)>
+// CHECK-LABEL: func.func @transposed_elementwise_operand
+// CHECK-SAME:     %[[A:[a-zA-Z0-9]+]]: tensor<64x128xf32>
+// CHECK-SAME:     %[[B:[a-zA-Z0-9]+]]: tensor<128x64xf32>
+//      CHECK:   %[[ADD:.+]] = linalg.generic
+// CHECK-SAME:     indexing_maps = [#[[$MAP0]], #[[$MAP1]], #[[$MAP1]]]
+// CHECK-SAME:     ins(%[[A]], %[[B]] :
+//      CHECK:     arith.addf
+//  CHECK-NOT:   linalg.generic
+//      CHECK:   return %[[ADD]]
+
+// -----
+
+func.func @batch_matmul_transposed_result(%a: tensor<4x384x384xf32>, %b: tensor<4x384x32xf32>) -> tensor<384x4x32xf32> {
+  %cst = arith.constant 0.000000e+00 : f32
+  %init = tensor.empty() : tensor<4x384x32xf32>
+  %fill = linalg.fill ins(%cst : f32) outs(%init : tensor<4x384x32xf32>) -> tensor<4x384x32xf32>
+  %matmul = linalg.batch_matmul ins(%a, %b : tensor<4x384x384xf32>, tensor<4x384x32xf32>) outs(%fill : tensor<4x384x32xf32>) -> tensor<4x384x32xf32>
+  %result = tensor.empty() : tensor<384x4x32xf32>
+  %transpose = linalg.transpose ins(%matmul : tensor<4x384x32xf32>) outs(%result : tensor<384x4x32xf32>) permutation = [1, 0, 2]
+  return %transpose : tensor<384x4x32xf32>
+}
+
+// Check that the batch matmul writes its result in the transposed layout.
+
+//  CHECK-DAG: #[[$MAP0:.+]] = affine_map<(d0, d1, d2, d3) -> (d0, d1, d3)>
+//  CHECK-DAG: #[[$MAP1:.+]] = affine_map<(d0, d1, d2, d3) -> (d0, d3, d2)>
+//  CHECK-DAG: #[[$MAP2:.+]] = affine_map<(d0, d1, d2, d3) -> (d1, d0, d2)>
+// CHECK-LABEL: func.func @batch_matmul_transposed_result
+// CHECK-SAME:     %[[A:[a-zA-Z0-9]+]]: tensor<4x384x384xf32>
+// CHECK-SAME:     %[[B:[a-zA-Z0-9]+]]: tensor<4x384x32xf32>
+//      CHECK:   %[[EMPTY:.+]] = tensor.empty() : tensor<384x4x32xf32>
+//      CHECK:   %[[FILL:.+]] = linalg.fill
+// CHECK-SAME:     outs(%[[EMPTY]] :
+//      CHECK:   %[[MATMUL:.+]] = linalg.generic
+// CHECK-SAME:     indexing_maps = [#[[$MAP0]], #[[$MAP1]], #[[$MAP2]]]
+// CHECK-SAME:     ins(%[[A]], %[[B]] :
+// CHECK-SAME:     outs(%[[FILL]] : tensor<384x4x32xf32>)
+//  CHECK-NOT:   linalg.transpose
+//      CHECK:   return %[[MATMUL]]
+
+// -----
+
+func.func @accumulated_result_not_transposed(%a: tensor<4x8xf32>, %acc: tensor<4x8xf32>) -> tensor<8x4xf32> {
+  %sum = linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (d0, d1)>], iterator_types = ["parallel", "parallel"]} ins(%a : tensor<4x8xf32>) outs(%acc : tensor<4x8xf32>) {
+  ^bb0(%arg0: f32, %arg1: f32):
+    %0 = arith.addf %arg0, %arg1 : f32
+    linalg.yield %0 : f32
+  } -> tensor<4x8xf32>
+  %init = tensor.empty() : tensor<8x4xf32>
+  %transpose = linalg.transpose ins(%sum : tensor<4x8xf32>) outs(%init : tensor<8x4xf32>) permutation = [1, 0]
+  return %transpose : tensor<8x4xf32>
+}
+
+// Check that results accumulated into an arbitrary tensor keep their layout.
+
+// CHECK-LABEL: func.func @accumulated_result_not_transposed
+//      CHECK:   %[[SUM:.+]] = linalg.generic
+//      CHECK:   linalg.transpose ins(%[[SUM]] :
@@ -0,0 +1,57 @@
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(func.func(iree-flow-raise-special-ops{raise-attention=true}))" %s | FileCheck %s
+
+// CHECK-LABEL: @attention
+//  CHECK-SAME: %[[Q:[a-zA-Z0-9]+]]: tensor<12x128x64xf32>
+//  CHECK-SAME: %[[K:[a-zA-Z0-9]+]]: tensor<12x128x64xf32>
+//  CHECK-SAME: %[[V:[a-zA-Z0-9]+]]: tensor<12x128x64xf32>
+//       CHECK:   %[[SCALE:.+]] = arith.constant 8.000000e+00 : f32
+//       CHECK:   linalg.fill
+//       CHECK:   %[[FILL:.+]] = linalg.fill
+//       CHECK:   %[[SCALED_Q:.+]] = linalg.generic
+//  CHECK-SAME:       ins(%[[Q]] : tensor<12x128x64xf32>)
+//       CHECK:     arith.divf %{{.+}}, %[[SCALE]] : f32
+//       CHECK:   %[[ATTN:.+]] = iree_linalg_ext.attention
+//  CHECK-SAME:       ins(%[[SCALED_Q]], %[[K]], %[[V]] : tensor<12x128x64xf32>, tensor<12x128x64xf32>, tensor<12x128x64xf32>)
+//  CHECK-SAME:       outs(%[[FILL]] : tensor<12x128x64xf32>)
+//   CHECK-NOT:   linalg.batch_matmul
+//   CHECK-NOT:   iree_linalg_ext.softmax
+//       CHECK:   return %[[ATTN]]
+func.func @attention(%q: tensor<12x128x64xf32>, %k: tensor<12x128x64xf32>, %v: tensor<12x128x64xf32>) -> tensor<12x128x64xf32> {
+  %zero = arith.constant 0.000000e+00 : f32
+  %scale = arith.constant 8.000000e+00 : f32
+  %kt_init = tensor.empty() : tensor<12x64x128xf32>
+  %kt = linalg.transpose ins(%k : tensor<12x128x64xf32>) outs(%kt_init : tensor<12x64x128xf32>) permutation = [0, 2, 1]
+  %s_init = tensor.empty() : tensor<12x128x128xf32>
+  %s_fill = linalg.fill ins(%zero : f32) outs(%s_init : tensor<12x128x128xf32>) -> tensor<12x128x128xf32>
+  %s = linalg.batch_matmul ins(%q, %kt : tensor<12x128x64xf32>, tensor<12x64x128xf32>) outs(%s_fill : tensor<12x128x128xf32>) -> tensor<12x128x128xf32>
+  %scaled = linalg.generic {indexing_maps = [affine_map<(d0, d1, d2) -> (d0, d1, d2)>, affine_map<(d0, d1, d2) -> (d0, d1, d2)>], iterator_types = ["parallel", "parallel", "parallel"]} ins(%s : tensor<12x128x128xf32>) outs(%s_init : tensor<12x128x128xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %0 = arith.divf %in, %scale : f32
+    linalg.yield %0 : f32
+  } -> tensor<12x128x128xf32>
+  %p = iree_linalg_ext.softmax dimension(2) ins(%scaled : tensor<12x128x128xf32>) outs(%s_init : tensor<12x128x128xf32>) -> tensor<12x128x128xf32>
+  %o_init = tensor.empty() : tensor<12x128x64xf32>
+  %o_fill = linalg.fill ins(%zero : f32) outs(%o_init : tensor<12x128x64xf32>) -> tensor<12x128x64xf32>
+  %o = linalg.batch_matmul ins(%p, %v : tensor<12x128x128xf32>, tensor<12x128x64xf32>) outs(%o_fill : tensor<12x128x64xf32>) -> tensor<12x128x64xf32>
+  return %o : tensor<12x128x64xf32>
+}
+
+// -----
+
+// The scores are used elsewhere and must be materialized.
+
+// CHECK-LABEL: @scores_with_other_uses
+//   CHECK-NOT:   iree_linalg_ext.attention
+func.func @scores_with_other_uses(%q: tensor<12x128x64xf32>, %k: tensor<12x128x64xf32>, %v: tensor<12x128x64xf32>) -> (tensor<12x128x64xf32>, tensor<12x128x128xf32>) {
+  %zero = arith.constant 0.000000e+00 : f32
+  %kt_init = tensor.empty() : tensor<12x64x128xf32>
+  %kt = linalg.transpose ins(%k : tensor<12x128x64xf32>) outs(%kt_init : tensor<12x64x128xf32>) permutation = [0, 2, 1]
+  %s_init = tensor.empty() : tensor<12x128x128xf32>
+  %s_fill = linalg.fill ins(%zero : f32) outs(%s_init : tensor<12x128x128xf32>) -> tensor<12x128x128xf32>
+  %s = linalg.batch_matmul ins(%q, %kt : tensor<12x128x64xf32>, tensor<12x64x128xf32>) outs(%s_fill : tensor<12x128x128xf32>) -> tensor<12x128x128xf32>
+  %p = iree_linalg_ext.softmax dimension(2) ins(%s : tensor<12x128x128xf32>) outs(%s_init : tensor<12x128x128xf32>) -> tensor<12x128x128xf32>
+  %o_init = tensor.empty() : tensor<12x128x64xf32>
+  %o_fill = linalg.fill ins(%zero : f32) outs(%o_init : tensor<12x128x64xf32>) -> tensor<12x128x64xf32>
+  %o = linalg.batch_matmul ins(%p, %v : tensor<12x128x128xf32>, tensor<12x128x64xf32>) outs(%o_fill : tensor<12x128x64xf32>) -> tensor<12x128x64xf32>
+  return %o, %s : tensor<12x128x64xf32>, tensor<12x128x128xf32>
+}
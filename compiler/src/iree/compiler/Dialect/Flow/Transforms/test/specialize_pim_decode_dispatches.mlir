@@ -0,0 +1,68 @@
+// RUN: iree-opt --split-input-file --iree-flow-specialize-pim-decode-dispatches %s | FileCheck %s
+
+// CHECK-LABEL: flow.executable private @ffn_dispatch_0 {
+//       CHECK:   flow.dispatch.tensor.load {{.+}} -> tensor<?x768xf32>
+//       CHECK: flow.executable private @ffn_dispatch_0_decode {
+//       CHECK:   flow.executable.export public @ffn_dispatch_0
+//       CHECK:   flow.dispatch.tensor.load {{.+}} -> tensor<1x768xf32>
+flow.executable private @ffn_dispatch_0 {
+  flow.executable.export public @ffn_dispatch_0
+  builtin.module {
+    func.func @ffn_dispatch_0(%arg0: !flow.dispatch.tensor<readonly:tensor<?x768xf32>>, %arg1: !flow.dispatch.tensor<readonly:tensor<768x3072xf32>>, %arg2: index, %arg3: !flow.dispatch.tensor<writeonly:tensor<?x3072xf32>>) {
+      %cst = arith.constant 0.000000e+00 : f32
+      %0 = flow.dispatch.tie_shape %arg0 : !flow.dispatch.tensor<readonly:tensor<?x768xf32>>{%arg2}
+      %1 = flow.dispatch.tie_shape %arg3 : !flow.dispatch.tensor<writeonly:tensor<?x3072xf32>>{%arg2}
+      %2 = flow.dispatch.tensor.load %0, offsets = [0, 0], sizes = [%arg2, 768], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<?x768xf32>>{%arg2} -> tensor<?x768xf32>
+      %3 = flow.dispatch.tensor.load %arg1, offsets = [0, 0], sizes = [768, 3072], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<768x3072xf32>> -> tensor<768x3072xf32>
+      %4 = tensor.empty(%arg2) : tensor<?x3072xf32>
+      %5 = linalg.fill ins(%cst : f32) outs(%4 : tensor<?x3072xf32>) -> tensor<?x3072xf32>
+      %6 = linalg.matmul {pim.partition = {workload = "normal", num_device = 1 : i32}} ins(%2, %3 : tensor<?x768xf32>, tensor<768x3072xf32>) outs(%5 : tensor<?x3072xf32>) -> tensor<?x3072xf32>
+      flow.dispatch.tensor.store %6, %1, offsets = [0, 0], sizes = [%arg2, 3072], strides = [1, 1] : tensor<?x3072xf32> -> !flow.dispatch.tensor<writeonly:tensor<?x3072xf32>>{%arg2}
+      return
+    }
+  }
+}
+// CHECK-LABEL: func.func @ffn
+//  CHECK-SAME: %[[TOKENS:[a-z0-9]+]]: index
+func.func @ffn(%arg0: tensor<?x768xf32>, %arg1: tensor<768x3072xf32>, %arg2: index) -> tensor<?x3072xf32> {
+  //      CHECK: %[[IS_DECODE:.+]] = arith.cmpi eq, %[[TOKENS]], %{{.+}} : index
+  //      CHECK: %[[RESULT:.+]] = scf.if %[[IS_DECODE]] -> (tensor<?x3072xf32>) {
+  // CHECK-NEXT:   %[[DECODE:.+]] = flow.dispatch @ffn_dispatch_0_decode::@ffn_dispatch_0[%[[TOKENS]]]
+  // CHECK-NEXT:   scf.yield %[[DECODE]]
+  // CHECK-NEXT: } else {
+  // CHECK-NEXT:   %[[PREFILL:.+]] = flow.dispatch @ffn_dispatch_0::@ffn_dispatch_0[%[[TOKENS]]]
+  // CHECK-NEXT:   scf.yield %[[PREFILL]]
+  %0 = flow.dispatch @ffn_dispatch_0::@ffn_dispatch_0[%arg2](%arg0, %arg1, %arg2) : (tensor<?x768xf32>{%arg2}, tensor<768x3072xf32>, index) -> tensor<?x3072xf32>{%arg2}
+  // CHECK: return %[[RESULT]]
+  return %0 : tensor<?x3072xf32>
+}
+
+// -----
+
+// Dispatches with a static token count or without PIM ops are left as-is.
+
+// CHECK-LABEL: flow.executable private @static_dispatch_0
+//   CHECK-NOT: flow.executable private @static_dispatch_0_decode
+flow.executable private @static_dispatch_0 {
+  flow.executable.export public @static_dispatch_0
+  builtin.module {
+    func.func @static_dispatch_0(%arg0: !flow.dispatch.tensor<readonly:tensor<4x768xf32>>, %arg1: !flow.dispatch.tensor<readonly:tensor<768x3072xf32>>, %arg2: !flow.dispatch.tensor<writeonly:tensor<4x3072xf32>>) {
+      %cst = arith.constant 0.000000e+00 : f32
+      %0 = flow.dispatch.tensor.load %arg0, offsets = [0, 0], sizes = [4, 768], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<4x768xf32>> -> tensor<4x768xf32>
+      %1 = flow.dispatch.tensor.load %arg1, offsets = [0, 0], sizes = [768, 3072], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<768x3072xf32>> -> tensor<768x3072xf32>
+      %2 = tensor.empty() : tensor<4x3072xf32>
+      %3 = linalg.fill ins(%cst : f32) outs(%2 : tensor<4x3072xf32>) -> tensor<4x3072xf32>
+      %4 = linalg.matmul {pim.partition = {workload = "normal", num_device = 1 : i32}} ins(%0, %1 : tensor<4x768xf32>, tensor<768x3072xf32>) outs(%3 : tensor<4x3072xf32>) -> tensor<4x3072xf32>
+      flow.dispatch.tensor.store %4, %arg2, offsets = [0, 0], sizes = [4, 3072], strides = [1, 1] : tensor<4x3072xf32> -> !flow.dispatch.tensor<writeonly:tensor<4x3072xf32>>
+      return
+    }
+  }
+}
+// CHECK-LABEL: func.func @static
+//   CHECK-NOT: scf.if
+//       CHECK: flow.dispatch @static_dispatch_0::@static_dispatch_0
+func.func @static(%arg0: tensor<4x768xf32>, %arg1: tensor<768x3072xf32>) -> tensor<4x3072xf32> {
+  %c4 = arith.constant 4 : index
+  %0 = flow.dispatch @static_dispatch_0::@static_dispatch_0[%c4](%arg0, %arg1) : (tensor<4x768xf32>, tensor<768x3072xf32>) -> tensor<4x3072xf32>
+  return %0 : tensor<4x3072xf32>
+}
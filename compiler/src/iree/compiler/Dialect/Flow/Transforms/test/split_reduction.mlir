@@ -0,0 +1,28 @@
+// RUN: iree-opt --split-input-file --iree-flow-split-reduction-ops --iree-flow-split-skinny-matmul-reduction=8 %s | FileCheck %s
+
+func.func @skinny_matmul(%lhs: tensor<1x768xf32>, %rhs: tensor<768x3072xf32>, %init: tensor<1x3072xf32>) -> tensor<1x3072xf32> {
+  %0 = linalg.matmul ins(%lhs, %rhs : tensor<1x768xf32>, tensor<768x3072xf32>)
+                     outs(%init : tensor<1x3072xf32>) -> tensor<1x3072xf32>
+  return %0 : tensor<1x3072xf32>
+}
+// 768 is not split 8 ways as each split would reduce fewer than 128 elements.
+// CHECK-LABEL: func.func @skinny_matmul
+//   CHECK-DAG:   tensor.expand_shape %{{.+}} {{\[}}[0], [1, 2]] : tensor<1x768xf32> into tensor<1x6x128xf32>
+//   CHECK-DAG:   tensor.expand_shape %{{.+}} {{\[}}[0, 1], [2]] : tensor<768x3072xf32> into tensor<6x128x3072xf32>
+//       CHECK:   %[[SPLIT:.+]] = linalg.generic
+//  CHECK-SAME:       iterator_types = ["parallel", "parallel", "parallel", "reduction"]
+//  CHECK-SAME:       -> tensor<6x1x3072xf32>
+//       CHECK:   linalg.generic
+//  CHECK-SAME:       ins(%[[SPLIT]] : tensor<6x1x3072xf32>)
+//  CHECK-SAME:       -> tensor<1x3072xf32>
+
+// -----
+
+func.func @square_matmul(%lhs: tensor<64x768xf32>, %rhs: tensor<768x3072xf32>, %init: tensor<64x3072xf32>) -> tensor<64x3072xf32> {
+  %0 = linalg.matmul ins(%lhs, %rhs : tensor<64x768xf32>, tensor<768x3072xf32>)
+                     outs(%init : tensor<64x3072xf32>) -> tensor<64x3072xf32>
+  return %0 : tensor<64x3072xf32>
+}
+// CHECK-LABEL: func.func @square_matmul
+//   CHECK-NOT:   tensor.expand_shape
+//       CHECK:   linalg.matmul
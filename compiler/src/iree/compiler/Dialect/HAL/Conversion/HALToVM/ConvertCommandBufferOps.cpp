@@ -4,6 +4,8 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <algorithm>
+
 #include "iree/compiler/Dialect/HAL/IR/HALOps.h"
 #include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
 #include "iree/compiler/Dialect/VM/Conversion/ImportUtils.h"
@@ -298,6 +300,84 @@ class CommandBufferPushDescriptorSetOpConversion
   mutable IREE::VM::ImportOp importOp;
 };
 
+class CommandBufferExecuteCommandsInlineOpConversion
+    : public OpConversionPattern<
+          IREE::HAL::CommandBufferExecuteCommandsInlineOp> {
+ public:
+  CommandBufferExecuteCommandsInlineOpConversion(MLIRContext *context,
+                                                 SymbolTable &importSymbols,
+                                                 TypeConverter &typeConverter,
+                                                 StringRef importName)
+      : OpConversionPattern(context) {
+    importOp = importSymbols.lookup<IREE::VM::ImportOp>(importName);
+    assert(importOp);
+  }
+
+  LogicalResult matchAndRewrite(
+      IREE::HAL::CommandBufferExecuteCommandsInlineOp op, OpAdaptor adaptor,
+      ConversionPatternRewriter &rewriter) const override {
+    auto importType = importOp.getFunctionType();
+
+    // All operand lists share slots; shorter lists are padded with nulls/zeros
+    // that the command stream never references.
+    DenseMap<Type, Value> nulls;
+    auto getNull = [&](Type type) {
+      auto &null = nulls[type];
+      if (!null) {
+        null = rewriter.create<IREE::VM::ConstRefZeroOp>(op.getLoc(), type);
+      }
+      return null;
+    };
+    Value zero;
+    auto getI64Zero = [&]() {
+      if (!zero) {
+        zero = rewriter.create<IREE::VM::ConstI64ZeroOp>(op.getLoc());
+      }
+      return zero;
+    };
+
+    size_t slotCount = std::max({
+        adaptor.getExecutables().size(),
+        adaptor.getPipelineLayouts().size(),
+        adaptor.getBuffers().size(),
+        adaptor.getValues().size(),
+    });
+    SmallVector<Value, 8> callOperands = {
+        adaptor.getCommandBuffer(),
+        adaptor.getCommands(),
+    };
+    SmallVector<int16_t, 3> segmentSizes = {
+        /*command_buffer=*/-1,
+        /*commands=*/-1,
+        /*operands=*/static_cast<int16_t>(slotCount),
+    };
+    auto operandTypes =
+        importType.getInputs().back().cast<TupleType>().getTypes();
+    auto appendRef = [&](ValueRange values, size_t i, Type type) {
+      callOperands.push_back(i < values.size() ? values[i] : getNull(type));
+    };
+    for (size_t i = 0; i < slotCount; ++i) {
+      appendRef(adaptor.getExecutables(), i, operandTypes[0]);
+      appendRef(adaptor.getPipelineLayouts(), i, operandTypes[1]);
+      appendRef(adaptor.getBuffers(), i, operandTypes[2]);
+      callOperands.push_back(i < adaptor.getValues().size()
+                                 ? castToImportType(adaptor.getValues()[i],
+                                                    rewriter.getI64Type(),
+                                                    rewriter)
+                                 : getI64Zero());
+    }
+
+    auto callOp = rewriter.replaceOpWithNewOp<IREE::VM::CallVariadicOp>(
+        op, SymbolRefAttr::get(importOp), importType.getResults(), segmentSizes,
+        importType.getInputs(), callOperands);
+    copyImportAttrs(importOp, callOp);
+    return success();
+  }
+
+ private:
+  mutable IREE::VM::ImportOp importOp;
+};
+
 }  // namespace
 
 void populateHALCommandBufferToVMPatterns(MLIRContext *context,
@@ -339,6 +419,9 @@ void populateHALCommandBufferToVMPatterns(MLIRContext *context,
       .insert<VMImportOpConversion<IREE::HAL::CommandBufferDispatchIndirectOp>>(
           context, importSymbols, typeConverter,
           "hal.command_buffer.dispatch.indirect");
+  patterns.insert<CommandBufferExecuteCommandsInlineOpConversion>(
+      context, importSymbols, typeConverter,
+      "hal.command_buffer.execute_commands_inline");
 }
 
 }  // namespace iree_compiler
@@ -249,3 +249,36 @@ func.func @command_buffer_dispatch_indirect(
       workgroups(%arg2 : !hal.buffer)[%c100]
   return
 }
+
+// -----
+
+// CHECK-LABEL: @command_buffer_execute_commands_inline
+//  CHECK-SAME: %[[CMD:.+]]: !vm.ref<!hal.command_buffer>,
+//  CHECK-SAME: %[[EXECUTABLE:.+]]: !vm.ref<!hal.executable>,
+//  CHECK-SAME: %[[BUFFER0:[a-z0-9_]+]]: !vm.ref<!hal.buffer>,
+//  CHECK-SAME: %[[BUFFER1:[a-z0-9_]+]]: !vm.ref<!hal.buffer>,
+//  CHECK-SAME: %[[X:.+]]: i64
+func.func @command_buffer_execute_commands_inline(
+    %cmd: !hal.command_buffer,
+    %executable: !hal.executable,
+    %buffer0: !hal.buffer,
+    %buffer1: !hal.buffer,
+    %x: i64
+  ) {
+  // CHECK-DAG: %[[COMMANDS:.+]] = vm.rodata.inline
+  %commands = util.buffer.constant : !util.buffer = dense<[1, 0, 0, 0, 0, 0]> : tensor<6xi32>
+  // CHECK-DAG: %[[NULL_EXECUTABLE:.+]] = vm.const.ref.zero : !vm.ref<!hal.executable>
+  // CHECK-DAG: %[[NULL_LAYOUT:.+]] = vm.const.ref.zero : !vm.ref<!hal.pipeline_layout>
+  // CHECK-DAG: %[[ZERO:.+]] = vm.const.i64.zero
+  // CHECK: vm.call.variadic @hal.command_buffer.execute_commands_inline
+  // CHECK-SAME: (%[[CMD]], %[[COMMANDS]], [
+  // CHECK-SAME:   (%[[EXECUTABLE]], %[[NULL_LAYOUT]], %[[BUFFER0]], %[[X]]),
+  // CHECK-SAME:   (%[[NULL_EXECUTABLE]], %[[NULL_LAYOUT]], %[[BUFFER1]], %[[ZERO]])
+  // CHECK-SAME: ]) : (!vm.ref<!hal.command_buffer>, !vm.buffer, tuple<!vm.ref<!hal.executable>, !vm.ref<!hal.pipeline_layout>, !vm.ref<!hal.buffer>, i64> ...)
+  hal.command_buffer.execute_commands_inline<%cmd : !hal.command_buffer>
+      commands(%commands)
+      executables([%executable])
+      buffers([%buffer0, %buffer1])
+      values([%x])
+  return
+}
@@ -20,6 +20,8 @@
 #include "iree/compiler/Dialect/HAL/Target/LLVM/StaticLibraryGenerator.h"
 #include "iree/compiler/Dialect/HAL/Target/TargetRegistry.h"
 #include "iree/compiler/Utils/ModuleUtils.h"
+#include "iree/schemas/cpu_data.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
@@ -27,6 +29,7 @@
 #include "llvm/IR/Module.h"
 #include "llvm/Linker/Linker.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Transforms/Utils/Cloning.h"
 #include "mlir/Dialect/ArmNeon/ArmNeonDialect.h"
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
 #include "mlir/Dialect/PDL/IR/PDL.h"
@@ -45,6 +48,103 @@ namespace HAL {
 static constexpr char kQueryFunctionName[] =
     "iree_hal_executable_library_query";
 
+// A CPU feature level dispatches can be specialized for on top of the baseline
+// target. A level is usable if all of |requiredBits| are set in processor data
+// field 0 at runtime and code for it is built with |llvmFeatures| enabled.
+struct CPUFeatureLevel {
+  // Canonical key from iree/schemas/cpu_data.h.
+  const char *key;
+  llvm::Triple::ArchType arch;
+  uint64_t requiredBits;
+  const char *llvmFeatures;
+};
+static const CPUFeatureLevel kCPUFeatureLevels[] = {
+    {"avx2_fma", llvm::Triple::x86_64,
+     IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA, "+avx,+avx2,+fma"},
+    {"avx512_base", llvm::Triple::x86_64,
+     IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA |
+         IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE,
+     "+avx,+avx2,+fma,+avx512f,+avx512cd,+avx512vl,+avx512dq,+avx512bw"},
+    {"avx512_vnni", llvm::Triple::x86_64,
+     IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA |
+         IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE |
+         IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_VNNI,
+     "+avx,+avx2,+fma,+avx512f,+avx512cd,+avx512vl,+avx512dq,+avx512bw,"
+     "+avx512vnni"},
+    {"avx512_bf16", llvm::Triple::x86_64,
+     IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA |
+         IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE |
+         IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BF16,
+     "+avx,+avx2,+fma,+avx512f,+avx512cd,+avx512vl,+avx512dq,+avx512bw,"
+     "+avx512bf16"},
+    {"dotprod", llvm::Triple::aarch64,
+     IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_DOTPROD, "+dotprod"},
+    {"i8mm", llvm::Triple::aarch64, IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_I8MM,
+     "+i8mm"},
+    {"fp16fml", llvm::Triple::aarch64,
+     IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_FP16FML, "+fullfp16,+fp16fml"},
+    {"bf16", llvm::Triple::aarch64, IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_BF16,
+     "+bf16"},
+};
+
+// Returns the feature level with the given canonical |key| or nullptr if the
+// key is unknown. |isArchMatch| is set if the level applies to |arch|.
+static const CPUFeatureLevel *lookupCPUFeatureLevel(StringRef key,
+                                                    llvm::Triple::ArchType arch,
+                                                    bool &isArchMatch) {
+  for (auto &level : kCPUFeatureLevels) {
+    if (key != level.key) continue;
+    isArchMatch = level.arch == arch;
+    return &level;
+  }
+  return nullptr;
+}
+
+// Returns true if all features of |level| are already enabled by the
+// comma-separated |cpuFeatures| and a specialized variant would be redundant.
+static bool isCPUFeatureLevelImplied(const CPUFeatureLevel &level,
+                                     StringRef cpuFeatures) {
+  SmallVector<StringRef> enabledFeatures;
+  cpuFeatures.split(enabledFeatures, ',', /*MaxSplit=*/-1,
+                    /*KeepEmpty=*/false);
+  llvm::StringSet<> enabledFeatureSet;
+  for (auto feature : enabledFeatures) enabledFeatureSet.insert(feature);
+  SmallVector<StringRef> levelFeatures;
+  StringRef(level.llvmFeatures).split(levelFeatures, ',');
+  return llvm::all_of(levelFeatures, [&](StringRef feature) {
+    return enabledFeatureSet.contains(feature);
+  });
+}
+
+// Clones |func| into a variant compiled with the features of |level| enabled
+// in addition to the |cpuFeatures| of the baseline target.
+static llvm::Function *cloneFunctionForCPUFeatureLevel(
+    llvm::Function *func, const CPUFeatureLevel &level, StringRef cpuFeatures) {
+  llvm::ValueToValueMapTy valueMap;
+  auto *variantFunc = llvm::CloneFunction(func, valueMap);
+  variantFunc->setName(func->getName() + "_" + level.key);
+  std::string features = cpuFeatures.str();
+  if (func->hasFnAttribute("target-features")) {
+    features =
+        func->getFnAttribute("target-features").getValueAsString().str();
+  }
+  if (!features.empty()) features += ",";
+  features += level.llvmFeatures;
+  variantFunc->addFnAttr("target-features", features);
+  return variantFunc;
+}
+
+// Writes the textual IR of |module| into |path| for inspection.
+static void dumpModuleToPath(StringRef path, StringRef baseName,
+                             StringRef suffix, StringRef extension,
+                             llvm::Module &module) {
+  std::string moduleData;
+  llvm::raw_string_ostream os(moduleData);
+  module.print(os, /*AAW=*/nullptr);
+  os.flush();
+  dumpDataToPath(path, baseName, suffix, extension, moduleData);
+}
+
 // Appends the |debugDatabase| to the end of |baseFile| and writes the footer
 // so the runtime can find it.
 static LogicalResult appendDebugDatabase(std::vector<int8_t> &baseFile,
@@ -223,6 +323,22 @@ class LLVMCPUTargetBackend final : public TargetBackend {
                                       "dialect to the native llvm::Module";
     }
 
+    // Executables may expect denormals to be flushed to zero by the runtime.
+    auto configAttr = variantOp.getTarget().getConfiguration();
+    auto flushDenormalsAttr =
+        configAttr ? configAttr.getAs<BoolAttr>("flush_denormals_to_zero")
+                   : BoolAttr();
+    bool flushDenormalsToZero =
+        flushDenormalsAttr && flushDenormalsAttr.getValue();
+
+    // Dispatch functions loop over workgroup ranges when requested; see
+    // HALDispatchABI::buildWorkgroupRangeLoop.
+    auto workgroupRangesAttr =
+        configAttr ? configAttr.getAs<BoolAttr>("workgroup_ranges")
+                   : BoolAttr();
+    bool workgroupRanges =
+        workgroupRangesAttr && workgroupRangesAttr.getValue();
+
     // Configure the functions in the module. This may override defaults set
     // during the MLIR->LLVM conversion.
     for (auto &func : *llvmModule) {
@@ -239,6 +355,11 @@ class LLVMCPUTargetBackend final : public TargetBackend {
       // Our dispatches are all hot - that's kind of the point.
       // This may favor more aggressive optimizations.
       func.addFnAttr("hot");
+
+      // Denormal inputs and results are treated as signed zeros.
+      if (flushDenormalsToZero) {
+        func.addFnAttr("denormal-fp-math", "preserve-sign,preserve-sign");
+      }
     }
 
     // Build the IREE HAL executable library metadata. The runtime uses this to
@@ -246,8 +367,19 @@ class LLVMCPUTargetBackend final : public TargetBackend {
     LibraryBuilder::Mode libraryBuilderMode =
         options_.debugSymbols ? LibraryBuilder::Mode::INCLUDE_REFLECTION_ATTRS
                               : LibraryBuilder::Mode::NONE;
+    // Libraries not using workgroup ranges remain loadable by v0.3 runtimes.
     LibraryBuilder libraryBuilder(llvmModule.get(), libraryBuilderMode,
-                                  LibraryBuilder::Version::LATEST);
+                                  workgroupRanges
+                                      ? LibraryBuilder::Version::V_0_4
+                                      : LibraryBuilder::Version::V_0_3);
+    if (flushDenormalsToZero) {
+      libraryBuilder.addRequiredFeature(
+          LibraryBuilder::Features::FLUSH_DENORMALS_TO_ZERO);
+    }
+    if (workgroupRanges) {
+      libraryBuilder.addRequiredFeature(
+          LibraryBuilder::Features::WORKGROUP_RANGES);
+    }
 
     switch (options_.sanitizerKind) {
       case SanitizerKind::kNone: {
@@ -281,6 +413,27 @@ class LLVMCPUTargetBackend final : public TargetBackend {
       variantOp->removeAttr(importsAttrName);
     }
 
+    // Declare the CPU feature levels dispatches are specialized for. Levels
+    // for other architectures are ignored so that a single set of levels can
+    // be used when targeting multiple architectures and levels already implied
+    // by the baseline target features don't need variants.
+    SmallVector<const CPUFeatureLevel *> featureLevels;
+    for (auto &key : options_.cpuFeatureLevels) {
+      bool isArchMatch = false;
+      auto *level =
+          lookupCPUFeatureLevel(key, targetTriple.getArch(), isArchMatch);
+      if (!level) {
+        return mlir::emitError(variantOp.getLoc())
+               << "unknown CPU feature level '" << key << "'";
+      }
+      if (!isArchMatch ||
+          isCPUFeatureLevelImplied(*level, target.cpuFeatures)) {
+        continue;
+      }
+      featureLevels.push_back(level);
+      libraryBuilder.addFeatureLevel(level->key, level->requiredBits);
+    }
+
     // Declare exported entry points.
     auto align16 = llvm::Attribute::getWithAlignment(context, llvm::Align(16));
     for (auto exportOp : variantOp.getBlock().getOps<ExecutableExportOp>()) {
@@ -313,9 +466,20 @@ class LLVMCPUTargetBackend final : public TargetBackend {
           sourceLine = loc.getLine();
         }
       }
+
+      // Specialize a copy of the function for each feature level. The copies
+      // share the same MLIR codegen output and only differ in the instructions
+      // LLVM is allowed to select.
+      SmallVector<llvm::Function *> variantFuncs;
+      for (auto *level : featureLevels) {
+        variantFuncs.push_back(cloneFunctionForCPUFeatureLevel(
+            llvmFunc, *level, target.cpuFeatures));
+      }
+
       libraryBuilder.addExport(
           exportOp.getName(), sourceFile, sourceLine, /*tag=*/"",
-          LibraryBuilder::DispatchAttrs{localMemorySize}, llvmFunc);
+          LibraryBuilder::DispatchAttrs{localMemorySize}, llvmFunc,
+          variantFuncs);
     }
 
     auto queryFunctionName = std::string(kQueryFunctionName);
@@ -397,6 +561,10 @@ class LLVMCPUTargetBackend final : public TargetBackend {
                 "targeting '"
              << targetTriple.str() << "'";
     }
+    if (!options.dumpIntermediatesPath.empty()) {
+      dumpModuleToPath(options.dumpIntermediatesPath, options.dumpBaseName,
+                       variantOp.getName(), ".optimized.ll", *llvmModule);
+    }
 
     // Fixup visibility from any symbols we may link in - we want to hide all
     // but the query entry point.
@@ -731,6 +899,22 @@ class LLVMCPUTargetBackend final : public TargetBackend {
     addConfig("cpu_features",
               StringAttr::get(context, options_.target.cpuFeatures));
 
+    // Declare the FPU state executables expect when requested. Omitted by
+    // default to keep IEEE denormal behavior.
+    if (options_.flushDenormalsToZero) {
+      addConfig("flush_denormals_to_zero", BoolAttr::get(context, true));
+    }
+
+    // Have dispatch functions execute ranges of workgroups per call.
+    if (options_.workgroupRanges) {
+      addConfig("workgroup_ranges", BoolAttr::get(context, true));
+    }
+
+    // Use microkernels where available; see hasMicrokernels.
+    if (options_.enableMicrokernels) {
+      addConfig("ukernels", BoolAttr::get(context, true));
+    }
+
     // Set data layout
     addConfig("data_layout", StringAttr::get(context, config_.dataLayoutStr));
 
@@ -92,6 +92,13 @@ LLVMTargetOptions getLLVMTargetOptionsFromFlags() {
       llvm::cl::desc("LLVM target machine CPU features; use 'host' for your "
                      "host native CPU"),
       llvm::cl::init(""));
+  static llvm::cl::list<std::string> clTargetCPUFeatureLevels(
+      "iree-llvm-target-cpu-feature-levels",
+      llvm::cl::desc("Additional CPU feature levels to build variants of each "
+                     "dispatch for (such as 'avx2_fma,avx512_base'); the "
+                     "variant matching the processor is selected at load "
+                     "time"),
+      llvm::cl::CommaSeparated);
 
   static llvm::cl::opt<bool> llvmLoopInterleaving(
       "iree-llvm-loop-interleaving", llvm::cl::init(false),
@@ -117,6 +124,8 @@ LLVMTargetOptions getLLVMTargetOptionsFromFlags() {
   if (clTargetCPU != "host" && clTargetCPU != "generic") {
     addTargetCPUFeaturesForCPU(targetOptions.target);
   }
+  targetOptions.cpuFeatureLevels.assign(clTargetCPUFeatureLevels.begin(),
+                                        clTargetCPUFeatureLevels.end());
 
   // LLVM opt options.
   targetOptions.pipelineTuningOptions.LoopInterleaving = llvmLoopInterleaving;
@@ -158,6 +167,29 @@ LLVMTargetOptions getLLVMTargetOptionsFromFlags() {
       llvm::cl::init(targetOptions.debugSymbols));
   targetOptions.debugSymbols = clDebugSymbols;
 
+  static llvm::cl::opt<bool> clFlushDenormalsToZero(
+      "iree-llvm-flush-denormals-to-zero",
+      llvm::cl::desc("Compiles executables to run with denormal floats "
+                     "flushed to zero, avoiding their slow paths on targets "
+                     "that handle them in microcode."),
+      llvm::cl::init(targetOptions.flushDenormalsToZero));
+  targetOptions.flushDenormalsToZero = clFlushDenormalsToZero;
+
+  static llvm::cl::opt<bool> clWorkgroupRanges(
+      "iree-llvm-workgroup-ranges",
+      llvm::cl::desc("Compiles dispatch functions to execute a range of "
+                     "workgroups per call, amortizing the per-workgroup call "
+                     "overhead of small tiles."),
+      llvm::cl::init(targetOptions.workgroupRanges));
+  targetOptions.workgroupRanges = clWorkgroupRanges;
+
+  static llvm::cl::opt<bool> clEnableMicrokernels(
+      "iree-llvm-enable-microkernels",
+      llvm::cl::desc("Lowers operations with microkernels (such as the mmt4d "
+                     "ops produced by data tiling) to microkernel calls."),
+      llvm::cl::init(targetOptions.enableMicrokernels));
+  targetOptions.enableMicrokernels = clEnableMicrokernels;
+
   static llvm::cl::opt<std::string> clSystemLinkerPath(
       "iree-llvm-system-linker-path",
       llvm::cl::desc("Tool used to link system shared libraries produced by "
@@ -179,6 +211,14 @@ LLVMTargetOptions getLLVMTargetOptionsFromFlags() {
       llvm::cl::init(""));
   targetOptions.wasmLinkerPath = clWasmLinkerPath;
 
+  static llvm::cl::opt<bool> clWasmSharedMemory(
+      "iree-llvm-wasm-shared-memory",
+      llvm::cl::desc("Links WebAssembly modules to import shared memory for "
+                     "use with multithreaded runtimes (requires the +atomics "
+                     "and +bulk-memory target CPU features)."),
+      llvm::cl::init(false));
+  targetOptions.wasmSharedMemory = clWasmSharedMemory;
+
   static llvm::cl::opt<bool> clLinkEmbedded(
       "iree-llvm-link-embedded",
       llvm::cl::desc("Links binaries into a platform-agnostic ELF to be loaded "
@@ -7,6 +7,9 @@
 #ifndef IREE_COMPILER_DIALECT_HAL_TARGET_LLVM_LLVMTARGETOPTIONS_H_
 #define IREE_COMPILER_DIALECT_HAL_TARGET_LLVM_LLVMTARGETOPTIONS_H_
 
+#include <string>
+#include <vector>
+
 #include "llvm/Passes/PassBuilder.h"
 #include "llvm/Target/TargetOptions.h"
 
@@ -33,6 +36,12 @@ struct LLVMTargetOptions {
   // Default target machine configuration.
   LLVMTarget target;
 
+  // Additional CPU feature levels to build dispatch variants for, such as
+  // `avx512_base`. Keys match the canonical keys in iree/schemas/cpu_data.h.
+  // All variants are included in the same library and the one matching the
+  // processor is selected when the library is loaded.
+  std::vector<std::string> cpuFeatureLevels;
+
   llvm::PipelineTuningOptions pipelineTuningOptions;
   // Optimization level to be used by the LLVM optimizer (middle-end).
   llvm::OptimizationLevel optimizerOptLevel;
@@ -50,6 +59,20 @@ struct LLVMTargetOptions {
   // Sanitizer Kind for CPU Kernels
   SanitizerKind sanitizerKind = SanitizerKind::kNone;
 
+  // Declares that executables expect denormal floats to be flushed to zero.
+  // The runtime applies the FPU state around their workgroups and LLVM may
+  // generate code relying on it.
+  bool flushDenormalsToZero = false;
+
+  // Emits dispatch functions that execute a range of workgroups per call so
+  // that the runtime can issue one call per tile range instead of one per
+  // workgroup. Requires a runtime supporting library version 0.4.
+  bool workgroupRanges = false;
+
+  // Lowers the operations that have microkernels (such as mmt4d produced by
+  // data tiling) to calls to them instead of generating code.
+  bool enableMicrokernels = false;
+
   // Tool to use for native platform linking (like ld on Unix or link.exe on
   // Windows). Acts as a prefix to the command line and can contain additional
   // arguments.
@@ -61,6 +84,11 @@ struct LLVMTargetOptions {
   // Tool to use for linking WebAssembly modules. Must be wasm-ld or lld.
   std::string wasmLinkerPath;
 
+  // Links WebAssembly modules to import shared memory from the environment.
+  // Required when loading into runtimes built with threads (Web Workers and
+  // SharedArrayBuffer) and must be off for single-threaded runtimes.
+  bool wasmSharedMemory = false;
+
   // Build for the IREE embedded platform-agnostic ELF loader.
   // Note: this is ignored for target machines that do not support the ELF
   // loader, such as WebAssembly.
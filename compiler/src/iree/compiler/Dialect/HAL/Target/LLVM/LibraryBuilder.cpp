@@ -284,6 +284,42 @@ static llvm::Constant *getStringConstant(StringRef value,
       stringType, global, ArrayRef<llvm::Constant *>{zero, zero});
 }
 
+// Returns a pointer to `environment->processor.data[|index|]`.
+// The environment type is opaque to executables so this models the prefix of
+// the struct up to the processor data:
+// %struct.iree_hal_executable_environment_v0_t = type {
+//   i32*,
+//   i32 (i8*, i8*, i8*, i8*)*,
+//   i8**,
+//   i8**,
+//   %struct.iree_hal_processor_v0_t
+// }
+// %struct.iree_hal_processor_v0_t = type {
+//   [8 x i64]
+// }
+static llvm::Value *buildEnvironmentProcessorDataPtr(
+    llvm::IRBuilder<> &builder, llvm::Value *environment, unsigned index) {
+  auto &context = builder.getContext();
+  auto *i8PtrType = llvm::IntegerType::getInt8PtrTy(context);
+  auto *processorDataType =
+      llvm::ArrayType::get(builder.getInt64Ty(), /*data capacity=*/8);
+  auto *environmentPrefixType = llvm::StructType::get(
+      context, {
+                   i8PtrType,
+                   i8PtrType,
+                   i8PtrType,
+                   i8PtrType,
+                   processorDataType,
+               });
+  auto *processorDataPtr = builder.CreateStructGEP(
+      environmentPrefixType,
+      builder.CreatePointerCast(environment,
+                                environmentPrefixType->getPointerTo()),
+      4);
+  return builder.CreateConstInBoundsGEP2_32(processorDataType,
+                                            processorDataPtr, 0, index);
+}
+
 //===----------------------------------------------------------------------===//
 // Builder interface
 //===----------------------------------------------------------------------===//
@@ -312,14 +348,69 @@ llvm::Function *LibraryBuilder::build(StringRef queryFuncName) {
 
   // Build out the header for each version and select it at runtime.
   // NOTE: today there is just one version so this is rather simple:
-  //   return max_version == 0 ? &library : NULL;
-  auto *v0 = buildLibraryV0((queryFuncName + "_v0").str());
-  builder.CreateRet(builder.CreateSelect(
-      builder.CreateICmpEQ(func->getArg(0),
-                           llvm::ConstantInt::get(
-                               i32Type, static_cast<int64_t>(Version::LATEST))),
-      builder.CreatePointerCast(v0, libraryHeaderType->getPointerTo()),
-      llvm::ConstantPointerNull::get(libraryHeaderType->getPointerTo())));
+  //   return max_version >= version ? &library : NULL;
+  auto v0Libraries = buildLibraryV0((queryFuncName + "_v0").str());
+  auto *v0 = v0Libraries.front();
+  if (featureLevels.empty()) {
+    builder.CreateRet(builder.CreateSelect(
+        builder.CreateICmpUGE(
+            func->getArg(0),
+            llvm::ConstantInt::get(i32Type, static_cast<int64_t>(version))),
+        builder.CreatePointerCast(v0, libraryHeaderType->getPointerTo()),
+        llvm::ConstantPointerNull::get(libraryHeaderType->getPointerTo())));
+    return func;
+  }
+
+  // With feature levels the library matching the processor the library is
+  // being loaded on is selected from those that are satisfied:
+  //   if (max_version < version) return NULL;
+  //   if (!environment) return &library;
+  //   library = &library;
+  //   if ((processor.data[0] & level0_bits) == level0_bits) library = &level0;
+  //   ...
+  //   return library;
+  auto *unsupportedBlock =
+      llvm::BasicBlock::Create(context, "unsupported", func);
+  auto *supportedBlock = llvm::BasicBlock::Create(context, "supported", func);
+  auto *baselineBlock = llvm::BasicBlock::Create(context, "baseline", func);
+  auto *selectBlock = llvm::BasicBlock::Create(context, "select", func);
+  builder.CreateCondBr(
+      builder.CreateICmpUGE(
+          func->getArg(0),
+          llvm::ConstantInt::get(i32Type, static_cast<int64_t>(version))),
+      supportedBlock, unsupportedBlock);
+
+  builder.SetInsertPoint(unsupportedBlock);
+  builder.CreateRet(
+      llvm::ConstantPointerNull::get(libraryHeaderType->getPointerTo()));
+
+  builder.SetInsertPoint(supportedBlock);
+  builder.CreateCondBr(builder.CreateIsNull(func->getArg(1)), baselineBlock,
+                       selectBlock);
+
+  builder.SetInsertPoint(baselineBlock);
+  builder.CreateRet(
+      builder.CreatePointerCast(v0, libraryHeaderType->getPointerTo()));
+
+  builder.SetInsertPoint(selectBlock);
+  auto *processorData0 = builder.CreateLoad(
+      builder.getInt64Ty(),
+      buildEnvironmentProcessorDataPtr(builder, func->getArg(1), 0),
+      "processor_data0");
+  llvm::Value *library =
+      builder.CreatePointerCast(v0, libraryHeaderType->getPointerTo());
+  for (auto [level, levelLibrary] :
+       llvm::zip_equal(featureLevels, ArrayRef<llvm::Constant *>(v0Libraries)
+                                          .drop_front())) {
+    auto *requiredBits = builder.getInt64(level.requiredProcessorBits);
+    library = builder.CreateSelect(
+        builder.CreateICmpEQ(builder.CreateAnd(processorData0, requiredBits),
+                             requiredBits),
+        builder.CreatePointerCast(levelLibrary,
+                                  libraryHeaderType->getPointerTo()),
+        library, "has_" + level.name);
+  }
+  builder.CreateRet(library);
 
   return func;
 }
@@ -367,7 +458,6 @@ llvm::Constant *LibraryBuilder::buildLibraryV0ExportTable(
     std::string libraryName) {
   auto &context = module->getContext();
   auto *exportTableType = makeExportTableType(context);
-  auto *dispatchFunctionType = makeDispatchFunctionType(context);
   auto *dispatchAttrsType = makeDispatchAttrsType(context);
   auto *srcLocType = makeSrcLocType(context);
   auto *i8Type = llvm::IntegerType::getInt8Ty(context);
@@ -376,20 +466,12 @@ llvm::Constant *LibraryBuilder::buildLibraryV0ExportTable(
   llvm::Constant *zero = llvm::ConstantInt::get(i32Type, 0);
 
   // iree_hal_executable_export_table_v0_t::ptrs
-  SmallVector<llvm::Constant *, 4> exportPtrValues;
-  for (auto dispatch : exports) {
-    exportPtrValues.push_back(dispatch.func);
+  SmallVector<llvm::Function *> exportFuncs;
+  for (auto &dispatch : exports) {
+    exportFuncs.push_back(dispatch.func);
   }
-  auto *exportPtrsType = llvm::ArrayType::get(
-      dispatchFunctionType->getPointerTo(), exportPtrValues.size());
-  llvm::Constant *exportPtrs = new llvm::GlobalVariable(
-      *module, exportPtrsType, /*isConstant=*/true,
-      llvm::GlobalVariable::PrivateLinkage,
-      llvm::ConstantArray::get(exportPtrsType, exportPtrValues),
-      /*Name=*/libraryName + "_funcs");
-  // TODO(benvanik): force alignment (16? natural pointer width *2?)
-  exportPtrs = llvm::ConstantExpr::getInBoundsGetElementPtr(
-      exportPtrsType, exportPtrs, ArrayRef<llvm::Constant *>{zero, zero});
+  llvm::Constant *exportPtrs =
+      buildLibraryV0ExportPtrs(libraryName, exportFuncs);
 
   // iree_hal_executable_export_table_v0_t::attrs
   llvm::Constant *exportAttrs =
@@ -511,6 +593,29 @@ llvm::Constant *LibraryBuilder::buildLibraryV0ExportTable(
                        });
 }
 
+llvm::Constant *LibraryBuilder::buildLibraryV0ExportPtrs(
+    std::string libraryName, ArrayRef<llvm::Function *> funcs) {
+  auto &context = module->getContext();
+  auto *dispatchFunctionType = makeDispatchFunctionType(context);
+  auto *i32Type = llvm::IntegerType::getInt32Ty(context);
+  llvm::Constant *zero = llvm::ConstantInt::get(i32Type, 0);
+
+  SmallVector<llvm::Constant *, 4> exportPtrValues;
+  for (auto *func : funcs) {
+    exportPtrValues.push_back(func);
+  }
+  auto *exportPtrsType = llvm::ArrayType::get(
+      dispatchFunctionType->getPointerTo(), exportPtrValues.size());
+  llvm::Constant *exportPtrs = new llvm::GlobalVariable(
+      *module, exportPtrsType, /*isConstant=*/true,
+      llvm::GlobalVariable::PrivateLinkage,
+      llvm::ConstantArray::get(exportPtrsType, exportPtrValues),
+      /*Name=*/libraryName + "_funcs");
+  // TODO(benvanik): force alignment (16? natural pointer width *2?)
+  return llvm::ConstantExpr::getInBoundsGetElementPtr(
+      exportPtrsType, exportPtrs, ArrayRef<llvm::Constant *>{zero, zero});
+}
+
 llvm::Constant *LibraryBuilder::buildLibraryV0ConstantTable(
     std::string libraryName) {
   auto &context = module->getContext();
@@ -524,7 +629,8 @@ llvm::Constant *LibraryBuilder::buildLibraryV0ConstantTable(
                          });
 }
 
-llvm::Constant *LibraryBuilder::buildLibraryV0(std::string libraryName) {
+SmallVector<llvm::Constant *> LibraryBuilder::buildLibraryV0(
+    std::string libraryName) {
   auto &context = module->getContext();
   auto *libraryHeaderType = makeLibraryHeaderType(context);
   auto *libraryType = makeLibraryType(libraryHeaderType);
@@ -539,8 +645,7 @@ llvm::Constant *LibraryBuilder::buildLibraryV0(std::string libraryName) {
           libraryHeaderType,
           {
               // version=
-              llvm::ConstantInt::get(i32Type,
-                                     static_cast<int64_t>(Version::LATEST)),
+              llvm::ConstantInt::get(i32Type, static_cast<int64_t>(version)),
               // name=
               getStringConstant(module->getName(), module),
               // features=
@@ -554,24 +659,52 @@ llvm::Constant *LibraryBuilder::buildLibraryV0(std::string libraryName) {
 
   // ----- Library -----
 
-  auto *library = new llvm::GlobalVariable(
-      *module, libraryType, /*isConstant=*/true,
-      llvm::GlobalVariable::PrivateLinkage,
-      llvm::ConstantStruct::get(libraryType,
-                                {
-                                    // header=
-                                    libraryHeader,
-                                    // imports=
-                                    buildLibraryV0ImportTable(libraryName),
-                                    // exports=
-                                    buildLibraryV0ExportTable(libraryName),
-                                    // constants=
-                                    buildLibraryV0ConstantTable(libraryName),
-                                }),
-      /*Name=*/libraryName);
-  // TODO(benvanik): force alignment (8? natural pointer width?)
+  auto *importTable = buildLibraryV0ImportTable(libraryName);
+  auto *exportTable = buildLibraryV0ExportTable(libraryName);
+  auto *constantTable = buildLibraryV0ConstantTable(libraryName);
+  auto makeLibrary = [&](llvm::Constant *exportTable, std::string name) {
+    auto *library = new llvm::GlobalVariable(
+        *module, libraryType, /*isConstant=*/true,
+        llvm::GlobalVariable::PrivateLinkage,
+        llvm::ConstantStruct::get(libraryType,
+                                  {
+                                      // header=
+                                      libraryHeader,
+                                      // imports=
+                                      importTable,
+                                      // exports=
+                                      exportTable,
+                                      // constants=
+                                      constantTable,
+                                  }),
+        /*Name=*/name);
+    // TODO(benvanik): force alignment (8? natural pointer width?)
+    return library;
+  };
+  SmallVector<llvm::Constant *> libraries;
+  libraries.push_back(makeLibrary(exportTable, libraryName));
+
+  // Feature level libraries only differ in their export function pointers and
+  // share all other tables with the baseline library.
+  auto *exportTableType = makeExportTableType(context);
+  for (auto level : llvm::enumerate(featureLevels)) {
+    std::string levelName = libraryName + "_" + level.value().name;
+    SmallVector<llvm::Function *> levelFuncs;
+    for (auto &dispatch : exports) {
+      levelFuncs.push_back(dispatch.variantFuncs[level.index()]);
+    }
+    SmallVector<llvm::Constant *> exportTableFields;
+    for (unsigned i = 0; i < exportTableType->getNumElements(); ++i) {
+      exportTableFields.push_back(exportTable->getAggregateElement(i));
+    }
+    // iree_hal_executable_export_table_v0_t::ptrs
+    exportTableFields[1] = buildLibraryV0ExportPtrs(levelName, levelFuncs);
+    libraries.push_back(makeLibrary(
+        llvm::ConstantStruct::get(exportTableType, exportTableFields),
+        levelName));
+  }
 
-  return library;
+  return libraries;
 }
 
 }  // namespace HAL
@@ -8,6 +8,7 @@
 #ifndef IREE_COMPILER_DIALECT_HAL_TARGET_LLVM_LIBRARYBUILDER_H_
 #define IREE_COMPILER_DIALECT_HAL_TARGET_LLVM_LIBRARYBUILDER_H_
 
+#include <cassert>
 #include <string>
 
 #include "iree/compiler/Dialect/HAL/Target/LLVM/LLVMTargetOptions.h"
@@ -49,16 +50,21 @@ class LibraryBuilder {
     // We may want to make this major release number, date codes (0x20220307),
     // or some semantic versioning we track in whatever spec we end up having.
     V_0_3 = 0x0000'0003u,  // v0.3 - ~2022-08-08
+    V_0_4 = 0x0000'0004u,  // v0.4 - workgroup ranges
 
     // Pinned to the latest version.
     // Requires that the runtime be compiled with the same version.
-    LATEST = V_0_3,
+    LATEST = V_0_4,
   };
 
   // iree_hal_executable_library_features_t
   enum class Features : uint32_t {
     // IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_NONE
     NONE = 0u,
+    // IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_FLUSH_DENORMALS_TO_ZERO
+    FLUSH_DENORMALS_TO_ZERO = 1u << 0,
+    // IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_WORKGROUP_RANGES
+    WORKGROUP_RANGES = 1u << 1,
   };
 
   // iree_hal_executable_library_sanitizer_kind_t
@@ -110,14 +116,33 @@ class LibraryBuilder {
     imports.push_back({name.str(), weak});
   }
 
+  // Declares a CPU feature level that exports may provide variants for.
+  // The level is selected when the library is queried if all of
+  // |requiredProcessorBits| are set in processor data field 0 (see
+  // iree/schemas/cpu_data.h). If multiple levels are satisfied the last one
+  // declared is used and if none are the baseline exports are used.
+  // Levels must be declared before any exports are added.
+  void addFeatureLevel(StringRef name, uint64_t requiredProcessorBits) {
+    assert(exports.empty() && "feature levels must be declared first");
+    featureLevels.push_back({name.str(), requiredProcessorBits});
+  }
+
   // Defines a new entry point on the library implemented by |func|.
   // |name| will be used as the library export
   // |sourceFile| and |sourceLoc| are optional source information
   // |tag| is an optional attachment
+  // |variantFuncs| are optional implementations for each declared feature
+  // level; if omitted |func| is used for all levels
   void addExport(StringRef name, StringRef sourceFile, uint32_t sourceLoc,
-                 StringRef tag, DispatchAttrs attrs, llvm::Function *func) {
-    exports.push_back(
-        {name.str(), sourceFile.str(), sourceLoc, tag.str(), attrs, func});
+                 StringRef tag, DispatchAttrs attrs, llvm::Function *func,
+                 ArrayRef<llvm::Function *> variantFuncs = {}) {
+    assert((variantFuncs.empty() ||
+            variantFuncs.size() == featureLevels.size()) &&
+           "one variant per feature level required");
+    SmallVector<llvm::Function *> funcs(featureLevels.size(), func);
+    llvm::copy(variantFuncs, funcs.begin());
+    exports.push_back({name.str(), sourceFile.str(), sourceLoc, tag.str(),
+                       attrs, func, std::move(funcs)});
   }
 
   // Builds a `iree_hal_executable_library_query_fn_t` with the given
@@ -131,10 +156,13 @@ class LibraryBuilder {
   llvm::Function *build(StringRef queryFuncName);
 
  private:
-  // Builds and returns an iree_hal_executable_library_v0_t global constant.
-  llvm::Constant *buildLibraryV0(std::string libraryName);
+  // Builds and returns iree_hal_executable_library_v0_t global constants for
+  // the baseline exports followed by one per declared feature level.
+  SmallVector<llvm::Constant *> buildLibraryV0(std::string libraryName);
   llvm::Constant *buildLibraryV0ImportTable(std::string libraryName);
   llvm::Constant *buildLibraryV0ExportTable(std::string libraryName);
+  llvm::Constant *buildLibraryV0ExportPtrs(std::string libraryName,
+                                           ArrayRef<llvm::Function *> funcs);
   llvm::Constant *buildLibraryV0ConstantTable(std::string libraryName);
 
   llvm::Module *module = nullptr;
@@ -156,9 +184,17 @@ class LibraryBuilder {
     std::string tag;
     DispatchAttrs attrs;
     llvm::Function *func;
+    // Implementation for each feature level.
+    SmallVector<llvm::Function *> variantFuncs;
   };
   SmallVector<Dispatch> exports;
 
+  struct FeatureLevel {
+    std::string name;
+    uint64_t requiredProcessorBits = 0;
+  };
+  SmallVector<FeatureLevel> featureLevels;
+
   size_t constantCount = 0;
 };
 
@@ -106,17 +106,21 @@ class WasmLinkerTool : public LinkerTool {
         "--experimental-pic",
         "--shared",
 
-        // Import [shared] memory from the environment.
-        // https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/WebAssembly/Memory#creating_a_shared_memory
-        // TODO(scotttodd): Add a flag controlling these - some combination is
-        //   required when using multithreading + SharedArrayBuffer, but they
-        //   must be left off when running single threaded.
-        // "--import-memory",
-        // "--shared-memory",
-
         "-o " + artifacts.libraryFile.path,
     };
 
+    // Import shared memory from the environment when running multithreaded
+    // with SharedArrayBuffer. This must be left off when running single
+    // threaded as the memory of the runtime will not be shared.
+    // https://developer.mozilla.org/en-US/docs/Web/JavaScript/Reference/Global_Objects/WebAssembly/Memory#creating_a_shared_memory
+    if (targetOptions.wasmSharedMemory) {
+      flags.push_back("--import-memory");
+      flags.push_back("--shared-memory");
+      // Shared memories must declare a maximum; use the full wasm32 range so
+      // that any runtime memory limit is compatible.
+      flags.push_back("--max-memory=4294967296");
+    }
+
     // Strip debug information when not requested.
     if (!targetOptions.debugSymbols) {
       flags.push_back("--strip-debug");
@@ -0,0 +1,49 @@
+// Tests that executables requesting denormals be flushed to zero are compiled
+// assuming the mode and declare the library feature the runtime applies it for.
+// RUN: iree-opt --iree-hal-target-backends=llvm-cpu --iree-llvm-target-triple=x86_64-unknown-unknown-eabi-elf --iree-llvm-link-embedded=true --iree-llvm-flush-denormals-to-zero --iree-stream-transformation-pipeline --iree-hal-transformation-pipeline --iree-hal-dump-executable-intermediates-to=%t.ftz %s | FileCheck %s --check-prefix=TARGET
+// RUN: FileCheck %s --check-prefix=FTZ --input-file=%t.ftz/module_add_dispatch_0_embedded_elf_x86_64.optimized.ll
+// RUN: iree-opt --iree-hal-target-backends=llvm-cpu --iree-llvm-target-triple=x86_64-unknown-unknown-eabi-elf --iree-llvm-link-embedded=true --iree-stream-transformation-pipeline --iree-hal-transformation-pipeline --iree-hal-dump-executable-intermediates-to=%t.default %s | FileCheck %s --check-prefix=TARGET-DEFAULT
+// RUN: FileCheck %s --check-prefix=DEFAULT --input-file=%t.default/module_add_dispatch_0_embedded_elf_x86_64.optimized.ll
+
+stream.executable public @add_dispatch_0 {
+  stream.executable.export @add_dispatch_0 workgroups(%arg0 : index) -> (index, index, index) {
+    %x, %y, %z = flow.dispatch.workgroup_count_from_dag_root %arg0
+    stream.return %x, %y, %z : index, index, index
+  }
+  builtin.module  {
+    func.func @add_dispatch_0(%arg0_binding: !stream.binding, %arg1_binding: !stream.binding, %arg2_binding: !stream.binding) {
+      %c0 = arith.constant 0 : index
+      %arg0 = stream.binding.subspan %arg0_binding[%c0] : !stream.binding -> !flow.dispatch.tensor<readonly:tensor<16xf32>>
+      %arg1 = stream.binding.subspan %arg1_binding[%c0] : !stream.binding -> !flow.dispatch.tensor<readonly:tensor<16xf32>>
+      %arg2 = stream.binding.subspan %arg2_binding[%c0] : !stream.binding -> !flow.dispatch.tensor<writeonly:tensor<16xf32>>
+      %0 = tensor.empty() : tensor<16xf32>
+      %1 = flow.dispatch.tensor.load %arg0, offsets=[0], sizes=[16], strides=[1] : !flow.dispatch.tensor<readonly:tensor<16xf32>> -> tensor<16xf32>
+      %2 = flow.dispatch.tensor.load %arg1, offsets=[0], sizes=[16], strides=[1] : !flow.dispatch.tensor<readonly:tensor<16xf32>> -> tensor<16xf32>
+      %3 = linalg.generic {indexing_maps = [affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>], iterator_types = ["parallel"]} ins(%1, %2 : tensor<16xf32>, tensor<16xf32>) outs(%0 : tensor<16xf32>) {
+      ^bb0(%arg3: f32, %arg4: f32, %arg5: f32):
+        %4 = arith.addf %arg3, %arg4 : f32
+        linalg.yield %4 : f32
+      } -> tensor<16xf32>
+      flow.dispatch.tensor.store %3, %arg2, offsets=[0], sizes=[16], strides=[1] : tensor<16xf32> -> !flow.dispatch.tensor<writeonly:tensor<16xf32>>
+      return
+    }
+  }
+}
+
+// The flag is carried on the executable target configuration.
+// TARGET: #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64", {{\{.*}}flush_denormals_to_zero = true
+// TARGET: hal.executable.binary public @embedded_elf_x86_64
+// TARGET-DEFAULT-NOT: flush_denormals_to_zero
+// TARGET-DEFAULT: hal.executable.binary public @embedded_elf_x86_64
+
+// Dispatch functions are compiled with denormals treated as signed zeros and
+// the library header declares
+// IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_FLUSH_DENORMALS_TO_ZERO (1) and no
+// sanitizer.
+// FTZ: %iree_hal_executable_library_header_t {{.*}}{ i32 {{[0-9]+}}, {{.+}}, i32 1, i32 0 }
+// FTZ: define {{.*}}i32 @add_dispatch_0({{.*}}) #[[ATTRS:[0-9]+]]
+// FTZ: attributes #[[ATTRS]] = {{\{.*}}"denormal-fp-math"="preserve-sign,preserve-sign"
+
+// Without the flag no features are declared.
+// DEFAULT: %iree_hal_executable_library_header_t {{.*}}{ i32 {{[0-9]+}}, {{.+}}, i32 0, i32 0 }
+// DEFAULT: define {{.*}}i32 @add_dispatch_0(
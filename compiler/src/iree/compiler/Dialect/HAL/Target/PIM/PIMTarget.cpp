@@ -4,16 +4,17 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
-#include <iostream>
 #include <stdio.h>
 #include <string>
 #include <vector>
+#include <map>
 #include <random>
 #include <sstream>
 #include "iree/compiler/Dialect/HAL/Target/PIM/PIMTarget.h"
 
 #include "iree/compiler/Codegen/Dialect/IREECodegenDialect.h"
 #include "iree/compiler/Codegen/Passes.h"
+#include "iree/compiler/Dialect/Flow/IR/FlowTypes.h"
 #include "iree/compiler/Dialect/HAL/Target/CUDA/LLVMPasses.h"
 #include "iree/compiler/Dialect/HAL/Target/TargetRegistry.h"
 #include "iree/compiler/Dialect/PIM/IR/PIMDialect.h"
@@ -31,21 +32,88 @@
 #include "llvm/MC/TargetRegistry.h"
 #include "llvm/Passes/PassBuilder.h"
 #include "llvm/Passes/StandardInstrumentations.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/IPO/Internalize.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
+#include "llvm/Support/Debug.h"
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/SymbolTable.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Target/LLVMIR/Dialect/LLVMIR/LLVMToLLVMIRTranslation.h"
 #include "mlir/Target/LLVMIR/Dialect/NVVM/NVVMToLLVMIRTranslation.h"
 #include "mlir/Target/LLVMIR/Export.h"
-#include "json/json.h"
 
 
+#define DEBUG_TYPE "iree-hal-pim-target"
+
+// Geometry of the PIM SKU the executables are specialized for. The values are
+// stored in the hal.executable.target configuration where the PIM kernel
+// configuration reads them to pick tile sizes and device partitioning.
+static llvm::cl::opt<int> clDeviceCount(
+    "iree-pim-device-count",
+    llvm::cl::desc("Number of PIM devices dispatches are partitioned across."),
+    llvm::cl::init(1));
+
+static llvm::cl::opt<int64_t> clBankCount(
+    "iree-pim-bank-count",
+    llvm::cl::desc("Number of banks computing in parallel on one PIM device."),
+    llvm::cl::init(512));
+
+static llvm::cl::opt<int64_t> clRowBufferBytes(
+    "iree-pim-row-buffer-bytes",
+    llvm::cl::desc("Size of the row buffer of one PIM bank in bytes."),
+    llvm::cl::init(2048));
+
+static llvm::cl::opt<int64_t> clDeviceCapacityBytes(
+    "iree-pim-device-capacity-bytes",
+    llvm::cl::desc("Memory of one PIM device available for the weights of a "
+                   "dispatch in bytes."),
+    llvm::cl::init(int64_t(1) << 30));
+
+static llvm::cl::list<std::string> clElementTypes(
+    "iree-pim-element-types",
+    llvm::cl::desc("Comma-separated element types the PIM devices compute in "
+                   "(f32, f16, bf16, i8). Dispatches on other types are left "
+                   "to the fallback target backends."),
+    llvm::cl::CommaSeparated);
+
+static llvm::cl::list<std::string> clHostLayers(
+    "iree-pim-host-layers",
+    llvm::cl::desc("Comma-separated decoder layers (such as softmax or "
+                   "layernorm) left to the fallback target backends so that "
+                   "the runtime runs them on the host alongside independent "
+                   "PIM dispatches."),
+    llvm::cl::CommaSeparated);
+
+static llvm::cl::opt<bool> clPartitionSearch(
+    "iree-pim-partition-search",
+    llvm::cl::desc("Ignores the row-wise/col-wise partitioning recorded for "
+                   "matmuls by the flow dispatch region formation and splits "
+                   "each one the cheapest way under the PIM cost model "
+                   "(compute, all-gather and all-reduce volume). Emits a "
+                   "remark per matmul with the chosen split and the cost of "
+                   "every candidate."),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<bool> clLegacySync(
+    "iree-pim-legacy-sync",
+    llvm::cl::desc("Blocks the host on every submission to the PIM devices as "
+                   "required by HAL drivers without asynchronous queues."),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<bool> clRemarks(
+    "iree-pim-remarks",
+    llvm::cl::desc("Emits a remark for every PIM instruction with its split, "
+                   "dims and sync point and one per executable with its "
+                   "instruction count."),
+    llvm::cl::init(false));
+
 namespace mlir {
 namespace iree_compiler {
 namespace IREE {
@@ -53,43 +121,210 @@ namespace HAL {
 
 // Convert PIM operations to INT64 code
 // LayerNorm1: 1, QKVGen: 2, QKMatmul: 3, Softmax: 4,
-// SVMatmul: 5, OutProj: 6, LayerNorm2: 7, FFN1: 8, FFN2: 9
-void GenOpCommand(mlir::Operation *op, std::vector<uint64_t> &code){
+// SVMatmul: 5, OutProj: 6, LayerNorm2: 7, FFN1: 8, FFN2: 9, LMHead: 10,
+// Gather: 11, RMSNorm: 12, RoPE: 13, FFNGate: 14, SwiGLU: 15,
+// GQAQKMatmul: 16, GQASVMatmul: 17, Elementwise: 18
+//
+// Instruction word layout (see pim_executable_def.fbs):
+//   [7:0]   opcode
+//   [9:8]   split type: 0 none, 1 col-wise, 2 row-wise
+//   [15:12] number of dims appended to |dims|
+//   [18:16] element type: 0 f32, 1 f16, 2 bf16, 3 i8
+// The dims are the i32 operands of the op in order (length, count and length
+// for gathers or m/n/k with the batch dim first for batched matmuls and the
+// query heads per key head last for grouped-query attention).
+// Instructions followed by a sync append a sync point to |comm_flag|: the
+// instruction ordinal in the low 32 bits and 1 for all-reduce or 2 for
+// all-gather in the high 32 bits.
+// Returns the ordinal of the push constant |value| is loaded from, looking
+// through integer casts, or std::nullopt if it isn't a push constant.
+static Optional<int64_t> GetPushConstantOrdinal(Value value) {
+  while (Operation *defOp = value.getDefiningOp()) {
+    if (auto loadOp = dyn_cast<IREE::HAL::InterfaceConstantLoadOp>(defOp)) {
+      return loadOp.getIndex().getZExtValue();
+    }
+    if (!isa<arith::IndexCastOp, arith::IndexCastUIOp, arith::ExtUIOp,
+             arith::ExtSIOp, arith::TruncIOp>(defOp)) {
+      break;
+    }
+    value = defOp->getOperand(0);
+  }
+  return std::nullopt;
+}
+
+// Emits a remark on the PIM instruction |op| encoded as |word| with |dims|
+// and followed by |sync| (the high bits of its comm_flag entry or 0).
+// Dims read from push constants are printed as `pc[ordinal]`.
+static void EmitInstructionRemark(mlir::Operation *op, uint64_t word,
+                                  ArrayRef<int32_t> dims, uint64_t sync) {
+  static const char *kSplitNames[] = {"none", "col-wise", "row-wise", "?"};
+  static const char *kElementTypeNames[] = {"f32", "f16", "bf16", "i8"};
+  const uint64_t elementType = (word >> 16) & 0x7;
+  auto diag = op->emitRemark()
+              << "PIM " << op->getName().stripDialect()
+              << " split=" << kSplitNames[(word >> 8) & 0x3] << " type="
+              << (elementType < 4 ? kElementTypeNames[elementType] : "?")
+              << " dims=(";
+  llvm::interleaveComma(dims, diag, [&](int32_t dim) {
+    if (dim < 0) {
+      diag << "pc[" << (-1 - static_cast<int64_t>(dim)) << "]";
+    } else {
+      diag << dim;
+    }
+  });
+  diag << ")";
+  if (sync == 1) diag << " sync=all-reduce";
+  if (sync == 2) diag << " sync=all-gather";
+}
+
+void GenOpCommand(mlir::Operation *op, std::vector<uint64_t> &code,
+                  std::vector<int32_t> &dims,
+                  std::vector<uint64_t> &comm_flag){
+  uint64_t cmd = 0;
   if (isa<IREE::PIM::LayerNorm1Op>(op)) {
-    uint64_t cmd = 1;
-    code.push_back(cmd);
+    cmd = 1;
   }
   else if (isa<IREE::PIM::QKVGenOp>(op)) {
-    uint64_t cmd = 2;
-    code.push_back(cmd);
+    cmd = 2;
   }
   else if (isa<IREE::PIM::QKMatmulOp>(op)) {
-    uint64_t cmd = 3;
-    code.push_back(cmd);
+    cmd = 3;
   }
   else if (isa<IREE::PIM::SoftmaxOp>(op)) {
-    uint64_t cmd = 4;
-    code.push_back(cmd);
+    cmd = 4;
   }
   else if (isa<IREE::PIM::SVMatmulOp>(op)) {
-    uint64_t cmd = 5;
-    code.push_back(cmd);
+    cmd = 5;
   }
   else if (isa<IREE::PIM::OutProjOp>(op)) {
-    uint64_t cmd = 6;
-    code.push_back(cmd);
+    cmd = 6;
   }
   else if (isa<IREE::PIM::LayerNorm2Op>(op)) {
-    uint64_t cmd = 7;
-    code.push_back(cmd);
+    cmd = 7;
   }
   else if (isa<IREE::PIM::FFN1Op>(op)) {
-    uint64_t cmd = 8;
-    code.push_back(cmd);
+    cmd = 8;
   }
   else if (isa<IREE::PIM::FFN2Op>(op)) {
-    uint64_t cmd = 9;
-    code.push_back(cmd);
+    cmd = 9;
+  }
+  else if (isa<IREE::PIM::LMHeadOp>(op)) {
+    cmd = 10;
+  }
+  else if (isa<IREE::PIM::GatherOp>(op)) {
+    cmd = 11;
+  }
+  else if (isa<IREE::PIM::RMSNormOp>(op)) {
+    cmd = 12;
+  }
+  else if (isa<IREE::PIM::RoPEOp>(op)) {
+    cmd = 13;
+  }
+  else if (isa<IREE::PIM::FFNGateOp>(op)) {
+    cmd = 14;
+  }
+  else if (isa<IREE::PIM::SwiGLUOp>(op)) {
+    cmd = 15;
+  }
+  else if (isa<IREE::PIM::GQAQKMatmulOp>(op)) {
+    cmd = 16;
+  }
+  else if (isa<IREE::PIM::GQASVMatmulOp>(op)) {
+    cmd = 17;
+  }
+  else if (isa<IREE::PIM::ElementwiseOp>(op)) {
+    cmd = 18;
+  }
+  if (cmd == 0) return;
+
+  // Split type and sync are recorded by the LinalgToPIM patterns.
+  if (auto splitAttr = op->getAttrOfType<IntegerAttr>("pim.split_type")) {
+    switch (splitAttr.getInt()) {
+      case 0: cmd |= 1ull << 8; break;  // col-wise
+      case 1: cmd |= 2ull << 8; break;  // row-wise
+      default: break;
+    }
+  }
+  if (auto syncAttr = op->getAttrOfType<StringAttr>("pim.sync")) {
+    uint64_t sync = 0;
+    if (syncAttr.getValue() == "reduce") sync = 1;
+    else if (syncAttr.getValue() == "gather") sync = 2;
+    if (sync) comm_flag.push_back((sync << 32) | code.size());
+  }
+
+  if (auto typeAttr = op->getAttrOfType<IntegerAttr>("pim.element_type")) {
+    cmd |= (static_cast<uint64_t>(typeAttr.getInt()) & 0x7) << 16;
+  }
+
+  uint64_t dim_count = 0;
+  for (Value operand : op->getOperands()) {
+    APInt value;
+    if (matchPattern(operand, m_ConstantInt(&value))) {
+      dims.push_back(static_cast<int32_t>(value.getSExtValue()));
+      ++dim_count;
+    } else if (Optional<int64_t> ordinal = GetPushConstantOrdinal(operand)) {
+      // Dims the dispatch provides at runtime (the sequence length of a KV
+      // cache) are encoded as -1 - ordinal of their push constant.
+      dims.push_back(static_cast<int32_t>(-1 - *ordinal));
+      ++dim_count;
+    }
+  }
+  // Elementwise programs follow the length; their words are never negative.
+  if (auto elementwiseOp = dyn_cast<IREE::PIM::ElementwiseOp>(op)) {
+    for (int32_t word : elementwiseOp.getProgram()) {
+      dims.push_back(word);
+      ++dim_count;
+    }
+  }
+  cmd |= dim_count << 12;
+  code.push_back(cmd);
+}
+
+// Returns the element type encoding of |type| (see GenOpCommand). Types PIM
+// doesn't store are treated as f32 as the runtime has no other way to read
+// them.
+static uint8_t GetPIMElementType(Type type) {
+  if (type.isF16()) return 1;
+  if (type.isBF16()) return 2;
+  if (type.isInteger(8)) return 3;
+  return 0;
+}
+
+// Appends the static tensor shape of each binding of |funcOp| in binding
+// order: the rank of binding i in |ranks[base + i]| and its dims to |dims|
+// where base is the size of |ranks| on entry. Bindings without a subspan or
+// with a dynamic shape get rank 0 so that the runtime keeps the shape of their
+// buffers. The element type of binding i is recorded in |types[base + i]|.
+static void GenBindingShapes(func::FuncOp funcOp, std::vector<uint8_t> &ranks,
+                             std::vector<int32_t> &dims,
+                             std::vector<uint8_t> &types) {
+  std::map<int64_t, SmallVector<int64_t>> shapes;
+  std::map<int64_t, uint8_t> elementTypes;
+  funcOp.walk([&](IREE::HAL::InterfaceBindingSubspanOp subspanOp) {
+    int64_t binding = subspanOp.getBinding().getSExtValue();
+    if (shapes.count(binding)) return;
+    Type type = subspanOp.getType();
+    ArrayRef<int64_t> shape;
+    Type elementType = type;
+    if (auto tensorType = type.dyn_cast<IREE::Flow::DispatchTensorType>()) {
+      shape = tensorType.getShape();
+      elementType = tensorType.getBoundElementType();
+    } else if (auto shapedType = type.dyn_cast<ShapedType>()) {
+      shape = shapedType.getShape();
+      elementType = shapedType.getElementType();
+    }
+    elementTypes[binding] = GetPIMElementType(elementType);
+    if (ShapedType::isDynamicShape(shape)) shape = {};
+    shapes[binding].assign(shape.begin(), shape.end());
+  });
+  if (shapes.empty()) return;
+  size_t base = ranks.size();
+  ranks.resize(base + shapes.rbegin()->first + 1, 0);
+  types.resize(ranks.size(), 0);
+  for (auto &[binding, shape] : shapes) {
+    ranks[base + binding] = static_cast<uint8_t>(shape.size());
+    types[base + binding] = elementTypes[binding];
+    for (int64_t dim : shape) dims.push_back(static_cast<int32_t>(dim));
   }
 }
 
@@ -109,9 +344,13 @@ class PIMTargetBackend final : public TargetBackend {
     Builder b(context);
     SmallVector<NamedAttribute> configItems;
 
-    // Indicates that the runtime HAL driver operates only in the legacy
-    // synchronous mode.
-    configItems.emplace_back(b.getStringAttr("legacy_sync"), b.getUnitAttr());
+    // The PIM HAL driver executes submissions asynchronously on its queues
+    // and honors their wait and signal semaphores so the host only waits
+    // where stream timepoints require it.
+    if (clLegacySync) {
+      configItems.emplace_back(b.getStringAttr("legacy_sync"),
+                               b.getUnitAttr());
+    }
 
     configItems.emplace_back(b.getStringAttr("executable_targets"),
                              getExecutableTargets(context));
@@ -127,11 +366,14 @@ class PIMTargetBackend final : public TargetBackend {
     // We could instead perform linking with those objects (if they're bitcode
     // ala libdevice.bc, etc).
     if (variantOp.isExternal()) return;
-    // std::cout << "TranslationPassPipeline\n";
-    
+
     buildPIMCodegenPassPipeline(passManager);
   }
 
+  void buildLinkingPassPipeline(OpPassManager &passManager) override {
+    buildPIMLinkingPassPipeline(passManager);
+  }
+
   LogicalResult serializeExecutable(const SerializationOptions &options,
                                     IREE::HAL::ExecutableVariantOp variantOp,
                                     OpBuilder &executableBuilder) override {
@@ -152,48 +394,111 @@ class PIMTargetBackend final : public TargetBackend {
     // AiMDMACmdCreator cmd_creator;
     std::vector<uint64_t> code;
     std::vector<uint64_t> out_dim;
-    // std::vector<uint64_t> comm_flag;
+    std::vector<uint64_t> comm_flag;
+    std::vector<int32_t> dims;
+    // Operand slots of fused programs (see ConvertToPIMPass).
+    std::vector<uint32_t> operand_offsets;
+    std::vector<int32_t> operand_slots;
+    bool has_operand_slots = false;
+    // Binding shapes of the entry points read by the runtime in place of a
+    // separate metadata file.
+    std::vector<uint8_t> binding_ranks;
+    std::vector<int32_t> binding_dims;
+    std::vector<uint8_t> binding_types;
+    // Ranges of the instructions and bindings of each entry point of linked
+    // executables in |code| and |binding_ranks|.
+    std::vector<uint32_t> entry_code_offsets;
+    std::vector<uint32_t> entry_binding_offsets;
+    // Dispatch bindings and byte offsets viewed by the bindings of entry
+    // points with fused bindings (see PIMMaterializeBindingViews) in
+    // |binding_ranks| order. Bindings of other entry points view their
+    // dispatch binding from its start.
+    std::vector<uint32_t> binding_sources;
+    std::vector<int32_t> binding_offsets;
+    bool has_binding_views = false;
 
+    // Entry points are serialized in ordinal order, each as its own program.
     auto innerModule = variantOp.getInnerModule();
-    // for (auto &op : innerModule.getBody()->without_terminator()) {
-    for (auto &op : *innerModule.getBody()) {
-      if (auto funcOp = llvm::dyn_cast<mlir::func::FuncOp>(op)) {
-        // std::cout << "Get access to func op" << std::endl;
-        funcOp.walk([/*&cmd_creator,*/ &code, &out_dim/*, &comm_flag*/](mlir::Operation *op) {
-          /*
-          if (isa<IREE::PIM::AllReduceOp>(op)) {
-            comm_flag.push_back(0);
-            comm_flag.push_back(1);
+    SymbolTable symbolTable(innerModule);
+    SmallVector<StringRef, 8> entryPointNames;
+    for (auto exportOp : variantOp.getOps<IREE::HAL::ExecutableExportOp>()) {
+      entryPointNames.emplace_back(exportOp.getSymName());
+      entry_code_offsets.push_back(code.size());
+      entry_binding_offsets.push_back(binding_ranks.size());
+      auto funcOp = symbolTable.lookup<func::FuncOp>(exportOp.getSymName());
+      if (!funcOp) continue;
+      bool entry_has_operand_slots = false;
+      funcOp.walk([/*&cmd_creator,*/ &code, &dims, &out_dim, &comm_flag,
+                   &operand_offsets, &operand_slots,
+                   &entry_has_operand_slots](mlir::Operation *op) {
+        size_t code_size = code.size();
+        size_t dims_size = dims.size();
+        size_t comm_flag_size = comm_flag.size();
+        GenOpCommand(op, /*cmd_creator,*/ code, dims, comm_flag);
+        if (code.size() == code_size) return;
+        if (clRemarks) {
+          EmitInstructionRemark(op, code.back(),
+                                ArrayRef<int32_t>(dims).drop_front(dims_size),
+                                comm_flag.size() != comm_flag_size
+                                    ? comm_flag.back() >> 32
+                                    : 0);
+        }
+        operand_offsets.push_back(operand_slots.size());
+        if (auto slots =
+                op->getAttrOfType<DenseI32ArrayAttr>("pim.operand_slots")) {
+          entry_has_operand_slots = true;
+          operand_slots.insert(operand_slots.end(), slots.asArrayRef().begin(),
+                               slots.asArrayRef().end());
+        }
+      });
+
+      // Every instruction of a program needs at least its result slot.
+      if (entry_has_operand_slots) {
+        for (size_t i = entry_code_offsets.back(); i < code.size(); ++i) {
+          size_t end = i + 1 < code.size() ? operand_offsets[i + 1]
+                                           : operand_slots.size();
+          if (operand_offsets[i] == end) {
+            return exportOp.emitError()
+                   << "PIM instruction " << i - entry_code_offsets.back()
+                   << " of a multi-instruction program has no operand slots";
           }
-          else if (isa<IREE::PIM::AllGatherOp>(op)) {
-            comm_flag.push_back(1);
-            comm_flag.push_back(1);
-          }*/
-          GenOpCommand(op, /*cmd_creator,*/ code);
-        });
+        }
+        has_operand_slots = true;
+      }
+      size_t binding_base = binding_ranks.size();
+      GenBindingShapes(funcOp, binding_ranks, binding_dims, binding_types);
+      auto views =
+          funcOp->getAttrOfType<DenseI32ArrayAttr>("pim.binding_views");
+      if (views && static_cast<size_t>(views.size()) <
+                       2 * (binding_ranks.size() - binding_base)) {
+        return exportOp.emitError()
+               << "PIM binding views do not cover the "
+               << binding_ranks.size() - binding_base << " bindings";
+      }
+      has_binding_views |= views != nullptr;
+      for (size_t i = 0; i < binding_ranks.size() - binding_base; ++i) {
+        binding_sources.push_back(views ? views[2 * i]
+                                        : static_cast<uint32_t>(i));
+        binding_offsets.push_back(views ? views[2 * i + 1] : 0);
       }
     }
-    /*
-    if (comm_flag.size() == 0) {
-      comm_flag.push_back(2);
-      comm_flag.push_back(2);
+    entry_code_offsets.push_back(code.size());
+    entry_binding_offsets.push_back(binding_ranks.size());
+    if (clRemarks) {
+      mlir::emitRemark(variantOp.getLoc())
+          << "PIM executable " << variantOp.getSymName() << ": "
+          << code.size() << " instructions, " << comm_flag.size()
+          << " sync points, " << dims.size() << " dims";
     }
-    llvm::outs() << "PIMTarget.cpp: comm_flag size: " << comm_flag.size() << "\n";
-    for (uint64_t i: comm_flag)
-      llvm::outs() << "PIMTarget.cpp: comm_flag data: " << i << "\n";
-    */
-    llvm::outs() <<"PIMTarget.cpp: Generated from op command stream (bit) : \n";
-    for (uint64_t i: code)
-      std::cout << std::bitset<64>(i) << '\n';
-    llvm::outs() << "\n";
-    llvm::outs() << "PIMTarget.cpp: code size: " << code.size() << "\n";
+    LLVM_DEBUG({
+      llvm::dbgs() << "PIMTarget.cpp: Generated from op command stream (bit) : \n";
+      for (uint64_t i: code)
+        llvm::dbgs() << std::bitset<64>(i).to_string() << '\n';
+      llvm::dbgs() << "\n";
+      llvm::dbgs() << "PIMTarget.cpp: code size: " << code.size() << "\n";
+    });
+    operand_offsets.push_back(operand_slots.size());
 
-    // Get entryPointNames
-    SmallVector<StringRef, 8> entryPointNames;
-    for (auto exportOp : variantOp.getOps<IREE::HAL::ExecutableExportOp>()) {
-      entryPointNames.emplace_back(exportOp.getSymName());
-    }
-    
     FlatbufferBuilder builder;
     iree_PIMExecutableDef_start_as_root(builder);
 
@@ -201,16 +506,87 @@ class PIMTargetBackend final : public TargetBackend {
         builder, code.data(),
         code.size());
 
-    /*
-    auto commFlagRef = flatbuffers_uint64_vec_create(
-        builder, comm_flag.data(),
-        comm_flag.size());*/
+    flatbuffers_uint64_vec_ref_t commFlagRef = 0;
+    if (!comm_flag.empty()) {
+      commFlagRef = flatbuffers_uint64_vec_create(builder, comm_flag.data(),
+                                                  comm_flag.size());
+    }
 
     auto entryPointsRef = builder.createStringVec(entryPointNames);
 
+    auto dimsRef = flatbuffers_int32_vec_create(builder, dims.data(),
+                                                dims.size());
+
+    flatbuffers_uint32_vec_ref_t operandOffsetsRef = 0;
+    flatbuffers_int32_vec_ref_t operandSlotsRef = 0;
+    if (has_operand_slots) {
+      operandOffsetsRef = flatbuffers_uint32_vec_create(
+          builder, operand_offsets.data(), operand_offsets.size());
+      operandSlotsRef = flatbuffers_int32_vec_create(
+          builder, operand_slots.data(), operand_slots.size());
+    }
+
+    flatbuffers_uint8_vec_ref_t bindingRanksRef = 0;
+    flatbuffers_int32_vec_ref_t bindingDimsRef = 0;
+    if (!binding_ranks.empty()) {
+      bindingRanksRef = flatbuffers_uint8_vec_create(
+          builder, binding_ranks.data(), binding_ranks.size());
+      bindingDimsRef = flatbuffers_int32_vec_create(
+          builder, binding_dims.data(), binding_dims.size());
+    }
+
+    // Executables with a single entry point omit its ranges.
+    flatbuffers_uint32_vec_ref_t entryCodeOffsetsRef = 0;
+    flatbuffers_uint32_vec_ref_t entryBindingOffsetsRef = 0;
+    if (entryPointNames.size() > 1) {
+      entryCodeOffsetsRef = flatbuffers_uint32_vec_create(
+          builder, entry_code_offsets.data(), entry_code_offsets.size());
+      entryBindingOffsetsRef = flatbuffers_uint32_vec_create(
+          builder, entry_binding_offsets.data(), entry_binding_offsets.size());
+    }
+
+    // Executables without fused bindings omit the views.
+    flatbuffers_uint32_vec_ref_t bindingSourcesRef = 0;
+    flatbuffers_int32_vec_ref_t bindingOffsetsRef = 0;
+    if (has_binding_views) {
+      bindingSourcesRef = flatbuffers_uint32_vec_create(
+          builder, binding_sources.data(), binding_sources.size());
+      bindingOffsetsRef = flatbuffers_int32_vec_create(
+          builder, binding_offsets.data(), binding_offsets.size());
+    }
+
+    // Executables with only f32 bindings omit the types.
+    flatbuffers_uint8_vec_ref_t bindingTypesRef = 0;
+    if (llvm::any_of(binding_types, [](uint8_t type) { return type != 0; })) {
+      bindingTypesRef = flatbuffers_uint8_vec_create(
+          builder, binding_types.data(), binding_types.size());
+    }
+
     iree_PIMExecutableDef_entry_points_add(builder, entryPointsRef);
     iree_PIMExecutableDef_code_add(builder, codeRef);
-    // iree_PIMExecutableDef_comm_flag_add(builder, commFlagRef);
+    iree_PIMExecutableDef_dims_add(builder, dimsRef);
+    if (has_operand_slots) {
+      iree_PIMExecutableDef_operand_offsets_add(builder, operandOffsetsRef);
+      iree_PIMExecutableDef_operand_slots_add(builder, operandSlotsRef);
+    }
+    if (commFlagRef) iree_PIMExecutableDef_comm_flag_add(builder, commFlagRef);
+    if (bindingRanksRef) {
+      iree_PIMExecutableDef_binding_ranks_add(builder, bindingRanksRef);
+      iree_PIMExecutableDef_binding_dims_add(builder, bindingDimsRef);
+    }
+    if (bindingTypesRef) {
+      iree_PIMExecutableDef_binding_types_add(builder, bindingTypesRef);
+    }
+    if (bindingSourcesRef) {
+      iree_PIMExecutableDef_binding_sources_add(builder, bindingSourcesRef);
+      iree_PIMExecutableDef_binding_offsets_add(builder, bindingOffsetsRef);
+    }
+    if (entryCodeOffsetsRef) {
+      iree_PIMExecutableDef_entry_code_offsets_add(builder,
+                                                   entryCodeOffsetsRef);
+      iree_PIMExecutableDef_entry_binding_offsets_add(builder,
+                                                      entryBindingOffsetsRef);
+    }
     iree_PIMExecutableDef_end_as_root(builder);
 
     // Add the binary data to the target executable.
@@ -239,13 +615,30 @@ class PIMTargetBackend final : public TargetBackend {
     Builder b(context);
     SmallVector<NamedAttribute> configItems;
     // Add some configurations to the `hal.executable.target` attribute.
-    /*
     auto addConfig = [&](StringRef name, Attribute value) {
       configItems.emplace_back(StringAttr::get(context, name), value);
     };
-    */
-    // Set target arch
-    // addConfig("target_arch", StringAttr::get(context, clTargetChip));
+    addConfig("num_device", b.getI64IntegerAttr(clDeviceCount));
+    addConfig("bank_count", b.getI64IntegerAttr(clBankCount));
+    addConfig("row_buffer_bytes", b.getI64IntegerAttr(clRowBufferBytes));
+    addConfig("device_capacity_bytes",
+              b.getI64IntegerAttr(clDeviceCapacityBytes));
+    if (clPartitionSearch) addConfig("partition_search", b.getBoolAttr(true));
+    // All element types are supported unless restricted.
+    if (!clElementTypes.empty()) {
+      SmallVector<Attribute> elementTypes;
+      for (const std::string &type : clElementTypes) {
+        elementTypes.push_back(b.getStringAttr(type));
+      }
+      addConfig("element_types", b.getArrayAttr(elementTypes));
+    }
+    if (!clHostLayers.empty()) {
+      SmallVector<Attribute> hostLayers;
+      for (const std::string &layer : clHostLayers) {
+        hostLayers.push_back(b.getStringAttr(layer));
+      }
+      addConfig("host_layers", b.getArrayAttr(hostLayers));
+    }
 
     auto configAttr = b.getDictionaryAttr(configItems);
     return IREE::HAL::ExecutableTargetAttr::get(
@@ -33,6 +33,13 @@ void TargetOptions::bindOptions(OptionsBinder &binder) {
       llvm::cl::desc("Target backends for executable compilation."),
       llvm::cl::ZeroOrMore, llvm::cl::cat(halTargetOptionsCategory));
 
+  binder.list<std::string>(
+      "iree-hal-fallback-target-backends", fallbackTargets,
+      llvm::cl::desc("Target backends compiling a fallback variant of each "
+                     "executable for dispatches the target devices can't "
+                     "lower (such as llvm-cpu for pim)."),
+      llvm::cl::ZeroOrMore, llvm::cl::cat(halTargetOptionsCategory));
+
   binder.opt<int>(
       "iree-hal-executable-debug-level", debugLevel,
       llvm::cl::desc("Debug level for executable translation (0-3)"),
@@ -61,6 +68,18 @@ void TargetOptions::bindOptions(OptionsBinder &binder) {
       llvm::cl::desc(
           "Path to write translated and serialized executable binaries into."),
       llvm::cl::cat(halTargetOptionsCategory));
+
+  binder.opt<std::string>(
+      "iree-hal-executable-translation-cache-dir",
+      executableTranslationCachePath,
+      llvm::cl::desc(
+          "Directory caching translated executables across compilations. "
+          "Executables with unchanged IR and translation pipelines skip "
+          "codegen. Flags that are not reflected in the executable target "
+          "or pass pipeline are not part of the cache key: use a separate "
+          "directory per such configuration and clear it when updating the "
+          "compiler."),
+      llvm::cl::cat(halTargetOptionsCategory));
 }
 
 void dumpDataToPath(StringRef path, StringRef baseName, StringRef suffix,
@@ -31,6 +31,10 @@ struct TargetOptions {
   // TODO(benvanik): multiple targets of the same type, etc.
   std::vector<std::string> targets;
 
+  // Target backends whose executables are added to every target device as
+  // fallbacks for dispatches the device backend marks unsupported.
+  std::vector<std::string> fallbackTargets;
+
   // Coarse debug level for executable translation across all targets.
   // Each target backend can use this to control its own flags, with values
   // generally corresponding to the gcc-style levels 0-3:
@@ -52,6 +56,11 @@ struct TargetOptions {
   // A path to write translated and serialized executable binaries into.
   std::string executableBinariesPath;
 
+  // A directory caching translated executable variants across compilations.
+  // Variants whose IR and translation pipeline are unchanged reuse the cached
+  // result instead of being translated again.
+  std::string executableTranslationCachePath;
+
   void bindOptions(OptionsBinder &binder);
   using FromFlags = OptionsFromFlags<TargetOptions>;
 };
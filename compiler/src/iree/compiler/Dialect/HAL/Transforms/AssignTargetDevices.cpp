@@ -31,8 +31,10 @@ class AssignTargetDevicesPass
  public:
   AssignTargetDevicesPass() = default;
   AssignTargetDevicesPass(const AssignTargetDevicesPass &pass) {}
-  AssignTargetDevicesPass(ArrayRef<std::string> targets) {
+  AssignTargetDevicesPass(ArrayRef<std::string> targets,
+                          ArrayRef<std::string> fallbackTargets) {
     this->targets = targets;
+    this->fallbackTargets = fallbackTargets;
   }
 
   void getDependentDialects(DialectRegistry &registry) const override {
@@ -72,43 +74,98 @@ class AssignTargetDevicesPass
       return;
     }
 
-    SmallVector<Attribute> targetAttrs;
+    SmallVector<IREE::HAL::DeviceTargetAttr> targetAttrs;
     for (const auto &targetName : targets) {
-      auto targetBackend = getTargetBackend(targetName);
-      if (!targetBackend) {
-        std::string backends;
-        llvm::raw_string_ostream os(backends);
-        llvm::interleaveComma(
-            getTargetBackends(getRegisteredTargetBackends()), os,
-            [&os](const std::shared_ptr<
-                  mlir::iree_compiler::IREE::HAL::TargetBackend>
-                      b) { os << b->name(); });
-        emitError(moduleOp.getLoc())
-            << "target backend '" << targetName
-            << "' not registered; registered backends: " << os.str();
-        signalPassFailure();
-        return;
-      }
-
-      // Ask the target backend for its default device specification attribute.
-      auto targetAttr =
-          targetBackend->getDefaultDeviceTarget(moduleOp.getContext());
+      auto targetAttr = getDefaultDeviceTarget(moduleOp, targetName);
+      if (!targetAttr) return signalPassFailure();
       targetAttrs.push_back(targetAttr);
     }
 
+    // Fallback executable targets are appended to those of each device so
+    // that the device variants are preferred at runtime. A variant the device
+    // backend can't lower is dropped during translation and its dispatches
+    // select the fallback variant instead (see TranslateExecutables). The
+    // runtime device must be able to load the fallback format.
+    SmallVector<Attribute> fallbackAttrs;
+    for (const auto &targetName : fallbackTargets) {
+      auto targetAttr = getDefaultDeviceTarget(moduleOp, targetName);
+      if (!targetAttr) return signalPassFailure();
+      for (auto executableTargetAttr : targetAttr.getExecutableTargets()) {
+        fallbackAttrs.push_back(executableTargetAttr);
+      }
+    }
+
+    SmallVector<Attribute> deviceAttrs;
+    for (auto targetAttr : targetAttrs) {
+      deviceAttrs.push_back(appendExecutableTargets(targetAttr, fallbackAttrs));
+    }
     moduleOp->setAttr("hal.device.targets",
-                      ArrayAttr::get(moduleOp.getContext(), targetAttrs));
+                      ArrayAttr::get(moduleOp.getContext(), deviceAttrs));
   }
 
  private:
+  // Returns the default device target of the backend |targetName| or null
+  // after emitting an error if it is not registered.
+  IREE::HAL::DeviceTargetAttr getDefaultDeviceTarget(
+      ModuleOp moduleOp, StringRef targetName) {
+    auto targetBackend = getTargetBackend(targetName);
+    if (!targetBackend) {
+      std::string backends;
+      llvm::raw_string_ostream os(backends);
+      llvm::interleaveComma(
+          getTargetBackends(getRegisteredTargetBackends()), os,
+          [&os](const std::shared_ptr<
+                mlir::iree_compiler::IREE::HAL::TargetBackend>
+                    b) { os << b->name(); });
+      emitError(moduleOp.getLoc())
+          << "target backend '" << targetName
+          << "' not registered; registered backends: " << os.str();
+      return {};
+    }
+
+    // Ask the target backend for its default device specification attribute.
+    return targetBackend->getDefaultDeviceTarget(moduleOp.getContext());
+  }
+
+  // Returns |targetAttr| with |executableTargetAttrs| appended to its
+  // executable targets, skipping those it already has.
+  IREE::HAL::DeviceTargetAttr appendExecutableTargets(
+      IREE::HAL::DeviceTargetAttr targetAttr,
+      ArrayRef<Attribute> executableTargetAttrs) {
+    if (executableTargetAttrs.empty()) return targetAttr;
+    SmallVector<Attribute> allAttrs;
+    for (auto executableTargetAttr : targetAttr.getExecutableTargets()) {
+      allAttrs.push_back(executableTargetAttr);
+    }
+    for (auto executableTargetAttr : executableTargetAttrs) {
+      if (!llvm::is_contained(allAttrs, executableTargetAttr)) {
+        allAttrs.push_back(executableTargetAttr);
+      }
+    }
+    auto *context = targetAttr.getContext();
+    NamedAttrList configItems;
+    if (auto configAttr = targetAttr.getConfiguration()) {
+      configItems.assign(configAttr.getValue());
+    }
+    configItems.set("executable_targets", ArrayAttr::get(context, allAttrs));
+    return IREE::HAL::DeviceTargetAttr::get(
+        context, targetAttr.getDeviceID(),
+        configItems.getDictionary(context));
+  }
+
   ListOption<std::string> targets{*this, "targets",
                                   llvm::cl::desc("List of devices to target."),
                                   llvm::cl::ZeroOrMore};
+  ListOption<std::string> fallbackTargets{
+      *this, "fallback-targets",
+      llvm::cl::desc("List of backends providing fallback executables for "
+                     "dispatches the devices can't lower."),
+      llvm::cl::ZeroOrMore};
 };
 
 std::unique_ptr<OperationPass<ModuleOp>> createAssignTargetDevicesPass(
-    ArrayRef<std::string> targets) {
-  return std::make_unique<AssignTargetDevicesPass>(targets);
+    ArrayRef<std::string> targets, ArrayRef<std::string> fallbackTargets) {
+  return std::make_unique<AssignTargetDevicesPass>(targets, fallbackTargets);
 }
 
 static PassRegistration<AssignTargetDevicesPass> pass([] {
@@ -0,0 +1,293 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <optional>
+#include <utility>
+
+#include "iree/compiler/Dialect/HAL/IR/HALDialect.h"
+#include "iree/compiler/Dialect/HAL/IR/HALOps.h"
+#include "iree/compiler/Dialect/HAL/Transforms/Passes.h"
+#include "iree/compiler/Dialect/Util/IR/UtilDialect.h"
+#include "iree/compiler/Dialect/Util/IR/UtilOps.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/TypeSwitch.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Pass/Pass.h"
+
+#define DEBUG_TYPE "iree-hal-batch-command-buffer-commands"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace HAL {
+namespace {
+
+// Opcodes of the packed command stream consumed by
+// hal.command_buffer.execute_commands_inline. Must match
+// iree_hal_module_inline_command_t in runtime/src/iree/modules/hal/module.c.
+enum class InlineCommand : int32_t {
+  Dispatch = 1,
+  PushConstants = 2,
+  PushDescriptorSet = 3,
+  ExecutionBarrier = 4,
+};
+
+// Operands referenced from the command stream by slot ordinal. Each unique
+// value is only passed once regardless of how many commands reference it.
+struct SlotList {
+  int32_t getSlot(Value value) {
+    auto it = slots.try_emplace(value, values.size());
+    if (it.second) values.push_back(value);
+    return it.first->second;
+  }
+
+  // Drops all values added after the first |count|.
+  void truncate(size_t count) {
+    for (size_t i = count; i < values.size(); ++i) slots.erase(values[i]);
+    values.resize(count);
+  }
+
+  SmallVector<Value> values;
+  DenseMap<Value, int32_t> slots;
+};
+
+// Accumulates the packed command stream of consecutive commands recorded into
+// a single command buffer along with the operands the stream references.
+class CommandStreamBuilder {
+ public:
+  explicit CommandStreamBuilder(Value commandBuffer)
+      : commandBuffer(commandBuffer) {}
+
+  Value getCommandBuffer() const { return commandBuffer; }
+
+  // Appends |op| to the stream and returns true if it can be encoded.
+  bool append(Operation *op) {
+    size_t wordCount = words.size();
+    size_t executableCount = executables.values.size();
+    size_t layoutCount = layouts.values.size();
+    size_t bufferCount = buffers.values.size();
+    size_t valueCount = values.values.size();
+    bool didEncode =
+        llvm::TypeSwitch<Operation *, bool>(op)
+            .Case<IREE::HAL::CommandBufferDispatchOp,
+                  IREE::HAL::CommandBufferPushConstantsOp,
+                  IREE::HAL::CommandBufferPushDescriptorSetOp,
+                  IREE::HAL::CommandBufferExecutionBarrierOp>(
+                [&](auto typedOp) { return encode(typedOp); })
+            .Default([](Operation *) { return false; });
+    if (!didEncode) {
+      // Roll back any partially encoded operands.
+      words.resize(wordCount);
+      executables.truncate(executableCount);
+      layouts.truncate(layoutCount);
+      buffers.truncate(bufferCount);
+      values.truncate(valueCount);
+      return false;
+    }
+    ops.push_back(op);
+    return true;
+  }
+
+  // Replaces the appended commands with a single batched command if there are
+  // enough of them to be worth it. The builder is reset.
+  void flush() {
+    if (ops.size() >= 2) replaceOps();
+    ops.clear();
+    words.clear();
+    executables = {};
+    layouts = {};
+    buffers = {};
+    values = {};
+  }
+
+ private:
+  bool encode(IREE::HAL::CommandBufferDispatchOp op) {
+    words.push_back(static_cast<int32_t>(InlineCommand::Dispatch));
+    words.push_back(executables.getSlot(op.getExecutable()));
+    words.push_back(op.getEntryPoint().getSExtValue());
+    words.push_back(values.getSlot(op.getWorkgroupX()));
+    words.push_back(values.getSlot(op.getWorkgroupY()));
+    words.push_back(values.getSlot(op.getWorkgroupZ()));
+    return true;
+  }
+
+  bool encode(IREE::HAL::CommandBufferPushConstantsOp op) {
+    words.push_back(static_cast<int32_t>(InlineCommand::PushConstants));
+    words.push_back(layouts.getSlot(op.getPipelineLayout()));
+    words.push_back(op.getOffset().getSExtValue());
+    words.push_back(op.getValues().size());
+    for (auto value : op.getValues()) words.push_back(values.getSlot(value));
+    return true;
+  }
+
+  bool encode(IREE::HAL::CommandBufferPushDescriptorSetOp op) {
+    // The set and binding ordinals are encoded as literals so they must be
+    // constant and bindings referencing the binding table aren't supported.
+    APInt set;
+    if (!matchPattern(op.getSet(), m_ConstantInt(&set))) return false;
+    words.push_back(static_cast<int32_t>(InlineCommand::PushDescriptorSet));
+    words.push_back(layouts.getSlot(op.getPipelineLayout()));
+    words.push_back(set.getSExtValue());
+    words.push_back(op.getBindingOrdinals().size());
+    for (auto [ordinalValue, buffer, offset, length] :
+         llvm::zip_equal(op.getBindingOrdinals(), op.getBindingBuffers(),
+                         op.getBindingOffsets(), op.getBindingLengths())) {
+      APInt ordinal;
+      if (!matchPattern(ordinalValue, m_ConstantInt(&ordinal))) return false;
+      if (!buffer.getType().isa<IREE::HAL::BufferType>()) return false;
+      words.push_back(ordinal.getSExtValue());
+      words.push_back(buffers.getSlot(buffer));
+      words.push_back(values.getSlot(offset));
+      words.push_back(values.getSlot(length));
+    }
+    return true;
+  }
+
+  bool encode(IREE::HAL::CommandBufferExecutionBarrierOp op) {
+    words.push_back(static_cast<int32_t>(InlineCommand::ExecutionBarrier));
+    words.push_back(static_cast<int32_t>(op.getSourceStageMask()));
+    words.push_back(static_cast<int32_t>(op.getTargetStageMask()));
+    words.push_back(static_cast<int32_t>(op.getFlags()));
+    return true;
+  }
+
+  void replaceOps() {
+    Operation *lastOp = ops.back();
+    auto loc = FusedLoc::get(
+        lastOp->getContext(),
+        llvm::to_vector(llvm::map_range(
+            ops, [](Operation *op) -> Location { return op->getLoc(); })));
+
+    // All operands dominate the last op as they dominate their users.
+    OpBuilder builder(lastOp->getContext());
+    builder.setInsertionPointAfter(lastOp);
+    auto commandsAttr = DenseIntElementsAttr::get(
+        RankedTensorType::get({static_cast<int64_t>(words.size())},
+                              builder.getI32Type()),
+        ArrayRef<int32_t>(words));
+    Value commands = builder.create<IREE::Util::BufferConstantOp>(
+        loc, /*name=*/nullptr, commandsAttr,
+        builder.getIndexAttr(sizeof(int32_t)), /*mimeType=*/nullptr);
+
+    auto i64Type = builder.getI64Type();
+    SmallVector<Value> i64Values;
+    i64Values.reserve(values.values.size());
+    for (auto value : values.values) {
+      if (value.getType().isIndex()) {
+        value = builder.create<arith::IndexCastUIOp>(loc, i64Type, value);
+      } else if (value.getType() != i64Type) {
+        // Push constants are opaque 32-bit values.
+        value = builder.create<arith::ExtUIOp>(loc, i64Type, value);
+      }
+      i64Values.push_back(value);
+    }
+
+    builder.create<IREE::HAL::CommandBufferExecuteCommandsInlineOp>(
+        loc, commandBuffer, commands, executables.values, layouts.values,
+        buffers.values, i64Values);
+    LLVM_DEBUG(llvm::dbgs() << "batched " << ops.size() << " commands into "
+                            << words.size() << " words\n");
+    for (auto *op : ops) op->erase();
+  }
+
+  Value commandBuffer;
+  SmallVector<Operation *> ops;
+  SmallVector<int32_t> words;
+  SlotList executables;
+  SlotList layouts;
+  SlotList buffers;
+  SlotList values;
+};
+
+static bool isBatchableOp(Operation *op) {
+  return isa<IREE::HAL::CommandBufferDispatchOp,
+             IREE::HAL::CommandBufferPushConstantsOp,
+             IREE::HAL::CommandBufferPushDescriptorSetOp,
+             IREE::HAL::CommandBufferExecutionBarrierOp>(op);
+}
+
+// Returns true if |op| can't observe or modify command buffer state and may
+// be interleaved with batched commands.
+static bool isReadOnlyOp(Operation *op) {
+  if (op->getNumRegions() != 0) return false;
+  auto effectInterface = dyn_cast<MemoryEffectOpInterface>(op);
+  if (!effectInterface) return false;
+  SmallVector<MemoryEffects::EffectInstance> effects;
+  effectInterface.getEffects(effects);
+  return llvm::all_of(effects, [](MemoryEffects::EffectInstance &effect) {
+    return isa<MemoryEffects::Read>(effect.getEffect());
+  });
+}
+
+// Batches runs of commands recorded into the same command buffer within
+// |block|. Read-only ops (such as loads of cached executables) may be
+// interleaved with the commands but any other op ends the run.
+static void batchCommandsInBlock(Block &block) {
+  std::optional<CommandStreamBuilder> streamBuilder;
+  auto flush = [&]() {
+    if (streamBuilder) streamBuilder->flush();
+    streamBuilder.reset();
+  };
+  for (auto &op : llvm::make_early_inc_range(block)) {
+    if (isBatchableOp(&op)) {
+      Value commandBuffer = op.getOperand(0);
+      if (streamBuilder && streamBuilder->getCommandBuffer() == commandBuffer &&
+          streamBuilder->append(&op)) {
+        continue;
+      }
+      flush();
+      streamBuilder.emplace(commandBuffer);
+      if (!streamBuilder->append(&op)) streamBuilder.reset();
+      continue;
+    }
+    if (isReadOnlyOp(&op)) continue;
+    flush();
+  }
+  flush();
+}
+
+class BatchCommandBufferCommandsPass
+    : public PassWrapper<BatchCommandBufferCommandsPass, OperationPass<void>> {
+ public:
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<mlir::arith::ArithDialect>();
+    registry.insert<IREE::HAL::HALDialect>();
+    registry.insert<IREE::Util::UtilDialect>();
+  }
+
+  StringRef getArgument() const override {
+    return "iree-hal-batch-command-buffer-commands";
+  }
+
+  StringRef getDescription() const override {
+    return "Batches sequences of command buffer recording ops into packed "
+           "command streams recorded with a single operation.";
+  }
+
+  void runOnOperation() override {
+    for (auto &region : getOperation()->getRegions()) {
+      for (auto &block : region) batchCommandsInBlock(block);
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<OperationPass<void>> createBatchCommandBufferCommandsPass() {
+  return std::make_unique<BatchCommandBufferCommandsPass>();
+}
+
+static PassRegistration<BatchCommandBufferCommandsPass> pass;
+
+}  // namespace HAL
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -6,8 +6,10 @@
 
 #include "iree/compiler/Dialect/HAL/IR/HALOps.h"
 #include "iree/compiler/Dialect/HAL/Transforms/Passes.h"
+#include "llvm/ADT/StringSet.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinTypes.h"
@@ -20,10 +22,10 @@ namespace IREE {
 namespace HAL {
 
 // Marks a command buffer as being executable inline during recording.
-// This is only possible because we generate our command buffer code without
-// caching today and know that all are executable inline so long as we have
-// blocking queue operations. As soon as we memoize command buffers this will be
-// invalid.
+// This is only possible because one-shot command buffers are recorded right
+// before they are submitted and are executable inline so long as we have
+// blocking queue operations. Memoized command buffers are reusable and are
+// never marked.
 static void makeAllowInlineExecution(IREE::HAL::CommandBufferCreateOp op) {
   auto modes = op.getModes();
   if (bitEnumContainsAll(modes,
@@ -46,9 +48,14 @@ static void makeAllowInlineExecution(IREE::HAL::CommandBufferCreateOp op) {
 //   hal.device.queue.execute wait(%wait_fence) signal(%signal_fence)
 //   // no wait inserted on %signal_fence as present following:
 //   hal.fence.await until([%signal_fence])  // existing
-static void insertWaitIfNeeded(Operation *asyncOp,
+//
+// If |legacyMatchAttrs| is not empty the inserted waits are guarded by the
+// device matching any of them so that modules targeting both legacy and modern
+// devices only block on the legacy ones.
+static void insertWaitIfNeeded(Operation *asyncOp, Value device,
                                MutableOperandRange waitFence,
-                               Value signalFence) {
+                               Value signalFence,
+                               ArrayRef<Attribute> legacyMatchAttrs) {
   assert(waitFence.size() == 1 && "one wait fence expected");
   auto loc = asyncOp->getLoc();
 
@@ -112,27 +119,90 @@ static void insertWaitIfNeeded(Operation *asyncOp,
 
   // Scan backward to see if the wait fences have been signaled already.
   // Since we walk the regions forward we will likely have a wait from the
-  // producer already.
+  // producer already. Scan forward to see if the signal fences are waited on
+  // already. Both scans happen before anything is inserted as the device
+  // queries can't be reordered.
   auto *precedingAwait = findPrecedingAwait(waitFence[0]);
-  if (!precedingAwait) {
-    builder.create<IREE::HAL::FenceAwaitOp>(
-        loc, builder.getI32Type(), makeInfiniteTimeout(), waitFence[0]);
+  auto *succeedingAwait = findSucceedingAwait(signalFence);
+  if (precedingAwait && succeedingAwait &&
+      isa_and_nonnull<IREE::Util::NullOp>(waitFence[0].getDefiningOp())) {
+    return;
   }
+
+  // Query whether the device is one of the legacy ones, if needed.
+  Value isLegacyDevice;
+  for (auto matchAttr : legacyMatchAttrs) {
+    Value isMatch = matchAttr.cast<IREE::HAL::MatchAttrInterface>()
+                        .buildConditionExpression(loc, device, builder);
+    isLegacyDevice = isLegacyDevice ? builder.create<arith::OrIOp>(
+                                          loc, isLegacyDevice, isMatch)
+                                    : isMatch;
+  }
+  auto createAwait = [&](Value fence) {
+    if (!isLegacyDevice) {
+      builder.create<IREE::HAL::FenceAwaitOp>(
+          loc, builder.getI32Type(), makeInfiniteTimeout(), fence);
+      return;
+    }
+    Value timeout = makeInfiniteTimeout();
+    auto ifOp = builder.create<scf::IfOp>(loc, isLegacyDevice,
+                                          /*withElseRegion=*/false);
+    auto thenBuilder = ifOp.getThenBodyBuilder();
+    thenBuilder.create<IREE::HAL::FenceAwaitOp>(loc, builder.getI32Type(),
+                                                timeout, fence);
+  };
+
+  if (!precedingAwait) createAwait(waitFence[0]);
   if (!isa_and_nonnull<IREE::Util::NullOp>(waitFence[0].getDefiningOp())) {
     // Neuter wait because it's either covered (we found a preceding await) or
-    // we just inserted one.
+    // we just inserted one. Guarded waits only cover legacy devices and the
+    // others keep waiting on the queue.
     Value nullFence = builder.create<IREE::Util::NullOp>(
         loc, builder.getType<IREE::HAL::FenceType>());
+    if (!precedingAwait && isLegacyDevice) {
+      nullFence = builder.create<arith::SelectOp>(loc, isLegacyDevice,
+                                                  nullFence, waitFence[0]);
+    }
     waitFence.assign(nullFence);
   }
 
-  // Scan forward to see if the signal fences are waited on already.
-  auto *succeedingAwait = findSucceedingAwait(signalFence);
   if (!succeedingAwait) {
     builder.setInsertionPointAfter(asyncOp);
-    builder.create<IREE::HAL::FenceAwaitOp>(loc, builder.getI32Type(),
-                                            makeInfiniteTimeout(), signalFence);
+    createAwait(signalFence);
+  }
+}
+
+// Returns the match expressions of the executable formats only loadable by
+// devices requiring legacy_sync. Empty if all devices require it or the legacy
+// devices can't be told apart at runtime, in which case the fixups must apply
+// to all of them.
+static SmallVector<Attribute> getLegacyDeviceMatchAttrs(
+    ArrayRef<IREE::HAL::DeviceTargetAttr> deviceTargetAttrs) {
+  llvm::StringSet<> modernFormats;
+  for (auto deviceTargetAttr : deviceTargetAttrs) {
+    if (deviceTargetAttr.hasConfigurationAttr("legacy_sync")) continue;
+    for (auto targetAttr : deviceTargetAttr.getExecutableTargets()) {
+      modernFormats.insert(targetAttr.getFormat().getValue());
+    }
+  }
+  if (modernFormats.empty()) return {};
+
+  SmallVector<Attribute> matchAttrs;
+  llvm::StringSet<> legacyFormats;
+  for (auto deviceTargetAttr : deviceTargetAttrs) {
+    if (!deviceTargetAttr.hasConfigurationAttr("legacy_sync")) continue;
+    bool hasLegacyFormat = false;
+    for (auto targetAttr : deviceTargetAttr.getExecutableTargets()) {
+      StringRef format = targetAttr.getFormat().getValue();
+      if (modernFormats.contains(format)) continue;
+      hasLegacyFormat = true;
+      if (legacyFormats.insert(format).second) {
+        matchAttrs.push_back(targetAttr.getMatchExpression());
+      }
+    }
+    if (!hasLegacyFormat) return {};
   }
+  return matchAttrs;
 }
 
 // NOTE: this pass only exists for backwards compatibility with legacy HAL
@@ -148,6 +218,10 @@ struct FixupLegacySyncPass
            "that only support synchronous execution";
   }
 
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<arith::ArithDialect, scf::SCFDialect>();
+  }
+
   void runOnOperation() override {
     auto moduleOp = getOperation();
 
@@ -163,6 +237,10 @@ struct FixupLegacySyncPass
     }
     if (!anyRequireFixup) return;
 
+    // Modules compiled for both legacy and modern devices (such as pim and
+    // llvm-cpu) select the blocking behavior at runtime based on the device.
+    auto legacyMatchAttrs = getLegacyDeviceMatchAttrs(deviceTargetAttrs);
+
     // This could use an interface but it'd be better to remove the need for
     // this pass instead.
     for (auto funcOp : moduleOp.getOps<FunctionOpInterface>()) {
@@ -172,16 +250,16 @@ struct FixupLegacySyncPass
               makeAllowInlineExecution(op);
             })
             .Case([&](IREE::HAL::DeviceQueueAllocaOp op) {
-              insertWaitIfNeeded(op, op.getWaitFenceMutable(),
-                                 op.getSignalFence());
+              insertWaitIfNeeded(op, op.getDevice(), op.getWaitFenceMutable(),
+                                 op.getSignalFence(), legacyMatchAttrs);
             })
             .Case([&](IREE::HAL::DeviceQueueDeallocaOp op) {
-              insertWaitIfNeeded(op, op.getWaitFenceMutable(),
-                                 op.getSignalFence());
+              insertWaitIfNeeded(op, op.getDevice(), op.getWaitFenceMutable(),
+                                 op.getSignalFence(), legacyMatchAttrs);
             })
             .Case([&](IREE::HAL::DeviceQueueExecuteOp op) {
-              insertWaitIfNeeded(op, op.getWaitFenceMutable(),
-                                 op.getSignalFence());
+              insertWaitIfNeeded(op, op.getDevice(), op.getWaitFenceMutable(),
+                                 op.getSignalFence(), legacyMatchAttrs);
             });
       });
     }
@@ -0,0 +1,243 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <utility>
+
+#include "iree/compiler/Dialect/HAL/IR/HALDialect.h"
+#include "iree/compiler/Dialect/HAL/IR/HALOps.h"
+#include "iree/compiler/Dialect/HAL/Transforms/Passes.h"
+#include "iree/compiler/Dialect/Util/IR/UtilDialect.h"
+#include "iree/compiler/Dialect/Util/IR/UtilOps.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Pass/Pass.h"
+
+#define DEBUG_TYPE "iree-hal-memoize-command-buffers"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace HAL {
+namespace {
+
+// Tracks which values can be computed once during module initialization.
+class StaticValueAnalysis {
+ public:
+  explicit StaticValueAnalysis(SymbolTable &symbolTable)
+      : symbolTable(symbolTable) {}
+
+  // Returns true if |value| is a constant, a load of an immutable global, or a
+  // side-effect free computation of only those.
+  bool isStatic(Value value) {
+    auto it = cache.find(value);
+    if (it != cache.end()) return it->second;
+    // Conservatively treat cycles as dynamic while the value is evaluated.
+    cache[value] = false;
+    bool result = computeIsStatic(value);
+    cache[value] = result;
+    return result;
+  }
+
+ private:
+  bool computeIsStatic(Value value) {
+    Operation *op = value.getDefiningOp();
+    if (!op) return false;  // block arguments vary per invocation
+    if (op->hasTrait<OpTrait::ConstantLike>()) return true;
+    if (auto loadOp = dyn_cast<IREE::Util::GlobalLoadOpInterface>(op)) {
+      auto globalOp = symbolTable.lookup<IREE::Util::GlobalOpInterface>(
+          loadOp.getGlobalName());
+      return globalOp && !globalOp.isGlobalMutable();
+    }
+    if (op->getNumRegions() != 0 || !isMemoryEffectFree(op)) return false;
+    return llvm::all_of(op->getOperands(),
+                        [&](Value operand) { return isStatic(operand); });
+  }
+
+  SymbolTable &symbolTable;
+  DenseMap<Value, bool> cache;
+};
+
+// A command buffer whose entire recording can be hoisted.
+struct StaticCommandBuffer {
+  IREE::HAL::CommandBufferCreateOp createOp;
+  // All ops recording into the command buffer (including the finalize) in
+  // program order.
+  SmallVector<Operation *> recordingOps;
+};
+
+// Returns the recording of |createOp| if it only uses static values and the
+// command buffer is only recorded within its defining block.
+static Optional<StaticCommandBuffer> findStaticCommandBuffer(
+    IREE::HAL::CommandBufferCreateOp createOp,
+    StaticValueAnalysis &staticValues) {
+  // Nested command buffers are recorded with bindings from their parent and
+  // inline execution is only valid for one-shot command buffers executed
+  // immediately.
+  if (createOp.getBindingCapacity() ||
+      bitEnumContainsAny(createOp.getModes(),
+                         IREE::HAL::CommandBufferModeBitfield::Nested)) {
+    return std::nullopt;
+  }
+  if (!staticValues.isStatic(createOp.getDevice())) return std::nullopt;
+
+  StaticCommandBuffer result;
+  result.createOp = createOp;
+  Block *block = createOp->getBlock();
+  Value commandBuffer = createOp.getResult();
+  unsigned finalizeCount = 0;
+  for (auto &use : commandBuffer.getUses()) {
+    Operation *userOp = use.getOwner();
+    if (isa<IREE::HAL::DeviceQueueExecuteOp>(userOp)) continue;
+    // Only ops that record into the command buffer are hoisted; anything else
+    // (calls, queries, etc) may observe the command buffer mid-recording.
+    if (userOp->getBlock() != block || use.getOperandNumber() != 0 ||
+        userOp->getNumResults() != 0 ||
+        !userOp->getName().getStringRef().startswith("hal.command_buffer.")) {
+      return std::nullopt;
+    }
+    for (auto operand : userOp->getOperands().drop_front()) {
+      if (!staticValues.isStatic(operand)) return std::nullopt;
+    }
+    if (isa<IREE::HAL::CommandBufferFinalizeOp>(userOp)) ++finalizeCount;
+    result.recordingOps.push_back(userOp);
+  }
+  if (finalizeCount != 1) return std::nullopt;
+  llvm::sort(result.recordingOps, [](Operation *lhs, Operation *rhs) {
+    return lhs->isBeforeInBlock(rhs);
+  });
+  if (!isa<IREE::HAL::CommandBufferFinalizeOp>(result.recordingOps.back())) {
+    return std::nullopt;  // recording after finalize is invalid
+  }
+  return result;
+}
+
+// Clones |value| and the static values it is computed from with |builder|.
+static Value cloneStaticValue(Value value, OpBuilder &builder,
+                              IRMapping &mapping) {
+  if (auto mappedValue = mapping.lookupOrNull(value)) return mappedValue;
+  Operation *op = value.getDefiningOp();
+  assert(op && "static values are defined by ops");
+  for (auto operand : op->getOperands()) {
+    cloneStaticValue(operand, builder, mapping);
+  }
+  builder.clone(*op, mapping);
+  return mapping.lookup(value);
+}
+
+// Records |staticCommandBuffer| once in an initializer into a reusable command
+// buffer stored in a new global and replaces the original recording with a
+// load of the global.
+static void memoizeCommandBuffer(StaticCommandBuffer &staticCommandBuffer,
+                                 StringRef name, OpBuilder &moduleBuilder,
+                                 SymbolTable &symbolTable) {
+  auto createOp = staticCommandBuffer.createOp;
+  auto loc = createOp.getLoc();
+  auto commandBufferType = createOp.getResult().getType();
+
+  auto globalOp = moduleBuilder.create<IREE::Util::GlobalOp>(
+      loc, name, /*isMutable=*/false, commandBufferType);
+  globalOp.setPrivate();
+  symbolTable.insert(globalOp);
+
+  auto initializerOp = moduleBuilder.create<IREE::Util::InitializerOp>(loc);
+  auto initializerBuilder =
+      OpBuilder::atBlockBegin(initializerOp.addEntryBlock());
+  IRMapping mapping;
+  for (auto *op : staticCommandBuffer.recordingOps) {
+    for (auto operand : op->getOperands().drop_front()) {
+      cloneStaticValue(operand, initializerBuilder, mapping);
+    }
+  }
+
+  // The command buffer is submitted on every invocation so it can't be
+  // one-shot and can't execute inline while it is being recorded.
+  auto memoizedCommandBuffer =
+      initializerBuilder
+          .create<IREE::HAL::CommandBufferCreateOp>(
+              loc, commandBufferType,
+              cloneStaticValue(createOp.getDevice(), initializerBuilder,
+                               mapping),
+              IREE::HAL::CommandBufferModeBitfield::None,
+              createOp.getCommandCategories(), /*binding_capacity=*/Value{})
+          .getResult();
+  mapping.map(createOp.getResult(), memoizedCommandBuffer);
+  for (auto *op : staticCommandBuffer.recordingOps) {
+    initializerBuilder.clone(*op, mapping);
+  }
+  initializerBuilder.create<IREE::Util::GlobalStoreOp>(
+      loc, memoizedCommandBuffer, globalOp.getName());
+  initializerBuilder.create<IREE::Util::InitializerReturnOp>(loc);
+
+  OpBuilder replaceBuilder(createOp);
+  auto loadOp = replaceBuilder.create<IREE::Util::GlobalLoadOp>(loc, globalOp);
+  createOp.getResult().replaceAllUsesWith(loadOp.getResult());
+  for (auto *op : staticCommandBuffer.recordingOps) op->erase();
+  createOp.erase();
+}
+
+class MemoizeCommandBuffersPass
+    : public PassWrapper<MemoizeCommandBuffersPass, OperationPass<ModuleOp>> {
+ public:
+  StringRef getArgument() const override {
+    return "iree-hal-memoize-command-buffers";
+  }
+
+  StringRef getDescription() const override {
+    return "Records command buffers with static contents once at "
+           "initialization time and reuses them for all submissions";
+  }
+
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<IREE::HAL::HALDialect>();
+    registry.insert<IREE::Util::UtilDialect>();
+  }
+
+  void runOnOperation() override {
+    auto moduleOp = getOperation();
+    SymbolTable symbolTable(moduleOp);
+    StaticValueAnalysis staticValues(symbolTable);
+
+    // Only recordings performed on each invocation are interesting;
+    // initializers already run once.
+    SmallVector<StaticCommandBuffer> staticCommandBuffers;
+    for (auto funcOp : moduleOp.getOps<mlir::func::FuncOp>()) {
+      funcOp.walk([&](IREE::HAL::CommandBufferCreateOp createOp) {
+        if (auto staticCommandBuffer =
+                findStaticCommandBuffer(createOp, staticValues)) {
+          staticCommandBuffers.push_back(std::move(*staticCommandBuffer));
+        }
+      });
+    }
+
+    // Initializers are appended to the end of the module so that all globals
+    // they reference have been initialized first.
+    auto moduleBuilder = OpBuilder::atBlockEnd(moduleOp.getBody());
+    for (auto it : llvm::enumerate(staticCommandBuffers)) {
+      std::string name = "_command_buffer_" + std::to_string(it.index());
+      LLVM_DEBUG(llvm::dbgs() << "memoizing " << it.value().recordingOps.size()
+                              << " recording ops as @" << name << "\n");
+      memoizeCommandBuffer(it.value(), name, moduleBuilder, symbolTable);
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<OperationPass<ModuleOp>> createMemoizeCommandBuffersPass() {
+  return std::make_unique<MemoizeCommandBuffersPass>();
+}
+
+static PassRegistration<MemoizeCommandBuffersPass> pass;
+
+}  // namespace HAL
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -48,6 +48,30 @@ static llvm::cl::opt<unsigned> clBenchmarkDispatchRepeatCount{
         "meant for command buffers having linear dispatch structures."),
     llvm::cl::init(1)};
 
+static llvm::cl::opt<bool> clLazyGlobalInitialization{
+    "iree-hal-lazy-global-initialization",
+    llvm::cl::desc(
+        "Initializes hoisted constants and cached HAL resources such as "
+        "executables on their first use instead of at module load. Reduces "
+        "startup time of modules with many rarely used entry points."),
+    llvm::cl::init(false)};
+
+static llvm::cl::opt<bool> clBatchCommandBufferCommands{
+    "iree-hal-batch-command-buffer-commands",
+    llvm::cl::desc(
+        "Packs sequences of dispatches, push constants, descriptor set pushes, "
+        "and barriers into command streams recorded with a single "
+        "hal.command_buffer.execute_commands_inline call."),
+    llvm::cl::init(false)};
+
+static llvm::cl::opt<bool> clMemoizeCommandBuffers{
+    "iree-hal-memoize-command-buffers",
+    llvm::cl::desc(
+        "Records command buffers that only reference constants and immutable "
+        "globals once at initialization time and reuses them for every "
+        "submission instead of re-recording them on each invocation."),
+    llvm::cl::init(false)};
+
 static llvm::cl::list<std::string> clSubstituteExecutableSource{
     "iree-hal-substitute-executable-source",
     llvm::cl::desc(
@@ -132,7 +156,8 @@ void buildHALConfigurationPassPipeline(OpPassManager &passManager,
     // Today we just assign devices from parameters but we should instead be
     // performing analysis at the flow level and then doing magic device
     // database lookups here.
-    passManager.addPass(createAssignTargetDevicesPass(targetOptions.targets));
+    passManager.addPass(createAssignTargetDevicesPass(
+        targetOptions.targets, targetOptions.fallbackTargets));
   }
   passManager.addPass(createVerifyTargetEnvironmentPass());
 
@@ -200,7 +225,8 @@ void buildHALTransformPassPipeline(OpPassManager &passManager,
   // their interfaces.
 
   passManager.addNestedPass<IREE::HAL::ExecutableOp>(
-      createTranslateExecutablesPass());
+      createTranslateExecutablesPass(
+          targetOptions.executableTranslationCachePath));
 
   // Substitute hal.executables we've translated with those specified on the
   // command line. This developer feature allows for splicing in hand-authored
@@ -286,6 +312,18 @@ void buildHALTransformPassPipeline(OpPassManager &passManager,
   // SimplifyGlobalAccesses are currently broken with scf present.
   FunctionLikeNest(passManager).addPass(mlir::createConvertSCFToCFPass);
 
+  // Hoist static command buffer recordings such that each invocation only
+  // has to submit them.
+  if (clMemoizeCommandBuffers) {
+    passManager.addPass(createMemoizeCommandBuffersPass());
+  }
+
+  // Defer the initializers of cached resources and hoisted constants to their
+  // first use if requested; only the remaining ones run at module load.
+  if (clLazyGlobalInitialization) {
+    passManager.addPass(IREE::Util::createLazyInitializeGlobalsPass());
+  }
+
   // Combine the initializers we emitted during resource cache materialization.
   passManager.addPass(IREE::Util::createCombineInitializersPass());
 
@@ -331,6 +369,12 @@ void buildHALTransformPassPipeline(OpPassManager &passManager,
     passManager.addPass(
         IREE::Util::createFixedPointIteratorPass(std::move(ipoPipeline)));
   }
+
+  // Batch command buffer recording once IPO has folded descriptor set and
+  // binding ordinals to constants.
+  if (clBatchCommandBufferCommands) {
+    FunctionLikeNest(passManager).addPass(createBatchCommandBufferCommandsPass);
+  }
 }
 
 void buildHALTransformPassPipeline(OpPassManager &passManager,
@@ -65,8 +65,10 @@ std::unique_ptr<OperationPass<mlir::ModuleOp>>
 createVerifyTargetEnvironmentPass();
 
 // Assigns the HAL devices the module will target to the given list of targets.
+// The executable targets of |fallbackTargets| are appended to those of each
+// device so that dispatches a device backend can't lower run on a fallback.
 std::unique_ptr<OperationPass<mlir::ModuleOp>> createAssignTargetDevicesPass(
-    ArrayRef<std::string> targets);
+    ArrayRef<std::string> targets, ArrayRef<std::string> fallbackTargets = {});
 
 // Applies fixups to the program for when using legacy HAL devices that only
 // support synchronous execution. Once all devices support async this will be
@@ -79,6 +81,11 @@ std::unique_ptr<OperationPass<void>> createInlineDeviceSwitchesPass();
 // Finds hal.device.query ops and creates variables initialized on startup.
 std::unique_ptr<OperationPass<mlir::ModuleOp>> createMemoizeDeviceQueriesPass();
 
+// Hoists command buffers recorded only from constants and immutable globals
+// into reusable command buffers recorded once on startup.
+std::unique_ptr<OperationPass<mlir::ModuleOp>>
+createMemoizeCommandBuffersPass();
+
 //===----------------------------------------------------------------------===//
 // Executable translation
 //===----------------------------------------------------------------------===//
@@ -108,12 +115,15 @@ std::unique_ptr<OperationPass<mlir::ModuleOp>> createSubstituteExecutablesPass(
     std::string searchPath);
 
 // Translates hal.executable.variant ops via a nested translation pipeline.
+// If |cachePath| is provided translated variants are stored in and reused
+// from that directory.
 std::unique_ptr<OperationPass<IREE::HAL::ExecutableOp>>
-createTranslateExecutablesPass();
+createTranslateExecutablesPass(std::string cachePath = "");
 
 // Translates hal.executable.variant ops for the specified |target| backend.
 std::unique_ptr<OperationPass<IREE::HAL::ExecutableVariantOp>>
-createTranslateTargetExecutableVariantsPass(StringRef target);
+createTranslateTargetExecutableVariantsPass(StringRef target,
+                                            std::string cachePath = "");
 
 // Calls into each target backend to have it link multiple hal.executables
 // together (if that makes sense). For example, the LLVM AOT backend may combine
@@ -154,6 +164,10 @@ createMaterializeResourceCachesPass(TargetOptions targetOptions);
 // Elides stateful command buffer ops that set redundant state.
 std::unique_ptr<OperationPass<void>> createElideRedundantCommandsPass();
 
+// Batches sequences of command buffer recording ops into packed command
+// streams recorded with a single hal.command_buffer.execute_commands_inline.
+std::unique_ptr<OperationPass<void>> createBatchCommandBufferCommandsPass();
+
 // Repeats dispatches `iree-hal-repeat-dispatch-num` times, which is 1 by
 // default.
 std::unique_ptr<OperationPass<func::FuncOp>> createBenchmarkBatchDispatchesPass(
@@ -168,6 +182,7 @@ inline void registerHALPasses() {
   registerHALConfigurationPassPipeline();
   auto targetOptions = TargetOptions::FromFlags::get();
   createAssignTargetDevicesPass({});
+  createBatchCommandBufferCommandsPass();
   createBenchmarkBatchDispatchesPass(/*repeatCount=*/1);
   createConvertToHALPass();
   createDumpExecutableSourcesPass("");
@@ -178,6 +193,7 @@ inline void registerHALPasses() {
   createLinkTargetExecutablesPass("");
   createMaterializeInterfacesPass();
   createMaterializeResourceCachesPass(targetOptions);
+  createMemoizeCommandBuffersPass();
   createMemoizeDeviceQueriesPass();
   createResolveExportOrdinalsPass();
   createSerializeExecutablesPass();
@@ -13,11 +13,18 @@
 #include "iree/compiler/Dialect/HAL/Target/TargetRegistry.h"
 #include "iree/compiler/Dialect/HAL/Transforms/Passes.h"
 #include "iree/compiler/Utils/TracingUtils.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringSet.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA1.h"
 #include "mlir/Dialect/Bufferization/IR/Bufferization.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/Diagnostics.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Parser/Parser.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
 
@@ -26,7 +33,176 @@ namespace iree_compiler {
 namespace IREE {
 namespace HAL {
 
-std::vector<std::string> op_pattern;
+//===----------------------------------------------------------------------===//
+// Translation cache
+//===----------------------------------------------------------------------===//
+// Translated variants are stored as `<key>.mlir` files in the cache directory.
+// The key hashes the variant IR (including its target attribute) prior to
+// translation and the textual translation pipeline with all pass options.
+//
+// Exports are keyed and stored under placeholder names derived from their
+// position in the variant. Export names embed the ordinal of the dispatch
+// they were outlined from and shift whenever a dispatch is added or removed
+// earlier in the program (such as when the partitioning of one PIM decoder
+// layer changes) even though the executables of the other layers are
+// otherwise unchanged; the placeholders let those keep hitting the cache.
+
+// Bumped whenever the cache entry format changes.
+static constexpr StringLiteral kTranslationCacheVersion =
+    "iree-hal-translation-cache-v2";
+
+static SmallVector<StringAttr> getExportNames(
+    IREE::HAL::ExecutableVariantOp variantOp) {
+  SmallVector<StringAttr> names;
+  for (auto exportOp : variantOp.getOps<IREE::HAL::ExecutableExportOp>()) {
+    names.push_back(exportOp.getSymNameAttr());
+  }
+  return names;
+}
+
+static SmallVector<StringAttr> getPlaceholderExportNames(MLIRContext *context,
+                                                         size_t count) {
+  SmallVector<StringAttr> names;
+  for (size_t i = 0; i < count; ++i) {
+    names.push_back(StringAttr::get(context, "__cached_export_" +
+                                                 std::to_string(i)));
+  }
+  return names;
+}
+
+// Renames the exports of |variantOp| in order to |names| along with the inner
+// module functions implementing them and all references to those.
+static void renameExports(IREE::HAL::ExecutableVariantOp variantOp,
+                          ArrayRef<StringAttr> names) {
+  auto innerModuleOp = variantOp.getInnerModule();
+  auto exportOps =
+      llvm::to_vector(variantOp.getOps<IREE::HAL::ExecutableExportOp>());
+  for (auto [exportOp, name] : llvm::zip_equal(exportOps, names)) {
+    StringAttr oldName = exportOp.getSymNameAttr();
+    if (oldName == name) continue;
+    if (innerModuleOp) {
+      if (auto *funcOp = SymbolTable::lookupSymbolIn(innerModuleOp, oldName)) {
+        SymbolTable::setSymbolName(funcOp, name);
+      }
+    }
+    (void)SymbolTable::replaceAllSymbolUses(oldName, name,
+                                            &variantOp->getRegion(0));
+    SymbolTable::setSymbolName(exportOp, name);
+  }
+}
+
+static std::string getTranslationCacheKey(
+    IREE::HAL::ExecutableVariantOp variantOp, OpPassManager &passManager) {
+  auto keyOp = cast<IREE::HAL::ExecutableVariantOp>(variantOp->clone());
+  renameExports(keyOp,
+                getPlaceholderExportNames(variantOp.getContext(),
+                                          getExportNames(variantOp).size()));
+  std::string key;
+  llvm::raw_string_ostream os(key);
+  os << kTranslationCacheVersion << "\n";
+  passManager.printAsTextualPipeline(os);
+  os << "\n";
+  keyOp->print(os, OpPrintingFlags().useLocalScope());
+  os.flush();
+  keyOp->erase();
+  llvm::SHA1 hasher;
+  hasher.update(key);
+  return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+}
+
+static std::string getTranslationCacheEntryPath(StringRef cachePath,
+                                                StringRef key) {
+  SmallString<256> path(cachePath);
+  llvm::sys::path::append(path, key + ".mlir");
+  return path.str().str();
+}
+
+// Replaces the contents of |variantOp| with the translated variant cached
+// under |key|. Fails if there is no entry or it cannot be used.
+static LogicalResult loadCachedTranslation(
+    IREE::HAL::ExecutableVariantOp variantOp, StringRef cachePath,
+    StringRef key) {
+  auto fileOr = llvm::MemoryBuffer::getFile(
+      getTranslationCacheEntryPath(cachePath, key));
+  if (!fileOr) return failure();
+
+  // The variant is parsed outside of its executable so cannot be verified
+  // until it has been moved into place.
+  Block block;
+  ParserConfig config(variantOp.getContext(), /*verifyAfterParse=*/false);
+  if (failed(parseSourceString((*fileOr)->getBuffer(), &block, config))) {
+    variantOp.emitWarning() << "ignoring unreadable translation cache entry "
+                            << key;
+    return failure();
+  }
+  IREE::HAL::ExecutableVariantOp cachedOp;
+  if (!block.empty()) {
+    cachedOp = dyn_cast<IREE::HAL::ExecutableVariantOp>(&block.front());
+  }
+  auto exportNames = getExportNames(variantOp);
+  if (!cachedOp || cachedOp.getSymName() != variantOp.getSymName() ||
+      getExportNames(cachedOp) !=
+          getPlaceholderExportNames(variantOp.getContext(),
+                                    exportNames.size())) {
+    variantOp.emitWarning() << "ignoring mismatched translation cache entry "
+                            << key;
+    return failure();
+  }
+  renameExports(cachedOp, exportNames);
+
+  variantOp->setAttrs(cachedOp->getAttrDictionary());
+  variantOp->getRegion(0).takeBody(cachedOp->getRegion(0));
+  return success();
+}
+
+// Stores the translated |variantOp| under |key|. Entries are written to a
+// temporary file and renamed into place so that concurrent compilations never
+// observe partial entries. Failures are ignored as the cache is best-effort.
+// |exportCount| is the number of exports prior to translation; variants whose
+// exports were added or removed by translation are not cached as their
+// exports can't be matched up with those of later compilations.
+static void storeCachedTranslation(IREE::HAL::ExecutableVariantOp variantOp,
+                                   size_t exportCount, StringRef cachePath,
+                                   StringRef key) {
+  auto exportNames = getExportNames(variantOp);
+  if (exportNames.size() != exportCount) return;
+  if (llvm::sys::fs::create_directories(cachePath)) return;
+
+  std::string data;
+  llvm::raw_string_ostream os(data);
+  renameExports(variantOp, getPlaceholderExportNames(variantOp.getContext(),
+                                                     exportCount));
+  variantOp->print(os, OpPrintingFlags()
+                           .useLocalScope()
+                           .printGenericOpForm()
+                           .enableDebugInfo());
+  os.flush();
+  renameExports(variantOp, exportNames);
+
+  SmallString<256> modelPath(cachePath);
+  llvm::sys::path::append(modelPath, key + "-%%%%%%.tmp");
+  SmallString<256> tempPath;
+  int fd = -1;
+  if (llvm::sys::fs::createUniqueFile(modelPath, fd, tempPath)) return;
+  {
+    llvm::raw_fd_ostream file(fd, /*shouldClose=*/true);
+    file << data;
+    file.close();
+    if (file.has_error()) {
+      file.clear_error();
+      llvm::sys::fs::remove(tempPath);
+      return;
+    }
+  }
+  if (llvm::sys::fs::rename(tempPath,
+                            getTranslationCacheEntryPath(cachePath, key))) {
+    llvm::sys::fs::remove(tempPath);
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// -iree-hal-translate-target-executable-variants
+//===----------------------------------------------------------------------===//
 
 class TranslateTargetExecutableVariantsPass
     : public PassWrapper<TranslateTargetExecutableVariantsPass,
@@ -35,8 +211,10 @@ class TranslateTargetExecutableVariantsPass
   TranslateTargetExecutableVariantsPass() = default;
   TranslateTargetExecutableVariantsPass(
       const TranslateTargetExecutableVariantsPass &pass) {}
-  TranslateTargetExecutableVariantsPass(StringRef target) {
+  TranslateTargetExecutableVariantsPass(StringRef target,
+                                        std::string cachePath) {
     this->target = target.str();
+    this->cachePath = cachePath;
   }
 
   StringRef getArgument() const override {
@@ -58,12 +236,8 @@ class TranslateTargetExecutableVariantsPass
 
   void runOnOperation() override {
     auto variantOp = getOperation();
-    // auto module = getModule();
-    // extern std::vector<std::string> g_ffn_pattern;
-    /*
-    for (const auto &opName : g_ffn_pattern) {
-      llvm::outs() << opName << " ";
-    }*/
+    // Variants of different executables are translated concurrently when
+    // multithreading is enabled; backends must keep all state in the IR.
     if (variantOp.getTarget().getBackend().getValue() != target) return;
 
     auto targetBackend = getTargetBackend(target);
@@ -74,12 +248,28 @@ class TranslateTargetExecutableVariantsPass
 
     OpPassManager passManager(variantOp.getOperationName());
     targetBackend->buildTranslationPassPipeline(variantOp, passManager);
+
+    std::string cacheKey;
+    size_t exportCount = getExportNames(variantOp).size();
+    if (!cachePath.empty()) {
+      cacheKey = getTranslationCacheKey(variantOp, passManager);
+      if (succeeded(loadCachedTranslation(variantOp, cachePath, cacheKey))) {
+        ++cacheHits;
+        return;
+      }
+      ++cacheMisses;
+    }
+
     if (failed(runPipeline(passManager, variantOp))) {
       variantOp.emitError() << "failed to run translation of source "
                                "executable to target executable for backend "
                             << variantOp.getTarget();
       return signalPassFailure();
     }
+
+    if (!cacheKey.empty()) {
+      storeCachedTranslation(variantOp, exportCount, cachePath, cacheKey);
+    }
   }
 
  private:
@@ -88,21 +278,38 @@ class TranslateTargetExecutableVariantsPass
       llvm::cl::desc(
           "Target backend name whose executables will be translated by "
           "this pass.")};
+  Option<std::string> cachePath{
+      *this, "cache-path",
+      llvm::cl::desc("Directory storing translated variants for reuse across "
+                     "compilations.")};
+
+  Statistic cacheHits{this, "cache-hits",
+                      "Number of variants reused from the translation cache"};
+  Statistic cacheMisses{
+      this, "cache-misses",
+      "Number of variants translated and added to the translation cache"};
 };
 
 std::unique_ptr<OperationPass<IREE::HAL::ExecutableVariantOp>>
-createTranslateTargetExecutableVariantsPass(StringRef target) {
-  return std::make_unique<TranslateTargetExecutableVariantsPass>(target);
+createTranslateTargetExecutableVariantsPass(StringRef target,
+                                            std::string cachePath) {
+  return std::make_unique<TranslateTargetExecutableVariantsPass>(target,
+                                                                 cachePath);
 }
 
 static PassRegistration<TranslateTargetExecutableVariantsPass> linkTargetPass(
     [] { return std::make_unique<TranslateTargetExecutableVariantsPass>(); });
 
+//===----------------------------------------------------------------------===//
+// -iree-hal-translate-executables
+//===----------------------------------------------------------------------===//
+
 class TranslateExecutablesPass
     : public PassWrapper<TranslateExecutablesPass,
                          OperationPass<IREE::HAL::ExecutableOp>> {
  public:
   TranslateExecutablesPass() = default;
+  TranslateExecutablesPass(std::string cachePath) : cachePath(cachePath) {}
 
   StringRef getArgument() const override {
     return "iree-hal-translate-executables";
@@ -126,7 +333,7 @@ class TranslateExecutablesPass
     OpPassManager passManager(executableOp.getOperationName());
     for (const auto &targetName : gatherExecutableTargetNames(executableOp)) {
       passManager.addNestedPass<IREE::HAL::ExecutableVariantOp>(
-          createTranslateTargetExecutableVariantsPass(targetName));
+          createTranslateTargetExecutableVariantsPass(targetName, cachePath));
     }
 
     IREE_COMPILER_TRACE_MESSAGE_DYNAMIC(INFO, executableOp.getSymName().str());
@@ -135,12 +342,35 @@ class TranslateExecutablesPass
       executableOp.emitError() << "failed to serialize executables";
       return signalPassFailure();
     }
+
+    // Backends mark the variants they could not lower by setting
+    // `hal.executable.unsupported` on the inner module. Those are dropped when
+    // another variant (such as a host fallback) remains so that the runtime
+    // selects it instead; a lone variant is kept as-is.
+    SmallVector<IREE::HAL::ExecutableVariantOp> unsupportedOps;
+    size_t variantCount = 0;
+    for (auto variantOp :
+         executableOp.getOps<IREE::HAL::ExecutableVariantOp>()) {
+      ++variantCount;
+      auto innerModuleOp = variantOp.getInnerModule();
+      if (innerModuleOp &&
+          innerModuleOp->hasAttr("hal.executable.unsupported")) {
+        unsupportedOps.push_back(variantOp);
+      }
+    }
+    if (unsupportedOps.empty() || unsupportedOps.size() == variantCount) {
+      return;
+    }
+    for (auto variantOp : unsupportedOps) variantOp.erase();
   }
+
+ private:
+  std::string cachePath;
 };
 
 std::unique_ptr<OperationPass<IREE::HAL::ExecutableOp>>
-createTranslateExecutablesPass() {
-  return std::make_unique<TranslateExecutablesPass>();
+createTranslateExecutablesPass(std::string cachePath) {
+  return std::make_unique<TranslateExecutablesPass>(cachePath);
 }
 
 static PassRegistration<TranslateExecutablesPass> translatePass([] {
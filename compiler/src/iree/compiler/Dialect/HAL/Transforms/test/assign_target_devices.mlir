@@ -1,18 +1,25 @@
 // RUN: iree-opt --split-input-file --pass-pipeline='builtin.module(iree-hal-assign-target-devices)' %s | FileCheck %s --check-prefix=CHECK --check-prefix=TARGET-0
 // RUN: iree-opt --split-input-file --pass-pipeline='builtin.module(iree-hal-assign-target-devices{targets=vulkan-spirv})' %s | FileCheck %s --check-prefix=CHECK --check-prefix=TARGET-1
 // RUN: iree-opt --split-input-file --pass-pipeline='builtin.module(iree-hal-assign-target-devices{targets=vulkan-spirv,vmvx})' %s | FileCheck %s --check-prefix=CHECK --check-prefix=TARGET-2
+// RUN: iree-opt --split-input-file --pass-pipeline='builtin.module(iree-hal-assign-target-devices{targets=vulkan-spirv fallback-targets=vmvx})' %s | FileCheck %s --check-prefix=CHECK --check-prefix=TARGET-3
 
 // TARGET-1: #device_target_vulkan = #hal.device.target<"vulkan"
 
 // TARGET-2: #device_target_vmvx = #hal.device.target<"vmvx"
 // TARGET-2: #device_target_vulkan = #hal.device.target<"vulkan"
 
+// Fallback executable targets follow those of the device.
+// TARGET-3: #executable_target_vmvx_bytecode_fb = #hal.executable.target<"vmvx", "vmvx-bytecode-fb">
+// TARGET-3: #device_target_vulkan = #hal.device.target<"vulkan", {{.*}}executable_targets = [#executable_target_{{.+}}, #executable_target_vmvx_bytecode_fb]
+
 // CHECK: module
 // TARGET-0: @module {
 // TARGET-1: @module attributes {
 // TARGET-1-SAME: hal.device.targets = [#device_target_vulkan]
 // TARGET-2: @module attributes {
 // TARGET-2-SAME: hal.device.targets = [#device_target_vulkan, #device_target_vmvx]}
+// TARGET-3: @module attributes {
+// TARGET-3-SAME: hal.device.targets = [#device_target_vulkan]}
 module @module {}
 
 // -----
@@ -0,0 +1,94 @@
+// RUN: iree-opt --split-input-file --pass-pipeline='builtin.module(func.func(iree-hal-batch-command-buffer-commands))' %s | FileCheck %s
+
+// Tests that a dispatch sequence is packed into a single command stream with
+// deduplicated operand slots.
+
+// CHECK-LABEL: @batchDispatchSequence
+// CHECK-SAME: (%[[CMD:.+]]: !hal.command_buffer, %[[LAYOUT:.+]]: !hal.pipeline_layout, %[[EXECUTABLE:.+]]: !hal.executable, %[[BUFFER:.+]]: !hal.buffer, %[[SIZE:.+]]: index, %[[X:.+]]: index)
+func.func @batchDispatchSequence(%cmd: !hal.command_buffer, %pipeline_layout: !hal.pipeline_layout, %executable: !hal.executable, %buffer: !hal.buffer, %size: index, %x: index) {
+  // CHECK-DAG: %[[C0:.+]] = arith.constant 0 : index
+  %c0 = arith.constant 0 : index
+  // CHECK-DAG: %[[C1:.+]] = arith.constant 1 : index
+  %c1 = arith.constant 1 : index
+  // CHECK-DAG: %[[C42:.+]] = arith.constant 42 : i32
+  %c42_i32 = arith.constant 42 : i32
+  // CHECK-NOT: hal.command_buffer.push_descriptor_set
+  hal.command_buffer.push_descriptor_set<%cmd : !hal.command_buffer> layout(%pipeline_layout : !hal.pipeline_layout)[%c0] bindings([
+    %c0 = (%buffer : !hal.buffer)[%c0, %size],
+    %c1 = (%buffer : !hal.buffer)[%c0, %size]
+  ])
+  // CHECK-NOT: hal.command_buffer.push_constants
+  hal.command_buffer.push_constants<%cmd : !hal.command_buffer> layout(%pipeline_layout : !hal.pipeline_layout) offset(0) values([%c42_i32]) : i32
+  // CHECK-NOT: hal.command_buffer.dispatch
+  hal.command_buffer.dispatch<%cmd : !hal.command_buffer> target(%executable : !hal.executable)[0] workgroups([%x, %c1, %c1])
+  // CHECK-NOT: hal.command_buffer.execution_barrier
+  hal.command_buffer.execution_barrier<%cmd : !hal.command_buffer> source("Dispatch|Transfer|CommandRetire") target("CommandIssue|Dispatch|Transfer") flags("None")
+  hal.command_buffer.dispatch<%cmd : !hal.command_buffer> target(%executable : !hal.executable)[1] workgroups([%x, %c1, %c1])
+  //      CHECK: %[[COMMANDS:.+]] = util.buffer.constant {alignment = 4 : index} : !util.buffer = dense<[
+  // CHECK-SAME:   3, 0, 0, 2, 0, 0, 0, 1, 1, 0, 0, 1,
+  // CHECK-SAME:   2, 0, 0, 1, 2,
+  // CHECK-SAME:   1, 0, 0, 3, 4, 4,
+  // CHECK-SAME:   4, 28, 13, 0,
+  // CHECK-SAME:   1, 0, 1, 3, 4, 4
+  // CHECK-SAME: ]> : tensor<33xi32>
+  // CHECK-DAG: %[[C0_I64:.+]] = arith.index_castui %[[C0]] : index to i64
+  // CHECK-DAG: %[[SIZE_I64:.+]] = arith.index_castui %[[SIZE]] : index to i64
+  // CHECK-DAG: %[[C42_I64:.+]] = arith.extui %[[C42]] : i32 to i64
+  // CHECK-DAG: %[[X_I64:.+]] = arith.index_castui %[[X]] : index to i64
+  // CHECK-DAG: %[[C1_I64:.+]] = arith.index_castui %[[C1]] : index to i64
+  //      CHECK: hal.command_buffer.execute_commands_inline<%[[CMD]] : !hal.command_buffer>
+  // CHECK-SAME:   commands(%[[COMMANDS]])
+  // CHECK-SAME:   executables([%[[EXECUTABLE]]])
+  // CHECK-SAME:   layouts([%[[LAYOUT]]])
+  // CHECK-SAME:   buffers([%[[BUFFER]]])
+  // CHECK-SAME:   values([%[[C0_I64]], %[[SIZE_I64]], %[[C42_I64]], %[[X_I64]], %[[C1_I64]]])
+  // CHECK-NEXT: return
+  return
+}
+
+// -----
+
+// Tests that ops with side effects end a batch and that single commands are
+// left as-is.
+
+func.func private @extern()
+
+// CHECK-LABEL: @batchSplitBySideEffects
+func.func @batchSplitBySideEffects(%cmd: !hal.command_buffer, %executable: !hal.executable) {
+  %c1 = arith.constant 1 : index
+  // CHECK: hal.command_buffer.execute_commands_inline
+  hal.command_buffer.dispatch<%cmd : !hal.command_buffer> target(%executable : !hal.executable)[0] workgroups([%c1, %c1, %c1])
+  hal.command_buffer.dispatch<%cmd : !hal.command_buffer> target(%executable : !hal.executable)[1] workgroups([%c1, %c1, %c1])
+  // CHECK-NEXT: call @extern
+  call @extern() : () -> ()
+  // CHECK-NEXT: hal.command_buffer.dispatch
+  hal.command_buffer.dispatch<%cmd : !hal.command_buffer> target(%executable : !hal.executable)[2] workgroups([%c1, %c1, %c1])
+  // CHECK-NEXT: hal.command_buffer.finalize
+  hal.command_buffer.finalize<%cmd : !hal.command_buffer>
+  return
+}
+
+// -----
+
+// Tests that descriptor sets with dynamic ordinals or binding table references
+// end a batch.
+
+// CHECK-LABEL: @batchSplitByDynamicDescriptorSet
+func.func @batchSplitByDynamicDescriptorSet(%cmd: !hal.command_buffer, %pipeline_layout: !hal.pipeline_layout, %executable: !hal.executable, %buffer: !hal.buffer, %set: index, %slot: index) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c128 = arith.constant 128 : index
+  // CHECK: hal.command_buffer.push_descriptor_set{{.+}}[%{{.+}}]
+  hal.command_buffer.push_descriptor_set<%cmd : !hal.command_buffer> layout(%pipeline_layout : !hal.pipeline_layout)[%set] bindings([
+    %c0 = (%buffer : !hal.buffer)[%c0, %c128]
+  ])
+  // CHECK-NEXT: hal.command_buffer.dispatch
+  hal.command_buffer.dispatch<%cmd : !hal.command_buffer> target(%executable : !hal.executable)[0] workgroups([%c1, %c1, %c1])
+  // CHECK-NEXT: hal.command_buffer.push_descriptor_set
+  hal.command_buffer.push_descriptor_set<%cmd : !hal.command_buffer> layout(%pipeline_layout : !hal.pipeline_layout)[%c0] bindings([
+    %c0 = (%slot : index)[%c0, %c128]
+  ])
+  // CHECK-NEXT: hal.command_buffer.dispatch
+  hal.command_buffer.dispatch<%cmd : !hal.command_buffer> target(%executable : !hal.executable)[0] workgroups([%c1, %c1, %c1])
+  return
+}
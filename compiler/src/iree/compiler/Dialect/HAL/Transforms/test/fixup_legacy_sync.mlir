@@ -93,3 +93,41 @@ func.func @blocking_execute(%device: !hal.device, %wait: !hal.fence, %cmd: !hal.
   return
 }
 }  // module
+
+// -----
+
+// Tests that waits are only performed on legacy devices when the module also
+// targets devices that don't require them.
+
+module attributes {hal.device.targets = [
+  #hal.device.target<"pim", {legacy_sync, executable_targets = [
+    #hal.executable.target<"pim", "pim-isr-fb">,
+    #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64">
+  ]}>,
+  #hal.device.target<"llvm-cpu", {executable_targets = [
+    #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64">
+  ]}>
+]} {
+// CHECK-LABEL: @guarded_blocking_execute
+// CHECK-SAME: (%[[DEVICE:.+]]: !hal.device, %[[WAIT:.+]]: !hal.fence, %[[CMD:.+]]: !hal.command_buffer, %[[SIGNAL:.+]]: !hal.fence)
+func.func @guarded_blocking_execute(%device: !hal.device, %wait: !hal.fence, %cmd: !hal.command_buffer, %signal: !hal.fence) {
+  %affinity = arith.constant 0 : i64
+  //      CHECK: %{{.+}}, %[[IS_PIM:.+]] = hal.device.query<%[[DEVICE]] : !hal.device> key("hal.executable.format" :: "pim-isr-fb") : i1, i1 = false
+  //      CHECK: scf.if %[[IS_PIM]] {
+  // CHECK-NEXT:   hal.fence.await until([%[[WAIT]]])
+  // CHECK-NEXT: }
+  //      CHECK: %[[NULL:.+]] = util.null : !hal.fence
+  //      CHECK: %[[WAIT_OR_NULL:.+]] = arith.select %[[IS_PIM]], %[[NULL]], %[[WAIT]] : !hal.fence
+  // CHECK-NEXT: hal.device.queue.execute<%[[DEVICE]] : !hal.device>
+  // CHECK-SAME:   wait(%[[WAIT_OR_NULL]]) signal(%[[SIGNAL]])
+  // CHECK-SAME:   commands([%[[CMD]]])
+  // CHECK-NEXT: scf.if %[[IS_PIM]] {
+  // CHECK-NEXT:   hal.fence.await until([%[[SIGNAL]]])
+  // CHECK-NEXT: }
+  hal.device.queue.execute<%device : !hal.device>
+      affinity(%affinity)
+      wait(%wait) signal(%signal)
+      commands([%cmd])
+  return
+}
+}  // module
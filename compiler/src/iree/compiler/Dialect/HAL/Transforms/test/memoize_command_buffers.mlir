@@ -0,0 +1,104 @@
+// RUN: iree-opt --split-input-file --iree-hal-memoize-command-buffers %s | FileCheck %s
+
+// Tests that a command buffer recorded only from constants and immutable
+// globals is recorded once into a reusable command buffer at initialization.
+
+util.global private @executable : !hal.executable
+util.global private @pipeline_layout : !hal.pipeline_layout
+util.global private @buffer : !hal.buffer
+
+// CHECK-LABEL: @staticCommandBuffer
+// CHECK-SAME: (%[[WAIT:.+]]: !hal.fence, %[[SIGNAL:.+]]: !hal.fence)
+func.func @staticCommandBuffer(%wait: !hal.fence, %signal: !hal.fence) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c128 = arith.constant 128 : index
+  %c256 = arith.constant 256 : index
+  %c42_i32 = arith.constant 42 : i32
+  %affinity = arith.constant -1 : i64
+  // CHECK: %[[DEVICE:.+]] = hal.ex.shared_device
+  %device = hal.ex.shared_device : !hal.device
+  %executable = util.global.load @executable : !hal.executable
+  %pipeline_layout = util.global.load @pipeline_layout : !hal.pipeline_layout
+  %buffer = util.global.load @buffer : !hal.buffer
+  %half = arith.divui %c256, %c1 : index
+  // CHECK-NOT: hal.command_buffer.create
+  // CHECK: %[[CMD:.+]] = util.global.load @_command_buffer_0 : !hal.command_buffer
+  // CHECK-NOT: hal.command_buffer.
+  %cmd = hal.command_buffer.create device(%device : !hal.device) mode("OneShot|AllowInlineExecution") categories("Transfer|Dispatch") : !hal.command_buffer
+  hal.command_buffer.push_constants<%cmd : !hal.command_buffer> layout(%pipeline_layout : !hal.pipeline_layout) offset(0) values([%c42_i32]) : i32
+  hal.command_buffer.push_descriptor_set<%cmd : !hal.command_buffer> layout(%pipeline_layout : !hal.pipeline_layout)[%c0] bindings([
+    %c0 = (%buffer : !hal.buffer)[%c0, %c128],
+    %c1 = (%buffer : !hal.buffer)[%c128, %half]
+  ])
+  hal.command_buffer.dispatch<%cmd : !hal.command_buffer> target(%executable : !hal.executable)[0] workgroups([%c1, %c1, %c1])
+  hal.command_buffer.finalize<%cmd : !hal.command_buffer>
+  // CHECK: hal.device.queue.execute<%[[DEVICE]] : !hal.device>
+  // CHECK-SAME: wait(%[[WAIT]]) signal(%[[SIGNAL]])
+  // CHECK-SAME: commands([%[[CMD]]])
+  hal.device.queue.execute<%device : !hal.device> affinity(%affinity) wait(%wait) signal(%signal) commands([%cmd])
+  return
+}
+
+//      CHECK: util.global private @_command_buffer_0 : !hal.command_buffer
+// CHECK-NEXT: util.initializer {
+//  CHECK-DAG:   %[[INIT_LAYOUT:.+]] = util.global.load @pipeline_layout
+//  CHECK-DAG:   %[[INIT_BUFFER:.+]] = util.global.load @buffer
+//  CHECK-DAG:   %[[INIT_HALF:.+]] = arith.divui
+//  CHECK-DAG:   %[[INIT_EXECUTABLE:.+]] = util.global.load @executable
+//  CHECK-DAG:   %[[INIT_DEVICE:.+]] = hal.ex.shared_device
+//      CHECK:   %[[INIT_CMD:.+]] = hal.command_buffer.create device(%[[INIT_DEVICE]] : !hal.device) mode("None") categories("Transfer|Dispatch")
+// CHECK-NEXT:   hal.command_buffer.push_constants<%[[INIT_CMD]] : !hal.command_buffer> layout(%[[INIT_LAYOUT]] : !hal.pipeline_layout)
+// CHECK-NEXT:   hal.command_buffer.push_descriptor_set<%[[INIT_CMD]] : !hal.command_buffer> layout(%[[INIT_LAYOUT]] : !hal.pipeline_layout)
+// CHECK-NEXT:      = (%[[INIT_BUFFER]] : !hal.buffer)
+// CHECK-NEXT:      = (%[[INIT_BUFFER]] : !hal.buffer)[{{.+}}, %[[INIT_HALF]]]
+// CHECK-NEXT:   ])
+// CHECK-NEXT:   hal.command_buffer.dispatch<%[[INIT_CMD]] : !hal.command_buffer> target(%[[INIT_EXECUTABLE]] : !hal.executable)[0]
+// CHECK-NEXT:   hal.command_buffer.finalize<%[[INIT_CMD]] : !hal.command_buffer>
+// CHECK-NEXT:   util.global.store %[[INIT_CMD]], @_command_buffer_0 : !hal.command_buffer
+// CHECK-NEXT:   util.initializer.return
+
+// -----
+
+// Tests that command buffers recording values that vary per invocation are
+// left as-is.
+
+util.global private @executable : !hal.executable
+util.global private @pipeline_layout : !hal.pipeline_layout
+util.global private mutable @mutable_buffer : !hal.buffer
+
+// CHECK-LABEL: @dynamicCommandBuffer
+func.func @dynamicCommandBuffer(%buffer: !hal.buffer, %workgroups: index, %wait: !hal.fence, %signal: !hal.fence) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c128 = arith.constant 128 : index
+  %affinity = arith.constant -1 : i64
+  %device = hal.ex.shared_device : !hal.device
+  %executable = util.global.load @executable : !hal.executable
+  %pipeline_layout = util.global.load @pipeline_layout : !hal.pipeline_layout
+
+  // Function arguments:
+  // CHECK: hal.command_buffer.create
+  %cmd0 = hal.command_buffer.create device(%device : !hal.device) mode(OneShot) categories("Transfer|Dispatch") : !hal.command_buffer
+  hal.command_buffer.push_descriptor_set<%cmd0 : !hal.command_buffer> layout(%pipeline_layout : !hal.pipeline_layout)[%c0] bindings([
+    %c0 = (%buffer : !hal.buffer)[%c0, %c128]
+  ])
+  hal.command_buffer.dispatch<%cmd0 : !hal.command_buffer> target(%executable : !hal.executable)[0] workgroups([%workgroups, %c1, %c1])
+  hal.command_buffer.finalize<%cmd0 : !hal.command_buffer>
+  hal.device.queue.execute<%device : !hal.device> affinity(%affinity) wait(%wait) signal(%signal) commands([%cmd0])
+
+  // Mutable globals:
+  // CHECK: hal.command_buffer.create
+  %mutable_buffer = util.global.load @mutable_buffer : !hal.buffer
+  %cmd1 = hal.command_buffer.create device(%device : !hal.device) mode(OneShot) categories("Transfer|Dispatch") : !hal.command_buffer
+  hal.command_buffer.push_descriptor_set<%cmd1 : !hal.command_buffer> layout(%pipeline_layout : !hal.pipeline_layout)[%c0] bindings([
+    %c0 = (%mutable_buffer : !hal.buffer)[%c0, %c128]
+  ])
+  hal.command_buffer.dispatch<%cmd1 : !hal.command_buffer> target(%executable : !hal.executable)[0] workgroups([%c1, %c1, %c1])
+  hal.command_buffer.finalize<%cmd1 : !hal.command_buffer>
+  hal.device.queue.execute<%device : !hal.device> affinity(%affinity) wait(%wait) signal(%signal) commands([%cmd1])
+
+  // CHECK-NOT: util.global.load @_command_buffer
+  return
+}
+// CHECK-NOT: util.initializer
@@ -301,6 +301,16 @@ vm.import @command_buffer.execute.commands(
   %bindings : tuple<!vm.ref<!hal.buffer>, i64, i64>...
 )
 
+// Records a packed stream of commands referencing the given operand slots.
+// See hal.command_buffer.execute_commands_inline for the stream encoding.
+vm.import @command_buffer.execute_commands_inline(
+  %command_buffer : !vm.ref<!hal.command_buffer>,
+  %commands : !vm.buffer,
+  // <executable, pipeline_layout, buffer, value>
+  %operands : tuple<!vm.ref<!hal.executable>, !vm.ref<!hal.pipeline_layout>,
+                    !vm.ref<!hal.buffer>, i64>...
+)
+
 //===----------------------------------------------------------------------===//
 // iree_hal_descriptor_set_layout_t
 //===----------------------------------------------------------------------===//
@@ -10,17 +10,19 @@
 #include "iree/compiler/Dialect/PIM/IR/PIMOps.h"
 #include "iree/compiler/Dialect/Flow/IR/FlowDialect.h"
 #include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
+#include "llvm/Support/Debug.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/Dominance.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "mlir/IR/Value.h"
-#include <iostream>
 #include <bitset>
 #include <cmath>
 #include <algorithm>
 
+#define DEBUG_TYPE "iree-linalg-to-pim"
+
 using namespace std;
 
 namespace mlir {
@@ -36,7 +38,7 @@ struct BatchMatmulOpPattern : public mlir::OpRewritePattern<linalg::BatchMatmulO
 
   mlir::LogicalResult matchAndRewrite(linalg::BatchMatmulOp op, PatternRewriter &rewriter) const override {
     
-    std::cout << "ConvertBatchMatmulOp.cpp: enter function\n";
+    LLVM_DEBUG(llvm::dbgs() << "ConvertBatchMatmulOp.cpp: enter function\n");
 
     // Access the first input tensor operand of the linalg::MatmulOp.
     mlir::Value inputTensor_l = op.getDpsInputOperands()[0]->get();
@@ -55,20 +57,32 @@ struct BatchMatmulOpPattern : public mlir::OpRewritePattern<linalg::BatchMatmulO
     SmallVector<int64_t> tileSizes;
     auto loweringConfig = op->getAttrOfType<IREE::Codegen::LoweringConfigAttr>("lowering_config");
     if(loweringConfig){
-      llvm::outs() << "ConvertBatchMatmulOp.cpp: Get tileSizesAttr\n";
+      LLVM_DEBUG(llvm::dbgs() << "ConvertBatchMatmulOp.cpp: Get tileSizesAttr\n");
       // loweringConfig.dump();
       tileSizes.assign(loweringConfig.getTileSizeVals(0));
-      llvm::outs() << "ConvertBatchMatmulOp.cpp: Tile sizes: ";
+      LLVM_DEBUG(llvm::dbgs() << "ConvertBatchMatmulOp.cpp: Tile sizes: ");
       for (size_t i = 0; i < tileSizes.size(); ++i) {
-        std::cout << tileSizes[i];
+        LLVM_DEBUG(llvm::dbgs() << tileSizes[i]);
         if (i < tileSizes.size() - 1) {
-            std::cout << ", ";
+            LLVM_DEBUG(llvm::dbgs() << ", ");
         }
       }
-      std::cout << "\n";
+      LLVM_DEBUG(llvm::dbgs() << "\n");
     }
     else {
-      llvm::outs() << "ConvertBatchMatmulOp.cpp: There is no lowering_config attribute\n";
+      LLVM_DEBUG(llvm::dbgs() << "ConvertBatchMatmulOp.cpp: There is no lowering_config attribute\n");
+    }
+
+    Optional<int32_t> element_type = getPIMElementType(op.getInputs());
+    if (!element_type) {
+      return rewriter.notifyMatchFailure(op, "unsupported PIM element type");
+    }
+    auto elementTypeAttr = rewriter.getI32IntegerAttr(*element_type);
+
+    // Query heads sharing each key and value head (grouped-query attention).
+    int group = 1;
+    if (decoder_config.size() > 4 && decoder_config[4] > 0) {
+      group = decoder_config[1] / decoder_config[4];
     }
 
     int dyn = 1; // dynamic iteration mode
@@ -84,38 +98,74 @@ struct BatchMatmulOpPattern : public mlir::OpRewritePattern<linalg::BatchMatmulO
     ////////////////////////////////////////
     // n_head, d_head, token
     if (layer == "qk") {
-      llvm::outs() << "ConvertBatchMatmulOp: Is Query*Key\n";
-      llvm::outs() << "ConvertBatchMatmulOp: n_head: " << n_head << "\n";
+      LLVM_DEBUG(llvm::dbgs() << "ConvertBatchMatmulOp: Is Query*Key\n");
+      LLVM_DEBUG(llvm::dbgs() << "ConvertBatchMatmulOp: n_head: " << n_head << "\n");
       int d_model = decoder_config[0];
       int d_head = decoder_config[2];
-      int token = decoder_config[3];
 
       // Query*Key instruction gen
+      // During incremental decode the key cache [n_head, d_head, seq] grows
+      // by one token per step; only the new query row is computed against
+      // the cached prefix with seq read from a push constant. Prompts of any
+      // length use the same push constant so one executable serves them all.
+      mlir::Value dim_n_val = getPIMDimValue(rewriter, op.getLoc(), inputTensor_r, 2, shape_r[2]);
+      if (!dim_n_val) {
+        return rewriter.notifyMatchFailure(op, "dynamic key length is not a push constant");
+      }
       mlir::Value dim_b_val = rewriter.create<mlir::arith::ConstantIntOp>(op.getLoc(), n_head, 32);
-      mlir::Value dim_m_val = rewriter.create<mlir::arith::ConstantIntOp>(op.getLoc(), 1, 32);
-      mlir::Value dim_n_val = rewriter.create<mlir::arith::ConstantIntOp>(op.getLoc(), token, 32);
+      // One query row per token of the batch sharing the key cache.
+      mlir::Value dim_m_val = getPIMDimValue(rewriter, op.getLoc(), inputTensor_l, 1, shape_l[1]);
+      if (!dim_m_val) {
+        return rewriter.notifyMatchFailure(op, "dynamic query count is not a push constant");
+      }
       mlir::Value dim_k_val = rewriter.create<mlir::arith::ConstantIntOp>(op.getLoc(), d_head, 32);
-      rewriter.create<IREE::PIM::QKMatmulOp>(op.getLoc(), dim_b_val, dim_m_val, dim_n_val, dim_k_val);
+      Operation *pim_op = nullptr;
+      if (group > 1) {
+        // The key cache holds n_head / group heads read ungrouped.
+        mlir::Value group_val = rewriter.create<mlir::arith::ConstantIntOp>(op.getLoc(), group, 32);
+        pim_op = rewriter.create<IREE::PIM::GQAQKMatmulOp>(
+            op.getLoc(), dim_b_val, dim_m_val, dim_n_val, dim_k_val, group_val);
+      } else {
+        pim_op = rewriter.create<IREE::PIM::QKMatmulOp>(
+            op.getLoc(), dim_b_val, dim_m_val, dim_n_val, dim_k_val);
+      }
+      pim_op->setAttr("pim.element_type", elementTypeAttr);
     }
 
     else if (layer == "sv") {
       int d_model = decoder_config[0];
       int d_head = decoder_config[2];
-      int token = decoder_config[3];
 
-      llvm::outs() << "ConvertBatchMatmulOp: Is Score*Value\n";
-      llvm::outs() << "ConvertBatchMatmulOp: n_head: " << n_head << "\n";
+      LLVM_DEBUG(llvm::dbgs() << "ConvertBatchMatmulOp: Is Score*Value\n");
+      LLVM_DEBUG(llvm::dbgs() << "ConvertBatchMatmulOp: n_head: " << n_head << "\n");
       
       // Score*Value instruction gen
+      // The value cache [n_head, seq, d_head] is read up to the current
+      // sequence length like the key cache of Query*Key.
+      mlir::Value dim_k_val = getPIMDimValue(rewriter, op.getLoc(), inputTensor_r, 1, shape_r[1]);
+      if (!dim_k_val) {
+        return rewriter.notifyMatchFailure(op, "dynamic value length is not a push constant");
+      }
       mlir::Value dim_b_val = rewriter.create<mlir::arith::ConstantIntOp>(op.getLoc(), n_head, 32);
-      mlir::Value dim_m_val = rewriter.create<mlir::arith::ConstantIntOp>(op.getLoc(), 1, 32);
+      mlir::Value dim_m_val = getPIMDimValue(rewriter, op.getLoc(), inputTensor_l, 1, shape_l[1]);
+      if (!dim_m_val) {
+        return rewriter.notifyMatchFailure(op, "dynamic score count is not a push constant");
+      }
       mlir::Value dim_n_val = rewriter.create<mlir::arith::ConstantIntOp>(op.getLoc(), d_head, 32);
-      mlir::Value dim_k_val = rewriter.create<mlir::arith::ConstantIntOp>(op.getLoc(), token, 32);
-      rewriter.create<IREE::PIM::SVMatmulOp>(op.getLoc(), dim_b_val, dim_m_val, dim_n_val, dim_k_val);
+      Operation *pim_op = nullptr;
+      if (group > 1) {
+        mlir::Value group_val = rewriter.create<mlir::arith::ConstantIntOp>(op.getLoc(), group, 32);
+        pim_op = rewriter.create<IREE::PIM::GQASVMatmulOp>(
+            op.getLoc(), dim_b_val, dim_m_val, dim_n_val, dim_k_val, group_val);
+      } else {
+        pim_op = rewriter.create<IREE::PIM::SVMatmulOp>(
+            op.getLoc(), dim_b_val, dim_m_val, dim_n_val, dim_k_val);
+      }
+      pim_op->setAttr("pim.element_type", elementTypeAttr);
 
     } // Score*Value codegen
 
-    llvm::outs() << "ConvertBatchMatmulOp.cpp: BatchMatmulOpPattern End\n";
+    LLVM_DEBUG(llvm::dbgs() << "ConvertBatchMatmulOp.cpp: BatchMatmulOpPattern End\n");
     return mlir::success();
   }
 
@@ -132,7 +182,6 @@ struct BatchMatmulOpPattern : public mlir::OpRewritePattern<linalg::BatchMatmulO
 
 void populateLinalgBatchMatmulToPIMPatterns(MLIRContext* context, RewritePatternSet &patterns, bool is_fused_matmul, std::vector<std::pair<int, int>> hal_buffer_info, 
   string layer, string sync, int num_device, std::vector<int> decoder_config) {
-  // std::cout<< "ConvertBatchMatmulOp: populateLinalgBatchMatmulToPIMPatterns\n";
   context->getOrLoadDialect<IREE::PIM::PIMDialect>();
   context->getOrLoadDialect<IREE::Flow::FlowDialect>();
   context->getOrLoadDialect<mlir::arith::ArithDialect>();
@@ -10,16 +10,22 @@
 #include "iree/compiler/Dialect/PIM/IR/PIMOps.h"
 #include "iree/compiler/Dialect/Flow/IR/FlowDialect.h"
 #include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
+#include "iree/compiler/Dialect/HAL/IR/HALOps.h"
+#include "llvm/Support/Debug.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Math/IR/Math.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/Dominance.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/TypeUtilities.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "mlir/IR/Value.h"
-#include <iostream>
 #include <bitset>
 
+#define DEBUG_TYPE "iree-linalg-to-pim"
+
 namespace mlir {
 namespace iree_compiler {
 
@@ -47,17 +53,17 @@ int doesGenericOpMatchPattern(linalg::GenericOp genericOp) {
 
   // Check if opsInGeneric matches the desired pattern.
   if (opsInGeneric == sm_pattern) {
-    llvm::outs() << "ConvertGeneric.cpp: Softmax pattern\n";
+    LLVM_DEBUG(llvm::dbgs() << "ConvertGeneric.cpp: Softmax pattern\n");
     nl_flag = 1;
     return nl_flag;
   }
   else if (opsInGeneric == ln_pattern) {
-    llvm::outs() << "ConvertGeneric.cpp: LayerNorm pattern\n";
+    LLVM_DEBUG(llvm::dbgs() << "ConvertGeneric.cpp: LayerNorm pattern\n");
     nl_flag = 2;
     return nl_flag;
   }
   else if (opsInGeneric == sc_pattern) {
-    llvm::outs() << "ConvertGeneric.cpp: Shortcut pattern\n";
+    LLVM_DEBUG(llvm::dbgs() << "ConvertGeneric.cpp: Shortcut pattern\n");
     nl_flag = 3;
     return nl_flag;
   }
@@ -77,7 +83,7 @@ struct NonlinearPattern : public mlir::OpRewritePattern<linalg::GenericOp> {
 
   mlir::LogicalResult matchAndRewrite(linalg::GenericOp op, PatternRewriter &rewriter) const override {
     
-    llvm::outs() << "ConvertGeneric.cpp: enter function\n";
+    LLVM_DEBUG(llvm::dbgs() << "ConvertGeneric.cpp: enter function\n");
 
     // Access the first input tensor operand of the linalg::MatmulOp.
     mlir::Value inputTensor_l = op.getDpsInputOperands()[0]->get();
@@ -93,37 +99,94 @@ struct NonlinearPattern : public mlir::OpRewritePattern<linalg::GenericOp> {
     // The shape of the tensor contains the dimension values.
     mlir::ArrayRef<int64_t> shape_r = inputType_r.getShape();*/
     
+    Optional<int32_t> element_type = getPIMElementType(op.getInputs());
+    if (!element_type) {
+      return rewriter.notifyMatchFailure(op, "unsupported PIM element type");
+    }
+    auto elementTypeAttr = rewriter.getI32IntegerAttr(*element_type);
+
     // Check if the operations inside the genericOp match the desired pattern.
     int op_type = doesGenericOpMatchPattern(op);
     if (layer == "softmax" && op_type == 1) {
-      llvm::outs() << "ConvertGeneric.cpp: Softmax cmd gen\n";
+      LLVM_DEBUG(llvm::dbgs() << "ConvertGeneric.cpp: Softmax cmd gen\n");
       int d_model = decoder_config[0];
       int n_head = shape_l[0]/num_device;
-      int token = shape_l[1];
-      mlir::Value length = rewriter.create<mlir::arith::ConstantIntOp>(op.getLoc(), token, 32);
-      rewriter.create<IREE::PIM::SoftmaxOp>(op.getLoc(), length);
+      // Scores are normalized along the key sequence, the innermost dim. It is
+      // read from a push constant when the sequence length is dynamic.
+      int64_t key_dim = inputType_l.getRank() - 1;
+      mlir::Value length = getPIMDimValue(rewriter, op.getLoc(), inputTensor_l, key_dim, shape_l[key_dim]);
+      if (!length) {
+        return rewriter.notifyMatchFailure(op, "dynamic key length is not a push constant");
+      }
+      Operation *pim_op =
+          rewriter.create<IREE::PIM::SoftmaxOp>(op.getLoc(), length);
+      pim_op->setAttr("pim.element_type", elementTypeAttr);
       return mlir::success();
     }
 
     else if (layer == "layernorm1") {
-      llvm::outs() << "ConvertGeneric.cpp: Layernorm cmd gen\n";
+      LLVM_DEBUG(llvm::dbgs() << "ConvertGeneric.cpp: Layernorm cmd gen\n");
       int d_model = shape_l[1];
       mlir::Value length = rewriter.create<mlir::arith::ConstantIntOp>(op.getLoc(), d_model, 32);
-      rewriter.create<IREE::PIM::LayerNorm1Op>(op.getLoc(), length);
+      Operation *pim_op =
+          rewriter.create<IREE::PIM::LayerNorm1Op>(op.getLoc(), length);
+      pim_op->setAttr("pim.element_type", elementTypeAttr);
       return mlir::success();
     }
 
     else if (layer == "layernorm2") {
-      llvm::outs() << "ConvertGeneric.cpp: Layernorm cmd gen\n";
+      LLVM_DEBUG(llvm::dbgs() << "ConvertGeneric.cpp: Layernorm cmd gen\n");
       int d_model = shape_l[1];
       mlir::Value length = rewriter.create<mlir::arith::ConstantIntOp>(op.getLoc(), d_model, 32);
-      rewriter.create<IREE::PIM::LayerNorm2Op>(op.getLoc(), length);
+      Operation *pim_op =
+          rewriter.create<IREE::PIM::LayerNorm2Op>(op.getLoc(), length);
+      pim_op->setAttr("pim.element_type", elementTypeAttr);
+      return mlir::success();
+    }
+
+    else if ((layer == "rmsnorm1") || (layer == "rmsnorm2")) {
+      LLVM_DEBUG(llvm::dbgs() << "ConvertGeneric.cpp: RMSNorm cmd gen\n");
+      int d_model = shape_l[1];
+      mlir::Value length = rewriter.create<mlir::arith::ConstantIntOp>(op.getLoc(), d_model, 32);
+      Operation *pim_op =
+          rewriter.create<IREE::PIM::RMSNormOp>(op.getLoc(), length);
+      pim_op->setAttr("pim.element_type", elementTypeAttr);
+      return mlir::success();
+    }
+
+    else if (layer == "rope") {
+      LLVM_DEBUG(llvm::dbgs() << "ConvertGeneric.cpp: RoPE cmd gen\n");
+      // The rotated queries or keys are [..., token, d_head] with the heads in
+      // the outer dims. The tokens are read from a push constant when the
+      // sequence length is dynamic.
+      mlir::Value result = op.getDpsInitOperands()[0]->get();
+      mlir::ArrayRef<int64_t> shape = result.getType().cast<mlir::ShapedType>().getShape();
+      int64_t rank = shape.size();
+      if (rank < 2 || ShapedType::isDynamic(shape[rank - 1])) {
+        return rewriter.notifyMatchFailure(op, "unsupported rotary embedding shape");
+      }
+      int64_t heads = 1;
+      for (int64_t dim : shape.drop_back(2)) {
+        if (ShapedType::isDynamic(dim)) {
+          return rewriter.notifyMatchFailure(op, "dynamic rotary embedding heads");
+        }
+        heads *= dim;
+      }
+      mlir::Value dim_m_val = getPIMDimValue(rewriter, op.getLoc(), result, rank - 2, shape[rank - 2]);
+      if (!dim_m_val) {
+        return rewriter.notifyMatchFailure(op, "dynamic token count is not a push constant");
+      }
+      mlir::Value dim_b_val = rewriter.create<mlir::arith::ConstantIntOp>(op.getLoc(), heads, 32);
+      mlir::Value dim_k_val = rewriter.create<mlir::arith::ConstantIntOp>(op.getLoc(), shape[rank - 1], 32);
+      Operation *pim_op = rewriter.create<IREE::PIM::RoPEOp>(
+          op.getLoc(), dim_b_val, dim_m_val, dim_k_val);
+      pim_op->setAttr("pim.element_type", elementTypeAttr);
       return mlir::success();
     }
 
     /*
     else if ((layer=="c_proj+residual")||(layer=="fc2+residual")) {
-      llvm::outs() << "ConvertGeneric.cpp: Shorcut cmd gen - " << layer << "\n";
+      LLVM_DEBUG(llvm::dbgs() << "ConvertGeneric.cpp: Shorcut cmd gen - " << layer << "\n");
       int d_model = shape_l[1];
       mlir::Value length = rewriter.create<mlir::arith::ConstantIntOp>(op.getLoc(), d_model, 32);
       rewriter.create<IREE::PIM::AddOp>(op.getLoc(), length);
@@ -132,7 +195,6 @@ struct NonlinearPattern : public mlir::OpRewritePattern<linalg::GenericOp> {
     }*/
     
     else
-      // std::cout << "SoftmaxPattern End" << std::endl;
       return mlir::success();
   }
 
@@ -145,17 +207,308 @@ struct NonlinearPattern : public mlir::OpRewritePattern<linalg::GenericOp> {
     std::vector<int> decoder_config;
 };
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Patterns to generate a PIM command stack for embedding lookups
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Returns the binding ordinal of the flow.dispatch.tensor.load producing
+// |value|, if any.
+Optional<int32_t> getLoadedBindingOrdinal(mlir::Value value) {
+  auto loadOp = value.getDefiningOp<IREE::Flow::DispatchTensorLoadOp>();
+  if (!loadOp) return std::nullopt;
+  auto subspanOp = loadOp.getSource().getDefiningOp<IREE::HAL::InterfaceBindingSubspanOp>();
+  if (!subspanOp) return std::nullopt;
+  return static_cast<int32_t>(subspanOp.getBinding().getSExtValue());
+}
+
+// Returns the binding ordinal of the flow.dispatch.tensor.store of |value|,
+// if any.
+Optional<int32_t> getStoredBindingOrdinal(mlir::Value value) {
+  for (Operation *user : value.getUsers()) {
+    auto storeOp = dyn_cast<IREE::Flow::DispatchTensorStoreOp>(user);
+    if (!storeOp) continue;
+    auto subspanOp = storeOp.getTarget().getDefiningOp<IREE::HAL::InterfaceBindingSubspanOp>();
+    if (!subspanOp) continue;
+    return static_cast<int32_t>(subspanOp.getBinding().getSExtValue());
+  }
+  return std::nullopt;
+}
+
+// Pattern to convert an embedding lookup (the token and position embeddings
+// of the decoder) into a PIM gather:
+//
+//   %0 = linalg.generic {indexing_maps = [(d0, d1) -> (d0), (d0, d1) -> (d0, d1)]}
+//       ins(%ids : tensor<?xi32>) outs(%init : tensor<?x768xf32>) {
+//   ^bb0(%id: i32, %out: f32):
+//     %row = arith.index_cast %id : i32 to index
+//     %col = linalg.index 1 : index
+//     %e = tensor.extract %table[%row, %col] : tensor<50257x768xf32>
+//     linalg.yield %e : f32
+//   }
+//
+// The table is read from the binding it is loaded from so that it stays
+// resident in PIM and the gathered rows are written to the result binding
+// without passing through the host. The dims are the number of rows gathered
+// and the row length. Lookups are matched independent of the layer and take
+// precedence over the nonlinear patterns.
+struct GatherPattern : public mlir::OpRewritePattern<linalg::GenericOp> {
+  GatherPattern(MLIRContext *context)
+      : OpRewritePattern<linalg::GenericOp>(context, /*benefit=*/2) {}
+
+  mlir::LogicalResult matchAndRewrite(linalg::GenericOp op, PatternRewriter &rewriter) const override {
+    if (op.getNumDpsInputs() != 1 || op.getNumDpsInits() != 1 ||
+        op.getNumLoops() != 2 || op.getNumParallelLoops() != 2) {
+      return rewriter.notifyMatchFailure(op, "not a 2-d parallel lookup");
+    }
+    OpOperand *indicesOperand = op.getDpsInputOperands()[0];
+    OpOperand *initOperand = op.getDpsInitOperands()[0];
+    mlir::AffineMap rowMap = mlir::AffineMap::get(2, 0, rewriter.getAffineDimExpr(0));
+    if (op.getMatchingIndexingMap(indicesOperand) != rowMap ||
+        !op.getMatchingIndexingMap(initOperand).isIdentity()) {
+      return rewriter.notifyMatchFailure(op, "indices must index the rows");
+    }
+    // The device reads the indices as 32-bit integers.
+    mlir::Value indices = indicesOperand->get();
+    if (!getElementTypeOrSelf(indices.getType()).isInteger(32)) {
+      return rewriter.notifyMatchFailure(op, "indices must be i32");
+    }
+
+    auto yieldOp = cast<linalg::YieldOp>(op.getBlock()->getTerminator());
+    auto extractOp = yieldOp.getOperand(0).getDefiningOp<tensor::ExtractOp>();
+    if (!extractOp || extractOp.getIndices().size() != 2) {
+      return rewriter.notifyMatchFailure(op, "does not yield a table element");
+    }
+    mlir::Value row = extractOp.getIndices()[0];
+    if (auto castOp = row.getDefiningOp<arith::IndexCastOp>()) {
+      row = castOp.getIn();
+    } else if (auto castOp = row.getDefiningOp<arith::IndexCastUIOp>()) {
+      row = castOp.getIn();
+    }
+    auto col = extractOp.getIndices()[1].getDefiningOp<linalg::IndexOp>();
+    if (row != op.getBlock()->getArgument(0) || !col || col.getDim() != 1) {
+      return rewriter.notifyMatchFailure(op, "not a row lookup");
+    }
+
+    mlir::Value table = extractOp.getTensor();
+    Optional<int32_t> table_slot = getLoadedBindingOrdinal(table);
+    Optional<int32_t> indices_slot = getLoadedBindingOrdinal(indices);
+    Optional<int32_t> result_slot = getStoredBindingOrdinal(op.getResult(0));
+    if (!table_slot || !indices_slot || !result_slot) {
+      return rewriter.notifyMatchFailure(op, "operands are not bindings");
+    }
+
+    Optional<int32_t> element_type = getPIMElementType(table);
+    if (!element_type) {
+      return rewriter.notifyMatchFailure(op, "unsupported PIM element type");
+    }
+
+    // The number of tokens looked up is dynamic during incremental decode.
+    mlir::Value result = initOperand->get();
+    mlir::ArrayRef<int64_t> shape = result.getType().cast<mlir::ShapedType>().getShape();
+    if (ShapedType::isDynamic(shape[1])) {
+      return rewriter.notifyMatchFailure(op, "dynamic row length");
+    }
+    mlir::Value count = getPIMDimValue(rewriter, op.getLoc(), result, 0, shape[0]);
+    if (!count) {
+      return rewriter.notifyMatchFailure(op, "dynamic lookup count is not a push constant");
+    }
+    mlir::Value length = rewriter.create<mlir::arith::ConstantIntOp>(op.getLoc(), shape[1], 32);
+
+    LLVM_DEBUG(llvm::dbgs() << "ConvertGeneric.cpp: Gather cmd gen\n");
+    Operation *pim_op =
+        rewriter.create<IREE::PIM::GatherOp>(op.getLoc(), count, length);
+    pim_op->setAttr("pim.element_type", rewriter.getI32IntegerAttr(*element_type));
+    pim_op->setAttr("pim.operand_slots", rewriter.getDenseI32ArrayAttr({*table_slot, *indices_slot, *result_slot}));
+    return mlir::success();
+  }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Patterns to generate a PIM command stack for elementwise bodies
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Micro-op kinds of PIM elementwise programs (see PIM_ElementwiseOp).
+enum ElementwiseKind : int32_t {
+  kElementwiseAdd = 1,
+  kElementwiseSub = 2,
+  kElementwiseMul = 3,
+  kElementwiseDiv = 4,
+  kElementwiseMax = 5,
+  kElementwiseMin = 6,
+  kElementwiseNeg = 16,
+  kElementwiseExp = 17,
+  kElementwiseTanh = 18,
+  kElementwiseSqrt = 19,
+  kElementwiseRsqrt = 20,
+  kElementwiseErf = 21,
+  kElementwiseLog = 22,
+  kElementwiseConstant = 32,
+};
+
+// The instruction word holds at most 15 dims, one of which is the length.
+static constexpr size_t kMaxElementwiseProgramWords = 14;
+
+// Returns the micro-op kind computing |op| or 0 if the device has none.
+static int32_t getElementwiseKind(Operation *op) {
+  if (isa<arith::AddFOp>(op)) return kElementwiseAdd;
+  if (isa<arith::SubFOp>(op)) return kElementwiseSub;
+  if (isa<arith::MulFOp>(op)) return kElementwiseMul;
+  if (isa<arith::DivFOp>(op)) return kElementwiseDiv;
+  if (isa<arith::MaxFOp>(op)) return kElementwiseMax;
+  if (isa<arith::MinFOp>(op)) return kElementwiseMin;
+  if (isa<arith::NegFOp>(op)) return kElementwiseNeg;
+  if (isa<math::ExpOp>(op)) return kElementwiseExp;
+  if (isa<math::TanhOp>(op)) return kElementwiseTanh;
+  if (isa<math::SqrtOp>(op)) return kElementwiseSqrt;
+  if (isa<math::RsqrtOp>(op)) return kElementwiseRsqrt;
+  if (isa<math::ErfOp>(op)) return kElementwiseErf;
+  if (isa<math::LogOp>(op)) return kElementwiseLog;
+  return 0;
+}
+
+// Encodes the body of |op| as a PIM elementwise program in |program|. Float
+// constants, whether defined in the body or captured from the dispatch, are
+// emitted at their first use. Returns false if the body computes anything but
+// f32 micro-ops of its inputs or the program doesn't fit an instruction.
+static bool buildElementwiseProgram(linalg::GenericOp op, SmallVectorImpl<int32_t> &program) {
+  Block *block = op.getBlock();
+  llvm::DenseMap<mlir::Value, int32_t> refs;
+  int32_t next_ref = 0;
+  for (unsigned i = 0; i < op.getNumDpsInputs(); ++i) {
+    refs[block->getArgument(i)] = next_ref++;
+  }
+  auto getRef = [&](mlir::Value value) -> Optional<int32_t> {
+    auto it = refs.find(value);
+    if (it != refs.end()) return it->second;
+    FloatAttr attr;
+    if (!matchPattern(value, m_Constant(&attr)) || !attr.getType().isF32()) {
+      return std::nullopt;
+    }
+    uint32_t bits = static_cast<uint32_t>(attr.getValue().bitcastToAPInt().getZExtValue());
+    program.push_back(kElementwiseConstant | static_cast<int32_t>((bits >> 31) << 24));
+    program.push_back(static_cast<int32_t>(bits & 0x7fffffffu));
+    refs[value] = next_ref;
+    return next_ref++;
+  };
+
+  mlir::Value last;
+  for (Operation &nested : block->without_terminator()) {
+    if (isa<arith::ConstantOp>(nested)) continue;
+    int32_t kind = getElementwiseKind(&nested);
+    if (!kind || nested.getNumOperands() > 2 || !nested.getResult(0).getType().isF32()) {
+      return false;
+    }
+    int32_t word = kind;
+    for (auto [index, operand] : llvm::enumerate(nested.getOperands())) {
+      Optional<int32_t> ref = getRef(operand);
+      if (!ref) return false;
+      word |= *ref << (8 + 8 * index);
+    }
+    program.push_back(word);
+    // Keeps the refs within their 8 bits.
+    if (program.size() > kMaxElementwiseProgramWords) return false;
+    refs[nested.getResult(0)] = next_ref++;
+    last = nested.getResult(0);
+  }
+  auto yieldOp = cast<linalg::YieldOp>(block->getTerminator());
+  return last && yieldOp.getNumOperands() == 1 && yieldOp.getOperand(0) == last &&
+         program.size() <= kMaxElementwiseProgramWords;
+}
+
+// Pattern to convert an elementwise linalg.generic (activations such as GELU,
+// residual adds and scalings) into a PIM elementwise instruction:
+//
+//   %0 = linalg.generic {indexing_maps = [#id, #id, #id], iterator_types = ["parallel", "parallel"]}
+//       ins(%a, %b : tensor<?x768xf32>, tensor<?x768xf32>) outs(%init : tensor<?x768xf32>) {
+//   ^bb0(%x: f32, %y: f32, %out: f32):
+//     %s = arith.addf %x, %y : f32
+//     linalg.yield %s : f32
+//   }
+//
+// The inputs must be read from bindings and the result stored to one so that
+// bodies fused into matmuls keep their own lowering. The dim is the innermost
+// dim of the result and is read from a push constant when dynamic; the device
+// applies the program along every row of the operands. Layers with
+// instructions of their own (softmax, norms, rotary embeddings) are left to
+// the nonlinear patterns.
+struct ElementwisePattern : public mlir::OpRewritePattern<linalg::GenericOp> {
+  ElementwisePattern(MLIRContext *context, string layerType)
+      : OpRewritePattern<linalg::GenericOp>(context, /*benefit=*/2), layer(std::move(layerType)) {}
+
+  mlir::LogicalResult matchAndRewrite(linalg::GenericOp op, PatternRewriter &rewriter) const override {
+    if (layer == "softmax" || layer == "layernorm1" || layer == "layernorm2" ||
+        layer == "rmsnorm1" || layer == "rmsnorm2" || layer == "rope") {
+      return rewriter.notifyMatchFailure(op, "layer has its own instruction");
+    }
+    // The SDK reads at most 16 operands including the program and the result.
+    if (op.getNumDpsInputs() == 0 || op.getNumDpsInputs() > 14 ||
+        op.getNumDpsInits() != 1 || op.getNumLoops() != op.getNumParallelLoops()) {
+      return rewriter.notifyMatchFailure(op, "not an elementwise op");
+    }
+    for (mlir::AffineMap map : op.getIndexingMapsArray()) {
+      if (!map.isIdentity()) {
+        return rewriter.notifyMatchFailure(op, "operands are not elementwise");
+      }
+    }
+
+    SmallVector<int32_t> slots;
+    for (mlir::Value input : op.getInputs()) {
+      Optional<int32_t> slot = getLoadedBindingOrdinal(input);
+      if (!slot) {
+        return rewriter.notifyMatchFailure(op, "inputs are not bindings");
+      }
+      slots.push_back(*slot);
+    }
+    Optional<int32_t> result_slot = getStoredBindingOrdinal(op.getResult(0));
+    if (!result_slot) {
+      return rewriter.notifyMatchFailure(op, "result is not stored to a binding");
+    }
+    slots.push_back(*result_slot);
+
+    Optional<int32_t> element_type = getPIMElementType(op.getInputs());
+    if (!element_type) {
+      return rewriter.notifyMatchFailure(op, "unsupported PIM element type");
+    }
+
+    SmallVector<int32_t> program;
+    if (!buildElementwiseProgram(op, program)) {
+      return rewriter.notifyMatchFailure(op, "body is not a PIM elementwise program");
+    }
+
+    mlir::Value result = op.getDpsInitOperands()[0]->get();
+    mlir::ArrayRef<int64_t> shape = result.getType().cast<mlir::ShapedType>().getShape();
+    if (shape.empty()) {
+      return rewriter.notifyMatchFailure(op, "scalar result");
+    }
+    mlir::Value length = getPIMDimValue(rewriter, op.getLoc(), result, shape.size() - 1, shape.back());
+    if (!length) {
+      return rewriter.notifyMatchFailure(op, "dynamic row length is not a push constant");
+    }
+
+    LLVM_DEBUG(llvm::dbgs() << "ConvertGeneric.cpp: Elementwise cmd gen\n");
+    Operation *pim_op = rewriter.create<IREE::PIM::ElementwiseOp>(
+        op.getLoc(), length, rewriter.getDenseI32ArrayAttr(program));
+    pim_op->setAttr("pim.element_type", rewriter.getI32IntegerAttr(*element_type));
+    pim_op->setAttr("pim.operand_slots", rewriter.getDenseI32ArrayAttr(slots));
+    return mlir::success();
+  }
+
+  private:
+    string layer;
+};
+
 } // namespace
  
 
 void populateLinalgGenericToPIMPatterns(MLIRContext* context, RewritePatternSet &patterns, bool is_fused_matmul, 
   string layer, string sync, int num_device, std::vector<int> decoder_config) {
-  // llvm::outs() << "\npopulateLinalgGenericToPIMPatterns\n";
   context->getOrLoadDialect<IREE::PIM::PIMDialect>();
   context->getOrLoadDialect<mlir::math::MathDialect>();
   context->getOrLoadDialect<mlir::arith::ArithDialect>();
   
   patterns.add<NonlinearPattern>(context, is_fused_matmul, layer, sync, num_device, decoder_config);
+  patterns.add<GatherPattern>(context);
+  patterns.add<ElementwisePattern>(context, layer);
 
 }
 
@@ -11,16 +11,18 @@
 #include "iree/compiler/Dialect/Flow/IR/FlowDialect.h"
 #include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
 #include "iree/compiler/Codegen/Dialect/LoweringConfig.h"
+#include "llvm/Support/Debug.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/Dominance.h"
 #include "mlir/Transforms/DialectConversion.h"
 #include "mlir/IR/Value.h"
-#include <iostream>
 #include <bitset>
 #include <cmath>
 
+#define DEBUG_TYPE "iree-linalg-to-pim"
+
 namespace mlir {
 namespace iree_compiler {
 
@@ -36,9 +38,9 @@ struct MatmulOpPattern : public mlir::OpRewritePattern<linalg::MatmulOp> {
   
   mlir::LogicalResult matchAndRewrite(linalg::MatmulOp op, PatternRewriter &rewriter) const override {
     
-    llvm::outs() << "ConvertMatmulOp.cpp: enter function\n";
+    LLVM_DEBUG(llvm::dbgs() << "ConvertMatmulOp.cpp: enter function\n");
     if (is_fused_matmul)
-      llvm::outs() << "ConvertMatmulOp.cpp: Fused matmul (bias)\n";
+      LLVM_DEBUG(llvm::dbgs() << "ConvertMatmulOp.cpp: Fused matmul (bias)\n");
     // std::string op_name = "matmul";
 
     SmallVector<int64_t> tileSizes;
@@ -47,20 +49,20 @@ struct MatmulOpPattern : public mlir::OpRewritePattern<linalg::MatmulOp> {
     
     // Get tile config attribute
     if(loweringConfig){
-      llvm::outs() << "ConvertMatmulOp.cpp: Get tileSizesAttr\n";
+      LLVM_DEBUG(llvm::dbgs() << "ConvertMatmulOp.cpp: Get tileSizesAttr\n");
       // loweringConfig.dump();
       tileSizes.assign(loweringConfig.getTileSizeVals(0));
-      llvm::outs() << "ConvertMatmulOp.cpp: Tile sizes: ";
+      LLVM_DEBUG(llvm::dbgs() << "ConvertMatmulOp.cpp: Tile sizes: ");
       for (size_t i = 0; i < tileSizes.size(); ++i) {
-        std::cout << tileSizes[i];
+        LLVM_DEBUG(llvm::dbgs() << tileSizes[i]);
         if (i < tileSizes.size() - 1) {
-            std::cout << ", ";
+            LLVM_DEBUG(llvm::dbgs() << ", ");
         }
       }
-      std::cout << "\n";
+      LLVM_DEBUG(llvm::dbgs() << "\n");
     }
     else {
-      llvm::outs() << "ConvertMatmulOp.cpp: There is no lowering_config attribute\n";
+      LLVM_DEBUG(llvm::dbgs() << "ConvertMatmulOp.cpp: There is no lowering_config attribute\n");
     }
 
     // Access the first input tensor operand of the linalg::MatmulOp.
@@ -78,17 +80,22 @@ struct MatmulOpPattern : public mlir::OpRewritePattern<linalg::MatmulOp> {
 
     
     // Print out the shape
-    llvm::outs() << "ConvertMatmulOp.cpp: 1st argument shape: ";
+    LLVM_DEBUG(llvm::dbgs() << "ConvertMatmulOp.cpp: 1st argument shape: ");
     for (int64_t dim : shape_l) {
-      llvm::outs() << dim << " ";
+      LLVM_DEBUG(llvm::dbgs() << dim << " ");
     }
-    llvm::outs() << "\n";
+    LLVM_DEBUG(llvm::dbgs() << "\n");
     
-    llvm::outs() << "ConvertMatmulOp.cpp: 2nd argument shape: ";
+    LLVM_DEBUG(llvm::dbgs() << "ConvertMatmulOp.cpp: 2nd argument shape: ");
     for (int64_t dim : shape_r) {
-      llvm::outs() << dim << " ";
+      LLVM_DEBUG(llvm::dbgs() << dim << " ");
+    }
+    LLVM_DEBUG(llvm::dbgs() << "\n");
+
+    Optional<int32_t> element_type = getPIMElementType(op.getInputs());
+    if (!element_type) {
+      return rewriter.notifyMatchFailure(op, "unsupported PIM element type");
     }
-    llvm::outs() << "\n";
 
     int dim_m;
     int dim_n;
@@ -108,48 +115,78 @@ struct MatmulOpPattern : public mlir::OpRewritePattern<linalg::MatmulOp> {
     int split_type = 2;
 
     if (!(dim_k == shape_r[0])) { // col-wise, all-reduce
-      llvm::outs() << "ConvertMatmulOp.cpp: column-wise\n";
+      LLVM_DEBUG(llvm::dbgs() << "ConvertMatmulOp.cpp: column-wise\n");
       split_type = 0;
     }
     
     else if (!(dim_n == shape_r[1])) { // row-wise, all-gather
-      // llvm::outs() << "ConvertMatmulOp.cpp: row-wise\n";
+      LLVM_DEBUG(llvm::dbgs() << "ConvertMatmulOp.cpp: row-wise\n");
       split_type = 1;
     }
     
-    // llvm::outs() << "ConvertMatmulOp.cpp: MNK: " << dim_m << " " << dim_n << " " << dim_k << "\n";
+    LLVM_DEBUG(llvm::dbgs() << "ConvertMatmulOp.cpp: MNK: " << dim_m << " " << dim_n << " " << dim_k << "\n");
     int act = 0;
     bool is_multi_bias = false;
     if (layer == "fc1") {
-      // llvm::outs() << "ConvertMatmulOp.cpp: Matmul with the activation function\n";
+      LLVM_DEBUG(llvm::dbgs() << "ConvertMatmulOp.cpp: Matmul with the activation function\n");
       act = 1;
     }
     if ((layer == "c_proj+residual")||(layer=="fc2+residual")) {
       is_multi_bias = true;
     }
     
-    int d_model = decoder_config[0];
-    
     mlir::Value lhs = op.getInputs()[0];
     mlir::Value rhs = op.getInputs()[1];
     mlir::Value result = op.getOutputs()[0];
 
-    mlir::Value dim_m_val = rewriter.create<mlir::arith::ConstantIntOp>(op.getLoc(), dim_m, 32);
+    // M is the number of tokens of the batch. When several sequences are
+    // decoded together it is only known at runtime and read from the push
+    // constant the activations are sized by; M is never tiled so the tokens
+    // share one pass over the weights.
+    mlir::Value dim_m_val =
+        getPIMDimValue(rewriter, op.getLoc(), inputTensor_l, 0, dim_m);
+    if (!dim_m_val) {
+      return rewriter.notifyMatchFailure(op, "dynamic batch size is not a push constant");
+    }
     mlir::Value dim_n_val = rewriter.create<mlir::arith::ConstantIntOp>(op.getLoc(), dim_n, 32);
     mlir::Value dim_k_val = rewriter.create<mlir::arith::ConstantIntOp>(op.getLoc(), dim_k, 32);
     // mlir::Value act_val = rewriter.create<mlir::arith::ConstantIntOp>(op.getLoc(), act, 32);
     
+    Operation *pim_op = nullptr;
     if (layer=="c_attn")
-      rewriter.create<IREE::PIM::QKVGenOp>(op.getLoc(), dim_m_val, dim_n_val, dim_k_val);
+      pim_op = rewriter.create<IREE::PIM::QKVGenOp>(op.getLoc(), dim_m_val, dim_n_val, dim_k_val);
 
     else if (layer == "c_proj+residual")
-      rewriter.create<IREE::PIM::OutProjOp>(op.getLoc(), dim_m_val, dim_n_val, dim_k_val);
+      pim_op = rewriter.create<IREE::PIM::OutProjOp>(op.getLoc(), dim_m_val, dim_n_val, dim_k_val);
 
     else if (layer=="fc1")
-      rewriter.create<IREE::PIM::FFN1Op>(op.getLoc(), dim_m_val, dim_n_val, dim_k_val);
+      pim_op = rewriter.create<IREE::PIM::FFN1Op>(op.getLoc(), dim_m_val, dim_n_val, dim_k_val);
+
+    else if (layer == "fc1_gate")
+      pim_op = rewriter.create<IREE::PIM::FFNGateOp>(op.getLoc(), dim_m_val, dim_n_val, dim_k_val);
+
+    else if (layer == "fc1+swiglu")
+      pim_op = rewriter.create<IREE::PIM::SwiGLUOp>(op.getLoc(), dim_m_val, dim_n_val, dim_k_val);
 
     else if (layer=="fc2+residual")
-      rewriter.create<IREE::PIM::FFN2Op>(op.getLoc(), dim_m_val, dim_n_val, dim_k_val);
+      pim_op = rewriter.create<IREE::PIM::FFN2Op>(op.getLoc(), dim_m_val, dim_n_val, dim_k_val);
+
+    else if (layer == "lm_head")
+      pim_op = rewriter.create<IREE::PIM::LMHeadOp>(op.getLoc(), dim_m_val, dim_n_val, dim_k_val);
+
+    // Encoded into the executable by the PIM target backend. Split results
+    // are only complete after a sync across devices: partial sums of a
+    // col-wise split are all-reduced and slices of a row-wise split are
+    // all-gathered.
+    if (pim_op) {
+      pim_op->setAttr("pim.split_type", rewriter.getI32IntegerAttr(split_type));
+      pim_op->setAttr("pim.element_type",
+                      rewriter.getI32IntegerAttr(*element_type));
+      if (num_device != 1 && split_type != 2) {
+        pim_op->setAttr("pim.sync", rewriter.getStringAttr(
+                                        split_type == 0 ? "reduce" : "gather"));
+      }
+    }
     
     /*
     if ((sync == "reduce") && (num_device!=1)) {
@@ -160,7 +197,7 @@ struct MatmulOpPattern : public mlir::OpRewritePattern<linalg::MatmulOp> {
       rewriter.create<IREE::PIM::AllGatherOp>(op.getLoc());
     */
 
-    llvm::outs() << "ConvertMatmulOp.cpp: MatmulOpPattern End" << "\n";
+    LLVM_DEBUG(llvm::dbgs() << "ConvertMatmulOp.cpp: MatmulOpPattern End" << "\n");
     return mlir::success();
   }
 
@@ -179,7 +216,7 @@ struct EraseFlowDispatchTensorStoreOpPattern : public mlir::OpRewritePattern<IRE
 
   mlir::LogicalResult matchAndRewrite(IREE::Flow::DispatchTensorStoreOp op, PatternRewriter &rewriter) const override {
     
-    llvm::outs() << "\nEraseFlowDispatchTensorStoreOpPattern\n";
+    LLVM_DEBUG(llvm::dbgs() << "\nEraseFlowDispatchTensorStoreOpPattern\n");
     rewriter.eraseOp(op);
     return mlir::success();
   }
@@ -190,7 +227,6 @@ struct EraseFlowDispatchTensorStoreOpPattern : public mlir::OpRewritePattern<IRE
 void populateLinalgMatmulToPIMPatterns(MLIRContext* context, RewritePatternSet &patterns, bool is_fused_matmul, 
   std::vector<std::pair<int, int>> hal_buffer_info, string layer, string sync, int num_device, std::vector<int> decoder_config) {
 
-  // llvm::outs() << "ConvertMatmulOp: populateLinalgToPIMPatterns\n";
   context->getOrLoadDialect<IREE::PIM::PIMDialect>();
   context->getOrLoadDialect<IREE::Flow::FlowDialect>();
   context->getOrLoadDialect<mlir::arith::ArithDialect>();
@@ -10,16 +10,20 @@
 #include "iree/compiler/Dialect/PIM/IR/PIMOps.h"
 #include "iree/compiler/Dialect/Flow/IR/FlowDialect.h"
 #include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
+#include "llvm/Support/Debug.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Math/IR/Math.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/Dominance.h"
 #include "mlir/Transforms/DialectConversion.h"
+#include "mlir/IR/TypeUtilities.h"
 #include "mlir/IR/Value.h"
-#include <iostream>
 #include <bitset>
 
+#define DEBUG_TYPE "iree-linalg-to-pim"
+
 namespace mlir {
 namespace iree_compiler {
 
@@ -32,7 +36,7 @@ extern void populateLinalgGenericToPIMPatterns(MLIRContext* context, RewritePatt
 void populateLinalgToPIMPatterns(MLIRContext* context, RewritePatternSet &patterns, bool is_fused_matmul, 
   std::vector<std::pair<int, int>> hal_buffer_info, string layer, string sync, int num_device, std::vector<int> decoder_config) {
 
-  std::cout<< "\npopulateLinalgToPIMPatterns\n";
+  LLVM_DEBUG(llvm::dbgs() << "\npopulateLinalgToPIMPatterns\n");
 
   populateLinalgMatmulToPIMPatterns(context, patterns, is_fused_matmul, hal_buffer_info, layer, sync, num_device, decoder_config);
   populateLinalgBatchMatmulToPIMPatterns(context, patterns, is_fused_matmul, hal_buffer_info, layer, sync, num_device, decoder_config);
@@ -40,5 +44,50 @@ void populateLinalgToPIMPatterns(MLIRContext* context, RewritePatternSet &patter
 
 }
 
+Optional<int32_t> getPIMElementType(ValueRange inputs) {
+  Optional<int32_t> elementType;
+  for (Value input : inputs) {
+    Type type = getElementTypeOrSelf(input.getType());
+    Optional<int32_t> inputType;
+    if (type.isF32()) inputType = 0;
+    else if (type.isF16()) inputType = 1;
+    else if (type.isBF16()) inputType = 2;
+    else if (type.isInteger(8)) inputType = 3;
+    if (!inputType || (elementType && *elementType != *inputType)) {
+      return std::nullopt;
+    }
+    elementType = inputType;
+  }
+  return elementType;
+}
+
+Value getPIMDimValue(OpBuilder &builder, Location loc, Value tensor,
+                     int64_t dim, int64_t staticSize) {
+  auto tensorType = tensor.getType().cast<ShapedType>();
+  if (!tensorType.isDynamicDim(dim)) {
+    return builder.create<arith::ConstantIntOp>(loc, staticSize, 32);
+  }
+  // Intermediate results of the dispatch (such as the exponentials that
+  // softmax normalizes) have the dims of the init they were computed into.
+  while (auto linalgOp = tensor.getDefiningOp<linalg::LinalgOp>()) {
+    auto result = tensor.cast<OpResult>();
+    tensor = linalgOp.getDpsInitOperand(result.getResultNumber())->get();
+  }
+  Value size;
+  if (auto emptyOp = tensor.getDefiningOp<tensor::EmptyOp>()) {
+    size = emptyOp.getDynamicSize(dim);
+  } else if (auto loadOp =
+                 tensor.getDefiningOp<IREE::Flow::DispatchTensorLoadOp>()) {
+    SmallVector<OpFoldResult> sizes = loadOp.getMixedSizes();
+    // Rank-reduced loads don't map result dims to sizes one to one.
+    if (sizes.size() != static_cast<size_t>(tensorType.getRank())) {
+      return Value();
+    }
+    size = sizes[dim].dyn_cast<Value>();
+  }
+  if (!size) return Value();
+  return builder.create<arith::IndexCastOp>(loc, builder.getI32Type(), size);
+}
+
 }  // namespace iree_compiler
 }  // namespace mlir
@@ -29,6 +29,23 @@ namespace iree_compiler {
 void populateLinalgToPIMPatterns(MLIRContext* context, RewritePatternSet &patterns, bool is_fused_matmul, 
     std::vector<std::pair<int, int>> hal_buffer_info, string layer, string sync, int num_device, std::vector<int> decoder_config);
 
+// Returns the element type PIM instructions reading |inputs| operate on,
+// encoded as in pim_executable_def.fbs (0 f32, 1 f16, 2 bf16, 3 i8), or
+// std::nullopt if the inputs don't share an element type the device stores.
+// The patterns record it on the instructions they create as
+// `pim.element_type`.
+Optional<int32_t> getPIMElementType(ValueRange inputs);
+
+// Returns an i32 value holding dim |dim| of |tensor| for use as a PIM
+// instruction dim. Static dims are materialized as |staticSize|. Dynamic dims
+// (such as the sequence length of a KV cache during incremental decode) are
+// forwarded from the size of the flow.dispatch.tensor.load or tensor.empty
+// producing |tensor|, looking through the inits of linalg ops computing it,
+// so that the executable reads them from the push constant they were loaded
+// from. Returns a null value if a dynamic dim has no such size.
+Value getPIMDimValue(OpBuilder &builder, Location loc, Value tensor,
+                     int64_t dim, int64_t staticSize);
+
 
 }  // namespace iree_compiler
 }  // namespace mlir
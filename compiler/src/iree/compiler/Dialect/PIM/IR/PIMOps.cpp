@@ -6,6 +6,7 @@
 
 #include "iree/compiler/Dialect/PIM/IR/PIMOps.h"
 
+#include "iree/compiler/Dialect/PIM/IR/PIMDialect.h"
 #include "iree/compiler/Dialect/PIM/IR/PIMTypes.h"
 #include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
 #include "llvm/ADT/Hashing.h"
@@ -41,6 +42,167 @@ namespace PIM {
   // state.addTypes({result_type});
 }*/
 
+//===----------------------------------------------------------------------===//
+// Instruction verification
+//===----------------------------------------------------------------------===//
+
+// Element types the PIM target backend can encode (see GenOpCommand).
+static constexpr int64_t kMaxElementType = 3;
+
+// Verifies the dims and the attributes recorded on PIM instruction |op| by the
+// LinalgToPIM patterns. Dims that aren't constants are read from push
+// constants at runtime and can only be checked there.
+static LogicalResult verifyInstructionOp(Operation *op) {
+  for (auto [index, operand] : llvm::enumerate(op->getOperands())) {
+    APInt value;
+    if (matchPattern(operand, m_ConstantInt(&value)) &&
+        value.getSExtValue() <= 0) {
+      return op->emitOpError() << "dim " << index << " must be positive but is "
+                               << value.getSExtValue();
+    }
+  }
+
+  int64_t splitType = 2;
+  if (Attribute attr = op->getAttr("pim.split_type")) {
+    auto splitAttr = attr.dyn_cast<IntegerAttr>();
+    if (!splitAttr || splitAttr.getInt() < 0 || splitAttr.getInt() > 2) {
+      return op->emitOpError()
+             << "expects pim.split_type to be 0 (col-wise), 1 (row-wise) or "
+                "2 (none)";
+    }
+    splitType = splitAttr.getInt();
+  }
+
+  if (Attribute attr = op->getAttr("pim.element_type")) {
+    auto typeAttr = attr.dyn_cast<IntegerAttr>();
+    if (!typeAttr || typeAttr.getInt() < 0 ||
+        typeAttr.getInt() > kMaxElementType) {
+      return op->emitOpError() << "unsupported pim.element_type";
+    }
+  }
+
+  // Col-wise splits produce partial sums and row-wise splits slices of the
+  // result; each is completed by its own collective.
+  if (Attribute attr = op->getAttr("pim.sync")) {
+    auto syncAttr = attr.dyn_cast<StringAttr>();
+    if (!syncAttr ||
+        (syncAttr.getValue() != "reduce" && syncAttr.getValue() != "gather")) {
+      return op->emitOpError()
+             << "expects pim.sync to be \"reduce\" or \"gather\"";
+    }
+    int64_t expectedSplit = syncAttr.getValue() == "reduce" ? 0 : 1;
+    if (splitType != expectedSplit) {
+      return op->emitOpError()
+             << "pim.sync \"" << syncAttr.getValue()
+             << "\" does not match pim.split_type " << splitType;
+    }
+  }
+
+  if (Attribute attr = op->getAttr("pim.operand_slots")) {
+    auto slotsAttr = attr.dyn_cast<DenseI32ArrayAttr>();
+    if (!slotsAttr || slotsAttr.empty()) {
+      return op->emitOpError()
+             << "expects pim.operand_slots to end with the result slot";
+    }
+  }
+  return success();
+}
+
+LogicalResult LayerNorm1Op::verify() { return verifyInstructionOp(*this); }
+LogicalResult QKVGenOp::verify() { return verifyInstructionOp(*this); }
+LogicalResult QKMatmulOp::verify() { return verifyInstructionOp(*this); }
+LogicalResult SoftmaxOp::verify() { return verifyInstructionOp(*this); }
+LogicalResult SVMatmulOp::verify() { return verifyInstructionOp(*this); }
+LogicalResult OutProjOp::verify() { return verifyInstructionOp(*this); }
+LogicalResult LayerNorm2Op::verify() { return verifyInstructionOp(*this); }
+LogicalResult FFN1Op::verify() { return verifyInstructionOp(*this); }
+LogicalResult FFN2Op::verify() { return verifyInstructionOp(*this); }
+LogicalResult LMHeadOp::verify() { return verifyInstructionOp(*this); }
+LogicalResult GatherOp::verify() { return verifyInstructionOp(*this); }
+LogicalResult RMSNormOp::verify() { return verifyInstructionOp(*this); }
+LogicalResult RoPEOp::verify() { return verifyInstructionOp(*this); }
+LogicalResult FFNGateOp::verify() { return verifyInstructionOp(*this); }
+LogicalResult SwiGLUOp::verify() { return verifyInstructionOp(*this); }
+LogicalResult GQAQKMatmulOp::verify() { return verifyInstructionOp(*this); }
+LogicalResult GQASVMatmulOp::verify() { return verifyInstructionOp(*this); }
+
+LogicalResult ElementwiseOp::verify() {
+  // The instruction word holds at most 15 dims including the length.
+  if (getProgram().empty() || getProgram().size() > 14) {
+    return emitOpError() << "expects a program of 1 to 14 words";
+  }
+  for (int32_t word : getProgram()) {
+    if (word < 0) return emitOpError() << "program words must not be negative";
+  }
+  return verifyInstructionOp(*this);
+}
+
+//===----------------------------------------------------------------------===//
+// Instruction canonicalization
+//===----------------------------------------------------------------------===//
+
+// Returns true if dims |lhs| and |rhs| are known to be equal.
+static bool isSameDim(Value lhs, Value rhs) {
+  if (lhs == rhs) return true;
+  APInt lhsValue, rhsValue;
+  return matchPattern(lhs, m_ConstantInt(&lhsValue)) &&
+         matchPattern(rhs, m_ConstantInt(&rhsValue)) && lhsValue == rhsValue;
+}
+
+bool isDuplicateInstruction(Operation *prevOp, Operation *op) {
+  if (prevOp->getName() != op->getName() ||
+      prevOp->getNumOperands() != op->getNumOperands()) {
+    return false;
+  }
+  for (auto [prevDim, dim] :
+       llvm::zip(prevOp->getOperands(), op->getOperands())) {
+    if (!isSameDim(prevDim, dim)) return false;
+  }
+  NamedAttrList prevAttrs(prevOp->getAttrDictionary());
+  NamedAttrList attrs(op->getAttrDictionary());
+  prevAttrs.erase("pim.operand_slots");
+  attrs.erase("pim.operand_slots");
+  return prevAttrs.getDictionary(op->getContext()) ==
+         attrs.getDictionary(op->getContext());
+}
+
+namespace {
+
+// Erases a layer normalization that repeats the instruction right before it.
+// Both read the same bindings and overwrite the same result so the second
+// pass only recomputes it. Instructions of fused decoder blocks are numbered
+// for the resident intermediates they chain and are folded by ConvertToPIM
+// before the numbering is assigned.
+template <typename OpTy>
+struct FoldRepeatedInstruction : public OpRewritePattern<OpTy> {
+  using OpRewritePattern<OpTy>::OpRewritePattern;
+  LogicalResult matchAndRewrite(OpTy op,
+                                PatternRewriter &rewriter) const override {
+    if (op->hasAttr("pim.operand_slots")) return failure();
+    // The dims of each instruction are materialized right before it.
+    Operation *prevOp = op->getPrevNode();
+    while (prevOp && !isa_and_nonnull<PIMDialect>(prevOp->getDialect()) &&
+           isMemoryEffectFree(prevOp)) {
+      prevOp = prevOp->getPrevNode();
+    }
+    if (!prevOp || !isDuplicateInstruction(prevOp, op)) return failure();
+    rewriter.eraseOp(op);
+    return success();
+  }
+};
+
+}  // namespace
+
+void LayerNorm1Op::getCanonicalizationPatterns(RewritePatternSet &results,
+                                               MLIRContext *context) {
+  results.insert<FoldRepeatedInstruction<LayerNorm1Op>>(context);
+}
+
+void LayerNorm2Op::getCanonicalizationPatterns(RewritePatternSet &results,
+                                               MLIRContext *context) {
+  results.insert<FoldRepeatedInstruction<LayerNorm2Op>>(context);
+}
+
 }  // namespace PIM
 }  // namespace IREE
 }  // namespace iree_compiler
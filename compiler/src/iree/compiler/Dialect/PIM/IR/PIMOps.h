@@ -27,4 +27,20 @@
 #define GET_OP_CLASSES
 #include "iree/compiler/Dialect/PIM/IR/PIMOps.h.inc"  // IWYU pragma: export
 
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace PIM {
+
+// Returns true if PIM instruction |op| repeats |prevOp|: the same instruction
+// with the same dims and attributes. The `pim.operand_slots` of the fused
+// decoder blocks are not compared; callers chaining resident intermediates
+// must check that both read the same slots.
+bool isDuplicateInstruction(Operation *prevOp, Operation *op);
+
+}  // namespace PIM
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
+
 #endif  // IREE_COMPILER_DIALECT_PIM_IR_PIMOPS_H_
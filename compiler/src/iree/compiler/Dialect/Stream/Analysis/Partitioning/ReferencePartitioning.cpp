@@ -6,6 +6,7 @@
 
 #include "iree/compiler/Dialect/Stream/Analysis/Partitioning.h"
 #include "iree/compiler/Dialect/Stream/Analysis/ResourceHazards.h"
+#include "iree/compiler/Dialect/Stream/IR/StreamOps.h"
 #include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallPtrSet.h"
@@ -38,6 +39,12 @@ static std::unique_ptr<AsmState> getRootAsmState(Block *block) {
   return nullptr;
 }
 
+// Returns true if |op| only moves data and can be placed on a transfer queue.
+static bool isTransferOp(Operation &op) {
+  return isa<IREE::Stream::AsyncCloneOp, IREE::Stream::AsyncUpdateOp,
+             IREE::Stream::AsyncCopyOp, IREE::Stream::AsyncTransferOp>(op);
+}
+
 // This is terrible. See Stream/Analysis/Partition.h for a description of what
 // a real implementation would do. We want cost modeling for tie breakers when
 // an op could be in multiple partitions, cloning for ops that are not worth
@@ -50,6 +57,8 @@ PartitionSet partitionStreamableOpsReference(
     unsigned ordinal;
     // Affinity of the partition.
     IREE::Stream::AffinityAttr affinity;
+    // Whether the partition only contains transfer ops.
+    bool isTransfer = false;
     // Ops present in the partition; ops may be present in multiple partitions.
     SetVector<Operation *> ops;
     // Ops that were cloned and are known not to have their values escape.
@@ -75,6 +84,9 @@ PartitionSet partitionStreamableOpsReference(
 
   auto asmState = getRootAsmState(block);
 
+  // When set transfers are split from compute and placed on this affinity.
+  auto transferAffinity = config.getTransferAffinity();
+
   for (auto &op : llvm::reverse(*block)) {
     // Skip constants; they just add noise (and since they are heavily CSE'd
     // they have lots of users to test).
@@ -113,6 +125,8 @@ PartitionSet partitionStreamableOpsReference(
     if (auto affinityOp = dyn_cast<IREE::Stream::AffinityOpInterface>(op)) {
       affinityAttr = affinityOp.getAffinity();
     }
+    bool isTransfer = transferAffinity && isTransferOp(op);
+    if (isTransfer && !affinityAttr) affinityAttr = transferAffinity;
 
     LLVM_DEBUG({
       llvm::dbgs() << "====\nPartitioning op:\n";
@@ -148,8 +162,15 @@ PartitionSet partitionStreamableOpsReference(
     candidates |= consumers;
     candidates &= usableBuilders;
 
-    // Prune candidates that do not have a compatible affinity.
+    // Prune candidates that do not have a compatible affinity. Transfers and
+    // compute never share a partition so that they can overlap.
     for (auto ordinal : candidates.set_bits()) {
+      if (builders[ordinal]->isTransfer != isTransfer) {
+        LLVM_DEBUG(llvm::dbgs() << "Candidate partition " << ordinal
+                                << " incompatible (transfer)\n");
+        candidates.reset(ordinal);
+        continue;
+      }
       if (!IREE::Stream::AffinityAttr::canExecuteTogether(
               affinityAttr, builders[ordinal]->affinity)) {
         LLVM_DEBUG(llvm::dbgs()
@@ -221,6 +242,7 @@ PartitionSet partitionStreamableOpsReference(
     auto builder = std::make_unique<PartitionBuilder>();
     builder->ordinal = builders.size();
     builder->affinity = affinityAttr;
+    builder->isTransfer = isTransfer;
     builder->insert(&op);
     LLVM_DEBUG(llvm::dbgs()
                << "Created partition " << builder->ordinal << "\n");
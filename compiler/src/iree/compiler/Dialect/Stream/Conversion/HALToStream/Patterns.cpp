@@ -158,7 +158,30 @@ struct ConvertTensorExportOp
         IREE::Stream::Lifetime::External);
     auto exportSource = adaptor.getSource();
     auto exportSize = source.resourceSize;
-    if (adaptor.getTargetStorage()) {
+    auto donatedResource = findDonatedResource(op, rewriter);
+    if (donatedResource) {
+      // The target storage backs an input of the same type. Update the input
+      // resource in-place instead of importing the storage a second time so
+      // that the aliasing is visible: copy-on-write materialization and copy
+      // elision will then order the update after all uses of the input.
+      auto donated = *donatedResource;
+      Value targetResource = donated.resource;
+      if (targetResource.getType() != externalType) {
+        targetResource = rewriter.create<IREE::Stream::AsyncTransferOp>(
+            op.getLoc(), externalType, targetResource, donated.resourceSize,
+            donated.resourceSize,
+            /*source_affinity=*/nullptr,
+            /*result_affinity=*/nullptr);
+      }
+      auto zeroOffset = rewriter.create<arith::ConstantIndexOp>(op.getLoc(), 0);
+      auto updateOp = rewriter.create<IREE::Stream::AsyncUpdateOp>(
+          op.getLoc(), externalType, targetResource, donated.resourceSize,
+          zeroOffset, source.resourceSize, source.resource,
+          source.resourceSize,
+          /*affinity=*/nullptr);
+      exportSource = updateOp.getResult();
+      exportSize = updateOp.getTargetSize();
+    } else if (adaptor.getTargetStorage()) {
       // Query the target storage buffer length; we will only populate up to
       // what is required for the output.
       auto storageSize =
@@ -208,6 +231,37 @@ struct ConvertTensorExportOp
         /*affinity=*/nullptr);
     return success();
   }
+
+  // Returns the converted resource imported from the buffer view that backs
+  // the target storage of |op|, if any. This is the pattern produced for
+  // inputs donated to results (`iree.abi.donate`):
+  //   %storage = hal.buffer_view.buffer<%view : !hal.buffer_view>
+  //   %input = hal.tensor.import %view : !hal.buffer_view -> tensor<4xf32>
+  //   ...
+  //   hal.tensor.export %result into %storage : tensor<4xf32> -> ...
+  // Only statically-shaped imports of the same type as the exported value are
+  // matched so that the update is known to fit.
+  static Optional<ConvertedTensor> findDonatedResource(
+      IREE::HAL::TensorExportOp op, ConversionPatternRewriter &rewriter) {
+    if (!op.getTargetStorage()) return std::nullopt;
+    auto bufferOp =
+        op.getTargetStorage().getDefiningOp<IREE::HAL::BufferViewBufferOp>();
+    if (!bufferOp) return std::nullopt;
+    auto sourceType = op.getSourceEncoding().dyn_cast<RankedTensorType>();
+    if (!sourceType || !sourceType.hasStaticShape()) return std::nullopt;
+    for (auto user : bufferOp.getBufferView().getUsers()) {
+      auto importOp = dyn_cast<IREE::HAL::TensorImportOp>(user);
+      if (!importOp || importOp.getTargetEncoding() != sourceType ||
+          importOp->getBlock() != op->getBlock()) {
+        continue;
+      }
+      // The import must have already been converted.
+      auto resource = rewriter.getRemappedValue(importOp.getTarget());
+      if (!resource || resource.getType().isa<TensorType>()) continue;
+      return consumeTensorOperand(op.getLoc(), resource, rewriter);
+    }
+    return std::nullopt;
+  }
 };
 
 // %r0b, %r1b = hal.tensor.barrier join(%r0a : tensor<4xf32>,
@@ -84,3 +84,24 @@ func.func @exportBufferViewInPlace(%tensor: tensor<?x?x4xf32>, %dim0: index, %di
   // CHECK: return %[[STORAGE_RESULT]]
   return %0 : !hal.buffer_view
 }
+
+// -----
+
+// Tests that exporting into the storage of an input donated to the result
+// updates the imported input resource instead of importing the storage again.
+
+// CHECK-LABEL: @exportBufferViewDonated
+// CHECK-SAME: (%[[VIEW:.+]]: !hal.buffer_view, %[[TENSOR:.+]]: !stream.resource<*>, %[[TENSOR_SIZE:.+]]: index)
+func.func @exportBufferViewDonated(%view: !hal.buffer_view, %tensor: tensor<4xf32>) -> (tensor<4xf32>, !hal.buffer_view) {
+  %storage = hal.buffer_view.buffer<%view : !hal.buffer_view> : !hal.buffer
+  //      CHECK: %[[IMPORT:.+]] = stream.tensor.import %[[VIEW]]
+  // CHECK-NEXT: %[[INPUT:.+]] = stream.async.transfer %[[IMPORT]]
+  %0 = hal.tensor.import %view : !hal.buffer_view -> tensor<4xf32>
+  //  CHECK-NOT: stream.tensor.import
+  //      CHECK: %[[UPDATE:.+]] = stream.async.update %[[TENSOR]], %[[IMPORT]]
+  // CHECK-SAME:   -> %[[IMPORT]] as !stream.resource<external>
+  // CHECK-NEXT: %[[RESULT:.+]] = stream.tensor.export %[[UPDATE]]
+  %1 = hal.tensor.export %tensor into %storage : tensor<4xf32> -> !hal.buffer_view
+  // CHECK: return %[[INPUT]], %{{.+}}, %[[RESULT]]
+  return %0, %1 : tensor<4xf32>, !hal.buffer_view
+}
@@ -1436,6 +1436,12 @@ void AsyncFillOp::getCanonicalizationPatterns(RewritePatternSet &results,
 
 OpFoldResult AsyncUpdateOp::fold(FoldAdaptor operands) {
   if (getUpdateSize() == getTargetSize()) {
+    // External targets are storage provided to us (such as a donated input)
+    // and the update must land in them; replacing it would drop the placement.
+    auto targetType = getTarget().getType().cast<IREE::Stream::ResourceType>();
+    if (targetType.getLifetime() == IREE::Stream::Lifetime::External) {
+      return {};
+    }
     // If updating the entire target then just replace with the update.
     // Note that this breaks copy-on-write semantics but will be fixed up during
     // canonicalization if needed.
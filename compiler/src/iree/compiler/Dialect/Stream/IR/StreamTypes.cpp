@@ -240,6 +240,19 @@ Attribute PartitioningConfigAttr::parse(AsmParser &p, Type type) {
   } else if (failed(p.parseString(&favorStr))) {
     return {};
   }
+  AffinityAttr transferAffinity;
+  if (succeeded(p.parseOptionalComma())) {
+    Attribute attr;
+    if (failed(p.parseKeyword("transfers")) || failed(p.parseEqual()) ||
+        failed(p.parseAttribute(attr))) {
+      return {};
+    }
+    transferAffinity = attr.dyn_cast<AffinityAttr>();
+    if (!transferAffinity) {
+      p.emitError(p.getNameLoc(), "expected an affinity for transfers");
+      return {};
+    }
+  }
   if (failed(p.parseGreater())) return {};
   auto favor = symbolizeFavor(favorStr);
   if (!favor.has_value()) {
@@ -247,13 +260,17 @@ Attribute PartitioningConfigAttr::parse(AsmParser &p, Type type) {
     return {};
   }
   return PartitioningConfigAttr::get(
-      FavorAttr::get(p.getContext(), favor.value()));
+      FavorAttr::get(p.getContext(), favor.value()), transferAffinity);
 }
 
 void PartitioningConfigAttr::print(AsmPrinter &p) const {
   p << "<";
   p << "favor-";
   p << stringifyFavor(getFavor().getValue());
+  if (auto transferAffinity = getTransferAffinity()) {
+    p << ", transfers = ";
+    p.printAttribute(transferAffinity);
+  }
   p << ">";
 }
 
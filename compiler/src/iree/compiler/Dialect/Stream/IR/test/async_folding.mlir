@@ -118,6 +118,17 @@ func.func @FoldAsyncUpdateOp(%arg0: !stream.resource<*>, %arg1: !stream.resource
 
 // -----
 
+// CHECK-LABEL: @DontFoldAsyncUpdateOpIntoExternal
+func.func @DontFoldAsyncUpdateOpIntoExternal(%arg0: !stream.resource<external>, %arg1: !stream.resource<*>, %arg2: index) -> !stream.resource<external> {
+  %c0 = arith.constant 0 : index
+  // CHECK: %[[UPDATE:.+]] = stream.async.update %arg1, %arg0
+  %0 = stream.async.update %arg1, %arg0[%c0 to %arg2] : !stream.resource<*>{%arg2} -> %arg0 as !stream.resource<external>{%arg2}
+  // CHECK: return %[[UPDATE]]
+  return %0 : !stream.resource<external>
+}
+
+// -----
+
 // CHECK-LABEL: @CombineSplatUpdateFromToFill
 func.func @CombineSplatUpdateFromToFill(%arg0: !stream.resource<*>, %arg1: index) -> !stream.resource<*> {
   %c0 = arith.constant 0 : index
@@ -24,6 +24,7 @@
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/Diagnostics.h"
+#include "mlir/IR/FunctionInterfaces.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
@@ -116,6 +117,19 @@ class LastUsers
 };
 const char LastUsers::ID = 0;
 
+// Returns true if |arg| is a function argument marked as `stream.donated`.
+// Callers of the function (including those outside of the program) pass the
+// last reference to the resource and will not observe it after the call, so
+// the callee may update it in-place. This is used for persistent resources like
+// KV caches that are round-tripped through each invocation.
+static bool isDonatedArgument(BlockArgument arg) {
+  if (!arg.getParentBlock()->isEntryBlock()) return false;
+  auto funcOp =
+      dyn_cast<FunctionOpInterface>(arg.getParentBlock()->getParentOp());
+  if (!funcOp) return false;
+  return funcOp.getArgAttr(arg.getArgNumber(), "stream.donated") != nullptr;
+}
+
 class ArgumentSemantics
     : public DFX::StateWrapper<DFX::BitIntegerState<uint8_t, 3, 0>,
                                DFX::ValueElement> {
@@ -247,7 +261,7 @@ class ArgumentSemantics
       // Call argument.
       auto callableOp =
           cast<mlir::CallableOpInterface>(arg.getParentBlock()->getParentOp());
-      traversalResult |= solver.getExplorer().walkIncomingCalls(
+      auto callResult = solver.getExplorer().walkIncomingCalls(
           callableOp, [&](mlir::CallOpInterface callOp) -> WalkResult {
             unsigned baseIdx = callOp.getArgOperands().getBeginOperandIndex();
             auto &sourceOperand =
@@ -255,6 +269,13 @@ class ArgumentSemantics
             updateFromPredecessorUse(sourceOperand, solver);
             return WalkResult::advance();
           });
+      // Callers we can't see (such as those of public functions) are unknown
+      // unless they have promised to donate the argument. Callers we can see
+      // were still checked above.
+      if (callResult == TraversalResult::INCOMPLETE &&
+          !isDonatedArgument(arg)) {
+        traversalResult |= TraversalResult::INCOMPLETE;
+      }
     } else {
       // Branch argument.
       traversalResult |= solver.getExplorer().walkIncomingBranchOperands(
@@ -35,6 +35,33 @@ namespace {
 // Emplacement
 //===----------------------------------------------------------------------===//
 
+// Returns the resource |value| was transferred from, if any. Transfers between
+// the same lifetimes are elided after usage refinement and the resources will
+// then alias.
+static Value stripTransfers(Value value) {
+  while (auto transferOp =
+             value.getDefiningOp<IREE::Stream::AsyncTransferOp>()) {
+    value = transferOp.getSource();
+  }
+  return value;
+}
+
+// Returns true if |resource| is an untied resource operand of |dispatchOp|.
+// Operands tied to results by prior emplacement are allowed as the dispatch
+// only writes distinct ranges of them.
+static bool isReadOperand(IREE::Stream::AsyncDispatchOp dispatchOp,
+                          Value resource) {
+  auto tiedOperandIndices = dispatchOp.getTiedResultOperandIndices();
+  resource = stripTransfers(resource);
+  for (auto [i, operand] : llvm::enumerate(dispatchOp.getResourceOperands())) {
+    if (stripTransfers(operand) != resource) continue;
+    if (!llvm::is_contained(tiedOperandIndices, static_cast<int64_t>(i))) {
+      return true;
+    }
+  }
+  return false;
+}
+
 static bool tryEmplaceDispatchOp(IREE::Stream::AsyncDispatchOp dispatchOp) {
   bool didChange = false;
   for (auto [resultIndex, result] : llvm::enumerate(dispatchOp.getResults())) {
@@ -78,6 +105,11 @@ static bool tryEmplaceDispatchOp(IREE::Stream::AsyncDispatchOp dispatchOp) {
     }
     if (!targetResource) continue;
 
+    // Ignore targets the dispatch also reads from. This happens when updating
+    // an input in-place (such as one donated to a result) and placing the
+    // result into it would have the dispatch overwrite data it may still read.
+    if (isReadOperand(dispatchOp, targetResource)) continue;
+
     // Add operand and tie the result.
     operandIndex = dispatchOp.getResourceOperands().size();
     dispatchOp.getResourceOperandsMutable().append(targetResource);
@@ -63,7 +63,17 @@ static Value packSlicesWithNoAliasing(
   return builder.createOrFold<IREE::Util::AlignOp>(loc, offset, rangeAlignment);
 }
 
-// Packs a set of statically-sized slices by greedy strip packing.
+// Static offsets assigned to a set of slices by one packing heuristic.
+struct StaticPacking {
+  // Offset of each slice in the order the slices were provided.
+  SmallVector<int64_t> offsets;
+  // Total number of bytes required for all slices.
+  int64_t highwaterMark = 0;
+};
+
+// Packs a set of statically-sized slices by greedy strip packing, visiting the
+// slices in |order| and placing each into the smallest gap it fits in between
+// the reservations it overlaps in lifetime with.
 //
 // This is the same algorithm used in tflite here:
 // https://github.com/tensorflow/tensorflow/blob/master/tensorflow/lite/simple_memory_arena.cc
@@ -77,17 +87,10 @@ static Value packSlicesWithNoAliasing(
 // 2D strip packing is NP-hard) such as
 // https://www.sciencedirect.com/science/article/pii/S0925772113001016 that
 // someone with a brain able to parse mathy papers can try implementing.
-//
-// Slice packed offset SSA values will be updated and start at the given
-// |baseOffset|. Returns |baseOffset| + the total size of the allocation
-// aligned to the requirements of |resourceConfig|.
-static Value packStaticSlicesGreedily(
-    IREE::Stream::ResourcePackOp packOp, Value baseOffset,
-    ArrayRef<Slice> slices, IREE::Stream::ResourceConfigAttr resourceConfig,
-    IndexSet &indexSet, OpBuilder &builder) {
-  int64_t offsetAlignment = resourceConfig.getMinBufferOffsetAlignment();
-  int64_t rangeAlignment = resourceConfig.getMinBufferRangeAlignment();
-
+static StaticPacking packStaticSlicesBestFit(ArrayRef<Slice> slices,
+                                             ArrayRef<int64_t> alignedSizes,
+                                             ArrayRef<unsigned> order,
+                                             int64_t offsetAlignment) {
   struct Reservation {
     const Slice *slice = nullptr;
     int64_t staticOffset = 0;
@@ -95,14 +98,14 @@ static Value packStaticSlicesGreedily(
   };
   static constexpr int64_t UNASSIGNED = INT64_MAX;
 
+  StaticPacking packing;
+  packing.offsets.resize(slices.size(), 0);
   std::list<Reservation> reservations;
-  int64_t highwaterMark = 0;
-  for (auto &slice : slices) {
+  for (unsigned i : order) {
+    auto &slice = slices[i];
     int64_t bestOffset = UNASSIGNED;
     int64_t bestOffsetFit = UNASSIGNED;
-    int64_t staticSize =
-        cast<arith::ConstantIndexOp>(slice.dynamicSize.getDefiningOp()).value();
-    int64_t alignedSize = IREE::Util::align(staticSize, rangeAlignment);
+    int64_t alignedSize = alignedSizes[i];
 
     // Iterate through reservations (sorted by ascending offset) and identify
     // gaps in which the slice will fit. To reduce wastage we want to find the
@@ -121,7 +124,7 @@ static Value packStaticSlicesGreedily(
       if (alignedOffset + alignedSize <= reservation.staticOffset &&
           reservation.staticOffset - alignedOffset < bestOffsetFit) {
         bestOffset = alignedOffset;
-        bestOffsetFit = reservation.staticOffset - currentOffset;
+        bestOffsetFit = reservation.staticOffset - alignedOffset;
       }
       currentOffset = std::max(
           currentOffset, reservation.staticOffset + reservation.staticSize);
@@ -141,15 +144,90 @@ static Value packStaticSlicesGreedily(
       ++insertionIt;
     }
     reservations.insert(insertionIt, reservation);
-    slice.packedOffset.replaceAllUsesWith(builder.createOrFold<arith::AddIOp>(
-        packOp.getLoc(), baseOffset, indexSet.get(bestOffset)));
+    packing.offsets[i] = bestOffset;
 
     // Update highwater mark indicating how much memory needs to be allocated
     // for the entire slab.
-    highwaterMark = std::max(highwaterMark, bestOffset + alignedSize);
+    packing.highwaterMark =
+        std::max(packing.highwaterMark, bestOffset + alignedSize);
+  }
+  return packing;
+}
+
+// Returns the peak number of bytes live at any point in the lifetimes of
+// |slices|. No packing can require less memory than this.
+static int64_t computeLivenessLowerBound(ArrayRef<Slice> slices,
+                                         ArrayRef<int64_t> alignedSizes) {
+  // Sweep over the lifetime boundaries with ends ordered after starts at the
+  // same point as lifetime intervals are inclusive.
+  SmallVector<std::tuple<int64_t, bool, int64_t>> events;
+  events.reserve(slices.size() * 2);
+  for (auto [slice, alignedSize] : llvm::zip_equal(slices, alignedSizes)) {
+    events.push_back({slice.lifetimeStart, /*isEnd=*/false, alignedSize});
+    events.push_back({slice.lifetimeEnd, /*isEnd=*/true, alignedSize});
   }
+  llvm::sort(events);
+  int64_t liveSize = 0;
+  int64_t peakSize = 0;
+  for (auto [point, isEnd, size] : events) {
+    liveSize += isEnd ? -size : size;
+    peakSize = std::max(peakSize, liveSize);
+  }
+  return peakSize;
+}
+
+// Packs a set of statically-sized slices with the heuristic producing the
+// smallest slab. Both the lifetime order and best-fit decreasing (largest
+// slices first) are tried as neither is strictly better than the other.
+//
+// Slice packed offset SSA values will be updated and start at the given
+// |baseOffset|. Returns |baseOffset| + the total size of the allocation
+// aligned to the requirements of |resourceConfig|. |outPackedSize| and
+// |outLowerBound| are set to the total size and to the liveness lower bound.
+static Value packStaticSlicesGreedily(
+    IREE::Stream::ResourcePackOp packOp, Value baseOffset,
+    ArrayRef<Slice> slices, IREE::Stream::ResourceConfigAttr resourceConfig,
+    IndexSet &indexSet, OpBuilder &builder, int64_t &outPackedSize,
+    int64_t &outLowerBound) {
+  int64_t offsetAlignment = resourceConfig.getMinBufferOffsetAlignment();
+  int64_t rangeAlignment = resourceConfig.getMinBufferRangeAlignment();
 
-  highwaterMark = IREE::Util::align(highwaterMark, rangeAlignment);
+  SmallVector<int64_t> alignedSizes;
+  alignedSizes.reserve(slices.size());
+  for (auto &slice : slices) {
+    int64_t staticSize =
+        cast<arith::ConstantIndexOp>(slice.dynamicSize.getDefiningOp()).value();
+    alignedSizes.push_back(IREE::Util::align(staticSize, rangeAlignment));
+  }
+
+  SmallVector<unsigned> lifetimeOrder =
+      llvm::to_vector(llvm::seq<unsigned>(0, slices.size()));
+  StaticPacking packing = packStaticSlicesBestFit(slices, alignedSizes,
+                                                  lifetimeOrder,
+                                                  offsetAlignment);
+
+  SmallVector<unsigned> decreasingOrder = lifetimeOrder;
+  llvm::stable_sort(decreasingOrder, [&](unsigned lhs, unsigned rhs) {
+    return alignedSizes[lhs] > alignedSizes[rhs];
+  });
+  StaticPacking decreasingPacking = packStaticSlicesBestFit(
+      slices, alignedSizes, decreasingOrder, offsetAlignment);
+  if (decreasingPacking.highwaterMark < packing.highwaterMark) {
+    packing = std::move(decreasingPacking);
+  }
+
+  for (auto [slice, offset] : llvm::zip_equal(slices, packing.offsets)) {
+    slice.packedOffset.replaceAllUsesWith(builder.createOrFold<arith::AddIOp>(
+        packOp.getLoc(), baseOffset, indexSet.get(offset)));
+  }
+
+  int64_t highwaterMark =
+      IREE::Util::align(packing.highwaterMark, rangeAlignment);
+  outPackedSize = highwaterMark;
+  outLowerBound = computeLivenessLowerBound(slices, alignedSizes);
+  LLVM_DEBUG(llvm::dbgs() << "packed " << slices.size() << " static slices "
+                          << "into " << highwaterMark << " bytes (liveness "
+                          << "lower bound " << outLowerBound << " bytes)\n");
   return builder.createOrFold<arith::AddIOp>(packOp.getLoc(), baseOffset,
                                              indexSet.get(highwaterMark));
 }
@@ -260,9 +338,9 @@ class LayoutSlicesPass : public LayoutSlicesBase<LayoutSlicesPass> {
       return;
     }
 
-    // NOTE: we could try several algorithms and compute which packs best. For
-    // now we just pack greedily as it's fast and what most existing ML
-    // frameworks do.
+    // NOTE: static slices are packed with a few greedy heuristics and the
+    // best one is kept; the totals are reported as pass statistics so that
+    // the achieved size can be compared against the liveness lower bound.
     parentOp.walk([&](IREE::Stream::ResourcePackOp packOp) {
       // Derive resource constraints based on pack affinity.
       auto resourceConfig = IREE::Stream::ResourceConfigAttr::lookup(packOp);
@@ -290,8 +368,13 @@ class LayoutSlicesPass : public LayoutSlicesBase<LayoutSlicesPass> {
       // compile time.
       auto offset = packOp.getOffset() ? packOp.getOffset() : indexSet.get(0);
       if (!staticSlices.empty()) {
+        int64_t packedSize = 0;
+        int64_t lowerBound = 0;
         offset = packStaticSlicesGreedily(packOp, offset, staticSlices,
-                                          resourceConfig, indexSet, builder);
+                                          resourceConfig, indexSet, builder,
+                                          packedSize, lowerBound);
+        staticBytesPacked += packedSize;
+        staticBytesLowerBound += lowerBound;
 
         // TODO(benvanik): make this an option; it can be useful for debugging
         // this code.
@@ -314,6 +397,14 @@ class LayoutSlicesPass : public LayoutSlicesBase<LayoutSlicesPass> {
       packOp.erase();
     });
   }
+
+ private:
+  Statistic staticBytesPacked{
+      this, "static-bytes-packed",
+      "Total bytes required for all statically-sized slices"};
+  Statistic staticBytesLowerBound{
+      this, "static-bytes-lower-bound",
+      "Total peak bytes live across statically-sized slices"};
 };
 
 }  // namespace
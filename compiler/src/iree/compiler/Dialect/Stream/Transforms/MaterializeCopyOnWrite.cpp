@@ -42,7 +42,9 @@ namespace {
 // remove the copies we insert here when possible.
 static bool isSafeToElideCOW(Value operand, IREE::Stream::ResourceType type) {
   // Can't do anything with block args without analysis - we don't know if the
-  // value they carry is the last user (move semantics).
+  // value they carry is the last user (move semantics). This includes function
+  // arguments marked `stream.donated` as callers within the program may still
+  // retain them; --iree-stream-elide-async-copies checks those callers.
   if (operand.isa<BlockArgument>()) return false;
 
   // If our value is a constant then we need to ensure that we aren't
@@ -10,6 +10,7 @@
 
 #include "iree/compiler/Dialect/Util/Transforms/Passes.h"
 #include "iree/compiler/Utils/PassUtils.h"
+#include "llvm/Support/CommandLine.h"
 #include "mlir/Conversion/SCFToControlFlow/SCFToControlFlow.h"
 #include "mlir/Pass/PassOptions.h"
 #include "mlir/Pass/PassRegistry.h"
@@ -22,6 +23,24 @@ namespace Stream {
 
 using FunctionLikeNest = MultiOpNest<func::FuncOp, IREE::Util::InitializerOp>;
 
+static llvm::cl::opt<bool> clPIMPlanCapacity(
+    "iree-stream-pim-plan-capacity",
+    llvm::cl::desc("Reports the memory footprint of PIM dispatches on each "
+                   "device and fails if it exceeds the device capacity."),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<bool> clPIMAutoDeviceCount(
+    "iree-stream-pim-auto-device-count",
+    llvm::cl::desc("Increases the PIM device count until the program fits "
+                   "when planning the PIM capacity."),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<int64_t> clPIMSequenceLength(
+    "iree-stream-pim-sequence-length",
+    llvm::cl::desc("Sequence length the PIM KV cache is planned for; 0 uses "
+                   "the token count the attention layers were compiled for."),
+    llvm::cl::init(0));
+
 //===----------------------------------------------------------------------===//
 // Utilities
 //===----------------------------------------------------------------------===//
@@ -305,6 +324,12 @@ void buildStreamTransformPassPipeline(
   buildStreamAsyncPassPipeline(passManager, transformOptions);
   buildStreamCmdPassPipeline(passManager, transformOptions);
 
+  // Check the PIM devices can hold the program once allocations are known.
+  if (clPIMPlanCapacity) {
+    passManager.addPass(IREE::Stream::createPlanPIMCapacityPass(
+        clPIMSequenceLength, clPIMAutoDeviceCount));
+  }
+
   // Dump statistics before the deeper optimizations happen.
   // Optimizations such as dispatch operand fusion remove information we can use
   // to determine memory usage by dispatches.
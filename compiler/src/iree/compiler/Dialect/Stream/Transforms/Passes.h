@@ -166,6 +166,9 @@ std::unique_ptr<OperationPass<mlir::ModuleOp>> createDumpStatisticsPass(
     DumpOutputFormat outputFormat = DumpOutputFormat::Pretty,
     std::string outputFile = "");
 
+std::unique_ptr<OperationPass<mlir::ModuleOp>> createPlanPIMCapacityPass(
+    int64_t sequenceLength = 0, bool autoDeviceCount = false);
+
 std::unique_ptr<OperationPass<mlir::ModuleOp>> createVerifyInputPass();
 std::unique_ptr<OperationPass<mlir::ModuleOp>>
 createVerifyLoweringToTensorsPass();
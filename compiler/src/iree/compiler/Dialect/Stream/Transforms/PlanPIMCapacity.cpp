@@ -0,0 +1,353 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
+#include "iree/compiler/Dialect/HAL/IR/HALDialect.h"
+#include "iree/compiler/Dialect/HAL/IR/HALTypes.h"
+#include "iree/compiler/Dialect/Stream/IR/StreamDialect.h"
+#include "iree/compiler/Dialect/Stream/IR/StreamOps.h"
+#include "iree/compiler/Dialect/Stream/Transforms/PassDetail.h"
+#include "iree/compiler/Dialect/Stream/Transforms/Passes.h"
+#include "iree/compiler/Dialect/Util/IR/UtilOps.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/Pass/Pass.h"
+
+#define DEBUG_TYPE "iree-stream-plan-pim-capacity"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Stream {
+
+namespace {
+
+// Partitioning set by GenerateMetaData on the ops offloaded to PIM.
+static const char kPIMPartitionAttr[] = "pim.partition";
+
+// Matches the PIM target backend registration and runtime limits.
+static const char kPIMBackend[] = "pim";
+static constexpr int64_t kMaxPIMDeviceCount = 64;
+
+// Static memory required by the program on each PIM device.
+struct PIMFootprint {
+  // Weights split across the devices by the chosen partitioning.
+  int64_t shardedWeightBytes = 0;
+  // Weights every device holds in full.
+  int64_t replicatedWeightBytes = 0;
+  // Largest transient allocation of a single submission.
+  int64_t peakTransientBytes = 0;
+  // KV cache bytes of all attention layers for one token.
+  int64_t kvBytesPerToken = 0;
+  // Key and value heads of the attention layers and the token count they were
+  // compiled for (-1 if dynamic).
+  int64_t kvHeadCount = 0;
+  int64_t tokenCount = -1;
+  // Set when a size was dynamic and the values above are lower bounds.
+  bool isDynamic = false;
+
+  // Returns the bytes of weights held by each of |deviceCount| devices.
+  int64_t getWeightBytes(int64_t deviceCount) const {
+    return llvm::divideCeil(shardedWeightBytes, deviceCount) +
+           replicatedWeightBytes;
+  }
+
+  // Returns the bytes of KV cache held by each of |deviceCount| devices for
+  // |sequenceLength| tokens. Attention is split by heads when they divide.
+  int64_t getKVBytes(int64_t deviceCount, int64_t sequenceLength) const {
+    int64_t bytes = kvBytesPerToken * sequenceLength;
+    if (kvHeadCount > 0 && kvHeadCount % deviceCount == 0) {
+      bytes /= deviceCount;
+    }
+    return bytes;
+  }
+
+  int64_t getTotalBytes(int64_t deviceCount, int64_t sequenceLength) const {
+    return getWeightBytes(deviceCount) + peakTransientBytes +
+           getKVBytes(deviceCount, sequenceLength);
+  }
+};
+
+// Returns the PIM partitioning of the first linalg op reading |bindingArg| of
+// a dispatch function or null if no PIM op reads it.
+static DictionaryAttr getBindingPartition(BlockArgument bindingArg) {
+  for (Operation *subspanUser : bindingArg.getUsers()) {
+    auto subspanOp = dyn_cast<IREE::Stream::BindingSubspanOp>(subspanUser);
+    if (!subspanOp) continue;
+    for (Operation *loadUser : subspanOp.getResult().getUsers()) {
+      auto loadOp = dyn_cast<IREE::Flow::DispatchTensorLoadOp>(loadUser);
+      if (!loadOp) continue;
+      for (Operation *user : loadOp.getResult().getUsers()) {
+        if (auto partition =
+                user->getAttrOfType<DictionaryAttr>(kPIMPartitionAttr)) {
+          return partition;
+        }
+      }
+    }
+  }
+  return {};
+}
+
+// Returns true if weights read with |partition| are split across the devices:
+// projections split row-wise or col-wise and layers pipelined over the
+// modules, each of which holds its own layers only.
+static bool isShardedPartition(DictionaryAttr partition) {
+  if (partition.get("pipelined")) return true;
+  auto partitioning = partition.getAs<StringAttr>("partitioning");
+  return partitioning && (partitioning.getValue() == "row-wise" ||
+                          partitioning.getValue() == "col-wise");
+}
+
+// Returns a key identifying the constant bytes bound by |resource| at
+// |offset| within the execution region |executeOp| so that weights read by
+// several dispatches (such as the decode and prefill variants of a layer or
+// the same layer called from several functions) are only counted once.
+static std::pair<const void *, int64_t> getResourceKey(
+    IREE::Stream::CmdExecuteOp executeOp, Value resource, int64_t offset) {
+  auto arg = resource.dyn_cast<BlockArgument>();
+  if (!arg || arg.getOwner()->getParentOp() != executeOp) {
+    return {resource.getAsOpaquePointer(), offset};
+  }
+  Value value = executeOp.getResourceOperands()[arg.getArgNumber()];
+  while (auto subviewOp =
+             value.getDefiningOp<IREE::Stream::ResourceSubviewOp>()) {
+    APInt subviewOffset;
+    if (!matchPattern(subviewOp.getSourceOffset(),
+                      m_ConstantInt(&subviewOffset))) {
+      break;
+    }
+    offset += subviewOffset.getSExtValue();
+    value = subviewOp.getSource();
+  }
+  if (auto loadOp = value.getDefiningOp<IREE::Util::GlobalLoadOp>()) {
+    return {loadOp.getGlobalAttr().getAsOpaquePointer(), offset};
+  }
+  return {value.getAsOpaquePointer(), offset};
+}
+
+// Computes the footprint of the PIM dispatches of |moduleOp|.
+static PIMFootprint analyzeFootprint(ModuleOp moduleOp) {
+  PIMFootprint footprint;
+  SymbolTable symbolTable(moduleOp);
+  llvm::DenseSet<std::pair<const void *, int64_t>> countedWeights;
+  moduleOp.walk([&](IREE::Stream::ResourceAllocaOp allocaOp) {
+    APInt allocaSize;
+    if (matchPattern(allocaOp.getStorageSize(), m_ConstantInt(&allocaSize))) {
+      footprint.peakTransientBytes = std::max(footprint.peakTransientBytes,
+                                              allocaSize.getSExtValue());
+    } else {
+      footprint.isDynamic = true;
+    }
+  });
+  moduleOp.walk([&](IREE::Stream::CmdDispatchOp dispatchOp) {
+    auto exportOp = dyn_cast_or_null<IREE::Stream::ExecutableExportOp>(
+        symbolTable.lookupSymbolIn(moduleOp, dispatchOp.getEntryPoint()));
+    if (!exportOp) return;
+    auto funcOp = exportOp.lookupFunctionRef();
+    if (!funcOp || funcOp.empty()) return;
+    auto executeOp = dispatchOp->getParentOfType<IREE::Stream::CmdExecuteOp>();
+    SmallVector<BlockArgument> bindingArgs;
+    for (BlockArgument arg : funcOp.getArguments()) {
+      if (arg.getType().isa<IREE::Stream::BindingType>()) {
+        bindingArgs.push_back(arg);
+      }
+    }
+    for (auto [i, resource] : llvm::enumerate(dispatchOp.getResources())) {
+      if (i >= bindingArgs.size()) break;
+      auto resourceType = resource.getType().cast<IREE::Stream::ResourceType>();
+      if (resourceType.getLifetime() != IREE::Stream::Lifetime::Constant) {
+        continue;
+      }
+      DictionaryAttr partition = getBindingPartition(bindingArgs[i]);
+      if (!partition) continue;
+      APInt offset;
+      APInt length;
+      if (!matchPattern(dispatchOp.getResourceOffsets()[i],
+                        m_ConstantInt(&offset)) ||
+          !matchPattern(dispatchOp.getResourceLengths()[i],
+                        m_ConstantInt(&length))) {
+        footprint.isDynamic = true;
+        continue;
+      }
+      if (!countedWeights
+               .insert(getResourceKey(executeOp, resource,
+                                      offset.getSExtValue()))
+               .second) {
+        continue;
+      }
+      if (isShardedPartition(partition)) {
+        footprint.shardedWeightBytes += length.getSExtValue();
+      } else {
+        footprint.replicatedWeightBytes += length.getSExtValue();
+      }
+
+      // Every decoder layer has its own QKV projection weights and caches
+      // the keys and values it produces for each token.
+      auto layer = partition.getAs<StringAttr>("layer");
+      auto config = partition.getAs<DenseI32ArrayAttr>("config");
+      if (layer && layer.getValue() == "c_attn" && config &&
+          config.size() >= 5) {
+        ArrayRef<int32_t> values = config.asArrayRef();
+        int64_t dHead = values[2];
+        int64_t nKVHead = values[4];
+        footprint.kvBytesPerToken += 2 * nKVHead * dHead * sizeof(float);
+        footprint.kvHeadCount = nKVHead;
+        footprint.tokenCount = values[3];
+      }
+    }
+  });
+  return footprint;
+}
+
+// Returns the PIM executable targets of |moduleOp|.
+static SmallVector<IREE::HAL::ExecutableTargetAttr> getPIMTargets(
+    ModuleOp moduleOp) {
+  SmallVector<IREE::HAL::ExecutableTargetAttr> targetAttrs;
+  for (auto targetAttr :
+       IREE::HAL::DeviceTargetAttr::lookupExecutableTargets(moduleOp)) {
+    if (targetAttr.getBackend().getValue() == kPIMBackend) {
+      targetAttrs.push_back(targetAttr);
+    }
+  }
+  return targetAttrs;
+}
+
+// Returns the integer configuration entry |name| of |targetAttr| or
+// |defaultValue|.
+static int64_t getTargetConfigInt(IREE::HAL::ExecutableTargetAttr targetAttr,
+                                  StringRef name, int64_t defaultValue) {
+  auto config = targetAttr.getConfiguration();
+  if (!config) return defaultValue;
+  auto attr = config.getAs<IntegerAttr>(name);
+  return attr ? attr.getInt() : defaultValue;
+}
+
+// Replaces the `num_device` of all PIM executable targets of |moduleOp|.
+static void setPIMDeviceCount(ModuleOp moduleOp, int64_t deviceCount) {
+  MLIRContext *context = moduleOp.getContext();
+  Builder b(context);
+  auto targetsAttr = moduleOp->getAttrOfType<ArrayAttr>("hal.device.targets");
+  if (!targetsAttr) return;
+  auto updateTarget = [&](IREE::HAL::ExecutableTargetAttr targetAttr) {
+    if (targetAttr.getBackend().getValue() != kPIMBackend) return targetAttr;
+    NamedAttrList config(targetAttr.getConfiguration());
+    config.set("num_device", b.getI64IntegerAttr(deviceCount));
+    return IREE::HAL::ExecutableTargetAttr::get(
+        context, targetAttr.getBackend(), targetAttr.getFormat(),
+        config.getDictionary(context));
+  };
+  SmallVector<Attribute> deviceAttrs;
+  for (Attribute attr : targetsAttr) {
+    auto deviceAttr = attr.dyn_cast<IREE::HAL::DeviceTargetAttr>();
+    if (!deviceAttr) {
+      deviceAttrs.push_back(attr);
+      continue;
+    }
+    SmallVector<Attribute> executableAttrs;
+    for (auto targetAttr : deviceAttr.getExecutableTargets()) {
+      executableAttrs.push_back(updateTarget(targetAttr));
+    }
+    NamedAttrList config(deviceAttr.getConfiguration());
+    config.set("executable_targets", b.getArrayAttr(executableAttrs));
+    deviceAttrs.push_back(IREE::HAL::DeviceTargetAttr::get(
+        context, deviceAttr.getDeviceID(), config.getDictionary(context)));
+  }
+  moduleOp->setAttr("hal.device.targets", b.getArrayAttr(deviceAttrs));
+}
+
+class PlanPIMCapacityPass : public PlanPIMCapacityBase<PlanPIMCapacityPass> {
+ public:
+  PlanPIMCapacityPass() = default;
+  PlanPIMCapacityPass(int64_t sequenceLength, bool autoDeviceCount) {
+    this->sequenceLength = sequenceLength;
+    this->autoDeviceCount = autoDeviceCount;
+  }
+
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<IREE::HAL::HALDialect, IREE::Stream::StreamDialect>();
+  }
+
+  void runOnOperation() override {
+    auto moduleOp = getOperation();
+    auto targetAttrs = getPIMTargets(moduleOp);
+    if (targetAttrs.empty()) return;
+    const int64_t initialDeviceCount =
+        getTargetConfigInt(targetAttrs.front(), "num_device", 1);
+    const int64_t capacityBytes = getTargetConfigInt(
+        targetAttrs.front(), "device_capacity_bytes", int64_t(1) << 30);
+
+    PIMFootprint footprint = analyzeFootprint(moduleOp);
+    // The KV cache is sized for the requested sequence length or the token
+    // count the attention layers were compiled for when it is static.
+    int64_t tokens = sequenceLength;
+    if (tokens <= 0) tokens = std::max<int64_t>(footprint.tokenCount, 0);
+
+    int64_t deviceCount = std::max<int64_t>(initialDeviceCount, 1);
+    auto fits = [&](int64_t count) {
+      return footprint.getTotalBytes(count, tokens) <= capacityBytes;
+    };
+    if (autoDeviceCount) {
+      while (!fits(deviceCount) && deviceCount * 2 <= kMaxPIMDeviceCount) {
+        deviceCount *= 2;
+      }
+    }
+
+    // Longest sequence whose KV cache fits next to the weights and transients.
+    int64_t freeBytes = capacityBytes -
+                        footprint.getWeightBytes(deviceCount) -
+                        footprint.peakTransientBytes;
+    int64_t kvBytesPerToken = footprint.getKVBytes(deviceCount, 1);
+    std::string report = llvm::formatv(
+        "PIM capacity plan for {0} device(s) of {1} B: {2}{3} B of weights, "
+        "{4} B of peak transients, {5} B of KV cache per token ({6} B for {7} "
+        "tokens)",
+        deviceCount, capacityBytes, footprint.isDynamic ? "at least " : "",
+        footprint.getWeightBytes(deviceCount), footprint.peakTransientBytes,
+        kvBytesPerToken, footprint.getKVBytes(deviceCount, tokens), tokens);
+    if (kvBytesPerToken > 0 && freeBytes > 0) {
+      report += llvm::formatv("; fits up to {0} tokens",
+                              freeBytes / kvBytesPerToken);
+    }
+    LLVM_DEBUG(llvm::dbgs() << report << "\n");
+
+    if (!fits(deviceCount)) {
+      moduleOp.emitError()
+          << report << "; exceeds the capacity by "
+          << footprint.getTotalBytes(deviceCount, tokens) - capacityBytes
+          << " B (increase --iree-pim-device-count or use "
+             "--iree-stream-pim-auto-device-count)";
+      return signalPassFailure();
+    }
+    moduleOp.emitRemark() << report;
+    if (deviceCount != initialDeviceCount) {
+      // The queues of the runtime device must match; see
+      // iree_hal_pim_device_options_t::queue_count.
+      moduleOp.emitRemark()
+          << "partitioning across " << deviceCount
+          << " PIM devices instead of " << initialDeviceCount
+          << " to fit the program; run with --pim_queue_count=" << deviceCount;
+      setPIMDeviceCount(moduleOp, deviceCount);
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<OperationPass<mlir::ModuleOp>> createPlanPIMCapacityPass(
+    int64_t sequenceLength, bool autoDeviceCount) {
+  return std::make_unique<PlanPIMCapacityPass>(sequenceLength,
+                                               autoDeviceCount);
+}
+
+}  // namespace Stream
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -120,3 +120,27 @@ func.func private @blockArgMove(%cond: i1, %size: index) -> (!stream.resource<*>
 ^bb2(%bb2_0: !stream.resource<*>, %bb2_1: !stream.resource<*>):
   return %bb2_0, %bb2_1 : !stream.resource<*>, !stream.resource<*>
 }
+
+// -----
+
+// Tests that copies of public function arguments are only elided when the
+// caller donates the argument. The donated cache is updated in-place while the
+// other argument may still be used by the caller and must be copied.
+
+// CHECK-LABEL: @donatedArg
+// CHECK-SAME: (%[[CACHE:.+]]: !stream.resource<*> {stream.donated}, %[[OTHER:.+]]: !stream.resource<*>
+func.func @donatedArg(%cache: !stream.resource<*> {stream.donated}, %other: !stream.resource<*>, %size: index) -> (!stream.resource<*>, !stream.resource<*>) {
+  %c0 = arith.constant 0 : index
+  %c128 = arith.constant 128 : index
+  %c123_i32 = arith.constant 123 : i32
+  // CHECK-NOT: stream.async.clone %[[CACHE]]
+  %clone0 = stream.async.clone %cache : !stream.resource<*>{%size} -> !stream.resource<*>{%size}
+  // CHECK: %[[FILL0:.+]] = stream.async.fill %c123_i32, %[[CACHE]]
+  %fill0 = stream.async.fill %c123_i32, %clone0[%c0 to %c128 for %c128] : i32 -> %clone0 as !stream.resource<*>{%size}
+  // CHECK: %[[CLONE1:.+]] = stream.async.clone %[[OTHER]]
+  %clone1 = stream.async.clone %other : !stream.resource<*>{%size} -> !stream.resource<*>{%size}
+  // CHECK: %[[FILL1:.+]] = stream.async.fill %c123_i32, %[[CLONE1]]
+  %fill1 = stream.async.fill %c123_i32, %clone1[%c0 to %c128 for %c128] : i32 -> %clone1 as !stream.resource<*>{%size}
+  // CHECK: return %[[FILL0]], %[[FILL1]]
+  return %fill0, %fill1 : !stream.resource<*>, !stream.resource<*>
+}
@@ -45,6 +45,27 @@ func.func @dontEmplaceTiedDispatch(
 
 // -----
 
+// Tests that a dispatch result is not placed into a target the dispatch reads
+// from as the dispatch could overwrite data it has yet to read. This happens
+// when updating inputs in-place such as ones donated to results.
+
+// CHECK-LABEL: @dontEmplaceIntoReadOperand
+func.func @dontEmplaceIntoReadOperand(
+    %input: !stream.resource<*>, %input_size: index) -> !stream.resource<external> {
+  %c0 = arith.constant 0 : index
+  // CHECK: %[[TARGET:.+]] = stream.async.transfer
+  %target = stream.async.transfer %input : !stream.resource<*>{%input_size} -> !stream.resource<external>{%input_size}
+  // CHECK: %[[UPDATE:.+]] = stream.async.dispatch @ex::@dispatch
+  // CHECK-SAME: -> !stream.resource<*>{%arg1}
+  %update = stream.async.dispatch @ex::@dispatch(%input[%c0 to %input_size for %input_size]) : (!stream.resource<*>{%input_size}) -> !stream.resource<*>{%input_size}
+  // CHECK: %[[RESULT:.+]] = stream.async.update %[[UPDATE]], %[[TARGET]]
+  %result = stream.async.update %update, %target[%c0 to %input_size] : !stream.resource<*>{%input_size} -> %target as !stream.resource<external>{%input_size}
+  // CHECK: return %[[RESULT]]
+  return %result : !stream.resource<external>
+}
+
+// -----
+
 // Tests that sequences of updates get reordered and placed.
 // This pattern originates from concats in higher level representations and we
 // test that explicitly as it's 95% of what this pass is designed to optimize.
@@ -29,6 +29,35 @@ func.func @layoutStatic() -> (index, index, index, index, index, index, index)
 
 // -----
 
+#layoutStaticDecreasingConfig = #stream.resource_config<{
+  max_allocation_size = 1073741824,
+  min_buffer_offset_alignment = 16,
+  max_buffer_range = 1073741824,
+  min_buffer_range_alignment = 16,
+  index_bits = 32
+}>
+
+// Packing in lifetime order places [2, 3] after [0, 3] (64 bytes total) as the
+// gap left by [0, 1] is too small; packing the largest slice first reaches the
+// 48 byte peak of live memory.
+
+// CHECK-LABEL: @layoutStaticDecreasing
+func.func @layoutStaticDecreasing() -> (index, index, index, index)
+    attributes {stream.resources = #layoutStaticDecreasingConfig} {
+  %c16 = arith.constant 16 : index
+  %c32 = arith.constant 32 : index
+  %t:4 = stream.resource.pack slices({
+    [0, 1] = %c16,  // +0 (reuse [2, 3])
+    [0, 3] = %c16,  // +32 (after [2, 3])
+    [2, 3] = %c32,  // +0 (packed first)
+  }) : index
+  // CHECK: return %c48
+  // CHECK-SAME: %c0, %c32, %c0
+  return %t#0, %t#1, %t#2, %t#3 : index, index, index, index
+}
+
+// -----
+
 #layoutDynamicConfig = #stream.resource_config<{
   max_allocation_size = 1073741824,
   min_buffer_offset_alignment = 16,
@@ -0,0 +1,88 @@
+// RUN: iree-opt --split-input-file --iree-stream-plan-pim-capacity --verify-diagnostics %s
+// RUN: iree-opt --split-input-file --pass-pipeline='builtin.module(iree-stream-plan-pim-capacity{auto-device-count=true})' %s 2>/dev/null | FileCheck %s
+
+// Tests that the QKV projection weights are split row-wise across both devices
+// and that the KV cache of its 4 heads is split with them.
+
+// CHECK-LABEL: module @shardedFits
+// CHECK: num_device = 2
+// expected-remark @+1 {{PIM capacity plan for 2 device(s) of 1048576 B: 24576 B of weights, 6144 B of peak transients, 256 B of KV cache per token (2048 B for 8 tokens); fits up to 3976 tokens}}
+module @shardedFits attributes {hal.device.targets = [#hal.device.target<"vulkan", {executable_targets = [#hal.executable.target<"pim", "pim-isr-fb", {device_capacity_bytes = 1048576 : i64, num_device = 2 : i64}>]}>]} {
+  stream.executable private @ex {
+    stream.executable.export public @dispatch
+    builtin.module {
+      func.func @dispatch(%weight: !stream.binding, %result: !stream.binding) {
+        %c0 = arith.constant 0 : index
+        %input = arith.constant dense<1.0> : tensor<8x64xf32>
+        %init = arith.constant dense<0.0> : tensor<8x192xf32>
+        %0 = stream.binding.subspan %weight[%c0] : !stream.binding -> !flow.dispatch.tensor<readonly:tensor<64x192xf32>>
+        %1 = stream.binding.subspan %result[%c0] : !stream.binding -> !flow.dispatch.tensor<writeonly:tensor<8x192xf32>>
+        %2 = flow.dispatch.tensor.load %0, offsets = [0, 0], sizes = [64, 192], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<64x192xf32>> -> tensor<64x192xf32>
+        %3 = linalg.matmul {pim.partition = {config = array<i32: 64, 4, 16, 8, 4>, layer = "c_attn", partitioning = "row-wise"}} ins(%input, %2 : tensor<8x64xf32>, tensor<64x192xf32>) outs(%init : tensor<8x192xf32>) -> tensor<8x192xf32>
+        flow.dispatch.tensor.store %3, %1, offsets = [0, 0], sizes = [8, 192], strides = [1, 1] : tensor<8x192xf32> -> !flow.dispatch.tensor<writeonly:tensor<8x192xf32>>
+        return
+      }
+    }
+  }
+  func.func @forward(%weights: !stream.resource<constant>) -> !stream.timepoint {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c6144 = arith.constant 6144 : index
+    %c49152 = arith.constant 49152 : index
+    %c98304 = arith.constant 98304 : index
+    %result, %result_timepoint = stream.resource.alloca uninitialized => !stream.resource<transient>{%c6144} => !stream.timepoint
+    %timepoint = stream.cmd.execute await(%result_timepoint) => with(%weights as %captured_weights: !stream.resource<constant>{%c98304}, %result as %captured_result: !stream.resource<transient>{%c6144}) {
+      // The decode and prefill variants of a dispatch read the same weights.
+      stream.cmd.dispatch @ex::@dispatch[%c1, %c1, %c1] {
+        ro %captured_weights[%c0 for %c49152] : !stream.resource<constant>{%c98304},
+        wo %captured_result[%c0 for %c6144] : !stream.resource<transient>{%c6144}
+      }
+      stream.cmd.dispatch @ex::@dispatch[%c1, %c1, %c1] {
+        ro %captured_weights[%c0 for %c49152] : !stream.resource<constant>{%c98304},
+        wo %captured_result[%c0 for %c6144] : !stream.resource<transient>{%c6144}
+      }
+    } => !stream.timepoint
+    return %timepoint : !stream.timepoint
+  }
+}
+
+// -----
+
+// Tests that a program exceeding the capacity of a single device fails and
+// that the device count is doubled until it fits when requested.
+
+// CHECK-LABEL: module @exceedsCapacity
+// CHECK: num_device = 2
+// expected-error @+1 {{PIM capacity plan for 1 device(s) of 32768 B: 49152 B of weights, 6144 B of peak transients, 512 B of KV cache per token (4096 B for 8 tokens); exceeds the capacity by 26624 B}}
+module @exceedsCapacity attributes {hal.device.targets = [#hal.device.target<"vulkan", {executable_targets = [#hal.executable.target<"pim", "pim-isr-fb", {device_capacity_bytes = 32768 : i64, num_device = 1 : i64}>]}>]} {
+  stream.executable private @ex {
+    stream.executable.export public @dispatch
+    builtin.module {
+      func.func @dispatch(%weight: !stream.binding, %result: !stream.binding) {
+        %c0 = arith.constant 0 : index
+        %input = arith.constant dense<1.0> : tensor<8x64xf32>
+        %init = arith.constant dense<0.0> : tensor<8x192xf32>
+        %0 = stream.binding.subspan %weight[%c0] : !stream.binding -> !flow.dispatch.tensor<readonly:tensor<64x192xf32>>
+        %1 = stream.binding.subspan %result[%c0] : !stream.binding -> !flow.dispatch.tensor<writeonly:tensor<8x192xf32>>
+        %2 = flow.dispatch.tensor.load %0, offsets = [0, 0], sizes = [64, 192], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<64x192xf32>> -> tensor<64x192xf32>
+        %3 = linalg.matmul {pim.partition = {config = array<i32: 64, 4, 16, 8, 4>, layer = "c_attn", partitioning = "row-wise"}} ins(%input, %2 : tensor<8x64xf32>, tensor<64x192xf32>) outs(%init : tensor<8x192xf32>) -> tensor<8x192xf32>
+        flow.dispatch.tensor.store %3, %1, offsets = [0, 0], sizes = [8, 192], strides = [1, 1] : tensor<8x192xf32> -> !flow.dispatch.tensor<writeonly:tensor<8x192xf32>>
+        return
+      }
+    }
+  }
+  func.func @forward(%weights: !stream.resource<constant>) -> !stream.timepoint {
+    %c0 = arith.constant 0 : index
+    %c1 = arith.constant 1 : index
+    %c6144 = arith.constant 6144 : index
+    %c49152 = arith.constant 49152 : index
+    %result, %result_timepoint = stream.resource.alloca uninitialized => !stream.resource<transient>{%c6144} => !stream.timepoint
+    %timepoint = stream.cmd.execute await(%result_timepoint) => with(%weights as %captured_weights: !stream.resource<constant>{%c49152}, %result as %captured_result: !stream.resource<transient>{%c6144}) {
+      stream.cmd.dispatch @ex::@dispatch[%c1, %c1, %c1] {
+        ro %captured_weights[%c0 for %c49152] : !stream.resource<constant>{%c49152},
+        wo %captured_result[%c0 for %c6144] : !stream.resource<transient>{%c6144}
+      }
+    } => !stream.timepoint
+    return %timepoint : !stream.timepoint
+  }
+}
@@ -315,3 +315,41 @@ func.func @deviceHostDeviceCrossing(%arg0: i1) -> !stream.resource<transient> {
   // CHECK: return
   return %4 : !stream.resource<transient>
 }
+
+// -----
+
+// Tests that transfers are partitioned apart from compute and placed on the
+// transfer affinity when the partitioning config specifies one.
+
+// CHECK-LABEL: @partitioningWithTransferAffinity
+// CHECK-SAME: (%[[ARG0:.+]]: !stream.resource<staging>)
+func.func @partitioningWithTransferAffinity(%arg0: !stream.resource<staging>) -> !stream.resource<external>
+    attributes {stream.partitioning = #stream.partitioning_config<"max-concurrency", transfers = #hal.affinity.queue<[1]>>} {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c20 = arith.constant 20 : index
+  %c255_i32 = arith.constant 255 : i32
+
+  // CHECK: %[[UPLOAD:.+]], %[[UPLOAD_TIMEPOINT:.+]] = stream.async.execute on(#hal.affinity.queue<[1]>)
+  // CHECK-SAME: with(%[[ARG0]] as %[[ARG0_CAPTURE:.+]]: !stream.resource<staging>{%c20})
+  // CHECK-NEXT: %[[TRANSFER:.+]] = stream.async.transfer %[[ARG0_CAPTURE]]
+  %upload = stream.async.transfer %arg0 : !stream.resource<staging>{%c20} -> !stream.resource<transient>{%c20}
+  // CHECK-NEXT: stream.yield %[[TRANSFER]]
+  // CHECK: %[[UPLOAD_READY:.+]] = stream.timepoint.await %[[UPLOAD_TIMEPOINT]] => %[[UPLOAD]]
+
+  // CHECK: %[[COMPUTE:.+]], %[[COMPUTE_TIMEPOINT:.+]] = stream.async.execute with(%[[UPLOAD_READY]] as %[[UPLOAD_CAPTURE:.+]]: !stream.resource<transient>{%c20})
+  // CHECK-NEXT: %[[SPLAT:.+]] = stream.async.splat
+  %splat = stream.async.splat %c255_i32 : i32 -> !stream.resource<transient>{%c20}
+  // CHECK-NEXT: %[[DISPATCH:.+]] = stream.async.dispatch @ex::@dispatch[%c1](%[[UPLOAD_CAPTURE]][{{.+}}], %[[SPLAT]][{{.+}}])
+  %dispatch = stream.async.dispatch @ex::@dispatch[%c1](%upload[%c0 to %c20 for %c20], %splat[%c0 to %c20 for %c20]) : (!stream.resource<transient>{%c20}, !stream.resource<transient>{%c20}) -> !stream.resource<transient>{%c20}
+  // CHECK-NEXT: stream.yield %[[DISPATCH]]
+  // CHECK: %[[COMPUTE_READY:.+]] = stream.timepoint.await %[[COMPUTE_TIMEPOINT]] => %[[COMPUTE]]
+
+  // CHECK: stream.async.execute on(#hal.affinity.queue<[1]>)
+  // CHECK-SAME: with(%[[COMPUTE_READY]] as
+  // CHECK-NEXT: stream.async.transfer
+  %result = stream.async.transfer %dispatch : !stream.resource<transient>{%c20} -> !stream.resource<external>{%c20}
+
+  // CHECK: return
+  return %result : !stream.resource<external>
+}
@@ -86,6 +86,12 @@ ConstExprOpInfo ConstExprOpInfo::getForOp(Operation *op) {
     return {};
   }
 
+  // Relayouts of constants (typically weights being packed for a matmul) are
+  // evaluated at compile time so they ship pre-laid-out.
+  if (llvm::isa<tensor::PackOp, tensor::UnPackOp>(op)) {
+    return getInfoForDefaultConstExprOp(op);
+  }
+
   // By default any effects make it non const-expr.
   if (!isMemoryEffectFree(op)) {
     return {};
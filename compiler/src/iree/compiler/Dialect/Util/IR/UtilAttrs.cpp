@@ -564,8 +564,32 @@ struct SerializableDenseResourceElementsAttrModel
       return success();
     }
 
-    return mlir::emitError(UnknownLoc::get(baseAttr.getContext()))
-           << "DenseResourceElementsAttr not yet supported for serialization";
+    // Blobs (such as those produced by const-eval) hold the dense host
+    // representation of the elements and can be streamed out directly as long
+    // as no byte swapping is required.
+    AsmResourceBlob *blob = handle.getBlob();
+    if (!blob) {
+      return mlir::emitError(UnknownLoc::get(baseAttr.getContext()))
+             << "DenseResourceElementsAttr '" << handle.getKey()
+             << "' has no blob data to serialize";
+    }
+    ArrayRef<char> data = blob->getData();
+    Type elementType = attr.getType().getElementType();
+    unsigned bitWidth =
+        elementType.isIntOrFloat() ? elementType.getIntOrFloatBitWidth() : 0;
+    if (bitWidth == 0 || bitWidth % 8 != 0 ||
+        static_cast<int64_t>(data.size()) != getStorageSize(baseAttr)) {
+      return mlir::emitError(UnknownLoc::get(baseAttr.getContext()))
+             << "DenseResourceElementsAttr '" << handle.getKey()
+             << "' is not densely packed and cannot be serialized";
+    }
+    if (bitWidth != 8 && endian != llvm::support::endian::system_endianness()) {
+      return mlir::emitError(UnknownLoc::get(baseAttr.getContext()))
+             << "DenseResourceElementsAttr serialization with mismatched "
+                "endianness is not yet supported";
+    }
+    os.write(data.data(), data.size());
+    return success();
   }
 };
 
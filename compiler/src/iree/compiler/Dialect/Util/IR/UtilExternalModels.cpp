@@ -139,6 +139,8 @@ void registerUtilExternalModels(DialectRegistry &registry) {
             LinalgOpTiedOpInterface<LinalgExt::ReverseOp>>(*ctx);
         LinalgExt::TopkOp::attachInterface<
             LinalgOpTiedOpInterface<LinalgExt::TopkOp>>(*ctx);
+        LinalgExt::SampleOp::attachInterface<
+            LinalgOpTiedOpInterface<LinalgExt::SampleOp>>(*ctx);
         LinalgExt::WinogradInputTransformOp::attachInterface<
             LinalgOpTiedOpInterface<LinalgExt::WinogradInputTransformOp>>(*ctx);
         LinalgExt::WinogradOutputTransformOp::attachInterface<
@@ -0,0 +1,202 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Dialect/Util/IR/UtilDialect.h"
+#include "iree/compiler/Dialect/Util/IR/UtilOps.h"
+#include "iree/compiler/Dialect/Util/Transforms/PassDetail.h"
+#include "iree/compiler/Dialect/Util/Transforms/Passes.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Pass/Pass.h"
+
+#define DEBUG_TYPE "iree-util-lazy-initialize-globals"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Util {
+namespace {
+
+// Returns true if |initializerOp| only initializes private globals that are
+// stored nowhere else and has no effects outside of them that could be
+// observed if it ran later than module initialization.
+static bool isLazyInitializable(
+    InitializerOp initializerOp, SymbolTable &symbolTable,
+    const DenseMap<StringRef, SmallVector<Operation *>> &storesByGlobal,
+    const DenseSet<StringRef> &indirectGlobals) {
+  bool isLazy = true;
+  initializerOp.walk([&](Operation *op) {
+    if (auto storeOp = dyn_cast<GlobalStoreOpInterface>(op)) {
+      StringRef globalName = storeOp.getGlobalName();
+      auto globalOp = symbolTable.lookup<GlobalOpInterface>(globalName);
+      if (!globalOp || !globalOp.isGlobalPrivate() ||
+          indirectGlobals.contains(globalName)) {
+        isLazy = false;
+        return WalkResult::interrupt();
+      }
+      for (Operation *otherStoreOp : storesByGlobal.lookup(globalName)) {
+        if (otherStoreOp->getParentOfType<InitializerOp>() != initializerOp) {
+          isLazy = false;
+          return WalkResult::interrupt();
+        }
+      }
+    } else if (isa<GlobalStoreIndirectOpInterface>(op)) {
+      isLazy = false;
+      return WalkResult::interrupt();
+    } else if (auto callOp = dyn_cast<CallOpInterface>(op)) {
+      // Calls to external functions may have arbitrary side effects that must
+      // remain ordered with the rest of module initialization.
+      auto calleeOp = dyn_cast_or_null<FunctionOpInterface>(
+          callOp.resolveCallable());
+      if (!calleeOp || calleeOp.isExternal()) {
+        isLazy = false;
+        return WalkResult::interrupt();
+      }
+    }
+    return WalkResult::advance();
+  });
+  return isLazy;
+}
+
+// Moves the body of |initializerOp| into a private function guarded by a
+// flag global so that it runs at most once and returns the function.
+static func::FuncOp outlineLazyInitializer(InitializerOp initializerOp,
+                                           StringRef name,
+                                           SymbolTable &symbolTable) {
+  Location loc = initializerOp.getLoc();
+  OpBuilder moduleBuilder(initializerOp);
+  Type i1Type = moduleBuilder.getI1Type();
+  auto flagOp = moduleBuilder.create<GlobalOp>(
+      loc, (name + "_done").str(), /*isMutable=*/true, i1Type,
+      moduleBuilder.getIntegerAttr(i1Type, 0));
+  flagOp.setPrivate();
+  symbolTable.insert(flagOp);
+
+  auto funcOp = moduleBuilder.create<func::FuncOp>(
+      loc, name, moduleBuilder.getFunctionType({}, {}));
+  funcOp.setPrivate();
+  // Keep the guarded body out of line at every use site.
+  funcOp->setAttr("noinline", moduleBuilder.getUnitAttr());
+  symbolTable.insert(funcOp);
+  funcOp.getBody().takeBody(initializerOp.getBody());
+  Block *bodyBlock = &funcOp.getBody().front();
+
+  // Every exit of the original body marks the globals initialized.
+  Block *exitBlock = new Block();
+  funcOp.getBody().push_back(exitBlock);
+  for (Block &block : funcOp.getBody()) {
+    for (auto returnOp :
+         llvm::make_early_inc_range(block.getOps<InitializerReturnOp>())) {
+      OpBuilder(returnOp).create<cf::BranchOp>(returnOp.getLoc(), exitBlock);
+      returnOp.erase();
+    }
+  }
+  Block *returnBlock = new Block();
+  funcOp.getBody().push_back(returnBlock);
+  auto exitBuilder = OpBuilder::atBlockEnd(exitBlock);
+  Value trueValue = exitBuilder.create<arith::ConstantIntOp>(loc, 1, 1);
+  exitBuilder.create<GlobalStoreOp>(loc, trueValue, flagOp.getSymName());
+  exitBuilder.create<cf::BranchOp>(loc, returnBlock);
+  OpBuilder::atBlockEnd(returnBlock).create<func::ReturnOp>(loc);
+
+  // Guard the body with the flag in a new entry block.
+  Block *guardBlock = new Block();
+  funcOp.getBody().push_front(guardBlock);
+  auto guardBuilder = OpBuilder::atBlockEnd(guardBlock);
+  Value doneValue = guardBuilder.create<GlobalLoadOp>(loc, flagOp);
+  guardBuilder.create<cf::CondBranchOp>(loc, doneValue, returnBlock,
+                                        ValueRange{}, bodyBlock, ValueRange{});
+
+  initializerOp.erase();
+  return funcOp;
+}
+
+class LazyInitializeGlobalsPass
+    : public LazyInitializeGlobalsBase<LazyInitializeGlobalsPass> {
+ public:
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<IREE::Util::UtilDialect>();
+    registry.insert<mlir::arith::ArithDialect>();
+    registry.insert<mlir::cf::ControlFlowDialect>();
+    registry.insert<mlir::func::FuncDialect>();
+  }
+
+  void runOnOperation() override {
+    auto moduleOp = getOperation();
+    SymbolTable symbolTable(moduleOp);
+
+    // Gather all global stores and any globals accessed indirectly.
+    DenseMap<StringRef, SmallVector<Operation *>> storesByGlobal;
+    DenseSet<StringRef> indirectGlobals;
+    moduleOp.walk([&](Operation *op) {
+      if (auto storeOp = dyn_cast<GlobalStoreOpInterface>(op)) {
+        storesByGlobal[storeOp.getGlobalName()].push_back(op);
+      } else if (auto addressOp = dyn_cast<GlobalAddressOpInterface>(op)) {
+        indirectGlobals.insert(addressOp.getGlobalName());
+      }
+    });
+
+    // Outline each eligible initializer and note the globals it initializes.
+    DenseMap<StringRef, func::FuncOp> lazyFuncsByGlobal;
+    unsigned nextId = 0;
+    for (auto initializerOp :
+         llvm::make_early_inc_range(moduleOp.getOps<InitializerOp>())) {
+      if (!isLazyInitializable(initializerOp, symbolTable, storesByGlobal,
+                               indirectGlobals)) {
+        continue;
+      }
+      SmallVector<StringRef> globalNames;
+      initializerOp.walk([&](GlobalStoreOpInterface storeOp) {
+        globalNames.push_back(storeOp.getGlobalName());
+      });
+      if (globalNames.empty()) continue;
+
+      std::string name = "__lazy_initializer_" + std::to_string(nextId++);
+      func::FuncOp funcOp =
+          outlineLazyInitializer(initializerOp, name, symbolTable);
+      for (StringRef globalName : globalNames) {
+        // The globals are now stored outside of an initializer.
+        symbolTable.lookup<GlobalOpInterface>(globalName)
+            .setGlobalMutable(true);
+        lazyFuncsByGlobal[globalName] = funcOp;
+      }
+      LLVM_DEBUG(llvm::dbgs() << "lazily initializing " << globalNames.size()
+                              << " globals with @" << name << "\n");
+    }
+    if (lazyFuncsByGlobal.empty()) return;
+
+    // Run the initializer before the first load of its globals in each block.
+    // Loads within the initializer itself see the values it just stored.
+    DenseSet<std::pair<Block *, Operation *>> initializedBlocks;
+    moduleOp.walk([&](GlobalLoadOpInterface loadOp) {
+      func::FuncOp funcOp = lazyFuncsByGlobal.lookup(loadOp.getGlobalName());
+      if (!funcOp) return;
+      if (loadOp->getParentOfType<func::FuncOp>() == funcOp) return;
+      Block *block = loadOp->getBlock();
+      if (!initializedBlocks.insert({block, funcOp}).second) return;
+      OpBuilder(loadOp).create<func::CallOp>(loadOp.getLoc(), funcOp);
+    });
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<OperationPass<mlir::ModuleOp>>
+createLazyInitializeGlobalsPass() {
+  return std::make_unique<LazyInitializeGlobalsPass>();
+}
+
+}  // namespace Util
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
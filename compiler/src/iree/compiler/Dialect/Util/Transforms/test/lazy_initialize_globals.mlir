@@ -0,0 +1,126 @@
+// RUN: iree-opt --split-input-file --iree-util-lazy-initialize-globals %s | FileCheck %s
+
+// Tests that an initializer of private globals is outlined into a guarded
+// function called before the first load in each block.
+
+// CHECK: util.global private mutable @hoisted : index
+util.global private @hoisted : index
+// CHECK: util.global private mutable @__lazy_initializer_0_done = false
+// CHECK: func.func private @__lazy_initializer_0() attributes {noinline}
+// CHECK-NEXT: %[[DONE:.+]] = util.global.load @__lazy_initializer_0_done : i1
+// CHECK-NEXT: cf.cond_br %[[DONE]], ^bb3, ^bb1
+// CHECK-NEXT: ^bb1:
+// CHECK-NEXT: %[[C100:.+]] = arith.constant 100 : index
+// CHECK-NEXT: util.global.store %[[C100]], @hoisted : index
+// CHECK-NEXT: cf.br ^bb2
+// CHECK-NEXT: ^bb2:
+// CHECK-NEXT: %[[TRUE:.+]] = arith.constant true
+// CHECK-NEXT: util.global.store %[[TRUE]], @__lazy_initializer_0_done : i1
+// CHECK-NEXT: cf.br ^bb3
+// CHECK-NEXT: ^bb3:
+// CHECK-NEXT: return
+// CHECK-NOT: util.initializer
+util.initializer {
+  %c100 = arith.constant 100 : index
+  util.global.store %c100, @hoisted : index
+  util.initializer.return
+}
+
+// CHECK-LABEL: @loadTwice
+func.func @loadTwice() -> (index, index) {
+  // CHECK-NEXT: call @__lazy_initializer_0()
+  // CHECK-NEXT: util.global.load @hoisted
+  %0 = util.global.load @hoisted : index
+  // CHECK-NEXT: util.global.load @hoisted
+  %1 = util.global.load @hoisted : index
+  return %0, %1 : index, index
+}
+
+// CHECK-LABEL: @loadInRegion
+func.func @loadInRegion(%arg0: i1) -> index {
+  // CHECK-NOT: call
+  // CHECK: cf.cond_br
+  cf.cond_br %arg0, ^bb1, ^bb2
+// CHECK: ^bb1:
+^bb1:
+  // CHECK-NEXT: call @__lazy_initializer_0()
+  // CHECK-NEXT: util.global.load @hoisted
+  %0 = util.global.load @hoisted : index
+  return %0 : index
+^bb2:
+  %c0 = arith.constant 0 : index
+  return %c0 : index
+}
+
+// -----
+
+// Tests that initializers reading other lazily initialized globals initialize
+// them first.
+
+util.global private @a : index
+util.initializer {
+  %c1 = arith.constant 1 : index
+  util.global.store %c1, @a : index
+  util.initializer.return
+}
+util.global private @b : index
+util.initializer {
+  %a = util.global.load @a : index
+  %b = arith.addi %a, %a : index
+  util.global.store %b, @b : index
+  util.initializer.return
+}
+// CHECK: func.func private @__lazy_initializer_1()
+// CHECK: ^bb1:
+// CHECK-NEXT: call @__lazy_initializer_0()
+// CHECK-NEXT: util.global.load @a
+
+// CHECK-LABEL: @loadB
+func.func @loadB() -> index {
+  // CHECK-NEXT: call @__lazy_initializer_1()
+  %0 = util.global.load @b : index
+  return %0 : index
+}
+
+// -----
+
+// Tests that initializers with effects outside of their private globals are
+// left as-is.
+
+func.func private @extern() -> index
+
+// CHECK: util.global private @external_value : index
+util.global private @external_value : index
+// CHECK: util.initializer
+util.initializer {
+  %0 = func.call @extern() : () -> index
+  util.global.store %0, @external_value : index
+  util.initializer.return
+}
+
+// CHECK: util.global @public_value : index
+util.global @public_value : index
+// CHECK: util.initializer
+util.initializer {
+  %c1 = arith.constant 1 : index
+  util.global.store %c1, @public_value : index
+  util.initializer.return
+}
+
+// CHECK: util.global private mutable @stored_value : index
+util.global private mutable @stored_value : index
+// CHECK: util.initializer
+util.initializer {
+  %c2 = arith.constant 2 : index
+  util.global.store %c2, @stored_value : index
+  util.initializer.return
+}
+
+// CHECK-LABEL: @useValues
+func.func @useValues(%arg0: index) -> (index, index) {
+  // CHECK-NOT: call
+  util.global.store %arg0, @stored_value : index
+  %0 = util.global.load @external_value : index
+  %1 = util.global.load @public_value : index
+  return %0, %1 : index, index
+}
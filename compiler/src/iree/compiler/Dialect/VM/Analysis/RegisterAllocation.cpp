@@ -146,6 +146,39 @@ struct RegisterUsage {
     }
   }
 
+  // Returns true if all of the ordinals covered by |reg| are unused.
+  bool isRegisterFree(Register reg) {
+    int ordinalStart = reg.ordinal();
+    if (reg.isRef()) {
+      return ordinalStart < Register::kRefRegisterCount &&
+             !refRegisters.test(ordinalStart);
+    }
+    int ordinalEnd = ordinalStart + (reg.byteWidth() / 4) - 1;
+    if (ordinalEnd >= Register::kInt32RegisterCount) return false;
+    for (int ordinal = ordinalStart; ordinal <= ordinalEnd; ++ordinal) {
+      if (intRegisters.test(ordinal)) return false;
+    }
+    return true;
+  }
+
+  // Allocates a register of |type| preferring the first free register in
+  // |hints| so that copies between the hinted values and the new value can be
+  // elided. Falls back to allocateRegister if no hint is available.
+  Optional<Register> allocateRegister(Type type, ArrayRef<Register> hints) {
+    for (auto hint : hints) {
+      auto reg = type.isIntOrFloat()
+                     ? Register::getValue(type, hint.ordinal())
+                     : Register::getRef(type, hint.ordinal(), /*isMove=*/false);
+      if (reg.isRef() != hint.isRef() || reg.byteWidth() != hint.byteWidth()) {
+        continue;
+      }
+      if (!isRegisterFree(reg)) continue;
+      markRegisterUsed(reg);
+      return reg;
+    }
+    return allocateRegister(type);
+  }
+
   void markRegisterUsed(Register reg) {
     int ordinalStart = reg.ordinal();
     if (reg.isRef()) {
@@ -202,6 +235,43 @@ static SmallVector<Block *, 8> sortBlocksInDominanceOrder(
   return orderedBlocks;
 }
 
+// Returns the registers already assigned to values forwarded to |blockArg| by
+// the branches into its block. Predecessors that have not yet been allocated
+// (such as loop back edges) are skipped.
+static SmallVector<Register, 4> getBlockArgHints(
+    BlockArgument blockArg, const llvm::DenseMap<Value, Register> &map) {
+  SmallVector<Register, 4> hints;
+  for (auto &blockUse : blockArg.getOwner()->getUses()) {
+    auto branchOp = dyn_cast<BranchOpInterface>(blockUse.getOwner());
+    if (!branchOp) continue;
+    auto operands =
+        branchOp.getSuccessorOperands(blockUse.getOperandNumber())
+            .getForwardedOperands();
+    if (blockArg.getArgNumber() >= operands.size()) continue;
+    auto it = map.find(operands[blockArg.getArgNumber()]);
+    if (it != map.end()) hints.push_back(it->second);
+  }
+  return hints;
+}
+
+// Returns the registers of already allocated block arguments that |value| is
+// forwarded to by branches. This is common for loop-carried values where the
+// loop header is allocated before the back edge.
+static SmallVector<Register, 4> getSuccessorArgHints(
+    Value value, const llvm::DenseMap<Value, Register> &map) {
+  SmallVector<Register, 4> hints;
+  for (auto &use : value.getUses()) {
+    auto branchOp = dyn_cast<BranchOpInterface>(use.getOwner());
+    if (!branchOp) continue;
+    auto blockArg =
+        branchOp.getSuccessorBlockArgument(use.getOperandNumber());
+    if (!blockArg.has_value()) continue;
+    auto it = map.find(blockArg.value());
+    if (it != map.end()) hints.push_back(it->second);
+  }
+  return hints;
+}
+
 // NOTE: this is not a good algorithm, nor is it a good allocator. If you're
 // looking at this and have ideas of how to do this for real please feel
 // free to rip it all apart :)
@@ -211,6 +281,13 @@ static SmallVector<Block *, 8> sortBlocksInDominanceOrder(
 // ensure we are avoiding as many moves as possible. The special case we need to
 // handle is when values are not defined within the current block (as values in
 // dominators are allowed to cross block boundaries outside of arguments).
+//
+// To avoid most of the branch remapping moves we coalesce values across
+// branches when the liveness allows: block arguments prefer the registers of
+// the values passed in by already allocated predecessors and values forwarded
+// to already allocated block arguments (loop back edges) prefer the registers
+// of those arguments. Each register bank is allocated independently so i32/i64
+// values never compete with refs.
 LogicalResult RegisterAllocation::recalculate(IREE::VM::FuncOp funcOp) {
   map_.clear();
 
@@ -237,9 +314,11 @@ LogicalResult RegisterAllocation::recalculate(IREE::VM::FuncOp funcOp) {
       registerUsage.markRegisterUsed(mapToRegister(liveInValue));
     }
 
-    // Allocate arguments first from left-to-right.
+    // Allocate arguments first from left-to-right. The entry block arguments
+    // are defined by the calling convention and must remain in order.
     for (auto blockArg : block->getArguments()) {
-      auto reg = registerUsage.allocateRegister(blockArg.getType());
+      auto reg = registerUsage.allocateRegister(
+          blockArg.getType(), getBlockArgHints(blockArg, map_));
       if (!reg.has_value()) {
         return funcOp.emitError() << "register allocation failed for block arg "
                                   << blockArg.getArgNumber();
@@ -265,7 +344,8 @@ LogicalResult RegisterAllocation::recalculate(IREE::VM::FuncOp funcOp) {
         }
       }
       for (auto result : op.getResults()) {
-        auto reg = registerUsage.allocateRegister(result.getType());
+        auto reg = registerUsage.allocateRegister(
+            result.getType(), getSuccessorArgHints(result, map_));
         if (!reg.has_value()) {
           return op.emitError() << "register allocation failed for result "
                                 << result.cast<OpResult>().getResultNumber();
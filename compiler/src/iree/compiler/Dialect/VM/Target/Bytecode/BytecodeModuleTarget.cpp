@@ -7,6 +7,7 @@
 #include "iree/compiler/Dialect/VM/Target/Bytecode/BytecodeModuleTarget.h"
 
 #include <algorithm>
+#include <memory>
 
 #include "iree/compiler/Dialect/Util/IR/UtilDialect.h"
 #include "iree/compiler/Dialect/Util/IR/UtilOps.h"
@@ -18,6 +19,7 @@
 #include "iree/compiler/Dialect/VM/IR/VMOps.h"
 #include "iree/compiler/Dialect/VM/Target/Bytecode/ArchiveWriter.h"
 #include "iree/compiler/Dialect/VM/Target/Bytecode/BytecodeEncoder.h"
+#include "iree/compiler/Dialect/VM/Target/Bytecode/RodataCompression.h"
 #include "iree/compiler/Dialect/VM/Transforms/Passes.h"
 #include "iree/compiler/Dialect/VM/Utils/CallingConvention.h"
 #include "iree/compiler/Utils/FlatbufferUtils.h"
@@ -58,6 +60,10 @@ static constexpr int kDefaultRodataAlignment = 16;
 // data at the risk of tripping the 31-bit FlatBuffer offset values.
 static constexpr int kMaxEmbeddedDataSize = 4 * 1024;
 
+// Uncompressed length of each independently compressed rodata block. Smaller
+// blocks allow more parallelism when decompressing at the cost of ratio.
+static constexpr uint64_t kRodataCompressionBlockLength = 1024 * 1024;
+
 struct TypeDef {
   Type type;
   std::string full_name;
@@ -74,6 +80,8 @@ struct RodataRef {
   uint64_t totalSize = 0;
   // Optional reference to the rodata in the file.
   Optional<ArchiveWriter::File> archiveFile;
+  // Optional compressed contents of the rodata stored in the archive file.
+  std::shared_ptr<LZ4CompressedData> compressedData;
 };
 
 }  // namespace
@@ -128,6 +136,29 @@ static flatbuffers_uint8_vec_ref_t serializeEmbeddedData(
   return flatbuffers_uint8_vec_end(fbb);
 }
 
+// Serializes and compresses the contents of |rodataOp|. Returns nullptr if the
+// data does not compress well enough to be worth decompressing at load time.
+static FailureOr<std::shared_ptr<LZ4CompressedData>> compressRodata(
+    IREE::VM::RodataOp rodataOp,
+    IREE::Util::SerializableAttrInterface rodataValue) {
+  SmallVector<char, 0> buffer;
+  if (failed(rodataValue.serializeToVector(llvm::support::endianness::little,
+                                           buffer))) {
+    return rodataOp.emitError() << "constant attribute failed to serialize: "
+                                   "unsupported format or encoding";
+  }
+  auto compressedData = std::make_shared<LZ4CompressedData>(compressLZ4Blocks(
+      ArrayRef<uint8_t>(reinterpret_cast<const uint8_t *>(buffer.data()),
+                        buffer.size()),
+      kRodataCompressionBlockLength));
+  // Require at least a 1/8th reduction; random data (such as trained weights
+  // without much structure) is left as-is so it can be mapped in place.
+  if (compressedData->data.size() > buffer.size() - buffer.size() / 8) {
+    return std::shared_ptr<LZ4CompressedData>();
+  }
+  return compressedData;
+}
+
 // Finds all types in the module and builds a type table mapping the index in
 // the vector to the type represented by the type ordinal.
 static std::vector<TypeDef> buildTypeTable(IREE::VM::ModuleOp moduleOp) {
@@ -423,6 +454,20 @@ static LogicalResult buildFlatBufferModule(
   SmallVector<iree_vm_RodataSegmentDef_ref_t, 8> rodataSegmentRefs;
   for (auto &rodataRef : llvm::reverse(rodataRefs)) {
     if (rodataRef.archiveFile.has_value()) {
+      iree_vm_LZ4DataDef_ref_t lz4Ref = 0;
+      if (rodataRef.compressedData) {
+        const auto &compressedData = *rodataRef.compressedData;
+        auto blockOffsetsRef = flatbuffers_uint64_vec_create(
+            fbb, compressedData.blockOffsets.data(),
+            compressedData.blockOffsets.size());
+        iree_vm_LZ4DataDef_start(fbb);
+        iree_vm_LZ4DataDef_uncompressed_length_add(
+            fbb, compressedData.uncompressedLength);
+        iree_vm_LZ4DataDef_block_length_add(fbb, compressedData.blockLength);
+        iree_vm_LZ4DataDef_block_offsets_add(fbb, blockOffsetsRef);
+        lz4Ref = iree_vm_LZ4DataDef_end(fbb);
+      }
+
       // Data is already in the file at a calculated offset.
       iree_vm_RodataSegmentDef_start(fbb);
       iree_vm_RodataSegmentDef_external_data_offset_add(
@@ -430,6 +475,10 @@ static LogicalResult buildFlatBufferModule(
                    rodataRef.archiveFile->prefixLength);
       iree_vm_RodataSegmentDef_external_data_length_add(
           fbb, rodataRef.archiveFile->fileLength);
+      if (lz4Ref) {
+        iree_vm_RodataSegmentDef_compression_type_add(
+            fbb, iree_vm_CompressionTypeDef_as_LZ4DataDef(lz4Ref));
+      }
       rodataSegmentRefs.push_back(iree_vm_RodataSegmentDef_end(fbb));
     } else {
       // Serialize the embedded data first so that we can reference it.
@@ -655,12 +704,31 @@ LogicalResult translateModuleToBytecode(IREE::VM::ModuleOp moduleOp,
           (rodataOp.getName() +
            mimeTypeToFileExtension(rodataOp.getMimeType().value_or("")))
               .str();
-      rodataRef.archiveFile = archiveWriter->declareFile(
-          fileName, rodataRef.alignment, rodataRef.totalSize,
-          [=](llvm::raw_ostream &os) {
-            return rodataValue.serializeToStream(
-                llvm::support::endianness::little, os);
-          });
+      // Data with a mime type is expected to be consumed in-place (such as
+      // executables) and is never compressed.
+      if (targetOptions.compressRodata &&
+          !rodataOp.getMimeType().has_value()) {
+        auto compressedData = compressRodata(rodataOp, rodataValue);
+        if (failed(compressedData)) return failure();
+        rodataRef.compressedData = std::move(compressedData.value());
+      }
+      if (auto compressedData = rodataRef.compressedData) {
+        rodataRef.archiveFile = archiveWriter->declareFile(
+            fileName, rodataRef.alignment, compressedData->data.size(),
+            [=](llvm::raw_ostream &os) {
+              os.write(reinterpret_cast<const char *>(
+                           compressedData->data.data()),
+                       compressedData->data.size());
+              return success();
+            });
+      } else {
+        rodataRef.archiveFile = archiveWriter->declareFile(
+            fileName, rodataRef.alignment, rodataRef.totalSize,
+            [=](llvm::raw_ostream &os) {
+              return rodataValue.serializeToStream(
+                  llvm::support::endianness::little, os);
+            });
+      }
     }
     rodataRefs[rodataOp.getOrdinal()->getLimitedValue()] = rodataRef;
   }
@@ -726,6 +794,12 @@ void BytecodeTargetOptions::bindOptions(OptionsBinder &binder) {
   binder.opt<bool>("iree-vm-bytecode-module-strip-debug-ops", stripDebugOps,
                    llvm::cl::cat(vmBytecodeOptionsCategory),
                    llvm::cl::desc("Strips debug-only ops from the module"));
+  binder.opt<bool>(
+      "iree-vm-bytecode-module-compress-rodata", compressRodata,
+      llvm::cl::cat(vmBytecodeOptionsCategory),
+      llvm::cl::desc("Compresses large rodata without a mime type (such as "
+                     "weights) with LZ4; it is decompressed when the module "
+                     "is loaded"));
   binder.opt<bool>(
       "iree-vm-emit-polyglot-zip", emitPolyglotZip,
       llvm::cl::cat(vmBytecodeOptionsCategory),
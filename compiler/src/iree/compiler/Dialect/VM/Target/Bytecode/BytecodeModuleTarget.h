@@ -56,6 +56,11 @@ struct BytecodeTargetOptions {
   // should be disabled in release builds.
   bool emitPolyglotZip = true;
 
+  // Compresses large rodata without a mime type (such as weights) in the
+  // archive. Compressed rodata is decompressed into host memory when the module
+  // is loaded instead of being referenced in place.
+  bool compressRodata = false;
+
   void bindOptions(OptionsBinder &binder);
   using FromFlags = OptionsFromFlags<BytecodeTargetOptions>;
 };
@@ -0,0 +1,119 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Dialect/VM/Target/Bytecode/RodataCompression.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace VM {
+
+// LZ4 block format constants; see
+// https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+static constexpr size_t kMinMatchLength = 4;
+// The last match must start at least this many bytes before the block end.
+static constexpr size_t kMatchStartLimit = 12;
+// The last this many bytes of the block are always literals.
+static constexpr size_t kLastLiterals = 5;
+static constexpr size_t kMaxOffset = 65535;
+static constexpr unsigned kHashLog = 16;
+
+static uint32_t readU32(const uint8_t *ptr) {
+  uint32_t value;
+  std::memcpy(&value, ptr, sizeof(value));
+  return value;
+}
+
+static uint32_t hashU32(uint32_t value) {
+  return (value * 2654435761u) >> (32 - kHashLog);
+}
+
+// Appends the 255-byte run extension of a length field that overflowed its
+// 4-bit token nibble.
+static void appendLengthExtension(size_t length, std::vector<uint8_t> &dst) {
+  for (; length >= 255; length -= 255) dst.push_back(255);
+  dst.push_back(static_cast<uint8_t>(length));
+}
+
+// Appends a sequence of the literals [begin, end) followed by an optional
+// match of |matchLength| bytes at |offset| back (omitted if zero).
+static void appendSequence(const uint8_t *begin, const uint8_t *end,
+                           size_t offset, size_t matchLength,
+                           std::vector<uint8_t> &dst) {
+  size_t literalLength = end - begin;
+  size_t matchCode = matchLength ? matchLength - kMinMatchLength : 0;
+  uint8_t token = static_cast<uint8_t>(
+      (std::min<size_t>(literalLength, 15) << 4) |
+      std::min<size_t>(matchCode, 15));
+  dst.push_back(token);
+  if (literalLength >= 15) appendLengthExtension(literalLength - 15, dst);
+  dst.insert(dst.end(), begin, end);
+  if (!matchLength) return;
+  dst.push_back(static_cast<uint8_t>(offset & 0xFF));
+  dst.push_back(static_cast<uint8_t>(offset >> 8));
+  if (matchCode >= 15) appendLengthExtension(matchCode - 15, dst);
+}
+
+// Greedy single-probe hash chain compressor. This favors compression speed
+// and a trivial decoder over ratio; bulk weight data rarely benefits from
+// deeper searches.
+static void compressLZ4Block(ArrayRef<uint8_t> source,
+                             std::vector<uint8_t> &dst) {
+  const uint8_t *base = source.data();
+  const size_t length = source.size();
+  size_t anchor = 0;
+  if (length > kMatchStartLimit) {
+    std::vector<int64_t> table(1u << kHashLog, -1);
+    const size_t matchStartLimit = length - kMatchStartLimit;
+    const size_t matchEndLimit = length - kLastLiterals;
+    size_t ip = 0;
+    while (ip < matchStartLimit) {
+      uint32_t sequence = readU32(base + ip);
+      uint32_t hash = hashU32(sequence);
+      int64_t candidate = table[hash];
+      table[hash] = static_cast<int64_t>(ip);
+      if (candidate < 0 || ip - candidate > kMaxOffset ||
+          readU32(base + candidate) != sequence) {
+        ++ip;
+        continue;
+      }
+      size_t matchEnd = ip + kMinMatchLength;
+      while (matchEnd < matchEndLimit &&
+             base[matchEnd] == base[candidate + (matchEnd - ip)]) {
+        ++matchEnd;
+      }
+      appendSequence(base + anchor, base + ip, ip - candidate, matchEnd - ip,
+                     dst);
+      ip = anchor = matchEnd;
+    }
+  }
+  appendSequence(base + anchor, base + length, /*offset=*/0,
+                 /*matchLength=*/0, dst);
+}
+
+LZ4CompressedData compressLZ4Blocks(ArrayRef<uint8_t> source,
+                                    uint64_t blockLength) {
+  LZ4CompressedData result;
+  result.uncompressedLength = source.size();
+  result.blockLength = blockLength;
+  for (uint64_t offset = 0; offset < source.size(); offset += blockLength) {
+    result.blockOffsets.push_back(result.data.size());
+    compressLZ4Block(
+        source.slice(offset, std::min<uint64_t>(blockLength,
+                                                source.size() - offset)),
+        result.data);
+  }
+  result.blockOffsets.push_back(result.data.size());
+  return result;
+}
+
+}  // namespace VM
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
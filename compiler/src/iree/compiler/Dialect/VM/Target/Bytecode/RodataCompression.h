@@ -0,0 +1,45 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_COMPILER_DIALECT_VM_TARGET_BYTECODE_RODATA_COMPRESSION_H_
+#define IREE_COMPILER_DIALECT_VM_TARGET_BYTECODE_RODATA_COMPRESSION_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "mlir/Support/LLVM.h"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace VM {
+
+// Rodata contents compressed as independent LZ4 blocks.
+// See LZ4DataDef in iree/schemas/bytecode_module_def.fbs.
+struct LZ4CompressedData {
+  // Length of the data prior to compression.
+  uint64_t uncompressedLength = 0;
+  // Uncompressed length of each block (except the last).
+  uint64_t blockLength = 0;
+  // Offset of each block in |data| followed by the total length of |data|.
+  SmallVector<uint64_t> blockOffsets;
+  // Concatenated compressed blocks.
+  std::vector<uint8_t> data;
+};
+
+// Compresses |source| into independent LZ4 blocks of up to |blockLength|
+// uncompressed bytes each.
+LZ4CompressedData compressLZ4Blocks(ArrayRef<uint8_t> source,
+                                    uint64_t blockLength);
+
+}  // namespace VM
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
+
+#endif  // IREE_COMPILER_DIALECT_VM_TARGET_BYTECODE_RODATA_COMPRESSION_H_
@@ -126,6 +126,38 @@ vm.import @divu.2d.i32(
   %sizes : tuple<i64, i64>
 )
 
+vm.import @max.2d.f32(
+  %lhs_buffer : !vm.buffer,
+  %lhs_offset : i64,
+  %lhs_strides : tuple<i64, i64>,
+
+  %rhs_buffer : !vm.buffer,
+  %rhs_offset : i64,
+  %rhs_strides : tuple<i64, i64>,
+
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+
+  %sizes : tuple<i64, i64>
+)
+
+vm.import @min.2d.f32(
+  %lhs_buffer : !vm.buffer,
+  %lhs_offset : i64,
+  %lhs_strides : tuple<i64, i64>,
+
+  %rhs_buffer : !vm.buffer,
+  %rhs_offset : i64,
+  %rhs_strides : tuple<i64, i64>,
+
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+
+  %sizes : tuple<i64, i64>
+)
+
 vm.import @mul.2d.f32(
   %lhs_buffer : !vm.buffer,
   %lhs_offset : i64,
@@ -355,6 +387,16 @@ vm.import @rsqrt.2d.f32(
   %sizes : tuple<i64, i64>
 )
 
+vm.import @tanh.2d.f32(
+  %in_buffer : !vm.buffer,
+  %in_offset : i64,
+  %in_strides : tuple<i64, i64>,
+  %out_buffer : !vm.buffer,
+  %out_offset : i64,
+  %out_strides : tuple<i64, i64>,
+  %sizes : tuple<i64, i64>
+)
+
 //==============================================================================
 // Strided copy ops
 // Variants of copy ops exist for power of two rank and datatype sizes.
@@ -273,7 +273,10 @@ bool isConsecutive(ArrayRef<int64_t> array) {
 // After that, batch_dims, contraction_dims, parallel_dims are
 // in consecutive order and not spliting the domain. This pattern inserts
 // reshapes to collapse consecutive reduction and parallel dims to always
-// generate a rank-3 dot_general op.
+// generate a rank-3 dot_general op. Dynamic shapes are collapsed with
+// tensor.collapse_shape and restored with tensor.expand_shape so that dynamic
+// batch or sequence dimensions (as exported by JAX) still reach the named
+// linalg.batch_matmul lowering.
 class TransposeReshapeGenericDotGeneral
     : public OpRewritePattern<mhlo::DotGeneralOp> {
  public:
@@ -292,10 +295,40 @@ class TransposeReshapeGenericDotGeneral
         b.getI64TensorAttr(targetOrder));
   }
 
+  // Returns the reassociation collapsing |rank| dims into the three groups
+  // [0, dimsBorder0), [dimsBorder0, dimsBorder1) and [dimsBorder1, rank).
+  static SmallVector<ReassociationIndices> getCollapseReassociation(
+      int64_t rank, size_t dimsBorder0, size_t dimsBorder1) {
+    SmallVector<ReassociationIndices> reassociation(3);
+    for (size_t i = 0, e = static_cast<size_t>(rank); i < e; ++i) {
+      size_t group = i < dimsBorder0 ? 0 : i < dimsBorder1 ? 1 : 2;
+      reassociation[group].push_back(i);
+    }
+    return reassociation;
+  }
+
+  // Returns true if the dims of |shape| grouped by |reassociation| can be
+  // expanded from their collapsed form: every group must be non-empty and
+  // have at most one dynamic dim.
+  static bool isExpandable(ArrayRef<int64_t> shape,
+                           ArrayRef<ReassociationIndices> reassociation) {
+    return llvm::all_of(reassociation, [&](const ReassociationIndices &group) {
+      return !group.empty() &&
+             llvm::count_if(group, [&](int64_t i) {
+               return ShapedType::isDynamic(shape[i]);
+             }) <= 1;
+    });
+  }
+
   Value ReshapeIfMorethan3D(OpBuilder &b, Location loc, Value src,
                             size_t dimsBorder0, size_t dimsBorder1) const {
     auto type = src.getType().cast<RankedTensorType>();
     if (type.getRank() <= 3) return src;
+    if (!type.hasStaticShape()) {
+      return b.create<tensor::CollapseShapeOp>(
+          loc, src,
+          getCollapseReassociation(type.getRank(), dimsBorder0, dimsBorder1));
+    }
     auto shape = type.getShape();
     SmallVector<int64_t, 4> result_shape = {
         std::accumulate(shape.begin(), shape.begin() + dimsBorder0, 1,
@@ -316,13 +349,6 @@ class TransposeReshapeGenericDotGeneral
     auto resultType = op.getResult().getType().dyn_cast<RankedTensorType>();
     if (!lhsShapeType || !rhsShapeType || !resultType) return failure();
 
-    // TODO(jpienaar): This pattern is not safe for dynamic shapes and seems to
-    // be (now) redundant with later pass that does handle them. To decouple
-    // fixing and verifying redundant, this just limits to static shapes and
-    // then will remove this in follow up.
-    if (!lhsShapeType.hasStaticShape() || !rhsShapeType.hasStaticShape())
-      return failure();
-
     SmallVector<int64_t> lhsTargetOrder, rhsTargetOrder;
     mhlo::DotDimensionNumbersAttr dimNumbers = op.getDotDimensionNumbers();
     auto lhsBatchingDims = dimNumbers.getLhsBatchingDimensions();
@@ -338,6 +364,31 @@ class TransposeReshapeGenericDotGeneral
     if (lhsBatchingDims.size() == 0 || rhsBatchingDims.size() == 0)
       return rewriter.notifyMatchFailure(op, "can be represented as mhlo.dot");
 
+    // Dynamic shapes are only handled when the canonical form is a plain
+    // {batch, M, K} x {batch, K, N} batch matmul whose collapsed dims can be
+    // expanded back into the result.
+    int64_t numBatchDims = lhsBatchingDims.size();
+    int64_t numLhsParallelDims =
+        lhsShapeType.getRank() - numBatchDims - lhsContractingDims.size();
+    bool isDynamic = !lhsShapeType.hasStaticShape() ||
+                     !rhsShapeType.hasStaticShape() ||
+                     !resultType.hasStaticShape();
+    if (isDynamic) {
+      int64_t numRhsParallelDims =
+          rhsShapeType.getRank() - numBatchDims - rhsContractingDims.size();
+      if (numLhsParallelDims == 0 || numRhsParallelDims == 0) {
+        return rewriter.notifyMatchFailure(
+            op, "dynamic dot_general without M or N dims");
+      }
+      if (!isExpandable(resultType.getShape(),
+                        getCollapseReassociation(
+                            resultType.getRank(), numBatchDims,
+                            numBatchDims + numLhsParallelDims))) {
+        return rewriter.notifyMatchFailure(
+            op, "dynamic dims can't be collapsed into a batch matmul");
+      }
+    }
+
     SmallVector<bool> isLhsParallel(lhsShapeType.getRank(), true);
     for (auto i : lhsBatchingDims) {
       lhsTargetOrder.push_back(i);
@@ -431,7 +482,12 @@ class TransposeReshapeGenericDotGeneral
     }
 
     Value result = newOp.getResult();
-    if (needReshapeResult) {
+    if (needReshapeResult && isDynamic) {
+      result = rewriter.create<tensor::ExpandShapeOp>(
+          op.getLoc(), resultType, result,
+          getCollapseReassociation(resultType.getRank(), numBatchDims,
+                                   numBatchDims + numLhsParallelDims));
+    } else if (needReshapeResult) {
       result =
           rewriter.create<mhlo::ReshapeOp>(op.getLoc(), resultType, result);
     }
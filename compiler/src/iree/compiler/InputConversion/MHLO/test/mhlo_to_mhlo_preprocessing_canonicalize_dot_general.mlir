@@ -15,3 +15,24 @@ func.func public @dot_general_2d(%arg0: tensor<4x3xf32> {mhlo.sharding = ""}, %a
   // CHECK-SAME: precision_config = [#mhlo<precision HIGHEST>, #mhlo<precision HIGHEST>]
   return %0 : tensor<3xf32>
 }
+
+// -----
+
+// CHECK-LABEL: @dot_general_dynamic_attention
+func.func public @dot_general_dynamic_attention(%arg0: tensor<?x128x16x64xf32>, %arg1: tensor<?x128x16x64xf32>) -> tensor<?x16x128x128xf32> {
+  // CHECK: %[[LHS_T:.+]] = "mhlo.transpose"(%arg0) {permutation = dense<[0, 2, 1, 3]> : tensor<4xi64>} : (tensor<?x128x16x64xf32>) -> tensor<?x16x128x64xf32>
+  // CHECK: %[[RHS_T:.+]] = "mhlo.transpose"(%arg1) {permutation = dense<[0, 2, 3, 1]> : tensor<4xi64>} : (tensor<?x128x16x64xf32>) -> tensor<?x16x64x128xf32>
+  // CHECK: %[[LHS:.+]] = tensor.collapse_shape %[[LHS_T]] {{\[}}[0, 1], [2], [3]] : tensor<?x16x128x64xf32> into tensor<?x128x64xf32>
+  // CHECK: %[[RHS:.+]] = tensor.collapse_shape %[[RHS_T]] {{\[}}[0, 1], [2], [3]] : tensor<?x16x64x128xf32> into tensor<?x64x128xf32>
+  // CHECK: %[[DOT:.+]] = "mhlo.dot_general"(%[[LHS]], %[[RHS]])
+  // CHECK-SAME: dot_dimension_numbers = #mhlo.dot<
+  // CHECK-SAME: lhs_batching_dimensions = [0]
+  // CHECK-SAME: rhs_batching_dimensions = [0]
+  // CHECK-SAME: lhs_contracting_dimensions = [2]
+  // CHECK-SAME: rhs_contracting_dimensions = [1]>
+  // CHECK-SAME: -> tensor<?x128x128xf32>
+  // CHECK: %[[RESULT:.+]] = tensor.expand_shape %[[DOT]] {{\[}}[0, 1], [2], [3]] : tensor<?x128x128xf32> into tensor<?x16x128x128xf32>
+  // CHECK: return %[[RESULT]]
+  %0 = "mhlo.dot_general"(%arg0, %arg1) {dot_dimension_numbers = #mhlo.dot<lhs_batching_dimensions = [0, 2], rhs_batching_dimensions = [0, 2], lhs_contracting_dimensions = [3], rhs_contracting_dimensions = [3]>} : (tensor<?x128x16x64xf32>, tensor<?x128x16x64xf32>) -> tensor<?x16x128x128xf32>
+  return %0 : tensor<?x16x128x128xf32>
+}
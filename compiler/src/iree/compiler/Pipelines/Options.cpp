@@ -69,6 +69,13 @@ void HighLevelOptimizationOptions::bindOptions(OptionsBinder &binder) {
           "Hoists the results of latent constant expressions into immutable "
           "global initializers for evaluation at program load."),
       llvm::cl::cat(category));
+  binder.opt<bool>(
+      "iree-opt-data-tiling", dataTiling,
+      llvm::cl::desc(
+          "Enables data tiling of contractions into packed mmt4d layouts. "
+          "Only applies when all target backends materialize encodings "
+          "(llvm-cpu, vmvx, vmvx-inline); ignored otherwise."),
+      llvm::cl::cat(category));
   binder.opt<bool>(
       "iree-opt-numeric-precision-reduction", numericPrecisionReduction,
       llvm::cl::desc(
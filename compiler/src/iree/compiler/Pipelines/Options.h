@@ -65,6 +65,10 @@ struct HighLevelOptimizationOptions {
   // and runtime.
   bool constEval = false;
 
+  // Enables data tiling of contractions when every target backend can
+  // materialize the resulting tensor encodings.
+  bool dataTiling = true;
+
   // Optimizations to reduce numeric precision where it is safe to do so.
   bool numericPrecisionReduction = false;
 
@@ -96,6 +96,19 @@ void buildIREEVMTransformPassPipeline(
   flowOptions.numericPrecisionReduction =
       highLevelOptimizationOptions.numericPrecisionReduction;
 
+  // Data tiling picks packed layouts at codegen time so it can only be used
+  // when every executable target knows how to materialize encodings.
+  if (highLevelOptimizationOptions.dataTiling) {
+    auto materializesEncodings = [](const std::string &target) {
+      return target == "llvm-cpu" || target == "vmvx" ||
+             target == "vmvx-inline";
+    };
+    flowOptions.dataTiling =
+        !executableOptions.targets.empty() &&
+        llvm::all_of(executableOptions.targets, materializesEncodings) &&
+        llvm::all_of(executableOptions.fallbackTargets, materializesEncodings);
+  }
+
   // Enable const-eval via hook. For debug builds, we assert if enabled without
   // a hook. For release, we just silently skip enabling const-eval.
   if (highLevelOptimizationOptions.constEval) {
@@ -16,6 +16,36 @@
 extern "C" {
 #endif  // __cplusplus
 
+//===----------------------------------------------------------------------===//
+// iree_hal_rocm_device_t
+//===----------------------------------------------------------------------===//
+
+// Defines how command buffers are recorded and executed.
+typedef enum iree_hal_rocm_command_buffer_mode_e {
+  // Command buffers are directly issued as they are recorded.
+  IREE_HAL_ROCM_COMMAND_BUFFER_MODE_DIRECT = 0,
+  // Command buffers are recorded into HIP graphs and launched on submission.
+  // Reusable command buffers that are re-recorded with the same topology update
+  // their graph exec in-place instead of reinstantiating it.
+  IREE_HAL_ROCM_COMMAND_BUFFER_MODE_GRAPH = 1,
+} iree_hal_rocm_command_buffer_mode_t;
+
+// Parameters configuring an iree_hal_rocm_device_t.
+// Must be initialized with iree_hal_rocm_device_params_initialize prior to use.
+typedef struct iree_hal_rocm_device_params_t {
+  // Total size of each block in the device shared block pool.
+  // Larger sizes will lower overhead and ensure the heap isn't hit for
+  // transient allocations while also increasing memory consumption.
+  iree_host_size_t arena_block_size;
+
+  // Specifies how command buffers are recorded and executed.
+  iree_hal_rocm_command_buffer_mode_t command_buffer_mode;
+} iree_hal_rocm_device_params_t;
+
+// Initializes |out_params| to default values.
+IREE_API_EXPORT void iree_hal_rocm_device_params_initialize(
+    iree_hal_rocm_device_params_t *out_params);
+
 //===----------------------------------------------------------------------===//
 // iree_hal_rocm_driver_t
 //===----------------------------------------------------------------------===//
@@ -31,10 +61,12 @@ IREE_API_EXPORT void iree_hal_rocm_driver_options_initialize(
     iree_hal_rocm_driver_options_t *out_options);
 
 // Creates a ROCM HAL driver that manage its own hipcontext.
+// |default_params| is used when creating devices.
 //
 // |out_driver| must be released by the caller (see |iree_hal_driver_release|).
 IREE_API_EXPORT iree_status_t iree_hal_rocm_driver_create(
     iree_string_view_t identifier,
+    const iree_hal_rocm_device_params_t *default_params,
     const iree_hal_rocm_driver_options_t *options,
     iree_allocator_t host_allocator, iree_hal_driver_t **out_driver);
 
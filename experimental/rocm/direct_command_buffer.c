@@ -27,6 +27,9 @@ typedef struct {
   iree_hal_rocm_context_wrapper_t* context;
   iree_arena_block_pool_t* block_pool;
 
+  // Stream all commands are issued on as they are recorded.
+  hipStream_t stream;
+
   // Keep track of the current set of kernel arguments.
   int32_t push_constant[IREE_HAL_ROCM_MAX_PUSH_CONSTANT_COUNT];
   void* current_descriptor[];
@@ -51,7 +54,7 @@ iree_status_t iree_hal_rocm_direct_command_buffer_create(
     iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
-    iree_arena_block_pool_t* block_pool,
+    hipStream_t stream, iree_arena_block_pool_t* block_pool,
     iree_hal_command_buffer_t** out_command_buffer) {
   IREE_ASSERT_ARGUMENT(context);
   IREE_ASSERT_ARGUMENT(block_pool);
@@ -76,6 +79,7 @@ iree_status_t iree_hal_rocm_direct_command_buffer_create(
         device, mode, command_categories, queue_affinity, binding_capacity,
         &iree_hal_rocm_direct_command_buffer_vtable, &command_buffer->base);
     command_buffer->context = context;
+    command_buffer->stream = stream;
     command_buffer->block_pool = block_pool;
     hipDeviceptr_t* device_ptrs =
         (hipDeviceptr_t*)(command_buffer->current_descriptor +
@@ -199,27 +203,28 @@ static iree_status_t iree_hal_rocm_direct_command_buffer_fill_buffer(
   hipDeviceptr_t dst =
       (hipDeviceptr_t)((uintptr_t)target_device_buffer + target_offset);
   size_t num_elements = length / pattern_length;
-  // TODO(raikonenfnu): Currently using NULL stream, need to figure out way to
-  // access proper stream from command buffer
   switch (pattern_length) {
     case 4: {
       ROCM_RETURN_IF_ERROR(
           command_buffer->context->syms,
-          hipMemsetD32Async(dst, *(const uint32_t*)(pattern), num_elements, 0),
+          hipMemsetD32Async(dst, *(const uint32_t*)(pattern), num_elements,
+                            command_buffer->stream),
           "hipMemsetD32Async");
       break;
     }
     case 2: {
       ROCM_RETURN_IF_ERROR(
           command_buffer->context->syms,
-          hipMemsetD16Async(dst, *(const uint16_t*)(pattern), num_elements, 0),
+          hipMemsetD16Async(dst, *(const uint16_t*)(pattern), num_elements,
+                            command_buffer->stream),
           "hipMemsetD16Async");
       break;
     }
     case 1: {
       ROCM_RETURN_IF_ERROR(
           command_buffer->context->syms,
-          hipMemsetD8Async(dst, *(const uint8_t*)(pattern), num_elements, 0),
+          hipMemsetD8Async(dst, *(const uint8_t*)(pattern), num_elements,
+                           command_buffer->stream),
           "hipMemsetD*Async");
       break;
     }
@@ -256,11 +261,10 @@ static iree_status_t iree_hal_rocm_direct_command_buffer_copy_buffer(
       (hipDeviceptr_t)((uintptr_t)target_device_buffer + target_offset);
   hipDeviceptr_t src =
       (hipDeviceptr_t)((uintptr_t)source_device_buffer + source_offset);
-  // TODO(raikonenfnu): Currently using NULL stream, need to figure out way to
-  // access proper stream from command buffer
   ROCM_RETURN_IF_ERROR(
       command_buffer->context->syms,
-      hipMemcpyAsync(dst, src, length, hipMemcpyDeviceToDevice, 0),
+      hipMemcpyAsync(dst, src, length, hipMemcpyDeviceToDevice,
+                     command_buffer->stream),
       "hipMemcpyAsync");
   return iree_ok_status();
 }
@@ -366,12 +370,11 @@ static iree_status_t iree_hal_rocm_direct_command_buffer_dispatch(
       executable, entry_point, &block_size_x, &block_size_y, &block_size_z));
   hipFunction_t func =
       iree_hal_rocm_native_executable_for_entry_point(executable, entry_point);
-  // TODO(raikonenfnu): Currently using NULL stream, need to figure out way to
-  // access proper stream from command buffer
   ROCM_RETURN_IF_ERROR(
       command_buffer->context->syms,
       hipModuleLaunchKernel(func, workgroup_x, workgroup_y, workgroup_z,
-                            block_size_x, block_size_y, block_size_z, 0, 0,
+                            block_size_x, block_size_y, block_size_z, 0,
+                            command_buffer->stream,
                             command_buffer->current_descriptor, NULL),
       "hipModuleLaunchKernel");
   return iree_ok_status();
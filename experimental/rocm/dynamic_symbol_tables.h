@@ -6,10 +6,16 @@
 
 RC_PFN_DECL(hipCtxCreate, hipCtx_t *, unsigned int, hipDevice_t)
 RC_PFN_DECL(hipCtxDestroy, hipCtx_t)
+RC_PFN_DECL(hipCtxSetCurrent, hipCtx_t)
 RC_PFN_DECL(hipDeviceGet, hipDevice_t *, int)  // No direct, need to modify
 RC_PFN_DECL(hipGetDeviceCount, int *)
 RC_PFN_DECL(hipDeviceGetName, char *, int,
             hipDevice_t)  // No direct, need to modify
+RC_PFN_DECL(hipEventCreateWithFlags, hipEvent_t *, unsigned int)
+RC_PFN_DECL(hipEventDestroy, hipEvent_t)
+RC_PFN_DECL(hipEventQuery, hipEvent_t)
+RC_PFN_DECL(hipEventRecord, hipEvent_t, hipStream_t)
+RC_PFN_DECL(hipEventSynchronize, hipEvent_t)
 RC_PFN_STR_DECL(
     hipGetErrorName,
     hipError_t)  // Unlike other functions hipGetErrorName(hipError_t) return
@@ -47,3 +53,18 @@ RC_PFN_DECL(hipStreamCreateWithFlags, hipStream_t *, unsigned int)
 RC_PFN_DECL(hipStreamDestroy, hipStream_t)
 RC_PFN_DECL(hipStreamSynchronize, hipStream_t)
 RC_PFN_DECL(hipStreamWaitEvent, hipStream_t, hipEvent_t, unsigned int)
+RC_PFN_DECL(hipGraphCreate, hipGraph_t *, unsigned int)
+RC_PFN_DECL(hipGraphDestroy, hipGraph_t)
+RC_PFN_DECL(hipGraphInstantiate, hipGraphExec_t *, hipGraph_t, hipGraphNode_t *,
+            char *, size_t)
+RC_PFN_DECL(hipGraphExecDestroy, hipGraphExec_t)
+RC_PFN_DECL(hipGraphExecUpdate, hipGraphExec_t, hipGraph_t, hipGraphNode_t *,
+            hipGraphExecUpdateResult *)
+RC_PFN_DECL(hipGraphLaunch, hipGraphExec_t, hipStream_t)
+RC_PFN_DECL(hipGraphAddKernelNode, hipGraphNode_t *, hipGraph_t,
+            const hipGraphNode_t *, size_t, const hipKernelNodeParams *)
+RC_PFN_DECL(hipGraphAddMemcpyNode1D, hipGraphNode_t *, hipGraph_t,
+            const hipGraphNode_t *, size_t, void *, const void *, size_t,
+            hipMemcpyKind)
+RC_PFN_DECL(hipGraphAddMemsetNode, hipGraphNode_t *, hipGraph_t,
+            const hipGraphNode_t *, size_t, const hipMemsetParams *)
@@ -6,16 +6,61 @@
 
 #include "experimental/rocm/event_semaphore.h"
 
+#include <inttypes.h>
 #include <stddef.h>
+#include <string.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/utils/semaphore_base.h"
 
+// Sentinel used the semaphore has failed and an error status is set.
+#define IREE_HAL_ROCM_SEMAPHORE_FAILURE_VALUE UINT64_MAX
+
+// Interval between polls of a pending event when a waiter has a finite
+// deadline. hipEventSynchronize cannot time out and is only used for infinite
+// waits.
+#define IREE_HAL_ROCM_SEMAPHORE_POLL_INTERVAL_NS (50 * 1000)
+
+// A device-side signal of the semaphore to |value| that will be reached when
+// |event| completes.
+typedef struct iree_hal_rocm_semaphore_pending_signal_t {
+  uint64_t value;
+  hipEvent_t event;
+} iree_hal_rocm_semaphore_pending_signal_t;
+
 typedef struct iree_hal_rocm_semaphore_t {
   iree_hal_semaphore_t base;
   iree_hal_rocm_context_wrapper_t* context;
-  iree_atomic_int64_t value;
+
+  // Posted whenever the value changes, the semaphore fails, or a new pending
+  // signal is enqueued so that host waiters can re-evaluate their wait.
+  iree_notification_t notification;
+
+  // Guards all mutable fields. We expect low contention on semaphores and since
+  // iree_slim_mutex_t is (effectively) just a CAS this keeps things simpler
+  // than trying to make the entire structure lock-free.
+  iree_slim_mutex_t mutex;
+
+  // Last value known to be reached by the host or device. May be
+  // IREE_HAL_ROCM_SEMAPHORE_FAILURE_VALUE to indicate that the semaphore has
+  // been signaled for failure and |failure_status| contains the error.
+  uint64_t current_value;
+
+  // OK or the status passed to iree_hal_semaphore_fail. Owned by the semaphore.
+  iree_status_t failure_status;
+
+  // Number of host threads blocked on a pending signal event. Completed pending
+  // signals are only retired (and their events destroyed) when there are no
+  // waiters that may be using them.
+  iree_host_size_t waiter_count;
+
+  // Device-side signals in increasing value order that have not yet been
+  // observed as completed.
+  iree_host_size_t pending_count;
+  iree_host_size_t pending_capacity;
+  iree_hal_rocm_semaphore_pending_signal_t* pending_signals;
 } iree_hal_rocm_semaphore_t;
 
 static const iree_hal_semaphore_vtable_t iree_hal_rocm_semaphore_vtable;
@@ -31,15 +76,21 @@ iree_status_t iree_hal_rocm_semaphore_create(
     iree_hal_semaphore_t** out_semaphore) {
   IREE_ASSERT_ARGUMENT(context);
   IREE_ASSERT_ARGUMENT(out_semaphore);
+  *out_semaphore = NULL;
   IREE_TRACE_ZONE_BEGIN(z0);
 
   iree_hal_rocm_semaphore_t* semaphore = NULL;
   iree_status_t status = iree_allocator_malloc(
       context->host_allocator, sizeof(*semaphore), (void**)&semaphore);
   if (iree_status_is_ok(status)) {
+    memset(semaphore, 0, sizeof(*semaphore));
     iree_hal_semaphore_initialize(&iree_hal_rocm_semaphore_vtable,
                                   &semaphore->base);
     semaphore->context = context;
+    iree_notification_initialize(&semaphore->notification);
+    iree_slim_mutex_initialize(&semaphore->mutex);
+    semaphore->current_value = initial_value;
+    semaphore->failure_status = iree_ok_status();
     *out_semaphore = &semaphore->base;
   }
 
@@ -54,29 +105,139 @@ static void iree_hal_rocm_semaphore_destroy(
   iree_allocator_t host_allocator = semaphore->context->host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  // Events still recorded on a stream are released by HIP once they complete.
+  for (iree_host_size_t i = 0; i < semaphore->pending_count; ++i) {
+    ROCM_IGNORE_ERROR(semaphore->context->syms,
+                      hipEventDestroy(semaphore->pending_signals[i].event));
+  }
+  iree_allocator_free(host_allocator, semaphore->pending_signals);
+
+  iree_slim_mutex_deinitialize(&semaphore->mutex);
+  iree_notification_deinitialize(&semaphore->notification);
+  iree_status_ignore(semaphore->failure_status);
+
   iree_hal_semaphore_deinitialize(&semaphore->base);
   iree_allocator_free(host_allocator, semaphore);
 
   IREE_TRACE_ZONE_END(z0);
 }
 
+bool iree_hal_rocm_semaphore_isa(iree_hal_semaphore_t* semaphore) {
+  return iree_hal_resource_is(semaphore, &iree_hal_rocm_semaphore_vtable);
+}
+
+// Fails the semaphore with |status| if it has not already failed.
+// The semaphore mutex must be held. Returns true if the semaphore transitioned
+// to the failed state and waiters must be notified.
+static bool iree_hal_rocm_semaphore_fail_unsafe(
+    iree_hal_rocm_semaphore_t* semaphore, iree_status_t status) {
+  // Only preserve the first failure.
+  if (!iree_status_is_ok(semaphore->failure_status)) {
+    iree_status_ignore(status);
+    return false;
+  }
+  semaphore->current_value = IREE_HAL_ROCM_SEMAPHORE_FAILURE_VALUE;
+  semaphore->failure_status = status;
+  return true;
+}
+
+// Advances the current value past all pending signals that have completed on
+// the device. The semaphore mutex must be held. Returns true if the value
+// changed and waiters must be notified.
+static bool iree_hal_rocm_semaphore_refresh_unsafe(
+    iree_hal_rocm_semaphore_t* semaphore) {
+  if (semaphore->pending_count == 0) return false;
+  if (!iree_status_is_ok(semaphore->failure_status)) return false;
+
+  // Pending signals are recorded in submission order. Signals enqueued on
+  // different streams may complete out of order but values must be reached in
+  // order so we stop at the first that has not completed.
+  iree_host_size_t completed_count = 0;
+  uint64_t completed_value = semaphore->current_value;
+  for (; completed_count < semaphore->pending_count; ++completed_count) {
+    const iree_hal_rocm_semaphore_pending_signal_t* pending_signal =
+        &semaphore->pending_signals[completed_count];
+    hipError_t result = semaphore->context->syms->hipEventQuery(
+        pending_signal->event);
+    if (result == hipErrorNotReady) break;
+    if (result != hipSuccess) {
+      return iree_hal_rocm_semaphore_fail_unsafe(
+          semaphore, iree_hal_rocm_result_to_status(semaphore->context->syms,
+                                                    result, __FILE__,
+                                                    __LINE__));
+    }
+    if (pending_signal->value > completed_value) {
+      completed_value = pending_signal->value;
+    }
+  }
+  bool changed = completed_value != semaphore->current_value;
+  semaphore->current_value = completed_value;
+
+  // Retire the completed signals if no waiter may be blocked on them.
+  if (completed_count > 0 && semaphore->waiter_count == 0) {
+    for (iree_host_size_t i = 0; i < completed_count; ++i) {
+      ROCM_IGNORE_ERROR(semaphore->context->syms,
+                        hipEventDestroy(semaphore->pending_signals[i].event));
+    }
+    semaphore->pending_count -= completed_count;
+    memmove(semaphore->pending_signals,
+            semaphore->pending_signals + completed_count,
+            semaphore->pending_count * sizeof(semaphore->pending_signals[0]));
+  }
+
+  return changed;
+}
+
+// Notifies timepoints and host waiters of a change in the semaphore state.
+// The semaphore mutex must not be held.
+static void iree_hal_rocm_semaphore_notify(iree_hal_rocm_semaphore_t* semaphore,
+                                           uint64_t value,
+                                           iree_status_code_t status_code) {
+  iree_hal_semaphore_notify(&semaphore->base, value, status_code);
+  iree_notification_post(&semaphore->notification, IREE_ALL_WAITERS);
+}
+
 static iree_status_t iree_hal_rocm_semaphore_query(
     iree_hal_semaphore_t* base_semaphore, uint64_t* out_value) {
   iree_hal_rocm_semaphore_t* semaphore =
       iree_hal_rocm_semaphore_cast(base_semaphore);
-  // TODO: Support semaphores completely.
-  *out_value =
-      iree_atomic_load_int64(&semaphore->value, iree_memory_order_acquire);
-  return iree_ok_status();
+
+  iree_slim_mutex_lock(&semaphore->mutex);
+  bool changed = iree_hal_rocm_semaphore_refresh_unsafe(semaphore);
+  *out_value = semaphore->current_value;
+  iree_status_code_t status_code = iree_status_code(semaphore->failure_status);
+  iree_status_t status = iree_ok_status();
+  if (*out_value >= IREE_HAL_ROCM_SEMAPHORE_FAILURE_VALUE) {
+    status = iree_status_clone(semaphore->failure_status);
+  }
+  iree_slim_mutex_unlock(&semaphore->mutex);
+
+  if (changed) {
+    iree_hal_rocm_semaphore_notify(semaphore, *out_value, status_code);
+  }
+  return status;
 }
 
 static iree_status_t iree_hal_rocm_semaphore_signal(
     iree_hal_semaphore_t* base_semaphore, uint64_t new_value) {
   iree_hal_rocm_semaphore_t* semaphore =
       iree_hal_rocm_semaphore_cast(base_semaphore);
-  // TODO: Support semaphores completely. Return OK currently as everything is
-  // synchronized for each submit to allow things to run.
-  iree_hal_semaphore_poll(&semaphore->base);
+
+  iree_slim_mutex_lock(&semaphore->mutex);
+  iree_hal_rocm_semaphore_refresh_unsafe(semaphore);
+  if (new_value <= semaphore->current_value) {
+    uint64_t current_value IREE_ATTRIBUTE_UNUSED = semaphore->current_value;
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "semaphore values must be monotonically "
+                            "increasing; current_value=%" PRIu64
+                            ", new_value=%" PRIu64,
+                            current_value, new_value);
+  }
+  semaphore->current_value = new_value;
+  iree_slim_mutex_unlock(&semaphore->mutex);
+
+  iree_hal_rocm_semaphore_notify(semaphore, new_value, IREE_STATUS_OK);
   return iree_ok_status();
 }
 
@@ -84,9 +245,78 @@ static void iree_hal_rocm_semaphore_fail(iree_hal_semaphore_t* base_semaphore,
                                          iree_status_t status) {
   iree_hal_rocm_semaphore_t* semaphore =
       iree_hal_rocm_semaphore_cast(base_semaphore);
-  // TODO: save status and mark timepoint as failed.
-  iree_status_ignore(status);
-  iree_hal_semaphore_poll(&semaphore->base);
+  const iree_status_code_t status_code = iree_status_code(status);
+
+  iree_slim_mutex_lock(&semaphore->mutex);
+  bool failed = iree_hal_rocm_semaphore_fail_unsafe(semaphore, status);
+  iree_slim_mutex_unlock(&semaphore->mutex);
+
+  if (failed) {
+    iree_hal_rocm_semaphore_notify(
+        semaphore, IREE_HAL_ROCM_SEMAPHORE_FAILURE_VALUE, status_code);
+  }
+}
+
+// Returns the event of the first pending signal that will reach |value|.
+// The semaphore mutex must be held.
+static hipEvent_t iree_hal_rocm_semaphore_find_pending_event_unsafe(
+    iree_hal_rocm_semaphore_t* semaphore, uint64_t value) {
+  for (iree_host_size_t i = 0; i < semaphore->pending_count; ++i) {
+    if (semaphore->pending_signals[i].value >= value) {
+      return semaphore->pending_signals[i].event;
+    }
+  }
+  return NULL;
+}
+
+typedef struct iree_hal_rocm_semaphore_wait_state_t {
+  iree_hal_rocm_semaphore_t* semaphore;
+  uint64_t value;
+} iree_hal_rocm_semaphore_wait_state_t;
+
+// Returns true if the wait can make progress: the semaphore has reached the
+// value, has failed, or has a pending device signal that will reach it.
+// Used with with iree_condition_fn_t and must match that signature.
+static bool iree_hal_rocm_semaphore_is_waitable(
+    iree_hal_rocm_semaphore_wait_state_t* state) {
+  iree_hal_rocm_semaphore_t* semaphore = state->semaphore;
+  iree_slim_mutex_lock(&semaphore->mutex);
+  bool is_waitable =
+      semaphore->current_value >= state->value ||
+      !iree_status_is_ok(semaphore->failure_status) ||
+      iree_hal_rocm_semaphore_find_pending_event_unsafe(semaphore,
+                                                        state->value) != NULL;
+  iree_slim_mutex_unlock(&semaphore->mutex);
+  return is_waitable;
+}
+
+// Blocks until |event| completes or |deadline_ns| elapses.
+static iree_status_t iree_hal_rocm_semaphore_wait_event(
+    iree_hal_rocm_semaphore_t* semaphore, hipEvent_t event,
+    iree_time_t deadline_ns) {
+  if (deadline_ns == IREE_TIME_INFINITE_FUTURE) {
+    IREE_TRACE_ZONE_BEGIN_NAMED(z0, "hipEventSynchronize");
+    iree_status_t status = ROCM_RESULT_TO_STATUS(semaphore->context->syms,
+                                                 hipEventSynchronize(event),
+                                                 "hipEventSynchronize");
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+  for (;;) {
+    hipError_t result = semaphore->context->syms->hipEventQuery(event);
+    if (result != hipErrorNotReady) {
+      return iree_hal_rocm_result_to_status(semaphore->context->syms, result,
+                                            __FILE__, __LINE__);
+    }
+    iree_time_t now_ns = iree_time_now();
+    if (now_ns >= deadline_ns) {
+      return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+    }
+    iree_time_t poll_deadline_ns =
+        now_ns + IREE_HAL_ROCM_SEMAPHORE_POLL_INTERVAL_NS;
+    iree_wait_until(poll_deadline_ns < deadline_ns ? poll_deadline_ns
+                                                   : deadline_ns);
+  }
 }
 
 static iree_status_t iree_hal_rocm_semaphore_wait(
@@ -94,10 +324,192 @@ static iree_status_t iree_hal_rocm_semaphore_wait(
     iree_timeout_t timeout) {
   iree_hal_rocm_semaphore_t* semaphore =
       iree_hal_rocm_semaphore_cast(base_semaphore);
-  // TODO: Support semaphores completely. Return OK currently as everything is
-  // synchronized for each submit to allow things to run.
-  iree_hal_semaphore_poll(&semaphore->base);
-  return iree_ok_status();
+  const iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
+
+  for (;;) {
+    iree_slim_mutex_lock(&semaphore->mutex);
+    bool changed = iree_hal_rocm_semaphore_refresh_unsafe(semaphore);
+    const uint64_t current_value = semaphore->current_value;
+    const iree_status_code_t status_code =
+        iree_status_code(semaphore->failure_status);
+    hipEvent_t event = NULL;
+    if (status_code == IREE_STATUS_OK && current_value < value) {
+      event = iree_hal_rocm_semaphore_find_pending_event_unsafe(semaphore,
+                                                                 value);
+      if (event) ++semaphore->waiter_count;
+    }
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    if (changed) {
+      iree_hal_rocm_semaphore_notify(semaphore, current_value, status_code);
+    }
+
+    if (status_code != IREE_STATUS_OK) {
+      // Failed; return an error to tell callers to query for it.
+      return iree_status_from_code(IREE_STATUS_ABORTED);
+    } else if (current_value >= value) {
+      return iree_ok_status();
+    } else if (event) {
+      // A submission will signal the value; block on its completion event and
+      // then loop around to pick up the new value.
+      iree_status_t status =
+          iree_hal_rocm_semaphore_wait_event(semaphore, event, deadline_ns);
+      iree_slim_mutex_lock(&semaphore->mutex);
+      --semaphore->waiter_count;
+      iree_slim_mutex_unlock(&semaphore->mutex);
+      IREE_RETURN_IF_ERROR(status);
+    } else if (iree_time_now() >= deadline_ns) {
+      return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+    } else {
+      // Nothing has been submitted that will reach the value yet; wait for a
+      // host signal or for a submission to enqueue a device signal.
+      iree_hal_rocm_semaphore_wait_state_t wait_state = {
+          .semaphore = semaphore,
+          .value = value,
+      };
+      if (!iree_notification_await(
+              &semaphore->notification,
+              (iree_condition_fn_t)iree_hal_rocm_semaphore_is_waitable,
+              &wait_state, iree_make_deadline(deadline_ns))) {
+        return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+      }
+    }
+  }
+}
+
+iree_status_t iree_hal_rocm_semaphore_enqueue_signal(
+    iree_hal_semaphore_t* base_semaphore, uint64_t value, hipStream_t stream) {
+  iree_hal_rocm_semaphore_t* semaphore =
+      iree_hal_rocm_semaphore_cast(base_semaphore);
+  iree_allocator_t host_allocator = semaphore->context->host_allocator;
+
+  iree_slim_mutex_lock(&semaphore->mutex);
+  iree_hal_rocm_semaphore_refresh_unsafe(semaphore);
+  uint64_t last_value =
+      semaphore->pending_count > 0
+          ? semaphore->pending_signals[semaphore->pending_count - 1].value
+          : semaphore->current_value;
+  if (value <= last_value) {
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "semaphore values must be monotonically "
+                            "increasing; last_value=%" PRIu64
+                            ", new_value=%" PRIu64,
+                            last_value, value);
+  }
+
+  iree_status_t status = iree_ok_status();
+  if (semaphore->pending_count == semaphore->pending_capacity) {
+    iree_host_size_t new_capacity =
+        iree_max(4, semaphore->pending_capacity * 2);
+    status = iree_allocator_realloc(
+        host_allocator, new_capacity * sizeof(semaphore->pending_signals[0]),
+        (void**)&semaphore->pending_signals);
+    if (iree_status_is_ok(status)) {
+      semaphore->pending_capacity = new_capacity;
+    }
+  }
+
+  // Timing is not needed and disabling it makes the events cheaper to record
+  // and query.
+  hipEvent_t event = NULL;
+  if (iree_status_is_ok(status)) {
+    status = ROCM_RESULT_TO_STATUS(
+        semaphore->context->syms,
+        hipEventCreateWithFlags(&event, hipEventDisableTiming),
+        "hipEventCreateWithFlags");
+  }
+  if (iree_status_is_ok(status)) {
+    status = ROCM_RESULT_TO_STATUS(semaphore->context->syms,
+                                   hipEventRecord(event, stream),
+                                   "hipEventRecord");
+    if (!iree_status_is_ok(status)) {
+      ROCM_IGNORE_ERROR(semaphore->context->syms, hipEventDestroy(event));
+    }
+  }
+  if (iree_status_is_ok(status)) {
+    iree_hal_rocm_semaphore_pending_signal_t* pending_signal =
+        &semaphore->pending_signals[semaphore->pending_count++];
+    pending_signal->value = value;
+    pending_signal->event = event;
+  }
+  iree_slim_mutex_unlock(&semaphore->mutex);
+
+  // Wake host waiters so that they can switch to waiting on the event.
+  if (iree_status_is_ok(status)) {
+    iree_notification_post(&semaphore->notification, IREE_ALL_WAITERS);
+  }
+  return status;
+}
+
+iree_status_t iree_hal_rocm_semaphore_enqueue_wait(
+    iree_hal_semaphore_t* base_semaphore, uint64_t value, hipStream_t stream) {
+  iree_hal_rocm_semaphore_t* semaphore =
+      iree_hal_rocm_semaphore_cast(base_semaphore);
+
+  iree_slim_mutex_lock(&semaphore->mutex);
+  iree_hal_rocm_semaphore_refresh_unsafe(semaphore);
+  if (!iree_status_is_ok(semaphore->failure_status)) {
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    return iree_status_from_code(IREE_STATUS_ABORTED);
+  } else if (semaphore->current_value >= value) {
+    // Already reached; nothing to wait on.
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    return iree_ok_status();
+  }
+  hipEvent_t event =
+      iree_hal_rocm_semaphore_find_pending_event_unsafe(semaphore, value);
+  iree_status_t status = iree_ok_status();
+  if (event) {
+    // The mutex is held so the event cannot be retired while we use it.
+    status = ROCM_RESULT_TO_STATUS(semaphore->context->syms,
+                                   hipStreamWaitEvent(stream, event, 0),
+                                   "hipStreamWaitEvent");
+  }
+  iree_slim_mutex_unlock(&semaphore->mutex);
+  if (event) return status;
+
+  // The value will be reached by a host signal or by a submission that has not
+  // been made yet. Waiting here could block the thread that has to make it.
+  return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                          "no signal of the semaphore to value %" PRIu64
+                          " has been enqueued; the submission must be "
+                          "deferred until one has",
+                          value);
+}
+
+bool iree_hal_rocm_semaphore_list_can_enqueue_wait(
+    const iree_hal_semaphore_list_t semaphore_list) {
+  for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+    iree_hal_semaphore_t* base_semaphore = semaphore_list.semaphores[i];
+    const uint64_t value = semaphore_list.payload_values[i];
+    if (iree_hal_rocm_semaphore_isa(base_semaphore)) {
+      iree_hal_rocm_semaphore_t* semaphore =
+          iree_hal_rocm_semaphore_cast(base_semaphore);
+      iree_slim_mutex_lock(&semaphore->mutex);
+      bool changed = iree_hal_rocm_semaphore_refresh_unsafe(semaphore);
+      const uint64_t current_value = semaphore->current_value;
+      const iree_status_code_t status_code =
+          iree_status_code(semaphore->failure_status);
+      const bool can_wait =
+          current_value >= value || status_code != IREE_STATUS_OK ||
+          iree_hal_rocm_semaphore_find_pending_event_unsafe(semaphore,
+                                                            value) != NULL;
+      iree_slim_mutex_unlock(&semaphore->mutex);
+      if (changed) {
+        iree_hal_rocm_semaphore_notify(semaphore, current_value, status_code);
+      }
+      if (!can_wait) return false;
+    } else {
+      // Other semaphores can only be waited on from the host so the value must
+      // already have been reached. Failures resolve the wait.
+      uint64_t current_value = 0;
+      iree_status_t status =
+          iree_hal_semaphore_query(base_semaphore, &current_value);
+      if (iree_status_is_ok(status) && current_value < value) return false;
+      iree_status_ignore(status);
+    }
+  }
+  return true;
 }
 
 static const iree_hal_semaphore_vtable_t iree_hal_rocm_semaphore_vtable = {
@@ -0,0 +1,242 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "experimental/rocm/pending_queue.h"
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "experimental/rocm/event_semaphore.h"
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace rocm {
+namespace {
+
+// Pending submissions and hipEvent semaphores only signaled from the host
+// never touch the device so the tests run without a GPU. The only driver entry
+// point used is hipCtxSetCurrent on the worker thread.
+static hipError_t FakeCtxSetCurrent(hipCtx_t context) { return hipSuccess; }
+
+// Upper bound on how long a ready submission may take to be issued.
+static const iree_duration_t kIssueTimeoutNs = 5000000000ll;  // 5s
+
+// Submissions with this tag hold the worker in Issue until the gate semaphore
+// is signaled to 1.
+static const uintptr_t kGateQueue = 0;
+
+class PendingQueueTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    syms_.hipCtxSetCurrent = FakeCtxSetCurrent;
+    context_.rocm_context = NULL;
+    context_.host_allocator = iree_allocator_system();
+    context_.syms = &syms_;
+    IREE_ASSERT_OK(iree_hal_rocm_pending_queue_create(
+        &context_, {Issue, this}, iree_allocator_system(), &pending_queue_));
+  }
+
+  void TearDown() override {
+    // Releases a worker left blocked in a gate submission by a failed test.
+    if (gate_semaphore_) {
+      iree_status_ignore(iree_hal_semaphore_signal(gate_semaphore_, 1));
+    }
+    iree_hal_rocm_pending_queue_destroy(pending_queue_);
+    for (iree_hal_semaphore_t* semaphore : semaphores_) {
+      iree_hal_semaphore_release(semaphore);
+    }
+  }
+
+  iree_hal_semaphore_t* CreateSemaphore(uint64_t initial_value) {
+    iree_hal_semaphore_t* semaphore = NULL;
+    IREE_CHECK_OK(
+        iree_hal_rocm_semaphore_create(&context_, initial_value, &semaphore));
+    semaphores_.push_back(semaphore);
+    return semaphore;
+  }
+
+  // Enqueues a submission tagged |queue| that waits for |wait_semaphore| (if
+  // any) to reach |wait_value| and signals |signal_semaphore| to
+  // |signal_value| once issued. Issued submissions are identified by their
+  // signal semaphore so each submission must use a distinct one.
+  iree_status_t Enqueue(uintptr_t queue, iree_hal_semaphore_t* wait_semaphore,
+                        uint64_t wait_value,
+                        iree_hal_semaphore_t* signal_semaphore,
+                        uint64_t signal_value) {
+    iree_hal_semaphore_list_t wait_list = {
+        wait_semaphore ? 1u : 0u,
+        &wait_semaphore,
+        &wait_value,
+    };
+    iree_hal_semaphore_list_t signal_list = {
+        1,
+        &signal_semaphore,
+        &signal_value,
+    };
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      queues_[signal_semaphore] = queue;
+    }
+    return iree_hal_rocm_pending_queue_enqueue(
+        pending_queue_, wait_list, signal_list,
+        /*command_buffer_count=*/0, /*command_buffers=*/NULL);
+  }
+
+  std::vector<uintptr_t> IssuedQueues() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return issued_queues_;
+  }
+
+  // Records the submission and signals its semaphores from the host in place
+  // of work completing on a stream. Gate submissions then block the worker.
+  static iree_status_t Issue(
+      void* user_data, const iree_hal_semaphore_list_t wait_list,
+      const iree_hal_semaphore_list_t signal_list,
+      iree_host_size_t command_buffer_count,
+      iree_hal_command_buffer_t* const* command_buffers) {
+    auto* test = static_cast<PendingQueueTest*>(user_data);
+    uintptr_t queue = 0;
+    {
+      std::lock_guard<std::mutex> lock(test->mutex_);
+      queue = test->queues_[signal_list.semaphores[0]];
+      test->issued_queues_.push_back(queue);
+    }
+    if (test->issue_failure_) {
+      return iree_make_status(IREE_STATUS_DATA_LOSS, "injected issue failure");
+    }
+    IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_signal(signal_list));
+    if (queue == kGateQueue) {
+      return iree_hal_semaphore_wait(test->gate_semaphore_, 1,
+                                     iree_infinite_timeout());
+    }
+    return iree_ok_status();
+  }
+
+  iree_hal_rocm_dynamic_symbols_t syms_ = {};
+  iree_hal_rocm_context_wrapper_t context_;
+  iree_hal_rocm_pending_queue_t* pending_queue_ = NULL;
+  std::vector<iree_hal_semaphore_t*> semaphores_;
+  bool issue_failure_ = false;
+  iree_hal_semaphore_t* gate_semaphore_ = NULL;
+
+  std::mutex mutex_;
+  std::unordered_map<iree_hal_semaphore_t*, uintptr_t> queues_;
+  std::vector<uintptr_t> issued_queues_;
+};
+
+// A submission waiting on a value signaled from the host is issued only once
+// the host signals it.
+TEST_F(PendingQueueTest, WaitsOnHostSignal) {
+  iree_hal_semaphore_t* wait_semaphore = CreateSemaphore(0);
+  iree_hal_semaphore_t* signal_semaphore = CreateSemaphore(0);
+  IREE_ASSERT_OK(Enqueue(1, wait_semaphore, 1, signal_semaphore, 1));
+
+  // Long enough for the worker to have re-evaluated the submission a few times.
+  iree_status_t status =
+      iree_hal_semaphore_wait(signal_semaphore, 1, iree_make_timeout_ms(10));
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_DEADLINE_EXCEEDED, status);
+  iree_status_free(status);
+  EXPECT_TRUE(IssuedQueues().empty());
+
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(wait_semaphore, 1));
+  IREE_ASSERT_OK(iree_hal_semaphore_wait(
+      signal_semaphore, 1, iree_make_timeout_ns(kIssueTimeoutNs)));
+  EXPECT_EQ(IssuedQueues(), std::vector<uintptr_t>({1}));
+}
+
+// A submission whose waits are already satisfied is issued without a signal.
+TEST_F(PendingQueueTest, IssuesReadySubmission) {
+  iree_hal_semaphore_t* wait_semaphore = CreateSemaphore(1);
+  iree_hal_semaphore_t* signal_semaphore = CreateSemaphore(0);
+  IREE_ASSERT_OK(Enqueue(1, wait_semaphore, 1, signal_semaphore, 1));
+  IREE_ASSERT_OK(iree_hal_semaphore_wait(
+      signal_semaphore, 1, iree_make_timeout_ns(kIssueTimeoutNs)));
+  EXPECT_EQ(IssuedQueues(), std::vector<uintptr_t>({1}));
+}
+
+// Submissions that become ready together are issued in submission order and a
+// submission waiting on another pending submission is issued after it.
+TEST_F(PendingQueueTest, IssuesInSubmissionOrder) {
+  // Hold the worker until all submissions are pending and the host signal has
+  // been made so that they are all evaluated together.
+  gate_semaphore_ = CreateSemaphore(0);
+  iree_hal_semaphore_t* gate_entered_semaphore = CreateSemaphore(0);
+  IREE_ASSERT_OK(Enqueue(kGateQueue, NULL, 0, gate_entered_semaphore, 1));
+  IREE_ASSERT_OK(iree_hal_semaphore_wait(
+      gate_entered_semaphore, 1, iree_make_timeout_ns(kIssueTimeoutNs)));
+
+  iree_hal_semaphore_t* host_semaphore = CreateSemaphore(0);
+  iree_hal_semaphore_t* semaphore_1 = CreateSemaphore(0);
+  iree_hal_semaphore_t* semaphore_2 = CreateSemaphore(0);
+  iree_hal_semaphore_t* semaphore_3 = CreateSemaphore(0);
+  iree_hal_semaphore_t* semaphore_4 = CreateSemaphore(0);
+  IREE_ASSERT_OK(Enqueue(1, host_semaphore, 1, semaphore_1, 1));
+  IREE_ASSERT_OK(Enqueue(2, semaphore_3, 1, semaphore_2, 1));
+  IREE_ASSERT_OK(Enqueue(3, host_semaphore, 1, semaphore_3, 1));
+  IREE_ASSERT_OK(Enqueue(4, semaphore_2, 1, semaphore_4, 1));
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(host_semaphore, 1));
+
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(gate_semaphore_, 1));
+  IREE_ASSERT_OK(iree_hal_semaphore_wait(
+      semaphore_4, 1, iree_make_timeout_ns(kIssueTimeoutNs)));
+  EXPECT_EQ(IssuedQueues(), std::vector<uintptr_t>({kGateQueue, 1, 3, 2, 4}));
+}
+
+// Failing to issue a submission fails its signal semaphores.
+TEST_F(PendingQueueTest, IssueFailureFailsSignals) {
+  issue_failure_ = true;
+  iree_hal_semaphore_t* wait_semaphore = CreateSemaphore(0);
+  iree_hal_semaphore_t* signal_semaphore = CreateSemaphore(0);
+  IREE_ASSERT_OK(Enqueue(1, wait_semaphore, 1, signal_semaphore, 1));
+
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(wait_semaphore, 1));
+  iree_status_t status = iree_hal_semaphore_wait(
+      signal_semaphore, 1, iree_make_timeout_ns(kIssueTimeoutNs));
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_ABORTED, status);
+  iree_status_free(status);
+  uint64_t value = 0;
+  status = iree_hal_semaphore_query(signal_semaphore, &value);
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_DATA_LOSS, status);
+  iree_status_free(status);
+  EXPECT_EQ(IssuedQueues(), std::vector<uintptr_t>({1}));
+}
+
+// Destroying the queue fails the signals of submissions that never became
+// ready without issuing them.
+TEST_F(PendingQueueTest, DestroyFailsPendingSignals) {
+  iree_hal_semaphore_t* wait_semaphore = CreateSemaphore(0);
+  iree_hal_semaphore_t* signal_semaphore_1 = CreateSemaphore(0);
+  iree_hal_semaphore_t* signal_semaphore_2 = CreateSemaphore(0);
+  IREE_ASSERT_OK(Enqueue(1, wait_semaphore, 1, signal_semaphore_1, 1));
+  IREE_ASSERT_OK(Enqueue(2, wait_semaphore, 2, signal_semaphore_2, 1));
+
+  iree_hal_rocm_pending_queue_destroy(pending_queue_);
+  pending_queue_ = NULL;
+
+  uint64_t value = 0;
+  iree_status_t status = iree_hal_semaphore_query(signal_semaphore_1, &value);
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_CANCELLED, status);
+  iree_status_free(status);
+  status = iree_hal_semaphore_query(signal_semaphore_2, &value);
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_CANCELLED, status);
+  iree_status_free(status);
+  EXPECT_TRUE(IssuedQueues().empty());
+
+  // Signaling after destruction must not reach the freed queue through a
+  // leftover timepoint.
+  IREE_EXPECT_OK(iree_hal_semaphore_signal(wait_semaphore, 2));
+}
+
+}  // namespace
+}  // namespace rocm
+}  // namespace hal
+}  // namespace iree
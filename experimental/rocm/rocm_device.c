@@ -14,23 +14,43 @@
 #include "experimental/rocm/direct_command_buffer.h"
 #include "experimental/rocm/dynamic_symbols.h"
 #include "experimental/rocm/event_semaphore.h"
+#include "experimental/rocm/graph_command_buffer.h"
 #include "experimental/rocm/nop_executable_cache.h"
+#include "experimental/rocm/pending_queue.h"
 #include "experimental/rocm/pipeline_layout.h"
 #include "experimental/rocm/rocm_allocator.h"
 #include "experimental/rocm/rocm_event.h"
 #include "experimental/rocm/status_util.h"
 #include "iree/base/internal/arena.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/utils/buffer_transfer.h"
+#include "iree/hal/utils/deferred_command_buffer.h"
+#include "iree/hal/utils/resource_set.h"
+
+// Interval between polls of the semaphores in a wait-any operation.
+#define IREE_HAL_ROCM_DEVICE_WAIT_ANY_POLL_INTERVAL_NS (50 * 1000)
 
 //===----------------------------------------------------------------------===//
 // iree_hal_rocm_device_t
 //===----------------------------------------------------------------------===//
 
+// A submission made to the device stream that has not yet been observed as
+// completed. Retains all resources used by the submission until |event|
+// completes.
+typedef struct iree_hal_rocm_submission_t {
+  struct iree_hal_rocm_submission_t* next;
+  hipEvent_t event;
+  iree_hal_resource_set_t* resource_set;
+} iree_hal_rocm_submission_t;
+
 typedef struct iree_hal_rocm_device_t {
   iree_hal_resource_t resource;
   iree_string_view_t identifier;
 
+  // Parameters used to control device behavior.
+  iree_hal_rocm_device_params_t params;
+
   // Block pool used for command buffers with a larger block size (as command
   // buffers can contain inlined data uploads).
   iree_arena_block_pool_t block_pool;
@@ -46,6 +66,22 @@ typedef struct iree_hal_rocm_device_t {
   iree_hal_rocm_context_wrapper_t context_wrapper;
   iree_hal_allocator_t* device_allocator;
 
+  // Direct command buffer issuing to |stream| that deferred command buffers are
+  // replayed into on submission.
+  iree_hal_command_buffer_t* replay_command_buffer;
+
+  // Submissions deferred until their waits can be enqueued on |stream|.
+  iree_hal_rocm_pending_queue_t* pending_queue;
+
+  // Guards the in-flight submission list and submission to |stream|.
+  iree_slim_mutex_t submission_mutex;
+
+  // In-flight submissions in submission order. Completed submissions are
+  // retired from the head as new submissions are made.
+  iree_hal_rocm_submission_t* submission_head
+      IREE_GUARDED_BY(submission_mutex);
+  iree_hal_rocm_submission_t* submission_tail
+      IREE_GUARDED_BY(submission_mutex);
 } iree_hal_rocm_device_t;
 
 static const iree_hal_device_vtable_t iree_hal_rocm_device_vtable;
@@ -56,16 +92,110 @@ static iree_hal_rocm_device_t* iree_hal_rocm_device_cast(
   return (iree_hal_rocm_device_t*)base_value;
 }
 
+// Retires in-flight submissions that have completed and releases their
+// resources. If |wait_all| is set all submissions are retired and the caller
+// must have ensured that the stream is idle. The submission mutex must be held.
+static void iree_hal_rocm_device_retire_submissions(
+    iree_hal_rocm_device_t* device, bool wait_all) {
+  iree_allocator_t host_allocator = device->context_wrapper.host_allocator;
+  while (device->submission_head) {
+    iree_hal_rocm_submission_t* submission = device->submission_head;
+    if (!wait_all && device->context_wrapper.syms->hipEventQuery(
+                         submission->event) == hipErrorNotReady) {
+      break;  // submissions complete in order
+    }
+    device->submission_head = submission->next;
+    ROCM_IGNORE_ERROR(device->context_wrapper.syms,
+                      hipEventDestroy(submission->event));
+    iree_hal_resource_set_free(submission->resource_set);
+    iree_allocator_free(host_allocator, submission);
+  }
+  if (!device->submission_head) device->submission_tail = NULL;
+}
+
+// Retains |command_buffers| until all work currently submitted to the device
+// stream has completed. The submission mutex must be held.
+static iree_status_t iree_hal_rocm_device_track_submission(
+    iree_hal_rocm_device_t* device, iree_host_size_t command_buffer_count,
+    iree_hal_command_buffer_t* const* command_buffers) {
+  iree_allocator_t host_allocator = device->context_wrapper.host_allocator;
+  iree_hal_rocm_submission_t* submission = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      host_allocator, sizeof(*submission), (void**)&submission));
+  memset(submission, 0, sizeof(*submission));
+
+  iree_status_t status = iree_hal_resource_set_allocate(
+      &device->block_pool, &submission->resource_set);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_resource_set_insert(submission->resource_set,
+                                          command_buffer_count,
+                                          command_buffers);
+  }
+  if (iree_status_is_ok(status)) {
+    status = ROCM_RESULT_TO_STATUS(
+        device->context_wrapper.syms,
+        hipEventCreateWithFlags(&submission->event, hipEventDisableTiming),
+        "hipEventCreateWithFlags");
+  }
+  if (iree_status_is_ok(status)) {
+    status = ROCM_RESULT_TO_STATUS(
+        device->context_wrapper.syms,
+        hipEventRecord(submission->event, device->stream), "hipEventRecord");
+  }
+
+  if (iree_status_is_ok(status)) {
+    if (device->submission_tail) {
+      device->submission_tail->next = submission;
+    } else {
+      device->submission_head = submission;
+    }
+    device->submission_tail = submission;
+  } else {
+    if (submission->event) {
+      ROCM_IGNORE_ERROR(device->context_wrapper.syms,
+                        hipEventDestroy(submission->event));
+    }
+    if (submission->resource_set) {
+      iree_hal_resource_set_free(submission->resource_set);
+    }
+    iree_allocator_free(host_allocator, submission);
+  }
+  return status;
+}
+
+static iree_status_t iree_hal_rocm_device_issue_pending(
+    void* user_data, const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_host_size_t command_buffer_count,
+    iree_hal_command_buffer_t* const* command_buffers);
+
 static void iree_hal_rocm_device_destroy(iree_hal_device_t* base_device) {
   iree_hal_rocm_device_t* device = iree_hal_rocm_device_cast(base_device);
   iree_allocator_t host_allocator = iree_hal_device_host_allocator(base_device);
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  // Submissions still waiting on values that were never signaled are failed
+  // and never issued.
+  iree_hal_rocm_pending_queue_destroy(device->pending_queue);
+
+  // Wait for all in-flight work to complete so that the resources it uses can
+  // be released.
+  ROCM_IGNORE_ERROR(device->context_wrapper.syms,
+                    hipStreamSynchronize(device->stream));
+  iree_slim_mutex_lock(&device->submission_mutex);
+  iree_hal_rocm_device_retire_submissions(device, /*wait_all=*/true);
+  iree_slim_mutex_unlock(&device->submission_mutex);
+  iree_slim_mutex_deinitialize(&device->submission_mutex);
+
+  iree_hal_command_buffer_release(device->replay_command_buffer);
+
   // There should be no more buffers live that use the allocator.
   iree_hal_allocator_release(device->device_allocator);
   ROCM_IGNORE_ERROR(device->context_wrapper.syms,
                     hipStreamDestroy(device->stream));
 
+  iree_arena_block_pool_deinitialize(&device->block_pool);
+
   // Finally, destroy the device.
   iree_hal_driver_release(device->driver);
 
@@ -74,11 +204,27 @@ static void iree_hal_rocm_device_destroy(iree_hal_device_t* base_device) {
   IREE_TRACE_ZONE_END(z0);
 }
 
+void iree_hal_rocm_device_params_initialize(
+    iree_hal_rocm_device_params_t* out_params) {
+  memset(out_params, 0, sizeof(*out_params));
+  out_params->arena_block_size = 32 * 1024;
+  out_params->command_buffer_mode = IREE_HAL_ROCM_COMMAND_BUFFER_MODE_DIRECT;
+}
+
+static iree_status_t iree_hal_rocm_device_check_params(
+    const iree_hal_rocm_device_params_t* params) {
+  if (params->arena_block_size < 4096) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "arena block size too small (< 4096 bytes)");
+  }
+  return iree_ok_status();
+}
+
 static iree_status_t iree_hal_rocm_device_create_internal(
     iree_hal_driver_t* driver, iree_string_view_t identifier,
-    hipDevice_t rocm_device, hipStream_t stream, hipCtx_t context,
-    iree_hal_rocm_dynamic_symbols_t* syms, iree_allocator_t host_allocator,
-    iree_hal_device_t** out_device) {
+    const iree_hal_rocm_device_params_t* params, hipDevice_t rocm_device,
+    hipStream_t stream, hipCtx_t context, iree_hal_rocm_dynamic_symbols_t* syms,
+    iree_allocator_t host_allocator, iree_hal_device_t** out_device) {
   iree_hal_rocm_device_t* device = NULL;
   iree_host_size_t total_size = sizeof(*device) + identifier.size;
   IREE_RETURN_IF_ERROR(
@@ -90,14 +236,37 @@ static iree_status_t iree_hal_rocm_device_create_internal(
   uint8_t* buffer_ptr = (uint8_t*)device + sizeof(*device);
   buffer_ptr += iree_string_view_append_to_buffer(
       identifier, &device->identifier, (char*)buffer_ptr);
+  memcpy(&device->params, params, sizeof(device->params));
+  iree_arena_block_pool_initialize(params->arena_block_size, host_allocator,
+                                   &device->block_pool);
   device->device = rocm_device;
   device->stream = stream;
   device->context_wrapper.rocm_context = context;
   device->context_wrapper.host_allocator = host_allocator;
   device->context_wrapper.syms = syms;
+  iree_slim_mutex_initialize(&device->submission_mutex);
   iree_status_t status = iree_hal_rocm_allocator_create(
       (iree_hal_device_t*)device, &device->context_wrapper,
       &device->device_allocator);
+  if (iree_status_is_ok(status) &&
+      params->command_buffer_mode == IREE_HAL_ROCM_COMMAND_BUFFER_MODE_DIRECT) {
+    status = iree_hal_rocm_direct_command_buffer_create(
+        (iree_hal_device_t*)device, &device->context_wrapper,
+        IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION |
+            IREE_HAL_COMMAND_BUFFER_MODE_UNVALIDATED,
+        IREE_HAL_COMMAND_CATEGORY_ANY, IREE_HAL_QUEUE_AFFINITY_ANY,
+        /*binding_capacity=*/0, device->stream, &device->block_pool,
+        &device->replay_command_buffer);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_rocm_pending_queue_create(
+        &device->context_wrapper,
+        (iree_hal_rocm_pending_queue_issue_t){
+            .fn = iree_hal_rocm_device_issue_pending,
+            .user_data = device,
+        },
+        host_allocator, &device->pending_queue);
+  }
   if (iree_status_is_ok(status)) {
     *out_device = (iree_hal_device_t*)device;
   } else {
@@ -106,13 +275,15 @@ static iree_status_t iree_hal_rocm_device_create_internal(
   return status;
 }
 
-iree_status_t iree_hal_rocm_device_create(iree_hal_driver_t* driver,
-                                          iree_string_view_t identifier,
-                                          iree_hal_rocm_dynamic_symbols_t* syms,
-                                          hipDevice_t device,
-                                          iree_allocator_t host_allocator,
-                                          iree_hal_device_t** out_device) {
+iree_status_t iree_hal_rocm_device_create(
+    iree_hal_driver_t* driver, iree_string_view_t identifier,
+    const iree_hal_rocm_device_params_t* params,
+    iree_hal_rocm_dynamic_symbols_t* syms, hipDevice_t device,
+    iree_allocator_t host_allocator, iree_hal_device_t** out_device) {
+  IREE_ASSERT_ARGUMENT(params);
   IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(z0,
+                                    iree_hal_rocm_device_check_params(params));
   hipCtx_t context;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
       z0, ROCM_RESULT_TO_STATUS(syms, hipCtxCreate(&context, 0, device)));
@@ -121,9 +292,9 @@ iree_status_t iree_hal_rocm_device_create(iree_hal_driver_t* driver,
       syms, hipStreamCreateWithFlags(&stream, hipStreamNonBlocking));
 
   if (iree_status_is_ok(status)) {
-    status = iree_hal_rocm_device_create_internal(driver, identifier, device,
-                                                  stream, context, syms,
-                                                  host_allocator, out_device);
+    status = iree_hal_rocm_device_create_internal(
+        driver, identifier, params, device, stream, context, syms,
+        host_allocator, out_device);
   }
   if (!iree_status_is_ok(status)) {
     if (stream) {
@@ -201,10 +372,33 @@ static iree_status_t iree_hal_rocm_device_create_command_buffer(
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
     iree_hal_command_buffer_t** out_command_buffer) {
   iree_hal_rocm_device_t* device = iree_hal_rocm_device_cast(base_device);
-  return iree_hal_rocm_direct_command_buffer_create(
-      base_device, &device->context_wrapper, mode, command_categories,
-      queue_affinity, binding_capacity, &device->block_pool,
-      out_command_buffer);
+  switch (device->params.command_buffer_mode) {
+    case IREE_HAL_ROCM_COMMAND_BUFFER_MODE_GRAPH:
+      return iree_hal_rocm_graph_command_buffer_create(
+          base_device, &device->context_wrapper, mode, command_categories,
+          queue_affinity, binding_capacity, &device->block_pool,
+          out_command_buffer);
+    case IREE_HAL_ROCM_COMMAND_BUFFER_MODE_DIRECT:
+      if (iree_all_bits_set(
+              mode, IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION)) {
+        // The caller has indicated the command buffer can be executed as it is
+        // recorded and will not wait on anything when submitted so we can
+        // issue the commands directly to the device stream.
+        return iree_hal_rocm_direct_command_buffer_create(
+            base_device, &device->context_wrapper, mode, command_categories,
+            queue_affinity, binding_capacity, device->stream,
+            &device->block_pool, out_command_buffer);
+      }
+      // Otherwise the commands must not be issued until the submission waits
+      // have been enqueued and are replayed on submission.
+      return iree_hal_deferred_command_buffer_create(
+          base_device, mode, command_categories, binding_capacity,
+          &device->block_pool, iree_hal_device_host_allocator(base_device),
+          out_command_buffer);
+    default:
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "invalid command buffer mode");
+  }
 }
 
 static iree_status_t iree_hal_rocm_device_create_descriptor_set_layout(
@@ -255,7 +449,12 @@ static iree_status_t iree_hal_rocm_device_create_semaphore(
 static iree_hal_semaphore_compatibility_t
 iree_hal_rocm_device_query_semaphore_compatibility(
     iree_hal_device_t* base_device, iree_hal_semaphore_t* semaphore) {
-  // TODO: implement ROCM semaphores.
+  // TODO: device-side waits on semaphores from other ROCM devices are possible
+  // as the events are shareable within a process; for now all ROCM semaphores
+  // are assumed to be from the same context.
+  if (iree_hal_rocm_semaphore_isa(semaphore)) {
+    return IREE_HAL_SEMAPHORE_COMPATIBILITY_ALL;
+  }
   return IREE_HAL_SEMAPHORE_COMPATIBILITY_HOST_ONLY;
 }
 
@@ -267,13 +466,22 @@ static iree_status_t iree_hal_rocm_device_queue_alloca(
     iree_device_size_t allocation_size,
     iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
   // TODO: queue-ordered allocations.
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_wait(wait_semaphore_list,
-                                                    iree_infinite_timeout()));
+  // The buffer is allocated immediately and only the signals are ordered after
+  // the waits; allocating early is safe as nothing can use the buffer before
+  // the signal.
+  *out_buffer = NULL;
+  iree_hal_buffer_t* buffer = NULL;
   IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
       iree_hal_device_allocator(base_device), params, allocation_size,
-      iree_const_byte_span_empty(), out_buffer));
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_signal(signal_semaphore_list));
-  return iree_ok_status();
+      iree_const_byte_span_empty(), &buffer));
+  iree_status_t status = iree_hal_device_queue_barrier(
+      base_device, queue_affinity, wait_semaphore_list, signal_semaphore_list);
+  if (iree_status_is_ok(status)) {
+    *out_buffer = buffer;
+  } else {
+    iree_hal_buffer_release(buffer);
+  }
+  return status;
 }
 
 static iree_status_t iree_hal_rocm_device_queue_dealloca(
@@ -287,6 +495,121 @@ static iree_status_t iree_hal_rocm_device_queue_dealloca(
   return iree_ok_status();
 }
 
+// Issues |command_buffers| to the device stream in order.
+static iree_status_t iree_hal_rocm_device_issue_command_buffers(
+    iree_hal_rocm_device_t* device, iree_host_size_t command_buffer_count,
+    iree_hal_command_buffer_t* const* command_buffers) {
+  for (iree_host_size_t i = 0; i < command_buffer_count; i++) {
+    iree_hal_command_buffer_t* command_buffer = command_buffers[i];
+    if (iree_hal_rocm_direct_command_buffer_isa(command_buffer)) {
+      // Nothing to do for an inline command buffer; all the work has already
+      // been submitted. We do not have to worry about any waits: if there
+      // were waits we wouldn't have been able to execute inline!
+    } else if (iree_hal_rocm_graph_command_buffer_isa(command_buffer)) {
+      hipGraphExec_t exec =
+          iree_hal_rocm_graph_command_buffer_handle(command_buffer);
+      ROCM_RETURN_IF_ERROR(device->context_wrapper.syms,
+                           hipGraphLaunch(exec, device->stream),
+                           "hipGraphLaunch");
+    } else {
+      IREE_RETURN_IF_ERROR(iree_hal_deferred_command_buffer_apply(
+          command_buffer, device->replay_command_buffer,
+          iree_hal_buffer_binding_table_empty()));
+    }
+  }
+  return iree_ok_status();
+}
+
+// Issues a submission whose waits can all be enqueued on the device stream.
+static iree_status_t iree_hal_rocm_device_issue_execute(
+    iree_hal_rocm_device_t* device,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_host_size_t command_buffer_count,
+    iree_hal_command_buffer_t* const* command_buffers) {
+  // Waits on semaphores signaled by prior submissions are made on the stream
+  // and signals are recorded as events so that the host can continue
+  // preparing work while the device executes. Other semaphores must already
+  // have reached their values.
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0;
+       i < wait_semaphore_list.count && iree_status_is_ok(status); ++i) {
+    iree_hal_semaphore_t* semaphore = wait_semaphore_list.semaphores[i];
+    uint64_t value = wait_semaphore_list.payload_values[i];
+    if (iree_hal_rocm_semaphore_isa(semaphore)) {
+      status = iree_hal_rocm_semaphore_enqueue_wait(semaphore, value,
+                                                    device->stream);
+    } else {
+      status =
+          iree_hal_semaphore_wait(semaphore, value, iree_immediate_timeout());
+    }
+  }
+  IREE_RETURN_IF_ERROR(status);
+
+  iree_slim_mutex_lock(&device->submission_mutex);
+  iree_hal_rocm_device_retire_submissions(device, /*wait_all=*/false);
+
+  status = iree_hal_rocm_device_issue_command_buffers(
+      device, command_buffer_count, command_buffers);
+  if (iree_status_is_ok(status) && command_buffer_count > 0) {
+    status = iree_hal_rocm_device_track_submission(
+        device, command_buffer_count, command_buffers);
+  }
+
+  bool requires_host_signal = false;
+  for (iree_host_size_t i = 0;
+       i < signal_semaphore_list.count && iree_status_is_ok(status); ++i) {
+    iree_hal_semaphore_t* semaphore = signal_semaphore_list.semaphores[i];
+    if (iree_hal_rocm_semaphore_isa(semaphore)) {
+      status = iree_hal_rocm_semaphore_enqueue_signal(
+          semaphore, signal_semaphore_list.payload_values[i], device->stream);
+    } else {
+      requires_host_signal = true;
+    }
+  }
+  iree_slim_mutex_unlock(&device->submission_mutex);
+
+  // Pending submissions waiting on the signals can now wait on the device.
+  if (iree_status_is_ok(status) && signal_semaphore_list.count > 0) {
+    iree_hal_rocm_pending_queue_poke(device->pending_queue);
+  }
+
+  // Semaphores we cannot signal from the device are signaled from the host
+  // once the submission has completed.
+  if (iree_status_is_ok(status) && requires_host_signal) {
+    IREE_TRACE_ZONE_BEGIN_NAMED(z1, "hipStreamSynchronize");
+    status = ROCM_RESULT_TO_STATUS(device->context_wrapper.syms,
+                                   hipStreamSynchronize(device->stream),
+                                   "hipStreamSynchronize");
+    IREE_TRACE_ZONE_END(z1);
+    for (iree_host_size_t i = 0;
+         i < signal_semaphore_list.count && iree_status_is_ok(status); ++i) {
+      iree_hal_semaphore_t* semaphore = signal_semaphore_list.semaphores[i];
+      if (!iree_hal_rocm_semaphore_isa(semaphore)) {
+        status = iree_hal_semaphore_signal(
+            semaphore, signal_semaphore_list.payload_values[i]);
+      }
+    }
+  }
+
+  return status;
+}
+
+// Issues a submission deferred by the pending queue on its worker thread.
+static iree_status_t iree_hal_rocm_device_issue_pending(
+    void* user_data, const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_host_size_t command_buffer_count,
+    iree_hal_command_buffer_t* const* command_buffers) {
+  iree_hal_rocm_device_t* device = (iree_hal_rocm_device_t*)user_data;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status = iree_hal_rocm_device_issue_execute(
+      device, wait_semaphore_list, signal_semaphore_list,
+      command_buffer_count, command_buffers);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 static iree_status_t iree_hal_rocm_device_queue_execute(
     iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
     const iree_hal_semaphore_list_t wait_semaphore_list,
@@ -294,14 +617,25 @@ static iree_status_t iree_hal_rocm_device_queue_execute(
     iree_host_size_t command_buffer_count,
     iree_hal_command_buffer_t* const* command_buffers) {
   iree_hal_rocm_device_t* device = iree_hal_rocm_device_cast(base_device);
-  // TODO(raikonenfnu): Once semaphore is implemented wait for semaphores
-  // TODO(thomasraoux): implement semaphores - for now this conservatively
-  // synchronizes after every submit.
-  // TODO(raikonenfnu): currently run on default/null stream, when cmd buffer
-  // stream work with device->stream, we'll change
-  ROCM_RETURN_IF_ERROR(device->context_wrapper.syms, hipStreamSynchronize(0),
-                       "hipStreamSynchronize");
-  return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Submissions never block on the host. If a waited value has not been
+  // signaled and no submission that signals it has been made (such as a value
+  // the caller signals from the host after this returns) the submission is
+  // deferred to the pending queue and issued once it can wait on the device.
+  iree_status_t status = iree_ok_status();
+  if (iree_hal_rocm_semaphore_list_can_enqueue_wait(wait_semaphore_list)) {
+    status = iree_hal_rocm_device_issue_execute(
+        device, wait_semaphore_list, signal_semaphore_list,
+        command_buffer_count, command_buffers);
+  } else {
+    status = iree_hal_rocm_pending_queue_enqueue(
+        device->pending_queue, wait_semaphore_list, signal_semaphore_list,
+        command_buffer_count, command_buffers);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 static iree_status_t iree_hal_rocm_device_queue_flush(
@@ -313,8 +647,55 @@ static iree_status_t iree_hal_rocm_device_queue_flush(
 static iree_status_t iree_hal_rocm_device_wait_semaphores(
     iree_hal_device_t* base_device, iree_hal_wait_mode_t wait_mode,
     const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout) {
-  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                          "semaphore not implemented");
+  const iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
+  if (semaphore_list.count == 0) return iree_ok_status();
+
+  // Waiting for all is a wait on each in turn against the same deadline.
+  if (wait_mode == IREE_HAL_WAIT_MODE_ALL || semaphore_list.count == 1) {
+    for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+      IREE_RETURN_IF_ERROR(iree_hal_semaphore_wait(
+          semaphore_list.semaphores[i], semaphore_list.payload_values[i],
+          iree_make_deadline(deadline_ns)));
+    }
+    return iree_ok_status();
+  }
+
+  // Waiting for any polls the semaphores until one is reached as there is no
+  // HIP primitive for waiting on one of multiple events.
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status = iree_ok_status();
+  for (;;) {
+    bool any_signaled = false;
+    for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+      uint64_t current_value = 0;
+      status = iree_hal_semaphore_query(semaphore_list.semaphores[i],
+                                        &current_value);
+      if (!iree_status_is_ok(status)) break;
+      if (current_value >= semaphore_list.payload_values[i]) {
+        any_signaled = true;
+        break;
+      }
+    }
+    if (!iree_status_is_ok(status)) {
+      // Failed; return an error to tell callers to query for it.
+      iree_status_ignore(status);
+      status = iree_status_from_code(IREE_STATUS_ABORTED);
+      break;
+    } else if (any_signaled) {
+      break;
+    }
+    iree_time_t now_ns = iree_time_now();
+    if (now_ns >= deadline_ns) {
+      status = iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+      break;
+    }
+    iree_time_t poll_deadline_ns =
+        now_ns + IREE_HAL_ROCM_DEVICE_WAIT_ANY_POLL_INTERVAL_NS;
+    iree_wait_until(poll_deadline_ns < deadline_ns ? poll_deadline_ns
+                                                   : deadline_ns);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 static iree_status_t iree_hal_rocm_device_profiling_begin(
@@ -34,7 +34,9 @@
 #   sample_dynamic/serve_sample.sh
 #
 #   then open http://localhost:8000/benchmarks.html (for automated benchmarks)
-#   or open http://localhost:8000/ (for interactive benchmarks)
+#   or open http://localhost:8000/ (for interactive benchmarks). Benchmarks run
+#   multithreaded by default; open http://localhost:8000/benchmarks.html?sync
+#   to run the scalar and SIMD variants single-threaded and compare.
 
 set -eo pipefail
 
@@ -115,15 +117,15 @@ import_program "MobileNetV3SmallStaticBatch" "MobileNetV3SmallStaticBatch.tflite
 IREE_COMPILE_PATH=iree-compile
 
 # compile_program_wasm helper
-#   Args: program_name
-#   Compiles program_name.tflite.mlir to program_name_wasm.vmfb, dumping
-#   statistics and intermediate files to disk.
+#   Args: program_name, variant_name, extra compiler flags...
+#   Compiles program_name.tflite.mlir to program_name_variant_name.vmfb,
+#   dumping statistics and intermediate files to disk.
 function compile_program_wasm {
   INPUT_FILE=./"$1".tflite.mlir
-  OUTPUT_FILE=./"$1"_wasm.vmfb
+  OUTPUT_FILE=./"$1"_"$2".vmfb
   echo "Compiling '${INPUT_FILE}' to '${OUTPUT_FILE}'..."
 
-  ARTIFACTS_DIR=./"$1"-wasm_artifacts/
+  ARTIFACTS_DIR=./"$1"-"$2"_artifacts/
   mkdir -p "${ARTIFACTS_DIR}"
 
   # Compile from .mlir to .vmfb, dumping all the intermediate files and
@@ -136,6 +138,7 @@ function compile_program_wasm {
     --iree-hal-dump-executable-binaries-to="${ARTIFACTS_DIR}" \
     --iree-scheduling-dump-statistics-format=csv \
     --iree-scheduling-dump-statistics-file=${ARTIFACTS_DIR}/$1_statistics.csv \
+    "${@:3}" \
     --o ${OUTPUT_FILE}
 
   # Compress the .vmfb file (ideally it would be compressed already, but we can
@@ -179,8 +182,19 @@ function compile_program_native {
 # compile_program helper
 #   Args: program_name
 #   Wraps compile_program_wasm and compile_program_native.
+#   Compiles the WebAssembly variants benchmarked by
+#   sample_dynamic/benchmarks.html:
+#     * wasm: scalar codegen for the single-threaded runtime (baseline)
+#     * wasm_simd: SIMD128 codegen for the single-threaded runtime
+#     * wasm_simd_multithreaded: SIMD128 codegen importing shared memory for
+#       the multithreaded (Web Workers + SharedArrayBuffer) runtime
 function compile_program {
-  compile_program_wasm $1
+  compile_program_wasm $1 "wasm"
+  compile_program_wasm $1 "wasm_simd" \
+    --iree-llvm-target-cpu-features=+simd128
+  compile_program_wasm $1 "wasm_simd_multithreaded" \
+    --iree-llvm-target-cpu-features=+atomics,+bulk-memory,+simd128 \
+    --iree-llvm-wasm-shared-memory
   compile_program_native $1
 }
 
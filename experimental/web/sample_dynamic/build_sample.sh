@@ -66,6 +66,14 @@ compile_sample() {
     --iree-llvm-target-triple=wasm32-unknown-emscripten \
     --iree-llvm-target-cpu-features=+atomics,+bulk-memory,+simd128 \
     --o "${BINARY_DIR}/$1.vmfb"
+  # The multithreaded runtime needs programs that import its shared memory.
+  "${COMPILE_TOOL}" "$2" \
+    --iree-input-type=mhlo \
+    --iree-hal-target-backends=llvm-cpu \
+    --iree-llvm-target-triple=wasm32-unknown-emscripten \
+    --iree-llvm-target-cpu-features=+atomics,+bulk-memory,+simd128 \
+    --iree-llvm-wasm-shared-memory \
+    --o "${BINARY_DIR}/$1_multithreaded.vmfb"
 }
 
 echo "=== Compiling sample MLIR files to VM FlatBuffer outputs (.vmfb) ==="
@@ -91,12 +99,14 @@ emcmake "${CMAKE_BIN}" \
   -DIREE_BUILD_EXPERIMENTAL_WEB_SAMPLES=ON \
   -DIREE_HAL_DRIVER_DEFAULTS=OFF \
   -DIREE_HAL_DRIVER_LOCAL_SYNC=ON \
+  -DIREE_HAL_DRIVER_LOCAL_TASK=ON \
   -DIREE_BUILD_COMPILER=OFF \
   -DIREE_BUILD_TESTS=OFF \
   .
 
 "${CMAKE_BIN}" --build "${BUILD_DIR}" --target \
-  iree_experimental_web_sample_dynamic_sync
+  iree_experimental_web_sample_dynamic_sync \
+  iree_experimental_web_sample_dynamic_multithreaded
 
 echo "=== Copying static files (.html, .js) to the build directory ==="
 
@@ -10,6 +10,16 @@ let ireeWorker = null;
 let nextMessageId = 0;
 const pendingPromises = {};
 
+// Whether the multithreaded runtime (Web Workers + SharedArrayBuffer) is used.
+// SharedArrayBuffer requires the page to be cross-origin isolated. Pass the
+// ?sync URL query parameter to force the single-threaded runtime.
+const ireeMultithreaded = self.crossOriginIsolated &&
+    !new URLSearchParams(window.location.search).has('sync');
+
+// Suffix of programs compiled for the selected runtime. Programs loaded by the
+// multithreaded runtime must be compiled with --iree-llvm-wasm-shared-memory.
+const ireeProgramSuffix = ireeMultithreaded ? '_multithreaded.vmfb' : '.vmfb';
+
 // Communication protocol to and from the worker:
 // {
 //     'messageType': string
@@ -63,7 +73,9 @@ function ireeInitializeWorker() {
       'reject': reject,
     };
 
-    ireeWorker = new Worker('iree_worker.js', {name: 'IREE-main'});
+    const workerUrl =
+        'iree_worker.js' + (ireeMultithreaded ? '?multithreaded' : '');
+    ireeWorker = new Worker(workerUrl, {name: 'IREE-main'});
     ireeWorker.onmessage = _handleMessageFromWorker;
   });
 }
@@ -4,9 +4,11 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
-// TODO(scotttodd): configure this through the build system / scripts?
-// const MAIN_SCRIPT_URL = 'web-sample-dynamic-multithreaded.js';
-const MAIN_SCRIPT_URL = 'web-sample-dynamic-sync.js';
+// The runtime variant is selected by iree_api.js via the worker URL.
+const MAIN_SCRIPT_URL =
+    new URL(self.location.href).searchParams.has('multithreaded') ?
+    'web-sample-dynamic-multithreaded.js' :
+    'web-sample-dynamic-sync.js';
 
 let wasmSetupSampleFn;
 let wasmCleanupSampleFn;
@@ -169,8 +169,10 @@ createTileAndDecomposeWinogradTransformPass();
 
 // Creates a pass to convert linalg convolution ops into a sequence of
 // linalg_ext.winograd.* ops and linalg.batch_matmul ops using the winograd
-// tranformation.
-std::unique_ptr<Pass> createConvertConv2DToWinogradPass();
+// tranformation. Each transform computes output tiles of size
+// |outputTileSize| x |outputTileSize|, which must be 4 or 6.
+std::unique_ptr<Pass>
+createConvertConv2DToWinogradPass(int64_t outputTileSize = 6);
 
 // Creates a pass to convert the softmax op into a sequence of
 // linalg generic ops.
@@ -523,7 +523,9 @@ LogicalResult SortOp::generateScalarImplementation(OpBuilder &b, Location loc,
   auto sortDim = getDimension();
   SmallVector<Value> indices, sortBlkArgs;
   indices.append(ivs.begin(), ivs.end());
-  // Bubble sort innermost loop.
+  // Bubble sort innermost loop. Each pass over the sort dimension bubbles the
+  // last element of the unsorted prefix into place so pass `i` only needs to
+  // visit the first `size - 1 - i` pairs.
   Value zero = b.create<arith::ConstantIndexOp>(loc, 0);
   Value one = b.create<arith::ConstantIndexOp>(loc, 1);
   Value ub;
@@ -534,6 +536,7 @@ LogicalResult SortOp::generateScalarImplementation(OpBuilder &b, Location loc,
         loc, getOperandType(0).getDimSize(sortDim));
   }
   ub = b.create<arith::SubIOp>(loc, ub, one);
+  ub = b.create<arith::SubIOp>(loc, ub, ivs[sortDim]);
   auto scfFor = b.create<scf::ForOp>(
       loc, zero, ub, one, ValueRange{},
       [&](OpBuilder &b, Location loc, Value iv, ValueRange iters) {
@@ -1328,6 +1331,48 @@ SmallVector<utils::IteratorType> TopkOp::getLoopIteratorTypes() {
   return iteratorTypes;
 }
 
+/// Clones the comparator |srcBlock| of a topk op as a black box comparison
+/// function f(x,y) to compare the value N (|lhsValue|, |lhsIndex|) to the
+/// value K (|rhsValue|, |rhsIndex|). Returns f(N,K) and whether N precedes K,
+/// which is f(N,K) or, if N and K are equal under the strict weak ordering,
+/// whether N came first.
+static std::pair<Value, Value>
+buildTopkComparison(OpBuilder &b, Location loc, Block &srcBlock,
+                    Value lhsValue, Value lhsIndex, Value rhsValue,
+                    Value rhsIndex) {
+  IRMapping bvmF; // f(x,y)
+  IRMapping bvmR; // f(y,x)
+  SmallVector<Value> forwardValues{lhsValue, rhsValue};
+  SmallVector<Value> reverseValues{rhsValue, lhsValue};
+  for (auto it : llvm::zip(srcBlock.getArguments(), forwardValues)) {
+    bvmF.map(std::get<0>(it), std::get<1>(it));
+  }
+  for (auto it : llvm::zip(srcBlock.getArguments(), reverseValues)) {
+    bvmR.map(std::get<0>(it), std::get<1>(it));
+  }
+  for (auto &blockOp : srcBlock.without_terminator()) {
+    b.clone(blockOp, bvmF);
+    b.clone(blockOp, bvmR);
+  }
+  Value forwardCmpRes = bvmF.lookup(srcBlock.getTerminator()->getOperand(0));
+  Value reverseCmpRes = bvmR.lookup(srcBlock.getTerminator()->getOperand(0));
+
+  // Check value equality using strictly weak ordering from the region:
+  //   f(x,y) --> forwardCmpRes
+  //   f(y,x) --> reverseCmpRes
+  //   if forwardCmpRes == reverseCmpRes then select which came first
+  Value cmpValuesEqual = b.create<arith::CmpIOp>(
+      loc, arith::CmpIPredicate::eq, forwardCmpRes, reverseCmpRes);
+  Value cmpFirstIndex = b.create<arith::CmpIOp>(
+      loc, arith::CmpIPredicate::slt, lhsIndex, rhsIndex);
+  Value combinedCmpEqRes =
+      b.create<arith::AndIOp>(loc, cmpValuesEqual, cmpFirstIndex);
+  // True if N > K or N came before K
+  Value indexCmpRes =
+      b.create<arith::OrIOp>(loc, forwardCmpRes, combinedCmpEqRes);
+  return {forwardCmpRes, indexCmpRes};
+}
+
 LogicalResult TopkOp::generateScalarImplementation(OpBuilder &b, Location loc,
                                                    ValueRange ivs) {
   uint64_t kDim = getDimension();
@@ -1349,6 +1394,31 @@ LogicalResult TopkOp::generateScalarImplementation(OpBuilder &b, Location loc,
   // Compute K (ub) from the selected dim of the output
   Value ub = b.create<memref::DimOp>(loc, outputValues(), getDimension());
 
+  // The outputs are kept ordered by the comparator so a value that does not
+  // precede the last of the current K values can't be part of the result.
+  // Checking it first lets most values of inputs much larger than K skip the
+  // scan over all K outputs. This is only done for a static non-zero K as the
+  // last output must exist.
+  auto &srcBlock = getRegion().front();
+  int64_t staticK =
+      outputValues().getType().cast<ShapedType>().getDimSize(kDim);
+  std::optional<scf::IfOp> insertIfOp;
+  if (!ShapedType::isDynamic(staticK) && staticK > 0) {
+    SmallVector<Value> lastIndices(ivs);
+    lastIndices[kDim] = b.create<arith::ConstantIndexOp>(loc, staticK - 1);
+    Value lastValue =
+        b.create<memref::LoadOp>(loc, outputValues(), lastIndices);
+    Value lastIndex =
+        b.create<memref::LoadOp>(loc, outputIndices(), lastIndices);
+    Value insertCond =
+        buildTopkComparison(b, loc, srcBlock, initialValue, initialIndex,
+                            lastValue, lastIndex)
+            .second;
+    insertIfOp = b.create<scf::IfOp>(loc, insertCond, /*withElseRegion=*/false);
+  }
+  OpBuilder::InsertionGuard ifGuard(b);
+  if (insertIfOp) b.setInsertionPoint(insertIfOp->thenYield());
+
   // Inner K loop functions:
   //   Load current K value and index
   //   Compare N/K using inserted block compare
@@ -1371,42 +1441,13 @@ LogicalResult TopkOp::generateScalarImplementation(OpBuilder &b, Location loc,
   indices[kDim] = scfFor.getInductionVar();
   auto loopCarryValues = scfFor.getRegionIterArgs();
 
-  // Retrieve region as black box comparision function f(x,y). Plug into op.
-  auto &srcBlock = getRegion().front();
-  IRMapping bvmF; // f(x,y)
-  IRMapping bvmR; // f(y,x)
   {
     // Save previous insertion point. Continue within loop body.
     OpBuilder::InsertionGuard guard(b);
     b.setInsertionPointToEnd(&scfFor.getRegion().front());
-    SmallVector<Value> forwardValues{loopCarryValues[0], kValue};
-    SmallVector<Value> reverseValues{kValue, loopCarryValues[0]};
-    for (auto it : llvm::zip(srcBlock.getArguments(), forwardValues)) {
-      bvmF.map(std::get<0>(it), std::get<1>(it));
-    }
-    for (auto it : llvm::zip(srcBlock.getArguments(), reverseValues)) {
-      bvmR.map(std::get<0>(it), std::get<1>(it));
-    }
-    for (auto &blockOp : srcBlock.without_terminator()) {
-      b.clone(blockOp, bvmF);
-      b.clone(blockOp, bvmR);
-    }
-    Value forwardCmpRes = bvmF.lookup(srcBlock.getTerminator()->getOperand(0));
-    Value reverseCmpRes = bvmR.lookup(srcBlock.getTerminator()->getOperand(0));
-
-    // Check value equality using strictly weak ordering from the region:
-    //   f(x,y) --> forwardCmpRes
-    //   f(y,x) --> reverseCmpRes
-    //   if forwardCmpRes == reverseCmpRes then select which came first
-    Value cmpValuesEqual = b.create<arith::CmpIOp>(
-        loc, arith::CmpIPredicate::eq, forwardCmpRes, reverseCmpRes);
-    Value cmpFirstIndex = b.create<arith::CmpIOp>(
-        loc, arith::CmpIPredicate::slt, loopCarryValues[1], kIndex);
-    Value combinedCmpEqRes =
-        b.create<arith::AndIOp>(loc, cmpValuesEqual, cmpFirstIndex);
-    // True if N > K or N came before K
-    Value indexCmpRes =
-        b.create<arith::OrIOp>(loc, forwardCmpRes, combinedCmpEqRes);
+    auto [forwardCmpRes, indexCmpRes] =
+        buildTopkComparison(b, loc, srcBlock, loopCarryValues[0],
+                            loopCarryValues[1], kValue, kIndex);
     // Select results for K based on comparisons
     Value resultKValue = b.create<arith::SelectOp>(loc, forwardCmpRes,
                                                    loopCarryValues[0], kValue);
@@ -1487,6 +1528,232 @@ TopkOp::reifyResultShapes(OpBuilder &b,
       .reifyResultShapes(b, reifiedReturnShapes);
 }
 
+//===----------------------------------------------------------------------===//
+// SampleOp
+//===----------------------------------------------------------------------===//
+
+LogicalResult SampleOp::verify() {
+  Operation *op = getOperation();
+  if (getNumInputs() != 3) {
+    return op->emitOpError("expected three input operands");
+  }
+  if (getNumOutputs() != 1) {
+    return op->emitOpError("expected one output operand");
+  }
+  auto valuesType = getValuesType();
+  auto indicesType = indices().getType().cast<ShapedType>();
+  auto countersType = counters().getType().cast<ShapedType>();
+  auto outputType = output().getType().cast<ShapedType>();
+  if (valuesType.getRank() != 2 || indicesType.getRank() != 2) {
+    return op->emitOpError("expected values/indices to be of rank 2");
+  }
+  if (countersType.getRank() != 1 || outputType.getRank() != 1) {
+    return op->emitOpError("expected counters/output to be of rank 1");
+  }
+  if (!valuesType.getElementType().isa<FloatType>()) {
+    return op->emitOpError("expected values to be of float type");
+  }
+  if (!indicesType.getElementType().isInteger(32) ||
+      !outputType.getElementType().isInteger(32)) {
+    return op->emitOpError("expected indices/output types to be int32");
+  }
+  if (!countersType.getElementType().isInteger(64)) {
+    return op->emitOpError("expected counters type to be int64");
+  }
+  if (failed(verifyCompatibleShape(valuesType, indicesType))) {
+    return op->emitOpError("values/indices shape must match");
+  }
+  if (failed(verifyCompatibleShape(valuesType.getShape()[0],
+                                   countersType.getShape()[0])) ||
+      failed(verifyCompatibleShape(valuesType.getShape()[0],
+                                   outputType.getShape()[0]))) {
+    return op->emitOpError("incompatible batch dimension");
+  }
+  if (!(getTemperature().convertToFloat() > 0.0f)) {
+    return op->emitOpError("expected temperature to be positive");
+  }
+  float topP = getTopP().convertToFloat();
+  if (!(topP > 0.0f && topP <= 1.0f)) {
+    return op->emitOpError("expected top_p to be in (0, 1]");
+  }
+  return success();
+}
+
+SmallVector<Range> SampleOp::getIterationDomain(OpBuilder &builder) {
+  Location loc = getLoc();
+  Value zero = builder.create<arith::ConstantIndexOp>(loc, 0);
+  Value one = builder.create<arith::ConstantIndexOp>(loc, 1);
+  Value size = getDimValue(builder, loc, output(), 0);
+  return {Range{zero, size, one}};
+}
+
+SmallVector<utils::IteratorType> SampleOp::getLoopIteratorTypes() {
+  return {utils::IteratorType::parallel};
+}
+
+/// Returns a float in [0, 1) derived from the i64 `counter` using the
+/// splitmix64 finalizer (see iree_prng_splitmix64_next).
+static Value buildUniformFromCounter(OpBuilder &b, Location loc,
+                                     Value counter) {
+  auto constant = [&](uint64_t value) -> Value {
+    return b.create<arith::ConstantIntOp>(loc, static_cast<int64_t>(value),
+                                          64);
+  };
+  auto xorShift = [&](Value z, uint64_t shift) -> Value {
+    Value shifted = b.create<arith::ShRUIOp>(loc, z, constant(shift));
+    return b.create<arith::XOrIOp>(loc, z, shifted);
+  };
+  Value z = b.create<arith::AddIOp>(loc, counter, constant(0x9E3779B97F4A7C15));
+  z = b.create<arith::MulIOp>(loc, xorShift(z, 30),
+                              constant(0xBF58476D1CE4E5B9));
+  z = b.create<arith::MulIOp>(loc, xorShift(z, 27),
+                              constant(0x94D049BB133111EB));
+  z = xorShift(z, 31);
+  // Keep the top 24 bits so the value is exactly representable in f32.
+  Value bits = b.create<arith::ShRUIOp>(loc, z, constant(40));
+  bits = b.create<arith::TruncIOp>(loc, b.getI32Type(), bits);
+  Value uniform = b.create<arith::UIToFPOp>(loc, b.getF32Type(), bits);
+  Value scale = b.create<arith::ConstantOp>(loc, b.getF32FloatAttr(0x1p-24f));
+  return b.create<arith::MulFOp>(loc, uniform, scale);
+}
+
+LogicalResult SampleOp::generateScalarImplementation(OpBuilder &b,
+                                                     Location loc,
+                                                     ValueRange ivs) {
+  Value row = ivs[0];
+  Value zero = b.create<arith::ConstantIndexOp>(loc, 0);
+  Value one = b.create<arith::ConstantIndexOp>(loc, 1);
+  Value ub = b.create<memref::DimOp>(loc, values(), 1);
+  Type f32Type = b.getF32Type();
+  Value zeroF = b.create<arith::ConstantOp>(loc, b.getF32FloatAttr(0.0f));
+
+  // All arithmetic is done in f32 regardless of the value type.
+  auto loadValue = [&](OpBuilder &b, Location loc, Value iv) -> Value {
+    Value value = b.create<memref::LoadOp>(loc, values(), ValueRange{row, iv});
+    unsigned width = value.getType().getIntOrFloatBitWidth();
+    if (width < 32) return b.create<arith::ExtFOp>(loc, f32Type, value);
+    if (width > 32) return b.create<arith::TruncFOp>(loc, f32Type, value);
+    return value;
+  };
+
+  // The values are sorted in decreasing order so the first one is the max and
+  // exp((x - max) / temperature) is the unnormalized probability of x.
+  Value maxValue = loadValue(b, loc, zero);
+  Value invTemperature = b.create<arith::ConstantOp>(
+      loc, b.getF32FloatAttr(1.0f / getTemperature().convertToFloat()));
+  auto loadProb = [&](OpBuilder &b, Location loc, Value iv) -> Value {
+    Value diff = b.create<arith::SubFOp>(loc, loadValue(b, loc, iv), maxValue);
+    Value scaled = b.create<arith::MulFOp>(loc, diff, invTemperature);
+    return b.create<math::ExpOp>(loc, scaled);
+  };
+
+  // Total probability mass of the K values.
+  auto totalLoop = b.create<scf::ForOp>(
+      loc, zero, ub, one, ValueRange{zeroF},
+      [&](OpBuilder &b, Location loc, Value iv, ValueRange args) {
+        Value sum = b.create<arith::AddFOp>(loc, args[0], loadProb(b, loc, iv));
+        b.create<scf::YieldOp>(loc, sum);
+      });
+  Value topP = b.create<arith::ConstantOp>(
+      loc, b.getF32FloatAttr(getTopP().convertToFloat()));
+  Value threshold =
+      b.create<arith::MulFOp>(loc, totalLoop.getResult(0), topP);
+
+  // Mass of the kept prefix: a value is kept while the mass before it is
+  // below the top-p threshold.
+  auto keptLoop = b.create<scf::ForOp>(
+      loc, zero, ub, one, ValueRange{zeroF, zeroF},
+      [&](OpBuilder &b, Location loc, Value iv, ValueRange args) {
+        Value prob = loadProb(b, loc, iv);
+        Value isKept = b.create<arith::CmpFOp>(loc, arith::CmpFPredicate::OLT,
+                                               args[0], threshold);
+        Value keptSum = b.create<arith::AddFOp>(loc, args[1], prob);
+        Value kept = b.create<arith::SelectOp>(loc, isKept, keptSum, args[1]);
+        Value cum = b.create<arith::AddFOp>(loc, args[0], prob);
+        b.create<scf::YieldOp>(loc, ValueRange{cum, kept});
+      });
+
+  Value counter = b.create<memref::LoadOp>(loc, counters(), row);
+  Value uniform = buildUniformFromCounter(b, loc, counter);
+  Value target = b.create<arith::MulFOp>(loc, uniform, keptLoop.getResult(1));
+
+  // Select the first kept value whose cumulative mass exceeds the target. If
+  // rounding keeps the target out of reach the last kept value is selected.
+  Value initialIndex =
+      b.create<memref::LoadOp>(loc, indices(), ValueRange{row, zero});
+  Value falseVal = b.create<arith::ConstantIntOp>(loc, 0, 1);
+  auto selectLoop = b.create<scf::ForOp>(
+      loc, zero, ub, one, ValueRange{zeroF, initialIndex, falseVal},
+      [&](OpBuilder &b, Location loc, Value iv, ValueRange args) {
+        Value prob = loadProb(b, loc, iv);
+        Value cum = b.create<arith::AddFOp>(loc, args[0], prob);
+        Value isKept = b.create<arith::CmpFOp>(loc, arith::CmpFPredicate::OLT,
+                                               args[0], threshold);
+        Value trueVal = b.create<arith::ConstantIntOp>(loc, 1, 1);
+        Value notFound = b.create<arith::XOrIOp>(loc, args[2], trueVal);
+        Value take = b.create<arith::AndIOp>(loc, notFound, isKept);
+        Value index =
+            b.create<memref::LoadOp>(loc, indices(), ValueRange{row, iv});
+        Value selected = b.create<arith::SelectOp>(loc, take, index, args[1]);
+        Value crossed = b.create<arith::CmpFOp>(
+            loc, arith::CmpFPredicate::OGT, cum, target);
+        Value found = b.create<arith::OrIOp>(loc, args[2], crossed);
+        b.create<scf::YieldOp>(loc, ValueRange{cum, selected, found});
+      });
+  b.create<memref::StoreOp>(loc, selectLoop.getResult(1), output(), row);
+  return success();
+}
+
+SmallVector<Operation *>
+SampleOp::getTiledImplementation(OpBuilder &builder,
+                                 ArrayRef<OpFoldResult> offsets,
+                                 ArrayRef<OpFoldResult> sizes) {
+  assert(offsets.size() == 1 && sizes.size() == 1);
+  Location loc = getLoc();
+  OpFoldResult zero = builder.getIndexAttr(0);
+  OpFoldResult one = builder.getIndexAttr(1);
+  OpFoldResult kSize =
+      getAsOpFoldResult(getDimValue(builder, loc, values(), 1));
+  SmallVector<OpFoldResult> rowOffsets = {offsets[0], zero};
+  SmallVector<OpFoldResult> rowSizes = {sizes[0], kSize};
+  SmallVector<OpFoldResult> rowStrides = {one, one};
+  SmallVector<OpFoldResult> strides = {one};
+
+  SmallVector<Value> tiledOperands;
+  tiledOperands.emplace_back(
+      getSlice(builder, loc, values(), rowOffsets, rowSizes, rowStrides));
+  tiledOperands.emplace_back(
+      getSlice(builder, loc, indices(), rowOffsets, rowSizes, rowStrides));
+  tiledOperands.emplace_back(
+      getSlice(builder, loc, counters(), offsets, sizes, strides));
+  tiledOperands.emplace_back(
+      getSlice(builder, loc, output(), offsets, sizes, strides));
+  SmallVector<Type, 1> resultTypes;
+  if (hasTensorSemantics()) {
+    resultTypes.push_back(tiledOperands.back().getType());
+  }
+
+  Operation *tiledSampleOp =
+      mlir::clone(builder, getOperation(), resultTypes, tiledOperands);
+  return {tiledSampleOp};
+}
+
+LogicalResult SampleOp::getResultTilePosition(
+    OpBuilder &builder, unsigned resultNumber, ArrayRef<OpFoldResult> offsets,
+    ArrayRef<OpFoldResult> sizes, SmallVector<OpFoldResult> &resultOffsets,
+    SmallVector<OpFoldResult> &resultSizes) {
+  resultOffsets.assign(offsets.begin(), offsets.end());
+  resultSizes.assign(sizes.begin(), sizes.end());
+  return success();
+}
+
+LogicalResult
+SampleOp::reifyResultShapes(OpBuilder &b,
+                            ReifiedRankedShapedTypeDims &reifiedReturnShapes) {
+  return cast<LinalgExtOp>(getOperation())
+      .reifyResultShapes(b, reifiedReturnShapes);
+}
+
 //===----------------------------------------------------------------------===//
 // PackOp and UnPackOp utils
 //===----------------------------------------------------------------------===//
@@ -2968,6 +3235,7 @@ DEFINE_OP_GET_EFFECTS(FftOp)
 DEFINE_OP_GET_EFFECTS(ReverseOp)
 DEFINE_OP_GET_EFFECTS(ScanOp)
 DEFINE_OP_GET_EFFECTS(TopkOp)
+DEFINE_OP_GET_EFFECTS(SampleOp)
 DEFINE_OP_GET_EFFECTS(PackOp)
 DEFINE_OP_GET_EFFECTS(UnPackOp)
 DEFINE_OP_GET_EFFECTS(WinogradInputTransformOp)
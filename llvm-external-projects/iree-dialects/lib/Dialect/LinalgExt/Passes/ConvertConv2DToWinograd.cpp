@@ -43,9 +43,18 @@ static bool hasAllOneValues(DenseIntElementsAttr attr) {
   return llvm::all_of(attr, [](APInt element) { return element.isOne(); });
 }
 
-// TODO: Make this a user-settable parameter once we have support
-// for more tile sizes
-static constexpr int64_t outputTileSize = 6;
+/// Returns the G matrix of the filter transform for 3x3 kernels computing
+/// output tiles of size r x r, or nullptr if there is no transform for r.
+static const float *getFilterTransformMatrix(int64_t outputTileSize) {
+  switch (outputTileSize) {
+  case 4:
+    return IREE::LinalgExt::Winograd::G_4x4_3x3;
+  case 6:
+    return IREE::LinalgExt::Winograd::G_6x6_3x3;
+  default:
+    return nullptr;
+  }
+}
 
 /// This function computes the Winograd filter transform when
 /// the filter is known to be a constant. Specifically, this
@@ -133,7 +142,8 @@ namespace {
 template <typename ConvOp>
 class FoldWinogradFilterTransform final : public OpRewritePattern<ConvOp> {
 public:
-  using OpRewritePattern<ConvOp>::OpRewritePattern;
+  FoldWinogradFilterTransform(MLIRContext *context, int64_t outputTileSize)
+      : OpRewritePattern<ConvOp>(context), outputTileSize(outputTileSize) {}
 
   LogicalResult matchAndRewrite(ConvOp convOp,
                                 PatternRewriter &rewriter) const override {
@@ -182,11 +192,14 @@ public:
     auto resultType = RankedTensorType::get(resultShape, elemType);
     auto foldedKernelAttr =
         foldFilterTransform(shape, inputTileSize, kernelSize, resultType,
-                            IREE::LinalgExt::Winograd::G_6x6_3x3, isSplat,
+                            getFilterTransformMatrix(outputTileSize), isSplat,
                             splatValue, nonSplatValues, elemType, isNchw);
     rewriter.replaceOpWithNewOp<arith::ConstantOp>(constOp, foldedKernelAttr);
     return success();
   }
+
+private:
+  int64_t outputTileSize;
 };
 
 } // namespace
@@ -282,7 +295,8 @@ namespace {
 template <typename ConvOp>
 class ConvertConvToWinograd final : public OpRewritePattern<ConvOp> {
 public:
-  using OpRewritePattern<ConvOp>::OpRewritePattern;
+  ConvertConvToWinograd(MLIRContext *context, int64_t outputTileSize)
+      : OpRewritePattern<ConvOp>(context), outputTileSize(outputTileSize) {}
 
   LogicalResult matchAndRewrite(ConvOp convOp,
                                 PatternRewriter &rewriter) const override {
@@ -303,6 +317,8 @@ public:
 
     const int64_t kernelSize = 3;
     const int64_t inputTileSize = outputTileSize + kernelSize - 1;
+    if (kernelShape[0] != inputTileSize * inputTileSize)
+      return failure();
 
     // Create winograd input transform op
     Location loc = convOp.getLoc();
@@ -416,21 +432,35 @@ public:
     result.replaceAllUsesWith(winogradOutput);
     return success();
   }
+
+private:
+  int64_t outputTileSize;
 };
 
 struct ConvertConv2DToWinogradPass
     : ConvertConv2DToWinogradBase<ConvertConv2DToWinogradPass> {
+  ConvertConv2DToWinogradPass(int64_t outputTileSize) {
+    this->outputTileSize = outputTileSize;
+  }
+  ConvertConv2DToWinogradPass(const ConvertConv2DToWinogradPass &pass)
+      : ConvertConv2DToWinogradPass(pass.outputTileSize) {}
   void getDependentDialects(DialectRegistry &registry) const override {
     registry
         .insert<linalg::LinalgDialect, IREE::LinalgExt::IREELinalgExtDialect>();
   }
   void runOnOperation() override {
     MLIRContext *context = &getContext();
+    if (!getFilterTransformMatrix(outputTileSize)) {
+      getOperation()->emitError()
+          << "unsupported winograd output tile size " << outputTileSize;
+      return signalPassFailure();
+    }
     RewritePatternSet patterns(&getContext());
     patterns.insert<FoldWinogradFilterTransform<linalg::Conv2DNchwFchwOp>,
                     FoldWinogradFilterTransform<linalg::Conv2DNhwcHwcfOp>,
                     ConvertConvToWinograd<linalg::Conv2DNhwcHwcfOp>,
-                    ConvertConvToWinograd<linalg::Conv2DNchwFchwOp>>(context);
+                    ConvertConvToWinograd<linalg::Conv2DNchwFchwOp>>(
+        context, outputTileSize);
     if (failed(applyPatternsAndFoldGreedily(getOperation(),
                                             std::move(patterns)))) {
       return signalPassFailure();
@@ -440,8 +470,9 @@ struct ConvertConv2DToWinogradPass
 
 } // namespace
 
-std::unique_ptr<Pass> createConvertConv2DToWinogradPass() {
-  return std::make_unique<ConvertConv2DToWinogradPass>();
+std::unique_ptr<Pass>
+createConvertConv2DToWinogradPass(int64_t outputTileSize) {
+  return std::make_unique<ConvertConv2DToWinogradPass>(outputTileSize);
 }
 
 } // namespace LinalgExt
@@ -77,18 +77,30 @@ chooseEncodingInfo(RankedTensorType tensorType) {
   switch (*encoding) {
   case TensorEncoding::MATMUL_F32F32F32_LHS:
   case TensorEncoding::MATMUL_I8I8I32_LHS:
+  case TensorEncoding::MATMUL_F16F16F32_LHS:
+  case TensorEncoding::MATMUL_F16F16F16_LHS:
+  case TensorEncoding::MATMUL_BF16BF16F32_LHS:
     return MaterializeEncodingInfo{{0, 1}, {8, 4}, {}};
     break;
   case TensorEncoding::MATMUL_F32F32F32_RHS:
   case TensorEncoding::MATMUL_I8I8I32_RHS:
+  case TensorEncoding::MATMUL_F16F16F32_RHS:
+  case TensorEncoding::MATMUL_F16F16F16_RHS:
+  case TensorEncoding::MATMUL_BF16BF16F32_RHS:
     return MaterializeEncodingInfo{{0, 1}, {4, 8}, {}};
     break;
   case TensorEncoding::MATMUL_F32F32F32_RHS_TRANSPOSE:
   case TensorEncoding::MATMUL_I8I8I32_RHS_TRANSPOSE:
+  case TensorEncoding::MATMUL_F16F16F32_RHS_TRANSPOSE:
+  case TensorEncoding::MATMUL_F16F16F16_RHS_TRANSPOSE:
+  case TensorEncoding::MATMUL_BF16BF16F32_RHS_TRANSPOSE:
     return MaterializeEncodingInfo{{1, 0}, {8, 4}, {1, 0}};
     break;
   case TensorEncoding::MATMUL_F32F32F32_RESULT:
   case TensorEncoding::MATMUL_I8I8I32_RESULT:
+  case TensorEncoding::MATMUL_F16F16F32_RESULT:
+  case TensorEncoding::MATMUL_F16F16F16_RESULT:
+  case TensorEncoding::MATMUL_BF16BF16F32_RESULT:
     return MaterializeEncodingInfo{{0, 1}, {8, 8}, {}};
     break;
   default:
@@ -197,6 +209,24 @@ static FailureOr<UnPackOp> lowerUnsetEncodingToUnpackOp(
       *innerTileSizesOfr, materializeEncodingInfo->outerDimsPerm);
 }
 
+/// Returns true if `lhs`, `rhs` and `result` are the MATMUL_*_LHS,
+/// MATMUL_*_RHS_TRANSPOSE and MATMUL_*_RESULT encodings of the same matmul
+/// type.
+static bool isMatmulEncodingTriple(TensorEncoding lhs, TensorEncoding rhs,
+                                   TensorEncoding result) {
+#define MATMUL_ENCODING_TRIPLE(TYPE)                                           \
+  if (lhs == TensorEncoding::MATMUL_##TYPE##_LHS)                              \
+    return rhs == TensorEncoding::MATMUL_##TYPE##_RHS_TRANSPOSE &&             \
+           result == TensorEncoding::MATMUL_##TYPE##_RESULT;
+  MATMUL_ENCODING_TRIPLE(F32F32F32)
+  MATMUL_ENCODING_TRIPLE(I8I8I32)
+  MATMUL_ENCODING_TRIPLE(F16F16F32)
+  MATMUL_ENCODING_TRIPLE(F16F16F16)
+  MATMUL_ENCODING_TRIPLE(BF16BF16F32)
+#undef MATMUL_ENCODING_TRIPLE
+  return false;
+}
+
 /// Utility method to convert from `linalg.matmul` with
 /// - lhs encoding of MATMUL_*_LHS
 /// - rhs encoding of MATMUL_*_RHS_TRANSPOSE
@@ -217,15 +247,9 @@ lowerOpWithEncoding(RewriterBase &rewriter, linalg::MatmulOp matmulOp,
       getEncoding(inputs[1]->get().getType().cast<RankedTensorType>());
   Optional<TensorEncoding> resultEncoding =
       getEncoding(outputs[0]->get().getType().cast<RankedTensorType>());
-  if (!lhsEncoding ||
-      (lhsEncoding.value() != TensorEncoding::MATMUL_F32F32F32_LHS &&
-       lhsEncoding.value() != TensorEncoding::MATMUL_I8I8I32_LHS) ||
-      !rhsEncoding ||
-      (rhsEncoding.value() != TensorEncoding::MATMUL_F32F32F32_RHS_TRANSPOSE &&
-       rhsEncoding.value() != TensorEncoding::MATMUL_I8I8I32_RHS_TRANSPOSE) ||
-      !resultEncoding ||
-      (resultEncoding.value() != TensorEncoding::MATMUL_F32F32F32_RESULT &&
-       resultEncoding.value() != TensorEncoding::MATMUL_I8I8I32_RESULT)) {
+  if (!lhsEncoding || !rhsEncoding || !resultEncoding ||
+      !isMatmulEncodingTriple(lhsEncoding.value(), rhsEncoding.value(),
+                              resultEncoding.value())) {
     return failure();
   }
   Operation *mmt4DOp = rewriter.create<linalg::Mmt4DOp>(
@@ -0,0 +1,37 @@
+// RUN: iree-dialects-opt --split-input-file -iree-linalg-ext-convert-conv2d-to-winograd="output-tile-size=4" -mlir-elide-elementsattrs-if-larger=4 %s | FileCheck %s
+
+func.func @conv_14433126(%arg0: tensor<1x14x14x4xf32>, %arg2: tensor<1x12x12x16xf32>) -> tensor<1x12x12x16xf32> {
+  %c0 = arith.constant dense<0.1> : tensor<3x3x4x16xf32>
+  %0 = linalg.conv_2d_nhwc_hwcf
+    {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64> }
+     ins(%arg0, %c0: tensor<1x14x14x4xf32>, tensor<3x3x4x16xf32>)
+    outs(%arg2: tensor<1x12x12x16xf32>) -> tensor<1x12x12x16xf32>
+  return %0 : tensor<1x12x12x16xf32>
+}
+// CHECK:      func.func @conv_14433126(%[[ARG0:[a-zA-Z0-9_]+]]: tensor<1x14x14x4xf32>, %[[ARG1:[a-zA-Z0-9_]+]]:
+// CHECK-SAME:   tensor<1x12x12x16xf32>) -> tensor<1x12x12x16xf32> {
+// CHECK:        %[[CST:.+]] = arith.constant dense_resource<__elided__> : tensor<36x4x16xf32>
+// CHECK:        %[[CST_0:.+]] = arith.constant 0.000000e+00 : f32
+// CHECK:        %[[D0:.+]] = tensor.empty() : tensor<6x6x1x3x3x4xf32>
+// CHECK:        %[[D1:.+]] = iree_linalg_ext.winograd.input_transform output_tile_size(4) kernel_size(3)
+// CHECK-SAME:     image_dimensions([1, 2]) ins(%[[ARG0]] : tensor<1x14x14x4xf32>) outs(%[[D0]] :
+// CHECK-SAME:     tensor<6x6x1x3x3x4xf32>) -> tensor<6x6x1x3x3x4xf32>
+// CHECK:        %[[COLLAPSED:.+]] = tensor.collapse_shape %[[D1]]
+// CHECK-SAME{LITERAL}:  [[0, 1], [2, 3, 4], [5]]
+// CHECK-SAME:           tensor<6x6x1x3x3x4xf32> into tensor<36x9x4xf32>
+// CHECK:        %[[D2:.+]] = tensor.empty() : tensor<36x9x16xf32>
+// CHECK:        %[[D3:.+]] = linalg.fill ins(%[[CST_0]] : f32) outs(%[[D2]] : tensor<36x9x16xf32>) ->
+// CHECK-SAME:     tensor<36x9x16xf32>
+// CHECK:        %[[D4:.+]] = linalg.batch_matmul ins(%[[COLLAPSED]], %[[CST]] : tensor<36x9x4xf32>,
+// CHECK-SAME:     tensor<36x4x16xf32>) outs(%[[D3]] : tensor<36x9x16xf32>) -> tensor<36x9x16xf32>
+// CHECK:        %[[EXPANDED:.+]] = tensor.expand_shape %[[D4]]
+// CHECK-SAME{LITERAL}: [[0, 1], [2, 3, 4], [5]]
+// CHECK-SAME:          tensor<36x9x16xf32> into tensor<6x6x1x3x3x16xf32>
+// CHECK:        %[[D5:.+]] = tensor.empty() : tensor<1x12x12x16xf32>
+// CHECK:        %[[D6:.+]] = iree_linalg_ext.winograd.output_transform output_tile_size(4) kernel_size(3)
+// CHECK-SAME:     image_dimensions([1, 2]) ins(%[[EXPANDED]] : tensor<6x6x1x3x3x16xf32>) outs(%[[D5]] :
+// CHECK-SAME:     tensor<1x12x12x16xf32>) -> tensor<1x12x12x16xf32>
+// CHECK:        %[[EXTRACTED_SLICE:.+]] = tensor.extract_slice %[[D6]][0, 0, 0, 0] [1, 12, 12, 16] [1, 1, 1, 1] :
+// CHECK-SAME:     tensor<1x12x12x16xf32> to tensor<1x12x12x16xf32>
+// CHECK:        return %[[EXTRACTED_SLICE]] : tensor<1x12x12x16xf32>
+// CHECK:      }
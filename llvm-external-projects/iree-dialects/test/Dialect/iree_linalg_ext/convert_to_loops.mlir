@@ -16,7 +16,8 @@ func.func @sort_1d(%arg0: memref<128xi32>) {
 // CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
 // CHECK-DAG:     %[[C127:.+]] = arith.constant 127 : index
 // CHECK:         scf.for %[[ARG1:.+]] = %[[C0]] to %[[C128]] step %[[C1]]
-// CHECK:           scf.for %[[ARG2:.+]] = %[[C0]] to %[[C127]] step %[[C1]]
+// CHECK:           %[[UB:.+]] = arith.subi %[[C127]], %[[ARG1]] : index
+// CHECK:           scf.for %[[ARG2:.+]] = %[[C0]] to %[[UB]] step %[[C1]]
 // CHECK:             %[[T1:.+]] = arith.addi %[[ARG2]], %[[C1]] : index
 // CHECK:             %[[V1:.+]] = memref.load %[[BUF]][%[[ARG2]]]
 // CHECK:             %[[V2:.+]] = memref.load %[[BUF]][%[[T1]]]
@@ -48,7 +49,8 @@ func.func @sort_2d(%arg0: memref<16x32xi32>) {
 // CHECK-DAG:     %[[C15:.+]] = arith.constant 15 : index
 // CHECK:         scf.for %[[ARG1:.+]] = %[[C0]] to %[[C16]] step %[[C1]]
 // CHECK:           scf.for %[[ARG2:.+]] = %[[C0]] to %[[C32]] step %[[C1]]
-// CHECK:             scf.for %[[ARG3:.+]] = %[[C0]] to %[[C15]] step %[[C1]]
+// CHECK:             %[[UB:.+]] = arith.subi %[[C15]], %[[ARG1]] : index
+// CHECK:             scf.for %[[ARG3:.+]] = %[[C0]] to %[[UB]] step %[[C1]]
 // CHECK:               %[[T1:.+]] = arith.addi %[[ARG3]], %[[C1]] : index
 // CHECK:               %[[V1:.+]] = memref.load %[[BUF]][%[[ARG3]], %[[ARG2]]]
 // CHECK:               %[[V2:.+]] = memref.load %[[BUF]][%[[T1]], %[[ARG2]]]
@@ -80,7 +82,8 @@ func.func @sort_multi(%arg0: memref<128xf32>, %arg1: memref<128xi32>) {
 // CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
 // CHECK-DAG:     %[[C127:.+]] = arith.constant 127 : index
 // CHECK:         scf.for %[[ARG1:.+]] = %[[C0]] to %[[C128]] step %[[C1]]
-// CHECK:           scf.for %[[ARG2:.+]] = %[[C0]] to %[[C127]] step %[[C1]]
+// CHECK:           %[[UB:.+]] = arith.subi %[[C127]], %[[ARG1]] : index
+// CHECK:           scf.for %[[ARG2:.+]] = %[[C0]] to %[[UB]] step %[[C1]]
 // CHECK:             %[[T1:.+]] = arith.addi %[[ARG2]], %[[C1]] : index
 // CHECK:             %[[V1:.+]] = memref.load %[[BUF1]][%[[ARG2]]]
 // CHECK:             %[[V2:.+]] = memref.load %[[BUF1]][%[[T1]]]
@@ -656,6 +659,15 @@ func.func @topk_memref(%input_values: memref<2x10xf32>, %input_indices: memref<2
 // CHECK:           scf.for %[[ARG5:.+]] = %[[C0]] to %[[C10]] step %[[C1]]
 // CHECK:             %[[D0:.+]] = memref.load %[[ARG0]][%[[ARG4]], %[[ARG5]]]
 // CHECK:             %[[D1:.+]] = memref.load %[[ARG1]][%[[ARG4]], %[[ARG5]]]
+// CHECK:             %[[LAST_V:.+]] = memref.load %[[ARG2]][%[[ARG4]], %[[C2]]]
+// CHECK:             %[[LAST_I:.+]] = memref.load %[[ARG3]][%[[ARG4]], %[[C2]]]
+// CHECK:             %[[FWD:.+]] = arith.cmpf ogt, %[[D0]], %[[LAST_V]] : f32
+// CHECK:             %[[REV:.+]] = arith.cmpf ogt, %[[LAST_V]], %[[D0]] : f32
+// CHECK:             %[[EQ:.+]] = arith.cmpi eq, %[[FWD]], %[[REV]] : i1
+// CHECK:             %[[FIRST:.+]] = arith.cmpi slt, %[[D1]], %[[LAST_I]] : i32
+// CHECK:             %[[TIE:.+]] = arith.andi %[[EQ]], %[[FIRST]] : i1
+// CHECK:             %[[INSERT:.+]] = arith.ori %[[FWD]], %[[TIE]] : i1
+// CHECK:             scf.if %[[INSERT]] {
 // CHECK:             %[[D2:.+]]:2 = scf.for %[[ARG6:.+]] = %[[C0]] to %[[C3]] step %[[C1]] iter_args(%[[ARG7:.+]] = %[[D0]], %[[ARG8:.+]] = %[[D1]])
 // CHECK:               %[[D3:.+]] = memref.load %[[ARG2]][%[[ARG4]], %[[ARG6]]]
 // CHECK:               %[[D4:.+]] = memref.load %[[ARG3]][%[[ARG4]], %[[ARG6]]]
@@ -694,6 +706,7 @@ func.func @topk_memref_dynamic(%input_values: memref<?x?xf32>, %input_indices: m
 // CHECK-SAME:    %[[ARG3:[a-zA-Z0-9]+]]
 // CHECK-DAG:     %[[C0:.+]] = arith.constant 0 : index
 // CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
+// CHECK-DAG:     %[[C2:.+]] = arith.constant 2 : index
 // CHECK-DAG:     %[[C3:.+]] = arith.constant 3 : index
 // CHECK:         %[[D0:.+]] = memref.dim %[[ARG0:.+]], %[[C0]]
 // CHECK:         %[[D1:.+]] = memref.dim %[[ARG0:.+]], %[[C1]]
@@ -701,6 +714,15 @@ func.func @topk_memref_dynamic(%input_values: memref<?x?xf32>, %input_indices: m
 // CHECK:           scf.for %[[ARG5:.+]] = %[[C0]] to %[[D1]] step %[[C1]]
 // CHECK:             %[[D2:.+]] = memref.load %[[ARG0]][%[[ARG4]], %[[ARG5]]]
 // CHECK:             %[[D3:.+]] = memref.load %[[ARG1]][%[[ARG4]], %[[ARG5]]]
+// CHECK:             %[[LAST_V:.+]] = memref.load %[[ARG2]][%[[ARG4]], %[[C2]]]
+// CHECK:             %[[LAST_I:.+]] = memref.load %[[ARG3]][%[[ARG4]], %[[C2]]]
+// CHECK:             %[[FWD:.+]] = arith.cmpf ogt, %[[D2]], %[[LAST_V]] : f32
+// CHECK:             %[[REV:.+]] = arith.cmpf ogt, %[[LAST_V]], %[[D2]] : f32
+// CHECK:             %[[EQ:.+]] = arith.cmpi eq, %[[FWD]], %[[REV]] : i1
+// CHECK:             %[[FIRST:.+]] = arith.cmpi slt, %[[D3]], %[[LAST_I]] : i32
+// CHECK:             %[[TIE:.+]] = arith.andi %[[EQ]], %[[FIRST]] : i1
+// CHECK:             %[[INSERT:.+]] = arith.ori %[[FWD]], %[[TIE]] : i1
+// CHECK:             scf.if %[[INSERT]] {
 // CHECK:             %[[D4:.+]]:2 = scf.for %[[ARG6:.+]] = %[[C0]] to %[[C3]] step %[[C1]] iter_args(%[[ARG7:.+]] = %[[D2]], %[[ARG8:.+]] = %[[D3]])
 // CHECK:               %[[D5:.+]] = memref.load %[[ARG2]][%[[ARG4]], %[[ARG6]]]
 // CHECK:               %[[D6:.+]] = memref.load %[[ARG3]][%[[ARG4]], %[[ARG6]]]
@@ -745,6 +767,15 @@ func.func @topk_memref_optional(%input_values: memref<2x10xf32>, %out_values: me
 // CHECK:           scf.for %[[ARG4:.+]] = %[[C0]] to %[[C10]] step %[[C1]]
 // CHECK:             %[[D0:.+]] = memref.load %[[ARG0]][%[[ARG3]], %[[ARG4]]]
 // CHECK:             %[[D1:.+]] = arith.index_cast %[[ARG4]] : index to i32
+// CHECK:             %[[LAST_V:.+]] = memref.load %[[ARG1]][%[[ARG3]], %[[C2]]]
+// CHECK:             %[[LAST_I:.+]] = memref.load %[[ARG2]][%[[ARG3]], %[[C2]]]
+// CHECK:             %[[FWD:.+]] = arith.cmpf ogt, %[[D0]], %[[LAST_V]] : f32
+// CHECK:             %[[REV:.+]] = arith.cmpf ogt, %[[LAST_V]], %[[D0]] : f32
+// CHECK:             %[[EQ:.+]] = arith.cmpi eq, %[[FWD]], %[[REV]] : i1
+// CHECK:             %[[FIRST:.+]] = arith.cmpi slt, %[[D1]], %[[LAST_I]] : i32
+// CHECK:             %[[TIE:.+]] = arith.andi %[[EQ]], %[[FIRST]] : i1
+// CHECK:             %[[INSERT:.+]] = arith.ori %[[FWD]], %[[TIE]] : i1
+// CHECK:             scf.if %[[INSERT]] {
 // CHECK:             %[[D2:.+]]:2 = scf.for %[[ARG5:.+]] = %[[C0]] to %[[C3]] step %[[C1]] iter_args(%[[ARG6:.+]] = %[[D0]], %[[ARG7:.+]] = %[[D1]])
 // CHECK:               %[[D3:.+]] = memref.load %[[ARG1]][%[[ARG3]], %[[ARG5]]]
 // CHECK:               %[[D4:.+]] = memref.load %[[ARG2]][%[[ARG3]], %[[ARG5]]]
@@ -764,6 +795,48 @@ func.func @topk_memref_optional(%input_values: memref<2x10xf32>, %out_values: me
 
 // -----
 
+func.func @sample_memref(%values: memref<2x40xf16>, %indices: memref<2x40xi32>, %counters: memref<2xi64>, %out: memref<2xi32>) {
+  iree_linalg_ext.sample {temperature = 0.5 : f32, top_p = 0.9 : f32}
+        ins(%values, %indices, %counters : memref<2x40xf16>, memref<2x40xi32>, memref<2xi64>)
+        outs(%out : memref<2xi32>)
+  return
+}
+
+// CHECK-LABEL: func.func @sample_memref
+// CHECK-SAME:    %[[VALUES:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[INDICES:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[COUNTERS:[a-zA-Z0-9]+]]
+// CHECK-SAME:    %[[OUT:[a-zA-Z0-9]+]]
+// CHECK-DAG:     %[[C0:.+]] = arith.constant 0 : index
+// CHECK-DAG:     %[[C1:.+]] = arith.constant 1 : index
+// CHECK-DAG:     %[[C2:.+]] = arith.constant 2 : index
+// CHECK-DAG:     %[[C40:.+]] = arith.constant 40 : index
+// CHECK-DAG:     %[[INV_T:.+]] = arith.constant 2.000000e+00 : f32
+// CHECK-DAG:     %[[TOP_P:.+]] = arith.constant 9.000000e-01 : f32
+// CHECK:         scf.for %[[ROW:.+]] = %[[C0]] to %[[C2]] step %[[C1]]
+// CHECK:           %[[FIRST:.+]] = memref.load %[[VALUES]][%[[ROW]], %[[C0]]]
+// CHECK:           %[[MAX:.+]] = arith.extf %[[FIRST]] : f16 to f32
+// CHECK:           %[[TOTAL:.+]] = scf.for %{{.+}} = %[[C0]] to %[[C40]] step %[[C1]] iter_args
+// CHECK:             arith.subf %{{.+}}, %[[MAX]] : f32
+// CHECK:             arith.mulf %{{.+}}, %[[INV_T]] : f32
+// CHECK:             math.exp
+// CHECK:           %[[THRESHOLD:.+]] = arith.mulf %[[TOTAL]], %[[TOP_P]] : f32
+// CHECK:           %[[KEPT:.+]]:2 = scf.for
+// CHECK:             arith.cmpf olt, %{{.+}}, %[[THRESHOLD]] : f32
+// CHECK:           %[[COUNTER:.+]] = memref.load %[[COUNTERS]][%[[ROW]]]
+// CHECK:           arith.addi %[[COUNTER]]
+// CHECK:           %[[UNIFORM:.+]] = arith.mulf
+// CHECK:           %[[TARGET:.+]] = arith.mulf %[[UNIFORM]], %[[KEPT]]#1 : f32
+// CHECK:           %[[INITIAL:.+]] = memref.load %[[INDICES]][%[[ROW]], %[[C0]]]
+// CHECK:           %[[SELECT:.+]]:3 = scf.for %[[K:.+]] = %[[C0]] to %[[C40]] step %[[C1]]
+// CHECK-SAME:          iter_args(%{{.+}} = %{{.+}}, %[[SELECTED:.+]] = %[[INITIAL]], %{{.+}} = %{{.+}})
+// CHECK:             %[[INDEX:.+]] = memref.load %[[INDICES]][%[[ROW]], %[[K]]]
+// CHECK:             arith.select %{{.+}}, %[[INDEX]], %[[SELECTED]] : i32
+// CHECK:             arith.cmpf ogt, %{{.+}}, %[[TARGET]] : f32
+// CHECK:           memref.store %[[SELECT]]#1, %[[OUT]][%[[ROW]]]
+
+// -----
+
 func.func @NC_to_NCnc(%arg0: memref<128x256xf32>, %arg1: memref<4x8x32x32xf32>) {
   iree_linalg_ext.pack %arg0 inner_dims_pos = [0, 1] inner_tiles = [32, 32] into %arg1 : (memref<128x256xf32> memref<4x8x32x32xf32>)
   return
@@ -479,6 +479,26 @@ func.func @topk_invalid(%input_values: tensor<3x10xf32>, %input_indices: tensor<
 
 // -----
 
+func.func @sample_invalid_batch(%values: tensor<2x40xf32>, %indices: tensor<2x40xi32>, %counters: tensor<3xi64>, %out: tensor<2xi32>) -> tensor<2xi32> {
+  // expected-error@+1 {{incompatible batch dimension}}
+  %0 = iree_linalg_ext.sample
+        ins(%values, %indices, %counters : tensor<2x40xf32>, tensor<2x40xi32>, tensor<3xi64>)
+        outs(%out : tensor<2xi32>) -> tensor<2xi32>
+  return %0 : tensor<2xi32>
+}
+
+// -----
+
+func.func @sample_invalid_top_p(%values: tensor<2x40xf32>, %indices: tensor<2x40xi32>, %counters: tensor<2xi64>, %out: tensor<2xi32>) -> tensor<2xi32> {
+  // expected-error@+1 {{expected top_p to be in (0, 1]}}
+  %0 = iree_linalg_ext.sample {top_p = 1.5 : f32}
+        ins(%values, %indices, %counters : tensor<2x40xf32>, tensor<2x40xi32>, tensor<2xi64>)
+        outs(%out : tensor<2xi32>) -> tensor<2xi32>
+  return %0 : tensor<2xi32>
+}
+
+// -----
+
 func.func @pack_invalid(%input: tensor<256x128xf32>, %output: tensor<8x8x32x16xf32>) -> tensor<8x8x32x16xf32> {
   // expected-error@+1 {{the shape of output is not large enough to hold the packed data. Expected at least 'tensor<8x8x16x32xf32>', got 'tensor<8x8x32x16xf32>'}}
   %0 = iree_linalg_ext.pack %input inner_dims_pos = [1, 0] inner_tiles = [16, 32] into %output : (tensor<256x128xf32> tensor<8x8x32x16xf32>) -> tensor<8x8x32x16xf32>
@@ -666,6 +666,46 @@ func.func @topk_tensor_optional(%input_values: tensor<20x10x8x4xf32>) -> (tensor
 
 // -----
 
+func.func @sample_tensor(%values: tensor<2x40xf32>, %indices: tensor<2x40xi32>, %counters: tensor<2xi64>) -> tensor<2xi32> {
+  %out = tensor.empty() : tensor<2xi32>
+  %0 = iree_linalg_ext.sample {temperature = 0.8 : f32, top_p = 0.9 : f32}
+        ins(%values, %indices, %counters : tensor<2x40xf32>, tensor<2x40xi32>, tensor<2xi64>)
+        outs(%out : tensor<2xi32>) -> tensor<2xi32>
+  return %0 : tensor<2xi32>
+}
+
+// CHECK-LABEL: func.func @sample_tensor
+//  CHECK-SAME:   %[[ARG0:[a-zA-Z0-9]+]]: tensor<2x40xf32>
+//  CHECK-SAME:   %[[ARG1:[a-zA-Z0-9]+]]: tensor<2x40xi32>
+//  CHECK-SAME:   %[[ARG2:[a-zA-Z0-9]+]]: tensor<2xi64>
+//       CHECK:   %[[OUT:.+]] = tensor.empty()
+//       CHECK:   %[[RESULT:.+]] = iree_linalg_ext.sample
+//  CHECK-SAME:      temperature = 8.000000e-01 : f32
+//  CHECK-SAME:      top_p = 9.000000e-01 : f32
+//  CHECK-SAME:      ins(%[[ARG0]], %[[ARG1]], %[[ARG2]]
+//  CHECK-SAME:      outs(%[[OUT]]
+//       CHECK:   return %[[RESULT]]
+
+// -----
+
+func.func @sample_memref(%values: memref<?x?xf16>, %indices: memref<?x?xi32>, %counters: memref<?xi64>, %out: memref<?xi32>) {
+  iree_linalg_ext.sample
+        ins(%values, %indices, %counters : memref<?x?xf16>, memref<?x?xi32>, memref<?xi64>)
+        outs(%out : memref<?xi32>)
+  return
+}
+
+// CHECK-LABEL: func.func @sample_memref
+//  CHECK-SAME:   %[[ARG0:[a-zA-Z0-9]+]]: memref<?x?xf16>
+//  CHECK-SAME:   %[[ARG1:[a-zA-Z0-9]+]]: memref<?x?xi32>
+//  CHECK-SAME:   %[[ARG2:[a-zA-Z0-9]+]]: memref<?xi64>
+//  CHECK-SAME:   %[[ARG3:[a-zA-Z0-9]+]]: memref<?xi32>
+//       CHECK:   iree_linalg_ext.sample
+//  CHECK-SAME:      ins(%[[ARG0]], %[[ARG1]], %[[ARG2]]
+//  CHECK-SAME:      outs(%[[ARG3]]
+
+// -----
+
 func.func @pack(%arg0: tensor<3x3xf32>, %arg1: tensor<3x3x1x1xf32>) -> tensor<3x3x1x1xf32> {
   %1 = iree_linalg_ext.pack %arg0 inner_dims_pos = [0, 1] inner_tiles = [1, 1] into %arg1 : (tensor<3x3xf32> tensor<3x3x1x1xf32>) -> tensor<3x3x1x1xf32>
   return %1 : tensor<3x3x1x1xf32>
@@ -43,6 +43,33 @@ static std::string ToHexString(uint32_t value) {
   return ToHexString((const uint8_t*)&value, sizeof(value));
 }
 
+// Returns |hal_buffer| as a HalBuffer or, if |element_type| is specified, as
+// a HalBufferView shaped like |py_view|. Takes ownership of |hal_buffer|.
+py::object WrapHalBuffer(iree_hal_buffer_t* hal_buffer, Py_buffer& py_view,
+                         std::optional<iree_hal_element_types_t> element_type,
+                         iree_allocator_t host_allocator) {
+  if (!element_type) {
+    return py::cast(HalBuffer::StealFromRawPtr(hal_buffer),
+                    py::return_value_policy::move);
+  }
+
+  // Create the buffer_view. (note that numpy shape is ssize_t, so we need to
+  // copy).
+  iree_hal_encoding_type_t encoding_type =
+      IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR;
+  std::vector<iree_hal_dim_t> dims(py_view.ndim);
+  std::copy(py_view.shape, py_view.shape + py_view.ndim, dims.begin());
+  iree_hal_buffer_view_t* hal_buffer_view = nullptr;
+  iree_status_t status = iree_hal_buffer_view_create(
+      hal_buffer, dims.size(), dims.data(), *element_type, encoding_type,
+      host_allocator, &hal_buffer_view);
+  iree_hal_buffer_release(hal_buffer);
+  CheckApiStatus(status, "Error allocating buffer_view");
+
+  return py::cast(HalBufferView::StealFromRawPtr(hal_buffer_view),
+                  py::return_value_policy::move);
+}
+
 }  // namespace
 
 //------------------------------------------------------------------------------
@@ -115,27 +142,68 @@ py::object HalAllocator::AllocateBufferCopy(
   }
   CheckApiStatus(status, "Failed to allocate device visible buffer");
 
-  if (!element_type) {
-    return py::cast(HalBuffer::StealFromRawPtr(hal_buffer),
-                    py::return_value_policy::move);
+  return WrapHalBuffer(hal_buffer, py_view, element_type,
+                       iree_hal_allocator_host_allocator(raw_ptr()));
+}
+
+py::object HalAllocator::ImportBuffer(
+    int memory_type, int allowed_usage, py::object buffer,
+    std::optional<iree_hal_element_types_t> element_type) {
+  IREE_TRACE_SCOPE0("HalAllocator::ImportBuffer");
+  // The Py_buffer must outlive this call: it is owned by the HAL buffer and
+  // released from its release callback (which may run on any thread).
+  auto py_view = std::make_unique<Py_buffer>();
+  int flags = PyBUF_FORMAT | PyBUF_ND;
+  if (PyObject_GetBuffer(buffer.ptr(), py_view.get(), flags) != 0) {
+    throw py::error_already_set();
   }
 
-  // Create the buffer_view. (note that numpy shape is ssize_t, so we need to
-  // copy).
-  iree_hal_encoding_type_t encoding_type =
-      IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR;
-  std::vector<iree_hal_dim_t> dims(py_view.ndim);
-  std::copy(py_view.shape, py_view.shape + py_view.ndim, dims.begin());
-  iree_hal_buffer_view_t* hal_buffer_view;
-  CheckApiStatus(
-      iree_hal_buffer_view_create(
-          hal_buffer, dims.size(), dims.data(), *element_type, encoding_type,
-          iree_hal_allocator_host_allocator(raw_ptr()), &hal_buffer_view),
-      "Error allocating buffer_view");
-  iree_hal_buffer_release(hal_buffer);
+  // Host allocations can only be imported if they meet the alignment
+  // requirements of the HAL. Callers are expected to fall back to copying.
+  if (((uintptr_t)py_view->buf % IREE_HAL_HEAP_BUFFER_ALIGNMENT) != 0) {
+    PyBuffer_Release(py_view.get());
+    return py::none();
+  }
 
-  return py::cast(HalBufferView::StealFromRawPtr(hal_buffer_view),
-                  py::return_value_policy::move);
+  iree_hal_buffer_params_t params = {0};
+  params.type = memory_type | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE;
+  params.usage = allowed_usage;
+  params.access = py_view->readonly ? IREE_HAL_MEMORY_ACCESS_READ
+                                    : IREE_HAL_MEMORY_ACCESS_ALL;
+
+  iree_hal_external_buffer_t external_buffer;
+  memset(&external_buffer, 0, sizeof(external_buffer));
+  external_buffer.type = IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION;
+  external_buffer.size = py_view->len;
+  external_buffer.handle.host_allocation.ptr = py_view->buf;
+
+  iree_hal_buffer_release_callback_t release_callback;
+  release_callback.fn = +[](void* user_data, iree_hal_buffer_t* buffer) {
+    Py_buffer* py_view = static_cast<Py_buffer*>(user_data);
+    if (Py_IsInitialized()) {
+      PyGILState_STATE gil_state = PyGILState_Ensure();
+      PyBuffer_Release(py_view);
+      PyGILState_Release(gil_state);
+    }
+    delete py_view;
+  };
+  release_callback.user_data = py_view.get();
+
+  iree_hal_buffer_t* hal_buffer = nullptr;
+  iree_status_t status = iree_hal_allocator_import_buffer(
+      raw_ptr(), params, &external_buffer, release_callback, &hal_buffer);
+  if (!iree_status_is_ok(status)) {
+    // Not importable by this allocator (wrong memory type, unsupported
+    // external buffer type, etc): signal the caller to copy instead.
+    iree_status_ignore(status);
+    PyBuffer_Release(py_view.get());
+    return py::none();
+  }
+  // Ownership of the Py_buffer has transferred to the release callback.
+  Py_buffer* owned_view = py_view.release();
+
+  return WrapHalBuffer(hal_buffer, *owned_view, element_type,
+                       iree_hal_allocator_host_allocator(raw_ptr()));
 }
 
 //------------------------------------------------------------------------------
@@ -244,6 +312,108 @@ void HalDevice::EndProfiling() {
                  "ending device profiling");
 }
 
+HalSemaphore HalDevice::CreateSemaphore(uint64_t initial_value) {
+  iree_hal_semaphore_t* semaphore = nullptr;
+  CheckApiStatus(
+      iree_hal_semaphore_create(raw_ptr(), initial_value, &semaphore),
+      "creating semaphore");
+  return HalSemaphore::StealFromRawPtr(semaphore);
+}
+
+//------------------------------------------------------------------------------
+// HalSemaphore / HalFence
+//------------------------------------------------------------------------------
+
+namespace {
+
+iree_timeout_t MakeTimeout(std::optional<int64_t> timeout_ms) {
+  return timeout_ms ? iree_make_timeout_ms(*timeout_ms)
+                    : iree_infinite_timeout();
+}
+
+// Returns true if |status| is OK and false if it is a deadline exceeded error.
+// Raises on all other errors.
+bool CheckWaitStatus(iree_status_t status, const char* message) {
+  if (iree_status_is_deadline_exceeded(status)) {
+    iree_status_ignore(status);
+    return false;
+  }
+  CheckApiStatus(status, message);
+  return true;
+}
+
+}  // namespace
+
+uint64_t HalSemaphore::Query() {
+  uint64_t value = 0;
+  CheckApiStatus(iree_hal_semaphore_query(raw_ptr(), &value),
+                 "querying semaphore");
+  return value;
+}
+
+void HalSemaphore::Signal(uint64_t new_value) {
+  CheckApiStatus(iree_hal_semaphore_signal(raw_ptr(), new_value),
+                 "signaling semaphore");
+}
+
+bool HalSemaphore::Wait(uint64_t value, std::optional<int64_t> timeout_ms) {
+  iree_status_t status;
+  {
+    py::gil_scoped_release release;
+    status = iree_hal_semaphore_wait(raw_ptr(), value, MakeTimeout(timeout_ms));
+  }
+  return CheckWaitStatus(status, "waiting for semaphore");
+}
+
+HalFence HalFence::Create(iree_host_size_t capacity) {
+  iree_hal_fence_t* fence = nullptr;
+  CheckApiStatus(
+      iree_hal_fence_create(capacity, iree_allocator_system(), &fence),
+      "creating fence");
+  return HalFence::StealFromRawPtr(fence);
+}
+
+HalFence HalFence::CreateAt(HalSemaphore& semaphore, uint64_t value) {
+  iree_hal_fence_t* fence = nullptr;
+  CheckApiStatus(iree_hal_fence_create_at(semaphore.raw_ptr(), value,
+                                          iree_allocator_system(), &fence),
+                 "creating fence");
+  return HalFence::StealFromRawPtr(fence);
+}
+
+void HalFence::Insert(HalSemaphore& semaphore, uint64_t value) {
+  CheckApiStatus(iree_hal_fence_insert(raw_ptr(), semaphore.raw_ptr(), value),
+                 "inserting into fence");
+}
+
+void HalFence::Extend(HalFence& from_fence) {
+  CheckApiStatus(iree_hal_fence_extend(raw_ptr(), from_fence.raw_ptr()),
+                 "extending fence");
+}
+
+bool HalFence::Query() {
+  iree_status_t status = iree_hal_fence_query(raw_ptr());
+  if (iree_status_is_deferred(status)) {
+    iree_status_ignore(status);
+    return false;
+  }
+  CheckApiStatus(status, "querying fence");
+  return true;
+}
+
+void HalFence::Signal() {
+  CheckApiStatus(iree_hal_fence_signal(raw_ptr()), "signaling fence");
+}
+
+bool HalFence::Wait(std::optional<int64_t> timeout_ms) {
+  iree_status_t status;
+  {
+    py::gil_scoped_release release;
+    status = iree_hal_fence_wait(raw_ptr(), MakeTimeout(timeout_ms));
+  }
+  return CheckWaitStatus(status, "waiting for fence");
+}
+
 //------------------------------------------------------------------------------
 // HalDriver
 //------------------------------------------------------------------------------
@@ -580,7 +750,38 @@ void SetupHalBindings(pybind11::module m) {
           },
           py::keep_alive<0, 1>())
       .def("begin_profiling", &HalDevice::BeginProfiling)
-      .def("end_profiling", &HalDevice::EndProfiling);
+      .def("end_profiling", &HalDevice::EndProfiling)
+      .def("create_semaphore", &HalDevice::CreateSemaphore,
+           py::arg("initial_value") = 0, py::keep_alive<0, 1>());
+
+  auto hal_semaphore = py::class_<HalSemaphore>(m, "HalSemaphore");
+  VmRef::BindRefProtocol(hal_semaphore, iree_hal_semaphore_type_id,
+                         iree_hal_semaphore_retain_ref,
+                         iree_hal_semaphore_deref, iree_hal_semaphore_isa);
+  hal_semaphore.def("query", &HalSemaphore::Query)
+      .def("signal", &HalSemaphore::Signal, py::arg("new_value"))
+      .def("wait", &HalSemaphore::Wait, py::arg("value"),
+           py::arg("timeout_ms") = py::none(),
+           "Waits for the semaphore to reach the given value, releasing the "
+           "GIL while blocked. Returns False if the timeout elapsed first.");
+
+  auto hal_fence = py::class_<HalFence>(m, "HalFence");
+  VmRef::BindRefProtocol(hal_fence, iree_hal_fence_type_id,
+                         iree_hal_fence_retain_ref, iree_hal_fence_deref,
+                         iree_hal_fence_isa);
+  hal_fence.def(py::init(&HalFence::Create), py::arg("capacity") = 0)
+      .def_static("create_at", &HalFence::CreateAt, py::arg("semaphore"),
+                  py::arg("value"))
+      .def_property_readonly("timepoint_count", &HalFence::timepoint_count)
+      .def("insert", &HalFence::Insert, py::arg("semaphore"), py::arg("value"))
+      .def("extend", &HalFence::Extend, py::arg("from_fence"))
+      .def("query", &HalFence::Query,
+           "Returns True if all timepoints in the fence have been reached.")
+      .def("signal", &HalFence::Signal)
+      .def("wait", &HalFence::Wait, py::arg("timeout_ms") = py::none(),
+           "Waits for all timepoints in the fence to be reached, releasing "
+           "the GIL while blocked. Returns False if the timeout elapsed "
+           "first.");
 
   py::class_<HalDriver>(m, "HalDriver")
       .def_static("query", &HalDriver::Query)
@@ -661,6 +862,15 @@ void SetupHalBindings(pybind11::module m) {
            "matching the characteristics of the Python buffer. The format is "
            "requested as ND/C-Contiguous, which may incur copies if not "
            "already in that format.");
+      .def("import_buffer", &HalAllocator::ImportBuffer,
+           py::arg("memory_type"), py::arg("allowed_usage"), py::arg("buffer"),
+           py::arg("element_type") = py::none(), py::keep_alive<0, 1>(),
+           "Imports a Python buffer object as a HAL buffer without copying. "
+           "The Python buffer is kept alive (and must not be resized) for the "
+           "lifetime of the HAL buffer. Returns None if the allocator cannot "
+           "import the memory (e.g. it is insufficiently aligned or not "
+           "device accessible), in which case allocate_buffer_copy should be "
+           "used instead.");
 
   py::class_<HalBuffer>(m, "HalBuffer")
       .def("fill_zero", &HalBuffer::FillZero, py::arg("byte_offset"),
@@ -66,6 +66,20 @@ struct ApiPtrAdapter<iree_hal_buffer_t> {
   static void Release(iree_hal_buffer_t* b) { iree_hal_buffer_release(b); }
 };
 
+template <>
+struct ApiPtrAdapter<iree_hal_semaphore_t> {
+  static void Retain(iree_hal_semaphore_t* s) { iree_hal_semaphore_retain(s); }
+  static void Release(iree_hal_semaphore_t* s) {
+    iree_hal_semaphore_release(s);
+  }
+};
+
+template <>
+struct ApiPtrAdapter<iree_hal_fence_t> {
+  static void Retain(iree_hal_fence_t* f) { iree_hal_fence_retain(f); }
+  static void Release(iree_hal_fence_t* f) { iree_hal_fence_release(f); }
+};
+
 template <>
 struct ApiPtrAdapter<iree_hal_buffer_view_t> {
   static void Retain(iree_hal_buffer_view_t* bv) {
@@ -80,6 +94,34 @@ struct ApiPtrAdapter<iree_hal_buffer_view_t> {
 // ApiRefCounted types
 //------------------------------------------------------------------------------
 
+class HalSemaphore : public ApiRefCounted<HalSemaphore, iree_hal_semaphore_t> {
+ public:
+  uint64_t Query();
+  void Signal(uint64_t new_value);
+  // Waits (with the GIL released) until the semaphore reaches |value|.
+  // Returns false if |timeout_ms| elapsed first.
+  bool Wait(uint64_t value, std::optional<int64_t> timeout_ms);
+};
+
+class HalFence : public ApiRefCounted<HalFence, iree_hal_fence_t> {
+ public:
+  static HalFence Create(iree_host_size_t capacity);
+  static HalFence CreateAt(HalSemaphore& semaphore, uint64_t value);
+
+  iree_host_size_t timepoint_count() const {
+    return iree_hal_fence_timepoint_count(raw_ptr());
+  }
+
+  void Insert(HalSemaphore& semaphore, uint64_t value);
+  void Extend(HalFence& from_fence);
+  // Returns true if all timepoints have been reached.
+  bool Query();
+  void Signal();
+  // Waits (with the GIL released) until all timepoints are reached.
+  // Returns false if |timeout_ms| elapsed first.
+  bool Wait(std::optional<int64_t> timeout_ms);
+};
+
 class HalDevice : public ApiRefCounted<HalDevice, iree_hal_device_t> {
  public:
   iree_hal_allocator_t* allocator() {
@@ -88,6 +130,7 @@ class HalDevice : public ApiRefCounted<HalDevice, iree_hal_device_t> {
 
   void BeginProfiling(const py::kwargs& kwargs);
   void EndProfiling();
+  HalSemaphore CreateSemaphore(uint64_t initial_value);
 };
 
 class HalDriver : public ApiRefCounted<HalDriver, iree_hal_driver_t> {
@@ -110,6 +153,12 @@ class HalAllocator : public ApiRefCounted<HalAllocator, iree_hal_allocator_t> {
   py::object AllocateBufferCopy(
       int memory_type, int allowed_usage, py::object buffer,
       std::optional<iree_hal_element_types_t> element_type);
+
+  // Imports |buffer| as a HAL buffer aliasing its memory. Returns None if the
+  // allocator cannot import it and a copy is required.
+  py::object ImportBuffer(int memory_type, int allowed_usage,
+                          py::object buffer,
+                          std::optional<iree_hal_element_types_t> element_type);
 };
 
 struct HalShape {
@@ -30,6 +30,22 @@ class InvokeContext {
     return HalAllocator::BorrowFromRawPtr(device().allocator());
   }
 
+  // Places a host array on the device as a buffer view, importing it without
+  // a copy when the allocator supports it and copying otherwise.
+  py::object ImportOrCopyArray(py::handle host_array,
+                               iree_hal_element_types_t element_type) {
+    HalAllocator allocator = this->allocator();
+    py::object imported_bv = allocator.ImportBuffer(
+        IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
+        IREE_HAL_BUFFER_USAGE_DEFAULT | IREE_HAL_BUFFER_USAGE_MAPPING,
+        py::reinterpret_borrow<py::object>(host_array), element_type);
+    if (!imported_bv.is_none()) return imported_bv;
+    return allocator.AllocateBufferCopy(
+        IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
+        IREE_HAL_BUFFER_USAGE_DEFAULT | IREE_HAL_BUFFER_USAGE_MAPPING,
+        py::reinterpret_borrow<py::object>(host_array), element_type);
+  }
+
  private:
   HalDevice device_;
 };
@@ -193,10 +209,7 @@ class InvokeStatics {
               throw std::invalid_argument(std::move(msg));
             }
 
-            retained_bv = c.allocator().AllocateBufferCopy(
-                IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
-                IREE_HAL_BUFFER_USAGE_DEFAULT | IREE_HAL_BUFFER_USAGE_MAPPING,
-                host_array, hal_element_type);
+            retained_bv = c.ImportOrCopyArray(host_array, hal_element_type);
             bv = py::cast<HalBufferView *>(retained_bv);
           }
 
@@ -398,10 +411,8 @@ class InvokeStatics {
           MapDtypeToElementType(host_array.attr(kDtypeAttr));
 
       // Put it on the device.
-      py::object retained_bv = c.allocator().AllocateBufferCopy(
-          IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
-          IREE_HAL_BUFFER_USAGE_DEFAULT | IREE_HAL_BUFFER_USAGE_MAPPING,
-          host_array, hal_element_type);
+      py::object retained_bv =
+          c.ImportOrCopyArray(host_array, hal_element_type);
       HalBufferView *bv = py::cast<HalBufferView *>(retained_bv);
 
       // TODO: If adding further manipulation here, please make this common
@@ -592,6 +603,62 @@ class ArgumentPacker {
   /// it.
   VmVariantList Pack(InvokeContext &invoke_context, py::sequence pos_args,
                      py::dict kw_args) {
+    VmVariantList arg_list = VmVariantList::Create(ArgCapacity(pos_args));
+    PackInto(invoke_context, arg_list, pos_args, kw_args);
+    return arg_list;
+  }
+
+  /// Packs positional/kw arguments and synchronously invokes |f| in
+  /// |context|, returning the list of results. This is the fast path for
+  /// untraced calls: the argument list is reused across invocations and is
+  /// cleared before returning so that arguments are not retained.
+  VmVariantList Invoke(InvokeContext &invoke_context, VmContext &context,
+                       iree_vm_function_t f, iree_host_size_t result_capacity,
+                       py::sequence pos_args, py::dict kw_args) {
+    IREE_TRACE_SCOPE0("ArgumentPacker::Invoke");
+
+    // A reentrant call (i.e. from another thread while the GIL is released
+    // during invocation) cannot share the cached list and uses its own.
+    VmVariantList transient_arg_list;
+    VmVariantList *arg_list = &cached_arg_list_;
+    if (cached_arg_list_in_use_) {
+      transient_arg_list = VmVariantList::Create(ArgCapacity(pos_args));
+      arg_list = &transient_arg_list;
+    } else if (!cached_arg_list_) {
+      cached_arg_list_ = VmVariantList::Create(ArgCapacity(pos_args));
+    }
+
+    class ArgListScope {
+     public:
+      ArgListScope(VmVariantList &arg_list, bool &in_use, bool is_cached)
+          : arg_list_(arg_list), in_use_(in_use), is_cached_(is_cached) {
+        if (is_cached_) in_use_ = true;
+      }
+      ~ArgListScope() {
+        iree_vm_list_clear(arg_list_.raw_ptr());
+        if (is_cached_) in_use_ = false;
+      }
+
+     private:
+      VmVariantList &arg_list_;
+      bool &in_use_;
+      bool is_cached_;
+    } arg_list_scope(*arg_list, cached_arg_list_in_use_,
+                     arg_list == &cached_arg_list_);
+
+    PackInto(invoke_context, *arg_list, pos_args, kw_args);
+    VmVariantList ret_list = VmVariantList::Create(result_capacity);
+    context.Invoke(f, *arg_list, ret_list);
+    return ret_list;
+  }
+
+ private:
+  iree_host_size_t ArgCapacity(py::sequence &pos_args) {
+    return dynamic_dispatch_ ? pos_args.size() : flat_arg_packers_.size();
+  }
+
+  void PackInto(InvokeContext &invoke_context, VmVariantList &arg_list,
+                py::sequence pos_args, py::dict kw_args) {
     // Dynamic dispatch.
     if (dynamic_dispatch_) {
       IREE_TRACE_SCOPE0("ArgumentPacker::PackDynamic");
@@ -600,7 +667,6 @@ class ArgumentPacker {
             "kwargs not supported for dynamic dispatch functions");
       }
 
-      VmVariantList arg_list = VmVariantList::Create(pos_args.size());
       for (py::handle py_arg : pos_args) {
         PackCallback packer = statics_.GetGenericPackCallbackFor(py_arg);
         if (!packer) {
@@ -612,7 +678,6 @@ class ArgumentPacker {
         // reporting which arg has a problem.
         packer(invoke_context, arg_list.raw_ptr(), py_arg);
       }
-      return arg_list;
     } else {
       IREE_TRACE_SCOPE0("ArgumentPacker::PackReflection");
 
@@ -665,17 +730,14 @@ class ArgumentPacker {
       }
 
       // Start packing into the list.
-      VmVariantList arg_list = VmVariantList::Create(flat_arg_packers_.size());
       for (size_t i = 0; i < py_args.size(); ++i) {
         // TODO: Better error handling by catching the exception and
         // reporting which arg has a problem.
         flat_arg_packers_[i](invoke_context, arg_list.raw_ptr(), py_args[i]);
       }
-      return arg_list;
     }
   }
 
- private:
   InvokeStatics &statics_;
 
   int pos_only_arg_count_ = 0;
@@ -690,6 +752,10 @@ class ArgumentPacker {
   // If true, then there is no dispatch metadata and we process fully
   // dynamically.
   bool dynamic_dispatch_ = false;
+
+  // Argument list reused by Invoke when not already in use.
+  VmVariantList cached_arg_list_;
+  bool cached_arg_list_in_use_ = false;
 };
 
 }  // namespace
@@ -699,7 +765,10 @@ void SetupInvokeBindings(pybind11::module &m) {
   py::class_<InvokeContext>(m, "InvokeContext").def(py::init<HalDevice &>());
   py::class_<ArgumentPacker>(m, "ArgumentPacker")
       .def(py::init<InvokeStatics &, std::optional<py::list>>())
-      .def("pack", &ArgumentPacker::Pack);
+      .def("pack", &ArgumentPacker::Pack)
+      .def("invoke", &ArgumentPacker::Invoke, py::arg("invoke_context"),
+           py::arg("context"), py::arg("function"), py::arg("result_capacity"),
+           py::arg("args"), py::arg("kwargs"));
 
   m.attr("_invoke_statics") = py::cast(InvokeStatics());
 }
@@ -22,10 +22,14 @@ from ._binding import (
 __all__ = [
     "asdevicearray",
     "DeviceArray",
+    "from_dlpack",
 ]
 
 _DEVICE_HANDLED_FUNCTIONS = {}
 
+# DLPack device type for host memory (DLDeviceType::kDLCPU).
+_DLPACK_KDLCPU = 1
+
 
 def _device_implements(np_function):
   """Decorator that registers a base class implementation."""
@@ -90,6 +94,21 @@ class DeviceArray(numpy.lib.mixins.NDArrayOperatorsMixin):
     host_array = self.to_host()
     return host_array.__array_function__(func, types, args, kwargs)  # pytype: disable=attribute-error
 
+  def __dlpack__(self, stream=None):
+    """Exports the array as a DLPack capsule.
+
+    The capsule aliases the mapped host memory of the underlying buffer (no
+    copy is made) and keeps the mapping alive for as long as the consumer
+    holds it. Only host accessible buffers can be exported.
+    """
+    if stream is not None:
+      raise BufferError("DeviceArray only supports DLPack with stream=None")
+    host_array = self.to_host()
+    return host_array.__dlpack__()
+
+  def __dlpack_device__(self):
+    return (_DLPACK_KDLCPU, 0)
+
   def __repr__(self):
     return f"<IREE DeviceArray: shape={np.shape(self)}, dtype={self.dtype}>"
 
@@ -187,7 +206,8 @@ def asdevicearray(device: HalDevice,
                   implicit_host_transfer: bool = False,
                   memory_type=MemoryType.DEVICE_LOCAL,
                   allowed_usage=(BufferUsage.DEFAULT | BufferUsage.MAPPING),
-                  element_type: Optional[HalElementType] = None) -> DeviceArray:
+                  element_type: Optional[HalElementType] = None,
+                  copy: bool = True) -> DeviceArray:
   """Helper to create a DeviceArray from an arbitrary array like.
 
   This is similar in purpose and usage to np.asarray, except that it takes
@@ -197,6 +217,11 @@ def asdevicearray(device: HalDevice,
   transfers to satisfy the request. If this is important to you, then a lower
   level API is likely more appropriate.
 
+  If `copy` is False, the host memory of `a` is imported into the device
+  allocator without a copy when it is suitably aligned and the device can
+  access it. The returned DeviceArray then aliases `a` (and keeps it alive).
+  Otherwise, or if the import is not possible, the contents are copied.
+
   Note that additional flags `memory_type`, `allowed_usage` and `element_type`
   are only hints if creating a new DeviceArray. If `a` is already a DeviceArray,
   they are ignored.
@@ -213,17 +238,51 @@ def asdevicearray(device: HalDevice,
   element_type = map_dtype_to_element_type(a.dtype)
   if element_type is None:
     raise ValueError(f"Could not map dtype {a.dtype} to IREE element type")
-  buffer_view = device.allocator.allocate_buffer_copy(
-      memory_type=memory_type,
-      allowed_usage=allowed_usage,
-      buffer=a,
-      element_type=element_type)
+  buffer_view = None
+  if not copy:
+    buffer_view = device.allocator.import_buffer(memory_type=memory_type,
+                                                 allowed_usage=allowed_usage,
+                                                 buffer=a,
+                                                 element_type=element_type)
+  if buffer_view is None:
+    buffer_view = device.allocator.allocate_buffer_copy(
+        memory_type=memory_type,
+        allowed_usage=allowed_usage,
+        buffer=a,
+        element_type=element_type)
   return DeviceArray(device,
                      buffer_view,
                      implicit_host_transfer=implicit_host_transfer,
                      override_dtype=a.dtype)
 
 
+def from_dlpack(device: HalDevice,
+                x,
+                *,
+                implicit_host_transfer: bool = False,
+                memory_type=MemoryType.DEVICE_LOCAL,
+                allowed_usage=(BufferUsage.DEFAULT | BufferUsage.MAPPING),
+                copy: bool = False) -> DeviceArray:
+  """Creates a DeviceArray from an object supporting the DLPack protocol.
+
+  Only host (kDLCPU) tensors are presently supported. By default the tensor
+  memory is imported without a copy if the device can access it, falling back
+  to a copy otherwise (see `asdevicearray`).
+  """
+  if isinstance(x, DeviceArray):
+    return x
+  device_type, _ = x.__dlpack_device__()
+  if device_type != _DLPACK_KDLCPU:
+    raise BufferError(
+        f"from_dlpack only supports host (kDLCPU) tensors, got {device_type}")
+  return asdevicearray(device,
+                       np.from_dlpack(x),
+                       implicit_host_transfer=implicit_host_transfer,
+                       memory_type=memory_type,
+                       allowed_usage=allowed_usage,
+                       copy=copy)
+
+
 # NOTE: Numpy dtypes are not hashable and exist in a hierarchy that should
 # be queried via isinstance checks. This should be done as a fallback but
 # this is a linear list for quick access to the most common. There may also
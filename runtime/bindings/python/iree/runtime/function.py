@@ -6,6 +6,7 @@
 
 from typing import Dict, Optional
 
+import asyncio
 import json
 import logging
 
@@ -17,6 +18,7 @@ from ._binding import (
     BufferUsage,
     HalBufferView,
     HalDevice,
+    HalFence,
     InvokeContext,
     MemoryType,
     VmContext,
@@ -84,9 +86,13 @@ class FunctionInvoker:
       "_abi_dict",
       "_arg_descs",
       "_arg_packer",
+      "_invoke_context",
+      "_ret_capacity",
       "_ret_descs",
       "_has_inlined_results",
+      "_is_coarse_fences",
       "_tracer",
+      "_use_native_invoke",
   ]
 
   def __init__(self, vm_context: VmContext, device: HalDevice,
@@ -103,58 +109,112 @@ class FunctionInvoker:
     self._arg_descs = None
     self._ret_descs = None
     self._has_inlined_results = False
+    self._is_coarse_fences = False
     self._parse_abi_dict(vm_function)
     self._arg_packer = ArgumentPacker(_invoke_statics, self._arg_descs)
+    self._invoke_context = InvokeContext(self._device)
+    # Initialize the capacity to our total number of results, since we should
+    # be below that when doing a flat invocation.
+    self._ret_capacity = (len(self._ret_descs)
+                          if self._ret_descs is not None else 1)
+    # Untraced calls on native contexts can be packed and invoked entirely in
+    # native code (other contexts are invoked via their Python API).
+    self._use_native_invoke = (tracer is None and
+                               isinstance(vm_context, VmContext) and
+                               isinstance(vm_function, VmFunction))
 
   @property
   def vm_function(self) -> VmFunction:
     return self._vm_function
 
   def __call__(self, *args, **kwargs):
-    invoke_context = InvokeContext(self._device)
-    arg_list = self._arg_packer.pack(invoke_context, args, kwargs)
-
+    if self._use_native_invoke:
+      # Fast path: arguments are packed and the function invoked in a single
+      # native call which reuses its argument list across invocations.
+      ret_list = self._arg_packer.invoke(self._invoke_context,
+                                         self._vm_context, self._vm_function,
+                                         self._ret_capacity, args, kwargs)
+      return self._unpack_results(ret_list)
+
+    arg_list = self._arg_packer.pack(self._invoke_context, args, kwargs)
     call_trace = None  # type: Optional[tracing.CallTrace]
     if self._tracer:
       call_trace = self._tracer.start_call(self._vm_function)
     try:
-      # Initialize the capacity to our total number of args, since we should
-      # be below that when doing a flat invocation. May want to be more
-      # conservative here when considering nesting.
-      inv = Invocation(self._device)
-      ret_descs = self._ret_descs
-
-      ret_list = VmVariantList(len(ret_descs) if ret_descs is not None else 1)
+      ret_list = VmVariantList(self._ret_capacity)
       if call_trace:
         call_trace.add_vm_list(arg_list, "args")
       self._invoke(arg_list, ret_list)
       if call_trace:
         call_trace.add_vm_list(ret_list, "results")
-
-      # Un-inline the results to align with reflection, as needed.
-      reflection_aligned_ret_list = ret_list
-      if self._has_inlined_results:
-        reflection_aligned_ret_list = VmVariantList(1)
-        reflection_aligned_ret_list.push_list(ret_list)
-      returns = _extract_vm_sequence_to_python(inv, reflection_aligned_ret_list,
-                                               ret_descs)
-      return_arity = len(returns)
-      if return_arity == 1:
-        return returns[0]
-      elif return_arity == 0:
-        return None
-      else:
-        return tuple(returns)
+      return self._unpack_results(ret_list)
     finally:
       if call_trace:
         call_trace.end_call()
 
+  async def invoke_async(self,
+                         *args,
+                         wait_fence: Optional[HalFence] = None,
+                         executor=None,
+                         **kwargs):
+    """Invokes the function without blocking the running event loop.
+
+    Arguments are packed on the calling thread. The invocation and the wait
+    for its completion then run on `executor` (the loop's default executor
+    if None) with the GIL released, so that multiple invocations (and the
+    event loop itself) proceed concurrently.
+
+    For functions compiled with the `coarse-fences` ABI model, the wait and
+    signal fences are appended to the arguments: device work is gated on
+    `wait_fence` (if provided) and the results are returned once the signal
+    fence is reached. Other functions execute synchronously on the executor.
+    """
+    arg_list = self._arg_packer.pack(self._invoke_context, args, kwargs)
+    signal_fence = None
+    if self._is_coarse_fences:
+      signal_fence = HalFence.create_at(self._device.create_semaphore(0), 1)
+      arg_list.push_ref(wait_fence if wait_fence is not None else HalFence(0))
+      arg_list.push_ref(signal_fence)
+    elif wait_fence is not None:
+      raise ValueError(
+          "wait_fence is only supported for functions compiled with the "
+          "coarse-fences ABI model")
+    ret_list = VmVariantList(self._ret_capacity)
+
+    def run():
+      self._invoke(arg_list, ret_list)
+      if signal_fence is not None:
+        signal_fence.wait()
+
+    loop = asyncio.get_running_loop()
+    await loop.run_in_executor(executor, run)
+    return self._unpack_results(ret_list)
+
   # Break out invoke so it shows up in profiles.
   def _invoke(self, arg_list, ret_list):
     self._vm_context.invoke(self._vm_function, arg_list, ret_list)
 
+  def _unpack_results(self, ret_list):
+    inv = Invocation(self._device)
+    # Un-inline the results to align with reflection, as needed.
+    reflection_aligned_ret_list = ret_list
+    if self._has_inlined_results:
+      reflection_aligned_ret_list = VmVariantList(1)
+      reflection_aligned_ret_list.push_list(ret_list)
+    returns = _extract_vm_sequence_to_python(inv, reflection_aligned_ret_list,
+                                             self._ret_descs)
+    return_arity = len(returns)
+    if return_arity == 1:
+      return returns[0]
+    elif return_arity == 0:
+      return None
+    else:
+      return tuple(returns)
+
   def _parse_abi_dict(self, vm_function: VmFunction):
     reflection = vm_function.reflection
+    self._is_coarse_fences = (
+        reflection.get("iree.abi.model") == "coarse-fences")
     abi_json = reflection.get("iree.abi")
     if abi_json is None:
       # It is valid to have no reflection data, and rely on pure dynamic
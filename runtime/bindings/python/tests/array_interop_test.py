@@ -164,5 +164,53 @@ class DeviceHalTest(unittest.TestCase):
     np.testing.assert_array_equal(ary.to_host(), init_ary)
 
 
+  def _aligned_zeros(self, shape, dtype, offset=0):
+    # Allocates an array at |offset| bytes past a 64 byte aligned address.
+    dtype = np.dtype(dtype)
+    byte_length = int(np.prod(shape)) * dtype.itemsize
+    raw = np.zeros([byte_length + 128], dtype=np.uint8)
+    start = (-raw.ctypes.data) % 64 + offset
+    return raw[start:start + byte_length].view(dtype).reshape(shape)
+
+  def testImportZeroCopy(self):
+    init_ary = self._aligned_zeros([3, 4], np.int32)
+    ary = iree.runtime.asdevicearray(self.device, init_ary, copy=False)
+    # The device array aliases the host memory.
+    init_ary[1, 2] = 42
+    self.assertEqual(42, ary.to_host()[1, 2])
+    # And keeps it alive.
+    init_ary = None
+    gc.collect()
+    self.assertEqual(42, ary.to_host()[1, 2])
+
+  def testImportUnalignedCopies(self):
+    init_ary = self._aligned_zeros([3, 4], np.int32, offset=4)
+    ary = iree.runtime.asdevicearray(self.device, init_ary, copy=False)
+    init_ary[1, 2] = 42
+    self.assertEqual(0, ary.to_host()[1, 2])
+
+  def testDefaultCopies(self):
+    init_ary = self._aligned_zeros([3, 4], np.int32)
+    ary = iree.runtime.asdevicearray(self.device, init_ary)
+    init_ary[1, 2] = 42
+    self.assertEqual(0, ary.to_host()[1, 2])
+
+  def testDlpackExport(self):
+    init_ary = np.arange(12, dtype=np.float32).reshape([3, 4])
+    ary = iree.runtime.asdevicearray(self.device, init_ary)
+    self.assertEqual((1, 0), ary.__dlpack_device__())
+    host_ary = np.from_dlpack(ary)
+    np.testing.assert_array_equal(init_ary, host_ary)
+    # The exported array aliases the mapped device memory.
+    self.assertEqual(host_ary.ctypes.data, ary.to_host().ctypes.data)
+
+  def testDlpackImport(self):
+    init_ary = self._aligned_zeros([3, 4], np.float32)
+    ary = iree.runtime.from_dlpack(self.device, init_ary)
+    self.assertIsInstance(ary, iree.runtime.DeviceArray)
+    init_ary[0, 1] = 3.0
+    self.assertEqual(3.0, ary.to_host()[0, 1])
+
+
 if __name__ == "__main__":
   unittest.main()
@@ -4,6 +4,7 @@
 # See https://llvm.org/LICENSE.txt for license information.
 # SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+import asyncio
 import json
 import numpy as np
 import unittest
@@ -590,5 +591,41 @@ class FunctionTest(unittest.TestCase):
     self.assertEqual("[1, 2]", repr(result))
 
 
+  def testInvokeAsync(self):
+
+    def invoke(arg_list, ret_list):
+      ret_list.push_int(3)
+      ret_list.push_int(4)
+
+    vm_context = MockVmContext(invoke)
+    vm_function = MockVmFunction(reflection={})
+    invoker = FunctionInvoker(vm_context, self.device, vm_function, tracer=None)
+    result = asyncio.run(invoker.invoke_async(1, 2))
+    self.assertEqual("[<VmVariantList(2): [1, 2]>]", vm_context.mock_arg_reprs)
+    self.assertEqual((3, 4), result)
+
+  def testInvokeAsyncCoarseFences(self):
+
+    def invoke(arg_list, ret_list):
+      # Signal fence is appended after the wait fence.
+      self.assertEqual(4, len(arg_list))
+      signal_fence = arg_list.get_as_object(3, rt.HalFence)
+      ret_list.push_int(3)
+      signal_fence.signal()
+
+    vm_context = MockVmContext(invoke)
+    vm_function = MockVmFunction(reflection={"iree.abi.model": "coarse-fences"})
+    invoker = FunctionInvoker(vm_context, self.device, vm_function, tracer=None)
+    result = asyncio.run(invoker.invoke_async(1, 2))
+    self.assertEqual(3, result)
+
+  def testInvokeAsyncWaitFenceRequiresCoarseFences(self):
+    vm_context = MockVmContext(lambda arg_list, ret_list: None)
+    vm_function = MockVmFunction(reflection={})
+    invoker = FunctionInvoker(vm_context, self.device, vm_function, tracer=None)
+    with self.assertRaises(ValueError):
+      asyncio.run(invoker.invoke_async(1, wait_fence=rt.HalFence()))
+
+
 if __name__ == "__main__":
   unittest.main()
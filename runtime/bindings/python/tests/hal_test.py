@@ -143,5 +143,31 @@ class DeviceHalTest(unittest.TestCase):
     )
 
 
+  def testSemaphore(self):
+    sem = self.device.create_semaphore(1)
+    self.assertEqual(1, sem.query())
+    sem.signal(2)
+    self.assertEqual(2, sem.query())
+    self.assertTrue(sem.wait(2))
+    self.assertFalse(sem.wait(3, timeout_ms=0))
+
+  def testFence(self):
+    sem = self.device.create_semaphore(0)
+    fence = iree.runtime.HalFence.create_at(sem, 1)
+    self.assertEqual(1, fence.timepoint_count)
+    self.assertFalse(fence.query())
+    self.assertFalse(fence.wait(timeout_ms=0))
+    fence.signal()
+    self.assertTrue(fence.query())
+    self.assertTrue(fence.wait())
+    self.assertEqual(1, sem.query())
+
+  def testEmptyFence(self):
+    fence = iree.runtime.HalFence()
+    self.assertEqual(0, fence.timepoint_count)
+    self.assertTrue(fence.query())
+    self.assertTrue(fence.wait())
+
+
 if __name__ == "__main__":
   unittest.main()
@@ -156,10 +156,10 @@ static iree_status_t _TfLiteInterpreterShapeFrameApply(
   // Populate shape_list with the shape dimensions for this particular output.
   iree_vm_value_t index_value = iree_vm_value_make_i32(index);
   IREE_IGNORE_ERROR(iree_vm_list_set_value(frame->arg_list, 0, &index_value));
-  return iree_vm_invoke(interpreter->context, apply_fn,
-                        IREE_VM_INVOCATION_FLAG_NONE,
-                        /*policy=*/NULL, frame->arg_list, /*outputs=*/NULL,
-                        interpreter->allocator);
+  return iree_vm_invoke_with_context(
+      interpreter->invoke_context, interpreter->context, apply_fn,
+      IREE_VM_INVOCATION_FLAG_NONE,
+      /*policy=*/NULL, frame->arg_list, /*outputs=*/NULL);
 }
 
 //===----------------------------------------------------------------------===//
@@ -198,23 +198,54 @@ static iree_status_t _TfLiteInterpreterRefreshOutputShapes(
   return iree_ok_status();
 }
 
+// Returns a fingerprint of all input tensor shapes (FNV-1a over ranks/dims).
+static uint64_t _TfLiteInterpreterFingerprintInputShapes(
+    const TfLiteInterpreter* interpreter) {
+  uint64_t hash = 0xCBF29CE484222325ull;
+  for (int32_t i = 0; i < interpreter->model->input_count; ++i) {
+    const TfLiteTensor* tensor = &interpreter->input_tensors[i];
+    hash = (hash ^ (uint32_t)tensor->shape_rank) * 0x100000001B3ull;
+    for (int32_t j = 0; j < tensor->shape_rank; ++j) {
+      hash = (hash ^ (uint32_t)tensor->shape_dims[j]) * 0x100000001B3ull;
+    }
+  }
+  return hash;
+}
+
 // Refreshes both input and output tensor shapes by querying the module.
 // This should be called after each shape change so that we can let the module
 // run "shape propagation" and compute the new output shapes.
+//
+// The shape functions only depend on the module shape state and not on tensor
+// contents, so results are memoized: this is a no-op until an input is resized
+// and output shapes are only re-queried if the resulting input shapes differ
+// from those they were last computed with.
 static iree_status_t _TfLiteInterpreterRefreshIOShapes(
     TfLiteInterpreter* interpreter) {
+  if (interpreter->io_shapes_valid) return iree_ok_status();
   IREE_TRACE_ZONE_BEGIN(z0);
   _TfLiteInterpreterShapeFrame frame;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
       z0, _TfLiteInterpreterShapeFrameInitialize(&frame));
 
-  // Query all shapes.
-  iree_status_t status = iree_ok_status();
-  if (iree_status_is_ok(status)) {
-    status = _TfLiteInterpreterRefreshInputShapes(interpreter, &frame);
-  }
+  // Query all input shapes; some may be resolved by the module.
+  iree_status_t status =
+      _TfLiteInterpreterRefreshInputShapes(interpreter, &frame);
+
+  // Query output shapes only if the input shapes changed since the last query
+  // (for example a resize to a new shape and back again is free).
   if (iree_status_is_ok(status)) {
-    status = _TfLiteInterpreterRefreshOutputShapes(interpreter, &frame);
+    uint64_t fingerprint =
+        _TfLiteInterpreterFingerprintInputShapes(interpreter);
+    bool outputs_stale = interpreter->io_shapes_fingerprint == 0 ||
+                         interpreter->io_shapes_fingerprint != fingerprint;
+    if (outputs_stale) {
+      status = _TfLiteInterpreterRefreshOutputShapes(interpreter, &frame);
+    }
+    if (iree_status_is_ok(status)) {
+      interpreter->io_shapes_fingerprint = fingerprint;
+      interpreter->io_shapes_valid = true;
+    }
   }
 
   _TfLiteInterpreterShapeFrameDeinitialize(&frame);
@@ -374,6 +405,8 @@ static iree_status_t _TfLiteInterpreterCreate(
       interpreter->instance, IREE_VM_CONTEXT_FLAG_NONE,
       IREE_ARRAYSIZE(interpreter->all_modules), interpreter->all_modules,
       interpreter->allocator, &interpreter->context));
+  IREE_RETURN_IF_ERROR(iree_vm_invoke_context_create(
+      interpreter->allocator, &interpreter->invoke_context));
 
   // Setup all I/O tensors and buffer views.
   IREE_RETURN_IF_ERROR(_TfLiteInterpreterPopulateIO(interpreter));
@@ -424,6 +457,7 @@ TFL_CAPI_EXPORT extern void TfLiteInterpreterDelete(
   iree_vm_list_deinitialize(interpreter->input_list);
   iree_vm_list_deinitialize(interpreter->output_list);
 
+  iree_vm_invoke_context_release(interpreter->invoke_context);
   iree_vm_context_release(interpreter->context);
   iree_vm_module_release(interpreter->hal_module);
   iree_vm_module_release(interpreter->user_module);
@@ -446,10 +480,10 @@ TFL_CAPI_EXPORT extern TfLiteStatus TfLiteInterpreterResetVariableTensors(
   iree_vm_function_t reset_variables_fn =
       interpreter->model->exports._reset_variables;
   if (!iree_vm_function_is_null(reset_variables_fn)) {
-    status = iree_vm_invoke(interpreter->context, reset_variables_fn,
-                            IREE_VM_INVOCATION_FLAG_NONE,
-                            /*policy=*/NULL, /*inputs=*/NULL, /*outputs=*/NULL,
-                            interpreter->allocator);
+    status = iree_vm_invoke_with_context(
+        interpreter->invoke_context, interpreter->context, reset_variables_fn,
+        IREE_VM_INVOCATION_FLAG_NONE,
+        /*policy=*/NULL, /*inputs=*/NULL, /*outputs=*/NULL);
   }
 
   IREE_TRACE_ZONE_END(z0);
@@ -484,19 +518,44 @@ static iree_status_t _TfLiteInterpreterResizeInputTensor(
                             "model has no dynamic shapes");
   }
 
+  if (input_dims_size < 0 || input_dims_size > IREE_BINDINGS_TFLITE_MAX_RANK) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "input rank %d out of range (0 <= rank <= %d)",
+                            input_dims_size, IREE_BINDINGS_TFLITE_MAX_RANK);
+  }
+
+  // Resizing to the current shape is a no-op and keeps any memoized shapes.
+  TfLiteTensor* tensor = &interpreter->input_tensors[input_index];
+  int32_t shape_dims[IREE_BINDINGS_TFLITE_MAX_RANK];
+  bool shape_changed = tensor->shape_rank != input_dims_size;
+  for (int32_t i = 0; i < input_dims_size; ++i) {
+    shape_dims[i] = (int32_t)input_dims[i];
+    shape_changed |= i >= tensor->shape_rank ||
+                     tensor->shape_dims[i] != shape_dims[i];
+  }
+  if (!shape_changed) return iree_ok_status();
+
   _TfLiteInterpreterShapeFrame frame;
   IREE_RETURN_IF_ERROR(_TfLiteInterpreterShapeFrameInitialize(&frame));
 
   // Poke the model and let it update its internal shape.
   // TODO(#3975): return bool to allow model to say it failed.
-  TfLiteTensor* tensor = &interpreter->input_tensors[input_index];
   iree_status_t status = _TfLiteInterpreterShapeFrameWriteValue(
-      &frame, tensor->shape_rank, tensor->shape_dims);
+      &frame, input_dims_size, shape_dims);
   if (iree_status_is_ok(status)) {
     status = _TfLiteInterpreterShapeFrameApply(
         &frame, interpreter, interpreter->model->exports._resize_input_shape,
         input_index);
   }
+  if (iree_status_is_ok(status)) {
+    tensor->shape_rank = input_dims_size;
+    memcpy(tensor->shape_dims, shape_dims,
+           input_dims_size * sizeof(tensor->shape_dims[0]));
+  }
+
+  // Module shape state may have changed (even on failure) so shapes must be
+  // re-queried.
+  interpreter->io_shapes_valid = false;
 
   // NOTE: the allocation may now not match the requested shape. This is just
   // how the tflite API works unfortunately; until
@@ -516,6 +575,51 @@ TFL_CAPI_EXPORT extern TfLiteStatus TfLiteInterpreterResizeInputTensor(
   return _TfLiteStatusFromIREEStatus(status);
 }
 
+static iree_status_t _TfLiteInterpreterSetCustomAllocationForTensor(
+    TfLiteInterpreter* interpreter, int tensor_index,
+    const TfLiteCustomAllocation* allocation) {
+  if (tensor_index < 0 || tensor_index >= interpreter->model->input_count) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "tensor_index out of range (0 <= %d < %d); only "
+                            "input tensors support custom allocations",
+                            tensor_index, interpreter->model->input_count);
+  }
+  TfLiteTensor* tensor = &interpreter->input_tensors[tensor_index];
+  bool was_allocated = tensor->buffer != NULL;
+  IREE_RETURN_IF_ERROR(_TfLiteTensorSetCustomAllocation(tensor, allocation));
+  if (!was_allocated || tensor->buffer) return iree_ok_status();
+
+  // Tensors are already allocated: swap in the new buffer so that the next
+  // invocation uses it without another TfLiteInterpreterAllocateTensors.
+  iree_status_t status = _TfLiteTensorReallocateIfNeeded(
+      tensor, iree_hal_device_allocator(interpreter->device),
+      interpreter->allocator);
+  if (iree_status_is_ok(status) &&
+      (iree_host_size_t)tensor_index <
+          iree_vm_list_size(interpreter->input_list)) {
+    iree_vm_ref_t buffer_ref = iree_hal_buffer_retain_ref(tensor->buffer);
+    status = iree_vm_list_set_ref_move(interpreter->input_list, tensor_index,
+                                       &buffer_ref);
+  }
+  if (!iree_status_is_ok(status)) {
+    // Don't invoke with the stale buffer; the tensors must be reallocated.
+    iree_status_ignore(iree_vm_list_resize(interpreter->input_list, 0));
+  }
+  return status;
+}
+
+TFL_CAPI_EXPORT extern TfLiteStatus
+TfLiteInterpreterSetCustomAllocationForTensor(
+    TfLiteInterpreter* interpreter, int tensor_index,
+    const TfLiteCustomAllocation* allocation, int64_t flags) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  // NOTE: flags are ignored as the alignment is always required.
+  iree_status_t status = _TfLiteInterpreterSetCustomAllocationForTensor(
+      interpreter, tensor_index, allocation);
+  IREE_TRACE_ZONE_END(z0);
+  return _TfLiteStatusFromIREEStatus(status);
+}
+
 static iree_status_t _TfLiteInterpreterAllocateTensors(
     TfLiteInterpreter* interpreter) {
   // NOTE: we could slab allocate like tflite does, but then if any single
@@ -543,8 +647,9 @@ static iree_status_t _TfLiteInterpreterAllocateTensors(
   }
 
   // TODO(benvanik): preallocate outputs when we support using them.
-  // We could stash the buffer views in interpreter->output_list.
-  // For now we just drop them all.
+  // Output buffers are owned by the module and bound after each invocation;
+  // they stay mapped across invocations for as long as the module keeps
+  // returning the same buffers (see _TfLiteTensorBind).
   for (iree_host_size_t i = 0; i < interpreter->model->output_count; ++i) {
     _TfLiteTensorDiscardBuffer(&interpreter->output_tensors[i]);
   }
@@ -574,14 +679,18 @@ TFL_CAPI_EXPORT extern TfLiteStatus TfLiteInterpreterAllocateTensors(
 static iree_status_t _TfLiteInterpreterInvoke(TfLiteInterpreter* interpreter) {
   // tflite models only have a single entry point and the IREE converter
   // emits it as '_main'.
-  IREE_RETURN_IF_ERROR(
-      iree_vm_invoke(interpreter->context, interpreter->model->exports._main,
-                     IREE_VM_INVOCATION_FLAG_NONE,
-                     /*policy=*/NULL, interpreter->input_list,
-                     interpreter->output_list, interpreter->allocator));
-
-  // Refresh output shapes.
-  // TODO(#3975): just use buffer view results or at least just refresh outputs.
+  // The input list is populated once by TfLiteInterpreterAllocateTensors and
+  // references the persistently mapped input buffers, so there's no staging
+  // of input data here. The invoke context and output list are reused so that
+  // steady state invocations don't allocate.
+  IREE_RETURN_IF_ERROR(iree_vm_invoke_with_context(
+      interpreter->invoke_context, interpreter->context,
+      interpreter->model->exports._main, IREE_VM_INVOCATION_FLAG_NONE,
+      /*policy=*/NULL, interpreter->input_list, interpreter->output_list));
+
+  // Refresh output shapes; this is a no-op unless inputs were resized since
+  // the last TfLiteInterpreterAllocateTensors.
+  // TODO(#3975): just use buffer view results.
   IREE_RETURN_IF_ERROR(_TfLiteInterpreterRefreshIOShapes(interpreter));
 
   // Map the output buffers.
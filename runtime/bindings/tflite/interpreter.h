@@ -38,11 +38,19 @@ struct TfLiteInterpreter {
     iree_vm_module_t* all_modules[2];
   };
   iree_vm_context_t* context;
+  // Reused for all invocations so that steady state invokes don't allocate.
+  iree_vm_invoke_context_t* invoke_context;
 
   iree_vm_list_t* input_list;
   iree_vm_list_t* output_list;
   TfLiteTensor* input_tensors;
   TfLiteTensor* output_tensors;
+
+  // True if the I/O tensor shapes reflect the current module shape state.
+  // Cleared when an input is resized to a different shape.
+  bool io_shapes_valid;
+  // Fingerprint of the input shapes the output shapes were last queried with.
+  uint64_t io_shapes_fingerprint;
 };
 
 #endif  // IREE_BINDINGS_TFLITE_INTERPRETER_H_
@@ -200,6 +200,10 @@ public final class Interpreter implements AutoCloseable {
    * <p>Note: that the number of elements in single/multi arrays should match the tensor's {@link
    * Tensor#numElements()} output, else inference will fail.
    *
+   * <p>Direct buffers passed as inputs are imported as the input storage without any copies and
+   * must not be modified until the run returns. The views returned by {@link Tensor#buffer()} can
+   * be passed as inputs and outputs to avoid copies entirely.
+   *
    * @param input a {@link java.nio.Buffer} with correct capacity populated with tensor input.
    * @param output an empty {@link java.nio.Buffer} to be filled with tensor output. The caller must
    *     ensure that it is set to the appropriate write position and remaining capacity.
@@ -298,6 +302,8 @@ public final class Interpreter implements AutoCloseable {
    *     number of model inputs; or if error occurs when resizing the specified input.
    */
   public void resizeInput(int inputIndex, @NonNull int[] dims) {
+    // The imported buffer would no longer match the size of the input.
+    getInputTensor(inputIndex).unbindDirectBuffer();
     if (nativeResizeInputTensor(inputIndex, dims) != 0) {
       throw new IllegalArgumentException("Unable to resize to input tensor.");
     }
@@ -30,7 +30,7 @@ public final class Tensor {
     if (nativeAddress == 0) {
       throw new RuntimeException(String.format("Failed to create input tensor %d", tensorIndex));
     }
-    return new Tensor(nativeAddress, tensorIndex);
+    return new Tensor(nativeInterpreterHandle, nativeAddress, tensorIndex, /*isInput=*/true);
   }
 
   static Tensor outputFromIndex(long nativeInterpreterHandle, int tensorIndex) {
@@ -38,7 +38,7 @@ public final class Tensor {
     if (nativeAddress == 0) {
       throw new RuntimeException(String.format("Failed to create output tensor %d", tensorIndex));
     }
-    return new Tensor(nativeAddress, tensorIndex);
+    return new Tensor(nativeInterpreterHandle, nativeAddress, tensorIndex, /*isInput=*/false);
   }
 
   /**
@@ -162,19 +162,50 @@ public final class Tensor {
     return quantizationParams;
   }
 
+  /**
+   * Returns a direct {@link ByteBuffer} in native byte order viewing the tensor storage.
+   *
+   * <p>Inputs written to and outputs read from the view are not copied. The view remains valid
+   * until the tensors are reallocated or the storage of an output changes; call again after
+   * {@link Interpreter#allocateTensors} or a run to get an up-to-date view. Passing the view to
+   * {@link Interpreter#run} performs no copies.
+   */
+  public ByteBuffer buffer() {
+    long dataAddress = nativeDataAddress();
+    if (dataAddress == 0) {
+      throw new IllegalStateException(
+          String.format("Tensor(%d) has no storage; tensors must be allocated", tensorIndex));
+    }
+    if (view == null || dataAddress != viewAddress || numBytes() != view.capacity()) {
+      view = getNativeBuffer();
+      viewAddress = dataAddress;
+    }
+    view.rewind();
+    return view;
+  }
+
   void copyFromBuffer(Buffer inputBuffer) {
     checkBufferCapacity(inputBuffer);
+    if (isView(inputBuffer)) {
+      return;  // Written in place.
+    }
     if (isDirectBuffer(inputBuffer)) {
+      // Import the buffer memory as the input storage so that it is read without any copies.
+      // Memory that can't be imported (such as unaligned buffers) is copied instead.
+      if (inputBuffer == boundBuffer || bindDirectBuffer(inputBuffer)) {
+        return;
+      }
       copyFromDirectBuffer(inputBuffer);
     } else {
+      unbindDirectBuffer();
       if (inputBuffer instanceof ByteBuffer) {
-        ((ByteBuffer) inputBuffer).put(getNativeBuffer());
+        getNativeBuffer().put((ByteBuffer) inputBuffer);
       } else if (inputBuffer instanceof FloatBuffer) {
-        ((FloatBuffer) inputBuffer).put(getNativeBuffer().asFloatBuffer());
+        getNativeBuffer().asFloatBuffer().put((FloatBuffer) inputBuffer);
       } else if (inputBuffer instanceof IntBuffer) {
-        ((IntBuffer) inputBuffer).put(getNativeBuffer().asIntBuffer());
+        getNativeBuffer().asIntBuffer().put((IntBuffer) inputBuffer);
       } else if (inputBuffer instanceof LongBuffer) {
-        ((LongBuffer) inputBuffer).put(getNativeBuffer().asLongBuffer());
+        getNativeBuffer().asLongBuffer().put((LongBuffer) inputBuffer);
       } else {
         throw new IllegalArgumentException(
             "Unexpected input buffer type: " + inputBuffer.getClass());
@@ -184,6 +215,9 @@ public final class Tensor {
 
   void copyToBuffer(Buffer outputBuffer) {
     checkBufferCapacity(outputBuffer);
+    if (isView(outputBuffer)) {
+      return;  // Read in place.
+    }
     if (isDirectBuffer(outputBuffer)) {
       copyToDirectBuffer(outputBuffer);
     } else {
@@ -202,6 +236,43 @@ public final class Tensor {
     }
   }
 
+  /**
+   * Drops the direct buffer imported as the input storage, if any, returning the tensor to storage
+   * owned by the interpreter.
+   */
+  void unbindDirectBuffer() {
+    if (boundBuffer == null) {
+      return;
+    }
+    boundBuffer = null;
+    // Failing to unbind leaves the interpreter needing reallocation, which run reports.
+    nativeSetDirectBuffer(nativeInterpreterHandle, tensorIndex, null);
+  }
+
+  private boolean isView(Buffer otherBuffer) {
+    if (view == null || otherBuffer != view) {
+      return false;
+    }
+    if (viewAddress != nativeDataAddress()) {
+      throw new IllegalStateException(String.format(
+          "Buffer view of Tensor(%d) is stale; the tensor storage has changed", tensorIndex));
+    }
+    return true;
+  }
+
+  private boolean bindDirectBuffer(Buffer inputBuffer) {
+    if (!isInput) {
+      return false;
+    }
+    unbindDirectBuffer();
+    if (nativeSetDirectBuffer(nativeInterpreterHandle, tensorIndex, inputBuffer) != 0) {
+      return false;
+    }
+    // Keeps the memory alive for as long as it is imported.
+    boundBuffer = inputBuffer;
+    return true;
+  }
+
   private boolean isDirectBuffer(Buffer object) {
     if (object instanceof ByteBuffer) {
       ByteBuffer buffer = (ByteBuffer) object;
@@ -265,14 +336,25 @@ public final class Tensor {
     return nativeGetByteBuffer().order(ByteOrder.nativeOrder());
   }
 
+  private final long nativeInterpreterHandle;
   private final long nativeAddress;
   private final int tensorIndex;
+  private final boolean isInput;
   private final QuantizationParams quantizationParams;
   private final int shapeSignature[];
 
-  private Tensor(long nativeAddress, int tensorIndex) {
+  // Direct buffer imported as the input storage, if any.
+  private Buffer boundBuffer;
+  // Cached view of the tensor storage returned by buffer() and the address it views.
+  private ByteBuffer view;
+  private long viewAddress;
+
+  private Tensor(long nativeInterpreterHandle, long nativeAddress, int tensorIndex,
+      boolean isInput) {
+    this.nativeInterpreterHandle = nativeInterpreterHandle;
     this.nativeAddress = nativeAddress;
     this.tensorIndex = tensorIndex;
+    this.isInput = isInput;
     this.quantizationParams =
         new QuantizationParams(nativeQuantizationScale(), nativeQuantizationZeroPoint());
     this.shapeSignature = shape();
@@ -301,4 +383,9 @@ public final class Tensor {
   private native int nativeCopyToDirectBuffer(Buffer outputByteBuffer);
 
   private native ByteBuffer nativeGetByteBuffer();
+
+  private native long nativeDataAddress();
+
+  private static native int nativeSetDirectBuffer(
+      long interpreterAddress, int inputIndex, Buffer inputByteBuffer);
 }
@@ -11,6 +11,7 @@
 // NOTE: we pull in our own copy here in case the tflite API changes upstream.
 #define TFL_COMPILE_LIBRARY 1
 #include "runtime/bindings/tflite/include/tensorflow/lite/c/c_api.h"
+#include "runtime/bindings/tflite/include/tensorflow/lite/c/c_api_experimental.h"
 
 #define JNI_FUNC extern "C" JNIEXPORT
 #define JNI_PREFIX(METHOD) Java_org_tensorflow_lite_Tensor_##METHOD
@@ -162,3 +163,36 @@ JNI_FUNC jobject JNI_PREFIX(nativeGetByteBuffer)(JNIEnv* env, jobject thiz) {
       static_cast<void*>(TfLiteTensorData(tensor)),
       static_cast<jlong>(TfLiteTensorByteSize(tensor)));
 }
+
+JNI_FUNC jlong JNI_PREFIX(nativeDataAddress)(JNIEnv* env, jobject thiz) {
+  TfLiteTensor* tensor = GetTensor(env, thiz);
+  if (!tensor) {
+    return 0;  // Failed get handle. Returning to error in Java.
+  }
+  return reinterpret_cast<jlong>(TfLiteTensorData(tensor));
+}
+
+JNI_FUNC jint JNI_PREFIX(nativeSetDirectBuffer)(JNIEnv* env, jclass clazz,
+                                                jlong interpreter_handle,
+                                                jint input_index,
+                                                jobject input_byte_buffer) {
+  TfLiteInterpreter* interpreter = (TfLiteInterpreter*)interpreter_handle;
+  if (!interpreter) {
+    return kTfLiteError;  // Null handle input. Returning to error in Java.
+  }
+  const TfLiteTensor* tensor =
+      TfLiteInterpreterGetInputTensor(interpreter, input_index);
+  if (!tensor) {
+    return kTfLiteError;  // Invalid index. Returning to error in Java.
+  }
+
+  // A null buffer returns the tensor to storage owned by the interpreter.
+  // The Java object keeps the buffer alive for as long as it is imported.
+  TfLiteCustomAllocation allocation = {nullptr, 0};
+  if (input_byte_buffer) {
+    allocation.data = env->GetDirectBufferAddress(input_byte_buffer);
+    allocation.bytes = TfLiteTensorByteSize(tensor);
+  }
+  return (jint)TfLiteInterpreterSetCustomAllocationForTensor(
+      interpreter, input_index, &allocation, kTfLiteCustomAllocationFlagsNone);
+}
@@ -30,6 +30,7 @@ limitations under the License.
 // NOTE: we pull in our own copy here in case the tflite API changes upstream.
 #define TFL_COMPILE_LIBRARY 1
 #include "runtime/bindings/tflite/include/tensorflow/lite/c/c_api.h"
+#include "runtime/bindings/tflite/include/tensorflow/lite/c/c_api_experimental.h"
 
 // Test model is available both on the filesystem and here for embedding testing
 // embedding the module directly in a binary.
@@ -131,6 +132,24 @@ TEST(CApiSimple, DISABLED_DynamicSmoke) {
   EXPECT_EQ(output[0], 3.f);
   EXPECT_EQ(output[1], 9.f);
 
+  // Resizing to the same shape and invoking again writes through the same
+  // persistently mapped input storage and produces the same shapes/results.
+  void* input_data = TfLiteTensorData(input_tensor);
+  ASSERT_EQ(TfLiteInterpreterResizeInputTensor(
+                interpreter, 0, input_dims.data(), input_dims.size()),
+            kTfLiteOk);
+  ASSERT_EQ(TfLiteInterpreterAllocateTensors(interpreter), kTfLiteOk);
+  EXPECT_EQ(TfLiteTensorData(input_tensor), input_data);
+  ASSERT_EQ(TfLiteInterpreterInvoke(interpreter), kTfLiteOk);
+  output_tensor = TfLiteInterpreterGetOutputTensor(interpreter, 0);
+  EXPECT_EQ(TfLiteTensorNumDims(output_tensor), 1);
+  EXPECT_EQ(TfLiteTensorDim(output_tensor, 0), 2);
+  ASSERT_EQ(TfLiteTensorCopyToBuffer(output_tensor, output.data(),
+                                     output.size() * sizeof(float)),
+            kTfLiteOk);
+  EXPECT_EQ(output[0], 3.f);
+  EXPECT_EQ(output[1], 9.f);
+
   TfLiteInterpreterDelete(interpreter);
 }
 
@@ -214,6 +233,64 @@ TEST(CApiSimple, StaticSmoke) {
   TfLiteInterpreterDelete(interpreter);
 }
 
+TEST(CApiSimple, StaticCustomAllocation) {
+  TfLiteModel* model =
+      TfLiteModelCreate(IREE_BINDINGS_TFLITE_TESTDATA_ADD_STATIC_EMBEDDED_DATA,
+                        IREE_BINDINGS_TFLITE_TESTDATA_ADD_STATIC_EMBEDDED_SIZE);
+  ASSERT_NE(model, nullptr);
+  TfLiteInterpreter* interpreter = TfLiteInterpreterCreate(model, nullptr);
+  ASSERT_NE(interpreter, nullptr);
+  TfLiteModelDelete(model);
+
+  ASSERT_EQ(TfLiteInterpreterAllocateTensors(interpreter), kTfLiteOk);
+  TfLiteTensor* input_tensor = TfLiteInterpreterGetInputTensor(interpreter, 0);
+  ASSERT_NE(input_tensor, nullptr);
+
+  // The user memory is used as the input storage without any copies.
+  alignas(64) float input[1 * 8 * 8 * 3] = {1.f, 3.f};
+  TfLiteCustomAllocation allocation = {input, sizeof(input)};
+  ASSERT_EQ(TfLiteInterpreterSetCustomAllocationForTensor(
+                interpreter, 0, &allocation, kTfLiteCustomAllocationFlagsNone),
+            kTfLiteOk);
+  EXPECT_EQ(TfLiteTensorData(input_tensor), input);
+
+  // Unaligned and undersized memory, and outputs, are rejected.
+  TfLiteCustomAllocation unaligned = {input + 1, sizeof(input)};
+  EXPECT_NE(TfLiteInterpreterSetCustomAllocationForTensor(
+                interpreter, 0, &unaligned, kTfLiteCustomAllocationFlagsNone),
+            kTfLiteOk);
+  EXPECT_NE(TfLiteInterpreterSetCustomAllocationForTensor(
+                interpreter, 1, &allocation, kTfLiteCustomAllocationFlagsNone),
+            kTfLiteOk);
+  EXPECT_EQ(TfLiteTensorData(input_tensor), input);
+
+  ASSERT_EQ(TfLiteInterpreterInvoke(interpreter), kTfLiteOk);
+  const TfLiteTensor* output_tensor =
+      TfLiteInterpreterGetOutputTensor(interpreter, 0);
+  ASSERT_NE(output_tensor, nullptr);
+  const float* output =
+      reinterpret_cast<const float*>(TfLiteTensorData(output_tensor));
+  ASSERT_NE(output, nullptr);
+  EXPECT_EQ(output[0], 2.f);
+  EXPECT_EQ(output[1], 6.f);
+
+  // Writes to the user memory are visible to the next invocation.
+  input[0] = 5.f;
+  ASSERT_EQ(TfLiteInterpreterInvoke(interpreter), kTfLiteOk);
+  output = reinterpret_cast<const float*>(TfLiteTensorData(output_tensor));
+  EXPECT_EQ(output[0], 10.f);
+
+  // Resetting returns the tensor to storage owned by the interpreter.
+  TfLiteCustomAllocation reset = {nullptr, 0};
+  ASSERT_EQ(TfLiteInterpreterSetCustomAllocationForTensor(
+                interpreter, 0, &reset, kTfLiteCustomAllocationFlagsNone),
+            kTfLiteOk);
+  EXPECT_NE(TfLiteTensorData(input_tensor), nullptr);
+  EXPECT_NE(TfLiteTensorData(input_tensor), input);
+
+  TfLiteInterpreterDelete(interpreter);
+}
+
 // TODO(#3971): fix cmake data deps.
 // TODO(#3972): plumb through quantization params.
 TEST(CApiSimple, DISABLED_QuantizationParams) {
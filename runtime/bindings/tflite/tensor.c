@@ -134,18 +134,48 @@ iree_status_t _TfLiteTensorReallocateIfNeeded(
     return iree_ok_status();
   }
 
-  // Allocate the underlying buffer for the tensor.
-  IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_hal_allocator_allocate_buffer(
-              buffer_allocator,
-              (iree_hal_buffer_params_t){
-                  .type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL |
-                          IREE_HAL_MEMORY_TYPE_HOST_VISIBLE,
-                  .usage = IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE |
-                           IREE_HAL_BUFFER_USAGE_TRANSFER |
-                           IREE_HAL_BUFFER_USAGE_MAPPING,
-              },
-              allocation_size, iree_const_byte_span_empty(), &tensor->buffer));
+  // Drop (and unmap) the old buffer, if any, before allocating the new one.
+  _TfLiteTensorDiscardBuffer(tensor);
+
+  // The buffer is host coherent and persistently mapped so that writes through
+  // TfLiteTensorData are directly visible to the device without any staging or
+  // flushes.
+  const iree_hal_buffer_params_t params = {
+      .type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL |
+              IREE_HAL_MEMORY_TYPE_HOST_VISIBLE |
+              IREE_HAL_MEMORY_TYPE_HOST_COHERENT,
+      .usage = IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE |
+               IREE_HAL_BUFFER_USAGE_TRANSFER | IREE_HAL_BUFFER_USAGE_MAPPING |
+               IREE_HAL_BUFFER_USAGE_MAPPING_PERSISTENT,
+  };
+  if (tensor->custom_allocation.data) {
+    // Import the user storage so that the device reads it directly.
+    if (tensor->custom_allocation.bytes < allocation_size) {
+      IREE_TRACE_ZONE_END(z0);
+      return iree_make_status(
+          IREE_STATUS_OUT_OF_RANGE,
+          "custom allocation of %" PRIhsz
+          " bytes is too small for tensor of %" PRIdsz " bytes",
+          (iree_host_size_t)tensor->custom_allocation.bytes, allocation_size);
+    }
+    iree_hal_external_buffer_t external_buffer = {
+        .type = IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION,
+        .flags = IREE_HAL_EXTERNAL_BUFFER_FLAG_NONE,
+        .size = allocation_size,
+        .handle.host_allocation.ptr = tensor->custom_allocation.data,
+    };
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_hal_allocator_import_buffer(
+                buffer_allocator, params, &external_buffer,
+                iree_hal_buffer_release_callback_null(), &tensor->buffer));
+  } else {
+    // Allocate the underlying buffer for the tensor.
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_hal_allocator_allocate_buffer(buffer_allocator, params,
+                                               allocation_size,
+                                               iree_const_byte_span_empty(),
+                                               &tensor->buffer));
+  }
 
   // Map the buffer memory immediately. The tflite API doesn't let us know if
   // this is a buffer the user will actually touch or some state buffer that is
@@ -153,17 +183,47 @@ iree_status_t _TfLiteTensorReallocateIfNeeded(
   // on-demand mapping when the user calls TfLiteTensorData but this at least
   // puts potential errors in the same easy to find place.
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0,
-      iree_hal_buffer_map_range(tensor->buffer, IREE_HAL_MAPPING_MODE_SCOPED,
-                                IREE_HAL_MEMORY_ACCESS_ALL, 0,
-                                IREE_WHOLE_BUFFER, &tensor->buffer_mapping));
+      z0, iree_hal_buffer_map_range(
+              tensor->buffer, IREE_HAL_MAPPING_MODE_PERSISTENT,
+              IREE_HAL_MEMORY_ACCESS_ALL, 0, IREE_WHOLE_BUFFER,
+              &tensor->buffer_mapping));
 
   IREE_TRACE_ZONE_END(z0);
   return iree_ok_status();
 }
 
+iree_status_t _TfLiteTensorSetCustomAllocation(
+    TfLiteTensor* tensor, const TfLiteCustomAllocation* allocation) {
+  TfLiteCustomAllocation custom_allocation = {NULL, 0};
+  if (allocation && allocation->data) custom_allocation = *allocation;
+  if (custom_allocation.data == tensor->custom_allocation.data &&
+      custom_allocation.bytes == tensor->custom_allocation.bytes) {
+    return iree_ok_status();  // unchanged
+  }
+
+  // Imported buffers are used directly by dispatches which assume the
+  // alignment of all bindings; unaligned storage must be copied instead.
+  if (!iree_host_size_has_alignment((uintptr_t)custom_allocation.data,
+                                    IREE_HAL_HEAP_BUFFER_ALIGNMENT)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "custom allocation data must be aligned to %d; "
+                            "got %p",
+                            (int)IREE_HAL_HEAP_BUFFER_ALIGNMENT,
+                            custom_allocation.data);
+  }
+
+  // The new storage is imported (or allocated) on the next reallocation.
+  _TfLiteTensorDiscardBuffer(tensor);
+  tensor->custom_allocation = custom_allocation;
+  return iree_ok_status();
+}
+
 iree_status_t _TfLiteTensorBind(TfLiteTensor* tensor,
                                 iree_hal_buffer_t* buffer) {
+  // Modules may return the same buffer across invocations (such as when
+  // results alias state); keep the existing mapping in that case.
+  if (buffer && buffer == tensor->buffer) return iree_ok_status();
+
   IREE_TRACE_ZONE_BEGIN(z0);
   _TfLiteTensorDiscardBuffer(tensor);
   if (!buffer) {
@@ -197,6 +257,7 @@ void _TfLiteTensorDiscardBuffer(TfLiteTensor* tensor) {
   if (tensor->buffer_mapping.contents.data != NULL) {
     iree_hal_buffer_unmap_range(&tensor->buffer_mapping);
   }
+  memset(&tensor->buffer_mapping, 0, sizeof(tensor->buffer_mapping));
   iree_hal_buffer_release(tensor->buffer);
   tensor->buffer = NULL;
   IREE_TRACE_ZONE_END(z0);
@@ -38,6 +38,10 @@ struct TfLiteTensor {
   iree_hal_buffer_t* buffer;
   // Persistently mapped buffer; invalidated when buffer is resized.
   iree_hal_buffer_mapping_t buffer_mapping;
+
+  // User storage imported as the buffer in place of an allocation, if any.
+  // See TfLiteInterpreterSetCustomAllocationForTensor.
+  TfLiteCustomAllocation custom_allocation;
 };
 
 // Parses a tfl.io.names value and sets the |tensor| name.
@@ -55,11 +59,17 @@ iree_status_t _TfLiteTensorParseQuantAttr(TfLiteTensor* tensor,
 
 // Reallocates and remaps the tensor buffer view if needed.
 // No-op if the buffer view is already allocated and its shape matches the
-// current tensor shape.
+// current tensor shape. Tensors with a custom allocation import it instead.
 iree_status_t _TfLiteTensorReallocateIfNeeded(
     TfLiteTensor* tensor, iree_hal_allocator_t* buffer_allocator,
     iree_allocator_t heap_allocator);
 
+// Sets the user storage imported by _TfLiteTensorReallocateIfNeeded, or
+// resets to runtime-owned storage if |allocation| is NULL or has no data.
+// The current buffer is discarded if the storage changes.
+iree_status_t _TfLiteTensorSetCustomAllocation(
+    TfLiteTensor* tensor, const TfLiteCustomAllocation* allocation);
+
 // Binds the given |buffer| to the tensor and maps it.
 // The tensor shape will be overwritten with the buffer view shape.
 iree_status_t _TfLiteTensorBind(TfLiteTensor* tensor,
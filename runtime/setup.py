@@ -22,7 +22,7 @@
 #
 # Select CMake options are available from environment variables:
 #   IREE_HAL_DRIVER_CUDA
-#   IREE_HAL_DRIVER_VULKAN
+#   IREE_HAL_DRIVER_PIM
 #   IREE_ENABLE_RUNTIME_TRACING
 #   IREE_BUILD_TRACY
 #   IREE_ENABLE_CPUINFO
@@ -237,7 +237,7 @@ def prepare_installation():
         "-DPython3_EXECUTABLE={}".format(sys.executable),
         "-DCMAKE_BUILD_TYPE={}".format(cfg),
         get_env_cmake_option("IREE_HAL_DRIVER_CUDA"),
-        get_env_cmake_option("IREE_HAL_DRIVER_VULKAN",
+        get_env_cmake_option("IREE_HAL_DRIVER_PIM",
                              "OFF" if platform.system() == "Darwin" else "ON"),
         get_env_cmake_option("IREE_ENABLE_RUNTIME_TRACING"),
         get_env_cmake_option("IREE_BUILD_TRACY"),
@@ -254,7 +254,8 @@ typedef IREE_DEVICE_SIZE_T iree_device_size_t;
 #if !defined(IREE_VM_BYTECODE_DISPATCH_COMPUTED_GOTO_ENABLE)
 // Enables the use of compute goto for bytecode dispatch. This can have a
 // moderate performance improvement (~10-20%) on very heavy VMVX workloads but
-// adds 20-30KB to the binary size.
+// adds 20-30KB to the binary size. Requires the labels-as-values extension
+// supported by GCC and clang; other compilers fall back to a switch.
 #define IREE_VM_BYTECODE_DISPATCH_COMPUTED_GOTO_ENABLE 0
 #endif  // IREE_VM_BYTECODE_DISPATCH_COMPUTED_GOTO_ENABLE
 
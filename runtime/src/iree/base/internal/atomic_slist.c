@@ -10,10 +10,235 @@
 
 #include "iree/base/attributes.h"
 
+#if IREE_ATOMIC_SLIST_LOCK_FREE && defined(IREE_COMPILER_MSVC)
+#include <intrin.h>
+#endif  // IREE_ATOMIC_SLIST_LOCK_FREE && IREE_COMPILER_MSVC
+
 // TODO(benvanik): add TSAN annotations when switched to atomics:
 // https://github.com/gcc-mirror/gcc/blob/master/libsanitizer/include/sanitizer/tsan_interface_atomic.h
 // https://reviews.llvm.org/D18500
 
+#if IREE_ATOMIC_SLIST_LOCK_FREE
+
+//===----------------------------------------------------------------------===//
+// Lock-free implementation (double-width CAS)
+//===----------------------------------------------------------------------===//
+
+// Set in the tag while a pop holds the right to remove the head entry. Every
+// modification advances the tag by IREE_ATOMIC_SLIST_TAG_INCREMENT so that the
+// low bits are preserved by pushes racing with the pop.
+#define IREE_ATOMIC_SLIST_TAG_REMOVING ((uintptr_t)1)
+// Set while the removing bit is held to indicate that a thread has parked on
+// iree_atomic_slist_removal_notification and must be woken when it clears.
+#define IREE_ATOMIC_SLIST_TAG_WAITING ((uintptr_t)2)
+#define IREE_ATOMIC_SLIST_TAG_INCREMENT ((uintptr_t)4)
+
+// Number of times a removal spins on a held removing bit before parking.
+// A pop holds the bit only for a single load and exchange so this is almost
+// always enough unless the holder has been descheduled.
+#define IREE_ATOMIC_SLIST_REMOVAL_SPIN_COUNT 128
+
+// Shared by all lists as parking is rare; waiters re-check their own list on
+// wake so spurious wakes from unrelated lists are harmless.
+static iree_notification_t iree_atomic_slist_removal_notification =
+    IREE_NOTIFICATION_INIT;
+
+// Loads the current head. The two words may be torn but any subsequent
+// compare-and-swap will fail and return the true value.
+static inline iree_atomic_slist_head_t iree_atomic_slist_load_head(
+    iree_atomic_slist_t* list) {
+  iree_atomic_slist_head_t head;
+  head.entry = ((volatile iree_atomic_slist_head_t*)&list->head)->entry;
+  head.tag = ((volatile iree_atomic_slist_head_t*)&list->head)->tag;
+  // Pairs with the release in the exchange that published the entry so that
+  // its |next| pointer is visible before we read it.
+  iree_atomic_thread_fence(iree_memory_order_acquire);
+  return head;
+}
+
+// Atomically replaces the list head with |desired| if it matches |expected|.
+// On failure |expected| is updated with the current head. Has acq_rel
+// semantics.
+static inline bool iree_atomic_slist_exchange_head(
+    iree_atomic_slist_t* list, iree_atomic_slist_head_t* expected,
+    iree_atomic_slist_head_t desired) {
+#if defined(IREE_COMPILER_MSVC)
+  return _InterlockedCompareExchange128(
+             (volatile __int64*)&list->head, (__int64)desired.tag,
+             (__int64)desired.entry, (__int64*)expected) != 0;
+#elif defined(IREE_ARCH_X86_64)
+  bool result;
+  __asm__ __volatile__(
+      "lock cmpxchg16b %1\n\t"
+      "sete %0"
+      : "=q"(result), "+m"(list->head), "+a"(expected->entry),
+        "+d"(expected->tag)
+      : "b"(desired.entry), "c"(desired.tag)
+      : "cc", "memory");
+  return result;
+#elif defined(IREE_ARCH_ARM_64)
+  // LDAXP/STLXP are available on all ARMv8.0 cores (CASP requires LSE).
+  iree_atomic_slist_entry_t* current_entry;
+  uintptr_t current_tag;
+  uint32_t store_failed;
+  __asm__ __volatile__(
+      "1:\n\t"
+      "ldaxp %[current_entry], %[current_tag], %[head]\n\t"
+      "cmp %[current_entry], %[expected_entry]\n\t"
+      "ccmp %[current_tag], %[expected_tag], #0, eq\n\t"
+      "b.ne 2f\n\t"
+      "stlxp %w[store_failed], %[desired_entry], %[desired_tag], %[head]\n\t"
+      "cbnz %w[store_failed], 1b\n\t"
+      "b 3f\n\t"
+      "2:\n\t"
+      "clrex\n\t"
+      "3:"
+      : [current_entry] "=&r"(current_entry), [current_tag] "=&r"(current_tag),
+        [store_failed] "=&r"(store_failed), [head] "+Q"(list->head)
+      : [expected_entry] "r"(expected->entry),
+        [expected_tag] "r"(expected->tag),
+        [desired_entry] "r"(desired.entry), [desired_tag] "r"(desired.tag)
+      : "cc", "memory");
+  bool result =
+      current_entry == expected->entry && current_tag == expected->tag;
+  expected->entry = current_entry;
+  expected->tag = current_tag;
+  return result;
+#else
+#error "IREE_ATOMIC_SLIST_LOCK_FREE enabled on an unsupported architecture"
+#endif  // IREE_COMPILER_MSVC / IREE_ARCH_*
+}
+
+// Waits until the removing bit in |head| clears and returns the new head.
+// Spins for a bounded number of iterations and then parks on the removal
+// notification after flagging the head so the holder knows to post it.
+static iree_atomic_slist_head_t iree_atomic_slist_wait_for_removal(
+    iree_atomic_slist_t* list, iree_atomic_slist_head_t head) {
+  for (int i = 0; i < IREE_ATOMIC_SLIST_REMOVAL_SPIN_COUNT; ++i) {
+    iree_processor_yield();
+    head = iree_atomic_slist_load_head(list);
+    if (!(head.tag & IREE_ATOMIC_SLIST_TAG_REMOVING)) return head;
+  }
+  while (head.tag & IREE_ATOMIC_SLIST_TAG_REMOVING) {
+    iree_wait_token_t wait_token =
+        iree_notification_prepare_wait(&iree_atomic_slist_removal_notification);
+    // Reload after preparing so that any release we observe as pending posts
+    // after our token was taken. Flag the head only while the bit is still
+    // held; if the holder releases it first the exchange fails and the loop
+    // observes the cleared bit.
+    head = iree_atomic_slist_load_head(list);
+    iree_atomic_slist_head_t desired = head;
+    desired.tag |= IREE_ATOMIC_SLIST_TAG_WAITING;
+    if ((head.tag & IREE_ATOMIC_SLIST_TAG_REMOVING) &&
+        ((head.tag & IREE_ATOMIC_SLIST_TAG_WAITING) ||
+         iree_atomic_slist_exchange_head(list, &head, desired))) {
+      iree_notification_commit_wait(&iree_atomic_slist_removal_notification,
+                                    wait_token, IREE_DURATION_ZERO,
+                                    IREE_TIME_INFINITE_FUTURE);
+      head = iree_atomic_slist_load_head(list);
+    } else {
+      iree_notification_cancel_wait(&iree_atomic_slist_removal_notification);
+    }
+  }
+  return head;
+}
+
+void iree_atomic_slist_initialize(iree_atomic_slist_t* out_list) {
+  memset(out_list, 0, sizeof(*out_list));
+}
+
+void iree_atomic_slist_deinitialize(iree_atomic_slist_t* list) {
+  // TODO(benvanik): assert empty.
+  memset(list, 0, sizeof(*list));
+}
+
+void iree_atomic_slist_concat(iree_atomic_slist_t* list,
+                              iree_atomic_slist_entry_t* head,
+                              iree_atomic_slist_entry_t* tail) {
+  if (IREE_UNLIKELY(!head)) return;
+  iree_atomic_slist_head_t expected = iree_atomic_slist_load_head(list);
+  iree_atomic_slist_head_t desired;
+  do {
+    tail->next = expected.entry;
+    desired.entry = head;
+    desired.tag = expected.tag + IREE_ATOMIC_SLIST_TAG_INCREMENT;
+  } while (!iree_atomic_slist_exchange_head(list, &expected, desired));
+}
+
+void iree_atomic_slist_push(iree_atomic_slist_t* list,
+                            iree_atomic_slist_entry_t* entry) {
+  iree_atomic_slist_concat(list, entry, entry);
+}
+
+void iree_atomic_slist_push_unsafe(iree_atomic_slist_t* list,
+                                   iree_atomic_slist_entry_t* entry) {
+  // NOTE: no atomic operation is used; the caller must have exclusive access.
+  entry->next = list->head.entry;
+  list->head.entry = entry;
+  list->head.tag += IREE_ATOMIC_SLIST_TAG_INCREMENT;
+}
+
+iree_atomic_slist_entry_t* iree_atomic_slist_pop(iree_atomic_slist_t* list) {
+  // Set the removing bit without changing the head. Waits for any other pop to
+  // finish as it may be reading the head entry.
+  iree_atomic_slist_head_t expected = iree_atomic_slist_load_head(list);
+  iree_atomic_slist_head_t desired;
+  for (;;) {
+    if (!expected.entry) return NULL;
+    if (expected.tag & IREE_ATOMIC_SLIST_TAG_REMOVING) {
+      expected = iree_atomic_slist_wait_for_removal(list, expected);
+      continue;
+    }
+    desired.entry = expected.entry;
+    desired.tag = expected.tag | IREE_ATOMIC_SLIST_TAG_REMOVING;
+    if (iree_atomic_slist_exchange_head(list, &expected, desired)) break;
+  }
+
+  // Only pushes may race with us while the bit is set. They never remove
+  // |expected.entry| so reading its |next| is safe and if one lands first the
+  // exchange fails and we retry with the new (still non-empty) head. Waiters
+  // may also flag the head while we hold the bit and are woken once it clears.
+  expected = desired;
+  do {
+    desired.entry = expected.entry->next;
+    desired.tag = (expected.tag & ~(IREE_ATOMIC_SLIST_TAG_REMOVING |
+                                    IREE_ATOMIC_SLIST_TAG_WAITING)) +
+                  IREE_ATOMIC_SLIST_TAG_INCREMENT;
+  } while (!iree_atomic_slist_exchange_head(list, &expected, desired));
+  if (IREE_UNLIKELY(expected.tag & IREE_ATOMIC_SLIST_TAG_WAITING)) {
+    iree_notification_post(&iree_atomic_slist_removal_notification,
+                           IREE_ALL_WAITERS);
+  }
+  expected.entry->next = NULL;
+  return expected.entry;
+}
+
+// Exchanges the list head with NULL and returns the prior head.
+static iree_atomic_slist_entry_t* iree_atomic_slist_steal(
+    iree_atomic_slist_t* list) {
+  // Waits for any pop that may be reading entries we are about to hand off:
+  // the exchange only succeeds when the removing bit is clear.
+  iree_atomic_slist_head_t expected = iree_atomic_slist_load_head(list);
+  iree_atomic_slist_head_t desired;
+  for (;;) {
+    if (!expected.entry) return NULL;
+    if (expected.tag & IREE_ATOMIC_SLIST_TAG_REMOVING) {
+      expected = iree_atomic_slist_wait_for_removal(list, expected);
+      continue;
+    }
+    desired.entry = NULL;
+    desired.tag = expected.tag + IREE_ATOMIC_SLIST_TAG_INCREMENT;
+    if (iree_atomic_slist_exchange_head(list, &expected, desired)) break;
+  }
+  return expected.entry;
+}
+
+#else
+
+//===----------------------------------------------------------------------===//
+// Mutex-based fallback
+//===----------------------------------------------------------------------===//
+
 void iree_atomic_slist_initialize(iree_atomic_slist_t* out_list) {
   memset(out_list, 0, sizeof(*out_list));
   iree_slim_mutex_initialize(&out_list->mutex);
@@ -61,16 +286,29 @@ iree_atomic_slist_entry_t* iree_atomic_slist_pop(iree_atomic_slist_t* list) {
   return entry;
 }
 
+// Exchanges the list head with NULL and returns the prior head.
+static iree_atomic_slist_entry_t* iree_atomic_slist_steal(
+    iree_atomic_slist_t* list) {
+  iree_slim_mutex_lock(&list->mutex);
+  iree_atomic_slist_entry_t* head = list->head;
+  list->head = NULL;
+  iree_slim_mutex_unlock(&list->mutex);
+  return head;
+}
+
+#endif  // IREE_ATOMIC_SLIST_LOCK_FREE
+
+//===----------------------------------------------------------------------===//
+// Common
+//===----------------------------------------------------------------------===//
+
 bool iree_atomic_slist_flush(iree_atomic_slist_t* list,
                              iree_atomic_slist_flush_order_t flush_order,
                              iree_atomic_slist_entry_t** out_head,
                              iree_atomic_slist_entry_t** out_tail) {
   // Exchange list head with NULL to steal the entire list. The list will be in
   // the native LIFO order of the slist.
-  iree_slim_mutex_lock(&list->mutex);
-  iree_atomic_slist_entry_t* head = list->head;
-  list->head = NULL;
-  iree_slim_mutex_unlock(&list->mutex);
+  iree_atomic_slist_entry_t* head = iree_atomic_slist_steal(list);
   if (!head) return false;
 
   switch (flush_order) {
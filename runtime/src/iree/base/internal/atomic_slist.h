@@ -72,17 +72,67 @@ typedef struct iree_atomic_slist_entry_t {
 //
 // WARNING: this is an extremely sharp pufferfish-esque API. Don't use it. 🐡
 //
+// On x86_64 and aarch64 pushes and concats are lock-free: the head pointer is
+// paired with a modification tag and updated with a double-width
+// compare-and-swap that fails and retries if the head changed in any way since
+// it was loaded. Removals (pop and flush) are serialized by a lock bit in the
+// tag: a pop has to read the |next| pointer of the head entry and if another
+// thread could remove that entry at the same time it could also release its
+// memory (such as iree_arena_block_pool_trim freeing flushed blocks) before the
+// read. Holding the bit keeps the head entry in the list until the pop has
+// exchanged it out so entries can be freed as soon as they have been removed.
+// Removals are therefore not lock-free: a thread that finds the bit held spins
+// a bounded number of times and then parks on an iree_notification_t (futex-
+// backed where available) after flagging the tag so the holder wakes it when
+// releasing the bit. A descheduled holder thus blocks other removals but never
+// leaves them burning a core. The bits live in the tag so that the list stays
+// a single 16-byte unit (worker mailboxes pack several lists into one cache
+// line). Other platforms and TSAN
+// builds (which cannot see through the inline assembly) use a mutex for all
+// operations.
+//
 // TODO(benvanik): verify behavior (and worthwhileness) of supporting platform
 // primitives. The benefit of something like OSAtomicEnqueue/Dequeue is that it
 // may have better tooling (TSAN), special intrinsic handling in the compiler,
 // etc. That said, the Windows Interlocked* variants don't seem to. Having a
 // single heavily tested implementation seems more worthwhile than several.
+#if !defined(IREE_ATOMIC_SLIST_LOCK_FREE)
+#if IREE_SYNCHRONIZATION_DISABLE_UNSAFE || defined(IREE_SANITIZER_THREAD)
+#define IREE_ATOMIC_SLIST_LOCK_FREE 0
+#elif (defined(IREE_ARCH_X86_64) || defined(IREE_ARCH_ARM_64)) && \
+    (defined(IREE_COMPILER_MSVC) || defined(IREE_COMPILER_GCC_COMPAT))
+#define IREE_ATOMIC_SLIST_LOCK_FREE 1
+#else
+#define IREE_ATOMIC_SLIST_LOCK_FREE 0
+#endif  // IREE_ARCH_*
+#endif  // !IREE_ATOMIC_SLIST_LOCK_FREE
+
+#if IREE_ATOMIC_SLIST_LOCK_FREE
+
+// DO NOT USE: implementation detail.
+// The list head and a tag advanced on every modification, exchanged as a
+// single 16-byte unit. The low bit of the tag is set while a pop is removing
+// the head entry and the next bit while another removal is parked waiting on
+// it.
+typedef iree_alignas(16) struct iree_atomic_slist_head_t {
+  iree_atomic_slist_entry_t* entry;
+  uintptr_t tag;
+} iree_atomic_slist_head_t;
+
+typedef iree_alignas(iree_max_align_t) struct {
+  iree_atomic_slist_head_t head;
+} iree_atomic_slist_t;
+
+#else
+
 typedef iree_alignas(iree_max_align_t) struct {
   // TODO(benvanik): spend some time golfing this. Unblocking myself for now :)
   iree_slim_mutex_t mutex;
   iree_atomic_slist_entry_t* head;
 } iree_atomic_slist_t;
 
+#endif  // IREE_ATOMIC_SLIST_LOCK_FREE
+
 // Initializes an slist handle to an empty list.
 // Lists must be flushed to empty and deinitialized when no longer needed with
 // iree_atomic_slist_deinitialize.
@@ -6,6 +6,9 @@
 
 #include "iree/base/internal/atomic_slist.h"
 
+#include <atomic>
+#include <cstdint>
+#include <thread>
 #include <vector>
 
 #include "iree/testing/gtest.h"
@@ -182,4 +185,100 @@ TEST(AtomicSList, FlushFIFO) {
   dummy_slist_deinitialize(&list);
 }
 
+// Entry owned by the stress test. |in_list| is set while the entry is in the
+// list and cleared by whichever thread removes it; removing an entry twice
+// would find it already cleared (or, once freed, trip ASAN).
+struct stress_entry_t {
+  uint64_t value = 0;
+  std::atomic<bool> in_list{false};
+  iree_atomic_slist_intrusive_ptr_t slist_next = NULL;
+};
+IREE_TYPED_ATOMIC_SLIST_WRAPPER(stress, stress_entry_t,
+                                offsetof(stress_entry_t, slist_next));
+
+// Threads concurrently pop, push, and flush entries that are freed as soon as
+// they are removed and replaced with freshly allocated ones. The allocator
+// readily hands the same addresses back so the list sees its heads recycled
+// while other threads are racing to remove them. Every entry must be removed
+// exactly once and the entries left at the end must be exactly those pushed
+// and not yet removed.
+TEST(AtomicSList, ConcurrentStress) {
+  static constexpr int kThreadCount = 8;
+  static constexpr int kIterationCount = 10000;
+  static constexpr int kInitialEntryCount = 64;
+
+  stress_slist_t list;
+  stress_slist_initialize(&list);
+
+  // Each entry gets a unique value so the list contents can be checked by
+  // count and by sum: a lost entry or a duplicated one changes either.
+  std::atomic<uint64_t> next_value{1};
+  std::atomic<int64_t> expected_count{0};
+  std::atomic<uint64_t> expected_sum{0};
+  std::atomic<int> duplicate_count{0};
+  auto push_new_entry = [&]() {
+    stress_entry_t* entry = new stress_entry_t();
+    entry->value = next_value.fetch_add(1);
+    entry->in_list.store(true);
+    expected_count.fetch_add(1);
+    expected_sum.fetch_add(entry->value);
+    stress_slist_push(&list, entry);
+  };
+  auto retire_entry = [&](stress_entry_t* entry) {
+    if (!entry->in_list.exchange(false)) duplicate_count.fetch_add(1);
+    expected_count.fetch_sub(1);
+    expected_sum.fetch_sub(entry->value);
+    delete entry;
+  };
+
+  for (int i = 0; i < kInitialEntryCount; ++i) push_new_entry();
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreadCount; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kIterationCount; ++i) {
+        if ((i + t) % 16 == 0) {
+          // Flush everything, free it, and push as many new entries.
+          stress_entry_t* head = NULL;
+          stress_entry_t* tail = NULL;
+          int flushed_count = 0;
+          if (stress_slist_flush(&list,
+                                 IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_LIFO,
+                                 &head, &tail)) {
+            while (head) {
+              stress_entry_t* next = stress_slist_get_next(head);
+              retire_entry(head);
+              head = next;
+              ++flushed_count;
+            }
+          }
+          for (int j = 0; j < flushed_count; ++j) push_new_entry();
+        } else if (stress_entry_t* entry = stress_slist_pop(&list)) {
+          // Free the entry and push a new one that is likely to reuse its
+          // address.
+          retire_entry(entry);
+          push_new_entry();
+        } else {
+          push_new_entry();
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  EXPECT_EQ(0, duplicate_count.load());
+  int64_t remaining_count = 0;
+  uint64_t remaining_sum = 0;
+  while (stress_entry_t* entry = stress_slist_pop(&list)) {
+    EXPECT_TRUE(entry->in_list.load());
+    ++remaining_count;
+    remaining_sum += entry->value;
+    delete entry;
+  }
+  EXPECT_EQ(expected_count.load(), remaining_count);
+  EXPECT_EQ(expected_sum.load(), remaining_sum);
+
+  stress_slist_deinitialize(&list);
+}
+
 }  // namespace
@@ -16,7 +16,97 @@
 // Platform-specific processor data queries
 //===----------------------------------------------------------------------===//
 
-#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
+#if defined(IREE_ARCH_X86_64)
+
+// x86-64 exposes its features to user mode through CPUID on all platforms.
+// Features using extended register state are only reported when the OS has
+// enabled saving that state (as reported by XGETBV) as otherwise using them
+// would fault.
+
+#if defined(IREE_COMPILER_MSVC)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif  // IREE_COMPILER_MSVC
+
+// Queries |leaf|/|subleaf| into |out_regs| as [eax, ebx, ecx, edx].
+static void iree_cpu_cpuid(uint32_t leaf, uint32_t subleaf,
+                           uint32_t out_regs[4]) {
+#if defined(IREE_COMPILER_MSVC)
+  int regs[4];
+  __cpuidex(regs, (int)leaf, (int)subleaf);
+  for (int i = 0; i < 4; ++i) out_regs[i] = (uint32_t)regs[i];
+#else
+  __cpuid_count(leaf, subleaf, out_regs[0], out_regs[1], out_regs[2],
+                out_regs[3]);
+#endif  // IREE_COMPILER_MSVC
+}
+
+// Returns the XCR0 register. Must only be called if CPUID reports OSXSAVE.
+static uint64_t iree_cpu_xgetbv_xcr0(void) {
+#if defined(IREE_COMPILER_MSVC)
+  return _xgetbv(0);
+#else
+  uint32_t eax = 0, edx = 0;
+  __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return ((uint64_t)edx << 32) | eax;
+#endif  // IREE_COMPILER_MSVC
+}
+
+// OR's |field_bit| into |field_value| if all |bits| are set in |value|.
+#define IREE_SET_IF_ALL_BITS(value, bits, field_value, field_bit) \
+  if (iree_all_bits_set(value, bits)) (field_value) |= (field_bit)
+
+static void iree_cpu_initialize_from_platform(iree_allocator_t temp_allocator,
+                                              uint64_t* out_fields) {
+  uint32_t leaf0[4] = {0};
+  iree_cpu_cpuid(0, 0, leaf0);
+  const uint32_t max_leaf = leaf0[0];
+  if (max_leaf < 7) return;
+  uint32_t leaf1[4] = {0};
+  iree_cpu_cpuid(1, 0, leaf1);
+  uint32_t leaf7[4] = {0};
+  iree_cpu_cpuid(7, 0, leaf7);
+  // Subleaf 1 is only valid if subleaf 0 reports it in EAX.
+  uint32_t leaf7_1[4] = {0};
+  if (leaf7[0] >= 1) iree_cpu_cpuid(7, 1, leaf7_1);
+
+  // Without OS support for saving the extended state none of the AVX
+  // registers may be used.
+  const uint32_t leaf1_ecx_osxsave = 1u << 27;
+  if (!iree_all_bits_set(leaf1[2], leaf1_ecx_osxsave)) return;
+  const uint64_t xcr0 = iree_cpu_xgetbv_xcr0();
+  const uint64_t xcr0_ymm = (1u << 1) | (1u << 2);  // SSE | AVX
+  const uint64_t xcr0_zmm = xcr0_ymm | (1u << 5) | (1u << 6) | (1u << 7);
+  if (!iree_all_bits_set(xcr0, xcr0_ymm)) return;
+
+  const uint32_t leaf1_ecx_fma = 1u << 12;
+  const uint32_t leaf7_ebx_avx2 = 1u << 5;
+  if (iree_all_bits_set(leaf1[2], leaf1_ecx_fma)) {
+    IREE_SET_IF_ALL_BITS(leaf7[1], leaf7_ebx_avx2, out_fields[0],
+                         IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA);
+  }
+
+  if (!iree_all_bits_set(xcr0, xcr0_zmm)) return;
+  const uint32_t leaf7_ebx_avx512_base = (1u << 16) |  // AVX512F
+                                         (1u << 17) |  // AVX512DQ
+                                         (1u << 28) |  // AVX512CD
+                                         (1u << 30) |  // AVX512BW
+                                         (1u << 31);   // AVX512VL
+  const uint32_t leaf7_ecx_avx512_vnni = 1u << 11;
+  const uint32_t leaf7_1_eax_avx512_bf16 = 1u << 5;
+  if (iree_all_bits_set(leaf7[1], leaf7_ebx_avx512_base)) {
+    out_fields[0] |= IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE;
+    IREE_SET_IF_ALL_BITS(leaf7[2], leaf7_ecx_avx512_vnni, out_fields[0],
+                         IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_VNNI);
+    IREE_SET_IF_ALL_BITS(leaf7_1[0], leaf7_1_eax_avx512_bf16, out_fields[0],
+                         IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BF16);
+  }
+}
+
+#undef IREE_SET_IF_ALL_BITS
+
+#elif defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
 
 // NOTE: not all kernel versions have all of the cap bits we need defined so as
 // a practice we always define the feature bits we need locally.
@@ -35,13 +125,19 @@
 
 // https://docs.kernel.org/arm64/elf_hwcaps.html
 #define IREE_HWCAP_ASIMDDP (1 << 20)
+#define IREE_HWCAP_ASIMDFHM (1 << 23)
 #define IREE_HWCAP2_I8MM (1 << 13)
+#define IREE_HWCAP2_BF16 (1 << 14)
 static void iree_cpu_query_data_arch_hwcaps(uint32_t hwcap, uint32_t hwcap2,
                                             uint64_t* out_fields) {
   IREE_SET_IF_HWCAP(hwcap, IREE_HWCAP_ASIMDDP, out_fields[0],
                     IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_DOTPROD);
   IREE_SET_IF_HWCAP(hwcap2, IREE_HWCAP2_I8MM, out_fields[0],
                     IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_I8MM);
+  IREE_SET_IF_HWCAP(hwcap, IREE_HWCAP_ASIMDFHM, out_fields[0],
+                    IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_FP16FML);
+  IREE_SET_IF_HWCAP(hwcap2, IREE_HWCAP2_BF16, out_fields[0],
+                    IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_BF16);
 }
 
 #else
@@ -81,6 +177,10 @@ static void iree_cpu_initialize_from_platform(iree_allocator_t temp_allocator,
                     IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_DOTPROD);
   IREE_QUERY_SYSCTL("hw.optional.arm.FEAT_I8MM", out_fields[0],
                     IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_I8MM);
+  IREE_QUERY_SYSCTL("hw.optional.arm.FEAT_FHM", out_fields[0],
+                    IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_FP16FML);
+  IREE_QUERY_SYSCTL("hw.optional.arm.FEAT_BF16", out_fields[0],
+                    IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_BF16);
 #endif
 }
 
@@ -93,6 +193,92 @@ static void iree_cpu_initialize_from_platform(iree_allocator_t temp_allocator,
 
 #endif  // IREE_PLATFORM_*
 
+//===----------------------------------------------------------------------===//
+// Platform-specific cache size queries
+//===----------------------------------------------------------------------===//
+// Cache sizes are architecture-independent and stored in field 1 in KiB. Any
+// level that cannot be queried is left as zero (unknown).
+
+// OR's |size_bytes| converted to KiB into |field_value| at |shift|.
+static void iree_cpu_set_cache_size(uint64_t size_bytes, int shift,
+                                    uint64_t* field_value) {
+  uint64_t size_kb = size_bytes / 1024;
+  if (size_kb > IREE_CPU_DATA_FIELD_1_CACHE_KB_MASK) {
+    size_kb = IREE_CPU_DATA_FIELD_1_CACHE_KB_MASK;
+  }
+  *field_value |= size_kb << shift;
+}
+
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
+
+#include <unistd.h>
+
+// sysconf returns 0 or -1 when a level is unknown; both are left as zero.
+#define IREE_QUERY_SYSCONF_CACHE(name, shift, field_value)              \
+  do {                                                                  \
+    long result = sysconf(name);                                        \
+    if (result > 0) iree_cpu_set_cache_size(result, shift, field_value); \
+  } while (0)
+
+static void iree_cpu_query_cache_sizes(uint64_t* out_fields) {
+  // The _SC_LEVEL* names are glibc extensions and not present in bionic/musl.
+#if defined(_SC_LEVEL1_DCACHE_SIZE)
+  IREE_QUERY_SYSCONF_CACHE(_SC_LEVEL1_DCACHE_SIZE,
+                           IREE_CPU_DATA_FIELD_1_L1D_CACHE_KB_SHIFT,
+                           &out_fields[1]);
+#endif  // _SC_LEVEL1_DCACHE_SIZE
+#if defined(_SC_LEVEL2_CACHE_SIZE)
+  IREE_QUERY_SYSCONF_CACHE(_SC_LEVEL2_CACHE_SIZE,
+                           IREE_CPU_DATA_FIELD_1_L2_CACHE_KB_SHIFT,
+                           &out_fields[1]);
+#endif  // _SC_LEVEL2_CACHE_SIZE
+#if defined(_SC_LEVEL3_CACHE_SIZE)
+  IREE_QUERY_SYSCONF_CACHE(_SC_LEVEL3_CACHE_SIZE,
+                           IREE_CPU_DATA_FIELD_1_L3_CACHE_KB_SHIFT,
+                           &out_fields[1]);
+#endif  // _SC_LEVEL3_CACHE_SIZE
+}
+
+#undef IREE_QUERY_SYSCONF_CACHE
+
+#elif defined(IREE_PLATFORM_APPLE)
+
+// Included again as the feature query block above is skipped on x86_64.
+#include <sys/sysctl.h>
+#include <sys/types.h>
+
+#define IREE_QUERY_SYSCTL_CACHE(key, shift, field_value)             \
+  do {                                                              \
+    int64_t result = 0;                                             \
+    size_t result_size = sizeof result;                             \
+    if (0 == sysctlbyname(key, &result, &result_size, NULL, 0) &&   \
+        result > 0) {                                               \
+      iree_cpu_set_cache_size(result, shift, field_value);          \
+    }                                                               \
+  } while (0)
+
+static void iree_cpu_query_cache_sizes(uint64_t* out_fields) {
+  IREE_QUERY_SYSCTL_CACHE("hw.l1dcachesize",
+                          IREE_CPU_DATA_FIELD_1_L1D_CACHE_KB_SHIFT,
+                          &out_fields[1]);
+  IREE_QUERY_SYSCTL_CACHE("hw.l2cachesize",
+                          IREE_CPU_DATA_FIELD_1_L2_CACHE_KB_SHIFT,
+                          &out_fields[1]);
+  IREE_QUERY_SYSCTL_CACHE("hw.l3cachesize",
+                          IREE_CPU_DATA_FIELD_1_L3_CACHE_KB_SHIFT,
+                          &out_fields[1]);
+}
+
+#undef IREE_QUERY_SYSCTL_CACHE
+
+#else
+
+static void iree_cpu_query_cache_sizes(uint64_t* out_fields) {
+  // No implementation available. Cache sizes will be unknown (zero).
+}
+
+#endif  // IREE_PLATFORM_*
+
 //===----------------------------------------------------------------------===//
 // Architecture-specific string lookup
 //===----------------------------------------------------------------------===//
@@ -112,6 +298,26 @@ static bool iree_cpu_lookup_data_by_key_for_arch(
                       IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_DOTPROD);
   IREE_TEST_FIELD_BIT("i8mm", fields[0],
                       IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_I8MM);
+  IREE_TEST_FIELD_BIT("fp16fml", fields[0],
+                      IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_FP16FML);
+  IREE_TEST_FIELD_BIT("bf16", fields[0],
+                      IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_BF16);
+  return false;
+}
+
+#elif defined(IREE_ARCH_X86_64)
+
+static bool iree_cpu_lookup_data_by_key_for_arch(
+    const uint64_t* fields, iree_string_view_t key,
+    int64_t* IREE_RESTRICT out_value) {
+  IREE_TEST_FIELD_BIT("avx2_fma", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA);
+  IREE_TEST_FIELD_BIT("avx512_base", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE);
+  IREE_TEST_FIELD_BIT("avx512_vnni", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_VNNI);
+  IREE_TEST_FIELD_BIT("avx512_bf16", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BF16);
   return false;
 }
 
@@ -139,6 +345,7 @@ void iree_cpu_initialize(iree_allocator_t temp_allocator) {
   IREE_TRACE_ZONE_BEGIN(z0);
   memset(iree_cpu_data_cache_, 0, sizeof(iree_cpu_data_cache_));
   iree_cpu_initialize_from_platform(temp_allocator, iree_cpu_data_cache_);
+  iree_cpu_query_cache_sizes(iree_cpu_data_cache_);
   IREE_TRACE_ZONE_END(z0);
 }
 
@@ -10,27 +10,81 @@
 #include <stddef.h>
 #include <string.h>
 
+#include "iree/base/internal/atomic_slist.h"
 #include "iree/base/internal/synchronization.h"
 #include "iree/base/tracing.h"
 
+// Storage for a pooled event. Nodes are allocated in blocks and never freed
+// until the pool is freed so they can be used with lock-free lists. When an
+// event is acquired its node moves to the unused list to be refilled by the
+// next release.
+typedef struct iree_event_pool_node_t {
+  iree_atomic_slist_intrusive_ptr_t slist_next;
+  iree_event_t event;
+} iree_event_pool_node_t;
+IREE_TYPED_ATOMIC_SLIST_WRAPPER(iree_event_pool_node, iree_event_pool_node_t,
+                                offsetof(iree_event_pool_node_t, slist_next));
+
+// Number of nodes allocated at a time when the pool grows.
+#define IREE_EVENT_POOL_BLOCK_NODE_COUNT 32
+
+typedef struct iree_event_pool_block_t {
+  iree_atomic_slist_intrusive_ptr_t slist_next;
+  iree_event_pool_node_t nodes[IREE_EVENT_POOL_BLOCK_NODE_COUNT];
+} iree_event_pool_block_t;
+IREE_TYPED_ATOMIC_SLIST_WRAPPER(iree_event_pool_block, iree_event_pool_block_t,
+                                offsetof(iree_event_pool_block_t, slist_next));
+
 struct iree_event_pool_t {
   // Allocator used to create the event pool.
   iree_allocator_t host_allocator;
-  // Guards the pool. Since this pool is used to get operating system-level
-  // event objects that will be signaled and waited on using syscalls it's got
-  // relatively low contention: callers are rate limited by how fast they can
-  // signal and wait on the events they get.
-  iree_slim_mutex_t mutex;
-  // Maximum number of events that will be maintained in the pool. More events
-  // may be allocated at any time but when they are no longer needed they will
-  // be disposed directly.
-  iree_host_size_t available_capacity;
-  // Total number of available
-  iree_host_size_t available_count;
-  // Dense left-aligned list of available_count events.
-  iree_event_t available_list[];
+  // Nodes holding initialized and reset events ready to be acquired.
+  // Lock-free so that workers and waiters don't serialize on the pool when
+  // acquiring and releasing events at high rates.
+  iree_event_pool_node_slist_t available_slist;
+  // Nodes with no event available to hold released events.
+  iree_event_pool_node_slist_t unused_slist;
+  // All blocks of nodes allocated by the pool.
+  iree_event_pool_block_slist_t block_slist;
 };
 
+// Allocates a new block of nodes and returns one of them to the caller. The
+// remaining nodes are added to the unused list.
+static iree_status_t iree_event_pool_grow(iree_event_pool_t* event_pool,
+                                          iree_event_pool_node_t** out_node) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_event_pool_block_t* block = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(event_pool->host_allocator, sizeof(*block),
+                                (void**)&block));
+  memset(block, 0, sizeof(*block));
+  for (iree_host_size_t i = 1; i + 1 < IREE_EVENT_POOL_BLOCK_NODE_COUNT; ++i) {
+    iree_event_pool_node_slist_set_next(&block->nodes[i], &block->nodes[i + 1]);
+  }
+  iree_event_pool_node_slist_concat(
+      &event_pool->unused_slist, &block->nodes[1],
+      &block->nodes[IREE_EVENT_POOL_BLOCK_NODE_COUNT - 1]);
+  iree_event_pool_block_slist_push(&event_pool->block_slist, block);
+  *out_node = &block->nodes[0];
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+// Adds |event| to the available list, growing the pool if needed.
+// The event must be reset. Fails if the pool could not grow, in which case the
+// caller still owns the event.
+static iree_status_t iree_event_pool_push_available(
+    iree_event_pool_t* event_pool, iree_event_t event) {
+  iree_event_pool_node_t* node =
+      iree_event_pool_node_slist_pop(&event_pool->unused_slist);
+  if (IREE_UNLIKELY(!node)) {
+    IREE_RETURN_IF_ERROR(iree_event_pool_grow(event_pool, &node));
+  }
+  node->event = event;
+  iree_event_pool_node_slist_push(&event_pool->available_slist, node);
+  return iree_ok_status();
+}
+
 iree_status_t iree_event_pool_allocate(iree_host_size_t available_capacity,
                                        iree_allocator_t host_allocator,
                                        iree_event_pool_t** out_event_pool) {
@@ -39,22 +93,24 @@ iree_status_t iree_event_pool_allocate(iree_host_size_t available_capacity,
   IREE_TRACE_ZONE_BEGIN(z0);
 
   iree_event_pool_t* event_pool = NULL;
-  iree_host_size_t total_size =
-      sizeof(*event_pool) +
-      available_capacity * sizeof(event_pool->available_list[0]);
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0,
-      iree_allocator_malloc(host_allocator, total_size, (void**)&event_pool));
+      z0, iree_allocator_malloc(host_allocator, sizeof(*event_pool),
+                                (void**)&event_pool));
   event_pool->host_allocator = host_allocator;
-  event_pool->available_capacity = available_capacity;
-  event_pool->available_count = 0;
+  iree_event_pool_node_slist_initialize(&event_pool->available_slist);
+  iree_event_pool_node_slist_initialize(&event_pool->unused_slist);
+  iree_event_pool_block_slist_initialize(&event_pool->block_slist);
 
   iree_status_t status = iree_ok_status();
   for (iree_host_size_t i = 0; i < available_capacity; ++i) {
-    status = iree_event_initialize(
-        /*initial_state=*/false,
-        &event_pool->available_list[event_pool->available_count++]);
+    iree_event_t event;
+    status = iree_event_initialize(/*initial_state=*/false, &event);
     if (!iree_status_is_ok(status)) break;
+    status = iree_event_pool_push_available(event_pool, event);
+    if (!iree_status_is_ok(status)) {
+      iree_event_deinitialize(&event);
+      break;
+    }
   }
 
   if (iree_status_is_ok(status)) {
@@ -70,15 +126,51 @@ void iree_event_pool_free(iree_event_pool_t* event_pool) {
   iree_allocator_t host_allocator = event_pool->host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  for (iree_host_size_t i = 0; i < event_pool->available_count; ++i) {
-    iree_event_deinitialize(&event_pool->available_list[i]);
+  iree_event_pool_trim(event_pool);
+
+  iree_event_pool_block_t* block = NULL;
+  if (iree_event_pool_block_slist_flush(
+          &event_pool->block_slist,
+          IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_LIFO, &block, NULL)) {
+    while (block) {
+      iree_event_pool_block_t* next_block =
+          iree_event_pool_block_slist_get_next(block);
+      iree_allocator_free(host_allocator, block);
+      block = next_block;
+    }
   }
-  iree_slim_mutex_deinitialize(&event_pool->mutex);
+
+  iree_event_pool_node_slist_deinitialize(&event_pool->available_slist);
+  iree_event_pool_node_slist_deinitialize(&event_pool->unused_slist);
+  iree_event_pool_block_slist_deinitialize(&event_pool->block_slist);
   iree_allocator_free(host_allocator, event_pool);
 
   IREE_TRACE_ZONE_END(z0);
 }
 
+void iree_event_pool_trim(iree_event_pool_t* event_pool) {
+  IREE_ASSERT_ARGUMENT(event_pool);
+
+  // Steal all available events; concurrent acquires will allocate new ones.
+  iree_event_pool_node_t* head = NULL;
+  iree_event_pool_node_t* tail = NULL;
+  if (!iree_event_pool_node_slist_flush(
+          &event_pool->available_slist,
+          IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_LIFO, &head, &tail)) {
+    return;  // no available events
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Destroy the events and return their nodes for reuse.
+  for (iree_event_pool_node_t* node = head; node != NULL;
+       node = iree_event_pool_node_slist_get_next(node)) {
+    iree_event_deinitialize(&node->event);
+  }
+  iree_event_pool_node_slist_concat(&event_pool->unused_slist, head, tail);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
 iree_status_t iree_event_pool_acquire(iree_event_pool_t* event_pool,
                                       iree_host_size_t event_count,
                                       iree_event_t* out_events) {
@@ -88,37 +180,26 @@ iree_status_t iree_event_pool_acquire(iree_event_pool_t* event_pool,
 
   // We'll try to get what we can from the pool and fall back to initializing
   // new events.
-  iree_host_size_t remaining_count = event_count;
-
-  // Try first to grab from the pool.
-  iree_slim_mutex_lock(&event_pool->mutex);
-  iree_host_size_t from_pool_count =
-      iree_min(event_pool->available_count, event_count);
-  if (from_pool_count > 0) {
-    iree_host_size_t pool_base_index =
-        event_pool->available_count - from_pool_count;
-    memcpy(out_events, &event_pool->available_list[pool_base_index],
-           from_pool_count * sizeof(iree_event_t));
-    event_pool->available_count -= from_pool_count;
-    remaining_count -= from_pool_count;
-  }
-  iree_slim_mutex_unlock(&event_pool->mutex);
-
-  // Allocate the rest of the events.
-  if (remaining_count > 0) {
-    IREE_TRACE_ZONE_BEGIN(z0);
-    iree_status_t status = iree_ok_status();
-    for (iree_host_size_t i = 0; i < remaining_count; ++i) {
-      status = iree_event_initialize(/*initial_state=*/false,
-                                     &out_events[from_pool_count + i]);
-      if (!iree_status_is_ok(status)) {
-        // Must release all events we've acquired so far.
-        iree_event_pool_release(event_pool, from_pool_count + i, out_events);
-        IREE_TRACE_ZONE_END(z0);
-        return status;
-      }
+  for (iree_host_size_t i = 0; i < event_count; ++i) {
+    iree_event_pool_node_t* node =
+        iree_event_pool_node_slist_pop(&event_pool->available_slist);
+    if (IREE_LIKELY(node)) {
+      out_events[i] = node->event;
+      iree_event_pool_node_slist_push(&event_pool->unused_slist, node);
+      continue;
     }
+
+    // Pool exhausted; allocate a new event. It will be retained in the pool
+    // when released so that steady-state usage stops hitting the system.
+    IREE_TRACE_ZONE_BEGIN_NAMED(z0, "iree_event_pool_acquire_initialize");
+    iree_status_t status =
+        iree_event_initialize(/*initial_state=*/false, &out_events[i]);
     IREE_TRACE_ZONE_END(z0);
+    if (!iree_status_is_ok(status)) {
+      // Must release all events we've acquired so far.
+      iree_event_pool_release(event_pool, i, out_events);
+      return status;
+    }
   }
 
   return iree_ok_status();
@@ -131,36 +212,16 @@ void iree_event_pool_release(iree_event_pool_t* event_pool,
   if (!event_count) return;
   IREE_ASSERT_ARGUMENT(events);
 
-  // We'll try to release all we can back to the pool and then deinitialize
-  // the ones that won't fit.
-  iree_host_size_t remaining_count = event_count;
-
-  // Try first to release to the pool.
   // Note that we reset the events we add back to the pool so that they are
-  // ready to be acquired again.
-  iree_slim_mutex_lock(&event_pool->mutex);
-  iree_host_size_t to_pool_count =
-      iree_min(event_pool->available_capacity - event_pool->available_count,
-               event_count);
-  if (to_pool_count > 0) {
-    iree_host_size_t pool_base_index = event_pool->available_count;
-    for (iree_host_size_t i = 0; i < to_pool_count; ++i) {
-      iree_event_reset(&events[i]);
-    }
-    memcpy(&event_pool->available_list[pool_base_index], events,
-           to_pool_count * sizeof(iree_event_t));
-    event_pool->available_count += to_pool_count;
-    remaining_count -= to_pool_count;
-  }
-  iree_slim_mutex_unlock(&event_pool->mutex);
-
-  // Deallocate the rest of the events. We don't bother resetting them as we are
-  // getting rid of them.
-  if (remaining_count > 0) {
-    IREE_TRACE_ZONE_BEGIN(z0);
-    for (iree_host_size_t i = 0; i < remaining_count; ++i) {
-      iree_event_deinitialize(&events[to_pool_count + i]);
+  // ready to be acquired again. If the pool is unable to grow we dispose the
+  // event directly.
+  for (iree_host_size_t i = 0; i < event_count; ++i) {
+    iree_event_reset(&events[i]);
+    iree_status_t status =
+        iree_event_pool_push_available(event_pool, events[i]);
+    if (IREE_UNLIKELY(!iree_status_is_ok(status))) {
+      iree_status_ignore(status);
+      iree_event_deinitialize(&events[i]);
     }
-    IREE_TRACE_ZONE_END(z0);
   }
 }
@@ -15,11 +15,17 @@ extern "C" {
 #endif  // __cplusplus
 
 // A simple pool of iree_event_ts to recycle.
+// The pool grows to hold the peak number of events released to it so that
+// steady-state usage does not create or destroy system events. Use
+// iree_event_pool_trim to release unused events back to the system.
 //
 // Thread-safe; multiple threads may acquire and release events from the pool.
+// Release is lock-free and acquires only serialize with each other (see
+// iree_atomic_slist_t).
 typedef struct iree_event_pool_t iree_event_pool_t;
 
-// Allocates a new event pool with up to |available_capacity| events.
+// Allocates a new event pool with |available_capacity| events initially
+// available.
 iree_status_t iree_event_pool_allocate(iree_host_size_t available_capacity,
                                        iree_allocator_t host_allocator,
                                        iree_event_pool_t** out_event_pool);
@@ -29,6 +35,11 @@ iree_status_t iree_event_pool_allocate(iree_host_size_t available_capacity,
 // back to it prior to deallocation.
 void iree_event_pool_free(iree_event_pool_t* event_pool);
 
+// Destroys all events currently available in the pool.
+// Events that are acquired remain valid and are retained by the pool when
+// released. Safe to call concurrently with acquire/release.
+void iree_event_pool_trim(iree_event_pool_t* event_pool);
+
 // Acquires one or more events from the event pool.
 // The returned events will be unsignaled and ready for use. Callers may set and
 // reset the events as much as they want prior to releasing them back to the
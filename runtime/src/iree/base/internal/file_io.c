@@ -12,6 +12,7 @@
 
 #include <errno.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 
@@ -26,6 +27,37 @@
 #define IREE_SET_BINARY_MODE(handle) ((void)0)
 #endif  // IREE_PLATFORM_WINDOWS
 
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_APPLE) || \
+    defined(IREE_PLATFORM_LINUX)
+#define IREE_FILE_MAP_ENABLE 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#define IREE_FILE_MAP_ENABLE 0
+#endif  // IREE_PLATFORM_*
+
+// io_uring is used for parallel reads on Linux when the headers are available;
+// availability at runtime is checked when the ring is created.
+#if !defined(IREE_FILE_URING_ENABLE)
+#if defined(IREE_PLATFORM_LINUX) && !defined(IREE_PLATFORM_ANDROID) && \
+    defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define IREE_FILE_URING_ENABLE 1
+#endif  // __has_include(<linux/io_uring.h>)
+#endif  // IREE_PLATFORM_LINUX
+#endif  // !IREE_FILE_URING_ENABLE
+#if !defined(IREE_FILE_URING_ENABLE)
+#define IREE_FILE_URING_ENABLE 0
+#endif  // !IREE_FILE_URING_ENABLE
+
+#if IREE_FILE_URING_ENABLE
+#include <inttypes.h>
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif  // IREE_FILE_URING_ENABLE
+
 // We could take alignment as an arg, but roughly page aligned should be
 // acceptable for all uses - if someone cares about memory usage they won't
 // be using this method.
@@ -99,8 +131,7 @@ iree_status_t iree_file_contents_allocator_ctl(void* self,
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "only the file contents buffer is valid");
   }
-  iree_allocator_t allocator = contents->allocator;
-  iree_allocator_free(allocator, contents);
+  iree_file_contents_free(contents);
   return iree_ok_status();
 }
 
@@ -116,6 +147,11 @@ iree_allocator_t iree_file_contents_deallocator(
 void iree_file_contents_free(iree_file_contents_t* contents) {
   if (!contents) return;
   IREE_TRACE_ZONE_BEGIN(z0);
+#if IREE_FILE_MAP_ENABLE
+  if (contents->mapped) {
+    munmap(contents->buffer.data, contents->buffer.data_length);
+  }
+#endif  // IREE_FILE_MAP_ENABLE
   iree_allocator_free(contents->allocator, contents);
   IREE_TRACE_ZONE_END(z0);
 }
@@ -189,6 +225,446 @@ iree_status_t iree_file_read_contents(const char* path,
   return status;
 }
 
+iree_status_t iree_file_map_contents(const char* path,
+                                     iree_allocator_t allocator,
+                                     iree_file_contents_t** out_contents) {
+#if IREE_FILE_MAP_ENABLE
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_ASSERT_ARGUMENT(path);
+  IREE_ASSERT_ARGUMENT(out_contents);
+  *out_contents = NULL;
+
+  int fd = open(path, O_RDONLY);
+  if (fd == -1) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to open file '%s'", path);
+  }
+  struct stat stat_buf;
+  if (fstat(fd, &stat_buf) == -1) {
+    iree_status_t status = iree_make_status(
+        iree_status_code_from_errno(errno), "failed to stat file '%s'", path);
+    close(fd);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+  if (stat_buf.st_size == 0 ||
+      (uint64_t)stat_buf.st_size > IREE_HOST_SIZE_MAX) {
+    // Empty files can't be mapped and files too large for the address space
+    // fail the same way read_contents reports.
+    close(fd);
+    IREE_TRACE_ZONE_END(z0);
+    return iree_file_read_contents(path, allocator, out_contents);
+  }
+  iree_host_size_t file_size = (iree_host_size_t)stat_buf.st_size;
+
+  iree_file_contents_t* contents = NULL;
+  iree_status_t status =
+      iree_allocator_malloc(allocator, sizeof(*contents), (void**)&contents);
+  if (iree_status_is_ok(status)) {
+    void* data = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      status = iree_make_status(iree_status_code_from_errno(errno),
+                                "failed to map file '%s'", path);
+      iree_allocator_free(allocator, contents);
+    } else {
+      contents->allocator = allocator;
+      contents->mapped = true;
+      contents->buffer.data = (uint8_t*)data;
+      contents->buffer.data_length = file_size;
+      *out_contents = contents;
+    }
+  }
+  // The mapping keeps the file referenced.
+  close(fd);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+#else
+  return iree_file_read_contents(path, allocator, out_contents);
+#endif  // IREE_FILE_MAP_ENABLE
+}
+
+//===----------------------------------------------------------------------===//
+// iree_file_read_contents_parallel
+//===----------------------------------------------------------------------===//
+
+// Maximum number of read requests in flight regardless of the requested queue
+// depth. Bounds the on-stack request tracking.
+#define IREE_FILE_READ_MAX_QUEUE_DEPTH 64
+
+void iree_file_read_params_initialize(iree_file_read_params_t* out_params) {
+  memset(out_params, 0, sizeof(*out_params));
+  out_params->flags = IREE_FILE_READ_FLAG_NONE;
+  out_params->chunk_size = 4 * 1024 * 1024;
+  out_params->queue_depth = 16;
+}
+
+#if IREE_FILE_MAP_ENABLE
+
+// Reads [0, |read_length|) of |fd| into |data| one chunk at a time.
+// Reads stop early at the end of the file.
+static iree_status_t iree_file_pread_chunks(int fd, uint8_t* data,
+                                            iree_host_size_t read_length,
+                                            iree_host_size_t chunk_size) {
+  iree_host_size_t offset = 0;
+  while (offset < read_length) {
+    iree_host_size_t length = iree_min(chunk_size, read_length - offset);
+    ssize_t ret = pread(fd, data + offset, length, (off_t)offset);
+    if (ret < 0) {
+      if (errno == EINTR) continue;
+      return iree_make_status(iree_status_code_from_errno(errno),
+                              "failed to read %zu bytes at offset %zu", length,
+                              offset);
+    } else if (ret == 0) {
+      break;  // EOF
+    }
+    offset += (iree_host_size_t)ret;
+  }
+  return iree_ok_status();
+}
+
+#if IREE_FILE_URING_ENABLE
+
+// A minimal io_uring instance set up with raw syscalls so that no liburing
+// dependency is required. Only used from a single thread.
+typedef struct iree_file_uring_t {
+  int fd;
+  void* sq_ring;
+  size_t sq_ring_size;
+  void* cq_ring;
+  size_t cq_ring_size;
+  struct io_uring_sqe* sqes;
+  size_t sqes_size;
+  unsigned* sq_tail;
+  unsigned* sq_mask;
+  unsigned* sq_array;
+  unsigned* cq_head;
+  unsigned* cq_tail;
+  unsigned* cq_mask;
+  struct io_uring_cqe* cqes;
+} iree_file_uring_t;
+
+static void iree_file_uring_deinitialize(iree_file_uring_t* ring) {
+  if (ring->sqes) munmap(ring->sqes, ring->sqes_size);
+  if (ring->cq_ring && ring->cq_ring != ring->sq_ring) {
+    munmap(ring->cq_ring, ring->cq_ring_size);
+  }
+  if (ring->sq_ring) munmap(ring->sq_ring, ring->sq_ring_size);
+  if (ring->fd >= 0) close(ring->fd);
+  memset(ring, 0, sizeof(*ring));
+  ring->fd = -1;
+}
+
+static iree_status_t iree_file_uring_initialize(uint32_t entries,
+                                                iree_file_uring_t* out_ring) {
+  memset(out_ring, 0, sizeof(*out_ring));
+  out_ring->fd = -1;
+
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+  if (fd < 0) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "io_uring_setup failed");
+  }
+  out_ring->fd = fd;
+
+  out_ring->sq_ring_size =
+      params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  out_ring->cq_ring_size =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    out_ring->sq_ring_size =
+        iree_max(out_ring->sq_ring_size, out_ring->cq_ring_size);
+    out_ring->cq_ring_size = out_ring->sq_ring_size;
+  }
+  out_ring->sq_ring =
+      mmap(NULL, out_ring->sq_ring_size, PROT_READ | PROT_WRITE,
+           MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if (out_ring->sq_ring == MAP_FAILED) {
+    out_ring->sq_ring = NULL;
+    iree_file_uring_deinitialize(out_ring);
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "io_uring submission ring mapping failed");
+  }
+  if (single_mmap) {
+    out_ring->cq_ring = out_ring->sq_ring;
+  } else {
+    out_ring->cq_ring =
+        mmap(NULL, out_ring->cq_ring_size, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if (out_ring->cq_ring == MAP_FAILED) {
+      out_ring->cq_ring = NULL;
+      iree_file_uring_deinitialize(out_ring);
+      return iree_make_status(iree_status_code_from_errno(errno),
+                              "io_uring completion ring mapping failed");
+    }
+  }
+  out_ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+  out_ring->sqes = (struct io_uring_sqe*)mmap(
+      NULL, out_ring->sqes_size, PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if (out_ring->sqes == MAP_FAILED) {
+    out_ring->sqes = NULL;
+    iree_file_uring_deinitialize(out_ring);
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "io_uring submission entry mapping failed");
+  }
+
+  uint8_t* sq_ring = (uint8_t*)out_ring->sq_ring;
+  out_ring->sq_tail = (unsigned*)(sq_ring + params.sq_off.tail);
+  out_ring->sq_mask = (unsigned*)(sq_ring + params.sq_off.ring_mask);
+  out_ring->sq_array = (unsigned*)(sq_ring + params.sq_off.array);
+  uint8_t* cq_ring = (uint8_t*)out_ring->cq_ring;
+  out_ring->cq_head = (unsigned*)(cq_ring + params.cq_off.head);
+  out_ring->cq_tail = (unsigned*)(cq_ring + params.cq_off.tail);
+  out_ring->cq_mask = (unsigned*)(cq_ring + params.cq_off.ring_mask);
+  out_ring->cqes = (struct io_uring_cqe*)(cq_ring + params.cq_off.cqes);
+  return iree_ok_status();
+}
+
+// Queues a read of |iov| at |offset| tagged with |user_data|.
+// The caller must ensure there is space in the submission ring.
+static void iree_file_uring_queue_read(iree_file_uring_t* ring, int fd,
+                                       const struct iovec* iov, off_t offset,
+                                       uint64_t user_data) {
+  const unsigned tail = *ring->sq_tail;
+  const unsigned index = tail & *ring->sq_mask;
+  struct io_uring_sqe* sqe = &ring->sqes[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = IORING_OP_READV;
+  sqe->fd = fd;
+  sqe->off = (uint64_t)offset;
+  sqe->addr = (uint64_t)(uintptr_t)iov;
+  sqe->len = 1;
+  sqe->user_data = user_data;
+  ring->sq_array[index] = index;
+  __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+// Submits |submit_count| queued reads and waits for at least one completion.
+static iree_status_t iree_file_uring_submit_and_wait(iree_file_uring_t* ring,
+                                                     unsigned submit_count) {
+  while (true) {
+    int ret = (int)syscall(__NR_io_uring_enter, ring->fd, submit_count,
+                           /*min_complete=*/1, IORING_ENTER_GETEVENTS,
+                           /*sig=*/NULL, /*sigsz=*/0);
+    if (ret >= 0) return iree_ok_status();
+    if (errno != EINTR) {
+      return iree_make_status(iree_status_code_from_errno(errno),
+                              "io_uring_enter failed");
+    }
+    // Interrupted; all submissions are consumed before waiting so retry only
+    // the wait.
+    submit_count = 0;
+  }
+}
+
+// An in-flight chunk read that may be resubmitted if the read is short.
+typedef struct iree_file_uring_request_t {
+  struct iovec iov;
+  off_t offset;
+} iree_file_uring_request_t;
+
+// Reads [0, |read_length|) of |fd| into |data| with up to |queue_depth| reads
+// of |chunk_size| in flight. Reads stop early at the end of the file.
+static iree_status_t iree_file_uring_read_chunks(iree_file_uring_t* ring,
+                                                 int fd, uint8_t* data,
+                                                 iree_host_size_t read_length,
+                                                 iree_host_size_t chunk_size,
+                                                 uint32_t queue_depth) {
+  iree_file_uring_request_t requests[IREE_FILE_READ_MAX_QUEUE_DEPTH];
+  uint32_t free_requests[IREE_FILE_READ_MAX_QUEUE_DEPTH];
+  uint32_t free_count = queue_depth;
+  for (uint32_t i = 0; i < queue_depth; ++i) free_requests[i] = i;
+
+  iree_status_t status = iree_ok_status();
+  iree_host_size_t next_offset = 0;
+  uint32_t in_flight_count = 0;
+  unsigned pending_submit_count = 0;
+  do {
+    // Fill the queue with new chunks.
+    while (iree_status_is_ok(status) && free_count > 0 &&
+           next_offset < read_length) {
+      uint32_t request_index = free_requests[--free_count];
+      iree_file_uring_request_t* request = &requests[request_index];
+      request->offset = (off_t)next_offset;
+      request->iov.iov_base = data + next_offset;
+      request->iov.iov_len = iree_min(chunk_size, read_length - next_offset);
+      next_offset += request->iov.iov_len;
+      iree_file_uring_queue_read(ring, fd, &request->iov, request->offset,
+                                 request_index);
+      ++pending_submit_count;
+      ++in_flight_count;
+    }
+    if (in_flight_count == 0) break;
+
+    // Submit and wait for at least one read to complete. On failure the reads
+    // already submitted must still drain as they reference |data|.
+    iree_status_t wait_status =
+        iree_file_uring_submit_and_wait(ring, pending_submit_count);
+    pending_submit_count = 0;
+    if (!iree_status_is_ok(wait_status)) {
+      status = iree_status_join(status, wait_status);
+      break;
+    }
+
+    // Reap all available completions.
+    unsigned head = *ring->cq_head;
+    const unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head) {
+      const struct io_uring_cqe* cqe = &ring->cqes[head & *ring->cq_mask];
+      uint32_t request_index = (uint32_t)cqe->user_data;
+      iree_file_uring_request_t* request = &requests[request_index];
+      --in_flight_count;
+      if (cqe->res < 0) {
+        if (iree_status_is_ok(status)) {
+          status = iree_make_status(
+              iree_status_code_from_errno(-cqe->res),
+              "failed to read %zu bytes at offset %" PRIu64,
+              request->iov.iov_len, (uint64_t)request->offset);
+        }
+        free_requests[free_count++] = request_index;
+      } else if (cqe->res > 0 && (size_t)cqe->res < request->iov.iov_len &&
+                 iree_status_is_ok(status)) {
+        // Short read: resubmit the remainder of the chunk.
+        request->offset += cqe->res;
+        request->iov.iov_base = (uint8_t*)request->iov.iov_base + cqe->res;
+        request->iov.iov_len -= (size_t)cqe->res;
+        iree_file_uring_queue_read(ring, fd, &request->iov, request->offset,
+                                   request_index);
+        ++pending_submit_count;
+        ++in_flight_count;
+      } else {
+        // Completed (or hit EOF).
+        free_requests[free_count++] = request_index;
+      }
+    }
+    __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+  } while (in_flight_count > 0 ||
+           (iree_status_is_ok(status) && next_offset < read_length));
+  return status;
+}
+
+#endif  // IREE_FILE_URING_ENABLE
+
+iree_status_t iree_file_read_contents_parallel(
+    const char* path, const iree_file_read_params_t* params,
+    iree_allocator_t allocator, iree_file_contents_t** out_contents) {
+  IREE_ASSERT_ARGUMENT(path);
+  IREE_ASSERT_ARGUMENT(params);
+  IREE_ASSERT_ARGUMENT(out_contents);
+  *out_contents = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Direct I/O is best-effort: file systems that don't support it (tmpfs/etc)
+  // reject the open and we fall back to cached reads.
+  bool direct = false;
+  int fd = -1;
+#if defined(O_DIRECT)
+  if (iree_all_bits_set(params->flags, IREE_FILE_READ_FLAG_DIRECT)) {
+    fd = open(path, O_RDONLY | O_DIRECT);
+    direct = fd != -1;
+  }
+#endif  // O_DIRECT
+  if (fd == -1) fd = open(path, O_RDONLY);
+  if (fd == -1) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to open file '%s'", path);
+  }
+  struct stat stat_buf;
+  if (fstat(fd, &stat_buf) == -1) {
+    iree_status_t status = iree_make_status(
+        iree_status_code_from_errno(errno), "failed to stat file '%s'", path);
+    close(fd);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+  if (stat_buf.st_size == 0 ||
+      (uint64_t)stat_buf.st_size >
+          IREE_HOST_SIZE_MAX - 2 * IREE_FILE_BASE_ALIGNMENT) {
+    // Nothing to parallelize (or too large); use the default path for
+    // consistent results and errors.
+    close(fd);
+    IREE_TRACE_ZONE_END(z0);
+    return iree_file_read_contents(path, allocator, out_contents);
+  }
+  iree_host_size_t file_size = (iree_host_size_t)stat_buf.st_size;
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, file_size);
+
+  // Direct reads must cover whole aligned blocks so the buffer is padded out
+  // to the alignment; the contents only report the file size.
+  iree_host_size_t read_length =
+      direct ? iree_host_align(file_size, IREE_FILE_BASE_ALIGNMENT)
+             : file_size;
+  iree_host_size_t chunk_size = iree_host_align(
+      iree_max(params->chunk_size, (iree_host_size_t)1),
+      IREE_FILE_BASE_ALIGNMENT);
+  uint32_t queue_depth =
+      iree_min(iree_max(params->queue_depth, 1u),
+               (uint32_t)IREE_FILE_READ_MAX_QUEUE_DEPTH);
+
+  // We allocate +1 to force a trailing \0 in case this is used as a cstring.
+  iree_file_contents_t* contents = NULL;
+  iree_host_size_t total_size =
+      sizeof(*contents) + IREE_FILE_BASE_ALIGNMENT + read_length + /*NUL*/ 1;
+  iree_status_t status =
+      iree_allocator_malloc(allocator, total_size, (void**)&contents);
+  if (iree_status_is_ok(status)) {
+    contents->allocator = allocator;
+    contents->buffer.data = (void*)iree_host_align(
+        (uintptr_t)contents + sizeof(*contents), IREE_FILE_BASE_ALIGNMENT);
+    contents->buffer.data_length = file_size;
+  }
+
+  bool read_complete = false;
+#if IREE_FILE_URING_ENABLE
+  if (iree_status_is_ok(status) && queue_depth > 1) {
+    iree_file_uring_t ring;
+    iree_status_t ring_status = iree_file_uring_initialize(queue_depth, &ring);
+    if (iree_status_is_ok(ring_status)) {
+      status = iree_file_uring_read_chunks(&ring, fd, contents->buffer.data,
+                                           read_length, chunk_size,
+                                           queue_depth);
+      iree_file_uring_deinitialize(&ring);
+      read_complete = true;
+    } else {
+      // io_uring unavailable (old kernel, blocked by seccomp, etc).
+      iree_status_ignore(ring_status);
+    }
+  }
+#endif  // IREE_FILE_URING_ENABLE
+  if (iree_status_is_ok(status) && !read_complete) {
+    status = iree_file_pread_chunks(fd, contents->buffer.data, read_length,
+                                    chunk_size);
+  }
+  close(fd);
+
+  if (iree_status_is_ok(status)) {
+    // Add trailing NUL to make the contents C-string compatible.
+    contents->buffer.data[file_size] = 0;  // NUL
+    *out_contents = contents;
+  } else {
+    status = iree_status_annotate_f(status, "reading file '%s'", path);
+    iree_allocator_free(allocator, contents);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+#else
+
+iree_status_t iree_file_read_contents_parallel(
+    const char* path, const iree_file_read_params_t* params,
+    iree_allocator_t allocator, iree_file_contents_t** out_contents) {
+  return iree_file_read_contents(path, allocator, out_contents);
+}
+
+#endif  // IREE_FILE_MAP_ENABLE
+
 iree_status_t iree_file_write_contents(const char* path,
                                        iree_const_byte_span_t content) {
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -300,6 +776,22 @@ iree_status_t iree_file_read_contents(const char* path,
   return iree_make_status(IREE_STATUS_UNAVAILABLE, "File I/O is disabled");
 }
 
+iree_status_t iree_file_map_contents(const char* path,
+                                     iree_allocator_t allocator,
+                                     iree_file_contents_t** out_contents) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE, "File I/O is disabled");
+}
+
+void iree_file_read_params_initialize(iree_file_read_params_t* out_params) {
+  memset(out_params, 0, sizeof(*out_params));
+}
+
+iree_status_t iree_file_read_contents_parallel(
+    const char* path, const iree_file_read_params_t* params,
+    iree_allocator_t allocator, iree_file_contents_t** out_contents) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE, "File I/O is disabled");
+}
+
 iree_status_t iree_file_write_contents(const char* path,
                                        iree_const_byte_span_t content) {
   return iree_make_status(IREE_STATUS_UNAVAILABLE, "File I/O is disabled");
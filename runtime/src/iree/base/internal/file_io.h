@@ -32,6 +32,9 @@ bool iree_file_is_at(FILE* file, uint64_t position);
 // Loaded file contents.
 typedef struct iree_file_contents_t {
   iree_allocator_t allocator;
+  // True if |buffer| is a read-only mapping of the file made by
+  // iree_file_map_contents instead of a copy owned by |allocator|.
+  bool mapped;
   union {
     iree_byte_span_t buffer;
     iree_const_byte_span_t const_buffer;
@@ -54,6 +57,61 @@ iree_status_t iree_file_read_contents(const char* path,
                                       iree_allocator_t allocator,
                                       iree_file_contents_t** out_contents);
 
+// Controls the behavior of iree_file_read_contents_parallel.
+enum iree_file_read_flag_bits_t {
+  IREE_FILE_READ_FLAG_NONE = 0u,
+  // Reads bypass the OS page cache (O_DIRECT) when the platform and file
+  // system support it. Large files read once (such as weights uploaded to
+  // devices) then don't evict other cached data or get copied twice.
+  IREE_FILE_READ_FLAG_DIRECT = 1u << 0,
+};
+typedef uint32_t iree_file_read_flags_t;
+
+// Parameters controlling how iree_file_read_contents_parallel issues reads.
+// Must be initialized with iree_file_read_params_initialize prior to use.
+typedef struct iree_file_read_params_t {
+  iree_file_read_flags_t flags;
+  // Size of each read request in bytes. Rounded up to the file alignment.
+  iree_host_size_t chunk_size;
+  // Maximum number of read requests in flight at a time.
+  uint32_t queue_depth;
+} iree_file_read_params_t;
+
+// Initializes |out_params| to default values.
+void iree_file_read_params_initialize(iree_file_read_params_t* out_params);
+
+// Synchronously reads a file's contents into memory using multiple concurrent
+// chunked reads.
+//
+// On Linux the reads are issued through io_uring with up to
+// |params.queue_depth| chunks in flight such that storage devices with deep
+// queues (NVMe) can be saturated from a single thread. When io_uring is
+// unavailable (older kernels, seccomp filters, other platforms) the chunks are
+// read sequentially. The resulting contents are identical to those of
+// iree_file_read_contents.
+//
+// Returns the contents of the file in |out_contents|.
+// |allocator| is used to allocate the memory and the caller must use
+// iree_file_contents_free to release the memory.
+iree_status_t iree_file_read_contents_parallel(
+    const char* path, const iree_file_read_params_t* params,
+    iree_allocator_t allocator, iree_file_contents_t** out_contents);
+
+// Maps a file's contents into memory read-only.
+//
+// Pages are read from the file on first access instead of up front so large
+// files (such as modules with embedded weights) don't need a host copy of their
+// full contents; pages that have been consumed can be evicted by the OS. The
+// contents must not be written. Platforms without file mapping (and empty
+// files) fall back to iree_file_read_contents.
+//
+// Returns the contents of the file in |out_contents|.
+// |allocator| is used to allocate the bookkeeping and the caller must use
+// iree_file_contents_free to release the mapping.
+iree_status_t iree_file_map_contents(const char* path,
+                                     iree_allocator_t allocator,
+                                     iree_file_contents_t** out_contents);
+
 // Synchronously writes a byte buffer into a file.
 // Existing contents are overwritten.
 iree_status_t iree_file_write_contents(const char* path,
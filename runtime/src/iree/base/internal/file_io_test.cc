@@ -94,6 +94,71 @@ TEST(FileIO, ReadWriteContents) {
   iree_file_contents_free(read_contents);
 }
 
+TEST(FileIO, MapContents) {
+  constexpr const char* kUniqueName = "MapContents";
+  auto path = GetUniquePath(kUniqueName);
+
+  // Generate file contents.
+  auto write_contents = GetUniqueContents(kUniqueName);
+
+  // Write the contents to disk.
+  IREE_ASSERT_OK(iree_file_write_contents(
+      path.c_str(),
+      iree_make_const_byte_span(write_contents.data(), write_contents.size())));
+
+  // Map the contents from disk.
+  iree_file_contents_t* mapped_contents = NULL;
+  IREE_ASSERT_OK(iree_file_map_contents(path.c_str(), iree_allocator_system(),
+                                        &mapped_contents));
+
+  // Expect the contents are equal.
+  EXPECT_EQ(write_contents.size(), mapped_contents->const_buffer.data_length);
+  EXPECT_EQ(memcmp(write_contents.data(), mapped_contents->const_buffer.data,
+                   mapped_contents->const_buffer.data_length),
+            0);
+
+  // Releasing through the deallocator unmaps the file as well.
+  iree_allocator_t deallocator =
+      iree_file_contents_deallocator(mapped_contents);
+  iree_allocator_free(deallocator, mapped_contents->buffer.data);
+}
+
+TEST(FileIO, ReadContentsParallel) {
+  constexpr const char* kUniqueName = "ReadContentsParallel";
+  auto path = GetUniquePath(kUniqueName);
+
+  // Generate contents spanning multiple chunks with a partial tail chunk.
+  std::string write_contents;
+  while (write_contents.size() < 5 * 4096 + 123) {
+    write_contents += GetUniqueContents(kUniqueName);
+  }
+  IREE_ASSERT_OK(iree_file_write_contents(
+      path.c_str(),
+      iree_make_const_byte_span(write_contents.data(), write_contents.size())));
+
+  // Read with varying queue depths (and direct I/O, which may fall back to
+  // cached reads) and expect identical contents each time.
+  for (iree_file_read_flags_t flags :
+       {IREE_FILE_READ_FLAG_NONE, IREE_FILE_READ_FLAG_DIRECT}) {
+    for (uint32_t queue_depth : {1u, 2u, 16u}) {
+      iree_file_read_params_t params;
+      iree_file_read_params_initialize(&params);
+      params.flags = flags;
+      params.chunk_size = 4096;
+      params.queue_depth = queue_depth;
+      iree_file_contents_t* read_contents = NULL;
+      IREE_ASSERT_OK(iree_file_read_contents_parallel(
+          path.c_str(), &params, iree_allocator_system(), &read_contents));
+      EXPECT_EQ(write_contents.size(), read_contents->const_buffer.data_length);
+      EXPECT_EQ(memcmp(write_contents.data(), read_contents->const_buffer.data,
+                       read_contents->const_buffer.data_length),
+                0);
+      EXPECT_EQ(0, read_contents->buffer.data[write_contents.size()]);
+      iree_file_contents_free(read_contents);
+    }
+  }
+}
+
 }  // namespace
 }  // namespace file_io
 }  // namespace iree
@@ -0,0 +1,436 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/flight_recorder.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "iree/base/internal/call_once.h"
+#include "iree/base/internal/math.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/threading.h"
+#include "iree/base/tracing.h"
+
+#if defined(IREE_PLATFORM_WINDOWS)
+#include <intrin.h>
+#elif defined(IREE_ARCH_X86_64) && defined(IREE_COMPILER_GCC_COMPAT)
+#include <x86intrin.h>
+#endif  // IREE_PLATFORM_WINDOWS
+
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_APPLE) || \
+    defined(IREE_PLATFORM_LINUX)
+#define IREE_FLIGHT_RECORDER_HAVE_SIGNALS 1
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#else
+#define IREE_FLIGHT_RECORDER_HAVE_SIGNALS 0
+#endif  // IREE_PLATFORM_*
+
+//===----------------------------------------------------------------------===//
+// Timestamps
+//===----------------------------------------------------------------------===//
+
+// Returns the current value of a monotonic per-process tick counter. Ticks are
+// converted to nanoseconds when written by comparing against iree_time_now at
+// the time the recorder was enabled.
+static inline uint64_t iree_flight_recorder_ticks(void) {
+#if defined(IREE_ARCH_X86_64) && \
+    (defined(IREE_COMPILER_GCC_COMPAT) || defined(IREE_COMPILER_MSVC))
+  return __rdtsc();
+#elif defined(IREE_ARCH_ARM_64) && defined(IREE_COMPILER_GCC_COMPAT)
+  uint64_t value = 0;
+  __asm__ volatile("mrs %0, cntvct_el0" : "=r"(value));
+  return value;
+#else
+  return (uint64_t)iree_time_now();
+#endif  // IREE_ARCH_*
+}
+
+static inline uint64_t iree_flight_recorder_thread_id(void) {
+#if defined(IREE_PLATFORM_WINDOWS)
+  return (uint64_t)GetCurrentThreadId();
+#elif IREE_FLIGHT_RECORDER_HAVE_SIGNALS
+  return (uint64_t)(uintptr_t)pthread_self();
+#else
+  return 0;
+#endif  // IREE_PLATFORM_*
+}
+
+//===----------------------------------------------------------------------===//
+// Ring buffer
+//===----------------------------------------------------------------------===//
+
+// A slot in the ring. |sequence| is 1 + the index of the event stored in the
+// slot or 0 while the slot is being written and lets readers detect events
+// that were overwritten while they were being copied.
+typedef struct iree_flight_recorder_slot_t {
+  iree_atomic_int64_t sequence;
+  uint64_t ticks;
+  uint64_t thread_id;
+  uint64_t arg0;
+  uint64_t arg1;
+  uint64_t type;
+} iree_flight_recorder_slot_t;
+
+typedef struct iree_flight_recorder_t {
+  // Guards enabling and installing the signal handler.
+  iree_slim_mutex_t mutex;
+  // Total number of events ever recorded; the next event goes in
+  // |slots[head & (capacity - 1)]|.
+  iree_atomic_int64_t head;
+  iree_host_size_t capacity;
+  iree_flight_recorder_slot_t* slots;
+  // Tick and time when the ring was created used to convert ticks to time.
+  uint64_t base_ticks;
+  iree_time_t base_time_ns;
+  // Path written by the signal handler thread.
+  char* signal_path;
+  int signal_pipe[2];
+} iree_flight_recorder_t;
+
+iree_atomic_int32_t iree_flight_recorder_enabled_ = IREE_ATOMIC_VAR_INIT(0);
+
+static iree_flight_recorder_t iree_flight_recorder_;
+static iree_once_flag iree_flight_recorder_once_ = IREE_ONCE_FLAG_INIT;
+
+static void iree_flight_recorder_initialize(void) {
+  iree_slim_mutex_initialize(&iree_flight_recorder_.mutex);
+}
+
+iree_status_t iree_flight_recorder_enable(iree_host_size_t capacity) {
+  if (capacity == 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "flight recorder capacity must be nonzero");
+  }
+  capacity = iree_math_round_up_to_pow2_u64(capacity);
+  iree_call_once(&iree_flight_recorder_once_, iree_flight_recorder_initialize);
+  iree_flight_recorder_t* recorder = &iree_flight_recorder_;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)capacity);
+
+  iree_status_t status = iree_ok_status();
+  iree_slim_mutex_lock(&recorder->mutex);
+  if (!recorder->slots) {
+    // The ring is never freed as an event site may be writing into it at any
+    // time after it has been published.
+    status = iree_allocator_malloc(iree_allocator_system(),
+                                   capacity * sizeof(*recorder->slots),
+                                   (void**)&recorder->slots);
+    if (iree_status_is_ok(status)) {
+      memset(recorder->slots, 0, capacity * sizeof(*recorder->slots));
+      recorder->capacity = capacity;
+      recorder->base_ticks = iree_flight_recorder_ticks();
+      recorder->base_time_ns = iree_time_now();
+    }
+  } else if (capacity > recorder->capacity) {
+    status = iree_make_status(
+        IREE_STATUS_FAILED_PRECONDITION,
+        "flight recorder already enabled with a capacity of %" PRIhsz
+        " events; cannot grow to %" PRIhsz,
+        recorder->capacity, capacity);
+  }
+  if (iree_status_is_ok(status)) {
+    iree_atomic_store_int32(&iree_flight_recorder_enabled_, 1,
+                            iree_memory_order_release);
+  }
+  iree_slim_mutex_unlock(&recorder->mutex);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+void iree_flight_recorder_disable(void) {
+  iree_atomic_store_int32(&iree_flight_recorder_enabled_, 0,
+                          iree_memory_order_release);
+}
+
+void iree_flight_recorder_record_enabled(iree_flight_recorder_event_type_t type,
+                                         uint64_t arg0, uint64_t arg1) {
+  // Synchronizes with the release in iree_flight_recorder_enable so that the
+  // ring is visible.
+  if (!iree_atomic_load_int32(&iree_flight_recorder_enabled_,
+                              iree_memory_order_acquire)) {
+    return;
+  }
+  iree_flight_recorder_t* recorder = &iree_flight_recorder_;
+  int64_t index = iree_atomic_fetch_add_int64(&recorder->head, 1,
+                                              iree_memory_order_relaxed);
+  iree_flight_recorder_slot_t* slot =
+      &recorder->slots[index & (recorder->capacity - 1)];
+  iree_atomic_store_int64(&slot->sequence, 0, iree_memory_order_relaxed);
+  iree_atomic_thread_fence(iree_memory_order_release);
+  slot->ticks = iree_flight_recorder_ticks();
+  slot->thread_id = iree_flight_recorder_thread_id();
+  slot->arg0 = arg0;
+  slot->arg1 = arg1;
+  slot->type = (uint64_t)type;
+  iree_atomic_store_int64(&slot->sequence, index + 1,
+                          iree_memory_order_release);
+}
+
+//===----------------------------------------------------------------------===//
+// Chrome trace JSON
+//===----------------------------------------------------------------------===//
+
+// Maximum number of distinct threads given small ids in the output. Threads
+// beyond this share the last id.
+#define IREE_FLIGHT_RECORDER_MAX_THREADS 256
+
+typedef struct iree_flight_recorder_writer_t {
+  FILE* file;
+  bool first_event;
+  uint64_t base_ticks;
+  double ns_per_tick;
+  iree_host_size_t thread_count;
+  uint64_t thread_ids[IREE_FLIGHT_RECORDER_MAX_THREADS];
+} iree_flight_recorder_writer_t;
+
+// Returns a small stable id for |thread_id| so that traces are readable.
+static iree_host_size_t iree_flight_recorder_writer_tid(
+    iree_flight_recorder_writer_t* writer, uint64_t thread_id) {
+  for (iree_host_size_t i = 0; i < writer->thread_count; ++i) {
+    if (writer->thread_ids[i] == thread_id) return i;
+  }
+  if (writer->thread_count == IREE_FLIGHT_RECORDER_MAX_THREADS) {
+    return IREE_FLIGHT_RECORDER_MAX_THREADS - 1;
+  }
+  writer->thread_ids[writer->thread_count] = thread_id;
+  return writer->thread_count++;
+}
+
+static void iree_flight_recorder_write_event(
+    iree_flight_recorder_writer_t* writer,
+    const iree_flight_recorder_slot_t* event) {
+  const char* name = NULL;
+  const char* phase = NULL;
+  bool async = false;
+  switch ((iree_flight_recorder_event_type_t)event->type) {
+    case IREE_FLIGHT_RECORDER_EVENT_DISPATCH_BEGIN:
+      name = "dispatch", phase = "b", async = true;
+      break;
+    case IREE_FLIGHT_RECORDER_EVENT_DISPATCH_END:
+      name = "dispatch", phase = "e", async = true;
+      break;
+    case IREE_FLIGHT_RECORDER_EVENT_QUEUE_SUBMIT:
+      name = "queue_submit", phase = "i";
+      break;
+    case IREE_FLIGHT_RECORDER_EVENT_WAIT_BEGIN:
+      name = "wait", phase = "B";
+      break;
+    case IREE_FLIGHT_RECORDER_EVENT_WAIT_END:
+      name = "wait", phase = "E";
+      break;
+    case IREE_FLIGHT_RECORDER_EVENT_USER:
+      name = "user", phase = "i";
+      break;
+    default:
+      return;
+  }
+  // Ticks may be read on different cores before the base was taken.
+  double ts_us =
+      event->ticks > writer->base_ticks
+          ? (double)(event->ticks - writer->base_ticks) * writer->ns_per_tick /
+                1000.0
+          : 0.0;
+  fprintf(writer->file,
+          "%s\n{\"name\":\"%s\",\"cat\":\"iree\",\"ph\":\"%s\",\"ts\":%.3f,"
+          "\"pid\":0,\"tid\":%" PRIhsz,
+          writer->first_event ? "" : ",", name, phase, ts_us,
+          iree_flight_recorder_writer_tid(writer, event->thread_id));
+  if (async) {
+    fprintf(writer->file, ",\"id\":\"0x%" PRIx64 "\"", event->arg0);
+  } else if (phase[0] == 'i') {
+    fprintf(writer->file, ",\"s\":\"t\"");
+  }
+  fprintf(writer->file,
+          ",\"args\":{\"arg0\":%" PRIu64 ",\"arg1\":%" PRIu64 "}}",
+          event->arg0, event->arg1);
+  writer->first_event = false;
+}
+
+iree_status_t iree_flight_recorder_fwrite(FILE* file) {
+  IREE_ASSERT_ARGUMENT(file);
+  iree_flight_recorder_t* recorder = &iree_flight_recorder_;
+  if (!iree_atomic_load_int32(&iree_flight_recorder_enabled_,
+                              iree_memory_order_acquire) &&
+      !recorder->slots) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "flight recorder has not been enabled");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // The writer state is large enough that it does not belong on the stack of
+  // whatever thread happens to request a dump.
+  iree_flight_recorder_writer_t* writer = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(iree_allocator_system(), sizeof(*writer),
+                                (void**)&writer));
+  memset(writer, 0, sizeof(*writer));
+  writer->file = file;
+  writer->first_event = true;
+  writer->base_ticks = recorder->base_ticks;
+  uint64_t now_ticks = iree_flight_recorder_ticks();
+  iree_time_t now_ns = iree_time_now();
+  writer->ns_per_tick =
+      now_ticks > recorder->base_ticks && now_ns > recorder->base_time_ns
+          ? (double)(now_ns - recorder->base_time_ns) /
+                (double)(now_ticks - recorder->base_ticks)
+          : 1.0;
+
+  int64_t head =
+      iree_atomic_load_int64(&recorder->head, iree_memory_order_acquire);
+  int64_t capacity = (int64_t)recorder->capacity;
+  int64_t begin = head > capacity ? head - capacity : 0;
+  int64_t skipped_count = 0;
+  fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+  for (int64_t i = begin; i < head; ++i) {
+    iree_flight_recorder_slot_t* slot = &recorder->slots[i & (capacity - 1)];
+    int64_t sequence =
+        iree_atomic_load_int64(&slot->sequence, iree_memory_order_acquire);
+    iree_flight_recorder_slot_t event;
+    event.ticks = slot->ticks;
+    event.thread_id = slot->thread_id;
+    event.arg0 = slot->arg0;
+    event.arg1 = slot->arg1;
+    event.type = slot->type;
+    iree_atomic_thread_fence(iree_memory_order_acquire);
+    if (sequence != i + 1 ||
+        iree_atomic_load_int64(&slot->sequence, iree_memory_order_relaxed) !=
+            sequence) {
+      // Still being written or overwritten by a newer event.
+      ++skipped_count;
+      continue;
+    }
+    iree_flight_recorder_write_event(writer, &event);
+  }
+  fprintf(file,
+          "\n],\"otherData\":{\"base_time_ns\":\"%" PRId64
+          "\",\"recorded_events\":\"%" PRId64 "\",\"dropped_events\":\"%" PRId64
+          "\",\"skipped_events\":\"%" PRId64 "\"}}\n",
+          recorder->base_time_ns, head, begin, skipped_count);
+  iree_allocator_free(iree_allocator_system(), writer);
+
+  iree_status_t status = iree_ok_status();
+  if (fflush(file) != 0 || ferror(file)) {
+    status = iree_make_status(IREE_STATUS_DATA_LOSS,
+                              "failed to write flight recorder events");
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_flight_recorder_dump_to_file(const char* path) {
+  IREE_ASSERT_ARGUMENT(path);
+  FILE* file = fopen(path, "wb");
+  if (!file) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to open '%s' for writing", path);
+  }
+  iree_status_t status = iree_flight_recorder_fwrite(file);
+  fclose(file);
+  return status;
+}
+
+//===----------------------------------------------------------------------===//
+// Signal handling
+//===----------------------------------------------------------------------===//
+
+#if IREE_FLIGHT_RECORDER_HAVE_SIGNALS
+
+static void iree_flight_recorder_signal_handler(int signal_number) {
+  // Only async-signal-safe calls are allowed here: wake the dump thread.
+  int saved_errno = errno;
+  char byte = 0;
+  if (write(iree_flight_recorder_.signal_pipe[1], &byte, 1) < 0) {
+    // The dump thread is already pending; nothing else can be done here.
+  }
+  errno = saved_errno;
+}
+
+static int iree_flight_recorder_signal_thread_main(void* entry_arg) {
+  iree_flight_recorder_t* recorder = (iree_flight_recorder_t*)entry_arg;
+  for (;;) {
+    char byte = 0;
+    ssize_t result = read(recorder->signal_pipe[0], &byte, 1);
+    if (result < 0 && errno == EINTR) continue;
+    if (result <= 0) break;
+    iree_status_t status =
+        iree_flight_recorder_dump_to_file(recorder->signal_path);
+    if (!iree_status_is_ok(status)) {
+      iree_status_fprint(stderr, status);
+      iree_status_free(status);
+    }
+  }
+  return 0;
+}
+
+iree_status_t iree_flight_recorder_install_signal_handler(int signal_number,
+                                                          const char* path) {
+  IREE_ASSERT_ARGUMENT(path);
+  iree_call_once(&iree_flight_recorder_once_, iree_flight_recorder_initialize);
+  iree_flight_recorder_t* recorder = &iree_flight_recorder_;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_slim_mutex_lock(&recorder->mutex);
+  iree_status_t status = iree_ok_status();
+  if (recorder->signal_path) {
+    status = iree_make_status(IREE_STATUS_ALREADY_EXISTS,
+                              "flight recorder signal handler already "
+                              "installed");
+  }
+
+  // The path, pipe, and thread live for the remainder of the process.
+  if (iree_status_is_ok(status)) {
+    iree_host_size_t path_length = strlen(path);
+    status = iree_allocator_malloc(iree_allocator_system(), path_length + 1,
+                                   (void**)&recorder->signal_path);
+    if (iree_status_is_ok(status)) {
+      memcpy(recorder->signal_path, path, path_length + 1);
+    }
+  }
+  if (iree_status_is_ok(status) && pipe(recorder->signal_pipe) != 0) {
+    status = iree_make_status(iree_status_code_from_errno(errno),
+                              "failed to create the signal pipe");
+  }
+  if (iree_status_is_ok(status)) {
+    iree_thread_create_params_t params;
+    memset(&params, 0, sizeof(params));
+    params.name = iree_make_cstring_view("iree-flight-recorder");
+    iree_thread_t* thread = NULL;
+    status = iree_thread_create(iree_flight_recorder_signal_thread_main,
+                                recorder, params, iree_allocator_system(),
+                                &thread);
+  }
+  if (iree_status_is_ok(status)) {
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = iree_flight_recorder_signal_handler;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(signal_number, &action, NULL) != 0) {
+      status = iree_make_status(iree_status_code_from_errno(errno),
+                                "failed to install handler for signal %d",
+                                signal_number);
+    }
+  }
+  iree_slim_mutex_unlock(&recorder->mutex);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+#else
+
+iree_status_t iree_flight_recorder_install_signal_handler(int signal_number,
+                                                          const char* path) {
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "signals are not available on this platform");
+}
+
+#endif  // IREE_FLIGHT_RECORDER_HAVE_SIGNALS
@@ -0,0 +1,112 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// A process-wide always-available event recorder for diagnosing latency in
+// builds without tracing (IREE_TRACING_FEATURES) enabled.
+//
+// The recorder keeps the most recent events in a fixed-size ring buffer and is
+// disabled until iree_flight_recorder_enable is called. While disabled each
+// event site costs a single relaxed atomic load. While enabled recording an
+// event reads the CPU timestamp counter and claims a ring slot with one atomic
+// increment; no locks are taken and nothing is allocated.
+//
+// The contents of the ring can be written at any time as Chrome trace event
+// JSON (loadable in chrome://tracing or https://ui.perfetto.dev) either with
+// iree_flight_recorder_fwrite/iree_flight_recorder_dump_to_file or, on POSIX
+// platforms, when the process receives a signal registered with
+// iree_flight_recorder_install_signal_handler.
+//
+// The HAL records queue submissions and semaphore waits and the local
+// executors record the beginning and end of each dispatch.
+
+#ifndef IREE_BASE_INTERNAL_FLIGHT_RECORDER_H_
+#define IREE_BASE_INTERNAL_FLIGHT_RECORDER_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Types of events recorded in the ring.
+typedef enum iree_flight_recorder_event_type_e {
+  IREE_FLIGHT_RECORDER_EVENT_NONE = 0,
+  // A dispatch began executing.
+  // arg0 identifies the dispatch and matches the DISPATCH_END event.
+  // arg1 is the total number of workgroups.
+  IREE_FLIGHT_RECORDER_EVENT_DISPATCH_BEGIN,
+  // A dispatch completed.
+  // arg0 identifies the dispatch and matches the DISPATCH_BEGIN event.
+  IREE_FLIGHT_RECORDER_EVENT_DISPATCH_END,
+  // Work was submitted to a device queue.
+  // arg0 is the number of command buffers and arg1 the queue affinity.
+  IREE_FLIGHT_RECORDER_EVENT_QUEUE_SUBMIT,
+  // The calling thread began blocking on one or more semaphores.
+  // arg0 is the number of semaphores and arg1 the earliest deadline (ns).
+  IREE_FLIGHT_RECORDER_EVENT_WAIT_BEGIN,
+  // The calling thread stopped blocking.
+  // arg0 is the status code of the wait.
+  IREE_FLIGHT_RECORDER_EVENT_WAIT_END,
+  // An application-defined event with application-defined arguments.
+  IREE_FLIGHT_RECORDER_EVENT_USER,
+} iree_flight_recorder_event_type_t;
+
+// Nonzero while the recorder is enabled. Use iree_flight_recorder_is_enabled.
+extern iree_atomic_int32_t iree_flight_recorder_enabled_;
+
+// Enables recording of the most recent |capacity| events (rounded up to a
+// power of two). The ring is allocated on the first call and lives for the
+// remainder of the process; later calls succeed only if |capacity| is not
+// larger than the existing ring and re-enable recording into it.
+iree_status_t iree_flight_recorder_enable(iree_host_size_t capacity);
+
+// Stops recording events. Events already in the ring are retained and can
+// still be written.
+void iree_flight_recorder_disable(void);
+
+// Returns true if events are currently being recorded.
+static inline bool iree_flight_recorder_is_enabled(void) {
+  return iree_atomic_load_int32(&iree_flight_recorder_enabled_,
+                                iree_memory_order_relaxed) != 0;
+}
+
+void iree_flight_recorder_record_enabled(iree_flight_recorder_event_type_t type,
+                                         uint64_t arg0, uint64_t arg1);
+
+// Records an event of |type| with two type-specific arguments if the recorder
+// is enabled. Thread-safe and lock-free.
+static inline void iree_flight_recorder_record(
+    iree_flight_recorder_event_type_t type, uint64_t arg0, uint64_t arg1) {
+  if (IREE_UNLIKELY(iree_flight_recorder_is_enabled())) {
+    iree_flight_recorder_record_enabled(type, arg0, arg1);
+  }
+}
+
+// Writes the events currently in the ring to |file| as Chrome trace JSON.
+// Recording may continue concurrently; events overwritten while being written
+// are skipped.
+iree_status_t iree_flight_recorder_fwrite(FILE* file);
+
+// Writes the events currently in the ring to a new file at |path|.
+iree_status_t iree_flight_recorder_dump_to_file(const char* path);
+
+// Writes the ring to |path| each time the process receives |signal_number|
+// (such as SIGUSR1). The signal handler only wakes a dedicated thread that
+// performs the write so that no unsafe work happens in signal context. May be
+// called once per process and returns IREE_STATUS_UNIMPLEMENTED on platforms
+// without POSIX signals.
+iree_status_t iree_flight_recorder_install_signal_handler(int signal_number,
+                                                          const char* path);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_BASE_INTERNAL_FLIGHT_RECORDER_H_
@@ -0,0 +1,123 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/flight_recorder.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+// The recorder is process-wide so all tests share one ring of this size.
+constexpr iree_host_size_t kCapacity = 8;
+
+class FlightRecorderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_ASSERT_OK(iree_flight_recorder_enable(kCapacity));
+  }
+
+  void TearDown() override { iree_flight_recorder_disable(); }
+
+  std::string Dump() {
+    FILE* file = tmpfile();
+    IREE_CHECK_OK(iree_flight_recorder_fwrite(file));
+    std::string result;
+    rewind(file);
+    char chunk[256];
+    size_t length = 0;
+    while ((length = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+      result.append(chunk, length);
+    }
+    fclose(file);
+    return result;
+  }
+
+  // Returns the total number of events recorded since the ring was created.
+  int64_t RecordedCount() {
+    std::string json = Dump();
+    const std::string key = "\"recorded_events\":\"";
+    size_t offset = json.find(key);
+    if (offset == std::string::npos) return -1;
+    return std::strtoll(json.c_str() + offset + key.size(), nullptr, 10);
+  }
+};
+
+TEST_F(FlightRecorderTest, WritesChromeTrace) {
+  iree_flight_recorder_record(IREE_FLIGHT_RECORDER_EVENT_DISPATCH_BEGIN, 0xAB,
+                              64);
+  iree_flight_recorder_record(IREE_FLIGHT_RECORDER_EVENT_DISPATCH_END, 0xAB, 0);
+  iree_flight_recorder_record(IREE_FLIGHT_RECORDER_EVENT_QUEUE_SUBMIT, 2, 1);
+
+  std::string json = Dump();
+  EXPECT_EQ(0, json.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["));
+  EXPECT_NE(std::string::npos, json.find("\"name\":\"dispatch\",\"cat\":"
+                                         "\"iree\",\"ph\":\"b\""));
+  EXPECT_NE(std::string::npos, json.find("\"ph\":\"e\""));
+  EXPECT_NE(std::string::npos, json.find("\"id\":\"0xab\""));
+  EXPECT_NE(std::string::npos, json.find("\"name\":\"queue_submit\""));
+  EXPECT_NE(std::string::npos, json.find("\"args\":{\"arg0\":2,\"arg1\":1}"));
+}
+
+// Only the most recent events are kept once the ring wraps.
+TEST_F(FlightRecorderTest, KeepsMostRecentEvents) {
+  for (uint64_t i = 0; i < 3 * kCapacity; ++i) {
+    iree_flight_recorder_record(IREE_FLIGHT_RECORDER_EVENT_USER, 1000 + i, 0);
+  }
+
+  std::string json = Dump();
+  EXPECT_EQ(std::string::npos,
+            json.find("\"arg0\":" + std::to_string(1000 + 2 * kCapacity - 1)));
+  for (uint64_t i = 2 * kCapacity; i < 3 * kCapacity; ++i) {
+    EXPECT_NE(std::string::npos,
+              json.find("\"arg0\":" + std::to_string(1000 + i)));
+  }
+}
+
+TEST_F(FlightRecorderTest, DisabledRecordsNothing) {
+  int64_t count = RecordedCount();
+  iree_flight_recorder_disable();
+  EXPECT_FALSE(iree_flight_recorder_is_enabled());
+  iree_flight_recorder_record(IREE_FLIGHT_RECORDER_EVENT_USER, 0, 0);
+  EXPECT_EQ(count, RecordedCount());
+
+  IREE_ASSERT_OK(iree_flight_recorder_enable(kCapacity));
+  EXPECT_TRUE(iree_flight_recorder_is_enabled());
+  iree_flight_recorder_record(IREE_FLIGHT_RECORDER_EVENT_USER, 0, 0);
+  EXPECT_EQ(count + 1, RecordedCount());
+}
+
+// The ring is allocated once and cannot grow after events may be in flight.
+TEST_F(FlightRecorderTest, CannotGrow) {
+  IREE_EXPECT_OK(iree_flight_recorder_enable(kCapacity / 2));
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_FAILED_PRECONDITION,
+                        iree_flight_recorder_enable(kCapacity * 2));
+}
+
+TEST_F(FlightRecorderTest, ConcurrentRecording) {
+  constexpr int kThreadCount = 4;
+  constexpr int kEventsPerThread = 1000;
+  int64_t count = RecordedCount();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadCount; ++i) {
+    threads.emplace_back([]() {
+      for (int j = 0; j < kEventsPerThread; ++j) {
+        iree_flight_recorder_record(IREE_FLIGHT_RECORDER_EVENT_USER, j, 0);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(count + kThreadCount * kEventsPerThread, RecordedCount());
+}
+
+}  // namespace
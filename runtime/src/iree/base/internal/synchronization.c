@@ -57,42 +57,6 @@
 #define IREE_DISABLE_THREAD_SAFETY_ANALYSIS \
   IREE_THREAD_ANNOTATION_ATTRIBUTE(no_thread_safety_analysis)
 
-//==============================================================================
-// Cross-platform processor yield (where supported)
-//==============================================================================
-
-#if defined(IREE_COMPILER_MSVC)
-
-// MSVC uses architecture-specific intrinsics.
-
-static inline void iree_processor_yield(void) {
-#if defined(IREE_ARCH_X86_32) || defined(IREE_ARCH_X86_64)
-  // https://docs.microsoft.com/en-us/cpp/intrinsics/x86-intrinsics-list
-  _mm_pause();
-#elif defined(IREE_ARCH_ARM_64)
-  // https://docs.microsoft.com/en-us/cpp/intrinsics/arm64-intrinsics
-  __yield();
-#else
-  // None available; we'll spin hard.
-#endif  // IREE_ARCH_*
-}
-
-#else
-
-// Clang/GCC and compatibles use architecture-specific inline assembly.
-
-static inline void iree_processor_yield(void) {
-#if defined(IREE_ARCH_X86_32) || defined(IREE_ARCH_X86_64)
-  asm volatile("pause");
-#elif defined(IREE_ARCH_ARM_32) || defined(IREE_ARCH_ARM_64)
-  asm volatile("yield");
-#else
-  // None available; we'll spin hard.
-#endif  // IREE_ARCH_*
-}
-
-#endif  // IREE_COMPILER_*
-
 //==============================================================================
 // Cross-platform futex mappings (where supported)
 //==============================================================================
@@ -619,6 +583,11 @@ bool iree_notification_commit_wait(iree_notification_t* notification,
 
 void iree_notification_cancel_wait(iree_notification_t* notification) {}
 
+bool iree_notification_poll(iree_notification_t* notification,
+                            iree_wait_token_t wait_token) {
+  return true;
+}
+
 #elif !defined(IREE_PLATFORM_HAS_FUTEX)
 
 // Emulation of a lock-free futex-backed notification using pthreads.
@@ -710,6 +679,14 @@ void iree_notification_cancel_wait(iree_notification_t* notification) {
   pthread_mutex_unlock(&notification->mutex);
 }
 
+bool iree_notification_poll(iree_notification_t* notification,
+                            iree_wait_token_t wait_token) {
+  pthread_mutex_lock(&notification->mutex);
+  bool result = notification->epoch != wait_token;
+  pthread_mutex_unlock(&notification->mutex);
+  return result;
+}
+
 #else
 
 // The 64-bit value used to atomically read-modify-write (RMW) the state is
@@ -848,6 +825,12 @@ void iree_notification_cancel_wait(iree_notification_t* notification) {
   SYNC_ASSERT((previous_value & IREE_NOTIFICATION_WAITER_MASK) != 0);
 }
 
+bool iree_notification_poll(iree_notification_t* notification,
+                            iree_wait_token_t wait_token) {
+  return iree_notification_test_wait_condition(notification, wait_token) ==
+         IREE_NOTIFICATION_RESULT_RESOLVED;
+}
+
 #endif  // DISABLED / HAS_FUTEX
 
 bool iree_notification_await(iree_notification_t* notification,
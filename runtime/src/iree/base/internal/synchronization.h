@@ -20,6 +20,10 @@
 #include "iree/base/target_platform.h"
 #include "iree/base/tracing.h"
 
+#if defined(IREE_COMPILER_MSVC)
+#include <intrin.h>  // iree_processor_yield
+#endif  // IREE_COMPILER_MSVC
+
 // NOTE: clang cannot support thread annotations in C code due to some
 // representational bugs... which means that we can't use it here. Boo.
 // There's some workarounds I've seen but getting TSAN working would be much
@@ -81,6 +85,44 @@ extern "C" {
 #define IREE_ALL_WAITERS INT32_MAX
 #define IREE_INFINITE_TIMEOUT_MS UINT32_MAX
 
+//==============================================================================
+// Cross-platform processor yield (where supported)
+//==============================================================================
+
+#if defined(IREE_COMPILER_MSVC)
+
+// MSVC uses architecture-specific intrinsics.
+
+// Hints to the processor that the caller is in a spin-wait loop.
+static inline void iree_processor_yield(void) {
+#if defined(IREE_ARCH_X86_32) || defined(IREE_ARCH_X86_64)
+  // https://docs.microsoft.com/en-us/cpp/intrinsics/x86-intrinsics-list
+  _mm_pause();
+#elif defined(IREE_ARCH_ARM_64)
+  // https://docs.microsoft.com/en-us/cpp/intrinsics/arm64-intrinsics
+  __yield();
+#else
+  // None available; we'll spin hard.
+#endif  // IREE_ARCH_*
+}
+
+#else
+
+// Clang/GCC and compatibles use architecture-specific inline assembly.
+
+// Hints to the processor that the caller is in a spin-wait loop.
+static inline void iree_processor_yield(void) {
+#if defined(IREE_ARCH_X86_32) || defined(IREE_ARCH_X86_64)
+  __asm__ __volatile__("pause");
+#elif defined(IREE_ARCH_ARM_32) || defined(IREE_ARCH_ARM_64)
+  __asm__ __volatile__("yield");
+#else
+  // None available; we'll spin hard.
+#endif  // IREE_ARCH_*
+}
+
+#endif  // IREE_COMPILER_*
+
 //==============================================================================
 // iree_mutex_t
 //==============================================================================
@@ -417,6 +459,16 @@ bool iree_notification_commit_wait(iree_notification_t* notification,
                                    iree_duration_t spin_ns,
                                    iree_time_t deadline_ns);
 
+// Returns true if a notification has been posted since |wait_token| was
+// captured by iree_notification_prepare_wait. Never blocks and does not count
+// as a waiter: the token remains valid after iree_notification_cancel_wait so
+// callers can poll for posts without forcing posters into the system wake API.
+//
+// Acts as (at least) a memory_order_acquire operation on the notification
+// object when returning true.
+bool iree_notification_poll(iree_notification_t* notification,
+                            iree_wait_token_t wait_token);
+
 // Cancels a pending wait operation without blocking.
 //
 // Acts as (at least) a memory_order_relaxed barrier:
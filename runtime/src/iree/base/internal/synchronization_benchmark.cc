@@ -8,6 +8,7 @@
 #include <mutex>
 
 #include "benchmark/benchmark.h"
+#include "iree/base/internal/atomic_slist.h"
 #include "iree/base/internal/synchronization.h"
 
 namespace {
@@ -245,6 +246,90 @@ BENCHMARK_TEMPLATE(BM_Contended, std::mutex)
     ->Arg(50)
     ->Arg(200);
 
+//==============================================================================
+// iree_atomic_slist_t
+//==============================================================================
+
+// Shared list pre-populated with enough entries that threads rarely find it
+// empty. Entries are never freed as the list may be in use by other benchmark
+// threads.
+struct SlistShared {
+  static constexpr int kEntryCount = 4096;
+  iree_atomic_slist_t list;
+  iree_atomic_slist_entry_t entries[kEntryCount];
+  SlistShared() {
+    iree_atomic_slist_initialize(&list);
+    for (int i = 0; i < kEntryCount; ++i) {
+      iree_atomic_slist_push(&list, &entries[i]);
+    }
+  }
+};
+
+SlistShared* GetSlistShared() {
+  static auto* shared = new SlistShared();
+  return shared;
+}
+
+// Models a free list: each iteration pops an entry, does some local work, and
+// pushes it back.
+void BM_SlistPushPop(benchmark::State& state) {
+  SlistShared* shared = GetSlistShared();
+  int local = 0;
+  for (auto _ : state) {
+    iree_atomic_slist_entry_t* entry = iree_atomic_slist_pop(&shared->list);
+    SpinDelay(static_cast<int>(state.range(0)), &local);
+    if (entry) iree_atomic_slist_push(&shared->list, entry);
+  }
+}
+
+BENCHMARK(BM_SlistPushPop)
+    ->UseRealTime()
+    // ThreadPerCpu poorly handles non-power-of-two CPU counts.
+    ->Threads(1)
+    ->Threads(2)
+    ->Threads(4)
+    ->Threads(8)
+    ->Threads(16)
+    ->Threads(32)
+    ->Threads(64)
+    ->Threads(96)
+    ->Threads(128)
+    // Local work between operations; 0 is maximum contention.
+    ->Arg(0)
+    ->Arg(10);
+
+// Models a mailbox: each iteration steals the entire list and splices it back.
+void BM_SlistFlushConcat(benchmark::State& state) {
+  SlistShared* shared = GetSlistShared();
+  int local = 0;
+  for (auto _ : state) {
+    iree_atomic_slist_entry_t* head = NULL;
+    iree_atomic_slist_entry_t* tail = NULL;
+    if (iree_atomic_slist_flush(
+            &shared->list, IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_LIFO,
+            &head, &tail)) {
+      SpinDelay(static_cast<int>(state.range(0)), &local);
+      iree_atomic_slist_concat(&shared->list, head, tail);
+    }
+  }
+}
+
+BENCHMARK(BM_SlistFlushConcat)
+    ->UseRealTime()
+    // ThreadPerCpu poorly handles non-power-of-two CPU counts.
+    ->Threads(1)
+    ->Threads(2)
+    ->Threads(4)
+    ->Threads(8)
+    ->Threads(16)
+    ->Threads(32)
+    ->Threads(64)
+    ->Threads(96)
+    ->Threads(128)
+    // Local work between operations; 0 is maximum contention.
+    ->Arg(0)
+    ->Arg(10);
+
 //==============================================================================
 // iree_notification_t
 //==============================================================================
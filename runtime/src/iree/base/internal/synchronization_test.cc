@@ -215,4 +215,24 @@ TEST(NotificationTest, Timeout) {
   iree_notification_deinitialize(&notification);
 }
 
+TEST(NotificationTest, Poll) {
+  iree_notification_t notification;
+  iree_notification_initialize(&notification);
+
+  // Polling doesn't require remaining registered as a waiter.
+  iree_wait_token_t wait_token = iree_notification_prepare_wait(&notification);
+  iree_notification_cancel_wait(&notification);
+  EXPECT_FALSE(iree_notification_poll(&notification, wait_token));
+
+  iree_notification_post(&notification, IREE_ALL_WAITERS);
+  EXPECT_TRUE(iree_notification_poll(&notification, wait_token));
+
+  // A fresh token only observes later posts.
+  wait_token = iree_notification_prepare_wait(&notification);
+  iree_notification_cancel_wait(&notification);
+  EXPECT_FALSE(iree_notification_poll(&notification, wait_token));
+
+  iree_notification_deinitialize(&notification);
+}
+
 }  // namespace
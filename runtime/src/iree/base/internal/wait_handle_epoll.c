@@ -9,58 +9,443 @@
 
 #if IREE_WAIT_API == IREE_WAIT_API_EPOLL
 
+#include <errno.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <time.h>
+#include <unistd.h>
+
 #include "iree/base/internal/wait_handle_posix.h"
 #include "iree/base/tracing.h"
 
+//===----------------------------------------------------------------------===//
+// Platform utilities
+//===----------------------------------------------------------------------===//
+
+// epoll lets us route the wait set operations right to the kernel: handles are
+// registered once on insertion and each wait only costs O(signaled handles)
+// instead of the O(total handles) poll has to pay to copy in/scan the fd list.
+// This allows sets with thousands of handles (such as those used by the task
+// system poller when many invocations are waiting on external fences).
+//
+// Registrations are level-triggered: wait sets must report handles that remain
+// signaled across waits and events may be reset without any notification to
+// the set so we cannot cache edge state ourselves.
+//
+// Documentation: https://man7.org/linux/man-pages/man7/epoll.7.html
+
+// Waits on |epoll_fd| until |deadline_ns| with EINTR handling.
+static iree_status_t iree_syscall_epoll_wait(int epoll_fd,
+                                             struct epoll_event* events,
+                                             int max_events,
+                                             iree_time_t deadline_ns,
+                                             int* out_signaled_count) {
+  *out_signaled_count = 0;
+  int rv = -1;
+  do {
+    // Recomputed each iteration as a previous attempt may have taken some of
+    // the time before being interrupted.
+    uint32_t timeout_ms = iree_absolute_deadline_to_timeout_ms(deadline_ns);
+    rv = epoll_wait(epoll_fd, events, max_events, (int)timeout_ms);
+  } while (rv < 0 && errno == EINTR);
+  if (rv > 0) {
+    // One or more events set.
+    *out_signaled_count = rv;
+    return iree_ok_status();
+  } else if (IREE_UNLIKELY(rv < 0)) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "epoll_wait failure %d", errno);
+  }
+  // rv == 0
+  // Timeout; no events set.
+  return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+}
+
+// Maps an epoll event bitfield result to a status (on failure) and an
+// indicator of whether the event was signaled.
+static iree_status_t iree_wait_set_resolve_epoll_events(uint32_t events,
+                                                        bool* out_signaled) {
+  if (events & EPOLLERR) {
+    return iree_make_status(IREE_STATUS_INTERNAL, "EPOLLERR on fd");
+  } else if (events & EPOLLHUP) {
+    return iree_make_status(IREE_STATUS_CANCELLED, "EPOLLHUP on fd");
+  }
+  *out_signaled = (events & EPOLLIN) != 0;
+  return iree_ok_status();
+}
+
 //===----------------------------------------------------------------------===//
 // iree_wait_set_t
 //===----------------------------------------------------------------------===//
 
-// TODO(benvanik): iree_wait_set_s using an epoll fd.
-// epoll lets us route the wait set operations right to kernel and not need our
-// own duplicate data structure. epoll is great, just not available on mac/ios
-// so we still need poll for that. linux/android/bsd all have epoll, though.
+// Maximum number of events retrieved from the kernel per wait syscall.
+#define IREE_WAIT_SET_EPOLL_EVENT_CAPACITY 64
+
 struct iree_wait_set_t {
-  // NOTE: we could in theory use the epoll handle directly (iree_wait_set_s
-  // then is just a pointer). Then allocate/free just go straight to the system.
-  int reserved;
+  iree_allocator_t allocator;
+
+  // epoll instance with one registration per unique handle in the set.
+  // The registration data is the index of the handle in |user_handles|.
+  int epoll_fd;
+
+  // Total capacity of |user_handles|. Grows on demand up to UINT16_MAX (the
+  // limit of iree_wait_handle_t::set_internal.index).
+  iree_host_size_t handle_capacity;
+
+  // Total number of unique handles in |user_handles|.
+  iree_host_size_t handle_count;
+
+  // User-provided handles with duplicates tracked in set_internal.dupe_count.
+  // Ordering is unspecified and erasure swaps with the tail.
+  iree_wait_handle_t* user_handles;
+
+  // Storage for events returned from the kernel.
+  struct epoll_event events[IREE_WAIT_SET_EPOLL_EVENT_CAPACITY];
 };
 
+// Registers (or updates) |fd| with the set epoll instance.
+static iree_status_t iree_wait_set_epoll_ctl(iree_wait_set_t* set, int op,
+                                             int fd, uint32_t events,
+                                             iree_host_size_t index) {
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = events;
+  event.data.u64 = (uint64_t)index;
+  if (IREE_UNLIKELY(epoll_ctl(set->epoll_fd, op, fd, &event) < 0)) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "epoll_ctl(%d) failure %d on fd %d", op, errno, fd);
+  }
+  return iree_ok_status();
+}
+
 iree_status_t iree_wait_set_allocate(iree_host_size_t capacity,
                                      iree_allocator_t allocator,
                                      iree_wait_set_t** out_set) {
-  // TODO(benvanik): epoll_create()
+  IREE_ASSERT_ARGUMENT(out_set);
+  *out_set = NULL;
+
+  // Capacity is only the initial reservation; sets grow as needed.
+  if (capacity >= UINT16_MAX) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "wait set capacity of %zu is unreasonably large",
+                            capacity);
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_wait_set_t* set = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(allocator, sizeof(*set), (void**)&set));
+  memset(set, 0, sizeof(*set));
+  set->allocator = allocator;
+  set->epoll_fd = -1;
+
+  iree_status_t status = iree_ok_status();
+  if (capacity > 0) {
+    status = iree_allocator_malloc(allocator,
+                                   capacity * sizeof(*set->user_handles),
+                                   (void**)&set->user_handles);
+    if (iree_status_is_ok(status)) set->handle_capacity = capacity;
+  }
+
+  if (iree_status_is_ok(status)) {
+    set->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (IREE_UNLIKELY(set->epoll_fd < 0)) {
+      status = iree_make_status(iree_status_code_from_errno(errno),
+                                "epoll_create1 failure %d", errno);
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_set = set;
+  } else {
+    iree_wait_set_free(set);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 void iree_wait_set_free(iree_wait_set_t* set) {
-  // TODO(benvanik): close()
+  if (!set) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  if (set->epoll_fd >= 0) close(set->epoll_fd);
+  iree_allocator_free(set->allocator, set->user_handles);
+  iree_allocator_free(set->allocator, set);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+bool iree_wait_set_is_empty(const iree_wait_set_t* set) {
+  return set->handle_count != 0;
+}
+
+// Grows the |set| handle storage to hold at least |minimum_capacity| handles.
+static iree_status_t iree_wait_set_reserve(iree_wait_set_t* set,
+                                           iree_host_size_t minimum_capacity) {
+  if (minimum_capacity <= set->handle_capacity) return iree_ok_status();
+  if (minimum_capacity >= UINT16_MAX) {
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "wait set capacity reached");
+  }
+  iree_host_size_t new_capacity =
+      iree_max(iree_max((iree_host_size_t)16, set->handle_capacity * 2),
+               minimum_capacity);
+  new_capacity = iree_min(new_capacity, (iree_host_size_t)UINT16_MAX - 1);
+
+  // NOTE: not all allocators support realloc (like arenas) so we always
+  // allocate a new list and copy.
+  iree_wait_handle_t* new_handles = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      set->allocator, new_capacity * sizeof(*new_handles),
+      (void**)&new_handles));
+  if (set->handle_count > 0) {
+    memcpy(new_handles, set->user_handles,
+           set->handle_count * sizeof(*new_handles));
+  }
+  iree_allocator_free(set->allocator, set->user_handles);
+  set->user_handles = new_handles;
+  set->handle_capacity = new_capacity;
+  return iree_ok_status();
+}
+
+// Returns the index of |handle| in |set| or -1 if not found.
+static int iree_wait_set_find(iree_wait_set_t* set,
+                              const iree_wait_handle_t* handle) {
+  // Fast path when the handle came from an iree_wait_any and the set has not
+  // been changed since.
+  iree_host_size_t index = handle->set_internal.index;
+  if (index < set->handle_count &&
+      iree_wait_primitive_compare_identical(&set->user_handles[index],
+                                            handle)) {
+    return (int)index;
+  }
+  for (iree_host_size_t i = 0; i < set->handle_count; ++i) {
+    if (iree_wait_primitive_compare_identical(&set->user_handles[i], handle)) {
+      return (int)i;
+    }
+  }
+  return -1;
 }
 
 iree_status_t iree_wait_set_insert(iree_wait_set_t* set,
                                    iree_wait_handle_t handle) {
-  // TODO(benvanik): epoll_ctl(EPOLL_CTL_ADD)
+  int fd = iree_wait_primitive_get_read_fd(&handle);
+  if (IREE_UNLIKELY(fd < 0)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "wait handle has no pollable fd");
+  }
+
+  // Try to register the handle with the kernel. This fails with EEXIST if the
+  // handle is already in the set which lets us skip scanning for duplicates
+  // in the common case of unique handles.
+  IREE_RETURN_IF_ERROR(iree_wait_set_reserve(set, set->handle_count + 1));
+  iree_host_size_t index = set->handle_count;
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN | EPOLLPRI;
+  event.data.u64 = (uint64_t)index;
+  if (epoll_ctl(set->epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+    if (errno != EEXIST) {
+      return iree_make_status(iree_status_code_from_errno(errno),
+                              "epoll_ctl(ADD) failure %d on fd %d", errno, fd);
+    }
+    // Duplicate handles share a single kernel registration.
+    int existing_index = iree_wait_set_find(set, &handle);
+    if (IREE_UNLIKELY(existing_index < 0)) {
+      return iree_make_status(IREE_STATUS_INTERNAL,
+                              "fd %d registered but not tracked in the set",
+                              fd);
+    }
+    iree_wait_handle_t* user_handle = &set->user_handles[existing_index];
+    if (user_handle->set_internal.dupe_count + 1 >= UINT16_MAX) {
+      return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                              "too many duplicate handles in the wait set");
+    }
+    ++user_handle->set_internal.dupe_count;
+    return iree_ok_status();
+  }
+
+  iree_wait_handle_t* user_handle = &set->user_handles[index];
+  iree_wait_handle_wrap_primitive(handle.type, handle.value, user_handle);
+  ++set->handle_count;
+  return iree_ok_status();
 }
 
 void iree_wait_set_erase(iree_wait_set_t* set, iree_wait_handle_t handle) {
-  // TODO(benvanik): epoll_ctl(EPOLL_CTL_DEL)
+  int index = iree_wait_set_find(set, &handle);
+  if (IREE_UNLIKELY(index < 0)) return;
+
+  iree_wait_handle_t* user_handle = &set->user_handles[index];
+  if (user_handle->set_internal.dupe_count > 0) {
+    --user_handle->set_internal.dupe_count;
+    return;
+  }
+
+  // NOTE: the fd may have already been closed which implicitly removes it from
+  // the epoll set; we ignore failures here.
+  int fd = iree_wait_primitive_get_read_fd(user_handle);
+  epoll_ctl(set->epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+
+  // Since we make no guarantees about the order of the list we can just swap
+  // with the last value. The moved handle needs its registration updated so
+  // the kernel reports the new index.
+  int tail_index = (int)set->handle_count - 1;
+  if (tail_index > index) {
+    memcpy(&set->user_handles[index], &set->user_handles[tail_index],
+           sizeof(*set->user_handles));
+    int tail_fd = iree_wait_primitive_get_read_fd(&set->user_handles[index]);
+    iree_status_ignore(iree_wait_set_epoll_ctl(set, EPOLL_CTL_MOD, tail_fd,
+                                               EPOLLIN | EPOLLPRI, index));
+  }
+  --set->handle_count;
 }
 
 void iree_wait_set_clear(iree_wait_set_t* set) {
-  // TODO(benvanik): close and reopen?
+  // Cheaper to recreate the epoll instance than to remove each fd.
+  if (set->handle_count > 0) {
+    int new_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (new_epoll_fd >= 0) {
+      close(set->epoll_fd);
+      set->epoll_fd = new_epoll_fd;
+    } else {
+      for (iree_host_size_t i = 0; i < set->handle_count; ++i) {
+        epoll_ctl(set->epoll_fd, EPOLL_CTL_DEL,
+                  iree_wait_primitive_get_read_fd(&set->user_handles[i]), NULL);
+      }
+    }
+  }
+  set->handle_count = 0;
 }
 
 iree_status_t iree_wait_all(iree_wait_set_t* set, iree_time_t deadline_ns) {
-  // TODO(benvanik): epoll_wait
+  // Make the syscall only when we have at least one valid fd.
+  // Don't use this as a sleep.
+  if (set->handle_count <= 0) {
+    return iree_ok_status();
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Wait-all requires that we repeatedly wait until all handles have been
+  // signaled. As registrations are level-triggered we disable each handle as it
+  // is observed signaled so the kernel stops reporting it and then restore all
+  // of them once the wait completes. Most waits are wait-any and this path is
+  // not expected to be hot.
+  iree_status_t status = iree_ok_status();
+  iree_host_size_t unsignaled_count = set->handle_count;
+  while (iree_status_is_ok(status) && unsignaled_count > 0) {
+    int signaled_count = 0;
+    status = iree_syscall_epoll_wait(set->epoll_fd, set->events,
+                                     IREE_WAIT_SET_EPOLL_EVENT_CAPACITY,
+                                     deadline_ns, &signaled_count);
+    for (int i = 0; i < signaled_count && iree_status_is_ok(status); ++i) {
+      bool signaled = false;
+      status = iree_wait_set_resolve_epoll_events(set->events[i].events,
+                                                  &signaled);
+      if (!iree_status_is_ok(status) || !signaled) continue;
+      iree_host_size_t index = (iree_host_size_t)set->events[i].data.u64;
+      status = iree_wait_set_epoll_ctl(
+          set, EPOLL_CTL_MOD,
+          iree_wait_primitive_get_read_fd(&set->user_handles[index]), 0, index);
+      --unsignaled_count;
+    }
+  }
+
+  // Re-enable all handles so that the next wait can happen. Handles that were
+  // never disabled are harmlessly re-armed.
+  for (iree_host_size_t i = 0; i < set->handle_count; ++i) {
+    iree_status_ignore(iree_wait_set_epoll_ctl(
+        set, EPOLL_CTL_MOD,
+        iree_wait_primitive_get_read_fd(&set->user_handles[i]),
+        EPOLLIN | EPOLLPRI, i));
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 iree_status_t iree_wait_any(iree_wait_set_t* set, iree_time_t deadline_ns,
                             iree_wait_handle_t* out_wake_handle) {
-  // TODO(benvanik): epoll_wait
+  // Make the syscall only when we have at least one valid fd.
+  // Don't use this as a sleep.
+  if (set->handle_count <= 0) {
+    memset(out_wake_handle, 0, sizeof(*out_wake_handle));
+    return iree_ok_status();
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // TODO(benvanik): see if we can use tracy's mutex tracking to make waits
+  // nicer (at least showing signal->wait relations).
+
+  int signaled_count = 0;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_syscall_epoll_wait(set->epoll_fd, set->events,
+                                  IREE_WAIT_SET_EPOLL_EVENT_CAPACITY,
+                                  deadline_ns, &signaled_count));
+
+  // Find at least one signaled handle.
+  memset(out_wake_handle, 0, sizeof(*out_wake_handle));
+  for (int i = 0; i < signaled_count; ++i) {
+    bool signaled = false;
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0,
+        iree_wait_set_resolve_epoll_events(set->events[i].events, &signaled));
+    if (signaled) {
+      iree_host_size_t index = (iree_host_size_t)set->events[i].data.u64;
+      memcpy(out_wake_handle, &set->user_handles[index],
+             sizeof(*out_wake_handle));
+      out_wake_handle->set_internal.index = index;
+      break;
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
 }
 
 iree_status_t iree_wait_one(iree_wait_handle_t* handle,
                             iree_time_t deadline_ns) {
-  // TODO(benvanik): just use poll?
+  // Single waits don't benefit from epoll and would require creating an
+  // instance; we use ppoll directly instead.
+  struct pollfd poll_fd;
+  poll_fd.fd = iree_wait_primitive_get_read_fd(handle);
+  if (poll_fd.fd == -1) return iree_ok_status();
+  poll_fd.events = POLLIN;
+  poll_fd.revents = 0;
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  int rv = -1;
+  do {
+    // See wait_handle_poll.c for details on the timeout handling.
+    struct timespec timeout_ts;
+    struct timespec* tmo_p = &timeout_ts;
+    if (deadline_ns == IREE_TIME_INFINITE_PAST) {
+      memset(&timeout_ts, 0, sizeof(timeout_ts));
+    } else if (deadline_ns == IREE_TIME_INFINITE_FUTURE) {
+      tmo_p = NULL;
+    } else {
+      iree_duration_t timeout_ns = deadline_ns - iree_time_now();
+      if (timeout_ns < 0) {
+        memset(&timeout_ts, 0, sizeof(timeout_ts));
+      } else {
+        timeout_ts.tv_sec = (time_t)(timeout_ns / 1000000000ull);
+        timeout_ts.tv_nsec = (long)(timeout_ns % 1000000000ull);
+      }
+    }
+    rv = ppoll(&poll_fd, 1, tmo_p, NULL);
+  } while (rv < 0 && errno == EINTR);
+
+  iree_status_t status = iree_ok_status();
+  if (rv == 0) {
+    status = iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+  } else if (IREE_UNLIKELY(rv < 0)) {
+    status = iree_make_status(iree_status_code_from_errno(errno),
+                              "ppoll failure %d", errno);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 #endif  // IREE_WAIT_API == IREE_WAIT_API_EPOLL
@@ -0,0 +1,191 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/arm_64/elementwise_arm_64.h"
+
+#include <arm_neon.h>
+
+// Advanced SIMD is part of the ARM 64-bit baseline, so these row functions
+// don't depend on any cpu_data bit.
+
+//===----------------------------------------------------------------------===//
+// Vector math helpers.
+//===----------------------------------------------------------------------===//
+
+// Computes expf as 2^n * e^r with n = round(x / ln2) and a degree 6 polynomial
+// approximating e^r on [-ln2/2, ln2/2] (Cephes). Inputs are clamped so that
+// 2^(n - 1) is a normal float, results below FLT_MIN being flushed to zero.
+static inline float32x4_t iree_uk_expf_arm_64(float32x4_t x) {
+  x = vminq_f32(vmaxq_f32(x, vdupq_n_f32(-87.3365478515625f)),
+                vdupq_n_f32(88.3762626647949f));
+  float32x4_t n = vrndnq_f32(vmulq_n_f32(x, 1.44269504088896341f));
+  float32x4_t r = vfmsq_f32(x, n, vdupq_n_f32(0.693359375f));
+  r = vfmsq_f32(r, n, vdupq_n_f32(-2.12194440e-4f));
+  float32x4_t y = vdupq_n_f32(1.9875691500e-4f);
+  y = vfmaq_f32(vdupq_n_f32(1.3981999507e-3f), y, r);
+  y = vfmaq_f32(vdupq_n_f32(8.3334519073e-3f), y, r);
+  y = vfmaq_f32(vdupq_n_f32(4.1665795894e-2f), y, r);
+  y = vfmaq_f32(vdupq_n_f32(1.6666665459e-1f), y, r);
+  y = vfmaq_f32(vdupq_n_f32(5.0000001201e-1f), y, r);
+  y = vfmaq_f32(vaddq_f32(r, vdupq_n_f32(1.0f)), y, vmulq_f32(r, r));
+  // Scale by 2^(n - 1) then 2 so that n = 128 doesn't overflow the exponent.
+  int32x4_t e = vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(n), vdupq_n_s32(126)), 23);
+  y = vmulq_f32(y, vreinterpretq_f32_s32(e));
+  return vaddq_f32(y, y);
+}
+
+// Computes tanhf as a 13/6 rational approximation on [-7.9, 7.9], outside of
+// which tanhf rounds to +-1 (Eigen).
+static inline float32x4_t iree_uk_tanhf_arm_64(float32x4_t x) {
+  uint32x4_t tiny = vcltq_f32(vabsq_f32(x), vdupq_n_f32(0.0004f));
+  float32x4_t c = vminq_f32(vmaxq_f32(x, vdupq_n_f32(-7.90531110763549805f)),
+                            vdupq_n_f32(7.90531110763549805f));
+  float32x4_t c2 = vmulq_f32(c, c);
+  float32x4_t p = vdupq_n_f32(-2.76076847742355e-16f);
+  p = vfmaq_f32(vdupq_n_f32(2.00018790482477e-13f), p, c2);
+  p = vfmaq_f32(vdupq_n_f32(-8.60467152213735e-11f), p, c2);
+  p = vfmaq_f32(vdupq_n_f32(5.12229709037114e-08f), p, c2);
+  p = vfmaq_f32(vdupq_n_f32(1.48572235717979e-05f), p, c2);
+  p = vfmaq_f32(vdupq_n_f32(6.37261928875436e-04f), p, c2);
+  p = vfmaq_f32(vdupq_n_f32(4.89352455891786e-03f), p, c2);
+  p = vmulq_f32(p, c);
+  float32x4_t q = vdupq_n_f32(1.19825839466702e-06f);
+  q = vfmaq_f32(vdupq_n_f32(1.18534705686654e-04f), q, c2);
+  q = vfmaq_f32(vdupq_n_f32(2.26843463243900e-03f), q, c2);
+  q = vfmaq_f32(vdupq_n_f32(4.89352518554385e-03f), q, c2);
+  return vbslq_f32(tiny, x, vdivq_f32(p, q));
+}
+
+//===----------------------------------------------------------------------===//
+// Row functions.
+//===----------------------------------------------------------------------===//
+
+// Defines a x32b row function computing 4 elements at a time as EXPR(a, b),
+// where a and b are VTYPE vectors of TYPE elements.
+#define IREE_UK_X32B_ROW_FUNC_ARM_64(NAME, TYPE, VTYPE, SUFFIX, EXPR)        \
+  static iree_uk_ssize_t iree_uk_x32b_##NAME##_row_arm_64(                   \
+      const iree_uk_uint32_t* lhs, iree_uk_ssize_t lhs_stride,               \
+      const iree_uk_uint32_t* rhs, iree_uk_ssize_t rhs_stride,               \
+      iree_uk_uint32_t* IREE_UK_RESTRICT out, iree_uk_ssize_t size) {        \
+    const TYPE* l = (const TYPE*)lhs;                                        \
+    const TYPE* r = (const TYPE*)rhs;                                        \
+    TYPE* o = (TYPE*)out;                                                    \
+    VTYPE l_bcast = vdupq_n_##SUFFIX(l[0]);                                  \
+    VTYPE r_bcast = vdupq_n_##SUFFIX(r[0]);                                  \
+    iree_uk_ssize_t i = 0;                                                   \
+    for (; i + 4 <= size; i += 4) {                                          \
+      VTYPE a = lhs_stride ? vld1q_##SUFFIX(l + i) : l_bcast;                \
+      VTYPE b = rhs_stride ? vld1q_##SUFFIX(r + i) : r_bcast;                \
+      vst1q_##SUFFIX(o + i, EXPR(a, b));                                     \
+    }                                                                        \
+    return i;                                                                \
+  }
+
+// Defines a x32u row function computing 4 elements at a time as EXPR(a).
+#define IREE_UK_X32U_ROW_FUNC_ARM_64(NAME, TYPE, VTYPE, SUFFIX, EXPR)        \
+  static iree_uk_ssize_t iree_uk_x32u_##NAME##_row_arm_64(                   \
+      const iree_uk_uint32_t* in, iree_uk_uint32_t* IREE_UK_RESTRICT out,    \
+      iree_uk_ssize_t size) {                                                \
+    const TYPE* x = (const TYPE*)in;                                         \
+    TYPE* o = (TYPE*)out;                                                    \
+    iree_uk_ssize_t i = 0;                                                   \
+    for (; i + 4 <= size; i += 4) {                                          \
+      vst1q_##SUFFIX(o + i, EXPR(vld1q_##SUFFIX(x + i)));                    \
+    }                                                                        \
+    return i;                                                                \
+  }
+
+#define IREE_UK_RSQRTF_ARM_64(a) vdivq_f32(vdupq_n_f32(1.0f), vsqrtq_f32(a))
+
+IREE_UK_X32B_ROW_FUNC_ARM_64(addf, float, float32x4_t, f32, vaddq_f32)
+IREE_UK_X32B_ROW_FUNC_ARM_64(subf, float, float32x4_t, f32, vsubq_f32)
+IREE_UK_X32B_ROW_FUNC_ARM_64(mulf, float, float32x4_t, f32, vmulq_f32)
+IREE_UK_X32B_ROW_FUNC_ARM_64(divf, float, float32x4_t, f32, vdivq_f32)
+// FMAX and FMIN propagate NaNs like arith.maxf and arith.minf.
+IREE_UK_X32B_ROW_FUNC_ARM_64(maxf, float, float32x4_t, f32, vmaxq_f32)
+IREE_UK_X32B_ROW_FUNC_ARM_64(minf, float, float32x4_t, f32, vminq_f32)
+IREE_UK_X32B_ROW_FUNC_ARM_64(addi, iree_uk_uint32_t, uint32x4_t, u32,
+                             vaddq_u32)
+IREE_UK_X32B_ROW_FUNC_ARM_64(subi, iree_uk_uint32_t, uint32x4_t, u32,
+                             vsubq_u32)
+IREE_UK_X32B_ROW_FUNC_ARM_64(muli, iree_uk_uint32_t, uint32x4_t, u32,
+                             vmulq_u32)
+IREE_UK_X32B_ROW_FUNC_ARM_64(andi, iree_uk_uint32_t, uint32x4_t, u32,
+                             vandq_u32)
+IREE_UK_X32B_ROW_FUNC_ARM_64(ori, iree_uk_uint32_t, uint32x4_t, u32, vorrq_u32)
+IREE_UK_X32B_ROW_FUNC_ARM_64(xori, iree_uk_uint32_t, uint32x4_t, u32,
+                             veorq_u32)
+
+IREE_UK_X32U_ROW_FUNC_ARM_64(absf, float, float32x4_t, f32, vabsq_f32)
+IREE_UK_X32U_ROW_FUNC_ARM_64(ceilf, float, float32x4_t, f32, vrndpq_f32)
+IREE_UK_X32U_ROW_FUNC_ARM_64(ctlz, iree_uk_uint32_t, uint32x4_t, u32,
+                             vclzq_u32)
+IREE_UK_X32U_ROW_FUNC_ARM_64(expf, float, float32x4_t, f32,
+                             iree_uk_expf_arm_64)
+IREE_UK_X32U_ROW_FUNC_ARM_64(floorf, float, float32x4_t, f32, vrndmq_f32)
+IREE_UK_X32U_ROW_FUNC_ARM_64(negf, float, float32x4_t, f32, vnegq_f32)
+IREE_UK_X32U_ROW_FUNC_ARM_64(rsqrtf, float, float32x4_t, f32,
+                             IREE_UK_RSQRTF_ARM_64)
+IREE_UK_X32U_ROW_FUNC_ARM_64(tanhf, float, float32x4_t, f32,
+                             iree_uk_tanhf_arm_64)
+
+iree_uk_x32b_row_func_t iree_uk_x32b_select_row_func_arm_64(
+    iree_uk_x32b_opcode_t opcode, const iree_uk_uint64_t* cpu_data) {
+  (void)cpu_data;
+  switch (opcode) {
+    case IREE_UK_X32B_ADDF:
+      return iree_uk_x32b_addf_row_arm_64;
+    case IREE_UK_X32B_ADDI:
+      return iree_uk_x32b_addi_row_arm_64;
+    case IREE_UK_X32B_ANDI:
+      return iree_uk_x32b_andi_row_arm_64;
+    case IREE_UK_X32B_DIVF:
+      return iree_uk_x32b_divf_row_arm_64;
+    case IREE_UK_X32B_MAXF:
+      return iree_uk_x32b_maxf_row_arm_64;
+    case IREE_UK_X32B_MINF:
+      return iree_uk_x32b_minf_row_arm_64;
+    case IREE_UK_X32B_MULF:
+      return iree_uk_x32b_mulf_row_arm_64;
+    case IREE_UK_X32B_MULI:
+      return iree_uk_x32b_muli_row_arm_64;
+    case IREE_UK_X32B_ORI:
+      return iree_uk_x32b_ori_row_arm_64;
+    case IREE_UK_X32B_SUBF:
+      return iree_uk_x32b_subf_row_arm_64;
+    case IREE_UK_X32B_SUBI:
+      return iree_uk_x32b_subi_row_arm_64;
+    case IREE_UKENREL_X32B_XORI:
+      return iree_uk_x32b_xori_row_arm_64;
+    default:
+      return 0;
+  }
+}
+
+iree_uk_x32u_row_func_t iree_uk_x32u_select_row_func_arm_64(
+    iree_uk_x32u_opcode_t opcode, const iree_uk_uint64_t* cpu_data) {
+  (void)cpu_data;
+  switch (opcode) {
+    case IREE_UK_X32U_ABSF:
+      return iree_uk_x32u_absf_row_arm_64;
+    case IREE_UK_X32U_CEILF:
+      return iree_uk_x32u_ceilf_row_arm_64;
+    case IREE_UK_X32U_CTLZ:
+      return iree_uk_x32u_ctlz_row_arm_64;
+    case IREE_UK_X32U_EXPF:
+      return iree_uk_x32u_expf_row_arm_64;
+    case IREE_UK_X32U_FLOORF:
+      return iree_uk_x32u_floorf_row_arm_64;
+    case IREE_UK_X32U_NEGF:
+      return iree_uk_x32u_negf_row_arm_64;
+    case IREE_UK_X32U_RSQRTF:
+      return iree_uk_x32u_rsqrtf_row_arm_64;
+    case IREE_UK_X32U_TANHF:
+      return iree_uk_x32u_tanhf_row_arm_64;
+    default:
+      return 0;
+  }
+}
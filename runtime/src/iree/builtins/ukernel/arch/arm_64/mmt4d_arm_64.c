@@ -13,6 +13,10 @@ IREE_UK_MMT4D_TILE_FUNC_DECL(iree_uk_mmt4d_tile_f32f32f32_8x8x1_arm_64)
 IREE_UK_MMT4D_TILE_FUNC_DECL(iree_uk_mmt4d_tile_i8i8i32_8x8x1_arm_64)
 IREE_UK_MMT4D_TILE_FUNC_DECL(iree_uk_mmt4d_tile_i8i8i32_8x8x4_arm_64_dotprod)
 IREE_UK_MMT4D_TILE_FUNC_DECL(iree_uk_mmt4d_tile_i8i8i32_8x8x8_arm_64_i8mm)
+IREE_UK_MMT4D_TILE_FUNC_DECL(
+    iree_uk_mmt4d_tile_f16f16f32_8x8x1_arm_64_fp16fml)
+IREE_UK_MMT4D_TILE_FUNC_DECL(
+    iree_uk_mmt4d_tile_bf16bf16f32_8x8x4_arm_64_bf16)
 
 static iree_uk_mmt4d_tile_func_t
 iree_uk_mmt4d_select_tile_func_arm_64_i8i8i32_8x8x8(
@@ -40,6 +44,32 @@ iree_uk_mmt4d_select_tile_func_arm_64_i8i8i32_8x8x4(
   return 0;
 }
 
+static iree_uk_mmt4d_tile_func_t
+iree_uk_mmt4d_select_tile_func_arm_64_f16f16f32_8x8x1(
+    const iree_uk_mmt4d_params_t* params) {
+#ifdef IREE_UK_BUILD_ARM_64_FP16FML
+  if (params->cpu_data[0] & IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_FP16FML) {
+    return iree_uk_mmt4d_tile_f16f16f32_8x8x1_arm_64_fp16fml;
+  }
+#else
+  (void)params;
+#endif
+  return 0;
+}
+
+static iree_uk_mmt4d_tile_func_t
+iree_uk_mmt4d_select_tile_func_arm_64_bf16bf16f32_8x8x4(
+    const iree_uk_mmt4d_params_t* params) {
+#ifdef IREE_UK_BUILD_ARM_64_BF16
+  if (params->cpu_data[0] & IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_BF16) {
+    return iree_uk_mmt4d_tile_bf16bf16f32_8x8x4_arm_64_bf16;
+  }
+#else
+  (void)params;
+#endif
+  return 0;
+}
+
 static iree_uk_mmt4d_tile_func_t
 iree_uk_mmt4d_select_tile_func_arm_64_f32f32f32(
     const iree_uk_mmt4d_params_t* params) {
@@ -63,6 +93,24 @@ static iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func_arm_64_i8i8i32(
   return 0;
 }
 
+static iree_uk_mmt4d_tile_func_t
+iree_uk_mmt4d_select_tile_func_arm_64_f16f16f32(
+    const iree_uk_mmt4d_params_t* params) {
+  if (params->M0 == 8 && params->N0 == 8 && params->K0 == 1) {
+    return iree_uk_mmt4d_select_tile_func_arm_64_f16f16f32_8x8x1(params);
+  }
+  return 0;
+}
+
+static iree_uk_mmt4d_tile_func_t
+iree_uk_mmt4d_select_tile_func_arm_64_bf16bf16f32(
+    const iree_uk_mmt4d_params_t* params) {
+  if (params->M0 == 8 && params->N0 == 8 && params->K0 == 4) {
+    return iree_uk_mmt4d_select_tile_func_arm_64_bf16bf16f32_8x8x4(params);
+  }
+  return 0;
+}
+
 iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func_arm_64(
     const iree_uk_mmt4d_params_t* params) {
   switch (params->type) {
@@ -70,6 +118,13 @@ iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func_arm_64(
       return iree_uk_mmt4d_select_tile_func_arm_64_f32f32f32(params);
     case iree_uk_mmt4d_type_i8i8i32:
       return iree_uk_mmt4d_select_tile_func_arm_64_i8i8i32(params);
+    case iree_uk_mmt4d_type_f16f16f32:
+      return iree_uk_mmt4d_select_tile_func_arm_64_f16f16f32(params);
+    case iree_uk_mmt4d_type_bf16bf16f32:
+      return iree_uk_mmt4d_select_tile_func_arm_64_bf16bf16f32(params);
+    case iree_uk_mmt4d_type_f16f16f16:
+      // No arm64 kernel yet: use the generic tile function.
+      return 0;
     default:
       IREE_UK_ASSUME_UNREACHABLE;
       return 0;
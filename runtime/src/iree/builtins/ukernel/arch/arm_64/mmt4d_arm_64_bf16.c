@@ -0,0 +1,62 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <arm_neon.h>
+
+#include "iree/builtins/ukernel/arch/arm_64/mmt4d_arm_64.h"
+
+// 8x8x4 bf16 tile accumulating into f32 with BFMMLA. Like SMMLA in the i8mm
+// kernel, each BFMMLA accumulates a 2x2 block of the tile from a pair of LHS
+// rows and a pair of RHS columns (each 4 deep along K), so the accumulators
+// hold the tile as 2x2 blocks: acc[4 * i + j] holds rows 2i..2i+1 and columns
+// 2j..2j+1. Loads and stores zip 64-bit halves to convert from and to the
+// row-major tile layout.
+void iree_uk_mmt4d_tile_bf16bf16f32_8x8x4_arm_64_bf16(
+    void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
+    const void* IREE_UK_RESTRICT rhs_panel, iree_uk_int32_t K,
+    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params) {
+  float* IREE_UK_RESTRICT out_ptr = out_tile;
+  const bfloat16_t* IREE_UK_RESTRICT lhs_ptr = lhs_panel;
+  const bfloat16_t* IREE_UK_RESTRICT rhs_ptr = rhs_panel;
+  float32x4_t acc[16];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < 4; ++i) {
+      for (int j = 0; j < 2; ++j) {
+        float64x2_t row0 =
+            vreinterpretq_f64_f32(vld1q_f32(out_ptr + 16 * i + 4 * j));
+        float64x2_t row1 =
+            vreinterpretq_f64_f32(vld1q_f32(out_ptr + 16 * i + 8 + 4 * j));
+        acc[4 * i + 2 * j + 0] = vreinterpretq_f32_f64(vzip1q_f64(row0, row1));
+        acc[4 * i + 2 * j + 1] = vreinterpretq_f32_f64(vzip2q_f64(row0, row1));
+      }
+    }
+  } else {
+    for (int i = 0; i < 16; ++i) acc[i] = vdupq_n_f32(0);
+  }
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    bfloat16x8_t lhs[4];
+    bfloat16x8_t rhs[4];
+    for (int i = 0; i < 4; ++i) lhs[i] = vld1q_bf16(lhs_ptr + 8 * i);
+    for (int j = 0; j < 4; ++j) rhs[j] = vld1q_bf16(rhs_ptr + 8 * j);
+    lhs_ptr += 32;
+    rhs_ptr += 32;
+    for (int i = 0; i < 4; ++i) {
+      for (int j = 0; j < 4; ++j) {
+        acc[4 * i + j] = vbfmmlaq_f32(acc[4 * i + j], lhs[i], rhs[j]);
+      }
+    }
+  }
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 2; ++j) {
+      float64x2_t blk0 = vreinterpretq_f64_f32(acc[4 * i + 2 * j + 0]);
+      float64x2_t blk1 = vreinterpretq_f64_f32(acc[4 * i + 2 * j + 1]);
+      vst1q_f32(out_ptr + 16 * i + 4 * j,
+                vreinterpretq_f32_f64(vzip1q_f64(blk0, blk1)));
+      vst1q_f32(out_ptr + 16 * i + 8 + 4 * j,
+                vreinterpretq_f32_f64(vzip2q_f64(blk0, blk1)));
+    }
+  }
+}
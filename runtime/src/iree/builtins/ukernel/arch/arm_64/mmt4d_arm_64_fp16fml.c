@@ -0,0 +1,49 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <arm_neon.h>
+
+#include "iree/builtins/ukernel/arch/arm_64/mmt4d_arm_64.h"
+
+// Accumulates the outer product of the 8 RHS values with LHS lane |I| into
+// row I of the tile, widening to f32 with FMLAL/FMLAL2.
+#define IREE_UK_FP16FML_ROW(I)                                              \
+  acc[2 * (I)] = vfmlalq_laneq_low_f16(acc[2 * (I)], rhs, lhs, I);          \
+  acc[2 * (I) + 1] = vfmlalq_laneq_high_f16(acc[2 * (I) + 1], rhs, lhs, I);
+
+// 8x8x1 f16 tile accumulating into f32. The 8x8 f32 accumulator tile is held
+// in 16 registers, two per row.
+void iree_uk_mmt4d_tile_f16f16f32_8x8x1_arm_64_fp16fml(
+    void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
+    const void* IREE_UK_RESTRICT rhs_panel, iree_uk_int32_t K,
+    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params) {
+  float* IREE_UK_RESTRICT out_ptr = out_tile;
+  const float16_t* IREE_UK_RESTRICT lhs_ptr = lhs_panel;
+  const float16_t* IREE_UK_RESTRICT rhs_ptr = rhs_panel;
+  float32x4_t acc[16];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < 16; ++i) acc[i] = vld1q_f32(out_ptr + 4 * i);
+  } else {
+    for (int i = 0; i < 16; ++i) acc[i] = vdupq_n_f32(0);
+  }
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    float16x8_t lhs = vld1q_f16(lhs_ptr);
+    lhs_ptr += 8;
+    float16x8_t rhs = vld1q_f16(rhs_ptr);
+    rhs_ptr += 8;
+    IREE_UK_FP16FML_ROW(0)
+    IREE_UK_FP16FML_ROW(1)
+    IREE_UK_FP16FML_ROW(2)
+    IREE_UK_FP16FML_ROW(3)
+    IREE_UK_FP16FML_ROW(4)
+    IREE_UK_FP16FML_ROW(5)
+    IREE_UK_FP16FML_ROW(6)
+    IREE_UK_FP16FML_ROW(7)
+  }
+  for (int i = 0; i < 16; ++i) vst1q_f32(out_ptr + 4 * i, acc[i]);
+}
+
+#undef IREE_UK_FP16FML_ROW
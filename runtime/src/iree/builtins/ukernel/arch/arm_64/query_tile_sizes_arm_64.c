@@ -31,6 +31,29 @@ iree_uk_query_matmul_tile_sizes_arm_64_i8i8i32(
   return (iree_uk_matmul_tile_sizes_t){.M = 8, .K = 1, .N = 8};
 }
 
+static iree_uk_matmul_tile_sizes_t
+iree_uk_query_matmul_tile_sizes_arm_64_f16f16f32(
+    const iree_uk_query_tile_sizes_2d_params_t* params) {
+  return (iree_uk_matmul_tile_sizes_t){.M = 8, .K = 1, .N = 8};
+}
+
+static iree_uk_matmul_tile_sizes_t
+iree_uk_query_matmul_tile_sizes_arm_64_f16f16f16(
+    const iree_uk_query_tile_sizes_2d_params_t* params) {
+  return (iree_uk_matmul_tile_sizes_t){.M = 8, .K = 1, .N = 8};
+}
+
+static iree_uk_matmul_tile_sizes_t
+iree_uk_query_matmul_tile_sizes_arm_64_bf16bf16f32(
+    const iree_uk_query_tile_sizes_2d_params_t* params) {
+#ifdef IREE_UK_BUILD_ARM_64_BF16
+  if (params->cpu_data[0] & IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_BF16) {
+    return (iree_uk_matmul_tile_sizes_t){.M = 8, .K = 4, .N = 8};
+  }
+#endif
+  return (iree_uk_matmul_tile_sizes_t){.M = 8, .K = 1, .N = 8};
+}
+
 bool iree_uk_query_matmul_tile_sizes_arm_64(
     const iree_uk_query_tile_sizes_2d_params_t* params,
     iree_uk_matmul_tile_sizes_t* out_matmul_tile_sizes) {
@@ -43,6 +66,18 @@ bool iree_uk_query_matmul_tile_sizes_arm_64(
     *out_matmul_tile_sizes =
         iree_uk_query_matmul_tile_sizes_arm_64_i8i8i32(params);
     return true;
+  } else if (op == IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_F16F16F32) {
+    *out_matmul_tile_sizes =
+        iree_uk_query_matmul_tile_sizes_arm_64_f16f16f32(params);
+    return true;
+  } else if (op == IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_F16F16F16) {
+    *out_matmul_tile_sizes =
+        iree_uk_query_matmul_tile_sizes_arm_64_f16f16f16(params);
+    return true;
+  } else if (op == IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_BF16BF16F32) {
+    *out_matmul_tile_sizes =
+        iree_uk_query_matmul_tile_sizes_arm_64_bf16bf16f32(params);
+    return true;
   } else {
     // Can't happen, validated earlier.
     IREE_UK_ASSUME_UNREACHABLE;
@@ -0,0 +1,159 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/x86_64/elementwise_x86_64.h"
+
+#include "iree/builtins/ukernel/arch/x86_64/config.h"
+#include "iree/schemas/cpu_data.h"
+
+#define IREE_UK_X32B_ROW_FUNC_DECL(NAME)                          \
+  iree_uk_ssize_t NAME(                                           \
+      const iree_uk_uint32_t* lhs, iree_uk_ssize_t lhs_stride,    \
+      const iree_uk_uint32_t* rhs, iree_uk_ssize_t rhs_stride,    \
+      iree_uk_uint32_t* IREE_UK_RESTRICT out, iree_uk_ssize_t size);
+
+#define IREE_UK_X32U_ROW_FUNC_DECL(NAME)                                    \
+  iree_uk_ssize_t NAME(const iree_uk_uint32_t* in,                          \
+                       iree_uk_uint32_t* IREE_UK_RESTRICT out,              \
+                       iree_uk_ssize_t size);
+
+#define IREE_UK_X32B_ROW_FUNCS_DECL(OP)                                  \
+  IREE_UK_X32B_ROW_FUNC_DECL(iree_uk_x32b_##OP##_row_x86_64_avx2_fma)    \
+  IREE_UK_X32B_ROW_FUNC_DECL(iree_uk_x32b_##OP##_row_x86_64_avx512_base)
+
+#define IREE_UK_X32U_ROW_FUNCS_DECL(OP)                                  \
+  IREE_UK_X32U_ROW_FUNC_DECL(iree_uk_x32u_##OP##_row_x86_64_avx2_fma)    \
+  IREE_UK_X32U_ROW_FUNC_DECL(iree_uk_x32u_##OP##_row_x86_64_avx512_base)
+
+IREE_UK_X32B_ROW_FUNCS_DECL(addf)
+IREE_UK_X32B_ROW_FUNCS_DECL(addi)
+IREE_UK_X32B_ROW_FUNCS_DECL(andi)
+IREE_UK_X32B_ROW_FUNCS_DECL(divf)
+IREE_UK_X32B_ROW_FUNCS_DECL(maxf)
+IREE_UK_X32B_ROW_FUNCS_DECL(minf)
+IREE_UK_X32B_ROW_FUNCS_DECL(mulf)
+IREE_UK_X32B_ROW_FUNCS_DECL(muli)
+IREE_UK_X32B_ROW_FUNCS_DECL(ori)
+IREE_UK_X32B_ROW_FUNCS_DECL(subf)
+IREE_UK_X32B_ROW_FUNCS_DECL(subi)
+IREE_UK_X32B_ROW_FUNCS_DECL(xori)
+
+IREE_UK_X32U_ROW_FUNCS_DECL(absf)
+IREE_UK_X32U_ROW_FUNCS_DECL(ceilf)
+IREE_UK_X32U_ROW_FUNCS_DECL(expf)
+IREE_UK_X32U_ROW_FUNCS_DECL(floorf)
+IREE_UK_X32U_ROW_FUNCS_DECL(negf)
+IREE_UK_X32U_ROW_FUNCS_DECL(rsqrtf)
+IREE_UK_X32U_ROW_FUNCS_DECL(tanhf)
+// AVX2 has no vector count-leading-zeros, only AVX-512 CD does.
+IREE_UK_X32U_ROW_FUNC_DECL(iree_uk_x32u_ctlz_row_x86_64_avx512_base)
+
+// Row functions of code paths that weren't built are replaced by NULL.
+#ifdef IREE_UK_BUILD_X86_64_AVX2_FMA
+#define IREE_UK_ROW_FUNC_X86_64_AVX2_FMA(NAME) NAME##_x86_64_avx2_fma
+#else
+#define IREE_UK_ROW_FUNC_X86_64_AVX2_FMA(NAME) 0
+#endif
+#ifdef IREE_UK_BUILD_X86_64_AVX512_BASE
+#define IREE_UK_ROW_FUNC_X86_64_AVX512_BASE(NAME) NAME##_x86_64_avx512_base
+#else
+#define IREE_UK_ROW_FUNC_X86_64_AVX512_BASE(NAME) 0
+#endif
+
+// Returns the widest of the given row functions supported by |cpu_data|.
+static iree_uk_x32b_row_func_t iree_uk_x32b_select_row_func_x86_64_widest(
+    const iree_uk_uint64_t* cpu_data, iree_uk_x32b_row_func_t avx2_fma,
+    iree_uk_x32b_row_func_t avx512_base) {
+  if (avx512_base &&
+      (cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE)) {
+    return avx512_base;
+  }
+  if (avx2_fma && (cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA)) {
+    return avx2_fma;
+  }
+  return 0;
+}
+
+static iree_uk_x32u_row_func_t iree_uk_x32u_select_row_func_x86_64_widest(
+    const iree_uk_uint64_t* cpu_data, iree_uk_x32u_row_func_t avx2_fma,
+    iree_uk_x32u_row_func_t avx512_base) {
+  if (avx512_base &&
+      (cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE)) {
+    return avx512_base;
+  }
+  if (avx2_fma && (cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA)) {
+    return avx2_fma;
+  }
+  return 0;
+}
+
+#define IREE_UK_X32B_SELECT_ROW_FUNC_X86_64(OP)                          \
+  iree_uk_x32b_select_row_func_x86_64_widest(                            \
+      cpu_data, IREE_UK_ROW_FUNC_X86_64_AVX2_FMA(iree_uk_x32b_##OP##_row), \
+      IREE_UK_ROW_FUNC_X86_64_AVX512_BASE(iree_uk_x32b_##OP##_row))
+
+#define IREE_UK_X32U_SELECT_ROW_FUNC_X86_64(OP)                          \
+  iree_uk_x32u_select_row_func_x86_64_widest(                            \
+      cpu_data, IREE_UK_ROW_FUNC_X86_64_AVX2_FMA(iree_uk_x32u_##OP##_row), \
+      IREE_UK_ROW_FUNC_X86_64_AVX512_BASE(iree_uk_x32u_##OP##_row))
+
+iree_uk_x32b_row_func_t iree_uk_x32b_select_row_func_x86_64(
+    iree_uk_x32b_opcode_t opcode, const iree_uk_uint64_t* cpu_data) {
+  switch (opcode) {
+    case IREE_UK_X32B_ADDF:
+      return IREE_UK_X32B_SELECT_ROW_FUNC_X86_64(addf);
+    case IREE_UK_X32B_ADDI:
+      return IREE_UK_X32B_SELECT_ROW_FUNC_X86_64(addi);
+    case IREE_UK_X32B_ANDI:
+      return IREE_UK_X32B_SELECT_ROW_FUNC_X86_64(andi);
+    case IREE_UK_X32B_DIVF:
+      return IREE_UK_X32B_SELECT_ROW_FUNC_X86_64(divf);
+    case IREE_UK_X32B_MAXF:
+      return IREE_UK_X32B_SELECT_ROW_FUNC_X86_64(maxf);
+    case IREE_UK_X32B_MINF:
+      return IREE_UK_X32B_SELECT_ROW_FUNC_X86_64(minf);
+    case IREE_UK_X32B_MULF:
+      return IREE_UK_X32B_SELECT_ROW_FUNC_X86_64(mulf);
+    case IREE_UK_X32B_MULI:
+      return IREE_UK_X32B_SELECT_ROW_FUNC_X86_64(muli);
+    case IREE_UK_X32B_ORI:
+      return IREE_UK_X32B_SELECT_ROW_FUNC_X86_64(ori);
+    case IREE_UK_X32B_SUBF:
+      return IREE_UK_X32B_SELECT_ROW_FUNC_X86_64(subf);
+    case IREE_UK_X32B_SUBI:
+      return IREE_UK_X32B_SELECT_ROW_FUNC_X86_64(subi);
+    case IREE_UKENREL_X32B_XORI:
+      return IREE_UK_X32B_SELECT_ROW_FUNC_X86_64(xori);
+    default:
+      return 0;
+  }
+}
+
+iree_uk_x32u_row_func_t iree_uk_x32u_select_row_func_x86_64(
+    iree_uk_x32u_opcode_t opcode, const iree_uk_uint64_t* cpu_data) {
+  switch (opcode) {
+    case IREE_UK_X32U_ABSF:
+      return IREE_UK_X32U_SELECT_ROW_FUNC_X86_64(absf);
+    case IREE_UK_X32U_CEILF:
+      return IREE_UK_X32U_SELECT_ROW_FUNC_X86_64(ceilf);
+    case IREE_UK_X32U_CTLZ:
+      return iree_uk_x32u_select_row_func_x86_64_widest(
+          cpu_data, 0,
+          IREE_UK_ROW_FUNC_X86_64_AVX512_BASE(iree_uk_x32u_ctlz_row));
+    case IREE_UK_X32U_EXPF:
+      return IREE_UK_X32U_SELECT_ROW_FUNC_X86_64(expf);
+    case IREE_UK_X32U_FLOORF:
+      return IREE_UK_X32U_SELECT_ROW_FUNC_X86_64(floorf);
+    case IREE_UK_X32U_NEGF:
+      return IREE_UK_X32U_SELECT_ROW_FUNC_X86_64(negf);
+    case IREE_UK_X32U_RSQRTF:
+      return IREE_UK_X32U_SELECT_ROW_FUNC_X86_64(rsqrtf);
+    case IREE_UK_X32U_TANHF:
+      return IREE_UK_X32U_SELECT_ROW_FUNC_X86_64(tanhf);
+    default:
+      return 0;
+  }
+}
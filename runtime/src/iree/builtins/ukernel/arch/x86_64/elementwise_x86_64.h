@@ -0,0 +1,24 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BUILTINS_UKERNEL_ARCH_X86_64_ELEMENTWISE_X86_64_H_
+#define IREE_BUILTINS_UKERNEL_ARCH_X86_64_ELEMENTWISE_X86_64_H_
+
+#include "iree/builtins/ukernel/elementwise_row.h"
+
+// Returns the x86-64 row function to use for the x32b |opcode| on the CPU
+// described by |cpu_data|, or NULL if no suitable x86-64 row function exists,
+// in which case the caller falls back to generic code.
+iree_uk_x32b_row_func_t iree_uk_x32b_select_row_func_x86_64(
+    iree_uk_x32b_opcode_t opcode, const iree_uk_uint64_t* cpu_data);
+
+// Returns the x86-64 row function to use for the x32u |opcode| on the CPU
+// described by |cpu_data|, or NULL if no suitable x86-64 row function exists,
+// in which case the caller falls back to generic code.
+iree_uk_x32u_row_func_t iree_uk_x32u_select_row_func_x86_64(
+    iree_uk_x32u_opcode_t opcode, const iree_uk_uint64_t* cpu_data);
+
+#endif  // IREE_BUILTINS_UKERNEL_ARCH_X86_64_ELEMENTWISE_X86_64_H_
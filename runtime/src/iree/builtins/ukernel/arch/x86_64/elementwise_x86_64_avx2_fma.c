@@ -0,0 +1,150 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <immintrin.h>
+
+#include "iree/builtins/ukernel/arch/x86_64/elementwise_x86_64.h"
+
+//===----------------------------------------------------------------------===//
+// Vector math helpers.
+//===----------------------------------------------------------------------===//
+
+// MAXPS and MINPS return their second operand when either operand is NaN, so
+// passing |a| second propagates a NaN |a| and a NaN |b| is selected explicitly,
+// matching the NaN propagation of arith.maxf and arith.minf.
+static inline __m256 iree_uk_maxf_x86_64_avx2_fma(__m256 a, __m256 b) {
+  return _mm256_blendv_ps(_mm256_max_ps(b, a), b,
+                          _mm256_cmp_ps(b, b, _CMP_UNORD_Q));
+}
+
+static inline __m256 iree_uk_minf_x86_64_avx2_fma(__m256 a, __m256 b) {
+  return _mm256_blendv_ps(_mm256_min_ps(b, a), b,
+                          _mm256_cmp_ps(b, b, _CMP_UNORD_Q));
+}
+
+static inline __m256 iree_uk_absf_x86_64_avx2_fma(__m256 a) {
+  return _mm256_and_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff)));
+}
+
+static inline __m256 iree_uk_negf_x86_64_avx2_fma(__m256 a) {
+  return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f));
+}
+
+static inline __m256 iree_uk_rsqrtf_x86_64_avx2_fma(__m256 a) {
+  return _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(a));
+}
+
+// Same algorithm as iree_uk_expf_arm_64. The clamping operands are ordered so
+// that NaNs propagate.
+static inline __m256 iree_uk_expf_x86_64_avx2_fma(__m256 x) {
+  x = _mm256_min_ps(_mm256_set1_ps(88.3762626647949f),
+                    _mm256_max_ps(_mm256_set1_ps(-87.3365478515625f), x));
+  __m256 n = _mm256_round_ps(
+      _mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341f)),
+      _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  __m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(0.693359375f), x);
+  r = _mm256_fnmadd_ps(n, _mm256_set1_ps(-2.12194440e-4f), r);
+  __m256 y = _mm256_set1_ps(1.9875691500e-4f);
+  y = _mm256_fmadd_ps(y, r, _mm256_set1_ps(1.3981999507e-3f));
+  y = _mm256_fmadd_ps(y, r, _mm256_set1_ps(8.3334519073e-3f));
+  y = _mm256_fmadd_ps(y, r, _mm256_set1_ps(4.1665795894e-2f));
+  y = _mm256_fmadd_ps(y, r, _mm256_set1_ps(1.6666665459e-1f));
+  y = _mm256_fmadd_ps(y, r, _mm256_set1_ps(5.0000001201e-1f));
+  y = _mm256_fmadd_ps(y, _mm256_mul_ps(r, r),
+                      _mm256_add_ps(r, _mm256_set1_ps(1.0f)));
+  __m256i e = _mm256_slli_epi32(
+      _mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(126)), 23);
+  y = _mm256_mul_ps(y, _mm256_castsi256_ps(e));
+  return _mm256_add_ps(y, y);
+}
+
+// Same algorithm as iree_uk_tanhf_arm_64.
+static inline __m256 iree_uk_tanhf_x86_64_avx2_fma(__m256 x) {
+  __m256 tiny = _mm256_cmp_ps(iree_uk_absf_x86_64_avx2_fma(x),
+                              _mm256_set1_ps(0.0004f), _CMP_LT_OQ);
+  __m256 c = _mm256_min_ps(_mm256_set1_ps(7.90531110763549805f),
+                           _mm256_max_ps(_mm256_set1_ps(-7.90531110763549805f),
+                                         x));
+  __m256 c2 = _mm256_mul_ps(c, c);
+  __m256 p = _mm256_set1_ps(-2.76076847742355e-16f);
+  p = _mm256_fmadd_ps(p, c2, _mm256_set1_ps(2.00018790482477e-13f));
+  p = _mm256_fmadd_ps(p, c2, _mm256_set1_ps(-8.60467152213735e-11f));
+  p = _mm256_fmadd_ps(p, c2, _mm256_set1_ps(5.12229709037114e-08f));
+  p = _mm256_fmadd_ps(p, c2, _mm256_set1_ps(1.48572235717979e-05f));
+  p = _mm256_fmadd_ps(p, c2, _mm256_set1_ps(6.37261928875436e-04f));
+  p = _mm256_fmadd_ps(p, c2, _mm256_set1_ps(4.89352455891786e-03f));
+  p = _mm256_mul_ps(p, c);
+  __m256 q = _mm256_set1_ps(1.19825839466702e-06f);
+  q = _mm256_fmadd_ps(q, c2, _mm256_set1_ps(1.18534705686654e-04f));
+  q = _mm256_fmadd_ps(q, c2, _mm256_set1_ps(2.26843463243900e-03f));
+  q = _mm256_fmadd_ps(q, c2, _mm256_set1_ps(4.89352518554385e-03f));
+  return _mm256_blendv_ps(_mm256_div_ps(p, q), x, tiny);
+}
+
+//===----------------------------------------------------------------------===//
+// Row functions.
+//===----------------------------------------------------------------------===//
+
+#define IREE_UK_LOADU_PS_AVX2(ptr) _mm256_loadu_ps((const float*)(ptr))
+#define IREE_UK_LOADU_SI_AVX2(ptr) _mm256_loadu_si256((const __m256i*)(ptr))
+#define IREE_UK_STOREU_PS_AVX2(ptr, v) _mm256_storeu_ps((float*)(ptr), v)
+#define IREE_UK_STOREU_SI_AVX2(ptr, v) \
+  _mm256_storeu_si256((__m256i*)(ptr), v)
+#define IREE_UK_SET1_PS_AVX2(ptr) _mm256_broadcast_ss((const float*)(ptr))
+#define IREE_UK_SET1_SI_AVX2(ptr) \
+  _mm256_set1_epi32(*(const iree_uk_int32_t*)(ptr))
+
+// Defines a x32b row function computing 8 elements at a time as EXPR(a, b),
+// where a and b are VTYPE vectors accessed with the KIND (PS or SI) macros.
+#define IREE_UK_X32B_ROW_FUNC_AVX2(NAME, VTYPE, KIND, EXPR)               \
+  iree_uk_ssize_t iree_uk_x32b_##NAME##_row_x86_64_avx2_fma(              \
+      const iree_uk_uint32_t* lhs, iree_uk_ssize_t lhs_stride,            \
+      const iree_uk_uint32_t* rhs, iree_uk_ssize_t rhs_stride,            \
+      iree_uk_uint32_t* IREE_UK_RESTRICT out, iree_uk_ssize_t size) {     \
+    VTYPE l_bcast = IREE_UK_SET1_##KIND##_AVX2(lhs);                      \
+    VTYPE r_bcast = IREE_UK_SET1_##KIND##_AVX2(rhs);                      \
+    iree_uk_ssize_t i = 0;                                                \
+    for (; i + 8 <= size; i += 8) {                                       \
+      VTYPE a = lhs_stride ? IREE_UK_LOADU_##KIND##_AVX2(lhs + i) : l_bcast; \
+      VTYPE b = rhs_stride ? IREE_UK_LOADU_##KIND##_AVX2(rhs + i) : r_bcast; \
+      IREE_UK_STOREU_##KIND##_AVX2(out + i, EXPR(a, b));                  \
+    }                                                                     \
+    return i;                                                             \
+  }
+
+// Defines a x32u row function computing 8 elements at a time as EXPR(a).
+#define IREE_UK_X32U_ROW_FUNC_AVX2(NAME, KIND, EXPR)                      \
+  iree_uk_ssize_t iree_uk_x32u_##NAME##_row_x86_64_avx2_fma(              \
+      const iree_uk_uint32_t* in, iree_uk_uint32_t* IREE_UK_RESTRICT out, \
+      iree_uk_ssize_t size) {                                             \
+    iree_uk_ssize_t i = 0;                                                \
+    for (; i + 8 <= size; i += 8) {                                       \
+      IREE_UK_STOREU_##KIND##_AVX2(out + i,                               \
+                                   EXPR(IREE_UK_LOADU_##KIND##_AVX2(in + i))); \
+    }                                                                     \
+    return i;                                                             \
+  }
+
+IREE_UK_X32B_ROW_FUNC_AVX2(addf, __m256, PS, _mm256_add_ps)
+IREE_UK_X32B_ROW_FUNC_AVX2(subf, __m256, PS, _mm256_sub_ps)
+IREE_UK_X32B_ROW_FUNC_AVX2(mulf, __m256, PS, _mm256_mul_ps)
+IREE_UK_X32B_ROW_FUNC_AVX2(divf, __m256, PS, _mm256_div_ps)
+IREE_UK_X32B_ROW_FUNC_AVX2(maxf, __m256, PS, iree_uk_maxf_x86_64_avx2_fma)
+IREE_UK_X32B_ROW_FUNC_AVX2(minf, __m256, PS, iree_uk_minf_x86_64_avx2_fma)
+IREE_UK_X32B_ROW_FUNC_AVX2(addi, __m256i, SI, _mm256_add_epi32)
+IREE_UK_X32B_ROW_FUNC_AVX2(subi, __m256i, SI, _mm256_sub_epi32)
+IREE_UK_X32B_ROW_FUNC_AVX2(muli, __m256i, SI, _mm256_mullo_epi32)
+IREE_UK_X32B_ROW_FUNC_AVX2(andi, __m256i, SI, _mm256_and_si256)
+IREE_UK_X32B_ROW_FUNC_AVX2(ori, __m256i, SI, _mm256_or_si256)
+IREE_UK_X32B_ROW_FUNC_AVX2(xori, __m256i, SI, _mm256_xor_si256)
+
+IREE_UK_X32U_ROW_FUNC_AVX2(absf, PS, iree_uk_absf_x86_64_avx2_fma)
+IREE_UK_X32U_ROW_FUNC_AVX2(ceilf, PS, _mm256_ceil_ps)
+IREE_UK_X32U_ROW_FUNC_AVX2(expf, PS, iree_uk_expf_x86_64_avx2_fma)
+IREE_UK_X32U_ROW_FUNC_AVX2(floorf, PS, _mm256_floor_ps)
+IREE_UK_X32U_ROW_FUNC_AVX2(negf, PS, iree_uk_negf_x86_64_avx2_fma)
+IREE_UK_X32U_ROW_FUNC_AVX2(rsqrtf, PS, iree_uk_rsqrtf_x86_64_avx2_fma)
+IREE_UK_X32U_ROW_FUNC_AVX2(tanhf, PS, iree_uk_tanhf_x86_64_avx2_fma)
@@ -0,0 +1,151 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <immintrin.h>
+
+#include "iree/builtins/ukernel/arch/x86_64/elementwise_x86_64.h"
+
+//===----------------------------------------------------------------------===//
+// Vector math helpers.
+//===----------------------------------------------------------------------===//
+
+// See iree_uk_maxf_x86_64_avx2_fma for the NaN propagation.
+static inline __m512 iree_uk_maxf_x86_64_avx512_base(__m512 a, __m512 b) {
+  return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(b, b, _CMP_UNORD_Q),
+                              _mm512_max_ps(b, a), b);
+}
+
+static inline __m512 iree_uk_minf_x86_64_avx512_base(__m512 a, __m512 b) {
+  return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(b, b, _CMP_UNORD_Q),
+                              _mm512_min_ps(b, a), b);
+}
+
+static inline __m512 iree_uk_negf_x86_64_avx512_base(__m512 a) {
+  return _mm512_xor_ps(a, _mm512_set1_ps(-0.0f));
+}
+
+static inline __m512 iree_uk_ceilf_x86_64_avx512_base(__m512 a) {
+  return _mm512_roundscale_ps(a, _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC);
+}
+
+static inline __m512 iree_uk_floorf_x86_64_avx512_base(__m512 a) {
+  return _mm512_roundscale_ps(a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+}
+
+static inline __m512 iree_uk_rsqrtf_x86_64_avx512_base(__m512 a) {
+  return _mm512_div_ps(_mm512_set1_ps(1.0f), _mm512_sqrt_ps(a));
+}
+
+// Same algorithm as iree_uk_expf_x86_64_avx2_fma.
+static inline __m512 iree_uk_expf_x86_64_avx512_base(__m512 x) {
+  x = _mm512_min_ps(_mm512_set1_ps(88.3762626647949f),
+                    _mm512_max_ps(_mm512_set1_ps(-87.3365478515625f), x));
+  __m512 n = _mm512_roundscale_ps(
+      _mm512_mul_ps(x, _mm512_set1_ps(1.44269504088896341f)),
+      _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  __m512 r = _mm512_fnmadd_ps(n, _mm512_set1_ps(0.693359375f), x);
+  r = _mm512_fnmadd_ps(n, _mm512_set1_ps(-2.12194440e-4f), r);
+  __m512 y = _mm512_set1_ps(1.9875691500e-4f);
+  y = _mm512_fmadd_ps(y, r, _mm512_set1_ps(1.3981999507e-3f));
+  y = _mm512_fmadd_ps(y, r, _mm512_set1_ps(8.3334519073e-3f));
+  y = _mm512_fmadd_ps(y, r, _mm512_set1_ps(4.1665795894e-2f));
+  y = _mm512_fmadd_ps(y, r, _mm512_set1_ps(1.6666665459e-1f));
+  y = _mm512_fmadd_ps(y, r, _mm512_set1_ps(5.0000001201e-1f));
+  y = _mm512_fmadd_ps(y, _mm512_mul_ps(r, r),
+                      _mm512_add_ps(r, _mm512_set1_ps(1.0f)));
+  __m512i e = _mm512_slli_epi32(
+      _mm512_add_epi32(_mm512_cvtps_epi32(n), _mm512_set1_epi32(126)), 23);
+  y = _mm512_mul_ps(y, _mm512_castsi512_ps(e));
+  return _mm512_add_ps(y, y);
+}
+
+// Same algorithm as iree_uk_tanhf_x86_64_avx2_fma.
+static inline __m512 iree_uk_tanhf_x86_64_avx512_base(__m512 x) {
+  __mmask16 tiny = _mm512_cmp_ps_mask(_mm512_abs_ps(x), _mm512_set1_ps(0.0004f),
+                                      _CMP_LT_OQ);
+  __m512 c = _mm512_min_ps(_mm512_set1_ps(7.90531110763549805f),
+                           _mm512_max_ps(_mm512_set1_ps(-7.90531110763549805f),
+                                         x));
+  __m512 c2 = _mm512_mul_ps(c, c);
+  __m512 p = _mm512_set1_ps(-2.76076847742355e-16f);
+  p = _mm512_fmadd_ps(p, c2, _mm512_set1_ps(2.00018790482477e-13f));
+  p = _mm512_fmadd_ps(p, c2, _mm512_set1_ps(-8.60467152213735e-11f));
+  p = _mm512_fmadd_ps(p, c2, _mm512_set1_ps(5.12229709037114e-08f));
+  p = _mm512_fmadd_ps(p, c2, _mm512_set1_ps(1.48572235717979e-05f));
+  p = _mm512_fmadd_ps(p, c2, _mm512_set1_ps(6.37261928875436e-04f));
+  p = _mm512_fmadd_ps(p, c2, _mm512_set1_ps(4.89352455891786e-03f));
+  p = _mm512_mul_ps(p, c);
+  __m512 q = _mm512_set1_ps(1.19825839466702e-06f);
+  q = _mm512_fmadd_ps(q, c2, _mm512_set1_ps(1.18534705686654e-04f));
+  q = _mm512_fmadd_ps(q, c2, _mm512_set1_ps(2.26843463243900e-03f));
+  q = _mm512_fmadd_ps(q, c2, _mm512_set1_ps(4.89352518554385e-03f));
+  return _mm512_mask_blend_ps(tiny, _mm512_div_ps(p, q), x);
+}
+
+//===----------------------------------------------------------------------===//
+// Row functions.
+//===----------------------------------------------------------------------===//
+
+#define IREE_UK_LOADU_PS_AVX512(ptr) _mm512_loadu_ps((const float*)(ptr))
+#define IREE_UK_LOADU_SI_AVX512(ptr) _mm512_loadu_si512((const void*)(ptr))
+#define IREE_UK_STOREU_PS_AVX512(ptr, v) _mm512_storeu_ps((float*)(ptr), v)
+#define IREE_UK_STOREU_SI_AVX512(ptr, v) _mm512_storeu_si512((void*)(ptr), v)
+#define IREE_UK_SET1_PS_AVX512(ptr) _mm512_set1_ps(*(const float*)(ptr))
+#define IREE_UK_SET1_SI_AVX512(ptr) \
+  _mm512_set1_epi32(*(const iree_uk_int32_t*)(ptr))
+
+// Defines a x32b row function computing 16 elements at a time as EXPR(a, b),
+// where a and b are VTYPE vectors accessed with the KIND (PS or SI) macros.
+#define IREE_UK_X32B_ROW_FUNC_AVX512(NAME, VTYPE, KIND, EXPR)                \
+  iree_uk_ssize_t iree_uk_x32b_##NAME##_row_x86_64_avx512_base(              \
+      const iree_uk_uint32_t* lhs, iree_uk_ssize_t lhs_stride,               \
+      const iree_uk_uint32_t* rhs, iree_uk_ssize_t rhs_stride,               \
+      iree_uk_uint32_t* IREE_UK_RESTRICT out, iree_uk_ssize_t size) {        \
+    VTYPE l_bcast = IREE_UK_SET1_##KIND##_AVX512(lhs);                       \
+    VTYPE r_bcast = IREE_UK_SET1_##KIND##_AVX512(rhs);                       \
+    iree_uk_ssize_t i = 0;                                                   \
+    for (; i + 16 <= size; i += 16) {                                        \
+      VTYPE a = lhs_stride ? IREE_UK_LOADU_##KIND##_AVX512(lhs + i) : l_bcast; \
+      VTYPE b = rhs_stride ? IREE_UK_LOADU_##KIND##_AVX512(rhs + i) : r_bcast; \
+      IREE_UK_STOREU_##KIND##_AVX512(out + i, EXPR(a, b));                   \
+    }                                                                        \
+    return i;                                                                \
+  }
+
+// Defines a x32u row function computing 16 elements at a time as EXPR(a).
+#define IREE_UK_X32U_ROW_FUNC_AVX512(NAME, KIND, EXPR)                       \
+  iree_uk_ssize_t iree_uk_x32u_##NAME##_row_x86_64_avx512_base(              \
+      const iree_uk_uint32_t* in, iree_uk_uint32_t* IREE_UK_RESTRICT out,    \
+      iree_uk_ssize_t size) {                                                \
+    iree_uk_ssize_t i = 0;                                                   \
+    for (; i + 16 <= size; i += 16) {                                        \
+      IREE_UK_STOREU_##KIND##_AVX512(                                        \
+          out + i, EXPR(IREE_UK_LOADU_##KIND##_AVX512(in + i)));             \
+    }                                                                        \
+    return i;                                                                \
+  }
+
+IREE_UK_X32B_ROW_FUNC_AVX512(addf, __m512, PS, _mm512_add_ps)
+IREE_UK_X32B_ROW_FUNC_AVX512(subf, __m512, PS, _mm512_sub_ps)
+IREE_UK_X32B_ROW_FUNC_AVX512(mulf, __m512, PS, _mm512_mul_ps)
+IREE_UK_X32B_ROW_FUNC_AVX512(divf, __m512, PS, _mm512_div_ps)
+IREE_UK_X32B_ROW_FUNC_AVX512(maxf, __m512, PS, iree_uk_maxf_x86_64_avx512_base)
+IREE_UK_X32B_ROW_FUNC_AVX512(minf, __m512, PS, iree_uk_minf_x86_64_avx512_base)
+IREE_UK_X32B_ROW_FUNC_AVX512(addi, __m512i, SI, _mm512_add_epi32)
+IREE_UK_X32B_ROW_FUNC_AVX512(subi, __m512i, SI, _mm512_sub_epi32)
+IREE_UK_X32B_ROW_FUNC_AVX512(muli, __m512i, SI, _mm512_mullo_epi32)
+IREE_UK_X32B_ROW_FUNC_AVX512(andi, __m512i, SI, _mm512_and_si512)
+IREE_UK_X32B_ROW_FUNC_AVX512(ori, __m512i, SI, _mm512_or_si512)
+IREE_UK_X32B_ROW_FUNC_AVX512(xori, __m512i, SI, _mm512_xor_si512)
+
+IREE_UK_X32U_ROW_FUNC_AVX512(absf, PS, _mm512_abs_ps)
+IREE_UK_X32U_ROW_FUNC_AVX512(ceilf, PS, iree_uk_ceilf_x86_64_avx512_base)
+IREE_UK_X32U_ROW_FUNC_AVX512(ctlz, SI, _mm512_lzcnt_epi32)
+IREE_UK_X32U_ROW_FUNC_AVX512(expf, PS, iree_uk_expf_x86_64_avx512_base)
+IREE_UK_X32U_ROW_FUNC_AVX512(floorf, PS, iree_uk_floorf_x86_64_avx512_base)
+IREE_UK_X32U_ROW_FUNC_AVX512(negf, PS, iree_uk_negf_x86_64_avx512_base)
+IREE_UK_X32U_ROW_FUNC_AVX512(rsqrtf, PS, iree_uk_rsqrtf_x86_64_avx512_base)
+IREE_UK_X32U_ROW_FUNC_AVX512(tanhf, PS, iree_uk_tanhf_x86_64_avx512_base)
@@ -0,0 +1,72 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <immintrin.h>
+
+#include "iree/builtins/ukernel/arch/x86_64/mmt4d_x86_64.h"
+
+// 8x8x1 f32 tile: each step broadcasts one LHS element per row and FMAs it
+// with the 8-wide RHS row into one of 8 YMM accumulators.
+void iree_uk_mmt4d_tile_f32f32f32_8x8x1_x86_64_avx2_fma(
+    void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
+    const void* IREE_UK_RESTRICT rhs_panel, iree_uk_int32_t K,
+    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params) {
+  float* IREE_UK_RESTRICT out_ptr = out_tile;
+  const float* IREE_UK_RESTRICT lhs_ptr = lhs_panel;
+  const float* IREE_UK_RESTRICT rhs_ptr = rhs_panel;
+  __m256 acc[8];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < 8; ++i) acc[i] = _mm256_loadu_ps(out_ptr + 8 * i);
+  } else {
+    for (int i = 0; i < 8; ++i) acc[i] = _mm256_setzero_ps();
+  }
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    __m256 rhs = _mm256_loadu_ps(rhs_ptr);
+    rhs_ptr += 8;
+    for (int i = 0; i < 8; ++i) {
+      acc[i] = _mm256_fmadd_ps(_mm256_broadcast_ss(lhs_ptr + i), rhs, acc[i]);
+    }
+    lhs_ptr += 8;
+  }
+  for (int i = 0; i < 8; ++i) _mm256_storeu_ps(out_ptr + 8 * i, acc[i]);
+}
+
+// 8x8x2 i8 tile: LHS and RHS pairs along K are sign-extended to i16 so that
+// VPMADDWD computes both products and their sum into each i32 lane.
+void iree_uk_mmt4d_tile_i8i8i32_8x8x2_x86_64_avx2_fma(
+    void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
+    const void* IREE_UK_RESTRICT rhs_panel, iree_uk_int32_t K,
+    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params) {
+  iree_uk_int32_t* IREE_UK_RESTRICT out_ptr = out_tile;
+  const iree_uk_int8_t* IREE_UK_RESTRICT lhs_ptr = lhs_panel;
+  const iree_uk_int8_t* IREE_UK_RESTRICT rhs_ptr = rhs_panel;
+  __m256i acc[8];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < 8; ++i) {
+      acc[i] = _mm256_loadu_si256((const __m256i*)(out_ptr + 8 * i));
+    }
+  } else {
+    for (int i = 0; i < 8; ++i) acc[i] = _mm256_setzero_si256();
+  }
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    __m256i rhs = _mm256_cvtepi8_epi16(
+        _mm_loadu_si128((const __m128i*)rhs_ptr));
+    rhs_ptr += 16;
+    // Each i32 lane holds the sign-extended pair of one LHS row.
+    __m256i lhs = _mm256_cvtepi8_epi16(
+        _mm_loadu_si128((const __m128i*)lhs_ptr));
+    lhs_ptr += 16;
+    iree_uk_int32_t lhs_pairs[8];
+    _mm256_storeu_si256((__m256i*)lhs_pairs, lhs);
+    for (int i = 0; i < 8; ++i) {
+      acc[i] = _mm256_add_epi32(
+          acc[i], _mm256_madd_epi16(_mm256_set1_epi32(lhs_pairs[i]), rhs));
+    }
+  }
+  for (int i = 0; i < 8; ++i) {
+    _mm256_storeu_si256((__m256i*)(out_ptr + 8 * i), acc[i]);
+  }
+}
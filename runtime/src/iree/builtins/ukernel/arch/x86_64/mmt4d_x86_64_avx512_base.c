@@ -0,0 +1,70 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <immintrin.h>
+
+#include "iree/builtins/ukernel/arch/x86_64/mmt4d_x86_64.h"
+
+// 16x16x1 f32 tile: each step broadcasts one LHS element per row and FMAs it
+// with the 16-wide RHS row into one of 16 ZMM accumulators.
+void iree_uk_mmt4d_tile_f32f32f32_16x16x1_x86_64_avx512_base(
+    void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
+    const void* IREE_UK_RESTRICT rhs_panel, iree_uk_int32_t K,
+    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params) {
+  float* IREE_UK_RESTRICT out_ptr = out_tile;
+  const float* IREE_UK_RESTRICT lhs_ptr = lhs_panel;
+  const float* IREE_UK_RESTRICT rhs_ptr = rhs_panel;
+  __m512 acc[16];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < 16; ++i) acc[i] = _mm512_loadu_ps(out_ptr + 16 * i);
+  } else {
+    for (int i = 0; i < 16; ++i) acc[i] = _mm512_setzero_ps();
+  }
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    __m512 rhs = _mm512_loadu_ps(rhs_ptr);
+    rhs_ptr += 16;
+    for (int i = 0; i < 16; ++i) {
+      acc[i] = _mm512_fmadd_ps(_mm512_set1_ps(lhs_ptr[i]), rhs, acc[i]);
+    }
+    lhs_ptr += 16;
+  }
+  for (int i = 0; i < 16; ++i) _mm512_storeu_ps(out_ptr + 16 * i, acc[i]);
+}
+
+// 16x16x2 i8 tile: LHS and RHS pairs along K are sign-extended to i16 so that
+// VPMADDWD computes both products and their sum into each i32 lane.
+void iree_uk_mmt4d_tile_i8i8i32_16x16x2_x86_64_avx512_base(
+    void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
+    const void* IREE_UK_RESTRICT rhs_panel, iree_uk_int32_t K,
+    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params) {
+  iree_uk_int32_t* IREE_UK_RESTRICT out_ptr = out_tile;
+  const iree_uk_int8_t* IREE_UK_RESTRICT lhs_ptr = lhs_panel;
+  const iree_uk_int8_t* IREE_UK_RESTRICT rhs_ptr = rhs_panel;
+  __m512i acc[16];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < 16; ++i) {
+      acc[i] = _mm512_loadu_si512(out_ptr + 16 * i);
+    }
+  } else {
+    for (int i = 0; i < 16; ++i) acc[i] = _mm512_setzero_si512();
+  }
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    __m512i rhs = _mm512_cvtepi8_epi16(
+        _mm256_loadu_si256((const __m256i*)rhs_ptr));
+    rhs_ptr += 32;
+    // Each i32 lane holds the sign-extended pair of one LHS row.
+    __m512i lhs = _mm512_cvtepi8_epi16(
+        _mm256_loadu_si256((const __m256i*)lhs_ptr));
+    lhs_ptr += 32;
+    iree_uk_int32_t lhs_pairs[16];
+    _mm512_storeu_si512(lhs_pairs, lhs);
+    for (int i = 0; i < 16; ++i) {
+      acc[i] = _mm512_add_epi32(
+          acc[i], _mm512_madd_epi16(_mm512_set1_epi32(lhs_pairs[i]), rhs));
+    }
+  }
+  for (int i = 0; i < 16; ++i) _mm512_storeu_si512(out_ptr + 16 * i, acc[i]);
+}
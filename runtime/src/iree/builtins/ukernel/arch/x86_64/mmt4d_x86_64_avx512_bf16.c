@@ -0,0 +1,37 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <immintrin.h>
+
+#include "iree/builtins/ukernel/arch/x86_64/mmt4d_x86_64.h"
+
+// 16x16x2 bf16 tile. Every f32 lane of the RHS vector holds the pair of
+// values along K of one RHS column, so that a VDPBF16PS against a broadcast
+// LHS pair accumulates one full row of the tile.
+void iree_uk_mmt4d_tile_bf16bf16f32_16x16x2_x86_64_avx512_bf16(
+    void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
+    const void* IREE_UK_RESTRICT rhs_panel, iree_uk_int32_t K,
+    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params) {
+  float* IREE_UK_RESTRICT out_ptr = out_tile;
+  const iree_uk_int32_t* IREE_UK_RESTRICT lhs_ptr = lhs_panel;
+  const iree_uk_uint16_t* IREE_UK_RESTRICT rhs_ptr = rhs_panel;
+  __m512 acc[16];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < 16; ++i) acc[i] = _mm512_loadu_ps(out_ptr + 16 * i);
+  } else {
+    for (int i = 0; i < 16; ++i) acc[i] = _mm512_setzero_ps();
+  }
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    __m512bh rhs = (__m512bh)_mm512_loadu_si512(rhs_ptr);
+    rhs_ptr += 32;
+    for (int i = 0; i < 16; ++i) {
+      acc[i] = _mm512_dpbf16_ps(
+          acc[i], (__m512bh)_mm512_set1_epi32(lhs_ptr[i]), rhs);
+    }
+    lhs_ptr += 16;
+  }
+  for (int i = 0; i < 16; ++i) _mm512_storeu_ps(out_ptr + 16 * i, acc[i]);
+}
@@ -0,0 +1,54 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <immintrin.h>
+
+#include "iree/builtins/ukernel/arch/x86_64/mmt4d_x86_64.h"
+
+// 16x16x4 i8 tile. Operands are sign-extended to i16 and each group of 4
+// along K is split into an even and an odd pair, each pair feeding one
+// VPDPWSSD that multiplies and accumulates into the i32 lanes directly.
+void iree_uk_mmt4d_tile_i8i8i32_16x16x4_x86_64_avx512_vnni(
+    void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
+    const void* IREE_UK_RESTRICT rhs_panel, iree_uk_int32_t K,
+    iree_uk_uint32_t flags, const iree_uk_mmt4d_params_t* params) {
+  iree_uk_int32_t* IREE_UK_RESTRICT out_ptr = out_tile;
+  const iree_uk_int8_t* IREE_UK_RESTRICT lhs_ptr = lhs_panel;
+  const iree_uk_int8_t* IREE_UK_RESTRICT rhs_ptr = rhs_panel;
+  __m512i acc[16];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < 16; ++i) {
+      acc[i] = _mm512_loadu_si512(out_ptr + 16 * i);
+    }
+  } else {
+    for (int i = 0; i < 16; ++i) acc[i] = _mm512_setzero_si512();
+  }
+  for (iree_uk_int32_t k = 0; k < K; ++k) {
+    // Every i32 lane of |rhs_i8| holds the 4 values of one RHS column. The low
+    // and high halves of the lanes are the two pairs along K.
+    __m512i rhs_i8 = _mm512_loadu_si512(rhs_ptr);
+    rhs_ptr += 64;
+    __m512i rhs_lo = _mm512_cvtepi8_epi16(_mm512_cvtepi32_epi16(rhs_i8));
+    __m512i rhs_hi = _mm512_cvtepi8_epi16(
+        _mm512_cvtepi32_epi16(_mm512_srli_epi32(rhs_i8, 16)));
+    // Sign-extended LHS: i32 lane 2*i (2*i+1) holds the low (high) pair of
+    // row i.
+    iree_uk_int32_t lhs_pairs[32];
+    _mm512_storeu_si512(lhs_pairs, _mm512_cvtepi8_epi16(_mm256_loadu_si256(
+                                       (const __m256i*)lhs_ptr)));
+    _mm512_storeu_si512(lhs_pairs + 16,
+                        _mm512_cvtepi8_epi16(_mm256_loadu_si256(
+                            (const __m256i*)(lhs_ptr + 32))));
+    lhs_ptr += 64;
+    for (int i = 0; i < 16; ++i) {
+      acc[i] = _mm512_dpwssd_epi32(
+          acc[i], _mm512_set1_epi32(lhs_pairs[2 * i + 0]), rhs_lo);
+      acc[i] = _mm512_dpwssd_epi32(
+          acc[i], _mm512_set1_epi32(lhs_pairs[2 * i + 1]), rhs_hi);
+    }
+  }
+  for (int i = 0; i < 16; ++i) _mm512_storeu_si512(out_ptr + 16 * i, acc[i]);
+}
@@ -0,0 +1,197 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/x86_64/pack_x86_64.h"
+
+#include <xmmintrin.h>
+
+// Only baseline SSE is used here: packing is bound by memory traffic and the
+// fixed tile shapes below are what matters, letting the compiler turn every
+// row copy into a few fixed-size moves instead of the byte loops used for
+// runtime shapes by the generic tile functions.
+
+static inline void iree_uk_pack_tile_x86_64_direct(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,
+    iree_uk_ssize_t out_stride1, iree_uk_ssize_t in_stride0,
+    iree_uk_ssize_t elem_size, iree_uk_ssize_t tile_size0,
+    iree_uk_ssize_t tile_size1) {
+  const char* IREE_UK_RESTRICT in_ptr_l1 = in_tile_ptr;
+  char* IREE_UK_RESTRICT out_ptr_l1 = out_tile_ptr;
+  for (; outer_size1 > 0; --outer_size1) {
+    const char* IREE_UK_RESTRICT in_ptr = in_ptr_l1;
+    char* IREE_UK_RESTRICT out_ptr = out_ptr_l1;
+    for (iree_uk_ssize_t tile_i0 = 0; tile_i0 < tile_size0; ++tile_i0) {
+      iree_uk_memcpy(out_ptr, in_ptr, tile_size1 * elem_size);
+      out_ptr += tile_size1 * elem_size;
+      in_ptr += in_stride0 * elem_size;
+    }
+    out_ptr_l1 += out_stride1 * elem_size;
+    in_ptr_l1 += tile_size1 * elem_size;
+  }
+}
+
+static inline void iree_uk_pack_tile_x86_64_transpose(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,
+    iree_uk_ssize_t out_stride1, iree_uk_ssize_t in_stride0,
+    iree_uk_ssize_t elem_size, iree_uk_ssize_t tile_size0,
+    iree_uk_ssize_t tile_size1) {
+  const char* IREE_UK_RESTRICT in_ptr_l1 = in_tile_ptr;
+  char* IREE_UK_RESTRICT out_ptr_l1 = out_tile_ptr;
+  for (; outer_size1 > 0; --outer_size1) {
+    for (iree_uk_ssize_t tile_i0 = 0; tile_i0 < tile_size0; ++tile_i0) {
+      const char* IREE_UK_RESTRICT in_ptr =
+          in_ptr_l1 + tile_i0 * in_stride0 * elem_size;
+      char* IREE_UK_RESTRICT out_ptr = out_ptr_l1 + tile_i0 * elem_size;
+      for (iree_uk_ssize_t tile_i1 = 0; tile_i1 < tile_size1; ++tile_i1) {
+        iree_uk_memcpy(out_ptr, in_ptr, elem_size);
+        out_ptr += tile_size0 * elem_size;
+        in_ptr += elem_size;
+      }
+    }
+    out_ptr_l1 += out_stride1 * elem_size;
+    in_ptr_l1 += tile_size1 * elem_size;
+  }
+}
+
+// Gathers a column of |tile_size0| strided 32-bit elements into each tile.
+// Groups of 4 consecutive tiles are read as 4-wide rows and transposed in
+// registers.
+static inline void iree_uk_pack_tile_Nx1_x32_x86_64_direct(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,
+    iree_uk_ssize_t out_stride1, iree_uk_ssize_t in_stride0,
+    iree_uk_ssize_t tile_size0) {
+  iree_uk_int32_t* IREE_UK_RESTRICT out_ptr = out_tile_ptr;
+  const iree_uk_int32_t* IREE_UK_RESTRICT in_ptr = in_tile_ptr;
+  for (; outer_size1 >= 4; outer_size1 -= 4) {
+    for (iree_uk_ssize_t i = 0; i < tile_size0; i += 4) {
+      __m128 r0 = _mm_loadu_ps((const float*)(in_ptr + (i + 0) * in_stride0));
+      __m128 r1 = _mm_loadu_ps((const float*)(in_ptr + (i + 1) * in_stride0));
+      __m128 r2 = _mm_loadu_ps((const float*)(in_ptr + (i + 2) * in_stride0));
+      __m128 r3 = _mm_loadu_ps((const float*)(in_ptr + (i + 3) * in_stride0));
+      _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+      _mm_storeu_ps((float*)(out_ptr + 0 * out_stride1 + i), r0);
+      _mm_storeu_ps((float*)(out_ptr + 1 * out_stride1 + i), r1);
+      _mm_storeu_ps((float*)(out_ptr + 2 * out_stride1 + i), r2);
+      _mm_storeu_ps((float*)(out_ptr + 3 * out_stride1 + i), r3);
+    }
+    out_ptr += 4 * out_stride1;
+    in_ptr += 4;
+  }
+  for (; outer_size1 > 0; --outer_size1) {
+    for (iree_uk_ssize_t i = 0; i < tile_size0; ++i) {
+      out_ptr[i] = in_ptr[i * in_stride0];
+    }
+    out_ptr += out_stride1;
+    in_ptr += 1;
+  }
+}
+
+static void iree_uk_pack_tile_8x1_x32_x86_64_direct(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,
+    iree_uk_ssize_t out_stride1, iree_uk_ssize_t in_stride0,
+    iree_uk_ssize_t elem_size, iree_uk_ssize_t tile_size0,
+    iree_uk_ssize_t tile_size1) {
+  IREE_UK_ASSERT(elem_size == 4);
+  IREE_UK_ASSERT(tile_size0 == 8);
+  IREE_UK_ASSERT(tile_size1 == 1);
+  iree_uk_pack_tile_Nx1_x32_x86_64_direct(out_tile_ptr, in_tile_ptr,
+                                          outer_size1, out_stride1, in_stride0,
+                                          8);
+}
+
+static void iree_uk_pack_tile_16x1_x32_x86_64_direct(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,
+    iree_uk_ssize_t out_stride1, iree_uk_ssize_t in_stride0,
+    iree_uk_ssize_t elem_size, iree_uk_ssize_t tile_size0,
+    iree_uk_ssize_t tile_size1) {
+  IREE_UK_ASSERT(elem_size == 4);
+  IREE_UK_ASSERT(tile_size0 == 16);
+  IREE_UK_ASSERT(tile_size1 == 1);
+  iree_uk_pack_tile_Nx1_x32_x86_64_direct(out_tile_ptr, in_tile_ptr,
+                                          outer_size1, out_stride1, in_stride0,
+                                          16);
+}
+
+// Defines the pack tile functions for a fixed |S2|x|S3| packed tile of
+// |ESIZE|-byte elements.
+#define IREE_UK_PACK_TILE_X86_64_DIRECT(S2, S3, ESIZE, BITS)                \
+  static void iree_uk_pack_tile_##S2##x##S3##_x##BITS##_x86_64_direct(      \
+      void* IREE_UK_RESTRICT out_tile_ptr,                                  \
+      const void* IREE_UK_RESTRICT in_tile_ptr,                             \
+      iree_uk_ssize_t outer_size1, iree_uk_ssize_t out_stride1,             \
+      iree_uk_ssize_t in_stride0, iree_uk_ssize_t elem_size,                \
+      iree_uk_ssize_t tile_size0, iree_uk_ssize_t tile_size1) {             \
+    IREE_UK_ASSERT(elem_size == ESIZE);                                     \
+    IREE_UK_ASSERT(tile_size0 == S2);                                       \
+    IREE_UK_ASSERT(tile_size1 == S3);                                       \
+    iree_uk_pack_tile_x86_64_direct(out_tile_ptr, in_tile_ptr, outer_size1, \
+                                    out_stride1, in_stride0, ESIZE, S2,     \
+                                    S3);                                    \
+  }
+#define IREE_UK_PACK_TILE_X86_64_TRANSPOSE(S2, S3, ESIZE, BITS)           \
+  static void iree_uk_pack_tile_##S2##x##S3##_x##BITS##_x86_64_transpose( \
+      void* IREE_UK_RESTRICT out_tile_ptr,                                \
+      const void* IREE_UK_RESTRICT in_tile_ptr,                           \
+      iree_uk_ssize_t outer_size1, iree_uk_ssize_t out_stride1,           \
+      iree_uk_ssize_t in_stride0, iree_uk_ssize_t elem_size,              \
+      iree_uk_ssize_t tile_size0, iree_uk_ssize_t tile_size1) {           \
+    IREE_UK_ASSERT(elem_size == ESIZE);                                   \
+    IREE_UK_ASSERT(tile_size0 == S3);                                     \
+    IREE_UK_ASSERT(tile_size1 == S2);                                     \
+    iree_uk_pack_tile_x86_64_transpose(out_tile_ptr, in_tile_ptr,         \
+                                       outer_size1, out_stride1,          \
+                                       in_stride0, ESIZE, S3, S2);        \
+  }
+
+IREE_UK_PACK_TILE_X86_64_DIRECT(8, 8, 4, 32)
+IREE_UK_PACK_TILE_X86_64_DIRECT(16, 16, 4, 32)
+IREE_UK_PACK_TILE_X86_64_TRANSPOSE(8, 1, 4, 32)
+IREE_UK_PACK_TILE_X86_64_TRANSPOSE(16, 1, 4, 32)
+IREE_UK_PACK_TILE_X86_64_DIRECT(8, 2, 1, 8)
+IREE_UK_PACK_TILE_X86_64_TRANSPOSE(8, 2, 1, 8)
+IREE_UK_PACK_TILE_X86_64_DIRECT(16, 2, 1, 8)
+IREE_UK_PACK_TILE_X86_64_TRANSPOSE(16, 2, 1, 8)
+IREE_UK_PACK_TILE_X86_64_DIRECT(16, 4, 1, 8)
+IREE_UK_PACK_TILE_X86_64_TRANSPOSE(16, 4, 1, 8)
+
+#undef IREE_UK_PACK_TILE_X86_64_DIRECT
+#undef IREE_UK_PACK_TILE_X86_64_TRANSPOSE
+
+iree_uk_pack_tile_func_t iree_uk_pack_select_tile_func_x86_64(
+    const iree_uk_pack_params_t* params) {
+  // As in the arm_64 case, only the element size matters as no arithmetic is
+  // done while packing.
+  int esize = iree_uk_type_size(iree_uk_pack_out_type(params->type));
+  bool transpose = params->flags & IREE_UK_FLAG_PACK_TRANSPOSE_INNER;
+  if (esize == 4 && params->out_size2 == 8 && params->out_size3 == 8) {
+    // Currently only used for accumulators, which are never transposed.
+    return transpose ? 0 : iree_uk_pack_tile_8x8_x32_x86_64_direct;
+  } else if (esize == 4 && params->out_size2 == 16 &&
+             params->out_size3 == 16) {
+    return transpose ? 0 : iree_uk_pack_tile_16x16_x32_x86_64_direct;
+  } else if (esize == 4 && params->out_size2 == 8 && params->out_size3 == 1) {
+    return transpose ? iree_uk_pack_tile_8x1_x32_x86_64_transpose
+                     : iree_uk_pack_tile_8x1_x32_x86_64_direct;
+  } else if (esize == 4 && params->out_size2 == 16 && params->out_size3 == 1) {
+    return transpose ? iree_uk_pack_tile_16x1_x32_x86_64_transpose
+                     : iree_uk_pack_tile_16x1_x32_x86_64_direct;
+  } else if (esize == 1 && params->out_size2 == 8 && params->out_size3 == 2) {
+    return transpose ? iree_uk_pack_tile_8x2_x8_x86_64_transpose
+                     : iree_uk_pack_tile_8x2_x8_x86_64_direct;
+  } else if (esize == 1 && params->out_size2 == 16 && params->out_size3 == 2) {
+    return transpose ? iree_uk_pack_tile_16x2_x8_x86_64_transpose
+                     : iree_uk_pack_tile_16x2_x8_x86_64_direct;
+  } else if (esize == 1 && params->out_size2 == 16 && params->out_size3 == 4) {
+    return transpose ? iree_uk_pack_tile_16x4_x8_x86_64_transpose
+                     : iree_uk_pack_tile_16x4_x8_x86_64_direct;
+  }
+  return 0;
+}
@@ -0,0 +1,80 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/x86_64/query_tile_sizes_x86_64.h"
+
+#include "iree/builtins/ukernel/arch/x86_64/config.h"
+#include "iree/schemas/cpu_data.h"
+
+// The tile sizes here match those chosen by the compiler for the same CPU
+// features in LLVMCPUMaterializeEncodingPass.
+
+static iree_uk_matmul_tile_sizes_t
+iree_uk_query_matmul_tile_sizes_x86_64_f32f32f32(
+    const iree_uk_query_tile_sizes_2d_params_t* params) {
+#ifdef IREE_UK_BUILD_X86_64_AVX512_BASE
+  if (params->cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE) {
+    return (iree_uk_matmul_tile_sizes_t){.M = 16, .K = 1, .N = 16};
+  }
+#endif
+  return (iree_uk_matmul_tile_sizes_t){.M = 8, .K = 1, .N = 8};
+}
+
+static iree_uk_matmul_tile_sizes_t
+iree_uk_query_matmul_tile_sizes_x86_64_i8i8i32(
+    const iree_uk_query_tile_sizes_2d_params_t* params) {
+#ifdef IREE_UK_BUILD_X86_64_AVX512_VNNI
+  if (params->cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_VNNI) {
+    return (iree_uk_matmul_tile_sizes_t){.M = 16, .K = 4, .N = 16};
+  }
+#endif
+#ifdef IREE_UK_BUILD_X86_64_AVX512_BASE
+  if (params->cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE) {
+    return (iree_uk_matmul_tile_sizes_t){.M = 16, .K = 2, .N = 16};
+  }
+#endif
+  return (iree_uk_matmul_tile_sizes_t){.M = 8, .K = 2, .N = 8};
+}
+
+static iree_uk_matmul_tile_sizes_t
+iree_uk_query_matmul_tile_sizes_x86_64_bf16bf16f32(
+    const iree_uk_query_tile_sizes_2d_params_t* params) {
+#ifdef IREE_UK_BUILD_X86_64_AVX512_BF16
+  if (params->cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BF16) {
+    return (iree_uk_matmul_tile_sizes_t){.M = 16, .K = 2, .N = 16};
+  }
+#endif
+  return iree_uk_query_matmul_tile_sizes_x86_64_f32f32f32(params);
+}
+
+bool iree_uk_query_matmul_tile_sizes_x86_64(
+    const iree_uk_query_tile_sizes_2d_params_t* params,
+    iree_uk_matmul_tile_sizes_t* out_matmul_tile_sizes) {
+  iree_uk_uint32_t op = iree_uk_query_tile_sizes_operation(params->flags);
+  if (op == IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_F32F32F32) {
+    *out_matmul_tile_sizes =
+        iree_uk_query_matmul_tile_sizes_x86_64_f32f32f32(params);
+    return true;
+  } else if (op == IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_I8I8I32) {
+    *out_matmul_tile_sizes =
+        iree_uk_query_matmul_tile_sizes_x86_64_i8i8i32(params);
+    return true;
+  } else if (op == IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_BF16BF16F32) {
+    *out_matmul_tile_sizes =
+        iree_uk_query_matmul_tile_sizes_x86_64_bf16bf16f32(params);
+    return true;
+  } else if (op == IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_F16F16F32 ||
+             op == IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_F16F16F16) {
+    // No f16 kernels yet: use the f32 tile sizes with the generic kernels.
+    *out_matmul_tile_sizes =
+        iree_uk_query_matmul_tile_sizes_x86_64_f32f32f32(params);
+    return true;
+  } else {
+    // Can't happen, validated earlier.
+    IREE_UK_ASSUME_UNREACHABLE;
+    return false;
+  }
+}
@@ -0,0 +1,69 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/x86_64/unpack_x86_64.h"
+
+// Copies each |tile_size0| x |tile_size1| 32-bit input tile row by row into
+// the strided output. Always called with constant tile sizes so that the row
+// copies become fixed-size moves.
+static inline void iree_uk_unpack_tile_NxN_x32_x86_64_direct(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,
+    iree_uk_ssize_t out_stride0, iree_uk_ssize_t in_stride1,
+    iree_uk_ssize_t tile_size0, iree_uk_ssize_t tile_size1) {
+  iree_uk_int32_t* IREE_UK_RESTRICT out_ptr = out_tile_ptr;
+  const iree_uk_int32_t* IREE_UK_RESTRICT in_ptr = in_tile_ptr;
+  for (; outer_size1 > 0; --outer_size1) {
+    for (iree_uk_ssize_t i = 0; i < tile_size0; ++i) {
+      iree_uk_memcpy(out_ptr + i * out_stride0, in_ptr + i * tile_size1,
+                     tile_size1 * sizeof(iree_uk_int32_t));
+    }
+    out_ptr += tile_size1;
+    in_ptr += in_stride1;
+  }
+}
+
+static void iree_uk_unpack_tile_8x8_x32_x86_64_direct(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,
+    iree_uk_ssize_t out_stride0, iree_uk_ssize_t in_stride1,
+    iree_uk_ssize_t elem_size, iree_uk_ssize_t tile_size0,
+    iree_uk_ssize_t tile_size1) {
+  IREE_UK_ASSERT(elem_size == 4);
+  IREE_UK_ASSERT(tile_size0 == 8);
+  IREE_UK_ASSERT(tile_size1 == 8);
+  iree_uk_unpack_tile_NxN_x32_x86_64_direct(out_tile_ptr, in_tile_ptr,
+                                            outer_size1, out_stride0,
+                                            in_stride1, 8, 8);
+}
+
+static void iree_uk_unpack_tile_16x16_x32_x86_64_direct(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_ssize_t outer_size1,
+    iree_uk_ssize_t out_stride0, iree_uk_ssize_t in_stride1,
+    iree_uk_ssize_t elem_size, iree_uk_ssize_t tile_size0,
+    iree_uk_ssize_t tile_size1) {
+  IREE_UK_ASSERT(elem_size == 4);
+  IREE_UK_ASSERT(tile_size0 == 16);
+  IREE_UK_ASSERT(tile_size1 == 16);
+  iree_uk_unpack_tile_NxN_x32_x86_64_direct(out_tile_ptr, in_tile_ptr,
+                                            outer_size1, out_stride0,
+                                            in_stride1, 16, 16);
+}
+
+iree_uk_unpack_tile_func_t iree_uk_unpack_select_tile_func_x86_64(
+    const iree_uk_unpack_params_t* params) {
+  // As in the arm_64 case, only the element size matters as no arithmetic is
+  // done while unpacking.
+  int esize = iree_uk_type_size(iree_uk_unpack_out_type(params->type));
+  bool transpose = params->flags & IREE_UK_FLAG_UNPACK_TRANSPOSE_INNER;
+  if (esize == 4 && params->in_size2 == 8 && params->in_size3 == 8) {
+    return transpose ? 0 : iree_uk_unpack_tile_8x8_x32_x86_64_direct;
+  } else if (esize == 4 && params->in_size2 == 16 && params->in_size3 == 16) {
+    return transpose ? 0 : iree_uk_unpack_tile_16x16_x32_x86_64_direct;
+  }
+  return 0;
+}
@@ -211,6 +211,17 @@ extern "C" {
 #define IREE_UK_UNLIKELY(x) (x)
 #endif  // IREE_HAVE_ATTRIBUTE(likely)
 
+// Hints that the cache line containing |ptr| will soon be accessed. RW is 0 for
+// reads and 1 for writes; LOCALITY ranges from 0 (no temporal locality) to 3
+// (keep in all cache levels). Prefetching never faults, even on addresses past
+// the end of a buffer.
+#if IREE_UK_HAVE_BUILTIN(__builtin_prefetch) || defined(__GNUC__)
+#define IREE_UK_PREFETCH(ptr, rw, locality) \
+  __builtin_prefetch((ptr), (rw), (locality))
+#else
+#define IREE_UK_PREFETCH(ptr, rw, locality)
+#endif  // IREE_UK_HAVE_BUILTIN(__builtin_prefetch)
+
 #if IREE_UK_HAVE_ATTRIBUTE(aligned) || \
     (defined(__GNUC__) && !defined(__clang__))
 #define IREE_UK_ATTRIBUTE_ALIGNED(N) __attribute__((aligned(N)))
@@ -502,6 +513,83 @@ static inline void iree_uk_memset(void* buf, int val, iree_uk_ssize_t n) {
   for (iree_uk_ssize_t i = 0; i < n; ++i) ((char*)buf)[i] = val;
 }
 
+//===----------------------------------------------------------------------===//
+// 16-bit floating-point conversions
+//===----------------------------------------------------------------------===//
+// The 16-bit floating-point values are carried around as their raw bits in
+// iree_uk_uint16_t so that this does not depend on compiler support for
+// _Float16 / __bf16. Architecture-specific code is expected to use hardware
+// conversions instead; these are for generic code and tests.
+
+static inline float iree_uk_float_from_bits(iree_uk_uint32_t bits) {
+  union {
+    iree_uk_uint32_t u;
+    float f;
+  } v = {bits};
+  return v.f;
+}
+
+static inline iree_uk_uint32_t iree_uk_bits_from_float(float f) {
+  union {
+    float f;
+    iree_uk_uint32_t u;
+  } v = {f};
+  return v.u;
+}
+
+// Converts a bfloat16 bit pattern to float. This is exact.
+static inline float iree_uk_bf16_to_f32(iree_uk_uint16_t bf16) {
+  return iree_uk_float_from_bits((iree_uk_uint32_t)bf16 << 16);
+}
+
+// Converts a float to a bfloat16 bit pattern, rounding to nearest-even.
+static inline iree_uk_uint16_t iree_uk_f32_to_bf16(float f) {
+  iree_uk_uint32_t u = iree_uk_bits_from_float(f);
+  if ((u & 0x7fffffffu) > 0x7f800000u) {
+    // NaN: keep it a quiet NaN after truncation.
+    return (iree_uk_uint16_t)((u >> 16) | 0x40);
+  }
+  u += 0x7fffu + ((u >> 16) & 1);
+  return (iree_uk_uint16_t)(u >> 16);
+}
+
+// Converts an IEEE half-precision bit pattern to float. This is exact.
+static inline float iree_uk_f16_to_f32(iree_uk_uint16_t f16) {
+  iree_uk_uint32_t sign = (iree_uk_uint32_t)(f16 & 0x8000) << 16;
+  iree_uk_uint32_t exp = (f16 >> 10) & 0x1f;
+  iree_uk_uint32_t mantissa = f16 & 0x3ff;
+  if (exp == 0x1f) {
+    // Inf or NaN.
+    return iree_uk_float_from_bits(sign | 0x7f800000u | (mantissa << 13));
+  }
+  if (exp == 0) {
+    // Zero or denormal: denormals are exactly representable as floats.
+    float value = (float)mantissa * (1.0f / 16777216.0f);  // 2^-24
+    return sign ? -value : value;
+  }
+  return iree_uk_float_from_bits(sign | ((exp + 112) << 23) | (mantissa << 13));
+}
+
+// Converts a float to an IEEE half-precision bit pattern, rounding to
+// nearest-even.
+static inline iree_uk_uint16_t iree_uk_f32_to_f16(float f) {
+  iree_uk_uint32_t u = iree_uk_bits_from_float(f);
+  iree_uk_uint16_t sign = (iree_uk_uint16_t)((u >> 16) & 0x8000);
+  iree_uk_uint32_t abs = u & 0x7fffffffu;
+  if (abs > 0x7f800000u) return sign | 0x7e00;  // NaN
+  if (abs >= 0x477ff000u) return sign | 0x7c00;  // Overflows to Inf.
+  if (abs < 0x38800000u) {
+    // Result is a denormal or zero: let the FPU do the rounding by adding a
+    // magic value that aligns the denormal mantissa with the float LSBs.
+    float magic = iree_uk_float_from_bits(0x3f000000u);  // 0.5f
+    float value = iree_uk_float_from_bits(abs) + magic;
+    return sign | (iree_uk_uint16_t)(iree_uk_bits_from_float(value) -
+                                     0x3f000000u);
+  }
+  abs += 0xfffu + ((abs >> 13) & 1) - (112u << 23);
+  return sign | (iree_uk_uint16_t)(abs >> 13);
+}
+
 //===----------------------------------------------------------------------===//
 // Count leading zeros (extracted from base/internal/math.h and adapted
 // to be able to be used standalone).
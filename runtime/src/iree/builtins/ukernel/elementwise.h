@@ -19,7 +19,8 @@ extern "C" {
 
 // Binary ukernel func 2d, x32.
 // It takes lhs, rhs, out buffers and size, returning 0 on success and !0 on
-// error.
+// error. |cpu_data| is used to select architecture-specific code paths, as
+// the cpu_data field of the other ukernels' params.
 typedef int (*iree_uk_x32b_2d_func_t)(
     const iree_uk_uint32_t* lhs, iree_uk_ssize_t lhs_offset,
     iree_uk_ssize_t lhs_stride0, iree_uk_ssize_t lhs_stride1,
@@ -27,7 +28,8 @@ typedef int (*iree_uk_x32b_2d_func_t)(
     iree_uk_ssize_t rhs_stride0, iree_uk_ssize_t rhs_stride1,
     iree_uk_uint32_t* out, iree_uk_ssize_t out_offset,
     iree_uk_ssize_t out_stride0, iree_uk_ssize_t out_stride1,
-    iree_uk_ssize_t size0, iree_uk_ssize_t size1);
+    iree_uk_ssize_t size0, iree_uk_ssize_t size1,
+    const iree_uk_uint64_t* cpu_data);
 
 // Declares a binary 2d microkernel with the following signature:
 //   int iree_uk_{category}_{opcode}_2d(...)
@@ -40,7 +42,8 @@ typedef int (*iree_uk_x32b_2d_func_t)(
       iree_uk_ssize_t rhs_stride0, iree_uk_ssize_t rhs_stride1, \
       dtype* IREE_UK_RESTRICT out, iree_uk_ssize_t out_offset,  \
       iree_uk_ssize_t out_stride0, iree_uk_ssize_t out_stride1, \
-      iree_uk_ssize_t size0, iree_uk_ssize_t size1)
+      iree_uk_ssize_t size0, iree_uk_ssize_t size1,             \
+      const iree_uk_uint64_t* cpu_data)
 
 DECLARE_UKERNEL_BINARY_2D(addf, iree_uk_uint32_t, x32b);
 DECLARE_UKERNEL_BINARY_2D(addi, iree_uk_uint32_t, x32b);
@@ -48,6 +51,8 @@ DECLARE_UKERNEL_BINARY_2D(andi, iree_uk_uint32_t, x32b);
 DECLARE_UKERNEL_BINARY_2D(divf, iree_uk_uint32_t, x32b);
 DECLARE_UKERNEL_BINARY_2D(divsi, iree_uk_uint32_t, x32b);
 DECLARE_UKERNEL_BINARY_2D(divui, iree_uk_uint32_t, x32b);
+DECLARE_UKERNEL_BINARY_2D(maxf, iree_uk_uint32_t, x32b);
+DECLARE_UKERNEL_BINARY_2D(minf, iree_uk_uint32_t, x32b);
 DECLARE_UKERNEL_BINARY_2D(mulf, iree_uk_uint32_t, x32b);
 DECLARE_UKERNEL_BINARY_2D(muli, iree_uk_uint32_t, x32b);
 DECLARE_UKERNEL_BINARY_2D(ori, iree_uk_uint32_t, x32b);
@@ -64,13 +69,14 @@ DECLARE_UKERNEL_BINARY_2D(xori, iree_uk_uint32_t, x32b);
 
 // Unary ukernel func 2d, x32.
 // It takes in, out buffers and size, returning 0 on success and !0 on
-// error.
+// error. |cpu_data| is used as in iree_uk_x32b_2d_func_t.
 typedef int (*iree_uk_x32u_2d_func_t)(
     const iree_uk_uint32_t* in, iree_uk_ssize_t in_offset,
     iree_uk_ssize_t in_stride0, iree_uk_ssize_t in_stride1,
     iree_uk_uint32_t* out, iree_uk_ssize_t out_offset,
     iree_uk_ssize_t out_stride0, iree_uk_ssize_t out_stride1,
-    iree_uk_ssize_t size0, iree_uk_ssize_t size1);
+    iree_uk_ssize_t size0, iree_uk_ssize_t size1,
+    const iree_uk_uint64_t* cpu_data);
 
 // Declares a binary 2d microkernel with the following signature:
 //   int iree_uk_{category}_{opcode}_2d(...)
@@ -82,7 +88,7 @@ typedef int (*iree_uk_x32u_2d_func_t)(
       iree_uk_ssize_t in_stride1, dtype* IREE_UK_RESTRICT out,                \
       iree_uk_ssize_t out_offset, iree_uk_ssize_t out_stride0,                \
       iree_uk_ssize_t out_stride1, iree_uk_ssize_t size0,                     \
-      iree_uk_ssize_t size1)
+      iree_uk_ssize_t size1, const iree_uk_uint64_t* cpu_data)
 
 DECLARE_UKERNEL_UNARY_2D(absf, iree_uk_uint32_t, x32u);
 DECLARE_UKERNEL_UNARY_2D(ceilf, iree_uk_uint32_t, x32u);
@@ -92,6 +98,7 @@ DECLARE_UKERNEL_UNARY_2D(floorf, iree_uk_uint32_t, x32u);
 DECLARE_UKERNEL_UNARY_2D(logf, iree_uk_uint32_t, x32u);
 DECLARE_UKERNEL_UNARY_2D(negf, iree_uk_uint32_t, x32u);
 DECLARE_UKERNEL_UNARY_2D(rsqrtf, iree_uk_uint32_t, x32u);
+DECLARE_UKERNEL_UNARY_2D(tanhf, iree_uk_uint32_t, x32u);
 
 #ifdef __cplusplus
 }  // extern "C"
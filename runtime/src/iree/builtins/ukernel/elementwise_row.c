@@ -0,0 +1,39 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/elementwise_row.h"
+
+#if defined(IREE_UK_ARCH_ARM_64)
+#include "iree/builtins/ukernel/arch/arm_64/elementwise_arm_64.h"
+#elif defined(IREE_UK_ARCH_X86_64)
+#include "iree/builtins/ukernel/arch/x86_64/elementwise_x86_64.h"
+#endif
+
+iree_uk_x32b_row_func_t iree_uk_x32b_select_row_func(
+    iree_uk_x32b_opcode_t opcode, const iree_uk_uint64_t* cpu_data) {
+#if defined(IREE_UK_ARCH_ARM_64)
+  return iree_uk_x32b_select_row_func_arm_64(opcode, cpu_data);
+#elif defined(IREE_UK_ARCH_X86_64)
+  return iree_uk_x32b_select_row_func_x86_64(opcode, cpu_data);
+#else
+  (void)opcode;
+  (void)cpu_data;
+  return 0;
+#endif
+}
+
+iree_uk_x32u_row_func_t iree_uk_x32u_select_row_func(
+    iree_uk_x32u_opcode_t opcode, const iree_uk_uint64_t* cpu_data) {
+#if defined(IREE_UK_ARCH_ARM_64)
+  return iree_uk_x32u_select_row_func_arm_64(opcode, cpu_data);
+#elif defined(IREE_UK_ARCH_X86_64)
+  return iree_uk_x32u_select_row_func_x86_64(opcode, cpu_data);
+#else
+  (void)opcode;
+  (void)cpu_data;
+  return 0;
+#endif
+}
@@ -0,0 +1,77 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BUILTINS_UKERNEL_ELEMENTWISE_ROW_H_
+#define IREE_BUILTINS_UKERNEL_ELEMENTWISE_ROW_H_
+
+#include "iree/builtins/ukernel/elementwise.h"
+
+// Opcodes for generic functions operating on 32-bit operands and result.
+// Since the outer dispatcher only differentiates based on width, all other
+// type specificity is carried by the opcode.
+// Binary opcodes are named "X32B" and unary opcodes "X32U".
+// The initial list was sorted, and it is encouraged to sort extensions, but
+// each opcode must be numerically stable, so the list is not expected to
+// be sorted over time.
+typedef enum {
+  IREE_UK_X32B_ADDF = 0,
+  IREE_UK_X32B_ADDI = 1,
+  IREE_UK_X32B_ANDI = 2,
+  IREE_UK_X32B_DIVF = 3,
+  IREE_UK_X32B_DIVSI = 4,
+  IREE_UK_X32B_DIVUI = 5,
+  IREE_UK_X32B_MULF = 6,
+  IREE_UK_X32B_MULI = 7,
+  IREE_UK_X32B_ORI = 8,
+  IREE_UK_X32B_SHLI = 9,
+  IREE_UK_X32B_SHRSI = 10,
+  IREE_UK_X32B_SHRUI = 11,
+  IREE_UK_X32B_SUBF = 12,
+  IREE_UK_X32B_SUBI = 13,
+  IREE_UKENREL_X32B_XORI = 14,
+  IREE_UK_X32B_MAXF = 15,
+  IREE_UK_X32B_MINF = 16,
+} iree_uk_x32b_opcode_t;
+
+typedef enum {
+  IREE_UK_X32U_ABSF,
+  IREE_UK_X32U_CEILF,
+  IREE_UK_X32U_CTLZ,
+  IREE_UK_X32U_EXPF,
+  IREE_UK_X32U_FLOORF,
+  IREE_UK_X32U_LOGF,
+  IREE_UK_X32U_NEGF,
+  IREE_UK_X32U_RSQRTF,
+  IREE_UK_X32U_TANHF,
+} iree_uk_x32u_opcode_t;
+
+// Row function for an x32b opcode. Computes a leading part of a row of |size|
+// elements of a contiguous |out|, where each of |lhs| and |rhs| is either
+// contiguous (stride 1) or a broadcast scalar (stride 0). Returns the number of
+// leading elements computed, the remaining elements being left to the generic
+// code. Only called with size > 0.
+typedef iree_uk_ssize_t (*iree_uk_x32b_row_func_t)(
+    const iree_uk_uint32_t* lhs, iree_uk_ssize_t lhs_stride,
+    const iree_uk_uint32_t* rhs, iree_uk_ssize_t rhs_stride,
+    iree_uk_uint32_t* IREE_UK_RESTRICT out, iree_uk_ssize_t size);
+
+// Row function for an x32u opcode, with contiguous |in| and |out|. Same
+// contract as iree_uk_x32b_row_func_t.
+typedef iree_uk_ssize_t (*iree_uk_x32u_row_func_t)(
+    const iree_uk_uint32_t* in, iree_uk_uint32_t* IREE_UK_RESTRICT out,
+    iree_uk_ssize_t size);
+
+// Returns the row function to use for the x32b |opcode| on the CPU described
+// by |cpu_data|, or NULL if only the generic code handles it.
+iree_uk_x32b_row_func_t iree_uk_x32b_select_row_func(
+    iree_uk_x32b_opcode_t opcode, const iree_uk_uint64_t* cpu_data);
+
+// Returns the row function to use for the x32u |opcode| on the CPU described
+// by |cpu_data|, or NULL if only the generic code handles it.
+iree_uk_x32u_row_func_t iree_uk_x32u_select_row_func(
+    iree_uk_x32u_opcode_t opcode, const iree_uk_uint64_t* cpu_data);
+
+#endif  // IREE_BUILTINS_UKERNEL_ELEMENTWISE_ROW_H_
@@ -38,6 +38,28 @@
 #define IREE_UK_FLAG_ACCUMULATE 0x1u
 #define IREE_UK_FLAG_ACCUMULATE_BIT_POS 0
 
+// `mmt4d` ukernel-specific bits (bits 16..31).
+// The BIAS, ACTIVATION and REQUANTIZE bits select an epilogue applied to each
+// output tile right after it has been accumulated, in that order.
+// BIAS adds params->bias_buffer, a vector of N*N0 accumulator-type values
+// indexed by output column, to each row of the result.
+#define IREE_UK_FLAG_MMT4D_BIAS 0x10000u
+#define IREE_UK_FLAG_MMT4D_BIAS_BIT_POS 16
+// ACTIVATION (bits 17..18) selects an activation function. GELU (tanh
+// approximation) requires a floating-point result.
+// Note: the _INTERNAL suffix conveys that the _MASK value should only be used
+// by microkernels decoding flags, not by the compiler setting flags. Masks may
+// have to change even if flag values don't.
+#define IREE_UK_FLAG_MMT4D_ACTIVATION_MASK_INTERNAL 0x60000u
+#define IREE_UK_FLAG_MMT4D_ACTIVATION_NONE 0x00000u
+#define IREE_UK_FLAG_MMT4D_ACTIVATION_RELU 0x20000u
+#define IREE_UK_FLAG_MMT4D_ACTIVATION_GELU 0x40000u
+// REQUANTIZE is only valid for i8i8i32 without ACCUMULATE. The int32 result
+// is scaled by params->requant_scale, offset by params->requant_zero_point,
+// rounded and saturated to int8, and out_buffer holds int8 elements.
+#define IREE_UK_FLAG_MMT4D_REQUANTIZE 0x80000u
+#define IREE_UK_FLAG_MMT4D_REQUANTIZE_BIT_POS 19
+
 // `pack` ukernel-specific bits (bits 16..31).
 #define IREE_UK_FLAG_PACK_TRANSPOSE_INNER 0x10000u
 #define IREE_UK_FLAG_PACK_TRANSPOSE_INNER_BIT_POS 16
@@ -54,6 +76,8 @@
 #define IREE_UK_ENSURE_CONSISTENT_FLAG(F) \
   IREE_UK_STATIC_ASSERT((F) == (1u << (F##_BIT_POS)))
 IREE_UK_ENSURE_CONSISTENT_FLAG(IREE_UK_FLAG_ACCUMULATE);
+IREE_UK_ENSURE_CONSISTENT_FLAG(IREE_UK_FLAG_MMT4D_BIAS);
+IREE_UK_ENSURE_CONSISTENT_FLAG(IREE_UK_FLAG_MMT4D_REQUANTIZE);
 IREE_UK_ENSURE_CONSISTENT_FLAG(IREE_UK_FLAG_PACK_TRANSPOSE_INNER);
 IREE_UK_ENSURE_CONSISTENT_FLAG(IREE_UK_FLAG_PACK_TRANSPOSE_OUTER);
 
@@ -69,7 +93,7 @@ IREE_UK_ENSURE_CONSISTENT_FLAG(IREE_UK_FLAG_PACK_TRANSPOSE_OUTER);
 #define IREE_UK_FLAG_QUERY_TILE_SIZES_OPERAND_ROLE_RHS_TRANSPOSE 0x20000u
 #define IREE_UK_FLAG_QUERY_TILE_SIZES_OPERAND_ROLE_RESULT 0x30000u
 // OPERATION (bits 20..31, though may be shrunk as needed as this is currently
-// only using bit 20 and will only grow as needed) describes the operation
+// only using bits 20..22 and will only grow as needed) describes the operation
 // owning the tensor (that we are doing a query_tile_sizes for) as an operand.
 // Note: the _INTERNAL suffix conveys that the _MASK value should only be used
 // by microkernels decoding flags, not by the compiler setting flags. Masks may
@@ -77,5 +101,8 @@ IREE_UK_ENSURE_CONSISTENT_FLAG(IREE_UK_FLAG_PACK_TRANSPOSE_OUTER);
 #define IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MASK_INTERNAL 0xfff00000u
 #define IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_F32F32F32 0x000000u
 #define IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_I8I8I32 0x100000u
+#define IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_F16F16F32 0x200000u
+#define IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_F16F16F16 0x300000u
+#define IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_BF16BF16F32 0x400000u
 
 #endif  // IREE_BUILTINS_UKERNEL_EXPORTED_BITS_H_
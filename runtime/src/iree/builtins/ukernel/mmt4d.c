@@ -7,14 +7,37 @@
 #include "iree/builtins/ukernel/mmt4d.h"
 
 #include "iree/builtins/ukernel/mmt4d_tile.h"
+#include "iree/schemas/cpu_data.h"
 
 #define OUTSIDE_UINT_RANGE(value, bits) (((value) < 0) || ((value) >> (bits)))
 
 static void iree_uk_mmt4d_validate(const iree_uk_mmt4d_params_t* params) {
 #ifdef IREE_UK_ENABLE_ASSERTS
-  IREE_UK_ASSERT(!(params->flags & ~IREE_UK_FLAG_ACCUMULATE));
+  const iree_uk_uint32_t allowed_flags =
+      IREE_UK_FLAG_ACCUMULATE | IREE_UK_FLAG_MMT4D_BIAS |
+      IREE_UK_FLAG_MMT4D_ACTIVATION_MASK_INTERNAL |
+      IREE_UK_FLAG_MMT4D_REQUANTIZE;
+  IREE_UK_ASSERT(!(params->flags & ~allowed_flags));
+  iree_uk_uint32_t activation =
+      params->flags & IREE_UK_FLAG_MMT4D_ACTIVATION_MASK_INTERNAL;
+  IREE_UK_ASSERT(activation == IREE_UK_FLAG_MMT4D_ACTIVATION_NONE ||
+                 activation == IREE_UK_FLAG_MMT4D_ACTIVATION_RELU ||
+                 activation == IREE_UK_FLAG_MMT4D_ACTIVATION_GELU);
+  if (params->flags & IREE_UK_FLAG_MMT4D_BIAS) {
+    IREE_UK_ASSERT(params->bias_buffer);
+  }
+  if (params->flags & IREE_UK_FLAG_MMT4D_REQUANTIZE) {
+    IREE_UK_ASSERT(params->type == iree_uk_mmt4d_type_i8i8i32);
+    IREE_UK_ASSERT(!(params->flags & IREE_UK_FLAG_ACCUMULATE));
+    IREE_UK_ASSERT(activation != IREE_UK_FLAG_MMT4D_ACTIVATION_GELU);
+  } else if (activation == IREE_UK_FLAG_MMT4D_ACTIVATION_GELU) {
+    IREE_UK_ASSERT(params->type != iree_uk_mmt4d_type_i8i8i32);
+  }
   IREE_UK_ASSERT(params->type == iree_uk_mmt4d_type_f32f32f32 ||
-                 params->type == iree_uk_mmt4d_type_i8i8i32);
+                 params->type == iree_uk_mmt4d_type_i8i8i32 ||
+                 params->type == iree_uk_mmt4d_type_f16f16f32 ||
+                 params->type == iree_uk_mmt4d_type_f16f16f16 ||
+                 params->type == iree_uk_mmt4d_type_bf16bf16f32);
   // Some implementations may wish to avoid supporting absurdly wide types. For
   // instance, K is the innermost (i.e. hottest) loop bound, so some 32bit
   // targets may benefit from K being int32, not int64. We still let K be of
@@ -34,11 +57,186 @@ static void iree_uk_mmt4d_validate(const iree_uk_mmt4d_params_t* params) {
 #endif  // IREE_UK_ENABLE_ASSERTS
 }
 
+// Flags selecting an epilogue, see iree_uk_mmt4d_epilogue_tile.
+#define IREE_UK_MMT4D_EPILOGUE_FLAGS                                     \
+  (IREE_UK_FLAG_MMT4D_BIAS | IREE_UK_FLAG_MMT4D_ACTIVATION_MASK_INTERNAL | \
+   IREE_UK_FLAG_MMT4D_REQUANTIZE)
+
+// Type of the elements stored to out_buffer. That is the accumulator type
+// except when requantizing.
+static iree_uk_type_t iree_uk_mmt4d_stored_out_type(
+    const iree_uk_mmt4d_params_t* params) {
+  return (params->flags & IREE_UK_FLAG_MMT4D_REQUANTIZE)
+             ? IREE_UK_TYPE_INT_8
+             : iree_uk_mmt4d_out_type(params->type);
+}
+
+// Scalar tanh, same rational approximation as the elementwise tanhf row
+// functions. Avoids a libm dependency.
+static float iree_uk_mmt4d_tanhf(float x) {
+  if (x > -0.0004f && x < 0.0004f) return x;
+  float c = x < -7.90531110763549805f  ? -7.90531110763549805f
+            : x > 7.90531110763549805f ? 7.90531110763549805f
+                                       : x;
+  float c2 = c * c;
+  float p = -2.76076847742355e-16f;
+  p = p * c2 + 2.00018790482477e-13f;
+  p = p * c2 + -8.60467152213735e-11f;
+  p = p * c2 + 5.12229709037114e-08f;
+  p = p * c2 + 1.48572235717979e-05f;
+  p = p * c2 + 6.37261928875436e-04f;
+  p = p * c2 + 4.89352455891786e-03f;
+  float q = 1.19825839466702e-06f;
+  q = q * c2 + 1.18534705686654e-04f;
+  q = q * c2 + 2.26843463243900e-03f;
+  q = q * c2 + 4.89352518554385e-03f;
+  return c * p / q;
+}
+
+static float iree_uk_mmt4d_activation_f32(iree_uk_uint32_t flags, float x) {
+  switch (flags & IREE_UK_FLAG_MMT4D_ACTIVATION_MASK_INTERNAL) {
+    case IREE_UK_FLAG_MMT4D_ACTIVATION_RELU:
+      // Written so that NaNs propagate.
+      return x < 0.0f ? 0.0f : x;
+    case IREE_UK_FLAG_MMT4D_ACTIVATION_GELU:
+      return 0.5f * x *
+             (1.0f + iree_uk_mmt4d_tanhf(0.7978845608028654f *
+                                         (x + 0.044715f * x * x * x)));
+    default:
+      return x;
+  }
+}
+
+// Rounds to nearest, ties away from zero, and saturates to int8.
+static iree_uk_int8_t iree_uk_mmt4d_saturate_to_i8(float x) {
+  x = x < -128.0f ? -128.0f : x > 127.0f ? 127.0f : x;
+  return (iree_uk_int8_t)(x < 0.0f ? x - 0.5f : x + 0.5f);
+}
+
+// Applies the epilogue selected by params->flags to one M0xN0 tile, right
+// after its tile_func has accumulated it, so that the tile is still hot in
+// cache. |acc_tile| holds accumulator-type values. It is the same as
+// |out_tile| except when requantizing. |bias| points to the N0 bias values
+// for this tile, if any.
+static void iree_uk_mmt4d_epilogue_tile(const iree_uk_mmt4d_params_t* params,
+                                        const void* acc_tile, void* out_tile,
+                                        const void* bias) {
+  const iree_uk_int16_t M0 = params->M0;
+  const iree_uk_int16_t N0 = params->N0;
+  const iree_uk_uint32_t flags = params->flags;
+  const bool has_bias = flags & IREE_UK_FLAG_MMT4D_BIAS;
+  switch (params->type) {
+    case iree_uk_mmt4d_type_i8i8i32: {
+      const iree_uk_int32_t* acc = acc_tile;
+      const iree_uk_int32_t* bias_i32 = bias;
+      if (flags & IREE_UK_FLAG_MMT4D_REQUANTIZE) {
+        iree_uk_int8_t* out = out_tile;
+        float zero_point = params->requant_zero_point;
+        for (int i0 = 0; i0 < M0; ++i0) {
+          for (int j0 = 0; j0 < N0; ++j0) {
+            iree_uk_int32_t v = acc[i0 * N0 + j0];
+            if (has_bias) v += bias_i32[j0];
+            float x = iree_uk_mmt4d_activation_f32(flags,
+                                                   v * params->requant_scale);
+            out[i0 * N0 + j0] = iree_uk_mmt4d_saturate_to_i8(x + zero_point);
+          }
+        }
+        return;
+      }
+      iree_uk_int32_t* out = out_tile;
+      bool relu = (flags & IREE_UK_FLAG_MMT4D_ACTIVATION_MASK_INTERNAL) ==
+                  IREE_UK_FLAG_MMT4D_ACTIVATION_RELU;
+      for (int i0 = 0; i0 < M0; ++i0) {
+        for (int j0 = 0; j0 < N0; ++j0) {
+          iree_uk_int32_t v = acc[i0 * N0 + j0];
+          if (has_bias) v += bias_i32[j0];
+          if (relu && v < 0) v = 0;
+          out[i0 * N0 + j0] = v;
+        }
+      }
+      return;
+    }
+    case iree_uk_mmt4d_type_f16f16f16: {
+      const iree_uk_uint16_t* acc = acc_tile;
+      const iree_uk_uint16_t* bias_f16 = bias;
+      iree_uk_uint16_t* out = out_tile;
+      for (int i0 = 0; i0 < M0; ++i0) {
+        for (int j0 = 0; j0 < N0; ++j0) {
+          float v = iree_uk_f16_to_f32(acc[i0 * N0 + j0]);
+          if (has_bias) v += iree_uk_f16_to_f32(bias_f16[j0]);
+          out[i0 * N0 + j0] =
+              iree_uk_f32_to_f16(iree_uk_mmt4d_activation_f32(flags, v));
+        }
+      }
+      return;
+    }
+    default: {
+      // All other types accumulate into f32.
+      const float* acc = acc_tile;
+      const float* bias_f32 = bias;
+      float* out = out_tile;
+      for (int i0 = 0; i0 < M0; ++i0) {
+        for (int j0 = 0; j0 < N0; ++j0) {
+          float v = acc[i0 * N0 + j0];
+          if (has_bias) v += bias_f32[j0];
+          out[i0 * N0 + j0] = iree_uk_mmt4d_activation_f32(flags, v);
+        }
+      }
+      return;
+    }
+  }
+}
+
+// Cache sizes assumed when cpu_data does not report them. The L2 default is
+// on the small side of current cores so that blocking stays beneficial when
+// the real size is larger. An unknown L3 disables blocking along M.
+#define IREE_UK_MMT4D_DEFAULT_L2_CACHE_BYTES (256 * 1024)
+
+// Number of bytes of the next panels requested by software prefetch at each
+// tile. This only needs to cover the lead-in until the hardware prefetcher
+// picks up the sequential stream of the panel.
+#define IREE_UK_MMT4D_PREFETCH_BYTES 256
+
+static iree_uk_ssize_t iree_uk_mmt4d_cache_bytes(
+    const iree_uk_mmt4d_params_t* params, int shift) {
+  if (!params->cpu_data) return 0;
+  return ((params->cpu_data[1] >> shift) &
+          IREE_CPU_DATA_FIELD_1_CACHE_KB_MASK) *
+         1024;
+}
+
+// Returns the number of panels of |panel_size| bytes out of |count| that fit in
+// half of a cache of |cache_bytes|, leaving the other half to the panels of
+// the other operand and to the output tiles. A zero |cache_bytes| means no
+// blocking.
+static iree_uk_int32_t iree_uk_mmt4d_block_size(iree_uk_ssize_t cache_bytes,
+                                                iree_uk_ssize_t panel_size,
+                                                iree_uk_int32_t count) {
+  if (!cache_bytes || !panel_size) return count;
+  iree_uk_ssize_t block = (cache_bytes / 2) / panel_size;
+  if (block < 1) return 1;
+  return block < count ? (iree_uk_int32_t)block : count;
+}
+
+static void iree_uk_mmt4d_prefetch(const char* ptr, iree_uk_ssize_t size) {
+  for (iree_uk_ssize_t offset = 0; offset < size; offset += 64) {
+    IREE_UK_PREFETCH(ptr + offset, 0, 3);
+  }
+}
+
 // General mmt4d implementation, shared among all cases. The idea is that the
 // only really performance-critical part is the inner-most loop, and that's
 // handled by the tile_func passed as argument here. Sharing the outer loops
 // across all cases is a roughly 2x code shrink compared to if we were
 // emitting the whole loop nest for each case.
+//
+// The loop nest is blocked so that a block of N_block RHS panels stays
+// resident in L2 while it is multiplied by each of a block of M_block LHS
+// panels, and that block of LHS panels in turn stays resident in L3 while it
+// is multiplied by all RHS blocks. Without that, for large K each RHS panel is
+// evicted before it is reused by the next row. Within a block, the beginning
+// of the next RHS (and at the end of a row, LHS) panel is prefetched while the
+// current tile is computed.
 static void iree_uk_mmt4d_using_tile_func(const iree_uk_mmt4d_params_t* params,
                                           iree_uk_mmt4d_tile_func_t tile_func) {
   const iree_uk_int32_t M = params->M;
@@ -46,34 +244,89 @@ static void iree_uk_mmt4d_using_tile_func(const iree_uk_mmt4d_params_t* params,
   const iree_uk_int32_t K = params->K;
   const iree_uk_int16_t M0 = params->M0;
   const iree_uk_int16_t N0 = params->N0;
+  const iree_uk_int32_t K0 = params->K0;
   const iree_uk_type_t lhs_type = iree_uk_mmt4d_lhs_type(params->type);
   const iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(params->type);
-  const iree_uk_type_t out_type = iree_uk_mmt4d_out_type(params->type);
+  const iree_uk_type_t out_type = iree_uk_mmt4d_stored_out_type(params);
   const iree_uk_int16_t lhs_elem_size_log2 = iree_uk_type_size_log2(lhs_type);
   const iree_uk_int16_t rhs_elem_size_log2 = iree_uk_type_size_log2(rhs_type);
   const iree_uk_int16_t out_elem_size_log2 = iree_uk_type_size_log2(out_type);
-  char* out_tile_row = params->out_buffer;
-  const char* lhs_panel = params->lhs_buffer;
   iree_uk_int32_t out_tile_size = (M0 * N0) << out_elem_size_log2;
   iree_uk_ssize_t lhs_panel_stride = params->lhs_stride << lhs_elem_size_log2;
   iree_uk_ssize_t rhs_panel_stride = params->rhs_stride << rhs_elem_size_log2;
   iree_uk_ssize_t out_stride = params->out_stride << out_elem_size_log2;
-  for (iree_uk_int32_t i = 0; i < M; ++i) {
-    char* out_tile = out_tile_row;
-    const char* rhs_panel = params->rhs_buffer;
-    for (iree_uk_int32_t j = 0; j < N; ++j) {
-      tile_func(out_tile, lhs_panel, rhs_panel, K, params->flags, params);
-      out_tile += out_tile_size;
-      rhs_panel += rhs_panel_stride;
+  const bool has_epilogue = params->flags & IREE_UK_MMT4D_EPILOGUE_FLAGS;
+  // When requantizing, tiles are accumulated into this int32 scratch tile and
+  // the epilogue stores the int8 results to out_buffer.
+  iree_uk_int32_t acc_scratch[iree_uk_mmt4d_tile_generic_max_bytes /
+                              sizeof(iree_uk_int32_t)];
+  const bool requantize = params->flags & IREE_UK_FLAG_MMT4D_REQUANTIZE;
+  const iree_uk_int32_t bias_tile_size =
+      N0 << iree_uk_type_size_log2(iree_uk_mmt4d_out_type(params->type));
+  // Bytes actually read from each panel by one tile_func call.
+  const iree_uk_ssize_t lhs_panel_size = ((iree_uk_ssize_t)K * M0 * K0)
+                                         << lhs_elem_size_log2;
+  const iree_uk_ssize_t rhs_panel_size = ((iree_uk_ssize_t)K * N0 * K0)
+                                         << rhs_elem_size_log2;
+  iree_uk_ssize_t l2_cache_bytes = iree_uk_mmt4d_cache_bytes(
+      params, IREE_CPU_DATA_FIELD_1_L2_CACHE_KB_SHIFT);
+  if (!l2_cache_bytes) l2_cache_bytes = IREE_UK_MMT4D_DEFAULT_L2_CACHE_BYTES;
+  const iree_uk_int32_t N_block =
+      iree_uk_mmt4d_block_size(l2_cache_bytes, rhs_panel_size, N);
+  const iree_uk_ssize_t l3_cache_bytes = iree_uk_mmt4d_cache_bytes(
+      params, IREE_CPU_DATA_FIELD_1_L3_CACHE_KB_SHIFT);
+  const iree_uk_int32_t M_block =
+      iree_uk_mmt4d_block_size(l3_cache_bytes, lhs_panel_size, M);
+  for (iree_uk_int32_t i_block = 0; i_block < M; i_block += M_block) {
+    const iree_uk_int32_t i_end =
+        i_block + M_block < M ? i_block + M_block : M;
+    for (iree_uk_int32_t j_block = 0; j_block < N; j_block += N_block) {
+      const iree_uk_int32_t j_end =
+          j_block + N_block < N ? j_block + N_block : N;
+      const char* lhs_panel =
+          (const char*)params->lhs_buffer + i_block * lhs_panel_stride;
+      char* out_tile_row = (char*)params->out_buffer + i_block * out_stride +
+                           j_block * out_tile_size;
+      const char* rhs_block =
+          (const char*)params->rhs_buffer + j_block * rhs_panel_stride;
+      const char* bias_block =
+          params->bias_buffer
+              ? (const char*)params->bias_buffer + j_block * bias_tile_size
+              : 0;
+      for (iree_uk_int32_t i = i_block; i < i_end; ++i) {
+        char* out_tile = out_tile_row;
+        const char* rhs_panel = rhs_block;
+        const char* bias = bias_block;
+        for (iree_uk_int32_t j = j_block; j < j_end; ++j) {
+          // The next RHS panel of the block, or the first one again together
+          // with the next LHS panel when wrapping around to the next row.
+          if (j + 1 < j_end) {
+            iree_uk_mmt4d_prefetch(rhs_panel + rhs_panel_stride,
+                                   IREE_UK_MMT4D_PREFETCH_BYTES);
+          } else {
+            iree_uk_mmt4d_prefetch(rhs_block, IREE_UK_MMT4D_PREFETCH_BYTES);
+            iree_uk_mmt4d_prefetch(lhs_panel + lhs_panel_stride,
+                                   IREE_UK_MMT4D_PREFETCH_BYTES);
+          }
+          void* acc_tile = requantize ? (void*)acc_scratch : (void*)out_tile;
+          tile_func(acc_tile, lhs_panel, rhs_panel, K, params->flags, params);
+          if (has_epilogue) {
+            iree_uk_mmt4d_epilogue_tile(params, acc_tile, out_tile, bias);
+          }
+          out_tile += out_tile_size;
+          rhs_panel += rhs_panel_stride;
+          if (bias) bias += bias_tile_size;
+        }
+        out_tile_row += out_stride;
+        lhs_panel += lhs_panel_stride;
+      }
     }
-    out_tile_row += out_stride;
-    lhs_panel += lhs_panel_stride;
   }
 }
 
 // Helper for early-return path when K==0 and we just need to clear the output.
 static void iree_uk_mmt4d_zero_out(const iree_uk_mmt4d_params_t* params) {
-  iree_uk_type_t out_type = iree_uk_mmt4d_out_type(params->type);
+  iree_uk_type_t out_type = iree_uk_mmt4d_stored_out_type(params);
   int out_type_size_log2 = iree_uk_type_size_log2(out_type);
   iree_uk_ssize_t contiguous_size = params->N * params->M0 * params->N0
                                     << out_type_size_log2;
@@ -85,6 +338,19 @@ static void iree_uk_mmt4d_zero_out(const iree_uk_mmt4d_params_t* params) {
   }
 }
 
+// Tile function for K==0 with an epilogue: the accumulator tile is zero, or
+// the existing output with ACCUMULATE. Plain K==0 is handled by
+// iree_uk_mmt4d_early instead.
+static void iree_uk_mmt4d_tile_k0(void* out_tile, const void* lhs_panel,
+                                  const void* rhs_panel, iree_uk_int32_t K,
+                                  iree_uk_uint32_t flags,
+                                  const iree_uk_mmt4d_params_t* params) {
+  if (flags & IREE_UK_FLAG_ACCUMULATE) return;
+  iree_uk_type_t out_type = iree_uk_mmt4d_out_type(params->type);
+  iree_uk_memset(out_tile, 0,
+                 (params->M0 * params->N0) << iree_uk_type_size_log2(out_type));
+}
+
 // Early-return code paths, including trivial or near-trivial cases (when one
 // of the dimensions is 0) and in the future, hardware ports that specialize
 // the entire loop nest.
@@ -94,7 +360,9 @@ static bool iree_uk_mmt4d_early(const iree_uk_mmt4d_params_t* params) {
   if (params->M == 0 || params->N == 0) {
     return true;
   }
-  if (params->K == 0) {
+  // With an epilogue, K==0 still has to apply it to the (zero or accumulated)
+  // result, which iree_uk_mmt4d_tile_k0 takes care of.
+  if (params->K == 0 && !(params->flags & IREE_UK_MMT4D_EPILOGUE_FLAGS)) {
     if (params->flags & IREE_UK_FLAG_ACCUMULATE) {
       // Nothing to do!
     } else {
@@ -118,6 +386,7 @@ IREE_UK_EXPORT void iree_uk_mmt4d(const iree_uk_mmt4d_params_t* params) {
 
   // Select a target-specific tile_func (inner loop on K, computing one M0xN0
   // tile) and use that with generic outer loops.
-  iree_uk_mmt4d_tile_func_t tile_func = iree_uk_mmt4d_select_tile_func(params);
+  iree_uk_mmt4d_tile_func_t tile_func = iree_uk_mmt4d_tile_k0;
+  if (params->K) tile_func = iree_uk_mmt4d_select_tile_func(params);
   iree_uk_mmt4d_using_tile_func(params, tile_func);
 }
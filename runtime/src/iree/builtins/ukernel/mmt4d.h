@@ -18,6 +18,12 @@ typedef enum iree_uk_mmt4d_type_t {
       IREE_UK_TIE_3_TYPES_LITERAL(FLOAT_32, FLOAT_32, FLOAT_32),
   iree_uk_mmt4d_type_i8i8i32 =
       IREE_UK_TIE_3_TYPES_LITERAL(INT_8, INT_8, INT_32),
+  iree_uk_mmt4d_type_f16f16f32 =
+      IREE_UK_TIE_3_TYPES_LITERAL(FLOAT_16, FLOAT_16, FLOAT_32),
+  iree_uk_mmt4d_type_f16f16f16 =
+      IREE_UK_TIE_3_TYPES_LITERAL(FLOAT_16, FLOAT_16, FLOAT_16),
+  iree_uk_mmt4d_type_bf16bf16f32 =
+      IREE_UK_TIE_3_TYPES_LITERAL(BFLOAT_16, BFLOAT_16, FLOAT_32),
 } iree_uk_mmt4d_type_t;
 
 static inline iree_uk_type_t iree_uk_mmt4d_lhs_type(iree_uk_mmt4d_type_t type) {
@@ -48,6 +54,11 @@ typedef struct iree_uk_mmt4d_params_t {
   const void* lhs_buffer;
   const void* rhs_buffer;
   void* out_buffer;
+  // Epilogue parameters, only used when the corresponding
+  // IREE_UK_FLAG_MMT4D_* flags are set.
+  const void* bias_buffer;
+  float requant_scale;
+  iree_uk_int32_t requant_zero_point;
   const iree_uk_uint64_t* cpu_data;
 } iree_uk_mmt4d_params_t;
 
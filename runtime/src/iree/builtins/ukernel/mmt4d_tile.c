@@ -8,6 +8,8 @@
 
 #if defined(IREE_UK_ARCH_ARM_64)
 #include "iree/builtins/ukernel/arch/arm_64/mmt4d_arm_64.h"
+#elif defined(IREE_UK_ARCH_X86_64)
+#include "iree/builtins/ukernel/arch/x86_64/mmt4d_x86_64.h"
 #endif
 
 // Generic implementation of matmul tile, i8*i8->i32 case.
@@ -82,6 +84,101 @@ static void iree_uk_mmt4d_tile_f32f32f32_generic(
   for (int i = 0; i < M0 * N0; ++i) out_tile[i] = acc[i];
 }
 
+// Generic implementation of matmul tile, f16*f16->f32 and bf16*bf16->f32
+// cases. The 16-bit inputs are widened to f32 and accumulated in f32.
+static void iree_uk_mmt4d_tile_16bitfloat_16bitfloat_f32_generic(
+    void* out_tile_untyped, const void* lhs_panel_untyped,
+    const void* rhs_panel_untyped, iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params,
+    float (*to_f32)(iree_uk_uint16_t)) {
+  float* out_tile = out_tile_untyped;
+  const iree_uk_uint16_t* lhs_panel = lhs_panel_untyped;
+  const iree_uk_uint16_t* rhs_panel = rhs_panel_untyped;
+  iree_uk_int16_t M0 = params->M0;
+  iree_uk_int16_t N0 = params->N0;
+  iree_uk_int16_t K0 = params->K0;
+  // Initialize the local accumulator tile.
+  float acc[iree_uk_mmt4d_tile_generic_max_bytes / sizeof(*out_tile)];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < M0 * N0; ++i) acc[i] = out_tile[i];
+  } else {
+    for (int i = 0; i < M0 * N0; ++i) acc[i] = 0;
+  }
+  // Accumulation loop.
+  for (iree_uk_ssize_t k = 0; k < K; ++k) {
+    for (iree_uk_ssize_t i0 = 0; i0 < M0; ++i0) {
+      for (iree_uk_ssize_t j0 = 0; j0 < N0; ++j0) {
+        for (iree_uk_ssize_t k0 = 0; k0 < K0; ++k0) {
+          float lhs_val = to_f32(lhs_panel[i0 * K0 + k0]);
+          float rhs_val = to_f32(rhs_panel[j0 * K0 + k0]);
+          acc[i0 * N0 + j0] += lhs_val * rhs_val;
+        }
+      }
+    }
+    lhs_panel += M0 * K0;
+    rhs_panel += N0 * K0;
+  }
+  // Store the local accumulator tile to the destination.
+  for (int i = 0; i < M0 * N0; ++i) out_tile[i] = acc[i];
+}
+
+static void iree_uk_mmt4d_tile_f16f16f32_generic(
+    void* out_tile, const void* lhs_panel, const void* rhs_panel,
+    iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_16bitfloat_16bitfloat_f32_generic(
+      out_tile, lhs_panel, rhs_panel, K, flags, params, iree_uk_f16_to_f32);
+}
+
+static void iree_uk_mmt4d_tile_bf16bf16f32_generic(
+    void* out_tile, const void* lhs_panel, const void* rhs_panel,
+    iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_16bitfloat_16bitfloat_f32_generic(
+      out_tile, lhs_panel, rhs_panel, K, flags, params, iree_uk_bf16_to_f32);
+}
+
+// Generic implementation of matmul tile, f16*f16->f16 case. The accumulator
+// is kept in f16 and each multiply-add is rounded to f16, like a fused f16
+// multiply-add instruction would: the product of two f16 values is exact in
+// f32, so the only rounding is that of the f32 sum.
+static void iree_uk_mmt4d_tile_f16f16f16_generic(
+    void* out_tile_untyped, const void* lhs_panel_untyped,
+    const void* rhs_panel_untyped, iree_uk_int32_t K, iree_uk_uint32_t flags,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_uint16_t* out_tile = out_tile_untyped;
+  const iree_uk_uint16_t* lhs_panel = lhs_panel_untyped;
+  const iree_uk_uint16_t* rhs_panel = rhs_panel_untyped;
+  iree_uk_int16_t M0 = params->M0;
+  iree_uk_int16_t N0 = params->N0;
+  iree_uk_int16_t K0 = params->K0;
+  // Initialize the local accumulator tile.
+  iree_uk_uint16_t
+      acc[iree_uk_mmt4d_tile_generic_max_bytes / sizeof(*out_tile)];
+  if (flags & IREE_UK_FLAG_ACCUMULATE) {
+    for (int i = 0; i < M0 * N0; ++i) acc[i] = out_tile[i];
+  } else {
+    for (int i = 0; i < M0 * N0; ++i) acc[i] = 0;
+  }
+  // Accumulation loop.
+  for (iree_uk_ssize_t k = 0; k < K; ++k) {
+    for (iree_uk_ssize_t i0 = 0; i0 < M0; ++i0) {
+      for (iree_uk_ssize_t j0 = 0; j0 < N0; ++j0) {
+        for (iree_uk_ssize_t k0 = 0; k0 < K0; ++k0) {
+          float lhs_val = iree_uk_f16_to_f32(lhs_panel[i0 * K0 + k0]);
+          float rhs_val = iree_uk_f16_to_f32(rhs_panel[j0 * K0 + k0]);
+          float acc_val = iree_uk_f16_to_f32(acc[i0 * N0 + j0]);
+          acc[i0 * N0 + j0] = iree_uk_f32_to_f16(acc_val + lhs_val * rhs_val);
+        }
+      }
+    }
+    lhs_panel += M0 * K0;
+    rhs_panel += N0 * K0;
+  }
+  // Store the local accumulator tile to the destination.
+  for (int i = 0; i < M0 * N0; ++i) out_tile[i] = acc[i];
+}
+
 static iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func_generic(
     const iree_uk_mmt4d_params_t* params) {
   switch (params->type) {
@@ -89,6 +186,12 @@ static iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func_generic(
       return iree_uk_mmt4d_tile_f32f32f32_generic;
     case iree_uk_mmt4d_type_i8i8i32:
       return iree_uk_mmt4d_tile_i8i8i32_generic;
+    case iree_uk_mmt4d_type_f16f16f32:
+      return iree_uk_mmt4d_tile_f16f16f32_generic;
+    case iree_uk_mmt4d_type_f16f16f16:
+      return iree_uk_mmt4d_tile_f16f16f16_generic;
+    case iree_uk_mmt4d_type_bf16bf16f32:
+      return iree_uk_mmt4d_tile_bf16bf16f32_generic;
     default:
       // shouldn't happen, validated earlier.
       IREE_UK_ASSUME_UNREACHABLE;
@@ -100,6 +203,8 @@ static iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func_arch(
     const iree_uk_mmt4d_params_t* params) {
 #if defined(IREE_UK_ARCH_ARM_64)
   return iree_uk_mmt4d_select_tile_func_arm_64(params);
+#elif defined(IREE_UK_ARCH_X86_64)
+  return iree_uk_mmt4d_select_tile_func_x86_64(params);
 #endif
   return 0;
 }
@@ -59,7 +59,9 @@ static void iree_uk_pack_validate(const iree_uk_pack_params_t* params) {
   IREE_UK_ASSERT(!(params->flags & ~allflags));
   IREE_UK_ASSERT(params->type == iree_uk_pack_type_f32f32 ||
                  params->type == iree_uk_pack_type_i8i8 ||
-                 params->type == iree_uk_pack_type_i32i32);
+                 params->type == iree_uk_pack_type_i32i32 ||
+                 params->type == iree_uk_pack_type_f16f16 ||
+                 params->type == iree_uk_pack_type_bf16bf16);
   IREE_UK_ASSERT(params->in_stride0 >= 0);
   IREE_UK_ASSERT(params->out_stride0 >= 0);
   IREE_UK_ASSERT(params->in_size0 >= 0);
@@ -8,13 +8,18 @@
 
 #if defined(IREE_UK_ARCH_ARM_64)
 #include "iree/builtins/ukernel/arch/arm_64/query_tile_sizes_arm_64.h"
+#elif defined(IREE_UK_ARCH_X86_64)
+#include "iree/builtins/ukernel/arch/x86_64/query_tile_sizes_x86_64.h"
 #endif
 
 static bool iree_uk_query_tile_sizes_operation_is_matmul(
     iree_uk_uint32_t flags) {
   iree_uk_uint32_t op = iree_uk_query_tile_sizes_operation(flags);
   return op == IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_F32F32F32 ||
-         op == IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_I8I8I32;
+         op == IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_I8I8I32 ||
+         op == IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_F16F16F32 ||
+         op == IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_F16F16F16 ||
+         op == IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_BF16BF16F32;
 }
 
 static void iree_uk_query_tile_sizes_2d_validate(
@@ -47,6 +52,8 @@ static bool iree_uk_query_matmul_tile_sizes_arch(
     iree_uk_matmul_tile_sizes_t* out_matmul_tile_sizes) {
 #if defined(IREE_UK_ARCH_ARM_64)
   return iree_uk_query_matmul_tile_sizes_arm_64(params, out_matmul_tile_sizes);
+#elif defined(IREE_UK_ARCH_X86_64)
+  return iree_uk_query_matmul_tile_sizes_x86_64(params, out_matmul_tile_sizes);
 #endif
   return false;
 }
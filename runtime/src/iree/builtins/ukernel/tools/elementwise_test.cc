@@ -0,0 +1,317 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/cpu.h"
+#include "iree/builtins/ukernel/api.h"
+#include "iree/builtins/ukernel/tools/ukernel_test_utils.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+static float f32_from_bits(iree_uk_uint32_t u) {
+  float f;
+  memcpy(&f, &u, sizeof f);
+  return f;
+}
+
+static iree_uk_uint32_t bits_from_f32(float f) {
+  iree_uk_uint32_t u;
+  memcpy(&u, &f, sizeof u);
+  return u;
+}
+
+typedef iree_uk_uint32_t (*x32b_reference_func_t)(iree_uk_uint32_t,
+                                                  iree_uk_uint32_t);
+typedef iree_uk_uint32_t (*x32u_reference_func_t)(iree_uk_uint32_t);
+
+#define X32B_REFERENCE_F32(NAME, EXPR)                                 \
+  static iree_uk_uint32_t NAME##_reference(iree_uk_uint32_t lhs_bits,  \
+                                           iree_uk_uint32_t rhs_bits) { \
+    float l = f32_from_bits(lhs_bits);                                 \
+    float r = f32_from_bits(rhs_bits);                                 \
+    return bits_from_f32(EXPR);                                        \
+  }
+
+#define X32B_REFERENCE_I32(NAME, EXPR)                                 \
+  static iree_uk_uint32_t NAME##_reference(iree_uk_uint32_t l,         \
+                                           iree_uk_uint32_t r) {       \
+    return EXPR;                                                       \
+  }
+
+#define X32U_REFERENCE_F32(NAME, EXPR)                                  \
+  static iree_uk_uint32_t NAME##_reference(iree_uk_uint32_t in_bits) { \
+    float x = f32_from_bits(in_bits);                                   \
+    return bits_from_f32(EXPR);                                         \
+  }
+
+X32B_REFERENCE_F32(addf, l + r)
+X32B_REFERENCE_F32(subf, l - r)
+X32B_REFERENCE_F32(mulf, l* r)
+X32B_REFERENCE_F32(divf, l / r)
+X32B_REFERENCE_F32(maxf, (l > r || l != l) ? l : r)
+X32B_REFERENCE_F32(minf, (l < r || l != l) ? l : r)
+X32B_REFERENCE_I32(addi, l + r)
+X32B_REFERENCE_I32(subi, l - r)
+X32B_REFERENCE_I32(muli, l* r)
+X32B_REFERENCE_I32(andi, l& r)
+X32B_REFERENCE_I32(ori, l | r)
+X32B_REFERENCE_I32(xori, l ^ r)
+
+X32U_REFERENCE_F32(absf, std::fabs(x))
+X32U_REFERENCE_F32(ceilf, std::ceil(x))
+X32U_REFERENCE_F32(expf, std::exp(x))
+X32U_REFERENCE_F32(floorf, std::floor(x))
+X32U_REFERENCE_F32(negf, -x)
+X32U_REFERENCE_F32(rsqrtf, 1.0f / std::sqrt(x))
+X32U_REFERENCE_F32(tanhf, std::tanh(x))
+
+static iree_uk_uint32_t ctlz_reference(iree_uk_uint32_t x) {
+  iree_uk_uint32_t count = 0;
+  for (iree_uk_uint32_t bit = 0x80000000u; bit && !(x & bit); bit >>= 1) {
+    ++count;
+  }
+  return count;
+}
+
+// How the results of an op are compared to the reference.
+enum elementwise_compare_t {
+  // Bit-exact comparison.
+  ELEMENTWISE_COMPARE_EXACT,
+  // The op is an approximation (e.g. polynomial exp and tanh): allow a small
+  // relative and absolute error.
+  ELEMENTWISE_COMPARE_APPROX_F32,
+};
+
+// Which values the inputs are drawn from.
+enum elementwise_input_t {
+  // Random bits, excluding NaN and infinity when interpreted as float.
+  ELEMENTWISE_INPUT_ANY_BITS,
+  // Floats in [-16, 16), the interesting range of exp and tanh.
+  ELEMENTWISE_INPUT_F32_SMALL,
+  // Floats in [1/16, 16), for ops such as rsqrtf and divf.
+  ELEMENTWISE_INPUT_F32_POSITIVE,
+};
+
+static iree_uk_uint32_t random_input(elementwise_input_t input,
+                                     iree_uk_test_random_engine_t* engine) {
+  float unit = iree_uk_test_random_engine_get_0_65535(engine) / 65536.0f;
+  switch (input) {
+    case ELEMENTWISE_INPUT_F32_SMALL:
+      return bits_from_f32(32.0f * unit - 16.0f);
+    case ELEMENTWISE_INPUT_F32_POSITIVE:
+      return bits_from_f32(0.0625f + 15.9375f * unit);
+    default: {
+      iree_uk_uint32_t bits =
+          (iree_uk_uint32_t)iree_uk_test_random_engine_get_0_65535(engine) |
+          ((iree_uk_uint32_t)iree_uk_test_random_engine_get_0_65535(engine)
+           << 16);
+      // Keep floats finite by clearing the low exponent bit when the exponent
+      // is all ones.
+      if ((bits & 0x7f800000u) == 0x7f800000u) bits &= ~0x00800000u;
+      return bits;
+    }
+  }
+}
+
+static bool results_match(elementwise_compare_t compare,
+                          iree_uk_uint32_t expected, iree_uk_uint32_t actual) {
+  if (compare == ELEMENTWISE_COMPARE_EXACT) return expected == actual;
+  float e = f32_from_bits(expected);
+  float a = f32_from_bits(actual);
+  return std::fabs(e - a) <= 1e-5f * std::fabs(e) + 1e-6f;
+}
+
+// Shapes and strides to test. Rows are longer than any vector width and not a
+// multiple of it, so row functions and the scalar remainder loop both run.
+struct elementwise_test_shape_t {
+  iree_uk_ssize_t size0;
+  iree_uk_ssize_t size1;
+  // Extra elements between consecutive rows.
+  iree_uk_ssize_t row_padding;
+  // Stride1 of the lhs (binary) or in (unary) operand.
+  iree_uk_ssize_t lhs_stride1;
+  // Stride1 of the rhs operand (binary only).
+  iree_uk_ssize_t rhs_stride1;
+};
+
+static const elementwise_test_shape_t elementwise_test_shapes[] = {
+    {1, 1, 0, 1, 1},  {3, 37, 5, 1, 1}, {2, 64, 0, 1, 1}, {4, 21, 3, 1, 0},
+    {4, 21, 3, 0, 1}, {3, 19, 1, 2, 1}, {5, 0, 1, 1, 1},
+};
+
+static void x32b_test(iree_uk_x32b_2d_func_t func,
+                      x32b_reference_func_t reference,
+                      elementwise_input_t input, elementwise_compare_t compare,
+                      const iree_uk_uint64_t* cpu_data,
+                      iree_uk_test_random_engine_t* engine) {
+  for (const elementwise_test_shape_t& shape : elementwise_test_shapes) {
+    iree_uk_ssize_t lhs_stride0 =
+        shape.size1 * shape.lhs_stride1 + shape.row_padding;
+    iree_uk_ssize_t rhs_stride0 =
+        shape.size1 * shape.rhs_stride1 + shape.row_padding;
+    iree_uk_ssize_t out_stride0 = shape.size1 + shape.row_padding;
+    // Broadcast operands still need a valid element to read.
+    std::vector<iree_uk_uint32_t> lhs(
+        std::max<iree_uk_ssize_t>(1, shape.size0 * lhs_stride0));
+    std::vector<iree_uk_uint32_t> rhs(
+        std::max<iree_uk_ssize_t>(1, shape.size0 * rhs_stride0));
+    std::vector<iree_uk_uint32_t> out(
+        std::max<iree_uk_ssize_t>(1, shape.size0 * out_stride0));
+    for (auto& v : lhs) v = random_input(input, engine);
+    for (auto& v : rhs) v = random_input(input, engine);
+    for (auto& v : out) v = random_input(ELEMENTWISE_INPUT_ANY_BITS, engine);
+    std::vector<iree_uk_uint32_t> expected = out;
+    for (iree_uk_ssize_t i = 0; i < shape.size0; ++i) {
+      for (iree_uk_ssize_t j = 0; j < shape.size1; ++j) {
+        expected[i * out_stride0 + j] =
+            reference(lhs[i * lhs_stride0 + j * shape.lhs_stride1],
+                      rhs[i * rhs_stride0 + j * shape.rhs_stride1]);
+      }
+    }
+    ASSERT_EQ(0, func(lhs.data(), 0, lhs_stride0, shape.lhs_stride1,
+                      rhs.data(), 0, rhs_stride0, shape.rhs_stride1,
+                      out.data(), 0, out_stride0, 1, shape.size0, shape.size1,
+                      cpu_data));
+    for (size_t k = 0; k < out.size(); ++k) {
+      ASSERT_TRUE(results_match(compare, expected[k], out[k]))
+          << "shape " << shape.size0 << "x" << shape.size1 << ", index " << k
+          << ": expected " << f32_from_bits(expected[k]) << " (0x" << std::hex
+          << expected[k] << "), actual " << f32_from_bits(out[k]) << " (0x"
+          << out[k] << ")";
+    }
+  }
+}
+
+static void x32u_test(iree_uk_x32u_2d_func_t func,
+                      x32u_reference_func_t reference,
+                      elementwise_input_t input, elementwise_compare_t compare,
+                      const iree_uk_uint64_t* cpu_data,
+                      iree_uk_test_random_engine_t* engine) {
+  for (const elementwise_test_shape_t& shape : elementwise_test_shapes) {
+    // Unary ops have no broadcast operand.
+    iree_uk_ssize_t in_stride1 =
+        std::max<iree_uk_ssize_t>(1, shape.lhs_stride1);
+    iree_uk_ssize_t in_stride0 = shape.size1 * in_stride1 + shape.row_padding;
+    iree_uk_ssize_t out_stride0 = shape.size1 + shape.row_padding;
+    std::vector<iree_uk_uint32_t> in(
+        std::max<iree_uk_ssize_t>(1, shape.size0 * in_stride0));
+    std::vector<iree_uk_uint32_t> out(
+        std::max<iree_uk_ssize_t>(1, shape.size0 * out_stride0));
+    for (auto& v : in) v = random_input(input, engine);
+    for (auto& v : out) v = random_input(ELEMENTWISE_INPUT_ANY_BITS, engine);
+    std::vector<iree_uk_uint32_t> expected = out;
+    for (iree_uk_ssize_t i = 0; i < shape.size0; ++i) {
+      for (iree_uk_ssize_t j = 0; j < shape.size1; ++j) {
+        expected[i * out_stride0 + j] =
+            reference(in[i * in_stride0 + j * in_stride1]);
+      }
+    }
+    ASSERT_EQ(0, func(in.data(), 0, in_stride0, in_stride1, out.data(), 0,
+                      out_stride0, 1, shape.size0, shape.size1, cpu_data));
+    for (size_t k = 0; k < out.size(); ++k) {
+      ASSERT_TRUE(results_match(compare, expected[k], out[k]))
+          << "shape " << shape.size0 << "x" << shape.size1 << ", index " << k
+          << ": expected " << f32_from_bits(expected[k]) << " (0x" << std::hex
+          << expected[k] << "), actual " << f32_from_bits(out[k]) << " (0x"
+          << out[k] << ")";
+    }
+  }
+}
+
+// Runs |test| without optional CPU features, which tests the fallback to
+// architecture-default or generic code, then again with |cpu_data_field_0_bit|
+// if it is nonzero and supported by the CPU.
+template <typename Func, typename Reference>
+static void elementwise_test(void (*test)(Func, Reference, elementwise_input_t,
+                                          elementwise_compare_t,
+                                          const iree_uk_uint64_t*,
+                                          iree_uk_test_random_engine_t*),
+                             Func func, Reference reference,
+                             elementwise_input_t input,
+                             elementwise_compare_t compare,
+                             iree_uk_uint64_t cpu_data_field_0_bit) {
+  const iree_uk_uint64_t local_cpu_data_default[IREE_CPU_DATA_FIELD_COUNT] = {
+      0};
+  iree_uk_test_random_engine_t* engine = iree_uk_test_random_engine_create();
+  test(func, reference, input, compare, local_cpu_data_default, engine);
+  if (cpu_data_field_0_bit) {
+    const iree_uk_uint64_t local_cpu_data_with_bit[IREE_CPU_DATA_FIELD_COUNT] =
+        {cpu_data_field_0_bit};
+    // Check if the CPU supports the feature (otherwise, we crash).
+    bool supported = iree_cpu_data_field(0) & cpu_data_field_0_bit;
+    char cpu_feat_str[32];
+    iree_uk_test_cpu_features_str(cpu_feat_str, sizeof cpu_feat_str,
+                                  local_cpu_data_with_bit, 1);
+    if (supported) {
+      printf("Device supports CPU feature: %s\n", cpu_feat_str);
+      test(func, reference, input, compare, local_cpu_data_with_bit, engine);
+    } else {
+      printf("Skipped: device does not support CPU feature: %s\n",
+             cpu_feat_str);
+    }
+  }
+  iree_uk_test_random_engine_destroy(engine);
+}
+
+#define X32B_TEST(op, input, compare, test_suffix, feature_bit)         \
+  TEST(ElementwiseTest, x32b_##op##_##test_suffix) {                    \
+    elementwise_test(x32b_test, iree_uk_x32b_##op##_2d, op##_reference, \
+                     ELEMENTWISE_INPUT_##input,                         \
+                     ELEMENTWISE_COMPARE_##compare, feature_bit);       \
+  }
+
+#define X32U_TEST(op, input, compare, test_suffix, feature_bit)         \
+  TEST(ElementwiseTest, x32u_##op##_##test_suffix) {                    \
+    elementwise_test(x32u_test, iree_uk_x32u_##op##_2d, op##_reference, \
+                     ELEMENTWISE_INPUT_##input,                         \
+                     ELEMENTWISE_COMPARE_##compare, feature_bit);       \
+  }
+
+#define ELEMENTWISE_TESTS(test_suffix, feature_bit)                     \
+  X32B_TEST(addf, F32_SMALL, EXACT, test_suffix, feature_bit)           \
+  X32B_TEST(subf, F32_SMALL, EXACT, test_suffix, feature_bit)           \
+  X32B_TEST(mulf, F32_SMALL, EXACT, test_suffix, feature_bit)           \
+  X32B_TEST(divf, F32_POSITIVE, EXACT, test_suffix, feature_bit)        \
+  X32B_TEST(maxf, F32_SMALL, EXACT, test_suffix, feature_bit)           \
+  X32B_TEST(minf, F32_SMALL, EXACT, test_suffix, feature_bit)           \
+  X32B_TEST(addi, ANY_BITS, EXACT, test_suffix, feature_bit)            \
+  X32B_TEST(subi, ANY_BITS, EXACT, test_suffix, feature_bit)            \
+  X32B_TEST(muli, ANY_BITS, EXACT, test_suffix, feature_bit)            \
+  X32B_TEST(andi, ANY_BITS, EXACT, test_suffix, feature_bit)            \
+  X32B_TEST(ori, ANY_BITS, EXACT, test_suffix, feature_bit)             \
+  X32B_TEST(xori, ANY_BITS, EXACT, test_suffix, feature_bit)            \
+  X32U_TEST(absf, F32_SMALL, EXACT, test_suffix, feature_bit)           \
+  X32U_TEST(ceilf, F32_SMALL, EXACT, test_suffix, feature_bit)          \
+  X32U_TEST(ctlz, ANY_BITS, EXACT, test_suffix, feature_bit)            \
+  X32U_TEST(expf, F32_SMALL, APPROX_F32, test_suffix, feature_bit)      \
+  X32U_TEST(floorf, F32_SMALL, EXACT, test_suffix, feature_bit)         \
+  X32U_TEST(negf, F32_SMALL, EXACT, test_suffix, feature_bit)           \
+  X32U_TEST(rsqrtf, F32_POSITIVE, APPROX_F32, test_suffix, feature_bit) \
+  X32U_TEST(tanhf, F32_SMALL, APPROX_F32, test_suffix, feature_bit)
+
+// Generic tests, not matching any particular CPU feature. On architectures
+// with default SIMD code paths (such as NEON on ARM_64), these also test that.
+ELEMENTWISE_TESTS(generic, 0)
+
+// X86_64 tests.
+#if defined(IREE_UK_ARCH_X86_64)
+
+ELEMENTWISE_TESTS(x86_64_avx2_fma, IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA)
+ELEMENTWISE_TESTS(x86_64_avx512_base,
+                  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE)
+
+#endif  // defined(IREE_UK_ARCH_X86_64)
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  iree_cpu_initialize(iree_allocator_system());
+  return RUN_ALL_TESTS();
+}
@@ -28,6 +28,37 @@ IREE_FLAG(
 IREE_FLAG(bool, accumulate, false,
           "Whether the kernel should accumulate into the existing accumulator "
           "tile values, or zero the accumulator tile.");
+IREE_FLAG(bool, bias, false,
+          "Whether the kernel should add a bias vector to the result.");
+IREE_FLAG(int32_t, activation, 0,
+          "Activation applied to the result: 0 = none, 1 = ReLU, 2 = GeLU "
+          "(GeLU requires a floating-point result).");
+IREE_FLAG(int32_t, l2_cache_kb, -1,
+          "L2 cache size in KiB used by the kernel to block the N loop. -1 "
+          "uses the size detected on the host, 0 the kernel's default.");
+IREE_FLAG(int32_t, l3_cache_kb, -1,
+          "L3 cache size in KiB used by the kernel to block the M loop. -1 "
+          "uses the size detected on the host, 0 disables M blocking.");
+
+// Returns |cpu_data| field 1 with the cache sizes overridden by the flags.
+static iree_uk_uint64_t iree_mmt4d_benchmark_cache_sizes_field(void) {
+  iree_uk_uint64_t field = iree_cpu_data_field(1);
+  if (FLAG_l2_cache_kb >= 0) {
+    field &= ~(IREE_CPU_DATA_FIELD_1_CACHE_KB_MASK
+               << IREE_CPU_DATA_FIELD_1_L2_CACHE_KB_SHIFT);
+    field |= ((iree_uk_uint64_t)FLAG_l2_cache_kb &
+              IREE_CPU_DATA_FIELD_1_CACHE_KB_MASK)
+             << IREE_CPU_DATA_FIELD_1_L2_CACHE_KB_SHIFT;
+  }
+  if (FLAG_l3_cache_kb >= 0) {
+    field &= ~(IREE_CPU_DATA_FIELD_1_CACHE_KB_MASK
+               << IREE_CPU_DATA_FIELD_1_L3_CACHE_KB_SHIFT);
+    field |= ((iree_uk_uint64_t)FLAG_l3_cache_kb &
+              IREE_CPU_DATA_FIELD_1_CACHE_KB_MASK)
+             << IREE_CPU_DATA_FIELD_1_L3_CACHE_KB_SHIFT;
+  }
+  return field;
+}
 
 struct iree_mmt4d_benchmark_user_data_t {
   iree_uk_mmt4d_type_t type;
@@ -48,13 +79,24 @@ static iree_status_t iree_mmt4d_benchmark(
   memset(&params, 0, sizeof params);
   params.type = user_data->type;
   params.flags = FLAG_accumulate ? IREE_UK_FLAG_ACCUMULATE : 0;
+  if (FLAG_bias) params.flags |= IREE_UK_FLAG_MMT4D_BIAS;
+  if (FLAG_activation == 1) {
+    params.flags |= IREE_UK_FLAG_MMT4D_ACTIVATION_RELU;
+  } else if (FLAG_activation == 2) {
+    params.flags |= IREE_UK_FLAG_MMT4D_ACTIVATION_GELU;
+  }
   params.M = FLAG_m_size;
   params.N = FLAG_n_size;
   params.K = FLAG_k_size;
   params.M0 = user_data->M0;
   params.N0 = user_data->N0;
   params.K0 = user_data->K0;
-  params.cpu_data = user_data->cpu_data;
+  // The registered cpu_data only selects the code path; cache sizes come from
+  // the host unless overridden by flags.
+  iree_uk_uint64_t cpu_data[IREE_CPU_DATA_FIELD_COUNT];
+  memcpy(cpu_data, user_data->cpu_data, sizeof cpu_data);
+  cpu_data[1] = iree_mmt4d_benchmark_cache_sizes_field();
+  params.cpu_data = cpu_data;
   params.lhs_stride = params.K * params.M0 * params.K0;
   params.rhs_stride = params.K * params.N0 * params.K0;
   params.out_stride = params.N * params.M0 * params.N0;
@@ -70,6 +112,9 @@ static iree_status_t iree_mmt4d_benchmark(
   void* lhs_buffer = malloc(lhs_buffer_size);
   void* rhs_buffer = malloc(rhs_buffer_size);
   void* out_buffer = malloc(out_buffer_size);
+  iree_uk_ssize_t bias_buffer_size =
+      iree_uk_test_2d_buffer_length(out_type, 1, params.N * params.N0);
+  void* bias_buffer = malloc(bias_buffer_size);
   iree_uk_test_random_engine_t* engine = iree_uk_test_random_engine_create();
   // It's just about plausible that on some platform, for some number type,
   // performance might be different on zero buffers vs random buffers. But it
@@ -81,10 +126,13 @@ static iree_status_t iree_mmt4d_benchmark(
                                    engine);
   iree_uk_test_write_random_buffer(out_buffer, out_buffer_size, out_type,
                                    engine);
+  iree_uk_test_write_random_buffer(bias_buffer, bias_buffer_size, out_type,
+                                   engine);
   iree_uk_test_random_engine_destroy(engine);
   params.lhs_buffer = lhs_buffer;
   params.rhs_buffer = rhs_buffer;
   params.out_buffer = out_buffer;
+  params.bias_buffer = bias_buffer;
   iree_uk_int64_t total_iterations = 0;
   while (iree_benchmark_keep_running(benchmark_state,
                                      /*batch_count=*/FLAG_batch_count)) {
@@ -99,6 +147,7 @@ static iree_status_t iree_mmt4d_benchmark(
   free(lhs_buffer);
   free(rhs_buffer);
   free(out_buffer);
+  free(bias_buffer);
   return iree_ok_status();
 }
 
@@ -154,6 +203,12 @@ static void iree_mmt4d_benchmark_register(
                            IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_##_cpu_feature,  \
                            arm_64_##_cpu_feature)
 
+#define MMT4D_BENCHMARK_REGISTER_X86_64_WITH_CPU_FEATURE(_type, _m0, _n0, _k0, \
+                                                         _cpu_feature)         \
+  MMT4D_BENCHMARK_REGISTER(_type, _m0, _n0, _k0,                               \
+                           IREE_CPU_DATA_FIELD_0_X86_64_HAVE_##_cpu_feature,   \
+                           x86_64_##_cpu_feature)
+
 int main(int argc, char** argv) {
   iree_flags_set_usage("mmt4d_benchmark",
                        "Benchmarks the mmt4d microkernel.\n"
@@ -176,9 +231,29 @@ int main(int argc, char** argv) {
   MMT4D_BENCHMARK_REGISTER_ARM_64(i8i8i32, 8, 8, 1);
   MMT4D_BENCHMARK_REGISTER_ARM_64_WITH_CPU_FEATURE(i8i8i32, 8, 8, 4, DOTPROD);
   MMT4D_BENCHMARK_REGISTER_ARM_64_WITH_CPU_FEATURE(i8i8i32, 8, 8, 8, I8MM);
+  MMT4D_BENCHMARK_REGISTER_ARM_64_WITH_CPU_FEATURE(f16f16f32, 8, 8, 1,
+                                                   FP16FML);
+  MMT4D_BENCHMARK_REGISTER_ARM_64_WITH_CPU_FEATURE(bf16bf16f32, 8, 8, 4, BF16);
 
 #endif  // defined(IREE_UK_ARCH_ARM_64)
 
+// X86_64 benchmarks.
+#if defined(IREE_UK_ARCH_X86_64)
+
+  MMT4D_BENCHMARK_REGISTER_X86_64_WITH_CPU_FEATURE(f32f32f32, 8, 8, 1,
+                                                   AVX2_FMA);
+  MMT4D_BENCHMARK_REGISTER_X86_64_WITH_CPU_FEATURE(i8i8i32, 8, 8, 2, AVX2_FMA);
+  MMT4D_BENCHMARK_REGISTER_X86_64_WITH_CPU_FEATURE(f32f32f32, 16, 16, 1,
+                                                   AVX512_BASE);
+  MMT4D_BENCHMARK_REGISTER_X86_64_WITH_CPU_FEATURE(i8i8i32, 16, 16, 2,
+                                                   AVX512_BASE);
+  MMT4D_BENCHMARK_REGISTER_X86_64_WITH_CPU_FEATURE(i8i8i32, 16, 16, 4,
+                                                   AVX512_VNNI);
+  MMT4D_BENCHMARK_REGISTER_X86_64_WITH_CPU_FEATURE(bf16bf16f32, 16, 16, 2,
+                                                   AVX512_BF16);
+
+#endif  // defined(IREE_UK_ARCH_X86_64)
+
   iree_benchmark_run_specified();
   return 0;
 }
@@ -43,6 +43,8 @@
 // things that we would otherwise prefer to keep internal in the mmt4d builtin
 // implementation, and would make e2e/matmul tests even more expensive.
 
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 #include "iree/base/api.h"
@@ -52,7 +54,39 @@
 #include "iree/testing/gtest.h"
 #include "iree/testing/status_matchers.h"
 
-template <typename lhs_t, typename rhs_t, typename out_t>
+// Element access for the reference code. 16-bit floating-point values are
+// stored as raw bits and converted to and from float.
+struct iree_mmt4d_f16_t {
+  iree_uk_uint16_t bits;
+};
+struct iree_mmt4d_bf16_t {
+  iree_uk_uint16_t bits;
+};
+template <typename acc_t, typename T>
+static acc_t iree_mmt4d_load(const T& value) {
+  return value;
+}
+template <>
+float iree_mmt4d_load<float, iree_mmt4d_f16_t>(const iree_mmt4d_f16_t& value) {
+  return iree_uk_f16_to_f32(value.bits);
+}
+template <>
+float iree_mmt4d_load<float, iree_mmt4d_bf16_t>(
+    const iree_mmt4d_bf16_t& value) {
+  return iree_uk_bf16_to_f32(value.bits);
+}
+template <typename acc_t, typename T>
+static void iree_mmt4d_store(acc_t value, T* out) {
+  *out = value;
+}
+template <>
+void iree_mmt4d_store<float, iree_mmt4d_f16_t>(float value,
+                                               iree_mmt4d_f16_t* out) {
+  out->bits = iree_uk_f32_to_f16(value);
+}
+
+template <typename lhs_t, typename rhs_t, typename out_t,
+          typename acc_t = out_t>
 static void iree_mmt4d_reference(const iree_uk_mmt4d_params_t& params) {
   bool accumulate = params.flags & IREE_UK_FLAG_ACCUMULATE;
   iree_uk_ssize_t lhs_tile_size = params.M0 * params.K0;
@@ -71,12 +105,15 @@ static void iree_mmt4d_reference(const iree_uk_mmt4d_params_t& params) {
           const lhs_t* lhs_tile_ptr = lhs_panel_ptr;
           const rhs_t* rhs_tile_ptr = rhs_panel_ptr;
           out_t* out_ptr = out_tile_ptr + i0 * params.N0 + j0;
-          out_t acc = accumulate ? *out_ptr : 0.f;
+          out_t acc = accumulate ? *out_ptr : out_t{};
           for (iree_uk_ssize_t k = 0; k < params.K; ++k) {
             for (iree_uk_ssize_t k0 = 0; k0 < params.K0; ++k0) {
-              out_t lhs_val = lhs_tile_ptr[i0 * params.K0 + k0];
-              out_t rhs_val = rhs_tile_ptr[j0 * params.K0 + k0];
-              acc += lhs_val * rhs_val;
+              acc_t lhs_val =
+                  iree_mmt4d_load<acc_t>(lhs_tile_ptr[i0 * params.K0 + k0]);
+              acc_t rhs_val =
+                  iree_mmt4d_load<acc_t>(rhs_tile_ptr[j0 * params.K0 + k0]);
+              iree_mmt4d_store(iree_mmt4d_load<acc_t>(acc) + lhs_val * rhs_val,
+                               &acc);
             }
             lhs_tile_ptr += lhs_tile_size;
             rhs_tile_ptr += rhs_tile_size;
@@ -88,7 +125,7 @@ static void iree_mmt4d_reference(const iree_uk_mmt4d_params_t& params) {
   }
 }
 
-static void iree_mmt4d_reference(const iree_uk_mmt4d_params_t& params) {
+static void iree_mmt4d_reference_matmul(const iree_uk_mmt4d_params_t& params) {
   switch (params.type) {
     case iree_uk_mmt4d_type_f32f32f32:
       iree_mmt4d_reference<float, float, float>(params);
@@ -97,11 +134,168 @@ static void iree_mmt4d_reference(const iree_uk_mmt4d_params_t& params) {
       iree_mmt4d_reference<iree_uk_int8_t, iree_uk_int8_t, iree_uk_int32_t>(
           params);
       break;
+    case iree_uk_mmt4d_type_f16f16f32:
+      iree_mmt4d_reference<iree_mmt4d_f16_t, iree_mmt4d_f16_t, float>(params);
+      break;
+    case iree_uk_mmt4d_type_f16f16f16:
+      // Like the generic tile function, round the accumulator to f16 after
+      // each multiply-add.
+      iree_mmt4d_reference<iree_mmt4d_f16_t, iree_mmt4d_f16_t, iree_mmt4d_f16_t,
+                           float>(params);
+      break;
+    case iree_uk_mmt4d_type_bf16bf16f32:
+      iree_mmt4d_reference<iree_mmt4d_bf16_t, iree_mmt4d_bf16_t, float>(
+          params);
+      break;
     default:
       assert(false && "unknown type");
   }
 }
 
+static float iree_mmt4d_reference_activation(iree_uk_uint32_t flags, float x) {
+  switch (flags & IREE_UK_FLAG_MMT4D_ACTIVATION_MASK_INTERNAL) {
+    case IREE_UK_FLAG_MMT4D_ACTIVATION_RELU:
+      return x < 0.0f ? 0.0f : x;
+    case IREE_UK_FLAG_MMT4D_ACTIVATION_GELU:
+      return 0.5f * x *
+             (1.0f + std::tanh(0.7978845608028654f *
+                               (x + 0.044715f * x * x * x)));
+    default:
+      return x;
+  }
+}
+
+// Applies the epilogue to one element of an i8i8i32 matmul. The result is
+// int8 when requantizing and int32 otherwise.
+template <typename out_t>
+static out_t iree_mmt4d_reference_epilogue(const iree_uk_mmt4d_params_t& params,
+                                           iree_uk_int32_t acc,
+                                           const iree_uk_int32_t* bias) {
+  iree_uk_uint32_t flags = params.flags;
+  if (bias) acc += *bias;
+  if (flags & IREE_UK_FLAG_MMT4D_REQUANTIZE) {
+    float x =
+        iree_mmt4d_reference_activation(flags, acc * params.requant_scale);
+    x = std::round(x + params.requant_zero_point);
+    return std::min(127.0f, std::max(-128.0f, x));
+  }
+  if ((flags & IREE_UK_FLAG_MMT4D_ACTIVATION_MASK_INTERNAL) ==
+      IREE_UK_FLAG_MMT4D_ACTIVATION_RELU) {
+    acc = std::max(0, acc);
+  }
+  return acc;
+}
+
+// Applies the epilogue to one element of a matmul with a floating-point
+// result, computing in float like the ukernel.
+template <typename out_t, typename acc_t>
+static out_t iree_mmt4d_reference_epilogue(const iree_uk_mmt4d_params_t& params,
+                                           acc_t acc, const acc_t* bias) {
+  float v = iree_mmt4d_load<float>(acc);
+  if (bias) v += iree_mmt4d_load<float>(*bias);
+  out_t result;
+  iree_mmt4d_store<float>(iree_mmt4d_reference_activation(params.flags, v),
+                          &result);
+  return result;
+}
+
+template <typename acc_t, typename out_t>
+static void iree_mmt4d_reference_epilogue(const iree_uk_mmt4d_params_t& params,
+                                          const acc_t* acc_buffer) {
+  iree_uk_ssize_t tile_size = params.M0 * params.N0;
+  const acc_t* bias_buffer = (const acc_t*)params.bias_buffer;
+  bool has_bias = params.flags & IREE_UK_FLAG_MMT4D_BIAS;
+  for (iree_uk_ssize_t i = 0; i < params.M; ++i) {
+    for (iree_uk_ssize_t j = 0; j < params.N; ++j) {
+      for (iree_uk_ssize_t i0 = 0; i0 < params.M0; ++i0) {
+        for (iree_uk_ssize_t j0 = 0; j0 < params.N0; ++j0) {
+          iree_uk_ssize_t index =
+              i * params.out_stride + j * tile_size + i0 * params.N0 + j0;
+          const acc_t* bias =
+              has_bias ? &bias_buffer[j * params.N0 + j0] : nullptr;
+          ((out_t*)params.out_buffer)[index] =
+              iree_mmt4d_reference_epilogue<out_t>(params, acc_buffer[index],
+                                                   bias);
+        }
+      }
+    }
+  }
+}
+
+static void iree_mmt4d_reference(const iree_uk_mmt4d_params_t& params) {
+  const iree_uk_uint32_t epilogue_flags =
+      IREE_UK_FLAG_MMT4D_BIAS | IREE_UK_FLAG_MMT4D_ACTIVATION_MASK_INTERNAL |
+      IREE_UK_FLAG_MMT4D_REQUANTIZE;
+  if (!(params.flags & epilogue_flags)) {
+    iree_mmt4d_reference_matmul(params);
+    return;
+  }
+  // Compute the plain matmul into a temporary accumulator-type buffer, seeded
+  // with the existing output when accumulating, then apply the epilogue.
+  iree_uk_type_t acc_type = iree_uk_mmt4d_out_type(params.type);
+  iree_uk_ssize_t acc_buffer_size =
+      iree_uk_test_2d_buffer_length(acc_type, params.M, params.out_stride);
+  std::vector<char> acc_buffer(acc_buffer_size);
+  if (params.flags & IREE_UK_FLAG_ACCUMULATE) {
+    memcpy(acc_buffer.data(), params.out_buffer, acc_buffer_size);
+  }
+  iree_uk_mmt4d_params_t matmul_params = params;
+  matmul_params.flags = params.flags & IREE_UK_FLAG_ACCUMULATE;
+  matmul_params.out_buffer = acc_buffer.data();
+  iree_mmt4d_reference_matmul(matmul_params);
+  switch (params.type) {
+    case iree_uk_mmt4d_type_i8i8i32:
+      if (params.flags & IREE_UK_FLAG_MMT4D_REQUANTIZE) {
+        iree_mmt4d_reference_epilogue<iree_uk_int32_t, iree_uk_int8_t>(
+            params, (const iree_uk_int32_t*)acc_buffer.data());
+      } else {
+        iree_mmt4d_reference_epilogue<iree_uk_int32_t, iree_uk_int32_t>(
+            params, (const iree_uk_int32_t*)acc_buffer.data());
+      }
+      break;
+    case iree_uk_mmt4d_type_f16f16f16:
+      iree_mmt4d_reference_epilogue<iree_mmt4d_f16_t, iree_mmt4d_f16_t>(
+          params, (const iree_mmt4d_f16_t*)acc_buffer.data());
+      break;
+    default:
+      iree_mmt4d_reference_epilogue<float, float>(
+          params, (const float*)acc_buffer.data());
+      break;
+  }
+}
+
+// Returns the type of the elements stored to out_buffer.
+static iree_uk_type_t iree_mmt4d_stored_out_type(
+    const iree_uk_mmt4d_params_t& params) {
+  return (params.flags & IREE_UK_FLAG_MMT4D_REQUANTIZE)
+             ? IREE_UK_TYPE_INT_8
+             : iree_uk_mmt4d_out_type(params.type);
+}
+
+// Compares output buffers. Exact, except for the GELU activation which the
+// ukernel approximates.
+static bool iree_mmt4d_outputs_match(const iree_uk_mmt4d_params_t& params,
+                                     const void* actual, const void* expected,
+                                     iree_uk_ssize_t size) {
+  if ((params.flags & IREE_UK_FLAG_MMT4D_ACTIVATION_MASK_INTERNAL) !=
+      IREE_UK_FLAG_MMT4D_ACTIVATION_GELU) {
+    return !memcmp(actual, expected, size);
+  }
+  bool is_f16 = params.type == iree_uk_mmt4d_type_f16f16f16;
+  iree_uk_ssize_t count = is_f16 ? size / 2 : size / 4;
+  // f16 results may additionally differ by one rounding step of f16.
+  float tolerance = is_f16 ? 2e-3f : 1e-5f;
+  for (iree_uk_ssize_t i = 0; i < count; ++i) {
+    float a = is_f16 ? iree_uk_f16_to_f32(((const iree_uk_uint16_t*)actual)[i])
+                     : ((const float*)actual)[i];
+    float e = is_f16
+                  ? iree_uk_f16_to_f32(((const iree_uk_uint16_t*)expected)[i])
+                  : ((const float*)expected)[i];
+    if (!(std::fabs(a - e) <= tolerance * (1.0f + std::fabs(e)))) return false;
+  }
+  return true;
+}
+
 static void test_one_matmul_using_given_lhs_rhs(
     const iree_uk_mmt4d_params_t& shared_params,
     iree_uk_test_random_engine_t* engine) {
@@ -109,7 +303,7 @@ static void test_one_matmul_using_given_lhs_rhs(
 
   iree_uk_mmt4d_params_t reference_params;
   memcpy(&reference_params, &shared_params, sizeof shared_params);
-  iree_uk_type_t out_type = iree_uk_mmt4d_out_type(shared_params.type);
+  iree_uk_type_t out_type = iree_mmt4d_stored_out_type(shared_params);
   iree_uk_ssize_t out_buffer_size = iree_uk_test_2d_buffer_length(
       out_type, shared_params.M, shared_params.out_stride);
   reference_params.out_buffer = malloc(out_buffer_size);
@@ -132,8 +326,9 @@ static void test_one_matmul_using_given_lhs_rhs(
   // become problematic when we do float16. See the comment at the top of this
   // file explaining how we refrain from letting this grow into a 1000-line-long
   // fully-featured test.
-  if (memcmp(actual_params.out_buffer, reference_params.out_buffer,
-             out_buffer_size)) {
+  if (!iree_mmt4d_outputs_match(actual_params, actual_params.out_buffer,
+                                reference_params.out_buffer,
+                                out_buffer_size)) {
     const auto& p = actual_params;
     fprintf(stderr, "mmt4d test failure with the following params:\n");
     char types_str[32];
@@ -141,6 +336,10 @@ static void test_one_matmul_using_given_lhs_rhs(
     fprintf(stderr, "  types: %s\n", types_str);
     fprintf(stderr, "  flags: accumulate=%d\n",
             (bool)(p.flags & IREE_UK_FLAG_ACCUMULATE));
+    fprintf(stderr, "  epilogue: bias=%d, activation=0x%x, requantize=%d\n",
+            (bool)(p.flags & IREE_UK_FLAG_MMT4D_BIAS),
+            p.flags & IREE_UK_FLAG_MMT4D_ACTIVATION_MASK_INTERNAL,
+            (bool)(p.flags & IREE_UK_FLAG_MMT4D_REQUANTIZE));
     fprintf(stderr, "  M=%d, N=%d, K=%d\n", (int)p.M, (int)p.N, (int)p.K);
     fprintf(stderr, "  M0=%d, N0=%d, K0=%d\n", (int)p.M0, (int)p.N0, (int)p.K0);
     fprintf(stderr, "  lhs_stride=%zu, rhs_stride=%zu, out_stride=%zu\n",
@@ -199,9 +398,20 @@ static void test_one_matmul_creating_lhs_rhs_for_given_shape(
                                    engine);
   params.lhs_buffer = lhs_buffer;
   params.rhs_buffer = rhs_buffer;
+  void* bias_buffer = nullptr;
+  if (params.flags & IREE_UK_FLAG_MMT4D_BIAS) {
+    iree_uk_type_t acc_type = iree_uk_mmt4d_out_type(params.type);
+    iree_uk_ssize_t bias_buffer_size =
+        iree_uk_test_2d_buffer_length(acc_type, 1, params.N * params.N0);
+    bias_buffer = malloc(bias_buffer_size);
+    iree_uk_test_write_random_buffer(bias_buffer, bias_buffer_size, acc_type,
+                                     engine);
+    params.bias_buffer = bias_buffer;
+  }
   test_one_matmul_using_given_lhs_rhs(params, engine);
   free(lhs_buffer);
   free(rhs_buffer);
+  free(bias_buffer);
 }
 
 static void test_matmuls_for_various_MNK_shapes_and_flags(
@@ -236,14 +446,39 @@ static void test_matmuls_for_various_MNK_shapes_and_flags(
       {1, 2, 1},
       {2, 2, 2},
       {5, 7, 13},
+      {9, 11, 3},
   };
+  // Epilogues to test, in addition to no epilogue.
+  bool is_int = params.type == iree_uk_mmt4d_type_i8i8i32;
+  std::vector<iree_uk_uint32_t> epilogues{
+      0,
+      IREE_UK_FLAG_MMT4D_BIAS,
+      IREE_UK_FLAG_MMT4D_ACTIVATION_RELU,
+      IREE_UK_FLAG_MMT4D_BIAS | IREE_UK_FLAG_MMT4D_ACTIVATION_RELU,
+  };
+  if (is_int) {
+    epilogues.push_back(IREE_UK_FLAG_MMT4D_REQUANTIZE);
+    epilogues.push_back(IREE_UK_FLAG_MMT4D_REQUANTIZE |
+                        IREE_UK_FLAG_MMT4D_BIAS |
+                        IREE_UK_FLAG_MMT4D_ACTIVATION_RELU);
+  } else {
+    epilogues.push_back(IREE_UK_FLAG_MMT4D_BIAS |
+                        IREE_UK_FLAG_MMT4D_ACTIVATION_GELU);
+  }
+  // A power of two keeps the scaled values exact, so that rounding ties are
+  // actually exercised.
+  params.requant_scale = 0.25f;
+  params.requant_zero_point = 3;
   for (shape_mnk_t shape : shapes) {
     params.M = shape.m;
     params.N = shape.n;
     params.K = shape.k;
-    for (bool accumulate : {false, true}) {
-      params.flags = accumulate ? IREE_UK_FLAG_ACCUMULATE : 0;
-      test_one_matmul_creating_lhs_rhs_for_given_shape(params, engine);
+    for (iree_uk_uint32_t epilogue : epilogues) {
+      for (bool accumulate : {false, true}) {
+        if (accumulate && (epilogue & IREE_UK_FLAG_MMT4D_REQUANTIZE)) continue;
+        params.flags = epilogue | (accumulate ? IREE_UK_FLAG_ACCUMULATE : 0);
+        test_one_matmul_creating_lhs_rhs_for_given_shape(params, engine);
+      }
     }
   }
 }
@@ -273,6 +508,14 @@ static void mmt4d_test(iree_uk_mmt4d_type_t type, int M0, int N0, int K0,
   // feature is supported by the CPU because we want to test the fallback to
   // architecture-default or generic code.
   test_matmuls_for_various_MNK_shapes_and_flags(params, engine);
+  // Again with tiny cache sizes, so that the loops over M and N get split into
+  // several cache blocks, including partial ones.
+  const iree_uk_uint64_t
+      local_cpu_data_small_caches[IREE_CPU_DATA_FIELD_COUNT] = {
+      0, (1ull << IREE_CPU_DATA_FIELD_1_L2_CACHE_KB_SHIFT) |
+             (2ull << IREE_CPU_DATA_FIELD_1_L3_CACHE_KB_SHIFT)};
+  params.cpu_data = local_cpu_data_small_caches;
+  test_matmuls_for_various_MNK_shapes_and_flags(params, engine);
   // If this is nonzero, we are asked to test again with this CPU feature.
   if (cpu_data_field_0_bit) {
     const iree_uk_uint64_t local_cpu_data_with_bit[IREE_CPU_DATA_FIELD_COUNT] =
@@ -305,6 +548,9 @@ static void mmt4d_test(iree_uk_mmt4d_type_t type, int M0, int N0, int K0,
 // power-of-two assumption
 MMT4D_TEST(f32f32f32, 3, 5, 7, generic, 0)
 MMT4D_TEST(i8i8i32, 9, 6, 3, generic, 0)
+MMT4D_TEST(f16f16f32, 3, 5, 2, generic, 0)
+MMT4D_TEST(f16f16f16, 4, 3, 5, generic, 0)
+MMT4D_TEST(bf16bf16f32, 5, 3, 4, generic, 0)
 
 // ARM_64 tests.
 #if defined(IREE_UK_ARCH_ARM_64)
@@ -320,8 +566,25 @@ MMT4D_ARM_64_TEST(f32f32f32, 8, 8, 1)
 MMT4D_ARM_64_TEST(i8i8i32, 8, 8, 1)
 MMT4D_ARM_64_TEST_WITH_CPU_FEATURE(i8i8i32, 8, 8, 4, DOTPROD)
 MMT4D_ARM_64_TEST_WITH_CPU_FEATURE(i8i8i32, 8, 8, 8, I8MM)
+MMT4D_ARM_64_TEST_WITH_CPU_FEATURE(f16f16f32, 8, 8, 1, FP16FML)
+MMT4D_ARM_64_TEST_WITH_CPU_FEATURE(bf16bf16f32, 8, 8, 4, BF16)
 #endif  // defined(IREE_UK_ARCH_ARM_64)
 
+// X86_64 tests.
+#if defined(IREE_UK_ARCH_X86_64)
+
+#define MMT4D_X86_64_TEST_WITH_CPU_FEATURE(type, M0, N0, K0, FEATURE) \
+  MMT4D_TEST(type, M0, N0, K0, x86_64_##FEATURE,                      \
+             IREE_CPU_DATA_FIELD_0_X86_64_HAVE_##FEATURE)
+
+MMT4D_X86_64_TEST_WITH_CPU_FEATURE(f32f32f32, 8, 8, 1, AVX2_FMA)
+MMT4D_X86_64_TEST_WITH_CPU_FEATURE(i8i8i32, 8, 8, 2, AVX2_FMA)
+MMT4D_X86_64_TEST_WITH_CPU_FEATURE(f32f32f32, 16, 16, 1, AVX512_BASE)
+MMT4D_X86_64_TEST_WITH_CPU_FEATURE(i8i8i32, 16, 16, 2, AVX512_BASE)
+MMT4D_X86_64_TEST_WITH_CPU_FEATURE(i8i8i32, 16, 16, 4, AVX512_VNNI)
+MMT4D_X86_64_TEST_WITH_CPU_FEATURE(bf16bf16f32, 16, 16, 2, AVX512_BF16)
+#endif  // defined(IREE_UK_ARCH_X86_64)
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   iree_cpu_initialize(iree_allocator_system());
@@ -217,6 +217,9 @@ static void iree_pack_benchmark_register(
                           IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_##_cpu_feature,   \
                           arm_64_##_cpu_feature)
 
+#define PACK_BENCHMARK_REGISTER_X86_64(_type, _size2, _size3) \
+  PACK_BENCHMARK_REGISTER(_type, _size2, _size3, 0, x86_64)
+
 int main(int argc, char** argv) {
   iree_flags_set_usage("pack_benchmark",
                        "Benchmarks the pack microkernel.\n"
@@ -250,6 +253,17 @@ int main(int argc, char** argv) {
 
 #endif  // defined(IREE_UK_ARCH_ARM_64)
 
+// X86_64 benchmarks.
+#if defined(IREE_UK_ARCH_X86_64)
+
+  PACK_BENCHMARK_REGISTER_X86_64(f32f32, 8, 1);
+  PACK_BENCHMARK_REGISTER_X86_64(f32f32, 16, 1);
+  PACK_BENCHMARK_REGISTER_X86_64(i8i8, 8, 2);
+  PACK_BENCHMARK_REGISTER_X86_64(i8i8, 16, 2);
+  PACK_BENCHMARK_REGISTER_X86_64(i8i8, 16, 4);
+
+#endif  // defined(IREE_UK_ARCH_X86_64)
+
   iree_benchmark_run_specified();
   return 0;
 }
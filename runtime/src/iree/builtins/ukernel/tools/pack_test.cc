@@ -255,6 +255,8 @@ PACK_TEST(f32f32, 3, 5, generic, 0)
 PACK_TEST(i8i8, 4, 2, generic, 0)
 PACK_TEST(i32i32, 3, 4, generic, 0)
 PACK_TEST(i8i8, 8, 8, generic, 0)
+PACK_TEST(f16f16, 5, 3, generic, 0)
+PACK_TEST(bf16bf16, 4, 6, generic, 0)
 
 // ARM_64 tests.
 #if defined(IREE_UK_ARCH_ARM_64)
@@ -276,6 +278,22 @@ PACK_ARM_64_TEST_WITH_CPU_FEATURE(i8i8, 8, 8, I8MM)
 
 #endif  // defined(IREE_UK_ARCH_ARM_64)
 
+// X86_64 tests.
+#if defined(IREE_UK_ARCH_X86_64)
+
+#define PACK_X86_64_TEST(type, tile_size0, tile_size1) \
+  PACK_TEST(type, tile_size0, tile_size1, x86_64, 0)
+
+PACK_X86_64_TEST(f32f32, 8, 1)
+PACK_X86_64_TEST(f32f32, 16, 1)
+PACK_X86_64_TEST(i32i32, 8, 8)
+PACK_X86_64_TEST(i32i32, 16, 16)
+PACK_X86_64_TEST(i8i8, 8, 2)
+PACK_X86_64_TEST(i8i8, 16, 2)
+PACK_X86_64_TEST(i8i8, 16, 4)
+
+#endif  // defined(IREE_UK_ARCH_X86_64)
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   iree_cpu_initialize(iree_allocator_system());
@@ -94,6 +94,21 @@ static void iree_uk_test_write_random_buffer(
   }
 }
 
+// 16-bit floating-point types are stored as raw bits. The same small integer
+// values are exactly representable in both f16 and bf16.
+static void iree_uk_test_write_random_16bit_float_buffer(
+    iree_uk_uint16_t* buffer, iree_uk_ssize_t size_in_bytes,
+    iree_uk_type_t type, iree_uk_test_random_engine_t* engine) {
+  iree_uk_ssize_t size_in_elems = size_in_bytes / sizeof(*buffer);
+  IREE_UK_ASSERT(size_in_elems * sizeof(*buffer) == size_in_bytes &&
+                 "bad size");
+  for (iree_uk_ssize_t i = 0; i < size_in_elems; ++i) {
+    float random_val = iree_uk_test_random_engine_get_minus16_plus15(engine);
+    buffer[i] = type == IREE_UK_TYPE_BFLOAT_16 ? iree_uk_f32_to_bf16(random_val)
+                                               : iree_uk_f32_to_f16(random_val);
+  }
+}
+
 void iree_uk_test_write_random_buffer(void* buffer,
                                       iree_uk_ssize_t size_in_bytes,
                                       iree_uk_type_t type,
@@ -111,6 +126,11 @@ void iree_uk_test_write_random_buffer(void* buffer,
       iree_uk_test_write_random_buffer(static_cast<iree_uk_int8_t*>(buffer),
                                        size_in_bytes, engine);
       return;
+    case IREE_UK_TYPE_FLOAT_16:
+    case IREE_UK_TYPE_BFLOAT_16:
+      iree_uk_test_write_random_16bit_float_buffer(
+          static_cast<iree_uk_uint16_t*>(buffer), size_in_bytes, type, engine);
+      return;
     default:
       IREE_UK_ASSERT(false && "unknown type");
   }
@@ -190,7 +210,27 @@ int iree_uk_test_cpu_features_str(char* buf, int buf_length,
   if (cpu_data[0] & IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_DOTPROD) {
     return snprintf(buf, buf_length, "dotprod");
   }
+  if (cpu_data[0] & IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_FP16FML) {
+    return snprintf(buf, buf_length, "fp16fml");
+  }
+  if (cpu_data[0] & IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_BF16) {
+    return snprintf(buf, buf_length, "bf16");
+  }
 #endif  // defined(IREE_UK_ARCH_ARM_64)
+#if defined(IREE_UK_ARCH_X86_64)
+  if (cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA) {
+    return snprintf(buf, buf_length, "avx2_fma");
+  }
+  if (cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE) {
+    return snprintf(buf, buf_length, "avx512_base");
+  }
+  if (cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_VNNI) {
+    return snprintf(buf, buf_length, "avx512_vnni");
+  }
+  if (cpu_data[0] & IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BF16) {
+    return snprintf(buf, buf_length, "avx512_bf16");
+  }
+#endif  // defined(IREE_UK_ARCH_X86_64)
   IREE_UK_ASSERT(false && "unknown CPU feature");
   return snprintf(buf, buf_length, "(unknown CPU feature)");
 }
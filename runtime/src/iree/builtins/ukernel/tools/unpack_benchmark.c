@@ -213,6 +213,9 @@ static void iree_unpack_benchmark_register(
                             IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_##_cpu_feature, \
                             arm_64_##_cpu_feature)
 
+#define UNPACK_BENCHMARK_REGISTER_X86_64(_type, _size2, _size3) \
+  UNPACK_BENCHMARK_REGISTER(_type, _size2, _size3, 0, x86_64)
+
 int main(int argc, char** argv) {
   iree_flags_set_usage("unpack_benchmark",
                        "Benchmarks the pack microkernel.\n"
@@ -246,6 +249,14 @@ int main(int argc, char** argv) {
 
 #endif  // defined(IREE_UK_ARCH_ARM_64)
 
+// X86_64 benchmarks.
+#if defined(IREE_UK_ARCH_X86_64)
+
+  UNPACK_BENCHMARK_REGISTER_X86_64(f32f32, 8, 8);
+  UNPACK_BENCHMARK_REGISTER_X86_64(f32f32, 16, 16);
+
+#endif  // defined(IREE_UK_ARCH_X86_64)
+
   iree_benchmark_run_specified();
   return 0;
 }
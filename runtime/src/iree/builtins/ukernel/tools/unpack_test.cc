@@ -246,6 +246,8 @@ static void unpack_test(iree_uk_unpack_type_t type, int tile_size0,
 UNPACK_TEST(f32f32, 3, 5, generic, 0)
 UNPACK_TEST(i8i8, 4, 2, generic, 0)
 UNPACK_TEST(i32i32, 3, 4, generic, 0)
+UNPACK_TEST(f16f16, 5, 3, generic, 0)
+UNPACK_TEST(bf16bf16, 4, 6, generic, 0)
 
 // ARM_64 tests.
 #if defined(IREE_UK_ARCH_ARM_64)
@@ -258,6 +260,17 @@ UNPACK_ARM_64_TEST(i32i32, 8, 8)
 
 #endif  // defined(IREE_UK_ARCH_ARM_64)
 
+// X86_64 tests.
+#if defined(IREE_UK_ARCH_X86_64)
+
+#define UNPACK_X86_64_TEST(type, tile_size0, tile_size1) \
+  UNPACK_TEST(type, tile_size0, tile_size1, x86_64, 0)
+
+UNPACK_X86_64_TEST(f32f32, 8, 8)
+UNPACK_X86_64_TEST(i32i32, 16, 16)
+
+#endif  // defined(IREE_UK_ARCH_X86_64)
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   iree_cpu_initialize(iree_allocator_system());
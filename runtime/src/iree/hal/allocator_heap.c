@@ -18,6 +18,10 @@ typedef struct iree_hal_heap_allocator_t {
   iree_allocator_t host_allocator;
   iree_allocator_t data_allocator;
   iree_string_view_t identifier;
+  // Recycled metadata headers of split and imported buffers.
+  iree_hal_heap_header_pool_t buffer_pool;
+  // Recycled buffer view headers of buffers allocated from this allocator.
+  iree_hal_heap_header_pool_t buffer_view_pool;
   IREE_STATISTICS(iree_hal_heap_allocator_statistics_t statistics;)
 } iree_hal_heap_allocator_t;
 
@@ -48,6 +52,12 @@ IREE_API_EXPORT iree_status_t iree_hal_allocator_create_heap(
     iree_string_view_append_to_buffer(
         identifier, &allocator->identifier,
         (char*)allocator + iree_sizeof_struct(*allocator));
+    iree_hal_heap_header_pool_initialize(host_allocator,
+                                         IREE_HAL_HEAP_BUFFER_HEADER_SIZE,
+                                         &allocator->buffer_pool);
+    iree_hal_heap_header_pool_initialize(host_allocator,
+                                         IREE_HAL_HEAP_BUFFER_VIEW_HEADER_SIZE,
+                                         &allocator->buffer_view_pool);
 
     IREE_STATISTICS({
       // All start initialized to zero.
@@ -68,6 +78,8 @@ static void iree_hal_heap_allocator_destroy(
   iree_allocator_t host_allocator = allocator->host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  iree_hal_heap_header_pool_deinitialize(&allocator->buffer_view_pool);
+  iree_hal_heap_header_pool_deinitialize(&allocator->buffer_pool);
   IREE_STATISTICS(iree_slim_mutex_deinitialize(&allocator->statistics.mutex));
 
   iree_allocator_free(host_allocator, allocator);
@@ -84,9 +96,31 @@ static iree_allocator_t iree_hal_heap_allocator_host_allocator(
 
 static iree_status_t iree_hal_heap_allocator_trim(
     iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_heap_allocator_t* allocator =
+      iree_hal_heap_allocator_cast(base_allocator);
+  iree_hal_heap_header_pool_trim(&allocator->buffer_pool);
+  iree_hal_heap_header_pool_trim(&allocator->buffer_view_pool);
   return iree_ok_status();
 }
 
+iree_hal_heap_header_pool_t* iree_hal_heap_allocator_buffer_pool(
+    iree_hal_allocator_t* base_allocator) {
+  if (!base_allocator ||
+      !iree_hal_resource_is(base_allocator, &iree_hal_heap_allocator_vtable)) {
+    return NULL;
+  }
+  return &iree_hal_heap_allocator_cast(base_allocator)->buffer_pool;
+}
+
+iree_hal_heap_header_pool_t* iree_hal_heap_allocator_buffer_view_pool(
+    iree_hal_allocator_t* base_allocator) {
+  if (!base_allocator ||
+      !iree_hal_resource_is(base_allocator, &iree_hal_heap_allocator_vtable)) {
+    return NULL;
+  }
+  return &iree_hal_heap_allocator_cast(base_allocator)->buffer_view_pool;
+}
+
 static void iree_hal_heap_allocator_query_statistics(
     iree_hal_allocator_t* IREE_RESTRICT base_allocator,
     iree_hal_allocator_statistics_t* IREE_RESTRICT out_statistics) {
@@ -207,7 +241,8 @@ static iree_status_t iree_hal_heap_allocator_allocate_buffer(
 static void iree_hal_heap_allocator_deallocate_buffer(
     iree_hal_allocator_t* IREE_RESTRICT base_allocator,
     iree_hal_buffer_t* IREE_RESTRICT base_buffer) {
-  // We don't do any pooling yet.
+  // Buffer metadata headers are returned to the allocator pools as the buffer
+  // is destroyed; the storage itself is not pooled.
   // TODO(benvanik): move stats tracking here.
   iree_hal_buffer_destroy(base_buffer);
 }
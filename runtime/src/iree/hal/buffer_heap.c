@@ -21,11 +21,13 @@ typedef enum iree_hal_heap_buffer_storage_mode_e {
   // The data storage is not freed.
   IREE_HAL_HEAP_BUFFER_STORAGE_MODE_SLAB = 0u,
   // Allocated as split [metadata] and [data].
-  // The base metadata pointer must be freed with iree_allocator_free.
+  // The base metadata pointer must be released to the header pool, if any, or
+  // freed with iree_allocator_free.
   // The data storage must be freed with iree_allocator_free_aligned.
   IREE_HAL_HEAP_BUFFER_STORAGE_MODE_SPLIT = 1u,
   // Allocated as split [metadata] and an externally-owned [data].
-  // The base metadata pointer must be freed with iree_allocator_free.
+  // The base metadata pointer must be released to the header pool, if any, or
+  // freed with iree_allocator_free.
   // A user-provided buffer release callback is notified that the buffer is no
   // longer referencing the data.
   IREE_HAL_HEAP_BUFFER_STORAGE_MODE_EXTERNAL = 2u,
@@ -46,19 +48,100 @@ typedef struct iree_hal_heap_buffer_t {
   // Optional statistics shared with the allocator.
   IREE_STATISTICS(iree_hal_heap_allocator_statistics_t* statistics;)
 } iree_hal_heap_buffer_t;
-static_assert(sizeof(iree_hal_heap_buffer_t) <= 128,
+static_assert(sizeof(iree_hal_heap_buffer_t) <=
+                  IREE_HAL_HEAP_BUFFER_HEADER_SIZE,
               "header should be <= the minimum buffer alignment so that we "
               "don't introduce internal waste");
 
 static const iree_hal_buffer_vtable_t iree_hal_heap_buffer_vtable;
 
+//===----------------------------------------------------------------------===//
+// iree_hal_heap_header_pool_t
+//===----------------------------------------------------------------------===//
+
+void iree_hal_heap_header_pool_initialize(
+    iree_allocator_t host_allocator, iree_host_size_t header_size,
+    iree_hal_heap_header_pool_t* out_pool) {
+  IREE_ASSERT_ARGUMENT(out_pool);
+  IREE_ASSERT_GE(header_size, sizeof(void*));
+  iree_slim_mutex_initialize(&out_pool->mutex);
+  out_pool->host_allocator = host_allocator;
+  out_pool->header_size = header_size;
+  out_pool->free_count = 0;
+  out_pool->free_list = NULL;
+}
+
+void iree_hal_heap_header_pool_deinitialize(iree_hal_heap_header_pool_t* pool) {
+  iree_hal_heap_header_pool_trim(pool);
+  iree_slim_mutex_deinitialize(&pool->mutex);
+}
+
+iree_status_t iree_hal_heap_header_pool_acquire(
+    iree_hal_heap_header_pool_t* pool, void** out_header) {
+  iree_slim_mutex_lock(&pool->mutex);
+  void* header = pool->free_list;
+  if (header) {
+    pool->free_list = *(void**)header;
+    --pool->free_count;
+  }
+  iree_slim_mutex_unlock(&pool->mutex);
+  if (header) {
+    *out_header = header;
+    return iree_ok_status();
+  }
+  return iree_allocator_malloc_uninitialized(pool->host_allocator,
+                                             pool->header_size, out_header);
+}
+
+void iree_hal_heap_header_pool_release(iree_hal_heap_header_pool_t* pool,
+                                       void* header) {
+  iree_slim_mutex_lock(&pool->mutex);
+  if (pool->free_count < IREE_HAL_HEAP_HEADER_POOL_CAPACITY) {
+    *(void**)header = pool->free_list;
+    pool->free_list = header;
+    ++pool->free_count;
+    header = NULL;
+  }
+  iree_slim_mutex_unlock(&pool->mutex);
+  if (header) iree_allocator_free(pool->host_allocator, header);
+}
+
+void iree_hal_heap_header_pool_trim(iree_hal_heap_header_pool_t* pool) {
+  iree_slim_mutex_lock(&pool->mutex);
+  void* free_list = pool->free_list;
+  pool->free_list = NULL;
+  pool->free_count = 0;
+  iree_slim_mutex_unlock(&pool->mutex);
+  while (free_list) {
+    void* next = *(void**)free_list;
+    iree_allocator_free(pool->host_allocator, free_list);
+    free_list = next;
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_heap_buffer_t
+//===----------------------------------------------------------------------===//
+
+// Allocates the split metadata header of a buffer from |header_pool| if
+// provided and otherwise |host_allocator|.
+static iree_status_t iree_hal_heap_buffer_allocate_header(
+    iree_hal_heap_header_pool_t* header_pool, iree_allocator_t host_allocator,
+    iree_hal_heap_buffer_t** out_buffer) {
+  if (header_pool) {
+    return iree_hal_heap_header_pool_acquire(header_pool, (void**)out_buffer);
+  }
+  return iree_allocator_malloc(host_allocator, sizeof(**out_buffer),
+                               (void**)out_buffer);
+}
+
 // Allocates a buffer with the metadata and storage split.
 // This results in an additional host allocation but allows for user-overridden
 // data storage allocations.
 static iree_status_t iree_hal_heap_buffer_allocate_split(
     iree_device_size_t allocation_size, iree_allocator_t data_allocator,
-    iree_allocator_t host_allocator, iree_hal_heap_buffer_t** out_buffer,
-    iree_byte_span_t* out_data) {
+    iree_allocator_t host_allocator, iree_hal_heap_header_pool_t* header_pool,
+    iree_hal_heap_buffer_t** out_buffer, iree_byte_span_t* out_data) {
   // Try allocating the storage first as it's the most likely to fail if OOM.
   // It must be aligned to the minimum buffer alignment.
   out_data->data_length = allocation_size;
@@ -71,8 +154,8 @@ static iree_status_t iree_hal_heap_buffer_allocate_split(
   out_data->data = data_ptr;
 
   // Allocate the host metadata wrapper with natural alignment.
-  iree_status_t status = iree_allocator_malloc(
-      host_allocator, sizeof(**out_buffer), (void**)out_buffer);
+  iree_status_t status = iree_hal_heap_buffer_allocate_header(
+      header_pool, host_allocator, out_buffer);
   if (!iree_status_is_ok(status)) {
     // Need to free the storage we just allocated.
     iree_allocator_free_aligned(data_allocator, out_data->data);
@@ -134,8 +217,10 @@ iree_status_t iree_hal_heap_buffer_create(
       same_allocator
           ? iree_hal_heap_buffer_allocate_slab(allocation_size, host_allocator,
                                                &buffer, &data)
-          : iree_hal_heap_buffer_allocate_split(allocation_size, data_allocator,
-                                                host_allocator, &buffer, &data);
+          : iree_hal_heap_buffer_allocate_split(
+                allocation_size, data_allocator, host_allocator,
+                iree_hal_heap_allocator_buffer_pool(allocator), &buffer,
+                &data);
 
   if (iree_status_is_ok(status)) {
     iree_hal_buffer_initialize(host_allocator, allocator, &buffer->base,
@@ -153,8 +238,8 @@ iree_status_t iree_hal_heap_buffer_create(
     }
 
     IREE_STATISTICS({
+      buffer->statistics = statistics;
       if (statistics != NULL) {
-        buffer->statistics = statistics;
         iree_slim_mutex_lock(&statistics->mutex);
         iree_hal_allocator_statistics_record_alloc(
             &statistics->base, params->type, allocation_size);
@@ -197,8 +282,8 @@ iree_status_t iree_hal_heap_buffer_wrap(
   iree_allocator_t host_allocator =
       iree_hal_allocator_host_allocator(allocator);
   iree_hal_heap_buffer_t* buffer = NULL;
-  iree_status_t status =
-      iree_allocator_malloc(host_allocator, sizeof(*buffer), (void**)&buffer);
+  iree_status_t status = iree_hal_heap_buffer_allocate_header(
+      iree_hal_heap_allocator_buffer_pool(allocator), host_allocator, &buffer);
   if (iree_status_is_ok(status)) {
     iree_hal_buffer_initialize(host_allocator, allocator, &buffer->base,
                                allocation_size, 0, data.data_length,
@@ -209,6 +294,7 @@ iree_status_t iree_hal_heap_buffer_wrap(
     // Notify the provided callback when the external data is no longer needed.
     buffer->base.flags = IREE_HAL_HEAP_BUFFER_STORAGE_MODE_EXTERNAL;
     buffer->release_callback = release_callback;
+    IREE_STATISTICS(buffer->statistics = NULL);
 
     *out_buffer = &buffer->base;
   }
@@ -217,6 +303,18 @@ iree_status_t iree_hal_heap_buffer_wrap(
   return status;
 }
 
+// Frees the split metadata header of |buffer| or returns it to the buffer pool
+// of its allocator it was acquired from.
+static void iree_hal_heap_buffer_free_header(iree_hal_heap_buffer_t* buffer) {
+  iree_hal_heap_header_pool_t* header_pool =
+      iree_hal_heap_allocator_buffer_pool(buffer->base.device_allocator);
+  if (header_pool) {
+    iree_hal_heap_header_pool_release(header_pool, buffer);
+  } else {
+    iree_allocator_free(buffer->base.host_allocator, buffer);
+  }
+}
+
 static void iree_hal_heap_buffer_destroy(iree_hal_buffer_t* base_buffer) {
   iree_hal_heap_buffer_t* buffer = (iree_hal_heap_buffer_t*)base_buffer;
   iree_allocator_t host_allocator = base_buffer->host_allocator;
@@ -239,7 +337,7 @@ static void iree_hal_heap_buffer_destroy(iree_hal_buffer_t* base_buffer) {
     }
     case IREE_HAL_HEAP_BUFFER_STORAGE_MODE_SPLIT: {
       iree_allocator_free(buffer->data_allocator, buffer->data.data);
-      iree_allocator_free(host_allocator, buffer);
+      iree_hal_heap_buffer_free_header(buffer);
       break;
     }
     case IREE_HAL_HEAP_BUFFER_STORAGE_MODE_EXTERNAL: {
@@ -247,7 +345,7 @@ static void iree_hal_heap_buffer_destroy(iree_hal_buffer_t* base_buffer) {
         buffer->release_callback.fn(buffer->release_callback.user_data,
                                     base_buffer);
       }
-      iree_allocator_free(host_allocator, buffer);
+      iree_hal_heap_buffer_free_header(buffer);
       break;
     }
     default:
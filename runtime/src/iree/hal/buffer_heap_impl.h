@@ -26,10 +26,74 @@ typedef struct iree_hal_heap_allocator_statistics_t {
   iree_hal_allocator_statistics_t base;
 } iree_hal_heap_allocator_statistics_t;
 
+// Maximum number of free headers retained by an iree_hal_heap_header_pool_t.
+// Host API paths that create and drop buffers and buffer views per invocation
+// rarely have more than a handful live at a time.
+#define IREE_HAL_HEAP_HEADER_POOL_CAPACITY 64
+
+// Size in bytes of each pooled heap buffer metadata header.
+#define IREE_HAL_HEAP_BUFFER_HEADER_SIZE 128
+
+// Size in bytes of each pooled buffer view header including its inline shape.
+// Buffer views with more dimensions than fit are allocated from the host
+// allocator as usual.
+#define IREE_HAL_HEAP_BUFFER_VIEW_HEADER_SIZE 128
+
+// Bounded freelist of fixed-size host allocations used for buffer and buffer
+// view metadata; owned by a heap allocator.
+// Headers acquired from the pool are uninitialized and must be released back to
+// the same pool. Free headers beyond the capacity are returned to the host
+// allocator.
+typedef struct iree_hal_heap_header_pool_t {
+  iree_slim_mutex_t mutex;
+  // Allocator used for header storage.
+  iree_allocator_t host_allocator;
+  // Size in bytes of each header; must be at least sizeof(void*).
+  iree_host_size_t header_size;
+  // Number of headers in |free_list|.
+  iree_host_size_t free_count IREE_GUARDED_BY(mutex);
+  // Singly-linked list of free headers threaded through their first pointer.
+  void* free_list IREE_GUARDED_BY(mutex);
+} iree_hal_heap_header_pool_t;
+
+// Initializes |out_pool| to allocate headers of |header_size| bytes from
+// |host_allocator|.
+void iree_hal_heap_header_pool_initialize(
+    iree_allocator_t host_allocator, iree_host_size_t header_size,
+    iree_hal_heap_header_pool_t* out_pool);
+
+// Deinitializes |pool| and frees all free headers. All headers acquired from
+// the pool must have been released.
+void iree_hal_heap_header_pool_deinitialize(iree_hal_heap_header_pool_t* pool);
+
+// Acquires an uninitialized header from |pool|, allocating a new one if the
+// pool is empty.
+iree_status_t iree_hal_heap_header_pool_acquire(
+    iree_hal_heap_header_pool_t* pool, void** out_header);
+
+// Releases |header| back to |pool| for reuse.
+void iree_hal_heap_header_pool_release(iree_hal_heap_header_pool_t* pool,
+                                       void* header);
+
+// Frees all headers currently in the free list of |pool|.
+void iree_hal_heap_header_pool_trim(iree_hal_heap_header_pool_t* pool);
+
+// Returns the pool used for split heap buffer metadata headers of buffers
+// allocated from |allocator| or NULL if |allocator| is not a heap allocator.
+iree_hal_heap_header_pool_t* iree_hal_heap_allocator_buffer_pool(
+    iree_hal_allocator_t* allocator);
+
+// Returns the pool used for buffer view headers of buffers allocated from
+// |allocator| or NULL if |allocator| is not a heap allocator.
+iree_hal_heap_header_pool_t* iree_hal_heap_allocator_buffer_view_pool(
+    iree_hal_allocator_t* allocator);
+
 // Allocates a new heap buffer from the specified |data_allocator|.
 // |host_allocator| is used for the iree_hal_buffer_t metadata. If both
 // |data_allocator| and |host_allocator| are the same the buffer will be created
-// as a flat slab. |out_buffer| must be released by the caller.
+// as a flat slab. Otherwise the metadata is acquired from the buffer pool of
+// |allocator|, if it has one, and returned to it when the buffer is destroyed.
+// |out_buffer| must be released by the caller.
 iree_status_t iree_hal_heap_buffer_create(
     iree_hal_allocator_t* allocator,
     iree_hal_heap_allocator_statistics_t* statistics,
@@ -39,6 +103,8 @@ iree_status_t iree_hal_heap_buffer_create(
 
 // Wraps an existing host allocation in a buffer.
 // When the buffer is destroyed the provided |release_callback| will be called.
+// The buffer metadata is acquired from the buffer pool of |allocator| if it has
+// one.
 //
 // The buffer must be aligned to at least IREE_HAL_HEAP_BUFFER_ALIGNMENT and if
 // it is not the call will fail with IREE_STATUS_OUT_OF_RANGE.
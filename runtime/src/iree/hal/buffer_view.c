@@ -9,12 +9,16 @@
 #include "iree/base/api.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/allocator.h"
+#include "iree/hal/buffer_heap_impl.h"
 #include "iree/hal/buffer_view_util.h"
 #include "iree/hal/resource.h"
 
 struct iree_hal_buffer_view_t {
   iree_atomic_ref_count_t ref_count;
   iree_allocator_t host_allocator;
+  // Pool the buffer view was acquired from or NULL if allocated from
+  // |host_allocator|.
+  iree_hal_heap_header_pool_t* header_pool;
   iree_hal_buffer_t* buffer;
   iree_hal_element_type_t element_type;
   iree_hal_encoding_type_t encoding_type;
@@ -23,6 +27,39 @@ struct iree_hal_buffer_view_t {
   iree_hal_dim_t shape[];
 };
 
+// Maximum shape rank of buffer views that can be acquired from a pool.
+#define IREE_HAL_BUFFER_VIEW_POOLED_MAX_RANK                 \
+  ((IREE_HAL_HEAP_BUFFER_VIEW_HEADER_SIZE -                  \
+    sizeof(iree_hal_buffer_view_t)) /                        \
+   sizeof(iree_hal_dim_t))
+static_assert(IREE_HAL_BUFFER_VIEW_POOLED_MAX_RANK >= 4,
+              "pooled buffer view headers should fit common shape ranks");
+
+// Allocates storage for a buffer view with |shape_rank| dimensions.
+// Buffer views of buffers from heap allocators are acquired from the
+// allocator's pool so that host API paths creating a view per invocation
+// don't round-trip through the system allocator.
+static iree_status_t iree_hal_buffer_view_allocate(
+    iree_hal_buffer_t* buffer, iree_host_size_t shape_rank,
+    iree_allocator_t host_allocator, iree_hal_buffer_view_t** out_buffer_view) {
+  iree_hal_heap_header_pool_t* header_pool = NULL;
+  if (shape_rank <= IREE_HAL_BUFFER_VIEW_POOLED_MAX_RANK) {
+    header_pool =
+        iree_hal_heap_allocator_buffer_view_pool(buffer->device_allocator);
+  }
+  if (header_pool) {
+    IREE_RETURN_IF_ERROR(iree_hal_heap_header_pool_acquire(
+        header_pool, (void**)out_buffer_view));
+  } else {
+    IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+        host_allocator,
+        sizeof(**out_buffer_view) + sizeof(iree_hal_dim_t) * shape_rank,
+        (void**)out_buffer_view));
+  }
+  (*out_buffer_view)->header_pool = header_pool;
+  return iree_ok_status();
+}
+
 IREE_API_EXPORT iree_status_t iree_hal_buffer_view_create(
     iree_hal_buffer_t* buffer, iree_host_size_t shape_rank,
     const iree_hal_dim_t* shape, iree_hal_element_type_t element_type,
@@ -42,10 +79,8 @@ IREE_API_EXPORT iree_status_t iree_hal_buffer_view_create(
   // Allocate and initialize the iree_hal_buffer_view_t struct.
   // Note that we have the dynamically-sized shape dimensions on the end.
   iree_hal_buffer_view_t* buffer_view = NULL;
-  iree_status_t status = iree_allocator_malloc(
-      host_allocator,
-      sizeof(*buffer_view) + sizeof(iree_hal_dim_t) * shape_rank,
-      (void**)&buffer_view);
+  iree_status_t status = iree_hal_buffer_view_allocate(
+      buffer, shape_rank, host_allocator, &buffer_view);
   if (iree_status_is_ok(status)) {
     iree_atomic_ref_count_init(&buffer_view->ref_count);
     buffer_view->host_allocator = host_allocator;
@@ -96,9 +131,14 @@ IREE_API_EXPORT void iree_hal_buffer_view_release(
 IREE_API_EXPORT void iree_hal_buffer_view_destroy(
     iree_hal_buffer_view_t* buffer_view) {
   iree_allocator_t host_allocator = buffer_view->host_allocator;
+  iree_hal_heap_header_pool_t* header_pool = buffer_view->header_pool;
   IREE_TRACE_ZONE_BEGIN(z0);
   iree_hal_buffer_release(buffer_view->buffer);
-  iree_allocator_free(host_allocator, buffer_view);
+  if (header_pool) {
+    iree_hal_heap_header_pool_release(header_pool, buffer_view);
+  } else {
+    iree_allocator_free(host_allocator, buffer_view);
+  }
   IREE_TRACE_ZONE_END(z0);
 }
 
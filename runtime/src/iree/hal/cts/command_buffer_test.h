@@ -7,6 +7,7 @@
 #ifndef IREE_HAL_CTS_COMMAND_BUFFER_TEST_H_
 #define IREE_HAL_CTS_COMMAND_BUFFER_TEST_H_
 
+#include <algorithm>
 #include <cstdint>
 #include <vector>
 
@@ -124,6 +125,126 @@ TEST_P(command_buffer_test, SubmitEmpty) {
   iree_hal_command_buffer_release(command_buffer);
 }
 
+// Tests that a reusable command buffer produces the same results each time it
+// is submitted.
+TEST_P(command_buffer_test, SubmitReusableMultipleTimes) {
+  const iree_device_size_t buffer_size = 16;
+  iree_hal_buffer_t* device_buffer = NULL;
+  CreateZeroedDeviceBuffer(buffer_size, &device_buffer);
+
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_command_buffer_create(
+      device_, /*mode=*/0, IREE_HAL_COMMAND_CATEGORY_ANY,
+      IREE_HAL_QUEUE_AFFINITY_ANY, /*binding_capacity=*/0, &command_buffer));
+  IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer));
+
+  // Fill the whole buffer and then overwrite the front half after a barrier
+  // so that the recorded commands have a dependency between them.
+  const uint8_t back_pattern = 0x07;
+  IREE_ASSERT_OK(iree_hal_command_buffer_fill_buffer(
+      command_buffer, device_buffer, /*target_offset=*/0, buffer_size,
+      &back_pattern, sizeof(back_pattern)));
+  IREE_ASSERT_OK(iree_hal_command_buffer_execution_barrier(
+      command_buffer,
+      /*source_stage_mask=*/IREE_HAL_EXECUTION_STAGE_TRANSFER |
+          IREE_HAL_EXECUTION_STAGE_COMMAND_RETIRE,
+      /*target_stage_mask=*/IREE_HAL_EXECUTION_STAGE_COMMAND_ISSUE |
+          IREE_HAL_EXECUTION_STAGE_TRANSFER,
+      IREE_HAL_EXECUTION_BARRIER_FLAG_NONE, /*memory_barrier_count=*/0,
+      /*memory_barriers=*/NULL,
+      /*buffer_barrier_count=*/0, /*buffer_barriers=*/NULL));
+  const uint8_t front_pattern = 0x09;
+  IREE_ASSERT_OK(iree_hal_command_buffer_fill_buffer(
+      command_buffer, device_buffer, /*target_offset=*/0, buffer_size / 2,
+      &front_pattern, sizeof(front_pattern)));
+  IREE_ASSERT_OK(iree_hal_command_buffer_end(command_buffer));
+
+  std::vector<uint8_t> reference_buffer(buffer_size, back_pattern);
+  std::fill_n(reference_buffer.begin(), buffer_size / 2, front_pattern);
+  for (int i = 0; i < 3; ++i) {
+    IREE_ASSERT_OK(
+        iree_hal_buffer_map_zero(device_buffer, 0, IREE_WHOLE_BUFFER));
+    IREE_ASSERT_OK(SubmitCommandBufferAndWait(command_buffer));
+    std::vector<uint8_t> actual_data(buffer_size);
+    IREE_ASSERT_OK(iree_hal_device_transfer_d2h(
+        device_, device_buffer, /*source_offset=*/0,
+        /*target_buffer=*/actual_data.data(),
+        /*data_length=*/buffer_size, IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT,
+        iree_infinite_timeout()));
+    EXPECT_THAT(actual_data, ContainerEq(reference_buffer)) << "run " << i;
+  }
+
+  iree_hal_command_buffer_release(command_buffer);
+  iree_hal_buffer_release(device_buffer);
+}
+
+// Tests that a reusable command buffer may be submitted again before a prior
+// submission of it has completed.
+TEST_P(command_buffer_test, SubmitReusableOverlapping) {
+  const iree_device_size_t buffer_size = 16;
+  iree_hal_buffer_t* device_buffer = NULL;
+  CreateZeroedDeviceBuffer(buffer_size, &device_buffer);
+
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_command_buffer_create(
+      device_, /*mode=*/0, IREE_HAL_COMMAND_CATEGORY_ANY,
+      IREE_HAL_QUEUE_AFFINITY_ANY, /*binding_capacity=*/0, &command_buffer));
+  IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer));
+  const uint8_t back_pattern = 0x07;
+  IREE_ASSERT_OK(iree_hal_command_buffer_fill_buffer(
+      command_buffer, device_buffer, /*target_offset=*/0, buffer_size,
+      &back_pattern, sizeof(back_pattern)));
+  IREE_ASSERT_OK(iree_hal_command_buffer_execution_barrier(
+      command_buffer,
+      /*source_stage_mask=*/IREE_HAL_EXECUTION_STAGE_TRANSFER |
+          IREE_HAL_EXECUTION_STAGE_COMMAND_RETIRE,
+      /*target_stage_mask=*/IREE_HAL_EXECUTION_STAGE_COMMAND_ISSUE |
+          IREE_HAL_EXECUTION_STAGE_TRANSFER,
+      IREE_HAL_EXECUTION_BARRIER_FLAG_NONE, /*memory_barrier_count=*/0,
+      /*memory_barriers=*/NULL,
+      /*buffer_barrier_count=*/0, /*buffer_barriers=*/NULL));
+  const uint8_t front_pattern = 0x09;
+  IREE_ASSERT_OK(iree_hal_command_buffer_fill_buffer(
+      command_buffer, device_buffer, /*target_offset=*/0, buffer_size / 2,
+      &front_pattern, sizeof(front_pattern)));
+  IREE_ASSERT_OK(iree_hal_command_buffer_end(command_buffer));
+
+  // Submit twice with no dependency between the submissions and only wait for
+  // both after they have been issued.
+  iree_hal_semaphore_t* signal_semaphores[2] = {NULL, NULL};
+  for (int i = 0; i < 2; ++i) {
+    IREE_ASSERT_OK(
+        iree_hal_semaphore_create(device_, 0ull, &signal_semaphores[i]));
+    uint64_t target_payload_value = 1ull;
+    iree_hal_semaphore_list_t signal_semaphore_list = {
+        /*count=*/1,
+        /*semaphores=*/&signal_semaphores[i],
+        /*payload_values=*/&target_payload_value,
+    };
+    IREE_ASSERT_OK(iree_hal_device_queue_execute(
+        device_, IREE_HAL_QUEUE_AFFINITY_ANY, iree_hal_semaphore_list_empty(),
+        signal_semaphore_list, 1, &command_buffer));
+  }
+  for (int i = 0; i < 2; ++i) {
+    IREE_ASSERT_OK(iree_hal_semaphore_wait(signal_semaphores[i], 1ull,
+                                           iree_infinite_timeout()));
+    iree_hal_semaphore_release(signal_semaphores[i]);
+  }
+
+  std::vector<uint8_t> reference_buffer(buffer_size, back_pattern);
+  std::fill_n(reference_buffer.begin(), buffer_size / 2, front_pattern);
+  std::vector<uint8_t> actual_data(buffer_size);
+  IREE_ASSERT_OK(iree_hal_device_transfer_d2h(
+      device_, device_buffer, /*source_offset=*/0,
+      /*target_buffer=*/actual_data.data(),
+      /*data_length=*/buffer_size, IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT,
+      iree_infinite_timeout()));
+  EXPECT_THAT(actual_data, ContainerEq(reference_buffer));
+
+  iree_hal_command_buffer_release(command_buffer);
+  iree_hal_buffer_release(device_buffer);
+}
+
 TEST_P(command_buffer_test, CopyWholeBuffer) {
   iree_hal_command_buffer_t* command_buffer = NULL;
   IREE_ASSERT_OK(iree_hal_command_buffer_create(
@@ -0,0 +1,419 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/cts/cts_benchmarks.h"
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "iree/hal/api.h"
+#include "iree/testing/benchmark.h"
+
+typedef struct iree_hal_cts_benchmark_case_t {
+  // Driver whose default device is benchmarked.
+  const char* driver_name;
+  // Bytes of the buffers the benchmark operates on.
+  iree_device_size_t buffer_size;
+} iree_hal_cts_benchmark_case_t;
+
+// Creates the default device of the driver of |benchmark_case| in |out_device|.
+// Leaves |out_device| NULL and skips the benchmark if the driver or its device
+// is unavailable in this environment.
+static iree_status_t iree_hal_cts_benchmark_create_device(
+    const iree_hal_cts_benchmark_case_t* benchmark_case,
+    iree_benchmark_state_t* benchmark_state, iree_hal_device_t** out_device) {
+  *out_device = NULL;
+  iree_hal_driver_t* driver = NULL;
+  iree_status_t status = iree_hal_driver_registry_try_create(
+      iree_hal_driver_registry_default(),
+      iree_make_cstring_view(benchmark_case->driver_name),
+      benchmark_state->host_allocator, &driver);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_driver_create_default_device(
+        driver, benchmark_state->host_allocator, out_device);
+  }
+  iree_hal_driver_release(driver);
+  if (iree_status_is_unavailable(status)) {
+    iree_status_ignore(status);
+    iree_benchmark_skip(benchmark_state, "driver or device unavailable");
+    return iree_ok_status();
+  }
+  return status;
+}
+
+// Allocates a buffer of the benchmark case size from |device| in |out_buffer|.
+static iree_status_t iree_hal_cts_benchmark_allocate_buffer(
+    const iree_hal_cts_benchmark_case_t* benchmark_case,
+    iree_hal_device_t* device, iree_hal_memory_type_t memory_type,
+    iree_hal_buffer_usage_t usage, iree_hal_buffer_t** out_buffer) {
+  iree_hal_buffer_params_t params = {0};
+  params.type = memory_type;
+  params.usage = usage;
+  return iree_hal_allocator_allocate_buffer(
+      iree_hal_device_allocator(device), params, benchmark_case->buffer_size,
+      iree_const_byte_span_empty(), out_buffer);
+}
+
+// Submits |command_buffer| (if any) and blocks until |semaphore| reaches
+// |value| signaled by the submission.
+static iree_status_t iree_hal_cts_benchmark_submit_and_wait(
+    iree_hal_device_t* device, iree_hal_command_buffer_t* command_buffer,
+    iree_hal_semaphore_t* semaphore, uint64_t value) {
+  iree_hal_semaphore_list_t signal_semaphores = {
+      /*count=*/1,
+      /*semaphores=*/&semaphore,
+      /*payload_values=*/&value,
+  };
+  IREE_RETURN_IF_ERROR(iree_hal_device_queue_execute(
+      device, IREE_HAL_QUEUE_AFFINITY_ANY, iree_hal_semaphore_list_empty(),
+      signal_semaphores, command_buffer ? 1 : 0,
+      command_buffer ? &command_buffer : NULL));
+  return iree_hal_semaphore_wait(semaphore, value, iree_infinite_timeout());
+}
+
+//===----------------------------------------------------------------------===//
+// Buffers
+//===----------------------------------------------------------------------===//
+
+static iree_status_t iree_hal_cts_benchmark_buffer_allocate(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  const iree_hal_cts_benchmark_case_t* benchmark_case =
+      (const iree_hal_cts_benchmark_case_t*)benchmark_def->user_data;
+  iree_hal_device_t* device = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_cts_benchmark_create_device(
+      benchmark_case, benchmark_state, &device));
+  if (!device) return iree_ok_status();
+
+  iree_status_t status = iree_ok_status();
+  while (iree_status_is_ok(status) &&
+         iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    iree_hal_buffer_t* buffer = NULL;
+    status = iree_hal_cts_benchmark_allocate_buffer(
+        benchmark_case, device, IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
+        IREE_HAL_BUFFER_USAGE_DEFAULT, &buffer);
+    iree_hal_buffer_release(buffer);
+  }
+
+  iree_hal_device_release(device);
+  return status;
+}
+
+static iree_status_t iree_hal_cts_benchmark_buffer_map(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  const iree_hal_cts_benchmark_case_t* benchmark_case =
+      (const iree_hal_cts_benchmark_case_t*)benchmark_def->user_data;
+  iree_hal_device_t* device = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_cts_benchmark_create_device(
+      benchmark_case, benchmark_state, &device));
+  if (!device) return iree_ok_status();
+
+  iree_hal_buffer_t* buffer = NULL;
+  iree_status_t status = iree_hal_cts_benchmark_allocate_buffer(
+      benchmark_case, device,
+      IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE,
+      IREE_HAL_BUFFER_USAGE_TRANSFER | IREE_HAL_BUFFER_USAGE_MAPPING, &buffer);
+  while (iree_status_is_ok(status) &&
+         iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    iree_hal_buffer_mapping_t mapping;
+    status = iree_hal_buffer_map_range(
+        buffer, IREE_HAL_MAPPING_MODE_SCOPED, IREE_HAL_MEMORY_ACCESS_WRITE, 0,
+        benchmark_case->buffer_size, &mapping);
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_buffer_unmap_range(&mapping);
+    }
+  }
+
+  iree_hal_buffer_release(buffer);
+  iree_hal_device_release(device);
+  return status;
+}
+
+//===----------------------------------------------------------------------===//
+// Transfers
+//===----------------------------------------------------------------------===//
+
+// Copies the benchmark case size between the host and a device buffer in the
+// direction given by |to_device|. Reports the transfer bandwidth.
+static iree_status_t iree_hal_cts_benchmark_transfer(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state, bool to_device) {
+  const iree_hal_cts_benchmark_case_t* benchmark_case =
+      (const iree_hal_cts_benchmark_case_t*)benchmark_def->user_data;
+  iree_hal_device_t* device = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_cts_benchmark_create_device(
+      benchmark_case, benchmark_state, &device));
+  if (!device) return iree_ok_status();
+
+  const iree_host_size_t length = (iree_host_size_t)benchmark_case->buffer_size;
+  void* host_data = NULL;
+  iree_hal_buffer_t* buffer = NULL;
+  iree_status_t status = iree_allocator_malloc(benchmark_state->host_allocator,
+                                               length, &host_data);
+  if (iree_status_is_ok(status)) {
+    memset(host_data, 0xCD, length);
+    status = iree_hal_cts_benchmark_allocate_buffer(
+        benchmark_case, device, IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
+        IREE_HAL_BUFFER_USAGE_DEFAULT, &buffer);
+  }
+
+  int64_t transfer_count = 0;
+  while (iree_status_is_ok(status) &&
+         iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    if (to_device) {
+      status = iree_hal_device_transfer_h2d(
+          device, host_data, buffer, 0, benchmark_case->buffer_size,
+          IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout());
+    } else {
+      status = iree_hal_device_transfer_d2h(
+          device, buffer, 0, host_data, benchmark_case->buffer_size,
+          IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout());
+    }
+    ++transfer_count;
+  }
+  iree_benchmark_set_bytes_processed(benchmark_state,
+                                     transfer_count * (int64_t)length);
+
+  iree_hal_buffer_release(buffer);
+  iree_allocator_free(benchmark_state->host_allocator, host_data);
+  iree_hal_device_release(device);
+  return status;
+}
+
+static iree_status_t iree_hal_cts_benchmark_transfer_h2d(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  return iree_hal_cts_benchmark_transfer(benchmark_def, benchmark_state,
+                                         /*to_device=*/true);
+}
+
+static iree_status_t iree_hal_cts_benchmark_transfer_d2h(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  return iree_hal_cts_benchmark_transfer(benchmark_def, benchmark_state,
+                                         /*to_device=*/false);
+}
+
+//===----------------------------------------------------------------------===//
+// Command buffers and submission
+//===----------------------------------------------------------------------===//
+
+// Records a one-shot command buffer filling |buffer| (if any) in
+// |out_command_buffer|. Without a buffer only a barrier is recorded.
+static iree_status_t iree_hal_cts_benchmark_record(
+    iree_hal_device_t* device, iree_hal_buffer_t* buffer,
+    iree_hal_command_buffer_t** out_command_buffer) {
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_command_buffer_create(
+      device, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+      IREE_HAL_COMMAND_CATEGORY_ANY, IREE_HAL_QUEUE_AFFINITY_ANY,
+      /*binding_capacity=*/0, &command_buffer));
+  iree_status_t status = iree_hal_command_buffer_begin(command_buffer);
+  if (iree_status_is_ok(status) && buffer) {
+    const uint32_t pattern = 0xCDCDCDCDu;
+    status = iree_hal_command_buffer_fill_buffer(
+        command_buffer, buffer, 0, iree_hal_buffer_byte_length(buffer),
+        &pattern, sizeof(pattern));
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_command_buffer_execution_barrier(
+        command_buffer, IREE_HAL_EXECUTION_STAGE_COMMAND_RETIRE,
+        IREE_HAL_EXECUTION_STAGE_COMMAND_ISSUE,
+        IREE_HAL_EXECUTION_BARRIER_FLAG_NONE, 0, NULL, 0, NULL);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_command_buffer_end(command_buffer);
+  }
+  if (iree_status_is_ok(status)) {
+    *out_command_buffer = command_buffer;
+  } else {
+    iree_hal_command_buffer_release(command_buffer);
+  }
+  return status;
+}
+
+static iree_status_t iree_hal_cts_benchmark_command_buffer_record(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  const iree_hal_cts_benchmark_case_t* benchmark_case =
+      (const iree_hal_cts_benchmark_case_t*)benchmark_def->user_data;
+  iree_hal_device_t* device = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_cts_benchmark_create_device(
+      benchmark_case, benchmark_state, &device));
+  if (!device) return iree_ok_status();
+
+  iree_hal_buffer_t* buffer = NULL;
+  iree_status_t status = iree_hal_cts_benchmark_allocate_buffer(
+      benchmark_case, device, IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
+      IREE_HAL_BUFFER_USAGE_DEFAULT, &buffer);
+  while (iree_status_is_ok(status) &&
+         iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    iree_hal_command_buffer_t* command_buffer = NULL;
+    status = iree_hal_cts_benchmark_record(device, buffer, &command_buffer);
+    iree_hal_command_buffer_release(command_buffer);
+  }
+
+  iree_hal_buffer_release(buffer);
+  iree_hal_device_release(device);
+  return status;
+}
+
+// Records, submits and waits for an empty command buffer: the fixed latency
+// the driver adds to every dispatch before any device work.
+static iree_status_t iree_hal_cts_benchmark_submit_empty(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  const iree_hal_cts_benchmark_case_t* benchmark_case =
+      (const iree_hal_cts_benchmark_case_t*)benchmark_def->user_data;
+  iree_hal_device_t* device = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_cts_benchmark_create_device(
+      benchmark_case, benchmark_state, &device));
+  if (!device) return iree_ok_status();
+
+  iree_hal_semaphore_t* semaphore = NULL;
+  iree_status_t status = iree_hal_semaphore_create(device, 0ull, &semaphore);
+  uint64_t value = 0;
+  while (iree_status_is_ok(status) &&
+         iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    iree_hal_command_buffer_t* command_buffer = NULL;
+    status = iree_hal_cts_benchmark_record(device, /*buffer=*/NULL,
+                                           &command_buffer);
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_cts_benchmark_submit_and_wait(device, command_buffer,
+                                                      semaphore, ++value);
+    }
+    iree_hal_command_buffer_release(command_buffer);
+  }
+
+  iree_hal_semaphore_release(semaphore);
+  iree_hal_device_release(device);
+  return status;
+}
+
+//===----------------------------------------------------------------------===//
+// Semaphores
+//===----------------------------------------------------------------------===//
+
+// Signals a semaphore from the host and waits on the signaled value.
+static iree_status_t iree_hal_cts_benchmark_semaphore_signal_wait(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  const iree_hal_cts_benchmark_case_t* benchmark_case =
+      (const iree_hal_cts_benchmark_case_t*)benchmark_def->user_data;
+  iree_hal_device_t* device = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_cts_benchmark_create_device(
+      benchmark_case, benchmark_state, &device));
+  if (!device) return iree_ok_status();
+
+  iree_hal_semaphore_t* semaphore = NULL;
+  iree_status_t status = iree_hal_semaphore_create(device, 0ull, &semaphore);
+  uint64_t value = 0;
+  while (iree_status_is_ok(status) &&
+         iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    status = iree_hal_semaphore_signal(semaphore, ++value);
+    if (iree_status_is_ok(status)) {
+      status =
+          iree_hal_semaphore_wait(semaphore, value, iree_infinite_timeout());
+    }
+  }
+
+  iree_hal_semaphore_release(semaphore);
+  iree_hal_device_release(device);
+  return status;
+}
+
+// Signals a semaphore from the queue without any command buffer and waits on
+// it from the host: the round trip through the driver's queue.
+static iree_status_t iree_hal_cts_benchmark_queue_signal_wait(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  const iree_hal_cts_benchmark_case_t* benchmark_case =
+      (const iree_hal_cts_benchmark_case_t*)benchmark_def->user_data;
+  iree_hal_device_t* device = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_cts_benchmark_create_device(
+      benchmark_case, benchmark_state, &device));
+  if (!device) return iree_ok_status();
+
+  iree_hal_semaphore_t* semaphore = NULL;
+  iree_status_t status = iree_hal_semaphore_create(device, 0ull, &semaphore);
+  uint64_t value = 0;
+  while (iree_status_is_ok(status) &&
+         iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    status = iree_hal_cts_benchmark_submit_and_wait(
+        device, /*command_buffer=*/NULL, semaphore, ++value);
+  }
+
+  iree_hal_semaphore_release(semaphore);
+  iree_hal_device_release(device);
+  return status;
+}
+
+//===----------------------------------------------------------------------===//
+// Registration
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_hal_cts_benchmark_spec_t {
+  const char* name;
+  iree_status_t (*run)(const iree_benchmark_def_t* benchmark_def,
+                       iree_benchmark_state_t* benchmark_state);
+  // Buffer size of the benchmark or 0 if the name has no size suffix as the
+  // benchmark doesn't depend on it.
+  iree_device_size_t buffer_size;
+} iree_hal_cts_benchmark_spec_t;
+
+static const iree_hal_cts_benchmark_spec_t iree_hal_cts_benchmark_specs[] = {
+    {"buffer_allocate", iree_hal_cts_benchmark_buffer_allocate, 4 * 1024},
+    {"buffer_allocate", iree_hal_cts_benchmark_buffer_allocate, 1024 * 1024},
+    {"buffer_map", iree_hal_cts_benchmark_buffer_map, 4 * 1024},
+    {"transfer_h2d", iree_hal_cts_benchmark_transfer_h2d, 4 * 1024},
+    {"transfer_h2d", iree_hal_cts_benchmark_transfer_h2d, 1024 * 1024},
+    {"transfer_d2h", iree_hal_cts_benchmark_transfer_d2h, 4 * 1024},
+    {"transfer_d2h", iree_hal_cts_benchmark_transfer_d2h, 1024 * 1024},
+    {"command_buffer_record", iree_hal_cts_benchmark_command_buffer_record,
+     4 * 1024},
+    {"submit_empty", iree_hal_cts_benchmark_submit_empty, 0},
+    {"semaphore_signal_wait", iree_hal_cts_benchmark_semaphore_signal_wait, 0},
+    {"queue_signal_wait", iree_hal_cts_benchmark_queue_signal_wait, 0},
+};
+
+#define IREE_HAL_CTS_BENCHMARK_COUNT \
+  IREE_ARRAYSIZE(iree_hal_cts_benchmark_specs)
+
+// Registered definitions point at the cases for the lifetime of the process.
+static iree_hal_cts_benchmark_case_t
+    iree_hal_cts_benchmark_cases[IREE_HAL_CTS_BENCHMARK_COUNT];
+
+void iree_hal_cts_register_benchmarks(const char* driver_name) {
+  for (iree_host_size_t i = 0; i < IREE_HAL_CTS_BENCHMARK_COUNT; ++i) {
+    const iree_hal_cts_benchmark_spec_t* spec =
+        &iree_hal_cts_benchmark_specs[i];
+    iree_hal_cts_benchmark_case_t* benchmark_case =
+        &iree_hal_cts_benchmark_cases[i];
+    benchmark_case->driver_name = driver_name;
+    benchmark_case->buffer_size = spec->buffer_size;
+
+    char name[128];
+    if (spec->buffer_size) {
+      snprintf(name, sizeof(name), "%s_%s_%" PRIu64, driver_name, spec->name,
+               (uint64_t)spec->buffer_size);
+    } else {
+      snprintf(name, sizeof(name), "%s_%s", driver_name, spec->name);
+    }
+
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_MICROSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = spec->run,
+        .user_data = benchmark_case,
+    };
+    iree_benchmark_register(iree_make_cstring_view(name), &benchmark_def);
+  }
+}
@@ -0,0 +1,32 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_CTS_CTS_BENCHMARKS_H_
+#define IREE_HAL_CTS_CTS_BENCHMARKS_H_
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Registers microbenchmarks of the HAL operations whose overhead every driver
+// adds to a model invocation: buffer allocation, mapping, host<->device
+// transfers, command buffer recording, queue submission and semaphore round
+// trips. Each benchmark creates the default device of |driver_name|, which
+// must be registered with iree_hal_driver_registry_default(), and is skipped
+// if the driver or its device is unavailable.
+//
+// Benchmarks are named `<driver_name>_<operation>[_<bytes>]` so that reports of
+// different drivers can be compared side by side. |driver_name| must outlive
+// the benchmarks.
+void iree_hal_cts_register_benchmarks(const char* driver_name);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_CTS_CTS_BENCHMARKS_H_
@@ -11,6 +11,7 @@
 #include <stdint.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/flight_recorder.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -60,6 +61,28 @@ extern "C" {
     }                                                                    \
   }
 
+// Records the beginning of a blocking wait on |count| semaphores in the flight
+// recorder. Polls with an immediate timeout are not recorded.
+static inline void iree_hal_record_wait_begin(iree_host_size_t count,
+                                              iree_timeout_t timeout) {
+  if (IREE_UNLIKELY(iree_flight_recorder_is_enabled()) &&
+      !iree_timeout_is_immediate(timeout)) {
+    iree_flight_recorder_record_enabled(
+        IREE_FLIGHT_RECORDER_EVENT_WAIT_BEGIN, count,
+        (uint64_t)iree_timeout_as_deadline_ns(timeout));
+  }
+}
+
+// Records the end of a wait started with iree_hal_record_wait_begin.
+static inline void iree_hal_record_wait_end(iree_status_t status,
+                                            iree_timeout_t timeout) {
+  if (IREE_UNLIKELY(iree_flight_recorder_is_enabled()) &&
+      !iree_timeout_is_immediate(timeout)) {
+    iree_flight_recorder_record_enabled(IREE_FLIGHT_RECORDER_EVENT_WAIT_END,
+                                        iree_status_code(status), 0);
+  }
+}
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
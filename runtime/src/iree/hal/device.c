@@ -6,6 +6,7 @@
 
 #include "iree/hal/device.h"
 
+#include "iree/base/internal/flight_recorder.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/allocator.h"
 #include "iree/hal/buffer.h"
@@ -241,6 +242,8 @@ IREE_API_EXPORT iree_status_t iree_hal_device_queue_execute(
     }
   }
 
+  iree_flight_recorder_record(IREE_FLIGHT_RECORDER_EVENT_QUEUE_SUBMIT,
+                              command_buffer_count, queue_affinity);
   iree_status_t status = _VTABLE_DISPATCH(device, queue_execute)(
       device, queue_affinity, wait_semaphore_list, signal_semaphore_list,
       command_buffer_count, command_buffers);
@@ -278,8 +281,10 @@ IREE_API_EXPORT iree_status_t iree_hal_device_wait_semaphores(
   IREE_ASSERT_ARGUMENT(device);
   if (semaphore_list.count == 0) return iree_ok_status();
   IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_record_wait_begin(semaphore_list.count, timeout);
   iree_status_t status = _VTABLE_DISPATCH(device, wait_semaphores)(
       device, wait_mode, semaphore_list, timeout);
+  iree_hal_record_wait_end(status, timeout);
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
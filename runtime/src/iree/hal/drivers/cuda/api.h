@@ -29,14 +29,30 @@ typedef struct {
   char data[128];
 } iree_hal_cuda_nccl_id_t;
 
+// Maximum number of queues that may be exposed on a device, excluding the
+// dedicated transfer queue.
+#define IREE_HAL_CUDA_MAX_QUEUE_COUNT 8
+
 // Parameters configuring an iree_hal_cuda_device_t.
 // Must be initialized with iree_hal_cuda_device_params_initialize prior to use.
 typedef struct iree_hal_cuda_device_params_t {
   // Number of queues exposed on the device.
   // Each queue acts as a separate synchronization scope where all work executes
-  // concurrently unless prohibited by semaphores.
+  // concurrently unless prohibited by semaphores. Each queue is backed by its
+  // own CUDA stream and queue affinities hash into the available queues.
   iree_host_size_t queue_count;
 
+  // Routes command buffers that only perform transfers to an additional CUDA
+  // stream so that uploads and readbacks can overlap with dispatches. As with
+  // multiple queues the transfers are only ordered against other work by
+  // semaphores.
+  bool dedicated_transfer_queue;
+
+  // Issues collectives recorded into stream command buffers on an additional
+  // CUDA stream per queue so that they overlap with subsequent independent
+  // dispatches. The streams are joined with events at the next barrier.
+  bool dedicated_collective_stream;
+
   // Total size of each block in the device shared block pool.
   // Larger sizes will lower overhead and ensure the heap isn't hit for
   // transient allocations while also increasing memory consumption.
@@ -60,6 +76,33 @@ typedef struct iree_hal_cuda_device_params_t {
   // tracing with this enabled.
   bool stream_tracing;
 
+  // Enables queue-ordered allocations with cuMemAllocFromPoolAsync when the
+  // device supports memory pools. Device-local transient buffers allocated
+  // with iree_hal_device_queue_alloca are then allocated and freed on the
+  // stream timeline and their memory can be reused by later submissions
+  // without host synchronization.
+  bool async_allocations;
+
+  // Number of bytes of freed memory the device memory pool used for
+  // queue-ordered allocations may retain before releasing memory back to the
+  // system at synchronization points. Retained memory can be released by
+  // trimming the device.
+  uint64_t async_allocation_release_threshold;
+
+  // Size in bytes of each chunk of the page-locked host staging buffer used
+  // for transfers between pageable host memory and device-local memory.
+  iree_host_size_t staging_buffer_chunk_size;
+
+  // Number of chunks in the staging buffer. Copies of multiple chunks are kept
+  // in flight to overlap the host copies with DMA. 0 disables the staging
+  // buffer and all transfers use the generic path.
+  iree_host_size_t staging_buffer_chunk_count;
+
+  // Transfers of more than this many bytes between host memory and
+  // device-local memory go through the staging buffer. Smaller transfers are
+  // cheaper to execute as command buffer updates.
+  iree_device_size_t staging_transfer_threshold;
+
   // Opaque NCCL ID used during channel creation when empty IDs are provided.
   // Today this is used for all communicators created but in the future this may
   // just be used as a default when not otherwise specified on channel creation.
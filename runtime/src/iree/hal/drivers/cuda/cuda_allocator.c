@@ -26,6 +26,9 @@ typedef struct iree_hal_cuda_allocator_t {
   CUstream stream;
   bool supports_concurrent_managed_access;
 
+  // Memory pool used for queue-ordered allocations or NULL if unsupported.
+  CUmemoryPool async_pool;
+
   IREE_STATISTICS(iree_hal_allocator_statistics_t statistics;)
 } iree_hal_cuda_allocator_t;
 
@@ -37,11 +40,54 @@ static iree_hal_cuda_allocator_t* iree_hal_cuda_allocator_cast(
   return (iree_hal_cuda_allocator_t*)base_value;
 }
 
+// Creates a memory pool for queue-ordered allocations on |device| if supported.
+// |out_pool| will be NULL if memory pools are not supported.
+static iree_status_t iree_hal_cuda_allocator_create_async_pool(
+    iree_hal_cuda_context_wrapper_t* context, CUdevice device,
+    uint64_t release_threshold, CUmemoryPool* out_pool) {
+  *out_pool = NULL;
+
+  int supports_memory_pools = 0;
+  IREE_RETURN_IF_ERROR(CU_RESULT_TO_STATUS(
+      context->syms,
+      cuDeviceGetAttribute(&supports_memory_pools,
+                           CU_DEVICE_ATTRIBUTE_MEMORY_POOLS_SUPPORTED, device),
+      "cuDeviceGetAttribute"));
+  if (!supports_memory_pools) return iree_ok_status();
+
+  CUmemPoolProps pool_props;
+  memset(&pool_props, 0, sizeof(pool_props));
+  pool_props.allocType = CU_MEM_ALLOCATION_TYPE_PINNED;
+  pool_props.location.type = CU_MEM_LOCATION_TYPE_DEVICE;
+  pool_props.location.id = device;
+  CUmemoryPool pool = NULL;
+  IREE_RETURN_IF_ERROR(CU_RESULT_TO_STATUS(
+      context->syms, cuMemPoolCreate(&pool, &pool_props), "cuMemPoolCreate"));
+
+  // By default pools release all unused memory at each synchronization point;
+  // retaining it lets transients be reused across submissions.
+  cuuint64_t threshold = release_threshold;
+  iree_status_t status = CU_RESULT_TO_STATUS(
+      context->syms,
+      cuMemPoolSetAttribute(pool, CU_MEMPOOL_ATTR_RELEASE_THRESHOLD,
+                            &threshold),
+      "cuMemPoolSetAttribute");
+  if (iree_status_is_ok(status)) {
+    *out_pool = pool;
+  } else {
+    CUDA_IGNORE_ERROR(context->syms, cuMemPoolDestroy(pool));
+  }
+  return status;
+}
+
 iree_status_t iree_hal_cuda_allocator_create(
     iree_hal_device_t* base_device, iree_hal_cuda_context_wrapper_t* context,
-    CUdevice device, CUstream stream, iree_hal_allocator_t** out_allocator) {
+    CUdevice device, CUstream stream,
+    const iree_hal_cuda_device_params_t* params,
+    iree_hal_allocator_t** out_allocator) {
   IREE_ASSERT_ARGUMENT(base_device);
   IREE_ASSERT_ARGUMENT(context);
+  IREE_ASSERT_ARGUMENT(params);
   IREE_TRACE_ZONE_BEGIN(z0);
 
   // To support device-local + host-visible memory we need concurrent managed
@@ -65,6 +111,17 @@ iree_status_t iree_hal_cuda_allocator_create(
               : "no CONCURRENT_MANAGED_ACCESS (expect slow accesses on "
                 "device-local + host-visible memory)");
 
+  CUmemoryPool async_pool = NULL;
+  if (params->async_allocations) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_hal_cuda_allocator_create_async_pool(
+                context, device, params->async_allocation_release_threshold,
+                &async_pool));
+  }
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, async_pool
+                                      ? "has async memory pool"
+                                      : "no async memory pool");
+
   iree_hal_cuda_allocator_t* allocator = NULL;
   iree_status_t status = iree_allocator_malloc(
       context->host_allocator, sizeof(*allocator), (void**)&allocator);
@@ -77,7 +134,10 @@ iree_status_t iree_hal_cuda_allocator_create(
     allocator->stream = stream;
     allocator->supports_concurrent_managed_access =
         supports_concurrent_managed_access != 0;
+    allocator->async_pool = async_pool;
     *out_allocator = (iree_hal_allocator_t*)allocator;
+  } else if (async_pool) {
+    CUDA_IGNORE_ERROR(context->syms, cuMemPoolDestroy(async_pool));
   }
 
   IREE_TRACE_ZONE_END(z0);
@@ -91,6 +151,13 @@ static void iree_hal_cuda_allocator_destroy(
   iree_allocator_t host_allocator = allocator->context->host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  // Any outstanding queue-ordered allocations keep the pool memory alive until
+  // they are freed.
+  if (allocator->async_pool) {
+    CUDA_IGNORE_ERROR(allocator->context->syms,
+                      cuMemPoolDestroy(allocator->async_pool));
+  }
+
   iree_allocator_free(host_allocator, allocator);
 
   IREE_TRACE_ZONE_END(z0);
@@ -105,6 +172,14 @@ static iree_allocator_t iree_hal_cuda_allocator_host_allocator(
 
 static iree_status_t iree_hal_cuda_allocator_trim(
     iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_cuda_allocator_t* allocator =
+      iree_hal_cuda_allocator_cast(base_allocator);
+  if (allocator->async_pool) {
+    // Releases all memory not backing live allocations.
+    CUDA_RETURN_IF_ERROR(allocator->context->syms,
+                         cuMemPoolTrimTo(allocator->async_pool, 0),
+                         "cuMemPoolTrimTo");
+  }
   return iree_ok_status();
 }
 
@@ -274,6 +349,10 @@ static void iree_hal_cuda_buffer_free(iree_hal_cuda_context_wrapper_t* context,
       CUDA_IGNORE_ERROR(context->syms, cuMemHostUnregister(host_ptr));
       break;
     }
+    case IREE_HAL_CUDA_BUFFER_TYPE_ASYNC: {
+      // Freed in stream order by iree_hal_cuda_allocator_free_async.
+      break;
+    }
   }
   IREE_TRACE_ZONE_END(z0);
 }
@@ -426,6 +505,15 @@ static void iree_hal_cuda_allocator_deallocate_buffer(
   // to silently ignore them: whatever the user tries to do next will fail in
   // the same way and if we were deallocating this buffer as part of a tear-down
   // on failure we don't want to end up dying during cleanup.
+  //
+  // Queue-ordered allocations that were not freed with a queue_dealloca are
+  // freed in stream order after all work that may be using them. The device
+  // pointer is cleared when the free has already been enqueued.
+  if (buffer_type == IREE_HAL_CUDA_BUFFER_TYPE_ASYNC &&
+      iree_hal_cuda_buffer_device_pointer(base_buffer)) {
+    IREE_IGNORE_ERROR(iree_hal_cuda_allocator_free_async(
+        base_allocator, allocator->stream, base_buffer));
+  }
   iree_hal_cuda_buffer_free(allocator->context, buffer_type,
                             iree_hal_cuda_buffer_device_pointer(base_buffer),
                             iree_hal_cuda_buffer_host_pointer(base_buffer));
@@ -449,6 +537,103 @@ static void iree_hal_cuda_allocator_deallocate_buffer(
   iree_hal_buffer_destroy(base_buffer);
 }
 
+bool iree_hal_cuda_allocator_supports_async(
+    iree_hal_allocator_t* base_allocator,
+    const iree_hal_buffer_params_t* params) {
+  if (!iree_hal_resource_is(base_allocator, &iree_hal_cuda_allocator_vtable)) {
+    return false;
+  }
+  iree_hal_cuda_allocator_t* allocator =
+      iree_hal_cuda_allocator_cast(base_allocator);
+  if (!allocator->async_pool) return false;
+
+  // Pool memory is device-only and cannot be mapped or shared.
+  return iree_all_bits_set(params->type, IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL) &&
+         !iree_any_bit_set(params->type, IREE_HAL_MEMORY_TYPE_HOST_VISIBLE) &&
+         !iree_any_bit_set(params->usage,
+                           IREE_HAL_BUFFER_USAGE_MAPPING |
+                               IREE_HAL_BUFFER_USAGE_SHARING_EXPORT);
+}
+
+iree_status_t iree_hal_cuda_allocator_alloc_async(
+    iree_hal_allocator_t* base_allocator, CUstream stream,
+    const iree_hal_buffer_params_t* params, iree_device_size_t allocation_size,
+    iree_hal_buffer_t** out_buffer) {
+  iree_hal_cuda_allocator_t* allocator =
+      iree_hal_cuda_allocator_cast(base_allocator);
+  *out_buffer = NULL;
+  if (!iree_hal_cuda_allocator_supports_async(base_allocator, params)) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "allocator cannot make queue-ordered allocations of buffers with the "
+        "given parameters");
+  }
+
+  // Coerce options into those required by the current device.
+  iree_hal_buffer_params_t compat_params = *params;
+  iree_hal_buffer_compatibility_t compatibility =
+      iree_hal_cuda_allocator_query_buffer_compatibility(
+          base_allocator, &compat_params, &allocation_size);
+  if (!iree_all_bits_set(compatibility,
+                         IREE_HAL_BUFFER_COMPATIBILITY_ALLOCATABLE)) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "allocator cannot allocate a buffer with the given parameters");
+  }
+
+  IREE_TRACE_ZONE_BEGIN_NAMED(z0, "iree_hal_cuda_buffer_allocate_async");
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, allocation_size);
+  CUdeviceptr device_ptr = 0;
+  iree_status_t status = CU_RESULT_TO_STATUS(
+      allocator->context->syms,
+      cuMemAllocFromPoolAsync(&device_ptr, allocation_size,
+                              allocator->async_pool, stream),
+      "cuMemAllocFromPoolAsync");
+  IREE_TRACE_ZONE_END(z0);
+
+  iree_hal_buffer_t* buffer = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_cuda_buffer_wrap(
+        base_allocator, compat_params.type, compat_params.access,
+        compat_params.usage, allocation_size,
+        /*byte_offset=*/0,
+        /*byte_length=*/allocation_size, IREE_HAL_CUDA_BUFFER_TYPE_ASYNC,
+        device_ptr, /*host_ptr=*/NULL, iree_hal_buffer_release_callback_null(),
+        &buffer);
+  }
+
+  if (iree_status_is_ok(status)) {
+    IREE_TRACE_ALLOC_NAMED(IREE_HAL_CUDA_ALLOCATOR_ID, (void*)device_ptr,
+                           allocation_size);
+    IREE_STATISTICS(iree_hal_allocator_statistics_record_alloc(
+        &allocator->statistics, compat_params.type, allocation_size));
+    *out_buffer = buffer;
+  } else if (device_ptr) {
+    CUDA_IGNORE_ERROR(allocator->context->syms,
+                      cuMemFreeAsync(device_ptr, stream));
+  }
+  return status;
+}
+
+iree_status_t iree_hal_cuda_allocator_free_async(
+    iree_hal_allocator_t* base_allocator, CUstream stream,
+    iree_hal_buffer_t* buffer) {
+  iree_hal_cuda_allocator_t* allocator =
+      iree_hal_cuda_allocator_cast(base_allocator);
+  CUdeviceptr device_ptr = iree_hal_cuda_buffer_device_pointer(buffer);
+  if (!device_ptr) return iree_ok_status();
+
+  CUDA_RETURN_IF_ERROR(allocator->context->syms,
+                       cuMemFreeAsync(device_ptr, stream), "cuMemFreeAsync");
+  iree_hal_cuda_buffer_set_device_pointer(buffer, 0);
+
+  IREE_TRACE_FREE_NAMED(IREE_HAL_CUDA_ALLOCATOR_ID, (void*)device_ptr);
+  IREE_STATISTICS(iree_hal_allocator_statistics_record_free(
+      &allocator->statistics, iree_hal_buffer_memory_type(buffer),
+      iree_hal_buffer_allocation_size(buffer)));
+  return iree_ok_status();
+}
+
 static iree_status_t iree_hal_cuda_allocator_import_buffer(
     iree_hal_allocator_t* IREE_RESTRICT base_allocator,
     const iree_hal_buffer_params_t* IREE_RESTRICT params,
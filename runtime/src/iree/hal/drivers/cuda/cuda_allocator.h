@@ -9,6 +9,7 @@
 
 #include "iree/base/api.h"
 #include "iree/hal/api.h"
+#include "iree/hal/drivers/cuda/api.h"
 #include "iree/hal/drivers/cuda/context_wrapper.h"
 #include "iree/hal/drivers/cuda/status_util.h"
 
@@ -17,9 +18,34 @@ extern "C" {
 #endif  // __cplusplus
 
 // Create a cuda allocator.
+// If |params| enables async allocations and the device supports memory pools a
+// dedicated memory pool is created for queue-ordered allocations.
 iree_status_t iree_hal_cuda_allocator_create(
     iree_hal_device_t* base_device, iree_hal_cuda_context_wrapper_t* context,
-    CUdevice device, CUstream stream, iree_hal_allocator_t** out_allocator);
+    CUdevice device, CUstream stream,
+    const iree_hal_cuda_device_params_t* params,
+    iree_hal_allocator_t** out_allocator);
+
+// Returns true if |allocator| is a CUDA allocator that can make a queue-ordered
+// allocation of a buffer with |params|.
+bool iree_hal_cuda_allocator_supports_async(
+    iree_hal_allocator_t* allocator, const iree_hal_buffer_params_t* params);
+
+// Allocates a buffer from the allocator memory pool in stream order on
+// |stream|. The buffer memory must only be used by work submitted to |stream|
+// after this call (or work which waits on it).
+iree_status_t iree_hal_cuda_allocator_alloc_async(
+    iree_hal_allocator_t* allocator, CUstream stream,
+    const iree_hal_buffer_params_t* params, iree_device_size_t allocation_size,
+    iree_hal_buffer_t** out_buffer);
+
+// Frees the memory of a buffer allocated with
+// iree_hal_cuda_allocator_alloc_async in stream order on |stream|. The buffer
+// handle remains valid until released but its memory must not be used by any
+// work submitted after this call.
+iree_status_t iree_hal_cuda_allocator_free_async(
+    iree_hal_allocator_t* allocator, CUstream stream,
+    iree_hal_buffer_t* buffer);
 
 #ifdef __cplusplus
 }  // extern "C"
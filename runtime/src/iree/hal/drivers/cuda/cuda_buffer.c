@@ -131,6 +131,10 @@ static iree_status_t iree_hal_cuda_buffer_flush_range(
   return iree_ok_status();
 }
 
+bool iree_hal_cuda_buffer_isa(const iree_hal_buffer_t* buffer) {
+  return iree_hal_resource_is(buffer, &iree_hal_cuda_buffer_vtable);
+}
+
 iree_hal_cuda_buffer_type_t iree_hal_cuda_buffer_type(
     const iree_hal_buffer_t* base_buffer) {
   const iree_hal_cuda_buffer_t* buffer =
@@ -145,6 +149,12 @@ CUdeviceptr iree_hal_cuda_buffer_device_pointer(
   return buffer->device_ptr;
 }
 
+void iree_hal_cuda_buffer_set_device_pointer(iree_hal_buffer_t* base_buffer,
+                                             CUdeviceptr device_ptr) {
+  iree_hal_cuda_buffer_t* buffer = iree_hal_cuda_buffer_cast(base_buffer);
+  buffer->device_ptr = device_ptr;
+}
+
 void* iree_hal_cuda_buffer_host_pointer(const iree_hal_buffer_t* base_buffer) {
   const iree_hal_cuda_buffer_t* buffer =
       iree_hal_cuda_buffer_const_cast(base_buffer);
@@ -22,6 +22,8 @@ typedef enum iree_hal_cuda_buffer_type_e {
   IREE_HAL_CUDA_BUFFER_TYPE_HOST = 1u << 1,
   // cuMemHostRegister + cuMemHostUnregister
   IREE_HAL_CUDA_BUFFER_TYPE_HOST_REGISTERED = 1u << 2,
+  // cuMemAllocFromPoolAsync + cuMemFreeAsync
+  IREE_HAL_CUDA_BUFFER_TYPE_ASYNC = 1u << 3,
 } iree_hal_cuda_buffer_type_t;
 
 // Wraps a CUDA allocation in an iree_hal_buffer_t.
@@ -34,6 +36,9 @@ iree_status_t iree_hal_cuda_buffer_wrap(
     void* host_ptr, iree_hal_buffer_release_callback_t release_callback,
     iree_hal_buffer_t** out_buffer);
 
+// Returns true if |buffer| is a CUDA buffer.
+bool iree_hal_cuda_buffer_isa(const iree_hal_buffer_t* buffer);
+
 // Returns the underlying CUDA buffer type.
 iree_hal_cuda_buffer_type_t iree_hal_cuda_buffer_type(
     const iree_hal_buffer_t* buffer);
@@ -44,6 +49,11 @@ iree_hal_cuda_buffer_type_t iree_hal_cuda_buffer_type(
 CUdeviceptr iree_hal_cuda_buffer_device_pointer(
     const iree_hal_buffer_t* buffer);
 
+// Updates the CUDA base pointer of |buffer|. Used to clear the pointer of
+// queue-ordered allocations once their free has been enqueued.
+void iree_hal_cuda_buffer_set_device_pointer(iree_hal_buffer_t* buffer,
+                                             CUdeviceptr device_ptr);
+
 // Returns the CUDA host pointer for the given |buffer|, if available.
 void* iree_hal_cuda_buffer_host_pointer(const iree_hal_buffer_t* buffer);
 
@@ -12,26 +12,64 @@
 
 #include "iree/base/internal/arena.h"
 #include "iree/base/internal/math.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/drivers/cuda/context_wrapper.h"
 #include "iree/hal/drivers/cuda/cuda_allocator.h"
+#include "iree/hal/drivers/cuda/cuda_buffer.h"
 #include "iree/hal/drivers/cuda/cuda_event.h"
 #include "iree/hal/drivers/cuda/dynamic_symbols.h"
 #include "iree/hal/drivers/cuda/event_semaphore.h"
 #include "iree/hal/drivers/cuda/graph_command_buffer.h"
 #include "iree/hal/drivers/cuda/nccl_channel.h"
 #include "iree/hal/drivers/cuda/nop_executable_cache.h"
+#include "iree/hal/drivers/cuda/pending_queue.h"
 #include "iree/hal/drivers/cuda/pipeline_layout.h"
+#include "iree/hal/drivers/cuda/staging_buffer.h"
 #include "iree/hal/drivers/cuda/status_util.h"
 #include "iree/hal/drivers/cuda/stream_command_buffer.h"
 #include "iree/hal/drivers/cuda/tracing.h"
 #include "iree/hal/utils/buffer_transfer.h"
 #include "iree/hal/utils/deferred_command_buffer.h"
+#include "iree/hal/utils/resource_set.h"
+
+// Interval between polls of the semaphores in a wait-any operation.
+#define IREE_HAL_CUDA_DEVICE_WAIT_ANY_POLL_INTERVAL_NS (50 * 1000)
 
 //===----------------------------------------------------------------------===//
 // iree_hal_cuda_device_t
 //===----------------------------------------------------------------------===//
 
+// A submission made to a queue stream that has not yet been observed as
+// completed. Retains all resources used by the submission until |event|
+// completes.
+typedef struct iree_hal_cuda_submission_t {
+  struct iree_hal_cuda_submission_t* next;
+  CUevent event;
+  iree_hal_resource_set_t* resource_set;
+} iree_hal_cuda_submission_t;
+
+// A device queue backed by its own CUDA stream. Work on different queues runs
+// concurrently and is ordered only by semaphores, which wait on and record
+// CUDA events across streams.
+typedef struct iree_hal_cuda_queue_t {
+  CUstream stream;
+  iree_hal_cuda_tracing_context_t* tracing_context;
+
+  // Stream collectives recorded into stream command buffers are issued on so
+  // that they overlap with compute on |stream|, or NULL if disabled.
+  CUstream collective_stream;
+
+  // Cache of the direct stream command buffer initialized when in stream mode.
+  iree_hal_command_buffer_t* stream_command_buffer;
+
+  // In-flight submissions to |stream| in submission order. Completed
+  // submissions are retired from the head as new submissions are made.
+  // Guarded by the device submission mutex.
+  iree_hal_cuda_submission_t* submission_head;
+  iree_hal_cuda_submission_t* submission_tail;
+} iree_hal_cuda_queue_t;
+
 typedef struct iree_hal_cuda_device_t {
   iree_hal_resource_t resource;
   iree_string_view_t identifier;
@@ -49,15 +87,22 @@ typedef struct iree_hal_cuda_device_t {
 
   CUdevice device;
 
-  // TODO: support multiple streams.
-  CUstream stream;
   iree_hal_cuda_context_wrapper_t context_wrapper;
-  iree_hal_cuda_tracing_context_t* tracing_context;
   iree_hal_allocator_t* device_allocator;
 
-  // Cache of the direct stream command buffer initialized when in stream mode.
-  // TODO: have one cached per stream once there are multiple streams.
-  iree_hal_command_buffer_t* stream_command_buffer;
+  // Page-locked staging memory for transfers from/to pageable host memory.
+  iree_hal_cuda_staging_buffer_t staging_buffer;
+
+  // Guards the in-flight submission lists and submission to queue streams.
+  iree_slim_mutex_t submission_mutex;
+
+  // Queues selected by queue affinity followed by the dedicated transfer queue
+  // if enabled. Queue 0 is the default queue.
+  iree_host_size_t queue_count;
+  iree_hal_cuda_queue_t* queues;
+
+  // Submissions deferred until their waits can be enqueued on a stream.
+  iree_hal_cuda_pending_queue_t* pending_queue;
 } iree_hal_cuda_device_t;
 
 static const iree_hal_device_vtable_t iree_hal_cuda_device_vtable;
@@ -73,9 +118,17 @@ void iree_hal_cuda_device_params_initialize(
   memset(out_params, 0, sizeof(*out_params));
   out_params->arena_block_size = 32 * 1024;
   out_params->queue_count = 1;
+  out_params->dedicated_transfer_queue = false;
+  out_params->dedicated_collective_stream = false;
   out_params->command_buffer_mode = IREE_HAL_CUDA_COMMAND_BUFFER_MODE_GRAPH;
   out_params->allow_inline_execution = false;
   out_params->stream_tracing = false;
+  out_params->async_allocations = true;
+  out_params->async_allocation_release_threshold = UINT64_MAX;
+  out_params->staging_buffer_chunk_size = 4 * 1024 * 1024;
+  out_params->staging_buffer_chunk_count = 4;
+  out_params->staging_transfer_threshold =
+      IREE_HAL_COMMAND_BUFFER_MAX_UPDATE_SIZE;
 }
 
 static iree_status_t iree_hal_cuda_device_check_params(
@@ -88,57 +141,139 @@ static iree_status_t iree_hal_cuda_device_check_params(
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "at least one queue is required");
   }
+  if (params->staging_buffer_chunk_count > 0 &&
+      params->staging_buffer_chunk_size == 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "staging buffer chunks must be non-empty");
+  }
+  if (params->queue_count > IREE_HAL_CUDA_MAX_QUEUE_COUNT) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "queue count %" PRIhsz
+                            " exceeds the maximum of %d",
+                            params->queue_count, IREE_HAL_CUDA_MAX_QUEUE_COUNT);
+  }
   return iree_ok_status();
 }
 
+// Creates the stream and per-stream state for |queue|.
+static iree_status_t iree_hal_cuda_queue_initialize(
+    iree_hal_cuda_device_t* device, iree_hal_cuda_queue_t* queue) {
+  CUDA_RETURN_IF_ERROR(device->context_wrapper.syms,
+                       cuStreamCreate(&queue->stream, CU_STREAM_NON_BLOCKING),
+                       "cuStreamCreate");
+  if (device->params.dedicated_collective_stream) {
+    CUDA_RETURN_IF_ERROR(
+        device->context_wrapper.syms,
+        cuStreamCreate(&queue->collective_stream, CU_STREAM_NON_BLOCKING),
+        "cuStreamCreate");
+  }
+
+  // Enable tracing for the stream - no-op if disabled.
+  if (device->params.stream_tracing) {
+    IREE_RETURN_IF_ERROR(iree_hal_cuda_tracing_context_allocate(
+        &device->context_wrapper, device->identifier, queue->stream,
+        &device->block_pool, device->context_wrapper.host_allocator,
+        &queue->tracing_context));
+  }
+
+  if (device->params.command_buffer_mode ==
+      IREE_HAL_CUDA_COMMAND_BUFFER_MODE_STREAM) {
+    IREE_RETURN_IF_ERROR(iree_hal_cuda_stream_command_buffer_create(
+        (iree_hal_device_t*)device, &device->context_wrapper,
+        queue->tracing_context,
+        IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION |
+            IREE_HAL_COMMAND_BUFFER_MODE_UNVALIDATED,
+        IREE_HAL_COMMAND_CATEGORY_ANY, /*binding_capacity=*/0, queue->stream,
+        queue->collective_stream, &device->block_pool,
+        &queue->stream_command_buffer));
+  }
+  return iree_ok_status();
+}
+
+// Releases the per-stream state of |queue|. All work on the stream must have
+// completed and all submissions must have been retired.
+static void iree_hal_cuda_queue_deinitialize(iree_hal_cuda_device_t* device,
+                                             iree_hal_cuda_queue_t* queue) {
+  iree_hal_command_buffer_release(queue->stream_command_buffer);
+  iree_hal_cuda_tracing_context_free(queue->tracing_context);
+  if (queue->collective_stream) {
+    CUDA_IGNORE_ERROR(device->context_wrapper.syms,
+                      cuStreamDestroy(queue->collective_stream));
+  }
+  if (queue->stream) {
+    CUDA_IGNORE_ERROR(device->context_wrapper.syms,
+                      cuStreamDestroy(queue->stream));
+  }
+}
+
+static iree_status_t iree_hal_cuda_device_issue_pending(
+    void* user_data, void* queue,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_host_size_t command_buffer_count,
+    iree_hal_command_buffer_t* const* command_buffers,
+    iree_hal_buffer_t* dealloca_buffer);
+
 static iree_status_t iree_hal_cuda_device_create_internal(
     iree_hal_driver_t* driver, iree_string_view_t identifier,
     const iree_hal_cuda_device_params_t* params, CUdevice cu_device,
-    CUstream stream, CUcontext context, iree_hal_cuda_dynamic_symbols_t* syms,
+    CUcontext context, iree_hal_cuda_dynamic_symbols_t* syms,
     iree_allocator_t host_allocator, iree_hal_device_t** out_device) {
+  const iree_host_size_t queue_count =
+      params->queue_count + (params->dedicated_transfer_queue ? 1 : 0);
   iree_hal_cuda_device_t* device = NULL;
-  iree_host_size_t total_size = iree_sizeof_struct(*device) + identifier.size;
-  IREE_RETURN_IF_ERROR(
-      iree_allocator_malloc(host_allocator, total_size, (void**)&device));
+  iree_host_size_t total_size = iree_sizeof_struct(*device) +
+                                queue_count * sizeof(device->queues[0]) +
+                                identifier.size;
+  iree_status_t status =
+      iree_allocator_malloc(host_allocator, total_size, (void**)&device);
+  if (!iree_status_is_ok(status)) {
+    syms->cuDevicePrimaryCtxRelease(cu_device);
+    return status;
+  }
   memset(device, 0, total_size);
   iree_hal_resource_initialize(&iree_hal_cuda_device_vtable, &device->resource);
   device->driver = driver;
   iree_hal_driver_retain(device->driver);
-  iree_string_view_append_to_buffer(
-      identifier, &device->identifier,
-      (char*)device + iree_sizeof_struct(*device));
+  uint8_t* buffer_ptr = (uint8_t*)device + iree_sizeof_struct(*device);
+  device->queue_count = queue_count;
+  device->queues = (iree_hal_cuda_queue_t*)buffer_ptr;
+  buffer_ptr += queue_count * sizeof(device->queues[0]);
+  iree_string_view_append_to_buffer(identifier, &device->identifier,
+                                    (char*)buffer_ptr);
   device->params = *params;
   device->device = cu_device;
-  device->stream = stream;
   device->context_wrapper.cu_context = context;
   device->context_wrapper.host_allocator = host_allocator;
   iree_arena_block_pool_initialize(params->arena_block_size, host_allocator,
                                    &device->block_pool);
   device->context_wrapper.syms = syms;
+  iree_slim_mutex_initialize(&device->submission_mutex);
+  iree_hal_cuda_staging_buffer_initialize(
+      &device->context_wrapper, params->staging_buffer_chunk_size,
+      params->staging_buffer_chunk_count, &device->staging_buffer);
 
-  // Enable tracing for the (currently only) stream - no-op if disabled.
-  iree_status_t status = iree_ok_status();
-  if (device->params.stream_tracing) {
-    status = iree_hal_cuda_tracing_context_allocate(
-        &device->context_wrapper, device->identifier, stream,
-        &device->block_pool, host_allocator, &device->tracing_context);
+  for (iree_host_size_t i = 0; i < queue_count && iree_status_is_ok(status);
+       ++i) {
+    status = iree_hal_cuda_queue_initialize(device, &device->queues[i]);
   }
 
+  // Buffers released without a queue-ordered deallocation are freed on the
+  // default queue.
   if (iree_status_is_ok(status)) {
-    status = iree_hal_cuda_allocator_create((iree_hal_device_t*)device,
-                                            &device->context_wrapper, cu_device,
-                                            stream, &device->device_allocator);
+    status = iree_hal_cuda_allocator_create(
+        (iree_hal_device_t*)device, &device->context_wrapper, cu_device,
+        device->queues[0].stream, &device->params, &device->device_allocator);
   }
 
-  if (iree_status_is_ok(status) &&
-      params->command_buffer_mode == IREE_HAL_CUDA_COMMAND_BUFFER_MODE_STREAM) {
-    status = iree_hal_cuda_stream_command_buffer_create(
-        (iree_hal_device_t*)device, &device->context_wrapper,
-        device->tracing_context,
-        IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION |
-            IREE_HAL_COMMAND_BUFFER_MODE_UNVALIDATED,
-        IREE_HAL_COMMAND_CATEGORY_ANY, /*binding_capacity=*/0, device->stream,
-        &device->block_pool, &device->stream_command_buffer);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_cuda_pending_queue_create(
+        &device->context_wrapper,
+        (iree_hal_cuda_pending_queue_issue_t){
+            .fn = iree_hal_cuda_device_issue_pending,
+            .user_data = device,
+        },
+        host_allocator, &device->pending_queue);
   }
 
   if (iree_status_is_ok(status)) {
@@ -163,23 +298,108 @@ iree_status_t iree_hal_cuda_device_create(
       z0,
       CU_RESULT_TO_STATUS(syms, cuDevicePrimaryCtxRetain(&context, device)));
   iree_status_t status = CU_RESULT_TO_STATUS(syms, cuCtxSetCurrent(context));
-  CUstream stream;
+  if (iree_status_is_ok(status)) {
+    // On failure the device releases the primary context when destroyed.
+    status = iree_hal_cuda_device_create_internal(driver, identifier, params,
+                                                  device, context, syms,
+                                                  host_allocator, out_device);
+  } else {
+    syms->cuDevicePrimaryCtxRelease(device);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Returns the queue that work with |queue_affinity| is submitted to.
+// Work that only performs transfers goes to the dedicated transfer queue if
+// enabled. Affinities hash into the available queues such that a single bit
+// consistently maps to the same queue.
+static iree_hal_cuda_queue_t* iree_hal_cuda_device_select_queue(
+    iree_hal_cuda_device_t* device, iree_hal_queue_affinity_t queue_affinity,
+    iree_hal_command_category_t command_categories) {
+  if (device->params.dedicated_transfer_queue &&
+      command_categories == IREE_HAL_COMMAND_CATEGORY_TRANSFER) {
+    return &device->queues[device->queue_count - 1];
+  }
+  if (queue_affinity == 0) return &device->queues[0];
+  iree_host_size_t queue_index =
+      (iree_host_size_t)iree_math_count_trailing_zeros_u64(queue_affinity) %
+      device->params.queue_count;
+  return &device->queues[queue_index];
+}
+
+// Retires in-flight submissions to |queue| that have completed and releases
+// their resources. If |wait_all| is set all submissions are retired and the
+// caller must have ensured that the stream is idle. The submission mutex must
+// be held.
+static void iree_hal_cuda_device_retire_submissions(
+    iree_hal_cuda_device_t* device, iree_hal_cuda_queue_t* queue,
+    bool wait_all) {
+  iree_allocator_t host_allocator = device->context_wrapper.host_allocator;
+  while (queue->submission_head) {
+    iree_hal_cuda_submission_t* submission = queue->submission_head;
+    if (!wait_all && device->context_wrapper.syms->cuEventQuery(
+                         submission->event) == CUDA_ERROR_NOT_READY) {
+      break;  // submissions to a stream complete in order
+    }
+    queue->submission_head = submission->next;
+    CUDA_IGNORE_ERROR(device->context_wrapper.syms,
+                      cuEventDestroy(submission->event));
+    iree_hal_resource_set_free(submission->resource_set);
+    iree_allocator_free(host_allocator, submission);
+  }
+  if (!queue->submission_head) queue->submission_tail = NULL;
+}
+
+// Retains |command_buffers| until all work currently submitted to the |queue|
+// stream has completed. The submission mutex must be held.
+static iree_status_t iree_hal_cuda_device_track_submission(
+    iree_hal_cuda_device_t* device, iree_hal_cuda_queue_t* queue,
+    iree_host_size_t command_buffer_count,
+    iree_hal_command_buffer_t* const* command_buffers) {
+  iree_allocator_t host_allocator = device->context_wrapper.host_allocator;
+  iree_hal_cuda_submission_t* submission = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      host_allocator, sizeof(*submission), (void**)&submission));
+  memset(submission, 0, sizeof(*submission));
+
+  iree_status_t status = iree_hal_resource_set_allocate(
+      &device->block_pool, &submission->resource_set);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_resource_set_insert(submission->resource_set,
+                                          command_buffer_count,
+                                          command_buffers);
+  }
   if (iree_status_is_ok(status)) {
     status = CU_RESULT_TO_STATUS(
-        syms, cuStreamCreate(&stream, CU_STREAM_NON_BLOCKING));
+        device->context_wrapper.syms,
+        cuEventCreate(&submission->event, CU_EVENT_DISABLE_TIMING),
+        "cuEventCreate");
   }
   if (iree_status_is_ok(status)) {
-    status = iree_hal_cuda_device_create_internal(driver, identifier, params,
-                                                  device, stream, context, syms,
-                                                  host_allocator, out_device);
+    status = CU_RESULT_TO_STATUS(device->context_wrapper.syms,
+                                 cuEventRecord(submission->event,
+                                               queue->stream),
+                                 "cuEventRecord");
   }
-  if (!iree_status_is_ok(status)) {
-    if (stream) {
-      syms->cuStreamDestroy(stream);
+
+  if (iree_status_is_ok(status)) {
+    if (queue->submission_tail) {
+      queue->submission_tail->next = submission;
+    } else {
+      queue->submission_head = submission;
     }
-    syms->cuDevicePrimaryCtxRelease(device);
+    queue->submission_tail = submission;
+  } else {
+    if (submission->event) {
+      CUDA_IGNORE_ERROR(device->context_wrapper.syms,
+                        cuEventDestroy(submission->event));
+    }
+    if (submission->resource_set) {
+      iree_hal_resource_set_free(submission->resource_set);
+    }
+    iree_allocator_free(host_allocator, submission);
   }
-  IREE_TRACE_ZONE_END(z0);
   return status;
 }
 
@@ -188,15 +408,31 @@ static void iree_hal_cuda_device_destroy(iree_hal_device_t* base_device) {
   iree_allocator_t host_allocator = iree_hal_device_host_allocator(base_device);
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  iree_hal_command_buffer_release(device->stream_command_buffer);
+  // Submissions still waiting on values that were never signaled are failed
+  // and never issued.
+  iree_hal_cuda_pending_queue_destroy(device->pending_queue);
+
+  // Wait for all in-flight work to complete so that the resources it uses can
+  // be released.
+  iree_slim_mutex_lock(&device->submission_mutex);
+  for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
+    iree_hal_cuda_queue_t* queue = &device->queues[i];
+    if (!queue->stream) continue;
+    CUDA_IGNORE_ERROR(device->context_wrapper.syms,
+                      cuStreamSynchronize(queue->stream));
+    iree_hal_cuda_device_retire_submissions(device, queue, /*wait_all=*/true);
+  }
+  iree_slim_mutex_unlock(&device->submission_mutex);
+  iree_slim_mutex_deinitialize(&device->submission_mutex);
 
   // There should be no more buffers live that use the allocator.
   iree_hal_allocator_release(device->device_allocator);
 
-  // TODO: support multiple streams.
-  iree_hal_cuda_tracing_context_free(device->tracing_context);
-  CUDA_IGNORE_ERROR(device->context_wrapper.syms,
-                    cuStreamDestroy(device->stream));
+  iree_hal_cuda_staging_buffer_deinitialize(&device->staging_buffer);
+
+  for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
+    iree_hal_cuda_queue_deinitialize(device, &device->queues[i]);
+  }
 
   iree_arena_block_pool_deinitialize(&device->block_pool);
 
@@ -342,10 +578,12 @@ static iree_status_t iree_hal_cuda_device_create_command_buffer(
     // recorded, implying that the command buffer cannot be reused and doesn't
     // need to be persisted. This lets us lower the execution delay as we can
     // directly route commands to a CUDA stream and let it eagerly flush.
+    iree_hal_cuda_queue_t* queue = iree_hal_cuda_device_select_queue(
+        device, queue_affinity, command_categories);
     return iree_hal_cuda_stream_command_buffer_create(
-        base_device, &device->context_wrapper, device->tracing_context, mode,
-        command_categories, binding_capacity, device->stream,
-        &device->block_pool, out_command_buffer);
+        base_device, &device->context_wrapper, queue->tracing_context, mode,
+        command_categories, binding_capacity, queue->stream,
+        queue->collective_stream, &device->block_pool, out_command_buffer);
   }
   switch (device->params.command_buffer_mode) {
     case IREE_HAL_CUDA_COMMAND_BUFFER_MODE_GRAPH:
@@ -412,10 +650,215 @@ static iree_status_t iree_hal_cuda_device_create_semaphore(
 static iree_hal_semaphore_compatibility_t
 iree_hal_cuda_device_query_semaphore_compatibility(
     iree_hal_device_t* base_device, iree_hal_semaphore_t* semaphore) {
-  // TODO: implement CUDA semaphores.
+  // TODO: device-side waits on semaphores from other CUDA devices are possible
+  // as the events are shareable within a process; for now all CUDA semaphores
+  // are assumed to be from the same context.
+  if (iree_hal_cuda_semaphore_isa(semaphore)) {
+    return IREE_HAL_SEMAPHORE_COMPATIBILITY_ALL;
+  }
   return IREE_HAL_SEMAPHORE_COMPATIBILITY_HOST_ONLY;
 }
 
+// Issues |command_buffers| to the |queue| stream in order.
+static iree_status_t iree_hal_cuda_device_issue_command_buffers(
+    iree_hal_cuda_device_t* device, iree_hal_cuda_queue_t* queue,
+    iree_host_size_t command_buffer_count,
+    iree_hal_command_buffer_t* const* command_buffers) {
+  for (iree_host_size_t i = 0; i < command_buffer_count; i++) {
+    iree_hal_command_buffer_t* command_buffer = command_buffers[i];
+    if (iree_hal_cuda_stream_command_buffer_isa(command_buffer)) {
+      // Nothing to do for an inline command buffer; all the work has already
+      // been submitted. We do not have to worry about any waits: if there
+      // were waits we wouldn't have been able to execute inline!
+    } else if (iree_hal_cuda_graph_command_buffer_isa(command_buffer)) {
+      CUgraphExec exec =
+          iree_hal_cuda_graph_command_buffer_handle(command_buffers[i]);
+      CUDA_RETURN_IF_ERROR(device->context_wrapper.syms,
+                           cuGraphLaunch(exec, queue->stream),
+                           "cuGraphLaunch");
+    } else {
+      IREE_RETURN_IF_ERROR(iree_hal_deferred_command_buffer_apply(
+          command_buffers[i], queue->stream_command_buffer,
+          iree_hal_buffer_binding_table_empty()));
+    }
+  }
+  return iree_ok_status();
+}
+
+// Enqueues waits on |wait_semaphore_list| on the |queue| stream.
+// The caller must have checked the list with
+// iree_hal_cuda_semaphore_list_can_enqueue_wait: CUDA semaphores are waited on
+// by the stream and other semaphores must already have been reached.
+static iree_status_t iree_hal_cuda_device_enqueue_waits(
+    iree_hal_cuda_device_t* device, iree_hal_cuda_queue_t* queue,
+    const iree_hal_semaphore_list_t wait_semaphore_list) {
+  for (iree_host_size_t i = 0; i < wait_semaphore_list.count; ++i) {
+    iree_hal_semaphore_t* semaphore = wait_semaphore_list.semaphores[i];
+    uint64_t value = wait_semaphore_list.payload_values[i];
+    if (iree_hal_cuda_semaphore_isa(semaphore)) {
+      IREE_RETURN_IF_ERROR(iree_hal_cuda_semaphore_enqueue_wait(
+          semaphore, value, queue->stream));
+    } else {
+      IREE_RETURN_IF_ERROR(
+          iree_hal_semaphore_wait(semaphore, value, iree_immediate_timeout()));
+    }
+  }
+  return iree_ok_status();
+}
+
+// Enqueues signals of the CUDA semaphores in |signal_semaphore_list| on the
+// device stream. Sets |out_requires_host_signal| if any semaphores must be
+// signaled from the host with iree_hal_cuda_device_signal_from_host.
+// Must be called with the submission lock held.
+static iree_status_t iree_hal_cuda_device_enqueue_signals(
+    iree_hal_cuda_device_t* device, iree_hal_cuda_queue_t* queue,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    bool* out_requires_host_signal) {
+  *out_requires_host_signal = false;
+  for (iree_host_size_t i = 0; i < signal_semaphore_list.count; ++i) {
+    iree_hal_semaphore_t* semaphore = signal_semaphore_list.semaphores[i];
+    if (iree_hal_cuda_semaphore_isa(semaphore)) {
+      IREE_RETURN_IF_ERROR(iree_hal_cuda_semaphore_enqueue_signal(
+          semaphore, signal_semaphore_list.payload_values[i], queue->stream));
+    } else {
+      *out_requires_host_signal = true;
+    }
+  }
+  return iree_ok_status();
+}
+
+// Signals the semaphores in |signal_semaphore_list| we cannot signal from the
+// device once all work on the |queue| stream has completed.
+static iree_status_t iree_hal_cuda_device_signal_from_host(
+    iree_hal_cuda_device_t* device, iree_hal_cuda_queue_t* queue,
+    const iree_hal_semaphore_list_t signal_semaphore_list) {
+  IREE_TRACE_ZONE_BEGIN_NAMED(z0, "cuStreamSynchronize");
+  iree_status_t status = CU_RESULT_TO_STATUS(
+      device->context_wrapper.syms, cuStreamSynchronize(queue->stream),
+      "cuStreamSynchronize");
+  IREE_TRACE_ZONE_END(z0);
+  for (iree_host_size_t i = 0;
+       i < signal_semaphore_list.count && iree_status_is_ok(status); ++i) {
+    iree_hal_semaphore_t* semaphore = signal_semaphore_list.semaphores[i];
+    if (!iree_hal_cuda_semaphore_isa(semaphore)) {
+      status = iree_hal_semaphore_signal(
+          semaphore, signal_semaphore_list.payload_values[i]);
+    }
+  }
+  return status;
+}
+
+// Issues a queue-ordered deallocation of |buffer| to the |queue| stream once
+// |wait_semaphore_list| is reached. The waits must be enqueueable.
+static iree_status_t iree_hal_cuda_device_issue_dealloca(
+    iree_hal_cuda_device_t* device, iree_hal_cuda_queue_t* queue,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_buffer_t* buffer) {
+  IREE_RETURN_IF_ERROR(
+      iree_hal_cuda_device_enqueue_waits(device, queue, wait_semaphore_list));
+
+  iree_slim_mutex_lock(&device->submission_mutex);
+  iree_status_t status = iree_hal_cuda_allocator_free_async(
+      buffer->device_allocator, queue->stream, buffer);
+  bool requires_host_signal = false;
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_cuda_device_enqueue_signals(
+        device, queue, signal_semaphore_list, &requires_host_signal);
+  }
+  iree_slim_mutex_unlock(&device->submission_mutex);
+
+  if (iree_status_is_ok(status) && signal_semaphore_list.count > 0) {
+    iree_hal_cuda_pending_queue_poke(device->pending_queue);
+  }
+  if (iree_status_is_ok(status) && requires_host_signal) {
+    status = iree_hal_cuda_device_signal_from_host(device, queue,
+                                                   signal_semaphore_list);
+  }
+  return status;
+}
+
+// Issues |command_buffers| to the |queue| stream once |wait_semaphore_list| is
+// reached. The waits must be enqueueable.
+static iree_status_t iree_hal_cuda_device_issue_execute(
+    iree_hal_cuda_device_t* device, iree_hal_cuda_queue_t* queue,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_host_size_t command_buffer_count,
+    iree_hal_command_buffer_t* const* command_buffers) {
+  // Waits on semaphores signaled by prior submissions are made on the stream
+  // and signals are recorded as events so that the host can continue
+  // preparing work while the device executes.
+  IREE_RETURN_IF_ERROR(
+      iree_hal_cuda_device_enqueue_waits(device, queue, wait_semaphore_list));
+
+  iree_slim_mutex_lock(&device->submission_mutex);
+  for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
+    iree_hal_cuda_device_retire_submissions(device, &device->queues[i],
+                                            /*wait_all=*/false);
+  }
+
+  iree_status_t status = iree_hal_cuda_device_issue_command_buffers(
+      device, queue, command_buffer_count, command_buffers);
+  if (iree_status_is_ok(status) && command_buffer_count > 0) {
+    status = iree_hal_cuda_device_track_submission(
+        device, queue, command_buffer_count, command_buffers);
+  }
+
+  bool requires_host_signal = false;
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_cuda_device_enqueue_signals(
+        device, queue, signal_semaphore_list, &requires_host_signal);
+  }
+  iree_slim_mutex_unlock(&device->submission_mutex);
+
+  // Pending submissions waiting on the signals can now wait on the device.
+  if (iree_status_is_ok(status) && signal_semaphore_list.count > 0) {
+    iree_hal_cuda_pending_queue_poke(device->pending_queue);
+  }
+
+  // Semaphores we cannot signal from the device are signaled from the host
+  // once the submission has completed.
+  if (iree_status_is_ok(status) && requires_host_signal) {
+    status = iree_hal_cuda_device_signal_from_host(device, queue,
+                                                   signal_semaphore_list);
+  }
+
+  iree_hal_cuda_tracing_context_collect(queue->tracing_context);
+  return status;
+}
+
+// Issues a submission deferred by the pending queue on its worker thread.
+static iree_status_t iree_hal_cuda_device_issue_pending(
+    void* user_data, void* queue,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_host_size_t command_buffer_count,
+    iree_hal_command_buffer_t* const* command_buffers,
+    iree_hal_buffer_t* dealloca_buffer) {
+  iree_hal_cuda_device_t* device = (iree_hal_cuda_device_t*)user_data;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status = iree_ok_status();
+  if (dealloca_buffer) {
+    status = iree_hal_cuda_device_issue_dealloca(
+        device, (iree_hal_cuda_queue_t*)queue, wait_semaphore_list,
+        signal_semaphore_list, dealloca_buffer);
+  } else {
+    status = iree_hal_cuda_device_issue_execute(
+        device, (iree_hal_cuda_queue_t*)queue, wait_semaphore_list,
+        signal_semaphore_list, command_buffer_count, command_buffers);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static iree_status_t iree_hal_cuda_device_queue_execute(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_host_size_t command_buffer_count,
+    iree_hal_command_buffer_t* const* command_buffers);
+
 static iree_status_t iree_hal_cuda_device_queue_alloca(
     iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
     const iree_hal_semaphore_list_t wait_semaphore_list,
@@ -423,15 +866,68 @@ static iree_status_t iree_hal_cuda_device_queue_alloca(
     iree_hal_allocator_pool_t pool, iree_hal_buffer_params_t params,
     iree_device_size_t allocation_size,
     iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
-  // TODO(benvanik): queue-ordered allocations.
+  iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
+  *out_buffer = NULL;
+
+  // Device-local allocations are made in stream order from the allocator
+  // memory pool when supported. All pools map to the same memory pool today.
+  // Otherwise, or if the waits are not yet enqueueable, the buffer is
+  // allocated immediately and only the signals are ordered after the waits;
+  // allocating early is safe as nothing can use the buffer before the signal.
   // TODO(benvanik): tracing of the allocations (just for sequencing).
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_wait(wait_semaphore_list,
-                                                    iree_infinite_timeout()));
-  IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
-      iree_hal_device_allocator(base_device), params, allocation_size,
-      iree_const_byte_span_empty(), out_buffer));
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_signal(signal_semaphore_list));
-  return iree_ok_status();
+  if (!iree_hal_cuda_allocator_supports_async(device->device_allocator,
+                                              &params) ||
+      !iree_hal_cuda_semaphore_list_can_enqueue_wait(wait_semaphore_list)) {
+    iree_hal_buffer_t* buffer = NULL;
+    IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
+        iree_hal_device_allocator(base_device), params, allocation_size,
+        iree_const_byte_span_empty(), &buffer));
+    iree_status_t status = iree_hal_cuda_device_queue_execute(
+        base_device, queue_affinity, wait_semaphore_list,
+        signal_semaphore_list, 0, NULL);
+    if (iree_status_is_ok(status)) {
+      *out_buffer = buffer;
+    } else {
+      iree_hal_buffer_release(buffer);
+    }
+    return status;
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, allocation_size);
+  iree_hal_cuda_queue_t* queue = iree_hal_cuda_device_select_queue(
+      device, queue_affinity, IREE_HAL_COMMAND_CATEGORY_ANY);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0,
+      iree_hal_cuda_device_enqueue_waits(device, queue, wait_semaphore_list));
+
+  iree_slim_mutex_lock(&device->submission_mutex);
+  iree_hal_buffer_t* buffer = NULL;
+  iree_status_t status = iree_hal_cuda_allocator_alloc_async(
+      device->device_allocator, queue->stream, &params, allocation_size,
+      &buffer);
+  bool requires_host_signal = false;
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_cuda_device_enqueue_signals(
+        device, queue, signal_semaphore_list, &requires_host_signal);
+  }
+  iree_slim_mutex_unlock(&device->submission_mutex);
+
+  if (iree_status_is_ok(status) && signal_semaphore_list.count > 0) {
+    iree_hal_cuda_pending_queue_poke(device->pending_queue);
+  }
+  if (iree_status_is_ok(status) && requires_host_signal) {
+    status = iree_hal_cuda_device_signal_from_host(device, queue,
+                                                   signal_semaphore_list);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_buffer = buffer;
+  } else {
+    iree_hal_buffer_release(buffer);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 static iree_status_t iree_hal_cuda_device_queue_dealloca(
@@ -439,11 +935,35 @@ static iree_status_t iree_hal_cuda_device_queue_dealloca(
     const iree_hal_semaphore_list_t wait_semaphore_list,
     const iree_hal_semaphore_list_t signal_semaphore_list,
     iree_hal_buffer_t* buffer) {
-  // TODO(benvanik): queue-ordered allocations.
+  iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
+
+  // Buffers not allocated in stream order are freed when released.
   // TODO(benvanik): tracing of the allocations (just for sequencing).
-  IREE_RETURN_IF_ERROR(iree_hal_device_queue_barrier(
-      base_device, queue_affinity, wait_semaphore_list, signal_semaphore_list));
-  return iree_ok_status();
+  iree_hal_buffer_t* allocated_buffer =
+      iree_hal_buffer_allocated_buffer(buffer);
+  if (!iree_hal_cuda_buffer_isa(allocated_buffer) ||
+      iree_hal_cuda_buffer_type(allocated_buffer) !=
+          IREE_HAL_CUDA_BUFFER_TYPE_ASYNC) {
+    return iree_hal_device_queue_barrier(base_device, queue_affinity,
+                                         wait_semaphore_list,
+                                         signal_semaphore_list);
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_cuda_queue_t* queue = iree_hal_cuda_device_select_queue(
+      device, queue_affinity, IREE_HAL_COMMAND_CATEGORY_ANY);
+  iree_status_t status = iree_ok_status();
+  if (iree_hal_cuda_semaphore_list_can_enqueue_wait(wait_semaphore_list)) {
+    status = iree_hal_cuda_device_issue_dealloca(
+        device, queue, wait_semaphore_list, signal_semaphore_list,
+        allocated_buffer);
+  } else {
+    status = iree_hal_cuda_pending_queue_enqueue(
+        device->pending_queue, queue, wait_semaphore_list,
+        signal_semaphore_list, 0, NULL, allocated_buffer);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 static iree_status_t iree_hal_cuda_device_queue_execute(
@@ -453,39 +973,105 @@ static iree_status_t iree_hal_cuda_device_queue_execute(
     iree_host_size_t command_buffer_count,
     iree_hal_command_buffer_t* const* command_buffers) {
   iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
+  IREE_TRACE_ZONE_BEGIN(z0);
 
-  // TODO(benvanik): trace around the entire submission.
+  // Transfer-only submissions may be routed to the dedicated transfer queue
+  // so that they overlap with dispatches on the compute queues.
+  iree_hal_command_category_t command_categories = 0;
+  for (iree_host_size_t i = 0; i < command_buffer_count; ++i) {
+    command_categories |=
+        iree_hal_command_buffer_allowed_categories(command_buffers[i]);
+  }
+  iree_hal_cuda_queue_t* queue = iree_hal_cuda_device_select_queue(
+      device, queue_affinity, command_categories);
 
-  for (iree_host_size_t i = 0; i < command_buffer_count; i++) {
-    iree_hal_command_buffer_t* command_buffer = command_buffers[i];
-    if (iree_hal_cuda_stream_command_buffer_isa(command_buffer)) {
-      // Nothing to do for an inline command buffer; all the work has already
-      // been submitted. When we support semaphores we'll still need to signal
-      // their completion but do not have to worry about any waits: if there
-      // were waits we wouldn't have been able to execute inline!
-    } else if (iree_hal_cuda_graph_command_buffer_isa(command_buffer)) {
-      CUgraphExec exec =
-          iree_hal_cuda_graph_command_buffer_handle(command_buffers[i]);
-      CUDA_RETURN_IF_ERROR(device->context_wrapper.syms,
-                           cuGraphLaunch(exec, device->stream),
-                           "cuGraphLaunch");
-    } else {
-      IREE_RETURN_IF_ERROR(iree_hal_deferred_command_buffer_apply(
-          command_buffers[i], device->stream_command_buffer,
-          iree_hal_buffer_binding_table_empty()));
-    }
+  // Submissions never block on the host. If a waited value has not been
+  // signaled and no submission that signals it has been made (such as a value
+  // the caller signals from the host after this returns) the submission is
+  // deferred to the pending queue and issued once it can wait on the device.
+  iree_status_t status = iree_ok_status();
+  if (iree_hal_cuda_semaphore_list_can_enqueue_wait(wait_semaphore_list)) {
+    status = iree_hal_cuda_device_issue_execute(
+        device, queue, wait_semaphore_list, signal_semaphore_list,
+        command_buffer_count, command_buffers);
+  } else {
+    status = iree_hal_cuda_pending_queue_enqueue(
+        device->pending_queue, queue, wait_semaphore_list,
+        signal_semaphore_list, command_buffer_count, command_buffers,
+        /*dealloca_buffer=*/NULL);
   }
 
-  // TODO(thomasraoux): implement semaphores - for now this conservatively
-  // synchronizes after every submit.
-  IREE_TRACE_ZONE_BEGIN_NAMED(z0, "cuStreamSynchronize");
-  CUDA_RETURN_IF_ERROR(device->context_wrapper.syms,
-                       cuStreamSynchronize(device->stream),
-                       "cuStreamSynchronize");
-  iree_hal_cuda_tracing_context_collect(device->tracing_context);
   IREE_TRACE_ZONE_END(z0);
+  return status;
+}
 
-  return iree_ok_status();
+// Returns true if |buffer| is device-local memory that cannot be mapped and
+// transfers from/to host memory benefit from staging.
+static bool iree_hal_cuda_device_is_stageable_buffer(
+    iree_hal_buffer_t* buffer) {
+  if (!iree_hal_cuda_buffer_isa(iree_hal_buffer_allocated_buffer(buffer))) {
+    return false;
+  }
+  return !iree_all_bits_set(iree_hal_buffer_memory_type(buffer),
+                            IREE_HAL_MEMORY_TYPE_HOST_VISIBLE) ||
+         !iree_all_bits_set(iree_hal_buffer_allowed_usage(buffer),
+                            IREE_HAL_BUFFER_USAGE_MAPPING);
+}
+
+// Returns the device pointer to |offset| in |buffer|.
+static CUdeviceptr iree_hal_cuda_device_buffer_pointer(
+    iree_hal_buffer_t* buffer, iree_device_size_t offset) {
+  return iree_hal_cuda_buffer_device_pointer(
+             iree_hal_buffer_allocated_buffer(buffer)) +
+         iree_hal_buffer_byte_offset(buffer) + offset;
+}
+
+static iree_status_t iree_hal_cuda_device_transfer_range(
+    iree_hal_device_t* base_device, iree_hal_transfer_buffer_t source,
+    iree_device_size_t source_offset, iree_hal_transfer_buffer_t target,
+    iree_device_size_t target_offset, iree_device_size_t data_length,
+    iree_hal_transfer_buffer_flags_t flags, iree_timeout_t timeout) {
+  iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
+
+  // Large transfers between pageable host memory and device-local memory are
+  // pipelined through the pinned staging buffer on the transfer queue. The
+  // generic path would allocate, fill and free a pinned buffer per transfer.
+  // Like the generic path the transfer is unordered with respect to in-flight
+  // work using the buffers.
+  const bool use_staging =
+      device->params.staging_buffer_chunk_count > 0 &&
+      data_length != IREE_WHOLE_BUFFER &&
+      data_length > device->params.staging_transfer_threshold;
+  if (use_staging && !source.device_buffer && target.device_buffer &&
+      iree_hal_cuda_device_is_stageable_buffer(target.device_buffer)) {
+    IREE_RETURN_IF_ERROR(iree_hal_buffer_validate_range(
+        target.device_buffer, target_offset, data_length));
+    iree_hal_cuda_queue_t* queue = iree_hal_cuda_device_select_queue(
+        device, IREE_HAL_QUEUE_AFFINITY_ANY,
+        IREE_HAL_COMMAND_CATEGORY_TRANSFER);
+    return iree_hal_cuda_staging_buffer_upload(
+        &device->staging_buffer, queue->stream,
+        (const uint8_t*)source.host_buffer.data + source_offset,
+        iree_hal_cuda_device_buffer_pointer(target.device_buffer,
+                                            target_offset),
+        data_length);
+  } else if (use_staging && source.device_buffer && !target.device_buffer &&
+             iree_hal_cuda_device_is_stageable_buffer(source.device_buffer)) {
+    IREE_RETURN_IF_ERROR(iree_hal_buffer_validate_range(
+        source.device_buffer, source_offset, data_length));
+    iree_hal_cuda_queue_t* queue = iree_hal_cuda_device_select_queue(
+        device, IREE_HAL_QUEUE_AFFINITY_ANY,
+        IREE_HAL_COMMAND_CATEGORY_TRANSFER);
+    return iree_hal_cuda_staging_buffer_download(
+        &device->staging_buffer, queue->stream,
+        iree_hal_cuda_device_buffer_pointer(source.device_buffer,
+                                            source_offset),
+        target.host_buffer.data + target_offset, data_length);
+  }
+
+  return iree_hal_device_submit_transfer_range_and_wait(
+      base_device, source, source_offset, target, target_offset, data_length,
+      flags, timeout);
 }
 
 static iree_status_t iree_hal_cuda_device_queue_flush(
@@ -497,8 +1083,55 @@ static iree_status_t iree_hal_cuda_device_queue_flush(
 static iree_status_t iree_hal_cuda_device_wait_semaphores(
     iree_hal_device_t* base_device, iree_hal_wait_mode_t wait_mode,
     const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout) {
-  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                          "semaphore not implemented");
+  const iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
+  if (semaphore_list.count == 0) return iree_ok_status();
+
+  // Waiting for all is a wait on each in turn against the same deadline.
+  if (wait_mode == IREE_HAL_WAIT_MODE_ALL || semaphore_list.count == 1) {
+    for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+      IREE_RETURN_IF_ERROR(iree_hal_semaphore_wait(
+          semaphore_list.semaphores[i], semaphore_list.payload_values[i],
+          iree_make_deadline(deadline_ns)));
+    }
+    return iree_ok_status();
+  }
+
+  // Waiting for any polls the semaphores until one is reached as there is no
+  // CUDA primitive for waiting on one of multiple events.
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status = iree_ok_status();
+  for (;;) {
+    bool any_signaled = false;
+    for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+      uint64_t current_value = 0;
+      status = iree_hal_semaphore_query(semaphore_list.semaphores[i],
+                                        &current_value);
+      if (!iree_status_is_ok(status)) break;
+      if (current_value >= semaphore_list.payload_values[i]) {
+        any_signaled = true;
+        break;
+      }
+    }
+    if (!iree_status_is_ok(status)) {
+      // Failed; return an error to tell callers to query for it.
+      iree_status_ignore(status);
+      status = iree_status_from_code(IREE_STATUS_ABORTED);
+      break;
+    } else if (any_signaled) {
+      break;
+    }
+    iree_time_t now_ns = iree_time_now();
+    if (now_ns >= deadline_ns) {
+      status = iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+      break;
+    }
+    iree_time_t poll_deadline_ns =
+        now_ns + IREE_HAL_CUDA_DEVICE_WAIT_ANY_POLL_INTERVAL_NS;
+    iree_wait_until(poll_deadline_ns < deadline_ns ? poll_deadline_ns
+                                                   : deadline_ns);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 static iree_status_t iree_hal_cuda_device_profiling_begin(
@@ -533,7 +1166,7 @@ static const iree_hal_device_vtable_t iree_hal_cuda_device_vtable = {
     .create_semaphore = iree_hal_cuda_device_create_semaphore,
     .query_semaphore_compatibility =
         iree_hal_cuda_device_query_semaphore_compatibility,
-    .transfer_range = iree_hal_device_submit_transfer_range_and_wait,
+    .transfer_range = iree_hal_cuda_device_transfer_range,
     .queue_alloca = iree_hal_cuda_device_queue_alloca,
     .queue_dealloca = iree_hal_cuda_device_queue_dealloca,
     .queue_execute = iree_hal_cuda_device_queue_execute,
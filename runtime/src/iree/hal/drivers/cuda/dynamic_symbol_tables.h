@@ -33,6 +33,8 @@ CU_PFN_DECL(cuGraphAddKernelNode, CUgraphNode*, CUgraph, const CUgraphNode*,
 CU_PFN_DECL(cuGraphCreate, CUgraph*, unsigned int)
 CU_PFN_DECL(cuGraphDestroy, CUgraph)
 CU_PFN_DECL(cuGraphExecDestroy, CUgraphExec)
+CU_PFN_DECL_V1(cuGraphExecUpdate, CUgraphExec, CUgraph, CUgraphNode*,
+               CUgraphExecUpdateResult*)
 CU_PFN_DECL(cuGraphGetNodes, CUgraph, CUgraphNode*, size_t*)
 CU_PFN_DECL(cuGraphInstantiate, CUgraphExec*, CUgraph, CUgraphNode*, char*,
             size_t)
@@ -42,6 +44,13 @@ CU_PFN_DECL(cuMemAllocManaged, CUdeviceptr*, size_t, unsigned int)
 CU_PFN_DECL(cuMemPrefetchAsync, CUdeviceptr, size_t, CUdevice, CUstream)
 CU_PFN_DECL(cuMemAlloc, CUdeviceptr*, size_t)
 CU_PFN_DECL(cuMemFree, CUdeviceptr)
+CU_PFN_DECL(cuMemAllocFromPoolAsync, CUdeviceptr*, size_t, CUmemoryPool,
+            CUstream)
+CU_PFN_DECL(cuMemFreeAsync, CUdeviceptr, CUstream)
+CU_PFN_DECL(cuMemPoolCreate, CUmemoryPool*, const CUmemPoolProps*)
+CU_PFN_DECL(cuMemPoolDestroy, CUmemoryPool)
+CU_PFN_DECL(cuMemPoolSetAttribute, CUmemoryPool, CUmemPool_attribute, void*)
+CU_PFN_DECL(cuMemPoolTrimTo, CUmemoryPool, size_t)
 CU_PFN_DECL(cuMemFreeHost, void*)
 CU_PFN_DECL(cuMemHostAlloc, void**, size_t, unsigned int)
 CU_PFN_DECL(cuMemHostRegister, void*, size_t, unsigned int)
@@ -63,6 +72,7 @@ CU_PFN_DECL(cuMemsetD8Async, unsigned long long, unsigned char, size_t,
             CUstream)
 CU_PFN_DECL(cuMemcpyAsync, CUdeviceptr, CUdeviceptr, size_t, CUstream)
 CU_PFN_DECL(cuMemcpyHtoDAsync_v2, CUdeviceptr, const void*, size_t, CUstream)
+CU_PFN_DECL(cuMemcpyDtoHAsync_v2, void*, CUdeviceptr, size_t, CUstream)
 CU_PFN_DECL(cuFuncSetAttribute, CUfunction, CUfunction_attribute, int)
 CU_PFN_DECL(cuLaunchKernel, CUfunction, unsigned int, unsigned int,
             unsigned int, unsigned int, unsigned int, unsigned int,
@@ -44,10 +44,17 @@ static iree_status_t iree_hal_cuda_dynamic_symbols_resolve_all(
     iree_dynamic_library_lookup_symbol(syms->cuda_library, kNameV2, &funV2); \
     if (funV2) syms->cudaSymbolName = funV2;                                 \
   }
+#define CU_PFN_DECL_V1(cudaSymbolName, ...)                         \
+  {                                                                 \
+    static const char* kName = #cudaSymbolName;                     \
+    IREE_RETURN_IF_ERROR(iree_dynamic_library_lookup_symbol(        \
+        syms->cuda_library, kName, (void**)&syms->cudaSymbolName)); \
+  }
 #define NCCL_PFN_DECL(ncclSymbolName, ...)
 #define NCCL_PFN_DECL_STR_RETURN(ncclSymbolName, ...)
 #include "iree/hal/drivers/cuda/dynamic_symbol_tables.h"  // IWYU pragma: keep
 #undef CU_PFN_DECL
+#undef CU_PFN_DECL_V1
 #undef NCCL_PFN_DECL
 #undef NCCL_PFN_DECL_STR_RETURN
   return iree_ok_status();
@@ -57,6 +64,7 @@ static iree_status_t iree_hal_cuda_dynamic_symbols_resolve_all(
 static iree_status_t iree_hal_cuda_nccl_dynamic_symbols_resolve_all(
     iree_hal_cuda_dynamic_symbols_t* syms) {
 #define CU_PFN_DECL(cudaSymbolName, ...)
+#define CU_PFN_DECL_V1(cudaSymbolName, ...)
 #define NCCL_PFN_DECL(ncclSymbolName, ...)                          \
   {                                                                 \
     static const char* kName = #ncclSymbolName;                     \
@@ -71,6 +79,7 @@ static iree_status_t iree_hal_cuda_nccl_dynamic_symbols_resolve_all(
   }
 #include "iree/hal/drivers/cuda/dynamic_symbol_tables.h"  // IWYU pragma: keep
 #undef CU_PFN_DECL
+#undef CU_PFN_DECL_V1
 #undef NCCL_PFN_DECL
 #undef NCCL_PFN_DECL_STR_RETURN
   return iree_ok_status();
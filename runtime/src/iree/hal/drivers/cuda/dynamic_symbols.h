@@ -19,19 +19,24 @@ extern "C" {
 // DynamicSymbols allow loading dynamically a subset of CUDA driver and NCCL
 // API. It loads all the function declared in `dynamic_symbol_tables.h` and fail
 // if any of the symbol is not available. The functions signatures are matching
-// the declarations in `cuda.h` and `nccl.h"`.
+// the declarations in `cuda.h` and `nccl.h"`. Symbols declared with
+// CU_PFN_DECL_V1 have a `_v2` variant with a different signature in newer
+// drivers and always resolve to the unversioned entry point.
 typedef struct iree_hal_cuda_dynamic_symbols_t {
   iree_dynamic_library_t* cuda_library;
   iree_dynamic_library_t* nccl_library;
 
 #define CU_PFN_DECL(cudaSymbolName, ...) \
   CUresult (*cudaSymbolName)(__VA_ARGS__);
+#define CU_PFN_DECL_V1(cudaSymbolName, ...) \
+  CUresult (*cudaSymbolName)(__VA_ARGS__);
 #define NCCL_PFN_DECL(ncclSymbolName, ...) \
   ncclResult_t (*ncclSymbolName)(__VA_ARGS__);
 #define NCCL_PFN_DECL_STR_RETURN(ncclSymbolName, ...) \
   const char* (*ncclSymbolName)(__VA_ARGS__);
 #include "iree/hal/drivers/cuda/dynamic_symbol_tables.h"  // IWYU pragma: export
 #undef CU_PFN_DECL
+#undef CU_PFN_DECL_V1
 #undef NCCL_PFN_DECL
 #undef NCCL_PFN_DECL_STR_RETURN
 } iree_hal_cuda_dynamic_symbols_t;
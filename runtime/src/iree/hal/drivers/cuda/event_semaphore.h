@@ -7,6 +7,7 @@
 #ifndef IREE_HAL_DRIVERS_CUDA_SEMAPHORE_H_
 #define IREE_HAL_DRIVERS_CUDA_SEMAPHORE_H_
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "iree/base/api.h"
@@ -18,11 +19,37 @@
 extern "C" {
 #endif  // __cplusplus
 
-// Create a cuda allocator.
+// Creates a timeline semaphore that can be signaled from the host or
+// asynchronously from a CUDA stream. Device-side signals are tracked as CUDA
+// events recorded on the signaling stream and the semaphore value advances as
+// the events complete.
 iree_status_t iree_hal_cuda_semaphore_create(
     iree_hal_cuda_context_wrapper_t* context, uint64_t initial_value,
     iree_hal_semaphore_t** out_semaphore);
 
+// Returns true if |semaphore| is a CUDA event semaphore.
+bool iree_hal_cuda_semaphore_isa(iree_hal_semaphore_t* semaphore);
+
+// Enqueues a signal of |semaphore| to |value| once all work previously
+// submitted to |stream| has completed.
+iree_status_t iree_hal_cuda_semaphore_enqueue_signal(
+    iree_hal_semaphore_t* semaphore, uint64_t value, CUstream stream);
+
+// Makes all future work submitted to |stream| wait until |semaphore| reaches
+// |value|. The wait is performed on the device and never blocks the calling
+// thread. Fails with IREE_STATUS_FAILED_PRECONDITION if the value has not been
+// reached and no device-side signal of it has been enqueued yet; callers must
+// check with iree_hal_cuda_semaphore_list_can_enqueue_wait first.
+iree_status_t iree_hal_cuda_semaphore_enqueue_wait(
+    iree_hal_semaphore_t* semaphore, uint64_t value, CUstream stream);
+
+// Returns true if waits on all semaphores in |semaphore_list| can be made
+// without blocking the host: each value has been reached, its semaphore has
+// failed, or (for CUDA semaphores) a device-side signal reaching it has been
+// enqueued. Once true this remains true for the same list.
+bool iree_hal_cuda_semaphore_list_can_enqueue_wait(
+    const iree_hal_semaphore_list_t semaphore_list);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -41,7 +41,13 @@ typedef struct iree_hal_cuda_graph_command_buffer_t {
   // asynchronous operations.
   iree_arena_allocator_t arena;
 
+  // Graph being recorded between begin and end. Destroyed once the exec has
+  // been instantiated or updated from it.
   CUgraph graph;
+
+  // Executable graph launched on submission. Retained across re-recordings so
+  // that graphs with an unchanged topology can be updated in-place with
+  // cuGraphExecUpdate instead of paying for a full cuGraphInstantiate.
   CUgraphExec exec;
 
   // Keep track of the last node added to the command buffer as we are currently
@@ -221,15 +227,55 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_flush_collectives(
   return status;
 }
 
+// Drops all state from a prior recording except for the exec, which is
+// retained for a potential in-place update when the new recording ends.
+static iree_status_t iree_hal_cuda_graph_command_buffer_reset(
+    iree_hal_cuda_graph_command_buffer_t* command_buffer) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  if (command_buffer->graph != NULL) {
+    CUDA_IGNORE_ERROR(command_buffer->context->syms,
+                      cuGraphDestroy(command_buffer->graph));
+    command_buffer->graph = NULL;
+  }
+  command_buffer->last_node = NULL;
+
+  // Resources from the prior recording are released by swapping in a new
+  // resource set. The collective batch references the resource set and arena
+  // and is rebuilt on top of the new ones.
+  iree_hal_resource_set_t* resource_set = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_resource_set_allocate(command_buffer->arena.block_pool,
+                                         &resource_set));
+  iree_hal_collective_batch_deinitialize(&command_buffer->collective_batch);
+  iree_hal_resource_set_free(command_buffer->resource_set);
+  command_buffer->resource_set = resource_set;
+  iree_arena_reset(&command_buffer->arena);
+  iree_hal_collective_batch_initialize(&command_buffer->arena,
+                                       command_buffer->resource_set,
+                                       &command_buffer->collective_batch);
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 static iree_status_t iree_hal_cuda_graph_command_buffer_begin(
     iree_hal_command_buffer_t* base_command_buffer) {
   iree_hal_cuda_graph_command_buffer_t* command_buffer =
       iree_hal_cuda_graph_command_buffer_cast(base_command_buffer);
 
-  // Fail if re-recording.
-  if (command_buffer->graph != NULL) {
+  // One-shot command buffers may only be recorded once; reusable ones keep
+  // their exec around so that end can try to update it in-place.
+  if (command_buffer->exec != NULL &&
+      iree_all_bits_set(command_buffer->base.mode,
+                        IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT)) {
     return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
-                            "command buffer cannot be re-recorded");
+                            "one-shot command buffers cannot be re-recorded");
+  }
+
+  if (command_buffer->exec != NULL || command_buffer->graph != NULL) {
+    IREE_RETURN_IF_ERROR(
+        iree_hal_cuda_graph_command_buffer_reset(command_buffer));
   }
 
   // Create a new empty graph to record into.
@@ -240,6 +286,23 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_begin(
   return iree_ok_status();
 }
 
+// Updates the existing |command_buffer| exec from the recorded graph.
+// Returns false if the graph topology or node types changed such that the
+// exec must be reinstantiated.
+static bool iree_hal_cuda_graph_command_buffer_try_update_exec(
+    iree_hal_cuda_graph_command_buffer_t* command_buffer) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  CUgraphNode error_node = NULL;
+  CUgraphExecUpdateResult update_result = CU_GRAPH_EXEC_UPDATE_SUCCESS;
+  CUresult result = command_buffer->context->syms->cuGraphExecUpdate(
+      command_buffer->exec, command_buffer->graph, &error_node, &update_result);
+  bool updated =
+      result == CUDA_SUCCESS && update_result == CU_GRAPH_EXEC_UPDATE_SUCCESS;
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, updated ? 1 : 0);
+  IREE_TRACE_ZONE_END(z0);
+  return updated;
+}
+
 static iree_status_t iree_hal_cuda_graph_command_buffer_end(
     iree_hal_command_buffer_t* base_command_buffer) {
   iree_hal_cuda_graph_command_buffer_t* command_buffer =
@@ -252,7 +315,24 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_end(
   // Reset state used during recording.
   command_buffer->last_node = NULL;
 
+  // When re-recording try to update the exec from the last recording in-place.
+  // This only succeeds when the topology is unchanged (the common case of the
+  // same commands recorded with different buffers or push constants) and is
+  // significantly cheaper than instantiating a new exec.
+  if (command_buffer->exec != NULL) {
+    if (iree_hal_cuda_graph_command_buffer_try_update_exec(command_buffer)) {
+      CUDA_IGNORE_ERROR(command_buffer->context->syms,
+                        cuGraphDestroy(command_buffer->graph));
+      command_buffer->graph = NULL;
+      return iree_ok_status();
+    }
+    CUDA_IGNORE_ERROR(command_buffer->context->syms,
+                      cuGraphExecDestroy(command_buffer->exec));
+    command_buffer->exec = NULL;
+  }
+
   // Compile the graph.
+  IREE_TRACE_ZONE_BEGIN_NAMED(z0, "cuGraphInstantiate");
   CUgraphNode error_node = NULL;
   iree_status_t status =
       CU_RESULT_TO_STATUS(command_buffer->context->syms,
@@ -265,9 +345,12 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_end(
     CUDA_IGNORE_ERROR(command_buffer->context->syms,
                       cuGraphDestroy(command_buffer->graph));
     command_buffer->graph = NULL;
+  } else {
+    command_buffer->exec = NULL;
   }
+  IREE_TRACE_ZONE_END(z0);
 
-  return iree_ok_status();
+  return status;
 }
 
 static void iree_hal_cuda_graph_command_buffer_begin_debug_group(
@@ -584,6 +667,10 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_push_descriptor_set(
   IREE_ASSERT_LT(binding_count, IREE_HAL_CUDA_MAX_BINDING_COUNT,
                  "binding count larger than the max expected");
 
+  IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert_strided(
+      command_buffer->resource_set, binding_count, &bindings[0].buffer,
+      sizeof(bindings[0])));
+
   for (iree_host_size_t i = 0; i < binding_count; i++) {
     const iree_hal_descriptor_set_binding_t* binding =
         &bindings[binding_used[i].index];
@@ -595,10 +682,6 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_push_descriptor_set(
             : 0;
     *((CUdeviceptr*)command_buffer->current_descriptor[i + base_binding]) =
         device_ptr;
-    if (binding->buffer) {
-      IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
-          command_buffer->resource_set, 1, &binding->buffer));
-    }
   }
 
   return iree_ok_status();
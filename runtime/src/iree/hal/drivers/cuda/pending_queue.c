@@ -0,0 +1,429 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/cuda/pending_queue.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/threading.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/drivers/cuda/event_semaphore.h"
+#include "iree/hal/drivers/cuda/status_util.h"
+#include "iree/hal/utils/semaphore_base.h"
+
+// Interval at which the worker re-evaluates pending submissions when it has
+// not been woken. CUDA semaphores only notify timepoints when their value is
+// observed to advance so a value reached purely on the device may otherwise go
+// unnoticed until someone queries the semaphore.
+#define IREE_HAL_CUDA_PENDING_QUEUE_POLL_INTERVAL_NS (1000 * 1000)
+
+//===----------------------------------------------------------------------===//
+// iree_hal_cuda_pending_submission_t
+//===----------------------------------------------------------------------===//
+
+// A deferred submission and its retained resources. All arrays are allocated
+// inline after the struct.
+typedef struct iree_hal_cuda_pending_submission_t {
+  struct iree_hal_cuda_pending_submission_t* next;
+  void* queue;
+  iree_hal_semaphore_list_t wait_semaphore_list;
+  iree_hal_semaphore_list_t signal_semaphore_list;
+  iree_host_size_t command_buffer_count;
+  iree_hal_command_buffer_t** command_buffers;
+  iree_hal_buffer_t* dealloca_buffer;
+  // One timepoint per wait semaphore used to wake the worker. Timepoints are
+  // only acquired for waits that could not be enqueued at submission time.
+  iree_hal_semaphore_timepoint_t* timepoints;
+  bool* timepoint_acquired;
+} iree_hal_cuda_pending_submission_t;
+
+// Fails all semaphores in |semaphore_list| with |status|, consuming it.
+static void iree_hal_cuda_pending_queue_fail_semaphores(
+    const iree_hal_semaphore_list_t semaphore_list, iree_status_t status) {
+  for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+    iree_hal_semaphore_fail(semaphore_list.semaphores[i],
+                            iree_status_clone(status));
+  }
+  iree_status_ignore(status);
+}
+
+// Cancels the timepoints acquired by |submission|. Once this returns no
+// timepoint callback for the submission is running or will be made.
+static void iree_hal_cuda_pending_submission_cancel_timepoints(
+    iree_hal_cuda_pending_submission_t* submission) {
+  for (iree_host_size_t i = 0; i < submission->wait_semaphore_list.count;
+       ++i) {
+    if (!submission->timepoint_acquired[i]) continue;
+    iree_hal_semaphore_cancel_timepoint(
+        submission->wait_semaphore_list.semaphores[i],
+        &submission->timepoints[i]);
+    submission->timepoint_acquired[i] = false;
+  }
+}
+
+// Cancels any outstanding timepoints and releases all retained resources.
+static void iree_hal_cuda_pending_submission_free(
+    iree_hal_cuda_pending_submission_t* submission,
+    iree_allocator_t host_allocator) {
+  iree_hal_cuda_pending_submission_cancel_timepoints(submission);
+  for (iree_host_size_t i = 0; i < submission->wait_semaphore_list.count;
+       ++i) {
+    iree_hal_semaphore_release(submission->wait_semaphore_list.semaphores[i]);
+  }
+  for (iree_host_size_t i = 0; i < submission->signal_semaphore_list.count;
+       ++i) {
+    iree_hal_semaphore_release(
+        submission->signal_semaphore_list.semaphores[i]);
+  }
+  for (iree_host_size_t i = 0; i < submission->command_buffer_count; ++i) {
+    iree_hal_command_buffer_release(submission->command_buffers[i]);
+  }
+  iree_hal_buffer_release(submission->dealloca_buffer);
+  iree_allocator_free(host_allocator, submission);
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_cuda_pending_queue_t
+//===----------------------------------------------------------------------===//
+
+struct iree_hal_cuda_pending_queue_t {
+  iree_hal_cuda_context_wrapper_t* context;
+  iree_hal_cuda_pending_queue_issue_t issue;
+  iree_allocator_t host_allocator;
+
+  // Thread issuing submissions as they become ready.
+  iree_thread_t* thread;
+
+  // Posted when a submission is enqueued, a wait semaphore timepoint is
+  // reached, a device signal is enqueued, exit is requested, or the worker
+  // has exited.
+  iree_notification_t notification;
+
+  // Guards the pending list and exit flags.
+  iree_slim_mutex_t mutex;
+  // Pending submissions in submission order.
+  iree_hal_cuda_pending_submission_t* head IREE_GUARDED_BY(mutex);
+  iree_hal_cuda_pending_submission_t* tail IREE_GUARDED_BY(mutex);
+  bool exit_requested IREE_GUARDED_BY(mutex);
+  // Set by the worker once it will no longer touch the pending queue.
+  bool exited IREE_GUARDED_BY(mutex);
+};
+
+// Wakes the worker when a wait semaphore reaches the waited value or fails.
+// Runs on whichever thread notified the semaphore and must not block.
+static iree_status_t iree_hal_cuda_pending_queue_timepoint_callback(
+    void* user_data, iree_hal_semaphore_t* semaphore, uint64_t value,
+    iree_status_code_t status_code) {
+  iree_hal_cuda_pending_queue_t* pending_queue =
+      (iree_hal_cuda_pending_queue_t*)user_data;
+  iree_notification_post(&pending_queue->notification, IREE_ALL_WAITERS);
+  return iree_ok_status();
+}
+
+// Unlinks and returns the pending submissions that can be issued in submission
+// order. If |take_all| is set all submissions are returned regardless of their
+// waits. The pending queue mutex must be held.
+static iree_hal_cuda_pending_submission_t*
+iree_hal_cuda_pending_queue_take_ready_unsafe(
+    iree_hal_cuda_pending_queue_t* pending_queue, bool take_all) {
+  iree_hal_cuda_pending_submission_t* ready_head = NULL;
+  iree_hal_cuda_pending_submission_t* ready_tail = NULL;
+  iree_hal_cuda_pending_submission_t* prev = NULL;
+  iree_hal_cuda_pending_submission_t* submission = pending_queue->head;
+  while (submission) {
+    iree_hal_cuda_pending_submission_t* next = submission->next;
+    if (take_all || iree_hal_cuda_semaphore_list_can_enqueue_wait(
+                        submission->wait_semaphore_list)) {
+      if (prev) {
+        prev->next = next;
+      } else {
+        pending_queue->head = next;
+      }
+      if (pending_queue->tail == submission) pending_queue->tail = prev;
+      submission->next = NULL;
+      if (ready_tail) {
+        ready_tail->next = submission;
+      } else {
+        ready_head = submission;
+      }
+      ready_tail = submission;
+    } else {
+      prev = submission;
+    }
+    submission = next;
+  }
+  return ready_head;
+}
+
+// Issues each submission in the |ready| list and frees it. If |status| is not
+// OK the submissions are not issued and their signal semaphores are failed
+// with it instead. Consumes |status|.
+static void iree_hal_cuda_pending_queue_issue_list(
+    iree_hal_cuda_pending_queue_t* pending_queue,
+    iree_hal_cuda_pending_submission_t* ready, iree_status_t status) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  while (ready) {
+    iree_hal_cuda_pending_submission_t* submission = ready;
+    ready = submission->next;
+
+    // Timepoints must not fire once the submission has been handed off.
+    iree_hal_cuda_pending_submission_cancel_timepoints(submission);
+
+    iree_status_t issue_status = iree_status_clone(status);
+    if (iree_status_is_ok(issue_status)) {
+      issue_status = pending_queue->issue.fn(
+          pending_queue->issue.user_data, submission->queue,
+          submission->wait_semaphore_list, submission->signal_semaphore_list,
+          submission->command_buffer_count,
+          submission->command_buffers, submission->dealloca_buffer);
+    }
+    if (!iree_status_is_ok(issue_status)) {
+      iree_hal_cuda_pending_queue_fail_semaphores(
+          submission->signal_semaphore_list, issue_status);
+    }
+    iree_hal_cuda_pending_submission_free(submission,
+                                          pending_queue->host_allocator);
+  }
+  iree_status_ignore(status);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static int iree_hal_cuda_pending_queue_thread_main(void* entry_arg) {
+  iree_hal_cuda_pending_queue_t* pending_queue =
+      (iree_hal_cuda_pending_queue_t*)entry_arg;
+
+  // CUDA contexts are current per-thread. If this fails all submissions fail.
+  iree_status_t context_status = CU_RESULT_TO_STATUS(
+      pending_queue->context->syms,
+      cuCtxSetCurrent(pending_queue->context->cu_context), "cuCtxSetCurrent");
+
+  while (true) {
+    iree_wait_token_t wait_token =
+        iree_notification_prepare_wait(&pending_queue->notification);
+
+    iree_slim_mutex_lock(&pending_queue->mutex);
+    const bool exit_requested = pending_queue->exit_requested;
+    iree_hal_cuda_pending_submission_t* ready =
+        iree_hal_cuda_pending_queue_take_ready_unsafe(pending_queue,
+                                                      exit_requested);
+    const bool has_pending = pending_queue->head != NULL;
+    iree_slim_mutex_unlock(&pending_queue->mutex);
+
+    if (ready) {
+      // Issuing may make other submissions ready so check again immediately.
+      iree_notification_cancel_wait(&pending_queue->notification);
+      iree_hal_cuda_pending_queue_issue_list(
+          pending_queue, ready,
+          exit_requested
+              ? iree_make_status(IREE_STATUS_CANCELLED,
+                                 "device destroyed with pending submissions")
+              : iree_status_clone(context_status));
+      continue;
+    } else if (exit_requested) {
+      iree_notification_cancel_wait(&pending_queue->notification);
+      break;
+    }
+
+    iree_time_t deadline_ns =
+        has_pending
+            ? iree_time_now() + IREE_HAL_CUDA_PENDING_QUEUE_POLL_INTERVAL_NS
+            : IREE_TIME_INFINITE_FUTURE;
+    iree_notification_commit_wait(&pending_queue->notification, wait_token,
+                                  IREE_DURATION_ZERO, deadline_ns);
+  }
+
+  iree_status_ignore(context_status);
+
+  iree_slim_mutex_lock(&pending_queue->mutex);
+  pending_queue->exited = true;
+  iree_slim_mutex_unlock(&pending_queue->mutex);
+  iree_notification_post(&pending_queue->notification, IREE_ALL_WAITERS);
+  return 0;
+}
+
+// Returns true if the worker has exited.
+// Used with iree_condition_fn_t and must match that signature.
+static bool iree_hal_cuda_pending_queue_has_exited(
+    iree_hal_cuda_pending_queue_t* pending_queue) {
+  iree_slim_mutex_lock(&pending_queue->mutex);
+  const bool exited = pending_queue->exited;
+  iree_slim_mutex_unlock(&pending_queue->mutex);
+  return exited;
+}
+
+iree_status_t iree_hal_cuda_pending_queue_create(
+    iree_hal_cuda_context_wrapper_t* context,
+    iree_hal_cuda_pending_queue_issue_t issue, iree_allocator_t host_allocator,
+    iree_hal_cuda_pending_queue_t** out_pending_queue) {
+  IREE_ASSERT_ARGUMENT(context);
+  IREE_ASSERT_ARGUMENT(issue.fn);
+  IREE_ASSERT_ARGUMENT(out_pending_queue);
+  *out_pending_queue = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_cuda_pending_queue_t* pending_queue = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*pending_queue),
+                                (void**)&pending_queue));
+  memset(pending_queue, 0, sizeof(*pending_queue));
+  pending_queue->context = context;
+  pending_queue->issue = issue;
+  pending_queue->host_allocator = host_allocator;
+  iree_notification_initialize(&pending_queue->notification);
+  iree_slim_mutex_initialize(&pending_queue->mutex);
+
+  iree_thread_create_params_t params;
+  memset(&params, 0, sizeof(params));
+  params.name = IREE_SV("iree-cuda-pending-queue");
+  iree_status_t status = iree_thread_create(
+      iree_hal_cuda_pending_queue_thread_main, pending_queue, params,
+      host_allocator, &pending_queue->thread);
+
+  if (iree_status_is_ok(status)) {
+    *out_pending_queue = pending_queue;
+  } else {
+    iree_hal_cuda_pending_queue_destroy(pending_queue);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+void iree_hal_cuda_pending_queue_destroy(
+    iree_hal_cuda_pending_queue_t* pending_queue) {
+  if (!pending_queue) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  if (pending_queue->thread) {
+    // The worker fails all remaining submissions before it exits.
+    iree_slim_mutex_lock(&pending_queue->mutex);
+    pending_queue->exit_requested = true;
+    iree_slim_mutex_unlock(&pending_queue->mutex);
+    iree_notification_post(&pending_queue->notification, IREE_ALL_WAITERS);
+
+    // Releasing the thread only joins it if the thread has already dropped its
+    // own reference on startup so wait for the worker to exit first. This is
+    // then the last reference and the join ensures the worker is no longer
+    // using the notification when it is deinitialized.
+    iree_notification_await(
+        &pending_queue->notification,
+        (iree_condition_fn_t)iree_hal_cuda_pending_queue_has_exited,
+        pending_queue, iree_infinite_timeout());
+    iree_thread_release(pending_queue->thread);
+  }
+
+  iree_slim_mutex_deinitialize(&pending_queue->mutex);
+  iree_notification_deinitialize(&pending_queue->notification);
+  iree_allocator_free(pending_queue->host_allocator, pending_queue);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+iree_status_t iree_hal_cuda_pending_queue_enqueue(
+    iree_hal_cuda_pending_queue_t* pending_queue, void* queue,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_host_size_t command_buffer_count,
+    iree_hal_command_buffer_t* const* command_buffers,
+    iree_hal_buffer_t* dealloca_buffer) {
+  IREE_ASSERT_ARGUMENT(pending_queue);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  const iree_host_size_t wait_count = wait_semaphore_list.count;
+  const iree_host_size_t signal_count = signal_semaphore_list.count;
+  iree_hal_cuda_pending_submission_t* submission = NULL;
+  const iree_host_size_t total_size =
+      iree_sizeof_struct(*submission) +
+      wait_count * (sizeof(iree_hal_semaphore_t*) + sizeof(uint64_t) +
+                    sizeof(iree_hal_semaphore_timepoint_t)) +
+      signal_count * (sizeof(iree_hal_semaphore_t*) + sizeof(uint64_t)) +
+      command_buffer_count * sizeof(iree_hal_command_buffer_t*) +
+      wait_count * sizeof(bool);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(pending_queue->host_allocator, total_size,
+                                (void**)&submission));
+  memset(submission, 0, total_size);
+
+  // Timepoints and payload values are laid out first to keep them aligned.
+  uint8_t* ptr = (uint8_t*)submission + iree_sizeof_struct(*submission);
+  submission->timepoints = (iree_hal_semaphore_timepoint_t*)ptr;
+  ptr += wait_count * sizeof(iree_hal_semaphore_timepoint_t);
+  submission->wait_semaphore_list.count = wait_count;
+  submission->wait_semaphore_list.payload_values = (uint64_t*)ptr;
+  ptr += wait_count * sizeof(uint64_t);
+  submission->signal_semaphore_list.count = signal_count;
+  submission->signal_semaphore_list.payload_values = (uint64_t*)ptr;
+  ptr += signal_count * sizeof(uint64_t);
+  submission->wait_semaphore_list.semaphores = (iree_hal_semaphore_t**)ptr;
+  ptr += wait_count * sizeof(iree_hal_semaphore_t*);
+  submission->signal_semaphore_list.semaphores = (iree_hal_semaphore_t**)ptr;
+  ptr += signal_count * sizeof(iree_hal_semaphore_t*);
+  submission->command_buffers = (iree_hal_command_buffer_t**)ptr;
+  ptr += command_buffer_count * sizeof(iree_hal_command_buffer_t*);
+  submission->timepoint_acquired = (bool*)ptr;
+
+  submission->queue = queue;
+  for (iree_host_size_t i = 0; i < wait_count; ++i) {
+    submission->wait_semaphore_list.semaphores[i] =
+        wait_semaphore_list.semaphores[i];
+    submission->wait_semaphore_list.payload_values[i] =
+        wait_semaphore_list.payload_values[i];
+    iree_hal_semaphore_retain(wait_semaphore_list.semaphores[i]);
+  }
+  for (iree_host_size_t i = 0; i < signal_count; ++i) {
+    submission->signal_semaphore_list.semaphores[i] =
+        signal_semaphore_list.semaphores[i];
+    submission->signal_semaphore_list.payload_values[i] =
+        signal_semaphore_list.payload_values[i];
+    iree_hal_semaphore_retain(signal_semaphore_list.semaphores[i]);
+  }
+  submission->command_buffer_count = command_buffer_count;
+  for (iree_host_size_t i = 0; i < command_buffer_count; ++i) {
+    submission->command_buffers[i] = command_buffers[i];
+    iree_hal_command_buffer_retain(command_buffers[i]);
+  }
+  submission->dealloca_buffer = dealloca_buffer;
+  iree_hal_buffer_retain(dealloca_buffer);
+
+  // Wake the worker once each unresolved wait is reached. The submission is
+  // not visible to the worker yet so the timepoints cannot race with issue.
+  for (iree_host_size_t i = 0; i < wait_count; ++i) {
+    iree_hal_semaphore_list_t wait_list = {
+        .count = 1,
+        .semaphores = &submission->wait_semaphore_list.semaphores[i],
+        .payload_values = &submission->wait_semaphore_list.payload_values[i],
+    };
+    if (iree_hal_cuda_semaphore_list_can_enqueue_wait(wait_list)) continue;
+    iree_hal_semaphore_acquire_timepoint(
+        wait_list.semaphores[0], wait_list.payload_values[0],
+        iree_infinite_timeout(),
+        (iree_hal_semaphore_callback_t){
+            .fn = iree_hal_cuda_pending_queue_timepoint_callback,
+            .user_data = pending_queue,
+        },
+        &submission->timepoints[i]);
+    submission->timepoint_acquired[i] = true;
+  }
+
+  iree_slim_mutex_lock(&pending_queue->mutex);
+  if (pending_queue->tail) {
+    pending_queue->tail->next = submission;
+  } else {
+    pending_queue->head = submission;
+  }
+  pending_queue->tail = submission;
+  iree_slim_mutex_unlock(&pending_queue->mutex);
+  iree_notification_post(&pending_queue->notification, IREE_ALL_WAITERS);
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+void iree_hal_cuda_pending_queue_poke(
+    iree_hal_cuda_pending_queue_t* pending_queue) {
+  iree_notification_post(&pending_queue->notification, IREE_ALL_WAITERS);
+}
@@ -0,0 +1,79 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_CUDA_PENDING_QUEUE_H_
+#define IREE_HAL_DRIVERS_CUDA_PENDING_QUEUE_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/cuda/context_wrapper.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Issues a submission that was deferred until its waits could be enqueued on a
+// stream. |queue| is the opaque queue passed to the pending queue on enqueue.
+// |dealloca_buffer| is set if the submission is a queue-ordered deallocation
+// of the buffer and otherwise |command_buffers| are to be executed.
+// Returning a failure causes the signal semaphores to be failed.
+typedef iree_status_t(IREE_API_PTR* iree_hal_cuda_pending_queue_issue_fn_t)(
+    void* user_data, void* queue,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_host_size_t command_buffer_count,
+    iree_hal_command_buffer_t* const* command_buffers,
+    iree_hal_buffer_t* dealloca_buffer);
+
+typedef struct iree_hal_cuda_pending_queue_issue_t {
+  iree_hal_cuda_pending_queue_issue_fn_t fn;
+  void* user_data;
+} iree_hal_cuda_pending_queue_issue_t;
+
+// Holds queue submissions that wait on semaphore values that no submission
+// has been made to signal yet, such as values signaled from the host. Waiting
+// for those values in queue_execute would block the submitting thread on work
+// that may only be produced once it returns.
+//
+// A worker thread issues each submission once all of its waits can be
+// enqueued on a stream without blocking. The thread is woken by timepoints on
+// the wait semaphores and by iree_hal_cuda_pending_queue_poke when other
+// submissions enqueue device-side signals.
+typedef struct iree_hal_cuda_pending_queue_t iree_hal_cuda_pending_queue_t;
+
+// Creates a pending queue that issues ready submissions with |issue|.
+// The worker thread makes |context| current before issuing any work.
+iree_status_t iree_hal_cuda_pending_queue_create(
+    iree_hal_cuda_context_wrapper_t* context,
+    iree_hal_cuda_pending_queue_issue_t issue, iree_allocator_t host_allocator,
+    iree_hal_cuda_pending_queue_t** out_pending_queue);
+
+// Stops the worker thread and destroys |pending_queue|. Submissions still
+// pending are never issued and their signal semaphores are failed.
+void iree_hal_cuda_pending_queue_destroy(
+    iree_hal_cuda_pending_queue_t* pending_queue);
+
+// Defers a submission to |queue| until all waits in |wait_semaphore_list| can
+// be enqueued without blocking. Semaphores, command buffers, and the optional
+// |dealloca_buffer| are retained until the submission has been issued.
+iree_status_t iree_hal_cuda_pending_queue_enqueue(
+    iree_hal_cuda_pending_queue_t* pending_queue, void* queue,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_host_size_t command_buffer_count,
+    iree_hal_command_buffer_t* const* command_buffers,
+    iree_hal_buffer_t* dealloca_buffer);
+
+// Wakes the worker thread to re-evaluate pending submissions after a device
+// signal that pending submissions may wait on has been enqueued.
+void iree_hal_cuda_pending_queue_poke(
+    iree_hal_cuda_pending_queue_t* pending_queue);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_CUDA_PENDING_QUEUE_H_
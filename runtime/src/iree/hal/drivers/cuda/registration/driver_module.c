@@ -29,6 +29,27 @@ IREE_FLAG(bool, cuda_tracing, true,
           "enabled. Severely impacts benchmark timings and should only be used "
           "when analyzing dispatch timings.");
 
+IREE_FLAG(bool, cuda_async_allocations, true,
+          "Enables queue-ordered allocations from a CUDA memory pool when "
+          "supported by the device.");
+
+IREE_FLAG(int64_t, cuda_async_allocation_release_threshold, -1,
+          "Bytes of freed memory the CUDA memory pool retains for reuse before "
+          "releasing it at synchronization points (-1 retains all until "
+          "trimmed).");
+
+IREE_FLAG(int32_t, cuda_queue_count, 1,
+          "Number of queues (each backed by a CUDA stream) exposed on each "
+          "CUDA device.");
+
+IREE_FLAG(bool, cuda_dedicated_transfer_queue, false,
+          "Executes transfer-only command buffers on a dedicated CUDA stream "
+          "so they can overlap with dispatches.");
+
+IREE_FLAG(bool, cuda_dedicated_collective_stream, false,
+          "Issues collectives on a dedicated CUDA stream so they can overlap "
+          "with independent dispatches that follow them.");
+
 IREE_FLAG(int32_t, cuda_default_index, 0, "Index of the default CUDA device.");
 
 static iree_status_t iree_hal_cuda_driver_factory_enumerate(
@@ -99,8 +120,18 @@ static iree_status_t iree_hal_cuda_driver_factory_try_create(
     default_params.command_buffer_mode =
         IREE_HAL_CUDA_COMMAND_BUFFER_MODE_STREAM;
   }
+  default_params.queue_count =
+      FLAG_cuda_queue_count > 0 ? (iree_host_size_t)FLAG_cuda_queue_count : 0;
+  default_params.dedicated_transfer_queue = FLAG_cuda_dedicated_transfer_queue;
+  default_params.dedicated_collective_stream =
+      FLAG_cuda_dedicated_collective_stream;
   default_params.allow_inline_execution = FLAG_cuda_allow_inline_execution;
   default_params.stream_tracing = FLAG_cuda_tracing;
+  default_params.async_allocations = FLAG_cuda_async_allocations;
+  default_params.async_allocation_release_threshold =
+      FLAG_cuda_async_allocation_release_threshold < 0
+          ? UINT64_MAX
+          : (uint64_t)FLAG_cuda_async_allocation_release_threshold;
 
   iree_status_t status =
       iree_hal_cuda_init_nccl_rank_and_count(&default_params);
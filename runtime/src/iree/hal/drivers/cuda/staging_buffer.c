@@ -0,0 +1,239 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/cuda/staging_buffer.h"
+
+#include <string.h>
+
+#include "iree/base/tracing.h"
+#include "iree/hal/drivers/cuda/status_util.h"
+
+// Alignment of the staging memory; registration operates on whole pages.
+#define IREE_HAL_CUDA_STAGING_BUFFER_ALIGNMENT 4096
+
+void iree_hal_cuda_staging_buffer_initialize(
+    iree_hal_cuda_context_wrapper_t* context, iree_host_size_t chunk_size,
+    iree_host_size_t chunk_count,
+    iree_hal_cuda_staging_buffer_t* out_staging_buffer) {
+  memset(out_staging_buffer, 0, sizeof(*out_staging_buffer));
+  out_staging_buffer->context = context;
+  out_staging_buffer->chunk_size = chunk_size;
+  out_staging_buffer->chunk_count = chunk_count;
+  iree_slim_mutex_initialize(&out_staging_buffer->mutex);
+}
+
+// Releases the staging memory and events, if allocated.
+// The staging buffer mutex must be held or the staging buffer must be unused.
+static void iree_hal_cuda_staging_buffer_release_unsafe(
+    iree_hal_cuda_staging_buffer_t* staging_buffer) {
+  iree_hal_cuda_context_wrapper_t* context = staging_buffer->context;
+  if (staging_buffer->events) {
+    for (iree_host_size_t i = 0; i < staging_buffer->chunk_count; ++i) {
+      if (!staging_buffer->events[i]) continue;
+      CUDA_IGNORE_ERROR(context->syms,
+                        cuEventDestroy(staging_buffer->events[i]));
+    }
+    iree_allocator_free(context->host_allocator, staging_buffer->events);
+    staging_buffer->events = NULL;
+  }
+  if (staging_buffer->host_ptr) {
+    CUDA_IGNORE_ERROR(context->syms,
+                      cuMemHostUnregister(staging_buffer->host_ptr));
+    iree_allocator_free_aligned(context->host_allocator,
+                                staging_buffer->host_ptr);
+    staging_buffer->host_ptr = NULL;
+  }
+}
+
+void iree_hal_cuda_staging_buffer_deinitialize(
+    iree_hal_cuda_staging_buffer_t* staging_buffer) {
+  iree_hal_cuda_staging_buffer_release_unsafe(staging_buffer);
+  iree_slim_mutex_deinitialize(&staging_buffer->mutex);
+}
+
+// Allocates and registers the staging memory if not yet allocated.
+// The staging buffer mutex must be held.
+static iree_status_t iree_hal_cuda_staging_buffer_reserve_unsafe(
+    iree_hal_cuda_staging_buffer_t* staging_buffer) {
+  if (staging_buffer->host_ptr) return iree_ok_status();
+  iree_hal_cuda_context_wrapper_t* context = staging_buffer->context;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  const iree_host_size_t total_size =
+      staging_buffer->chunk_size * staging_buffer->chunk_count;
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, total_size);
+
+  iree_status_t status = iree_allocator_malloc(
+      context->host_allocator,
+      staging_buffer->chunk_count * sizeof(staging_buffer->events[0]),
+      (void**)&staging_buffer->events);
+  if (iree_status_is_ok(status)) {
+    memset(staging_buffer->events, 0,
+           staging_buffer->chunk_count * sizeof(staging_buffer->events[0]));
+    for (iree_host_size_t i = 0;
+         i < staging_buffer->chunk_count && iree_status_is_ok(status); ++i) {
+      status = CU_RESULT_TO_STATUS(
+          context->syms,
+          cuEventCreate(&staging_buffer->events[i], CU_EVENT_DISABLE_TIMING),
+          "cuEventCreate");
+    }
+  }
+
+  void* host_ptr = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_allocator_malloc_aligned(
+        context->host_allocator, total_size,
+        IREE_HAL_CUDA_STAGING_BUFFER_ALIGNMENT, /*offset=*/0, &host_ptr);
+  }
+  if (iree_status_is_ok(status)) {
+    status = CU_RESULT_TO_STATUS(
+        context->syms, cuMemHostRegister(host_ptr, total_size, /*flags=*/0),
+        "cuMemHostRegister");
+    if (iree_status_is_ok(status)) {
+      staging_buffer->host_ptr = (uint8_t*)host_ptr;
+    } else {
+      iree_allocator_free_aligned(context->host_allocator, host_ptr);
+    }
+  }
+
+  if (!iree_status_is_ok(status)) {
+    iree_hal_cuda_staging_buffer_release_unsafe(staging_buffer);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_hal_cuda_staging_buffer_upload(
+    iree_hal_cuda_staging_buffer_t* staging_buffer, CUstream stream,
+    const void* source, CUdeviceptr target, iree_device_size_t length) {
+  iree_hal_cuda_context_wrapper_t* context = staging_buffer->context;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, length);
+  iree_slim_mutex_lock(&staging_buffer->mutex);
+  iree_status_t status =
+      iree_hal_cuda_staging_buffer_reserve_unsafe(staging_buffer);
+
+  // Fill each chunk once its prior copy has completed and issue its copy; the
+  // host copy into the next chunk overlaps with the DMA of the previous ones.
+  // Events that have never been recorded are treated as completed.
+  const iree_host_size_t chunk_size = staging_buffer->chunk_size;
+  iree_host_size_t chunk_index = 0;
+  for (iree_device_size_t offset = 0;
+       offset < length && iree_status_is_ok(status); offset += chunk_size) {
+    const iree_host_size_t size =
+        (iree_host_size_t)iree_min(length - offset, chunk_size);
+    uint8_t* chunk_ptr = staging_buffer->host_ptr + chunk_index * chunk_size;
+    CUevent chunk_event = staging_buffer->events[chunk_index];
+    status = CU_RESULT_TO_STATUS(context->syms,
+                                 cuEventSynchronize(chunk_event),
+                                 "cuEventSynchronize");
+    if (iree_status_is_ok(status)) {
+      memcpy(chunk_ptr, (const uint8_t*)source + offset, size);
+      status = CU_RESULT_TO_STATUS(
+          context->syms,
+          cuMemcpyHtoDAsync_v2(target + offset, chunk_ptr, size, stream),
+          "cuMemcpyHtoDAsync");
+    }
+    if (iree_status_is_ok(status)) {
+      status = CU_RESULT_TO_STATUS(context->syms,
+                                   cuEventRecord(chunk_event, stream),
+                                   "cuEventRecord");
+    }
+    chunk_index = (chunk_index + 1) % staging_buffer->chunk_count;
+  }
+
+  // Copies complete in stream order so waiting for the most recently used
+  // chunk waits for all of them.
+  if (iree_status_is_ok(status) && length > 0) {
+    iree_host_size_t last_index =
+        (chunk_index + staging_buffer->chunk_count - 1) %
+        staging_buffer->chunk_count;
+    status = CU_RESULT_TO_STATUS(
+        context->syms, cuEventSynchronize(staging_buffer->events[last_index]),
+        "cuEventSynchronize");
+  }
+
+  iree_slim_mutex_unlock(&staging_buffer->mutex);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Issues a copy of chunk |chunk_ordinal| of the download from |source| into
+// its staging chunk and records the chunk event.
+// The staging buffer mutex must be held.
+static iree_status_t iree_hal_cuda_staging_buffer_issue_download_unsafe(
+    iree_hal_cuda_staging_buffer_t* staging_buffer, CUstream stream,
+    CUdeviceptr source, iree_device_size_t length,
+    iree_host_size_t chunk_ordinal) {
+  iree_hal_cuda_context_wrapper_t* context = staging_buffer->context;
+  const iree_host_size_t chunk_size = staging_buffer->chunk_size;
+  const iree_host_size_t chunk_index =
+      chunk_ordinal % staging_buffer->chunk_count;
+  const iree_device_size_t offset =
+      (iree_device_size_t)chunk_ordinal * chunk_size;
+  const iree_host_size_t size =
+      (iree_host_size_t)iree_min(length - offset, chunk_size);
+  CUDA_RETURN_IF_ERROR(
+      context->syms,
+      cuMemcpyDtoHAsync_v2(staging_buffer->host_ptr + chunk_index * chunk_size,
+                           source + offset, size, stream),
+      "cuMemcpyDtoHAsync");
+  CUDA_RETURN_IF_ERROR(
+      context->syms,
+      cuEventRecord(staging_buffer->events[chunk_index], stream),
+      "cuEventRecord");
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_cuda_staging_buffer_download(
+    iree_hal_cuda_staging_buffer_t* staging_buffer, CUstream stream,
+    CUdeviceptr source, void* target, iree_device_size_t length) {
+  iree_hal_cuda_context_wrapper_t* context = staging_buffer->context;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, length);
+  iree_slim_mutex_lock(&staging_buffer->mutex);
+  iree_status_t status =
+      iree_hal_cuda_staging_buffer_reserve_unsafe(staging_buffer);
+
+  // Keep every chunk in flight: as soon as a chunk has been copied out to the
+  // target its next copy is issued.
+  const iree_host_size_t chunk_size = staging_buffer->chunk_size;
+  const iree_host_size_t chunk_count = staging_buffer->chunk_count;
+  const iree_host_size_t total_chunks =
+      (iree_host_size_t)((length + chunk_size - 1) / chunk_size);
+  for (iree_host_size_t i = 0;
+       i < iree_min(chunk_count, total_chunks) && iree_status_is_ok(status);
+       ++i) {
+    status = iree_hal_cuda_staging_buffer_issue_download_unsafe(
+        staging_buffer, stream, source, length, i);
+  }
+  for (iree_host_size_t i = 0; i < total_chunks && iree_status_is_ok(status);
+       ++i) {
+    const iree_host_size_t chunk_index = i % chunk_count;
+    const iree_device_size_t offset = (iree_device_size_t)i * chunk_size;
+    const iree_host_size_t size =
+        (iree_host_size_t)iree_min(length - offset, chunk_size);
+    status = CU_RESULT_TO_STATUS(
+        context->syms, cuEventSynchronize(staging_buffer->events[chunk_index]),
+        "cuEventSynchronize");
+    if (iree_status_is_ok(status)) {
+      memcpy((uint8_t*)target + offset,
+             staging_buffer->host_ptr + chunk_index * chunk_size, size);
+      if (i + chunk_count < total_chunks) {
+        status = iree_hal_cuda_staging_buffer_issue_download_unsafe(
+            staging_buffer, stream, source, length, i + chunk_count);
+      }
+    }
+  }
+
+  // On failure we must not return while copies into the chunks are in flight.
+  if (!iree_status_is_ok(status)) {
+    CUDA_IGNORE_ERROR(context->syms, cuStreamSynchronize(stream));
+  }
+
+  iree_slim_mutex_unlock(&staging_buffer->mutex);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
@@ -0,0 +1,72 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_CUDA_STAGING_BUFFER_H_
+#define IREE_HAL_DRIVERS_CUDA_STAGING_BUFFER_H_
+
+#include "iree/base/api.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/cuda/context_wrapper.h"
+#include "iree/hal/drivers/cuda/cuda_headers.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// A ring of page-locked host memory chunks used to stage transfers between
+// pageable host memory and device memory. Transfers are split into chunks so
+// that the host copy into or out of one chunk overlaps with the DMA of the
+// others.
+//
+// The host memory is allocated and registered with cuMemHostRegister on first
+// use and reused by all subsequent transfers. Transfers are serialized.
+typedef struct iree_hal_cuda_staging_buffer_t {
+  iree_hal_cuda_context_wrapper_t* context;
+  iree_host_size_t chunk_size;
+  iree_host_size_t chunk_count;
+
+  // Guards the chunks and their events; held for the duration of a transfer.
+  iree_slim_mutex_t mutex;
+
+  // Registered host memory of chunk_count * chunk_size bytes or NULL if not
+  // yet allocated.
+  uint8_t* host_ptr;
+  // One event per chunk recorded after the last copy using the chunk.
+  CUevent* events;
+} iree_hal_cuda_staging_buffer_t;
+
+// Initializes |out_staging_buffer| with |chunk_count| chunks of |chunk_size|
+// bytes each. No memory is allocated until the first transfer.
+void iree_hal_cuda_staging_buffer_initialize(
+    iree_hal_cuda_context_wrapper_t* context, iree_host_size_t chunk_size,
+    iree_host_size_t chunk_count,
+    iree_hal_cuda_staging_buffer_t* out_staging_buffer);
+
+// Deinitializes |staging_buffer| and releases its memory. No transfers may be
+// in progress.
+void iree_hal_cuda_staging_buffer_deinitialize(
+    iree_hal_cuda_staging_buffer_t* staging_buffer);
+
+// Copies |length| bytes from host memory at |source| to |target| by way of the
+// staging buffer with copies issued on |stream|. Returns after the copies have
+// completed.
+iree_status_t iree_hal_cuda_staging_buffer_upload(
+    iree_hal_cuda_staging_buffer_t* staging_buffer, CUstream stream,
+    const void* source, CUdeviceptr target, iree_device_size_t length);
+
+// Copies |length| bytes from |source| to host memory at |target| by way of the
+// staging buffer with copies issued on |stream|. Returns after all data has
+// been written to |target|.
+iree_status_t iree_hal_cuda_staging_buffer_download(
+    iree_hal_cuda_staging_buffer_t* staging_buffer, CUstream stream,
+    CUdeviceptr source, void* target, iree_device_size_t length);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_CUDA_STAGING_BUFFER_H_
@@ -26,6 +26,17 @@ typedef struct {
   iree_hal_cuda_tracing_context_t* tracing_context;
   CUstream stream;
 
+  // Optional stream collectives are issued on so that they overlap with the
+  // commands that follow them up to the next barrier. NULL if collectives are
+  // issued on |stream|.
+  CUstream collective_stream;
+  // Recorded on |stream| to make |collective_stream| wait for prior commands.
+  CUevent collective_fork_event;
+  // Recorded on |collective_stream| after each batch of collectives.
+  CUevent collective_join_event;
+  // True if collectives have been issued that |stream| has not yet joined.
+  bool collectives_pending;
+
   // Maintains a reference to all resources used within the command buffer.
   // Reset on each begin.
   iree_hal_resource_set_t* resource_set;
@@ -61,7 +72,7 @@ iree_status_t iree_hal_cuda_stream_command_buffer_create(
     iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_host_size_t binding_capacity, CUstream stream,
-    iree_arena_block_pool_t* block_pool,
+    CUstream collective_stream, iree_arena_block_pool_t* block_pool,
     iree_hal_command_buffer_t** out_command_buffer) {
   IREE_ASSERT_ARGUMENT(device);
   IREE_ASSERT_ARGUMENT(context);
@@ -81,6 +92,7 @@ iree_status_t iree_hal_cuda_stream_command_buffer_create(
       iree_allocator_malloc(context->host_allocator, sizeof(*command_buffer),
                             (void**)&command_buffer);
   if (iree_status_is_ok(status)) {
+    memset(command_buffer, 0, sizeof(*command_buffer));
     iree_hal_command_buffer_initialize(
         device, mode, command_categories, IREE_HAL_QUEUE_AFFINITY_ANY,
         binding_capacity, &iree_hal_cuda_stream_command_buffer_vtable,
@@ -88,6 +100,7 @@ iree_status_t iree_hal_cuda_stream_command_buffer_create(
     command_buffer->context = context;
     command_buffer->tracing_context = tracing_context;
     command_buffer->stream = stream;
+    command_buffer->collective_stream = collective_stream;
     iree_arena_initialize(block_pool, &command_buffer->arena);
     for (size_t i = 0; i < IREE_HAL_CUDA_MAX_KERNEL_ARG; i++) {
       command_buffer->current_descriptor[i] = &command_buffer->device_ptrs[i];
@@ -113,6 +126,14 @@ static void iree_hal_cuda_stream_command_buffer_destroy(
       iree_hal_cuda_stream_command_buffer_cast(base_command_buffer);
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  if (command_buffer->collective_fork_event) {
+    CUDA_IGNORE_ERROR(command_buffer->context->syms,
+                      cuEventDestroy(command_buffer->collective_fork_event));
+  }
+  if (command_buffer->collective_join_event) {
+    CUDA_IGNORE_ERROR(command_buffer->context->syms,
+                      cuEventDestroy(command_buffer->collective_join_event));
+  }
   iree_hal_collective_batch_deinitialize(&command_buffer->collective_batch);
   iree_hal_resource_set_free(command_buffer->resource_set);
   iree_arena_deinitialize(&command_buffer->arena);
@@ -136,6 +157,35 @@ static void* iree_hal_cuda_stream_command_buffer_dyn_cast(
   return NULL;
 }
 
+// Makes the collective stream wait for all commands issued to the command
+// buffer stream so far. The fork/join events are created on first use.
+static iree_status_t iree_hal_cuda_stream_command_buffer_fork_collectives(
+    iree_hal_cuda_stream_command_buffer_t* command_buffer) {
+  iree_hal_cuda_dynamic_symbols_t* syms = command_buffer->context->syms;
+  if (!command_buffer->collective_fork_event) {
+    CUDA_RETURN_IF_ERROR(syms,
+                         cuEventCreate(&command_buffer->collective_fork_event,
+                                       CU_EVENT_DISABLE_TIMING),
+                         "cuEventCreate");
+  }
+  if (!command_buffer->collective_join_event) {
+    CUDA_RETURN_IF_ERROR(syms,
+                         cuEventCreate(&command_buffer->collective_join_event,
+                                       CU_EVENT_DISABLE_TIMING),
+                         "cuEventCreate");
+  }
+  CUDA_RETURN_IF_ERROR(syms,
+                       cuEventRecord(command_buffer->collective_fork_event,
+                                     command_buffer->stream),
+                       "cuEventRecord");
+  CUDA_RETURN_IF_ERROR(
+      syms,
+      cuStreamWaitEvent(command_buffer->collective_stream,
+                        command_buffer->collective_fork_event, 0),
+      "cuStreamWaitEvent");
+  return iree_ok_status();
+}
+
 // Flushes any pending batched collective operations.
 // Must be called before any other non-collective nodes are added to the graph
 // or a barrier is encountered.
@@ -149,14 +199,58 @@ static iree_status_t iree_hal_cuda_stream_command_buffer_flush_collectives(
     return iree_ok_status();
   }
   IREE_TRACE_ZONE_BEGIN(z0);
-  iree_status_t status = iree_hal_cuda_nccl_submit_batch(
-      command_buffer->context, command_buffer->tracing_context,
-      &command_buffer->collective_batch, command_buffer->stream);
+  iree_status_t status = iree_ok_status();
+  CUstream stream = command_buffer->stream;
+  if (command_buffer->collective_stream) {
+    // Fork the collective stream from all commands issued so far. Commands
+    // issued after this point may execute concurrently with the collectives
+    // until the next barrier joins the streams.
+    status = iree_hal_cuda_stream_command_buffer_fork_collectives(
+        command_buffer);
+    stream = command_buffer->collective_stream;
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_cuda_nccl_submit_batch(
+        command_buffer->context, command_buffer->tracing_context,
+        &command_buffer->collective_batch, stream);
+  }
+  if (iree_status_is_ok(status) && command_buffer->collective_stream) {
+    status = CU_RESULT_TO_STATUS(
+        command_buffer->context->syms,
+        cuEventRecord(command_buffer->collective_join_event, stream),
+        "cuEventRecord");
+    command_buffer->collectives_pending = iree_status_is_ok(status);
+  }
   iree_hal_collective_batch_reset(&command_buffer->collective_batch);
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
 
+// Makes all subsequent commands issued to the command buffer stream wait for
+// any collectives issued on the collective stream.
+static iree_status_t iree_hal_cuda_stream_command_buffer_join_collectives(
+    iree_hal_cuda_stream_command_buffer_t* command_buffer) {
+  if (IREE_LIKELY(!command_buffer->collectives_pending)) {
+    return iree_ok_status();
+  }
+  command_buffer->collectives_pending = false;
+  CUDA_RETURN_IF_ERROR(
+      command_buffer->context->syms,
+      cuStreamWaitEvent(command_buffer->stream,
+                        command_buffer->collective_join_event, 0),
+      "cuStreamWaitEvent");
+  return iree_ok_status();
+}
+
+// Flushes pending collectives and joins them with the command buffer stream.
+// Called on barriers: commands after a barrier may depend on the collectives.
+static iree_status_t iree_hal_cuda_stream_command_buffer_barrier_collectives(
+    iree_hal_cuda_stream_command_buffer_t* command_buffer) {
+  IREE_RETURN_IF_ERROR(
+      iree_hal_cuda_stream_command_buffer_flush_collectives(command_buffer));
+  return iree_hal_cuda_stream_command_buffer_join_collectives(command_buffer);
+}
+
 static iree_status_t iree_hal_cuda_stream_command_buffer_begin(
     iree_hal_command_buffer_t* base_command_buffer) {
   iree_hal_cuda_stream_command_buffer_t* command_buffer =
@@ -178,7 +272,7 @@ static iree_status_t iree_hal_cuda_stream_command_buffer_end(
       iree_hal_cuda_stream_command_buffer_cast(base_command_buffer);
 
   IREE_RETURN_IF_ERROR(
-      iree_hal_cuda_stream_command_buffer_flush_collectives(command_buffer));
+      iree_hal_cuda_stream_command_buffer_barrier_collectives(command_buffer));
 
   IREE_CUDA_TRACE_ZONE_END(command_buffer->tracing_context,
                            command_buffer->stream);
@@ -227,7 +321,7 @@ static iree_status_t iree_hal_cuda_stream_command_buffer_execution_barrier(
   iree_hal_cuda_stream_command_buffer_t* command_buffer =
       iree_hal_cuda_stream_command_buffer_cast(base_command_buffer);
   IREE_RETURN_IF_ERROR(
-      iree_hal_cuda_stream_command_buffer_flush_collectives(command_buffer));
+      iree_hal_cuda_stream_command_buffer_barrier_collectives(command_buffer));
   // TODO(jinchen62): implement CUDA barrier
   return iree_ok_status();
 }
@@ -238,7 +332,7 @@ static iree_status_t iree_hal_cuda_stream_command_buffer_signal_event(
   iree_hal_cuda_stream_command_buffer_t* command_buffer =
       iree_hal_cuda_stream_command_buffer_cast(base_command_buffer);
   IREE_RETURN_IF_ERROR(
-      iree_hal_cuda_stream_command_buffer_flush_collectives(command_buffer));
+      iree_hal_cuda_stream_command_buffer_barrier_collectives(command_buffer));
   // TODO(jinchen62): implement CUDA barrier
   return iree_ok_status();
 }
@@ -249,7 +343,7 @@ static iree_status_t iree_hal_cuda_stream_command_buffer_reset_event(
   iree_hal_cuda_stream_command_buffer_t* command_buffer =
       iree_hal_cuda_stream_command_buffer_cast(base_command_buffer);
   IREE_RETURN_IF_ERROR(
-      iree_hal_cuda_stream_command_buffer_flush_collectives(command_buffer));
+      iree_hal_cuda_stream_command_buffer_barrier_collectives(command_buffer));
   // TODO(jinchen62): implement CUDA barrier
   return iree_ok_status();
 }
@@ -266,7 +360,7 @@ static iree_status_t iree_hal_cuda_stream_command_buffer_wait_events(
   iree_hal_cuda_stream_command_buffer_t* command_buffer =
       iree_hal_cuda_stream_command_buffer_cast(base_command_buffer);
   IREE_RETURN_IF_ERROR(
-      iree_hal_cuda_stream_command_buffer_flush_collectives(command_buffer));
+      iree_hal_cuda_stream_command_buffer_barrier_collectives(command_buffer));
   // TODO(jinchen62): implement CUDA barrier
   return iree_ok_status();
 }
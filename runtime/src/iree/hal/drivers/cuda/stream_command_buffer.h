@@ -29,13 +29,17 @@ extern "C" {
 // perform inline execution. When replaying the scratch data required for things
 // like buffer updates is retained by the source deferred command buffer and as
 // such the |block_pool| and can be NULL to avoid a double copy.
+//
+// If |collective_stream| is non-NULL collectives are issued against it so that
+// they overlap with the commands recorded after them. The streams are joined
+// with events on the next barrier and when recording ends.
 iree_status_t iree_hal_cuda_stream_command_buffer_create(
     iree_hal_device_t* device, iree_hal_cuda_context_wrapper_t* context,
     iree_hal_cuda_tracing_context_t* tracing_context,
     iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_host_size_t binding_capacity, CUstream stream,
-    iree_arena_block_pool_t* block_pool,
+    CUstream collective_stream, iree_arena_block_pool_t* block_pool,
     iree_hal_command_buffer_t** out_command_buffer);
 
 // Returns true if |command_buffer| is a CUDA stream-based command buffer.
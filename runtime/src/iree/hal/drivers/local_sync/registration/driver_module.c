@@ -10,8 +10,48 @@
 #include <stddef.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/call_once.h"
+#include "iree/base/internal/flags.h"
 #include "iree/hal/drivers/local_sync/sync_driver.h"
+#include "iree/hal/drivers/local_sync/task_dispatch.h"
 #include "iree/hal/local/loaders/registration/init.h"
+#include "iree/task/api.h"
+
+IREE_FLAG(
+    int32_t, sync_parallel_dispatch_threshold, 0,
+    "Minimum total workgroup count of dispatches that local-sync distributes\n"
+    "across a worker pool (configured with the --task_* flags) instead of\n"
+    "running them on the calling thread. Execution remains synchronous with\n"
+    "the caller waiting for the dispatch to complete. 0 disables.");
+
+// Process-wide executor used for parallel dispatches. Created on first use and
+// kept alive for the process lifetime as devices may outlive their driver.
+static iree_task_executor_t* iree_hal_local_sync_dispatch_executor_ = NULL;
+static iree_status_t iree_hal_local_sync_dispatch_executor_status_;
+static iree_once_flag iree_hal_local_sync_dispatch_executor_flag_ =
+    IREE_ONCE_FLAG_INIT;
+static void iree_hal_local_sync_dispatch_executor_initialize(void) {
+  iree_host_size_t executor_count = 0;
+  iree_hal_local_sync_dispatch_executor_status_ =
+      iree_task_executors_create_from_flags(
+          iree_allocator_system(), /*executor_capacity=*/1,
+          &iree_hal_local_sync_dispatch_executor_, &executor_count);
+}
+
+static iree_status_t iree_hal_local_sync_driver_params_parse_flags(
+    iree_hal_sync_device_params_t* params) {
+  if (FLAG_sync_parallel_dispatch_threshold <= 0) return iree_ok_status();
+  iree_call_once(&iree_hal_local_sync_dispatch_executor_flag_,
+                 iree_hal_local_sync_dispatch_executor_initialize);
+  if (!iree_status_is_ok(iree_hal_local_sync_dispatch_executor_status_)) {
+    return iree_status_clone(iree_hal_local_sync_dispatch_executor_status_);
+  }
+  if (!iree_hal_local_sync_dispatch_executor_) return iree_ok_status();
+  params->dispatch_handler = iree_hal_sync_task_dispatch_handler(
+      iree_hal_local_sync_dispatch_executor_,
+      (uint32_t)FLAG_sync_parallel_dispatch_threshold);
+  return iree_ok_status();
+}
 
 static iree_status_t iree_hal_local_sync_driver_factory_enumerate(
     void* self, iree_host_size_t* out_driver_info_count,
@@ -37,6 +77,8 @@ static iree_status_t iree_hal_local_sync_driver_factory_try_create(
 
   iree_hal_sync_device_params_t default_params;
   iree_hal_sync_device_params_initialize(&default_params);
+  IREE_RETURN_IF_ERROR(
+      iree_hal_local_sync_driver_params_parse_flags(&default_params));
 
   iree_hal_executable_loader_t* loaders[8] = {NULL};
   iree_host_size_t loader_count = 0;
@@ -38,6 +38,11 @@ typedef struct iree_hal_sync_device_t {
   // synchronization ourselves.
   iree_hal_sync_semaphore_state_t semaphore_state;
 
+  iree_hal_local_executable_cache_flags_t executable_cache_flags;
+
+  // Handler set on all inline command buffers executed by the device.
+  iree_hal_inline_dispatch_handler_t dispatch_handler;
+
   iree_host_size_t loader_count;
   iree_hal_executable_loader_t* loaders[];
 } iree_hal_sync_device_t;
@@ -54,6 +59,8 @@ void iree_hal_sync_device_params_initialize(
     iree_hal_sync_device_params_t* out_params) {
   memset(out_params, 0, sizeof(*out_params));
   out_params->arena_block_size = 32 * 1024;
+  out_params->executable_cache_flags =
+      IREE_HAL_LOCAL_EXECUTABLE_CACHE_FLAG_NONE;
 }
 
 static iree_status_t iree_hal_sync_device_check_params(
@@ -98,6 +105,8 @@ iree_status_t iree_hal_sync_device_create(
     iree_arena_block_pool_initialize(params->arena_block_size, host_allocator,
                                      &device->large_block_pool);
 
+    device->executable_cache_flags = params->executable_cache_flags;
+    device->dispatch_handler = params->dispatch_handler;
     device->loader_count = loader_count;
     for (iree_host_size_t i = 0; i < device->loader_count; ++i) {
       device->loaders[i] = loaders[i];
@@ -209,13 +218,16 @@ static iree_status_t iree_hal_sync_device_create_command_buffer(
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
     iree_hal_command_buffer_t** out_command_buffer) {
+  iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
   if (iree_all_bits_set(mode,
                         IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION)) {
-    return iree_hal_inline_command_buffer_create(
+    IREE_RETURN_IF_ERROR(iree_hal_inline_command_buffer_create(
         base_device, mode, command_categories, queue_affinity, binding_capacity,
-        iree_hal_device_host_allocator(base_device), out_command_buffer);
+        iree_hal_device_host_allocator(base_device), out_command_buffer));
+    iree_hal_inline_command_buffer_set_dispatch_handler(
+        *out_command_buffer, device->dispatch_handler);
+    return iree_ok_status();
   } else {
-    iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
     return iree_hal_deferred_command_buffer_create(
         base_device, mode, command_categories, binding_capacity,
         &device->large_block_pool, device->host_allocator, out_command_buffer);
@@ -244,7 +256,9 @@ static iree_status_t iree_hal_sync_device_create_executable_cache(
     iree_loop_t loop, iree_hal_executable_cache_t** out_executable_cache) {
   iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
   return iree_hal_local_executable_cache_create(
-      identifier, /*worker_capacity=*/1, device->loader_count, device->loaders,
+      identifier, device->executable_cache_flags,
+      iree_hal_local_executable_cache_scheduler_null(), /*worker_capacity=*/1,
+      device->loader_count, device->loaders,
       iree_hal_device_host_allocator(base_device), out_executable_cache);
 }
 
@@ -333,6 +347,8 @@ static iree_status_t iree_hal_sync_device_apply_deferred_command_buffers(
           IREE_HAL_COMMAND_CATEGORY_ANY, IREE_HAL_QUEUE_AFFINITY_ANY,
           /*binding_capacity=*/0, device->host_allocator, storage,
           &inline_command_buffer));
+      iree_hal_inline_command_buffer_set_dispatch_handler(
+          inline_command_buffer, device->dispatch_handler);
       iree_status_t status = iree_hal_deferred_command_buffer_apply(
           command_buffer, inline_command_buffer,
           iree_hal_buffer_binding_table_empty());
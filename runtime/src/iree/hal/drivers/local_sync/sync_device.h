@@ -10,6 +10,8 @@
 #include "iree/base/api.h"
 #include "iree/hal/api.h"
 #include "iree/hal/local/executable_loader.h"
+#include "iree/hal/local/inline_command_buffer.h"
+#include "iree/hal/local/local_executable_cache.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -22,6 +24,17 @@ typedef struct iree_hal_sync_device_params_t {
   // Larger sizes will lower overhead and ensure the heap isn't hit for
   // transient allocations while also increasing memory consumption.
   iree_host_size_t arena_block_size;
+
+  // Flags used when creating executable caches. Set
+  // IREE_HAL_LOCAL_EXECUTABLE_CACHE_FLAG_SHARED to reuse executables prepared
+  // by other devices in the process that load the same programs.
+  iree_hal_local_executable_cache_flags_t executable_cache_flags;
+
+  // Optional handler used to distribute the workgroups of large dispatches
+  // across threads (such as with iree_hal_sync_task_dispatch_handler) while
+  // still executing synchronously. By default all dispatches run on the thread
+  // issuing the submission.
+  iree_hal_inline_dispatch_handler_t dispatch_handler;
 } iree_hal_sync_device_params_t;
 
 // Initializes |out_params| to default values.
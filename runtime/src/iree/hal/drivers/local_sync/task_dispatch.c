@@ -0,0 +1,117 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/local_sync/task_dispatch.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "iree/base/tracing.h"
+#include "iree/hal/local/local_executable.h"
+#include "iree/task/scope.h"
+#include "iree/task/submission.h"
+#include "iree/task/task.h"
+
+// Dispatch state shared by all tiles. Lives on the stack of the thread issuing
+// the dispatch as it blocks until all tiles have completed.
+typedef struct iree_hal_sync_task_dispatch_t {
+  iree_hal_local_executable_t* executable;
+  iree_host_size_t ordinal;
+  const iree_hal_executable_dispatch_state_v0_t* dispatch_state;
+} iree_hal_sync_task_dispatch_t;
+
+static iree_status_t iree_hal_sync_task_dispatch_tile(
+    void* user_context, const iree_task_tile_context_t* tile_context,
+    iree_task_submission_t* pending_submission) {
+  const iree_hal_sync_task_dispatch_t* dispatch =
+      (const iree_hal_sync_task_dispatch_t*)user_context;
+  const iree_alignas(64)
+      iree_hal_executable_workgroup_state_v0_t workgroup_state = {
+          .workgroup_id_x = tile_context->workgroup_xyz[0],
+          .workgroup_id_y = tile_context->workgroup_xyz[1],
+          .workgroup_id_z = tile_context->workgroup_xyz[2],
+          .reserved = 0,
+          .processor_id = tile_context->processor_id,
+          .local_memory = tile_context->local_memory.data,
+          .local_memory_size = (size_t)tile_context->local_memory.data_length,
+          .workgroup_range_count = 1,
+      };
+  return iree_hal_local_executable_issue_call_range(
+      dispatch->executable, dispatch->ordinal, dispatch->dispatch_state,
+      &workgroup_state, tile_context->tile_count, tile_context->worker_id);
+}
+
+static iree_status_t iree_hal_sync_task_dispatch_issue(
+    void* user_data, iree_hal_local_executable_t* executable,
+    iree_host_size_t ordinal,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    iree_host_size_t local_memory_size) {
+  iree_task_executor_t* executor = (iree_task_executor_t*)user_data;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Each dispatch gets its own scope so that multiple threads may issue
+  // dispatches against the same executor concurrently.
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("local-sync"), &scope);
+
+  const iree_hal_sync_task_dispatch_t dispatch = {
+      .executable = executable,
+      .ordinal = ordinal,
+      .dispatch_state = dispatch_state,
+  };
+  const uint32_t workgroup_size[3] = {
+      dispatch_state->workgroup_size_x,
+      dispatch_state->workgroup_size_y,
+      dispatch_state->workgroup_size_z,
+  };
+  const uint32_t workgroup_count[3] = {
+      dispatch_state->workgroup_count_x,
+      dispatch_state->workgroup_count_y,
+      dispatch_state->workgroup_count_z,
+  };
+  iree_task_dispatch_t dispatch_task;
+  iree_task_dispatch_initialize(
+      &scope,
+      iree_task_make_dispatch_closure(iree_hal_sync_task_dispatch_tile,
+                                      (void*)&dispatch),
+      workgroup_size, workgroup_count, &dispatch_task);
+  dispatch_task.header.flags |= IREE_TASK_FLAG_DISPATCH_TILE_RANGES;
+  dispatch_task.local_memory_size = (uint32_t)local_memory_size;
+  dispatch_task.cost_key =
+      ((uint64_t)(uintptr_t)executable << 16) ^ (uint64_t)ordinal;
+
+  // The fence retires the scope once all tiles have completed.
+  iree_task_fence_t* fence = NULL;
+  iree_status_t status =
+      iree_task_executor_acquire_fence(executor, &scope, &fence);
+  if (iree_status_is_ok(status)) {
+    iree_task_set_completion_task(&dispatch_task.header, &fence->header);
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    iree_task_submission_enqueue(&submission, &dispatch_task.header);
+    iree_task_executor_submit(executor, &submission);
+    status = iree_task_executor_donate_caller(
+        executor, iree_task_scope_await_idle(&scope), iree_infinite_timeout());
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_task_scope_consume_status(&scope);
+  }
+
+  iree_task_scope_deinitialize(&scope);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_hal_inline_dispatch_handler_t iree_hal_sync_task_dispatch_handler(
+    iree_task_executor_t* executor, uint32_t min_workgroup_count) {
+  iree_hal_inline_dispatch_handler_t handler = {
+      .fn = iree_hal_sync_task_dispatch_issue,
+      .user_data = executor,
+      .min_workgroup_count = min_workgroup_count,
+      .max_concurrency = (uint32_t)iree_task_executor_worker_count(executor),
+  };
+  return handler;
+}
@@ -0,0 +1,33 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_LOCAL_SYNC_TASK_DISPATCH_H_
+#define IREE_HAL_DRIVERS_LOCAL_SYNC_TASK_DISPATCH_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/local/inline_command_buffer.h"
+#include "iree/task/executor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Returns a dispatch handler that distributes the workgroups of dispatches
+// with at least |min_workgroup_count| workgroups across the workers of
+// |executor|. The thread issuing the dispatch is donated to the executor and
+// blocks until all workgroups have completed such that the synchronous device
+// semantics are preserved.
+//
+// |executor| is not retained and must remain valid for the lifetime of all
+// devices using the handler.
+iree_hal_inline_dispatch_handler_t iree_hal_sync_task_dispatch_handler(
+    iree_task_executor_t* executor, uint32_t min_workgroup_count);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_LOCAL_SYNC_TASK_DISPATCH_H_
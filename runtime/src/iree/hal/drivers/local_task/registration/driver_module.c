@@ -10,10 +10,40 @@
 #include <stddef.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/flags.h"
 #include "iree/hal/drivers/local_task/task_driver.h"
 #include "iree/hal/local/loaders/registration/init.h"
 #include "iree/task/api.h"
 
+IREE_FLAG(string, task_executable_preparation, "async",
+          "When executables are prepared (loaded and linked):\n"
+          "  'eager': while the module loads, one after another.\n"
+          "  'async': in parallel on the task executor while the module\n"
+          "           loads.\n"
+          "  'lazy': when first dispatched.");
+
+static iree_status_t iree_hal_local_task_driver_params_parse_flags(
+    iree_hal_task_device_params_t* params) {
+  iree_string_view_t preparation =
+      iree_make_cstring_view(FLAG_task_executable_preparation);
+  params->executable_cache_flags &=
+      ~(IREE_HAL_LOCAL_EXECUTABLE_CACHE_FLAG_ASYNC |
+        IREE_HAL_LOCAL_EXECUTABLE_CACHE_FLAG_LAZY);
+  if (iree_string_view_equal(preparation, IREE_SV("async"))) {
+    params->executable_cache_flags |=
+        IREE_HAL_LOCAL_EXECUTABLE_CACHE_FLAG_ASYNC;
+  } else if (iree_string_view_equal(preparation, IREE_SV("lazy"))) {
+    params->executable_cache_flags |= IREE_HAL_LOCAL_EXECUTABLE_CACHE_FLAG_LAZY;
+  } else if (!iree_string_view_equal(preparation, IREE_SV("eager"))) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "unknown --task_executable_preparation mode '%.*s'; expected 'eager', "
+        "'async' or 'lazy'",
+        (int)preparation.size, preparation.data);
+  }
+  return iree_ok_status();
+}
+
 static iree_status_t iree_hal_local_task_driver_factory_enumerate(
     void* self, iree_host_size_t* out_driver_info_count,
     const iree_hal_driver_info_t** out_driver_infos) {
@@ -40,6 +70,8 @@ static iree_status_t iree_hal_local_task_driver_factory_try_create(
 
   iree_hal_task_device_params_t default_params;
   iree_hal_task_device_params_initialize(&default_params);
+  IREE_RETURN_IF_ERROR(
+      iree_hal_local_task_driver_params_parse_flags(&default_params));
 
   // Create executors for each topology specified by flags.
   // Stack allocated storage today but we can query for the total count and
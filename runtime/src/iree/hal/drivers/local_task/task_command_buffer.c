@@ -12,6 +12,7 @@
 #include <string.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/local/executable_environment.h"
 #include "iree/hal/local/executable_library.h"
@@ -27,6 +28,51 @@
 // iree_hal_task_command_buffer_t
 //===----------------------------------------------------------------------===//
 
+// Number of task records stored in each arena allocation of a reusable
+// command buffer.
+#define IREE_HAL_TASK_COMMAND_BUFFER_RECORD_BLOCK_CAPACITY 64
+
+// A task recorded into a reusable command buffer. The recorded task is never
+// issued itself and instead serves as the template that each execution
+// instance is copied from.
+typedef struct iree_hal_task_command_buffer_record_t {
+  iree_task_t* task;
+  // Total size of the command embedding the task including trailing data.
+  iree_host_size_t task_size;
+} iree_hal_task_command_buffer_record_t;
+
+typedef struct iree_hal_task_command_buffer_record_block_t {
+  struct iree_hal_task_command_buffer_record_block_t* next;
+  iree_host_size_t count;
+  iree_hal_task_command_buffer_record_t
+      records[IREE_HAL_TASK_COMMAND_BUFFER_RECORD_BLOCK_CAPACITY];
+} iree_hal_task_command_buffer_record_block_t;
+
+// Offset of each task in an execution instance from the start of its
+// allocation. The owning instance is stored immediately prior to the task.
+#define IREE_HAL_TASK_COMMAND_BUFFER_INSTANCE_TASK_OFFSET \
+  iree_host_align(sizeof(void*), iree_max_align_t)
+
+// A copy of the recorded task DAG of a reusable command buffer. Executing a
+// task consumes its dependency count and completion edge so each issue copies
+// the recorded tasks into an idle instance, allocating a new one only when all
+// existing instances are still in flight. An instance is returned to the idle
+// list only once every one of its tasks has been cleaned up: tasks may still be
+// retiring (or being discarded) on other workers after the exit task retires.
+typedef struct iree_hal_task_command_buffer_instance_t {
+  struct iree_hal_task_command_buffer_instance_t* next;
+  struct iree_hal_task_command_buffer_t* command_buffer;
+
+  // Number of tasks (including the exit task) not yet cleaned up.
+  iree_atomic_int32_t live_count;
+
+  // Copies of the recorded tasks in recording order.
+  iree_task_t** tasks;
+
+  // Copy of the exit task chained to the per-submission retire task.
+  iree_task_t* exit_task;
+} iree_hal_task_command_buffer_instance_t;
+
 // iree/task/-based command buffer.
 // We track a minimal amount of state here and incrementally build out the task
 // DAG that we can submit to the task system directly. There's no intermediate
@@ -60,6 +106,35 @@ typedef struct iree_hal_task_command_buffer_t {
   // An empty list indicates that root_tasks are also the leaves.
   iree_task_list_t leaf_tasks;
 
+  // State used by reusable (not IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT) command
+  // buffers to execute the same task DAG many times. Instead of handing the
+  // tasks to the executor on the only issue the DAG is retained in the arena
+  // as a template and copied into an execution instance on each issue.
+  struct {
+    // True if the command buffer may be issued more than once.
+    bool enabled;
+
+    // Every task recorded in recording order.
+    iree_hal_task_command_buffer_record_block_t* record_head;
+    iree_hal_task_command_buffer_record_block_t* record_tail;
+    iree_host_size_t record_count;
+
+    // Roots of the DAG that are ready to execute as soon as it is issued.
+    iree_host_size_t root_count;
+    iree_task_t** roots;
+
+    // Joins all leaves of the recorded DAG.
+    iree_task_nop_t exit_task;
+
+    // Guards the idle instance list and the arena once recording has ended.
+    // Held while instantiating as the recorded tasks are temporarily linked to
+    // their copies.
+    iree_slim_mutex_t mutex;
+
+    // Instances with no tasks in flight.
+    iree_hal_task_command_buffer_instance_t* idle_instances;
+  } reuse;
+
   // TODO(benvanik): move this out of the struct and allocate from the arena -
   // we only need this during recording and it's ~4KB of waste otherwise.
   // State tracked within the command buffer during recording only.
@@ -116,19 +191,6 @@ iree_status_t iree_hal_task_command_buffer_create(
   IREE_ASSERT_ARGUMENT(out_command_buffer);
   *out_command_buffer = NULL;
 
-  if (!iree_all_bits_set(mode, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT)) {
-    // If we want reuse we'd need to support duplicating the task DAG after
-    // recording or have some kind of copy-on-submit behavior that does so if
-    // a command buffer is submitted for execution twice. Allowing for the same
-    // command buffer to be enqueued multiple times would be fine so long as
-    // execution doesn't overlap (`cmdbuf|cmdbuf` vs
-    // `cmdbuf -> semaphore -> cmdbuf`) though we'd still need to be careful
-    // that we did the enqueuing and reset of the task structures at the right
-    // times. Definitely something that'll be useful in the future... but not
-    // today :)
-    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                            "only one-shot command buffer usage is supported");
-  }
   if (binding_capacity > 0) {
     // TODO(#10144): support indirect command buffers with binding tables.
     return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
@@ -149,6 +211,10 @@ iree_status_t iree_hal_task_command_buffer_create(
     iree_arena_initialize(block_pool, &command_buffer->arena);
     iree_task_list_initialize(&command_buffer->root_tasks);
     iree_task_list_initialize(&command_buffer->leaf_tasks);
+    memset(&command_buffer->reuse, 0, sizeof(command_buffer->reuse));
+    command_buffer->reuse.enabled =
+        !iree_all_bits_set(mode, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT);
+    iree_slim_mutex_initialize(&command_buffer->reuse.mutex);
     memset(&command_buffer->state, 0, sizeof(command_buffer->state));
     status = iree_hal_resource_set_allocate(block_pool,
                                             &command_buffer->resource_set);
@@ -173,6 +239,7 @@ static void iree_hal_task_command_buffer_destroy(
   memset(&command_buffer->state, 0, sizeof(command_buffer->state));
   iree_task_list_discard(&command_buffer->root_tasks);
   iree_task_list_discard(&command_buffer->leaf_tasks);
+  iree_slim_mutex_deinitialize(&command_buffer->reuse.mutex);
   iree_arena_deinitialize(&command_buffer->arena);
   iree_hal_resource_set_free(command_buffer->resource_set);
   iree_allocator_free(host_allocator, command_buffer);
@@ -206,13 +273,17 @@ static iree_status_t iree_hal_task_command_buffer_begin(
     iree_hal_command_buffer_t* base_command_buffer) {
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
-  if (!iree_task_list_is_empty(&command_buffer->root_tasks)) {
+  if (!iree_task_list_is_empty(&command_buffer->root_tasks) ||
+      command_buffer->reuse.record_head) {
     return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
                             "command buffer cannot be re-recorded");
   }
   return iree_ok_status();
 }
 
+static iree_status_t iree_hal_task_command_buffer_finalize_reuse(
+    iree_hal_task_command_buffer_t* command_buffer);
+
 static iree_status_t iree_hal_task_command_buffer_end(
     iree_hal_command_buffer_t* base_command_buffer) {
   iree_hal_task_command_buffer_t* command_buffer =
@@ -230,6 +301,80 @@ static iree_status_t iree_hal_task_command_buffer_end(
                         &command_buffer->root_tasks);
   }
 
+  if (command_buffer->reuse.enabled) {
+    IREE_RETURN_IF_ERROR(
+        iree_hal_task_command_buffer_finalize_reuse(command_buffer));
+  }
+
+  return iree_ok_status();
+}
+
+// Appends |task| to the records of a reusable command buffer. |task_size| is
+// the size of the command embedding the task that is copied on each issue.
+static iree_status_t iree_hal_task_command_buffer_record_task(
+    iree_hal_task_command_buffer_t* command_buffer, iree_task_t* task,
+    iree_host_size_t task_size) {
+  if (!command_buffer->reuse.enabled) return iree_ok_status();
+  iree_hal_task_command_buffer_record_block_t* block =
+      command_buffer->reuse.record_tail;
+  if (!block ||
+      block->count == IREE_HAL_TASK_COMMAND_BUFFER_RECORD_BLOCK_CAPACITY) {
+    IREE_RETURN_IF_ERROR(iree_arena_allocate(
+        &command_buffer->arena, sizeof(*block), (void**)&block));
+    block->next = NULL;
+    block->count = 0;
+    if (command_buffer->reuse.record_tail) {
+      command_buffer->reuse.record_tail->next = block;
+    } else {
+      command_buffer->reuse.record_head = block;
+    }
+    command_buffer->reuse.record_tail = block;
+  }
+  iree_hal_task_command_buffer_record_t* record =
+      &block->records[block->count++];
+  record->task = task;
+  record->task_size = task_size;
+  ++command_buffer->reuse.record_count;
+  return iree_ok_status();
+}
+
+// Joins the leaves of the recorded DAG to the exit task and captures the roots.
+// The recorded tasks are retained as the template for execution instances.
+static iree_status_t iree_hal_task_command_buffer_finalize_reuse(
+    iree_hal_task_command_buffer_t* command_buffer) {
+  iree_task_list_t* root_tasks = &command_buffer->root_tasks;
+  iree_task_list_t* leaf_tasks =
+      iree_task_list_is_empty(&command_buffer->leaf_tasks)
+          ? root_tasks
+          : &command_buffer->leaf_tasks;
+
+  // Taken from the lists now as their links are clobbered by execution.
+  command_buffer->reuse.root_count = 0;
+  for (iree_task_t* task = root_tasks->head; task; task = task->next_task) {
+    ++command_buffer->reuse.root_count;
+  }
+  if (command_buffer->reuse.root_count > 0) {
+    IREE_RETURN_IF_ERROR(iree_arena_allocate(
+        &command_buffer->arena,
+        command_buffer->reuse.root_count * sizeof(iree_task_t*),
+        (void**)&command_buffer->reuse.roots));
+  }
+  iree_host_size_t root_index = 0;
+  for (iree_task_t* task = root_tasks->head; task; task = task->next_task) {
+    command_buffer->reuse.roots[root_index++] = task;
+  }
+
+  iree_task_nop_initialize(command_buffer->scope,
+                           &command_buffer->reuse.exit_task);
+  for (iree_task_t* task = leaf_tasks->head; task; task = task->next_task) {
+    iree_task_set_completion_task(task,
+                                  &command_buffer->reuse.exit_task.header);
+  }
+
+  // The recorded tasks are only ever copied and must not be discarded.
+  iree_task_list_initialize(&command_buffer->root_tasks);
+  iree_task_list_initialize(&command_buffer->leaf_tasks);
+
   return iree_ok_status();
 }
 
@@ -304,6 +449,8 @@ static iree_status_t iree_hal_task_command_buffer_emit_global_barrier(
   IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
                                            sizeof(*barrier), (void**)&barrier));
   iree_task_barrier_initialize_empty(command_buffer->scope, barrier);
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_record_task(
+      command_buffer, &barrier->header, sizeof(*barrier)));
 
   // If there were previous tasks then join them to the barrier.
   for (iree_task_t* task = iree_task_list_front(&command_buffer->leaf_tasks);
@@ -334,8 +481,12 @@ static iree_status_t iree_hal_task_command_buffer_emit_global_barrier(
 
 // Emits a the given execution |task| into the current open synchronization
 // scope (after state.open_barrier and before the next barrier).
+// |task_size| is the size of the command embedding the task.
 static iree_status_t iree_hal_task_command_buffer_emit_execution_task(
-    iree_hal_task_command_buffer_t* command_buffer, iree_task_t* task) {
+    iree_hal_task_command_buffer_t* command_buffer, iree_task_t* task,
+    iree_host_size_t task_size) {
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_record_task(
+      command_buffer, task, task_size));
   if (command_buffer->state.open_barrier == NULL) {
     // If there is no open barrier then we are at the head and going right into
     // the task DAG.
@@ -352,6 +503,217 @@ static iree_status_t iree_hal_task_command_buffer_emit_execution_task(
 // iree_hal_task_command_buffer_t execution
 //===----------------------------------------------------------------------===//
 
+// Returns the execution instance owning |task|.
+static iree_hal_task_command_buffer_instance_t*
+iree_hal_task_command_buffer_instance_from_task(iree_task_t* task) {
+  return ((iree_hal_task_command_buffer_instance_t**)task)[-1];
+}
+
+// Returns an execution instance to the idle list of its command buffer once
+// the last of its tasks has retired or been discarded. The command buffer is
+// retained while any of its instances are in flight as tasks may still be
+// cleaning up after the submission it was issued with has retired.
+static void iree_hal_task_command_buffer_instance_task_cleanup(
+    iree_task_t* task, iree_status_code_t status_code) {
+  iree_hal_task_command_buffer_instance_t* instance =
+      iree_hal_task_command_buffer_instance_from_task(task);
+  if (iree_atomic_fetch_sub_int32(&instance->live_count, 1,
+                                  iree_memory_order_acq_rel) != 1) {
+    return;
+  }
+  iree_hal_task_command_buffer_t* command_buffer = instance->command_buffer;
+  iree_slim_mutex_lock(&command_buffer->reuse.mutex);
+  instance->next = command_buffer->reuse.idle_instances;
+  command_buffer->reuse.idle_instances = instance;
+  iree_slim_mutex_unlock(&command_buffer->reuse.mutex);
+  iree_hal_command_buffer_release(&command_buffer->base);
+}
+
+// Allocates storage for a task of |task_size| bytes owned by |instance|.
+static iree_status_t iree_hal_task_command_buffer_allocate_instance_task(
+    iree_hal_task_command_buffer_t* command_buffer,
+    iree_hal_task_command_buffer_instance_t* instance,
+    iree_host_size_t task_size, iree_task_t** out_task) {
+  uint8_t* storage = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(
+      &command_buffer->arena,
+      IREE_HAL_TASK_COMMAND_BUFFER_INSTANCE_TASK_OFFSET + task_size,
+      (void**)&storage));
+  iree_task_t* task =
+      (iree_task_t*)&storage[IREE_HAL_TASK_COMMAND_BUFFER_INSTANCE_TASK_OFFSET];
+  ((iree_hal_task_command_buffer_instance_t**)task)[-1] = instance;
+  *out_task = task;
+  return iree_ok_status();
+}
+
+// Allocates a new execution instance with storage for a copy of every recorded
+// task. Must be called with the reuse mutex held.
+static iree_status_t iree_hal_task_command_buffer_allocate_instance(
+    iree_hal_task_command_buffer_t* command_buffer,
+    iree_hal_task_command_buffer_instance_t** out_instance) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_task_command_buffer_instance_t* instance = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_arena_allocate(&command_buffer->arena, sizeof(*instance),
+                              (void**)&instance));
+  memset(instance, 0, sizeof(*instance));
+  instance->command_buffer = command_buffer;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_arena_allocate(
+              &command_buffer->arena,
+              command_buffer->reuse.record_count * sizeof(iree_task_t*),
+              (void**)&instance->tasks));
+  iree_host_size_t task_index = 0;
+  for (iree_hal_task_command_buffer_record_block_t* block =
+           command_buffer->reuse.record_head;
+       block; block = block->next) {
+    for (iree_host_size_t i = 0; i < block->count; ++i) {
+      const iree_hal_task_command_buffer_record_t* record = &block->records[i];
+      // Barriers store their dependent task list after the task.
+      iree_host_size_t task_size = record->task_size;
+      if (record->task->type == IREE_TASK_TYPE_BARRIER) {
+        const iree_task_barrier_t* barrier_task =
+            (const iree_task_barrier_t*)record->task;
+        task_size += barrier_task->dependent_task_count * sizeof(iree_task_t*);
+      }
+      IREE_RETURN_AND_END_ZONE_IF_ERROR(
+          z0, iree_hal_task_command_buffer_allocate_instance_task(
+                  command_buffer, instance, task_size,
+                  &instance->tasks[task_index++]));
+    }
+  }
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_task_command_buffer_allocate_instance_task(
+              command_buffer, instance, sizeof(iree_task_nop_t),
+              &instance->exit_task));
+  *out_instance = instance;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+// Copies the recorded tasks into |instance| and remaps all edges between them
+// to the copies. The exit task is chained to |retire_task| and the roots of the
+// copied DAG are appended to |out_root_tasks|. Must be called with the reuse
+// mutex held as the recorded tasks are linked to their copies to remap edges.
+static void iree_hal_task_command_buffer_instantiate(
+    iree_hal_task_command_buffer_t* command_buffer,
+    iree_hal_task_command_buffer_instance_t* instance, iree_task_t* retire_task,
+    iree_task_list_t* out_root_tasks) {
+  iree_atomic_store_int32(&instance->live_count,
+                          (int32_t)command_buffer->reuse.record_count + 1,
+                          iree_memory_order_relaxed);
+
+  // Copy every task as recorded and link the recorded task to its copy.
+  // Recorded tasks are never issued so their next_task links are unused.
+  iree_host_size_t task_index = 0;
+  for (iree_hal_task_command_buffer_record_block_t* block =
+           command_buffer->reuse.record_head;
+       block; block = block->next) {
+    for (iree_host_size_t i = 0; i < block->count; ++i) {
+      const iree_hal_task_command_buffer_record_t* record = &block->records[i];
+      iree_task_t* task = instance->tasks[task_index++];
+      memcpy(task, record->task, record->task_size);
+      record->task->next_task = task;
+    }
+  }
+  memcpy(instance->exit_task, &command_buffer->reuse.exit_task,
+         sizeof(iree_task_nop_t));
+  command_buffer->reuse.exit_task.header.next_task = instance->exit_task;
+
+  // Remap the edges and closures referencing recorded tasks to the copies.
+  task_index = 0;
+  for (iree_hal_task_command_buffer_record_block_t* block =
+           command_buffer->reuse.record_head;
+       block; block = block->next) {
+    for (iree_host_size_t i = 0; i < block->count; ++i) {
+      const iree_hal_task_command_buffer_record_t* record = &block->records[i];
+      iree_task_t* task = instance->tasks[task_index++];
+      task->next_task = NULL;
+      task->cleanup_fn = iree_hal_task_command_buffer_instance_task_cleanup;
+      if (task->completion_task) {
+        task->completion_task = task->completion_task->next_task;
+      }
+      switch (task->type) {
+        case IREE_TASK_TYPE_CALL: {
+          iree_task_call_t* call_task = (iree_task_call_t*)task;
+          if (call_task->closure.user_context == record->task) {
+            call_task->closure.user_context = task;
+          }
+          break;
+        }
+        case IREE_TASK_TYPE_DISPATCH: {
+          iree_task_dispatch_t* dispatch_task = (iree_task_dispatch_t*)task;
+          if (dispatch_task->closure.user_context == record->task) {
+            dispatch_task->closure.user_context = task;
+          }
+          break;
+        }
+        case IREE_TASK_TYPE_BARRIER: {
+          iree_task_barrier_t* barrier_task = (iree_task_barrier_t*)task;
+          iree_task_t** dependent_tasks =
+              (iree_task_t**)((uint8_t*)task + record->task_size);
+          for (iree_host_size_t j = 0; j < barrier_task->dependent_task_count;
+               ++j) {
+            dependent_tasks[j] = barrier_task->dependent_tasks[j]->next_task;
+          }
+          barrier_task->dependent_tasks = dependent_tasks;
+          break;
+        }
+        default:
+          break;
+      }
+    }
+  }
+  instance->exit_task->next_task = NULL;
+  instance->exit_task->cleanup_fn =
+      iree_hal_task_command_buffer_instance_task_cleanup;
+  iree_task_set_completion_task(instance->exit_task, retire_task);
+
+  for (iree_host_size_t i = 0; i < command_buffer->reuse.root_count; ++i) {
+    iree_task_list_push_back(out_root_tasks,
+                             command_buffer->reuse.roots[i]->next_task);
+  }
+}
+
+// Copies the recorded task DAG of a reusable command buffer into an idle
+// execution instance and enqueues its roots. Overlapping issues each execute
+// their own instance.
+static iree_status_t iree_hal_task_command_buffer_issue_reusable(
+    iree_hal_task_command_buffer_t* command_buffer, iree_task_t* retire_task,
+    iree_task_submission_t* pending_submission) {
+  // If the command buffer is empty (valid!) then we are a no-op.
+  if (command_buffer->reuse.root_count == 0) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_task_list_t root_tasks;
+  iree_task_list_initialize(&root_tasks);
+  iree_status_t status = iree_ok_status();
+  iree_slim_mutex_lock(&command_buffer->reuse.mutex);
+  iree_hal_task_command_buffer_instance_t* instance =
+      command_buffer->reuse.idle_instances;
+  if (instance) {
+    command_buffer->reuse.idle_instances = instance->next;
+    instance->next = NULL;
+  } else {
+    status = iree_hal_task_command_buffer_allocate_instance(command_buffer,
+                                                            &instance);
+  }
+  if (iree_status_is_ok(status)) {
+    iree_hal_task_command_buffer_instantiate(command_buffer, instance,
+                                             retire_task, &root_tasks);
+  }
+  iree_slim_mutex_unlock(&command_buffer->reuse.mutex);
+
+  if (iree_status_is_ok(status)) {
+    // Released by the last task of the instance to be cleaned up.
+    iree_hal_command_buffer_retain(&command_buffer->base);
+    iree_task_submission_enqueue_list(pending_submission, &root_tasks);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 iree_status_t iree_hal_task_command_buffer_issue(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_task_queue_state_t* queue_state, iree_task_t* retire_task,
@@ -361,6 +723,11 @@ iree_status_t iree_hal_task_command_buffer_issue(
                                        &iree_hal_task_command_buffer_vtable);
   IREE_ASSERT_TRUE(command_buffer);
 
+  if (command_buffer->reuse.enabled) {
+    return iree_hal_task_command_buffer_issue_reusable(
+        command_buffer, retire_task, pending_submission);
+  }
+
   // If the command buffer is empty (valid!) then we are a no-op.
   bool has_root_tasks = !iree_task_list_is_empty(&command_buffer->root_tasks);
   if (!has_root_tasks) {
@@ -560,8 +927,8 @@ static iree_status_t iree_hal_task_command_buffer_fill_buffer(
   memcpy(cmd->pattern, pattern, pattern_length);
   cmd->pattern_length = pattern_length;
 
-  return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
-                                                          &cmd->task.header);
+  return iree_hal_task_command_buffer_emit_execution_task(
+      command_buffer, &cmd->task.header, sizeof(*cmd));
 }
 
 //===----------------------------------------------------------------------===//
@@ -616,8 +983,8 @@ static iree_status_t iree_hal_task_command_buffer_update_buffer(
   memcpy(cmd->source_buffer, (const uint8_t*)source_buffer + source_offset,
          cmd->length);
 
-  return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
-                                                          &cmd->task.header);
+  return iree_hal_task_command_buffer_emit_execution_task(
+      command_buffer, &cmd->task.header, total_cmd_size);
 }
 
 //===----------------------------------------------------------------------===//
@@ -700,8 +1067,8 @@ static iree_status_t iree_hal_task_command_buffer_copy_buffer(
   cmd->target_offset = target_offset;
   cmd->length = length;
 
-  return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
-                                                          &cmd->task.header);
+  return iree_hal_task_command_buffer_emit_execution_task(
+      command_buffer, &cmd->task.header, sizeof(*cmd));
 }
 
 //===----------------------------------------------------------------------===//
@@ -778,6 +1145,10 @@ static iree_status_t iree_hal_task_command_buffer_push_descriptor_set(
                             "set %u out of bounds", set);
   }
 
+  IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert_strided(
+      command_buffer->resource_set, binding_count, &bindings[0].buffer,
+      sizeof(bindings[0])));
+
   iree_host_size_t binding_base =
       set * IREE_HAL_LOCAL_MAX_DESCRIPTOR_BINDING_COUNT;
   for (iree_host_size_t i = 0; i < binding_count; ++i) {
@@ -788,10 +1159,6 @@ static iree_status_t iree_hal_task_command_buffer_push_descriptor_set(
     }
     iree_host_size_t binding_ordinal = binding_base + bindings[i].binding;
 
-    // TODO(benvanik): batch insert by getting the resources in their own list.
-    IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
-        command_buffer->resource_set, 1, &bindings[i].buffer));
-
     // TODO(benvanik): track mapping so we can properly map/unmap/flush/etc.
     iree_hal_buffer_mapping_t buffer_mapping = {{0}};
     if (bindings[i].buffer) {
@@ -877,10 +1244,11 @@ static iree_status_t iree_hal_cmd_dispatch_tile(
           .processor_id = tile_context->processor_id,
           .local_memory = tile_context->local_memory.data,
           .local_memory_size = (size_t)tile_context->local_memory.data_length,
+          .workgroup_range_count = 1,
       };
-  iree_status_t status = iree_hal_local_executable_issue_call(
+  iree_status_t status = iree_hal_local_executable_issue_call_range(
       cmd->executable, cmd->ordinal, &dispatch_state, &workgroup_state,
-      tile_context->worker_id);
+      tile_context->tile_count, tile_context->worker_id);
 
   IREE_TRACE_ZONE_END(z0);
   return status;
@@ -894,8 +1262,11 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
 
-  iree_hal_local_executable_t* local_executable =
-      iree_hal_local_executable_cast(executable);
+  // Executables may still be preparing; dispatches are recorded against the
+  // prepared executable and |executable| keeps it alive.
+  iree_hal_local_executable_t* local_executable = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_local_executable_resolve(
+      iree_hal_local_executable_cast(executable), &local_executable));
   if (IREE_UNLIKELY(!local_executable->pipeline_layouts)) {
     return iree_make_status(
         IREE_STATUS_FAILED_PRECONDITION,
@@ -938,6 +1309,11 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
       iree_task_make_dispatch_closure(iree_hal_cmd_dispatch_tile, (void*)cmd),
       workgroup_size, workgroup_count, &cmd->task);
 
+  // Each tile reservation is issued as a single range of workgroups so that
+  // the dispatch state is only prepared once per range and executables that
+  // support it can loop over the workgroups without calls back into the host.
+  cmd->task.header.flags |= IREE_TASK_FLAG_DISPATCH_TILE_RANGES;
+
   // Tell the task system how much workgroup local memory is required for the
   // dispatch; each invocation of the entry point will have at least as much
   // scratch memory available during execution.
@@ -947,6 +1323,11 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
                 IREE_HAL_WORKGROUP_LOCAL_MEMORY_PAGE_SIZE
           : 0;
 
+  // Tiles of the same entry point cost about the same across dispatches; key
+  // the measured cost on it so later dispatches can size their reservations.
+  cmd->task.cost_key =
+      ((uint64_t)(uintptr_t)local_executable << 16) ^ (uint64_t)entry_point;
+
   // Copy only the push constant range used by the executable.
   uint8_t* cmd_ptr = (uint8_t*)cmd + sizeof(*cmd);
   uint32_t* push_constants = (uint32_t*)cmd_ptr;
@@ -981,8 +1362,8 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
   }
 
   *out_cmd = cmd;
-  return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
-                                                          &cmd->task.header);
+  return iree_hal_task_command_buffer_emit_execution_task(
+      command_buffer, &cmd->task.header, total_cmd_size);
 }
 
 static iree_status_t iree_hal_task_command_buffer_dispatch(
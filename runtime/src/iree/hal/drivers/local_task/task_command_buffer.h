@@ -46,6 +46,13 @@ bool iree_hal_task_command_buffer_isa(
 //
 // |pending_submission| will receive the ready list of commands and must be
 // submitted to the executor (or discarded on failure) by the caller.
+//
+// Reusable command buffers (without IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT)
+// keep their recorded task DAG as a template that is never issued itself.
+// Each issue copies the template into an execution instance of its own so
+// issues may overlap: an instance is reused once all of its tasks have been
+// cleaned up and new instances are only allocated while every existing one
+// is still in flight.
 iree_status_t iree_hal_task_command_buffer_issue(
     iree_hal_command_buffer_t* command_buffer,
     iree_hal_task_queue_state_t* queue_state, iree_task_t* retire_task,
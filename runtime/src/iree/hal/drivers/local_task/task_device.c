@@ -12,6 +12,7 @@
 
 #include "iree/base/internal/arena.h"
 #include "iree/base/internal/cpu.h"
+#include "iree/base/internal/math.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/drivers/local_task/task_command_buffer.h"
 #include "iree/hal/drivers/local_task/task_event.h"
@@ -33,6 +34,12 @@ typedef struct iree_hal_task_device_t {
   // buffers can contain inlined data uploads).
   iree_arena_block_pool_t large_block_pool;
 
+  iree_hal_local_executable_cache_flags_t executable_cache_flags;
+
+  // Scope of executable preparation tasks scheduled by executable caches; see
+  // IREE_HAL_LOCAL_EXECUTABLE_CACHE_FLAG_ASYNC.
+  iree_task_scope_t prepare_scope;
+
   iree_host_size_t loader_count;
   iree_hal_executable_loader_t** loaders;
 
@@ -54,6 +61,9 @@ static iree_hal_task_device_t* iree_hal_task_device_cast(
 void iree_hal_task_device_params_initialize(
     iree_hal_task_device_params_t* out_params) {
   out_params->arena_block_size = 32 * 1024;
+  out_params->executable_cache_flags =
+      IREE_HAL_LOCAL_EXECUTABLE_CACHE_FLAG_ASYNC;
+  out_params->high_priority_queue_affinity = 0;
 }
 
 static iree_status_t iree_hal_task_device_check_params(
@@ -116,6 +126,8 @@ iree_status_t iree_hal_task_device_create(
     iree_arena_block_pool_initialize(params->arena_block_size, host_allocator,
                                      &device->large_block_pool);
 
+    device->executable_cache_flags = params->executable_cache_flags;
+    iree_task_scope_initialize(device->identifier, &device->prepare_scope);
     device->loader_count = loader_count;
     device->loaders =
         (iree_hal_executable_loader_t**)((uint8_t*)device + sizeof(*device) +
@@ -128,7 +140,13 @@ iree_status_t iree_hal_task_device_create(
     device->queue_count = queue_count;
     for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
       // TODO(benvanik): add a number to each queue ID.
-      iree_hal_task_queue_initialize(device->identifier, queue_executors[i],
+      iree_task_priority_class_t priority_class =
+          i < 64 && iree_all_bits_set(params->high_priority_queue_affinity,
+                                      1ull << i)
+              ? IREE_TASK_PRIORITY_CLASS_HIGH
+              : IREE_TASK_PRIORITY_CLASS_NORMAL;
+      iree_hal_task_queue_initialize(device->identifier, priority_class,
+                                     queue_executors[i],
                                      &device->small_block_pool,
                                      &device->queues[i]);
     }
@@ -148,6 +166,11 @@ static void iree_hal_task_device_destroy(iree_hal_device_t* base_device) {
   iree_allocator_t host_allocator = iree_hal_device_host_allocator(base_device);
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  // Executable preparation may still be in flight on the executors.
+  iree_status_ignore(iree_task_scope_wait_idle(&device->prepare_scope,
+                                               IREE_TIME_INFINITE_FUTURE));
+  iree_task_scope_deinitialize(&device->prepare_scope);
+
   for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
     iree_hal_task_queue_deinitialize(&device->queues[i]);
   }
@@ -248,10 +271,16 @@ static iree_host_size_t iree_hal_task_device_select_queue(
     iree_hal_task_device_t* device,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity) {
+  // The lowest selected affinity bit picks the queue such that programs
+  // scheduling independent work on distinct affinities land on distinct
+  // queues (and their executors) while IREE_HAL_QUEUE_AFFINITY_ANY and any
+  // other affinity including bit 0 share the first queue.
   // TODO(benvanik): evaluate if we want to obscure this mapping a bit so that
   // affinity really means "equivalent affinities map to equivalent queues" and
   // not a specific queue index.
-  return queue_affinity % device->queue_count;
+  if (device->queue_count == 1 || queue_affinity == 0) return 0;
+  return iree_math_count_trailing_zeros_u64(queue_affinity) %
+         device->queue_count;
 }
 
 static iree_status_t iree_hal_task_device_create_channel(
@@ -292,6 +321,63 @@ static iree_status_t iree_hal_task_device_create_event(
                                     out_event);
 }
 
+// Task running executable cache work such as executable preparation.
+typedef struct iree_hal_task_device_cache_work_t {
+  iree_task_call_t task;
+  iree_allocator_t host_allocator;
+  // Cleared once called.
+  iree_hal_local_executable_cache_work_fn_t fn;
+  void* user_data;
+} iree_hal_task_device_cache_work_t;
+
+static iree_status_t iree_hal_task_device_cache_work_call(
+    void* user_context, iree_task_t* task,
+    iree_task_submission_t* pending_submission) {
+  iree_hal_task_device_cache_work_t* work =
+      (iree_hal_task_device_cache_work_t*)task;
+  iree_hal_local_executable_cache_work_fn_t fn = work->fn;
+  work->fn = NULL;
+  fn(work->user_data);
+  return iree_ok_status();
+}
+
+static void iree_hal_task_device_cache_work_cleanup(
+    iree_task_t* task, iree_status_code_t status_code) {
+  iree_hal_task_device_cache_work_t* work =
+      (iree_hal_task_device_cache_work_t*)task;
+  // Work must be called exactly once even if the task was discarded.
+  if (work->fn) work->fn(work->user_data);
+  iree_allocator_free(work->host_allocator, work);
+}
+
+// Runs executable cache work on the executor of the first queue.
+static iree_status_t iree_hal_task_device_schedule_cache_work(
+    void* self, iree_hal_local_executable_cache_work_fn_t fn,
+    void* user_data) {
+  iree_hal_task_device_t* device = (iree_hal_task_device_t*)self;
+  iree_task_executor_t* executor = device->queues[0].executor;
+
+  iree_hal_task_device_cache_work_t* work = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      device->host_allocator, sizeof(*work), (void**)&work));
+  iree_task_call_initialize(
+      &device->prepare_scope,
+      iree_task_make_call_closure(iree_hal_task_device_cache_work_call, NULL),
+      &work->task);
+  iree_task_set_cleanup_fn(&work->task.header,
+                           iree_hal_task_device_cache_work_cleanup);
+  work->host_allocator = device->host_allocator;
+  work->fn = fn;
+  work->user_data = user_data;
+
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, &work->task.header);
+  iree_task_executor_submit(executor, &submission);
+  iree_task_executor_flush(executor);
+  return iree_ok_status();
+}
+
 static iree_status_t iree_hal_task_device_create_executable_cache(
     iree_hal_device_t* base_device, iree_string_view_t identifier,
     iree_loop_t loop, iree_hal_executable_cache_t** out_executable_cache) {
@@ -305,8 +391,13 @@ static iree_status_t iree_hal_task_device_create_executable_cache(
         iree_task_executor_worker_count(device->queues[i].executor);
   }
 
+  iree_hal_local_executable_cache_scheduler_t scheduler = {
+      .self = device,
+      .schedule = iree_hal_task_device_schedule_cache_work,
+  };
   return iree_hal_local_executable_cache_create(
-      identifier, total_worker_count, device->loader_count, device->loaders,
+      identifier, device->executable_cache_flags, scheduler, total_worker_count,
+      device->loader_count, device->loaders,
       iree_hal_device_host_allocator(base_device), out_executable_cache);
 }
 
@@ -10,6 +10,7 @@
 #include "iree/base/api.h"
 #include "iree/hal/api.h"
 #include "iree/hal/local/executable_loader.h"
+#include "iree/hal/local/local_executable_cache.h"
 #include "iree/task/executor.h"
 
 #ifdef __cplusplus
@@ -23,6 +24,20 @@ typedef struct iree_hal_task_device_params_t {
   // Larger sizes will lower overhead and ensure the heap isn't hit for
   // transient allocations while also increasing memory consumption.
   iree_host_size_t arena_block_size;
+
+  // Flags used when creating executable caches. Set
+  // IREE_HAL_LOCAL_EXECUTABLE_CACHE_FLAG_SHARED to reuse executables prepared
+  // by other devices in the process that load the same programs.
+  // Defaults to IREE_HAL_LOCAL_EXECUTABLE_CACHE_FLAG_ASYNC so that executables
+  // are prepared in parallel on the device executor.
+  iree_hal_local_executable_cache_flags_t executable_cache_flags;
+
+  // Bitmask of queue ordinals whose work is scheduled ahead of other queues
+  // sharing the same executor. Latency-sensitive programs can submit to a
+  // high priority queue via its queue affinity to avoid waiting behind bulk
+  // work submitted to the normal priority queues.
+  // Defaults to 0 such that all queues are normal priority.
+  iree_hal_queue_affinity_t high_priority_queue_affinity;
 } iree_hal_task_device_params_t;
 
 // Initializes |out_params| to default values.
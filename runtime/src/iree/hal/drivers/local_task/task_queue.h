@@ -39,7 +39,10 @@ typedef struct iree_hal_task_queue_t {
   iree_hal_task_queue_state_t state;
 } iree_hal_task_queue_t;
 
+// Initializes |out_queue| with all tasks scheduled with |priority_class|
+// relative to other queues sharing |executor|.
 void iree_hal_task_queue_initialize(iree_string_view_t identifier,
+                                    iree_task_priority_class_t priority_class,
                                     iree_task_executor_t* executor,
                                     iree_arena_block_pool_t* block_pool,
                                     iree_hal_task_queue_t* out_queue);
@@ -0,0 +1,888 @@
+// Copyright 2019 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/pim/PIM_allocator.h"
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <unordered_map>
+// for pim SDK
+#include <vector>
+#include <cmath>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/math.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/drivers/pim/PIM_buffer.h"
+#include "iree/hal/drivers/pim/PIM_sdk.h"
+
+#include <iostream>
+
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_APPLE) || \
+    defined(IREE_PLATFORM_LINUX)
+#include <sys/mman.h>
+#include <unistd.h>
+#define IREE_HAL_PIM_HOST_PREFETCH_ENABLE 1
+#else
+#define IREE_HAL_PIM_HOST_PREFETCH_ENABLE 0
+#endif  // IREE_PLATFORM_*
+
+using namespace iree::hal::pim;
+
+//===----------------------------------------------------------------------===//
+// Host data upload
+//===----------------------------------------------------------------------===//
+
+// Initial data smaller than this is uploaded without read-ahead hints.
+#define IREE_HAL_PIM_PREFETCH_MIN_BYTES (1 * 1024 * 1024)
+
+// Uploads |element_count| floats from |data| as a new device allocation
+// profiled with |simulation|.
+//
+// Constants usually point into the module file mapped by the loader and have
+// not been paged in yet. The range is hinted for read-ahead first so that the
+// kernel pages in the rest of the weights while the SDK is still uploading the
+// start of them instead of faulting page by page.
+static int iree_hal_pim_allocator_upload_host_data(
+    const iree_hal_pim_sim_params_t* simulation, int element_count,
+    const float* data) {
+  const iree_host_size_t byte_length =
+      (iree_host_size_t)element_count * sizeof(float);
+#if IREE_HAL_PIM_HOST_PREFETCH_ENABLE
+  if (byte_length >= IREE_HAL_PIM_PREFETCH_MIN_BYTES) {
+    const uintptr_t page_size = (uintptr_t)sysconf(_SC_PAGESIZE);
+    const uintptr_t begin = (uintptr_t)data & ~(page_size - 1);
+    const uintptr_t end = (uintptr_t)data + byte_length;
+    // Only a hint; heap memory and unsupported ranges are left alone.
+    madvise((void*)begin, end - begin, MADV_WILLNEED);
+  }
+#endif  // IREE_HAL_PIM_HOST_PREFETCH_ENABLE
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)byte_length);
+  int PiM_addr = iree_hal_pim_sdk_alloc_buffer(simulation, element_count, data);
+  IREE_TRACE_ZONE_END(z0);
+  return PiM_addr;
+}
+
+//===----------------------------------------------------------------------===//
+// PIM memory pool
+//===----------------------------------------------------------------------===//
+
+// Number of power-of-two size classes tracked by the pool. Element counts are
+// passed to the SDK as int so 32 classes cover every possible allocation.
+#define IREE_HAL_PIM_POOL_BUCKET_COUNT 32
+
+// Maximum bytes of device memory cached in the pool when the SDK is able to
+// free allocations. Releases beyond this are returned to the SDK immediately
+// so that pools fed by dispatch results can't grow without bound.
+#define IREE_HAL_PIM_POOL_MAX_POOLED_BYTES (256 * 1024 * 1024)
+
+// A released PIM device allocation cached for reuse.
+typedef struct iree_hal_pim_pool_block_t {
+  struct iree_hal_pim_pool_block_t* next;
+  int PiM_addr;
+  // Number of float elements allocated at |PiM_addr|.
+  int PiM_capacity;
+} iree_hal_pim_pool_block_t;
+
+// Device allocations shared by several owners after on-device copies. Only
+// shared addresses are tracked, mapping to the number of owners beyond the
+// first. Tracking is process-wide as buffers of different PIM devices may
+// share allocations of the process-wide SDK.
+typedef struct iree_hal_pim_shared_addresses_t {
+  iree_slim_mutex_t mutex;
+  std::unordered_map<int, int> extra_owners IREE_GUARDED_BY(mutex);
+} iree_hal_pim_shared_addresses_t;
+
+static iree_hal_pim_shared_addresses_t* iree_hal_pim_shared_addresses() {
+  static iree_hal_pim_shared_addresses_t state;
+  static bool initialized = (iree_slim_mutex_initialize(&state.mutex), true);
+  (void)initialized;
+  return &state;
+}
+
+// Drops one owner of |PiM_addr|. Returns true if other owners remain and the
+// allocation must not be reused yet.
+static bool iree_hal_pim_shared_addresses_release(int PiM_addr) {
+  iree_hal_pim_shared_addresses_t* state = iree_hal_pim_shared_addresses();
+  iree_slim_mutex_lock(&state->mutex);
+  bool still_owned = false;
+  auto it = state->extra_owners.find(PiM_addr);
+  if (it != state->extra_owners.end()) {
+    still_owned = true;
+    if (--it->second == 0) state->extra_owners.erase(it);
+  }
+  iree_slim_mutex_unlock(&state->mutex);
+  return still_owned;
+}
+
+// Returns the size class holding blocks with at least 2^class elements.
+static int iree_hal_pim_pool_bucket_floor(int element_count) {
+  if (element_count <= 1) return 0;
+  return 31 - iree_math_count_leading_zeros_u32((uint32_t)element_count);
+}
+
+//===----------------------------------------------------------------------===//
+// Weight residency
+//===----------------------------------------------------------------------===//
+
+// Weights of one model sharing the device. Models are evicted and restored as
+// a whole so a request never pays for swapping in its weights piecemeal.
+typedef struct iree_hal_pim_model_residency_t {
+  // Weight buffers of the model; unretained and removed on deallocation.
+  std::vector<iree_hal_buffer_t*> buffers;
+  // Total allocation size of |buffers| in bytes.
+  iree_device_size_t byte_size = 0;
+  // False when the weights were moved to host memory.
+  bool resident = true;
+  // Value of the residency clock when the model was last read.
+  uint64_t last_use = 0;
+} iree_hal_pim_model_residency_t;
+
+// Tracks which models own the weights on the device. Model 0 is reserved for
+// weights loaded without an active model; they are never evicted.
+typedef struct iree_hal_pim_residency_t {
+  // Guards all fields below. Eviction reads back and recycles device memory
+  // under this lock so it is always acquired before the pool lock.
+  iree_slim_mutex_t mutex;
+  // Bytes of weights allowed on the device or 0 for no limit.
+  iree_device_size_t capacity = 0;
+  // Bytes of weights of resident tracked models.
+  iree_device_size_t resident_bytes = 0;
+  // Model weights allocated from now on are attributed to.
+  uint64_t active_model = 0;
+  // Incremented each time a model is used to order models by recency.
+  uint64_t clock = 0;
+  // Number of times a model was evicted.
+  int64_t eviction_count = 0;
+  std::unordered_map<uint64_t, iree_hal_pim_model_residency_t> models;
+  // Model owning each tracked weight buffer.
+  std::unordered_map<iree_hal_buffer_t*, uint64_t> buffer_models;
+} iree_hal_pim_residency_t;
+
+// Moves all weights of |model| to host memory.
+static iree_status_t iree_hal_pim_residency_evict_model(
+    iree_hal_pim_residency_t* residency,
+    iree_hal_pim_model_residency_t* model) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)model->byte_size);
+  iree_status_t status = iree_ok_status();
+  for (iree_hal_buffer_t* buffer : model->buffers) {
+    status = iree_hal_pim_buffer_evict(buffer);
+    if (!iree_status_is_ok(status)) break;
+  }
+  // Buffers that were evicted are restored on their next read regardless so
+  // the model only counts as resident again once all of them are.
+  model->resident = false;
+  residency->resident_bytes -= model->byte_size;
+  ++residency->eviction_count;
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Evicts the least recently used models other than |keep_model_id| until
+// |required_bytes| more fit within the capacity. A model larger than the
+// capacity on its own is kept resident once everything else is evicted.
+static iree_status_t iree_hal_pim_residency_make_room(
+    iree_hal_pim_residency_t* residency, uint64_t keep_model_id,
+    iree_device_size_t required_bytes) {
+  if (residency->capacity == 0) return iree_ok_status();
+  while (residency->resident_bytes + required_bytes > residency->capacity) {
+    iree_hal_pim_model_residency_t* victim = NULL;
+    for (auto& it : residency->models) {
+      if (it.first == keep_model_id || !it.second.resident) continue;
+      if (!victim || it.second.last_use < victim->last_use) {
+        victim = &it.second;
+      }
+    }
+    if (!victim) break;
+    IREE_RETURN_IF_ERROR(iree_hal_pim_residency_evict_model(residency, victim));
+  }
+  return iree_ok_status();
+}
+
+// Marks |model_id| as used and swaps its weights back onto the device if they
+// were evicted.
+static iree_status_t iree_hal_pim_residency_use_model(
+    iree_hal_pim_residency_t* residency, uint64_t model_id) {
+  auto it = residency->models.find(model_id);
+  if (it == residency->models.end()) return iree_ok_status();
+  iree_hal_pim_model_residency_t* model = &it->second;
+  model->last_use = ++residency->clock;
+  if (model->resident) return iree_ok_status();
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)model->byte_size);
+  iree_status_t status = iree_hal_pim_residency_make_room(
+      residency, model_id, model->byte_size);
+  for (iree_host_size_t i = 0;
+       i < model->buffers.size() && iree_status_is_ok(status); ++i) {
+    status = iree_hal_pim_buffer_materialize(model->buffers[i]);
+  }
+  if (iree_status_is_ok(status)) {
+    model->resident = true;
+    residency->resident_bytes += model->byte_size;
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Attributes the weight |buffer| to the active model, if any.
+static iree_status_t iree_hal_pim_residency_track_buffer(
+    iree_hal_pim_residency_t* residency, iree_hal_buffer_t* buffer) {
+  iree_slim_mutex_lock(&residency->mutex);
+  uint64_t model_id = residency->active_model;
+  iree_status_t status = iree_ok_status();
+  if (model_id != 0) {
+    iree_device_size_t byte_size = iree_hal_buffer_allocation_size(buffer);
+    // Loading a model uses it; its weights push out older models instead of
+    // being evicted while they are still being uploaded.
+    status = iree_hal_pim_residency_use_model(residency, model_id);
+    if (iree_status_is_ok(status)) {
+      status =
+          iree_hal_pim_residency_make_room(residency, model_id, byte_size);
+    }
+    if (iree_status_is_ok(status)) {
+      iree_hal_pim_model_residency_t* model = &residency->models[model_id];
+      model->buffers.push_back(buffer);
+      model->byte_size += byte_size;
+      model->last_use = ++residency->clock;
+      residency->resident_bytes += byte_size;
+      residency->buffer_models[buffer] = model_id;
+    }
+  }
+  iree_slim_mutex_unlock(&residency->mutex);
+  return status;
+}
+
+// Stops tracking |buffer| as it is being deallocated.
+static void iree_hal_pim_residency_untrack_buffer(
+    iree_hal_pim_residency_t* residency, iree_hal_buffer_t* buffer) {
+  iree_slim_mutex_lock(&residency->mutex);
+  auto it = residency->buffer_models.find(buffer);
+  if (it != residency->buffer_models.end()) {
+    iree_hal_pim_model_residency_t* model = &residency->models[it->second];
+    iree_device_size_t byte_size = iree_hal_buffer_allocation_size(buffer);
+    for (iree_host_size_t i = 0; i < model->buffers.size(); ++i) {
+      if (model->buffers[i] != buffer) continue;
+      model->buffers[i] = model->buffers.back();
+      model->buffers.pop_back();
+      break;
+    }
+    model->byte_size -= byte_size;
+    if (model->resident) residency->resident_bytes -= byte_size;
+    if (model->buffers.empty()) residency->models.erase(it->second);
+    residency->buffer_models.erase(it);
+  }
+  iree_slim_mutex_unlock(&residency->mutex);
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_pim_vma_allocator_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_hal_pim_vma_allocator_t {
+  iree_hal_resource_t resource;
+  iree_hal_device_t* device;  // unretained to avoid cycles
+  iree_allocator_t host_allocator;
+  iree_hal_pim_device_flags_t device_flags;
+
+  // Latency model of the device transfers are profiled with if |simulated|.
+  bool simulated;
+  iree_hal_pim_sim_params_t simulation;
+
+  // Guards the pool and statistics; buffers may be released from the device
+  // queue thread while the host is allocating.
+  iree_slim_mutex_t mutex;
+
+  // Free lists of released device allocations bucketed by the floor of the
+  // log2 of their element capacity. The SDK cannot write into an existing
+  // address so only uninitialized allocations are served from the pool.
+  iree_hal_pim_pool_block_t* free_lists[IREE_HAL_PIM_POOL_BUCKET_COUNT]
+      IREE_GUARDED_BY(mutex);
+
+  // Total bytes of device memory currently cached in |free_lists|.
+  iree_device_size_t pooled_bytes IREE_GUARDED_BY(mutex);
+
+  // Weights of the models sharing the device; constructed in place.
+  iree_hal_pim_residency_t residency;
+
+  IREE_STATISTICS(iree_hal_allocator_statistics_t statistics;)
+} iree_hal_pim_vma_allocator_t;
+
+namespace {
+extern const iree_hal_allocator_vtable_t iree_hal_pim_vma_allocator_vtable;
+}  // namespace
+
+static iree_hal_pim_vma_allocator_t* iree_hal_pim_vma_allocator_cast(
+    iree_hal_allocator_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_pim_vma_allocator_vtable);
+  return (iree_hal_pim_vma_allocator_t*)base_value;
+}
+
+
+iree_status_t iree_hal_pim_vma_allocator_create(
+    iree_allocator_t host_allocator, iree_hal_device_t* device,
+    iree_hal_pim_device_flags_t device_flags,
+    iree_device_size_t residency_capacity,
+    const iree_hal_pim_sim_params_t* simulation,
+    iree_hal_allocator_t** out_allocator) {
+
+  IREE_ASSERT_ARGUMENT(device);
+  IREE_ASSERT_ARGUMENT(out_allocator);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_pim_vma_allocator_t* allocator = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*allocator),
+                                (void**)&allocator));
+  iree_hal_resource_initialize(&iree_hal_pim_vma_allocator_vtable,
+                               &allocator->resource);
+  allocator->host_allocator = host_allocator;
+  allocator->device = device;
+  allocator->device_flags = device_flags;
+  allocator->simulated = simulation != NULL;
+  if (simulation) allocator->simulation = *simulation;
+  iree_slim_mutex_initialize(&allocator->mutex);
+  memset(allocator->free_lists, 0, sizeof(allocator->free_lists));
+  allocator->pooled_bytes = 0;
+  new (&allocator->residency) iree_hal_pim_residency_t();
+  iree_slim_mutex_initialize(&allocator->residency.mutex);
+  allocator->residency.capacity = residency_capacity;
+  IREE_STATISTICS(memset(&allocator->statistics, 0,
+                         sizeof(allocator->statistics)));
+
+  iree_status_t status = iree_ok_status();
+
+  if (iree_status_is_ok(status)) {
+    *out_allocator = (iree_hal_allocator_t*)allocator;
+  } else {
+
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+// Takes a cached block with at least |element_count| elements from the pool.
+// Returns false if no suitable block is available.
+static bool iree_hal_pim_pool_acquire(
+    iree_hal_pim_vma_allocator_t* allocator, int element_count,
+    int* out_PiM_addr, int* out_PiM_capacity) {
+  // Scan the size class the request falls into for a large enough block and
+  // then fall back to the next larger class where any block will fit. Larger
+  // classes are not considered to bound the waste to 4x.
+  int bucket = iree_hal_pim_pool_bucket_floor(element_count);
+  iree_hal_pim_pool_block_t* block = NULL;
+  iree_slim_mutex_lock(&allocator->mutex);
+  for (int i = bucket; i < IREE_HAL_PIM_POOL_BUCKET_COUNT && i <= bucket + 1;
+       ++i) {
+    iree_hal_pim_pool_block_t** prev = &allocator->free_lists[i];
+    for (iree_hal_pim_pool_block_t* it = *prev; it; it = it->next) {
+      if (it->PiM_capacity >= element_count) {
+        *prev = it->next;
+        block = it;
+        break;
+      }
+      prev = &it->next;
+    }
+    if (block) break;
+  }
+  if (block) {
+    allocator->pooled_bytes -= (iree_device_size_t)block->PiM_capacity *
+                               sizeof(float);
+  }
+  iree_slim_mutex_unlock(&allocator->mutex);
+  if (!block) return false;
+
+  *out_PiM_addr = block->PiM_addr;
+  *out_PiM_capacity = block->PiM_capacity;
+  iree_allocator_free(allocator->host_allocator, block);
+  return true;
+}
+
+// Returns a device allocation to the pool for reuse.
+static void iree_hal_pim_pool_release(
+    iree_hal_pim_vma_allocator_t* allocator, int PiM_addr,
+    int PiM_capacity) {
+  if (iree_hal_pim_shared_addresses_release(PiM_addr)) return;
+  if (iree_hal_pim_sdk_can_free_buffer()) {
+    iree_device_size_t block_bytes =
+        (iree_device_size_t)PiM_capacity * sizeof(float);
+    iree_slim_mutex_lock(&allocator->mutex);
+    bool pool_full = allocator->pooled_bytes + block_bytes >
+                     IREE_HAL_PIM_POOL_MAX_POOLED_BYTES;
+    iree_slim_mutex_unlock(&allocator->mutex);
+    if (pool_full) {
+      iree_hal_pim_sdk_free_buffer(PiM_addr);
+      return;
+    }
+  }
+  iree_hal_pim_pool_block_t* block = NULL;
+  if (!iree_status_is_ok(iree_allocator_malloc(
+          allocator->host_allocator, sizeof(*block), (void**)&block))) {
+    // Dropping the block only loses the ability to reuse the address.
+    return;
+  }
+  block->PiM_addr = PiM_addr;
+  block->PiM_capacity = PiM_capacity;
+  int bucket = iree_hal_pim_pool_bucket_floor(PiM_capacity);
+  iree_slim_mutex_lock(&allocator->mutex);
+  block->next = allocator->free_lists[bucket];
+  allocator->free_lists[bucket] = block;
+  allocator->pooled_bytes += (iree_device_size_t)PiM_capacity * sizeof(float);
+  iree_slim_mutex_unlock(&allocator->mutex);
+}
+
+// Frees all cached blocks. Device memory is only returned if the SDK supports
+// it; otherwise the blocks are retained as dropping them would leak them.
+static void iree_hal_pim_pool_trim(iree_hal_pim_vma_allocator_t* allocator,
+                                   bool force) {
+  if (!force && !iree_hal_pim_sdk_can_free_buffer()) return;
+  iree_slim_mutex_lock(&allocator->mutex);
+  for (int i = 0; i < IREE_HAL_PIM_POOL_BUCKET_COUNT; ++i) {
+    iree_hal_pim_pool_block_t* block = allocator->free_lists[i];
+    allocator->free_lists[i] = NULL;
+    while (block) {
+      iree_hal_pim_pool_block_t* next = block->next;
+      iree_hal_pim_sdk_free_buffer(block->PiM_addr);
+      iree_allocator_free(allocator->host_allocator, block);
+      block = next;
+    }
+  }
+  allocator->pooled_bytes = 0;
+  iree_slim_mutex_unlock(&allocator->mutex);
+}
+
+void iree_hal_pim_allocator_recycle_address(
+    iree_hal_allocator_t* base_allocator, int PiM_addr, int PiM_capacity) {
+  iree_hal_pim_vma_allocator_t* allocator =
+      iree_hal_pim_vma_allocator_cast(base_allocator);
+  iree_hal_pim_pool_release(allocator, PiM_addr, PiM_capacity);
+}
+
+void iree_hal_pim_allocator_share_address(int PiM_addr) {
+  iree_hal_pim_shared_addresses_t* state = iree_hal_pim_shared_addresses();
+  iree_slim_mutex_lock(&state->mutex);
+  ++state->extra_owners[PiM_addr];
+  iree_slim_mutex_unlock(&state->mutex);
+}
+
+bool iree_hal_pim_allocator_acquire_address(
+    iree_hal_allocator_t* base_allocator, int element_count, int* out_PiM_addr,
+    int* out_PiM_capacity) {
+  iree_hal_pim_vma_allocator_t* allocator =
+      iree_hal_pim_vma_allocator_cast(base_allocator);
+  return iree_hal_pim_pool_acquire(allocator, element_count, out_PiM_addr,
+                                   out_PiM_capacity);
+}
+
+bool iree_hal_pim_allocator_isa(iree_hal_allocator_t* allocator) {
+  return iree_hal_resource_is(allocator, &iree_hal_pim_vma_allocator_vtable);
+}
+
+const iree_hal_pim_sim_params_t* iree_hal_pim_allocator_simulation(
+    iree_hal_allocator_t* base_allocator) {
+  iree_hal_pim_vma_allocator_t* allocator =
+      iree_hal_pim_vma_allocator_cast(base_allocator);
+  return allocator->simulated ? &allocator->simulation : NULL;
+}
+
+void iree_hal_pim_allocator_set_active_model(
+    iree_hal_allocator_t* base_allocator, uint64_t model_id) {
+  iree_hal_pim_vma_allocator_t* allocator =
+      iree_hal_pim_vma_allocator_cast(base_allocator);
+  iree_slim_mutex_lock(&allocator->residency.mutex);
+  allocator->residency.active_model = model_id;
+  iree_slim_mutex_unlock(&allocator->residency.mutex);
+}
+
+iree_status_t iree_hal_pim_allocator_prefetch_model(
+    iree_hal_allocator_t* base_allocator, uint64_t model_id) {
+  iree_hal_pim_vma_allocator_t* allocator =
+      iree_hal_pim_vma_allocator_cast(base_allocator);
+  iree_slim_mutex_lock(&allocator->residency.mutex);
+  iree_status_t status =
+      iree_hal_pim_residency_use_model(&allocator->residency, model_id);
+  iree_slim_mutex_unlock(&allocator->residency.mutex);
+  return status;
+}
+
+iree_status_t iree_hal_pim_allocator_make_resident(
+    iree_hal_allocator_t* base_allocator, iree_hal_buffer_t* buffer) {
+  iree_hal_pim_vma_allocator_t* allocator =
+      iree_hal_pim_vma_allocator_cast(base_allocator);
+  iree_hal_pim_residency_t* residency = &allocator->residency;
+  iree_slim_mutex_lock(&residency->mutex);
+  iree_status_t status = iree_ok_status();
+  auto it = residency->buffer_models.find(buffer);
+  if (it != residency->buffer_models.end()) {
+    status = iree_hal_pim_residency_use_model(residency, it->second);
+  }
+  iree_slim_mutex_unlock(&residency->mutex);
+  return status;
+}
+
+void iree_hal_pim_allocator_query_residency(
+    iree_hal_allocator_t* base_allocator,
+    iree_device_size_t* out_resident_bytes, int64_t* out_eviction_count) {
+  iree_hal_pim_vma_allocator_t* allocator =
+      iree_hal_pim_vma_allocator_cast(base_allocator);
+  iree_slim_mutex_lock(&allocator->residency.mutex);
+  *out_resident_bytes = allocator->residency.resident_bytes;
+  *out_eviction_count = allocator->residency.eviction_count;
+  iree_slim_mutex_unlock(&allocator->residency.mutex);
+}
+
+static void iree_hal_pim_vma_allocator_destroy(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_pim_vma_allocator_t* allocator =
+      iree_hal_pim_vma_allocator_cast(base_allocator);
+  iree_allocator_t host_allocator = allocator->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_pim_pool_trim(allocator, /*force=*/true);
+  iree_slim_mutex_deinitialize(&allocator->residency.mutex);
+  allocator->residency.~iree_hal_pim_residency_t();
+  iree_slim_mutex_deinitialize(&allocator->mutex);
+  iree_allocator_free(host_allocator, allocator);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static iree_allocator_t iree_hal_pim_vma_allocator_host_allocator(
+    const iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_pim_vma_allocator_t* allocator =
+      (iree_hal_pim_vma_allocator_t*)base_allocator;
+  return allocator->host_allocator;
+}
+
+static iree_status_t iree_hal_pim_vma_allocator_trim(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_pim_vma_allocator_t* allocator =
+      iree_hal_pim_vma_allocator_cast(base_allocator);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_pim_pool_trim(allocator, /*force=*/false);
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static void iree_hal_pim_vma_allocator_query_statistics(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_allocator_statistics_t* IREE_RESTRICT out_statistics) {
+  IREE_STATISTICS({
+    iree_hal_pim_vma_allocator_t* allocator =
+        iree_hal_pim_vma_allocator_cast(base_allocator);
+    iree_slim_mutex_lock(&allocator->mutex);
+    memcpy(out_statistics, &allocator->statistics, sizeof(*out_statistics));
+    iree_slim_mutex_unlock(&allocator->mutex);
+  });
+}
+
+static iree_status_t iree_hal_pim_vma_allocator_query_memory_heaps(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_host_size_t capacity,
+    iree_hal_allocator_memory_heap_t* IREE_RESTRICT heaps,
+    iree_host_size_t* IREE_RESTRICT out_count) {
+  // All PIM allocations come from a single device address space that is
+  // materialized on the host when mapped. Reporting it allows allocator shims
+  // (caching, allocation timelines, etc) to attribute allocations to it.
+  const iree_host_size_t count = 1;
+  if (out_count) *out_count = count;
+  if (capacity < count) {
+    // NOTE: lightweight as this is hit in normal pre-sizing usage.
+    return iree_status_from_code(IREE_STATUS_OUT_OF_RANGE);
+  }
+  memset(&heaps[0], 0, sizeof(heaps[0]));
+  heaps[0].type =
+      IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE;
+  heaps[0].allowed_usage =
+      IREE_HAL_BUFFER_USAGE_TRANSFER | IREE_HAL_BUFFER_USAGE_DISPATCH |
+      IREE_HAL_BUFFER_USAGE_SHARING_IMMUTABLE |
+      IREE_HAL_BUFFER_USAGE_MAPPING_SCOPED |
+      IREE_HAL_BUFFER_USAGE_MAPPING_PERSISTENT |
+      IREE_HAL_BUFFER_USAGE_MAPPING_OPTIONAL |
+      IREE_HAL_BUFFER_USAGE_MAPPING_ACCESS_RANDOM |
+      IREE_HAL_BUFFER_USAGE_MAPPING_ACCESS_SEQUENTIAL_WRITE;
+  heaps[0].max_allocation_size = ~(iree_device_size_t)0;
+  heaps[0].min_alignment = 4;
+  return iree_ok_status();
+}
+
+static iree_hal_buffer_compatibility_t
+iree_hal_pim_vma_allocator_query_buffer_compatibility(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t* IREE_RESTRICT allocation_size) {
+  // TODO(benvanik): check to ensure the allocator can serve the memory type.
+
+  // All buffers can be allocated on the heap. Host allocations can be imported
+  // by uploading directly from the caller's memory.
+  iree_hal_buffer_compatibility_t compatibility =
+      IREE_HAL_BUFFER_COMPATIBILITY_ALLOCATABLE |
+      IREE_HAL_BUFFER_COMPATIBILITY_IMPORTABLE;
+
+  if (iree_any_bit_set(params->usage, IREE_HAL_BUFFER_USAGE_TRANSFER)) {
+    compatibility |= IREE_HAL_BUFFER_COMPATIBILITY_QUEUE_TRANSFER;
+  }
+
+  // Buffers can only be used on the queue if they are device visible.
+  if (iree_all_bits_set(params->type, IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE)) {
+    if (iree_any_bit_set(params->usage,
+                         IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE)) {
+      compatibility |= IREE_HAL_BUFFER_COMPATIBILITY_QUEUE_DISPATCH;
+    }
+  }
+
+  // We are now optimal.
+  params->type &= ~IREE_HAL_MEMORY_TYPE_OPTIMAL;
+
+  // Guard against the corner case where the requested buffer size is 0. The
+  // application is unlikely to do anything when requesting a 0-byte buffer; but
+  // it can happen in real world use cases. So we should at least not crash.
+  if (*allocation_size == 0) *allocation_size = 4;
+
+  // Align allocation sizes to 4 bytes so shaders operating on 32 bit types can
+  // act safely even on buffer ranges that are not naturally aligned.
+  *allocation_size = iree_host_align(*allocation_size, 4);
+
+  return compatibility;
+}
+
+static iree_status_t iree_hal_PIM_allocator_allocate_internal(
+    iree_hal_pim_vma_allocator_t* IREE_RESTRICT allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t allocation_size, iree_const_byte_span_t initial_data,
+    int PiM_addr, int PiM_capacity, int PiM_rank, const int* PiM_dim,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+
+  iree_hal_buffer_t* buffer = NULL;
+  iree_status_t status = iree_hal_PIM_buffer_wrap(
+      (iree_hal_allocator_t*)allocator, params->type, params->access,
+      params->usage, allocation_size,
+      /*byte_offset=*/0,
+      /*byte_length=*/allocation_size,
+      PiM_addr, PiM_capacity, PiM_rank, PiM_dim,
+      &buffer);
+
+
+  if (!iree_status_is_ok(status)) {
+    return status;
+  }
+
+  if (iree_status_is_ok(status)) {
+    iree_slim_mutex_lock(&allocator->mutex);
+    IREE_STATISTICS(iree_hal_allocator_statistics_record_alloc(
+        &allocator->statistics, params->type, allocation_size));
+    iree_slim_mutex_unlock(&allocator->mutex);
+    *out_buffer = buffer;
+  } else {
+    iree_hal_buffer_release(buffer);
+  }
+
+
+  return status;
+}
+
+// Creates an uninitialized buffer. If |use_pool| is set a pooled address is
+// bound when one is available and otherwise the buffer is only reserved.
+static iree_status_t iree_hal_PIM_allocator_reserve_internal(
+    iree_hal_pim_vma_allocator_t* IREE_RESTRICT allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t allocation_size, bool use_pool,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  int element_count = (int)(allocation_size / sizeof(float));
+  int PiM_addr = IREE_HAL_PIM_BUFFER_ADDR_NONE;
+  int PiM_capacity = element_count;
+  if (use_pool) {
+    iree_hal_pim_pool_acquire(allocator, element_count, &PiM_addr,
+                              &PiM_capacity);
+  }
+
+  // The shape is unknown until a dispatch writes the result.
+  static const int PiM_dim[3] = {0, 0, 0};
+
+  IREE_RETURN_IF_ERROR(iree_hal_PIM_allocator_allocate_internal(
+      allocator, params, allocation_size, iree_const_byte_span_empty(),
+      PiM_addr, PiM_capacity, IREE_ARRAYSIZE(PiM_dim), PiM_dim, out_buffer));
+
+  // Host-mappable dispatch results (logits, hidden states) are streamed out
+  // as they are produced when requested.
+  if (iree_all_bits_set(
+          allocator->device_flags,
+          IREE_HAL_PIM_DEVICE_FLAG_DOUBLE_BUFFERED_RESULTS) &&
+      iree_all_bits_set(params->type, IREE_HAL_MEMORY_TYPE_HOST_VISIBLE) &&
+      iree_any_bit_set(params->usage,
+                       IREE_HAL_BUFFER_USAGE_MAPPING_SCOPED |
+                           IREE_HAL_BUFFER_USAGE_MAPPING_PERSISTENT)) {
+    iree_hal_pim_buffer_enable_double_buffering(*out_buffer);
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_PIM_allocator_allocate_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t allocation_size, iree_const_byte_span_t initial_data,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  iree_hal_pim_vma_allocator_t* allocator =
+      iree_hal_pim_vma_allocator_cast(base_allocator);
+
+  int element_count = (int)(allocation_size / sizeof(float));
+
+  // PIM device allocation
+  if (!iree_const_byte_span_is_empty(initial_data)) {
+    // The SDK can only upload contents as part of an allocation so we can't
+    // serve initialized buffers from the pool.
+    int PiM_addr = iree_hal_pim_allocator_upload_host_data(
+        iree_hal_pim_allocator_simulation(base_allocator), element_count,
+        (const float*)initial_data.data);
+
+
+    int PiM_rank = params->tensor_shape ? params->tensor_rank : 0;
+
+    IREE_RETURN_IF_ERROR(iree_hal_PIM_allocator_allocate_internal(
+      allocator, params, allocation_size, initial_data,
+      PiM_addr, element_count, PiM_rank, params->tensor_shape,
+      out_buffer));
+
+    // Initialized buffers are weights and count against the residency of the
+    // model being loaded.
+    iree_status_t status = iree_hal_pim_residency_track_buffer(
+        &allocator->residency, *out_buffer);
+    if (!iree_status_is_ok(status)) {
+      iree_hal_buffer_release(*out_buffer);
+      *out_buffer = NULL;
+    }
+    return status;
+  }
+  else {
+    // if there is no initial data reuse a pooled address when possible and
+    // otherwise only reserve the buffer. Most uninitialized buffers are
+    // dispatch results that receive a fresh address from the SDK and never
+    // need their own allocation; the rest are materialized on first read.
+    return iree_hal_PIM_allocator_reserve_internal(
+        allocator, params, allocation_size, /*use_pool=*/true, out_buffer);
+  }
+}
+
+iree_status_t iree_hal_pim_allocator_reserve_buffer(
+    iree_hal_allocator_t* base_allocator, iree_hal_buffer_params_t params,
+    iree_device_size_t allocation_size, iree_hal_buffer_t** out_buffer) {
+  iree_hal_pim_vma_allocator_t* allocator =
+      iree_hal_pim_vma_allocator_cast(base_allocator);
+  IREE_ASSERT_ARGUMENT(out_buffer);
+  *out_buffer = NULL;
+  iree_hal_buffer_params_canonicalize(&params);
+  return iree_hal_PIM_allocator_reserve_internal(
+      allocator, &params, allocation_size, /*use_pool=*/false, out_buffer);
+}
+
+static void iree_hal_pim_vma_allocator_deallocate_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_buffer_t* IREE_RESTRICT base_buffer) {
+  iree_hal_pim_vma_allocator_t* allocator =
+      iree_hal_pim_vma_allocator_cast(base_allocator);
+
+  iree_hal_pim_residency_untrack_buffer(&allocator->residency, base_buffer);
+
+  // Return the device allocation to the pool; the SDK has no way to free it.
+  int PiM_addr = iree_hal_pim_buffer_get_PiM_addr(base_buffer);
+  if (PiM_addr != IREE_HAL_PIM_BUFFER_ADDR_NONE) {
+    iree_hal_pim_pool_release(
+        allocator, PiM_addr, iree_hal_pim_buffer_get_PiM_capacity(base_buffer));
+  }
+
+  iree_slim_mutex_lock(&allocator->mutex);
+  IREE_STATISTICS(iree_hal_allocator_statistics_record_free(
+      &allocator->statistics, iree_hal_buffer_memory_type(base_buffer),
+      iree_hal_buffer_allocation_size(base_buffer)));
+  iree_slim_mutex_unlock(&allocator->mutex);
+
+  iree_hal_buffer_destroy(base_buffer);
+}
+
+static iree_status_t iree_hal_pim_vma_allocator_import_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_hal_external_buffer_t* IREE_RESTRICT external_buffer,
+    iree_hal_buffer_release_callback_t release_callback,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  iree_hal_pim_vma_allocator_t* allocator =
+      iree_hal_pim_vma_allocator_cast(base_allocator);
+
+  if (external_buffer->type != IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION) {
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "external buffer type %d not supported",
+                            (int)external_buffer->type);
+  }
+  if (!iree_host_size_has_alignment(
+          (iree_host_size_t)external_buffer->handle.host_allocation.ptr,
+          sizeof(float))) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "imported host allocations must be aligned to %zu "
+                            "bytes",
+                            sizeof(float));
+  }
+  // The SDK addresses whole floats and a partial trailing element would be
+  // dropped from the device copy.
+  if (!iree_device_size_has_alignment(external_buffer->size, sizeof(float))) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "imported host allocation size %" PRIdsz
+                            " must be a multiple of %zu bytes",
+                            external_buffer->size, sizeof(float));
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Upload straight from the caller's memory; this is the only copy made.
+  // Host writes to the memory after import reach the device only when the
+  // caller flushes them (iree_hal_buffer_flush_range or unmapping a writable
+  // mapping), as the buffer is not host coherent.
+  iree_device_size_t allocation_size = external_buffer->size;
+  int element_count = (int)(allocation_size / sizeof(float));
+  int PiM_addr = iree_hal_pim_allocator_upload_host_data(
+      iree_hal_pim_allocator_simulation(base_allocator), element_count,
+      (const float*)external_buffer->handle.host_allocation.ptr);
+
+  int PiM_rank = params->tensor_shape ? params->tensor_rank : 0;
+
+  iree_status_t status = iree_hal_PIM_allocator_allocate_internal(
+      allocator, params, allocation_size, iree_const_byte_span_empty(),
+      PiM_addr, element_count, PiM_rank, params->tensor_shape, out_buffer);
+
+  if (iree_status_is_ok(status)) {
+    iree_hal_pim_buffer_attach_host_allocation(
+        *out_buffer, external_buffer->handle.host_allocation.ptr,
+        (iree_host_size_t)allocation_size, release_callback);
+    status = iree_hal_pim_residency_track_buffer(&allocator->residency,
+                                                 *out_buffer);
+    if (!iree_status_is_ok(status)) {
+      iree_hal_buffer_release(*out_buffer);
+      *out_buffer = NULL;
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+
+namespace {
+const iree_hal_allocator_vtable_t iree_hal_pim_vma_allocator_vtable = {
+    /*.destroy=*/iree_hal_pim_vma_allocator_destroy,
+    /*.host_allocator=*/iree_hal_pim_vma_allocator_host_allocator,
+    /*.trim=*/iree_hal_pim_vma_allocator_trim,
+    /*.query_statistics=*/iree_hal_pim_vma_allocator_query_statistics,
+    /*.query_memory_heaps=*/iree_hal_pim_vma_allocator_query_memory_heaps,
+    /*.query_buffer_compatibility=*/
+    iree_hal_pim_vma_allocator_query_buffer_compatibility,
+    /*.allocate_buffer=*/iree_hal_PIM_allocator_allocate_buffer,
+    /*.deallocate_buffer=*/iree_hal_pim_vma_allocator_deallocate_buffer,
+    /*.import_buffer=*/iree_hal_pim_vma_allocator_import_buffer,
+};
+}  // namespace
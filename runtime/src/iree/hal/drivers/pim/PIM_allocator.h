@@ -0,0 +1,93 @@
+// Copyright 2019 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_PIM_VMA_ALLOCATOR_H_
+#define IREE_HAL_DRIVERS_PIM_VMA_ALLOCATOR_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/pim/api.h"
+#include "iree/hal/drivers/pim/handle_util.h"
+#include "iree/hal/drivers/pim/util/pim_sim_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Creates the PIM device allocator. |device_flags| controls how buffers are
+// allocated; see IREE_HAL_PIM_DEVICE_FLAG_DOUBLE_BUFFERED_RESULTS.
+// |residency_capacity| bounds the bytes of model weights kept on the device;
+// see iree_hal_pim_device_options_t::pim_residency_capacity.
+// Transfers of the buffers allocated are modeled with |simulation| (copied) if
+// not NULL.
+iree_status_t iree_hal_pim_vma_allocator_create(
+    iree_allocator_t host_allocator, iree_hal_device_t* device,
+    iree_hal_pim_device_flags_t device_flags,
+    iree_device_size_t residency_capacity,
+    const iree_hal_pim_sim_params_t* simulation,
+    iree_hal_allocator_t** out_allocator);
+
+// Returns the latency model transfers of buffers allocated from |allocator|
+// are profiled with or NULL if they are measured.
+const iree_hal_pim_sim_params_t* iree_hal_pim_allocator_simulation(
+    iree_hal_allocator_t* allocator);
+
+// Returns a device allocation no longer referenced by any buffer to the pool
+// of |allocator| so that it is reused by later allocations (or freed if the SDK
+// supports it and the pool is full).
+void iree_hal_pim_allocator_recycle_address(iree_hal_allocator_t* allocator,
+                                            int PiM_addr, int PiM_capacity);
+
+// Adds an owner to the device allocation |PiM_addr| so that it can be shared
+// by another buffer (or slice). The SDK never writes into existing allocations
+// so sharing is safe; each owner releases it through
+// iree_hal_pim_allocator_recycle_address and it is only reused once the last
+// owner has done so.
+void iree_hal_pim_allocator_share_address(int PiM_addr);
+
+// Returns true if |allocator| is a PIM device allocator.
+bool iree_hal_pim_allocator_isa(iree_hal_allocator_t* allocator);
+
+// Attributes weights allocated from now on to |model_id|.
+// See iree_hal_pim_device_set_active_model.
+void iree_hal_pim_allocator_set_active_model(iree_hal_allocator_t* allocator,
+                                             uint64_t model_id);
+
+// Swaps the weights of |model_id| back onto the device if they were evicted.
+iree_status_t iree_hal_pim_allocator_prefetch_model(
+    iree_hal_allocator_t* allocator, uint64_t model_id);
+
+// Marks the model owning |buffer| as used and swaps its weights back onto the
+// device if they were evicted. Must be called before a dispatch reads
+// |buffer|; buffers that are not weights of a model are ignored.
+iree_status_t iree_hal_pim_allocator_make_resident(
+    iree_hal_allocator_t* allocator, iree_hal_buffer_t* buffer);
+
+// Returns the bytes of model weights currently on the device and the number of
+// times a model has been evicted.
+void iree_hal_pim_allocator_query_residency(
+    iree_hal_allocator_t* allocator, iree_device_size_t* out_resident_bytes,
+    int64_t* out_eviction_count);
+
+// Creates an uninitialized buffer without binding any device allocation.
+// Used by queue-ordered allocations that bind pooled memory from the queue
+// thread once their waits resolve; see iree_hal_pim_buffer_bind_pooled_storage.
+iree_status_t iree_hal_pim_allocator_reserve_buffer(
+    iree_hal_allocator_t* allocator, iree_hal_buffer_params_t params,
+    iree_device_size_t allocation_size, iree_hal_buffer_t** out_buffer);
+
+// Takes a pooled device allocation with at least |element_count| elements.
+// Returns false if the pool has no suitable allocation.
+bool iree_hal_pim_allocator_acquire_address(iree_hal_allocator_t* allocator,
+                                            int element_count,
+                                            int* out_PiM_addr,
+                                            int* out_PiM_capacity);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_PIM_VMA_ALLOCATOR_H_
@@ -0,0 +1,1328 @@
+// Copyright 2019 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/pim/PIM_buffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/drivers/pim/PIM_allocator.h"
+#include "iree/hal/drivers/pim/PIM_sdk.h"
+#include "iree/hal/drivers/pim/status_util.h"
+
+// A byte range of a buffer whose contents live in a device allocation of their
+// own. The SDK can only address whole allocations so suballocations (such as
+// transients packed into one slab by the stream dialect) are written and read
+// as separate device tensors tracked by the buffer they belong to.
+typedef struct iree_hal_pim_buffer_slice_t {
+  iree_device_size_t byte_offset;
+  iree_device_size_t byte_length;
+  int PIM_addr;
+  // number of float elements allocated at PIM_addr
+  int PIM_capacity;
+  int PIM_dim[IREE_HAL_PIM_BUFFER_MAX_RANK];
+  int PIM_rank;
+} iree_hal_pim_buffer_slice_t;
+
+// A shard of a matrix held in a byte range of a buffer laid out for the PIM
+// module reading it. Split instructions read the same shard of a weight on
+// every dispatch so it is uploaded once and kept until the range is written.
+typedef struct iree_hal_pim_buffer_placement_t {
+  iree_device_size_t byte_offset;
+  iree_device_size_t byte_length;
+  int axis;
+  int shard_index;
+  int shard_count;
+  int PIM_addr;
+  // number of float elements allocated at PIM_addr
+  int PIM_capacity;
+  int PIM_dim[2];
+} iree_hal_pim_buffer_placement_t;
+
+typedef struct iree_hal_pim_vma_buffer_t {
+  iree_hal_buffer_t base;
+
+  int PIM_addr;
+  // number of float elements allocated at PIM_addr
+  int PIM_capacity;
+
+  // information of shape
+  int PIM_dim[IREE_HAL_PIM_BUFFER_MAX_RANK];
+  int PIM_rank;
+
+  // Host copy of the device contents reused across mappings. The SDK can only
+  // read back whole allocations so we pay for the transfer once per device
+  // write instead of once per map.
+  float* host_shadow;
+  // Size of |host_shadow| in bytes.
+  iree_host_size_t host_shadow_size;
+  // False when the device contents changed since |host_shadow| was filled.
+  bool host_shadow_valid;
+  // False if |host_shadow| is imported memory owned by the caller.
+  bool host_shadow_owned;
+  // True when the device contents were moved into |host_shadow| by
+  // iree_hal_pim_buffer_evict and have to be uploaded again before use.
+  bool evicted;
+
+  // Double-buffered result readback. Each dispatch writing the buffer reads
+  // its result back into |host_back_shadow| on the queue thread and then swaps
+  // it with |host_shadow|. Host mappings of the previous result stay valid
+  // while the next dispatch executes and maps never call into the SDK.
+  bool double_buffered;
+  // Guards |host_shadow| and |host_back_shadow| when |double_buffered|.
+  iree_slim_mutex_t shadow_mutex;
+  float* host_back_shadow;
+  // Size of |host_back_shadow| in bytes.
+  iree_host_size_t host_back_shadow_size;
+
+  // Issued on destroy for buffers wrapping imported host allocations.
+  iree_hal_buffer_release_callback_t release_callback;
+
+  // Subranges whose contents are newer than (or staged from) |PIM_addr|.
+  // Overlapping slices always hold the same contents for the bytes they share;
+  // writing a range drops every slice it overlaps.
+  iree_host_size_t slice_count;
+  iree_host_size_t slice_capacity;
+  iree_hal_pim_buffer_slice_t* slices;
+
+  // Weight shards staged by iree_hal_pim_buffer_acquire_shard. Queues of
+  // different PIM modules read their shards of the same buffer concurrently
+  // so the list is guarded by |placement_mutex|. Writing a range drops every
+  // placement it overlaps.
+  iree_slim_mutex_t placement_mutex;
+  iree_host_size_t placement_count;
+  iree_host_size_t placement_capacity;
+  iree_hal_pim_buffer_placement_t* placements;
+
+} iree_hal_pim_vma_buffer_t;
+
+namespace {
+extern const iree_hal_buffer_vtable_t iree_hal_pim_vma_buffer_vtable;
+}  // namespace
+
+static iree_hal_pim_vma_buffer_t* iree_hal_pim_vma_buffer_cast(
+    iree_hal_buffer_t* base_value) {
+
+  // this causes error in PiM execution
+  //IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_pim_vma_buffer_vtable);
+  return (iree_hal_pim_vma_buffer_t*)base_value;
+}
+
+// Returns the latency model transfers of |buffer| are profiled with or NULL if
+// they are measured.
+static const iree_hal_pim_sim_params_t* iree_hal_pim_vma_buffer_simulation(
+    iree_hal_pim_vma_buffer_t* buffer) {
+  return iree_hal_pim_allocator_simulation(buffer->base.device_allocator);
+}
+
+iree_status_t iree_hal_PIM_buffer_wrap(
+    iree_hal_allocator_t* allocator, iree_hal_memory_type_t memory_type,
+    iree_hal_memory_access_t allowed_access,
+    iree_hal_buffer_usage_t allowed_usage, iree_device_size_t allocation_size,
+    iree_device_size_t byte_offset, iree_device_size_t byte_length,
+    int PIM_addr, int PIM_capacity, int PIM_rank, const int* PIM_dim,
+    iree_hal_buffer_t** out_buffer) {
+  IREE_ASSERT_ARGUMENT(allocator);
+  IREE_ASSERT_ARGUMENT(out_buffer);
+  if (PIM_rank < 0 || PIM_rank > IREE_HAL_PIM_BUFFER_MAX_RANK) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "PiM tensor rank %d exceeds the maximum of %d",
+                            PIM_rank, IREE_HAL_PIM_BUFFER_MAX_RANK);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)allocation_size);
+
+  iree_allocator_t host_allocator =
+      iree_hal_allocator_host_allocator(allocator);
+  iree_hal_pim_vma_buffer_t* buffer = NULL;
+  iree_status_t status =
+      iree_allocator_malloc(host_allocator, sizeof(*buffer), (void**)&buffer);
+  if (iree_status_is_ok(status)) {
+    iree_hal_buffer_initialize(
+        host_allocator, allocator, &buffer->base, allocation_size, byte_offset,
+        byte_length, memory_type, allowed_access, allowed_usage,
+        &iree_hal_pim_vma_buffer_vtable, &buffer->base);
+
+    buffer->PIM_addr = PIM_addr;
+    buffer->PIM_capacity = PIM_capacity;
+    if (PIM_rank > 0) {
+      memcpy(buffer->PIM_dim, PIM_dim, PIM_rank * sizeof(*PIM_dim));
+    }
+    buffer->PIM_rank = PIM_rank;
+    buffer->host_shadow = NULL;
+    buffer->host_shadow_size = 0;
+    buffer->host_shadow_valid = false;
+    iree_slim_mutex_initialize(&buffer->shadow_mutex);
+    iree_slim_mutex_initialize(&buffer->placement_mutex);
+
+    *out_buffer = &buffer->base;
+  } else {
+    iree_status_ignore(status);
+    status = iree_make_status(
+        IREE_STATUS_RESOURCE_EXHAUSTED,
+        "out of host memory wrapping PIM address %d as a buffer of %" PRIdsz
+        " bytes",
+        PIM_addr, allocation_size);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+void iree_hal_pim_buffer_attach_host_allocation(
+    iree_hal_buffer_t* base_buffer, void* host_ptr, iree_host_size_t host_size,
+    iree_hal_buffer_release_callback_t release_callback) {
+  iree_hal_pim_vma_buffer_t* buffer =
+      iree_hal_pim_vma_buffer_cast(base_buffer);
+  if (buffer->host_shadow_owned) {
+    iree_allocator_free(base_buffer->host_allocator, buffer->host_shadow);
+  }
+  // The device allocation was made from |host_ptr| so it starts out coherent.
+  buffer->host_shadow = (float*)host_ptr;
+  buffer->host_shadow_size = host_size;
+  buffer->host_shadow_valid = true;
+  buffer->host_shadow_owned = false;
+  buffer->release_callback = release_callback;
+}
+
+void iree_hal_pim_buffer_enable_double_buffering(
+    iree_hal_buffer_t* base_buffer) {
+  iree_hal_pim_vma_buffer_t* buffer =
+      iree_hal_pim_vma_buffer_cast(base_buffer);
+  buffer->double_buffered = true;
+}
+
+// Grows |*shadow| to at least |required_size| bytes.
+static iree_status_t iree_hal_pim_buffer_reserve_shadow(
+    iree_allocator_t host_allocator, iree_host_size_t required_size,
+    float** shadow, iree_host_size_t* shadow_size) {
+  if (required_size <= *shadow_size) return iree_ok_status();
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_realloc(host_allocator, required_size, (void**)shadow));
+  *shadow_size = required_size;
+  return iree_ok_status();
+}
+
+// Reads back a newly written result of a double-buffered buffer and publishes
+// it to host mappings. Called on the queue thread before the submission
+// signals its semaphores so waiters observe the result without device access.
+static iree_status_t iree_hal_pim_vma_buffer_stream_result(
+    iree_hal_pim_vma_buffer_t* buffer) {
+  iree_hal_buffer_t* base_buffer = &buffer->base;
+  if (!buffer->double_buffered ||
+      buffer->PIM_addr == IREE_HAL_PIM_BUFFER_ADDR_NONE) {
+    return iree_ok_status();
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)buffer->PIM_capacity);
+
+  // The back shadow is only touched by the queue thread executing the dispatch
+  // so the readback itself happens without holding the lock.
+  iree_host_size_t shadow_size = iree_max(
+      (iree_host_size_t)iree_hal_buffer_allocation_size(base_buffer),
+      (iree_host_size_t)buffer->PIM_capacity * sizeof(float));
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_pim_buffer_reserve_shadow(
+              base_buffer->host_allocator, shadow_size,
+              &buffer->host_back_shadow, &buffer->host_back_shadow_size));
+  iree_hal_pim_sdk_read_buffer(iree_hal_pim_vma_buffer_simulation(buffer),
+                               buffer->PIM_addr, buffer->PIM_capacity,
+                               buffer->host_back_shadow);
+
+  // Publish the new result; the previous one becomes the next back shadow.
+  iree_slim_mutex_lock(&buffer->shadow_mutex);
+  float* front_shadow = buffer->host_shadow;
+  iree_host_size_t front_shadow_size = buffer->host_shadow_size;
+  if (!buffer->host_shadow_owned) {
+    // Imported memory can't be swapped; the caller expects it to hold the
+    // contents so copy into it when it fits.
+    if (front_shadow_size >= shadow_size) {
+      memcpy(front_shadow, buffer->host_back_shadow, shadow_size);
+      buffer->host_shadow_valid = true;
+      iree_slim_mutex_unlock(&buffer->shadow_mutex);
+      IREE_TRACE_ZONE_END(z0);
+      return iree_ok_status();
+    }
+    front_shadow = NULL;
+    front_shadow_size = 0;
+    buffer->host_shadow_owned = true;
+  }
+  buffer->host_shadow = buffer->host_back_shadow;
+  buffer->host_shadow_size = buffer->host_back_shadow_size;
+  buffer->host_shadow_valid = true;
+  buffer->host_back_shadow = front_shadow;
+  buffer->host_back_shadow_size = front_shadow_size;
+  iree_slim_mutex_unlock(&buffer->shadow_mutex);
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+// Reads the device contents back into the host shadow.
+static iree_status_t iree_hal_pim_vma_buffer_fill_shadow(
+    iree_hal_pim_vma_buffer_t* buffer) {
+  iree_hal_buffer_t* base_buffer = &buffer->base;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // The SDK copies out the whole allocation, which may be larger than the
+  // buffer if its address was reused from the allocator pool.
+  iree_host_size_t shadow_size = iree_max(
+      (iree_host_size_t)iree_hal_buffer_allocation_size(base_buffer),
+      (iree_host_size_t)buffer->PIM_capacity * sizeof(float));
+  if (shadow_size > buffer->host_shadow_size) {
+    // Imported memory too small for the readback is left untouched and we
+    // switch to a shadow of our own.
+    if (!buffer->host_shadow_owned) {
+      buffer->host_shadow = NULL;
+      buffer->host_shadow_size = 0;
+      buffer->host_shadow_owned = true;
+    }
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_hal_pim_buffer_reserve_shadow(
+                base_buffer->host_allocator, shadow_size, &buffer->host_shadow,
+                &buffer->host_shadow_size));
+  }
+
+  if (buffer->PIM_addr == IREE_HAL_PIM_BUFFER_ADDR_NONE) {
+    // Reserved buffers have never been written and read back as zeros
+    // without touching the device.
+    memset(buffer->host_shadow, 0, buffer->host_shadow_size);
+  } else {
+    iree_hal_pim_sdk_read_buffer(iree_hal_pim_vma_buffer_simulation(buffer),
+                                 buffer->PIM_addr, buffer->PIM_capacity,
+                                 buffer->host_shadow);
+  }
+
+  // Ranges written by dispatches live in their own allocations.
+  std::vector<float> slice_data;
+  for (iree_host_size_t i = 0; i < buffer->slice_count; ++i) {
+    const iree_hal_pim_buffer_slice_t* slice = &buffer->slices[i];
+    slice_data.resize(slice->PIM_capacity);
+    iree_hal_pim_sdk_read_buffer(iree_hal_pim_vma_buffer_simulation(buffer),
+                                 slice->PIM_addr, slice->PIM_capacity,
+                                 slice_data.data());
+    iree_host_size_t length = iree_min(
+        (iree_host_size_t)slice->byte_length,
+        (iree_host_size_t)slice->PIM_capacity * sizeof(float));
+    length = iree_min(length, buffer->host_shadow_size -
+                                  (iree_host_size_t)slice->byte_offset);
+    memcpy((uint8_t*)buffer->host_shadow + slice->byte_offset,
+           slice_data.data(), length);
+  }
+  buffer->host_shadow_valid = true;
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static void iree_hal_pim_vma_buffer_lock_shadow(
+    iree_hal_pim_vma_buffer_t* buffer);
+static void iree_hal_pim_vma_buffer_unlock_shadow(
+    iree_hal_pim_vma_buffer_t* buffer);
+
+// PiM SDK impl
+int iree_hal_pim_buffer_get_PiM_addr(iree_hal_buffer_t* base_buffer){
+  iree_hal_pim_vma_buffer_t* buffer =
+      iree_hal_pim_vma_buffer_cast(base_buffer);
+
+  return buffer->PIM_addr;
+}
+
+iree_status_t iree_hal_pim_buffer_materialize(iree_hal_buffer_t* base_buffer){
+  iree_hal_pim_vma_buffer_t* buffer =
+      iree_hal_pim_vma_buffer_cast(base_buffer);
+  if (buffer->PIM_addr != IREE_HAL_PIM_BUFFER_ADDR_NONE) {
+    return iree_ok_status();
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)buffer->PIM_capacity);
+
+  iree_hal_pim_vma_buffer_lock_shadow(buffer);
+  if (buffer->evicted) {
+    // The host shadow kept the contents while the buffer was off the device.
+    buffer->PIM_addr = iree_hal_pim_sdk_alloc_buffer(
+        iree_hal_pim_vma_buffer_simulation(buffer), buffer->PIM_capacity,
+        buffer->host_shadow);
+    buffer->evicted = false;
+  } else {
+    // The SDK can only allocate with contents so zeros are uploaded here;
+    // this is only paid by buffers that are read before ever being written.
+    std::vector<float> zero_data(buffer->PIM_capacity, 0.0f);
+    buffer->PIM_addr = iree_hal_pim_sdk_alloc_buffer(
+        iree_hal_pim_vma_buffer_simulation(buffer), buffer->PIM_capacity,
+        zero_data.data());
+  }
+  iree_hal_pim_vma_buffer_unlock_shadow(buffer);
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+int iree_hal_pim_buffer_get_PiM_capacity(iree_hal_buffer_t* base_buffer){
+  iree_hal_pim_vma_buffer_t* buffer =
+      iree_hal_pim_vma_buffer_cast(base_buffer);
+
+  return buffer->PIM_capacity;
+}
+
+void iree_hal_pim_buffer_push_PiM_addr(iree_hal_buffer_t* base_buffer,
+                                       int new_PIM_addr, int new_PIM_capacity) {
+  iree_hal_pim_vma_buffer_t* buffer =
+      iree_hal_pim_vma_buffer_cast(base_buffer);
+
+  // The buffer owns its device allocation; once replaced nothing references
+  // it anymore and it goes back to the pool instead of leaking.
+  if (buffer->PIM_addr != IREE_HAL_PIM_BUFFER_ADDR_NONE &&
+      buffer->PIM_addr != new_PIM_addr) {
+    iree_hal_pim_allocator_recycle_address(base_buffer->device_allocator,
+                                           buffer->PIM_addr,
+                                           buffer->PIM_capacity);
+  }
+
+  buffer->PIM_addr = new_PIM_addr;
+  buffer->PIM_capacity = new_PIM_capacity;
+  buffer->evicted = false;
+
+  // Device contents changed; the next map must read them back. Double-buffered
+  // buffers keep serving the previous result until the new one is streamed.
+  if (!buffer->double_buffered) {
+    buffer->host_shadow_valid = false;
+  }
+}
+
+iree_status_t iree_hal_pim_buffer_push_PiM_dim(iree_hal_buffer_t* base_buffer,
+                                               int new_PIM_rank,
+                                               const int* new_PIM_dim){
+  iree_hal_pim_vma_buffer_t* buffer =
+      iree_hal_pim_vma_buffer_cast(base_buffer);
+  if (new_PIM_rank < 0 || new_PIM_rank > IREE_HAL_PIM_BUFFER_MAX_RANK) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "PiM tensor rank %d exceeds the maximum of %d",
+                            new_PIM_rank, IREE_HAL_PIM_BUFFER_MAX_RANK);
+  }
+  if (new_PIM_rank > 0) {
+    memcpy(buffer->PIM_dim, new_PIM_dim, new_PIM_rank * sizeof(*new_PIM_dim));
+  }
+  buffer->PIM_rank = new_PIM_rank;
+  return iree_ok_status();
+}
+
+const int* iree_hal_pim_buffer_get_PiM_dim(iree_hal_buffer_t* base_buffer,
+                                           int* out_PIM_rank){
+  iree_hal_pim_vma_buffer_t* buffer =
+      iree_hal_pim_vma_buffer_cast(base_buffer);
+  *out_PIM_rank = buffer->PIM_rank;
+  return buffer->PIM_dim;
+}
+
+// Acquires/releases the host shadow lock if the shadow may be published
+// concurrently by a queue thread.
+static void iree_hal_pim_vma_buffer_lock_shadow(
+    iree_hal_pim_vma_buffer_t* buffer) {
+  if (buffer->double_buffered) iree_slim_mutex_lock(&buffer->shadow_mutex);
+}
+static void iree_hal_pim_vma_buffer_unlock_shadow(
+    iree_hal_pim_vma_buffer_t* buffer) {
+  if (buffer->double_buffered) iree_slim_mutex_unlock(&buffer->shadow_mutex);
+}
+
+// Drops all placements overlapping [byte_offset, byte_offset + byte_length)
+// and returns their device allocations to the pool.
+static void iree_hal_pim_vma_buffer_drop_placements(
+    iree_hal_pim_vma_buffer_t* buffer, iree_device_size_t byte_offset,
+    iree_device_size_t byte_length) {
+  iree_slim_mutex_lock(&buffer->placement_mutex);
+  iree_host_size_t kept_count = 0;
+  for (iree_host_size_t i = 0; i < buffer->placement_count; ++i) {
+    iree_hal_pim_buffer_placement_t* placement = &buffer->placements[i];
+    bool overlaps =
+        placement->byte_offset < byte_offset + byte_length &&
+        byte_offset < placement->byte_offset + placement->byte_length;
+    if (overlaps) {
+      iree_hal_pim_allocator_recycle_address(buffer->base.device_allocator,
+                                             placement->PIM_addr,
+                                             placement->PIM_capacity);
+    } else {
+      buffer->placements[kept_count++] = *placement;
+    }
+  }
+  buffer->placement_count = kept_count;
+  iree_slim_mutex_unlock(&buffer->placement_mutex);
+}
+
+// Drops all slices overlapping [byte_offset, byte_offset + byte_length) and
+// returns their device allocations to the pool. Placements staged from the
+// range are stale as well and dropped with them.
+static void iree_hal_pim_vma_buffer_drop_slices(
+    iree_hal_pim_vma_buffer_t* buffer, iree_device_size_t byte_offset,
+    iree_device_size_t byte_length) {
+  iree_hal_pim_vma_buffer_drop_placements(buffer, byte_offset, byte_length);
+  iree_host_size_t kept_count = 0;
+  for (iree_host_size_t i = 0; i < buffer->slice_count; ++i) {
+    iree_hal_pim_buffer_slice_t* slice = &buffer->slices[i];
+    bool overlaps = slice->byte_offset < byte_offset + byte_length &&
+                    byte_offset < slice->byte_offset + slice->byte_length;
+    if (overlaps) {
+      iree_hal_pim_allocator_recycle_address(buffer->base.device_allocator,
+                                             slice->PIM_addr,
+                                             slice->PIM_capacity);
+    } else {
+      buffer->slices[kept_count++] = *slice;
+    }
+  }
+  buffer->slice_count = kept_count;
+}
+
+// Appends a slice holding the contents of the given range.
+static iree_status_t iree_hal_pim_vma_buffer_append_slice(
+    iree_hal_pim_vma_buffer_t* buffer, iree_device_size_t byte_offset,
+    iree_device_size_t byte_length, int PIM_addr, int PIM_capacity,
+    int PIM_rank, const int* PIM_dim) {
+  if (PIM_rank < 0 || PIM_rank > IREE_HAL_PIM_BUFFER_MAX_RANK) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "PiM tensor rank %d exceeds the maximum of %d",
+                            PIM_rank, IREE_HAL_PIM_BUFFER_MAX_RANK);
+  }
+  if (buffer->slice_count == buffer->slice_capacity) {
+    iree_host_size_t new_capacity = iree_max(4, buffer->slice_capacity * 2);
+    IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+        buffer->base.host_allocator, new_capacity * sizeof(*buffer->slices),
+        (void**)&buffer->slices));
+    buffer->slice_capacity = new_capacity;
+  }
+  iree_hal_pim_buffer_slice_t* slice = &buffer->slices[buffer->slice_count++];
+  slice->byte_offset = byte_offset;
+  slice->byte_length = byte_length;
+  slice->PIM_addr = PIM_addr;
+  slice->PIM_capacity = PIM_capacity;
+  if (PIM_rank > 0) {
+    memcpy(slice->PIM_dim, PIM_dim, PIM_rank * sizeof(*PIM_dim));
+  }
+  slice->PIM_rank = PIM_rank;
+  return iree_ok_status();
+}
+
+// Returns true if the range covers the entire buffer allocation.
+static bool iree_hal_pim_vma_buffer_is_whole_range(
+    iree_hal_pim_vma_buffer_t* buffer, iree_device_size_t byte_offset,
+    iree_device_size_t byte_length) {
+  return byte_offset == 0 &&
+         byte_length >= iree_hal_buffer_allocation_size(&buffer->base);
+}
+
+// Validates that the range can be addressed as a float tensor.
+static iree_status_t iree_hal_pim_vma_buffer_check_range(
+    iree_hal_pim_vma_buffer_t* buffer, iree_device_size_t byte_offset,
+    iree_device_size_t byte_length) {
+  if (byte_offset % sizeof(float) || byte_length % sizeof(float) ||
+      byte_offset + byte_length >
+          iree_hal_buffer_allocation_size(&buffer->base)) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "PiM buffer range [%" PRIdsz ", %" PRIdsz
+        ") must be float aligned and within the %" PRIdsz "B allocation",
+        byte_offset, byte_offset + byte_length,
+        iree_hal_buffer_allocation_size(&buffer->base));
+  }
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_pim_buffer_acquire_range(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t byte_offset,
+    iree_device_size_t byte_length, int* out_PIM_addr, int* out_PIM_rank,
+    const int** out_PIM_dim) {
+  iree_hal_pim_vma_buffer_t* buffer =
+      iree_hal_pim_vma_buffer_cast(base_buffer);
+
+  if (iree_hal_pim_vma_buffer_is_whole_range(buffer, byte_offset,
+                                             byte_length)) {
+    if (buffer->slice_count > 0) {
+      // Fold the slices back into a single allocation.
+      IREE_TRACE_ZONE_BEGIN_NAMED(z0, "iree_hal_pim_buffer_flatten");
+      iree_hal_pim_vma_buffer_lock_shadow(buffer);
+      iree_status_t status = iree_ok_status();
+      if (!buffer->host_shadow_valid) {
+        status = iree_hal_pim_vma_buffer_fill_shadow(buffer);
+      }
+      if (iree_status_is_ok(status)) {
+        int element_count =
+            (int)(iree_hal_buffer_allocation_size(base_buffer) / sizeof(float));
+        int new_addr = iree_hal_pim_sdk_alloc_buffer(
+            iree_hal_pim_vma_buffer_simulation(buffer), element_count,
+            buffer->host_shadow);
+        iree_hal_pim_vma_buffer_drop_slices(buffer, 0, IREE_WHOLE_BUFFER);
+        bool shadow_valid = buffer->host_shadow_valid;
+        iree_hal_pim_buffer_push_PiM_addr(base_buffer, new_addr,
+                                          element_count);
+        buffer->host_shadow_valid = shadow_valid;
+      }
+      iree_hal_pim_vma_buffer_unlock_shadow(buffer);
+      IREE_TRACE_ZONE_END(z0);
+      IREE_RETURN_IF_ERROR(status);
+    }
+    IREE_RETURN_IF_ERROR(iree_hal_pim_buffer_materialize(base_buffer));
+    *out_PIM_addr = buffer->PIM_addr;
+    *out_PIM_rank = buffer->PIM_rank;
+    *out_PIM_dim = buffer->PIM_dim;
+    return iree_ok_status();
+  }
+
+  IREE_RETURN_IF_ERROR(
+      iree_hal_pim_vma_buffer_check_range(buffer, byte_offset, byte_length));
+  for (iree_host_size_t i = 0; i < buffer->slice_count; ++i) {
+    const iree_hal_pim_buffer_slice_t* slice = &buffer->slices[i];
+    if (slice->byte_offset == byte_offset &&
+        slice->byte_length == byte_length) {
+      *out_PIM_addr = slice->PIM_addr;
+      *out_PIM_rank = slice->PIM_rank;
+      *out_PIM_dim = slice->PIM_dim;
+      return iree_ok_status();
+    }
+  }
+
+  // The range has not been produced on its own; stage it from the composed
+  // contents as a 1-D tensor. It is kept as a slice so later reads reuse it.
+  IREE_TRACE_ZONE_BEGIN_NAMED(z0, "iree_hal_pim_buffer_stage_range");
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)byte_length);
+  iree_hal_pim_vma_buffer_lock_shadow(buffer);
+  iree_status_t status = iree_ok_status();
+  if (!buffer->host_shadow_valid) {
+    status = iree_hal_pim_vma_buffer_fill_shadow(buffer);
+  }
+  if (iree_status_is_ok(status)) {
+    int element_count = (int)(byte_length / sizeof(float));
+    int new_addr = iree_hal_pim_sdk_alloc_buffer(
+        iree_hal_pim_vma_buffer_simulation(buffer), element_count,
+        (const float*)((const uint8_t*)buffer->host_shadow + byte_offset));
+    status = iree_hal_pim_vma_buffer_append_slice(
+        buffer, byte_offset, byte_length, new_addr, element_count,
+        /*PIM_rank=*/1, &element_count);
+    if (iree_status_is_ok(status)) {
+      const iree_hal_pim_buffer_slice_t* slice =
+          &buffer->slices[buffer->slice_count - 1];
+      *out_PIM_addr = slice->PIM_addr;
+      *out_PIM_rank = slice->PIM_rank;
+      *out_PIM_dim = slice->PIM_dim;
+    } else {
+      iree_hal_pim_allocator_recycle_address(base_buffer->device_allocator,
+                                             new_addr, element_count);
+    }
+  }
+  iree_hal_pim_vma_buffer_unlock_shadow(buffer);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Returns the placement of the given shard in |out_placement| if it exists.
+static bool iree_hal_pim_vma_buffer_find_placement(
+    iree_hal_pim_vma_buffer_t* buffer, iree_device_size_t byte_offset,
+    iree_device_size_t byte_length, int axis, int shard_index, int shard_count,
+    iree_hal_pim_buffer_placement_t* out_placement) {
+  for (iree_host_size_t i = 0; i < buffer->placement_count; ++i) {
+    const iree_hal_pim_buffer_placement_t* placement = &buffer->placements[i];
+    if (placement->byte_offset == byte_offset &&
+        placement->byte_length == byte_length && placement->axis == axis &&
+        placement->shard_index == shard_index &&
+        placement->shard_count == shard_count) {
+      *out_placement = *placement;
+      return true;
+    }
+  }
+  return false;
+}
+
+iree_status_t iree_hal_pim_buffer_acquire_shard(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t byte_offset,
+    iree_device_size_t byte_length, int rows, int cols, int axis,
+    int shard_index, int shard_count, int* out_PIM_addr, int out_PIM_dim[2]) {
+  iree_hal_pim_vma_buffer_t* buffer =
+      iree_hal_pim_vma_buffer_cast(base_buffer);
+  const int extent = axis == 0 ? rows : cols;
+  if (rows <= 0 || cols <= 0 || (axis != 0 && axis != 1) || shard_count <= 0 ||
+      extent % shard_count != 0 || shard_index < 0 ||
+      shard_index >= shard_count ||
+      (iree_device_size_t)rows * cols * sizeof(float) != byte_length) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "shard %d of %d along axis %d does not evenly "
+                            "divide the %dx%d matrix in %" PRIdsz "B",
+                            shard_index, shard_count, axis, rows, cols,
+                            byte_length);
+  }
+  IREE_RETURN_IF_ERROR(
+      iree_hal_pim_vma_buffer_check_range(buffer, byte_offset, byte_length));
+
+  iree_hal_pim_buffer_placement_t placement;
+  iree_slim_mutex_lock(&buffer->placement_mutex);
+  bool found = iree_hal_pim_vma_buffer_find_placement(
+      buffer, byte_offset, byte_length, axis, shard_index, shard_count,
+      &placement);
+  iree_slim_mutex_unlock(&buffer->placement_mutex);
+  if (found) {
+    *out_PIM_addr = placement.PIM_addr;
+    memcpy(out_PIM_dim, placement.PIM_dim, sizeof(placement.PIM_dim));
+    return iree_ok_status();
+  }
+
+  // Lay the shard out densely on the host and upload it. The placement lock
+  // isn't held while reading the contents as writes to the buffer drop
+  // placements with the shadow lock held.
+  IREE_TRACE_ZONE_BEGIN_NAMED(z0, "iree_hal_pim_buffer_place_shard");
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)byte_length / shard_count);
+  std::vector<float> matrix((iree_host_size_t)rows * cols);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_pim_buffer_download_range(base_buffer, byte_offset,
+                                             matrix.data(), byte_length));
+  const int shard_rows = axis == 0 ? rows / shard_count : rows;
+  const int shard_cols = axis == 1 ? cols / shard_count : cols;
+  std::vector<float> shard((iree_host_size_t)shard_rows * shard_cols);
+  const int row_begin = axis == 0 ? shard_index * shard_rows : 0;
+  const int col_begin = axis == 1 ? shard_index * shard_cols : 0;
+  for (int r = 0; r < shard_rows; ++r) {
+    memcpy(shard.data() + (iree_host_size_t)r * shard_cols,
+           matrix.data() + (iree_host_size_t)(row_begin + r) * cols + col_begin,
+           shard_cols * sizeof(float));
+  }
+  placement.byte_offset = byte_offset;
+  placement.byte_length = byte_length;
+  placement.axis = axis;
+  placement.shard_index = shard_index;
+  placement.shard_count = shard_count;
+  placement.PIM_capacity = (int)shard.size();
+  placement.PIM_addr = iree_hal_pim_sdk_alloc_buffer(
+      iree_hal_pim_vma_buffer_simulation(buffer), placement.PIM_capacity,
+      shard.data());
+  placement.PIM_dim[0] = shard_rows;
+  placement.PIM_dim[1] = shard_cols;
+
+  // Another queue may have placed the same shard meanwhile; keep the first.
+  iree_status_t status = iree_ok_status();
+  iree_hal_pim_buffer_placement_t existing;
+  iree_slim_mutex_lock(&buffer->placement_mutex);
+  if (iree_hal_pim_vma_buffer_find_placement(
+          buffer, byte_offset, byte_length, axis, shard_index, shard_count,
+          &existing)) {
+    iree_hal_pim_allocator_recycle_address(
+        base_buffer->device_allocator, placement.PIM_addr,
+        placement.PIM_capacity);
+    placement = existing;
+  } else {
+    if (buffer->placement_count == buffer->placement_capacity) {
+      iree_host_size_t new_capacity =
+          iree_max(4, buffer->placement_capacity * 2);
+      status = iree_allocator_realloc(
+          base_buffer->host_allocator,
+          new_capacity * sizeof(*buffer->placements),
+          (void**)&buffer->placements);
+      if (iree_status_is_ok(status)) {
+        buffer->placement_capacity = new_capacity;
+      }
+    }
+    if (iree_status_is_ok(status)) {
+      buffer->placements[buffer->placement_count++] = placement;
+    } else {
+      iree_hal_pim_allocator_recycle_address(
+          base_buffer->device_allocator, placement.PIM_addr,
+          placement.PIM_capacity);
+    }
+  }
+  iree_slim_mutex_unlock(&buffer->placement_mutex);
+  if (iree_status_is_ok(status)) {
+    *out_PIM_addr = placement.PIM_addr;
+    memcpy(out_PIM_dim, placement.PIM_dim, sizeof(placement.PIM_dim));
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_hal_pim_buffer_query_range(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t byte_offset,
+    iree_device_size_t byte_length, int* out_PIM_addr, int* out_PIM_rank,
+    const int** out_PIM_dim) {
+  iree_hal_pim_vma_buffer_t* buffer =
+      iree_hal_pim_vma_buffer_cast(base_buffer);
+  static const int kNoDims[1] = {0};
+  *out_PIM_addr = IREE_HAL_PIM_BUFFER_ADDR_NONE;
+  *out_PIM_rank = 0;
+  *out_PIM_dim = kNoDims;
+  if (iree_hal_pim_vma_buffer_is_whole_range(buffer, byte_offset,
+                                             byte_length)) {
+    *out_PIM_addr = buffer->PIM_addr;
+    *out_PIM_rank = buffer->PIM_rank;
+    *out_PIM_dim = buffer->PIM_dim;
+    return iree_ok_status();
+  }
+  IREE_RETURN_IF_ERROR(
+      iree_hal_pim_vma_buffer_check_range(buffer, byte_offset, byte_length));
+  for (iree_host_size_t i = 0; i < buffer->slice_count; ++i) {
+    const iree_hal_pim_buffer_slice_t* slice = &buffer->slices[i];
+    if (slice->byte_offset == byte_offset &&
+        slice->byte_length == byte_length) {
+      *out_PIM_addr = slice->PIM_addr;
+      *out_PIM_rank = slice->PIM_rank;
+      *out_PIM_dim = slice->PIM_dim;
+      break;
+    }
+  }
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_pim_buffer_write_range(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t byte_offset,
+    iree_device_size_t byte_length, int PIM_addr, int PIM_capacity,
+    int PIM_rank, const int* PIM_dim) {
+  iree_hal_pim_vma_buffer_t* buffer =
+      iree_hal_pim_vma_buffer_cast(base_buffer);
+
+  if (iree_hal_pim_vma_buffer_is_whole_range(buffer, byte_offset,
+                                             byte_length)) {
+    iree_hal_pim_vma_buffer_drop_slices(buffer, 0, IREE_WHOLE_BUFFER);
+    iree_hal_pim_buffer_push_PiM_addr(base_buffer, PIM_addr, PIM_capacity);
+    IREE_RETURN_IF_ERROR(
+        iree_hal_pim_buffer_push_PiM_dim(base_buffer, PIM_rank, PIM_dim));
+    return iree_hal_pim_vma_buffer_stream_result(buffer);
+  }
+
+  iree_status_t status =
+      iree_hal_pim_vma_buffer_check_range(buffer, byte_offset, byte_length);
+  if (iree_status_is_ok(status)) {
+    iree_hal_pim_vma_buffer_lock_shadow(buffer);
+    iree_hal_pim_vma_buffer_drop_slices(buffer, byte_offset, byte_length);
+    status = iree_hal_pim_vma_buffer_append_slice(
+        buffer, byte_offset, byte_length, PIM_addr, PIM_capacity, PIM_rank,
+        PIM_dim);
+    buffer->host_shadow_valid = false;
+    iree_hal_pim_vma_buffer_unlock_shadow(buffer);
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_hal_pim_allocator_recycle_address(base_buffer->device_allocator,
+                                           PIM_addr, PIM_capacity);
+  }
+  return status;
+}
+
+// Resets the shape of |buffer| to a 1-D tensor of |element_count| elements
+// unless the current shape already holds that many elements.
+static void iree_hal_pim_vma_buffer_reshape_for_upload(
+    iree_hal_pim_vma_buffer_t* buffer, int element_count) {
+  int current_count = buffer->PIM_rank > 0 ? 1 : 0;
+  for (int i = 0; i < buffer->PIM_rank; ++i) {
+    current_count *= buffer->PIM_dim[i];
+  }
+  if (current_count != element_count) {
+    buffer->PIM_rank = 1;
+    buffer->PIM_dim[0] = element_count;
+  }
+}
+
+// Uploads the float-aligned |upload_data| as the device contents of
+// [upload_offset, upload_offset + upload_length). The shadow lock must be held.
+static iree_status_t iree_hal_pim_vma_buffer_upload_locked(
+    iree_hal_pim_vma_buffer_t* buffer, iree_device_size_t upload_offset,
+    iree_device_size_t upload_length, const uint8_t* upload_data) {
+  iree_hal_buffer_t* base_buffer = &buffer->base;
+  iree_status_t status = iree_ok_status();
+  int element_count = (int)(upload_length / sizeof(float));
+  int new_addr = iree_hal_pim_sdk_alloc_buffer(
+      iree_hal_pim_vma_buffer_simulation(buffer), element_count,
+      (const float*)upload_data);
+  bool shadow_valid = buffer->host_shadow_valid;
+  if (iree_hal_pim_vma_buffer_is_whole_range(buffer, upload_offset,
+                                             upload_length)) {
+    iree_hal_pim_vma_buffer_drop_slices(buffer, 0, IREE_WHOLE_BUFFER);
+    iree_hal_pim_buffer_push_PiM_addr(base_buffer, new_addr, element_count);
+    iree_hal_pim_vma_buffer_reshape_for_upload(buffer, element_count);
+  } else {
+    iree_hal_pim_vma_buffer_drop_slices(buffer, upload_offset, upload_length);
+    status = iree_hal_pim_vma_buffer_append_slice(
+        buffer, upload_offset, upload_length, new_addr, element_count,
+        /*PIM_rank=*/1, &element_count);
+    if (!iree_status_is_ok(status)) {
+      iree_hal_pim_allocator_recycle_address(base_buffer->device_allocator,
+                                             new_addr, element_count);
+      shadow_valid = false;
+    }
+  }
+  buffer->host_shadow_valid = shadow_valid;
+  return status;
+}
+
+iree_status_t iree_hal_pim_buffer_upload_range(iree_hal_buffer_t* base_buffer,
+                                               iree_device_size_t byte_offset,
+                                               const void* source,
+                                               iree_device_size_t byte_length) {
+  iree_hal_pim_vma_buffer_t* buffer =
+      iree_hal_pim_vma_buffer_cast(base_buffer);
+  if (byte_length == 0) return iree_ok_status();
+  if (byte_offset + byte_length >
+      iree_hal_buffer_allocation_size(base_buffer)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "upload range [%" PRIdsz ", %" PRIdsz
+                            ") exceeds the %" PRIdsz "B allocation",
+                            byte_offset, byte_offset + byte_length,
+                            iree_hal_buffer_allocation_size(base_buffer));
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)byte_length);
+
+  iree_hal_pim_vma_buffer_lock_shadow(buffer);
+  iree_status_t status = iree_ok_status();
+
+  // The SDK addresses floats; ranges that split an element are merged into the
+  // current contents of the enclosing float range first.
+  const uint8_t* upload_data = (const uint8_t*)source;
+  iree_device_size_t upload_offset = byte_offset;
+  iree_device_size_t upload_length = byte_length;
+  if (byte_offset % sizeof(float) || byte_length % sizeof(float)) {
+    upload_offset = byte_offset / sizeof(float) * sizeof(float);
+    upload_length = iree_device_align(byte_offset + byte_length,
+                                      sizeof(float)) -
+                    upload_offset;
+    if (!buffer->host_shadow_valid) {
+      status = iree_hal_pim_vma_buffer_fill_shadow(buffer);
+    }
+    if (iree_status_is_ok(status)) {
+      memcpy((uint8_t*)buffer->host_shadow + byte_offset, source, byte_length);
+      upload_data = (const uint8_t*)buffer->host_shadow + upload_offset;
+    }
+  } else if (buffer->host_shadow_valid) {
+    // Keep the shadow coherent instead of reading the device back later.
+    memcpy((uint8_t*)buffer->host_shadow + byte_offset, source, byte_length);
+  }
+
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_pim_vma_buffer_upload_locked(buffer, upload_offset,
+                                                   upload_length, upload_data);
+  }
+
+  iree_hal_pim_vma_buffer_unlock_shadow(buffer);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_hal_pim_buffer_download_range(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t byte_offset,
+    void* target, iree_device_size_t byte_length) {
+  iree_hal_pim_vma_buffer_t* buffer =
+      iree_hal_pim_vma_buffer_cast(base_buffer);
+  if (byte_length == 0) return iree_ok_status();
+  if (byte_offset + byte_length >
+      iree_hal_buffer_allocation_size(base_buffer)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "download range [%" PRIdsz ", %" PRIdsz
+                            ") exceeds the %" PRIdsz "B allocation",
+                            byte_offset, byte_offset + byte_length,
+                            iree_hal_buffer_allocation_size(base_buffer));
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)byte_length);
+
+  iree_hal_pim_vma_buffer_lock_shadow(buffer);
+  iree_status_t status = iree_ok_status();
+  if (buffer->host_shadow_valid) {
+    memcpy(target, (const uint8_t*)buffer->host_shadow + byte_offset,
+           byte_length);
+    iree_hal_pim_vma_buffer_unlock_shadow(buffer);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  // Find the single device allocation holding the range, if any. A slice
+  // produced for exactly the range is read on its own and a range no slice
+  // overlaps is read from the base allocation. The SDK only reads from the
+  // start of an allocation so reads of the base stop at the end of the range.
+  int source_addr = buffer->PIM_addr;
+  int source_capacity = buffer->PIM_capacity;
+  iree_device_size_t source_offset = byte_offset;
+  iree_device_size_t source_end = byte_offset + byte_length;
+  bool needs_compose = false;
+  for (iree_host_size_t i = 0; i < buffer->slice_count; ++i) {
+    const iree_hal_pim_buffer_slice_t* slice = &buffer->slices[i];
+    if (slice->byte_offset == byte_offset &&
+        slice->byte_length == byte_length) {
+      source_addr = slice->PIM_addr;
+      source_capacity = slice->PIM_capacity;
+      source_offset = 0;
+      source_end = byte_length;
+      needs_compose = false;
+      break;
+    }
+    if (slice->byte_offset < byte_offset + byte_length &&
+        byte_offset < slice->byte_offset + slice->byte_length) {
+      needs_compose = true;
+    }
+  }
+
+  iree_host_size_t staging_count =
+      iree_device_align(source_end, sizeof(float)) / sizeof(float);
+  if (needs_compose || staging_count > (iree_host_size_t)source_capacity) {
+    status = iree_hal_pim_vma_buffer_fill_shadow(buffer);
+    if (iree_status_is_ok(status)) {
+      memcpy(target, (const uint8_t*)buffer->host_shadow + byte_offset,
+             byte_length);
+    }
+  } else if (source_addr == IREE_HAL_PIM_BUFFER_ADDR_NONE) {
+    // Reserved buffers read back as zeros without touching the device.
+    memset(target, 0, byte_length);
+  } else {
+    std::vector<float> staging(staging_count);
+    iree_hal_pim_sdk_read_buffer(iree_hal_pim_vma_buffer_simulation(buffer),
+                                 source_addr, (int)staging_count,
+                                 staging.data());
+    memcpy(target, (const uint8_t*)staging.data() + source_offset,
+           byte_length);
+  }
+
+  iree_hal_pim_vma_buffer_unlock_shadow(buffer);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_hal_pim_buffer_copy_range(
+    iree_hal_buffer_t* source_base_buffer, iree_device_size_t source_offset,
+    iree_hal_buffer_t* target_base_buffer, iree_device_size_t target_offset,
+    iree_device_size_t byte_length) {
+  iree_hal_pim_vma_buffer_t* source_buffer =
+      iree_hal_pim_vma_buffer_cast(source_base_buffer);
+  if (byte_length == 0) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)byte_length);
+
+  iree_status_t status = iree_ok_status();
+  if (source_offset % sizeof(float) || target_offset % sizeof(float) ||
+      byte_length % sizeof(float)) {
+    // Ranges splitting a float can't be shared; stage them through the host.
+    std::vector<uint8_t> staging(byte_length);
+    status = iree_hal_pim_buffer_download_range(
+        source_base_buffer, source_offset, staging.data(), byte_length);
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_pim_buffer_upload_range(
+          target_base_buffer, target_offset, staging.data(), byte_length);
+    }
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  // Make the source range a device allocation of its own (usually it already
+  // is one, such as a dispatch result) and share it with the target. Device
+  // allocations are never written in place so no data needs to move.
+  int PIM_addr = IREE_HAL_PIM_BUFFER_ADDR_NONE;
+  int PIM_rank = 0;
+  const int* PIM_dim = NULL;
+  status = iree_hal_pim_buffer_acquire_range(source_base_buffer, source_offset,
+                                             byte_length, &PIM_addr, &PIM_rank,
+                                             &PIM_dim);
+  int PIM_capacity = source_buffer->PIM_capacity;
+  if (!iree_hal_pim_vma_buffer_is_whole_range(source_buffer, source_offset,
+                                              byte_length)) {
+    for (iree_host_size_t i = 0; i < source_buffer->slice_count; ++i) {
+      if (source_buffer->slices[i].PIM_addr == PIM_addr) {
+        PIM_capacity = source_buffer->slices[i].PIM_capacity;
+        break;
+      }
+    }
+  }
+  // Copying the same contents again must not add another owner.
+  iree_hal_pim_vma_buffer_t* target_buffer =
+      iree_hal_pim_vma_buffer_cast(target_base_buffer);
+  bool already_shared = false;
+  if (iree_hal_pim_vma_buffer_is_whole_range(target_buffer, target_offset,
+                                             byte_length)) {
+    already_shared =
+        target_buffer->slice_count == 0 && target_buffer->PIM_addr == PIM_addr;
+  } else {
+    for (iree_host_size_t i = 0; i < target_buffer->slice_count; ++i) {
+      const iree_hal_pim_buffer_slice_t* slice = &target_buffer->slices[i];
+      already_shared = already_shared ||
+                       (slice->byte_offset == target_offset &&
+                        slice->byte_length == byte_length &&
+                        slice->PIM_addr == PIM_addr);
+    }
+  }
+  if (iree_status_is_ok(status) && !already_shared) {
+    // The shape storage belongs to the source and may move if the target is
+    // the same buffer.
+    int dims[IREE_HAL_PIM_BUFFER_MAX_RANK];
+    memcpy(dims, PIM_dim, PIM_rank * sizeof(*dims));
+    iree_hal_pim_allocator_share_address(PIM_addr);
+    status = iree_hal_pim_buffer_write_range(target_base_buffer, target_offset,
+                                             byte_length, PIM_addr,
+                                             PIM_capacity, PIM_rank, dims);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_hal_pim_buffer_fill_range(iree_hal_buffer_t* base_buffer,
+                                             iree_device_size_t byte_offset,
+                                             iree_device_size_t byte_length,
+                                             const void* pattern,
+                                             iree_host_size_t pattern_length) {
+  iree_hal_pim_vma_buffer_t* buffer =
+      iree_hal_pim_vma_buffer_cast(base_buffer);
+  if (byte_length == 0) return iree_ok_status();
+  if (pattern_length == 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "fill pattern must not be empty");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)byte_length);
+
+  bool is_zero = true;
+  for (iree_host_size_t i = 0; i < pattern_length; ++i) {
+    is_zero = is_zero && ((const uint8_t*)pattern)[i] == 0;
+  }
+  if (is_zero &&
+      iree_hal_pim_vma_buffer_is_whole_range(buffer, byte_offset,
+                                             byte_length)) {
+    // Reserved buffers read as zeros so zero-initialization only drops the
+    // current contents. Most are overwritten by a dispatch before ever being
+    // read and never need a device allocation at all.
+    iree_hal_pim_buffer_release_storage(base_buffer);
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
+  }
+
+  // The SDK can only allocate with contents so the pattern is expanded on the
+  // host and uploaded once; the rest of the buffer is left untouched.
+  std::vector<uint8_t> data(byte_length);
+  for (iree_device_size_t i = 0; i < byte_length; i += pattern_length) {
+    memcpy(data.data() + i, pattern,
+           iree_min((iree_device_size_t)pattern_length, byte_length - i));
+  }
+  iree_status_t status = iree_hal_pim_buffer_upload_range(
+      base_buffer, byte_offset, data.data(), byte_length);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+bool iree_hal_pim_buffer_isa(iree_hal_buffer_t* base_buffer) {
+  return iree_hal_resource_is(base_buffer, &iree_hal_pim_vma_buffer_vtable);
+}
+
+void iree_hal_pim_buffer_bind_pooled_storage(iree_hal_buffer_t* base_buffer) {
+  iree_hal_pim_vma_buffer_t* buffer =
+      iree_hal_pim_vma_buffer_cast(base_buffer);
+  if (buffer->PIM_addr != IREE_HAL_PIM_BUFFER_ADDR_NONE) return;
+  int PIM_addr = IREE_HAL_PIM_BUFFER_ADDR_NONE;
+  int PIM_capacity = 0;
+  if (iree_hal_pim_allocator_acquire_address(base_buffer->device_allocator,
+                                             buffer->PIM_capacity, &PIM_addr,
+                                             &PIM_capacity)) {
+    iree_hal_pim_buffer_push_PiM_addr(base_buffer, PIM_addr, PIM_capacity);
+  }
+}
+
+void iree_hal_pim_buffer_release_storage(iree_hal_buffer_t* base_buffer) {
+  iree_hal_pim_vma_buffer_t* buffer =
+      iree_hal_pim_vma_buffer_cast(base_buffer);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_pim_vma_buffer_lock_shadow(buffer);
+  iree_hal_pim_vma_buffer_drop_slices(buffer, 0, IREE_WHOLE_BUFFER);
+  if (buffer->PIM_addr != IREE_HAL_PIM_BUFFER_ADDR_NONE) {
+    iree_hal_pim_allocator_recycle_address(base_buffer->device_allocator,
+                                           buffer->PIM_addr,
+                                           buffer->PIM_capacity);
+    buffer->PIM_addr = IREE_HAL_PIM_BUFFER_ADDR_NONE;
+  }
+  // Reserved buffers are sized by their byte length again so that a later
+  // materialization doesn't depend on the capacity of the released address.
+  buffer->PIM_capacity =
+      (int)(iree_hal_buffer_allocation_size(base_buffer) / sizeof(float));
+  buffer->host_shadow_valid = false;
+  buffer->evicted = false;
+  iree_hal_pim_vma_buffer_unlock_shadow(buffer);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+iree_status_t iree_hal_pim_buffer_evict(iree_hal_buffer_t* base_buffer) {
+  iree_hal_pim_vma_buffer_t* buffer =
+      iree_hal_pim_vma_buffer_cast(base_buffer);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(
+      z0, (int64_t)iree_hal_buffer_allocation_size(base_buffer));
+  iree_hal_pim_vma_buffer_lock_shadow(buffer);
+  iree_status_t status = iree_ok_status();
+  if (buffer->evicted) {
+    iree_hal_pim_vma_buffer_unlock_shadow(buffer);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  // Imported weights still alias the caller's memory and constants are read
+  // back once; either way the shadow holds the composed contents afterwards.
+  if (!buffer->host_shadow_valid) {
+    status = iree_hal_pim_vma_buffer_fill_shadow(buffer);
+  }
+  if (iree_status_is_ok(status)) {
+    iree_hal_pim_vma_buffer_drop_slices(buffer, 0, IREE_WHOLE_BUFFER);
+    if (buffer->PIM_addr != IREE_HAL_PIM_BUFFER_ADDR_NONE) {
+      iree_hal_pim_allocator_recycle_address(base_buffer->device_allocator,
+                                             buffer->PIM_addr,
+                                             buffer->PIM_capacity);
+      buffer->PIM_addr = IREE_HAL_PIM_BUFFER_ADDR_NONE;
+    }
+    buffer->PIM_capacity =
+        (int)(iree_hal_buffer_allocation_size(base_buffer) / sizeof(float));
+    buffer->evicted = true;
+  }
+  iree_hal_pim_vma_buffer_unlock_shadow(buffer);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_pim_vma_buffer_destroy(iree_hal_buffer_t* base_buffer) {
+  iree_hal_pim_vma_buffer_t* buffer =
+      iree_hal_pim_vma_buffer_cast(base_buffer);
+  iree_allocator_t host_allocator = base_buffer->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(
+      z0, (int64_t)iree_hal_buffer_allocation_size(base_buffer));
+
+  if (buffer->release_callback.fn) {
+    buffer->release_callback.fn(buffer->release_callback.user_data,
+                                base_buffer);
+  }
+  if (buffer->host_shadow_owned) {
+    iree_allocator_free(host_allocator, buffer->host_shadow);
+  }
+  iree_allocator_free(host_allocator, buffer->host_back_shadow);
+  // The base allocation is returned by the allocator; slices are ours.
+  for (iree_host_size_t i = 0; i < buffer->slice_count; ++i) {
+    iree_hal_pim_allocator_recycle_address(base_buffer->device_allocator,
+                                           buffer->slices[i].PIM_addr,
+                                           buffer->slices[i].PIM_capacity);
+  }
+  iree_allocator_free(host_allocator, buffer->slices);
+  for (iree_host_size_t i = 0; i < buffer->placement_count; ++i) {
+    iree_hal_pim_allocator_recycle_address(base_buffer->device_allocator,
+                                           buffer->placements[i].PIM_addr,
+                                           buffer->placements[i].PIM_capacity);
+  }
+  iree_allocator_free(host_allocator, buffer->placements);
+  iree_slim_mutex_deinitialize(&buffer->placement_mutex);
+  iree_slim_mutex_deinitialize(&buffer->shadow_mutex);
+  iree_allocator_free(host_allocator, buffer);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+
+static iree_status_t iree_hal_pim_vma_buffer_map_range(
+    iree_hal_buffer_t* base_buffer, iree_hal_mapping_mode_t mapping_mode,
+    iree_hal_memory_access_t memory_access,
+    iree_device_size_t local_byte_offset, iree_device_size_t local_byte_length,
+    iree_hal_buffer_mapping_t* mapping) {
+  iree_hal_pim_vma_buffer_t* buffer =
+      iree_hal_pim_vma_buffer_cast(base_buffer);
+
+  // Double-buffered results may be published by a queue thread concurrently.
+  if (buffer->double_buffered) iree_slim_mutex_lock(&buffer->shadow_mutex);
+
+  iree_status_t status = iree_ok_status();
+  if (!buffer->host_shadow_valid) {
+    status = iree_hal_pim_vma_buffer_fill_shadow(buffer);
+  }
+  if (iree_status_is_ok(status)) {
+    mapping->contents = iree_make_byte_span(
+        (uint8_t*)buffer->host_shadow + local_byte_offset, local_byte_length);
+  }
+
+  if (buffer->double_buffered) iree_slim_mutex_unlock(&buffer->shadow_mutex);
+  return status;
+}
+
+// Uploads the host writes made through mappings of
+// [local_byte_offset, local_byte_offset + local_byte_length) to the device.
+static iree_status_t iree_hal_pim_vma_buffer_flush_range(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t local_byte_offset,
+    iree_device_size_t local_byte_length) {
+  iree_hal_pim_vma_buffer_t* buffer =
+      iree_hal_pim_vma_buffer_cast(base_buffer);
+  if (local_byte_length == 0) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)local_byte_length);
+
+  iree_hal_pim_vma_buffer_lock_shadow(buffer);
+  iree_status_t status = iree_ok_status();
+  // Evicted buffers are restored from the shadow when next used and a shadow
+  // that isn't valid holds no mapped contents.
+  if (buffer->host_shadow_valid && !buffer->evicted) {
+    // The SDK addresses floats; the shadow holds the contents around the
+    // range so it is widened to whole elements.
+    iree_device_size_t upload_offset =
+        local_byte_offset / sizeof(float) * sizeof(float);
+    iree_device_size_t upload_length =
+        iree_device_align(local_byte_offset + local_byte_length,
+                          sizeof(float)) -
+        upload_offset;
+    status = iree_hal_pim_vma_buffer_upload_locked(
+        buffer, upload_offset, upload_length,
+        (const uint8_t*)buffer->host_shadow + upload_offset);
+  }
+  iree_hal_pim_vma_buffer_unlock_shadow(buffer);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static iree_status_t iree_hal_pim_vma_buffer_unmap_range(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t local_byte_offset,
+    iree_device_size_t local_byte_length, iree_hal_buffer_mapping_t* mapping) {
+  // The host shadow is kept for future mappings and freed with the buffer;
+  // writes made through the mapping are uploaded to the device.
+  if (!iree_any_bit_set(mapping->impl.allowed_access,
+                        IREE_HAL_MEMORY_ACCESS_WRITE)) {
+    return iree_ok_status();
+  }
+  return iree_hal_pim_vma_buffer_flush_range(base_buffer, local_byte_offset,
+                                             local_byte_length);
+}
+
+// Refreshes the host shadow with the device contents so that mappings observe
+// device writes made since they were mapped.
+static iree_status_t iree_hal_pim_vma_buffer_invalidate_range(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t local_byte_offset,
+    iree_device_size_t local_byte_length) {
+  iree_hal_pim_vma_buffer_t* buffer =
+      iree_hal_pim_vma_buffer_cast(base_buffer);
+  iree_hal_pim_vma_buffer_lock_shadow(buffer);
+  iree_status_t status = iree_ok_status();
+  // Evicted buffers hold their contents only in the shadow. A shadow too
+  // small for the current device allocation would move when refilled so it is
+  // marked stale instead and refilled by the next mapping.
+  iree_host_size_t shadow_size = iree_max(
+      (iree_host_size_t)iree_hal_buffer_allocation_size(base_buffer),
+      (iree_host_size_t)buffer->PIM_capacity * sizeof(float));
+  if (!buffer->evicted) {
+    if (buffer->host_shadow && shadow_size > buffer->host_shadow_size) {
+      buffer->host_shadow_valid = false;
+    } else {
+      status = iree_hal_pim_vma_buffer_fill_shadow(buffer);
+    }
+  }
+  iree_hal_pim_vma_buffer_unlock_shadow(buffer);
+  return status;
+}
+
+namespace {
+const iree_hal_buffer_vtable_t iree_hal_pim_vma_buffer_vtable = {
+    /*.recycle=*/iree_hal_buffer_recycle,
+    /*.destroy=*/iree_hal_pim_vma_buffer_destroy,
+    /*.map_range=*/iree_hal_pim_vma_buffer_map_range,
+    /*.unmap_range=*/iree_hal_pim_vma_buffer_unmap_range,
+    /*.invalidate_range=*/iree_hal_pim_vma_buffer_invalidate_range,
+    /*.flush_range=*/iree_hal_pim_vma_buffer_flush_range,
+};
+}  // namespace
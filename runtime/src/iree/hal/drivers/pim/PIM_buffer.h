@@ -0,0 +1,182 @@
+// Copyright 2019 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_PIM_VMA_BUFFER_H_
+#define IREE_HAL_DRIVERS_PIM_VMA_BUFFER_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// PiM address of a buffer that has only been reserved. The device allocation
+// is made lazily the first time the contents are read by a dispatch.
+#define IREE_HAL_PIM_BUFFER_ADDR_NONE (-1)
+
+// Maximum rank of the tensor shape tracked alongside a PiM buffer.
+#define IREE_HAL_PIM_BUFFER_MAX_RANK 8
+
+// Wraps a PiM device allocation. |PIM_dim| provides |PIM_rank| dimensions of
+// the tensor stored at |PIM_addr| and is copied into the buffer.
+iree_status_t iree_hal_PIM_buffer_wrap(
+    iree_hal_allocator_t* allocator, iree_hal_memory_type_t memory_type,
+    iree_hal_memory_access_t allowed_access,
+    iree_hal_buffer_usage_t allowed_usage, iree_device_size_t allocation_size,
+    iree_device_size_t byte_offset, iree_device_size_t byte_length,
+    int PIM_addr, int PIM_capacity, int PIM_rank, const int* PIM_dim,
+    iree_hal_buffer_t** out_buffer);
+
+// Makes |host_ptr| the host-side view of |base_buffer|. Mappings of the buffer
+// alias the external memory and device readbacks are written into it when it
+// is large enough. Host writes to |host_ptr| are uploaded to the device only
+// when the range is flushed. |release_callback| is issued when the buffer is
+// destroyed, after which the buffer no longer references |host_ptr|.
+void iree_hal_pim_buffer_attach_host_allocation(
+    iree_hal_buffer_t* base_buffer, void* host_ptr, iree_host_size_t host_size,
+    iree_hal_buffer_release_callback_t release_callback);
+
+// Enables double-buffered result readback for |base_buffer|.
+// Results written over the whole buffer by dispatches are read back eagerly on
+// the queue thread by iree_hal_pim_buffer_write_range into a second host
+// shadow that is swapped in once complete. A mapping of step N remains valid
+// while step N+1 executes and is only overwritten by the readback of step N+2.
+void iree_hal_pim_buffer_enable_double_buffering(
+    iree_hal_buffer_t* base_buffer);
+
+// Returns the device tensor holding the contents of the byte range
+// [|byte_offset|, |byte_offset| + |byte_length|) of the allocated buffer
+// |base_buffer| so that it can be read by a dispatch.
+//
+// The SDK only addresses whole allocations: ranges previously written by a
+// dispatch are returned as-is and any other subrange is staged into a device
+// allocation of its own as a 1-D tensor. Ranges must be float aligned.
+iree_status_t iree_hal_pim_buffer_acquire_range(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t byte_offset,
+    iree_device_size_t byte_length, int* out_PIM_addr, int* out_PIM_rank,
+    const int** out_PIM_dim);
+
+// Returns the device tensor holding shard |shard_index| of |shard_count| of
+// the row-major [|rows|, |cols|] float matrix in the byte range
+// [|byte_offset|, |byte_offset| + |byte_length|) of |base_buffer|. Shards
+// split the matrix evenly along |axis| (0 rows, 1 columns) and are laid out
+// densely as a [rows, cols] tensor whose dims are returned in |out_PIM_dim|.
+//
+// Weights read by instructions split across PIM modules are placed the first
+// time each module reads its shard and then stay on the device until the range
+// is written so no re-layout happens on later dispatches. Safe to call from
+// the queue threads of several modules at once.
+iree_status_t iree_hal_pim_buffer_acquire_shard(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t byte_offset,
+    iree_device_size_t byte_length, int rows, int cols, int axis,
+    int shard_index, int shard_count, int* out_PIM_addr, int out_PIM_dim[2]);
+
+// Returns the device tensor currently holding the range without staging it.
+// |out_PIM_addr| is IREE_HAL_PIM_BUFFER_ADDR_NONE if the range has no device
+// allocation of its own. Used for dispatch results that are replaced anyway.
+iree_status_t iree_hal_pim_buffer_query_range(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t byte_offset,
+    iree_device_size_t byte_length, int* out_PIM_addr, int* out_PIM_rank,
+    const int** out_PIM_dim);
+
+// Makes the device allocation |PIM_addr| the contents of the byte range of
+// |base_buffer|, taking ownership of it. Allocations no longer referenced are
+// returned to the allocator pool. For double-buffered buffers whole-buffer
+// results are read back before returning; this must be called on the queue
+// thread before the submission signals its semaphores.
+iree_status_t iree_hal_pim_buffer_write_range(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t byte_offset,
+    iree_device_size_t byte_length, int PIM_addr, int PIM_capacity,
+    int PIM_rank, const int* PIM_dim);
+
+// Copies |byte_length| bytes from |source| into the byte range of
+// |base_buffer| starting at |byte_offset| without reading back the rest of the
+// buffer. The data is uploaded as a device allocation of its own (a slice for
+// subranges); only ranges that split a float are merged with the current
+// contents first.
+iree_status_t iree_hal_pim_buffer_upload_range(iree_hal_buffer_t* base_buffer,
+                                               iree_device_size_t byte_offset,
+                                               const void* source,
+                                               iree_device_size_t byte_length);
+
+// Copies |byte_length| bytes of |base_buffer| starting at |byte_offset| into
+// |target|. Ranges held by a single device allocation are read directly and
+// only ranges spanning several allocations are composed in the host shadow.
+iree_status_t iree_hal_pim_buffer_download_range(
+    iree_hal_buffer_t* base_buffer, iree_device_size_t byte_offset,
+    void* target, iree_device_size_t byte_length);
+
+// Copies |byte_length| bytes from |source_base_buffer| to |target_base_buffer|
+// on the device. The source range is made a device allocation of its own if it
+// isn't one already and is then shared with the target range; device
+// allocations are never modified in place so no data is moved. Ranges that
+// split a float are staged through host memory.
+iree_status_t iree_hal_pim_buffer_copy_range(
+    iree_hal_buffer_t* source_base_buffer, iree_device_size_t source_offset,
+    iree_hal_buffer_t* target_base_buffer, iree_device_size_t target_offset,
+    iree_device_size_t byte_length);
+
+// Fills the byte range of |base_buffer| with the repeating |pattern|.
+// Zero-filling a whole buffer returns its device allocations to the pool as
+// reserved buffers read back as zeros.
+iree_status_t iree_hal_pim_buffer_fill_range(iree_hal_buffer_t* base_buffer,
+                                             iree_device_size_t byte_offset,
+                                             iree_device_size_t byte_length,
+                                             const void* pattern,
+                                             iree_host_size_t pattern_length);
+
+// Returns true if |base_buffer| is a PiM buffer.
+bool iree_hal_pim_buffer_isa(iree_hal_buffer_t* base_buffer);
+
+// Binds a device allocation from the allocator pool to a reserved buffer.
+// Contents are undefined afterwards. The buffer stays reserved (and is
+// materialized lazily) if the pool has no suitable allocation.
+void iree_hal_pim_buffer_bind_pooled_storage(iree_hal_buffer_t* base_buffer);
+
+// Returns all device allocations of |base_buffer| to the allocator pool and
+// leaves the buffer reserved. Contents are undefined afterwards.
+void iree_hal_pim_buffer_release_storage(iree_hal_buffer_t* base_buffer);
+
+// Moves the contents of |base_buffer| into its host shadow and returns all of
+// its device allocations to the allocator pool. The buffer is reserved
+// afterwards and its contents are uploaded again by
+// iree_hal_pim_buffer_materialize the next time a dispatch reads it.
+iree_status_t iree_hal_pim_buffer_evict(iree_hal_buffer_t* base_buffer);
+
+// PiM SDK impl
+int iree_hal_pim_buffer_get_PiM_addr(iree_hal_buffer_t* base_buffer);
+
+// Ensures a reserved buffer is backed by a device allocation. Evicted buffers
+// are restored from host memory and all others are zero-initialized.
+// No-op if the buffer already has a PiM address.
+iree_status_t iree_hal_pim_buffer_materialize(iree_hal_buffer_t* base_buffer);
+
+// Returns the number of float elements backing the buffer's PiM address.
+// This may be larger than the buffer byte length if the address was reused
+// from the allocator pool.
+int iree_hal_pim_buffer_get_PiM_capacity(iree_hal_buffer_t* base_buffer);
+
+// Replaces the device allocation backing the buffer. The previous allocation is
+// owned by the buffer and is returned to the allocator pool.
+void iree_hal_pim_buffer_push_PiM_addr(iree_hal_buffer_t* base_buffer,
+                                       int new_PIM_addr, int new_PIM_capacity);
+
+// Replaces the tensor shape of the buffer with |new_PIM_rank| dimensions.
+iree_status_t iree_hal_pim_buffer_push_PiM_dim(iree_hal_buffer_t* base_buffer,
+                                               int new_PIM_rank,
+                                               const int* new_PIM_dim);
+
+// Returns the tensor shape of the buffer and its rank in |out_PIM_rank|.
+// The storage is owned by the buffer and valid until the shape is next pushed.
+const int* iree_hal_pim_buffer_get_PiM_dim(iree_hal_buffer_t* base_buffer,
+                                           int* out_PIM_rank);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_PIM_VMA_BUFFER_H_
@@ -0,0 +1,656 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/pim/PIM_channel.h"
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/drivers/pim/PIM_buffer.h"
+#include "iree/hal/drivers/pim/PIM_profiling.h"
+#include "iree/hal/drivers/pim/PIM_sdk.h"
+
+// Maximum time a participant waits at a barrier for its peers. A peer that
+// never arrives (such as one whose queue failed earlier work or that shares a
+// queue thread with another participant) aborts the group instead of hanging
+// every other queue thread of the group forever.
+#if !defined(IREE_HAL_PIM_CHANNEL_BARRIER_TIMEOUT_MS)
+#define IREE_HAL_PIM_CHANNEL_BARRIER_TIMEOUT_MS (60 * 1000)
+#endif  // !IREE_HAL_PIM_CHANNEL_BARRIER_TIMEOUT_MS
+
+//===----------------------------------------------------------------------===//
+// iree_hal_pim_channel_group_t
+//===----------------------------------------------------------------------===//
+
+// Rendezvous state shared by all channels created with the same ID.
+// Groups are kept in a process-wide registry while any channel references
+// them.
+typedef struct iree_hal_pim_channel_group_t {
+  // Registry link guarded by the registry mutex.
+  struct iree_hal_pim_channel_group_t* next;
+  // Number of live channels in the group guarded by the registry mutex.
+  int32_t ref_count;
+
+  // Total number of participants in the group.
+  int32_t count;
+  // Queue executing the collectives of each live rank or NULL if the rank has
+  // no channel. Guarded by the registry mutex.
+  const void** rank_queues;
+
+  // Posted whenever a barrier generation completes or the group fails.
+  iree_notification_t notification;
+
+  iree_slim_mutex_t mutex;
+  // Number of participants waiting in the current barrier generation.
+  int32_t arrived IREE_GUARDED_BY(mutex);
+  // Incremented each time all participants arrive at a barrier.
+  uint64_t generation IREE_GUARDED_BY(mutex);
+  // OK or the reason the group failed. Once a participant has failed the
+  // ranks no longer agree on which collective they are executing so the
+  // failure is permanent and all barriers fail with it.
+  iree_status_t failure_status IREE_GUARDED_BY(mutex);
+
+  // Host staging of each rank's send data for the collective in flight.
+  // Entries are only valid between the two barriers of a collective.
+  const float** contributions;
+
+  iree_const_byte_span_t id;
+} iree_hal_pim_channel_group_t;
+
+typedef struct iree_hal_pim_channel_registry_t {
+  iree_slim_mutex_t mutex;
+  iree_hal_pim_channel_group_t* head IREE_GUARDED_BY(mutex);
+} iree_hal_pim_channel_registry_t;
+
+static iree_hal_pim_channel_registry_t* iree_hal_pim_channel_registry() {
+  static iree_hal_pim_channel_registry_t registry;
+  static bool initialized = (iree_slim_mutex_initialize(&registry.mutex), true);
+  (void)initialized;
+  return &registry;
+}
+
+// Returns a referenced group for |id| joined as |rank| executing on |queue|,
+// creating the group if it does not exist.
+static iree_status_t iree_hal_pim_channel_group_acquire(
+    iree_const_byte_span_t id, int32_t rank, int32_t count,
+    const void* queue, iree_allocator_t host_allocator,
+    iree_hal_pim_channel_group_t** out_group) {
+  iree_hal_pim_channel_registry_t* registry = iree_hal_pim_channel_registry();
+  iree_slim_mutex_lock(&registry->mutex);
+
+  iree_status_t status = iree_ok_status();
+  iree_hal_pim_channel_group_t* group = registry->head;
+  for (; group; group = group->next) {
+    if (group->id.data_length == id.data_length &&
+        memcmp(group->id.data, id.data, id.data_length) == 0) {
+      break;
+    }
+  }
+  if (group && group->count != count) {
+    status = iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "channel group already exists with %d participants but %d requested",
+        group->count, count);
+  } else if (group && count > 1 && group->rank_queues[rank]) {
+    status = iree_make_status(IREE_STATUS_ALREADY_EXISTS,
+                              "rank %d of the channel group already has a "
+                              "channel",
+                              rank);
+  } else if (group) {
+    // Participants rendezvous on the queue threads executing the collectives
+    // so two ranks on one queue would wait on each other forever. Channels of
+    // a single participant never wait and may share a group freely.
+    for (int32_t p = 0; p < count && count > 1; ++p) {
+      if (group->rank_queues[p] == queue) {
+        status = iree_make_status(
+            IREE_STATUS_INVALID_ARGUMENT,
+            "ranks %d and %d of the channel group would execute on the same "
+            "PIM queue; each rank requires its own queue or device",
+            p, rank);
+        break;
+      }
+    }
+    if (iree_status_is_ok(status)) {
+      if (count > 1) group->rank_queues[rank] = queue;
+      ++group->ref_count;
+    }
+  } else {
+    iree_host_size_t total_size = sizeof(*group) +
+                                  count * sizeof(*group->rank_queues) +
+                                  count * sizeof(*group->contributions) +
+                                  id.data_length;
+    status = iree_allocator_malloc(host_allocator, total_size, (void**)&group);
+    if (iree_status_is_ok(status)) {
+      memset(group, 0, total_size);
+      group->ref_count = 1;
+      group->count = count;
+      group->failure_status = iree_ok_status();
+      iree_notification_initialize(&group->notification);
+      iree_slim_mutex_initialize(&group->mutex);
+      uint8_t* storage = (uint8_t*)group + sizeof(*group);
+      group->rank_queues = (const void**)storage;
+      if (count > 1) group->rank_queues[rank] = queue;
+      storage += count * sizeof(*group->rank_queues);
+      group->contributions = (const float**)storage;
+      storage += count * sizeof(*group->contributions);
+      memcpy(storage, id.data, id.data_length);
+      group->id = iree_make_const_byte_span(storage, id.data_length);
+      group->next = registry->head;
+      registry->head = group;
+    }
+  }
+
+  iree_slim_mutex_unlock(&registry->mutex);
+  *out_group = iree_status_is_ok(status) ? group : NULL;
+  return status;
+}
+
+// Leaves |group| as |rank| and drops the reference.
+static void iree_hal_pim_channel_group_release(
+    iree_hal_pim_channel_group_t* group, int32_t rank,
+    iree_allocator_t host_allocator) {
+  iree_hal_pim_channel_registry_t* registry = iree_hal_pim_channel_registry();
+  iree_slim_mutex_lock(&registry->mutex);
+  group->rank_queues[rank] = NULL;
+  bool destroy = --group->ref_count == 0;
+  if (destroy) {
+    iree_hal_pim_channel_group_t** link = &registry->head;
+    while (*link != group) link = &(*link)->next;
+    *link = group->next;
+  }
+  iree_slim_mutex_unlock(&registry->mutex);
+  if (!destroy) return;
+
+  iree_status_ignore(group->failure_status);
+  iree_slim_mutex_deinitialize(&group->mutex);
+  iree_notification_deinitialize(&group->notification);
+  iree_allocator_free(host_allocator, group);
+}
+
+// Fails |group| with |status| if it has not already failed and wakes all
+// participants waiting at a barrier. Consumes |status|.
+static void iree_hal_pim_channel_group_fail(iree_hal_pim_channel_group_t* group,
+                                            iree_status_t status) {
+  iree_slim_mutex_lock(&group->mutex);
+  if (iree_status_is_ok(group->failure_status)) {
+    group->failure_status = status;
+    status = iree_ok_status();
+  }
+  iree_slim_mutex_unlock(&group->mutex);
+  iree_status_ignore(status);
+  iree_notification_post(&group->notification, IREE_ALL_WAITERS);
+}
+
+// Returns a status describing why |group| failed. The group mutex must be held.
+static iree_status_t iree_hal_pim_channel_group_failure_status_unsafe(
+    iree_hal_pim_channel_group_t* group) {
+  return iree_make_status(IREE_STATUS_ABORTED,
+                          "channel group failed: %s",
+                          iree_status_code_string(
+                              iree_status_code(group->failure_status)));
+}
+
+typedef struct iree_hal_pim_channel_barrier_t {
+  iree_hal_pim_channel_group_t* group;
+  uint64_t generation;
+} iree_hal_pim_channel_barrier_t;
+
+// Returns true once the barrier generation has completed or the group failed.
+// Used with iree_condition_fn_t and must match that signature.
+static bool iree_hal_pim_channel_barrier_is_complete(
+    iree_hal_pim_channel_barrier_t* barrier) {
+  iree_slim_mutex_lock(&barrier->group->mutex);
+  bool is_complete = barrier->group->generation != barrier->generation ||
+                     !iree_status_is_ok(barrier->group->failure_status);
+  iree_slim_mutex_unlock(&barrier->group->mutex);
+  return is_complete;
+}
+
+// Blocks until all participants of |group| have arrived. Fails if the group
+// has failed or if the peers do not arrive within
+// IREE_HAL_PIM_CHANNEL_BARRIER_TIMEOUT_MS, in which case the group fails.
+static iree_status_t iree_hal_pim_channel_group_barrier(
+    iree_hal_pim_channel_group_t* group) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_slim_mutex_lock(&group->mutex);
+  if (!iree_status_is_ok(group->failure_status)) {
+    iree_status_t status =
+        iree_hal_pim_channel_group_failure_status_unsafe(group);
+    iree_slim_mutex_unlock(&group->mutex);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+  iree_hal_pim_channel_barrier_t barrier = {group, group->generation};
+  bool is_last = ++group->arrived == group->count;
+  if (is_last) {
+    group->arrived = 0;
+    ++group->generation;
+  }
+  iree_slim_mutex_unlock(&group->mutex);
+  if (is_last) {
+    iree_notification_post(&group->notification, IREE_ALL_WAITERS);
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
+  }
+
+  if (!iree_notification_await(
+          &group->notification,
+          (iree_condition_fn_t)iree_hal_pim_channel_barrier_is_complete,
+          &barrier,
+          iree_make_timeout_ms(IREE_HAL_PIM_CHANNEL_BARRIER_TIMEOUT_MS))) {
+    iree_hal_pim_channel_group_fail(
+        group, iree_make_status(IREE_STATUS_DEADLINE_EXCEEDED,
+                                "channel participants did not arrive within "
+                                "%d ms",
+                                IREE_HAL_PIM_CHANNEL_BARRIER_TIMEOUT_MS));
+  }
+
+  // The generation may have completed just before the group failed; only
+  // barriers that did not complete fail.
+  iree_status_t status = iree_ok_status();
+  iree_slim_mutex_lock(&group->mutex);
+  if (group->generation == barrier.generation) {
+    status = iree_hal_pim_channel_group_failure_status_unsafe(group);
+  }
+  iree_slim_mutex_unlock(&group->mutex);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_pim_channel_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_hal_pim_channel_t {
+  iree_hal_resource_t resource;
+  iree_allocator_t host_allocator;
+
+  // Shared rendezvous state of all participants.
+  iree_hal_pim_channel_group_t* group;
+
+  // This participant's rank in the group.
+  int32_t rank;
+  // Total number of participants in the group.
+  int32_t count;
+
+  // Latency model of the device that created the channel; only valid when
+  // |simulated|.
+  bool simulated;
+  iree_hal_pim_sim_params_t simulation;
+} iree_hal_pim_channel_t;
+
+namespace {
+extern const iree_hal_channel_vtable_t iree_hal_pim_channel_vtable;
+}  // namespace
+
+static iree_hal_pim_channel_t* iree_hal_pim_channel_cast(
+    iree_hal_channel_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_pim_channel_vtable);
+  return (iree_hal_pim_channel_t*)base_value;
+}
+
+iree_status_t iree_hal_pim_channel_create(
+    iree_const_byte_span_t id, int32_t rank, int32_t count, const void* queue,
+    const iree_hal_pim_sim_params_t* simulation,
+    iree_allocator_t host_allocator, iree_hal_channel_t** out_channel) {
+  IREE_ASSERT_ARGUMENT(out_channel);
+  *out_channel = NULL;
+  if (count <= 0 || rank < 0 || rank >= count) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "rank %d out of range for %d participants", rank,
+                            count);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, rank);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, count);
+
+  iree_hal_pim_channel_t* channel = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*channel),
+                                (void**)&channel));
+  iree_hal_resource_initialize(&iree_hal_pim_channel_vtable,
+                               &channel->resource);
+  channel->host_allocator = host_allocator;
+  channel->rank = rank;
+  channel->count = count;
+  channel->simulated = simulation != NULL;
+  if (simulation) channel->simulation = *simulation;
+
+  iree_status_t status = iree_hal_pim_channel_group_acquire(
+      id, rank, count, queue, host_allocator, &channel->group);
+
+  if (iree_status_is_ok(status)) {
+    *out_channel = (iree_hal_channel_t*)channel;
+  } else {
+    iree_allocator_free(host_allocator, channel);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_pim_channel_destroy(iree_hal_channel_t* base_channel) {
+  iree_hal_pim_channel_t* channel = iree_hal_pim_channel_cast(base_channel);
+  iree_allocator_t host_allocator = channel->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_pim_channel_group_release(channel->group, channel->rank,
+                                     host_allocator);
+  iree_allocator_free(host_allocator, channel);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static void iree_hal_pim_channel_query_rank_and_count(
+    const iree_hal_channel_t* base_channel, int32_t* out_rank,
+    int32_t* out_count) {
+  iree_hal_pim_channel_t* channel =
+      iree_hal_pim_channel_cast((iree_hal_channel_t*)base_channel);
+  *out_rank = channel->rank;
+  *out_count = channel->count;
+}
+
+//===----------------------------------------------------------------------===//
+// Collective execution
+//===----------------------------------------------------------------------===//
+
+static float iree_hal_pim_channel_reduce(iree_hal_collective_reduction_t op,
+                                         float lhs, float rhs) {
+  switch (op) {
+    default:
+    case IREE_HAL_COLLECTIVE_REDUCTION_SUM:
+    case IREE_HAL_COLLECTIVE_REDUCTION_AVERAGE:
+      return lhs + rhs;
+    case IREE_HAL_COLLECTIVE_REDUCTION_PRODUCT:
+      return lhs * rhs;
+    case IREE_HAL_COLLECTIVE_REDUCTION_MINIMUM:
+      return lhs < rhs ? lhs : rhs;
+    case IREE_HAL_COLLECTIVE_REDUCTION_MAXIMUM:
+      return lhs > rhs ? lhs : rhs;
+  }
+}
+
+// Reduces |element_count| elements starting at |element_offset| of every
+// participant's contribution into |result|.
+static void iree_hal_pim_channel_reduce_contributions(
+    const iree_hal_pim_channel_group_t* group,
+    iree_hal_collective_reduction_t op, iree_host_size_t element_offset,
+    iree_host_size_t element_count, float* result) {
+  memcpy(result, group->contributions[0] + element_offset,
+         element_count * sizeof(float));
+  for (int32_t p = 1; p < group->count; ++p) {
+    const float* contribution = group->contributions[p] + element_offset;
+    for (iree_host_size_t i = 0; i < element_count; ++i) {
+      result[i] = iree_hal_pim_channel_reduce(op, result[i], contribution[i]);
+    }
+  }
+  if (op == IREE_HAL_COLLECTIVE_REDUCTION_AVERAGE) {
+    for (iree_host_size_t i = 0; i < element_count; ++i) {
+      result[i] /= (float)group->count;
+    }
+  }
+}
+
+// Replaces the device contents of |binding| with |data|. The upload is profiled
+// with |simulation| if not NULL.
+static iree_status_t iree_hal_pim_channel_write_binding(
+    const iree_hal_pim_sim_params_t* simulation,
+    iree_hal_buffer_binding_t binding, const std::vector<float>& data) {
+  iree_hal_buffer_t* buffer = iree_hal_buffer_allocated_buffer(binding.buffer);
+  iree_device_size_t byte_offset =
+      iree_hal_buffer_byte_offset(binding.buffer) + binding.offset;
+  int element_count = (int)data.size();
+  iree_device_size_t byte_length =
+      (iree_device_size_t)element_count * sizeof(float);
+
+  // Keep the tensor shape of the receive range if it still describes the
+  // result; otherwise it becomes a 1-D tensor.
+  int current_addr = IREE_HAL_PIM_BUFFER_ADDR_NONE;
+  int rank = 0;
+  const int* dims = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_pim_buffer_query_range(
+      buffer, byte_offset, byte_length, &current_addr, &rank, &dims));
+  int shape_element_count = rank > 0 ? 1 : 0;
+  for (int i = 0; i < rank; ++i) shape_element_count *= dims[i];
+  int result_dims[IREE_HAL_PIM_BUFFER_MAX_RANK] = {element_count};
+  int result_rank = 1;
+  if (shape_element_count == element_count) {
+    memcpy(result_dims, dims, rank * sizeof(*dims));
+    result_rank = rank;
+  }
+
+  int addr =
+      iree_hal_pim_sdk_alloc_buffer(simulation, element_count, data.data());
+  return iree_hal_pim_buffer_write_range(buffer, byte_offset, byte_length,
+                                         addr, element_count, result_rank,
+                                         result_dims);
+}
+
+// Returns the element counts of the send and receive data of a single rank
+// for |op| on a channel of |count| participants.
+static iree_status_t iree_hal_pim_channel_query_element_counts(
+    iree_hal_collective_op_t op, uint32_t param, int32_t count,
+    iree_host_size_t element_count, iree_host_size_t* out_send_count,
+    iree_host_size_t* out_recv_count) {
+  if (op.element_type != IREE_HAL_COLLECTIVE_ELEMENT_TYPE_FLOAT_32) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "PIM collectives only support f32 elements");
+  }
+  *out_send_count = element_count;
+  *out_recv_count = element_count;
+  switch (op.kind) {
+    case IREE_HAL_COLLECTIVE_KIND_ALL_GATHER:
+      *out_recv_count = element_count * count;
+      break;
+    case IREE_HAL_COLLECTIVE_KIND_REDUCE_SCATTER:
+      *out_send_count = element_count * count;
+      break;
+    case IREE_HAL_COLLECTIVE_KIND_ALL_REDUCE:
+      break;
+    case IREE_HAL_COLLECTIVE_KIND_BROADCAST:
+    case IREE_HAL_COLLECTIVE_KIND_REDUCE:
+      if (param >= (uint32_t)count) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "root rank %u out of range for %d participants",
+                                param, count);
+      }
+      break;
+    default:
+      // Point-to-point transfers only involve two participants and can't use
+      // the group rendezvous.
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unsupported PIM collective kind %d",
+                              (int)op.kind);
+  }
+  return iree_ok_status();
+}
+
+// Returns the modeled latency of |op| on |count| participants where each
+// rank sends |send_count| and receives |recv_count| elements.
+static iree_time_t iree_hal_pim_channel_simulate(
+    const iree_hal_pim_sim_params_t* params, iree_hal_collective_op_t op,
+    int32_t count, iree_host_size_t send_count, iree_host_size_t recv_count) {
+  switch (op.kind) {
+    case IREE_HAL_COLLECTIVE_KIND_ALL_GATHER:
+      return iree_hal_pim_sim_collective_ns(
+          params, IREE_HAL_PIM_SIM_COLLECTIVE_ALL_GATHER, count,
+          recv_count * sizeof(float));
+    case IREE_HAL_COLLECTIVE_KIND_ALL_REDUCE:
+      return iree_hal_pim_sim_collective_ns(
+          params, IREE_HAL_PIM_SIM_COLLECTIVE_ALL_REDUCE, count,
+          recv_count * sizeof(float));
+    case IREE_HAL_COLLECTIVE_KIND_REDUCE_SCATTER:
+      return iree_hal_pim_sim_collective_ns(
+          params, IREE_HAL_PIM_SIM_COLLECTIVE_REDUCE_SCATTER, count,
+          send_count * sizeof(float));
+    default:
+      // Broadcasts and reduces pipeline the buffer around the ring in chunks
+      // which costs as much as gathering it.
+      return iree_hal_pim_sim_collective_ns(
+          params, IREE_HAL_PIM_SIM_COLLECTIVE_ALL_GATHER, count,
+          send_count * sizeof(float));
+  }
+}
+
+iree_status_t iree_hal_pim_channel_execute_host(
+    iree_hal_channel_t* base_channel, iree_hal_collective_op_t op,
+    uint32_t param, iree_host_size_t element_count, const float* send_data,
+    float* recv_data) {
+  iree_hal_pim_channel_t* channel = iree_hal_pim_channel_cast(base_channel);
+  iree_hal_pim_channel_group_t* group = channel->group;
+  const int32_t rank = channel->rank;
+  const int32_t count = channel->count;
+  iree_host_size_t send_count = 0;
+  iree_host_size_t recv_count = 0;
+  iree_status_t status = iree_hal_pim_channel_query_element_counts(
+      op, param, count, element_count, &send_count, &recv_count);
+  if (!iree_status_is_ok(status)) {
+    // Every rank rejects the same op but fail the group in case peers passed
+    // different ops so that none of them waits for us.
+    iree_hal_pim_channel_abort(base_channel, iree_status_clone(status));
+    return status;
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)op.kind);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)element_count);
+  const bool profiling = iree_hal_pim_profiling_is_enabled() && rank == 0;
+  iree_time_t start_ns = profiling ? iree_time_now() : 0;
+
+  group->contributions[rank] = send_data;
+  status = iree_hal_pim_channel_group_barrier(group);
+  if (!iree_status_is_ok(status)) {
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  switch (op.kind) {
+    case IREE_HAL_COLLECTIVE_KIND_ALL_GATHER:
+      for (int32_t p = 0; p < count; ++p) {
+        memcpy(recv_data + p * element_count, group->contributions[p],
+               element_count * sizeof(float));
+      }
+      break;
+    case IREE_HAL_COLLECTIVE_KIND_ALL_REDUCE:
+      iree_hal_pim_channel_reduce_contributions(group, op.reduction, 0,
+                                                element_count, recv_data);
+      break;
+    case IREE_HAL_COLLECTIVE_KIND_BROADCAST:
+      memcpy(recv_data, group->contributions[param],
+             element_count * sizeof(float));
+      break;
+    case IREE_HAL_COLLECTIVE_KIND_REDUCE:
+      if (rank == (int32_t)param) {
+        iree_hal_pim_channel_reduce_contributions(group, op.reduction, 0,
+                                                  element_count, recv_data);
+      }
+      break;
+    case IREE_HAL_COLLECTIVE_KIND_REDUCE_SCATTER:
+      iree_hal_pim_channel_reduce_contributions(group, op.reduction,
+                                                rank * element_count,
+                                                element_count, recv_data);
+      break;
+    default:
+      break;
+  }
+
+  // Peers may still be reading our contribution.
+  status = iree_hal_pim_channel_group_barrier(group);
+
+  if (profiling && iree_status_is_ok(status)) {
+    iree_hal_pim_profile_event_t event = {};
+    event.kind = IREE_HAL_PIM_PROFILE_EVENT_COLLECTIVE;
+    event.start_ns = start_ns;
+    event.end_ns = iree_time_now();
+    if (channel->simulated) {
+      event.end_ns = start_ns + iree_hal_pim_channel_simulate(
+                                    &channel->simulation, op, count,
+                                    send_count, recv_count);
+    }
+    event.bytes_in = (uint64_t)send_count * count * sizeof(float);
+    event.bytes_out = (uint64_t)recv_count * count * sizeof(float);
+    iree_hal_pim_profiling_record(&event);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static iree_status_t iree_hal_pim_channel_execute_entry(
+    const iree_hal_collective_batch_entry_t* entry) {
+  iree_hal_pim_channel_t* channel = iree_hal_pim_channel_cast(entry->channel);
+  const iree_host_size_t element_count = (iree_host_size_t)entry->element_count;
+  iree_host_size_t send_count = 0;
+  iree_host_size_t recv_count = 0;
+  iree_status_t status = iree_hal_pim_channel_query_element_counts(
+      entry->op, entry->param, channel->count, element_count, &send_count,
+      &recv_count);
+
+  // Stage this rank's contribution in host memory. Mapping goes through the
+  // buffer's host shadow and only reads from the device if it is stale.
+  std::vector<float> send_data;
+  if (iree_status_is_ok(status)) {
+    send_data.resize(send_count);
+    status = iree_hal_buffer_map_read(
+        entry->send_binding.buffer, entry->send_binding.offset,
+        send_data.data(), send_count * sizeof(float));
+  }
+  if (!iree_status_is_ok(status)) {
+    // Peers are (or will be) waiting for our contribution.
+    iree_hal_pim_channel_abort(entry->channel, iree_status_clone(status));
+    return status;
+  }
+
+  std::vector<float> recv_data(recv_count);
+  IREE_RETURN_IF_ERROR(iree_hal_pim_channel_execute_host(
+      entry->channel, entry->op, entry->param, element_count, send_data.data(),
+      recv_data.data()));
+
+  // Only the root receives the result of a reduce.
+  if (entry->op.kind == IREE_HAL_COLLECTIVE_KIND_REDUCE &&
+      channel->rank != (int32_t)entry->param) {
+    return iree_ok_status();
+  }
+  return iree_hal_pim_channel_write_binding(
+      channel->simulated ? &channel->simulation : NULL, entry->recv_binding,
+      recv_data);
+}
+
+iree_status_t iree_hal_pim_channel_execute(
+    iree_host_size_t entry_count,
+    const iree_hal_collective_batch_entry_t* entries) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)entry_count);
+  iree_status_t status = iree_ok_status();
+  iree_host_size_t i = 0;
+  for (; i < entry_count && iree_status_is_ok(status); ++i) {
+    status = iree_hal_pim_channel_execute_entry(&entries[i]);
+  }
+  // Peers of the entries we will never execute would wait for us.
+  for (; i < entry_count; ++i) {
+    iree_hal_pim_channel_abort(entries[i].channel, iree_status_clone(status));
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+void iree_hal_pim_channel_abort(iree_hal_channel_t* base_channel,
+                                iree_status_t status) {
+  iree_hal_pim_channel_t* channel = iree_hal_pim_channel_cast(base_channel);
+  if (channel->count <= 1) {
+    iree_status_ignore(status);
+    return;
+  }
+  iree_hal_pim_channel_group_fail(channel->group, status);
+}
+
+namespace {
+const iree_hal_channel_vtable_t iree_hal_pim_channel_vtable = {
+    /*.destroy=*/iree_hal_pim_channel_destroy,
+    /*.query_rank_and_count=*/iree_hal_pim_channel_query_rank_and_count,
+};
+}  // namespace
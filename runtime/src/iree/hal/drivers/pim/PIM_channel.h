@@ -0,0 +1,69 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_PIM_PIM_CHANNEL_H_
+#define IREE_HAL_DRIVERS_PIM_PIM_CHANNEL_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/pim/util/pim_sim_model.h"
+#include "iree/hal/utils/collective_batch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Creates a collective channel for |rank| in a group of |count| participants
+// whose collectives execute on |queue|, an opaque identity of a PIM queue.
+//
+// All channels created in the process with the same |id| join the same group.
+// Participants rendezvous on the queue threads executing the collectives so
+// each rank must be submitted to a different PIM queue (or device); joining
+// with a rank that already has a channel or with the queue of another rank
+// fails instead of creating a group that would wait on itself forever.
+//
+// Collectives are profiled with the latencies modeled by |simulation| if not
+// NULL and measured otherwise.
+iree_status_t iree_hal_pim_channel_create(
+    iree_const_byte_span_t id, int32_t rank, int32_t count, const void* queue,
+    const iree_hal_pim_sim_params_t* simulation,
+    iree_allocator_t host_allocator, iree_hal_channel_t** out_channel);
+
+// Executes the collective operations in |entries| in order, blocking the
+// calling queue thread until every participant of each channel has arrived.
+// Entries may apply to different channels. If an entry fails the groups of it
+// and of all following entries are aborted. Participants that have not arrived
+// within IREE_HAL_PIM_CHANNEL_BARRIER_TIMEOUT_MS abort the group as well.
+//
+// The PIM SDK has no device-to-device transfers so contributions are staged
+// through host memory and results are uploaded as new device allocations that
+// replace the contents of the receive buffers.
+iree_status_t iree_hal_pim_channel_execute(
+    iree_host_size_t entry_count,
+    const iree_hal_collective_batch_entry_t* entries);
+
+// Executes collective |op| for this rank of |channel| on host staged data,
+// blocking until every participant has arrived. |send_data| and |recv_data|
+// are sized as the send and receive bindings of the equivalent collective
+// batch entry with |element_count| elements. Used by dispatches that
+// synchronize intermediate results that never live in a HAL buffer.
+iree_status_t iree_hal_pim_channel_execute_host(
+    iree_hal_channel_t* channel, iree_hal_collective_op_t op, uint32_t param,
+    iree_host_size_t element_count, const float* send_data, float* recv_data);
+
+// Fails the group of |channel| with |status| so that every participant waiting
+// on (or later arriving at) one of its collectives fails instead of waiting for
+// this rank. Used when a rank will not execute a collective it was expected
+// to. Groups can't recover as their participants no longer agree on which
+// collective is next. Consumes |status|.
+void iree_hal_pim_channel_abort(iree_hal_channel_t* channel,
+                                iree_status_t status);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_PIM_PIM_CHANNEL_H_
@@ -0,0 +1,768 @@
+// Copyright 2019 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/pim/PIM_device.h"
+
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_APPLE) || \
+    defined(IREE_PLATFORM_LINUX)
+#include <unistd.h>
+#endif  // IREE_PLATFORM_*
+
+#include "iree/base/internal/arena.h"
+#include "iree/base/internal/math.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/drivers/pim/api.h"
+#include "iree/hal/drivers/pim/direct_command_buffer.h"
+#include "iree/hal/drivers/pim/dynamic_symbols.h"
+#include "iree/hal/drivers/pim/native_pipeline_layout.h"
+#include "iree/hal/drivers/pim/native_semaphore.h"
+#include "iree/hal/drivers/pim/status_util.h"
+#include "iree/hal/drivers/pim/tracing.h"
+#include "iree/hal/drivers/pim/util/arena.h"
+#include "iree/hal/drivers/pim/util/queue_affinity.h"
+#include "iree/hal/drivers/pim/util/ref_ptr.h"
+#include "iree/hal/drivers/pim/PIM_allocator.h"
+#include "iree/hal/drivers/pim/PIM_buffer.h"
+#include "iree/hal/drivers/pim/PIM_channel.h"
+#include "iree/hal/drivers/pim/PIM_executable_cache.h"
+#include "iree/hal/drivers/pim/PIM_profiling.h"
+#include "iree/hal/drivers/pim/PIM_queue.h"
+#include "iree/hal/local/executable_loader.h"
+#include "iree/hal/local/loaders/embedded_elf_loader.h"
+#include "iree/hal/utils/buffer_transfer.h"
+#include "iree/hal/utils/deferred_command_buffer.h"
+
+using namespace iree::hal::pim;
+
+// Maximum number of queues (PIM modules) addressable by a queue affinity mask.
+#define IREE_HAL_PIM_MAX_QUEUE_COUNT 64
+
+// Whether the device loads the host (embedded ELF) variants compiled for
+// dispatches the PIM backend can't lower and runs them on the queue threads.
+#if !defined(IREE_HAL_PIM_HOST_FALLBACK_ENABLE)
+#define IREE_HAL_PIM_HOST_FALLBACK_ENABLE 1
+#endif  // !IREE_HAL_PIM_HOST_FALLBACK_ENABLE
+
+// Returns the number of CPUs online or 0 if unknown on the platform.
+static int64_t iree_hal_pim_online_cpu_count() {
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_APPLE) || \
+    defined(IREE_PLATFORM_LINUX)
+  long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+  return cpu_count > 0 ? (int64_t)cpu_count : 0;
+#else
+  return 0;
+#endif  // IREE_PLATFORM_*
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_pim_device_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_hal_pim_device_t {
+  iree_hal_resource_t resource;
+  iree_string_view_t identifier;
+
+  // Optional driver that owns the instance. We retain it for our lifetime to
+  // ensure the instance remains valid.
+  iree_hal_driver_t* driver;
+
+  // Flags overriding default device behavior.
+  iree_hal_pim_device_flags_t flags;
+
+  // Latency model of each PIM module used when simulating. Only valid with
+  // IREE_HAL_PIM_DEVICE_FLAG_SIMULATION.
+  iree_hal_pim_sim_params_t simulation;
+
+  // Cumulative per-opcode counters of the dispatches executed by the queues
+  // of the device. Queried with the `pim.stats` category.
+  iree_hal_pim_stats_t stats;
+
+  iree_allocator_t host_allocator;
+  iree_hal_allocator_t* device_allocator;
+
+  // Block pool used for command buffer recording.
+  iree_arena_block_pool_t block_pool;
+
+  // Loader of host fallback executables or NULL if disabled.
+  iree_hal_executable_loader_t* host_loader;
+
+  // Executable cache shared by all contexts using the device so that loading
+  // the same module again reuses the already decoded executables.
+  iree_hal_executable_cache_t* executable_cache;
+
+#if defined(IREE_HAL_PIM_HAVE_RENDERDOC)
+  RENDERDOC_API_LATEST* renderdoc_api;
+#endif  // IREE_HAL_PIM_HAVE_RENDERDOC
+
+  // In-order submission queues executing command buffers asynchronously; one
+  // per PIM module.
+  iree_host_size_t queue_count;
+  iree_hal_pim_queue_t* queues[];
+} iree_hal_pim_device_t;
+
+namespace {
+extern const iree_hal_device_vtable_t iree_hal_pim_device_vtable;
+}  // namespace
+
+static iree_hal_pim_device_t* iree_hal_pim_device_cast(
+    iree_hal_device_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_pim_device_vtable);
+  return (iree_hal_pim_device_t*)base_value;
+}
+
+IREE_API_EXPORT void iree_hal_pim_device_options_initialize(
+    iree_hal_pim_device_options_t* out_options) {
+  memset(out_options, 0, sizeof(*out_options));
+  out_options->flags = 0;
+  out_options->large_heap_block_size = 64 * 1024 * 1024;
+  out_options->queue_count = 1;
+  iree_hal_pim_sim_params_initialize(&out_options->simulation);
+  out_options->pim_residency_capacity = 0;
+  out_options->pim_queue_thread_priority = 0;
+  out_options->pim_queue_thread_cpu = -1;
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_pim_device_set_active_model(
+    iree_hal_device_t* base_device, uint64_t model_id) {
+  IREE_ASSERT_ARGUMENT(base_device);
+  iree_hal_pim_device_t* device = iree_hal_pim_device_cast(base_device);
+  iree_hal_pim_allocator_set_active_model(device->device_allocator, model_id);
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_pim_device_prefetch_model(
+    iree_hal_device_t* base_device, uint64_t model_id) {
+  IREE_ASSERT_ARGUMENT(base_device);
+  iree_hal_pim_device_t* device = iree_hal_pim_device_cast(base_device);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)model_id);
+  iree_status_t status = iree_hal_pim_allocator_prefetch_model(
+      device->device_allocator, model_id);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+
+static iree_status_t iree_hal_pim_device_create_internal(
+    iree_hal_driver_t* driver, iree_string_view_t identifier,
+    const iree_hal_pim_device_options_t* options,
+    iree_allocator_t host_allocator, iree_hal_device_t** out_device) {
+
+
+  if (options->queue_count == 0 ||
+      options->queue_count > IREE_HAL_PIM_MAX_QUEUE_COUNT) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "queue count %" PRIhsz
+                            " out of range; expected [1, %d]",
+                            options->queue_count, IREE_HAL_PIM_MAX_QUEUE_COUNT);
+  }
+
+  // Queue i is pinned to CPU pim_queue_thread_cpu + i. Reject ranges running
+  // past the online CPUs instead of letting the threads fail to pin (or land
+  // wherever the system puts them) after the device is created.
+  const int64_t cpu_count = iree_hal_pim_online_cpu_count();
+  if (options->pim_queue_thread_cpu >= 0 && cpu_count > 0 &&
+      (int64_t)options->pim_queue_thread_cpu +
+              (int64_t)options->queue_count >
+          cpu_count) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "PIM queue threads pinned to CPUs [%d, %" PRId64
+        ") but only %" PRId64 " CPUs are online",
+        options->pim_queue_thread_cpu,
+        (int64_t)options->pim_queue_thread_cpu +
+            (int64_t)options->queue_count,
+        cpu_count);
+  }
+
+  iree_hal_pim_device_t* device = NULL;
+  iree_host_size_t total_size = sizeof(*device) +
+                                options->queue_count * sizeof(*device->queues) +
+                                identifier.size;
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_malloc(host_allocator, total_size, (void**)&device));
+  memset(device, 0, total_size);
+  iree_hal_resource_initialize(&iree_hal_pim_device_vtable,
+                               &device->resource);
+  device->host_allocator = host_allocator;
+  device->driver = driver;
+  iree_hal_driver_retain(device->driver);
+  uint8_t* buffer_ptr = (uint8_t*)device + sizeof(*device) +
+                        options->queue_count * sizeof(*device->queues);
+  buffer_ptr += iree_string_view_append_to_buffer(
+      identifier, &device->identifier, (char*)buffer_ptr);
+  device->flags = options->flags;
+  iree_hal_pim_stats_initialize(&device->stats);
+  const iree_hal_pim_sim_params_t* simulation = NULL;
+  if (iree_all_bits_set(options->flags,
+                        IREE_HAL_PIM_DEVICE_FLAG_SIMULATION)) {
+    device->simulation = options->simulation;
+    simulation = &device->simulation;
+  }
+  iree_arena_block_pool_initialize(32 * 1024, host_allocator,
+                                   &device->block_pool);
+
+  // Create the device memory allocator that will service all buffer
+  // allocation requests.
+  iree_status_t status = iree_hal_pim_vma_allocator_create(
+      host_allocator, (iree_hal_device_t*)device, options->flags,
+      options->pim_residency_capacity, simulation, &device->device_allocator);
+
+#if IREE_HAL_PIM_HOST_FALLBACK_ENABLE
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_embedded_elf_loader_create(
+        iree_hal_executable_import_provider_null(), host_allocator,
+        &device->host_loader);
+  }
+#endif  // IREE_HAL_PIM_HOST_FALLBACK_ENABLE
+
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_pim_executable_cache_create(
+        host_allocator, iree_make_cstring_view("pim"), device->host_loader,
+        simulation, &device->executable_cache);
+  }
+
+  // Executables split across the PIM modules of the device synchronize their
+  // partial results over a channel with one rank per queue. The channel ID is
+  // unique to the device so that groups of separate devices never meet.
+  char sync_channel_id[48];
+  snprintf(sync_channel_id, sizeof(sync_channel_id), "iree-pim-sync-%p",
+           (void*)device);
+  for (iree_host_size_t i = 0;
+       i < options->queue_count && iree_status_is_ok(status); ++i) {
+    iree_hal_channel_t* sync_channel = NULL;
+    if (options->queue_count > 1) {
+      status = iree_hal_pim_channel_create(
+          iree_make_const_byte_span(sync_channel_id, strlen(sync_channel_id)),
+          (int32_t)i, (int32_t)options->queue_count, &device->queues[i],
+          simulation, host_allocator, &sync_channel);
+    }
+    if (iree_status_is_ok(status)) {
+      char queue_name[32];
+      snprintf(queue_name, sizeof(queue_name), "iree-pim-queue-%" PRIhsz, i);
+      iree_hal_pim_queue_options_t queue_options;
+      iree_hal_pim_queue_options_initialize(&queue_options);
+      queue_options.overlap_host_dispatches = iree_all_bits_set(
+          options->flags, IREE_HAL_PIM_DEVICE_FLAG_HOST_OVERLAP);
+      queue_options.simulation = simulation;
+      queue_options.stats = &device->stats;
+      queue_options.priority_class =
+          (iree_thread_priority_class_t)iree_max(
+              IREE_THREAD_PRIORITY_CLASS_LOWEST,
+              iree_min(IREE_THREAD_PRIORITY_CLASS_HIGHEST,
+                       options->pim_queue_thread_priority));
+      if (options->pim_queue_thread_cpu >= 0) {
+        queue_options.affinity.specified = 1;
+        queue_options.affinity.id =
+            (uint32_t)options->pim_queue_thread_cpu + (uint32_t)i;
+      }
+      status = iree_hal_pim_queue_create(
+          (iree_hal_device_t*)device, iree_make_cstring_view(queue_name),
+          &device->block_pool, sync_channel, &queue_options, host_allocator,
+          &device->queues[i]);
+    }
+    iree_hal_channel_release(sync_channel);
+    if (iree_status_is_ok(status)) ++device->queue_count;
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_device = (iree_hal_device_t*)device;
+  } else {
+    iree_hal_device_destroy((iree_hal_device_t*)device);
+  }
+  return status;
+}
+
+static void iree_hal_pim_device_destroy(iree_hal_device_t* base_device) {
+  iree_hal_pim_device_t* device = iree_hal_pim_device_cast(base_device);
+  iree_allocator_t host_allocator = iree_hal_device_host_allocator(base_device);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Drain all in-flight submissions before tearing down the resources they
+  // may reference.
+  for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
+    iree_hal_pim_queue_destroy(device->queues[i]);
+  }
+
+  iree_hal_executable_cache_release(device->executable_cache);
+  iree_hal_executable_loader_release(device->host_loader);
+
+  // There should be no more buffers live that use the allocator.
+  iree_hal_allocator_release(device->device_allocator);
+
+  iree_arena_block_pool_deinitialize(&device->block_pool);
+
+  // Finally, destroy the device.
+  iree_hal_driver_release(device->driver);
+
+  iree_allocator_free(host_allocator, device);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+iree_status_t iree_hal_pim_device_create(
+    iree_hal_driver_t* driver, iree_string_view_t identifier,
+    const iree_hal_pim_device_options_t* options,
+    iree_allocator_t host_allocator,
+    iree_hal_device_t** out_device) {
+
+
+  // Allocate and initialize the device.
+  iree_status_t status = iree_ok_status();
+
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_pim_device_create_internal(
+        driver, identifier, options,
+        host_allocator, out_device);
+  }
+
+  return status;
+}
+
+static iree_string_view_t iree_hal_pim_device_id(
+    iree_hal_device_t* base_device) {
+  iree_hal_pim_device_t* device = iree_hal_pim_device_cast(base_device);
+  return device->identifier;
+}
+
+static iree_allocator_t iree_hal_pim_device_host_allocator(
+    iree_hal_device_t* base_device) {
+  iree_hal_pim_device_t* device = iree_hal_pim_device_cast(base_device);
+  return device->host_allocator;
+}
+
+static iree_hal_allocator_t* iree_hal_pim_device_allocator(
+    iree_hal_device_t* base_device) {
+  iree_hal_pim_device_t* device = iree_hal_pim_device_cast(base_device);
+  return device->device_allocator;
+}
+
+static void iree_hal_pim_replace_device_allocator(
+    iree_hal_device_t* base_device, iree_hal_allocator_t* new_allocator) {
+  iree_hal_pim_device_t* device = iree_hal_pim_device_cast(base_device);
+  iree_hal_allocator_retain(new_allocator);
+  iree_hal_allocator_release(device->device_allocator);
+  device->device_allocator = new_allocator;
+}
+
+static iree_status_t iree_hal_pim_device_trim(
+    iree_hal_device_t* base_device) {
+  iree_hal_pim_device_t* device = iree_hal_pim_device_cast(base_device);
+
+
+  return iree_hal_allocator_trim(device->device_allocator);
+}
+
+static iree_status_t iree_hal_pim_device_query_i64(
+    iree_hal_device_t* base_device, iree_string_view_t category,
+    iree_string_view_t key, int64_t* out_value) {
+  iree_hal_pim_device_t* device = iree_hal_pim_device_cast(base_device);
+  *out_value = 0;
+
+  if (iree_string_view_equal(category,
+                             iree_make_cstring_view("hal.executable.format"))) {
+    *out_value =
+        iree_string_view_equal(key, iree_make_cstring_view("pim-isr-fb")) ||
+                (device->host_loader &&
+                 iree_hal_executable_loader_query_support(
+                     device->host_loader, /*caching_mode=*/0, key))
+            ? 1
+            : 0;
+    return iree_ok_status();
+  } else if (iree_string_view_equal(category, IREE_SV("hal.device"))) {
+    if (iree_string_view_equal(key, IREE_SV("concurrency"))) {
+      *out_value = (int64_t)device->queue_count;
+      return iree_ok_status();
+    }
+  } else if (iree_string_view_equal(category, IREE_SV("pim.stats"))) {
+    return iree_hal_pim_stats_query(&device->stats, key, out_value);
+  } else if (iree_string_view_equal(category, IREE_SV("pim.residency"))) {
+    iree_device_size_t resident_bytes = 0;
+    int64_t eviction_count = 0;
+    iree_hal_pim_allocator_query_residency(device->device_allocator,
+                                           &resident_bytes, &eviction_count);
+    if (iree_string_view_equal(key, IREE_SV("resident_bytes"))) {
+      *out_value = (int64_t)resident_bytes;
+      return iree_ok_status();
+    } else if (iree_string_view_equal(key, IREE_SV("evictions"))) {
+      *out_value = eviction_count;
+      return iree_ok_status();
+    }
+  }
+
+  return iree_make_status(
+      IREE_STATUS_NOT_FOUND,
+      "unknown device configuration key value '%.*s :: %.*s'",
+      (int)category.size, category.data, (int)key.size, key.data);
+}
+
+
+static iree_host_size_t iree_hal_pim_device_select_queue_index(
+    iree_hal_pim_device_t* device,
+    iree_hal_queue_affinity_t queue_affinity) {
+  // Each queue maps to one PIM module. As with the task device the lowest
+  // selected affinity bit picks the queue.
+  return iree_hal_pim_select_queue_index(device->queue_count, queue_affinity);
+}
+
+// Returns the latency model of the device or NULL if it is not simulated.
+static const iree_hal_pim_sim_params_t* iree_hal_pim_device_simulation(
+    iree_hal_pim_device_t* device) {
+  return iree_all_bits_set(device->flags, IREE_HAL_PIM_DEVICE_FLAG_SIMULATION)
+             ? &device->simulation
+             : NULL;
+}
+
+static iree_hal_pim_queue_t* iree_hal_pim_device_select_queue(
+    iree_hal_pim_device_t* device,
+    iree_hal_queue_affinity_t queue_affinity) {
+  return device->queues[iree_hal_pim_device_select_queue_index(
+      device, queue_affinity)];
+}
+
+static iree_status_t iree_hal_pim_device_create_channel(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    iree_hal_channel_params_t params, iree_hal_channel_t** out_channel) {
+  iree_hal_pim_device_t* device = iree_hal_pim_device_cast(base_device);
+
+  // By default every PIM module of the device participates with the rank
+  // matching the queue the affinity selects.
+  int32_t rank = 0;
+  int32_t count = 0;
+  IREE_RETURN_IF_ERROR(iree_hal_pim_resolve_channel_rank(
+      device->queue_count, queue_affinity, params.rank, params.count, &rank,
+      &count));
+  const iree_host_size_t queue_index =
+      iree_hal_pim_device_select_queue_index(device, queue_affinity);
+
+  // Collectives of the channel must be submitted with the same affinity; the
+  // group rejects ranks of this device that would share the selected queue.
+  return iree_hal_pim_channel_create(params.id, rank, count,
+                                     &device->queues[queue_index],
+                                     iree_hal_pim_device_simulation(device),
+                                     device->host_allocator, out_channel);
+}
+
+static iree_status_t iree_hal_pim_device_create_command_buffer(
+    iree_hal_device_t* base_device, iree_hal_command_buffer_mode_t mode,
+    iree_hal_command_category_t command_categories,
+    iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
+    iree_hal_command_buffer_t** out_command_buffer) {
+  iree_hal_pim_device_t* device = iree_hal_pim_device_cast(base_device);
+
+  // Only nested command buffers resolve binding table slots (against the
+  // table passed to execute_commands). Queue submissions carry no binding
+  // table so primary command buffers would replay with an empty one.
+  if (binding_capacity > 0 &&
+      !iree_all_bits_set(mode, IREE_HAL_COMMAND_BUFFER_MODE_NESTED)) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "PIM primary command buffers with binding tables "
+                            "are not implemented; only nested command buffers "
+                            "may have a binding capacity");
+  }
+
+  command_categories |= IREE_HAL_COMMAND_CATEGORY_DISPATCH;
+
+  if (iree_all_bits_set(mode,
+                        IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION)) {
+    // The caller has indicated the command buffer is one-shot and will not be
+    // reused; record straight into a PIM command stream.
+    return iree_hal_pim_direct_command_buffer_allocate(
+        base_device, device->host_allocator,
+        iree_hal_device_allocator(base_device), &device->block_pool,
+        iree_hal_pim_device_simulation(device), &device->stats, mode,
+        command_categories, queue_affinity, binding_capacity,
+        out_command_buffer);
+  }
+
+  if (iree_all_bits_set(mode, IREE_HAL_COMMAND_BUFFER_MODE_NESTED)) {
+    // Nested command buffers are recorded once and spliced into primary
+    // command buffers via execute_commands, resolving their indirect bindings
+    // against the binding table provided with each execution.
+    return iree_hal_pim_direct_command_buffer_allocate(
+        base_device, device->host_allocator,
+        iree_hal_device_allocator(base_device), &device->block_pool,
+        iree_hal_pim_device_simulation(device), &device->stats, mode,
+        command_categories, queue_affinity, binding_capacity,
+        out_command_buffer);
+  }
+
+  // Otherwise capture the commands and replay them as a single batched PIM
+  // command stream when the command buffer is submitted.
+  return iree_hal_deferred_command_buffer_create(
+      base_device, mode, command_categories, binding_capacity,
+      &device->block_pool, device->host_allocator, out_command_buffer);
+}
+
+static iree_status_t iree_hal_pim_device_create_descriptor_set_layout(
+    iree_hal_device_t* base_device,
+    iree_hal_descriptor_set_layout_flags_t flags,
+    iree_host_size_t binding_count,
+    const iree_hal_descriptor_set_layout_binding_t* bindings,
+    iree_hal_descriptor_set_layout_t** out_descriptor_set_layout) {
+  iree_hal_pim_device_t* device = iree_hal_pim_device_cast(base_device);
+
+  (void)device;
+
+  return iree_ok_status(); //iree_hal_pim_native_descriptor_set_layout_create()
+
+}
+
+static iree_status_t iree_hal_pim_device_create_event(
+    iree_hal_device_t* base_device, iree_hal_event_t** out_event) {
+  iree_hal_pim_device_t* device = iree_hal_pim_device_cast(base_device);
+
+  (void)device;
+
+  // iree_hal_pim_native_event_create(device->logical_device, out_event);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_pim_device_create_executable_cache(
+    iree_hal_device_t* base_device, iree_string_view_t identifier,
+    iree_loop_t loop, iree_hal_executable_cache_t** out_executable_cache) {
+  iree_hal_pim_device_t* device = iree_hal_pim_device_cast(base_device);
+  iree_hal_executable_cache_retain(device->executable_cache);
+  *out_executable_cache = device->executable_cache;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_pim_device_create_pipeline_layout(
+    iree_hal_device_t* base_device, iree_host_size_t push_constants,
+    iree_host_size_t set_layout_count,
+    iree_hal_descriptor_set_layout_t* const* set_layouts,
+    iree_hal_pipeline_layout_t** out_pipeline_layout) {
+  iree_hal_pim_device_t* device = iree_hal_pim_device_cast(base_device);
+  return iree_hal_pim_native_pipeline_layout_create(
+      device->host_allocator, push_constants, set_layout_count, set_layouts,
+      out_pipeline_layout);
+}
+
+static iree_status_t iree_hal_pim_device_create_semaphore(
+    iree_hal_device_t* base_device, uint64_t initial_value,
+    iree_hal_semaphore_t** out_semaphore) {
+  iree_hal_pim_device_t* device = iree_hal_pim_device_cast(base_device);
+  return iree_hal_pim_native_semaphore_create(device->host_allocator,
+                                              initial_value, out_semaphore);
+}
+
+static iree_hal_semaphore_compatibility_t
+iree_hal_pim_device_query_semaphore_compatibility(
+    iree_hal_device_t* base_device, iree_hal_semaphore_t* semaphore) {
+  if (iree_hal_pim_native_semaphore_isa(semaphore)) {
+    // Semaphores from any PIM device are waited on and signaled by the queue
+    // threads without involving the application.
+    return IREE_HAL_SEMAPHORE_COMPATIBILITY_ALL;
+  }
+  // TODO(benvanik): semaphore APIs for querying allowed export formats. We
+  // can check device caps to see what external semaphore types are supported.
+  return IREE_HAL_SEMAPHORE_COMPATIBILITY_HOST_ONLY;
+}
+
+// Transfers between host memory and PIM buffers directly through the SDK.
+// Mapping for the transfer would read back and re-upload the whole buffer.
+// Transfers involving buffers of other devices use the generic path.
+static iree_status_t iree_hal_pim_device_transfer_range(
+    iree_hal_device_t* base_device, iree_hal_transfer_buffer_t source,
+    iree_device_size_t source_offset, iree_hal_transfer_buffer_t target,
+    iree_device_size_t target_offset, iree_device_size_t data_length,
+    iree_hal_transfer_buffer_flags_t flags, iree_timeout_t timeout) {
+  iree_hal_buffer_t* source_buffer =
+      source.device_buffer
+          ? iree_hal_buffer_allocated_buffer(source.device_buffer)
+          : NULL;
+  iree_hal_buffer_t* target_buffer =
+      target.device_buffer
+          ? iree_hal_buffer_allocated_buffer(target.device_buffer)
+          : NULL;
+  if ((source_buffer && !iree_hal_pim_buffer_isa(source_buffer)) ||
+      (target_buffer && !iree_hal_pim_buffer_isa(target_buffer))) {
+    return iree_hal_device_submit_transfer_range_and_wait(
+        base_device, source, source_offset, target, target_offset, data_length,
+        flags, timeout);
+  }
+  if (source.device_buffer) {
+    source_offset += iree_hal_buffer_byte_offset(source.device_buffer);
+  }
+  if (target.device_buffer) {
+    target_offset += iree_hal_buffer_byte_offset(target.device_buffer);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)data_length);
+
+  iree_status_t status = iree_ok_status();
+  // host->host transfers are rejected by iree_hal_device_transfer_range.
+  if (!source_buffer) {
+    status = iree_hal_pim_buffer_upload_range(
+        target_buffer, target_offset, source.host_buffer.data + source_offset,
+        data_length);
+  } else if (!target_buffer) {
+    status = iree_hal_pim_buffer_download_range(
+        source_buffer, source_offset, target.host_buffer.data + target_offset,
+        data_length);
+  } else {
+    status = iree_hal_pim_buffer_copy_range(source_buffer, source_offset,
+                                            target_buffer, target_offset,
+                                            data_length);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static iree_status_t iree_hal_pim_device_queue_alloca(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_allocator_pool_t pool, iree_hal_buffer_params_t params,
+    iree_device_size_t allocation_size,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  iree_hal_pim_device_t* device = iree_hal_pim_device_cast(base_device);
+  iree_hal_allocator_t* allocator = iree_hal_device_allocator(base_device);
+  if (!iree_hal_pim_allocator_isa(allocator)) {
+    // Replacement allocators don't know about the PIM pool; allocate now and
+    // only order the signal after the waits with a barrier so that the host
+    // never blocks on the timeline.
+    iree_hal_buffer_t* buffer = NULL;
+    IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
+        allocator, params, allocation_size, iree_const_byte_span_empty(),
+        &buffer));
+    iree_status_t status = iree_hal_pim_queue_submit(
+        iree_hal_pim_device_select_queue(device, queue_affinity),
+        wait_semaphore_list, signal_semaphore_list,
+        /*command_buffer_count=*/0, /*command_buffers=*/NULL);
+    if (iree_status_is_ok(status)) {
+      *out_buffer = buffer;
+    } else {
+      iree_hal_buffer_release(buffer);
+    }
+    return status;
+  }
+
+  // The buffer is returned reserved and device memory is bound in queue order
+  // so that it can come from a dealloca retiring just before it.
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_pim_allocator_reserve_buffer(
+      allocator, params, allocation_size, &buffer));
+  iree_status_t status = iree_hal_pim_queue_submit_alloca(
+      iree_hal_pim_device_select_queue(device, queue_affinity),
+      wait_semaphore_list, signal_semaphore_list, buffer);
+  if (iree_status_is_ok(status)) {
+    *out_buffer = buffer;
+  } else {
+    iree_hal_buffer_release(buffer);
+  }
+  return status;
+}
+
+static iree_status_t iree_hal_pim_device_queue_dealloca(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_buffer_t* buffer) {
+  iree_hal_pim_device_t* device = iree_hal_pim_device_cast(base_device);
+  iree_hal_buffer_t* allocated_buffer =
+      iree_hal_buffer_allocated_buffer(buffer);
+  if (!iree_hal_pim_buffer_isa(allocated_buffer)) {
+    // NOTE: foreign buffers are returned to their allocator when their last
+    // reference is released; we only need to keep the timelines moving here.
+    return iree_hal_pim_queue_submit(
+        iree_hal_pim_device_select_queue(device, queue_affinity),
+        wait_semaphore_list, signal_semaphore_list,
+        /*command_buffer_count=*/0, /*command_buffers=*/NULL);
+  }
+  return iree_hal_pim_queue_submit_dealloca(
+      iree_hal_pim_device_select_queue(device, queue_affinity),
+      wait_semaphore_list, signal_semaphore_list, allocated_buffer);
+}
+
+static iree_status_t iree_hal_pim_device_queue_execute(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_host_size_t command_buffer_count,
+    iree_hal_command_buffer_t* const* command_buffers) {
+
+  iree_hal_pim_device_t* device = iree_hal_pim_device_cast(base_device);
+  // NOTE: today we are not discriminating queues based on command type.
+  iree_hal_pim_queue_t* queue =
+      iree_hal_pim_device_select_queue(device, queue_affinity);
+  return iree_hal_pim_queue_submit(queue, wait_semaphore_list,
+                                   signal_semaphore_list, command_buffer_count,
+                                   command_buffers);
+}
+
+static iree_status_t iree_hal_pim_device_queue_flush(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity) {
+  // Currently unused; we flush as submissions are made.
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_pim_device_wait_semaphores(
+    iree_hal_device_t* base_device, iree_hal_wait_mode_t wait_mode,
+    const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout) {
+  if (!iree_hal_pim_native_semaphore_list_isa(semaphore_list)) {
+    // Foreign semaphores can't share our notification; fall back to waiting
+    // on each in turn. This only works for all-waits.
+    if (wait_mode != IREE_HAL_WAIT_MODE_ALL) {
+      return iree_make_status(
+          IREE_STATUS_UNIMPLEMENTED,
+          "wait-any across semaphores from other devices is not supported");
+    }
+    return iree_hal_semaphore_list_wait(semaphore_list, timeout);
+  }
+  return iree_hal_pim_native_semaphore_multi_wait(wait_mode, semaphore_list,
+                                                  timeout);
+}
+
+static iree_status_t iree_hal_pim_device_profiling_begin(
+    iree_hal_device_t* base_device,
+    const iree_hal_device_profiling_options_t* options) {
+  return iree_hal_pim_profiling_begin(options);
+}
+
+static iree_status_t iree_hal_pim_device_profiling_end(
+    iree_hal_device_t* base_device) {
+  return iree_hal_pim_profiling_end();
+}
+
+namespace {
+const iree_hal_device_vtable_t iree_hal_pim_device_vtable = {
+    /*.destroy=*/iree_hal_pim_device_destroy,
+    /*.id=*/iree_hal_pim_device_id,
+    /*.host_allocator=*/iree_hal_pim_device_host_allocator,
+    /*.device_allocator=*/iree_hal_pim_device_allocator,
+    /*.replace_device_allocator=*/iree_hal_pim_replace_device_allocator,
+    /*.trim=*/iree_hal_pim_device_trim,
+    /*.query_i64=*/iree_hal_pim_device_query_i64,
+    /*.create_channel=*/iree_hal_pim_device_create_channel,
+    /*.create_command_buffer=*/iree_hal_pim_device_create_command_buffer,
+    /*.create_descriptor_set_layout=*/
+    iree_hal_pim_device_create_descriptor_set_layout,
+    /*.create_event=*/iree_hal_pim_device_create_event,
+    /*.create_executable_cache=*/
+    iree_hal_pim_device_create_executable_cache,
+    /*.create_pipeline_layout=*/
+    iree_hal_pim_device_create_pipeline_layout,
+    /*.create_semaphore=*/iree_hal_pim_device_create_semaphore,
+    /*.query_semaphore_compatibility=*/
+    iree_hal_pim_device_query_semaphore_compatibility,
+    /*.transfer_range=*/iree_hal_pim_device_transfer_range,
+    /*.queue_alloca=*/iree_hal_pim_device_queue_alloca,
+    /*.queue_dealloca=*/iree_hal_pim_device_queue_dealloca,
+    /*.queue_execute=*/iree_hal_pim_device_queue_execute,
+    /*.queue_flush=*/iree_hal_pim_device_queue_flush,
+    /*.wait_semaphores=*/iree_hal_pim_device_wait_semaphores,
+    /*.profiling_begin=*/iree_hal_pim_device_profiling_begin,
+    /*.profiling_end=*/iree_hal_pim_device_profiling_end,
+};
+}  // namespace
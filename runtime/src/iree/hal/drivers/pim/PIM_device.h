@@ -4,13 +4,13 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
-#ifndef IREE_HAL_DRIVERS_VULKAN_VULKAN_DEVICE_H_
-#define IREE_HAL_DRIVERS_VULKAN_VULKAN_DEVICE_H_
+#ifndef IREE_HAL_DRIVERS_PIM_VULKAN_DEVICE_H_
+#define IREE_HAL_DRIVERS_PIM_VULKAN_DEVICE_H_
 
 #include "iree/base/api.h"
 #include "iree/hal/api.h"
-#include "iree/hal/drivers/vulkan/api.h"
-#include "iree/hal/drivers/vulkan/dynamic_symbols.h"
+#include "iree/hal/drivers/pim/api.h"
+#include "iree/hal/drivers/pim/dynamic_symbols.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -22,9 +22,9 @@ extern "C" {
 // the driver owns the |instance| provided it is ensured to be valid. |driver|
 // may be NULL if there is no parent driver to retain (such as when wrapping
 // existing VkInstances provided by the application).
-iree_status_t iree_hal_vulkan_device_create(
+iree_status_t iree_hal_pim_device_create(
     iree_hal_driver_t* driver, iree_string_view_t identifier,
-    const iree_hal_vulkan_device_options_t* options,
+    const iree_hal_pim_device_options_t* options,
     iree_allocator_t host_allocator,
     iree_hal_device_t** out_device);
 
@@ -32,4 +32,4 @@ iree_status_t iree_hal_vulkan_device_create(
 }  // extern "C"
 #endif  // __cplusplus
 
-#endif  // IREE_HAL_DRIVERS_VULKAN_VULKAN_DEVICE_H_
+#endif  // IREE_HAL_DRIVERS_PIM_VULKAN_DEVICE_H_
@@ -4,7 +4,7 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
-#include "iree/hal/drivers/vulkan/PIM_driver.h"
+#include "iree/hal/drivers/pim/PIM_driver.h"
 
 #include <cstdint>
 #include <cstring>
@@ -12,16 +12,16 @@
 #include "iree/base/api.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/api.h"
-#include "iree/hal/drivers/vulkan/api.h"
-#include "iree/hal/drivers/vulkan/dynamic_symbols.h"
-#include "iree/hal/drivers/vulkan/status_util.h"
-#include "iree/hal/drivers/vulkan/util/arena.h"
-#include "iree/hal/drivers/vulkan/util/ref_ptr.h"
-#include "iree/hal/drivers/vulkan/PIM_device.h"
+#include "iree/hal/drivers/pim/api.h"
+#include "iree/hal/drivers/pim/dynamic_symbols.h"
+#include "iree/hal/drivers/pim/status_util.h"
+#include "iree/hal/drivers/pim/util/arena.h"
+#include "iree/hal/drivers/pim/util/ref_ptr.h"
+#include "iree/hal/drivers/pim/PIM_device.h"
 
-using namespace iree::hal::vulkan;
+using namespace iree::hal::pim;
 
-typedef struct iree_hal_vulkan_driver_t {
+typedef struct iree_hal_pim_driver_t {
   iree_hal_resource_t resource;
   iree_allocator_t host_allocator;
 
@@ -30,42 +30,42 @@ typedef struct iree_hal_vulkan_driver_t {
   // same process.
   iree_string_view_t identifier;
 
-  iree_hal_vulkan_device_options_t device_options;
-  
-} iree_hal_vulkan_driver_t;
+  iree_hal_pim_device_options_t device_options;
+
+} iree_hal_pim_driver_t;
 
 namespace {
-extern const iree_hal_driver_vtable_t iree_hal_vulkan_driver_vtable;
+extern const iree_hal_driver_vtable_t iree_hal_pim_driver_vtable;
 }  // namespace
 
-static iree_hal_vulkan_driver_t* iree_hal_vulkan_driver_cast(
+static iree_hal_pim_driver_t* iree_hal_pim_driver_cast(
     iree_hal_driver_t* base_value) {
-  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_vulkan_driver_vtable);
-  return (iree_hal_vulkan_driver_t*)base_value;
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_pim_driver_vtable);
+  return (iree_hal_pim_driver_t*)base_value;
 }
 
-IREE_API_EXPORT void iree_hal_vulkan_driver_options_initialize(
-    iree_hal_vulkan_driver_options_t* out_options) {
+IREE_API_EXPORT void iree_hal_pim_driver_options_initialize(
+    iree_hal_pim_driver_options_t* out_options) {
   memset(out_options, 0, sizeof(*out_options));
   out_options->api_version = VK_API_VERSION_1_2;
   out_options->requested_features = 0;
   out_options->debug_verbosity = 0;
-  iree_hal_vulkan_device_options_initialize(&out_options->device_options);
+  iree_hal_pim_device_options_initialize(&out_options->device_options);
 }
 
 // NOTE: takes ownership of |instance|.
-static iree_status_t iree_hal_vulkan_driver_create_internal(
+static iree_status_t iree_hal_pim_driver_create_internal(
     iree_string_view_t identifier,
-    const iree_hal_vulkan_driver_options_t* options,
+    const iree_hal_pim_driver_options_t* options,
     iree_allocator_t host_allocator,
     iree_hal_driver_t** out_driver) {
-  
-  iree_hal_vulkan_driver_t* driver = NULL;
+
+  iree_hal_pim_driver_t* driver = NULL;
   iree_host_size_t total_size = sizeof(*driver) + identifier.size;
   iree_status_t status =
       iree_allocator_malloc(host_allocator, total_size, (void**)&driver);
-  
-  iree_hal_resource_initialize(&iree_hal_vulkan_driver_vtable,
+
+  iree_hal_resource_initialize(&iree_hal_pim_driver_vtable,
                                &driver->resource);
   driver->host_allocator = host_allocator;
   iree_string_view_append_to_buffer(
@@ -74,13 +74,13 @@ static iree_status_t iree_hal_vulkan_driver_create_internal(
 
   memcpy(&driver->device_options, &options->device_options,
          sizeof(driver->device_options));
-   
+
   *out_driver = (iree_hal_driver_t*)driver;
   return status;
 }
 
-static void iree_hal_vulkan_driver_destroy(iree_hal_driver_t* base_driver) {
-  iree_hal_vulkan_driver_t* driver = iree_hal_vulkan_driver_cast(base_driver);
+static void iree_hal_pim_driver_destroy(iree_hal_driver_t* base_driver) {
+  iree_hal_pim_driver_t* driver = iree_hal_pim_driver_cast(base_driver);
   iree_allocator_t host_allocator = driver->host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
 
@@ -89,59 +89,66 @@ static void iree_hal_vulkan_driver_destroy(iree_hal_driver_t* base_driver) {
   IREE_TRACE_ZONE_END(z0);
 }
 
-IREE_API_EXPORT iree_status_t iree_hal_vulkan_driver_create(
+IREE_API_EXPORT iree_status_t iree_hal_pim_driver_create(
     iree_string_view_t identifier,
-    const iree_hal_vulkan_driver_options_t* options,
+    const iree_hal_pim_driver_options_t* options,
     iree_allocator_t host_allocator,
     iree_hal_driver_t** out_driver) {
   IREE_ASSERT_ARGUMENT(options);
   IREE_ASSERT_ARGUMENT(out_driver);
   IREE_TRACE_SCOPE();
 
-  
+
   iree_status_t status = iree_ok_status();
 
   if (iree_status_is_ok(status)) {
-    status = iree_hal_vulkan_driver_create_internal(
+    status = iree_hal_pim_driver_create_internal(
         identifier, options, host_allocator, out_driver);
   }
 
   if (!iree_status_is_ok(status)) {
-    
+
   }
   return status;
 }
 
-static iree_status_t iree_hal_vulkan_driver_query_available_devices(
+static iree_status_t iree_hal_pim_driver_query_available_devices(
     iree_hal_driver_t* base_driver, iree_allocator_t host_allocator,
     iree_host_size_t* out_device_info_count,
     iree_hal_device_info_t** out_device_infos) {
-  iree_hal_vulkan_driver_t* driver = iree_hal_vulkan_driver_cast(base_driver);
-
-  (void)driver;
-
-  printf("\nquery devices do nothing\n\n");
-
-  return iree_ok_status();
+  // All PIM modules in the node are exposed through a single device with one
+  // queue per module (see iree_hal_pim_device_options_t::queue_count).
+  static const iree_hal_device_info_t device_infos[1] = {
+      {
+          /*.device_id=*/IREE_HAL_DEVICE_ID_DEFAULT,
+          /*.path=*/iree_string_view_literal(""),
+          /*.name=*/iree_string_view_literal("PIM"),
+      },
+  };
+  *out_device_info_count = IREE_ARRAYSIZE(device_infos);
+  return iree_allocator_clone(
+      host_allocator,
+      iree_make_const_byte_span(device_infos, sizeof(device_infos)),
+      (void**)out_device_infos);
 }
 
-static iree_status_t iree_hal_vulkan_driver_dump_device_info(
+static iree_status_t iree_hal_pim_driver_dump_device_info(
     iree_hal_driver_t* base_driver, iree_hal_device_id_t device_id,
     iree_string_builder_t* builder) {
-  iree_hal_vulkan_driver_t* driver = iree_hal_vulkan_driver_cast(base_driver);
+  iree_hal_pim_driver_t* driver = iree_hal_pim_driver_cast(base_driver);
   // TODO(benvanik): dump detailed device info.
   (void)driver;
   return iree_ok_status();
 }
 
-static iree_status_t iree_hal_vulkan_driver_create_device_by_id(
+static iree_status_t iree_hal_pim_driver_create_device_by_id(
     iree_hal_driver_t* base_driver, iree_hal_device_id_t device_id,
     iree_host_size_t param_count, const iree_string_pair_t* params,
     iree_allocator_t host_allocator, iree_hal_device_t** out_device) {
-  iree_hal_vulkan_driver_t* driver = iree_hal_vulkan_driver_cast(base_driver);
+  iree_hal_pim_driver_t* driver = iree_hal_pim_driver_cast(base_driver);
   IREE_TRACE_ZONE_BEGIN(z0);
 
-    
+
   // iree_string_view_t device_name =
   //     iree_make_string_view(physical_device_properties.deviceName,
   //                           strlen(physical_device_properties.deviceName));
@@ -150,20 +157,21 @@ static iree_status_t iree_hal_vulkan_driver_create_device_by_id(
   // Attempt to create the device.
   // This may fail if the device was enumerated but is in exclusive use,
   // disabled by the system, or permission is denied.
-  iree_status_t status = iree_hal_vulkan_device_create(
-      base_driver, device_name, &driver->device_options, host_allocator, out_device);
+  iree_status_t status = iree_hal_pim_device_create(
+      base_driver, device_name, &driver->device_options, host_allocator,
+      out_device);
 
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
 
-static iree_status_t iree_hal_vulkan_driver_create_device_by_path(
+static iree_status_t iree_hal_pim_driver_create_device_by_path(
     iree_hal_driver_t* base_driver, iree_string_view_t driver_name,
     iree_string_view_t device_path, iree_host_size_t param_count,
     const iree_string_pair_t* params, iree_allocator_t host_allocator,
     iree_hal_device_t** out_device) {
   if (iree_string_view_is_empty(device_path)) {
-    return iree_hal_vulkan_driver_create_device_by_id(
+    return iree_hal_pim_driver_create_device_by_id(
         base_driver, IREE_HAL_DEVICE_ID_DEFAULT, param_count, params,
         host_allocator, out_device);
   }
@@ -172,12 +180,12 @@ static iree_status_t iree_hal_vulkan_driver_create_device_by_path(
 }
 
 namespace {
-const iree_hal_driver_vtable_t iree_hal_vulkan_driver_vtable = {
-    /*.destroy=*/iree_hal_vulkan_driver_destroy,
+const iree_hal_driver_vtable_t iree_hal_pim_driver_vtable = {
+    /*.destroy=*/iree_hal_pim_driver_destroy,
     /*.query_available_devices=*/
-    iree_hal_vulkan_driver_query_available_devices,
-    /*.dump_device_info=*/iree_hal_vulkan_driver_dump_device_info,
-    /*.create_device_by_id=*/iree_hal_vulkan_driver_create_device_by_id,
-    /*.create_device_by_path=*/iree_hal_vulkan_driver_create_device_by_path,
+    iree_hal_pim_driver_query_available_devices,
+    /*.dump_device_info=*/iree_hal_pim_driver_dump_device_info,
+    /*.create_device_by_id=*/iree_hal_pim_driver_create_device_by_id,
+    /*.create_device_by_path=*/iree_hal_pim_driver_create_device_by_path,
 };
 }  // namespace
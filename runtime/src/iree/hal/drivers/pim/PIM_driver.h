@@ -4,14 +4,14 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
-#ifndef IREE_HAL_DRIVERS_VULKAN_VULKAN_DRIVER_H_
-#define IREE_HAL_DRIVERS_VULKAN_VULKAN_DRIVER_H_
+#ifndef IREE_HAL_DRIVERS_PIM_VULKAN_DRIVER_H_
+#define IREE_HAL_DRIVERS_PIM_VULKAN_DRIVER_H_
 
 #include "iree/hal/api.h"
-#include "iree/hal/drivers/vulkan/api.h"
+#include "iree/hal/drivers/pim/api.h"
 
 // NOTE: the driver API calls are defined in api.h.
 // TODO(benvanik): clean that up? api.h is nice because then we only need to
 // deploy a single header file for the backend, but it is a bit tricky.
 
-#endif  // IREE_HAL_DRIVERS_VULKAN_VULKAN_DRIVER_H_
+#endif  // IREE_HAL_DRIVERS_PIM_VULKAN_DRIVER_H_
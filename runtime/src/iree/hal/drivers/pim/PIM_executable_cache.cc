@@ -0,0 +1,322 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/pim/PIM_executable_cache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/drivers/pim/native_executable.h"
+
+// A prepared executable and the parameters it was prepared with. Entries are
+// keyed by everything that influences the prepared executable: the data is
+// hashed for fast rejection and then compared in full against a copy kept by
+// the entry so that colliding executables are never confused. Host fallback
+// executables are bound to their pipeline layouts and all executables read
+// their constants at creation so both are part of the key.
+typedef struct iree_hal_pim_executable_cache_entry_t {
+  // Retained executable.
+  iree_hal_executable_t* executable;
+
+  // Key. All pointers reference trailing storage of this allocation.
+  // 64-bit FNV-1a hash of |executable_data|.
+  uint64_t hash;
+  iree_hal_executable_caching_mode_t caching_mode;
+  iree_string_view_t executable_format;
+  iree_const_byte_span_t executable_data;
+  // Retained layouts compared by identity. Retaining them ensures that the
+  // addresses are not reused by other layouts while the entry exists.
+  iree_host_size_t pipeline_layout_count;
+  iree_hal_pipeline_layout_t** pipeline_layouts;
+  iree_host_size_t constant_count;
+  const uint32_t* constants;
+} iree_hal_pim_executable_cache_entry_t;
+
+typedef struct iree_hal_pim_executable_cache_t {
+  iree_hal_resource_t resource;
+  iree_allocator_t host_allocator;
+
+  // Optional loader of host fallback executables.
+  iree_hal_executable_loader_t* host_loader;
+
+  // Latency model of the device uploads are profiled with if |simulated|.
+  bool simulated;
+  iree_hal_pim_sim_params_t simulation;
+
+  // Guards the entry list.
+  iree_slim_mutex_t mutex;
+  iree_host_size_t entry_count;
+  iree_host_size_t entry_capacity;
+  iree_hal_pim_executable_cache_entry_t** entries;
+} iree_hal_pim_executable_cache_t;
+
+namespace {
+extern const iree_hal_executable_cache_vtable_t
+    iree_hal_pim_executable_cache_vtable;
+}  // namespace
+
+static iree_hal_pim_executable_cache_t* iree_hal_pim_executable_cache_cast(
+    iree_hal_executable_cache_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_pim_executable_cache_vtable);
+  return (iree_hal_pim_executable_cache_t*)base_value;
+}
+
+iree_status_t iree_hal_pim_executable_cache_create(
+    iree_allocator_t host_allocator, iree_string_view_t identifier,
+    iree_hal_executable_loader_t* host_loader,
+    const iree_hal_pim_sim_params_t* simulation,
+    iree_hal_executable_cache_t** out_executable_cache) {
+  IREE_ASSERT_ARGUMENT(out_executable_cache);
+  *out_executable_cache = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_pim_executable_cache_t* executable_cache = NULL;
+  iree_status_t status = iree_allocator_malloc(
+      host_allocator, sizeof(*executable_cache), (void**)&executable_cache);
+  if (iree_status_is_ok(status)) {
+    iree_hal_resource_initialize(&iree_hal_pim_executable_cache_vtable,
+                                 &executable_cache->resource);
+    executable_cache->host_allocator = host_allocator;
+    executable_cache->host_loader = host_loader;
+    iree_hal_executable_loader_retain(host_loader);
+    executable_cache->simulated = simulation != NULL;
+    if (simulation) executable_cache->simulation = *simulation;
+    iree_slim_mutex_initialize(&executable_cache->mutex);
+
+    *out_executable_cache = (iree_hal_executable_cache_t*)executable_cache;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_pim_executable_cache_destroy(
+    iree_hal_executable_cache_t* base_executable_cache) {
+  iree_hal_pim_executable_cache_t* executable_cache =
+      iree_hal_pim_executable_cache_cast(base_executable_cache);
+  iree_allocator_t host_allocator = executable_cache->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  for (iree_host_size_t i = 0; i < executable_cache->entry_count; ++i) {
+    iree_hal_pim_executable_cache_entry_t* entry = executable_cache->entries[i];
+    iree_hal_executable_release(entry->executable);
+    for (iree_host_size_t j = 0; j < entry->pipeline_layout_count; ++j) {
+      iree_hal_pipeline_layout_release(entry->pipeline_layouts[j]);
+    }
+    iree_allocator_free(host_allocator, entry);
+  }
+  iree_allocator_free(host_allocator, executable_cache->entries);
+  iree_hal_executable_loader_release(executable_cache->host_loader);
+  iree_slim_mutex_deinitialize(&executable_cache->mutex);
+  iree_allocator_free(host_allocator, executable_cache);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Returns true if |executable_format| is a PIM executable. SPVE is the format
+// identifier used by modules compiled before the PIM format was named.
+static bool iree_hal_pim_executable_cache_is_pim_format(
+    iree_string_view_t executable_format) {
+  return iree_string_view_equal(executable_format, IREE_SV("pim-isr-fb")) ||
+         iree_string_view_equal(executable_format, IREE_SV("SPVE"));
+}
+
+static bool iree_hal_pim_executable_cache_can_prepare_format(
+    iree_hal_executable_cache_t* base_executable_cache,
+    iree_hal_executable_caching_mode_t caching_mode,
+    iree_string_view_t executable_format) {
+  iree_hal_pim_executable_cache_t* executable_cache =
+      iree_hal_pim_executable_cache_cast(base_executable_cache);
+  if (iree_hal_pim_executable_cache_is_pim_format(executable_format)) {
+    return true;
+  }
+  return executable_cache->host_loader &&
+         iree_hal_executable_loader_query_support(
+             executable_cache->host_loader, caching_mode, executable_format);
+}
+
+// Hashes the executable contents with 64-bit FNV-1a. Only used to quickly
+// reject mismatching entries.
+static uint64_t iree_hal_pim_executable_cache_hash(
+    iree_const_byte_span_t data) {
+  uint64_t hash = 0xCBF29CE484222325ull;
+  for (iree_host_size_t i = 0; i < data.data_length; ++i) {
+    hash ^= data.data[i];
+    hash *= 0x100000001B3ull;
+  }
+  return hash;
+}
+
+// Returns true if |entry| was prepared with |params|.
+static bool iree_hal_pim_executable_cache_entry_matches(
+    const iree_hal_pim_executable_cache_entry_t* entry, uint64_t hash,
+    const iree_hal_executable_params_t* params) {
+  if (entry->hash != hash || entry->caching_mode != params->caching_mode ||
+      entry->executable_data.data_length !=
+          params->executable_data.data_length ||
+      entry->pipeline_layout_count != params->pipeline_layout_count ||
+      entry->constant_count != params->constant_count ||
+      !iree_string_view_equal(entry->executable_format,
+                              params->executable_format)) {
+    return false;
+  }
+  for (iree_host_size_t i = 0; i < entry->pipeline_layout_count; ++i) {
+    if (entry->pipeline_layouts[i] != params->pipeline_layouts[i]) return false;
+  }
+  if (entry->constant_count > 0 &&
+      memcmp(entry->constants, params->constants,
+             entry->constant_count * sizeof(*entry->constants)) != 0) {
+    return false;
+  }
+  return memcmp(entry->executable_data.data, params->executable_data.data,
+                entry->executable_data.data_length) == 0;
+}
+
+// Returns the entry prepared with |params| or NULL if not found.
+// Must be called with the cache mutex held.
+static iree_hal_pim_executable_cache_entry_t*
+iree_hal_pim_executable_cache_lookup(
+    iree_hal_pim_executable_cache_t* executable_cache, uint64_t hash,
+    const iree_hal_executable_params_t* params) {
+  for (iree_host_size_t i = 0; i < executable_cache->entry_count; ++i) {
+    iree_hal_pim_executable_cache_entry_t* entry = executable_cache->entries[i];
+    if (iree_hal_pim_executable_cache_entry_matches(entry, hash, params)) {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+// Inserts |executable| prepared with |params| into the cache, retaining it and
+// copying the key.
+// Must be called with the cache mutex held.
+static iree_status_t iree_hal_pim_executable_cache_insert(
+    iree_hal_pim_executable_cache_t* executable_cache, uint64_t hash,
+    const iree_hal_executable_params_t* params,
+    iree_hal_executable_t* executable) {
+  iree_allocator_t host_allocator = executable_cache->host_allocator;
+  if (executable_cache->entry_count == executable_cache->entry_capacity) {
+    iree_host_size_t new_capacity =
+        iree_max(8, executable_cache->entry_capacity * 2);
+    IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+        host_allocator, new_capacity * sizeof(*executable_cache->entries),
+        (void**)&executable_cache->entries));
+    executable_cache->entry_capacity = new_capacity;
+  }
+
+  // Layout pointers and constants are laid out first to keep them aligned.
+  iree_hal_pim_executable_cache_entry_t* entry = NULL;
+  iree_host_size_t total_size =
+      iree_sizeof_struct(*entry) +
+      params->pipeline_layout_count * sizeof(*entry->pipeline_layouts) +
+      params->constant_count * sizeof(*entry->constants) +
+      params->executable_format.size + params->executable_data.data_length;
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_malloc(host_allocator, total_size, (void**)&entry));
+  uint8_t* storage = (uint8_t*)entry + iree_sizeof_struct(*entry);
+  entry->executable = executable;
+  iree_hal_executable_retain(executable);
+  entry->hash = hash;
+  entry->caching_mode = params->caching_mode;
+  entry->pipeline_layout_count = params->pipeline_layout_count;
+  entry->pipeline_layouts = (iree_hal_pipeline_layout_t**)storage;
+  for (iree_host_size_t i = 0; i < params->pipeline_layout_count; ++i) {
+    entry->pipeline_layouts[i] = params->pipeline_layouts[i];
+    iree_hal_pipeline_layout_retain(params->pipeline_layouts[i]);
+  }
+  storage += params->pipeline_layout_count * sizeof(*entry->pipeline_layouts);
+  entry->constant_count = params->constant_count;
+  entry->constants = (const uint32_t*)storage;
+  if (params->constant_count > 0) {
+    memcpy(storage, params->constants,
+           params->constant_count * sizeof(*entry->constants));
+  }
+  storage += params->constant_count * sizeof(*entry->constants);
+  storage += iree_string_view_append_to_buffer(
+      params->executable_format, &entry->executable_format, (char*)storage);
+  if (params->executable_data.data_length > 0) {
+    memcpy(storage, params->executable_data.data,
+           params->executable_data.data_length);
+  }
+  entry->executable_data =
+      iree_make_const_byte_span(storage, params->executable_data.data_length);
+
+  executable_cache->entries[executable_cache->entry_count++] = entry;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_pim_executable_cache_prepare_executable(
+    iree_hal_executable_cache_t* base_executable_cache,
+    const iree_hal_executable_params_t* executable_params,
+    iree_hal_executable_t** out_executable) {
+  iree_hal_pim_executable_cache_t* executable_cache =
+      iree_hal_pim_executable_cache_cast(base_executable_cache);
+  *out_executable = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_const_byte_span_t data = executable_params->executable_data;
+  uint64_t hash = iree_hal_pim_executable_cache_hash(data);
+
+  // The mutex is held across creation so that concurrent loads of the same
+  // executable only decode it once.
+  iree_slim_mutex_lock(&executable_cache->mutex);
+
+  iree_status_t status = iree_ok_status();
+  iree_hal_pim_executable_cache_entry_t* entry =
+      iree_hal_pim_executable_cache_lookup(executable_cache, hash,
+                                           executable_params);
+  if (entry) {
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "hit");
+    iree_hal_executable_retain(entry->executable);
+    *out_executable = entry->executable;
+  } else {
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "miss");
+    iree_hal_executable_t* executable = NULL;
+    if (iree_hal_pim_executable_cache_is_pim_format(
+            executable_params->executable_format) ||
+        !executable_cache->host_loader) {
+      status = iree_hal_pim_native_executable_create(
+          executable_cache->host_allocator,
+          executable_cache->simulated ? &executable_cache->simulation : NULL,
+          executable_params, &executable);
+    } else {
+      // Host fallbacks run inline on the queue thread of a single module.
+      status = iree_hal_executable_loader_try_load(
+          executable_cache->host_loader, executable_params,
+          /*worker_capacity=*/1, &executable);
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_pim_executable_cache_insert(executable_cache, hash,
+                                                    executable_params,
+                                                    executable);
+    }
+    if (iree_status_is_ok(status)) {
+      *out_executable = executable;
+    } else {
+      iree_hal_executable_release(executable);
+    }
+  }
+
+  iree_slim_mutex_unlock(&executable_cache->mutex);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+namespace {
+const iree_hal_executable_cache_vtable_t iree_hal_pim_executable_cache_vtable =
+    {
+        /*.destroy=*/iree_hal_pim_executable_cache_destroy,
+        /*.can_prepare_format=*/
+        iree_hal_pim_executable_cache_can_prepare_format,
+        /*.prepare_executable=*/
+        iree_hal_pim_executable_cache_prepare_executable,
+};
+}  // namespace
@@ -0,0 +1,45 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_PIM_PIM_EXECUTABLE_CACHE_H_
+#define IREE_HAL_DRIVERS_PIM_PIM_EXECUTABLE_CACHE_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/pim/util/pim_sim_model.h"
+#include "iree/hal/local/executable_loader.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Creates an executable cache that retains every executable it prepares keyed
+// by its parameters: the executable format and data, the pipeline layouts and
+// the constants. Preparing an executable with the same parameters as a
+// previously prepared one returns the existing executable without verifying or
+// decoding the FlatBuffer again.
+//
+// The cache is safe to use from multiple threads and is intended to be shared
+// by all contexts created on a device so that reloading the same module hits.
+//
+// Executables in a format other than the PIM one are loaded with the optional
+// |host_loader| (retained) and run on the host by the command buffers of the
+// device. These are the fallback variants of dispatches the PIM backend could
+// not lower.
+//
+// Uploads made while preparing PIM executables are profiled with |simulation|
+// (copied) if not NULL.
+iree_status_t iree_hal_pim_executable_cache_create(
+    iree_allocator_t host_allocator, iree_string_view_t identifier,
+    iree_hal_executable_loader_t* host_loader,
+    const iree_hal_pim_sim_params_t* simulation,
+    iree_hal_executable_cache_t** out_executable_cache);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_PIM_PIM_EXECUTABLE_CACHE_H_
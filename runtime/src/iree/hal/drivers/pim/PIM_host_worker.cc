@@ -0,0 +1,174 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/pim/PIM_host_worker.h"
+
+#include <cstring>
+
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/threading.h"
+#include "iree/base/tracing.h"
+
+struct iree_hal_pim_host_worker_t {
+  iree_allocator_t host_allocator;
+
+  // Thread running the launched jobs.
+  iree_thread_t* thread;
+
+  // Posted whenever a job is launched or completes or exit is requested.
+  iree_notification_t notification;
+
+  // Guards the job slot and exit flag.
+  iree_slim_mutex_t mutex;
+  // Job waiting to be picked up by the thread or NULL.
+  iree_hal_pim_host_worker_fn_t fn IREE_GUARDED_BY(mutex);
+  void* user_data IREE_GUARDED_BY(mutex);
+  // Set from launch until the job has completed.
+  bool busy IREE_GUARDED_BY(mutex);
+  // Status of the completed job, returned by the next join.
+  iree_status_t status IREE_GUARDED_BY(mutex);
+  bool exit_requested IREE_GUARDED_BY(mutex);
+};
+
+// Returns true if the worker thread has a job to run or should exit.
+// Used with iree_condition_fn_t and must match that signature.
+static bool iree_hal_pim_host_worker_has_pending(
+    iree_hal_pim_host_worker_t* worker) {
+  iree_slim_mutex_lock(&worker->mutex);
+  bool has_pending = worker->fn != NULL || worker->exit_requested;
+  iree_slim_mutex_unlock(&worker->mutex);
+  return has_pending;
+}
+
+// Returns true if no job is in flight.
+// Used with iree_condition_fn_t and must match that signature.
+static bool iree_hal_pim_host_worker_is_idle(
+    iree_hal_pim_host_worker_t* worker) {
+  iree_slim_mutex_lock(&worker->mutex);
+  bool is_idle = !worker->busy;
+  iree_slim_mutex_unlock(&worker->mutex);
+  return is_idle;
+}
+
+static int iree_hal_pim_host_worker_thread_main(void* entry_arg) {
+  iree_hal_pim_host_worker_t* worker = (iree_hal_pim_host_worker_t*)entry_arg;
+  while (true) {
+    iree_notification_await(
+        &worker->notification,
+        (iree_condition_fn_t)iree_hal_pim_host_worker_has_pending, worker,
+        iree_infinite_timeout());
+
+    // A launched job is always run before honoring exit requests so that its
+    // joiner is never left waiting.
+    iree_slim_mutex_lock(&worker->mutex);
+    iree_hal_pim_host_worker_fn_t fn = worker->fn;
+    void* user_data = worker->user_data;
+    worker->fn = NULL;
+    bool exit_requested = worker->exit_requested;
+    iree_slim_mutex_unlock(&worker->mutex);
+
+    if (!fn) {
+      if (exit_requested) break;
+      continue;
+    }
+
+    IREE_TRACE_ZONE_BEGIN_NAMED(z0, "iree_hal_pim_host_worker_job");
+    iree_status_t status = fn(user_data);
+    IREE_TRACE_ZONE_END(z0);
+
+    iree_slim_mutex_lock(&worker->mutex);
+    worker->status = status;
+    worker->busy = false;
+    iree_slim_mutex_unlock(&worker->mutex);
+    iree_notification_post(&worker->notification, IREE_ALL_WAITERS);
+  }
+  return 0;
+}
+
+iree_status_t iree_hal_pim_host_worker_create(
+    iree_string_view_t identifier, iree_allocator_t host_allocator,
+    iree_hal_pim_host_worker_t** out_worker) {
+  IREE_ASSERT_ARGUMENT(out_worker);
+  *out_worker = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_pim_host_worker_t* worker = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*worker),
+                                (void**)&worker));
+  memset(worker, 0, sizeof(*worker));
+  worker->host_allocator = host_allocator;
+  worker->status = iree_ok_status();
+  iree_notification_initialize(&worker->notification);
+  iree_slim_mutex_initialize(&worker->mutex);
+
+  iree_thread_create_params_t params;
+  memset(&params, 0, sizeof(params));
+  params.name = identifier;
+  iree_status_t status =
+      iree_thread_create(iree_hal_pim_host_worker_thread_main, worker, params,
+                         host_allocator, &worker->thread);
+
+  if (iree_status_is_ok(status)) {
+    *out_worker = worker;
+  } else {
+    iree_hal_pim_host_worker_destroy(worker);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+void iree_hal_pim_host_worker_destroy(iree_hal_pim_host_worker_t* worker) {
+  if (!worker) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  if (worker->thread) {
+    iree_slim_mutex_lock(&worker->mutex);
+    worker->exit_requested = true;
+    iree_slim_mutex_unlock(&worker->mutex);
+    iree_notification_post(&worker->notification, IREE_ALL_WAITERS);
+
+    // Joins the thread.
+    iree_thread_release(worker->thread);
+  }
+  iree_status_ignore(worker->status);
+
+  iree_slim_mutex_deinitialize(&worker->mutex);
+  iree_notification_deinitialize(&worker->notification);
+  iree_allocator_free(worker->host_allocator, worker);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+void iree_hal_pim_host_worker_launch(iree_hal_pim_host_worker_t* worker,
+                                     iree_hal_pim_host_worker_fn_t fn,
+                                     void* user_data) {
+  IREE_ASSERT_ARGUMENT(worker);
+  IREE_ASSERT_ARGUMENT(fn);
+  iree_slim_mutex_lock(&worker->mutex);
+  IREE_ASSERT(!worker->busy, "host job launched before joining the last one");
+  worker->fn = fn;
+  worker->user_data = user_data;
+  worker->busy = true;
+  iree_slim_mutex_unlock(&worker->mutex);
+  iree_notification_post(&worker->notification, IREE_ALL_WAITERS);
+}
+
+iree_status_t iree_hal_pim_host_worker_join(
+    iree_hal_pim_host_worker_t* worker) {
+  IREE_ASSERT_ARGUMENT(worker);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_notification_await(
+      &worker->notification,
+      (iree_condition_fn_t)iree_hal_pim_host_worker_is_idle, worker,
+      iree_infinite_timeout());
+  iree_slim_mutex_lock(&worker->mutex);
+  iree_status_t status = worker->status;
+  worker->status = iree_ok_status();
+  iree_slim_mutex_unlock(&worker->mutex);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
@@ -0,0 +1,50 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_PIM_PIM_HOST_WORKER_H_
+#define IREE_HAL_DRIVERS_PIM_PIM_HOST_WORKER_H_
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// A thread running one host job at a time for a PIM queue.
+//
+// The queue thread hands host fallback dispatches (such as softmax or layer
+// norms compiled for the host) to the worker and keeps issuing the PIM
+// dispatches recorded alongside them until it reaches a command that depends
+// on the host result. Jobs must not call into the PIM SDK, which is only
+// driven from the queue thread.
+typedef struct iree_hal_pim_host_worker_t iree_hal_pim_host_worker_t;
+
+// Runs a host job on the worker thread and returns its status.
+typedef iree_status_t(IREE_API_PTR* iree_hal_pim_host_worker_fn_t)(
+    void* user_data);
+
+// Creates a worker and launches its thread.
+iree_status_t iree_hal_pim_host_worker_create(
+    iree_string_view_t identifier, iree_allocator_t host_allocator,
+    iree_hal_pim_host_worker_t** out_worker);
+
+// Waits for any launched job, joins the worker thread, and frees the worker.
+void iree_hal_pim_host_worker_destroy(iree_hal_pim_host_worker_t* worker);
+
+// Runs |fn| with |user_data| on the worker thread and returns immediately.
+// Only one job may be in flight; it must be joined before the next launch.
+void iree_hal_pim_host_worker_launch(iree_hal_pim_host_worker_t* worker,
+                                     iree_hal_pim_host_worker_fn_t fn,
+                                     void* user_data);
+
+// Waits for the job launched last and returns its status.
+iree_status_t iree_hal_pim_host_worker_join(iree_hal_pim_host_worker_t* worker);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_PIM_PIM_HOST_WORKER_H_
@@ -0,0 +1,340 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/pim/PIM_profiling.h"
+
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/drivers/pim/util/pim_executable_dump.h"
+
+static_assert(IREE_HAL_PIM_OP_TYPE_COUNT == IREE_HAL_PIM_OPCODE_COUNT,
+              "profiled op types must match the executable opcodes");
+
+const char* iree_hal_pim_op_type_name(int op_type) {
+  if (op_type < 0) op_type = 0;
+  return iree_hal_pim_opcode_name((uint32_t)op_type);
+}
+
+typedef struct iree_hal_pim_profiling_state_t {
+  // Checked on every SDK call without taking the mutex.
+  std::atomic<bool> enabled;
+
+  // Guards all fields below.
+  iree_slim_mutex_t mutex;
+  iree_hal_device_profiling_mode_t mode;
+  std::vector<char> file_path;
+  std::vector<iree_hal_pim_profile_event_t> events;
+
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
+  // Tracy GPU context used to show SDK calls on a device timeline. Tracy has
+  // a limited number of contexts so one is shared by the process.
+  bool tracing_context_allocated;
+  uint8_t tracing_context_id;
+  uint16_t next_query_id;
+#endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
+} iree_hal_pim_profiling_state_t;
+
+static iree_hal_pim_profiling_state_t* iree_hal_pim_profiling_state() {
+  static iree_hal_pim_profiling_state_t state;
+  static bool initialized = (iree_slim_mutex_initialize(&state.mutex), true);
+  (void)initialized;
+  return &state;
+}
+
+iree_status_t iree_hal_pim_profiling_begin(
+    const iree_hal_device_profiling_options_t* options) {
+  iree_hal_pim_profiling_state_t* state = iree_hal_pim_profiling_state();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_slim_mutex_lock(&state->mutex);
+  iree_status_t status = iree_ok_status();
+  if (state->enabled.load(std::memory_order_relaxed)) {
+    status = iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                              "PIM profiling is already active");
+  } else if (options->mode != IREE_HAL_DEVICE_PROFILING_MODE_NONE) {
+    state->mode = options->mode;
+    state->file_path.clear();
+    if (options->file_path) {
+      const char* file_path = options->file_path;
+      state->file_path.assign(file_path, file_path + strlen(file_path) + 1);
+    }
+    state->events.clear();
+
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
+    if (!state->tracing_context_allocated) {
+      // Events are recorded with iree_time_now() so the device timeline runs
+      // in nanoseconds. Tracy aligns it with the CPU clock at creation.
+      static const char kName[] = "PIM";
+      state->tracing_context_id = iree_tracing_gpu_context_allocate(
+          IREE_TRACING_GPU_CONTEXT_TYPE_VULKAN, kName, sizeof(kName) - 1,
+          /*is_calibrated=*/false, iree_tracing_time(), iree_time_now(),
+          /*timestamp_period=*/1.0f);
+      state->tracing_context_allocated = true;
+    }
+#endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
+
+    state->enabled.store(true, std::memory_order_release);
+  }
+  iree_slim_mutex_unlock(&state->mutex);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+bool iree_hal_pim_profiling_is_enabled(void) {
+  return iree_hal_pim_profiling_state()->enabled.load(
+      std::memory_order_acquire);
+}
+
+void iree_hal_pim_profiling_record(const iree_hal_pim_profile_event_t* event) {
+  iree_hal_pim_profiling_state_t* state = iree_hal_pim_profiling_state();
+  if (!state->enabled.load(std::memory_order_acquire)) return;
+
+  iree_slim_mutex_lock(&state->mutex);
+  if (state->enabled.load(std::memory_order_relaxed)) {
+    state->events.push_back(*event);
+
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
+    if (iree_any_bit_set(state->mode,
+                         IREE_HAL_DEVICE_PROFILING_MODE_QUEUE_OPERATIONS)) {
+      const char* name = "pim_transfer";
+      switch (event->kind) {
+        case IREE_HAL_PIM_PROFILE_EVENT_UPLOAD:
+          name = "pim_upload";
+          break;
+        case IREE_HAL_PIM_PROFILE_EVENT_DOWNLOAD:
+          name = "pim_download";
+          break;
+        case IREE_HAL_PIM_PROFILE_EVENT_DISPATCH:
+          name = iree_hal_pim_op_type_name(event->op_type);
+          break;
+        case IREE_HAL_PIM_PROFILE_EVENT_COLLECTIVE:
+          name = "pim_collective";
+          break;
+      }
+      // Events are emitted after they complete so begin/end pairs never
+      // overlap and query IDs can simply wrap.
+      uint16_t begin_query_id = state->next_query_id++;
+      uint16_t end_query_id = state->next_query_id++;
+      iree_tracing_gpu_zone_begin_external(
+          state->tracing_context_id, begin_query_id, __FILE__,
+          sizeof(__FILE__) - 1, __LINE__, __func__, sizeof(__func__) - 1, name,
+          strlen(name));
+      iree_tracing_gpu_zone_end(state->tracing_context_id, end_query_id);
+      iree_tracing_gpu_zone_notify(state->tracing_context_id, begin_query_id,
+                                   event->start_ns);
+      iree_tracing_gpu_zone_notify(state->tracing_context_id, end_query_id,
+                                   event->end_ns);
+    }
+#endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
+  }
+  iree_slim_mutex_unlock(&state->mutex);
+}
+
+typedef struct iree_hal_pim_profile_totals_t {
+  uint64_t count;
+  iree_time_t duration_ns;
+  uint64_t bytes_in;
+  uint64_t bytes_out;
+} iree_hal_pim_profile_totals_t;
+
+static void iree_hal_pim_profile_totals_accumulate(
+    iree_hal_pim_profile_totals_t* totals,
+    const iree_hal_pim_profile_event_t* event) {
+  ++totals->count;
+  totals->duration_ns += event->end_ns - event->start_ns;
+  totals->bytes_in += event->bytes_in;
+  totals->bytes_out += event->bytes_out;
+}
+
+static void iree_hal_pim_profile_totals_print(
+    FILE* file, const char* name, const iree_hal_pim_profile_totals_t* totals,
+    bool trailing_comma) {
+  fprintf(file,
+          "    {\"name\": \"%s\", \"count\": %" PRIu64
+          ", \"duration_ns\": %" PRId64 ", \"bytes_in\": %" PRIu64
+          ", \"bytes_out\": %" PRIu64 "}%s\n",
+          name, totals->count, totals->duration_ns, totals->bytes_in,
+          totals->bytes_out, trailing_comma ? "," : "");
+}
+
+// Writes the captured events as JSON. The summary splits device time between
+// dispatches, host<->PIM transfers and collectives so that it is easy to tell
+// which one bounds a workload.
+static void iree_hal_pim_profiling_write_summary(
+    FILE* file, const std::vector<iree_hal_pim_profile_event_t>& events) {
+  iree_hal_pim_profile_totals_t ops[IREE_HAL_PIM_OP_TYPE_COUNT] = {};
+  iree_hal_pim_profile_totals_t upload = {};
+  iree_hal_pim_profile_totals_t download = {};
+  iree_hal_pim_profile_totals_t collective = {};
+  for (const auto& event : events) {
+    switch (event.kind) {
+      case IREE_HAL_PIM_PROFILE_EVENT_UPLOAD:
+        iree_hal_pim_profile_totals_accumulate(&upload, &event);
+        break;
+      case IREE_HAL_PIM_PROFILE_EVENT_DOWNLOAD:
+        iree_hal_pim_profile_totals_accumulate(&download, &event);
+        break;
+      case IREE_HAL_PIM_PROFILE_EVENT_COLLECTIVE:
+        iree_hal_pim_profile_totals_accumulate(&collective, &event);
+        break;
+      case IREE_HAL_PIM_PROFILE_EVENT_DISPATCH: {
+        int op_type = event.op_type;
+        if (op_type < 0 || op_type >= IREE_HAL_PIM_OP_TYPE_COUNT) op_type = 0;
+        iree_hal_pim_profile_totals_accumulate(&ops[op_type], &event);
+        break;
+      }
+    }
+  }
+
+  fprintf(file, "{\n  \"dispatches\": [\n");
+  bool first = true;
+  for (const auto& event : events) {
+    if (event.kind != IREE_HAL_PIM_PROFILE_EVENT_DISPATCH) continue;
+    fprintf(file,
+            "%s    {\"op\": \"%s\", \"start_ns\": %" PRId64
+            ", \"duration_ns\": %" PRId64 ", \"bytes_in\": %" PRIu64
+            ", \"bytes_out\": %" PRIu64 "}",
+            first ? "" : ",\n", iree_hal_pim_op_type_name(event.op_type),
+            event.start_ns, event.end_ns - event.start_ns, event.bytes_in,
+            event.bytes_out);
+    first = false;
+  }
+  fprintf(file, "%s  ],\n  \"ops\": [\n", first ? "" : "\n");
+  int last_op_type = -1;
+  for (int i = 0; i < IREE_HAL_PIM_OP_TYPE_COUNT; ++i) {
+    if (ops[i].count) last_op_type = i;
+  }
+  for (int i = 0; i <= last_op_type; ++i) {
+    if (!ops[i].count) continue;
+    iree_hal_pim_profile_totals_print(file, iree_hal_pim_op_type_name(i),
+                                      &ops[i], i != last_op_type);
+  }
+  fprintf(file, "  ],\n  \"transfers\": [\n");
+  iree_hal_pim_profile_totals_print(file, "upload", &upload, true);
+  iree_hal_pim_profile_totals_print(file, "download", &download, true);
+  iree_hal_pim_profile_totals_print(file, "collective", &collective, false);
+  fprintf(file, "  ]\n}\n");
+}
+
+iree_status_t iree_hal_pim_profiling_end(void) {
+  iree_hal_pim_profiling_state_t* state = iree_hal_pim_profiling_state();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_slim_mutex_lock(&state->mutex);
+  iree_status_t status = iree_ok_status();
+  if (state->enabled.load(std::memory_order_relaxed)) {
+    state->enabled.store(false, std::memory_order_release);
+
+    FILE* file = stderr;
+    if (!state->file_path.empty()) {
+      file = fopen(state->file_path.data(), "w");
+      if (!file) {
+        status = iree_make_status(IREE_STATUS_PERMISSION_DENIED,
+                                  "unable to open PIM profile file '%s'",
+                                  state->file_path.data());
+      }
+    }
+    if (file) {
+      iree_hal_pim_profiling_write_summary(file, state->events);
+      if (file != stderr) fclose(file);
+    }
+    state->events.clear();
+    state->events.shrink_to_fit();
+  }
+  iree_slim_mutex_unlock(&state->mutex);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+//===----------------------------------------------------------------------===//
+// Dispatch statistics
+//===----------------------------------------------------------------------===//
+
+static const char* iree_hal_pim_stats_counter_names[] = {
+    "calls",
+    "latency_ns",
+    "bytes_in",
+    "bytes_out",
+};
+static_assert(IREE_ARRAYSIZE(iree_hal_pim_stats_counter_names) ==
+                  IREE_HAL_PIM_STATS_COUNTER_COUNT,
+              "counter names must match the counter enum");
+
+void iree_hal_pim_stats_initialize(iree_hal_pim_stats_t* out_stats) {
+  for (int i = 0; i < IREE_HAL_PIM_OP_TYPE_COUNT; ++i) {
+    for (int j = 0; j < IREE_HAL_PIM_STATS_COUNTER_COUNT; ++j) {
+      iree_atomic_store_int64(&out_stats->counters[i][j], 0,
+                              iree_memory_order_relaxed);
+    }
+  }
+}
+
+void iree_hal_pim_stats_record_dispatch(iree_hal_pim_stats_t* stats,
+                                        int op_type, iree_time_t duration_ns,
+                                        uint64_t bytes_in, uint64_t bytes_out) {
+  if (op_type < 0 || op_type >= IREE_HAL_PIM_OP_TYPE_COUNT) op_type = 0;
+  iree_atomic_int64_t* counters = stats->counters[op_type];
+  iree_atomic_fetch_add_int64(&counters[IREE_HAL_PIM_STATS_COUNTER_CALLS], 1,
+                              iree_memory_order_relaxed);
+  iree_atomic_fetch_add_int64(&counters[IREE_HAL_PIM_STATS_COUNTER_LATENCY_NS],
+                              duration_ns, iree_memory_order_relaxed);
+  iree_atomic_fetch_add_int64(&counters[IREE_HAL_PIM_STATS_COUNTER_BYTES_IN],
+                              (int64_t)bytes_in, iree_memory_order_relaxed);
+  iree_atomic_fetch_add_int64(&counters[IREE_HAL_PIM_STATS_COUNTER_BYTES_OUT],
+                              (int64_t)bytes_out, iree_memory_order_relaxed);
+}
+
+// Parses an opcode given by name or number.
+static bool iree_hal_pim_stats_parse_op_type(iree_string_view_t value,
+                                             int* out_op_type) {
+  int32_t op_type = 0;
+  if (iree_string_view_atoi_int32(value, &op_type)) {
+    if (op_type < 1 || op_type >= IREE_HAL_PIM_OP_TYPE_COUNT) return false;
+    *out_op_type = (int)op_type;
+    return true;
+  }
+  for (int i = 1; i < IREE_HAL_PIM_OP_TYPE_COUNT; ++i) {
+    if (iree_string_view_equal(
+            value, iree_make_cstring_view(iree_hal_pim_op_type_name(i)))) {
+      *out_op_type = i;
+      return true;
+    }
+  }
+  return false;
+}
+
+iree_status_t iree_hal_pim_stats_query(iree_hal_pim_stats_t* stats,
+                                       iree_string_view_t key,
+                                       int64_t* out_value) {
+  *out_value = 0;
+  iree_string_view_t op_name = iree_string_view_empty();
+  iree_string_view_t counter_name = iree_string_view_empty();
+  int op_type = 0;
+  if (iree_string_view_split(key, '.', &op_name, &counter_name) != -1 &&
+      iree_hal_pim_stats_parse_op_type(op_name, &op_type)) {
+    for (int i = 0; i < IREE_HAL_PIM_STATS_COUNTER_COUNT; ++i) {
+      if (iree_string_view_equal(
+              counter_name,
+              iree_make_cstring_view(iree_hal_pim_stats_counter_names[i]))) {
+        *out_value = iree_atomic_load_int64(&stats->counters[op_type][i],
+                                            iree_memory_order_relaxed);
+        return iree_ok_status();
+      }
+    }
+  }
+  return iree_make_status(IREE_STATUS_NOT_FOUND,
+                          "unknown PIM statistic '%.*s'; expected "
+                          "'<op>.{calls,latency_ns,bytes_in,bytes_out}'",
+                          (int)key.size, key.data);
+}
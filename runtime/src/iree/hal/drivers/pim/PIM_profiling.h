@@ -0,0 +1,116 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_PIM_PIM_PROFILING_H_
+#define IREE_HAL_DRIVERS_PIM_PIM_PROFILING_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// PIM opcodes as encoded by GenOpCommand in the compiler PIM target.
+#define IREE_HAL_PIM_OP_TYPE_COUNT 19
+
+// Returns a human-readable name for PIM opcode |op_type|.
+const char* iree_hal_pim_op_type_name(int op_type);
+
+// Kinds of SDK operations captured while profiling.
+typedef enum iree_hal_pim_profile_event_kind_e {
+  // Host to device upload of a new allocation.
+  IREE_HAL_PIM_PROFILE_EVENT_UPLOAD = 0,
+  // Device to host readback of an allocation.
+  IREE_HAL_PIM_PROFILE_EVENT_DOWNLOAD,
+  // Execution of a PIM operation.
+  IREE_HAL_PIM_PROFILE_EVENT_DISPATCH,
+  // Collective between PIM modules, recorded once per collective by rank 0.
+  IREE_HAL_PIM_PROFILE_EVENT_COLLECTIVE,
+} iree_hal_pim_profile_event_kind_t;
+
+// A single SDK operation captured while profiling.
+typedef struct iree_hal_pim_profile_event_t {
+  iree_hal_pim_profile_event_kind_t kind;
+  // PIM opcode for dispatches and 0 otherwise.
+  int op_type;
+  // Start and end of the SDK call in iree_time_now() nanoseconds.
+  iree_time_t start_ns;
+  iree_time_t end_ns;
+  // Bytes moved from the host/operands into the device and back out.
+  uint64_t bytes_in;
+  uint64_t bytes_out;
+} iree_hal_pim_profile_event_t;
+
+// Starts capturing SDK operations. The SDK is process-wide and so is the
+// capture: operations from all PIM devices are recorded.
+//
+// The PIM SDK is a functional model without hardware counters so the captured
+// device time is the duration of the SDK call and no bank/channel utilization
+// is available. Devices of the `pim-sim` driver record modeled latencies
+// instead (see iree_hal_pim_sdk_dispatch).
+iree_status_t iree_hal_pim_profiling_begin(
+    const iree_hal_device_profiling_options_t* options);
+
+// Stops capturing and writes a JSON summary of the captured range to the
+// |file_path| provided to iree_hal_pim_profiling_begin (or stderr if none).
+iree_status_t iree_hal_pim_profiling_end(void);
+
+// Returns true if SDK operations should be captured.
+bool iree_hal_pim_profiling_is_enabled(void);
+
+// Records |event| if profiling is enabled and emits it as a device zone on the
+// PIM tracing timeline when tracing is compiled in.
+void iree_hal_pim_profiling_record(const iree_hal_pim_profile_event_t* event);
+
+//===----------------------------------------------------------------------===//
+// Dispatch statistics
+//===----------------------------------------------------------------------===//
+
+typedef enum iree_hal_pim_stats_counter_e {
+  IREE_HAL_PIM_STATS_COUNTER_CALLS = 0,
+  IREE_HAL_PIM_STATS_COUNTER_LATENCY_NS,
+  IREE_HAL_PIM_STATS_COUNTER_BYTES_IN,
+  IREE_HAL_PIM_STATS_COUNTER_BYTES_OUT,
+  IREE_HAL_PIM_STATS_COUNTER_COUNT,
+} iree_hal_pim_stats_counter_t;
+
+// Cumulative per-opcode dispatch counters of one PIM device. Updated by the
+// command buffers of the device from its queue threads and read by
+// iree_hal_device_query_i64 from any thread.
+typedef struct iree_hal_pim_stats_t {
+  // Indexed by opcode; unknown opcodes accumulate into 0.
+  iree_atomic_int64_t counters[IREE_HAL_PIM_OP_TYPE_COUNT]
+                              [IREE_HAL_PIM_STATS_COUNTER_COUNT];
+} iree_hal_pim_stats_t;
+
+// Initializes |out_stats| with all counters zeroed.
+void iree_hal_pim_stats_initialize(iree_hal_pim_stats_t* out_stats);
+
+// Accumulates a dispatch of |op_type| into |stats|. Counters are always
+// maintained, independent of profiling.
+void iree_hal_pim_stats_record_dispatch(iree_hal_pim_stats_t* stats,
+                                        int op_type, iree_time_t duration_ns,
+                                        uint64_t bytes_in, uint64_t bytes_out);
+
+// Queries a cumulative per-opcode counter of |stats|.
+// |key| has the form `<op>.<counter>` where `<op>` is either the opcode name
+// (`LayerNorm1`, `QKVGen`, ..., `LMHead`) or its numeric value and `<counter>`
+// is one of `calls`, `latency_ns`, `bytes_in` or `bytes_out`.
+//
+// Returns IREE_STATUS_NOT_FOUND if the key is not recognized.
+iree_status_t iree_hal_pim_stats_query(iree_hal_pim_stats_t* stats,
+                                       iree_string_view_t key,
+                                       int64_t* out_value);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_PIM_PIM_PROFILING_H_
@@ -0,0 +1,469 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/pim/PIM_queue.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+#include "iree/base/internal/atomic_slist.h"
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/threading.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/drivers/pim/PIM_buffer.h"
+#include "iree/hal/drivers/pim/PIM_host_worker.h"
+#include "iree/hal/drivers/pim/direct_command_buffer.h"
+#include "iree/hal/drivers/pim/native_semaphore.h"
+#include "iree/hal/utils/deferred_command_buffer.h"
+
+//===----------------------------------------------------------------------===//
+// iree_hal_pim_queue_submission_t
+//===----------------------------------------------------------------------===//
+
+typedef enum iree_hal_pim_queue_submission_type_e {
+  // Executes command buffers.
+  IREE_HAL_PIM_QUEUE_SUBMISSION_TYPE_EXECUTE = 0,
+  // Binds pooled device memory to a reserved buffer.
+  IREE_HAL_PIM_QUEUE_SUBMISSION_TYPE_ALLOCA,
+  // Returns the device memory of a buffer to the pool.
+  IREE_HAL_PIM_QUEUE_SUBMISSION_TYPE_DEALLOCA,
+} iree_hal_pim_queue_submission_type_t;
+
+// A single queue request. Allocated as one block with the semaphore and
+// command buffer lists stored inline after the struct.
+typedef struct iree_hal_pim_queue_submission_t {
+  // Intrusive link of the queue's pending submission list.
+  iree_atomic_slist_intrusive_ptr_t slist_next;
+
+  iree_hal_pim_queue_submission_type_t type;
+
+  // Retained semaphores the submission waits on before executing.
+  iree_hal_semaphore_list_t wait_semaphore_list;
+  // Retained semaphores signaled once all command buffers have executed.
+  iree_hal_semaphore_list_t signal_semaphore_list;
+
+  // Retained command buffers executed in order.
+  iree_host_size_t command_buffer_count;
+  iree_hal_command_buffer_t** command_buffers;
+
+  // Retained PIM buffer of ALLOCA and DEALLOCA submissions.
+  iree_hal_buffer_t* buffer;
+} iree_hal_pim_queue_submission_t;
+
+IREE_TYPED_ATOMIC_SLIST_WRAPPER(iree_hal_pim_queue_submission,
+                                iree_hal_pim_queue_submission_t,
+                                offsetof(iree_hal_pim_queue_submission_t,
+                                         slist_next));
+
+// Copies |source| into |target| using |*storage| for the list arrays and
+// retains each semaphore. Advances |*storage| past the consumed bytes.
+static void iree_hal_pim_queue_clone_semaphore_list(
+    const iree_hal_semaphore_list_t source, uint8_t** storage,
+    iree_hal_semaphore_list_t* target) {
+  target->count = source.count;
+  target->semaphores = (iree_hal_semaphore_t**)*storage;
+  *storage += source.count * sizeof(*target->semaphores);
+  target->payload_values = (uint64_t*)*storage;
+  *storage += source.count * sizeof(*target->payload_values);
+  for (iree_host_size_t i = 0; i < source.count; ++i) {
+    target->semaphores[i] = source.semaphores[i];
+    iree_hal_semaphore_retain(target->semaphores[i]);
+    target->payload_values[i] = source.payload_values[i];
+  }
+}
+
+static void iree_hal_pim_queue_release_semaphore_list(
+    iree_hal_semaphore_list_t* list) {
+  for (iree_host_size_t i = 0; i < list->count; ++i) {
+    iree_hal_semaphore_release(list->semaphores[i]);
+  }
+}
+
+static iree_status_t iree_hal_pim_queue_submission_allocate(
+    iree_hal_pim_queue_submission_type_t type,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_host_size_t command_buffer_count,
+    iree_hal_command_buffer_t* const* command_buffers,
+    iree_hal_buffer_t* buffer, iree_allocator_t host_allocator,
+    iree_hal_pim_queue_submission_t** out_submission) {
+  *out_submission = NULL;
+
+  const iree_host_size_t semaphore_entry_size =
+      sizeof(iree_hal_semaphore_t*) + sizeof(uint64_t);
+  iree_host_size_t total_size =
+      sizeof(iree_hal_pim_queue_submission_t) +
+      (wait_semaphore_list.count + signal_semaphore_list.count) *
+          semaphore_entry_size +
+      command_buffer_count * sizeof(iree_hal_command_buffer_t*);
+
+  iree_hal_pim_queue_submission_t* submission = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_malloc(host_allocator, total_size, (void**)&submission));
+  memset(submission, 0, sizeof(*submission));
+  submission->type = type;
+  submission->buffer = buffer;
+  iree_hal_buffer_retain(buffer);
+
+  // Pointers are stored first to keep everything naturally aligned.
+  uint8_t* storage = (uint8_t*)submission + sizeof(*submission);
+  submission->command_buffer_count = command_buffer_count;
+  submission->command_buffers = (iree_hal_command_buffer_t**)storage;
+  storage += command_buffer_count * sizeof(iree_hal_command_buffer_t*);
+  for (iree_host_size_t i = 0; i < command_buffer_count; ++i) {
+    submission->command_buffers[i] = command_buffers[i];
+    iree_hal_command_buffer_retain(command_buffers[i]);
+  }
+  iree_hal_pim_queue_clone_semaphore_list(wait_semaphore_list, &storage,
+                                          &submission->wait_semaphore_list);
+  iree_hal_pim_queue_clone_semaphore_list(signal_semaphore_list, &storage,
+                                          &submission->signal_semaphore_list);
+
+  *out_submission = submission;
+  return iree_ok_status();
+}
+
+static void iree_hal_pim_queue_submission_free(
+    iree_hal_pim_queue_submission_t* submission,
+    iree_allocator_t host_allocator) {
+  for (iree_host_size_t i = 0; i < submission->command_buffer_count; ++i) {
+    iree_hal_command_buffer_release(submission->command_buffers[i]);
+  }
+  iree_hal_pim_queue_release_semaphore_list(&submission->wait_semaphore_list);
+  iree_hal_pim_queue_release_semaphore_list(&submission->signal_semaphore_list);
+  iree_hal_buffer_release(submission->buffer);
+  iree_allocator_free(host_allocator, submission);
+}
+
+// Executes |command_buffer| on the calling thread. Deferred command buffers are
+// first replayed into |replay_command_buffer| so that the whole recorded
+// sequence is issued to the PIM SDK as a single batch. Submitted command
+// buffers are never created with a binding capacity (see
+// iree_hal_pim_device_create_command_buffer) so they replay without a binding
+// table.
+static iree_status_t iree_hal_pim_queue_execute_command_buffer(
+    iree_hal_command_buffer_t* replay_command_buffer,
+    iree_hal_channel_t* sync_channel, iree_hal_pim_host_worker_t* host_worker,
+    iree_hal_command_buffer_t* command_buffer) {
+  if (iree_hal_deferred_command_buffer_isa(command_buffer)) {
+    IREE_RETURN_IF_ERROR(iree_hal_deferred_command_buffer_apply(
+        command_buffer, replay_command_buffer,
+        iree_hal_buffer_binding_table_empty()));
+    return iree_hal_pim_direct_command_buffer_execute(
+        replay_command_buffer, sync_channel, host_worker);
+  }
+  return iree_hal_pim_direct_command_buffer_execute(
+      command_buffer, sync_channel, host_worker);
+}
+
+// Executes |submission| on the calling thread and signals its semaphores.
+static void iree_hal_pim_queue_submission_process(
+    iree_hal_command_buffer_t* replay_command_buffer,
+    iree_hal_channel_t* sync_channel, iree_hal_pim_host_worker_t* host_worker,
+    iree_hal_pim_queue_submission_t* submission) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Waits on semaphores of any PIM device (the common case when layers are
+  // chained across devices) block only on the awaited semaphores. Foreign
+  // semaphores use the generic path.
+  iree_status_t status = iree_ok_status();
+  if (iree_hal_pim_native_semaphore_list_isa(
+          submission->wait_semaphore_list)) {
+    status = iree_hal_pim_native_semaphore_multi_wait(
+        IREE_HAL_WAIT_MODE_ALL, submission->wait_semaphore_list,
+        iree_infinite_timeout());
+  } else {
+    status = iree_hal_semaphore_list_wait(submission->wait_semaphore_list,
+                                          iree_infinite_timeout());
+  }
+
+  if (iree_status_is_ok(status)) {
+    switch (submission->type) {
+      case IREE_HAL_PIM_QUEUE_SUBMISSION_TYPE_EXECUTE:
+        for (iree_host_size_t i = 0;
+             i < submission->command_buffer_count && iree_status_is_ok(status);
+             ++i) {
+          status = iree_hal_pim_queue_execute_command_buffer(
+              replay_command_buffer, sync_channel, host_worker,
+              submission->command_buffers[i]);
+        }
+        break;
+      case IREE_HAL_PIM_QUEUE_SUBMISSION_TYPE_ALLOCA:
+        // Memory released by deallocas earlier on the timeline is reused
+        // here without any host round trip.
+        iree_hal_pim_buffer_bind_pooled_storage(submission->buffer);
+        break;
+      case IREE_HAL_PIM_QUEUE_SUBMISSION_TYPE_DEALLOCA:
+        iree_hal_pim_buffer_release_storage(submission->buffer);
+        break;
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_semaphore_list_signal(submission->signal_semaphore_list);
+  }
+  if (!iree_status_is_ok(status)) {
+    // Takes ownership of |status|.
+    iree_hal_semaphore_list_fail(submission->signal_semaphore_list, status);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_pim_queue_t
+//===----------------------------------------------------------------------===//
+
+struct iree_hal_pim_queue_t {
+  iree_allocator_t host_allocator;
+
+  // Thread retiring submissions in FIFO order.
+  iree_thread_t* thread;
+
+  // PIM command buffer deferred command buffers are replayed into. Only used
+  // from the queue thread.
+  iree_hal_command_buffer_t* replay_command_buffer;
+
+  // Optional channel used by dispatches to synchronize with the other PIM
+  // modules sharing a split executable.
+  iree_hal_channel_t* sync_channel;
+
+  // Optional worker running host fallback dispatches alongside the PIM
+  // dispatches of a submission. Only used from the queue thread.
+  iree_hal_pim_host_worker_t* host_worker;
+
+  // Posted whenever a submission is enqueued or exit is requested.
+  iree_notification_t pending_notification;
+
+  // Submissions pushed by any thread and flushed by the queue thread. The
+  // queue thread only ever flushes the whole list so entries are freed as
+  // soon as they retire.
+  iree_hal_pim_queue_submission_slist_t pending_submissions;
+
+  // Set once by destroy after the last submission was enqueued.
+  iree_atomic_int32_t exit_requested;
+};
+
+static int iree_hal_pim_queue_thread_main(void* entry_arg) {
+  iree_hal_pim_queue_t* queue = (iree_hal_pim_queue_t*)entry_arg;
+  while (true) {
+    // The wait is prepared before checking for work so that a submission
+    // enqueued after the flush always wakes the thread.
+    iree_wait_token_t wait_token =
+        iree_notification_prepare_wait(&queue->pending_notification);
+
+    // Entries pushed by one thread are flushed in the order it pushed them.
+    // Submissions racing from different threads have no order of their own.
+    iree_hal_pim_queue_submission_t* submission = NULL;
+    if (!iree_hal_pim_queue_submission_slist_flush(
+            &queue->pending_submissions,
+            IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_FIFO, &submission,
+            /*out_tail=*/NULL)) {
+      // Pending submissions are always drained before honoring exit requests
+      // so that no signal semaphore is left dangling.
+      if (iree_atomic_load_int32(&queue->exit_requested,
+                                 iree_memory_order_acquire)) {
+        iree_notification_cancel_wait(&queue->pending_notification);
+        break;
+      }
+      iree_notification_commit_wait(&queue->pending_notification, wait_token,
+                                    IREE_DURATION_ZERO,
+                                    IREE_TIME_INFINITE_FUTURE);
+      continue;
+    }
+    iree_notification_cancel_wait(&queue->pending_notification);
+
+    while (submission) {
+      iree_hal_pim_queue_submission_t* next =
+          iree_hal_pim_queue_submission_slist_get_next(submission);
+      iree_hal_pim_queue_submission_process(queue->replay_command_buffer,
+                                            queue->sync_channel,
+                                            queue->host_worker, submission);
+      iree_hal_pim_queue_submission_free(submission, queue->host_allocator);
+      submission = next;
+    }
+  }
+  return 0;
+}
+
+// Pushes |submission| to the pending list and wakes the queue thread. The
+// queue takes ownership of the submission.
+static void iree_hal_pim_queue_enqueue(
+    iree_hal_pim_queue_t* queue, iree_hal_pim_queue_submission_t* submission) {
+  iree_hal_pim_queue_submission_slist_push(&queue->pending_submissions,
+                                           submission);
+  iree_notification_post(&queue->pending_notification, IREE_ALL_WAITERS);
+}
+
+void iree_hal_pim_queue_options_initialize(
+    iree_hal_pim_queue_options_t* out_options) {
+  memset(out_options, 0, sizeof(*out_options));
+  out_options->overlap_host_dispatches = false;
+  out_options->priority_class = IREE_THREAD_PRIORITY_CLASS_NORMAL;
+  iree_thread_affinity_set_any(&out_options->affinity);
+}
+
+iree_status_t iree_hal_pim_queue_create(
+    iree_hal_device_t* device, iree_string_view_t identifier,
+    iree_arena_block_pool_t* block_pool, iree_hal_channel_t* sync_channel,
+    const iree_hal_pim_queue_options_t* options,
+    iree_allocator_t host_allocator, iree_hal_pim_queue_t** out_queue) {
+  IREE_ASSERT_ARGUMENT(device);
+  IREE_ASSERT_ARGUMENT(options);
+  IREE_ASSERT_ARGUMENT(out_queue);
+  *out_queue = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_pim_queue_t* queue = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*queue),
+                                (void**)&queue));
+  memset(queue, 0, sizeof(*queue));
+  queue->host_allocator = host_allocator;
+  queue->sync_channel = sync_channel;
+  iree_hal_channel_retain(queue->sync_channel);
+  iree_notification_initialize(&queue->pending_notification);
+  iree_hal_pim_queue_submission_slist_initialize(&queue->pending_submissions);
+  iree_atomic_store_int32(&queue->exit_requested, 0,
+                          iree_memory_order_relaxed);
+
+  // Replays are always one-shot so that buffers referenced by a submission
+  // are released as soon as it retires.
+  iree_status_t status = iree_hal_pim_direct_command_buffer_allocate(
+      device, host_allocator, iree_hal_device_allocator(device), block_pool,
+      options->simulation, options->stats,
+      IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT, IREE_HAL_COMMAND_CATEGORY_ANY,
+      IREE_HAL_QUEUE_AFFINITY_ANY, /*binding_capacity=*/0,
+      &queue->replay_command_buffer);
+
+  if (iree_status_is_ok(status) && options->overlap_host_dispatches) {
+    char worker_name[48];
+    snprintf(worker_name, sizeof(worker_name), "%.*s-host",
+             (int)identifier.size, identifier.data);
+    status = iree_hal_pim_host_worker_create(
+        iree_make_cstring_view(worker_name), host_allocator,
+        &queue->host_worker);
+  }
+
+  if (iree_status_is_ok(status)) {
+    iree_thread_create_params_t params;
+    memset(&params, 0, sizeof(params));
+    params.name = identifier;
+    params.priority_class = options->priority_class;
+    params.initial_affinity = options->affinity;
+    status = iree_thread_create(iree_hal_pim_queue_thread_main, queue, params,
+                                host_allocator, &queue->thread);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_queue = queue;
+  } else {
+    iree_hal_pim_queue_destroy(queue);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+void iree_hal_pim_queue_destroy(iree_hal_pim_queue_t* queue) {
+  if (!queue) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  if (queue->thread) {
+    iree_atomic_store_int32(&queue->exit_requested, 1,
+                            iree_memory_order_release);
+    iree_notification_post(&queue->pending_notification, IREE_ALL_WAITERS);
+
+    // Joins the thread.
+    iree_thread_release(queue->thread);
+  }
+  iree_hal_pim_host_worker_destroy(queue->host_worker);
+  iree_hal_command_buffer_release(queue->replay_command_buffer);
+  iree_hal_channel_release(queue->sync_channel);
+
+  iree_hal_pim_queue_submission_slist_deinitialize(&queue->pending_submissions);
+  iree_notification_deinitialize(&queue->pending_notification);
+  iree_allocator_free(queue->host_allocator, queue);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+iree_status_t iree_hal_pim_queue_submit(
+    iree_hal_pim_queue_t* queue,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_host_size_t command_buffer_count,
+    iree_hal_command_buffer_t* const* command_buffers) {
+  IREE_ASSERT_ARGUMENT(queue);
+  for (iree_host_size_t i = 0; i < command_buffer_count; ++i) {
+    if (!iree_hal_deferred_command_buffer_isa(command_buffers[i]) &&
+        !iree_hal_pim_direct_command_buffer_isa(command_buffers[i])) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "command buffer %zu was not created by a PIM "
+                              "device",
+                              i);
+    }
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_pim_queue_submission_t* submission = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_pim_queue_submission_allocate(
+              IREE_HAL_PIM_QUEUE_SUBMISSION_TYPE_EXECUTE, wait_semaphore_list,
+              signal_semaphore_list, command_buffer_count, command_buffers,
+              /*buffer=*/NULL, queue->host_allocator, &submission));
+  iree_hal_pim_queue_enqueue(queue, submission);
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+// Enqueues a buffer operation of |type| on |buffer|.
+static iree_status_t iree_hal_pim_queue_submit_buffer_op(
+    iree_hal_pim_queue_t* queue, iree_hal_pim_queue_submission_type_t type,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_buffer_t* buffer) {
+  IREE_ASSERT_ARGUMENT(queue);
+  IREE_ASSERT_ARGUMENT(buffer);
+  if (!iree_hal_pim_buffer_isa(buffer)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "buffer was not allocated from a PIM device");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_pim_queue_submission_t* submission = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_pim_queue_submission_allocate(
+              type, wait_semaphore_list, signal_semaphore_list,
+              /*command_buffer_count=*/0, /*command_buffers=*/NULL, buffer,
+              queue->host_allocator, &submission));
+  iree_hal_pim_queue_enqueue(queue, submission);
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_pim_queue_submit_alloca(
+    iree_hal_pim_queue_t* queue,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_buffer_t* buffer) {
+  return iree_hal_pim_queue_submit_buffer_op(
+      queue, IREE_HAL_PIM_QUEUE_SUBMISSION_TYPE_ALLOCA, wait_semaphore_list,
+      signal_semaphore_list, buffer);
+}
+
+iree_status_t iree_hal_pim_queue_submit_dealloca(
+    iree_hal_pim_queue_t* queue,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_buffer_t* buffer) {
+  return iree_hal_pim_queue_submit_buffer_op(
+      queue, IREE_HAL_PIM_QUEUE_SUBMISSION_TYPE_DEALLOCA, wait_semaphore_list,
+      signal_semaphore_list, buffer);
+}
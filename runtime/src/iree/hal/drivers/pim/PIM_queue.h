@@ -0,0 +1,112 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_PIM_PIM_QUEUE_H_
+#define IREE_HAL_DRIVERS_PIM_PIM_QUEUE_H_
+
+#include "iree/base/api.h"
+#include "iree/base/internal/arena.h"
+#include "iree/base/internal/threading.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/pim/PIM_profiling.h"
+#include "iree/hal/drivers/pim/util/pim_sim_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// An in-order PIM submission queue serviced by a dedicated thread.
+//
+// Submissions are retired in FIFO order: the queue thread waits for each
+// submission's wait semaphores, replays its command buffers against the PIM
+// SDK, and then signals (or fails) its signal semaphores. The submitting
+// thread returns as soon as the submission is enqueued so that the host can
+// stage the next batch while the device is busy with the current one.
+// Enqueuing is lock-free and never waits on the queue thread.
+typedef struct iree_hal_pim_queue_t iree_hal_pim_queue_t;
+
+// Options controlling a PIM queue and its submission thread.
+typedef struct iree_hal_pim_queue_options_t {
+  // Launches a host worker thread that host fallback dispatches run on while
+  // independent PIM dispatches of the same submission execute on the queue
+  // thread.
+  bool overlap_host_dispatches;
+  // Priority class of the submission thread.
+  iree_thread_priority_class_t priority_class;
+  // Processor the submission thread is pinned to when specified so that SDK
+  // calls don't migrate across cores shared with the serving threads.
+  iree_thread_affinity_t affinity;
+  // Latency model of the device dispatches are profiled with or NULL if they
+  // are measured. Must outlive the queue.
+  const iree_hal_pim_sim_params_t* simulation;
+  // Dispatch counters of the device the queue accumulates into or NULL if
+  // dispatches are not counted. Must outlive the queue.
+  iree_hal_pim_stats_t* stats;
+} iree_hal_pim_queue_options_t;
+
+// Initializes |out_options| to their defaults: no host worker and a thread of
+// normal priority placed by the system.
+void iree_hal_pim_queue_options_initialize(
+    iree_hal_pim_queue_options_t* out_options);
+
+// Creates a queue and launches its submission thread.
+// |device| is unretained and must outlive the queue. It is used to allocate
+// the PIM command buffer that deferred command buffers are replayed into.
+// |block_pool| must also outlive the queue.
+// |sync_channel| is an optional retained channel connecting this queue with
+// the other PIM modules that executables split across devices synchronize
+// with between instructions. When omitted those sync points are skipped.
+iree_status_t iree_hal_pim_queue_create(
+    iree_hal_device_t* device, iree_string_view_t identifier,
+    iree_arena_block_pool_t* block_pool, iree_hal_channel_t* sync_channel,
+    const iree_hal_pim_queue_options_t* options,
+    iree_allocator_t host_allocator, iree_hal_pim_queue_t** out_queue);
+
+// Drains all pending submissions, joins the submission thread, and frees the
+// queue.
+void iree_hal_pim_queue_destroy(iree_hal_pim_queue_t* queue);
+
+// Enqueues |command_buffers| for execution once |wait_semaphore_list| is
+// satisfied and signals |signal_semaphore_list| upon completion.
+// Command buffers may either be deferred command buffers, which are replayed
+// into a single batched PIM command stream on the queue thread, or PIM
+// command buffers recorded directly.
+// All semaphores and command buffers are retained until the submission
+// retires. Execution failures are propagated to the signal semaphores.
+// Without command buffers the submission only orders the signals after the
+// waits.
+iree_status_t iree_hal_pim_queue_submit(
+    iree_hal_pim_queue_t* queue,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_host_size_t command_buffer_count,
+    iree_hal_command_buffer_t* const* command_buffers);
+
+// Enqueues binding pooled device memory to the reserved PIM |buffer| once
+// |wait_semaphore_list| is satisfied and signals |signal_semaphore_list|
+// afterwards. Allocations released by deallocas that retired earlier on the
+// queue are reused directly; the buffer is otherwise materialized lazily.
+iree_status_t iree_hal_pim_queue_submit_alloca(
+    iree_hal_pim_queue_t* queue,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_buffer_t* buffer);
+
+// Enqueues returning the device memory of the PIM |buffer| to the allocator
+// pool once |wait_semaphore_list| is satisfied and signals
+// |signal_semaphore_list| afterwards. The buffer object itself remains valid
+// until released but its contents are undefined.
+iree_status_t iree_hal_pim_queue_submit_dealloca(
+    iree_hal_pim_queue_t* queue,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_buffer_t* buffer);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_PIM_PIM_QUEUE_H_
@@ -0,0 +1,381 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/pim/PIM_sdk.h"
+
+#include <cmath>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "iree/base/internal/math.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/drivers/pim/PIM_profiling.h"
+
+// for pim SDK
+#include "pim.h"
+
+// Optional SDK entry point used to return device memory. The dummy SDK does
+// not export it in which case device memory is never released.
+extern "C" void PIM_SDK_free_buffer(int PiM_addr) __attribute__((weak));
+
+// Optional SDK entry points storing tensors of the given element type (see
+// iree_hal_pim_element_type_t). If the SDK doesn't export them all data is
+// kept in f32 and converted on the host.
+extern "C" int PIM_SDK_alloc_typed_buffer(int element_type, int size,
+                                          const void* data)
+    __attribute__((weak));
+extern "C" void get_PIM_SDK_typed_buffer(int PiM_addr, int element_type,
+                                         void* data) __attribute__((weak));
+extern "C" int PIM_dispatch_typed_code(
+    std::vector<int> PiM_addr_vec, int op_type, int element_type,
+    std::vector<std::vector<int>> PiM_dim_inf, std::vector<int>& output_shape)
+    __attribute__((weak));
+
+// Optional SDK entry point taking its arguments as spans. |shapes| holds
+// |operand_count| shapes of |shape_stride| ints each: the rank followed by
+// the dims. |out_shape| receives the result shape in the same layout with at
+// most |shape_stride| - 1 dims.
+// Unlike PIM_dispatch_code it accepts any element type.
+extern "C" int PIM_dispatch_span_code(const int32_t* addrs,
+                                      int32_t operand_count, int32_t op_type,
+                                      int32_t element_type,
+                                      const int32_t* shapes,
+                                      int32_t shape_stride, int32_t* out_shape)
+    __attribute__((weak));
+
+static bool iree_hal_pim_sdk_has_typed_transfers() {
+  return PIM_SDK_alloc_typed_buffer && get_PIM_SDK_typed_buffer &&
+         PIM_dispatch_typed_code;
+}
+
+// Guards all calls into the SDK.
+static iree_slim_mutex_t* iree_hal_pim_sdk_mutex() {
+  static iree_slim_mutex_t mutex;
+  static bool initialized = (iree_slim_mutex_initialize(&mutex), true);
+  (void)initialized;
+  return &mutex;
+}
+
+// Returns the end of a transfer of |bytes| started at |start_ns| that the SDK
+// completed at |end_ns|, as modeled with |simulation| if not NULL. Only called
+// when profiling.
+static iree_time_t iree_hal_pim_sdk_transfer_end_ns(
+    const iree_hal_pim_sim_params_t* simulation, iree_time_t start_ns,
+    iree_time_t end_ns, uint64_t bytes) {
+  if (!simulation) return end_ns;
+  return start_ns + iree_hal_pim_sim_transfer_ns(simulation, bytes);
+}
+
+// Returns the number of elements in a tensor of |shape|.
+static uint64_t iree_hal_pim_sdk_element_count(
+    const iree_hal_pim_shape_t* shape) {
+  if (shape->rank <= 0) return 0;
+  uint64_t element_count = 1;
+  for (int32_t i = 0; i < shape->rank; ++i) {
+    element_count *= (uint64_t)shape->dims[i];
+  }
+  return element_count;
+}
+
+int iree_hal_pim_sdk_alloc_buffer(const iree_hal_pim_sim_params_t* simulation,
+                                  int element_count, const float* data) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, element_count);
+  const bool profiling = iree_hal_pim_profiling_is_enabled();
+  iree_slim_mutex_lock(iree_hal_pim_sdk_mutex());
+  iree_time_t start_ns = profiling ? iree_time_now() : 0;
+  int addr = PIM_SDK_alloc_buffer(element_count, (float*)data);
+  iree_time_t end_ns = profiling ? iree_time_now() : 0;
+  iree_slim_mutex_unlock(iree_hal_pim_sdk_mutex());
+  if (profiling) {
+    iree_hal_pim_profile_event_t event = {};
+    event.kind = IREE_HAL_PIM_PROFILE_EVENT_UPLOAD;
+    event.start_ns = start_ns;
+    event.bytes_in = (uint64_t)element_count * sizeof(float);
+    event.end_ns = iree_hal_pim_sdk_transfer_end_ns(simulation, start_ns,
+                                                    end_ns, event.bytes_in);
+    iree_hal_pim_profiling_record(&event);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return addr;
+}
+
+void iree_hal_pim_sdk_read_buffer(const iree_hal_pim_sim_params_t* simulation,
+                                  int addr, int element_count, float* data) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, element_count);
+  const bool profiling = iree_hal_pim_profiling_is_enabled();
+  iree_slim_mutex_lock(iree_hal_pim_sdk_mutex());
+  iree_time_t start_ns = profiling ? iree_time_now() : 0;
+  get_PIM_SDK_buffer(addr, data);
+  iree_time_t end_ns = profiling ? iree_time_now() : 0;
+  iree_slim_mutex_unlock(iree_hal_pim_sdk_mutex());
+  if (profiling) {
+    iree_hal_pim_profile_event_t event = {};
+    event.kind = IREE_HAL_PIM_PROFILE_EVENT_DOWNLOAD;
+    event.start_ns = start_ns;
+    event.bytes_out = (uint64_t)element_count * sizeof(float);
+    event.end_ns = iree_hal_pim_sdk_transfer_end_ns(simulation, start_ns,
+                                                    end_ns, event.bytes_out);
+    iree_hal_pim_profiling_record(&event);
+  }
+  IREE_TRACE_ZONE_END(z0);
+}
+
+iree_host_size_t iree_hal_pim_element_type_byte_size(
+    iree_hal_pim_element_type_t element_type) {
+  switch (element_type) {
+    case IREE_HAL_PIM_ELEMENT_TYPE_F16:
+    case IREE_HAL_PIM_ELEMENT_TYPE_BF16:
+      return 2;
+    case IREE_HAL_PIM_ELEMENT_TYPE_I8:
+      return 1;
+    default:
+      return sizeof(float);
+  }
+}
+
+// Widens |element_count| elements of |element_type| at |data| to f32.
+static void iree_hal_pim_widen_to_f32(iree_hal_pim_element_type_t element_type,
+                                      int element_count, const void* data,
+                                      float* result) {
+  for (int i = 0; i < element_count; ++i) {
+    switch (element_type) {
+      case IREE_HAL_PIM_ELEMENT_TYPE_F16:
+        result[i] = iree_math_f16_to_f32(((const uint16_t*)data)[i]);
+        break;
+      case IREE_HAL_PIM_ELEMENT_TYPE_BF16: {
+        uint32_t bits = (uint32_t)((const uint16_t*)data)[i] << 16;
+        memcpy(&result[i], &bits, sizeof(bits));
+        break;
+      }
+      case IREE_HAL_PIM_ELEMENT_TYPE_I8:
+        result[i] = (float)((const int8_t*)data)[i];
+        break;
+      default:
+        result[i] = ((const float*)data)[i];
+        break;
+    }
+  }
+}
+
+// Narrows |element_count| f32 values to |element_type| rounding to nearest.
+static void iree_hal_pim_narrow_from_f32(
+    iree_hal_pim_element_type_t element_type, int element_count,
+    const float* data, void* result) {
+  for (int i = 0; i < element_count; ++i) {
+    switch (element_type) {
+      case IREE_HAL_PIM_ELEMENT_TYPE_F16:
+        ((uint16_t*)result)[i] = iree_math_f32_to_f16(data[i]);
+        break;
+      case IREE_HAL_PIM_ELEMENT_TYPE_BF16: {
+        uint32_t bits = 0;
+        memcpy(&bits, &data[i], sizeof(bits));
+        if ((bits & 0x7FFFFFFFu) > 0x7F800000u) {
+          bits |= 0x00400000u;  // keep NaNs quiet after truncation
+        } else {
+          bits += 0x7FFFu + ((bits >> 16) & 1u);
+        }
+        ((uint16_t*)result)[i] = (uint16_t)(bits >> 16);
+        break;
+      }
+      case IREE_HAL_PIM_ELEMENT_TYPE_I8: {
+        float value = nearbyintf(data[i]);
+        value = value < -128.0f ? -128.0f : value > 127.0f ? 127.0f : value;
+        ((int8_t*)result)[i] = (int8_t)value;
+        break;
+      }
+      default:
+        ((float*)result)[i] = data[i];
+        break;
+    }
+  }
+}
+
+int iree_hal_pim_sdk_alloc_typed_buffer(
+    const iree_hal_pim_sim_params_t* simulation,
+    iree_hal_pim_element_type_t element_type, int element_count,
+    const void* data) {
+  if (element_type == IREE_HAL_PIM_ELEMENT_TYPE_F32) {
+    return iree_hal_pim_sdk_alloc_buffer(simulation, element_count,
+                                         (const float*)data);
+  }
+  if (!iree_hal_pim_sdk_has_typed_transfers()) {
+    std::vector<float> widened(element_count);
+    iree_hal_pim_widen_to_f32(element_type, element_count, data,
+                              widened.data());
+    return iree_hal_pim_sdk_alloc_buffer(simulation, element_count,
+                                         widened.data());
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, element_count);
+  const bool profiling = iree_hal_pim_profiling_is_enabled();
+  iree_slim_mutex_lock(iree_hal_pim_sdk_mutex());
+  iree_time_t start_ns = profiling ? iree_time_now() : 0;
+  int addr = PIM_SDK_alloc_typed_buffer((int)element_type, element_count, data);
+  iree_time_t end_ns = profiling ? iree_time_now() : 0;
+  iree_slim_mutex_unlock(iree_hal_pim_sdk_mutex());
+  if (profiling) {
+    iree_hal_pim_profile_event_t event = {};
+    event.kind = IREE_HAL_PIM_PROFILE_EVENT_UPLOAD;
+    event.start_ns = start_ns;
+    event.bytes_in = (uint64_t)element_count *
+                     iree_hal_pim_element_type_byte_size(element_type);
+    event.end_ns = iree_hal_pim_sdk_transfer_end_ns(simulation, start_ns,
+                                                    end_ns, event.bytes_in);
+    iree_hal_pim_profiling_record(&event);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return addr;
+}
+
+void iree_hal_pim_sdk_read_typed_buffer(
+    const iree_hal_pim_sim_params_t* simulation, int addr,
+    iree_hal_pim_element_type_t element_type, int element_count, void* data) {
+  if (element_type == IREE_HAL_PIM_ELEMENT_TYPE_F32) {
+    iree_hal_pim_sdk_read_buffer(simulation, addr, element_count, (float*)data);
+    return;
+  }
+  if (!iree_hal_pim_sdk_has_typed_transfers()) {
+    std::vector<float> contents(element_count);
+    iree_hal_pim_sdk_read_buffer(simulation, addr, element_count,
+                                 contents.data());
+    iree_hal_pim_narrow_from_f32(element_type, element_count, contents.data(),
+                                 data);
+    return;
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, element_count);
+  const bool profiling = iree_hal_pim_profiling_is_enabled();
+  iree_slim_mutex_lock(iree_hal_pim_sdk_mutex());
+  iree_time_t start_ns = profiling ? iree_time_now() : 0;
+  get_PIM_SDK_typed_buffer(addr, (int)element_type, data);
+  iree_time_t end_ns = profiling ? iree_time_now() : 0;
+  iree_slim_mutex_unlock(iree_hal_pim_sdk_mutex());
+  if (profiling) {
+    iree_hal_pim_profile_event_t event = {};
+    event.kind = IREE_HAL_PIM_PROFILE_EVENT_DOWNLOAD;
+    event.start_ns = start_ns;
+    event.bytes_out = (uint64_t)element_count *
+                      iree_hal_pim_element_type_byte_size(element_type);
+    event.end_ns = iree_hal_pim_sdk_transfer_end_ns(simulation, start_ns,
+                                                    end_ns, event.bytes_out);
+    iree_hal_pim_profiling_record(&event);
+  }
+  IREE_TRACE_ZONE_END(z0);
+}
+
+bool iree_hal_pim_sdk_can_free_buffer() { return PIM_SDK_free_buffer != NULL; }
+
+void iree_hal_pim_sdk_free_buffer(int addr) {
+  if (!PIM_SDK_free_buffer) return;
+  iree_slim_mutex_lock(iree_hal_pim_sdk_mutex());
+  PIM_SDK_free_buffer(addr);
+  iree_slim_mutex_unlock(iree_hal_pim_sdk_mutex());
+}
+
+// Calls the std::vector SDK entry points. They take their arguments by value
+// so the vectors are built from the spans for each call and moved into it
+// instead of being copied again. Must be called with the SDK mutex held.
+static int iree_hal_pim_sdk_dispatch_legacy(
+    int op_type, iree_hal_pim_element_type_t element_type, bool is_typed,
+    iree_host_size_t operand_count, const int32_t* addrs,
+    const iree_hal_pim_shape_t* shapes, iree_hal_pim_shape_t* out_shape) {
+  std::vector<int> legacy_addrs(addrs, addrs + operand_count);
+  std::vector<std::vector<int>> legacy_dims;
+  legacy_dims.reserve(operand_count);
+  for (iree_host_size_t i = 0; i < operand_count; ++i) {
+    legacy_dims.emplace_back(shapes[i].dims, shapes[i].dims + shapes[i].rank);
+  }
+  std::vector<int> legacy_out_shape;
+  int addr = is_typed
+                 ? PIM_dispatch_typed_code(std::move(legacy_addrs), op_type,
+                                           (int)element_type,
+                                           std::move(legacy_dims),
+                                           legacy_out_shape)
+                 : PIM_dispatch_code(std::move(legacy_addrs), op_type,
+                                     std::move(legacy_dims), legacy_out_shape);
+  out_shape->rank = (int32_t)iree_min(legacy_out_shape.size(),
+                                      (size_t)IREE_HAL_PIM_MAX_RANK);
+  for (int32_t i = 0; i < out_shape->rank; ++i) {
+    out_shape->dims[i] = legacy_out_shape[i];
+  }
+  return addr;
+}
+
+int iree_hal_pim_sdk_dispatch(const iree_hal_pim_sim_params_t* simulation,
+                              iree_hal_pim_stats_t* stats, int op_type,
+                              iree_hal_pim_element_type_t element_type,
+                              iree_host_size_t operand_count,
+                              const int32_t* addrs,
+                              const iree_hal_pim_shape_t* shapes,
+                              iree_hal_pim_shape_t* out_shape) {
+  // Operands of f32-only SDKs were widened on upload.
+  const bool is_typed = element_type != IREE_HAL_PIM_ELEMENT_TYPE_F32 &&
+                        iree_hal_pim_sdk_has_typed_transfers();
+  const iree_host_size_t element_size =
+      is_typed ? iree_hal_pim_element_type_byte_size(element_type)
+               : sizeof(float);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, op_type);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, iree_hal_pim_op_type_name(op_type));
+  out_shape->rank = 0;
+  iree_slim_mutex_lock(iree_hal_pim_sdk_mutex());
+  iree_time_t start_ns = iree_time_now();
+  int addr = 0;
+  if (PIM_dispatch_span_code) {
+    addr = PIM_dispatch_span_code(
+        addrs, (int32_t)operand_count, op_type,
+        (int32_t)(is_typed ? element_type : IREE_HAL_PIM_ELEMENT_TYPE_F32),
+        &shapes[0].rank, sizeof(iree_hal_pim_shape_t) / sizeof(int32_t),
+        &out_shape->rank);
+    out_shape->rank = iree_min(out_shape->rank, IREE_HAL_PIM_MAX_RANK);
+  } else {
+    addr = iree_hal_pim_sdk_dispatch_legacy(op_type, element_type, is_typed,
+                                            operand_count, addrs, shapes,
+                                            out_shape);
+  }
+  iree_time_t end_ns = iree_time_now();
+  iree_slim_mutex_unlock(iree_hal_pim_sdk_mutex());
+
+  // The last operand is the result binding and is not read.
+  uint64_t bytes_in = 0;
+  for (iree_host_size_t i = 0; i + 1 < operand_count; ++i) {
+    bytes_in += iree_hal_pim_sdk_element_count(&shapes[i]) * element_size;
+  }
+  uint64_t bytes_out = iree_hal_pim_sdk_element_count(out_shape) * element_size;
+  if (simulation) {
+    uint64_t lhs_element_count = 0;
+    uint64_t lhs_inner_dim = 0;
+    if (operand_count > 0 && shapes[0].rank > 0) {
+      lhs_element_count = iree_hal_pim_sdk_element_count(&shapes[0]);
+      lhs_inner_dim = (uint64_t)shapes[0].dims[shapes[0].rank - 1];
+    }
+    uint64_t macs = iree_hal_pim_sim_op_macs(
+        op_type, lhs_element_count, lhs_inner_dim,
+        iree_hal_pim_sdk_element_count(out_shape));
+    end_ns = start_ns + iree_hal_pim_sim_dispatch_ns(simulation, macs,
+                                                     bytes_in, bytes_out);
+  }
+  if (stats) {
+    iree_hal_pim_stats_record_dispatch(stats, op_type, end_ns - start_ns,
+                                       bytes_in, bytes_out);
+  }
+  if (iree_hal_pim_profiling_is_enabled()) {
+    iree_hal_pim_profile_event_t event = {};
+    event.kind = IREE_HAL_PIM_PROFILE_EVENT_DISPATCH;
+    event.op_type = op_type;
+    event.start_ns = start_ns;
+    event.end_ns = end_ns;
+    event.bytes_in = bytes_in;
+    event.bytes_out = bytes_out;
+    iree_hal_pim_profiling_record(&event);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return addr;
+}
@@ -0,0 +1,92 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_PIM_PIM_SDK_H_
+#define IREE_HAL_DRIVERS_PIM_PIM_SDK_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/drivers/pim/PIM_profiling.h"
+#include "iree/hal/drivers/pim/native_executable.h"
+#include "iree/hal/drivers/pim/util/pim_sim_model.h"
+
+// Thin wrappers around the PIM SDK entry points.
+//
+// The SDK keeps a single process-wide device model and is not safe to call
+// from multiple threads. With several PIM queues (and allocations happening on
+// the host thread) all SDK calls must go through these wrappers so that they
+// are serialized.
+
+// Transfers, dispatches, and collectives are modeled with the parameters of
+// the `pim-sim` device issuing them: the durations recorded in profiles and
+// statistics are computed from |simulation| when it is not NULL and measured
+// otherwise. The SDK performs the operation either way.
+
+// Uploads |element_count| floats from |data| and returns the new address.
+int iree_hal_pim_sdk_alloc_buffer(const iree_hal_pim_sim_params_t* simulation,
+                                  int element_count, const float* data);
+
+// Reads back the entire contents of the buffer at |addr| into |data|.
+// |element_count| is the capacity of the buffer and only used for profiling.
+void iree_hal_pim_sdk_read_buffer(const iree_hal_pim_sim_params_t* simulation,
+                                  int addr, int element_count, float* data);
+
+// Returns the size in bytes of one element of |element_type|.
+iree_host_size_t iree_hal_pim_element_type_byte_size(
+    iree_hal_pim_element_type_t element_type);
+
+// Uploads |element_count| elements of |element_type| from |data| and returns
+// the new address. SDKs with typed transfers store the data as is; otherwise
+// it is widened to f32 on the host and computed on in f32.
+int iree_hal_pim_sdk_alloc_typed_buffer(
+    const iree_hal_pim_sim_params_t* simulation,
+    iree_hal_pim_element_type_t element_type, int element_count,
+    const void* data);
+
+// Reads back the entire contents of the buffer at |addr| as |element_type|
+// into |data|. |element_count| is the capacity of the buffer. Without typed
+// SDK transfers the f32 contents are narrowed on the host.
+void iree_hal_pim_sdk_read_typed_buffer(
+    const iree_hal_pim_sim_params_t* simulation, int addr,
+    iree_hal_pim_element_type_t element_type, int element_count, void* data);
+
+// Returns true if the SDK is able to release device memory.
+bool iree_hal_pim_sdk_can_free_buffer();
+
+// Releases the buffer at |addr|. No-op if the SDK does not support it.
+void iree_hal_pim_sdk_free_buffer(int addr);
+
+// Maximum number of operands (including the result) of one instruction.
+#define IREE_HAL_PIM_MAX_OPERANDS 16
+
+// Maximum rank of an instruction operand.
+#define IREE_HAL_PIM_MAX_RANK 6
+
+// Shape of an instruction operand. The layout is part of the SDK ABI: it is
+// passed to the SDK as |rank| followed by IREE_HAL_PIM_MAX_RANK dims.
+typedef struct iree_hal_pim_shape_t {
+  int32_t rank;
+  int32_t dims[IREE_HAL_PIM_MAX_RANK];
+} iree_hal_pim_shape_t;
+
+// Dispatches |op_type| on the |operand_count| buffers at |addrs| with the
+// given |shapes| and returns the address of the result. |out_shape| receives
+// the result shape. |element_type| is the type the operands were uploaded
+// with by iree_hal_pim_sdk_alloc_typed_buffer; without typed SDK transfers
+// they were widened and the instruction runs in f32. The dispatch is
+// accumulated into the counters of the issuing device in |stats| if not NULL.
+//
+// SDKs exporting PIM_dispatch_span_code are called without copying the
+// arguments. Older SDKs take std::vector arguments by value; they are built
+// once per call and moved into it.
+int iree_hal_pim_sdk_dispatch(const iree_hal_pim_sim_params_t* simulation,
+                              iree_hal_pim_stats_t* stats, int op_type,
+                              iree_hal_pim_element_type_t element_type,
+                              iree_host_size_t operand_count,
+                              const int32_t* addrs,
+                              const iree_hal_pim_shape_t* shapes,
+                              iree_hal_pim_shape_t* out_shape);
+
+#endif  // IREE_HAL_DRIVERS_PIM_PIM_SDK_H_
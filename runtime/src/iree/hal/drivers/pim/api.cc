@@ -4,7 +4,7 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
-#include "iree/hal/drivers/vulkan/api.h"
+#include "iree/hal/drivers/pim/api.h"
 
 #include <cstring>
 #include <functional>
@@ -12,25 +12,25 @@
 
 #include "iree/base/api.h"
 #include "iree/base/tracing.h"
-#include "iree/hal/drivers/vulkan/dynamic_symbols.h"
-#include "iree/hal/drivers/vulkan/util/ref_ptr.h"
+#include "iree/hal/drivers/pim/dynamic_symbols.h"
+#include "iree/hal/drivers/pim/util/ref_ptr.h"
 
-using namespace iree::hal::vulkan;
+using namespace iree::hal::pim;
 
 // TODO(benvanik): move these into the appropriate files and delete this .cc.
 
 //===----------------------------------------------------------------------===//
-// iree::hal::vulkan::DynamicSymbols
+// iree::hal::pim::DynamicSymbols
 //===----------------------------------------------------------------------===//
 
-IREE_API_EXPORT iree_status_t iree_hal_vulkan_syms_create(
+IREE_API_EXPORT iree_status_t iree_hal_pim_syms_create(
     void* vkGetInstanceProcAddr_fn, iree_allocator_t host_allocator,
-    iree_hal_vulkan_syms_t** out_syms) {
-  IREE_TRACE_SCOPE0("iree_hal_vulkan_syms_create");
+    iree_hal_pim_syms_t** out_syms) {
+  IREE_TRACE_SCOPE0("iree_hal_pim_syms_create");
   IREE_ASSERT_ARGUMENT(out_syms);
   *out_syms = nullptr;
 
-  iree::ref_ptr<iree::hal::vulkan::DynamicSymbols> syms;
+  iree::ref_ptr<iree::hal::pim::DynamicSymbols> syms;
   IREE_RETURN_IF_ERROR(DynamicSymbols::Create(
       [&vkGetInstanceProcAddr_fn](const char* function_name) {
         // Only resolve vkGetInstanceProcAddr, rely on syms->LoadFromInstance()
@@ -43,23 +43,23 @@ IREE_API_EXPORT iree_status_t iree_hal_vulkan_syms_create(
       },
       &syms));
 
-  *out_syms = reinterpret_cast<iree_hal_vulkan_syms_t*>(syms.release());
+  *out_syms = reinterpret_cast<iree_hal_pim_syms_t*>(syms.release());
   return iree_ok_status();
 }
 
-IREE_API_EXPORT iree_status_t iree_hal_vulkan_syms_create_from_system_loader(
-    iree_allocator_t host_allocator, iree_hal_vulkan_syms_t** out_syms) {
-  IREE_TRACE_SCOPE0("iree_hal_vulkan_syms_create_from_system_loader");
+IREE_API_EXPORT iree_status_t iree_hal_pim_syms_create_from_system_loader(
+    iree_allocator_t host_allocator, iree_hal_pim_syms_t** out_syms) {
+  IREE_TRACE_SCOPE0("iree_hal_pim_syms_create_from_system_loader");
   IREE_ASSERT_ARGUMENT(out_syms);
   *out_syms = nullptr;
 
-  iree::ref_ptr<iree::hal::vulkan::DynamicSymbols> syms;
+  iree::ref_ptr<iree::hal::pim::DynamicSymbols> syms;
   IREE_RETURN_IF_ERROR(DynamicSymbols::CreateFromSystemLoader(&syms));
-  *out_syms = reinterpret_cast<iree_hal_vulkan_syms_t*>(syms.release());
+  *out_syms = reinterpret_cast<iree_hal_pim_syms_t*>(syms.release());
   return iree_ok_status();
 }
 
-IREE_API_EXPORT void iree_hal_vulkan_syms_retain(iree_hal_vulkan_syms_t* syms) {
+IREE_API_EXPORT void iree_hal_pim_syms_retain(iree_hal_pim_syms_t* syms) {
   IREE_ASSERT_ARGUMENT(syms);
   auto* handle = reinterpret_cast<DynamicSymbols*>(syms);
   if (handle) {
@@ -67,8 +67,8 @@ IREE_API_EXPORT void iree_hal_vulkan_syms_retain(iree_hal_vulkan_syms_t* syms) {
   }
 }
 
-IREE_API_EXPORT void iree_hal_vulkan_syms_release(
-    iree_hal_vulkan_syms_t* syms) {
+IREE_API_EXPORT void iree_hal_pim_syms_release(
+    iree_hal_pim_syms_t* syms) {
   IREE_ASSERT_ARGUMENT(syms);
   auto* handle = reinterpret_cast<DynamicSymbols*>(syms);
   if (handle) {
@@ -6,37 +6,38 @@
 
 // See iree/base/api.h for documentation on the API conventions used.
 
-#ifndef IREE_HAL_DRIVERS_VULKAN_API_H_
-#define IREE_HAL_DRIVERS_VULKAN_API_H_
+#ifndef IREE_HAL_DRIVERS_PIM_API_H_
+#define IREE_HAL_DRIVERS_PIM_API_H_
 
 #include <stdint.h>
 
 // clang-format off: must be included before all other headers.
-#include "iree/hal/drivers/vulkan/vulkan_headers.h"
+#include "iree/hal/drivers/pim/vulkan_headers.h"
 // clang-format on
 
 #include <stdint.h>
 
 #include "iree/base/api.h"
 #include "iree/hal/api.h"
+#include "iree/hal/drivers/pim/util/pim_sim_model.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif  // __cplusplus
 
 //===----------------------------------------------------------------------===//
-// iree_hal_vulkan_device_t extensibility util
+// iree_hal_pim_device_t extensibility util
 //===----------------------------------------------------------------------===//
 
 // TODO(benvanik): replace with feature list (easier to version).
 // Bitfield that defines sets of Vulkan features.
-enum iree_hal_vulkan_feature_bits_t {
+enum iree_hal_pim_feature_bits_t {
   // Use VK_LAYER_KHRONOS_standard_validation to validate Vulkan API usage.
   // Has a significant performance penalty and is *not* a security mechanism.
-  IREE_HAL_VULKAN_FEATURE_ENABLE_VALIDATION_LAYERS = 1u << 0,
+  IREE_HAL_PIM_FEATURE_ENABLE_VALIDATION_LAYERS = 1u << 0,
 
   // Use VK_EXT_debug_utils, record markers, and log errors.
-  IREE_HAL_VULKAN_FEATURE_ENABLE_DEBUG_UTILS = 1u << 1,
+  IREE_HAL_PIM_FEATURE_ENABLE_DEBUG_UTILS = 1u << 1,
 
   // Enables tracing of command buffers when IREE tracing is enabled.
   // May take advantage of additional extensions for more accurate timing or
@@ -46,38 +47,38 @@ enum iree_hal_vulkan_feature_bits_t {
   // submissions and introduce false barriers between dispatches. Use this to
   // identify slow dispatches and refine from there; be wary of whole-program
   // tracing with this enabled.
-  IREE_HAL_VULKAN_FEATURE_ENABLE_TRACING = 1u << 2,
+  IREE_HAL_PIM_FEATURE_ENABLE_TRACING = 1u << 2,
 };
-typedef uint32_t iree_hal_vulkan_features_t;
+typedef uint32_t iree_hal_pim_features_t;
 
 // Describes the type of a set of Vulkan extensions.
-typedef enum iree_hal_vulkan_extensibility_set_e {
+typedef enum iree_hal_pim_extensibility_set_e {
   // A set of required instance layer names. These must all be enabled on
   // the VkInstance for IREE to function.
-  IREE_HAL_VULKAN_EXTENSIBILITY_INSTANCE_LAYERS_REQUIRED = 0,
+  IREE_HAL_PIM_EXTENSIBILITY_INSTANCE_LAYERS_REQUIRED = 0,
 
   // A set of optional instance layer names. If omitted fallbacks may be
   // used or debugging features may not be available.
-  IREE_HAL_VULKAN_EXTENSIBILITY_INSTANCE_LAYERS_OPTIONAL,
+  IREE_HAL_PIM_EXTENSIBILITY_INSTANCE_LAYERS_OPTIONAL,
 
   // A set of required instance extension names. These must all be enabled on
   // the VkInstance for IREE to function.
-  IREE_HAL_VULKAN_EXTENSIBILITY_INSTANCE_EXTENSIONS_REQUIRED,
+  IREE_HAL_PIM_EXTENSIBILITY_INSTANCE_EXTENSIONS_REQUIRED,
 
   // A set of optional instance extension names. If omitted fallbacks may be
   // used or debugging features may not be available.
-  IREE_HAL_VULKAN_EXTENSIBILITY_INSTANCE_EXTENSIONS_OPTIONAL,
+  IREE_HAL_PIM_EXTENSIBILITY_INSTANCE_EXTENSIONS_OPTIONAL,
 
   // A set of required device extension names. These must all be enabled on
   // the VkDevice for IREE to function.
-  IREE_HAL_VULKAN_EXTENSIBILITY_DEVICE_EXTENSIONS_REQUIRED,
+  IREE_HAL_PIM_EXTENSIBILITY_DEVICE_EXTENSIONS_REQUIRED,
 
   // A set of optional device extension names. If omitted fallbacks may be
   // used or debugging features may not be available.
-  IREE_HAL_VULKAN_EXTENSIBILITY_DEVICE_EXTENSIONS_OPTIONAL,
+  IREE_HAL_PIM_EXTENSIBILITY_DEVICE_EXTENSIONS_OPTIONAL,
 
-  IREE_HAL_VULKAN_EXTENSIBILITY_SET_COUNT,  // used for sizing lookup tables
-} iree_hal_vulkan_extensibility_set_t;
+  IREE_HAL_PIM_EXTENSIBILITY_SET_COUNT,  // used for sizing lookup tables
+} iree_hal_pim_extensibility_set_t;
 
 // Queries the names of the Vulkan layers and extensions used for a given set of
 // IREE |requested_features|. All devices used by IREE must have the required
@@ -86,8 +87,8 @@ typedef enum iree_hal_vulkan_extensibility_set_e {
 // they are not available.
 //
 // Instance extensions should be enabled on VkInstances passed to
-// |iree_hal_vulkan_driver_create_using_instance| and device extensions should
-// be enabled on VkDevices passed to |iree_hal_vulkan_driver_wrap_device|.
+// |iree_hal_pim_driver_create_using_instance| and device extensions should
+// be enabled on VkDevices passed to |iree_hal_pim_driver_wrap_device|.
 //
 // |string_capacity| defines the number of elements available in
 // |out_string_values| and |out_string_count| will be set with the actual number
@@ -99,16 +100,16 @@ typedef enum iree_hal_vulkan_extensibility_set_e {
 // The returned strings originate from the _EXTENSION_NAME Vulkan macros
 // (such as 'VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME') and have a
 // lifetime matching whatever module they are defined in.
-IREE_API_EXPORT iree_status_t iree_hal_vulkan_query_extensibility_set(
-    iree_hal_vulkan_features_t requested_features,
-    iree_hal_vulkan_extensibility_set_t set, iree_host_size_t string_capacity,
+IREE_API_EXPORT iree_status_t iree_hal_pim_query_extensibility_set(
+    iree_hal_pim_features_t requested_features,
+    iree_hal_pim_extensibility_set_t set, iree_host_size_t string_capacity,
     iree_host_size_t* out_string_count, const char** out_string_values);
 
 //===----------------------------------------------------------------------===//
-// iree_hal_vulkan_syms_t
+// iree_hal_pim_syms_t
 //===----------------------------------------------------------------------===//
 
-typedef struct iree_hal_vulkan_syms_t iree_hal_vulkan_syms_t;
+typedef struct iree_hal_pim_syms_t iree_hal_pim_syms_t;
 
 // Loads Vulkan functions by invoking |vkGetInstanceProcAddr|.
 //
@@ -118,54 +119,75 @@ typedef struct iree_hal_vulkan_syms_t iree_hal_vulkan_syms_t;
 // statically linking Vulkan.
 //
 // |out_syms| must be released by the caller.
-IREE_API_EXPORT iree_status_t iree_hal_vulkan_syms_create(
+IREE_API_EXPORT iree_status_t iree_hal_pim_syms_create(
     void* vkGetInstanceProcAddr_fn, iree_allocator_t host_allocator,
-    iree_hal_vulkan_syms_t** out_syms);
+    iree_hal_pim_syms_t** out_syms);
 
 // Loads Vulkan functions from the Vulkan loader.
 // This will look for a Vulkan loader on the system (like libvulkan.so) and
 // dlsym the functions from that.
 //
-// |out_syms| must be released by the caller with iree_hal_vulkan_syms_release.
-IREE_API_EXPORT iree_status_t iree_hal_vulkan_syms_create_from_system_loader(
-    iree_allocator_t host_allocator, iree_hal_vulkan_syms_t** out_syms);
+// |out_syms| must be released by the caller with iree_hal_pim_syms_release.
+IREE_API_EXPORT iree_status_t iree_hal_pim_syms_create_from_system_loader(
+    iree_allocator_t host_allocator, iree_hal_pim_syms_t** out_syms);
 
 // Retains the given |syms| for the caller.
-IREE_API_EXPORT void iree_hal_vulkan_syms_retain(iree_hal_vulkan_syms_t* syms);
+IREE_API_EXPORT void iree_hal_pim_syms_retain(iree_hal_pim_syms_t* syms);
 
 // Releases the given |syms| from the caller.
-IREE_API_EXPORT void iree_hal_vulkan_syms_release(iree_hal_vulkan_syms_t* syms);
+IREE_API_EXPORT void iree_hal_pim_syms_release(iree_hal_pim_syms_t* syms);
 
 //===----------------------------------------------------------------------===//
-// iree_hal_vulkan_device_t
+// iree_hal_pim_device_t
 //===----------------------------------------------------------------------===//
 
 // A set of queues within a specific queue family on a VkDevice.
-typedef struct iree_hal_vulkan_queue_set_t {
+typedef struct iree_hal_pim_queue_set_t {
   // The index of a particular queue family on a VkPhysicalDevice, as described
   // by vkGetPhysicalDeviceQueueFamilyProperties.
   uint32_t queue_family_index;
 
   // Bitfield of queue indices within the queue family at |queue_family_index|.
   uint64_t queue_indices;
-} iree_hal_vulkan_queue_set_t;
+} iree_hal_pim_queue_set_t;
 
 // TODO(benvanik): replace with flag list (easier to version).
-enum iree_hal_vulkan_device_flag_bits_t {
-  IREE_HAL_VULKAN_DEVICE_FLAG_NONE = 0u,
+enum iree_hal_pim_device_flag_bits_t {
+  IREE_HAL_PIM_DEVICE_FLAG_NONE = 0u,
 
   // Prefer choosing a dedicated VK_QUEUE_COMPUTE_BIT without
   // VK_QUEUE_GRAPHICS_BIT capabilities. When integrating into an application
   // that makes heavy use of the primary graphics/compute queue this can allow
   // IREE execution to run asynchronously with the graphics workloads.
   // See: https://gpuopen.com/learn/concurrent-execution-asynchronous-queues/
-  IREE_HAL_VULKAN_DEVICE_FLAG_DEDICATED_COMPUTE_QUEUE = 1u << 0,
+  IREE_HAL_PIM_DEVICE_FLAG_DEDICATED_COMPUTE_QUEUE = 1u << 0,
+
+  // Double-buffers host-mappable dispatch results such as the final logits or
+  // hidden state. Each result is read back on the queue thread as part of the
+  // submission producing it so that by the time its semaphores signal the
+  // host can consume step N without touching the device while step N+1
+  // executes. Costs one extra host copy per result.
+  IREE_HAL_PIM_DEVICE_FLAG_DOUBLE_BUFFERED_RESULTS = 1u << 1,
+
+  // Reports latencies modeled by iree_hal_pim_device_options_t::simulation
+  // instead of the duration of the SDK calls in the dispatch statistics and
+  // profiles. Used by the `pim-sim` driver to evaluate compiler changes
+  // without PIM hardware; results are still computed by the SDK.
+  IREE_HAL_PIM_DEVICE_FLAG_SIMULATION = 1u << 2,
+
+  // Runs host fallback dispatches (such as the softmax or layer norms left to
+  // the host with --iree-pim-host-layers) on a worker thread of each queue
+  // while the PIM dispatches recorded with them up to the next execution
+  // barrier execute. With the heads or micro-batches of a block split into
+  // independent dispatches the host normalizes one group while the device
+  // computes the next.
+  IREE_HAL_PIM_DEVICE_FLAG_HOST_OVERLAP = 1u << 3,
 };
-typedef uint32_t iree_hal_vulkan_device_flags_t;
+typedef uint32_t iree_hal_pim_device_flags_t;
 
-typedef struct iree_hal_vulkan_device_options_t {
+typedef struct iree_hal_pim_device_options_t {
   // Flags controlling device behavior.
-  iree_hal_vulkan_device_flags_t flags;
+  iree_hal_pim_device_flags_t flags;
 
   // Sets the VMA preferredLargeHeapBlockSize field to control the preferred
   // size of a large heap block allocation. This effectively specifies the
@@ -173,11 +195,59 @@ typedef struct iree_hal_vulkan_device_options_t {
   // much.
   // NOTE: this is temporary and likely to get removed in the future.
   iree_device_size_t large_heap_block_size;
-} iree_hal_vulkan_device_options_t;
 
-
-IREE_API_EXPORT void iree_hal_vulkan_device_options_initialize(
-    iree_hal_vulkan_device_options_t* out_options);
+  // Number of PIM modules exposed as independent device queues. Each queue
+  // has its own submission thread and is selected by iree_hal_queue_affinity_t
+  // so that partitions targeting different modules are scheduled concurrently.
+  // Must be in the range [1, 64].
+  iree_host_size_t queue_count;
+
+  // Latency model of each PIM module used with
+  // IREE_HAL_PIM_DEVICE_FLAG_SIMULATION.
+  iree_hal_pim_sim_params_t simulation;
+
+  // Bytes of device memory the weights of all models sharing the device may
+  // occupy. When loading or running a model would exceed it the weights of the
+  // least recently used models are moved to host memory and swapped back in
+  // the next time they are read. 0 keeps all weights resident.
+  // See iree_hal_pim_device_set_active_model.
+  iree_device_size_t pim_residency_capacity;
+
+  // Priority class of the PIM queue submission threads, from -2 (lowest) to
+  // 2 (highest) as with iree_thread_priority_class_t.
+  int32_t pim_queue_thread_priority;
+
+  // CPU the submission thread of the first PIM queue is pinned to; queue i
+  // runs on CPU pim_queue_thread_cpu + i. Pinning keeps the SDK calls of
+  // each queue on a core of its own instead of migrating across cores shared
+  // with the serving threads. -1 lets the system place the threads.
+  //
+  // The range must lie within the online CPUs or device creation fails with
+  // IREE_STATUS_INVALID_ARGUMENT. CPUs are not offset per device: every device
+  // created with the same options pins its queues to the same CPUs, so callers
+  // creating several pinned devices must give each one a disjoint range.
+  int32_t pim_queue_thread_cpu;
+} iree_hal_pim_device_options_t;
+
+
+IREE_API_EXPORT void iree_hal_pim_device_options_initialize(
+    iree_hal_pim_device_options_t* out_options);
+
+// Attributes weights allocated on |device| from now on (buffers created with
+// initial contents or imported from host memory) to the model |model_id| so
+// that they are evicted and restored together under
+// iree_hal_pim_device_options_t::pim_residency_capacity. Servers hosting
+// several models set it before loading each model. Model 0 (the default) is
+// never evicted.
+IREE_API_EXPORT iree_status_t iree_hal_pim_device_set_active_model(
+    iree_hal_device_t* device, uint64_t model_id);
+
+// Swaps the weights of |model_id| back onto |device| ahead of a request for
+// it, evicting the least recently used models if needed. Called by servers
+// when a request is queued so the transfer overlaps with the requests still
+// executing. Models being evicted must not have dispatches in flight.
+IREE_API_EXPORT iree_status_t iree_hal_pim_device_prefetch_model(
+    iree_hal_device_t* device, uint64_t model_id);
 
 // Creates a Vulkan HAL device that wraps an existing VkDevice.
 //
@@ -185,8 +255,8 @@ IREE_API_EXPORT void iree_hal_vulkan_device_options_initialize(
 // within the same physical VkPhysicalDevice and logical VkDevice directly.
 //
 // |logical_device| is expected to have been created with all extensions
-// returned by |iree_hal_vulkan_get_extensions| and
-// IREE_HAL_DRIVERS_VULKAN_DEVICE_REQUIRED using the features provided during
+// returned by |iree_hal_pim_get_extensions| and
+// IREE_HAL_DRIVERS_PIM_DEVICE_REQUIRED using the features provided during
 // driver creation.
 //
 // |instance_syms| must have at least the instance-specific functions resolved
@@ -208,21 +278,21 @@ IREE_API_EXPORT void iree_hal_vulkan_device_options_initialize(
 // The queue sets can be the same.
 //
 // |out_device| must be released by the caller (see |iree_hal_device_release|).
-IREE_API_EXPORT iree_status_t iree_hal_vulkan_wrap_device(
+IREE_API_EXPORT iree_status_t iree_hal_pim_wrap_device(
     iree_string_view_t identifier,
-    const iree_hal_vulkan_device_options_t* options,
-    const iree_hal_vulkan_syms_t* instance_syms, VkInstance instance,
+    const iree_hal_pim_device_options_t* options,
+    const iree_hal_pim_syms_t* instance_syms, VkInstance instance,
     VkPhysicalDevice physical_device, VkDevice logical_device,
-    const iree_hal_vulkan_queue_set_t* compute_queue_set,
-    const iree_hal_vulkan_queue_set_t* transfer_queue_set,
+    const iree_hal_pim_queue_set_t* compute_queue_set,
+    const iree_hal_pim_queue_set_t* transfer_queue_set,
     iree_allocator_t host_allocator, iree_hal_device_t** out_device);
 
 //===----------------------------------------------------------------------===//
-// iree_hal_vulkan_driver_t
+// iree_hal_pim_driver_t
 //===----------------------------------------------------------------------===//
 
 // Vulkan driver creation options.
-typedef struct iree_hal_vulkan_driver_options_t {
+typedef struct iree_hal_pim_driver_options_t {
   // Vulkan version that will be requested, e.g. `VK_API_VERSION_1_0`.
   // Driver creation will fail if the required version is not available.
   uint32_t api_version;
@@ -230,7 +300,7 @@ typedef struct iree_hal_vulkan_driver_options_t {
   // IREE features used to configure the VkInstance and VkDevices created using
   // it. These are used to populate the active Vulkan layers and extensions when
   // the instance and its devices are created.
-  iree_hal_vulkan_features_t requested_features;
+  iree_hal_pim_features_t requested_features;
 
   // Cutoff for debug output: 0=none, 1=errors, 2=warnings, 3=info, 4=debug.
   int32_t debug_verbosity;
@@ -241,36 +311,36 @@ typedef struct iree_hal_vulkan_driver_options_t {
   // forces all devices - even if from different vendors - to have the same
   // options.
   // Options to use for all devices created by the driver.
-  iree_hal_vulkan_device_options_t device_options;
-} iree_hal_vulkan_driver_options_t;
+  iree_hal_pim_device_options_t device_options;
+} iree_hal_pim_driver_options_t;
 
-IREE_API_EXPORT void iree_hal_vulkan_driver_options_initialize(
-    iree_hal_vulkan_driver_options_t* out_options);
+IREE_API_EXPORT void iree_hal_pim_driver_options_initialize(
+    iree_hal_pim_driver_options_t* out_options);
 
 // Creates a Vulkan HAL driver that manages its own VkInstance.
 //
 // |out_driver| must be released by the caller (see |iree_hal_driver_release|).
-IREE_API_EXPORT iree_status_t iree_hal_vulkan_driver_create(
+IREE_API_EXPORT iree_status_t iree_hal_pim_driver_create(
     iree_string_view_t identifier,
-    const iree_hal_vulkan_driver_options_t* options,
+    const iree_hal_pim_driver_options_t* options,
     iree_allocator_t host_allocator,
     iree_hal_driver_t** out_driver);
 
 // Creates a Vulkan HAL driver that shares an existing VkInstance.
 //
 // |instance| is expected to have been created with all extensions returned by
-// the instance-specific |iree_hal_vulkan_query_extensibility_set| queries.
+// the instance-specific |iree_hal_pim_query_extensibility_set| queries.
 //
 // |instance| must remain valid for the life of |out_driver| and |out_driver|
 // itself must be released by the caller (see |iree_hal_driver_release|).
-IREE_API_EXPORT iree_status_t iree_hal_vulkan_driver_create_using_instance(
+IREE_API_EXPORT iree_status_t iree_hal_pim_driver_create_using_instance(
     iree_string_view_t identifier,
-    const iree_hal_vulkan_driver_options_t* options,
-    iree_hal_vulkan_syms_t* instance_syms, VkInstance instance,
+    const iree_hal_pim_driver_options_t* options,
+    iree_hal_pim_syms_t* instance_syms, VkInstance instance,
     iree_allocator_t host_allocator, iree_hal_driver_t** out_driver);
 
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
 
-#endif  // IREE_HAL_DRIVERS_VULKAN_API_H_
+#endif  // IREE_HAL_DRIVERS_PIM_API_H_
@@ -0,0 +1,2025 @@
+// Copyright 2019 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/pim/direct_command_buffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <bitset>
+#include <algorithm>
+#include <new>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/arena.h"
+#include "iree/base/internal/fpu_state.h"
+#include "iree/base/internal/inline_array.h"
+#include "iree/base/internal/math.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/drivers/pim/dynamic_symbols.h"
+#include "iree/hal/drivers/pim/native_executable.h"
+#include "iree/hal/drivers/pim/native_pipeline_layout.h"
+#include "iree/hal/drivers/pim/status_util.h"
+#include "iree/hal/drivers/pim/util/ref_ptr.h"
+#include "iree/hal/drivers/pim/PIM_allocator.h"
+#include "iree/hal/drivers/pim/PIM_buffer.h"
+#include "iree/hal/drivers/pim/PIM_channel.h"
+#include "iree/hal/drivers/pim/PIM_host_worker.h"
+#include "iree/hal/drivers/pim/PIM_sdk.h"
+#include "iree/hal/local/executable_library.h"
+#include "iree/hal/local/local_executable.h"
+#include "iree/hal/local/local_pipeline_layout.h"
+#include "iree/hal/utils/collective_batch.h"
+#include "iree/hal/utils/resource_set.h"
+
+
+using namespace iree::hal::pim;
+
+
+// A buffer range bound to a PIM dispatch. |buffer| is the allocated buffer and
+// |offset| is relative to the start of its allocation so that suballocations
+// of one buffer (through subspans or binding offsets) are told apart.
+typedef struct iree_hal_pim_binding_t {
+  iree_hal_buffer_t* buffer;
+  iree_device_size_t offset;
+  iree_device_size_t length;
+} iree_hal_pim_binding_t;
+
+// A transfer recorded into a PIM command buffer. The SDK has no transfer
+// commands of its own: updates and fills upload their data as new device
+// allocations and copies share the device allocation of the source range.
+typedef struct iree_hal_pim_transfer_t {
+  // Source range of copies. The buffer is NULL for updates and fills.
+  iree_hal_pim_binding_t source;
+  // Host data of updates or the fill pattern copied into the command buffer
+  // arena.
+  const void* source_data;
+  // Length of the fill pattern in bytes or 0 if not a fill.
+  iree_host_size_t pattern_length;
+  // Target range written by the transfer.
+  iree_hal_pim_binding_t target;
+} iree_hal_pim_transfer_t;
+
+// A dispatch, transfer, or group of collective operations recorded into a PIM
+// command buffer. Records and the tables they reference are allocated from the
+// command buffer arena and live until the command buffer is reset. Device
+// addresses are resolved from |bindings| when the command buffer is executed as
+// earlier dispatches in the same submission may reassign the device address of
+// their result buffers.
+typedef struct iree_hal_pim_dispatch_t {
+  // Next command in recording order.
+  struct iree_hal_pim_dispatch_t* next;
+  // Executable providing the PIM program of the dispatch. Retained by the
+  // resource set of the command buffer. Host fallback executables (any
+  // executable that isn't a PIM one) are run on the host instead.
+  iree_hal_executable_t* executable;
+  // Entry point selecting the PIM program of linked executables and the
+  // workgroup count of host fallback dispatches. PIM programs are not tiled
+  // into workgroups.
+  int32_t entry_point;
+  uint32_t workgroup_count[3];
+  // Buffers bound via push_descriptor_set. Unless the executable maps the
+  // operands of its instructions the last binding receives the dispatch
+  // result. Shared with other dispatches using the same descriptor set.
+  iree_host_size_t binding_count;
+  const iree_hal_pim_binding_t* bindings;
+  // Binding table slots of |bindings| entries with a NULL buffer. Only present
+  // in nested command buffers and resolved when they are executed from a
+  // primary command buffer.
+  const uint32_t* binding_slots;
+  // Push constants providing the dynamic dims of the program instructions.
+  // Shared with other dispatches recorded before the next push_constants.
+  iree_host_size_t constant_count;
+  const uint32_t* constants;
+  // Collective operations flushed from the collective batch. When non-zero
+  // the command is a collective group and |executable| and |bindings| are
+  // unused.
+  iree_host_size_t collective_count;
+  const iree_hal_collective_batch_entry_t* collectives;
+  // Transfer to perform. When non-NULL the command is a transfer and
+  // |executable| and |bindings| are unused.
+  const iree_hal_pim_transfer_t* transfer;
+  // Set on execution barriers. Commands between two barriers are independent
+  // (such as the dispatches of a stream.cmd.concurrent region) and host
+  // dispatches among them may run alongside the PIM dispatches.
+  bool barrier;
+} iree_hal_pim_dispatch_t;
+
+// A host fallback dispatch being executed. The bindings are downloaded on the
+// queue thread, the executable runs either inline or on the host worker and
+// the bindings it wrote are uploaded on the queue thread once it completes.
+typedef struct iree_hal_pim_host_dispatch_t {
+  const iree_hal_pim_dispatch_t* dispatch;
+  iree_hal_local_executable_t* local_executable;
+  iree_byte_span_t local_memory;
+  void* binding_ptrs[IREE_HAL_LOCAL_BINDING_MASK_BITS];
+  size_t binding_lengths[IREE_HAL_LOCAL_BINDING_MASK_BITS];
+  uint64_t binding_hashes[IREE_HAL_LOCAL_BINDING_MASK_BITS];
+} iree_hal_pim_host_dispatch_t;
+
+// Result of a PIM program instruction kept on the device for use by later
+// instructions of the same dispatch.
+typedef struct iree_hal_pim_resident_t {
+  int addr;
+  std::vector<int> shape;
+} iree_hal_pim_resident_t;
+
+// Command buffer implementation that records PIM dispatches on the calling
+// thread and replays them against the PIM SDK when submitted to the device
+// queue via iree_hal_pim_direct_command_buffer_execute.
+//
+// Deferred command buffers are replayed into one of these on the queue thread
+// so that the full dispatch sequence of a submission (such as a decoder block)
+// is assembled first and then issued to the SDK in a single pass.
+typedef struct iree_hal_pim_direct_command_buffer_t {
+  iree_hal_command_buffer_t base;
+
+  iree_allocator_t host_allocator;
+  iree_hal_allocator_t* device_allocator;
+
+  // Block pool used for the resource set and arena.
+  iree_arena_block_pool_t* block_pool;
+
+  // Latency model of the device or NULL if dispatches are measured.
+  const iree_hal_pim_sim_params_t* simulation;
+
+  // Dispatch counters of the device or NULL if dispatches are not counted.
+  iree_hal_pim_stats_t* stats;
+
+  // Storage for recorded commands, binding tables, and the collective batch.
+  // Reset with the command buffer so steady-state recording does not touch
+  // the heap.
+  iree_arena_allocator_t arena;
+
+  // Retains the buffers and channels referenced by recorded commands.
+  // Allocated on first use after each reset.
+  iree_hal_resource_set_t* resource_set;
+
+  // Collectives recorded since the last flush. Consecutive collectives are
+  // grouped into a single command so they rendezvous together.
+  iree_hal_collective_batch_t collective_batch;
+
+  // Binding table of the most recent push_descriptor_set in arena storage.
+  // |binding_slots| is NULL unless the table references indirect bindings.
+  iree_host_size_t binding_count;
+  iree_hal_pim_binding_t* bindings;
+  uint32_t* binding_slots;
+
+  // Push constants of the most recent push_constants in arena storage
+  // including those of earlier pushes to other offsets.
+  iree_host_size_t constant_count;
+  uint32_t* constants;
+
+  // Commands recorded in order since the last begin.
+  iree_hal_pim_dispatch_t* head;
+  iree_hal_pim_dispatch_t* tail;
+
+  // Scratch storage reused across executions for the SDK call arguments.
+  std::vector<int> scratch_addrs;
+  std::vector<std::vector<int>> scratch_shapes;
+  std::vector<int> scratch_output_shape;
+  // Results of the instructions of the program being executed that stay
+  // resident on the device.
+  std::vector<iree_hal_pim_resident_t> scratch_residents;
+  // Host staging of bindings that aren't f32 and the device allocations they
+  // were uploaded to for the instruction being executed.
+  std::vector<uint8_t> scratch_bytes;
+  std::vector<int> scratch_staged_addrs;
+  // Dims of the instruction being executed with push constants resolved.
+  std::vector<int32_t> scratch_dims;
+  // Shape an operand of the instruction being executed is read with.
+  std::vector<int> scratch_operand_shape;
+  // Host copies of results being sharded or synchronized across modules.
+  std::vector<float> scratch_download;
+  std::vector<float> scratch_upload;
+  std::vector<float> scratch_gather;
+  // Host copies of the bindings of the host fallback dispatch being executed.
+  std::vector<std::vector<uint8_t>> scratch_host_bindings;
+  // Host fallback dispatch being executed.
+  iree_hal_pim_host_dispatch_t scratch_host_dispatch;
+} iree_hal_pim_direct_command_buffer_t;
+
+namespace {
+extern const iree_hal_command_buffer_vtable_t
+    iree_hal_pim_direct_command_buffer_vtable;
+}  // namespace
+
+static iree_hal_pim_direct_command_buffer_t*
+iree_hal_pim_direct_command_buffer_cast(
+    iree_hal_command_buffer_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value,
+                       &iree_hal_pim_direct_command_buffer_vtable);
+  return (iree_hal_pim_direct_command_buffer_t*)base_value;
+}
+
+iree_status_t iree_hal_pim_direct_command_buffer_allocate(
+    iree_hal_device_t* device,
+    iree_allocator_t host_allocator, iree_hal_allocator_t* device_allocator,
+    iree_arena_block_pool_t* block_pool,
+    const iree_hal_pim_sim_params_t* simulation, iree_hal_pim_stats_t* stats,
+    iree_hal_command_buffer_mode_t mode,
+    iree_hal_command_category_t command_categories,
+    iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
+    iree_hal_command_buffer_t** out_command_buffer) {
+
+  IREE_ASSERT_ARGUMENT(out_command_buffer);
+  *out_command_buffer = NULL;
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_pim_direct_command_buffer_t* command_buffer = NULL;
+  iree_status_t status =
+      iree_allocator_malloc(host_allocator,
+                            sizeof(*command_buffer), (void**)&command_buffer);
+  if (iree_status_is_ok(status)) {
+    iree_hal_command_buffer_initialize(
+        device, mode, command_categories, queue_affinity, binding_capacity,
+        &iree_hal_pim_direct_command_buffer_vtable, &command_buffer->base);
+
+    command_buffer->host_allocator = host_allocator;
+    command_buffer->device_allocator = device_allocator;
+    command_buffer->block_pool = block_pool;
+    command_buffer->simulation = simulation;
+    command_buffer->stats = stats;
+    iree_arena_initialize(block_pool, &command_buffer->arena);
+    command_buffer->resource_set = NULL;
+    command_buffer->binding_count = 0;
+    command_buffer->bindings = NULL;
+    command_buffer->binding_slots = NULL;
+    command_buffer->head = NULL;
+    command_buffer->tail = NULL;
+    new (&command_buffer->scratch_addrs) std::vector<int>();
+    new (&command_buffer->scratch_shapes) std::vector<std::vector<int>>();
+    new (&command_buffer->scratch_output_shape) std::vector<int>();
+    new (&command_buffer->scratch_residents)
+        std::vector<iree_hal_pim_resident_t>();
+    new (&command_buffer->scratch_bytes) std::vector<uint8_t>();
+    new (&command_buffer->scratch_staged_addrs) std::vector<int>();
+    new (&command_buffer->scratch_dims) std::vector<int32_t>();
+    new (&command_buffer->scratch_operand_shape) std::vector<int>();
+    new (&command_buffer->scratch_download) std::vector<float>();
+    new (&command_buffer->scratch_upload) std::vector<float>();
+    new (&command_buffer->scratch_gather) std::vector<float>();
+    new (&command_buffer->scratch_host_bindings)
+        std::vector<std::vector<uint8_t>>();
+
+    *out_command_buffer = &command_buffer->base;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+bool iree_hal_pim_direct_command_buffer_isa(
+    iree_hal_command_buffer_t* command_buffer) {
+  return iree_hal_command_buffer_dyn_cast(
+      command_buffer, &iree_hal_pim_direct_command_buffer_vtable);
+}
+
+static void* iree_hal_pim_direct_command_buffer_dyn_cast(
+    iree_hal_command_buffer_t* command_buffer, const void* vtable) {
+  if (vtable == &iree_hal_pim_direct_command_buffer_vtable) {
+    IREE_HAL_ASSERT_TYPE(command_buffer, vtable);
+    return command_buffer;
+  }
+  return NULL;
+}
+
+// Releases all recorded commands and the resources they retain.
+static void iree_hal_pim_direct_command_buffer_reset(
+    iree_hal_pim_direct_command_buffer_t* command_buffer) {
+  command_buffer->head = NULL;
+  command_buffer->tail = NULL;
+  command_buffer->binding_count = 0;
+  command_buffer->bindings = NULL;
+  command_buffer->binding_slots = NULL;
+  command_buffer->constant_count = 0;
+  command_buffer->constants = NULL;
+  if (command_buffer->resource_set) {
+    iree_hal_collective_batch_deinitialize(&command_buffer->collective_batch);
+    iree_hal_resource_set_free(command_buffer->resource_set);
+    command_buffer->resource_set = NULL;
+  }
+  iree_arena_reset(&command_buffer->arena);
+}
+
+// Allocates the resource set and collective batch on first use after a reset.
+static iree_status_t iree_hal_pim_direct_command_buffer_ensure_resource_set(
+    iree_hal_pim_direct_command_buffer_t* command_buffer) {
+  if (IREE_LIKELY(command_buffer->resource_set)) return iree_ok_status();
+  IREE_RETURN_IF_ERROR(iree_hal_resource_set_allocate(
+      command_buffer->block_pool, &command_buffer->resource_set));
+  iree_hal_collective_batch_initialize(&command_buffer->arena,
+                                       command_buffer->resource_set,
+                                       &command_buffer->collective_batch);
+  return iree_ok_status();
+}
+
+// Appends a zeroed command to the command stream.
+static iree_status_t iree_hal_pim_direct_command_buffer_append_command(
+    iree_hal_pim_direct_command_buffer_t* command_buffer,
+    iree_hal_pim_dispatch_t** out_command) {
+  iree_hal_pim_dispatch_t* command = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(
+      &command_buffer->arena, sizeof(*command), (void**)&command));
+  memset(command, 0, sizeof(*command));
+  if (command_buffer->tail) {
+    command_buffer->tail->next = command;
+  } else {
+    command_buffer->head = command;
+  }
+  command_buffer->tail = command;
+  *out_command = command;
+  return iree_ok_status();
+}
+
+// Moves any pending collectives into the command stream as a single group.
+static iree_status_t iree_hal_pim_direct_command_buffer_flush_collectives(
+    iree_hal_pim_direct_command_buffer_t* command_buffer) {
+  if (IREE_LIKELY(!command_buffer->resource_set ||
+                  iree_hal_collective_batch_is_empty(
+                      &command_buffer->collective_batch))) {
+    return iree_ok_status();
+  }
+  iree_hal_collective_batch_t* batch = &command_buffer->collective_batch;
+  iree_hal_pim_dispatch_t* command = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_pim_direct_command_buffer_append_command(
+      command_buffer, &command));
+  // The batch entries live in the arena; copy them out as the batch reuses its
+  // storage for the next group.
+  iree_hal_collective_batch_entry_t* collectives = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(
+      &command_buffer->arena, batch->count * sizeof(*collectives),
+      (void**)&collectives));
+  memcpy(collectives, batch->entries, batch->count * sizeof(*collectives));
+  command->collective_count = batch->count;
+  command->collectives = collectives;
+  iree_hal_collective_batch_reset(batch);
+  return iree_ok_status();
+}
+
+static void iree_hal_pim_direct_command_buffer_destroy(
+    iree_hal_command_buffer_t* base_command_buffer) {
+  iree_hal_pim_direct_command_buffer_t* command_buffer =
+      iree_hal_pim_direct_command_buffer_cast(base_command_buffer);
+  iree_allocator_t host_allocator = command_buffer->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_pim_direct_command_buffer_reset(command_buffer);
+  iree_arena_deinitialize(&command_buffer->arena);
+  command_buffer->scratch_host_bindings.~vector();
+  command_buffer->scratch_gather.~vector();
+  command_buffer->scratch_upload.~vector();
+  command_buffer->scratch_download.~vector();
+  command_buffer->scratch_operand_shape.~vector();
+  command_buffer->scratch_dims.~vector();
+  command_buffer->scratch_staged_addrs.~vector();
+  command_buffer->scratch_bytes.~vector();
+  command_buffer->scratch_residents.~vector();
+  command_buffer->scratch_output_shape.~vector();
+  command_buffer->scratch_shapes.~vector();
+  command_buffer->scratch_addrs.~vector();
+  iree_allocator_free(host_allocator, command_buffer);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Performs |transfer| on the calling thread.
+static iree_status_t iree_hal_pim_direct_command_buffer_execute_transfer(
+    const iree_hal_pim_transfer_t* transfer) {
+  const iree_hal_pim_binding_t* target = &transfer->target;
+  if (transfer->source.buffer) {
+    return iree_hal_pim_buffer_copy_range(
+        transfer->source.buffer, transfer->source.offset, target->buffer,
+        target->offset, target->length);
+  } else if (transfer->pattern_length) {
+    return iree_hal_pim_buffer_fill_range(target->buffer, target->offset,
+                                          target->length,
+                                          transfer->source_data,
+                                          transfer->pattern_length);
+  }
+  return iree_hal_pim_buffer_upload_range(target->buffer, target->offset,
+                                          transfer->source_data,
+                                          target->length);
+}
+
+// Returns the number of elements of a tensor with |rank| |dims|.
+template <typename T>
+static int64_t iree_hal_pim_element_count(const T* dims,
+                                          iree_host_size_t rank) {
+  int64_t count = 1;
+  for (iree_host_size_t i = 0; i < rank; ++i) count *= dims[i];
+  return count;
+}
+
+// Returns the result shape of |instruction| as compiled into the executable in
+// |out_shape| or false if it can't be derived from the instruction dims.
+// Matmuls produce [m, n], batched matmuls and rotary embeddings [b, m, n] and
+// gathers [count, length].
+static bool iree_hal_pim_instruction_result_shape(
+    const iree_hal_pim_instruction_t* instruction,
+    std::vector<int>* out_shape) {
+  switch (instruction->opcode) {
+    case 2:   // QKVGen
+    case 6:   // OutProj
+    case 8:   // FFN1
+    case 9:   // FFN2
+    case 10:  // LMHead
+    case 14:  // FFNGate
+    case 15:  // SwiGLU
+      if (instruction->dim_count != 3) return false;
+      out_shape->assign({instruction->dims[0], instruction->dims[1]});
+      return true;
+    case 3:  // QKMatmul
+    case 5:  // SVMatmul
+      if (instruction->dim_count != 4) return false;
+      out_shape->assign(
+          {instruction->dims[0], instruction->dims[1], instruction->dims[2]});
+      return true;
+    case 13:  // RoPE
+      if (instruction->dim_count != 3) return false;
+      out_shape->assign(
+          {instruction->dims[0], instruction->dims[1], instruction->dims[2]});
+      return true;
+    case 16:  // GQAQKMatmul
+    case 17:  // GQASVMatmul
+      if (instruction->dim_count != 5) return false;
+      out_shape->assign(
+          {instruction->dims[0], instruction->dims[1], instruction->dims[2]});
+      return true;
+    case 11:  // Gather
+      if (instruction->dim_count != 2) return false;
+      out_shape->assign({instruction->dims[0], instruction->dims[1]});
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns in |out_shape| the shape operand |operand_index| of |instruction| is
+// read with when it can be derived from the instruction dims. Matmuls read
+// their activations as [m, k] with one row per token of the batch. Batched
+// matmuls read [b, m, k] and [b, k, n]; the second operand of Query*Key and
+// Score*Value is the key or value cache, holding one head per group of query
+// heads with grouped-query attention. Gathers read one index per row of
+// their result after the embedding table.
+static bool iree_hal_pim_instruction_operand_shape(
+    const iree_hal_pim_instruction_t* instruction,
+    iree_host_size_t operand_index, std::vector<int>* out_shape) {
+  switch (instruction->opcode) {
+    case 2:   // QKVGen
+    case 6:   // OutProj
+    case 8:   // FFN1
+    case 9:   // FFN2
+    case 10:  // LMHead
+    case 14:  // FFNGate
+    case 15:  // SwiGLU
+      if (instruction->dim_count != 3 || operand_index != 0) return false;
+      out_shape->assign({instruction->dims[0], instruction->dims[2]});
+      return true;
+    case 3:  // QKMatmul
+    case 5:  // SVMatmul
+      if (instruction->dim_count != 4) return false;
+      if (operand_index == 0) {
+        out_shape->assign(
+            {instruction->dims[0], instruction->dims[1], instruction->dims[3]});
+      } else if (operand_index == 1) {
+        out_shape->assign(
+            {instruction->dims[0], instruction->dims[3], instruction->dims[2]});
+      } else {
+        return false;
+      }
+      return true;
+    case 11:  // Gather
+      if (instruction->dim_count != 2 || operand_index != 1) return false;
+      out_shape->assign({instruction->dims[0]});
+      return true;
+    case 13:  // RoPE
+      if (instruction->dim_count != 3 || operand_index != 0) return false;
+      out_shape->assign(
+          {instruction->dims[0], instruction->dims[1], instruction->dims[2]});
+      return true;
+    case 16:  // GQAQKMatmul
+    case 17:  // GQASVMatmul
+      if (instruction->dim_count != 5 || instruction->dims[4] <= 0) {
+        return false;
+      }
+      if (operand_index == 0) {
+        out_shape->assign(
+            {instruction->dims[0], instruction->dims[1], instruction->dims[3]});
+      } else if (operand_index == 1) {
+        out_shape->assign({instruction->dims[0] / instruction->dims[4],
+                           instruction->dims[3], instruction->dims[2]});
+      } else {
+        return false;
+      }
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Reads operand |operand_index| of the dynamic |instruction| with the shape
+// implied by its resolved dims when |shape| covers the same elements. Caches
+// sized to the current sequence length carry no static shape of their own.
+// The implied shape is derived in |scratch|.
+static void iree_hal_pim_apply_operand_shape(
+    const iree_hal_pim_instruction_t* instruction,
+    iree_host_size_t operand_index, std::vector<int>* scratch,
+    std::vector<int>* shape) {
+  // Softmax normalizes rows of its dynamic length; the scores of a prompt
+  // hold one row per head and query token.
+  if (instruction->opcode == 4 && instruction->dim_count == 1 &&
+      operand_index == 0) {
+    const int64_t length = instruction->dims[0];
+    const int64_t count =
+        iree_hal_pim_element_count(shape->data(), shape->size());
+    if (length > 0 && count % length == 0) {
+      shape->assign({(int)(count / length), (int)length});
+    }
+    return;
+  }
+  if (!iree_hal_pim_instruction_operand_shape(instruction, operand_index,
+                                              scratch)) {
+    return;
+  }
+  if (iree_hal_pim_element_count(scratch->data(), scratch->size()) ==
+      iree_hal_pim_element_count(shape->data(), shape->size())) {
+    shape->assign(scratch->begin(), scratch->end());
+  }
+}
+
+// Resolves the dims of |instruction| provided by the push constants of
+// |dispatch| into |scratch_dims| and returns the instruction using them in
+// |out_instruction|. |out_is_dynamic| is set if any dim was resolved; other
+// instructions are returned as-is.
+static iree_status_t iree_hal_pim_resolve_instruction(
+    const iree_hal_pim_instruction_t* instruction,
+    const iree_hal_pim_dispatch_t* dispatch,
+    std::vector<int32_t>* scratch_dims,
+    iree_hal_pim_instruction_t* out_instruction, bool* out_is_dynamic) {
+  *out_instruction = *instruction;
+  *out_is_dynamic = false;
+  for (iree_host_size_t i = 0; i < instruction->dim_count; ++i) {
+    if (instruction->dims[i] < 0) *out_is_dynamic = true;
+  }
+  if (!*out_is_dynamic) return iree_ok_status();
+  scratch_dims->assign(instruction->dims,
+                       instruction->dims + instruction->dim_count);
+  for (int32_t& dim : *scratch_dims) {
+    if (dim >= 0) continue;
+    const iree_host_size_t ordinal = (iree_host_size_t)(-1 - (int64_t)dim);
+    if (IREE_UNLIKELY(ordinal >= dispatch->constant_count)) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "PIM instruction dim reads push constant %" PRIhsz
+                              " but only %" PRIhsz " are set",
+                              ordinal, dispatch->constant_count);
+    }
+    dim = (int32_t)dispatch->constants[ordinal];
+  }
+  out_instruction->dims = scratch_dims->data();
+  return iree_ok_status();
+}
+
+// Returns true if operand |operand_index| of |instruction| holding a
+// [|rows|, |cols|] matrix is read as one of |shard_count| shards by each PIM
+// module executing the split instruction and the axis it is split along in
+// |out_axis|. Matmuls read [m, k] activations and [k, n] weights: col-wise
+// splits divide k of both and row-wise splits divide n of the weights.
+static bool iree_hal_pim_instruction_operand_shard(
+    const iree_hal_pim_instruction_t* instruction,
+    iree_host_size_t operand_index, int rows, int cols, int32_t shard_count,
+    int* out_axis) {
+  switch (instruction->opcode) {
+    case 2:   // QKVGen
+    case 6:   // OutProj
+    case 8:   // FFN1
+    case 9:   // FFN2
+    case 10:  // LMHead
+    case 14:  // FFNGate
+    case 15:  // SwiGLU
+      break;
+    default:
+      return false;
+  }
+  if (shard_count <= 1 || instruction->dim_count != 3) return false;
+  const int64_t n = instruction->dims[1];
+  const int64_t k = instruction->dims[2];
+  if (instruction->split_type == IREE_HAL_PIM_SPLIT_TYPE_COL_WISE) {
+    if (operand_index == 0 && cols == k * shard_count) {
+      *out_axis = 1;
+      return true;
+    }
+    if (operand_index == 1 && rows == k * shard_count) {
+      *out_axis = 0;
+      return true;
+    }
+  } else if (instruction->split_type == IREE_HAL_PIM_SPLIT_TYPE_ROW_WISE) {
+    if (operand_index == 1 && cols == n * shard_count) {
+      *out_axis = 1;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns in |out_rows| and |out_cols| the [rows, cols] matrix held by operand
+// |operand_index| of |instruction| when its binding has no static shape. The
+// activations of matmuls over a batch sized by a push constant have one row of
+// |byte_length| / m bytes per token. The shape is derived in |scratch|.
+static bool iree_hal_pim_dynamic_operand_matrix(
+    const iree_hal_pim_instruction_t* instruction,
+    iree_host_size_t operand_index, iree_device_size_t byte_length,
+    std::vector<int>* scratch, int* out_rows, int* out_cols) {
+  if (!iree_hal_pim_instruction_operand_shape(instruction, operand_index,
+                                              scratch) ||
+      scratch->size() != 2 || (*scratch)[0] <= 0) {
+    return false;
+  }
+  const iree_device_size_t row_bytes =
+      (iree_device_size_t)(*scratch)[0] * sizeof(float);
+  if (byte_length == 0 || byte_length % row_bytes != 0) return false;
+  *out_rows = (*scratch)[0];
+  *out_cols = (int)(byte_length / row_bytes);
+  return true;
+}
+
+// Uploads shard |shard_index| of |shard_count| along |axis| of the [rows, cols]
+// result at |addr| kept resident on the device as an allocation of its own in
+// |out_addr| with its dims in |shape|. Results change on every dispatch so
+// unlike bindings their shards are not kept. The result and the shard are
+// copied through |scratch_matrix| and |scratch_shard| on the host and profiled
+// with |simulation|.
+static void iree_hal_pim_stage_resident_shard(
+    const iree_hal_pim_sim_params_t* simulation, int addr,
+    std::vector<int>* shape, int axis, int32_t shard_index, int32_t shard_count,
+    std::vector<float>* scratch_matrix, std::vector<float>* scratch_shard,
+    int* out_addr) {
+  const int rows = (*shape)[0];
+  const int cols = (*shape)[1];
+  std::vector<float>& matrix = *scratch_matrix;
+  matrix.resize((iree_host_size_t)rows * cols);
+  iree_hal_pim_sdk_read_buffer(simulation, addr, (int)matrix.size(),
+                               matrix.data());
+  const int shard_rows = axis == 0 ? rows / shard_count : rows;
+  const int shard_cols = axis == 1 ? cols / shard_count : cols;
+  const int row_begin = axis == 0 ? shard_index * shard_rows : 0;
+  const int col_begin = axis == 1 ? shard_index * shard_cols : 0;
+  std::vector<float>& shard = *scratch_shard;
+  shard.resize((iree_host_size_t)shard_rows * shard_cols);
+  for (int r = 0; r < shard_rows; ++r) {
+    memcpy(shard.data() + (iree_host_size_t)r * shard_cols,
+           matrix.data() + (iree_host_size_t)(row_begin + r) * cols + col_begin,
+           shard_cols * sizeof(float));
+  }
+  *out_addr = iree_hal_pim_sdk_alloc_buffer(simulation, (int)shard.size(),
+                                            shard.data());
+  shape->assign({shard_rows, shard_cols});
+}
+
+// Synchronizes the partial result of an instruction at |*addr| with |*shape|
+// across the participants of |sync_channel|. All-reduces sum the partial
+// results of every rank while all-gathers concatenate the slices of each rank
+// along the innermost dimension. The synchronized result replaces |*addr|
+// with a new allocation. Contributions are exchanged through |scratch_send|,
+// |scratch_recv| and |scratch_gather| on the host. Transfers are profiled with
+// |simulation|.
+static iree_status_t iree_hal_pim_sync_result(
+    const iree_hal_pim_sim_params_t* simulation,
+    iree_hal_channel_t* sync_channel, iree_hal_pim_sync_t sync, int* addr,
+    std::vector<int>* shape, std::vector<float>* scratch_send,
+    std::vector<float>* scratch_recv, std::vector<float>* scratch_gather) {
+  int element_count = shape->empty() ? 0 : 1;
+  for (int dim : *shape) element_count *= dim;
+  if (IREE_UNLIKELY(element_count <= 0)) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "PIM SDK returned no result shape to synchronize");
+  }
+  int32_t rank = 0;
+  int32_t count = 0;
+  iree_hal_channel_query_rank_and_count(sync_channel, &rank, &count);
+  (void)rank;
+
+  iree_hal_collective_op_t op;
+  memset(&op, 0, sizeof(op));
+  op.kind = sync == IREE_HAL_PIM_SYNC_ALL_GATHER
+                ? IREE_HAL_COLLECTIVE_KIND_ALL_GATHER
+                : IREE_HAL_COLLECTIVE_KIND_ALL_REDUCE;
+  op.reduction = IREE_HAL_COLLECTIVE_REDUCTION_SUM;
+  op.element_type = IREE_HAL_COLLECTIVE_ELEMENT_TYPE_FLOAT_32;
+
+  std::vector<float>& send_data = *scratch_send;
+  send_data.resize(element_count);
+  iree_hal_pim_sdk_read_buffer(simulation, *addr, element_count,
+                               send_data.data());
+  const iree_host_size_t recv_count =
+      op.kind == IREE_HAL_COLLECTIVE_KIND_ALL_GATHER
+          ? (iree_host_size_t)element_count * count
+          : (iree_host_size_t)element_count;
+  std::vector<float>& recv_data = *scratch_recv;
+  recv_data.resize(recv_count);
+  IREE_RETURN_IF_ERROR(iree_hal_pim_channel_execute_host(
+      sync_channel, op, /*param=*/0, element_count, send_data.data(),
+      recv_data.data()));
+
+  const float* result_data = recv_data.data();
+  if (op.kind == IREE_HAL_COLLECTIVE_KIND_ALL_GATHER) {
+    // Contributions arrive rank-major; interleave them so each row holds the
+    // slices of all ranks in order.
+    const int inner = shape->back();
+    const int outer = element_count / inner;
+    std::vector<float>& gathered = *scratch_gather;
+    gathered.resize(recv_count);
+    for (int r = 0; r < outer; ++r) {
+      for (int32_t p = 0; p < count; ++p) {
+        memcpy(gathered.data() + ((iree_host_size_t)r * count + p) * inner,
+               recv_data.data() + (iree_host_size_t)p * element_count +
+                   (iree_host_size_t)r * inner,
+               inner * sizeof(float));
+      }
+    }
+    result_data = gathered.data();
+    shape->back() *= count;
+  }
+
+  if (iree_hal_pim_sdk_can_free_buffer()) {
+    iree_hal_pim_sdk_free_buffer(*addr);
+  }
+  *addr =
+      iree_hal_pim_sdk_alloc_buffer(simulation, (int)recv_count, result_data);
+  return iree_ok_status();
+}
+
+// Uploads the contents of |binding| holding |element_type| data as a device
+// allocation of their own returned in |out_addr| with |out_element_count|
+// elements. PIM buffers store what the host wrote as raw bytes which the
+// device can only read once uploaded with their element type. The upload is
+// profiled with |simulation|.
+static iree_status_t iree_hal_pim_stage_typed_operand(
+    const iree_hal_pim_sim_params_t* simulation, std::vector<uint8_t>* scratch,
+    const iree_hal_pim_binding_t* binding,
+    iree_hal_pim_element_type_t element_type, int* out_addr,
+    int* out_element_count) {
+  scratch->resize(binding->length);
+  IREE_RETURN_IF_ERROR(iree_hal_pim_buffer_download_range(
+      binding->buffer, binding->offset, scratch->data(), binding->length));
+  *out_element_count = (int)(binding->length /
+                             iree_hal_pim_element_type_byte_size(element_type));
+  *out_addr = iree_hal_pim_sdk_alloc_typed_buffer(
+      simulation, element_type, *out_element_count, scratch->data());
+  return iree_ok_status();
+}
+
+// Stores the f32 result at |addr| with |shape| into |binding| as
+// |element_type| data and releases the device allocation. The readback is
+// profiled with |simulation|.
+static iree_status_t iree_hal_pim_write_typed_result(
+    const iree_hal_pim_sim_params_t* simulation, std::vector<uint8_t>* scratch,
+    const iree_hal_pim_binding_t* binding,
+    iree_hal_pim_element_type_t element_type, int addr,
+    const std::vector<int>& shape) {
+  const int element_count =
+      (int)iree_hal_pim_element_count(shape.data(), shape.size());
+  iree_device_size_t byte_length =
+      (iree_device_size_t)element_count *
+      iree_hal_pim_element_type_byte_size(element_type);
+  scratch->resize(byte_length);
+  iree_hal_pim_sdk_read_typed_buffer(simulation, addr, element_type,
+                                     element_count, scratch->data());
+  if (iree_hal_pim_sdk_can_free_buffer()) iree_hal_pim_sdk_free_buffer(addr);
+  return iree_hal_pim_buffer_upload_range(
+      binding->buffer, binding->offset, scratch->data(),
+      iree_min(byte_length, binding->length));
+}
+
+// Packs the operands of instruction |index| gathered in |addrs| and |shapes|
+// into the fixed-size SDK arguments |out_addrs| and |out_shapes| of
+// IREE_HAL_PIM_MAX_OPERANDS entries each.
+static iree_status_t iree_hal_pim_pack_operands(
+    iree_host_size_t index, const std::vector<int>& addrs,
+    const std::vector<std::vector<int>>& shapes, int32_t* out_addrs,
+    iree_hal_pim_shape_t* out_shapes) {
+  for (size_t j = 0; j < addrs.size(); ++j) {
+    const std::vector<int>& shape = shapes[j];
+    if (IREE_UNLIKELY(shape.size() > IREE_HAL_PIM_MAX_RANK)) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "operand %zu of PIM instruction %" PRIhsz
+                              " has rank %zu but at most %d is supported",
+                              j, index, shape.size(), IREE_HAL_PIM_MAX_RANK);
+    }
+    out_addrs[j] = addrs[j];
+    out_shapes[j].rank = (int32_t)shape.size();
+    for (size_t k = 0; k < shape.size(); ++k) out_shapes[j].dims[k] = shape[k];
+  }
+  return iree_ok_status();
+}
+
+// Resolves binding |slot| of the PIM program of |dispatch| to the range of the
+// dispatch binding it reads or writes. Executables with fused bindings view
+// the tensor of each operand at a byte offset within a dispatch binding
+// (possibly provided by a push constant) that spans the compiled shape of the
+// tensor or the rest of the binding if it has no static shape.
+static iree_status_t iree_hal_pim_resolve_dispatch_binding(
+    const iree_hal_pim_dispatch_t* dispatch, int32_t slot,
+    iree_hal_pim_binding_t* out_binding) {
+  if (!iree_hal_pim_executable_binding_view_count(dispatch->executable,
+                                                  dispatch->entry_point)) {
+    *out_binding = dispatch->bindings[slot];
+    return iree_ok_status();
+  }
+  uint32_t source_ordinal = 0;
+  int32_t byte_offset = 0;
+  iree_hal_pim_executable_binding_view(dispatch->executable,
+                                       dispatch->entry_point,
+                                       (iree_host_size_t)slot, &source_ordinal,
+                                       &byte_offset);
+  if (IREE_UNLIKELY(source_ordinal >= dispatch->binding_count)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "PIM binding %d views binding %u but only %" PRIhsz
+                            " are bound",
+                            slot, source_ordinal, dispatch->binding_count);
+  }
+  iree_device_size_t offset = (iree_device_size_t)byte_offset;
+  if (byte_offset < 0) {
+    iree_host_size_t ordinal = (iree_host_size_t)(-1 - (int64_t)byte_offset);
+    if (IREE_UNLIKELY(ordinal >= dispatch->constant_count)) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "PIM binding %d reads its offset from push "
+                              "constant %" PRIhsz " but only %" PRIhsz
+                              " are set",
+                              slot, ordinal, dispatch->constant_count);
+    }
+    offset = dispatch->constants[ordinal];
+  }
+  const iree_hal_pim_binding_t* source = &dispatch->bindings[source_ordinal];
+  if (IREE_UNLIKELY(offset > source->length)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "PIM binding %d starts at byte %" PRIdsz
+                            " of a binding of %" PRIdsz " bytes",
+                            slot, offset, source->length);
+  }
+  out_binding->buffer = source->buffer;
+  out_binding->offset = source->offset + offset;
+  out_binding->length = source->length - offset;
+  iree_host_size_t rank = 0;
+  const int32_t* dims = iree_hal_pim_executable_binding_shape(
+      dispatch->executable, dispatch->entry_point, (iree_host_size_t)slot,
+      &rank);
+  if (dims) {
+    iree_device_size_t length =
+        (iree_device_size_t)iree_hal_pim_element_count(dims, rank) *
+        iree_hal_pim_element_type_byte_size(
+            iree_hal_pim_executable_binding_element_type(
+                dispatch->executable, dispatch->entry_point,
+                (iree_host_size_t)slot));
+    out_binding->length = iree_min(out_binding->length, length);
+  }
+  return iree_ok_status();
+}
+
+// Executes the PIM program of |dispatch| on the calling thread.
+//
+// Each instruction reads its operand slots and writes its result to the last
+// one. Operands must exist on the device before they are read; subranges are
+// staged into allocations of their own. Result bindings receive a new address
+// from the SDK while the results of intermediate instructions stay resident on
+// the device and are released once the program completes.
+//
+// Bindings the executable declares to hold f16, bf16 or i8 data are uploaded
+// with their element type for each instruction reading them and results
+// (which the SDK produces in f32) are narrowed to the type of their binding.
+//
+// Dims the executable reads from push constants (such as the sequence length
+// of a KV cache during incremental decode or the number of tokens of a batch
+// of sequences decoded together) are resolved before each instruction and its
+// activation and cache operands are read with the shape they imply so that
+// only the cached prefix is used and all tokens share one pass over the
+// weights.
+//
+// Instructions split across PIM modules read the shards of their operands
+// assigned to this module (its rank in |sync_channel|): weight bindings are
+// placed once per module and stay on the device across dispatches. The
+// partial results are then synchronized over |sync_channel| before any later
+// instruction reads them. Without a channel the device has a single module and
+// the partial result is already complete.
+static iree_status_t iree_hal_pim_direct_command_buffer_execute_dispatch(
+    iree_hal_pim_direct_command_buffer_t* command_buffer,
+    iree_hal_channel_t* sync_channel,
+    const iree_hal_pim_dispatch_t* dispatch) {
+  // Operands are gathered in storage reused (including that of the inner shape
+  // vectors) across dispatches and passed to the SDK from the stack.
+  std::vector<int>& addrs = command_buffer->scratch_addrs;
+  std::vector<std::vector<int>>& shapes = command_buffer->scratch_shapes;
+  std::vector<int>& output_shape = command_buffer->scratch_output_shape;
+  std::vector<iree_hal_pim_resident_t>& residents =
+      command_buffer->scratch_residents;
+
+  iree_host_size_t command_count = 0;
+  iree_hal_pim_executable_commands(dispatch->executable,
+                                   dispatch->entry_point, &command_count);
+  const iree_hal_pim_instruction_t* instructions =
+      iree_hal_pim_executable_instructions(dispatch->executable,
+                                           dispatch->entry_point);
+  // Programs of executables with fused bindings address the views of their
+  // entry point instead of the dispatch bindings.
+  const iree_host_size_t view_count =
+      iree_hal_pim_executable_binding_view_count(dispatch->executable,
+                                                 dispatch->entry_point);
+  const iree_host_size_t binding_count =
+      view_count ? view_count : dispatch->binding_count;
+  residents.resize(command_count);
+  int32_t shard_index = 0;
+  int32_t shard_count = 1;
+  if (sync_channel) {
+    iree_hal_channel_query_rank_and_count(sync_channel, &shard_index,
+                                          &shard_count);
+  }
+
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < command_count && iree_status_is_ok(status);
+       ++i) {
+    residents[i].addr = IREE_HAL_PIM_BUFFER_ADDR_NONE;
+    iree_hal_pim_instruction_t instruction;
+    bool is_dynamic = false;
+    status = iree_hal_pim_resolve_instruction(
+        &instructions[i], dispatch, &command_buffer->scratch_dims, &instruction,
+        &is_dynamic);
+    if (!iree_status_is_ok(status)) break;
+    iree_host_size_t slot_count = 0;
+    const int32_t* slots = iree_hal_pim_executable_operand_slots(
+        dispatch->executable, dispatch->entry_point, i, &slot_count);
+    if (!slots) slot_count = binding_count;
+    if (IREE_UNLIKELY(slot_count > IREE_HAL_PIM_MAX_OPERANDS)) {
+      status = iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                                "PIM instruction %" PRIhsz " has %" PRIhsz
+                                " operands but at most %d are supported",
+                                i, slot_count, IREE_HAL_PIM_MAX_OPERANDS);
+      break;
+    }
+    addrs.resize(slot_count);
+    shapes.resize(slot_count);
+    for (iree_host_size_t j = 0; j < slot_count; ++j) {
+      const bool is_result = j + 1 == slot_count;
+      const int32_t slot = slots ? slots[j] : (int32_t)j;
+      if (slot < 0) {
+        if (is_result) {
+          addrs[j] = IREE_HAL_PIM_BUFFER_ADDR_NONE;
+          if (!iree_hal_pim_instruction_result_shape(&instruction,
+                                                     &shapes[j])) {
+            shapes[j].clear();
+          }
+        } else {
+          const iree_hal_pim_resident_t* resident =
+              &residents[-1 - slot];
+          addrs[j] = resident->addr;
+          shapes[j] = resident->shape;
+          int axis = 0;
+          if (shapes[j].size() == 2 &&
+              iree_hal_pim_instruction_operand_shard(
+                  &instruction, j, shapes[j][0], shapes[j][1], shard_count,
+                  &axis)) {
+            iree_hal_pim_stage_resident_shard(
+                command_buffer->simulation, resident->addr, &shapes[j], axis,
+                shard_index, shard_count, &command_buffer->scratch_download,
+                &command_buffer->scratch_upload, &addrs[j]);
+            command_buffer->scratch_staged_addrs.push_back(addrs[j]);
+          }
+        }
+        continue;
+      }
+      if (IREE_UNLIKELY((iree_host_size_t)slot >= binding_count)) {
+        status = iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                                  "PIM instruction %" PRIhsz
+                                  " reads binding %d but only %" PRIhsz
+                                  " are bound",
+                                  i, slot, binding_count);
+        break;
+      }
+      iree_hal_pim_binding_t binding_range;
+      status =
+          iree_hal_pim_resolve_dispatch_binding(dispatch, slot, &binding_range);
+      if (!iree_status_is_ok(status)) break;
+      const iree_hal_pim_binding_t* binding = &binding_range;
+      iree_host_size_t compiled_rank = 0;
+      const int32_t* compiled_dims = iree_hal_pim_executable_binding_shape(
+          dispatch->executable, dispatch->entry_point, (iree_host_size_t)slot,
+          &compiled_rank);
+      const iree_hal_pim_element_type_t binding_type =
+          iree_hal_pim_executable_binding_element_type(
+              dispatch->executable, dispatch->entry_point,
+              (iree_host_size_t)slot);
+      if (!is_result && binding_type != IREE_HAL_PIM_ELEMENT_TYPE_F32) {
+        int element_count = 0;
+        status = iree_hal_pim_stage_typed_operand(
+            command_buffer->simulation, &command_buffer->scratch_bytes,
+            binding, binding_type, &addrs[j], &element_count);
+        if (!iree_status_is_ok(status)) break;
+        command_buffer->scratch_staged_addrs.push_back(addrs[j]);
+        if (compiled_dims &&
+            iree_hal_pim_element_count(compiled_dims, compiled_rank) ==
+                element_count) {
+          shapes[j].assign(compiled_dims, compiled_dims + compiled_rank);
+        } else {
+          shapes[j].assign(1, element_count);
+        }
+        if (is_dynamic) {
+          iree_hal_pim_apply_operand_shape(
+              &instruction, j, &command_buffer->scratch_operand_shape,
+              &shapes[j]);
+        }
+        continue;
+      }
+      // Weights of models evicted to make room for others are swapped back in
+      // before they are read.
+      if (!is_result) {
+        status = iree_hal_pim_allocator_make_resident(
+            binding->buffer->device_allocator, binding->buffer);
+        if (!iree_status_is_ok(status)) break;
+      }
+      // Bindings sized by the batch carry no static shape and are split with
+      // the shape implied by the instruction.
+      int matrix_rows = 0;
+      int matrix_cols = 0;
+      bool is_matrix = false;
+      if (compiled_dims && compiled_rank == 2) {
+        matrix_rows = compiled_dims[0];
+        matrix_cols = compiled_dims[1];
+        is_matrix = true;
+      } else if (is_dynamic && !compiled_dims) {
+        is_matrix = iree_hal_pim_dynamic_operand_matrix(
+            &instruction, j, binding->length,
+            &command_buffer->scratch_operand_shape, &matrix_rows,
+            &matrix_cols);
+      }
+      int axis = 0;
+      if (!is_result && is_matrix &&
+          iree_hal_pim_instruction_operand_shard(
+              &instruction, j, matrix_rows, matrix_cols, shard_count, &axis)) {
+        int shard_dims[2];
+        status = iree_hal_pim_buffer_acquire_shard(
+            binding->buffer, binding->offset,
+            (iree_device_size_t)matrix_rows * matrix_cols * sizeof(float),
+            matrix_rows, matrix_cols, axis, shard_index, shard_count,
+            &addrs[j], shard_dims);
+        if (!iree_status_is_ok(status)) break;
+        shapes[j].assign(shard_dims, shard_dims + 2);
+        continue;
+      }
+      int rank = 0;
+      const int* dims = NULL;
+      if (!is_result) {
+        status = iree_hal_pim_buffer_acquire_range(
+            binding->buffer, binding->offset, binding->length, &addrs[j],
+            &rank, &dims);
+      } else {
+        status = iree_hal_pim_buffer_query_range(
+            binding->buffer, binding->offset, binding->length, &addrs[j],
+            &rank, &dims);
+      }
+      if (!iree_status_is_ok(status)) break;
+      // The compiled result shape doesn't depend on what the result binding
+      // held before.
+      if (is_result &&
+          iree_hal_pim_instruction_result_shape(&instruction, &shapes[j])) {
+        continue;
+      }
+      shapes[j].assign(dims, dims + rank);
+      // Staged uploads are flat; read them with the compiled binding shape
+      // when it covers the same elements.
+      if (compiled_dims &&
+          iree_hal_pim_element_count(compiled_dims, compiled_rank) ==
+              iree_hal_pim_element_count(dims, rank)) {
+        shapes[j].assign(compiled_dims, compiled_dims + compiled_rank);
+      }
+      if (is_dynamic) {
+        iree_hal_pim_apply_operand_shape(
+            &instruction, j, &command_buffer->scratch_operand_shape,
+            &shapes[j]);
+      }
+    }
+    if (!iree_status_is_ok(status)) break;
+
+    int32_t sdk_addrs[IREE_HAL_PIM_MAX_OPERANDS];
+    iree_hal_pim_shape_t sdk_shapes[IREE_HAL_PIM_MAX_OPERANDS];
+    status = iree_hal_pim_pack_operands(i, addrs, shapes, sdk_addrs,
+                                        sdk_shapes);
+    if (!iree_status_is_ok(status)) break;
+    int operand_count = (int)addrs.size();
+    // Elementwise instructions read their program, resident on the device
+    // since the executable was loaded, ahead of the result.
+    if (instruction.program_addr != IREE_HAL_PIM_BUFFER_ADDR_NONE) {
+      if (IREE_UNLIKELY(operand_count + 1 > IREE_HAL_PIM_MAX_OPERANDS)) {
+        status = iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                                  "PIM instruction %" PRIhsz " has %" PRIhsz
+                                  " operands and a program but at most %d "
+                                  "operands are supported",
+                                  i, slot_count, IREE_HAL_PIM_MAX_OPERANDS);
+        break;
+      }
+      sdk_addrs[operand_count] = sdk_addrs[operand_count - 1];
+      sdk_shapes[operand_count] = sdk_shapes[operand_count - 1];
+      sdk_addrs[operand_count - 1] = instruction.program_addr;
+      sdk_shapes[operand_count - 1].rank = 1;
+      sdk_shapes[operand_count - 1].dims[0] =
+          (int32_t)(instruction.dim_count - 1);
+      ++operand_count;
+    }
+    iree_hal_pim_shape_t sdk_output_shape;
+    int return_addr = iree_hal_pim_sdk_dispatch(
+        command_buffer->simulation, command_buffer->stats, instruction.opcode,
+        instruction.element_type, operand_count, sdk_addrs, sdk_shapes,
+        &sdk_output_shape);
+    output_shape.assign(sdk_output_shape.dims,
+                        sdk_output_shape.dims + sdk_output_shape.rank);
+    for (int staged_addr : command_buffer->scratch_staged_addrs) {
+      if (iree_hal_pim_sdk_can_free_buffer()) {
+        iree_hal_pim_sdk_free_buffer(staged_addr);
+      }
+    }
+    command_buffer->scratch_staged_addrs.clear();
+    if (sync_channel && instruction.sync != IREE_HAL_PIM_SYNC_NONE) {
+      status = iree_hal_pim_sync_result(
+          command_buffer->simulation, sync_channel, instruction.sync,
+          &return_addr, &output_shape, &command_buffer->scratch_download,
+          &command_buffer->scratch_upload, &command_buffer->scratch_gather);
+      if (!iree_status_is_ok(status)) break;
+    }
+
+    const int32_t result_slot =
+        slots ? slots[slot_count - 1] : (int32_t)binding_count - 1;
+    if (result_slot < 0) {
+      residents[i].addr = return_addr;
+      residents[i].shape = output_shape;
+      continue;
+    }
+
+    // update hal_PiM_buffer
+    iree_hal_pim_binding_t result_range;
+    status = iree_hal_pim_resolve_dispatch_binding(dispatch, result_slot,
+                                                   &result_range);
+    if (!iree_status_is_ok(status)) break;
+    const iree_hal_pim_binding_t* result = &result_range;
+    const iree_hal_pim_element_type_t result_type =
+        iree_hal_pim_executable_binding_element_type(
+            dispatch->executable, dispatch->entry_point,
+            (iree_host_size_t)result_slot);
+    if (result_type != IREE_HAL_PIM_ELEMENT_TYPE_F32) {
+      status = iree_hal_pim_write_typed_result(
+          command_buffer->simulation, &command_buffer->scratch_bytes, result,
+          result_type, return_addr, output_shape);
+      continue;
+    }
+    int result_capacity = 1;
+    for (int dim : output_shape) result_capacity *= dim;
+    status = iree_hal_pim_buffer_write_range(
+        result->buffer, result->offset, result->length, return_addr,
+        result_capacity, (int)output_shape.size(), output_shape.data());
+  }
+
+  // Staged operands are left over if staging failed part way.
+  for (int staged_addr : command_buffer->scratch_staged_addrs) {
+    if (iree_hal_pim_sdk_can_free_buffer()) {
+      iree_hal_pim_sdk_free_buffer(staged_addr);
+    }
+  }
+  command_buffer->scratch_staged_addrs.clear();
+
+  // Intermediates are never read back by the host.
+  for (iree_host_size_t i = 0; i < command_count; ++i) {
+    if (residents[i].addr == IREE_HAL_PIM_BUFFER_ADDR_NONE) continue;
+    if (iree_hal_pim_sdk_can_free_buffer()) {
+      iree_hal_pim_sdk_free_buffer(residents[i].addr);
+    }
+    residents[i].addr = IREE_HAL_PIM_BUFFER_ADDR_NONE;
+  }
+  return status;
+}
+
+// Hashes |length| bytes of |data| a word at a time with FNV-1a.
+static uint64_t iree_hal_pim_host_binding_hash(
+    const uint8_t* data, iree_host_size_t length) {
+  uint64_t hash = 0xCBF29CE484222325ull;
+  iree_host_size_t i = 0;
+  for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+    uint64_t word = 0;
+    memcpy(&word, data + i, sizeof(word));
+    hash = (hash ^ word) * 0x100000001B3ull;
+  }
+  for (; i < length; ++i) hash = (hash ^ data[i]) * 0x100000001B3ull;
+  return hash;
+}
+
+// Prepares the host fallback executable of |dispatch| for execution in
+// |out_host_dispatch|.
+//
+// Dispatches the PIM backend can't lower (or the layers left to the host with
+// --iree-pim-host-layers) are compiled for the host as well and run against
+// host copies of their bindings: each binding is downloaded, the workgroups
+// are issued one at a time and bindings whose contents changed are uploaded
+// back as new device allocations. Descriptor set layouts carry no access flags
+// on this device so written bindings are found by hashing their contents;
+// unchanged inputs (weights) keep their device allocations and placements.
+// Bindings are passed to the executable in descriptor set order.
+static iree_status_t iree_hal_pim_direct_command_buffer_begin_host_dispatch(
+    iree_hal_pim_direct_command_buffer_t* command_buffer,
+    const iree_hal_pim_dispatch_t* dispatch,
+    iree_hal_pim_host_dispatch_t* out_host_dispatch) {
+  out_host_dispatch->dispatch = dispatch;
+  out_host_dispatch->local_executable =
+      iree_hal_local_executable_cast(dispatch->executable);
+  out_host_dispatch->local_memory = iree_make_byte_span(NULL, 0);
+  const iree_host_size_t binding_count = dispatch->binding_count;
+  if (IREE_UNLIKELY(binding_count > IREE_HAL_LOCAL_BINDING_MASK_BITS)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "host dispatch has %" PRIhsz
+                            " bindings; at most %d are supported",
+                            binding_count,
+                            (int)IREE_HAL_LOCAL_BINDING_MASK_BITS);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  std::vector<std::vector<uint8_t>>& host_bindings =
+      command_buffer->scratch_host_bindings;
+  host_bindings.resize(binding_count);
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < binding_count && iree_status_is_ok(status);
+       ++i) {
+    const iree_hal_pim_binding_t* binding = &dispatch->bindings[i];
+    host_bindings[i].resize((size_t)binding->length);
+    out_host_dispatch->binding_ptrs[i] = host_bindings[i].data();
+    out_host_dispatch->binding_lengths[i] = (size_t)binding->length;
+    if (binding->length == 0) {
+      out_host_dispatch->binding_hashes[i] = 0;
+      continue;
+    }
+    status = iree_hal_pim_buffer_download_range(
+        binding->buffer, binding->offset, host_bindings[i].data(),
+        binding->length);
+    if (iree_status_is_ok(status)) {
+      out_host_dispatch->binding_hashes[i] =
+          iree_hal_pim_host_binding_hash(host_bindings[i].data(),
+                                         host_bindings[i].size());
+    }
+  }
+
+  iree_hal_local_executable_t* local_executable =
+      out_host_dispatch->local_executable;
+  iree_byte_span_t* local_memory = &out_host_dispatch->local_memory;
+  if (iree_status_is_ok(status) && local_executable->dispatch_attrs) {
+    local_memory->data_length =
+        local_executable->dispatch_attrs[dispatch->entry_point]
+            .local_memory_pages *
+        IREE_HAL_WORKGROUP_LOCAL_MEMORY_PAGE_SIZE;
+    if (local_memory->data_length > 0) {
+      status = iree_allocator_malloc(command_buffer->host_allocator,
+                                     local_memory->data_length,
+                                     (void**)&local_memory->data);
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Issues the workgroups of the host dispatch |user_data| (an
+// iree_hal_pim_host_dispatch_t) on the calling thread. Only touches the
+// host copies of the bindings so that it may run on the host worker while the
+// queue thread drives the PIM SDK.
+static iree_status_t iree_hal_pim_direct_command_buffer_run_host_dispatch(
+    void* user_data) {
+  iree_hal_pim_host_dispatch_t* host_dispatch =
+      (iree_hal_pim_host_dispatch_t*)user_data;
+  const iree_hal_pim_dispatch_t* dispatch = host_dispatch->dispatch;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_executable_dispatch_state_v0_t dispatch_state;
+  memset(&dispatch_state, 0, sizeof(dispatch_state));
+  dispatch_state.workgroup_size_x = 1;
+  dispatch_state.workgroup_size_y = 1;
+  dispatch_state.workgroup_size_z = 1;
+  dispatch_state.workgroup_count_x = dispatch->workgroup_count[0];
+  dispatch_state.workgroup_count_y = dispatch->workgroup_count[1];
+  dispatch_state.workgroup_count_z = dispatch->workgroup_count[2];
+  dispatch_state.max_concurrency = 1;
+  dispatch_state.push_constant_count = (uint16_t)dispatch->constant_count;
+  dispatch_state.push_constants = dispatch->constants;
+  dispatch_state.binding_count = (uint8_t)dispatch->binding_count;
+  dispatch_state.binding_ptrs = host_dispatch->binding_ptrs;
+  dispatch_state.binding_lengths = host_dispatch->binding_lengths;
+
+  // Neither the queue thread nor the host worker has a known floating point
+  // state.
+  iree_fpu_state_t fpu_state =
+      iree_fpu_state_push(IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO);
+  iree_status_t status = iree_hal_local_executable_issue_dispatch_inline(
+      host_dispatch->local_executable, dispatch->entry_point, &dispatch_state,
+      /*processor_id=*/0, host_dispatch->local_memory);
+  iree_fpu_state_pop(fpu_state);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Completes |host_dispatch| issued with |status| by uploading the bindings it
+// wrote. Takes ownership of |status|.
+static iree_status_t iree_hal_pim_direct_command_buffer_end_host_dispatch(
+    iree_hal_pim_direct_command_buffer_t* command_buffer,
+    iree_hal_pim_host_dispatch_t* host_dispatch, iree_status_t status) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  const iree_hal_pim_dispatch_t* dispatch = host_dispatch->dispatch;
+  std::vector<std::vector<uint8_t>>& host_bindings =
+      command_buffer->scratch_host_bindings;
+  iree_allocator_free(command_buffer->host_allocator,
+                      host_dispatch->local_memory.data);
+  host_dispatch->local_memory = iree_make_byte_span(NULL, 0);
+
+  for (iree_host_size_t i = 0;
+       i < dispatch->binding_count && iree_status_is_ok(status); ++i) {
+    const iree_hal_pim_binding_t* binding = &dispatch->bindings[i];
+    if (binding->length == 0 ||
+        iree_hal_pim_host_binding_hash(host_bindings[i].data(),
+                                       host_bindings[i].size()) ==
+            host_dispatch->binding_hashes[i]) {
+      continue;
+    }
+    status = iree_hal_pim_buffer_upload_range(binding->buffer, binding->offset,
+                                              host_bindings[i].data(),
+                                              binding->length);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Returns true if |dispatch| may execute while a host dispatch recorded before
+// it runs on the host worker. Only PIM dispatches up to the next barrier do;
+// transfers and collectives may read what the host dispatch writes and host
+// dispatches share its staging storage.
+static bool iree_hal_pim_direct_command_buffer_can_overlap_host(
+    const iree_hal_pim_dispatch_t* dispatch) {
+  return !dispatch->barrier && dispatch->collective_count == 0 &&
+         !dispatch->transfer &&
+         iree_hal_pim_native_executable_isa(dispatch->executable);
+}
+
+iree_status_t iree_hal_pim_direct_command_buffer_execute(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_channel_t* sync_channel, iree_hal_pim_host_worker_t* host_worker) {
+  iree_hal_pim_direct_command_buffer_t* command_buffer =
+      iree_hal_pim_direct_command_buffer_cast(base_command_buffer);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Host dispatches are handed to |host_worker| (if any) and joined before the
+  // first command that can't run alongside them.
+  iree_hal_pim_host_dispatch_t* host_dispatch =
+      &command_buffer->scratch_host_dispatch;
+  bool host_in_flight = false;
+  iree_status_t status = iree_ok_status();
+  const iree_hal_pim_dispatch_t* dispatch = command_buffer->head;
+  for (; dispatch && iree_status_is_ok(status); dispatch = dispatch->next) {
+    if (host_in_flight &&
+        !iree_hal_pim_direct_command_buffer_can_overlap_host(dispatch)) {
+      host_in_flight = false;
+      status = iree_hal_pim_direct_command_buffer_end_host_dispatch(
+          command_buffer, host_dispatch,
+          iree_hal_pim_host_worker_join(host_worker));
+      if (!iree_status_is_ok(status)) break;
+    }
+    if (dispatch->barrier) continue;
+    if (dispatch->collective_count > 0) {
+      status = iree_hal_pim_channel_execute(dispatch->collective_count,
+                                            dispatch->collectives);
+      continue;
+    }
+    if (dispatch->transfer) {
+      status = iree_hal_pim_direct_command_buffer_execute_transfer(
+          dispatch->transfer);
+      continue;
+    }
+    if (IREE_UNLIKELY(dispatch->binding_slots)) {
+      status = iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                                "nested command buffers with indirect "
+                                "bindings must be executed via "
+                                "execute_commands");
+      break;
+    }
+    if (!iree_hal_pim_native_executable_isa(dispatch->executable)) {
+      status = iree_hal_pim_direct_command_buffer_begin_host_dispatch(
+          command_buffer, dispatch, host_dispatch);
+      if (!iree_status_is_ok(status)) {
+        status = iree_hal_pim_direct_command_buffer_end_host_dispatch(
+            command_buffer, host_dispatch, status);
+        break;
+      }
+      // Hand the dispatch to the worker when the next command doesn't need
+      // its result.
+      if (host_worker && dispatch->next &&
+          iree_hal_pim_direct_command_buffer_can_overlap_host(
+              dispatch->next)) {
+        iree_hal_pim_host_worker_launch(
+            host_worker,
+            iree_hal_pim_direct_command_buffer_run_host_dispatch,
+            host_dispatch);
+        host_in_flight = true;
+        continue;
+      }
+      status = iree_hal_pim_direct_command_buffer_end_host_dispatch(
+          command_buffer, host_dispatch,
+          iree_hal_pim_direct_command_buffer_run_host_dispatch(
+              host_dispatch));
+      continue;
+    }
+    status = iree_hal_pim_direct_command_buffer_execute_dispatch(
+        command_buffer, sync_channel, dispatch);
+  }
+  // The worker references the staging storage of the command buffer so it is
+  // always joined, even if a later command failed.
+  if (host_in_flight) {
+    status = iree_status_join(
+        status, iree_hal_pim_direct_command_buffer_end_host_dispatch(
+                    command_buffer, host_dispatch,
+                    iree_hal_pim_host_worker_join(host_worker)));
+  }
+
+  // Peers of the collectives we will never reach would wait for this rank.
+  if (!iree_status_is_ok(status)) {
+    for (; dispatch; dispatch = dispatch->next) {
+      for (iree_host_size_t i = 0; i < dispatch->collective_count; ++i) {
+        iree_hal_pim_channel_abort(dispatch->collectives[i].channel,
+                                   iree_status_clone(status));
+      }
+    }
+  }
+
+  // One-shot command buffers can't be replayed so drop the recorded stream and
+  // the buffer references it holds as soon as it has been issued.
+  if (iree_all_bits_set(command_buffer->base.mode,
+                        IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT)) {
+    iree_hal_pim_direct_command_buffer_reset(command_buffer);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+
+
+static iree_status_t iree_hal_pim_direct_command_buffer_begin(
+    iree_hal_command_buffer_t* base_command_buffer) {
+  iree_hal_pim_direct_command_buffer_t* command_buffer =
+      iree_hal_pim_direct_command_buffer_cast(base_command_buffer);
+
+  iree_hal_pim_direct_command_buffer_reset(command_buffer);
+
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_pim_direct_command_buffer_end(
+    iree_hal_command_buffer_t* base_command_buffer) {
+  iree_hal_pim_direct_command_buffer_t* command_buffer =
+      iree_hal_pim_direct_command_buffer_cast(base_command_buffer);
+
+  IREE_RETURN_IF_ERROR(
+      iree_hal_pim_direct_command_buffer_flush_collectives(command_buffer));
+
+  return iree_ok_status();
+}
+
+static void iree_hal_pim_direct_command_buffer_begin_debug_group(
+    iree_hal_command_buffer_t* base_command_buffer, iree_string_view_t label,
+    iree_hal_label_color_t label_color,
+    const iree_hal_label_location_t* location) {
+  iree_hal_pim_direct_command_buffer_t* command_buffer =
+      iree_hal_pim_direct_command_buffer_cast(base_command_buffer);
+
+  (void)command_buffer;
+}
+
+static void iree_hal_pim_direct_command_buffer_end_debug_group(
+    iree_hal_command_buffer_t* base_command_buffer) {
+  iree_hal_pim_direct_command_buffer_t* command_buffer =
+      iree_hal_pim_direct_command_buffer_cast(base_command_buffer);
+
+  (void)command_buffer;
+}
+
+
+static iree_status_t iree_hal_pim_direct_command_buffer_execution_barrier(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_execution_stage_t source_stage_mask,
+    iree_hal_execution_stage_t target_stage_mask,
+    iree_hal_execution_barrier_flags_t flags,
+    iree_host_size_t memory_barrier_count,
+    const iree_hal_memory_barrier_t* memory_barriers,
+    iree_host_size_t buffer_barrier_count,
+    const iree_hal_buffer_barrier_t* buffer_barriers) {
+  iree_hal_pim_direct_command_buffer_t* command_buffer =
+      iree_hal_pim_direct_command_buffer_cast(base_command_buffer);
+
+  IREE_RETURN_IF_ERROR(
+      iree_hal_pim_direct_command_buffer_flush_collectives(command_buffer));
+
+  // Consecutive barriers order nothing more than the first.
+  if (!command_buffer->tail || command_buffer->tail->barrier) {
+    return iree_ok_status();
+  }
+  iree_hal_pim_dispatch_t* command = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_pim_direct_command_buffer_append_command(
+      command_buffer, &command));
+  command->barrier = true;
+
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_pim_direct_command_buffer_signal_event(
+    iree_hal_command_buffer_t* base_command_buffer, iree_hal_event_t* event,
+    iree_hal_execution_stage_t source_stage_mask) {
+  iree_hal_pim_direct_command_buffer_t* command_buffer =
+      iree_hal_pim_direct_command_buffer_cast(base_command_buffer);
+
+  (void)command_buffer;
+
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_pim_direct_command_buffer_reset_event(
+    iree_hal_command_buffer_t* base_command_buffer, iree_hal_event_t* event,
+    iree_hal_execution_stage_t source_stage_mask) {
+  iree_hal_pim_direct_command_buffer_t* command_buffer =
+      iree_hal_pim_direct_command_buffer_cast(base_command_buffer);
+
+  (void)command_buffer;
+
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_pim_direct_command_buffer_wait_events(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_host_size_t event_count, const iree_hal_event_t** events,
+    iree_hal_execution_stage_t source_stage_mask,
+    iree_hal_execution_stage_t target_stage_mask,
+    iree_host_size_t memory_barrier_count,
+    const iree_hal_memory_barrier_t* memory_barriers,
+    iree_host_size_t buffer_barrier_count,
+    const iree_hal_buffer_barrier_t* buffer_barriers) {
+  iree_hal_pim_direct_command_buffer_t* command_buffer =
+      iree_hal_pim_direct_command_buffer_cast(base_command_buffer);
+
+  (void)command_buffer;
+
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_pim_direct_command_buffer_discard_buffer(
+    iree_hal_command_buffer_t* base_command_buffer, iree_hal_buffer_t* buffer) {
+  // NOTE: we could use this to prevent queue family transitions.
+  return iree_ok_status();
+}
+
+
+// Resolves the range [|offset|, |offset| + |length|) of |buffer| (which may
+// be a subspan) to a range of its allocated buffer.
+static void iree_hal_pim_direct_command_buffer_resolve_binding(
+    iree_hal_buffer_t* buffer, iree_device_size_t offset,
+    iree_device_size_t length, iree_hal_pim_binding_t* out_binding) {
+  iree_device_size_t byte_length = iree_hal_buffer_byte_length(buffer);
+  offset = iree_min(offset, byte_length);
+  if (length == IREE_WHOLE_BUFFER || length > byte_length - offset) {
+    length = byte_length - offset;
+  }
+  out_binding->buffer = iree_hal_buffer_allocated_buffer(buffer);
+  out_binding->offset = iree_hal_buffer_byte_offset(buffer) + offset;
+  out_binding->length = length;
+}
+
+// Appends a transfer command writing |length| bytes to |target_buffer|.
+// The target (and |source_buffer| if any) are retained by the command buffer.
+static iree_status_t iree_hal_pim_direct_command_buffer_append_transfer(
+    iree_hal_pim_direct_command_buffer_t* command_buffer,
+    iree_hal_buffer_t* source_buffer, iree_device_size_t source_offset,
+    iree_hal_buffer_t* target_buffer, iree_device_size_t target_offset,
+    iree_device_size_t length, iree_hal_pim_transfer_t** out_transfer) {
+  *out_transfer = NULL;
+  if (!iree_hal_pim_buffer_isa(
+          iree_hal_buffer_allocated_buffer(target_buffer)) ||
+      (source_buffer && !iree_hal_pim_buffer_isa(
+                            iree_hal_buffer_allocated_buffer(source_buffer)))) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "PIM transfers require buffers allocated from a "
+                            "PIM device");
+  }
+
+  // Transfers are ordered with respect to preceding collectives.
+  IREE_RETURN_IF_ERROR(
+      iree_hal_pim_direct_command_buffer_flush_collectives(command_buffer));
+  IREE_RETURN_IF_ERROR(
+      iree_hal_pim_direct_command_buffer_ensure_resource_set(
+          command_buffer));
+  IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
+      command_buffer->resource_set, 1, &target_buffer));
+  if (source_buffer) {
+    IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
+        command_buffer->resource_set, 1, &source_buffer));
+  }
+
+  iree_hal_pim_transfer_t* transfer = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(
+      &command_buffer->arena, sizeof(*transfer), (void**)&transfer));
+  memset(transfer, 0, sizeof(*transfer));
+  iree_hal_pim_direct_command_buffer_resolve_binding(
+      target_buffer, target_offset, length, &transfer->target);
+  if (source_buffer) {
+    iree_hal_pim_direct_command_buffer_resolve_binding(
+        source_buffer, source_offset, transfer->target.length,
+        &transfer->source);
+  }
+
+  iree_hal_pim_dispatch_t* command = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_pim_direct_command_buffer_append_command(
+      command_buffer, &command));
+  command->transfer = transfer;
+  *out_transfer = transfer;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_pim_direct_command_buffer_fill_buffer(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_buffer_t* target_buffer, iree_device_size_t target_offset,
+    iree_device_size_t length, const void* pattern,
+    iree_host_size_t pattern_length) {
+  iree_hal_pim_direct_command_buffer_t* command_buffer =
+      iree_hal_pim_direct_command_buffer_cast(base_command_buffer);
+
+  iree_hal_pim_transfer_t* transfer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_pim_direct_command_buffer_append_transfer(
+      command_buffer, /*source_buffer=*/NULL, /*source_offset=*/0,
+      target_buffer, target_offset, length, &transfer));
+
+  void* pattern_data = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
+                                           pattern_length, &pattern_data));
+  memcpy(pattern_data, pattern, pattern_length);
+  transfer->source_data = pattern_data;
+  transfer->pattern_length = pattern_length;
+
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_pim_direct_command_buffer_update_buffer(
+    iree_hal_command_buffer_t* base_command_buffer, const void* source_buffer,
+    iree_host_size_t source_offset, iree_hal_buffer_t* target_buffer,
+    iree_device_size_t target_offset, iree_device_size_t length) {
+  iree_hal_pim_direct_command_buffer_t* command_buffer =
+      iree_hal_pim_direct_command_buffer_cast(base_command_buffer);
+
+  iree_hal_pim_transfer_t* transfer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_pim_direct_command_buffer_append_transfer(
+      command_buffer, /*source_buffer=*/NULL, /*source_offset=*/0,
+      target_buffer, target_offset, length, &transfer));
+
+  // The source may be released as soon as recording returns.
+  void* source_data = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(
+      &command_buffer->arena, transfer->target.length, &source_data));
+  memcpy(source_data, (const uint8_t*)source_buffer + source_offset,
+         transfer->target.length);
+  transfer->source_data = source_data;
+
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_pim_direct_command_buffer_copy_buffer(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_buffer_t* source_buffer, iree_device_size_t source_offset,
+    iree_hal_buffer_t* target_buffer, iree_device_size_t target_offset,
+    iree_device_size_t length) {
+  iree_hal_pim_direct_command_buffer_t* command_buffer =
+      iree_hal_pim_direct_command_buffer_cast(base_command_buffer);
+
+  iree_hal_pim_transfer_t* transfer = NULL;
+  return iree_hal_pim_direct_command_buffer_append_transfer(
+      command_buffer, source_buffer, source_offset, target_buffer,
+      target_offset, length, &transfer);
+}
+
+static iree_status_t iree_hal_pim_direct_command_buffer_collective(
+    iree_hal_command_buffer_t* base_command_buffer, iree_hal_channel_t* channel,
+    iree_hal_collective_op_t op, uint32_t param,
+    iree_hal_buffer_binding_t send_binding,
+    iree_hal_buffer_binding_t recv_binding, iree_device_size_t element_count) {
+  iree_hal_pim_direct_command_buffer_t* command_buffer =
+      iree_hal_pim_direct_command_buffer_cast(base_command_buffer);
+  IREE_RETURN_IF_ERROR(
+      iree_hal_pim_direct_command_buffer_ensure_resource_set(
+          command_buffer));
+  return iree_hal_collective_batch_append(&command_buffer->collective_batch,
+                                          channel, op, param, send_binding,
+                                          recv_binding, element_count);
+}
+
+static iree_status_t iree_hal_pim_direct_command_buffer_push_constants(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_pipeline_layout_t* pipeline_layout, iree_host_size_t offset,
+    const void* values, iree_host_size_t values_length) {
+  iree_hal_pim_direct_command_buffer_t* command_buffer =
+      iree_hal_pim_direct_command_buffer_cast(base_command_buffer);
+
+  if (IREE_UNLIKELY((offset % sizeof(uint32_t)) != 0 ||
+                    (values_length % sizeof(uint32_t)) != 0)) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "push constants must be 4-byte aligned (offset %" PRIhsz
+        ", length %" PRIhsz ")",
+        offset, values_length);
+  }
+
+  // Dispatches recorded earlier keep referencing the previous constants so
+  // each push captures a copy of all of them.
+  const iree_host_size_t first = offset / sizeof(uint32_t);
+  const iree_host_size_t count =
+      iree_max(command_buffer->constant_count,
+               first + values_length / sizeof(uint32_t));
+  uint32_t* constants = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(
+      &command_buffer->arena, count * sizeof(*constants), (void**)&constants));
+  memset(constants, 0, count * sizeof(*constants));
+  if (command_buffer->constant_count > 0) {
+    memcpy(constants, command_buffer->constants,
+           command_buffer->constant_count * sizeof(*constants));
+  }
+  memcpy(constants + first, values, values_length);
+  command_buffer->constant_count = count;
+  command_buffer->constants = constants;
+
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_pim_direct_command_buffer_push_descriptor_set(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_pipeline_layout_t* pipeline_layout, uint32_t set,
+    iree_host_size_t binding_count,
+    const iree_hal_descriptor_set_binding_t* bindings) {
+  iree_hal_pim_direct_command_buffer_t* command_buffer =
+      iree_hal_pim_direct_command_buffer_cast(base_command_buffer);
+
+  // The table is shared by all dispatches until the next push so it only
+  // needs to be captured (and its buffers retained) once.
+  IREE_RETURN_IF_ERROR(
+      iree_hal_pim_direct_command_buffer_ensure_resource_set(
+          command_buffer));
+  iree_hal_pim_binding_t* table = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(
+      &command_buffer->arena, binding_count * sizeof(*table), (void**)&table));
+  uint32_t* slots = NULL;
+  for (iree_host_size_t i = 0; i < binding_count; ++i) {
+    if (bindings[i].buffer) {
+      IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
+          command_buffer->resource_set, 1, &bindings[i].buffer));
+      iree_hal_pim_direct_command_buffer_resolve_binding(
+          bindings[i].buffer, bindings[i].offset, bindings[i].length,
+          &table[i]);
+      continue;
+    }
+    // Indirect binding sourced from the binding table at execution time. The
+    // offset is relative to the table binding until then.
+    table[i].buffer = NULL;
+    table[i].offset = bindings[i].offset;
+    table[i].length = bindings[i].length;
+    if (bindings[i].buffer_slot >= command_buffer->base.binding_capacity) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "binding table slot %u out of range of the "
+                              "command buffer capacity %u",
+                              (uint32_t)bindings[i].buffer_slot,
+                              command_buffer->base.binding_capacity);
+    }
+    if (!slots) {
+      IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
+                                               binding_count * sizeof(*slots),
+                                               (void**)&slots));
+      memset(slots, 0, binding_count * sizeof(*slots));
+    }
+    slots[i] = bindings[i].buffer_slot;
+  }
+  command_buffer->binding_count = binding_count;
+  command_buffer->bindings = table;
+  command_buffer->binding_slots = slots;
+
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_pim_direct_command_buffer_dispatch(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_executable_t* executable, int32_t entry_point,
+    uint32_t workgroup_x, uint32_t workgroup_y, uint32_t workgroup_z) {
+  iree_hal_pim_direct_command_buffer_t* command_buffer =
+      iree_hal_pim_direct_command_buffer_cast(base_command_buffer);
+
+  // Collectives recorded before this dispatch must complete first.
+  IREE_RETURN_IF_ERROR(
+      iree_hal_pim_direct_command_buffer_flush_collectives(command_buffer));
+
+  // Host fallback executables are run on the host when executed.
+  const bool is_host = !iree_hal_pim_native_executable_isa(executable);
+
+  // PiM execution information decoded when the executable was loaded.
+  iree_host_size_t command_count = 0;
+  if (!is_host) {
+    if (IREE_UNLIKELY(entry_point < 0 ||
+                      (iree_host_size_t)entry_point >=
+                          iree_hal_pim_executable_entry_point_count(
+                              executable))) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "PIM executable has no entry point %d",
+                              entry_point);
+    }
+    iree_hal_pim_executable_commands(executable, entry_point, &command_count);
+
+    // if there is no device_code, than skip dispatch
+    if (command_count == 0) {
+      return iree_ok_status();
+    }
+  }
+
+  if (!is_host && command_buffer->binding_count == 0) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "PIM dispatch requires bound buffers");
+  }
+
+  // The program is read from the executable when the dispatch executes.
+  IREE_RETURN_IF_ERROR(
+      iree_hal_pim_direct_command_buffer_ensure_resource_set(
+          command_buffer));
+  IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
+      command_buffer->resource_set, 1, &executable));
+  iree_hal_pim_dispatch_t* dispatch = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_pim_direct_command_buffer_append_command(
+      command_buffer, &dispatch));
+  dispatch->executable = executable;
+  dispatch->entry_point = entry_point;
+  dispatch->workgroup_count[0] = workgroup_x;
+  dispatch->workgroup_count[1] = workgroup_y;
+  dispatch->workgroup_count[2] = workgroup_z;
+  dispatch->binding_count = command_buffer->binding_count;
+  dispatch->bindings = command_buffer->bindings;
+  dispatch->binding_slots = command_buffer->binding_slots;
+  dispatch->constant_count = command_buffer->constant_count;
+  dispatch->constants = command_buffer->constants;
+
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_pim_direct_command_buffer_dispatch_indirect(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_executable_t* executable, int32_t entry_point,
+    iree_hal_buffer_t* workgroups_buffer,
+    iree_device_size_t workgroups_offset) {
+  iree_hal_pim_direct_command_buffer_t* command_buffer =
+      iree_hal_pim_direct_command_buffer_cast(base_command_buffer);
+
+  (void)command_buffer;
+
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_pim_direct_command_buffer_execute_commands(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_command_buffer_t* base_commands,
+    iree_hal_buffer_binding_table_t binding_table) {
+  iree_hal_pim_direct_command_buffer_t* command_buffer =
+      iree_hal_pim_direct_command_buffer_cast(base_command_buffer);
+  if (!iree_hal_pim_direct_command_buffer_isa(base_commands)) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "nested command buffers must be PIM command "
+                            "buffers");
+  }
+  iree_hal_pim_direct_command_buffer_t* commands =
+      iree_hal_pim_direct_command_buffer_cast(base_commands);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_pim_direct_command_buffer_flush_collectives(
+              command_buffer));
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_pim_direct_command_buffer_ensure_resource_set(
+              command_buffer));
+
+  // The nested command buffer owns the storage of the commands we reference
+  // (and retains their direct bindings) so it must outlive this one.
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_resource_set_insert(command_buffer->resource_set, 1,
+                                       &base_commands));
+
+  // Splice the nested commands into this command stream. Only binding tables
+  // with indirect bindings need to be copied; the rest are shared as-is.
+  const iree_hal_pim_binding_t* last_nested_table = NULL;
+  const iree_hal_pim_binding_t* last_resolved_table = NULL;
+  for (const iree_hal_pim_dispatch_t* nested = commands->head; nested;
+       nested = nested->next) {
+    iree_hal_pim_dispatch_t* dispatch = NULL;
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_hal_pim_direct_command_buffer_append_command(
+                command_buffer, &dispatch));
+    dispatch->executable = nested->executable;
+    dispatch->entry_point = nested->entry_point;
+    memcpy(dispatch->workgroup_count, nested->workgroup_count,
+           sizeof(dispatch->workgroup_count));
+    dispatch->binding_count = nested->binding_count;
+    dispatch->bindings = nested->bindings;
+    dispatch->constant_count = nested->constant_count;
+    dispatch->constants = nested->constants;
+    dispatch->collective_count = nested->collective_count;
+    dispatch->collectives = nested->collectives;
+    dispatch->transfer = nested->transfer;
+    dispatch->barrier = nested->barrier;
+    if (!nested->binding_slots) continue;
+
+    // Consecutive dispatches using the same descriptor set share the
+    // resolved table.
+    if (nested->bindings == last_nested_table) {
+      dispatch->bindings = last_resolved_table;
+      continue;
+    }
+    iree_hal_pim_binding_t* table = NULL;
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_arena_allocate(&command_buffer->arena,
+                                nested->binding_count * sizeof(*table),
+                                (void**)&table));
+    for (iree_host_size_t i = 0; i < nested->binding_count; ++i) {
+      table[i] = nested->bindings[i];
+      if (table[i].buffer) continue;
+      uint32_t slot = nested->binding_slots[i];
+      if (slot >= binding_table.count || !binding_table.bindings[slot].buffer) {
+        IREE_TRACE_ZONE_END(z0);
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "binding table slot %u is not bound", slot);
+      }
+      const iree_hal_buffer_binding_t* slot_binding =
+          &binding_table.bindings[slot];
+      IREE_RETURN_AND_END_ZONE_IF_ERROR(
+          z0, iree_hal_resource_set_insert(command_buffer->resource_set, 1,
+                                           &slot_binding->buffer));
+      // The descriptor range is relative to the table binding range.
+      iree_device_size_t slot_length = slot_binding->length;
+      iree_device_size_t length = nested->bindings[i].length;
+      if (slot_length != IREE_WHOLE_BUFFER) {
+        slot_length = slot_length > nested->bindings[i].offset
+                          ? slot_length - nested->bindings[i].offset
+                          : 0;
+        if (length == IREE_WHOLE_BUFFER || length > slot_length) {
+          length = slot_length;
+        }
+      }
+      iree_hal_pim_direct_command_buffer_resolve_binding(
+          slot_binding->buffer,
+          slot_binding->offset + nested->bindings[i].offset, length, &table[i]);
+    }
+    dispatch->bindings = table;
+    last_nested_table = nested->bindings;
+    last_resolved_table = table;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+namespace {
+const iree_hal_command_buffer_vtable_t
+    iree_hal_pim_direct_command_buffer_vtable = {
+        /*.destroy=*/iree_hal_pim_direct_command_buffer_destroy,
+        /*.dyn_cast=*/iree_hal_pim_direct_command_buffer_dyn_cast,
+        /*.begin=*/iree_hal_pim_direct_command_buffer_begin,
+        /*.end=*/iree_hal_pim_direct_command_buffer_end,
+        /*.begin_debug_group=*/
+        iree_hal_pim_direct_command_buffer_begin_debug_group,
+        /*.end_debug_group=*/
+        iree_hal_pim_direct_command_buffer_end_debug_group,
+        /*.execution_barrier=*/
+        iree_hal_pim_direct_command_buffer_execution_barrier,
+        /*.signal_event=*/
+        iree_hal_pim_direct_command_buffer_signal_event,
+        /*.reset_event=*/iree_hal_pim_direct_command_buffer_reset_event,
+        /*.wait_events=*/iree_hal_pim_direct_command_buffer_wait_events,
+        /*.discard_buffer=*/
+        iree_hal_pim_direct_command_buffer_discard_buffer,
+        /*.fill_buffer=*/iree_hal_pim_direct_command_buffer_fill_buffer,
+        /*.update_buffer=*/
+        iree_hal_pim_direct_command_buffer_update_buffer,
+        /*.copy_buffer=*/iree_hal_pim_direct_command_buffer_copy_buffer,
+        /*.collective=*/
+        iree_hal_pim_direct_command_buffer_collective,
+        /*.push_constants=*/
+        iree_hal_pim_direct_command_buffer_push_constants,
+        /*.push_descriptor_set=*/
+        iree_hal_pim_direct_command_buffer_push_descriptor_set,
+        /*.dispatch=*/iree_hal_pim_direct_command_buffer_dispatch,
+        /*.dispatch_indirect=*/
+        iree_hal_pim_direct_command_buffer_dispatch_indirect,
+        /*.execute_commands=*/
+        iree_hal_pim_direct_command_buffer_execute_commands,
+};
+}  // namespace
@@ -0,0 +1,61 @@
+// Copyright 2019 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_PIM_DIRECT_COMMAND_BUFFER_H_
+#define IREE_HAL_DRIVERS_PIM_DIRECT_COMMAND_BUFFER_H_
+
+#include "iree/base/api.h"
+#include "iree/base/internal/arena.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/pim/PIM_host_worker.h"
+#include "iree/hal/drivers/pim/PIM_profiling.h"
+#include "iree/hal/drivers/pim/handle_util.h"
+#include "iree/hal/drivers/pim/tracing.h"
+#include "iree/hal/drivers/pim/util/pim_sim_model.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Creates a PIM command buffer. |block_pool| is used for transient recording
+// storage and must remain valid for the lifetime of the command buffer.
+// Dispatches are modeled with |simulation| if not NULL (see
+// iree_hal_pim_sdk_dispatch) and accumulated into the device counters in
+// |stats| if not NULL; both must outlive the command buffer.
+iree_status_t iree_hal_pim_direct_command_buffer_allocate(
+    iree_hal_device_t* device,
+    iree_allocator_t host_allocator, iree_hal_allocator_t* device_allocator,
+    iree_arena_block_pool_t* block_pool,
+    const iree_hal_pim_sim_params_t* simulation, iree_hal_pim_stats_t* stats,
+    iree_hal_command_buffer_mode_t mode,
+    iree_hal_command_category_t command_categories,
+    iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
+    iree_hal_command_buffer_t** out_command_buffer);
+
+// Returns the native Vulkan VkCommandBuffer handle.
+VkCommandBuffer iree_hal_pim_direct_command_buffer_handle(
+    iree_hal_command_buffer_t* command_buffer);
+
+// Replays all dispatches recorded in |command_buffer| against the PIM SDK.
+// Must only be called from the device queue once all waits have resolved.
+// |sync_channel| is the optional channel of the queue that dispatches split
+// across PIM modules synchronize their partial results over.
+// |host_worker| is the optional worker of the queue that host fallback
+// dispatches run on while the PIM dispatches recorded with them up to the
+// next execution barrier execute. Without one they run inline.
+iree_status_t iree_hal_pim_direct_command_buffer_execute(
+    iree_hal_command_buffer_t* command_buffer, iree_hal_channel_t* sync_channel,
+    iree_hal_pim_host_worker_t* host_worker);
+
+// Returns true if |command_buffer| is a Vulkan command buffer.
+bool iree_hal_pim_direct_command_buffer_isa(
+    iree_hal_command_buffer_t* command_buffer);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_PIM_DIRECT_COMMAND_BUFFER_H_
@@ -23,12 +23,12 @@
 //
 // requirement is one of REQUIRED, OPTIONAL, or EXCLUDED.
 
-#ifndef IREE_HAL_DRIVERS_VULKAN_DYNAMIC_SYMBOL_TABLES_H_
-#define IREE_HAL_DRIVERS_VULKAN_DYNAMIC_SYMBOL_TABLES_H_
+#ifndef IREE_HAL_DRIVERS_PIM_DYNAMIC_SYMBOL_TABLES_H_
+#define IREE_HAL_DRIVERS_PIM_DYNAMIC_SYMBOL_TABLES_H_
 
 namespace iree {
 namespace hal {
-namespace vulkan {
+namespace pim {
 
 // Defines the list of symbols that can be queried from vkGetInstanceProcAddr
 // before Vulkan instance creation.
@@ -494,8 +494,8 @@ namespace vulkan {
   IREE_VULKAN_DYNAMIC_SYMBOL_COMMON_TABLE(INS_PFN, DEV_PFN) \
   IREE_VULKAN_DYNAMIC_SYMBOL_PLATFORM_TABLES(INS_PFN, DEV_PFN)
 
-}  // namespace vulkan
+}  // namespace pim
 }  // namespace hal
 }  // namespace iree
 
-#endif  // IREE_HAL_DRIVERS_VULKAN_DYNAMIC_SYMBOL_TABLES_H_
+#endif  // IREE_HAL_DRIVERS_PIM_DYNAMIC_SYMBOL_TABLES_H_
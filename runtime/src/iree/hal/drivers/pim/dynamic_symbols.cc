@@ -4,7 +4,7 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
-#include "iree/hal/drivers/vulkan/dynamic_symbols.h"
+#include "iree/hal/drivers/pim/dynamic_symbols.h"
 
 #include <cstddef>
 #include <cstdint>
@@ -13,11 +13,11 @@
 #include "iree/base/api.h"
 #include "iree/base/target_platform.h"
 #include "iree/base/tracing.h"
-#include "iree/hal/drivers/vulkan/dynamic_symbol_tables.h"
+#include "iree/hal/drivers/pim/dynamic_symbol_tables.h"
 
 namespace iree {
 namespace hal {
-namespace vulkan {
+namespace pim {
 
 // Read-only table of function pointer information designed to be in .rdata.
 // To reduce binary size this structure is packed (knowing that we won't have
@@ -260,6 +260,6 @@ void DynamicSymbols::FixupExtensionFunctions() {
                                 : this->vkSignalSemaphoreKHR;
 }
 
-}  // namespace vulkan
+}  // namespace pim
 }  // namespace hal
 }  // namespace iree
@@ -4,11 +4,11 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
-#ifndef IREE_HAL_DRIVERS_VULKAN_DYNAMIC_SYMBOLS_H_
-#define IREE_HAL_DRIVERS_VULKAN_DYNAMIC_SYMBOLS_H_
+#ifndef IREE_HAL_DRIVERS_PIM_DYNAMIC_SYMBOLS_H_
+#define IREE_HAL_DRIVERS_PIM_DYNAMIC_SYMBOLS_H_
 
 // clang-format off: must be included before all other headers.
-#include "iree/hal/drivers/vulkan/vulkan_headers.h"  // IWYU pragma: export
+#include "iree/hal/drivers/pim/vulkan_headers.h"  // IWYU pragma: export
 // clang-format on
 
 #include <cstdint>
@@ -17,12 +17,12 @@
 
 #include "iree/base/api.h"
 #include "iree/base/internal/dynamic_library.h"
-#include "iree/hal/drivers/vulkan/dynamic_symbol_tables.h"  // IWYU pragma: export
-#include "iree/hal/drivers/vulkan/util/ref_ptr.h"
+#include "iree/hal/drivers/pim/dynamic_symbol_tables.h"  // IWYU pragma: export
+#include "iree/hal/drivers/pim/util/ref_ptr.h"
 
 namespace iree {
 namespace hal {
-namespace vulkan {
+namespace pim {
 
 struct FunctionPtrInfo;
 
@@ -120,8 +120,8 @@ struct DynamicSymbols : public RefObject<DynamicSymbols> {
   iree_dynamic_library_t* loader_library_ = nullptr;
 };
 
-}  // namespace vulkan
+}  // namespace pim
 }  // namespace hal
 }  // namespace iree
 
-#endif  // IREE_HAL_DRIVERS_VULKAN_DYNAMIC_SYMBOLS_H_
+#endif  // IREE_HAL_DRIVERS_PIM_DYNAMIC_SYMBOLS_H_
@@ -4,7 +4,7 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
-#include "iree/hal/drivers/vulkan/dynamic_symbols.h"
+#include "iree/hal/drivers/pim/dynamic_symbols.h"
 
 #include "iree/base/api.h"
 #include "iree/testing/gtest.h"
@@ -12,7 +12,7 @@
 
 namespace iree {
 namespace hal {
-namespace vulkan {
+namespace pim {
 namespace {
 
 VkApplicationInfo GetApplicationInfo() {
@@ -41,7 +41,7 @@ VkInstanceCreateInfo GetInstanceCreateInfo(VkApplicationInfo* app_info) {
 }
 
 TEST(DynamicSymbolsTest, CreateFromSystemLoader) {
-  iree::ref_ptr<iree::hal::vulkan::DynamicSymbols> syms;
+  iree::ref_ptr<iree::hal::pim::DynamicSymbols> syms;
   IREE_ASSERT_OK(DynamicSymbols::CreateFromSystemLoader(&syms));
 
   // Create and destroy a VkInstance using the symbols. This is mainly testing
@@ -58,6 +58,6 @@ TEST(DynamicSymbolsTest, CreateFromSystemLoader) {
 }
 
 }  // namespace
-}  // namespace vulkan
+}  // namespace pim
 }  // namespace hal
 }  // namespace iree
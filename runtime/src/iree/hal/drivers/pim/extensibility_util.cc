@@ -4,17 +4,17 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
-#include "iree/hal/drivers/vulkan/extensibility_util.h"
+#include "iree/hal/drivers/pim/extensibility_util.h"
 
 #include <cstdint>
 #include <cstring>
 
-#include "iree/hal/drivers/vulkan/status_util.h"
+#include "iree/hal/drivers/pim/status_util.h"
 
 // Returns true if |layers| contains a layer matching |layer_name|.
-static bool iree_hal_vulkan_layer_list_contains(uint32_t layer_count,
-                                                const VkLayerProperties* layers,
-                                                const char* layer_name) {
+static bool iree_hal_pim_layer_list_contains(uint32_t layer_count,
+                                             const VkLayerProperties* layers,
+                                             const char* layer_name) {
   for (uint32_t i = 0; i < layer_count; ++i) {
     if (strcmp(layer_name, layers[i].layerName) == 0) {
       return true;
@@ -23,20 +23,20 @@ static bool iree_hal_vulkan_layer_list_contains(uint32_t layer_count,
   return false;
 }
 
-static iree_status_t iree_hal_vulkan_match_available_layers(
+static iree_status_t iree_hal_pim_match_available_layers(
     iree_host_size_t available_layers_count,
     const VkLayerProperties* available_layers,
-    const iree_hal_vulkan_string_list_t* required_layers,
-    const iree_hal_vulkan_string_list_t* optional_layers,
-    iree_hal_vulkan_string_list_t* out_enabled_layers) {
+    const iree_hal_pim_string_list_t* required_layers,
+    const iree_hal_pim_string_list_t* optional_layers,
+    iree_hal_pim_string_list_t* out_enabled_layers) {
   memset(out_enabled_layers->values, 0,
          (required_layers->count + optional_layers->count) *
              sizeof(out_enabled_layers->values[0]));
 
   for (iree_host_size_t i = 0; i < required_layers->count; ++i) {
     const char* layer_name = required_layers->values[i];
-    if (!iree_hal_vulkan_layer_list_contains(available_layers_count,
-                                             available_layers, layer_name)) {
+    if (!iree_hal_pim_layer_list_contains(available_layers_count,
+                                          available_layers, layer_name)) {
       return iree_make_status(IREE_STATUS_UNAVAILABLE,
                               "required layer %s not available", layer_name);
     }
@@ -45,8 +45,8 @@ static iree_status_t iree_hal_vulkan_match_available_layers(
 
   for (iree_host_size_t i = 0; i < optional_layers->count; ++i) {
     const char* layer_name = optional_layers->values[i];
-    if (iree_hal_vulkan_layer_list_contains(available_layers_count,
-                                            available_layers, layer_name)) {
+    if (iree_hal_pim_layer_list_contains(available_layers_count,
+                                         available_layers, layer_name)) {
       out_enabled_layers->values[out_enabled_layers->count++] = layer_name;
     }
   }
@@ -54,11 +54,11 @@ static iree_status_t iree_hal_vulkan_match_available_layers(
   return iree_ok_status();
 }
 
-iree_status_t iree_hal_vulkan_match_available_instance_layers(
-    const iree::hal::vulkan::DynamicSymbols* syms,
-    const iree_hal_vulkan_string_list_t* required_layers,
-    const iree_hal_vulkan_string_list_t* optional_layers, iree::Arena* arena,
-    iree_hal_vulkan_string_list_t* out_enabled_layers) {
+iree_status_t iree_hal_pim_match_available_instance_layers(
+    const iree::hal::pim::DynamicSymbols* syms,
+    const iree_hal_pim_string_list_t* required_layers,
+    const iree_hal_pim_string_list_t* optional_layers, iree::Arena* arena,
+    iree_hal_pim_string_list_t* out_enabled_layers) {
   uint32_t layer_property_count = 0;
   VK_RETURN_IF_ERROR(
       syms->vkEnumerateInstanceLayerProperties(&layer_property_count, NULL),
@@ -73,13 +73,13 @@ iree_status_t iree_hal_vulkan_match_available_instance_layers(
   out_enabled_layers->values = (const char**)arena->AllocateBytes(
       (required_layers->count + optional_layers->count) *
       sizeof(out_enabled_layers->values[0]));
-  return iree_hal_vulkan_match_available_layers(
+  return iree_hal_pim_match_available_layers(
       layer_property_count, layer_properties, required_layers, optional_layers,
       out_enabled_layers);
 }
 
 // Returns true if |extensions| contains a layer matching |extension_name|.
-static bool iree_hal_vulkan_extension_list_contains(
+static bool iree_hal_pim_extension_list_contains(
     uint32_t extension_count, const VkExtensionProperties* extensions,
     const char* extension_name) {
   for (uint32_t i = 0; i < extension_count; ++i) {
@@ -90,19 +90,19 @@ static bool iree_hal_vulkan_extension_list_contains(
   return false;
 }
 
-static iree_status_t iree_hal_vulkan_match_available_extensions(
+static iree_status_t iree_hal_pim_match_available_extensions(
     iree_host_size_t available_extension_count,
     const VkExtensionProperties* available_extensions,
-    const iree_hal_vulkan_string_list_t* required_extensions,
-    const iree_hal_vulkan_string_list_t* optional_extensions,
-    iree_hal_vulkan_string_list_t* out_enabled_extensions) {
+    const iree_hal_pim_string_list_t* required_extensions,
+    const iree_hal_pim_string_list_t* optional_extensions,
+    iree_hal_pim_string_list_t* out_enabled_extensions) {
   memset(out_enabled_extensions->values, 0,
          (required_extensions->count + optional_extensions->count) *
              sizeof(out_enabled_extensions->values[0]));
 
   for (iree_host_size_t i = 0; i < required_extensions->count; ++i) {
     const char* extension_name = required_extensions->values[i];
-    if (!iree_hal_vulkan_extension_list_contains(
+    if (!iree_hal_pim_extension_list_contains(
             available_extension_count, available_extensions, extension_name)) {
       return iree_make_status(IREE_STATUS_UNAVAILABLE,
                               "required extension %s not available",
@@ -114,7 +114,7 @@ static iree_status_t iree_hal_vulkan_match_available_extensions(
 
   for (iree_host_size_t i = 0; i < optional_extensions->count; ++i) {
     const char* extension_name = optional_extensions->values[i];
-    if (iree_hal_vulkan_extension_list_contains(
+    if (iree_hal_pim_extension_list_contains(
             available_extension_count, available_extensions, extension_name)) {
       out_enabled_extensions->values[out_enabled_extensions->count++] =
           extension_name;
@@ -124,11 +124,11 @@ static iree_status_t iree_hal_vulkan_match_available_extensions(
   return iree_ok_status();
 }
 
-iree_status_t iree_hal_vulkan_match_available_instance_extensions(
-    const iree::hal::vulkan::DynamicSymbols* syms,
-    const iree_hal_vulkan_string_list_t* required_extensions,
-    const iree_hal_vulkan_string_list_t* optional_extensions,
-    iree::Arena* arena, iree_hal_vulkan_string_list_t* out_enabled_extensions) {
+iree_status_t iree_hal_pim_match_available_instance_extensions(
+    const iree::hal::pim::DynamicSymbols* syms,
+    const iree_hal_pim_string_list_t* required_extensions,
+    const iree_hal_pim_string_list_t* optional_extensions,
+    iree::Arena* arena, iree_hal_pim_string_list_t* out_enabled_extensions) {
   uint32_t extension_property_count = 0;
   VK_RETURN_IF_ERROR(syms->vkEnumerateInstanceExtensionProperties(
                          NULL, &extension_property_count, NULL),
@@ -143,17 +143,17 @@ iree_status_t iree_hal_vulkan_match_available_instance_extensions(
   out_enabled_extensions->values = (const char**)arena->AllocateBytes(
       (required_extensions->count + optional_extensions->count) *
       sizeof(out_enabled_extensions->values[0]));
-  return iree_hal_vulkan_match_available_extensions(
+  return iree_hal_pim_match_available_extensions(
       extension_property_count, extension_properties, required_extensions,
       optional_extensions, out_enabled_extensions);
 }
 
-iree_status_t iree_hal_vulkan_match_available_device_extensions(
-    const iree::hal::vulkan::DynamicSymbols* syms,
+iree_status_t iree_hal_pim_match_available_device_extensions(
+    const iree::hal::pim::DynamicSymbols* syms,
     VkPhysicalDevice physical_device,
-    const iree_hal_vulkan_string_list_t* required_extensions,
-    const iree_hal_vulkan_string_list_t* optional_extensions,
-    iree::Arena* arena, iree_hal_vulkan_string_list_t* out_enabled_extensions) {
+    const iree_hal_pim_string_list_t* required_extensions,
+    const iree_hal_pim_string_list_t* optional_extensions,
+    iree::Arena* arena, iree_hal_pim_string_list_t* out_enabled_extensions) {
   uint32_t extension_property_count = 0;
   VK_RETURN_IF_ERROR(
       syms->vkEnumerateDeviceExtensionProperties(
@@ -170,15 +170,15 @@ iree_status_t iree_hal_vulkan_match_available_device_extensions(
   out_enabled_extensions->values = (const char**)arena->AllocateBytes(
       (required_extensions->count + optional_extensions->count) *
       sizeof(out_enabled_extensions->values[0]));
-  return iree_hal_vulkan_match_available_extensions(
+  return iree_hal_pim_match_available_extensions(
       extension_property_count, extension_properties, required_extensions,
       optional_extensions, out_enabled_extensions);
 }
 
-iree_hal_vulkan_instance_extensions_t
-iree_hal_vulkan_populate_enabled_instance_extensions(
-    const iree_hal_vulkan_string_list_t* enabled_extensions) {
-  iree_hal_vulkan_instance_extensions_t extensions;
+iree_hal_pim_instance_extensions_t
+iree_hal_pim_populate_enabled_instance_extensions(
+    const iree_hal_pim_string_list_t* enabled_extensions) {
+  iree_hal_pim_instance_extensions_t extensions;
   memset(&extensions, 0, sizeof(extensions));
   for (iree_host_size_t i = 0; i < enabled_extensions->count; ++i) {
     const char* extension_name = enabled_extensions->values[i];
@@ -189,10 +189,10 @@ iree_hal_vulkan_populate_enabled_instance_extensions(
   return extensions;
 }
 
-iree_hal_vulkan_device_extensions_t
-iree_hal_vulkan_populate_enabled_device_extensions(
-    const iree_hal_vulkan_string_list_t* enabled_extensions) {
-  iree_hal_vulkan_device_extensions_t extensions;
+iree_hal_pim_device_extensions_t
+iree_hal_pim_populate_enabled_device_extensions(
+    const iree_hal_pim_string_list_t* enabled_extensions) {
+  iree_hal_pim_device_extensions_t extensions;
   memset(&extensions, 0, sizeof(extensions));
   for (iree_host_size_t i = 0; i < enabled_extensions->count; ++i) {
     const char* extension_name = enabled_extensions->values[i];
@@ -215,10 +215,10 @@ iree_hal_vulkan_populate_enabled_device_extensions(
   return extensions;
 }
 
-iree_hal_vulkan_device_extensions_t
-iree_hal_vulkan_infer_enabled_device_extensions(
-    const iree::hal::vulkan::DynamicSymbols* device_syms) {
-  iree_hal_vulkan_device_extensions_t extensions;
+iree_hal_pim_device_extensions_t
+iree_hal_pim_infer_enabled_device_extensions(
+    const iree::hal::pim::DynamicSymbols* device_syms) {
+  iree_hal_pim_device_extensions_t extensions;
   memset(&extensions, 0, sizeof(extensions));
   if (device_syms->vkCmdPushDescriptorSetKHR) {
     extensions.push_descriptors = true;
@@ -13,22 +13,22 @@
 // Vulkan usage mostly functional and C-like to ensure minimal code size and
 // readability.
 
-#ifndef IREE_HAL_DRIVERS_VULKAN_HANDLE_UTIL_H_
-#define IREE_HAL_DRIVERS_VULKAN_HANDLE_UTIL_H_
+#ifndef IREE_HAL_DRIVERS_PIM_HANDLE_UTIL_H_
+#define IREE_HAL_DRIVERS_PIM_HANDLE_UTIL_H_
 
 // clang-format off: must be included before all other headers.
-#include "iree/hal/drivers/vulkan/vulkan_headers.h"  // IWYU pragma: export
+#include "iree/hal/drivers/pim/vulkan_headers.h"  // IWYU pragma: export
 // clang-format on
 
 #include "iree/base/internal/synchronization.h"
-#include "iree/hal/drivers/vulkan/dynamic_symbols.h"
-#include "iree/hal/drivers/vulkan/extensibility_util.h"
-#include "iree/hal/drivers/vulkan/status_util.h"
-#include "iree/hal/drivers/vulkan/util/ref_ptr.h"
+#include "iree/hal/drivers/pim/dynamic_symbols.h"
+#include "iree/hal/drivers/pim/extensibility_util.h"
+#include "iree/hal/drivers/pim/status_util.h"
+#include "iree/hal/drivers/pim/util/ref_ptr.h"
 
 namespace iree {
 namespace hal {
-namespace vulkan {
+namespace pim {
 
 template <class T, class U = T>
 constexpr T exchange(T& obj, U&& new_value) {
@@ -40,7 +40,7 @@ constexpr T exchange(T& obj, U&& new_value) {
 class VkDeviceHandle : public RefObject<VkDeviceHandle> {
  public:
   VkDeviceHandle(DynamicSymbols* syms,
-                 iree_hal_vulkan_device_extensions_t enabled_extensions,
+                 iree_hal_pim_device_extensions_t enabled_extensions,
                  bool owns_device, iree_allocator_t host_allocator,
                  const VkAllocationCallbacks* allocator = nullptr)
       : syms_(add_ref(syms)),
@@ -76,14 +76,14 @@ class VkDeviceHandle : public RefObject<VkDeviceHandle> {
   const VkAllocationCallbacks* allocator() const noexcept { return allocator_; }
   iree_allocator_t host_allocator() const noexcept { return host_allocator_; }
 
-  const iree_hal_vulkan_device_extensions_t& enabled_extensions() const {
+  const iree_hal_pim_device_extensions_t& enabled_extensions() const {
     return enabled_extensions_;
   }
 
  private:
   VkDevice value_ = VK_NULL_HANDLE;
   ref_ptr<DynamicSymbols> syms_;
-  iree_hal_vulkan_device_extensions_t enabled_extensions_;
+  iree_hal_pim_device_extensions_t enabled_extensions_;
   bool owns_device_;
   const VkAllocationCallbacks* allocator_ = nullptr;
   iree_allocator_t host_allocator_;
@@ -159,8 +159,8 @@ class VkCommandPoolHandle {
   iree_slim_mutex_t mutex_;
 };
 
-}  // namespace vulkan
+}  // namespace pim
 }  // namespace hal
 }  // namespace iree
 
-#endif  // IREE_HAL_DRIVERS_VULKAN_HANDLE_UTIL_H_
+#endif  // IREE_HAL_DRIVERS_PIM_HANDLE_UTIL_H_
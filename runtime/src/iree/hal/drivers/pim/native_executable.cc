@@ -0,0 +1,714 @@
+// Copyright 2019 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/pim/native_executable.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cinttypes>
+#include <cstring>
+#include <iostream>
+
+#include "iree/base/api.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/drivers/pim/dynamic_symbol_tables.h"
+#include "iree/hal/drivers/pim/dynamic_symbols.h"
+#include "iree/hal/drivers/pim/PIM_buffer.h"
+#include "iree/hal/drivers/pim/PIM_sdk.h"
+#include "iree/hal/drivers/pim/handle_util.h"
+#include "iree/hal/drivers/pim/native_pipeline_layout.h"
+#include "iree/hal/drivers/pim/status_util.h"
+#include "iree/hal/drivers/pim/util/ref_ptr.h"
+
+// flatcc schemas:
+#include "iree/base/internal/flatcc/parsing.h"
+#include "iree/schemas/pim_executable_def_reader.h"
+#include "iree/schemas/pim_executable_def_verifier.h"
+
+using namespace iree::hal::pim;
+
+// Verifies the structure of the FlatBuffer so that we can avoid doing so during
+// runtime. There are still some conditions we must be aware of (such as omitted
+// names on functions with internal linkage), however we shouldn't need to
+// bounds check anything within the FlatBuffer after this succeeds.
+static iree_status_t iree_hal_pim_executable_flatbuffer_verify(
+    iree_const_byte_span_t flatbuffer_data,
+    iree_host_size_t expected_entry_point_count) {
+  if (!flatbuffer_data.data || flatbuffer_data.data_length < 16) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "FlatBuffer data is not present or less than 16 bytes (%zu total)",
+        flatbuffer_data.data_length);
+  }
+
+  // Run flatcc generated verification. This ensures all pointers are in-bounds
+  // and that we can safely walk the file, but not that the actual contents of
+  // the FlatBuffer meet our expectations.
+  int verify_ret = iree_PIMExecutableDef_verify_as_root(
+      flatbuffer_data.data, flatbuffer_data.data_length);
+  if (verify_ret != flatcc_verify_ok) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "FlatBuffer verification failed: %s",
+                            flatcc_verify_error_string(verify_ret));
+  }
+
+  iree_PIMExecutableDef_table_t executable_def =
+      iree_PIMExecutableDef_as_root(flatbuffer_data.data);
+
+  flatbuffers_string_vec_t entry_points_vec =
+      iree_PIMExecutableDef_entry_points_get(executable_def);
+  size_t entry_point_count = flatbuffers_string_vec_len(entry_points_vec);
+  if (entry_point_count != expected_entry_point_count) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "executable provides %zu entry points but caller "
+                            "provided %zu; must match",
+                            entry_point_count, expected_entry_point_count);
+  }
+
+  for (size_t i = 0; i < entry_point_count; ++i) {
+    if (!flatbuffers_string_len(
+            flatbuffers_string_vec_at(entry_points_vec, i))) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "executable entry point %zu has no name", i);
+    }
+  }
+
+  // Linked executables split their instructions and bindings into one range
+  // per entry point.
+  flatbuffers_uint64_vec_t code_vec =
+      iree_PIMExecutableDef_code_get(executable_def);
+  flatbuffers_uint8_vec_t binding_ranks_vec =
+      iree_PIMExecutableDef_binding_ranks_get(executable_def);
+  flatbuffers_uint32_vec_t entry_code_offsets_vec =
+      iree_PIMExecutableDef_entry_code_offsets_get(executable_def);
+  flatbuffers_uint32_vec_t entry_binding_offsets_vec =
+      iree_PIMExecutableDef_entry_binding_offsets_get(executable_def);
+  if (entry_code_offsets_vec || entry_binding_offsets_vec) {
+    if (flatbuffers_uint32_vec_len(entry_code_offsets_vec) !=
+            entry_point_count + 1 ||
+        flatbuffers_uint32_vec_len(entry_binding_offsets_vec) !=
+            entry_point_count + 1) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "executable entry point ranges do not match its "
+                              "%zu entry points",
+                              entry_point_count);
+    }
+    for (size_t i = 0; i <= entry_point_count; ++i) {
+      uint32_t code_offset =
+          flatbuffers_uint32_vec_at(entry_code_offsets_vec, i);
+      uint32_t binding_offset =
+          flatbuffers_uint32_vec_at(entry_binding_offsets_vec, i);
+      bool is_last = i == entry_point_count;
+      bool is_valid =
+          i == 0 ? code_offset == 0 && binding_offset == 0
+                 : code_offset >= flatbuffers_uint32_vec_at(
+                                      entry_code_offsets_vec, i - 1) &&
+                       binding_offset >= flatbuffers_uint32_vec_at(
+                                             entry_binding_offsets_vec, i - 1);
+      if (is_last) {
+        is_valid = is_valid &&
+                   code_offset == flatbuffers_uint64_vec_len(code_vec) &&
+                   binding_offset ==
+                       flatbuffers_uint8_vec_len(binding_ranks_vec);
+      }
+      if (!is_valid) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "executable entry point range %zu is out of "
+                                "order or bounds",
+                                i);
+      }
+    }
+  }
+
+  /*
+  flatbuffers_uint32_vec_t subgroup_sizes_vec =
+      iree_pimExecutableDef_subgroup_sizes_get(executable_def);
+  if (subgroup_sizes_vec) {
+    size_t subgroup_sizes_count = flatbuffers_vec_len(subgroup_sizes_vec);
+    if (subgroup_sizes_count != expected_entry_point_count) {
+      return iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "executable has %zu entry points but %zu subgroup sizes are defined",
+          expected_entry_point_count, subgroup_sizes_count);
+    }
+  }*/
+
+  if (flatbuffers_uint64_vec_len(code_vec) == 0) {
+    //return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+    //                        "executable SPIR-V code is missing/empty");
+  }
+
+  // Instruction words must only use defined fields and their dims must add up
+  // to the dims table.
+  flatbuffers_int32_vec_t dims_vec =
+      iree_PIMExecutableDef_dims_get(executable_def);
+  size_t dim_count = 0;
+  for (size_t i = 0; i < flatbuffers_uint64_vec_len(code_vec); ++i) {
+    uint64_t word = flatbuffers_uint64_vec_at(code_vec, i);
+    if ((word >> 19) != 0 || ((word >> 8) & 0x3) == 0x3 ||
+        ((word >> 10) & 0x3) != 0 ||
+        ((word >> 16) & 0x7) > IREE_HAL_PIM_ELEMENT_TYPE_I8) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "executable instruction %zu has an invalid "
+                              "encoding 0x%016" PRIx64,
+                              i, word);
+    }
+    dim_count += (word >> 12) & 0xF;
+  }
+  if (dim_count != flatbuffers_int32_vec_len(dims_vec)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "executable instructions use %zu dims but %zu "
+                            "are defined",
+                            dim_count, flatbuffers_int32_vec_len(dims_vec));
+  }
+
+  // Sync points must follow existing instructions in program order and name
+  // a known collective.
+  flatbuffers_uint64_vec_t comm_flag_vec =
+      iree_PIMExecutableDef_comm_flag_get(executable_def);
+  for (size_t i = 0; i < flatbuffers_uint64_vec_len(comm_flag_vec); ++i) {
+    uint64_t flag = flatbuffers_uint64_vec_at(comm_flag_vec, i);
+    uint64_t ordinal = flag & 0xFFFFFFFFu;
+    uint64_t sync = flag >> 32;
+    bool is_ordered =
+        i == 0 ||
+        ordinal > (flatbuffers_uint64_vec_at(comm_flag_vec, i - 1) &
+                   0xFFFFFFFFu);
+    if (ordinal >= flatbuffers_uint64_vec_len(code_vec) || !is_ordered ||
+        sync == IREE_HAL_PIM_SYNC_NONE || sync > IREE_HAL_PIM_SYNC_ALL_GATHER) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "executable sync point %zu has an invalid "
+                              "encoding 0x%016" PRIx64,
+                              i, flag);
+    }
+  }
+
+  // Binding shapes must fit in a PIM buffer and add up to the binding dims.
+  flatbuffers_int32_vec_t binding_dims_vec =
+      iree_PIMExecutableDef_binding_dims_get(executable_def);
+  size_t binding_dim_count = 0;
+  for (size_t i = 0; i < flatbuffers_uint8_vec_len(binding_ranks_vec); ++i) {
+    uint8_t rank = flatbuffers_uint8_vec_at(binding_ranks_vec, i);
+    if (rank > IREE_HAL_PIM_BUFFER_MAX_RANK) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "executable binding %zu has rank %u but at most "
+                              "%d is supported",
+                              i, rank, IREE_HAL_PIM_BUFFER_MAX_RANK);
+    }
+    binding_dim_count += rank;
+  }
+  if (binding_dim_count != flatbuffers_int32_vec_len(binding_dims_vec)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "executable bindings use %zu dims but %zu are "
+                            "defined",
+                            binding_dim_count,
+                            flatbuffers_int32_vec_len(binding_dims_vec));
+  }
+  for (size_t i = 0; i < binding_dim_count; ++i) {
+    if (flatbuffers_int32_vec_at(binding_dims_vec, i) < 0) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "executable binding dim %zu is negative", i);
+    }
+  }
+  flatbuffers_uint8_vec_t binding_types_vec =
+      iree_PIMExecutableDef_binding_types_get(executable_def);
+  if (binding_types_vec &&
+      flatbuffers_uint8_vec_len(binding_types_vec) !=
+          flatbuffers_uint8_vec_len(binding_ranks_vec)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "executable declares types of %zu bindings but "
+                            "shapes of %zu",
+                            flatbuffers_uint8_vec_len(binding_types_vec),
+                            flatbuffers_uint8_vec_len(binding_ranks_vec));
+  }
+  for (size_t i = 0; i < flatbuffers_uint8_vec_len(binding_types_vec); ++i) {
+    if (flatbuffers_uint8_vec_at(binding_types_vec, i) >
+        IREE_HAL_PIM_ELEMENT_TYPE_I8) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "executable binding %zu has an invalid element "
+                              "type",
+                              i);
+    }
+  }
+
+  // Views of fused bindings are declared for every binding.
+  flatbuffers_uint32_vec_t binding_sources_vec =
+      iree_PIMExecutableDef_binding_sources_get(executable_def);
+  flatbuffers_int32_vec_t binding_offsets_vec =
+      iree_PIMExecutableDef_binding_offsets_get(executable_def);
+  if ((binding_sources_vec || binding_offsets_vec) &&
+      (flatbuffers_uint32_vec_len(binding_sources_vec) !=
+           flatbuffers_uint8_vec_len(binding_ranks_vec) ||
+       flatbuffers_int32_vec_len(binding_offsets_vec) !=
+           flatbuffers_uint8_vec_len(binding_ranks_vec))) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "executable declares views of %zu bindings but "
+                            "shapes of %zu",
+                            flatbuffers_uint32_vec_len(binding_sources_vec),
+                            flatbuffers_uint8_vec_len(binding_ranks_vec));
+  }
+
+  // Programs with an operand table must list the result slot of every
+  // instruction and only read results of earlier instructions of the same
+  // entry point. Entry points of linked executables without operand slots
+  // have empty ranges for all of their instructions.
+  flatbuffers_uint32_vec_t operand_offsets_vec =
+      iree_PIMExecutableDef_operand_offsets_get(executable_def);
+  flatbuffers_int32_vec_t operand_slots_vec =
+      iree_PIMExecutableDef_operand_slots_get(executable_def);
+  if (!operand_offsets_vec && !operand_slots_vec) return iree_ok_status();
+  size_t command_count = flatbuffers_uint64_vec_len(code_vec);
+  size_t slot_count = flatbuffers_int32_vec_len(operand_slots_vec);
+  if (flatbuffers_uint32_vec_len(operand_offsets_vec) != command_count + 1 ||
+      flatbuffers_uint32_vec_at(operand_offsets_vec, 0) != 0 ||
+      flatbuffers_uint32_vec_at(operand_offsets_vec, command_count) !=
+          slot_count) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "executable operand table does not match its %zu "
+                            "instructions",
+                            command_count);
+  }
+  for (size_t e = 0; e < entry_point_count; ++e) {
+    size_t entry_begin =
+        entry_code_offsets_vec
+            ? flatbuffers_uint32_vec_at(entry_code_offsets_vec, e)
+            : 0;
+    size_t entry_end =
+        entry_code_offsets_vec
+            ? flatbuffers_uint32_vec_at(entry_code_offsets_vec, e + 1)
+            : command_count;
+    bool has_slots =
+        flatbuffers_uint32_vec_at(operand_offsets_vec, entry_begin) !=
+        flatbuffers_uint32_vec_at(operand_offsets_vec, entry_end);
+    for (size_t i = entry_begin; i < entry_end; ++i) {
+      uint32_t begin = flatbuffers_uint32_vec_at(operand_offsets_vec, i);
+      uint32_t end = flatbuffers_uint32_vec_at(operand_offsets_vec, i + 1);
+      if ((has_slots ? begin >= end : begin != end) || end > slot_count) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "executable instruction %zu has no result "
+                                "slot",
+                                i);
+      }
+      for (uint32_t j = begin; j < end; ++j) {
+        int32_t slot = flatbuffers_int32_vec_at(operand_slots_vec, j);
+        if (slot >= 0) continue;
+        size_t producer = (size_t)(-1 - (int64_t)slot);
+        size_t ordinal = i - entry_begin;
+        bool is_result = j + 1 == end;
+        if (is_result ? producer != ordinal : producer >= ordinal) {
+          return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                  "executable instruction %zu references the "
+                                  "result of instruction %zu of its entry "
+                                  "point",
+                                  i, producer);
+        }
+      }
+    }
+  }
+
+  return iree_ok_status();
+}
+
+// Instructions and bindings of an entry point within those of the executable.
+typedef struct iree_hal_pim_entry_point_t {
+  iree_host_size_t command_offset;
+  iree_host_size_t command_count;
+  iree_host_size_t binding_offset;
+  iree_host_size_t binding_count;
+} iree_hal_pim_entry_point_t;
+
+typedef struct iree_hal_pim_native_executable_t {
+  iree_hal_resource_t resource;
+  iree_allocator_t host_allocator;
+
+  // Ranges of each entry point stored after |instructions|. Executables that
+  // aren't linked run all of their instructions from every entry point.
+  iree_host_size_t entry_point_count;
+  const iree_hal_pim_entry_point_t* entry_points;
+
+  // PIM command stream decoded from the FlatBuffer at load time. The commands
+  // are owned by the executable so that it can outlive the executable data
+  // (as is required when shared through the executable cache).
+  iree_host_size_t command_count;
+  // Instructions decoded from |commands| stored after them. The dims they
+  // reference are stored after |entry_points|.
+  const iree_hal_pim_instruction_t* instructions;
+  // Operand table of multi-instruction programs stored after |commands| or
+  // NULL if every instruction reads all bindings. See
+  // iree_hal_pim_executable_operand_slots.
+  const uint32_t* operand_offsets;
+  const int32_t* operand_slots;
+  // Compiled shapes of the bindings stored after the operand table. Binding i
+  // has the dims in [binding_offsets[i], binding_offsets[i + 1]) of
+  // binding_dims. See iree_hal_pim_executable_binding_shape.
+  iree_host_size_t binding_count;
+  const uint32_t* binding_offsets;
+  const int32_t* binding_dims;
+  // Dispatch bindings viewed by the bindings and the byte offsets of the views
+  // stored after |binding_dims| or NULL if bindings aren't fused. See
+  // iree_hal_pim_executable_binding_view.
+  const uint32_t* binding_sources;
+  const int32_t* binding_byte_offsets;
+  // Element types of the bindings stored after |binding_byte_offsets| or NULL
+  // if all bindings are f32.
+  const uint8_t* binding_types;
+  uint64_t commands[];
+} iree_hal_pim_native_executable_t;
+
+namespace {
+extern const iree_hal_executable_vtable_t
+    iree_hal_pim_native_executable_vtable;
+}  // namespace
+
+static iree_hal_pim_native_executable_t*
+iree_hal_pim_native_executable_cast(iree_hal_executable_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_pim_native_executable_vtable);
+  return (iree_hal_pim_native_executable_t*)base_value;
+}
+
+bool iree_hal_pim_native_executable_isa(iree_hal_executable_t* executable) {
+  return iree_hal_resource_is(executable,
+                              &iree_hal_pim_native_executable_vtable);
+}
+
+// Uploads the micro-op programs of the elementwise instructions of the
+// executable. Programs are constant so they stay resident on the device for
+// the lifetime of the executable instead of being uploaded per dispatch. The
+// SDK reads the words as the raw bits of an f32 operand. Uploads are profiled
+// with |simulation|.
+static void iree_hal_pim_native_executable_upload_programs(
+    const iree_hal_pim_sim_params_t* simulation, iree_host_size_t command_count,
+    iree_hal_pim_instruction_t* instructions) {
+  for (iree_host_size_t i = 0; i < command_count; ++i) {
+    iree_hal_pim_instruction_t* instruction = &instructions[i];
+    if (instruction->opcode != 18 || instruction->dim_count < 2) continue;
+    // The instruction word holds at most 15 dims, one of which is the length.
+    float words[15];
+    const iree_host_size_t word_count = instruction->dim_count - 1;
+    memcpy(words, instruction->dims + 1, word_count * sizeof(float));
+    instruction->program_addr =
+        iree_hal_pim_sdk_alloc_buffer(simulation, (int)word_count, words);
+  }
+}
+
+iree_status_t iree_hal_pim_native_executable_create(
+    iree_allocator_t host_allocator,
+    const iree_hal_pim_sim_params_t* simulation,
+    const iree_hal_executable_params_t* executable_params,
+    iree_hal_executable_t** out_executable) {
+  IREE_ASSERT_ARGUMENT(executable_params);
+  IREE_ASSERT_ARGUMENT(out_executable);
+  *out_executable = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Verify and fetch the executable FlatBuffer wrapper.
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_pim_executable_flatbuffer_verify(
+              executable_params->executable_data,
+              executable_params->pipeline_layout_count));
+  iree_PIMExecutableDef_table_t executable_def =
+      iree_PIMExecutableDef_as_root(executable_params->executable_data.data);
+
+  flatbuffers_uint64_vec_t code_vec =
+      iree_PIMExecutableDef_code_get(executable_def);
+  iree_host_size_t command_count = flatbuffers_uint64_vec_len(code_vec);
+
+  flatbuffers_string_vec_t entry_points_vec =
+      iree_PIMExecutableDef_entry_points_get(executable_def);
+  iree_host_size_t entry_point_count =
+      flatbuffers_string_vec_len(entry_points_vec);
+
+  flatbuffers_uint32_vec_t operand_offsets_vec =
+      iree_PIMExecutableDef_operand_offsets_get(executable_def);
+  flatbuffers_int32_vec_t operand_slots_vec =
+      iree_PIMExecutableDef_operand_slots_get(executable_def);
+  iree_host_size_t operand_offset_count =
+      operand_offsets_vec ? command_count + 1 : 0;
+  iree_host_size_t operand_slot_count =
+      flatbuffers_int32_vec_len(operand_slots_vec);
+
+  flatbuffers_int32_vec_t dims_vec =
+      iree_PIMExecutableDef_dims_get(executable_def);
+  iree_host_size_t dim_count = flatbuffers_int32_vec_len(dims_vec);
+
+  flatbuffers_uint8_vec_t binding_ranks_vec =
+      iree_PIMExecutableDef_binding_ranks_get(executable_def);
+  flatbuffers_int32_vec_t binding_dims_vec =
+      iree_PIMExecutableDef_binding_dims_get(executable_def);
+  iree_host_size_t binding_count = flatbuffers_uint8_vec_len(binding_ranks_vec);
+  iree_host_size_t binding_offset_count = binding_count ? binding_count + 1 : 0;
+  iree_host_size_t binding_dim_count =
+      flatbuffers_int32_vec_len(binding_dims_vec);
+  flatbuffers_uint8_vec_t binding_types_vec =
+      iree_PIMExecutableDef_binding_types_get(executable_def);
+  iree_host_size_t binding_type_count =
+      flatbuffers_uint8_vec_len(binding_types_vec);
+  flatbuffers_uint32_vec_t binding_sources_vec =
+      iree_PIMExecutableDef_binding_sources_get(executable_def);
+  flatbuffers_int32_vec_t binding_offsets_vec =
+      iree_PIMExecutableDef_binding_offsets_get(executable_def);
+  iree_host_size_t binding_view_count =
+      flatbuffers_uint32_vec_len(binding_sources_vec);
+
+  iree_hal_pim_native_executable_t* executable = NULL;
+  iree_host_size_t total_size =
+      sizeof(*executable) + command_count * sizeof(*executable->commands) +
+      command_count * sizeof(*executable->instructions) +
+      entry_point_count * sizeof(*executable->entry_points) +
+      dim_count * sizeof(int32_t) +
+      operand_offset_count * sizeof(*executable->operand_offsets) +
+      operand_slot_count * sizeof(*executable->operand_slots) +
+      binding_offset_count * sizeof(*executable->binding_offsets) +
+      binding_dim_count * sizeof(*executable->binding_dims) +
+      binding_view_count * sizeof(*executable->binding_sources) +
+      binding_view_count * sizeof(*executable->binding_byte_offsets) +
+      binding_type_count * sizeof(*executable->binding_types);
+  iree_status_t status = iree_allocator_malloc(host_allocator, total_size,
+                                               (void**)&executable);
+  if (iree_status_is_ok(status)) {
+    iree_hal_resource_initialize(&iree_hal_pim_native_executable_vtable,
+                                 &executable->resource);
+    executable->host_allocator = host_allocator;
+    executable->entry_point_count = entry_point_count;
+
+    // Decode the command stream once so dispatches don't touch the
+    // FlatBuffer. The vector data may be unaligned in the FlatBuffer.
+    executable->command_count = command_count;
+    for (iree_host_size_t i = 0; i < command_count; ++i) {
+      executable->commands[i] = flatbuffers_uint64_vec_at(code_vec, i);
+    }
+    iree_hal_pim_instruction_t* instructions =
+        (iree_hal_pim_instruction_t*)(executable->commands + command_count);
+    iree_hal_pim_entry_point_t* entry_points =
+        (iree_hal_pim_entry_point_t*)(instructions + command_count);
+    flatbuffers_uint32_vec_t entry_code_offsets_vec =
+        iree_PIMExecutableDef_entry_code_offsets_get(executable_def);
+    flatbuffers_uint32_vec_t entry_binding_offsets_vec =
+        iree_PIMExecutableDef_entry_binding_offsets_get(executable_def);
+    for (iree_host_size_t i = 0; i < entry_point_count; ++i) {
+      if (!entry_code_offsets_vec) {
+        entry_points[i].command_offset = 0;
+        entry_points[i].command_count = command_count;
+        entry_points[i].binding_offset = 0;
+        entry_points[i].binding_count = binding_count;
+        continue;
+      }
+      entry_points[i].command_offset =
+          flatbuffers_uint32_vec_at(entry_code_offsets_vec, i);
+      entry_points[i].command_count =
+          flatbuffers_uint32_vec_at(entry_code_offsets_vec, i + 1) -
+          entry_points[i].command_offset;
+      entry_points[i].binding_offset =
+          flatbuffers_uint32_vec_at(entry_binding_offsets_vec, i);
+      entry_points[i].binding_count =
+          flatbuffers_uint32_vec_at(entry_binding_offsets_vec, i + 1) -
+          entry_points[i].binding_offset;
+    }
+    executable->entry_points = entry_points;
+    int32_t* dims = (int32_t*)(entry_points + entry_point_count);
+    for (iree_host_size_t i = 0; i < dim_count; ++i) {
+      dims[i] = flatbuffers_int32_vec_at(dims_vec, i);
+    }
+    for (iree_host_size_t i = 0; i < command_count; ++i) {
+      uint64_t word = executable->commands[i];
+      instructions[i].opcode = (int)(word & 0xFF);
+      instructions[i].split_type =
+          (iree_hal_pim_split_type_t)((word >> 8) & 0x3);
+      instructions[i].sync = IREE_HAL_PIM_SYNC_NONE;
+      instructions[i].element_type =
+          (iree_hal_pim_element_type_t)((word >> 16) & 0x7);
+      instructions[i].dim_count = (iree_host_size_t)((word >> 12) & 0xF);
+      instructions[i].dims = dims;
+      instructions[i].program_addr = IREE_HAL_PIM_BUFFER_ADDR_NONE;
+      dims += instructions[i].dim_count;
+    }
+    iree_hal_pim_native_executable_upload_programs(simulation, command_count,
+                                                   instructions);
+    flatbuffers_uint64_vec_t comm_flag_vec =
+        iree_PIMExecutableDef_comm_flag_get(executable_def);
+    for (iree_host_size_t i = 0; i < flatbuffers_uint64_vec_len(comm_flag_vec);
+         ++i) {
+      uint64_t flag = flatbuffers_uint64_vec_at(comm_flag_vec, i);
+      instructions[flag & 0xFFFFFFFFu].sync = (iree_hal_pim_sync_t)(flag >> 32);
+    }
+    executable->instructions = instructions;
+
+    uint32_t* operand_offsets = (uint32_t*)dims;
+    int32_t* operand_slots = (int32_t*)(operand_offsets + operand_offset_count);
+    executable->operand_offsets = NULL;
+    executable->operand_slots = NULL;
+    if (operand_offset_count) {
+      for (iree_host_size_t i = 0; i < operand_offset_count; ++i) {
+        operand_offsets[i] = flatbuffers_uint32_vec_at(operand_offsets_vec, i);
+      }
+      for (iree_host_size_t i = 0; i < operand_slot_count; ++i) {
+        operand_slots[i] = flatbuffers_int32_vec_at(operand_slots_vec, i);
+      }
+      executable->operand_offsets = operand_offsets;
+      executable->operand_slots = operand_slots;
+    }
+
+    uint32_t* binding_offsets = (uint32_t*)(operand_slots + operand_slot_count);
+    int32_t* binding_dims = (int32_t*)(binding_offsets + binding_offset_count);
+    executable->binding_count = binding_count;
+    executable->binding_offsets = NULL;
+    executable->binding_dims = NULL;
+    if (binding_count) {
+      binding_offsets[0] = 0;
+      for (iree_host_size_t i = 0; i < binding_count; ++i) {
+        binding_offsets[i + 1] =
+            binding_offsets[i] + flatbuffers_uint8_vec_at(binding_ranks_vec, i);
+      }
+      for (iree_host_size_t i = 0; i < binding_dim_count; ++i) {
+        binding_dims[i] = flatbuffers_int32_vec_at(binding_dims_vec, i);
+      }
+      executable->binding_offsets = binding_offsets;
+      executable->binding_dims = binding_dims;
+    }
+    uint32_t* binding_sources = (uint32_t*)(binding_dims + binding_dim_count);
+    int32_t* binding_byte_offsets =
+        (int32_t*)(binding_sources + binding_view_count);
+    executable->binding_sources = NULL;
+    executable->binding_byte_offsets = NULL;
+    if (binding_view_count) {
+      for (iree_host_size_t i = 0; i < binding_view_count; ++i) {
+        binding_sources[i] = flatbuffers_uint32_vec_at(binding_sources_vec, i);
+        binding_byte_offsets[i] =
+            flatbuffers_int32_vec_at(binding_offsets_vec, i);
+      }
+      executable->binding_sources = binding_sources;
+      executable->binding_byte_offsets = binding_byte_offsets;
+    }
+    uint8_t* binding_types =
+        (uint8_t*)(binding_byte_offsets + binding_view_count);
+    executable->binding_types = NULL;
+    if (binding_type_count) {
+      for (iree_host_size_t i = 0; i < binding_type_count; ++i) {
+        binding_types[i] = flatbuffers_uint8_vec_at(binding_types_vec, i);
+      }
+      executable->binding_types = binding_types;
+    }
+
+    *out_executable = (iree_hal_executable_t*)executable;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_pim_native_executable_destroy(
+    iree_hal_executable_t* base_executable) {
+  iree_hal_pim_native_executable_t* executable =
+      iree_hal_pim_native_executable_cast(base_executable);
+  iree_allocator_t host_allocator = executable->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  if (iree_hal_pim_sdk_can_free_buffer()) {
+    for (iree_host_size_t i = 0; i < executable->command_count; ++i) {
+      const int program_addr = executable->instructions[i].program_addr;
+      if (program_addr == IREE_HAL_PIM_BUFFER_ADDR_NONE) continue;
+      iree_hal_pim_sdk_free_buffer(program_addr);
+    }
+  }
+
+  iree_allocator_free(host_allocator, executable);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+iree_host_size_t iree_hal_pim_executable_entry_point_count(
+    iree_hal_executable_t* base_executable) {
+  iree_hal_pim_native_executable_t* executable =
+      iree_hal_pim_native_executable_cast(base_executable);
+  return executable->entry_point_count;
+}
+
+const uint64_t* iree_hal_pim_executable_commands(
+    iree_hal_executable_t* base_executable, iree_host_size_t entry_ordinal,
+    iree_host_size_t* out_command_count) {
+  iree_hal_pim_native_executable_t* executable =
+      iree_hal_pim_native_executable_cast(base_executable);
+  const iree_hal_pim_entry_point_t* entry_point =
+      &executable->entry_points[entry_ordinal];
+  *out_command_count = entry_point->command_count;
+  return executable->commands + entry_point->command_offset;
+}
+
+const iree_hal_pim_instruction_t* iree_hal_pim_executable_instructions(
+    iree_hal_executable_t* base_executable, iree_host_size_t entry_ordinal) {
+  iree_hal_pim_native_executable_t* executable =
+      iree_hal_pim_native_executable_cast(base_executable);
+  return executable->instructions +
+         executable->entry_points[entry_ordinal].command_offset;
+}
+
+const int32_t* iree_hal_pim_executable_operand_slots(
+    iree_hal_executable_t* base_executable, iree_host_size_t entry_ordinal,
+    iree_host_size_t command_ordinal, iree_host_size_t* out_slot_count) {
+  iree_hal_pim_native_executable_t* executable =
+      iree_hal_pim_native_executable_cast(base_executable);
+  *out_slot_count = 0;
+  if (!executable->operand_offsets) return NULL;
+  command_ordinal += executable->entry_points[entry_ordinal].command_offset;
+  uint32_t begin = executable->operand_offsets[command_ordinal];
+  *out_slot_count = executable->operand_offsets[command_ordinal + 1] - begin;
+  return *out_slot_count ? executable->operand_slots + begin : NULL;
+}
+
+const int32_t* iree_hal_pim_executable_binding_shape(
+    iree_hal_executable_t* base_executable, iree_host_size_t entry_ordinal,
+    iree_host_size_t binding_ordinal, iree_host_size_t* out_rank) {
+  iree_hal_pim_native_executable_t* executable =
+      iree_hal_pim_native_executable_cast(base_executable);
+  const iree_hal_pim_entry_point_t* entry_point =
+      &executable->entry_points[entry_ordinal];
+  *out_rank = 0;
+  if (binding_ordinal >= entry_point->binding_count) return NULL;
+  binding_ordinal += entry_point->binding_offset;
+  uint32_t begin = executable->binding_offsets[binding_ordinal];
+  *out_rank = executable->binding_offsets[binding_ordinal + 1] - begin;
+  return *out_rank ? executable->binding_dims + begin : NULL;
+}
+
+iree_hal_pim_element_type_t iree_hal_pim_executable_binding_element_type(
+    iree_hal_executable_t* base_executable, iree_host_size_t entry_ordinal,
+    iree_host_size_t binding_ordinal) {
+  iree_hal_pim_native_executable_t* executable =
+      iree_hal_pim_native_executable_cast(base_executable);
+  const iree_hal_pim_entry_point_t* entry_point =
+      &executable->entry_points[entry_ordinal];
+  if (!executable->binding_types ||
+      binding_ordinal >= entry_point->binding_count) {
+    return IREE_HAL_PIM_ELEMENT_TYPE_F32;
+  }
+  return (iree_hal_pim_element_type_t)
+      executable->binding_types[entry_point->binding_offset + binding_ordinal];
+}
+
+iree_host_size_t iree_hal_pim_executable_binding_view_count(
+    iree_hal_executable_t* base_executable, iree_host_size_t entry_ordinal) {
+  iree_hal_pim_native_executable_t* executable =
+      iree_hal_pim_native_executable_cast(base_executable);
+  if (!executable->binding_sources) return 0;
+  return executable->entry_points[entry_ordinal].binding_count;
+}
+
+void iree_hal_pim_executable_binding_view(
+    iree_hal_executable_t* base_executable, iree_host_size_t entry_ordinal,
+    iree_host_size_t binding_ordinal, uint32_t* out_source_ordinal,
+    int32_t* out_byte_offset) {
+  iree_hal_pim_native_executable_t* executable =
+      iree_hal_pim_native_executable_cast(base_executable);
+  binding_ordinal += executable->entry_points[entry_ordinal].binding_offset;
+  *out_source_ordinal = executable->binding_sources[binding_ordinal];
+  *out_byte_offset = executable->binding_byte_offsets[binding_ordinal];
+}
+
+namespace {
+const iree_hal_executable_vtable_t iree_hal_pim_native_executable_vtable = {
+    /*.destroy=*/iree_hal_pim_native_executable_destroy,
+};
+}  // namespace
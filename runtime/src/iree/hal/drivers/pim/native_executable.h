@@ -0,0 +1,169 @@
+// Copyright 2019 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_PIM_NATIVE_EXECUTABLE_H_
+#define IREE_HAL_DRIVERS_PIM_NATIVE_EXECUTABLE_H_
+
+// clang-format off: must be included before all other headers.
+#include "iree/hal/drivers/pim/vulkan_headers.h"
+// clang-format on
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/pim/handle_util.h"
+#include "iree/hal/drivers/pim/util/pim_sim_model.h"
+
+// flatcc schemas:
+#include "iree/base/internal/flatcc/parsing.h"
+#include "iree/schemas/pim_executable_def_reader.h"
+#include "iree/schemas/pim_executable_def_verifier.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+typedef struct iree_hal_pim_source_location_t {
+  iree_string_view_t file_name;
+  int line;
+  iree_string_view_t func_name;
+} iree_hal_pim_source_location_t;
+
+// Creates a wrapper for one or more VkPipelines that are sourced from the same
+// IREE executable. Each of the pipelines will share the same shader module
+// and just differs by the entry point into the shader module they reference.
+// The upload of the instruction programs is profiled with |simulation| if not
+// NULL.
+iree_status_t iree_hal_pim_native_executable_create(
+    iree_allocator_t host_allocator,
+    const iree_hal_pim_sim_params_t* simulation,
+    const iree_hal_executable_params_t* executable_params,
+    iree_hal_executable_t** out_executable);
+
+// Returns true if |executable| is a PIM executable. Executables of other
+// formats prepared by the device (such as host fallbacks) are not.
+bool iree_hal_pim_native_executable_isa(iree_hal_executable_t* executable);
+
+// Returns the source location for the given entry point. May be empty if not
+// available.
+void iree_hal_pim_native_executable_entry_point_source_location(
+    iree_hal_executable_t* executable, iree_host_size_t entry_ordinal,
+    iree_hal_pim_source_location_t* out_source_location);
+
+// Returns the cached VkPipeline for the given executable |entry_ordinal|.
+iree_status_t iree_hal_pim_native_executable_pipeline_for_entry_point(
+    iree_hal_executable_t* executable, iree_host_size_t entry_ordinal,
+    VkPipeline* out_pipeline_handle);
+
+// Split of the operands of a PIM instruction across devices.
+typedef enum iree_hal_pim_split_type_e {
+  IREE_HAL_PIM_SPLIT_TYPE_NONE = 0,
+  // Split along the reduction dim; devices produce partial sums.
+  IREE_HAL_PIM_SPLIT_TYPE_COL_WISE = 1,
+  // Split along the output dim; devices produce slices of the result.
+  IREE_HAL_PIM_SPLIT_TYPE_ROW_WISE = 2,
+} iree_hal_pim_split_type_t;
+
+// Cross-device synchronization following a PIM instruction.
+typedef enum iree_hal_pim_sync_e {
+  IREE_HAL_PIM_SYNC_NONE = 0,
+  IREE_HAL_PIM_SYNC_ALL_REDUCE = 1,
+  IREE_HAL_PIM_SYNC_ALL_GATHER = 2,
+} iree_hal_pim_sync_t;
+
+// Element type of the data of a PIM instruction or binding.
+typedef enum iree_hal_pim_element_type_e {
+  IREE_HAL_PIM_ELEMENT_TYPE_F32 = 0,
+  IREE_HAL_PIM_ELEMENT_TYPE_F16 = 1,
+  IREE_HAL_PIM_ELEMENT_TYPE_BF16 = 2,
+  IREE_HAL_PIM_ELEMENT_TYPE_I8 = 3,
+} iree_hal_pim_element_type_t;
+
+// A PIM instruction decoded from its 64-bit word, the executable sync points
+// and the dims table. See pim_executable_def.fbs for the encoding.
+typedef struct iree_hal_pim_instruction_t {
+  int opcode;
+  iree_hal_pim_split_type_t split_type;
+  iree_hal_pim_sync_t sync;
+  iree_hal_pim_element_type_t element_type;
+  // Length of layer norms and softmax or m/n/k of matmuls with the batch dim
+  // first for batched matmuls. Negative dims -1 - c are provided by push
+  // constant c of the dispatch. Owned by the executable.
+  iree_host_size_t dim_count;
+  const int32_t* dims;
+  // Device address of the micro-op program of elementwise instructions (the
+  // dims following the length) uploaded when the executable is loaded or
+  // IREE_HAL_PIM_BUFFER_ADDR_NONE for other instructions.
+  int program_addr;
+} iree_hal_pim_instruction_t;
+
+// Returns the number of entry points of the executable. Linked executables
+// hold one PIM program per entry point.
+iree_host_size_t iree_hal_pim_executable_entry_point_count(
+    iree_hal_executable_t* base_executable);
+
+// Returns the PIM command stream of entry point |entry_ordinal| decoded from
+// the executable at load time and its length in |out_command_count|. The
+// storage is owned by the executable.
+const uint64_t* iree_hal_pim_executable_commands(
+    iree_hal_executable_t* base_executable, iree_host_size_t entry_ordinal,
+    iree_host_size_t* out_command_count);
+
+// Returns the instructions decoded from the commands of entry point
+// |entry_ordinal|. The storage is owned by the executable and has one entry
+// per command.
+const iree_hal_pim_instruction_t* iree_hal_pim_executable_instructions(
+    iree_hal_executable_t* base_executable, iree_host_size_t entry_ordinal);
+
+// Returns the operand slots of command |command_ordinal| of entry point
+// |entry_ordinal| and their count in |out_slot_count|. The command reads every
+// slot but the last and writes its result to the last one. Non-negative slots
+// are binding ordinals and slot -1 - i is the result of command i of the same
+// entry point kept resident on the device.
+//
+// Returns NULL if the entry point has no operand table, in which case each
+// command reads all bindings and writes its result to the last binding.
+const int32_t* iree_hal_pim_executable_operand_slots(
+    iree_hal_executable_t* base_executable, iree_host_size_t entry_ordinal,
+    iree_host_size_t command_ordinal, iree_host_size_t* out_slot_count);
+
+// Returns the compiled tensor shape of binding |binding_ordinal| of entry
+// point |entry_ordinal| and its rank in |out_rank|. The storage is owned by
+// the executable.
+//
+// Returns NULL if the executable doesn't declare a static shape for the
+// binding, in which case the binding is read with the shape of its buffer.
+const int32_t* iree_hal_pim_executable_binding_shape(
+    iree_hal_executable_t* base_executable, iree_host_size_t entry_ordinal,
+    iree_host_size_t binding_ordinal, iree_host_size_t* out_rank);
+
+// Returns the element type of binding |binding_ordinal| of entry point
+// |entry_ordinal|. Bindings hold f32 data unless the executable declares
+// otherwise.
+iree_hal_pim_element_type_t iree_hal_pim_executable_binding_element_type(
+    iree_hal_executable_t* base_executable, iree_host_size_t entry_ordinal,
+    iree_host_size_t binding_ordinal);
+
+// Returns the number of bindings of entry point |entry_ordinal| that view
+// ranges of fused dispatch bindings or 0 if the executable doesn't fuse
+// bindings, in which case binding i is dispatch binding i.
+iree_host_size_t iree_hal_pim_executable_binding_view_count(
+    iree_hal_executable_t* base_executable, iree_host_size_t entry_ordinal);
+
+// Returns the dispatch binding viewed by binding |binding_ordinal| of entry
+// point |entry_ordinal| in |out_source_ordinal| and the byte offset of the
+// view within it in |out_byte_offset|. Negative offsets -1 - c are provided by
+// push constant c of the dispatch. |binding_ordinal| must be less than
+// iree_hal_pim_executable_binding_view_count.
+void iree_hal_pim_executable_binding_view(
+    iree_hal_executable_t* base_executable, iree_host_size_t entry_ordinal,
+    iree_host_size_t binding_ordinal, uint32_t* out_source_ordinal,
+    int32_t* out_byte_offset);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_PIM_NATIVE_EXECUTABLE_H_
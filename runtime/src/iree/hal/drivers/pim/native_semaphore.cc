@@ -0,0 +1,406 @@
+// Copyright 2019 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/pim/native_semaphore.h"
+
+#include <cinttypes>
+#include <cstddef>
+#include <cstring>
+
+#include "iree/base/api.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/utils/semaphore_base.h"
+
+// The maximum valid payload value of an iree_hal_semaphore_t.
+// Payload values larger than this indicate that the semaphore has failed.
+//
+// This originates from Vulkan having a lower-bound of INT_MAX for
+// maxTimelineSemaphoreValueDifference and many Android devices only supporting
+// that lower-bound. At ~100 signals per second it'll take 1.5+ years to
+// saturate. We may increase this value at some point but so long as there are
+// some devices in the wild that may have this limitation we can ensure better
+// consistency across the backends by observing this.
+//
+// The major mitigation here is that in proper usage of IREE there are no
+// semaphores that are implicitly referenced by multiple VMs (each creates their
+// own internally) and in a multitenant system each session should have its own
+// semaphores - so even if the process lives for years it's highly unlikely any
+// particular session does. Whatever, 640K is enough for anyone.
+//
+// See:
+//   https://vulkan.gpuinfo.org/displayextensionproperty.php?name=maxTimelineSemaphoreValueDifference
+#define IREE_HAL_PIM_SEMAPHORE_MAX_VALUE (2147483647ull - 1)
+
+// Sentinel used when the semaphore has failed and an error status is set.
+#define IREE_HAL_PIM_SEMAPHORE_FAILURE_VALUE UINT64_MAX
+
+//===----------------------------------------------------------------------===//
+// iree_hal_pim_native_semaphore_state_t
+//===----------------------------------------------------------------------===//
+
+iree_hal_pim_native_semaphore_state_t*
+iree_hal_pim_native_semaphore_process_state(void) {
+  static iree_hal_pim_native_semaphore_state_t state;
+  static bool initialized =
+      (iree_notification_initialize(&state.notification), true);
+  (void)initialized;
+  return &state;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_pim_native_semaphore_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_hal_pim_native_semaphore_t {
+  iree_hal_semaphore_t base;
+  iree_allocator_t host_allocator;
+
+  // Shared across all semaphores in the process.
+  iree_hal_pim_native_semaphore_state_t* shared_state;
+
+  // Posted when this semaphore is signaled or fails. Single-semaphore waits
+  // (the common case for chained queue submissions) await only this.
+  iree_notification_t notification;
+
+  // Guards all mutable fields below.
+  iree_slim_mutex_t mutex;
+
+  // Current signaled value. May be IREE_HAL_PIM_SEMAPHORE_FAILURE_VALUE to
+  // indicate that the semaphore has been signaled for failure and
+  // |failure_status| contains the error.
+  uint64_t current_value;
+
+  // OK or the status passed to iree_hal_semaphore_fail. Owned by the semaphore.
+  iree_status_t failure_status;
+} iree_hal_pim_native_semaphore_t;
+
+namespace {
+extern const iree_hal_semaphore_vtable_t
+    iree_hal_pim_native_semaphore_vtable;
+}  // namespace
+
+static iree_hal_pim_native_semaphore_t*
+iree_hal_pim_native_semaphore_cast(iree_hal_semaphore_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_pim_native_semaphore_vtable);
+  return (iree_hal_pim_native_semaphore_t*)base_value;
+}
+
+iree_status_t iree_hal_pim_native_semaphore_create(
+    iree_allocator_t host_allocator, uint64_t initial_value,
+    iree_hal_semaphore_t** out_semaphore) {
+  IREE_ASSERT_ARGUMENT(out_semaphore);
+  *out_semaphore = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_pim_native_semaphore_t* semaphore = NULL;
+  iree_status_t status = iree_allocator_malloc(
+      host_allocator, sizeof(*semaphore), (void**)&semaphore);
+  if (iree_status_is_ok(status)) {
+    iree_hal_semaphore_initialize(&iree_hal_pim_native_semaphore_vtable,
+                                  &semaphore->base);
+    semaphore->host_allocator = host_allocator;
+    semaphore->shared_state = iree_hal_pim_native_semaphore_process_state();
+    iree_notification_initialize(&semaphore->notification);
+
+    iree_slim_mutex_initialize(&semaphore->mutex);
+    semaphore->current_value = initial_value;
+    semaphore->failure_status = iree_ok_status();
+
+    *out_semaphore = &semaphore->base;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_pim_native_semaphore_destroy(
+    iree_hal_semaphore_t* base_semaphore) {
+  iree_hal_pim_native_semaphore_t* semaphore =
+      iree_hal_pim_native_semaphore_cast(base_semaphore);
+  iree_allocator_t host_allocator = semaphore->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_notification_deinitialize(&semaphore->notification);
+  iree_slim_mutex_deinitialize(&semaphore->mutex);
+  iree_status_ignore(semaphore->failure_status);
+
+  iree_hal_semaphore_deinitialize(&semaphore->base);
+  iree_allocator_free(host_allocator, semaphore);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+bool iree_hal_pim_native_semaphore_isa(iree_hal_semaphore_t* semaphore) {
+  return iree_hal_resource_is(&semaphore->resource,
+                              &iree_hal_pim_native_semaphore_vtable);
+}
+
+static iree_status_t iree_hal_pim_native_semaphore_query(
+    iree_hal_semaphore_t* base_semaphore, uint64_t* out_value) {
+  iree_hal_pim_native_semaphore_t* semaphore =
+      iree_hal_pim_native_semaphore_cast(base_semaphore);
+
+  iree_slim_mutex_lock(&semaphore->mutex);
+
+  *out_value = semaphore->current_value;
+
+  iree_status_t status = iree_ok_status();
+  if (*out_value >= IREE_HAL_PIM_SEMAPHORE_FAILURE_VALUE) {
+    status = iree_status_clone(semaphore->failure_status);
+  }
+
+  iree_slim_mutex_unlock(&semaphore->mutex);
+
+  return status;
+}
+
+static iree_status_t iree_hal_pim_native_semaphore_signal(
+    iree_hal_semaphore_t* base_semaphore, uint64_t new_value) {
+  iree_hal_pim_native_semaphore_t* semaphore =
+      iree_hal_pim_native_semaphore_cast(base_semaphore);
+
+  if (new_value > IREE_HAL_PIM_SEMAPHORE_MAX_VALUE) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "semaphore payload value %" PRIu64
+                            " exceeds the maximum supported value",
+                            new_value);
+  }
+
+  iree_slim_mutex_lock(&semaphore->mutex);
+
+  if (new_value <= semaphore->current_value) {
+    uint64_t current_value IREE_ATTRIBUTE_UNUSED = semaphore->current_value;
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "semaphore values must be monotonically "
+                            "increasing; current_value=%" PRIu64
+                            ", new_value=%" PRIu64,
+                            current_value, new_value);
+  }
+  semaphore->current_value = new_value;
+
+  iree_slim_mutex_unlock(&semaphore->mutex);
+
+  // Notify timepoints of the new value.
+  iree_hal_semaphore_notify(&semaphore->base, new_value, IREE_STATUS_OK);
+
+  // Wake any waiters so they can check whether they are satisfied.
+  iree_notification_post(&semaphore->notification, IREE_ALL_WAITERS);
+  iree_notification_post(&semaphore->shared_state->notification,
+                         IREE_ALL_WAITERS);
+
+  return iree_ok_status();
+}
+
+static void iree_hal_pim_native_semaphore_fail(
+    iree_hal_semaphore_t* base_semaphore, iree_status_t status) {
+  iree_hal_pim_native_semaphore_t* semaphore =
+      iree_hal_pim_native_semaphore_cast(base_semaphore);
+  const iree_status_code_t status_code = iree_status_code(status);
+
+  iree_slim_mutex_lock(&semaphore->mutex);
+
+  // Only the first failure is preserved.
+  if (!iree_status_is_ok(semaphore->failure_status)) {
+    IREE_IGNORE_ERROR(status);
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    return;
+  }
+
+  semaphore->current_value = IREE_HAL_PIM_SEMAPHORE_FAILURE_VALUE;
+  semaphore->failure_status = status;
+
+  iree_slim_mutex_unlock(&semaphore->mutex);
+
+  // Notify timepoints of the failure.
+  iree_hal_semaphore_notify(&semaphore->base,
+                            IREE_HAL_PIM_SEMAPHORE_FAILURE_VALUE,
+                            status_code);
+
+  iree_notification_post(&semaphore->notification, IREE_ALL_WAITERS);
+  iree_notification_post(&semaphore->shared_state->notification,
+                         IREE_ALL_WAITERS);
+}
+
+typedef struct iree_hal_pim_native_semaphore_notify_state_t {
+  iree_hal_pim_native_semaphore_t* semaphore;
+  uint64_t value;
+} iree_hal_pim_native_semaphore_notify_state_t;
+
+// Returns true if the semaphore in |state| reached its value (or failed).
+// Used with iree_condition_fn_t and must match that signature.
+static bool iree_hal_pim_native_semaphore_is_signaled(
+    iree_hal_pim_native_semaphore_notify_state_t* state) {
+  iree_hal_pim_native_semaphore_t* semaphore = state->semaphore;
+  iree_slim_mutex_lock(&semaphore->mutex);
+  bool is_signaled = semaphore->current_value >= state->value ||
+                     !iree_status_is_ok(semaphore->failure_status);
+  iree_slim_mutex_unlock(&semaphore->mutex);
+  return is_signaled;
+}
+
+static iree_status_t iree_hal_pim_native_semaphore_wait(
+    iree_hal_semaphore_t* base_semaphore, uint64_t value,
+    iree_timeout_t timeout) {
+  iree_hal_pim_native_semaphore_t* semaphore =
+      iree_hal_pim_native_semaphore_cast(base_semaphore);
+
+  // Try to see if we can return immediately.
+  iree_slim_mutex_lock(&semaphore->mutex);
+  if (!iree_status_is_ok(semaphore->failure_status)) {
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    return iree_status_from_code(IREE_STATUS_ABORTED);
+  } else if (semaphore->current_value >= value) {
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    return iree_ok_status();
+  } else if (iree_timeout_is_immediate(timeout)) {
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+  }
+  iree_slim_mutex_unlock(&semaphore->mutex);
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_pim_native_semaphore_notify_state_t notify_state;
+  notify_state.semaphore = semaphore;
+  notify_state.value = value;
+  iree_notification_await(
+      &semaphore->notification,
+      (iree_condition_fn_t)iree_hal_pim_native_semaphore_is_signaled,
+      (void*)&notify_state, timeout);
+
+  iree_status_t status = iree_ok_status();
+  iree_slim_mutex_lock(&semaphore->mutex);
+  if (!iree_status_is_ok(semaphore->failure_status)) {
+    status = iree_status_from_code(IREE_STATUS_ABORTED);
+  } else if (semaphore->current_value < value) {
+    status = iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+  }
+  iree_slim_mutex_unlock(&semaphore->mutex);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Returns true if any semaphore in the list has signaled (or failed).
+// Used with iree_condition_fn_t and must match that signature.
+static bool iree_hal_pim_native_semaphore_any_signaled(
+    const iree_hal_semaphore_list_t* semaphore_list) {
+  for (iree_host_size_t i = 0; i < semaphore_list->count; ++i) {
+    iree_hal_pim_native_semaphore_notify_state_t state;
+    state.semaphore =
+        iree_hal_pim_native_semaphore_cast(semaphore_list->semaphores[i]);
+    state.value = semaphore_list->payload_values[i];
+    if (iree_hal_pim_native_semaphore_is_signaled(&state)) return true;
+  }
+  return false;
+}
+
+// Returns a status derived from the |semaphore_list| at the current time:
+// - IREE_STATUS_OK: any or all semaphores signaled (based on |wait_mode|).
+// - IREE_STATUS_ABORTED: one or more semaphores failed.
+// - IREE_STATUS_DEADLINE_EXCEEDED: any or all semaphores unsignaled.
+static iree_status_t iree_hal_pim_native_semaphore_result_from_state(
+    iree_hal_wait_mode_t wait_mode,
+    const iree_hal_semaphore_list_t semaphore_list) {
+  bool any_signaled = false;
+  bool all_signaled = true;
+  bool any_failed = false;
+  for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+    iree_hal_pim_native_semaphore_t* semaphore =
+        iree_hal_pim_native_semaphore_cast(semaphore_list.semaphores[i]);
+    iree_slim_mutex_lock(&semaphore->mutex);
+    if (!iree_status_is_ok(semaphore->failure_status)) {
+      any_failed = true;
+    } else if (semaphore->current_value < semaphore_list.payload_values[i]) {
+      all_signaled = false;
+    } else {
+      any_signaled = true;
+    }
+    iree_slim_mutex_unlock(&semaphore->mutex);
+  }
+  if (any_failed) {
+    return iree_status_from_code(IREE_STATUS_ABORTED);
+  }
+  switch (wait_mode) {
+    default:
+    case IREE_HAL_WAIT_MODE_ALL:
+      return all_signaled
+                 ? iree_ok_status()
+                 : iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+    case IREE_HAL_WAIT_MODE_ANY:
+      return any_signaled
+                 ? iree_ok_status()
+                 : iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+  }
+}
+
+bool iree_hal_pim_native_semaphore_list_isa(
+    const iree_hal_semaphore_list_t semaphore_list) {
+  for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+    if (!iree_hal_pim_native_semaphore_isa(semaphore_list.semaphores[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+iree_status_t iree_hal_pim_native_semaphore_multi_wait(
+    iree_hal_wait_mode_t wait_mode,
+    const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout) {
+  if (semaphore_list.count == 0) {
+    return iree_ok_status();
+  } else if (semaphore_list.count == 1) {
+    // Fast-path for a single semaphore.
+    return iree_hal_semaphore_wait(semaphore_list.semaphores[0],
+                                   semaphore_list.payload_values[0], timeout);
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  if (wait_mode == IREE_HAL_WAIT_MODE_ALL &&
+      !iree_timeout_is_immediate(timeout)) {
+    // Every semaphore has to be reached anyway so wait on each in turn; this
+    // avoids waking on signals of semaphores outside of the list.
+    iree_convert_timeout_to_absolute(&timeout);
+    for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+      iree_hal_pim_native_semaphore_notify_state_t notify_state;
+      notify_state.semaphore =
+          iree_hal_pim_native_semaphore_cast(semaphore_list.semaphores[i]);
+      notify_state.value = semaphore_list.payload_values[i];
+      if (!iree_notification_await(
+              &notify_state.semaphore->notification,
+              (iree_condition_fn_t)iree_hal_pim_native_semaphore_is_signaled,
+              (void*)&notify_state, timeout)) {
+        break;
+      }
+    }
+  } else if (!iree_timeout_is_immediate(timeout)) {
+    iree_hal_pim_native_semaphore_state_t* shared_state =
+        iree_hal_pim_native_semaphore_process_state();
+    iree_notification_await(
+        &shared_state->notification,
+        (iree_condition_fn_t)iree_hal_pim_native_semaphore_any_signaled,
+        (void*)&semaphore_list, timeout);
+  }
+
+  // We may have been successful - or may have a partial failure.
+  iree_status_t status = iree_hal_pim_native_semaphore_result_from_state(
+      wait_mode, semaphore_list);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+namespace {
+const iree_hal_semaphore_vtable_t iree_hal_pim_native_semaphore_vtable = {
+    /*.destroy=*/iree_hal_pim_native_semaphore_destroy,
+    /*.query=*/iree_hal_pim_native_semaphore_query,
+    /*.signal=*/iree_hal_pim_native_semaphore_signal,
+    /*.fail=*/iree_hal_pim_native_semaphore_fail,
+    /*.wait=*/iree_hal_pim_native_semaphore_wait,
+};
+}  // namespace
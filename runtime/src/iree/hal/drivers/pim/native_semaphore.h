@@ -0,0 +1,64 @@
+// Copyright 2019 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_PIM_NATIVE_SEMAPHORE_H_
+#define IREE_HAL_DRIVERS_PIM_NATIVE_SEMAPHORE_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// State shared by all semaphores created from any PIM device in the process.
+// Any semaphore signal or failure posts the notification so that wait-any
+// multi-waits spanning several semaphores can be woken without per-semaphore
+// wait handles. All PIM devices drive the same process-wide SDK so semaphores
+// from one device can be waited on by the queues of any other.
+typedef struct iree_hal_pim_native_semaphore_state_t {
+  iree_notification_t notification;
+} iree_hal_pim_native_semaphore_state_t;
+
+// Returns the process-wide semaphore state. It is never deinitialized.
+iree_hal_pim_native_semaphore_state_t*
+iree_hal_pim_native_semaphore_process_state(void);
+
+// Creates a timeline semaphore used to order PIM queue submissions.
+// The PIM SDK has no synchronization primitives so timelines are advanced by
+// the queue threads as submissions retire. Each semaphore has a notification
+// of its own so that a queue chained behind another PIM queue (or device) is
+// only woken by the semaphore it is waiting on.
+iree_status_t iree_hal_pim_native_semaphore_create(
+    iree_allocator_t host_allocator, uint64_t initial_value,
+    iree_hal_semaphore_t** out_semaphore);
+
+// Returns true if |semaphore| is a PIM native semaphore.
+bool iree_hal_pim_native_semaphore_isa(iree_hal_semaphore_t* semaphore);
+
+// Returns true if all semaphores in |semaphore_list| are PIM native semaphores.
+bool iree_hal_pim_native_semaphore_list_isa(
+    const iree_hal_semaphore_list_t semaphore_list);
+
+// Performs a multi-wait on one or more semaphores.
+// All semaphores in |semaphore_list| must be PIM native semaphores but may
+// have been created by different PIM devices. Wait-all waits block on each
+// semaphore's own notification in turn and are not woken by unrelated signals.
+//
+// Returns IREE_STATUS_DEADLINE_EXCEEDED if the wait does not complete before
+// |timeout| elapses and IREE_STATUS_ABORTED if any semaphore has failed.
+iree_status_t iree_hal_pim_native_semaphore_multi_wait(
+    iree_hal_wait_mode_t wait_mode,
+    const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_PIM_NATIVE_SEMAPHORE_H_
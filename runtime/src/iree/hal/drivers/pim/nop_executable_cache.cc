@@ -4,52 +4,58 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
-#include "iree/hal/drivers/vulkan/nop_executable_cache.h"
+#include "iree/hal/drivers/pim/nop_executable_cache.h"
 
 #include <cstddef>
 
 #include "iree/base/api.h"
 #include "iree/base/tracing.h"
-#include "iree/hal/drivers/vulkan/dynamic_symbol_tables.h"
-#include "iree/hal/drivers/vulkan/native_executable.h"
+#include "iree/hal/drivers/pim/dynamic_symbol_tables.h"
+#include "iree/hal/drivers/pim/native_executable.h"
 
-using namespace iree::hal::vulkan;
+using namespace iree::hal::pim;
 
-typedef struct iree_hal_vulkan_nop_executable_cache_t {
+typedef struct iree_hal_pim_nop_executable_cache_t {
   iree_hal_resource_t resource;
 
   iree_allocator_t host_allocator;
-} iree_hal_vulkan_nop_executable_cache_t;
+  // Latency model of the device uploads are profiled with if |simulated|.
+  bool simulated;
+  iree_hal_pim_sim_params_t simulation;
+} iree_hal_pim_nop_executable_cache_t;
 
 namespace {
 extern const iree_hal_executable_cache_vtable_t
-    iree_hal_vulkan_nop_executable_cache_vtable;
+    iree_hal_pim_nop_executable_cache_vtable;
 }  // namespace
 
-static iree_hal_vulkan_nop_executable_cache_t*
-iree_hal_vulkan_nop_executable_cache_cast(
+static iree_hal_pim_nop_executable_cache_t*
+iree_hal_pim_nop_executable_cache_cast(
     iree_hal_executable_cache_t* base_value) {
   IREE_HAL_ASSERT_TYPE(base_value,
-                       &iree_hal_vulkan_nop_executable_cache_vtable);
-  return (iree_hal_vulkan_nop_executable_cache_t*)base_value;
+                       &iree_hal_pim_nop_executable_cache_vtable);
+  return (iree_hal_pim_nop_executable_cache_t*)base_value;
 }
 
-iree_status_t iree_hal_vulkan_nop_executable_cache_create(
+iree_status_t iree_hal_pim_nop_executable_cache_create(
     iree_allocator_t host_allocator,
     iree_string_view_t identifier,
+    const iree_hal_pim_sim_params_t* simulation,
     iree_hal_executable_cache_t** out_executable_cache) {
   IREE_ASSERT_ARGUMENT(out_executable_cache);
   *out_executable_cache = NULL;
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  iree_hal_vulkan_nop_executable_cache_t* executable_cache = NULL;
+  iree_hal_pim_nop_executable_cache_t* executable_cache = NULL;
   iree_status_t status = iree_allocator_malloc(host_allocator,
                                                sizeof(*executable_cache),
                                                (void**)&executable_cache);
   if (iree_status_is_ok(status)) {
-    iree_hal_resource_initialize(&iree_hal_vulkan_nop_executable_cache_vtable,
+    iree_hal_resource_initialize(&iree_hal_pim_nop_executable_cache_vtable,
                                  &executable_cache->resource);
     executable_cache->host_allocator = host_allocator;
+    executable_cache->simulated = simulation != NULL;
+    if (simulation) executable_cache->simulation = *simulation;
 
     *out_executable_cache = (iree_hal_executable_cache_t*)executable_cache;
   }
@@ -58,10 +64,10 @@ iree_status_t iree_hal_vulkan_nop_executable_cache_create(
   return status;
 }
 
-static void iree_hal_vulkan_nop_executable_cache_destroy(
+static void iree_hal_pim_nop_executable_cache_destroy(
     iree_hal_executable_cache_t* base_executable_cache) {
-  iree_hal_vulkan_nop_executable_cache_t* executable_cache =
-      iree_hal_vulkan_nop_executable_cache_cast(base_executable_cache);
+  iree_hal_pim_nop_executable_cache_t* executable_cache =
+      iree_hal_pim_nop_executable_cache_cast(base_executable_cache);
   iree_allocator_t host_allocator =
       executable_cache->host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -71,7 +77,7 @@ static void iree_hal_vulkan_nop_executable_cache_destroy(
   IREE_TRACE_ZONE_END(z0);
 }
 
-static bool iree_hal_vulkan_nop_executable_cache_can_prepare_format(
+static bool iree_hal_pim_nop_executable_cache_can_prepare_format(
     iree_hal_executable_cache_t* base_executable_cache,
     iree_hal_executable_caching_mode_t caching_mode,
     iree_string_view_t executable_format) {
@@ -79,24 +85,25 @@ static bool iree_hal_vulkan_nop_executable_cache_can_prepare_format(
                                 iree_make_cstring_view("SPVE"));
 }
 
-static iree_status_t iree_hal_vulkan_nop_executable_cache_prepare_executable(
+static iree_status_t iree_hal_pim_nop_executable_cache_prepare_executable(
     iree_hal_executable_cache_t* base_executable_cache,
     const iree_hal_executable_params_t* executable_params,
     iree_hal_executable_t** out_executable) {
-  iree_hal_vulkan_nop_executable_cache_t* executable_cache =
-      iree_hal_vulkan_nop_executable_cache_cast(base_executable_cache);
-  return iree_hal_vulkan_native_executable_create(
+  iree_hal_pim_nop_executable_cache_t* executable_cache =
+      iree_hal_pim_nop_executable_cache_cast(base_executable_cache);
+  return iree_hal_pim_native_executable_create(
       executable_cache->host_allocator,
+      executable_cache->simulated ? &executable_cache->simulation : NULL,
       executable_params, out_executable);
 }
 
 namespace {
 const iree_hal_executable_cache_vtable_t
-    iree_hal_vulkan_nop_executable_cache_vtable = {
-        /*.destroy=*/iree_hal_vulkan_nop_executable_cache_destroy,
+    iree_hal_pim_nop_executable_cache_vtable = {
+        /*.destroy=*/iree_hal_pim_nop_executable_cache_destroy,
         /*.can_prepare_format=*/
-        iree_hal_vulkan_nop_executable_cache_can_prepare_format,
+        iree_hal_pim_nop_executable_cache_can_prepare_format,
         /*.prepare_executable=*/
-        iree_hal_vulkan_nop_executable_cache_prepare_executable,
+        iree_hal_pim_nop_executable_cache_prepare_executable,
 };
 }  // namespace
@@ -4,12 +4,13 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
-#ifndef IREE_HAL_DRIVERS_VULKAN_NOP_EXECUTABLE_CACHE_H_
-#define IREE_HAL_DRIVERS_VULKAN_NOP_EXECUTABLE_CACHE_H_
+#ifndef IREE_HAL_DRIVERS_PIM_NOP_EXECUTABLE_CACHE_H_
+#define IREE_HAL_DRIVERS_PIM_NOP_EXECUTABLE_CACHE_H_
 
 #include "iree/base/api.h"
 #include "iree/hal/api.h"
-#include "iree/hal/drivers/vulkan/handle_util.h"
+#include "iree/hal/drivers/pim/handle_util.h"
+#include "iree/hal/drivers/pim/util/pim_sim_model.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -17,14 +18,16 @@ extern "C" {
 
 // Creates a no-op executable cache that does not cache at all.
 // This is useful to isolate pipeline caching behavior and verify compilation
-// behavior.
-iree_status_t iree_hal_vulkan_nop_executable_cache_create(
+// behavior. Uploads made while preparing executables are profiled with
+// |simulation| (copied) if not NULL.
+iree_status_t iree_hal_pim_nop_executable_cache_create(
     iree_allocator_t host_allocator,
     iree_string_view_t identifier,
+    const iree_hal_pim_sim_params_t* simulation,
     iree_hal_executable_cache_t** out_executable_cache);
 
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
 
-#endif  // IREE_HAL_DRIVERS_VULKAN_NOP_EXECUTABLE_CACHE_H_
+#endif  // IREE_HAL_DRIVERS_PIM_NOP_EXECUTABLE_CACHE_H_
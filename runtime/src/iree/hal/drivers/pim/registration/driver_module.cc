@@ -0,0 +1,139 @@
+// Copyright 2020 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/pim/registration/driver_module.h"
+
+#include <cinttypes>
+#include <cstddef>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/flags.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/drivers/pim/api.h"
+
+IREE_FLAG(
+    int32_t, pim_queue_count, 1,
+    "Number of PIM modules exposed as device queues selected by affinity.");
+IREE_FLAG(
+    bool, pim_double_buffered_results, false,
+    "Streams host-mappable dispatch results back on the queue thread into "
+    "double-buffered host storage.");
+IREE_FLAG(
+    bool, pim_host_overlap, false,
+    "Runs host fallback dispatches on a worker thread alongside independent "
+    "PIM dispatches of the same submission.");
+IREE_FLAG(
+    int64_t, pim_residency_capacity, 0,
+    "Bytes of model weights kept on each PIM device before the least recently "
+    "used models are evicted to host memory (0 keeps all weights resident).");
+IREE_FLAG(
+    int32_t, pim_queue_thread_priority, 0,
+    "Priority class of the PIM queue submission threads from -2 (lowest) to "
+    "2 (highest).");
+IREE_FLAG(
+    int32_t, pim_queue_thread_cpu, -1,
+    "CPU the first PIM queue submission thread is pinned to with queue i on "
+    "the CPU after it (-1 lets the system place the threads). Must leave room "
+    "for all queues within the online CPUs. Every device created by the "
+    "driver uses the same CPUs.");
+
+IREE_FLAG(int32_t, pim_sim_bank_count, 512,
+          "Banks of each simulated PIM module working in parallel (pim-sim).");
+IREE_FLAG(int32_t, pim_sim_row_buffer_bytes, 2048,
+          "Row buffer size of each simulated PIM bank in bytes (pim-sim).");
+IREE_FLAG(double, pim_sim_row_cycle_ns, 48.0,
+          "Time to activate, read and precharge one simulated row (pim-sim).");
+IREE_FLAG(double, pim_sim_bank_macs_per_ns, 16.0,
+          "Multiply-accumulates per simulated bank per nanosecond (pim-sim).");
+IREE_FLAG(double, pim_sim_host_gbps, 16.0,
+          "Simulated host<->PIM transfer bandwidth in GB/s (pim-sim).");
+IREE_FLAG(double, pim_sim_link_gbps, 25.0,
+          "Simulated PIM<->PIM collective bandwidth in GB/s (pim-sim).");
+
+static iree_status_t iree_hal_pim_create_driver_with_flags(
+    iree_string_view_t identifier, iree_allocator_t host_allocator,
+    iree_hal_driver_t** out_driver) {
+  IREE_TRACE_SCOPE();
+
+  iree_hal_pim_driver_options_t driver_options;
+  iree_hal_pim_driver_options_initialize(&driver_options);
+  driver_options.device_options.queue_count =
+      (iree_host_size_t)FLAG_pim_queue_count;
+  driver_options.device_options.pim_residency_capacity =
+      (iree_device_size_t)FLAG_pim_residency_capacity;
+  driver_options.device_options.pim_queue_thread_priority =
+      FLAG_pim_queue_thread_priority;
+  driver_options.device_options.pim_queue_thread_cpu =
+      FLAG_pim_queue_thread_cpu;
+  if (FLAG_pim_double_buffered_results) {
+    driver_options.device_options.flags |=
+        IREE_HAL_PIM_DEVICE_FLAG_DOUBLE_BUFFERED_RESULTS;
+  }
+  if (FLAG_pim_host_overlap) {
+    driver_options.device_options.flags |=
+        IREE_HAL_PIM_DEVICE_FLAG_HOST_OVERLAP;
+  }
+  if (iree_string_view_equal(identifier, IREE_SV("pim-sim"))) {
+    iree_hal_pim_sim_params_t* simulation =
+        &driver_options.device_options.simulation;
+    driver_options.device_options.flags |=
+        IREE_HAL_PIM_DEVICE_FLAG_SIMULATION;
+    simulation->bank_count = (uint32_t)FLAG_pim_sim_bank_count;
+    simulation->row_buffer_bytes = (uint32_t)FLAG_pim_sim_row_buffer_bytes;
+    simulation->row_cycle_ns = FLAG_pim_sim_row_cycle_ns;
+    simulation->bank_macs_per_ns = FLAG_pim_sim_bank_macs_per_ns;
+    simulation->host_bytes_per_ns = FLAG_pim_sim_host_gbps;
+    simulation->link_bytes_per_ns = FLAG_pim_sim_link_gbps;
+  }
+
+  iree_status_t status = iree_hal_pim_driver_create(
+      identifier, &driver_options, host_allocator, out_driver);
+
+  return status;
+}
+
+static iree_status_t iree_hal_pim_driver_factory_enumerate(
+    void* self, iree_host_size_t* out_driver_info_count,
+    const iree_hal_driver_info_t** out_driver_infos) {
+  // NOTE: we could query supported vulkan versions or featuresets here.
+  static const iree_hal_driver_info_t driver_infos[2] = {
+      {
+          /*driver_name=*/iree_make_cstring_view("PIM"),
+          /*full_name=*/iree_make_cstring_view("{PIM_SDK} driver"),
+      },
+      {
+          /*driver_name=*/iree_make_cstring_view("pim-sim"),
+          /*full_name=*/iree_make_cstring_view(
+              "{PIM_SDK} driver with modeled PIM latencies"),
+      },
+  };
+  *out_driver_info_count = IREE_ARRAYSIZE(driver_infos);
+  *out_driver_infos = driver_infos;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_pim_driver_factory_try_create(
+    void* self, iree_string_view_t driver_name, iree_allocator_t host_allocator,
+    iree_hal_driver_t** out_driver) {
+  if (!iree_string_view_equal(driver_name, IREE_SV("PIM")) &&
+      !iree_string_view_equal(driver_name, IREE_SV("pim-sim"))) {
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "no driver '%.*s' is provided by this factory",
+                            (int)driver_name.size, driver_name.data);
+  }
+  return iree_hal_pim_create_driver_with_flags(driver_name, host_allocator,
+                                                  out_driver);
+}
+
+IREE_API_EXPORT iree_status_t
+iree_hal_pim_driver_module_register(iree_hal_driver_registry_t* registry) {
+  static const iree_hal_driver_factory_t factory = {
+      /*self=*/NULL,
+      iree_hal_pim_driver_factory_enumerate,
+      iree_hal_pim_driver_factory_try_create,
+  };
+  return iree_hal_driver_registry_register_factory(registry, &factory);
+}
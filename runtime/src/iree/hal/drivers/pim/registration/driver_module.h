@@ -4,8 +4,8 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
-#ifndef IREE_HAL_DRIVERS_VULKAN_REGISTRATION_DRIVER_MODULE_H_
-#define IREE_HAL_DRIVERS_VULKAN_REGISTRATION_DRIVER_MODULE_H_
+#ifndef IREE_HAL_DRIVERS_PIM_REGISTRATION_DRIVER_MODULE_H_
+#define IREE_HAL_DRIVERS_PIM_REGISTRATION_DRIVER_MODULE_H_
 
 #include "iree/base/api.h"
 #include "iree/hal/api.h"
@@ -15,10 +15,10 @@ extern "C" {
 #endif  // __cplusplus
 
 IREE_API_EXPORT iree_status_t
-iree_hal_vulkan_driver_module_register(iree_hal_driver_registry_t* registry);
+iree_hal_pim_driver_module_register(iree_hal_driver_registry_t* registry);
 
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
 
-#endif  // IREE_HAL_DRIVERS_VULKAN_REGISTRATION_DRIVER_MODULE_H_
+#endif  // IREE_HAL_DRIVERS_PIM_REGISTRATION_DRIVER_MODULE_H_
@@ -4,11 +4,10 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
-#include "iree/hal/drivers/vulkan/status_util.h"
+#include "iree/hal/drivers/pim/status_util.h"
 
-iree_status_t iree_hal_vulkan_result_to_status(VkResult result,
-                                               const char* file,
-                                               uint32_t line) {
+iree_status_t iree_hal_pim_result_to_status(VkResult result, const char* file,
+                                            uint32_t line) {
   switch (result) {
     // Success codes.
     case VK_SUCCESS:
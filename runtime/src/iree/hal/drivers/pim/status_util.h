@@ -4,11 +4,11 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
-#ifndef IREE_HAL_DRIVERS_VULKAN_STATUS_UTIL_H_
-#define IREE_HAL_DRIVERS_VULKAN_STATUS_UTIL_H_
+#ifndef IREE_HAL_DRIVERS_PIM_STATUS_UTIL_H_
+#define IREE_HAL_DRIVERS_PIM_STATUS_UTIL_H_
 
 // clang-format off: must be included before all other headers.
-#include "iree/hal/drivers/vulkan/vulkan_headers.h"
+#include "iree/hal/drivers/pim/vulkan_headers.h"
 // clang-format on
 
 #include <stdint.h>
@@ -24,7 +24,7 @@ extern "C" {
 // Usage:
 //   iree_status_t status = VK_RESULT_TO_STATUS(vkDoThing(...));
 #define VK_RESULT_TO_STATUS(expr, ...) \
-  iree_hal_vulkan_result_to_status((expr), __FILE__, __LINE__)
+  iree_hal_pim_result_to_status((expr), __FILE__, __LINE__)
 
 // IREE_RETURN_IF_ERROR but implicitly converts the VkResult return value to
 // a Status.
@@ -33,7 +33,7 @@ extern "C" {
 //   VK_RETURN_IF_ERROR(vkDoThing(...), "message");
 #define VK_RETURN_IF_ERROR(expr, ...) \
   IREE_RETURN_IF_ERROR(               \
-      iree_hal_vulkan_result_to_status(expr, __FILE__, __LINE__), __VA_ARGS__)
+      iree_hal_pim_result_to_status(expr, __FILE__, __LINE__), __VA_ARGS__)
 
 // IREE_CHECK_OK but implicitly converts the VkResults return value to a
 // Status and checks that it is OkStatus.
@@ -41,7 +41,7 @@ extern "C" {
 // Usage:
 //   VK_CHECK_OK(vkDoThing(...));
 #define VK_CHECK_OK(expr) \
-  IREE_CHECK_OK(iree_hal_vulkan_result_to_status(expr, __FILE__, __LINE__))
+  IREE_CHECK_OK(iree_hal_pim_result_to_status(expr, __FILE__, __LINE__))
 
 // Converts a VkResult to a Status object.
 //
@@ -83,11 +83,11 @@ extern "C" {
 // - VK_ERROR_NOT_PERMITTED_EXT           -> PermissionDeniedError("VK...")
 // - VK_ERROR_INVALID_DEVICE_ADDRESS_EXT  -> OutOfRangeError("VK...")
 // - VK_ERROR_FULL_SCREEN_EXCLUSIVE_MODE_LOST_EXT -> InternalError("VK...")
-iree_status_t iree_hal_vulkan_result_to_status(VkResult result,
-                                               const char* file, uint32_t line);
+iree_status_t iree_hal_pim_result_to_status(VkResult result, const char* file,
+                                            uint32_t line);
 
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
 
-#endif  // IREE_HAL_DRIVERS_VULKAN_STATUS_UTIL_H_
+#endif  // IREE_HAL_DRIVERS_PIM_STATUS_UTIL_H_
@@ -4,7 +4,7 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
-#include "iree/hal/drivers/vulkan/tracing.h"
+#include "iree/hal/drivers/pim/tracing.h"
 
 #if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
 
@@ -14,24 +14,24 @@
 // Total number of queries the per-queue query pool will contain. This
 // translates to the maximum number of outstanding queries before collection is
 // required.
-#define IREE_HAL_VULKAN_TRACING_DEFAULT_QUERY_CAPACITY (32 * 1024)
+#define IREE_HAL_PIM_TRACING_DEFAULT_QUERY_CAPACITY (32 * 1024)
 
 // Total number of queries that can be read back from the API in a single
 // collection.
-#define IREE_HAL_VULKAN_TRACING_READBACK_QUERY_CAPACITY (8 * 1024)
+#define IREE_HAL_PIM_TRACING_READBACK_QUERY_CAPACITY (8 * 1024)
 
 // Number of times we will query the max_deviation from calibrated timestamps.
 // The more we do the better confidence we have in a lower-bound.
-#define IREE_HAL_VULKAN_TRACING_MAX_DEVIATION_PROBE_COUNT 32
+#define IREE_HAL_PIM_TRACING_MAX_DEVIATION_PROBE_COUNT 32
 
-typedef struct iree_hal_vulkan_timestamp_query_t {
+typedef struct iree_hal_pim_timestamp_query_t {
   uint64_t timestamp;
   uint64_t availability;  // non-zero if available
-} iree_hal_vulkan_timestamp_query_t;
+} iree_hal_pim_timestamp_query_t;
 
-struct iree_hal_vulkan_tracing_context_t {
+struct iree_hal_pim_tracing_context_t {
   // Device and queue the context represents.
-  iree::hal::vulkan::VkDeviceHandle* logical_device;
+  iree::hal::pim::VkDeviceHandle* logical_device;
   VkQueue queue;
   iree_allocator_t host_allocator;
 
@@ -40,7 +40,7 @@ struct iree_hal_vulkan_tracing_context_t {
   VkQueue maintenance_dispatch_queue;
   // Command pool that serves command buffers compatible with the
   // |maintenance_dispatch_queue|.
-  iree::hal::vulkan::VkCommandPoolHandle* maintenance_command_pool;
+  iree::hal::pim::VkCommandPoolHandle* maintenance_command_pool;
 
   // A unique GPU zone ID allocated from Tracy.
   // There is a global limit of 255 GPU zones (ID 255 is special).
@@ -74,14 +74,14 @@ struct iree_hal_vulkan_tracing_context_t {
   // Availability will be non-zero if the timestamp is valid. Since we put all
   // timestamps in order once we reach an unavailable timestamp we can bail
   // and leave that for future collections.
-  iree_hal_vulkan_timestamp_query_t
-      readback_buffer[IREE_HAL_VULKAN_TRACING_READBACK_QUERY_CAPACITY];
+  iree_hal_pim_timestamp_query_t
+      readback_buffer[IREE_HAL_PIM_TRACING_READBACK_QUERY_CAPACITY];
 };
 
 // Allocates and begins a command buffer and returns its handle.
 // Returns VK_NULL_HANDLE if allocation fails.
-static VkCommandBuffer iree_hal_vulkan_tracing_begin_command_buffer(
-    iree_hal_vulkan_tracing_context_t* context) {
+static VkCommandBuffer iree_hal_pim_tracing_begin_command_buffer(
+    iree_hal_pim_tracing_context_t* context) {
   const auto& syms = context->logical_device->syms();
 
   VkCommandBufferAllocateInfo command_buffer_info;
@@ -105,8 +105,8 @@ static VkCommandBuffer iree_hal_vulkan_tracing_begin_command_buffer(
 }
 
 // Ends and submits |command_buffer| and waits for it to complete.
-static void iree_hal_vulkan_tracing_submit_command_buffer(
-    iree_hal_vulkan_tracing_context_t* context,
+static void iree_hal_pim_tracing_submit_command_buffer(
+    iree_hal_pim_tracing_context_t* context,
     VkCommandBuffer command_buffer) {
   const auto& syms = context->logical_device->syms();
 
@@ -126,8 +126,8 @@ static void iree_hal_vulkan_tracing_submit_command_buffer(
 
 // Synchronously resets a range of querys in a query pool.
 // This may submit commands to the queue.
-static void iree_hal_vulkan_tracing_reset_query_pool(
-    iree_hal_vulkan_tracing_context_t* context, uint32_t query_index,
+static void iree_hal_pim_tracing_reset_query_pool(
+    iree_hal_pim_tracing_context_t* context, uint32_t query_index,
     uint32_t query_count) {
   const auto& syms = context->logical_device->syms();
 
@@ -147,18 +147,18 @@ static void iree_hal_vulkan_tracing_reset_query_pool(
   // Slow-path submitting a command buffer to reset the query pool. It's obvious
   // why vkResetQueryPool was added :)
   VkCommandBuffer command_buffer =
-      iree_hal_vulkan_tracing_begin_command_buffer(context);
+      iree_hal_pim_tracing_begin_command_buffer(context);
   if (command_buffer != VK_NULL_HANDLE) {
     syms->vkCmdResetQueryPool(command_buffer, context->query_pool, query_index,
                               query_count);
-    iree_hal_vulkan_tracing_submit_command_buffer(context, command_buffer);
+    iree_hal_pim_tracing_submit_command_buffer(context, command_buffer);
   }
 }
 
 // Attempts to get a timestamp from both the CPU and GPU that are correlated
 // with each other. Only valid when calibration is supported.
-static void iree_hal_vulkan_tracing_query_calibration_timestamps(
-    iree_hal_vulkan_tracing_context_t* context, uint64_t* out_cpu_time,
+static void iree_hal_pim_tracing_query_calibration_timestamps(
+    iree_hal_pim_tracing_context_t* context, uint64_t* out_cpu_time,
     uint64_t* out_gpu_time) {
   IREE_TRACE_ZONE_BEGIN(z0);
   *out_cpu_time = 0;
@@ -203,8 +203,8 @@ static void iree_hal_vulkan_tracing_query_calibration_timestamps(
 // Depending on whether VK_EXT_calibrated_timestamps is available this may be
 // a guess done by ourselves (with lots of slop) or done by the driver (with
 // less slop).
-static void iree_hal_vulkan_tracing_perform_initial_calibration(
-    iree_hal_vulkan_tracing_context_t* context, uint64_t* out_cpu_time,
+static void iree_hal_pim_tracing_perform_initial_calibration(
+    iree_hal_pim_tracing_context_t* context, uint64_t* out_cpu_time,
     uint64_t* out_gpu_time) {
   const auto& syms = context->logical_device->syms();
   *out_cpu_time = 0;
@@ -223,12 +223,12 @@ static void iree_hal_vulkan_tracing_perform_initial_calibration(
   if (context->time_domain == VK_TIME_DOMAIN_DEVICE_EXT) {
     // Submit a device timestamp.
     VkCommandBuffer command_buffer =
-        iree_hal_vulkan_tracing_begin_command_buffer(context);
+        iree_hal_pim_tracing_begin_command_buffer(context);
     if (command_buffer != VK_NULL_HANDLE) {
       syms->vkCmdWriteTimestamp(command_buffer,
                                 VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
                                 context->query_pool, 0);
-      iree_hal_vulkan_tracing_submit_command_buffer(context, command_buffer);
+      iree_hal_pim_tracing_submit_command_buffer(context, command_buffer);
     }
 
     // Query the timestamp from the host and the device.
@@ -239,7 +239,7 @@ static void iree_hal_vulkan_tracing_perform_initial_calibration(
         VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
 
     // Reset the query used.
-    iree_hal_vulkan_tracing_reset_query_pool(context, 0, 1);
+    iree_hal_pim_tracing_reset_query_pool(context, 0, 1);
     IREE_TRACE_ZONE_END(z0);
     return;
   }
@@ -264,7 +264,7 @@ static void iree_hal_vulkan_tracing_perform_initial_calibration(
   timestamp_infos[1].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
   timestamp_infos[1].pNext = NULL;
   timestamp_infos[1].timeDomain = context->time_domain;
-  uint64_t max_deviations[IREE_HAL_VULKAN_TRACING_MAX_DEVIATION_PROBE_COUNT];
+  uint64_t max_deviations[IREE_HAL_PIM_TRACING_MAX_DEVIATION_PROBE_COUNT];
   IREE_TRACE_ZONE_BEGIN_NAMED(z1, "vkGetCalibratedTimestampsEXT");
   for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(max_deviations); ++i) {
     uint64_t timestamps[2] = {0, 0};
@@ -279,7 +279,7 @@ static void iree_hal_vulkan_tracing_perform_initial_calibration(
   }
   context->max_expected_deviation = min_deviation * 3 / 2;
 
-  iree_hal_vulkan_tracing_query_calibration_timestamps(
+  iree_hal_pim_tracing_query_calibration_timestamps(
       context, &context->previous_cpu_time, out_gpu_time);
   *out_cpu_time = iree_tracing_time();
 
@@ -290,15 +290,15 @@ static void iree_hal_vulkan_tracing_perform_initial_calibration(
 // Over time the host and device clocks may drift (especially with power events)
 // and by frequently performing this we ensure that the samples we are sending
 // to tracy are able to be correlated.
-void iree_hal_vulkan_tracing_perform_calibration(
-    iree_hal_vulkan_tracing_context_t* context) {
+void iree_hal_pim_tracing_perform_calibration(
+    iree_hal_pim_tracing_context_t* context) {
   if (context->time_domain == VK_TIME_DOMAIN_DEVICE_EXT) return;
   IREE_TRACE_ZONE_BEGIN(z0);
 
   uint64_t cpu_time = 0;
   uint64_t gpu_time = 0;
-  iree_hal_vulkan_tracing_query_calibration_timestamps(context, &cpu_time,
-                                                       &gpu_time);
+  iree_hal_pim_tracing_query_calibration_timestamps(context, &cpu_time,
+                                                    &gpu_time);
 
   uint64_t tracy_time = iree_tracing_time();
   if (cpu_time > context->previous_cpu_time) {
@@ -312,15 +312,15 @@ void iree_hal_vulkan_tracing_perform_calibration(
 }
 
 // Prepares the VkQueryPool backing storage for our query ringbuffer.
-static void iree_hal_vulkan_tracing_prepare_query_pool(
-    iree_hal_vulkan_tracing_context_t* context) {
+static void iree_hal_pim_tracing_prepare_query_pool(
+    iree_hal_pim_tracing_context_t* context) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
   // Create a query pool with the largest query capacity it can provide.
   VkQueryPoolCreateInfo pool_info;
   memset(&pool_info, 0, sizeof(pool_info));
   pool_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
-  pool_info.queryCount = IREE_HAL_VULKAN_TRACING_DEFAULT_QUERY_CAPACITY;
+  pool_info.queryCount = IREE_HAL_PIM_TRACING_DEFAULT_QUERY_CAPACITY;
   pool_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
   IREE_TRACE_ZONE_APPEND_VALUE(z0, pool_info.queryCount);
   while (context->logical_device->syms()->vkCreateQueryPool(
@@ -334,15 +334,15 @@ static void iree_hal_vulkan_tracing_prepare_query_pool(
 
   // Perform initial reset of the query pool. All queries must be reset upon
   // creation before first use.
-  iree_hal_vulkan_tracing_reset_query_pool(context, 0, context->query_capacity);
+  iree_hal_pim_tracing_reset_query_pool(context, 0, context->query_capacity);
 
   IREE_TRACE_ZONE_END(z0);
 }
 
 // Prepares the Tracy-related GPU context that events are fed into. Each context
 // will appear as a unique plot in the tracy UI with the given |queue_name|.
-static void iree_hal_vulkan_tracing_prepare_gpu_context(
-    iree_hal_vulkan_tracing_context_t* context,
+static void iree_hal_pim_tracing_prepare_gpu_context(
+    iree_hal_pim_tracing_context_t* context,
     VkPhysicalDevice physical_device, iree_string_view_t queue_name) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
@@ -357,8 +357,8 @@ static void iree_hal_vulkan_tracing_prepare_gpu_context(
   // between CPU and GPU.
   uint64_t cpu_time = 0;
   uint64_t gpu_time = 0;
-  iree_hal_vulkan_tracing_perform_initial_calibration(context, &cpu_time,
-                                                      &gpu_time);
+  iree_hal_pim_tracing_perform_initial_calibration(context, &cpu_time,
+                                                   &gpu_time);
 
   // Allocate the GPU context and pass initial calibration data.
   // We may need to periodically refresh the calibration depending on the device
@@ -375,9 +375,9 @@ static void iree_hal_vulkan_tracing_prepare_gpu_context(
 // VK_TIME_DOMAIN_DEVICE_EXT. By default it is one that is only usable for
 // device-relative calculations and that we need to perform our own hacky
 // calibration on.
-static VkTimeDomainEXT iree_hal_vulkan_tracing_query_time_domain(
+static VkTimeDomainEXT iree_hal_pim_tracing_query_time_domain(
     VkPhysicalDevice physical_device,
-    iree::hal::vulkan::VkDeviceHandle* logical_device) {
+    iree::hal::pim::VkDeviceHandle* logical_device) {
   if (!logical_device->enabled_extensions().calibrated_timestamps) {
     // Calibrated timestamps extension is not available; we'll only have the
     // device domain.
@@ -414,55 +414,55 @@ static VkTimeDomainEXT iree_hal_vulkan_tracing_query_time_domain(
   return VK_TIME_DOMAIN_DEVICE_EXT;
 }
 
-iree_status_t iree_hal_vulkan_tracing_context_allocate(
+iree_status_t iree_hal_pim_tracing_context_allocate(
     VkPhysicalDevice physical_device,
-    iree::hal::vulkan::VkDeviceHandle* logical_device, VkQueue queue,
+    iree::hal::pim::VkDeviceHandle* logical_device, VkQueue queue,
     iree_string_view_t queue_name, VkQueue maintenance_dispatch_queue,
-    iree::hal::vulkan::VkCommandPoolHandle* maintenance_command_pool,
+    iree::hal::pim::VkCommandPoolHandle* maintenance_command_pool,
     iree_allocator_t host_allocator,
-    iree_hal_vulkan_tracing_context_t** out_context) {
+    iree_hal_pim_tracing_context_t** out_context) {
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_ASSERT_ARGUMENT(logical_device);
   IREE_ASSERT_ARGUMENT(out_context);
   *out_context = NULL;
 
-  iree_hal_vulkan_tracing_context_t* context = NULL;
+  iree_hal_pim_tracing_context_t* context = NULL;
   iree_status_t status =
       iree_allocator_malloc(host_allocator, sizeof(*context), (void**)&context);
   if (iree_status_is_ok(status)) {
     context->logical_device = logical_device;
     context->queue = queue;
     context->host_allocator = host_allocator;
-    context->time_domain = iree_hal_vulkan_tracing_query_time_domain(
+    context->time_domain = iree_hal_pim_tracing_query_time_domain(
         physical_device, logical_device);
     context->maintenance_dispatch_queue = maintenance_dispatch_queue;
     context->maintenance_command_pool = maintenance_command_pool;
 
     // Prepare the query pool and perform the initial calibration.
-    iree_hal_vulkan_tracing_prepare_query_pool(context);
+    iree_hal_pim_tracing_prepare_query_pool(context);
 
     // Prepare the Tracy GPU context.
-    iree_hal_vulkan_tracing_prepare_gpu_context(context, physical_device,
-                                                queue_name);
+    iree_hal_pim_tracing_prepare_gpu_context(context, physical_device,
+                                             queue_name);
   }
 
   if (iree_status_is_ok(status)) {
     *out_context = context;
   } else {
-    iree_hal_vulkan_tracing_context_free(context);
+    iree_hal_pim_tracing_context_free(context);
   }
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
 
-void iree_hal_vulkan_tracing_context_free(
-    iree_hal_vulkan_tracing_context_t* context) {
+void iree_hal_pim_tracing_context_free(
+    iree_hal_pim_tracing_context_t* context) {
   if (!context) return;
   IREE_TRACE_ZONE_BEGIN(z0);
 
   if (context->query_pool != VK_NULL_HANDLE) {
     // Always perform a collection on shutdown.
-    iree_hal_vulkan_tracing_context_collect(context, VK_NULL_HANDLE);
+    iree_hal_pim_tracing_context_collect(context, VK_NULL_HANDLE);
 
     auto* logical_device = context->logical_device;
     logical_device->syms()->vkDestroyQueryPool(
@@ -475,16 +475,16 @@ void iree_hal_vulkan_tracing_context_free(
   IREE_TRACE_ZONE_END(z0);
 }
 
-uint32_t iree_hal_vulkan_tracing_context_acquire_query_id(
-    iree_hal_vulkan_tracing_context_t* context) {
+uint32_t iree_hal_pim_tracing_context_acquire_query_id(
+    iree_hal_pim_tracing_context_t* context) {
   uint32_t id = context->query_head;
   context->query_head = (context->query_head + 1) % context->query_capacity;
   assert(context->query_head != context->query_tail);
   return id;
 }
 
-void iree_hal_vulkan_tracing_context_collect(
-    iree_hal_vulkan_tracing_context_t* context,
+void iree_hal_pim_tracing_context_collect(
+    iree_hal_pim_tracing_context_t* context,
     VkCommandBuffer command_buffer) {
   if (!context) return;
   if (context->query_tail == context->query_head) {
@@ -502,7 +502,7 @@ void iree_hal_vulkan_tracing_context_collect(
             ? context->query_capacity - context->query_tail
             : context->query_head - context->query_tail;
     try_query_count = iree_min(try_query_count,
-                               IREE_HAL_VULKAN_TRACING_READBACK_QUERY_CAPACITY);
+                               IREE_HAL_PIM_TRACING_READBACK_QUERY_CAPACITY);
 
     // Read back all of the queries. Note that we also are reading back the
     // availability such that we can handle partial readiness of the outstanding
@@ -511,7 +511,7 @@ void iree_hal_vulkan_tracing_context_collect(
     if (syms->vkGetQueryPoolResults(
             *context->logical_device, context->query_pool, query_base,
             try_query_count, sizeof(context->readback_buffer),
-            context->readback_buffer, sizeof(iree_hal_vulkan_timestamp_query_t),
+            context->readback_buffer, sizeof(iree_hal_pim_timestamp_query_t),
             VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT) !=
         VK_SUCCESS) {
       break;
@@ -532,8 +532,8 @@ void iree_hal_vulkan_tracing_context_collect(
       syms->vkCmdResetQueryPool(command_buffer, context->query_pool, query_base,
                                 read_query_count);
     } else {
-      iree_hal_vulkan_tracing_reset_query_pool(context, query_base,
-                                               read_query_count);
+      iree_hal_pim_tracing_reset_query_pool(context, query_base,
+                                            read_query_count);
     }
 
     context->query_tail += read_query_count;
@@ -545,17 +545,17 @@ void iree_hal_vulkan_tracing_context_collect(
   // Run calibration - we could do this less frequently in cases where collect
   // is called every submission, however it's relatively cheap compared to all
   // this other tracing overhead.
-  iree_hal_vulkan_tracing_perform_calibration(context);
+  iree_hal_pim_tracing_perform_calibration(context);
 
   IREE_TRACE_ZONE_END(z0);
 }
 
-void iree_hal_vulkan_tracing_zone_begin_impl(
-    iree_hal_vulkan_tracing_context_t* context, VkCommandBuffer command_buffer,
+void iree_hal_pim_tracing_zone_begin_impl(
+    iree_hal_pim_tracing_context_t* context, VkCommandBuffer command_buffer,
     const iree_tracing_location_t* src_loc) {
   if (!context) return;
 
-  uint32_t query_id = iree_hal_vulkan_tracing_context_acquire_query_id(context);
+  uint32_t query_id = iree_hal_pim_tracing_context_acquire_query_id(context);
   context->logical_device->syms()->vkCmdWriteTimestamp(
       command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, context->query_pool,
       query_id);
@@ -563,14 +563,14 @@ void iree_hal_vulkan_tracing_zone_begin_impl(
   iree_tracing_gpu_zone_begin(context->id, (uint16_t)query_id, src_loc);
 }
 
-void iree_hal_vulkan_tracing_zone_begin_external_impl(
-    iree_hal_vulkan_tracing_context_t* context, VkCommandBuffer command_buffer,
+void iree_hal_pim_tracing_zone_begin_external_impl(
+    iree_hal_pim_tracing_context_t* context, VkCommandBuffer command_buffer,
     const char* file_name, size_t file_name_length, uint32_t line,
     const char* function_name, size_t function_name_length, const char* name,
     size_t name_length) {
   if (!context) return;
 
-  uint32_t query_id = iree_hal_vulkan_tracing_context_acquire_query_id(context);
+  uint32_t query_id = iree_hal_pim_tracing_context_acquire_query_id(context);
   context->logical_device->syms()->vkCmdWriteTimestamp(
       command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, context->query_pool,
       query_id);
@@ -580,12 +580,12 @@ void iree_hal_vulkan_tracing_zone_begin_external_impl(
       function_name, function_name_length, name, name_length);
 }
 
-void iree_hal_vulkan_tracing_zone_end_impl(
-    iree_hal_vulkan_tracing_context_t* context,
+void iree_hal_pim_tracing_zone_end_impl(
+    iree_hal_pim_tracing_context_t* context,
     VkCommandBuffer command_buffer) {
   if (!context) return;
 
-  uint32_t query_id = iree_hal_vulkan_tracing_context_acquire_query_id(context);
+  uint32_t query_id = iree_hal_pim_tracing_context_acquire_query_id(context);
   context->logical_device->syms()->vkCmdWriteTimestamp(
       command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, context->query_pool,
       query_id);
@@ -595,22 +595,22 @@ void iree_hal_vulkan_tracing_zone_end_impl(
 
 #else
 
-iree_status_t iree_hal_vulkan_tracing_context_allocate(
+iree_status_t iree_hal_pim_tracing_context_allocate(
     VkPhysicalDevice physical_device,
-    iree::hal::vulkan::VkDeviceHandle* logical_device, VkQueue queue,
+    iree::hal::pim::VkDeviceHandle* logical_device, VkQueue queue,
     iree_string_view_t queue_name, VkQueue maintenance_dispatch_queue,
-    iree::hal::vulkan::VkCommandPoolHandle* maintenance_command_pool,
+    iree::hal::pim::VkCommandPoolHandle* maintenance_command_pool,
     iree_allocator_t host_allocator,
-    iree_hal_vulkan_tracing_context_t** out_context) {
+    iree_hal_pim_tracing_context_t** out_context) {
   *out_context = NULL;
   return iree_ok_status();
 }
 
-void iree_hal_vulkan_tracing_context_free(
-    iree_hal_vulkan_tracing_context_t* context) {}
+void iree_hal_pim_tracing_context_free(
+    iree_hal_pim_tracing_context_t* context) {}
 
-void iree_hal_vulkan_tracing_context_collect(
-    iree_hal_vulkan_tracing_context_t* context,
+void iree_hal_pim_tracing_context_collect(
+    iree_hal_pim_tracing_context_t* context,
     VkCommandBuffer command_buffer) {}
 
 #endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
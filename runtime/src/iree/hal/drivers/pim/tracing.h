@@ -4,18 +4,18 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
-#ifndef IREE_HAL_DRIVERS_VULKAN_TRACING_H_
-#define IREE_HAL_DRIVERS_VULKAN_TRACING_H_
+#ifndef IREE_HAL_DRIVERS_PIM_TRACING_H_
+#define IREE_HAL_DRIVERS_PIM_TRACING_H_
 
 // clang-format off: must be included before all other headers.
-#include "iree/hal/drivers/vulkan/vulkan_headers.h"
+#include "iree/hal/drivers/pim/vulkan_headers.h"
 // clang-format on
 
 #include <stddef.h>
 
 #include "iree/base/api.h"
 #include "iree/base/tracing.h"
-#include "iree/hal/drivers/vulkan/handle_util.h"
+#include "iree/hal/drivers/pim/handle_util.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -34,7 +34,7 @@ extern "C" {
 //   vkCmdDispatch(command_buffer, ...);
 //   IREE_VULKAN_TRACE_ZONE_END(queue->tracing_context, command_buffer);
 //   ...
-//   iree_hal_vulkan_tracing_context_collect(queue->tracing_context,
+//   iree_hal_pim_tracing_context_collect(queue->tracing_context,
 //                                           command_buffer);
 //   vkQueueSubmit(...command_buffer...);
 //
@@ -66,26 +66,26 @@ extern "C" {
 //
 // Thread-compatible: external synchronization is required if using from
 // multiple threads (same as with VkQueue itself).
-typedef struct iree_hal_vulkan_tracing_context_t
-    iree_hal_vulkan_tracing_context_t;
+typedef struct iree_hal_pim_tracing_context_t
+    iree_hal_pim_tracing_context_t;
 
 // Allocates a tracing context for the given Vulkan queue.
 // Each context must only be used with the queue it was created with.
 //
 // |maintenance_dispatch_queue| may be used to perform query pool maintenance
 // tasks and must support graphics or compute commands.
-iree_status_t iree_hal_vulkan_tracing_context_allocate(
+iree_status_t iree_hal_pim_tracing_context_allocate(
     VkPhysicalDevice physical_device,
-    iree::hal::vulkan::VkDeviceHandle* logical_device, VkQueue queue,
+    iree::hal::pim::VkDeviceHandle* logical_device, VkQueue queue,
     iree_string_view_t queue_name, VkQueue maintenance_dispatch_queue,
-    iree::hal::vulkan::VkCommandPoolHandle* maintenance_command_pool,
+    iree::hal::pim::VkCommandPoolHandle* maintenance_command_pool,
     iree_allocator_t host_allocator,
-    iree_hal_vulkan_tracing_context_t** out_context);
+    iree_hal_pim_tracing_context_t** out_context);
 
 // Frees a tracing context and all associated Vulkan resources.
 // All submissions using the resources must be completed prior to calling.
-void iree_hal_vulkan_tracing_context_free(
-    iree_hal_vulkan_tracing_context_t* context);
+void iree_hal_pim_tracing_context_free(
+    iree_hal_pim_tracing_context_t* context);
 
 // Collects in-flight timestamp queries from the queue and feeds them to tracy.
 // Must be called frequently (every submission, etc) to drain the backlog;
@@ -94,34 +94,34 @@ void iree_hal_vulkan_tracing_context_free(
 // The provided |command_buffer| may receive additional bookkeeping commands
 // that should have no impact on correctness or behavior. If VK_NULL_HANDLE is
 // provided then collection will occur synchronously.
-void iree_hal_vulkan_tracing_context_collect(
-    iree_hal_vulkan_tracing_context_t* context, VkCommandBuffer command_buffer);
+void iree_hal_pim_tracing_context_collect(
+    iree_hal_pim_tracing_context_t* context, VkCommandBuffer command_buffer);
 
 #if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
 
 // Begins a normal zone derived on the calling |src_loc|.
 // Must be perfectly nested and paired with a corresponding zone end.
-void iree_hal_vulkan_tracing_zone_begin_impl(
-    iree_hal_vulkan_tracing_context_t* context, VkCommandBuffer command_buffer,
+void iree_hal_pim_tracing_zone_begin_impl(
+    iree_hal_pim_tracing_context_t* context, VkCommandBuffer command_buffer,
     const iree_tracing_location_t* src_loc);
 
 // Begins an external zone using the given source information.
 // The provided strings will be copied into the tracy buffer.
-void iree_hal_vulkan_tracing_zone_begin_external_impl(
-    iree_hal_vulkan_tracing_context_t* context, VkCommandBuffer command_buffer,
+void iree_hal_pim_tracing_zone_begin_external_impl(
+    iree_hal_pim_tracing_context_t* context, VkCommandBuffer command_buffer,
     const char* file_name, size_t file_name_length, uint32_t line,
     const char* function_name, size_t function_name_length, const char* name,
     size_t name_length);
 
-void iree_hal_vulkan_tracing_zone_end_impl(
-    iree_hal_vulkan_tracing_context_t* context, VkCommandBuffer command_buffer);
+void iree_hal_pim_tracing_zone_end_impl(
+    iree_hal_pim_tracing_context_t* context, VkCommandBuffer command_buffer);
 
 // Begins a new zone with the parent function name.
 #define IREE_VULKAN_TRACE_ZONE_BEGIN(context, command_buffer)                 \
   static const iree_tracing_location_t TracyConcat(                           \
       __tracy_source_location, __LINE__) = {name_literal, __FUNCTION__,       \
                                             __FILE__, (uint32_t)__LINE__, 0}; \
-  iree_hal_vulkan_tracing_zone_begin_impl(                                    \
+  iree_hal_pim_tracing_zone_begin_impl(                                    \
       context, command_buffer,                                                \
       &TracyConcat(__tracy_source_location, __LINE__));
 
@@ -131,13 +131,13 @@ void iree_hal_vulkan_tracing_zone_end_impl(
 #define IREE_VULKAN_TRACE_ZONE_BEGIN_EXTERNAL(                                 \
     context, command_buffer, file_name, file_name_length, line, function_name, \
     function_name_length, name, name_length)                                   \
-  iree_hal_vulkan_tracing_zone_begin_external_impl(                            \
+  iree_hal_pim_tracing_zone_begin_external_impl(                            \
       context, command_buffer, file_name, file_name_length, line,              \
       function_name, function_name_length, name, name_length)
 
 // Ends the current zone. Must be passed the |zone_id| from the _BEGIN.
 #define IREE_VULKAN_TRACE_ZONE_END(context, command_buffer) \
-  iree_hal_vulkan_tracing_zone_end_impl(context, command_buffer)
+  iree_hal_pim_tracing_zone_end_impl(context, command_buffer)
 
 #else
 
@@ -153,4 +153,4 @@ void iree_hal_vulkan_tracing_zone_end_impl(
 }  // extern "C"
 #endif  // __cplusplus
 
-#endif  // IREE_HAL_DRIVERS_VULKAN_TRACING_H_
+#endif  // IREE_HAL_DRIVERS_PIM_TRACING_H_
@@ -4,8 +4,8 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
-#ifndef IREE_HAL_DRIVERS_VULKAN_UTIL_ARENA_H_
-#define IREE_HAL_DRIVERS_VULKAN_UTIL_ARENA_H_
+#ifndef IREE_HAL_DRIVERS_PIM_UTIL_ARENA_H_
+#define IREE_HAL_DRIVERS_PIM_UTIL_ARENA_H_
 
 #include <cstddef>
 #include <cstdint>
@@ -126,4 +126,4 @@ class Arena {
 
 }  // namespace iree
 
-#endif  // IREE_HAL_DRIVERS_VULKAN_UTIL_ARENA_H_
+#endif  // IREE_HAL_DRIVERS_PIM_UTIL_ARENA_H_
@@ -40,8 +40,8 @@
 //
 // This type is thread-unsafe.
 
-#ifndef IREE_HAL_DRIVERS_VULKAN_UTIL_INTRUSIVE_LIST_H_
-#define IREE_HAL_DRIVERS_VULKAN_UTIL_INTRUSIVE_LIST_H_
+#ifndef IREE_HAL_DRIVERS_PIM_UTIL_INTRUSIVE_LIST_H_
+#define IREE_HAL_DRIVERS_PIM_UTIL_INTRUSIVE_LIST_H_
 
 #include <cstddef>
 #include <cstdint>
@@ -745,6 +745,6 @@ void IntrusiveListBase<T, IteratorT, ReverseIteratorT, kOffset>::sort(
 }  // namespace iree
 
 // Specializations:
-#include "iree/hal/drivers/vulkan/util/intrusive_list_unique_ptr.inc"
+#include "iree/hal/drivers/pim/util/intrusive_list_unique_ptr.inc"
 
-#endif  // IREE_HAL_DRIVERS_VULKAN_UTIL_INTRUSIVE_LIST_H_
+#endif  // IREE_HAL_DRIVERS_PIM_UTIL_INTRUSIVE_LIST_H_
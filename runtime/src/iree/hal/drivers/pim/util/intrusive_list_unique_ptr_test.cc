@@ -6,7 +6,7 @@
 
 #include <memory>
 
-#include "iree/hal/drivers/vulkan/util/intrusive_list.h"
+#include "iree/hal/drivers/pim/util/intrusive_list.h"
 #include "iree/testing/gtest.h"
 
 namespace iree {
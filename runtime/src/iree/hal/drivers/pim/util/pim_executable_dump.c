@@ -0,0 +1,365 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/pim/util/pim_executable_dump.h"
+
+#include <inttypes.h>
+#include <string.h>
+
+// flatcc schemas:
+#include "iree/base/internal/flatcc/parsing.h"
+#include "iree/schemas/pim_executable_def_reader.h"
+#include "iree/schemas/pim_executable_def_verifier.h"
+
+// Decoded fields of an instruction word (see pim_executable_def.fbs).
+#define IREE_HAL_PIM_WORD_OPCODE(word) ((uint32_t)((word)&0xFF))
+#define IREE_HAL_PIM_WORD_SPLIT(word) ((uint32_t)(((word) >> 8) & 0x3))
+#define IREE_HAL_PIM_WORD_DIM_COUNT(word) ((uint32_t)(((word) >> 12) & 0xF))
+#define IREE_HAL_PIM_WORD_ELEMENT_TYPE(word) ((uint32_t)(((word) >> 16) & 0x7))
+
+const char* iree_hal_pim_opcode_name(uint32_t opcode) {
+  static const char* kNames[IREE_HAL_PIM_OPCODE_COUNT] = {
+      "unknown",  "LayerNorm1", "QKVGen",     "QKMatmul", "Softmax",
+      "SVMatmul", "OutProj",    "LayerNorm2", "FFN1",     "FFN2",
+      "LMHead",   "Gather",     "RMSNorm",    "RoPE",     "FFNGate",
+      "SwiGLU",   "GQAQKMatmul", "GQASVMatmul", "Elementwise",
+  };
+  if (opcode >= IREE_HAL_PIM_OPCODE_COUNT) return kNames[0];
+  return kNames[opcode];
+}
+
+static const char* iree_hal_pim_split_name(uint32_t split) {
+  switch (split) {
+    case 1:
+      return "col-wise";
+    case 2:
+      return "row-wise";
+    default:
+      return "none";
+  }
+}
+
+static const char* iree_hal_pim_element_type_name(uint32_t element_type) {
+  switch (element_type) {
+    case 0:
+      return "f32";
+    case 1:
+      return "f16";
+    case 2:
+      return "bf16";
+    case 3:
+      return "i8";
+    default:
+      return "unknown";
+  }
+}
+
+static const char* iree_hal_pim_sync_name(uint64_t sync) {
+  switch (sync) {
+    case 1:
+      return "all-reduce";
+    case 2:
+      return "all-gather";
+    default:
+      return "unknown";
+  }
+}
+
+bool iree_hal_pim_executable_data_isa(iree_const_byte_span_t data) {
+  return data.data && data.data_length >= 8 &&
+         flatbuffers_has_identifier(data.data,
+                                    iree_PIMExecutableDef_file_identifier);
+}
+
+// Verifies that |data| can be safely walked. Unlike the executable loading
+// in the driver the contents aren't validated so that malformed executables
+// can still be inspected.
+static iree_status_t iree_hal_pim_executable_dump_verify(
+    iree_const_byte_span_t data) {
+  if (!iree_hal_pim_executable_data_isa(data)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "data is not a PIM executable");
+  }
+  int verify_ret =
+      iree_PIMExecutableDef_verify_as_root(data.data, data.data_length);
+  if (verify_ret != flatcc_verify_ok) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "FlatBuffer verification failed: %s",
+                            flatcc_verify_error_string(verify_ret));
+  }
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_pim_executable_compute_stats(
+    iree_const_byte_span_t data, iree_hal_pim_executable_stats_t* out_stats) {
+  IREE_ASSERT_ARGUMENT(out_stats);
+  memset(out_stats, 0, sizeof(*out_stats));
+  IREE_RETURN_IF_ERROR(iree_hal_pim_executable_dump_verify(data));
+
+  iree_PIMExecutableDef_table_t executable_def =
+      iree_PIMExecutableDef_as_root(data.data);
+  flatbuffers_uint64_vec_t code_vec =
+      iree_PIMExecutableDef_code_get(executable_def);
+  out_stats->byte_length = data.data_length;
+  out_stats->entry_point_count = flatbuffers_string_vec_len(
+      iree_PIMExecutableDef_entry_points_get(executable_def));
+  out_stats->instruction_count = flatbuffers_uint64_vec_len(code_vec);
+  out_stats->sync_count = flatbuffers_uint64_vec_len(
+      iree_PIMExecutableDef_comm_flag_get(executable_def));
+  out_stats->dim_count = flatbuffers_int32_vec_len(
+      iree_PIMExecutableDef_dims_get(executable_def));
+  out_stats->operand_slot_count = flatbuffers_int32_vec_len(
+      iree_PIMExecutableDef_operand_slots_get(executable_def));
+  for (iree_host_size_t i = 0; i < out_stats->instruction_count; ++i) {
+    uint32_t opcode =
+        IREE_HAL_PIM_WORD_OPCODE(flatbuffers_uint64_vec_at(code_vec, i));
+    if (opcode >= IREE_HAL_PIM_OPCODE_COUNT) opcode = 0;
+    ++out_stats->opcode_counts[opcode];
+  }
+  return iree_ok_status();
+}
+
+// Appends dim |dim| as a constant or the push constant it is read from.
+static iree_status_t iree_hal_pim_executable_append_dim(
+    int32_t dim, iree_string_builder_t* builder) {
+  if (dim < 0) {
+    return iree_string_builder_append_format(builder, "pc[%" PRId64 "]",
+                                             -1 - (int64_t)dim);
+  }
+  return iree_string_builder_append_format(builder, "%" PRId32, dim);
+}
+
+// Appends the shapes of bindings [|binding_begin|, |binding_end|) of
+// |executable_def|, one line per binding numbered from |binding_begin|.
+// Views of fused bindings are followed by the dispatch binding and byte offset
+// they view.
+static iree_status_t iree_hal_pim_executable_disassemble_bindings(
+    iree_PIMExecutableDef_table_t executable_def,
+    iree_host_size_t binding_begin, iree_host_size_t binding_end,
+    iree_string_builder_t* builder) {
+  flatbuffers_uint8_vec_t ranks_vec =
+      iree_PIMExecutableDef_binding_ranks_get(executable_def);
+  flatbuffers_int32_vec_t dims_vec =
+      iree_PIMExecutableDef_binding_dims_get(executable_def);
+  flatbuffers_uint8_vec_t types_vec =
+      iree_PIMExecutableDef_binding_types_get(executable_def);
+  flatbuffers_uint32_vec_t sources_vec =
+      iree_PIMExecutableDef_binding_sources_get(executable_def);
+  flatbuffers_int32_vec_t offsets_vec =
+      iree_PIMExecutableDef_binding_offsets_get(executable_def);
+  iree_host_size_t binding_count = flatbuffers_uint8_vec_len(ranks_vec);
+  iree_host_size_t dim_count = flatbuffers_int32_vec_len(dims_vec);
+  if (binding_begin > binding_end || binding_end > binding_count) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "bindings %" PRIhsz "-%" PRIhsz
+                            " are out of range",
+                            binding_begin, binding_end);
+  }
+  iree_host_size_t dim_offset = 0;
+  for (iree_host_size_t i = 0; i < binding_begin; ++i) {
+    dim_offset += flatbuffers_uint8_vec_at(ranks_vec, i);
+  }
+  for (iree_host_size_t i = binding_begin; i < binding_end; ++i) {
+    uint8_t rank = flatbuffers_uint8_vec_at(ranks_vec, i);
+    uint32_t type = i < flatbuffers_uint8_vec_len(types_vec)
+                        ? flatbuffers_uint8_vec_at(types_vec, i)
+                        : 0;
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+        builder, "  binding[%" PRIhsz "]: %s", i - binding_begin,
+        iree_hal_pim_element_type_name(type)));
+    if (rank == 0) {
+      IREE_RETURN_IF_ERROR(
+          iree_string_builder_append_cstring(builder, "[dynamic]"));
+    } else {
+      IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(builder, "["));
+      for (uint8_t j = 0; j < rank; ++j, ++dim_offset) {
+        if (dim_offset >= dim_count) {
+          return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                  "binding %" PRIhsz " dims are out of range",
+                                  i);
+        }
+        IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+            builder, j ? "x%" PRId32 : "%" PRId32,
+            flatbuffers_int32_vec_at(dims_vec, dim_offset)));
+      }
+      IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(builder, "]"));
+    }
+    if (i < flatbuffers_uint32_vec_len(sources_vec) &&
+        i < flatbuffers_int32_vec_len(offsets_vec)) {
+      IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+          builder, " view=$%" PRIu32 "+",
+          flatbuffers_uint32_vec_at(sources_vec, i)));
+      IREE_RETURN_IF_ERROR(iree_hal_pim_executable_append_dim(
+          flatbuffers_int32_vec_at(offsets_vec, i), builder));
+    }
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(builder, "\n"));
+  }
+  return iree_ok_status();
+}
+
+// Appends instructions [|code_begin|, |code_end|) of |executable_def|, one
+// line per instruction numbered from |code_begin|. |dim_offset| and
+// |sync_index| track the position in the dims and sync points and are advanced
+// past those of the listed instructions.
+static iree_status_t iree_hal_pim_executable_disassemble_instructions(
+    iree_PIMExecutableDef_table_t executable_def, iree_host_size_t code_begin,
+    iree_host_size_t code_end, iree_host_size_t* dim_offset,
+    iree_host_size_t* sync_index, iree_string_builder_t* builder) {
+  flatbuffers_uint64_vec_t code_vec =
+      iree_PIMExecutableDef_code_get(executable_def);
+  flatbuffers_int32_vec_t dims_vec =
+      iree_PIMExecutableDef_dims_get(executable_def);
+  flatbuffers_uint64_vec_t comm_flag_vec =
+      iree_PIMExecutableDef_comm_flag_get(executable_def);
+  flatbuffers_uint32_vec_t operand_offsets_vec =
+      iree_PIMExecutableDef_operand_offsets_get(executable_def);
+  flatbuffers_int32_vec_t operand_slots_vec =
+      iree_PIMExecutableDef_operand_slots_get(executable_def);
+
+  iree_host_size_t instruction_count = flatbuffers_uint64_vec_len(code_vec);
+  iree_host_size_t dim_count = flatbuffers_int32_vec_len(dims_vec);
+  iree_host_size_t sync_count = flatbuffers_uint64_vec_len(comm_flag_vec);
+  iree_host_size_t slot_count = flatbuffers_int32_vec_len(operand_slots_vec);
+  bool has_operand_slots =
+      flatbuffers_uint32_vec_len(operand_offsets_vec) == instruction_count + 1;
+  if (code_begin > code_end || code_end > instruction_count) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "instructions %" PRIhsz "-%" PRIhsz
+                            " are out of range",
+                            code_begin, code_end);
+  }
+  for (iree_host_size_t i = code_begin; i < code_end; ++i) {
+    uint64_t word = flatbuffers_uint64_vec_at(code_vec, i);
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+        builder, "  %4" PRIhsz ": %-10s split=%s type=%s dims=(",
+        i - code_begin,
+        iree_hal_pim_opcode_name(IREE_HAL_PIM_WORD_OPCODE(word)),
+        iree_hal_pim_split_name(IREE_HAL_PIM_WORD_SPLIT(word)),
+        iree_hal_pim_element_type_name(IREE_HAL_PIM_WORD_ELEMENT_TYPE(word))));
+    uint32_t instruction_dim_count = IREE_HAL_PIM_WORD_DIM_COUNT(word);
+    for (uint32_t j = 0; j < instruction_dim_count; ++j, ++*dim_offset) {
+      if (*dim_offset >= dim_count) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "instruction %" PRIhsz
+                                " dims are out of range",
+                                i);
+      }
+      if (j) {
+        IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(builder, ", "));
+      }
+      IREE_RETURN_IF_ERROR(iree_hal_pim_executable_append_dim(
+          flatbuffers_int32_vec_at(dims_vec, *dim_offset), builder));
+    }
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(builder, ")"));
+
+    // Entry points of linked executables without operand slots have empty
+    // ranges.
+    uint32_t begin =
+        has_operand_slots ? flatbuffers_uint32_vec_at(operand_offsets_vec, i)
+                          : 0;
+    uint32_t end = has_operand_slots
+                       ? flatbuffers_uint32_vec_at(operand_offsets_vec, i + 1)
+                       : 0;
+    if (begin > end || end > slot_count) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "instruction %" PRIhsz
+                              " operand slots are out of range",
+                              i);
+    }
+    if (begin != end) {
+      IREE_RETURN_IF_ERROR(
+          iree_string_builder_append_cstring(builder, " slots=("));
+      for (uint32_t j = begin; j < end; ++j) {
+        // Negative slots are resident results of earlier instructions.
+        int32_t slot = flatbuffers_int32_vec_at(operand_slots_vec, j);
+        IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+            builder, slot < 0 ? "%s%%%" PRId64 : "%s$%" PRId64,
+            j == begin ? "" : ", ",
+            slot < 0 ? -1 - (int64_t)slot : (int64_t)slot));
+      }
+      IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(builder, ")"));
+    }
+
+    // Sync points are in program order.
+    while (*sync_index < sync_count &&
+           (flatbuffers_uint64_vec_at(comm_flag_vec, *sync_index) &
+            0xFFFFFFFFu) < i) {
+      ++*sync_index;
+    }
+    if (*sync_index < sync_count) {
+      uint64_t flag = flatbuffers_uint64_vec_at(comm_flag_vec, *sync_index);
+      if ((flag & 0xFFFFFFFFu) == i) {
+        IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+            builder, " sync=%s", iree_hal_pim_sync_name(flag >> 32)));
+      }
+    }
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(builder, "\n"));
+  }
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_pim_executable_disassemble(
+    iree_const_byte_span_t data, iree_string_builder_t* builder) {
+  IREE_ASSERT_ARGUMENT(builder);
+  IREE_RETURN_IF_ERROR(iree_hal_pim_executable_dump_verify(data));
+
+  iree_PIMExecutableDef_table_t executable_def =
+      iree_PIMExecutableDef_as_root(data.data);
+  flatbuffers_string_vec_t entry_points_vec =
+      iree_PIMExecutableDef_entry_points_get(executable_def);
+  flatbuffers_uint32_vec_t entry_code_offsets_vec =
+      iree_PIMExecutableDef_entry_code_offsets_get(executable_def);
+  flatbuffers_uint32_vec_t entry_binding_offsets_vec =
+      iree_PIMExecutableDef_entry_binding_offsets_get(executable_def);
+
+  iree_host_size_t entry_point_count =
+      flatbuffers_string_vec_len(entry_points_vec);
+  IREE_RETURN_IF_ERROR(
+      iree_string_builder_append_cstring(builder, "entry points:"));
+  for (iree_host_size_t i = 0; i < entry_point_count; ++i) {
+    flatbuffers_string_t name = flatbuffers_string_vec_at(entry_points_vec, i);
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+        builder, " %.*s", (int)flatbuffers_string_len(name), name));
+  }
+  IREE_RETURN_IF_ERROR(iree_string_builder_append_cstring(builder, "\n"));
+
+  iree_host_size_t dim_offset = 0;
+  iree_host_size_t sync_index = 0;
+  bool is_linked = flatbuffers_uint32_vec_len(entry_code_offsets_vec) ==
+                       entry_point_count + 1 &&
+                   flatbuffers_uint32_vec_len(entry_binding_offsets_vec) ==
+                       entry_point_count + 1;
+  if (!is_linked) {
+    IREE_RETURN_IF_ERROR(iree_hal_pim_executable_disassemble_bindings(
+        executable_def, 0,
+        flatbuffers_uint8_vec_len(
+            iree_PIMExecutableDef_binding_ranks_get(executable_def)),
+        builder));
+    return iree_hal_pim_executable_disassemble_instructions(
+        executable_def, 0,
+        flatbuffers_uint64_vec_len(
+            iree_PIMExecutableDef_code_get(executable_def)),
+        &dim_offset, &sync_index, builder);
+  }
+
+  // Linked executables list the bindings and instructions of each entry point
+  // under its name numbered within the entry point as are the resident
+  // results the instructions reference.
+  for (iree_host_size_t i = 0; i < entry_point_count; ++i) {
+    flatbuffers_string_t name = flatbuffers_string_vec_at(entry_points_vec, i);
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+        builder, "%.*s:\n", (int)flatbuffers_string_len(name), name));
+    IREE_RETURN_IF_ERROR(iree_hal_pim_executable_disassemble_bindings(
+        executable_def,
+        flatbuffers_uint32_vec_at(entry_binding_offsets_vec, i),
+        flatbuffers_uint32_vec_at(entry_binding_offsets_vec, i + 1), builder));
+    IREE_RETURN_IF_ERROR(iree_hal_pim_executable_disassemble_instructions(
+        executable_def, flatbuffers_uint32_vec_at(entry_code_offsets_vec, i),
+        flatbuffers_uint32_vec_at(entry_code_offsets_vec, i + 1), &dim_offset,
+        &sync_index, builder));
+  }
+  return iree_ok_status();
+}
@@ -0,0 +1,63 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_PIM_UTIL_PIM_EXECUTABLE_DUMP_H_
+#define IREE_HAL_DRIVERS_PIM_UTIL_PIM_EXECUTABLE_DUMP_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Number of PIM opcodes including the unknown opcode 0.
+#define IREE_HAL_PIM_OPCODE_COUNT 19
+
+// Returns the name of PIM instruction |opcode| (such as "QKVGen") or
+// "unknown" if it isn't a defined opcode.
+const char* iree_hal_pim_opcode_name(uint32_t opcode);
+
+// Returns true if |data| is a PIMExecutableDef flatbuffer (see
+// pim_executable_def.fbs) as identified by its file identifier.
+bool iree_hal_pim_executable_data_isa(iree_const_byte_span_t data);
+
+// Size and instruction mix of a PIM executable.
+typedef struct iree_hal_pim_executable_stats_t {
+  // Size of the flatbuffer in bytes.
+  iree_host_size_t byte_length;
+  iree_host_size_t entry_point_count;
+  iree_host_size_t instruction_count;
+  // Instructions followed by a cross-device sync point.
+  iree_host_size_t sync_count;
+  iree_host_size_t dim_count;
+  // Total number of operand slots of multi-instruction programs.
+  iree_host_size_t operand_slot_count;
+  // Instruction count by opcode; undefined opcodes are counted in 0.
+  iree_host_size_t opcode_counts[IREE_HAL_PIM_OPCODE_COUNT];
+} iree_hal_pim_executable_stats_t;
+
+// Computes the stats of the PIM executable flatbuffer |data|.
+// Returns IREE_STATUS_INVALID_ARGUMENT if the flatbuffer fails verification.
+iree_status_t iree_hal_pim_executable_compute_stats(
+    iree_const_byte_span_t data, iree_hal_pim_executable_stats_t* out_stats);
+
+// Appends a readable listing of the PIM executable flatbuffer |data| to
+// |builder|: its entry points, binding shapes and one line per instruction
+// with its split, element type, dims, operand slots and sync point. Dims read
+// from push constants are printed as `pc[ordinal]`, binding slots as
+// `$ordinal` and resident results of earlier instructions as `%instruction`.
+// Returns IREE_STATUS_INVALID_ARGUMENT if the flatbuffer fails verification.
+iree_status_t iree_hal_pim_executable_disassemble(
+    iree_const_byte_span_t data, iree_string_builder_t* builder);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_PIM_UTIL_PIM_EXECUTABLE_DUMP_H_
@@ -0,0 +1,266 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/pim/util/pim_executable_dump.h"
+
+#include <string>
+#include <vector>
+
+#include "iree/schemas/pim_executable_def_builder.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+// A row-wise QKVGen over a batch read from push constant 0 followed by its
+// all-gather and a layer norm reading its resident result.
+class PIMExecutableDumpTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    flatcc_builder_t builder;
+    flatcc_builder_init(&builder);
+    iree_PIMExecutableDef_start_as_root(&builder);
+
+    flatbuffers_string_ref_t entry_point =
+        flatbuffers_string_create_str(&builder, "decoder");
+    auto entry_points_ref =
+        flatbuffers_string_vec_create(&builder, &entry_point, 1);
+    const uint64_t code[] = {
+        2 | (2ull << 8) | (3ull << 12),  // QKVGen row-wise, 3 dims
+        1 | (1ull << 12) | (1ull << 16),  // LayerNorm1 f16, 1 dim
+    };
+    auto code_ref = flatbuffers_uint64_vec_create(&builder, code, 2);
+    const int32_t dims[] = {-1, 768, 2304, 768};
+    auto dims_ref = flatbuffers_int32_vec_create(&builder, dims, 4);
+    const uint64_t comm_flag[] = {(2ull << 32) | 0};
+    auto comm_flag_ref =
+        flatbuffers_uint64_vec_create(&builder, comm_flag, 1);
+    const uint32_t operand_offsets[] = {0, 2, 4};
+    auto operand_offsets_ref =
+        flatbuffers_uint32_vec_create(&builder, operand_offsets, 3);
+    const int32_t operand_slots[] = {0, -1, -1, 1};
+    auto operand_slots_ref =
+        flatbuffers_int32_vec_create(&builder, operand_slots, 4);
+    const uint8_t binding_ranks[] = {2, 0};
+    auto binding_ranks_ref =
+        flatbuffers_uint8_vec_create(&builder, binding_ranks, 2);
+    const int32_t binding_dims[] = {1, 768};
+    auto binding_dims_ref =
+        flatbuffers_int32_vec_create(&builder, binding_dims, 2);
+
+    iree_PIMExecutableDef_entry_points_add(&builder, entry_points_ref);
+    iree_PIMExecutableDef_code_add(&builder, code_ref);
+    iree_PIMExecutableDef_dims_add(&builder, dims_ref);
+    iree_PIMExecutableDef_comm_flag_add(&builder, comm_flag_ref);
+    iree_PIMExecutableDef_operand_offsets_add(&builder, operand_offsets_ref);
+    iree_PIMExecutableDef_operand_slots_add(&builder, operand_slots_ref);
+    iree_PIMExecutableDef_binding_ranks_add(&builder, binding_ranks_ref);
+    iree_PIMExecutableDef_binding_dims_add(&builder, binding_dims_ref);
+    iree_PIMExecutableDef_end_as_root(&builder);
+
+    size_t size = 0;
+    void* buffer = flatcc_builder_finalize_aligned_buffer(&builder, &size);
+    data_.assign(static_cast<uint8_t*>(buffer),
+                 static_cast<uint8_t*>(buffer) + size);
+    flatcc_builder_aligned_free(buffer);
+    flatcc_builder_clear(&builder);
+  }
+
+  iree_const_byte_span_t data() const {
+    return iree_make_const_byte_span(data_.data(), data_.size());
+  }
+
+  std::vector<uint8_t> data_;
+};
+
+TEST_F(PIMExecutableDumpTest, OpcodeNames) {
+  EXPECT_STREQ("QKVGen", iree_hal_pim_opcode_name(2));
+  EXPECT_STREQ("FFN2", iree_hal_pim_opcode_name(9));
+  EXPECT_STREQ("LMHead", iree_hal_pim_opcode_name(10));
+  EXPECT_STREQ("Gather", iree_hal_pim_opcode_name(11));
+  EXPECT_STREQ("RMSNorm", iree_hal_pim_opcode_name(12));
+  EXPECT_STREQ("GQASVMatmul", iree_hal_pim_opcode_name(17));
+  EXPECT_STREQ("Elementwise", iree_hal_pim_opcode_name(18));
+  EXPECT_STREQ("unknown", iree_hal_pim_opcode_name(0));
+  EXPECT_STREQ("unknown", iree_hal_pim_opcode_name(42));
+}
+
+TEST_F(PIMExecutableDumpTest, Isa) {
+  EXPECT_TRUE(iree_hal_pim_executable_data_isa(data()));
+  const uint8_t not_pim[16] = {0};
+  EXPECT_FALSE(iree_hal_pim_executable_data_isa(
+      iree_make_const_byte_span(not_pim, sizeof(not_pim))));
+  EXPECT_FALSE(iree_hal_pim_executable_data_isa(iree_const_byte_span_empty()));
+}
+
+TEST_F(PIMExecutableDumpTest, Stats) {
+  iree_hal_pim_executable_stats_t stats;
+  IREE_ASSERT_OK(iree_hal_pim_executable_compute_stats(data(), &stats));
+  EXPECT_EQ(data_.size(), stats.byte_length);
+  EXPECT_EQ(1, stats.entry_point_count);
+  EXPECT_EQ(2, stats.instruction_count);
+  EXPECT_EQ(1, stats.sync_count);
+  EXPECT_EQ(4, stats.dim_count);
+  EXPECT_EQ(4, stats.operand_slot_count);
+  EXPECT_EQ(1, stats.opcode_counts[1]);
+  EXPECT_EQ(1, stats.opcode_counts[2]);
+  EXPECT_EQ(0, stats.opcode_counts[0]);
+}
+
+TEST_F(PIMExecutableDumpTest, Disassemble) {
+  iree_string_builder_t builder;
+  iree_string_builder_initialize(iree_allocator_system(), &builder);
+  IREE_ASSERT_OK(iree_hal_pim_executable_disassemble(data(), &builder));
+  std::string listing(iree_string_builder_buffer(&builder),
+                      iree_string_builder_size(&builder));
+  iree_string_builder_deinitialize(&builder);
+  EXPECT_EQ(
+      "entry points: decoder\n"
+      "  binding[0]: f32[1x768]\n"
+      "  binding[1]: f32[dynamic]\n"
+      "     0: QKVGen     split=row-wise type=f32 dims=(pc[0], 768, 2304) "
+      "slots=($0, %0) sync=all-gather\n"
+      "     1: LayerNorm1 split=none type=f16 dims=(768) slots=(%0, $1)\n",
+      listing);
+}
+
+// Two linked entry points: a layer norm over one binding and a softmax over
+// two bindings. Neither has operand slots.
+TEST(PIMExecutableDumpLinkedTest, Disassemble) {
+  flatcc_builder_t builder;
+  flatcc_builder_init(&builder);
+  iree_PIMExecutableDef_start_as_root(&builder);
+  flatbuffers_string_ref_t entry_points[] = {
+      flatbuffers_string_create_str(&builder, "norm"),
+      flatbuffers_string_create_str(&builder, "softmax"),
+  };
+  auto entry_points_ref =
+      flatbuffers_string_vec_create(&builder, entry_points, 2);
+  const uint64_t code[] = {
+      1 | (1ull << 12),  // LayerNorm1, 1 dim
+      4 | (1ull << 12),  // Softmax, 1 dim
+  };
+  auto code_ref = flatbuffers_uint64_vec_create(&builder, code, 2);
+  const int32_t dims[] = {768, 128};
+  auto dims_ref = flatbuffers_int32_vec_create(&builder, dims, 2);
+  const uint8_t binding_ranks[] = {1, 1, 0};
+  auto binding_ranks_ref =
+      flatbuffers_uint8_vec_create(&builder, binding_ranks, 3);
+  const int32_t binding_dims[] = {768, 128};
+  auto binding_dims_ref =
+      flatbuffers_int32_vec_create(&builder, binding_dims, 2);
+  const uint32_t entry_code_offsets[] = {0, 1, 2};
+  auto entry_code_offsets_ref =
+      flatbuffers_uint32_vec_create(&builder, entry_code_offsets, 3);
+  const uint32_t entry_binding_offsets[] = {0, 1, 3};
+  auto entry_binding_offsets_ref =
+      flatbuffers_uint32_vec_create(&builder, entry_binding_offsets, 3);
+  iree_PIMExecutableDef_entry_points_add(&builder, entry_points_ref);
+  iree_PIMExecutableDef_code_add(&builder, code_ref);
+  iree_PIMExecutableDef_dims_add(&builder, dims_ref);
+  iree_PIMExecutableDef_binding_ranks_add(&builder, binding_ranks_ref);
+  iree_PIMExecutableDef_binding_dims_add(&builder, binding_dims_ref);
+  iree_PIMExecutableDef_entry_code_offsets_add(&builder,
+                                               entry_code_offsets_ref);
+  iree_PIMExecutableDef_entry_binding_offsets_add(&builder,
+                                                  entry_binding_offsets_ref);
+  iree_PIMExecutableDef_end_as_root(&builder);
+  size_t size = 0;
+  void* buffer = flatcc_builder_finalize_aligned_buffer(&builder, &size);
+  std::vector<uint8_t> data(static_cast<uint8_t*>(buffer),
+                            static_cast<uint8_t*>(buffer) + size);
+  flatcc_builder_aligned_free(buffer);
+  flatcc_builder_clear(&builder);
+
+  iree_string_builder_t string_builder;
+  iree_string_builder_initialize(iree_allocator_system(), &string_builder);
+  IREE_ASSERT_OK(iree_hal_pim_executable_disassemble(
+      iree_make_const_byte_span(data.data(), data.size()), &string_builder));
+  std::string listing(iree_string_builder_buffer(&string_builder),
+                      iree_string_builder_size(&string_builder));
+  iree_string_builder_deinitialize(&string_builder);
+  EXPECT_EQ(
+      "entry points: norm softmax\n"
+      "norm:\n"
+      "  binding[0]: f32[768]\n"
+      "     0: LayerNorm1 split=none type=f32 dims=(768)\n"
+      "softmax:\n"
+      "  binding[0]: f32[128]\n"
+      "  binding[1]: f32[dynamic]\n"
+      "     0: Softmax    split=none type=f32 dims=(128)\n",
+      listing);
+}
+
+// A layer norm reading its weights and biases from one fused binding and
+// writing its result at an offset provided by a push constant.
+TEST(PIMExecutableDumpFusedTest, Disassemble) {
+  flatcc_builder_t builder;
+  flatcc_builder_init(&builder);
+  iree_PIMExecutableDef_start_as_root(&builder);
+  flatbuffers_string_ref_t entry_points[] = {
+      flatbuffers_string_create_str(&builder, "norm"),
+  };
+  auto entry_points_ref =
+      flatbuffers_string_vec_create(&builder, entry_points, 1);
+  const uint64_t code[] = {
+      1 | (1ull << 12),  // LayerNorm1, 1 dim
+  };
+  auto code_ref = flatbuffers_uint64_vec_create(&builder, code, 1);
+  const int32_t dims[] = {768};
+  auto dims_ref = flatbuffers_int32_vec_create(&builder, dims, 1);
+  const uint8_t binding_ranks[] = {1, 1, 0};
+  auto binding_ranks_ref =
+      flatbuffers_uint8_vec_create(&builder, binding_ranks, 3);
+  const int32_t binding_dims[] = {768, 768};
+  auto binding_dims_ref =
+      flatbuffers_int32_vec_create(&builder, binding_dims, 2);
+  const uint32_t binding_sources[] = {0, 0, 1};
+  auto binding_sources_ref =
+      flatbuffers_uint32_vec_create(&builder, binding_sources, 3);
+  const int32_t binding_offsets[] = {0, 3072, -1};
+  auto binding_offsets_ref =
+      flatbuffers_int32_vec_create(&builder, binding_offsets, 3);
+  iree_PIMExecutableDef_entry_points_add(&builder, entry_points_ref);
+  iree_PIMExecutableDef_code_add(&builder, code_ref);
+  iree_PIMExecutableDef_dims_add(&builder, dims_ref);
+  iree_PIMExecutableDef_binding_ranks_add(&builder, binding_ranks_ref);
+  iree_PIMExecutableDef_binding_dims_add(&builder, binding_dims_ref);
+  iree_PIMExecutableDef_binding_sources_add(&builder, binding_sources_ref);
+  iree_PIMExecutableDef_binding_offsets_add(&builder, binding_offsets_ref);
+  iree_PIMExecutableDef_end_as_root(&builder);
+  size_t size = 0;
+  void* buffer = flatcc_builder_finalize_aligned_buffer(&builder, &size);
+  std::vector<uint8_t> data(static_cast<uint8_t*>(buffer),
+                            static_cast<uint8_t*>(buffer) + size);
+  flatcc_builder_aligned_free(buffer);
+  flatcc_builder_clear(&builder);
+
+  iree_string_builder_t string_builder;
+  iree_string_builder_initialize(iree_allocator_system(), &string_builder);
+  IREE_ASSERT_OK(iree_hal_pim_executable_disassemble(
+      iree_make_const_byte_span(data.data(), data.size()), &string_builder));
+  std::string listing(iree_string_builder_buffer(&string_builder),
+                      iree_string_builder_size(&string_builder));
+  iree_string_builder_deinitialize(&string_builder);
+  EXPECT_EQ(
+      "entry points: norm\n"
+      "  binding[0]: f32[768] view=$0+0\n"
+      "  binding[1]: f32[768] view=$0+3072\n"
+      "  binding[2]: f32[dynamic] view=$1+pc[0]\n"
+      "     0: LayerNorm1 split=none type=f32 dims=(768)\n",
+      listing);
+}
+
+TEST_F(PIMExecutableDumpTest, RejectsOtherData) {
+  const uint8_t not_pim[16] = {0};
+  iree_hal_pim_executable_stats_t stats;
+  IREE_EXPECT_STATUS_IS(
+      IREE_STATUS_INVALID_ARGUMENT,
+      iree_hal_pim_executable_compute_stats(
+          iree_make_const_byte_span(not_pim, sizeof(not_pim)), &stats));
+}
+
+}  // namespace
@@ -0,0 +1,107 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Reports the size and instruction mix of the PIM executables of compiled
+// modules so that command stream growth can be tracked across compiler
+// versions. Prints one line per executable and the totals of each module:
+//
+//   pim_executable_size_benchmark decoder.vmfb [more.vmfb...]
+//   decoder.vmfb rodata[3]: bytes=1232 instructions=9 syncs=2 dims=29 ...
+//   decoder.vmfb total: executables=1 bytes=1232 instructions=9 ...
+
+#include <cinttypes>
+#include <cstdio>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/file_io.h"
+#include "iree/hal/drivers/pim/util/pim_executable_dump.h"
+#include "iree/hal/drivers/pim/util/pim_module_executables.h"
+
+namespace {
+
+struct ModuleStats {
+  const char* path = nullptr;
+  iree_host_size_t executable_count = 0;
+  iree_hal_pim_executable_stats_t totals = {};
+};
+
+void PrintStats(const char* path, const char* label,
+                const iree_hal_pim_executable_stats_t& stats) {
+  fprintf(stdout,
+          "%s %s bytes=%" PRIhsz " instructions=%" PRIhsz " syncs=%" PRIhsz
+          " dims=%" PRIhsz " slots=%" PRIhsz,
+          path, label, stats.byte_length, stats.instruction_count,
+          stats.sync_count, stats.dim_count, stats.operand_slot_count);
+  for (uint32_t i = 0; i < IREE_HAL_PIM_OPCODE_COUNT; ++i) {
+    if (!stats.opcode_counts[i]) continue;
+    fprintf(stdout, " %s=%" PRIhsz, iree_hal_pim_opcode_name(i),
+            stats.opcode_counts[i]);
+  }
+  fprintf(stdout, "\n");
+}
+
+iree_status_t RecordExecutable(void* user_data, int64_t rodata_ordinal,
+                               iree_const_byte_span_t data) {
+  auto* module_stats = static_cast<ModuleStats*>(user_data);
+  iree_hal_pim_executable_stats_t stats;
+  IREE_RETURN_IF_ERROR(iree_hal_pim_executable_compute_stats(data, &stats));
+  char label[32] = "executable:";
+  if (rodata_ordinal >= 0) {
+    snprintf(label, sizeof(label), "rodata[%" PRId64 "]:", rodata_ordinal);
+  }
+  PrintStats(module_stats->path, label, stats);
+
+  iree_hal_pim_executable_stats_t& totals = module_stats->totals;
+  ++module_stats->executable_count;
+  totals.byte_length += stats.byte_length;
+  totals.entry_point_count += stats.entry_point_count;
+  totals.instruction_count += stats.instruction_count;
+  totals.sync_count += stats.sync_count;
+  totals.dim_count += stats.dim_count;
+  totals.operand_slot_count += stats.operand_slot_count;
+  for (uint32_t i = 0; i < IREE_HAL_PIM_OPCODE_COUNT; ++i) {
+    totals.opcode_counts[i] += stats.opcode_counts[i];
+  }
+  return iree_ok_status();
+}
+
+iree_status_t ReportModule(const char* path) {
+  iree_file_contents_t* file_contents = nullptr;
+  IREE_RETURN_IF_ERROR(
+      iree_file_read_contents(path, iree_allocator_system(), &file_contents));
+  ModuleStats module_stats;
+  module_stats.path = path;
+  iree_status_t status = iree_hal_pim_module_enumerate_executables(
+      file_contents->const_buffer, RecordExecutable, &module_stats);
+  iree_file_contents_free(file_contents);
+  IREE_RETURN_IF_ERROR(status);
+
+  char label[48];
+  snprintf(label, sizeof(label), "total: executables=%" PRIhsz,
+           module_stats.executable_count);
+  PrintStats(path, label, module_stats.totals);
+  return iree_ok_status();
+}
+
+}  // namespace
+
+extern "C" int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr,
+            "Syntax: pim_executable_size_benchmark module.vmfb "
+            "[module.vmfb...]\n");
+    return 1;
+  }
+  for (int i = 1; i < argc; ++i) {
+    iree_status_t status = ReportModule(argv[i]);
+    if (!iree_status_is_ok(status)) {
+      iree_status_fprint(stderr, status);
+      iree_status_free(status);
+      return 1;
+    }
+  }
+  return 0;
+}
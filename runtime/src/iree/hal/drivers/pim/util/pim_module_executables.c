@@ -0,0 +1,67 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/pim/util/pim_module_executables.h"
+
+#include "iree/hal/drivers/pim/util/pim_executable_dump.h"
+#include "iree/vm/bytecode_module.h"
+
+// flatcc schemas:
+#include "iree/base/internal/flatcc/parsing.h"
+#include "iree/schemas/bytecode_module_def_reader.h"
+
+iree_status_t iree_hal_pim_module_enumerate_executables(
+    iree_const_byte_span_t archive_contents,
+    iree_hal_pim_executable_callback_fn_t callback, void* user_data) {
+  if (iree_hal_pim_executable_data_isa(archive_contents)) {
+    return callback(user_data, -1, archive_contents);
+  }
+
+  iree_const_byte_span_t flatbuffer_contents = iree_const_byte_span_empty();
+  iree_host_size_t rodata_offset = 0;
+  IREE_RETURN_IF_ERROR(iree_vm_bytecode_module_parse_header(
+      archive_contents, &flatbuffer_contents, &rodata_offset));
+  iree_vm_BytecodeModuleDef_table_t module_def =
+      iree_vm_BytecodeModuleDef_as_root(flatbuffer_contents.data);
+  if (!module_def) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "module flatbuffer has no root table");
+  }
+
+  iree_vm_RodataSegmentDef_vec_t rodata_segments =
+      iree_vm_BytecodeModuleDef_rodata_segments(module_def);
+  for (iree_host_size_t i = 0;
+       i < iree_vm_RodataSegmentDef_vec_len(rodata_segments); ++i) {
+    iree_vm_RodataSegmentDef_table_t segment =
+        iree_vm_RodataSegmentDef_vec_at(rodata_segments, i);
+    // Executables are read in place by the HAL and never compressed.
+    if (iree_vm_RodataSegmentDef_compression_type_is_present(segment)) {
+      continue;
+    }
+    iree_const_byte_span_t data = iree_const_byte_span_empty();
+    if (iree_vm_RodataSegmentDef_embedded_data_is_present(segment)) {
+      flatbuffers_uint8_vec_t embedded_data =
+          iree_vm_RodataSegmentDef_embedded_data(segment);
+      data = iree_make_const_byte_span(
+          embedded_data, flatbuffers_uint8_vec_len(embedded_data));
+    } else {
+      uint64_t offset = rodata_offset +
+                        iree_vm_RodataSegmentDef_external_data_offset(segment);
+      uint64_t length = iree_vm_RodataSegmentDef_external_data_length(segment);
+      if (offset + length > archive_contents.data_length) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "rodata[%" PRIhsz
+                                "] external reference out of range",
+                                i);
+      }
+      data = iree_make_const_byte_span(archive_contents.data + offset,
+                                       (iree_host_size_t)length);
+    }
+    if (!iree_hal_pim_executable_data_isa(data)) continue;
+    IREE_RETURN_IF_ERROR(callback(user_data, (int64_t)i, data));
+  }
+  return iree_ok_status();
+}
@@ -0,0 +1,34 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_PIM_UTIL_PIM_MODULE_EXECUTABLES_H_
+#define IREE_HAL_DRIVERS_PIM_UTIL_PIM_MODULE_EXECUTABLES_H_
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Called with the flatbuffer |data| of each PIM executable found in a module.
+// |rodata_ordinal| is the rodata segment holding it or -1 if the module file
+// is itself a PIM executable.
+typedef iree_status_t (*iree_hal_pim_executable_callback_fn_t)(
+    void* user_data, int64_t rodata_ordinal, iree_const_byte_span_t data);
+
+// Calls |callback| with each PIM executable stored in the rodata of the
+// bytecode module |archive_contents| in rodata order. A bare PIM executable
+// (such as one written by --iree-hal-dump-executable-binaries-to) is passed
+// directly. Iteration stops at the first callback failure.
+iree_status_t iree_hal_pim_module_enumerate_executables(
+    iree_const_byte_span_t archive_contents,
+    iree_hal_pim_executable_callback_fn_t callback, void* user_data);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_PIM_UTIL_PIM_MODULE_EXECUTABLES_H_
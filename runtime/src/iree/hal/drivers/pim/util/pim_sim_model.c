@@ -0,0 +1,96 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/pim/util/pim_sim_model.h"
+
+#include <math.h>
+#include <string.h>
+
+void iree_hal_pim_sim_params_initialize(iree_hal_pim_sim_params_t* out_params) {
+  memset(out_params, 0, sizeof(*out_params));
+  out_params->bank_count = 512;
+  out_params->row_buffer_bytes = 2048;
+  out_params->row_cycle_ns = 48.0;
+  out_params->bank_macs_per_ns = 16.0;
+  out_params->dispatch_latency_ns = 100.0;
+  out_params->host_bytes_per_ns = 16.0;
+  out_params->host_latency_ns = 1000.0;
+  out_params->link_bytes_per_ns = 25.0;
+  out_params->link_latency_ns = 1000.0;
+}
+
+uint64_t iree_hal_pim_sim_op_macs(int op_type, uint64_t lhs_element_count,
+                                  uint64_t lhs_inner_dim,
+                                  uint64_t result_element_count) {
+  switch (op_type) {
+    case 2:   // QKVGen
+    case 3:   // QKMatmul
+    case 5:   // SVMatmul
+    case 6:   // OutProj
+    case 8:   // FFN1
+    case 9:   // FFN2
+    case 10:  // LMHead
+    case 14:  // FFNGate
+    case 15:  // SwiGLU
+    case 16:  // GQAQKMatmul
+    case 17:  // GQASVMatmul
+      return result_element_count * lhs_inner_dim;
+    default:
+      return lhs_element_count;
+  }
+}
+
+// Rounds a modeled duration up to whole nanoseconds.
+static iree_time_t iree_hal_pim_sim_round_ns(double duration_ns) {
+  return duration_ns > 0.0 ? (iree_time_t)ceil(duration_ns) : 0;
+}
+
+iree_time_t iree_hal_pim_sim_dispatch_ns(
+    const iree_hal_pim_sim_params_t* params, uint64_t macs, uint64_t bytes_in,
+    uint64_t bytes_out) {
+  const uint64_t bank_count = params->bank_count ? params->bank_count : 1;
+  const uint64_t row_buffer_bytes =
+      params->row_buffer_bytes ? params->row_buffer_bytes : 1;
+  const uint64_t rows =
+      (bytes_in + bytes_out + row_buffer_bytes - 1) / row_buffer_bytes;
+  const uint64_t waves = (rows + bank_count - 1) / bank_count;
+  const double memory_ns = (double)waves * params->row_cycle_ns;
+  const double compute_ns =
+      params->bank_macs_per_ns > 0.0
+          ? (double)macs / ((double)bank_count * params->bank_macs_per_ns)
+          : 0.0;
+  return iree_hal_pim_sim_round_ns(
+      params->dispatch_latency_ns +
+      (memory_ns > compute_ns ? memory_ns : compute_ns));
+}
+
+iree_time_t iree_hal_pim_sim_transfer_ns(
+    const iree_hal_pim_sim_params_t* params, uint64_t bytes) {
+  const double transfer_ns = params->host_bytes_per_ns > 0.0
+                                 ? (double)bytes / params->host_bytes_per_ns
+                                 : 0.0;
+  return iree_hal_pim_sim_round_ns(params->host_latency_ns + transfer_ns);
+}
+
+iree_time_t iree_hal_pim_sim_collective_ns(
+    const iree_hal_pim_sim_params_t* params,
+    iree_hal_pim_sim_collective_t collective, int32_t participant_count,
+    uint64_t bytes) {
+  if (participant_count <= 1) return 0;
+  const double bytes_per_ns =
+      params->link_bytes_per_ns > 0.0 ? params->link_bytes_per_ns : INFINITY;
+  if (collective == IREE_HAL_PIM_SIM_COLLECTIVE_POINT_TO_POINT) {
+    return iree_hal_pim_sim_round_ns(params->link_latency_ns +
+                                     (double)bytes / bytes_per_ns);
+  }
+  // Every ring step moves one participant's chunk over each link.
+  const int64_t steps =
+      (participant_count - 1) *
+      (collective == IREE_HAL_PIM_SIM_COLLECTIVE_ALL_REDUCE ? 2 : 1);
+  const double chunk_bytes = (double)bytes / (double)participant_count;
+  return iree_hal_pim_sim_round_ns(
+      (double)steps * (params->link_latency_ns + chunk_bytes / bytes_per_ns));
+}
@@ -0,0 +1,94 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_PIM_UTIL_PIM_SIM_MODEL_H_
+#define IREE_HAL_DRIVERS_PIM_UTIL_PIM_SIM_MODEL_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Cycle-approximate latency model of a PIM module used by the `pim-sim`
+// driver in place of the wall time of SDK calls.
+//
+// Each bank streams its share of the operands through its row buffer. A row
+// takes |row_cycle_ns| to activate, read and precharge and all banks work in
+// parallel, so an instruction costs the larger of its row waves and its MACs
+// spread over the banks. Host transfers and collectives between modules are
+// a fixed latency plus bytes over the link bandwidth; collectives use a ring
+// schedule.
+typedef struct iree_hal_pim_sim_params_t {
+  // Banks working in parallel on one instruction.
+  uint32_t bank_count;
+  // Bytes read per row activation of a bank.
+  uint32_t row_buffer_bytes;
+  // Time to activate, read out and precharge one row.
+  double row_cycle_ns;
+  // Multiply-accumulates (or elementwise ops) per bank per nanosecond.
+  double bank_macs_per_ns;
+  // Fixed cost of issuing an instruction to the module.
+  double dispatch_latency_ns;
+  // Host<->module transfer bandwidth in bytes per nanosecond (GB/s).
+  double host_bytes_per_ns;
+  // Fixed cost of a host<->module transfer.
+  double host_latency_ns;
+  // Module<->module bandwidth in bytes per nanosecond (GB/s).
+  double link_bytes_per_ns;
+  // Fixed cost of each step of a ring collective.
+  double link_latency_ns;
+} iree_hal_pim_sim_params_t;
+
+// Initializes |out_params| to a module matching the default compiler target
+// (512 banks with 2 KiB row buffers, see --iree-pim-bank-count).
+void iree_hal_pim_sim_params_initialize(iree_hal_pim_sim_params_t* out_params);
+
+// Returns the multiply-accumulates of PIM instruction |op_type| reading an
+// lhs of |lhs_element_count| elements with innermost dim |lhs_inner_dim| and
+// producing |result_element_count| elements. Normalizations and softmax are
+// counted as one op per element read.
+uint64_t iree_hal_pim_sim_op_macs(int op_type, uint64_t lhs_element_count,
+                                  uint64_t lhs_inner_dim,
+                                  uint64_t result_element_count);
+
+// Returns the modeled latency of an instruction performing |macs| while
+// reading |bytes_in| and writing |bytes_out| bytes of device memory.
+iree_time_t iree_hal_pim_sim_dispatch_ns(
+    const iree_hal_pim_sim_params_t* params, uint64_t macs, uint64_t bytes_in,
+    uint64_t bytes_out);
+
+// Returns the modeled latency of moving |bytes| between host and module.
+iree_time_t iree_hal_pim_sim_transfer_ns(
+    const iree_hal_pim_sim_params_t* params, uint64_t bytes);
+
+// Collectives with a modeled cost.
+typedef enum iree_hal_pim_sim_collective_e {
+  // Reduce-scatter followed by all-gather: 2 * (count - 1) ring steps.
+  IREE_HAL_PIM_SIM_COLLECTIVE_ALL_REDUCE = 0,
+  // count - 1 ring steps.
+  IREE_HAL_PIM_SIM_COLLECTIVE_ALL_GATHER,
+  // count - 1 ring steps.
+  IREE_HAL_PIM_SIM_COLLECTIVE_REDUCE_SCATTER,
+  // A single transfer of the whole buffer.
+  IREE_HAL_PIM_SIM_COLLECTIVE_POINT_TO_POINT,
+} iree_hal_pim_sim_collective_t;
+
+// Returns the modeled latency of |collective| over |participant_count|
+// modules where |bytes| is the size of the full (gathered or reduced) result.
+// Collectives within a single module are free.
+iree_time_t iree_hal_pim_sim_collective_ns(
+    const iree_hal_pim_sim_params_t* params,
+    iree_hal_pim_sim_collective_t collective, int32_t participant_count,
+    uint64_t bytes);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_PIM_UTIL_PIM_SIM_MODEL_H_
@@ -0,0 +1,82 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/pim/util/pim_sim_model.h"
+
+#include "iree/testing/gtest.h"
+
+namespace {
+
+// 4 banks of 1 KiB rows with round numbers so expected latencies are exact.
+class PIMSimModelTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    iree_hal_pim_sim_params_initialize(&params_);
+    params_.bank_count = 4;
+    params_.row_buffer_bytes = 1024;
+    params_.row_cycle_ns = 50.0;
+    params_.bank_macs_per_ns = 1.0;
+    params_.dispatch_latency_ns = 10.0;
+    params_.host_bytes_per_ns = 2.0;
+    params_.host_latency_ns = 100.0;
+    params_.link_bytes_per_ns = 1.0;
+    params_.link_latency_ns = 20.0;
+  }
+
+  iree_hal_pim_sim_params_t params_;
+};
+
+TEST_F(PIMSimModelTest, OpMacs) {
+  // FFN1 of a [4x768] lhs into [4x3072] does 768 MACs per result element.
+  EXPECT_EQ(4u * 3072u * 768u,
+            iree_hal_pim_sim_op_macs(8, 4 * 768, 768, 4 * 3072));
+  // Softmax touches every lhs element once.
+  EXPECT_EQ(4u * 128u, iree_hal_pim_sim_op_macs(4, 4 * 128, 128, 4 * 128));
+}
+
+TEST_F(PIMSimModelTest, DispatchIsMemoryBound) {
+  // 8 rows over 4 banks take 2 row cycles and outweigh 64 MACs on 4 banks.
+  EXPECT_EQ(10 + 2 * 50,
+            iree_hal_pim_sim_dispatch_ns(&params_, 64, 7 * 1024, 1024));
+  // A partial row still takes a full row cycle.
+  EXPECT_EQ(10 + 50, iree_hal_pim_sim_dispatch_ns(&params_, 0, 1, 0));
+}
+
+TEST_F(PIMSimModelTest, DispatchIsComputeBound) {
+  // 4000 MACs over 4 banks take 1000ns compared to one row cycle.
+  EXPECT_EQ(10 + 1000, iree_hal_pim_sim_dispatch_ns(&params_, 4000, 1024, 0));
+}
+
+TEST_F(PIMSimModelTest, MoreBanksAreFaster) {
+  const iree_time_t narrow =
+      iree_hal_pim_sim_dispatch_ns(&params_, 1 << 20, 1 << 20, 1 << 16);
+  params_.bank_count = 16;
+  const iree_time_t wide =
+      iree_hal_pim_sim_dispatch_ns(&params_, 1 << 20, 1 << 20, 1 << 16);
+  EXPECT_LT(wide, narrow);
+}
+
+TEST_F(PIMSimModelTest, Transfer) {
+  EXPECT_EQ(100 + 512, iree_hal_pim_sim_transfer_ns(&params_, 1024));
+}
+
+TEST_F(PIMSimModelTest, Collectives) {
+  // Single participants don't communicate.
+  EXPECT_EQ(0, iree_hal_pim_sim_collective_ns(
+                   &params_, IREE_HAL_PIM_SIM_COLLECTIVE_ALL_REDUCE, 1, 4096));
+  // 4 participants move 1 KiB chunks: 3 steps to gather, 6 to reduce.
+  EXPECT_EQ(3 * (20 + 1024),
+            iree_hal_pim_sim_collective_ns(
+                &params_, IREE_HAL_PIM_SIM_COLLECTIVE_ALL_GATHER, 4, 4096));
+  EXPECT_EQ(6 * (20 + 1024),
+            iree_hal_pim_sim_collective_ns(
+                &params_, IREE_HAL_PIM_SIM_COLLECTIVE_ALL_REDUCE, 4, 4096));
+  EXPECT_EQ(20 + 4096,
+            iree_hal_pim_sim_collective_ns(
+                &params_, IREE_HAL_PIM_SIM_COLLECTIVE_POINT_TO_POINT, 4, 4096));
+}
+
+}  // namespace
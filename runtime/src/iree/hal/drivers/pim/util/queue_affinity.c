@@ -0,0 +1,39 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/pim/util/queue_affinity.h"
+
+#include "iree/base/internal/math.h"
+
+iree_host_size_t iree_hal_pim_select_queue_index(
+    iree_host_size_t queue_count, iree_hal_queue_affinity_t queue_affinity) {
+  if (queue_count <= 1 || queue_affinity == 0) return 0;
+  return (iree_host_size_t)iree_math_count_trailing_zeros_u64(queue_affinity) %
+         queue_count;
+}
+
+iree_status_t iree_hal_pim_resolve_channel_rank(
+    iree_host_size_t queue_count, iree_hal_queue_affinity_t queue_affinity,
+    int32_t rank, int32_t count, int32_t* out_rank, int32_t* out_count) {
+  *out_rank = 0;
+  *out_count = 0;
+  if (count == IREE_HAL_CHANNEL_COUNT_DEFAULT) {
+    count = (int32_t)queue_count;
+  }
+  if (rank == IREE_HAL_CHANNEL_RANK_DEFAULT) {
+    if (count > 1 && queue_affinity == IREE_HAL_QUEUE_AFFINITY_ANY) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "a queue affinity or explicit rank is required "
+                              "to create a channel with %d participants",
+                              count);
+    }
+    rank = (int32_t)iree_hal_pim_select_queue_index(queue_count,
+                                                    queue_affinity);
+  }
+  *out_rank = rank;
+  *out_count = count;
+  return iree_ok_status();
+}
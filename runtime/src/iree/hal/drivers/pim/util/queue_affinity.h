@@ -0,0 +1,42 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_PIM_UTIL_QUEUE_AFFINITY_H_
+#define IREE_HAL_DRIVERS_PIM_UTIL_QUEUE_AFFINITY_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Returns the index of the queue out of |queue_count| that |queue_affinity|
+// selects.
+//
+// Matches the local-task device: the lowest set affinity bit picks the queue
+// so distinct single-bit affinities land on distinct queues (modulo the
+// queue count) while IREE_HAL_QUEUE_AFFINITY_ANY and any other affinity
+// including bit 0 share the first queue.
+iree_host_size_t iree_hal_pim_select_queue_index(
+    iree_host_size_t queue_count, iree_hal_queue_affinity_t queue_affinity);
+
+// Resolves the rank and participant count of a channel created with
+// |queue_affinity| on a device with |queue_count| queues.
+//
+// IREE_HAL_CHANNEL_COUNT_DEFAULT uses every queue of the device and
+// IREE_HAL_CHANNEL_RANK_DEFAULT the index of the queue the affinity selects.
+// Fails if a default rank is requested for a multi-participant channel
+// without a specific affinity as every such channel would get rank 0.
+iree_status_t iree_hal_pim_resolve_channel_rank(
+    iree_host_size_t queue_count, iree_hal_queue_affinity_t queue_affinity,
+    int32_t rank, int32_t count, int32_t* out_rank, int32_t* out_count);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_PIM_UTIL_QUEUE_AFFINITY_H_
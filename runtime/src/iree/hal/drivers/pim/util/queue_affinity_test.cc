@@ -0,0 +1,75 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/pim/util/queue_affinity.h"
+
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+TEST(PIMQueueAffinityTest, SingleQueue) {
+  EXPECT_EQ(0u, iree_hal_pim_select_queue_index(1, 0));
+  EXPECT_EQ(0u, iree_hal_pim_select_queue_index(1, 1ull << 5));
+  EXPECT_EQ(0u, iree_hal_pim_select_queue_index(1, IREE_HAL_QUEUE_AFFINITY_ANY));
+}
+
+TEST(PIMQueueAffinityTest, AnySelectsFirstQueue) {
+  EXPECT_EQ(0u, iree_hal_pim_select_queue_index(4, IREE_HAL_QUEUE_AFFINITY_ANY));
+  EXPECT_EQ(0u, iree_hal_pim_select_queue_index(3, IREE_HAL_QUEUE_AFFINITY_ANY));
+  EXPECT_EQ(0u, iree_hal_pim_select_queue_index(4, 0));
+}
+
+TEST(PIMQueueAffinityTest, SingleBitsSelectDistinctQueues) {
+  EXPECT_EQ(0u, iree_hal_pim_select_queue_index(4, 1ull << 0));
+  EXPECT_EQ(1u, iree_hal_pim_select_queue_index(4, 1ull << 1));
+  EXPECT_EQ(2u, iree_hal_pim_select_queue_index(4, 1ull << 2));
+  EXPECT_EQ(3u, iree_hal_pim_select_queue_index(4, 1ull << 3));
+  // Bits past the queue count wrap around.
+  EXPECT_EQ(0u, iree_hal_pim_select_queue_index(4, 1ull << 4));
+  EXPECT_EQ(3u, iree_hal_pim_select_queue_index(4, 1ull << 63));
+}
+
+TEST(PIMQueueAffinityTest, LowestBitWins) {
+  EXPECT_EQ(1u, iree_hal_pim_select_queue_index(4, (1ull << 1) | (1ull << 3)));
+  EXPECT_EQ(2u, iree_hal_pim_select_queue_index(4, ~0ull << 2));
+}
+
+TEST(PIMQueueAffinityTest, DefaultChannelRankMatchesQueue) {
+  for (int32_t i = 0; i < 4; ++i) {
+    int32_t rank = -1, count = -1;
+    IREE_ASSERT_OK(iree_hal_pim_resolve_channel_rank(
+        4, 1ull << i, IREE_HAL_CHANNEL_RANK_DEFAULT,
+        IREE_HAL_CHANNEL_COUNT_DEFAULT, &rank, &count));
+    EXPECT_EQ(i, rank);
+    EXPECT_EQ(4, count);
+  }
+}
+
+TEST(PIMQueueAffinityTest, ExplicitChannelRank) {
+  int32_t rank = -1, count = -1;
+  IREE_ASSERT_OK(iree_hal_pim_resolve_channel_rank(
+      4, IREE_HAL_QUEUE_AFFINITY_ANY, 2, 3, &rank, &count));
+  EXPECT_EQ(2, rank);
+  EXPECT_EQ(3, count);
+}
+
+TEST(PIMQueueAffinityTest, DefaultChannelRankRequiresAffinity) {
+  int32_t rank = -1, count = -1;
+  IREE_EXPECT_STATUS_IS(
+      IREE_STATUS_INVALID_ARGUMENT,
+      iree_hal_pim_resolve_channel_rank(
+          4, IREE_HAL_QUEUE_AFFINITY_ANY, IREE_HAL_CHANNEL_RANK_DEFAULT,
+          IREE_HAL_CHANNEL_COUNT_DEFAULT, &rank, &count));
+  // A single participant is always rank 0.
+  IREE_ASSERT_OK(iree_hal_pim_resolve_channel_rank(
+      1, IREE_HAL_QUEUE_AFFINITY_ANY, IREE_HAL_CHANNEL_RANK_DEFAULT,
+      IREE_HAL_CHANNEL_COUNT_DEFAULT, &rank, &count));
+  EXPECT_EQ(0, rank);
+  EXPECT_EQ(1, count);
+}
+
+}  // namespace
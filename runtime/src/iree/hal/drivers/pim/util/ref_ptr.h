@@ -4,8 +4,8 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
-#ifndef IREE_HAL_DRIVERS_VULKAN_UTIL_REF_PTR_H_
-#define IREE_HAL_DRIVERS_VULKAN_UTIL_REF_PTR_H_
+#ifndef IREE_HAL_DRIVERS_PIM_UTIL_REF_PTR_H_
+#define IREE_HAL_DRIVERS_PIM_UTIL_REF_PTR_H_
 
 #include <atomic>
 #include <cstddef>
@@ -380,4 +380,4 @@ void swap(ref_ptr<T>& lhs, ref_ptr<T>& rhs) {
 
 }  // namespace iree
 
-#endif  // IREE_HAL_DRIVERS_VULKAN_UTIL_REF_PTR_H_
+#endif  // IREE_HAL_DRIVERS_PIM_UTIL_REF_PTR_H_
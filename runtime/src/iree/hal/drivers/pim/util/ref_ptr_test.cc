@@ -4,7 +4,7 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
-#include "iree/hal/drivers/vulkan/util/ref_ptr.h"
+#include "iree/hal/drivers/pim/util/ref_ptr.h"
 
 #include "iree/testing/gtest.h"
 
@@ -4,8 +4,8 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
-#ifndef IREE_HAL_DRIVERS_VULKAN_VULKAN_HEADERS_H_
-#define IREE_HAL_DRIVERS_VULKAN_VULKAN_HEADERS_H_
+#ifndef IREE_HAL_DRIVERS_PIM_VULKAN_HEADERS_H_
+#define IREE_HAL_DRIVERS_PIM_VULKAN_HEADERS_H_
 
 #include "iree/base/target_platform.h"
 
@@ -13,12 +13,12 @@
 // are no accidental calls to the linker-loaded implicit functions we just
 // compile them all out.
 //
-// Code under iree/hal/drivers/vulkan/ *MUST NOT* directly include vulkan.h or
+// Code under iree/hal/drivers/pim/ *MUST NOT* directly include vulkan.h or
 // any header that includes it without this first being set. This means that
-// this iree/hal/drivers/vulkan/vulkan_headers.h file must usually be included
+// this iree/hal/drivers/pim/vulkan_headers.h file must usually be included
 // first in all files using it.
 //
-// From there, use iree/hal/drivers/vulkan/dynamic_symbols.h to plumb the
+// From there, use iree/hal/drivers/pim/dynamic_symbols.h to plumb the
 // dynamically resolved symbols to any code that may need to make Vulkan calls.
 // See that header for more information: in general we try to keep our required
 // set of symbols minimal to avoid binary size/runtime memory/linker time so
@@ -47,4 +47,4 @@
 #include <vulkan/vulkan_beta.h>  // IWYU pragma: export
 #endif
 
-#endif  // IREE_HAL_DRIVERS_VULKAN_VULKAN_HEADERS_H_
+#endif  // IREE_HAL_DRIVERS_PIM_VULKAN_HEADERS_H_
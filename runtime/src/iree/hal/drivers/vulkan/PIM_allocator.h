@@ -1,27 +0,0 @@
-// Copyright 2019 The IREE Authors
-//
-// Licensed under the Apache License v2.0 with LLVM Exceptions.
-// See https://llvm.org/LICENSE.txt for license information.
-// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
-
-#ifndef IREE_HAL_DRIVERS_VULKAN_VMA_ALLOCATOR_H_
-#define IREE_HAL_DRIVERS_VULKAN_VMA_ALLOCATOR_H_
-
-#include "iree/base/api.h"
-#include "iree/hal/api.h"
-#include "iree/hal/drivers/vulkan/handle_util.h"
-
-#ifdef __cplusplus
-extern "C" {
-#endif  // __cplusplus
-
-
-iree_status_t iree_hal_vulkan_vma_allocator_create(
-    iree_allocator_t host_allocator,
-    iree_hal_device_t* device, iree_hal_allocator_t** out_allocator);
-
-#ifdef __cplusplus
-}  // extern "C"
-#endif  // __cplusplus
-
-#endif  // IREE_HAL_DRIVERS_VULKAN_VMA_ALLOCATOR_H_
@@ -7,6 +7,7 @@
 #include "iree/hal/local/elf/elf_module.h"
 
 #include <inttypes.h>
+#include <stdio.h>
 #include <string.h>
 
 #include "iree/base/target_platform.h"
@@ -20,6 +21,7 @@
 
 // Fields taken from the ELF headers used only during verification and loading.
 typedef struct iree_elf_module_load_state_t {
+  iree_elf_module_flags_t flags;
   iree_memory_info_t memory_info;
   const iree_elf_ehdr_t* ehdr;
   const iree_elf_phdr_t* phdr_table;  // ehdr.e_phnum has count
@@ -230,6 +232,35 @@ static iree_byte_range_t iree_elf_module_calculate_vaddr_range(
   return byte_range;
 }
 
+// Accumulates the pages spanned by |byte_range| into the module TLB footprint.
+// When |large_page_size| is non-zero the naturally aligned large pages fully
+// contained in the range are counted as such and the rest as normal pages.
+static void iree_elf_module_count_pages(iree_elf_module_t* module,
+                                        iree_byte_range_t byte_range,
+                                        iree_host_size_t normal_page_size,
+                                        iree_host_size_t large_page_size) {
+  uintptr_t start = (uintptr_t)module->vaddr_bias + byte_range.offset;
+  uintptr_t end = start + byte_range.length;
+  uintptr_t large_start = end;
+  uintptr_t large_end = end;
+  if (large_page_size) {
+    large_start = iree_page_align_end(start, large_page_size);
+    large_end = iree_page_align_start(end, large_page_size);
+    if (large_start >= large_end) large_start = large_end = end;
+    module->large_page_count += (large_end - large_start) / large_page_size;
+  }
+  // Normal pages before and after the large pages, if any.
+  module->normal_page_count +=
+      (iree_page_align_end(large_start, normal_page_size) -
+       iree_page_align_start(start, normal_page_size)) /
+      normal_page_size;
+  if (large_end != end) {
+    module->normal_page_count +=
+        (iree_page_align_end(end, normal_page_size) - large_end) /
+        normal_page_size;
+  }
+}
+
 // Allocates space for and loads all DT_LOAD segments into the host virtual
 // address space.
 static iree_status_t iree_elf_module_load_segments(
@@ -239,13 +270,26 @@ static iree_status_t iree_elf_module_load_segments(
   iree_byte_range_t vaddr_range =
       iree_elf_module_calculate_vaddr_range(load_state);
 
+  // Large pages are only worth their coarser reservation granularity when at
+  // least one of them can be filled.
+  const iree_host_size_t normal_page_size =
+      load_state->memory_info.normal_page_size;
+  const iree_host_size_t large_page_size =
+      load_state->memory_info.large_page_granularity;
+  const bool use_large_pages =
+      iree_all_bits_set(load_state->flags, IREE_ELF_MODULE_FLAG_LARGE_PAGES) &&
+      large_page_size > normal_page_size &&
+      vaddr_range.length >= large_page_size;
+
   // Reserve virtual address space in the host memory space. This memory is
   // uncommitted by default as the ELF may only sparsely use the address space.
+  iree_memory_view_flags_t view_flags = IREE_MEMORY_VIEW_FLAG_MAY_EXECUTE;
+  if (use_large_pages) view_flags |= IREE_MEMORY_VIEW_FLAG_LARGE_PAGES;
   module->vaddr_size = iree_page_align_end(
-      vaddr_range.length, load_state->memory_info.normal_page_size);
-  IREE_RETURN_IF_ERROR(iree_memory_view_reserve(
-      IREE_MEMORY_VIEW_FLAG_MAY_EXECUTE, module->vaddr_size,
-      module->host_allocator, (void**)&module->vaddr_base));
+      vaddr_range.length, use_large_pages ? large_page_size : normal_page_size);
+  IREE_RETURN_IF_ERROR(iree_memory_view_reserve(view_flags, module->vaddr_size,
+                                                module->host_allocator,
+                                                (void**)&module->vaddr_base));
   module->vaddr_bias = module->vaddr_base - vaddr_range.offset;
 
   // Commit and load all of the segments.
@@ -263,6 +307,13 @@ static iree_status_t iree_elf_module_load_segments(
         module->vaddr_bias, 1, &byte_range,
         IREE_MEMORY_ACCESS_READ | IREE_MEMORY_ACCESS_WRITE));
 
+    // The hint must precede the copy below as that first touches the pages.
+    bool large_pages_advised =
+        use_large_pages && iree_memory_view_advise_large_pages(
+                               module->vaddr_bias, 1, &byte_range);
+    iree_elf_module_count_pages(module, byte_range, normal_page_size,
+                                large_pages_advised ? large_page_size : 0);
+
     // Copy data present in the file.
     // TODO(benvanik): infra for being able to detect if the source model is in
     // a mapped file - if it is, we can remap the page and directly reference it
@@ -573,7 +624,7 @@ static const iree_elf_sym_t* iree_elf_module_lookup_global_symbol(
 
 iree_status_t iree_elf_module_initialize_from_memory(
     iree_const_byte_span_t raw_data,
-    const iree_elf_import_table_t* import_table,
+    const iree_elf_import_table_t* import_table, iree_elf_module_flags_t flags,
     iree_allocator_t host_allocator, iree_elf_module_t* out_module) {
   IREE_ASSERT_ARGUMENT(raw_data.data);
   IREE_ASSERT_ARGUMENT(out_module);
@@ -587,12 +638,23 @@ iree_status_t iree_elf_module_initialize_from_memory(
   iree_status_t status =
       iree_elf_module_parse_headers(raw_data, &load_state, out_module);
   out_module->host_allocator = host_allocator;
+  load_state.flags = flags;
 
   // Allocate and load the ELF into memory.
   iree_memory_jit_context_begin();
   if (iree_status_is_ok(status)) {
     status = iree_elf_module_load_segments(raw_data, &load_state, out_module);
   }
+  IREE_TRACE({
+    if (iree_status_is_ok(status)) {
+      char footprint[64];
+      int footprint_length =
+          snprintf(footprint, IREE_ARRAYSIZE(footprint),
+                   "%" PRIhsz " normal + %" PRIhsz " large pages",
+                   out_module->normal_page_count, out_module->large_page_count);
+      IREE_TRACE_ZONE_APPEND_TEXT(z0, footprint, footprint_length);
+    }
+  });
 
   // Parse required dynamic symbol tables in loaded memory. These are used for
   // runtime symbol resolution and relocation.
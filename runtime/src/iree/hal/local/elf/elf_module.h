@@ -34,6 +34,19 @@ typedef struct iree_elf_import_table_t {
 // Runtime ELF module loader/linker
 //==============================================================================
 
+// Flags controlling how ELF modules are loaded.
+enum iree_elf_module_flag_bits_t {
+  IREE_ELF_MODULE_FLAG_NONE = 0u,
+
+  // Backs the loaded segments with large pages when the platform supports it
+  // (transparent huge pages on Linux). Reduces iTLB/dTLB pressure of modules
+  // with large code or constant segments at the cost of reserving address
+  // space in large page granularity. Ignored for modules smaller than a single
+  // large page.
+  IREE_ELF_MODULE_FLAG_LARGE_PAGES = 1u << 0,
+};
+typedef uint32_t iree_elf_module_flags_t;
+
 // An ELF module mapped directly from memory.
 typedef struct iree_elf_module_t {
   // Allocator used for additional dynamic memory when needed.
@@ -56,6 +69,14 @@ typedef struct iree_elf_module_t {
   // Dynamic symbol table (.dynsym).
   const iree_elf_sym_t* dynsym;   // DT_SYMTAB
   iree_host_size_t dynsym_count;  // DT_SYMENT (bytes) / sizeof(iree_elf_sym_t)
+
+  // TLB footprint of the loaded segments computed at load time: the number of
+  // normal and large pages spanned, whose sum is the number of TLB entries
+  // required to map the whole module. Large pages are only counted for ranges
+  // where the platform accepted the large page hint; the kernel may still
+  // choose to back some of them with normal pages.
+  iree_host_size_t normal_page_count;
+  iree_host_size_t large_page_count;
 } iree_elf_module_t;
 
 // Initializes an ELF module from the ELF |raw_data| in memory.
@@ -74,7 +95,7 @@ typedef struct iree_elf_module_t {
 // loaded module, etc).
 iree_status_t iree_elf_module_initialize_from_memory(
     iree_const_byte_span_t raw_data,
-    const iree_elf_import_table_t* import_table,
+    const iree_elf_import_table_t* import_table, iree_elf_module_flags_t flags,
     iree_allocator_t host_allocator, iree_elf_module_t* out_module);
 
 // Deinitializes a |module|, releasing any allocated executable or data pages.
@@ -60,7 +60,8 @@ static iree_status_t run_test() {
   memset(&import_table, 0, sizeof(import_table));
   iree_elf_module_t module;
   IREE_RETURN_IF_ERROR(iree_elf_module_initialize_from_memory(
-      file_data, &import_table, iree_allocator_system(), &module));
+      file_data, &import_table, IREE_ELF_MODULE_FLAG_NONE,
+      iree_allocator_system(), &module));
 
   iree_hal_executable_environment_v0_t environment;
   iree_hal_executable_environment_initialize(iree_allocator_system(),
@@ -78,13 +79,20 @@ static iree_status_t run_test() {
       (const iree_hal_executable_library_header_t**)iree_elf_call_p_ip(
           query_fn_ptr, IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST,
           &environment);
+  if (library.header == NULL) {
+    // The test modules are built for v0.3 and only respond to that version.
+    library.header =
+        (const iree_hal_executable_library_header_t**)iree_elf_call_p_ip(
+            query_fn_ptr, IREE_HAL_EXECUTABLE_LIBRARY_VERSION_0_3,
+            &environment);
+  }
   if (library.header == NULL) {
     return iree_make_status(IREE_STATUS_NOT_FOUND,
                             "library header is empty (version mismatch?)");
   }
 
   const iree_hal_executable_library_header_t* header = *library.header;
-  if (header->version != IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST) {
+  if (header->version > IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST) {
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "library version error");
   }
@@ -132,6 +140,7 @@ static iree_status_t run_test() {
       .workgroup_id_y = 0,
       .workgroup_id_z = 0,
       .processor_id = iree_cpu_query_processor_id(),
+      .workgroup_range_count = 1,
   };
   int ret = iree_elf_call_i_ppp((const void*)library.v0->exports.ptrs[0],
                                 (void*)&environment, (void*)&dispatch_state,
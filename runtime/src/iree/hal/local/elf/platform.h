@@ -128,6 +128,12 @@ enum iree_memory_view_flag_bits_t {
   // Indicates that the memory may be used to execute code.
   // May be used to ask for special privileges (like MAP_JIT on MacOS).
   IREE_MEMORY_VIEW_FLAG_MAY_EXECUTE = 1u << 10,
+
+  // Requests that the view be backed by large pages when the platform supports
+  // it. The base address will be aligned to the large page granularity and
+  // committed ranges must additionally be hinted with
+  // iree_memory_view_advise_large_pages. Ignored on platforms without support.
+  IREE_MEMORY_VIEW_FLAG_LARGE_PAGES = 1u << 11,
 };
 typedef uint32_t iree_memory_view_flags_t;
 
@@ -158,6 +164,17 @@ iree_status_t iree_memory_view_commit_ranges(
     void* base_address, iree_host_size_t range_count,
     const iree_byte_range_t* ranges, iree_memory_access_t initial_access);
 
+// Hints that the committed pages overlapping |byte_ranges| should be backed by
+// large pages. Must be called after committing and before first touching the
+// pages for the hint to apply at fault time. Returns true if the platform
+// accepted the hint; the kernel may still decline to back some or all pages.
+// Only effective on views reserved with IREE_MEMORY_VIEW_FLAG_LARGE_PAGES.
+//
+// Implemented by madvise(MADV_HUGEPAGE) (transparent huge pages) on Linux.
+bool iree_memory_view_advise_large_pages(void* base_address,
+                                         iree_host_size_t range_count,
+                                         const iree_byte_range_t* ranges);
+
 // Changes the access protection of view byte ranges defined by |byte_ranges|.
 // Ranges will be adjusted to the page granularity of the view.
 //
@@ -143,6 +143,13 @@ iree_status_t iree_memory_view_commit_ranges(
   return status;
 }
 
+bool iree_memory_view_advise_large_pages(void* base_address,
+                                         iree_host_size_t range_count,
+                                         const iree_byte_range_t* ranges) {
+  // Large pages are not supported on this platform.
+  return false;
+}
+
 iree_status_t iree_memory_view_protect_ranges(void* base_address,
                                               iree_host_size_t range_count,
                                               const iree_byte_range_t* ranges,
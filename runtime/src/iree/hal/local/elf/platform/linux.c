@@ -11,6 +11,8 @@
 #if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
 
 #include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
 #include <sys/mman.h>
 #include <unistd.h>
 
@@ -18,6 +20,40 @@
 // Memory subsystem information and control
 //==============================================================================
 
+// Reads up to |buffer_capacity| - 1 bytes of the file at |path| into |buffer|
+// as a NUL-terminated string. Returns false if the file could not be read.
+static bool iree_memory_read_sysfs_file(const char* path, char* buffer,
+                                        iree_host_size_t buffer_capacity) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) return false;
+  ssize_t length = read(fd, buffer, buffer_capacity - 1);
+  close(fd);
+  if (length <= 0) return false;
+  buffer[length] = 0;
+  return true;
+}
+
+// Returns the size of transparent huge pages or 0 if they are unavailable or
+// disabled system-wide. Explicit hugetlbfs pages are not used as they require
+// a preallocated pool and would force the protection granularity of loaded
+// segments to the huge page size.
+// https://www.kernel.org/doc/html/latest/admin-guide/mm/transhuge.html
+static iree_host_size_t iree_memory_query_transparent_huge_page_size(void) {
+  char buffer[64];
+  if (!iree_memory_read_sysfs_file(
+          "/sys/kernel/mm/transparent_hugepage/enabled", buffer,
+          sizeof(buffer)) ||
+      strstr(buffer, "[never]")) {
+    return 0;
+  }
+  if (!iree_memory_read_sysfs_file(
+          "/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", buffer,
+          sizeof(buffer))) {
+    return 0;
+  }
+  return (iree_host_size_t)strtoull(buffer, NULL, 10);
+}
+
 void iree_memory_query_info(iree_memory_info_t* out_info) {
   memset(out_info, 0, sizeof(*out_info));
 
@@ -25,14 +61,13 @@ void iree_memory_query_info(iree_memory_info_t* out_info) {
   out_info->normal_page_size = page_size;
   out_info->normal_page_granularity = page_size;
 
-  // Large pages arent't currently used so we aren't introducing the build goo
-  // to detect and use them yet.
-  // https://linux.die.net/man/3/gethugepagesizes
-  // http://manpages.ubuntu.com/manpages/bionic/man3/gethugepagesize.3.html
-  // Would be:
-  //   #include <hugetlbfs.h>
-  //   out_info->large_page_granularity = gethugepagesize();
-  out_info->large_page_granularity = page_size;
+  // Large pages are transparent huge pages requested with madvise; see
+  // iree_memory_view_advise_large_pages.
+  iree_host_size_t huge_page_size =
+      iree_memory_query_transparent_huge_page_size();
+  out_info->large_page_granularity =
+      huge_page_size > (iree_host_size_t)page_size ? huge_page_size
+                                                   : page_size;
 
   out_info->can_allocate_executable_pages = true;
 }
@@ -63,11 +98,29 @@ iree_status_t iree_memory_view_reserve(iree_memory_view_flags_t flags,
   int mmap_prot = PROT_NONE;
   int mmap_flags = MAP_PRIVATE | MAP_ANON | MAP_NORESERVE;
 
+  // Large pages can only back naturally aligned ranges so we over-reserve by
+  // one large page and trim the unaligned head and tail.
+  iree_host_size_t alignment = 0;
+  if (flags & IREE_MEMORY_VIEW_FLAG_LARGE_PAGES) {
+    alignment = iree_memory_query_transparent_huge_page_size();
+    if (alignment <= (iree_host_size_t)getpagesize()) alignment = 0;
+  }
+
   iree_status_t status = iree_ok_status();
-  void* base_address = mmap(NULL, total_length, mmap_prot, mmap_flags, -1, 0);
+  void* base_address = mmap(NULL, total_length + alignment, mmap_prot,
+                            mmap_flags, -1, 0);
   if (base_address == MAP_FAILED) {
     status = iree_make_status(iree_status_code_from_errno(errno),
                               "mmap reservation failed");
+    base_address = NULL;
+  } else if (alignment) {
+    uint8_t* aligned_address =
+        (uint8_t*)iree_page_align_end((uintptr_t)base_address, alignment);
+    iree_host_size_t head_length = aligned_address - (uint8_t*)base_address;
+    iree_host_size_t tail_length = alignment - head_length;
+    if (head_length) munmap(base_address, head_length);
+    if (tail_length) munmap(aligned_address + total_length, tail_length);
+    base_address = aligned_address;
   }
 
   *out_base_address = base_address;
@@ -112,6 +165,26 @@ iree_status_t iree_memory_view_commit_ranges(
   return status;
 }
 
+bool iree_memory_view_advise_large_pages(void* base_address,
+                                         iree_host_size_t range_count,
+                                         const iree_byte_range_t* ranges) {
+#if defined(MADV_HUGEPAGE)
+  bool applied = true;
+  for (iree_host_size_t i = 0; i < range_count; ++i) {
+    void* range_start = NULL;
+    iree_host_size_t aligned_length = 0;
+    iree_page_align_range(base_address, ranges[i], getpagesize(), &range_start,
+                          &aligned_length);
+    if (madvise(range_start, aligned_length, MADV_HUGEPAGE) != 0) {
+      applied = false;
+    }
+  }
+  return applied;
+#else
+  return false;
+#endif  // MADV_HUGEPAGE
+}
+
 iree_status_t iree_memory_view_protect_ranges(void* base_address,
                                               iree_host_size_t range_count,
                                               const iree_byte_range_t* ranges,
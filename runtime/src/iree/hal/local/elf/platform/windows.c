@@ -118,6 +118,14 @@ iree_status_t iree_memory_view_commit_ranges(
   return status;
 }
 
+bool iree_memory_view_advise_large_pages(void* base_address,
+                                         iree_host_size_t range_count,
+                                         const iree_byte_range_t* ranges) {
+  // Large pages on Windows must be committed with MEM_LARGE_PAGES in a single
+  // allocation and require SeLockMemoryPrivilege; not supported here.
+  return false;
+}
+
 iree_status_t iree_memory_view_protect_ranges(void* base_address,
                                               iree_host_size_t range_count,
                                               const iree_byte_range_t* ranges,
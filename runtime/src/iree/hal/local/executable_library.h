@@ -40,6 +40,14 @@
 // Defines a bitfield of features that the library requires or supports.
 enum iree_hal_executable_library_feature_bits_t {
   IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_NONE = 0u,
+  // Dispatches expect denormal floats to be flushed to zero (FTZ/DAZ) and may
+  // have been compiled assuming so. Hosts set the FPU state around workgroups
+  // of the library.
+  IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_FLUSH_DENORMALS_TO_ZERO = 1u << 0,
+  // Dispatch functions execute a range of workgroups per call as specified by
+  // iree_hal_executable_workgroup_state_v0_t::workgroup_range_count. Hosts may
+  // call once per contiguous run of workgroups instead of once per workgroup.
+  IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_WORKGROUP_RANGES = 1u << 1,
   // TODO(benvanik): declare features for debugging/coverage/printf/etc.
   // These will control which symbols are injected into the library at runtime.
 };
@@ -88,11 +96,13 @@ typedef struct iree_hal_executable_environment_v0_t
 typedef uint32_t iree_hal_executable_library_version_t;
 
 #define IREE_HAL_EXECUTABLE_LIBRARY_VERSION_0_3 0x00000003u
+// Adds iree_hal_executable_workgroup_state_v0_t::workgroup_range_count.
+#define IREE_HAL_EXECUTABLE_LIBRARY_VERSION_0_4 0x00000004u
 
 // The latest version of the library API; can be used to populate the
 // iree_hal_executable_library_header_t::version when building libraries.
 #define IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST \
-  IREE_HAL_EXECUTABLE_LIBRARY_VERSION_0_3
+  IREE_HAL_EXECUTABLE_LIBRARY_VERSION_0_4
 
 // A header present at the top of all versions of the library API used by the
 // runtime to ensure version compatibility.
@@ -348,7 +358,12 @@ typedef struct iree_hal_executable_workgroup_state_v0_t {
   // the requested amount.
   uint32_t local_memory_size;
 
-  // +4 trailing bytes of free space
+  // Number of workgroups to execute starting at the workgroup ID in x-fastest
+  // linear order within the dispatch workgroup count. Ranges may span rows and
+  // slices of the grid. Only libraries declaring
+  // IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_WORKGROUP_RANGES are passed values
+  // other than 1; all others execute exactly one workgroup per call.
+  uint32_t workgroup_range_count;
 } iree_hal_executable_workgroup_state_v0_t;
 static_assert(
     sizeof(iree_hal_executable_workgroup_state_v0_t) <= 64,
@@ -357,7 +372,9 @@ static_assert(
 // Function signature of exported executable entry points.
 // The same |environment| is passed to all dispatches.
 // The same |dispatch_state| is passed to all workgroups within a dispatch.
-// A unique |workgroup_state| is passed to every workgroup within a dispatch.
+// A unique |workgroup_state| is passed to every workgroup within a dispatch or,
+// for libraries declaring IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_WORKGROUP_RANGES,
+// to every range of workgroups.
 //
 // Returns 0 on success and non-zero on failure. Failures will cause device loss
 // and should only be used to communicate serious issues that should abort all
@@ -21,6 +21,14 @@
 #include "iree/hal/local/local_pipeline_layout.h"
 #include "iree/testing/benchmark.h"
 
+#if defined(IREE_PLATFORM_LINUX)
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif  // IREE_PLATFORM_LINUX
+
 IREE_FLAG(string, executable_format, "",
           "Format of the executable file being loaded.");
 IREE_FLAG(string, executable_file, "",
@@ -49,6 +57,16 @@ IREE_FLAG(int32_t, workgroup_size_z, 1,
 IREE_FLAG(int32_t, max_concurrency, 1,
           "Maximum available concurrency exposed to the dispatch.");
 
+IREE_FLAG(string, perf_counters, "",
+          "Comma-separated list of hardware counters sampled while running\n"
+          "the dispatches and reported per dispatch (Linux only):\n"
+          "  cycles, instructions, llc_references, llc_misses,\n"
+          "  branch_misses, or raw:<config> for a model-specific event.\n"
+          "Vector utilization can be measured with raw events, such as\n"
+          "FP_ARITH_INST_RETIRED.{SCALAR,256B_PACKED,512B_PACKED}_SINGLE\n"
+          "(raw:0x02c7, raw:0x20c7, raw:0x80c7) on Intel x86-64.\n"
+          "IPC is reported when both cycles and instructions are sampled.");
+
 // Total number of bindings we (currently) allow any executable to have.
 #define IREE_HAL_LOCAL_MAX_TOTAL_BINDING_COUNT \
   (IREE_HAL_LOCAL_MAX_DESCRIPTOR_SET_COUNT *   \
@@ -130,6 +148,184 @@ IREE_FLAG_CALLBACK(
     "  # 2 4-byte floating-point values with contents [[1.4], [2.1]]:\n"
     "  --binding=2x1xf32=1.4,2.1");
 
+//===----------------------------------------------------------------------===//
+// Hardware performance counters
+//===----------------------------------------------------------------------===//
+
+#define IREE_HAL_PERF_COUNTER_MAX_COUNT 8
+
+// A group of hardware counters scheduled onto the PMU together so that derived
+// metrics (IPC, miss rates) are computed from the same time window.
+typedef struct iree_hal_perf_counters_t {
+  iree_host_size_t count;
+  iree_string_view_t names[IREE_HAL_PERF_COUNTER_MAX_COUNT];
+  int fds[IREE_HAL_PERF_COUNTER_MAX_COUNT];
+  // Values read after sampling, scaled up if the group was multiplexed.
+  double values[IREE_HAL_PERF_COUNTER_MAX_COUNT];
+} iree_hal_perf_counters_t;
+
+static void iree_hal_perf_counters_close(iree_hal_perf_counters_t* counters) {
+#if defined(IREE_PLATFORM_LINUX)
+  for (iree_host_size_t i = 0; i < counters->count; ++i) {
+    close(counters->fds[i]);
+  }
+#endif  // IREE_PLATFORM_LINUX
+  counters->count = 0;
+}
+
+#if defined(IREE_PLATFORM_LINUX)
+
+static iree_status_t iree_hal_perf_counter_parse(iree_string_view_t name,
+                                                 uint32_t* out_type,
+                                                 uint64_t* out_config) {
+  static const struct {
+    const char* name;
+    uint32_t type;
+    uint64_t config;
+  } known_events[] = {
+      {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+      {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+      {"llc_references", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES},
+      {"llc_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+      {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+  };
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(known_events); ++i) {
+    if (iree_string_view_equal(name,
+                               iree_make_cstring_view(known_events[i].name))) {
+      *out_type = known_events[i].type;
+      *out_config = known_events[i].config;
+      return iree_ok_status();
+    }
+  }
+  iree_string_view_t raw_config = name;
+  if (iree_string_view_consume_prefix(&raw_config, IREE_SV("raw:")) &&
+      iree_string_view_atoi_uint64(raw_config, out_config)) {
+    *out_type = PERF_TYPE_RAW;
+    return iree_ok_status();
+  }
+  return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                          "unknown perf counter '%.*s'", (int)name.size,
+                          name.data);
+}
+
+// Opens the counters listed in |spec| disabled; the first counter leads the
+// group and controls all others.
+static iree_status_t iree_hal_perf_counters_open(
+    iree_string_view_t spec, iree_hal_perf_counters_t* counters) {
+  memset(counters, 0, sizeof(*counters));
+  iree_status_t status = iree_ok_status();
+  while (iree_status_is_ok(status) && !iree_string_view_is_empty(spec)) {
+    iree_string_view_t name = iree_string_view_empty();
+    iree_string_view_split(spec, ',', &name, &spec);
+    name = iree_string_view_trim(name);
+    if (iree_string_view_is_empty(name)) continue;
+    if (counters->count >= IREE_HAL_PERF_COUNTER_MAX_COUNT) {
+      status = iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                                "at most %d perf counters may be sampled",
+                                IREE_HAL_PERF_COUNTER_MAX_COUNT);
+      break;
+    }
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    uint64_t config = 0;
+    status = iree_hal_perf_counter_parse(name, &attr.type, &config);
+    if (!iree_status_is_ok(status)) break;
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                       PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // Dispatches run in user mode on this thread; excluding the kernel also
+    // keeps this usable with the default perf_event_paranoid setting.
+    attr.disabled = counters->count == 0 ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    int group_fd = counters->count == 0 ? -1 : counters->fds[0];
+    int fd = (int)syscall(SYS_perf_event_open, &attr, /*pid=*/0, /*cpu=*/-1,
+                          group_fd, /*flags=*/0);
+    if (fd < 0) {
+      status = iree_make_status(iree_status_code_from_errno(errno),
+                                "perf_event_open failed for '%.*s' (%d); check "
+                                "/proc/sys/kernel/perf_event_paranoid",
+                                (int)name.size, name.data, errno);
+      break;
+    }
+    counters->names[counters->count] = name;
+    counters->fds[counters->count] = fd;
+    ++counters->count;
+  }
+  if (!iree_status_is_ok(status)) iree_hal_perf_counters_close(counters);
+  return status;
+}
+
+static void iree_hal_perf_counters_start(iree_hal_perf_counters_t* counters) {
+  if (!counters->count) return;
+  ioctl(counters->fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(counters->fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+static iree_status_t iree_hal_perf_counters_stop(
+    iree_hal_perf_counters_t* counters) {
+  if (!counters->count) return iree_ok_status();
+  ioctl(counters->fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+  // PERF_FORMAT_GROUP layout: nr, time_enabled, time_running, values[nr].
+  uint64_t data[3 + IREE_HAL_PERF_COUNTER_MAX_COUNT];
+  ssize_t read_size = read(counters->fds[0], data, sizeof(data));
+  if (read_size < (ssize_t)((3 + counters->count) * sizeof(data[0]))) {
+    return iree_make_status(IREE_STATUS_DATA_LOSS,
+                            "failed to read perf counter group");
+  }
+  // Scale up if the kernel had to multiplex the group with other events.
+  double scale = data[2] ? (double)data[1] / (double)data[2] : 0.0;
+  for (iree_host_size_t i = 0; i < counters->count; ++i) {
+    counters->values[i] = (double)data[3 + i] * scale;
+  }
+  return iree_ok_status();
+}
+
+#else
+
+static iree_status_t iree_hal_perf_counters_open(
+    iree_string_view_t spec, iree_hal_perf_counters_t* counters) {
+  memset(counters, 0, sizeof(*counters));
+  if (iree_string_view_is_empty(spec)) return iree_ok_status();
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "perf counters are only available on Linux");
+}
+
+static void iree_hal_perf_counters_start(iree_hal_perf_counters_t* counters) {}
+
+static iree_status_t iree_hal_perf_counters_stop(
+    iree_hal_perf_counters_t* counters) {
+  return iree_ok_status();
+}
+
+#endif  // IREE_PLATFORM_LINUX
+
+// Reports the sampled counters averaged over the dispatches of the run.
+static void iree_hal_perf_counters_report(
+    const iree_hal_perf_counters_t* counters,
+    iree_benchmark_state_t* benchmark_state) {
+  double cycles = 0.0;
+  double instructions = 0.0;
+  for (iree_host_size_t i = 0; i < counters->count; ++i) {
+    char name[64];
+    snprintf(name, sizeof(name), "%.*s", (int)counters->names[i].size,
+             counters->names[i].data);
+    iree_benchmark_set_counter(benchmark_state, name, counters->values[i],
+                               IREE_BENCHMARK_COUNTER_FLAG_AVG_ITERATIONS);
+    if (iree_string_view_equal(counters->names[i], IREE_SV("cycles"))) {
+      cycles = counters->values[i];
+    } else if (iree_string_view_equal(counters->names[i],
+                                      IREE_SV("instructions"))) {
+      instructions = counters->values[i];
+    }
+  }
+  if (cycles > 0.0 && instructions > 0.0) {
+    iree_benchmark_set_counter(benchmark_state, "IPC", instructions / cycles,
+                               IREE_BENCHMARK_COUNTER_FLAG_NONE);
+  }
+}
+
 // NOTE: error handling is here just for better diagnostics: it is not tracking
 // allocations correctly and will leak. Don't use this as an example for how to
 // write robust code.
@@ -238,12 +434,19 @@ static iree_status_t iree_hal_executable_library_run(
   // we are testing the memory access patterns: if we just ran the same single
   // tile processing the same exact region of memory over and over we are not
   // testing cache effects.
+  iree_hal_perf_counters_t perf_counters;
+  IREE_RETURN_IF_ERROR(iree_hal_perf_counters_open(
+      iree_make_cstring_view(FLAG_perf_counters), &perf_counters));
+  iree_hal_perf_counters_start(&perf_counters);
   int64_t dispatch_count = 0;
   while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
     IREE_RETURN_IF_ERROR(iree_hal_local_executable_issue_dispatch_inline(
         local_executable, FLAG_entry_point, &dispatch_state, 0, local_memory));
     ++dispatch_count;
   }
+  IREE_RETURN_IF_ERROR(iree_hal_perf_counters_stop(&perf_counters));
+  iree_hal_perf_counters_report(&perf_counters, benchmark_state);
+  iree_hal_perf_counters_close(&perf_counters);
 
   // To get a total time per invocation we set the item count to the total
   // invocations dispatched. That gives us both total dispatch and single
@@ -98,6 +98,7 @@ int main(int argc, char** argv) {
   };
   iree_hal_executable_workgroup_state_v0_t workgroup_state = {
       .processor_id = iree_cpu_query_processor_id(),
+      .workgroup_range_count = 1,
   };
   for (uint32_t z = 0; z < dispatch_state.workgroup_count_z; ++z) {
     workgroup_state.workgroup_id_z = z;
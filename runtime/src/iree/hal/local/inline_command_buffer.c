@@ -12,6 +12,7 @@
 
 #include "iree/base/api.h"
 #include "iree/base/internal/cpu.h"
+#include "iree/base/internal/flight_recorder.h"
 #include "iree/base/internal/fpu_state.h"
 #include "iree/base/internal/math.h"
 #include "iree/base/tracing.h"
@@ -28,6 +29,9 @@ typedef struct iree_hal_inline_command_buffer_t {
   iree_hal_command_buffer_t base;
   iree_allocator_t host_allocator;
 
+  // Optional handler for large dispatches; otherwise all execute inline.
+  iree_hal_inline_dispatch_handler_t dispatch_handler;
+
   struct {
     // A flattened list of all available descriptor set bindings.
     // As descriptor sets are pushed/bound the bindings will be updated to
@@ -190,6 +194,14 @@ static void iree_hal_inline_command_buffer_destroy(
   IREE_TRACE_ZONE_END(z0);
 }
 
+void iree_hal_inline_command_buffer_set_dispatch_handler(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_inline_dispatch_handler_t handler) {
+  iree_hal_inline_command_buffer_t* command_buffer =
+      iree_hal_inline_command_buffer_cast(base_command_buffer);
+  command_buffer->dispatch_handler = handler;
+}
+
 bool iree_hal_inline_command_buffer_isa(
     iree_hal_command_buffer_t* command_buffer) {
   return iree_hal_command_buffer_dyn_cast(
@@ -452,8 +464,11 @@ static iree_status_t iree_hal_inline_command_buffer_dispatch(
   iree_hal_inline_command_buffer_t* command_buffer =
       iree_hal_inline_command_buffer_cast(base_command_buffer);
 
-  iree_hal_local_executable_t* local_executable =
-      iree_hal_local_executable_cast(executable);
+  // Executables may still be preparing; dispatches are recorded against the
+  // prepared executable and |executable| keeps it alive.
+  iree_hal_local_executable_t* local_executable = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_local_executable_resolve(
+      iree_hal_local_executable_cast(executable), &local_executable));
   if (IREE_UNLIKELY(!local_executable->pipeline_layouts)) {
     return iree_make_status(
         IREE_STATUS_FAILED_PRECONDITION,
@@ -487,8 +502,17 @@ static iree_status_t iree_hal_inline_command_buffer_dispatch(
   dispatch_state->workgroup_count_y = workgroup_y;
   dispatch_state->workgroup_count_z = workgroup_z;
 
-  // Single-threaded.
-  dispatch_state->max_concurrency = 1;
+  // Large dispatches are distributed by the handler if one is set; all others
+  // are single-threaded.
+  const iree_hal_inline_dispatch_handler_t* dispatch_handler =
+      &command_buffer->dispatch_handler;
+  const uint64_t workgroup_count =
+      (uint64_t)workgroup_x * workgroup_y * workgroup_z;
+  const bool use_dispatch_handler =
+      dispatch_handler->fn && dispatch_handler->max_concurrency > 1 &&
+      workgroup_count >= dispatch_handler->min_workgroup_count;
+  dispatch_state->max_concurrency =
+      use_dispatch_handler ? dispatch_handler->max_concurrency : 1;
 
   // Push constants are pulled directly from the command buffer state, but we
   // only allow the dispatch to read what we know is initialized based on the
@@ -524,6 +548,20 @@ static iree_status_t iree_hal_inline_command_buffer_dispatch(
         command_buffer->state.full_binding_lengths[binding_ordinal];
   }
 
+  // The handler allocates per-thread local memory and sets up its own threads'
+  // floating point state.
+  if (use_dispatch_handler) {
+    iree_flight_recorder_record(IREE_FLIGHT_RECORDER_EVENT_DISPATCH_BEGIN,
+                                (uint64_t)(uintptr_t)dispatch_state,
+                                workgroup_count);
+    iree_status_t status =
+        dispatch_handler->fn(dispatch_handler->user_data, local_executable,
+                             entry_point, dispatch_state, local_memory_size);
+    iree_flight_recorder_record(IREE_FLIGHT_RECORDER_EVENT_DISPATCH_END,
+                                (uint64_t)(uintptr_t)dispatch_state, 0);
+    return status;
+  }
+
   // TODO(benvanik): plumb through an arena or fixed-size reservation to use.
   // For now when deploying to devices where you want something like the
   // inline command buffer you probably don't want 256KB of transient memory
@@ -538,6 +576,10 @@ static iree_status_t iree_hal_inline_command_buffer_dispatch(
                                                (void**)&local_memory.data));
   }
 
+  iree_flight_recorder_record(IREE_FLIGHT_RECORDER_EVENT_DISPATCH_BEGIN,
+                              (uint64_t)(uintptr_t)dispatch_state,
+                              workgroup_count);
+
   // Since we are running on a borrowed thread, we know nothing about the
   // floating point state. Reset it.
   iree_fpu_state_t fpu_state =
@@ -546,6 +588,8 @@ static iree_status_t iree_hal_inline_command_buffer_dispatch(
       local_executable, entry_point, dispatch_state,
       command_buffer->state.processor_id, local_memory);
   iree_fpu_state_pop(fpu_state);
+  iree_flight_recorder_record(IREE_FLIGHT_RECORDER_EVENT_DISPATCH_END,
+                              (uint64_t)(uintptr_t)dispatch_state, 0);
 
   if (local_memory.data) {
     iree_allocator_free(command_buffer->host_allocator, local_memory.data);
@@ -9,11 +9,46 @@
 
 #include "iree/base/api.h"
 #include "iree/hal/api.h"
+#include "iree/hal/local/local_executable.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif  // __cplusplus
 
+// Issues all workgroups of a dispatch of |ordinal| in |executable| and returns
+// once they have completed. |dispatch_state| is fully populated (including
+// max_concurrency) and each workgroup must be provided at least
+// |local_memory_size| bytes of scratch memory.
+typedef iree_status_t(IREE_API_PTR* iree_hal_inline_dispatch_fn_t)(
+    void* user_data, iree_hal_local_executable_t* executable,
+    iree_host_size_t ordinal,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    iree_host_size_t local_memory_size);
+
+// Optional handler used by inline command buffers to distribute workgroups of
+// large dispatches across multiple threads. Dispatches smaller than the
+// threshold (or all dispatches if no |fn| is set) execute on the calling
+// thread. Execution remains synchronous: the handler must not return until
+// the dispatch has completed.
+typedef struct iree_hal_inline_dispatch_handler_t {
+  // Function issuing dispatches, or NULL to execute all dispatches inline.
+  iree_hal_inline_dispatch_fn_t fn;
+  // User data passed to |fn|. Must remain valid for as long as any command
+  // buffer using the handler.
+  void* user_data;
+  // Minimum total workgroup count of a dispatch issued via |fn|.
+  uint32_t min_workgroup_count;
+  // Maximum number of threads |fn| may run workgroups on concurrently.
+  uint32_t max_concurrency;
+} iree_hal_inline_dispatch_handler_t;
+
+// Returns a handler that executes all dispatches on the calling thread.
+static inline iree_hal_inline_dispatch_handler_t
+iree_hal_inline_dispatch_handler_null(void) {
+  iree_hal_inline_dispatch_handler_t handler = {NULL, NULL, 0, 0};
+  return handler;
+}
+
 // Returns the size, in bytes, of an inline command buffer.
 // This can be used for arena/stack allocations along with
 // iree_hal_inline_command_buffer_initialize/iree_hal_inline_command_buffer_deinitialize.
@@ -45,7 +80,9 @@ void iree_hal_inline_command_buffer_deinitialize(
 // can begin execution immediately. No inter-command-buffer scheduling will be
 // performed and all barriers and events are ignored.
 //
-// Executes all work on the calling thread synchronously (today).
+// Executes all work synchronously on the calling thread or, for large
+// dispatches, on the threads of a handler set with
+// iree_hal_inline_command_buffer_set_dispatch_handler.
 //
 // Must have IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION set.
 iree_status_t iree_hal_inline_command_buffer_create(
@@ -55,6 +92,13 @@ iree_status_t iree_hal_inline_command_buffer_create(
     iree_allocator_t host_allocator,
     iree_hal_command_buffer_t** out_command_buffer);
 
+// Sets the |handler| used to issue large dispatches recorded into
+// |command_buffer|. Command buffers default to executing all dispatches on the
+// calling thread.
+void iree_hal_inline_command_buffer_set_dispatch_handler(
+    iree_hal_command_buffer_t* command_buffer,
+    iree_hal_inline_dispatch_handler_t handler);
+
 // Returns true if |command_buffer| is an inline command buffer.
 bool iree_hal_inline_command_buffer_isa(
     iree_hal_command_buffer_t* command_buffer);
@@ -48,11 +48,18 @@ static iree_status_t iree_hal_elf_executable_query_library(
       &executable->module, IREE_HAL_EXECUTABLE_LIBRARY_EXPORT_NAME,
       (void**)&query_fn));
 
-  // Query for a compatible version of the library.
+  // Query for a compatible version of the library. Libraries built prior to
+  // v0.4 only respond to the exact version they were built for.
   executable->library.header =
       (const iree_hal_executable_library_header_t**)iree_elf_call_p_ip(
           query_fn, IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST,
           &executable->base.environment);
+  if (!executable->library.header) {
+    executable->library.header =
+        (const iree_hal_executable_library_header_t**)iree_elf_call_p_ip(
+            query_fn, IREE_HAL_EXECUTABLE_LIBRARY_VERSION_0_3,
+            &executable->base.environment);
+  }
   if (!executable->library.header) {
     return iree_make_status(
         IREE_STATUS_FAILED_PRECONDITION,
@@ -81,6 +88,7 @@ static iree_status_t iree_hal_elf_executable_query_library(
   executable->identifier = iree_make_cstring_view(header->name);
 
   executable->base.dispatch_attrs = executable->library.v0->exports.attrs;
+  executable->base.library_features = header->features;
 
   return iree_ok_status();
 }
@@ -135,7 +143,8 @@ static iree_status_t iree_hal_elf_executable_resolve_imports(
 static iree_status_t iree_hal_elf_executable_create(
     const iree_hal_executable_params_t* executable_params,
     const iree_hal_executable_import_provider_t import_provider,
-    iree_allocator_t host_allocator, iree_hal_executable_t** out_executable) {
+    iree_elf_module_flags_t module_flags, iree_allocator_t host_allocator,
+    iree_hal_executable_t** out_executable) {
   IREE_ASSERT_ARGUMENT(executable_params);
   IREE_ASSERT_ARGUMENT(executable_params->executable_data.data &&
                        executable_params->executable_data.data_length);
@@ -180,7 +189,7 @@ static iree_status_t iree_hal_elf_executable_create(
     // Attempt to load the ELF module.
     status = iree_elf_module_initialize_from_memory(
         executable_params->executable_data, /*import_table=*/NULL,
-        host_allocator, &executable->module);
+        module_flags, host_allocator, &executable->module);
   }
   if (iree_status_is_ok(status)) {
     // Query metadata and get the entry point function pointers.
@@ -331,6 +340,8 @@ static const iree_hal_local_executable_vtable_t iree_hal_elf_executable_vtable =
 typedef struct iree_hal_embedded_elf_loader_t {
   iree_hal_executable_loader_t base;
   iree_allocator_t host_allocator;
+  // Flags passed to iree_elf_module_initialize_from_memory for each load.
+  iree_elf_module_flags_t module_flags;
 } iree_hal_embedded_elf_loader_t;
 
 static const iree_hal_executable_loader_vtable_t
@@ -340,6 +351,16 @@ iree_status_t iree_hal_embedded_elf_loader_create(
     iree_hal_executable_import_provider_t import_provider,
     iree_allocator_t host_allocator,
     iree_hal_executable_loader_t** out_executable_loader) {
+  return iree_hal_embedded_elf_loader_create_with_flags(
+      IREE_HAL_EMBEDDED_ELF_LOADER_FLAG_NONE, import_provider, host_allocator,
+      out_executable_loader);
+}
+
+iree_status_t iree_hal_embedded_elf_loader_create_with_flags(
+    iree_hal_embedded_elf_loader_flags_t flags,
+    iree_hal_executable_import_provider_t import_provider,
+    iree_allocator_t host_allocator,
+    iree_hal_executable_loader_t** out_executable_loader) {
   IREE_ASSERT_ARGUMENT(out_executable_loader);
   *out_executable_loader = NULL;
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -352,6 +373,10 @@ iree_status_t iree_hal_embedded_elf_loader_create(
                                           import_provider,
                                           &executable_loader->base);
     executable_loader->host_allocator = host_allocator;
+    executable_loader->module_flags = IREE_ELF_MODULE_FLAG_NONE;
+    if (flags & IREE_HAL_EMBEDDED_ELF_LOADER_FLAG_LARGE_PAGES) {
+      executable_loader->module_flags |= IREE_ELF_MODULE_FLAG_LARGE_PAGES;
+    }
     *out_executable_loader = (iree_hal_executable_loader_t*)executable_loader;
   }
 
@@ -390,7 +415,8 @@ static iree_status_t iree_hal_embedded_elf_loader_try_load(
   // Perform the load of the ELF and wrap it in an executable handle.
   iree_status_t status = iree_hal_elf_executable_create(
       executable_params, base_executable_loader->import_provider,
-      executable_loader->host_allocator, out_executable);
+      executable_loader->module_flags, executable_loader->host_allocator,
+      out_executable);
 
   IREE_TRACE_ZONE_END(z0);
   return status;
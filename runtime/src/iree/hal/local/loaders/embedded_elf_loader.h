@@ -17,6 +17,18 @@
 extern "C" {
 #endif  // __cplusplus
 
+// Flags controlling how the embedded ELF loader maps executables.
+enum iree_hal_embedded_elf_loader_flag_bits_t {
+  IREE_HAL_EMBEDDED_ELF_LOADER_FLAG_NONE = 0u,
+
+  // Backs the code and data segments of loaded executables with large pages
+  // when the platform supports it (transparent huge pages on Linux). Large
+  // generated libraries with big constant pools otherwise take many iTLB/dTLB
+  // misses. Executables smaller than a large page are loaded as usual.
+  IREE_HAL_EMBEDDED_ELF_LOADER_FLAG_LARGE_PAGES = 1u << 0,
+};
+typedef uint32_t iree_hal_embedded_elf_loader_flags_t;
+
 // Creates an executable loader that can load minimally-featured ELF dynamic
 // libraries on any platform. This allows us to use a single file format across
 // all operating systems at the cost of some missing debugging/profiling
@@ -26,6 +38,14 @@ iree_status_t iree_hal_embedded_elf_loader_create(
     iree_allocator_t host_allocator,
     iree_hal_executable_loader_t** out_executable_loader);
 
+// Creates an embedded ELF executable loader as with
+// iree_hal_embedded_elf_loader_create with the behavior controlled by |flags|.
+iree_status_t iree_hal_embedded_elf_loader_create_with_flags(
+    iree_hal_embedded_elf_loader_flags_t flags,
+    iree_hal_executable_import_provider_t import_provider,
+    iree_allocator_t host_allocator,
+    iree_hal_executable_loader_t** out_executable_loader);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
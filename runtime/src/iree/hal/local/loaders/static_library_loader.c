@@ -68,6 +68,7 @@ static iree_status_t iree_hal_static_executable_create(
     executable->library.header = library_header;
     executable->identifier = iree_make_cstring_view((*library_header)->name);
     executable->base.dispatch_attrs = executable->library.v0->exports.attrs;
+    executable->base.library_features = (*library_header)->features;
 
     // Copy executable constants so we own them.
     if (executable_params->constant_count > 0) {
@@ -232,6 +233,11 @@ iree_status_t iree_hal_static_library_loader_create(
       const iree_hal_executable_library_header_t* const* header_ptr =
           library_query_fns[i](IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST,
                                &environment);
+      if (!header_ptr) {
+        // Libraries built prior to v0.4 only respond to their exact version.
+        header_ptr = library_query_fns[i](
+            IREE_HAL_EXECUTABLE_LIBRARY_VERSION_0_3, &environment);
+      }
       if (!header_ptr) {
         status = iree_make_status(
             IREE_STATUS_UNAVAILABLE,
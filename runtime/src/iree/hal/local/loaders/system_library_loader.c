@@ -144,10 +144,15 @@ static iree_status_t iree_hal_system_executable_query_library(
       executable->handle, IREE_HAL_EXECUTABLE_LIBRARY_EXPORT_NAME,
       (void**)&query_fn));
 
-  // Query for a compatible version of the library.
+  // Query for a compatible version of the library. Libraries built prior to
+  // v0.4 only respond to the exact version they were built for.
   executable->library.header =
       query_fn(IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST,
                &executable->base.environment);
+  if (!executable->library.header) {
+    executable->library.header = query_fn(
+        IREE_HAL_EXECUTABLE_LIBRARY_VERSION_0_3, &executable->base.environment);
+  }
   if (!executable->library.header) {
     return iree_make_status(
         IREE_STATUS_FAILED_PRECONDITION,
@@ -201,6 +206,7 @@ static iree_status_t iree_hal_system_executable_query_library(
   executable->identifier = iree_make_cstring_view(header->name);
 
   executable->base.dispatch_attrs = executable->library.v0->exports.attrs;
+  executable->base.library_features = header->features;
 
   return iree_ok_status();
 }
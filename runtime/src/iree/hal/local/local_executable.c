@@ -6,6 +6,7 @@
 
 #include "iree/hal/local/local_executable.h"
 
+#include "iree/base/internal/fpu_state.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/local/executable_environment.h"
 
@@ -28,6 +29,8 @@ void iree_hal_local_executable_initialize(
 
   // Function attributes are optional and populated by the parent type.
   out_base_executable->dispatch_attrs = NULL;
+  out_base_executable->library_features =
+      IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_NONE;
 
   // Default environment with no imports assigned.
   iree_hal_executable_environment_initialize(host_allocator,
@@ -47,6 +50,20 @@ iree_hal_local_executable_t* iree_hal_local_executable_cast(
   return (iree_hal_local_executable_t*)base_value;
 }
 
+iree_status_t iree_hal_local_executable_resolve(
+    iree_hal_local_executable_t* executable,
+    iree_hal_local_executable_t** out_executable) {
+  IREE_ASSERT_ARGUMENT(executable);
+  IREE_ASSERT_ARGUMENT(out_executable);
+  const iree_hal_local_executable_vtable_t* vtable =
+      (const iree_hal_local_executable_vtable_t*)executable->resource.vtable;
+  if (IREE_LIKELY(!vtable->resolve)) {
+    *out_executable = executable;
+    return iree_ok_status();
+  }
+  return vtable->resolve(executable, out_executable);
+}
+
 iree_status_t iree_hal_local_executable_issue_call(
     iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
     const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
@@ -55,10 +72,57 @@ iree_status_t iree_hal_local_executable_issue_call(
   IREE_ASSERT_ARGUMENT(executable);
   IREE_ASSERT_ARGUMENT(dispatch_state);
   IREE_ASSERT_ARGUMENT(workgroup_state);
-  return ((const iree_hal_local_executable_vtable_t*)
-              executable->resource.vtable)
-      ->issue_call(executable, ordinal, dispatch_state, workgroup_state,
-                   worker_id);
+  const iree_hal_local_executable_vtable_t* vtable =
+      (const iree_hal_local_executable_vtable_t*)executable->resource.vtable;
+  const bool flush_denormals = iree_all_bits_set(
+      executable->library_features,
+      IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_FLUSH_DENORMALS_TO_ZERO);
+  if (IREE_LIKELY(!flush_denormals)) {
+    return vtable->issue_call(executable, ordinal, dispatch_state,
+                              workgroup_state, worker_id);
+  }
+  // Task workers already flush denormals in which case this only reads the
+  // FPU state; calls from other threads (such as the inline HAL module) get it
+  // applied for the duration of the workgroup.
+  iree_fpu_state_t fpu_state =
+      iree_fpu_state_push(IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO);
+  iree_status_t status = vtable->issue_call(executable, ordinal, dispatch_state,
+                                            workgroup_state, worker_id);
+  iree_fpu_state_pop(fpu_state);
+  return status;
+}
+
+iree_status_t iree_hal_local_executable_issue_call_range(
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
+    uint32_t workgroup_count, uint32_t worker_id) {
+  IREE_ASSERT_ARGUMENT(workgroup_state);
+  iree_alignas(64) iree_hal_executable_workgroup_state_v0_t range_state =
+      *workgroup_state;
+  if (iree_all_bits_set(executable->library_features,
+                        IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_WORKGROUP_RANGES)) {
+    // The executable loops over the range itself.
+    range_state.workgroup_range_count = workgroup_count;
+    return iree_hal_local_executable_issue_call(
+        executable, ordinal, dispatch_state, &range_state, worker_id);
+  }
+
+  // Issue one workgroup at a time, carrying the workgroup ID over into the
+  // next row and slice of the grid at the edges.
+  range_state.workgroup_range_count = 1;
+  for (uint32_t i = 0; i < workgroup_count; ++i) {
+    IREE_RETURN_IF_ERROR(iree_hal_local_executable_issue_call(
+        executable, ordinal, dispatch_state, &range_state, worker_id));
+    if (++range_state.workgroup_id_x == dispatch_state->workgroup_count_x) {
+      range_state.workgroup_id_x = 0;
+      if (++range_state.workgroup_id_y == dispatch_state->workgroup_count_y) {
+        range_state.workgroup_id_y = 0;
+        ++range_state.workgroup_id_z;
+      }
+    }
+  }
+  return iree_ok_status();
 }
 
 iree_status_t iree_hal_local_executable_issue_dispatch_inline(
@@ -92,7 +156,34 @@ iree_status_t iree_hal_local_executable_issue_dispatch_inline(
       .processor_id = processor_id,
       .local_memory = local_memory.data,
       .local_memory_size = (size_t)local_memory.data_length,
+      .workgroup_range_count = 1,
   };
+
+  // Executables able to loop over workgroups themselves are issued the whole
+  // grid (in ranges of at most UINT32_MAX workgroups).
+  if (iree_all_bits_set(executable->library_features,
+                        IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_WORKGROUP_RANGES)) {
+    const uint64_t workgroup_count = (uint64_t)workgroup_count_x *
+                                     workgroup_count_y * workgroup_count_z;
+    for (uint64_t base = 0; base < workgroup_count && iree_status_is_ok(status);
+         base += UINT32_MAX) {
+      uint64_t linear_id = base;
+      workgroup_state.workgroup_id_x =
+          (uint32_t)(linear_id % workgroup_count_x);
+      linear_id /= workgroup_count_x;
+      workgroup_state.workgroup_id_y =
+          (uint32_t)(linear_id % workgroup_count_y);
+      linear_id /= workgroup_count_y;
+      workgroup_state.workgroup_id_z = (uint16_t)linear_id;
+      status = iree_hal_local_executable_issue_call_range(
+          executable, ordinal, dispatch_state, &workgroup_state,
+          (uint32_t)iree_min(workgroup_count - base, (uint64_t)UINT32_MAX),
+          /*worker_id=*/0);
+    }
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
   for (uint32_t z = 0; z < workgroup_count_z; ++z) {
     workgroup_state.workgroup_id_z = z;
     for (uint32_t y = 0; y < workgroup_count_y; ++y) {
@@ -35,6 +35,10 @@ typedef struct iree_hal_local_executable_t {
   // of memory required by the function.
   const iree_hal_executable_dispatch_attrs_v0_t* dispatch_attrs;
 
+  // Features declared by the library backing the executable, if any. Calls
+  // are issued with the FPU state the features request.
+  iree_hal_executable_library_features_t library_features;
+
   // Execution environment.
   iree_hal_executable_environment_v0_t environment;
 } iree_hal_local_executable_t;
@@ -47,6 +51,13 @@ typedef struct iree_hal_local_executable_vtable_t {
       const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
       const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
       uint32_t worker_id);
+
+  // Optional. Returns the executable that dispatches are to be recorded
+  // against, finishing its preparation if it is still pending. Executables
+  // that are ready upon creation leave this NULL.
+  iree_status_t(IREE_API_PTR* resolve)(
+      iree_hal_local_executable_t* executable,
+      iree_hal_local_executable_t** out_executable);
 } iree_hal_local_executable_vtable_t;
 
 // Initializes the local executable base type.
@@ -67,12 +78,33 @@ void iree_hal_local_executable_deinitialize(
 iree_hal_local_executable_t* iree_hal_local_executable_cast(
     iree_hal_executable_t* base_value);
 
+// Returns in |out_executable| the executable whose pipeline layouts, dispatch
+// attributes and entry points are to be used when recording dispatches of
+// |executable|. This is |executable| itself unless it was returned before its
+// preparation completed (see IREE_HAL_LOCAL_EXECUTABLE_CACHE_FLAG_ASYNC), in
+// which case this waits for or performs the preparation and returns any error
+// it produced. The returned executable is borrowed and remains valid for
+// as long as |executable| does.
+iree_status_t iree_hal_local_executable_resolve(
+    iree_hal_local_executable_t* executable,
+    iree_hal_local_executable_t** out_executable);
+
 iree_status_t iree_hal_local_executable_issue_call(
     iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
     const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
     const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
     uint32_t worker_id);
 
+// Issues |workgroup_count| workgroups starting at the workgroup ID in
+// |workgroup_state| in x-fastest linear order. Executables whose library
+// declares IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_WORKGROUP_RANGES are called once
+// with the whole range and all others are called once per workgroup.
+iree_status_t iree_hal_local_executable_issue_call_range(
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
+    uint32_t workgroup_count, uint32_t worker_id);
+
 iree_status_t iree_hal_local_executable_issue_dispatch_inline(
     iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
     const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
@@ -8,13 +8,119 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <string.h>
 
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/call_once.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/base/tracing.h"
+#include "iree/hal/local/local_executable.h"
+#include "iree/hal/local/local_pipeline_layout.h"
+
+//===----------------------------------------------------------------------===//
+// Process-wide shared executable registry
+//===----------------------------------------------------------------------===//
+// Caches created with IREE_HAL_LOCAL_EXECUTABLE_CACHE_FLAG_SHARED register the
+// executables they prepare here so that other such caches (usually belonging
+// to other devices or contexts loading the same program) can reuse them.
+//
+// Entries are keyed by everything that influences the loaded executable. The
+// executable data is hashed for fast rejection and then compared in full:
+// entries keep a copy of the data so that a crafted hash collision from one
+// tenant can never hand out another tenant's executable.
+
+// The parts of a local pipeline layout observed by dispatches. Layouts are
+// device resources and not shared themselves; executables match when their
+// layouts are interchangeable from the perspective of command buffers.
+typedef struct iree_hal_local_shared_layout_key_t {
+  iree_host_size_t push_constants;
+  iree_hal_local_binding_mask_t used_bindings;
+  iree_hal_local_binding_mask_t read_only_bindings;
+} iree_hal_local_shared_layout_key_t;
+
+typedef struct iree_hal_local_shared_executable_t {
+  struct iree_hal_local_shared_executable_t* next;
+  iree_allocator_t host_allocator;
+
+  // Number of caches that have prepared the executable. The registry holds a
+  // reference to |executable| until this drops to zero.
+  iree_host_size_t user_count;
+  iree_hal_executable_t* executable;
+
+  // Key. All pointers reference trailing storage of this allocation.
+  uint64_t data_hash;
+  iree_hal_executable_caching_mode_t caching_mode;
+  // Executables prepared for more workers can serve caches with fewer.
+  iree_host_size_t worker_capacity;
+  iree_hal_executable_import_provider_t import_provider;
+  iree_string_view_t executable_format;
+  iree_const_byte_span_t executable_data;
+  iree_host_size_t constant_count;
+  const uint32_t* constants;
+  iree_host_size_t layout_count;
+  const iree_hal_local_shared_layout_key_t* layouts;
+} iree_hal_local_shared_executable_t;
+
+// A reference from a cache to a registry entry it has prepared.
+typedef struct iree_hal_local_shared_executable_use_t {
+  struct iree_hal_local_shared_executable_use_t* next;
+  iree_hal_local_shared_executable_t* shared;
+} iree_hal_local_shared_executable_use_t;
+
+typedef struct iree_hal_local_shared_executable_registry_t {
+  // Guards the entry list, entry user counts and the use lists of all caches.
+  iree_slim_mutex_t mutex;
+  iree_hal_local_shared_executable_t* head;
+} iree_hal_local_shared_executable_registry_t;
+
+static iree_hal_local_shared_executable_registry_t
+    iree_hal_local_shared_executable_registry_;
+static iree_once_flag iree_hal_local_shared_executable_registry_flag_ =
+    IREE_ONCE_FLAG_INIT;
+static void iree_hal_local_shared_executable_registry_initialize(void) {
+  memset(&iree_hal_local_shared_executable_registry_, 0,
+         sizeof(iree_hal_local_shared_executable_registry_));
+  iree_slim_mutex_initialize(&iree_hal_local_shared_executable_registry_.mutex);
+}
+
+static iree_hal_local_shared_executable_registry_t*
+iree_hal_local_shared_executable_registry(void) {
+  iree_call_once(&iree_hal_local_shared_executable_registry_flag_,
+                 iree_hal_local_shared_executable_registry_initialize);
+  return &iree_hal_local_shared_executable_registry_;
+}
+
+// 64-bit FNV-1a; only used to quickly reject mismatching entries.
+static uint64_t iree_hal_local_shared_executable_hash(
+    iree_const_byte_span_t data) {
+  uint64_t hash = 0xCBF29CE484222325ull;
+  for (iree_host_size_t i = 0; i < data.data_length; ++i) {
+    hash = (hash ^ data.data[i]) * 0x100000001B3ull;
+  }
+  return hash;
+}
+
+static iree_hal_local_shared_layout_key_t iree_hal_local_shared_layout_key(
+    iree_hal_pipeline_layout_t* base_layout) {
+  iree_hal_local_pipeline_layout_t* layout =
+      iree_hal_local_pipeline_layout_cast(base_layout);
+  iree_hal_local_shared_layout_key_t key;
+  memset(&key, 0, sizeof(key));
+  key.push_constants = layout->push_constants;
+  key.used_bindings = layout->used_bindings;
+  key.read_only_bindings = layout->read_only_bindings;
+  return key;
+}
 
 typedef struct iree_hal_local_executable_cache_t {
   iree_hal_resource_t resource;
   iree_allocator_t host_allocator;
   iree_string_view_t identifier;
+  iree_hal_local_executable_cache_flags_t flags;
+  iree_hal_local_executable_cache_scheduler_t scheduler;
+  // Registry entries prepared by this cache when it is shared. Guarded by the
+  // registry mutex.
+  iree_hal_local_shared_executable_use_t* shared_uses;
   iree_host_size_t worker_capacity;
   iree_host_size_t loader_count;
   iree_hal_executable_loader_t* loaders[];
@@ -30,9 +136,11 @@ static iree_hal_local_executable_cache_t* iree_hal_local_executable_cache_cast(
 }
 
 iree_status_t iree_hal_local_executable_cache_create(
-    iree_string_view_t identifier, iree_host_size_t worker_capacity,
-    iree_host_size_t loader_count, iree_hal_executable_loader_t** loaders,
-    iree_allocator_t host_allocator,
+    iree_string_view_t identifier,
+    iree_hal_local_executable_cache_flags_t flags,
+    iree_hal_local_executable_cache_scheduler_t scheduler,
+    iree_host_size_t worker_capacity, iree_host_size_t loader_count,
+    iree_hal_executable_loader_t** loaders, iree_allocator_t host_allocator,
     iree_hal_executable_cache_t** out_executable_cache) {
   IREE_ASSERT_ARGUMENT(!loader_count || loaders);
   IREE_ASSERT_ARGUMENT(out_executable_cache);
@@ -53,6 +161,9 @@ iree_status_t iree_hal_local_executable_cache_create(
     iree_string_view_append_to_buffer(
         identifier, &executable_cache->identifier,
         (char*)executable_cache + total_size - identifier.size);
+    executable_cache->flags = flags;
+    executable_cache->scheduler = scheduler;
+    executable_cache->shared_uses = NULL;
     executable_cache->worker_capacity = worker_capacity;
 
     executable_cache->loader_count = loader_count;
@@ -75,6 +186,38 @@ static void iree_hal_local_executable_cache_destroy(
   iree_allocator_t host_allocator = executable_cache->host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  // Drop our uses of shared executables. Entries no longer used by any cache
+  // are unlinked under the lock and destroyed after it is released as
+  // releasing the executables may unload them.
+  iree_hal_local_shared_executable_t* dead_list = NULL;
+  if (executable_cache->shared_uses) {
+    iree_hal_local_shared_executable_registry_t* registry =
+        iree_hal_local_shared_executable_registry();
+    iree_slim_mutex_lock(&registry->mutex);
+    iree_hal_local_shared_executable_use_t* use = executable_cache->shared_uses;
+    while (use) {
+      iree_hal_local_shared_executable_use_t* next_use = use->next;
+      iree_hal_local_shared_executable_t* shared = use->shared;
+      if (--shared->user_count == 0) {
+        iree_hal_local_shared_executable_t** link = &registry->head;
+        while (*link != shared) link = &(*link)->next;
+        *link = shared->next;
+        shared->next = dead_list;
+        dead_list = shared;
+      }
+      iree_allocator_free(host_allocator, use);
+      use = next_use;
+    }
+    executable_cache->shared_uses = NULL;
+    iree_slim_mutex_unlock(&registry->mutex);
+  }
+  while (dead_list) {
+    iree_hal_local_shared_executable_t* next = dead_list->next;
+    iree_hal_executable_release(dead_list->executable);
+    iree_allocator_free(dead_list->host_allocator, dead_list);
+    dead_list = next;
+  }
+
   for (iree_host_size_t i = 0; i < executable_cache->loader_count; ++i) {
     iree_hal_executable_loader_release(executable_cache->loaders[i]);
   }
@@ -98,12 +241,13 @@ static bool iree_hal_local_executable_cache_can_prepare_format(
   return false;
 }
 
-static iree_status_t iree_hal_local_executable_cache_prepare_executable(
-    iree_hal_executable_cache_t* base_executable_cache,
+// Loads a new executable with the first loader accepting it and returns the
+// import provider of that loader in |out_import_provider|.
+static iree_status_t iree_hal_local_executable_cache_load(
+    iree_hal_local_executable_cache_t* executable_cache,
     const iree_hal_executable_params_t* executable_params,
+    iree_hal_executable_import_provider_t* out_import_provider,
     iree_hal_executable_t** out_executable) {
-  iree_hal_local_executable_cache_t* executable_cache =
-      iree_hal_local_executable_cache_cast(base_executable_cache);
   for (iree_host_size_t i = 0; i < executable_cache->loader_count; ++i) {
     if (!iree_hal_executable_loader_query_support(
             executable_cache->loaders[i], executable_params->caching_mode,
@@ -119,6 +263,7 @@ static iree_status_t iree_hal_local_executable_cache_prepare_executable(
         executable_cache->worker_capacity, out_executable);
     if (iree_status_is_ok(status)) {
       // Executable was successfully loaded.
+      *out_import_provider = executable_cache->loaders[i]->import_provider;
       return status;
     } else if (!iree_status_is_cancelled(status)) {
       // Error beyond just the try failing due to unsupported formats.
@@ -133,6 +278,518 @@ static iree_status_t iree_hal_local_executable_cache_prepare_executable(
       executable_params->executable_format.data);
 }
 
+// Returns true if |shared| is interchangeable with an executable the cache
+// would load for |executable_params|.
+static bool iree_hal_local_shared_executable_matches(
+    iree_hal_local_executable_cache_t* executable_cache,
+    const iree_hal_executable_params_t* executable_params, uint64_t data_hash,
+    const iree_hal_local_shared_executable_t* shared) {
+  if (shared->data_hash != data_hash ||
+      shared->caching_mode != executable_params->caching_mode ||
+      shared->worker_capacity < executable_cache->worker_capacity ||
+      !iree_string_view_equal(shared->executable_format,
+                              executable_params->executable_format) ||
+      shared->executable_data.data_length !=
+          executable_params->executable_data.data_length ||
+      shared->constant_count != executable_params->constant_count ||
+      shared->layout_count != executable_params->pipeline_layout_count) {
+    return false;
+  }
+  if (memcmp(shared->constants, executable_params->constants,
+             shared->constant_count * sizeof(*shared->constants)) != 0) {
+    return false;
+  }
+  for (iree_host_size_t i = 0; i < shared->layout_count; ++i) {
+    iree_hal_local_shared_layout_key_t key = iree_hal_local_shared_layout_key(
+        executable_params->pipeline_layouts[i]);
+    if (memcmp(&shared->layouts[i], &key, sizeof(key)) != 0) return false;
+  }
+  // Imports are resolved at load time so one of our loaders must share the
+  // import provider that the executable was linked against.
+  bool has_import_provider = false;
+  for (iree_host_size_t i = 0; i < executable_cache->loader_count; ++i) {
+    iree_hal_executable_import_provider_t import_provider =
+        executable_cache->loaders[i]->import_provider;
+    if (import_provider.self == shared->import_provider.self &&
+        import_provider.resolve == shared->import_provider.resolve) {
+      has_import_provider = true;
+      break;
+    }
+  }
+  if (!has_import_provider) return false;
+  return memcmp(shared->executable_data.data,
+                executable_params->executable_data.data,
+                shared->executable_data.data_length) == 0;
+}
+
+// Returns the registry entry matching |executable_params| or NULL.
+// Must be called with the registry mutex held.
+static iree_hal_local_shared_executable_t*
+iree_hal_local_shared_executable_find(
+    iree_hal_local_shared_executable_registry_t* registry,
+    iree_hal_local_executable_cache_t* executable_cache,
+    const iree_hal_executable_params_t* executable_params, uint64_t data_hash) {
+  for (iree_hal_local_shared_executable_t* shared = registry->head; shared;
+       shared = shared->next) {
+    if (iree_hal_local_shared_executable_matches(
+            executable_cache, executable_params, data_hash, shared)) {
+      return shared;
+    }
+  }
+  return NULL;
+}
+
+// Allocates an unlinked registry entry for |executable| (retained) keyed by
+// |executable_params|.
+static iree_status_t iree_hal_local_shared_executable_allocate(
+    iree_hal_local_executable_cache_t* executable_cache,
+    const iree_hal_executable_params_t* executable_params, uint64_t data_hash,
+    iree_hal_executable_import_provider_t import_provider,
+    iree_hal_executable_t* executable,
+    iree_hal_local_shared_executable_t** out_shared) {
+  *out_shared = NULL;
+  iree_hal_local_shared_executable_t* shared = NULL;
+  const iree_host_size_t layouts_size =
+      executable_params->pipeline_layout_count * sizeof(*shared->layouts);
+  const iree_host_size_t constants_size =
+      executable_params->constant_count * sizeof(*shared->constants);
+  iree_host_size_t total_size =
+      iree_host_align(sizeof(*shared), iree_max_align_t) + layouts_size +
+      constants_size + executable_params->executable_format.size +
+      executable_params->executable_data.data_length;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(executable_cache->host_allocator,
+                                             total_size, (void**)&shared));
+  uint8_t* storage =
+      (uint8_t*)shared + iree_host_align(sizeof(*shared), iree_max_align_t);
+  shared->next = NULL;
+  shared->host_allocator = executable_cache->host_allocator;
+  shared->user_count = 0;
+  shared->executable = executable;
+  iree_hal_executable_retain(executable);
+  shared->data_hash = data_hash;
+  shared->caching_mode = executable_params->caching_mode;
+  shared->worker_capacity = executable_cache->worker_capacity;
+  shared->import_provider = import_provider;
+
+  iree_hal_local_shared_layout_key_t* layouts =
+      (iree_hal_local_shared_layout_key_t*)storage;
+  for (iree_host_size_t i = 0; i < executable_params->pipeline_layout_count;
+       ++i) {
+    layouts[i] = iree_hal_local_shared_layout_key(
+        executable_params->pipeline_layouts[i]);
+  }
+  shared->layout_count = executable_params->pipeline_layout_count;
+  shared->layouts = layouts;
+  storage += layouts_size;
+
+  memcpy(storage, executable_params->constants, constants_size);
+  shared->constant_count = executable_params->constant_count;
+  shared->constants = (const uint32_t*)storage;
+  storage += constants_size;
+
+  iree_string_view_append_to_buffer(executable_params->executable_format,
+                                    &shared->executable_format, (char*)storage);
+  storage += executable_params->executable_format.size;
+
+  memcpy(storage, executable_params->executable_data.data,
+         executable_params->executable_data.data_length);
+  shared->executable_data = iree_make_const_byte_span(
+      storage, executable_params->executable_data.data_length);
+
+  *out_shared = shared;
+  return iree_ok_status();
+}
+
+// Records that |executable_cache| uses |shared| unless it already does.
+// |use| is consumed either way. Must be called with the registry mutex held.
+static void iree_hal_local_executable_cache_add_shared_use(
+    iree_hal_local_executable_cache_t* executable_cache,
+    iree_hal_local_shared_executable_t* shared,
+    iree_hal_local_shared_executable_use_t* use) {
+  for (iree_hal_local_shared_executable_use_t* existing_use =
+           executable_cache->shared_uses;
+       existing_use; existing_use = existing_use->next) {
+    if (existing_use->shared == shared) {
+      iree_allocator_free(executable_cache->host_allocator, use);
+      return;
+    }
+  }
+  use->shared = shared;
+  use->next = executable_cache->shared_uses;
+  executable_cache->shared_uses = use;
+  ++shared->user_count;
+}
+
+static iree_status_t iree_hal_local_executable_cache_prepare_shared(
+    iree_hal_local_executable_cache_t* executable_cache,
+    const iree_hal_executable_params_t* executable_params,
+    iree_hal_executable_t** out_executable) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_local_shared_executable_registry_t* registry =
+      iree_hal_local_shared_executable_registry();
+  const uint64_t data_hash =
+      iree_hal_local_shared_executable_hash(executable_params->executable_data);
+
+  // Allocated up front so that no allocation happens under the lock.
+  iree_hal_local_shared_executable_use_t* use = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(executable_cache->host_allocator, sizeof(*use),
+                                (void**)&use));
+
+  // Fast path: another cache (or this one) already prepared the executable.
+  iree_slim_mutex_lock(&registry->mutex);
+  iree_hal_local_shared_executable_t* shared =
+      iree_hal_local_shared_executable_find(registry, executable_cache,
+                                            executable_params, data_hash);
+  if (shared) {
+    iree_hal_local_executable_cache_add_shared_use(executable_cache, shared,
+                                                   use);
+    *out_executable = shared->executable;
+    iree_hal_executable_retain(*out_executable);
+    iree_slim_mutex_unlock(&registry->mutex);
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "hit");
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
+  }
+  iree_slim_mutex_unlock(&registry->mutex);
+
+  // Load outside of the lock so that loads of unrelated executables from other
+  // caches are not serialized.
+  iree_hal_executable_import_provider_t import_provider =
+      iree_hal_executable_import_provider_null();
+  iree_hal_executable_t* executable = NULL;
+  iree_status_t status = iree_hal_local_executable_cache_load(
+      executable_cache, executable_params, &import_provider, &executable);
+  iree_hal_local_shared_executable_t* new_shared = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_local_shared_executable_allocate(
+        executable_cache, executable_params, data_hash, import_provider,
+        executable, &new_shared);
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_hal_executable_release(executable);
+    iree_allocator_free(executable_cache->host_allocator, use);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  // Another cache may have raced us while we were loading; prefer its entry so
+  // that all users end up with the same executable.
+  iree_slim_mutex_lock(&registry->mutex);
+  shared = iree_hal_local_shared_executable_find(registry, executable_cache,
+                                                 executable_params, data_hash);
+  if (!shared) {
+    new_shared->next = registry->head;
+    registry->head = new_shared;
+    shared = new_shared;
+    new_shared = NULL;
+  }
+  iree_hal_local_executable_cache_add_shared_use(executable_cache, shared, use);
+  *out_executable = shared->executable;
+  iree_hal_executable_retain(*out_executable);
+  iree_slim_mutex_unlock(&registry->mutex);
+
+  if (new_shared) {
+    iree_hal_executable_release(new_shared->executable);
+    iree_allocator_free(new_shared->host_allocator, new_shared);
+  }
+  iree_hal_executable_release(executable);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, "miss");
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+// Prepares an executable on the calling thread.
+static iree_status_t iree_hal_local_executable_cache_prepare_now(
+    iree_hal_local_executable_cache_t* executable_cache,
+    const iree_hal_executable_params_t* executable_params,
+    iree_hal_executable_t** out_executable) {
+  if (executable_cache->flags & IREE_HAL_LOCAL_EXECUTABLE_CACHE_FLAG_SHARED) {
+    return iree_hal_local_executable_cache_prepare_shared(
+        executable_cache, executable_params, out_executable);
+  }
+  iree_hal_executable_import_provider_t import_provider;
+  return iree_hal_local_executable_cache_load(
+      executable_cache, executable_params, &import_provider, out_executable);
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_local_deferred_executable_t
+//===----------------------------------------------------------------------===//
+// Returned by caches created with IREE_HAL_LOCAL_EXECUTABLE_CACHE_FLAG_ASYNC or
+// IREE_HAL_LOCAL_EXECUTABLE_CACHE_FLAG_LAZY in place of the executable that is
+// still to be prepared. Only the pipeline layouts are available until then;
+// command buffers use iree_hal_local_executable_resolve to get the prepared
+// executable when recording dispatches.
+
+typedef enum iree_hal_local_deferred_executable_state_e {
+  // Preparation has not started.
+  IREE_HAL_LOCAL_DEFERRED_EXECUTABLE_STATE_PENDING = 0,
+  // A thread is preparing the executable and others wait for it.
+  IREE_HAL_LOCAL_DEFERRED_EXECUTABLE_STATE_PREPARING,
+  // Preparation has completed with |status|.
+  IREE_HAL_LOCAL_DEFERRED_EXECUTABLE_STATE_READY,
+} iree_hal_local_deferred_executable_state_t;
+
+typedef struct iree_hal_local_deferred_executable_t {
+  iree_hal_local_executable_t base;
+
+  // Cache preparing the executable, retained until preparation completes.
+  iree_hal_local_executable_cache_t* executable_cache;
+  // Parameters with constants, format and (unless it may be aliased) data
+  // copied into trailing storage.
+  iree_hal_executable_params_t executable_params;
+
+  // iree_hal_local_deferred_executable_state_t.
+  iree_atomic_int32_t state;
+  iree_notification_t notification;
+
+  // Result of preparation, valid once the state is READY.
+  iree_status_t status;
+  iree_hal_local_executable_t* executable;
+} iree_hal_local_deferred_executable_t;
+
+static const iree_hal_local_executable_vtable_t
+    iree_hal_local_deferred_executable_vtable;
+
+static iree_hal_local_deferred_executable_t*
+iree_hal_local_deferred_executable_cast(iree_hal_executable_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_local_deferred_executable_vtable);
+  return (iree_hal_local_deferred_executable_t*)base_value;
+}
+
+static iree_status_t iree_hal_local_deferred_executable_create(
+    iree_hal_local_executable_cache_t* executable_cache,
+    const iree_hal_executable_params_t* executable_params,
+    iree_hal_local_deferred_executable_t** out_executable) {
+  *out_executable = NULL;
+  const bool alias_data = iree_all_bits_set(
+      executable_params->caching_mode,
+      IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA);
+  iree_hal_local_deferred_executable_t* executable = NULL;
+  const iree_host_size_t layouts_size =
+      executable_params->pipeline_layout_count *
+      sizeof(*executable->base.pipeline_layouts);
+  const iree_host_size_t constants_size =
+      executable_params->constant_count * sizeof(uint32_t);
+  const iree_host_size_t data_size =
+      alias_data ? 0 : executable_params->executable_data.data_length;
+  iree_host_size_t total_size = sizeof(*executable) + layouts_size +
+                                constants_size +
+                                executable_params->executable_format.size +
+                                data_size;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(executable_cache->host_allocator,
+                                             total_size, (void**)&executable));
+  uint8_t* storage = (uint8_t*)executable + sizeof(*executable);
+  iree_hal_local_executable_initialize(
+      &iree_hal_local_deferred_executable_vtable,
+      executable_params->pipeline_layout_count,
+      executable_params->pipeline_layouts,
+      (iree_hal_pipeline_layout_t**)storage, executable_cache->host_allocator,
+      &executable->base);
+  storage += layouts_size;
+
+  executable->executable_cache = executable_cache;
+  iree_hal_executable_cache_retain(
+      (iree_hal_executable_cache_t*)executable_cache);
+
+  executable->executable_params = *executable_params;
+  executable->executable_params.pipeline_layouts =
+      executable->base.pipeline_layouts;
+  memcpy(storage, executable_params->constants, constants_size);
+  executable->executable_params.constants = (const uint32_t*)storage;
+  storage += constants_size;
+  iree_string_view_append_to_buffer(
+      executable_params->executable_format,
+      &executable->executable_params.executable_format, (char*)storage);
+  storage += executable_params->executable_format.size;
+  if (!alias_data) {
+    memcpy(storage, executable_params->executable_data.data, data_size);
+    executable->executable_params.executable_data =
+        iree_make_const_byte_span(storage, data_size);
+  }
+
+  iree_atomic_store_int32(&executable->state,
+                          IREE_HAL_LOCAL_DEFERRED_EXECUTABLE_STATE_PENDING,
+                          iree_memory_order_relaxed);
+  iree_notification_initialize(&executable->notification);
+  executable->status = iree_ok_status();
+  executable->executable = NULL;
+
+  *out_executable = executable;
+  return iree_ok_status();
+}
+
+static void iree_hal_local_deferred_executable_destroy(
+    iree_hal_executable_t* base_executable) {
+  iree_hal_local_deferred_executable_t* executable =
+      iree_hal_local_deferred_executable_cast(base_executable);
+  iree_allocator_t host_allocator = executable->base.host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_executable_release((iree_hal_executable_t*)executable->executable);
+  iree_status_ignore(executable->status);
+  iree_hal_executable_cache_release(
+      (iree_hal_executable_cache_t*)executable->executable_cache);
+  iree_notification_deinitialize(&executable->notification);
+  iree_hal_local_executable_deinitialize(&executable->base);
+  iree_allocator_free(host_allocator, executable);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Prepares the executable unless another thread already has or is doing so.
+static void iree_hal_local_deferred_executable_prepare(
+    iree_hal_local_deferred_executable_t* executable) {
+  int32_t expected = IREE_HAL_LOCAL_DEFERRED_EXECUTABLE_STATE_PENDING;
+  if (!iree_atomic_compare_exchange_strong_int32(
+          &executable->state, &expected,
+          IREE_HAL_LOCAL_DEFERRED_EXECUTABLE_STATE_PREPARING,
+          iree_memory_order_acq_rel, iree_memory_order_acquire)) {
+    return;
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_executable_t* prepared_executable = NULL;
+  executable->status = iree_hal_local_executable_cache_prepare_now(
+      executable->executable_cache, &executable->executable_params,
+      &prepared_executable);
+  executable->executable =
+      prepared_executable ? iree_hal_local_executable_cast(prepared_executable)
+                          : NULL;
+
+  // The cache (and its loaders) are only needed for preparation.
+  iree_hal_executable_cache_release(
+      (iree_hal_executable_cache_t*)executable->executable_cache);
+  executable->executable_cache = NULL;
+
+  iree_atomic_store_int32(&executable->state,
+                          IREE_HAL_LOCAL_DEFERRED_EXECUTABLE_STATE_READY,
+                          iree_memory_order_release);
+  iree_notification_post(&executable->notification, IREE_ALL_WAITERS);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Scheduled with a reference to the executable that is released once done.
+static void iree_hal_local_deferred_executable_prepare_async(void* user_data) {
+  iree_hal_local_deferred_executable_t* executable =
+      (iree_hal_local_deferred_executable_t*)user_data;
+  iree_hal_local_deferred_executable_prepare(executable);
+  iree_hal_executable_release((iree_hal_executable_t*)executable);
+}
+
+static bool iree_hal_local_deferred_executable_is_ready(void* arg) {
+  return iree_atomic_load_int32((iree_atomic_int32_t*)arg,
+                                iree_memory_order_acquire) ==
+         IREE_HAL_LOCAL_DEFERRED_EXECUTABLE_STATE_READY;
+}
+
+static iree_status_t iree_hal_local_deferred_executable_resolve(
+    iree_hal_local_executable_t* base_executable,
+    iree_hal_local_executable_t** out_executable) {
+  iree_hal_local_deferred_executable_t* executable =
+      (iree_hal_local_deferred_executable_t*)base_executable;
+  if (!iree_hal_local_deferred_executable_is_ready(&executable->state)) {
+    // Prepare on this thread if the scheduler has not gotten to it yet instead
+    // of waiting behind other queued preparations.
+    iree_hal_local_deferred_executable_prepare(executable);
+    iree_notification_await(&executable->notification,
+                            iree_hal_local_deferred_executable_is_ready,
+                            &executable->state, iree_infinite_timeout());
+  }
+  if (IREE_UNLIKELY(!iree_status_is_ok(executable->status))) {
+    return iree_status_clone(executable->status);
+  }
+  *out_executable = executable->executable;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_local_deferred_executable_issue_call(
+    iree_hal_local_executable_t* base_executable, iree_host_size_t ordinal,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
+    uint32_t worker_id) {
+  iree_hal_local_executable_t* executable = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_local_deferred_executable_resolve(base_executable, &executable));
+  return iree_hal_local_executable_issue_call(
+      executable, ordinal, dispatch_state, workgroup_state, worker_id);
+}
+
+static const iree_hal_local_executable_vtable_t
+    iree_hal_local_deferred_executable_vtable = {
+        .base =
+            {
+                .destroy = iree_hal_local_deferred_executable_destroy,
+            },
+        .issue_call = iree_hal_local_deferred_executable_issue_call,
+        .resolve = iree_hal_local_deferred_executable_resolve,
+};
+
+// Returns true if any loader may be able to load |executable_params|; used to
+// report unsupported formats at creation even when preparation is deferred.
+static bool iree_hal_local_executable_cache_can_prepare(
+    iree_hal_local_executable_cache_t* executable_cache,
+    const iree_hal_executable_params_t* executable_params) {
+  for (iree_host_size_t i = 0; i < executable_cache->loader_count; ++i) {
+    if (iree_hal_executable_loader_query_support(
+            executable_cache->loaders[i], executable_params->caching_mode,
+            executable_params->executable_format)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static iree_status_t iree_hal_local_executable_cache_prepare_deferred(
+    iree_hal_local_executable_cache_t* executable_cache,
+    const iree_hal_executable_params_t* executable_params,
+    iree_hal_executable_t** out_executable) {
+  if (!iree_hal_local_executable_cache_can_prepare(executable_cache,
+                                                   executable_params)) {
+    return iree_make_status(IREE_STATUS_NOT_FOUND,
+                            "no executable loader registered for the given "
+                            "executable format '%.*s'",
+                            (int)executable_params->executable_format.size,
+                            executable_params->executable_format.data);
+  }
+
+  iree_hal_local_deferred_executable_t* executable = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_local_deferred_executable_create(
+      executable_cache, executable_params, &executable));
+
+  if ((executable_cache->flags & IREE_HAL_LOCAL_EXECUTABLE_CACHE_FLAG_ASYNC) &&
+      executable_cache->scheduler.schedule) {
+    iree_hal_executable_retain((iree_hal_executable_t*)executable);
+    iree_status_t status = executable_cache->scheduler.schedule(
+        executable_cache->scheduler.self,
+        iree_hal_local_deferred_executable_prepare_async, executable);
+    if (!iree_status_is_ok(status)) {
+      // The executable will be prepared on first use instead.
+      iree_status_ignore(status);
+      iree_hal_executable_release((iree_hal_executable_t*)executable);
+    }
+  }
+
+  *out_executable = (iree_hal_executable_t*)executable;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_local_executable_cache_prepare_executable(
+    iree_hal_executable_cache_t* base_executable_cache,
+    const iree_hal_executable_params_t* executable_params,
+    iree_hal_executable_t** out_executable) {
+  iree_hal_local_executable_cache_t* executable_cache =
+      iree_hal_local_executable_cache_cast(base_executable_cache);
+  if (executable_cache->flags & (IREE_HAL_LOCAL_EXECUTABLE_CACHE_FLAG_ASYNC |
+                                 IREE_HAL_LOCAL_EXECUTABLE_CACHE_FLAG_LAZY)) {
+    return iree_hal_local_executable_cache_prepare_deferred(
+        executable_cache, executable_params, out_executable);
+  }
+  return iree_hal_local_executable_cache_prepare_now(
+      executable_cache, executable_params, out_executable);
+}
+
 static const iree_hal_executable_cache_vtable_t
     iree_hal_local_executable_cache_vtable = {
         .destroy = iree_hal_local_executable_cache_destroy,
@@ -23,10 +23,73 @@ extern "C" {
 // one device is the same JIT'ed executable in another, and in multi-tenant
 // situations we're likely to want that isolation _and_ sharing.
 
+// Flags controlling the behavior of local executable caches.
+enum iree_hal_local_executable_cache_flag_bits_t {
+  IREE_HAL_LOCAL_EXECUTABLE_CACHE_FLAG_NONE = 0u,
+
+  // Shares prepared executables process-wide with all other caches created
+  // with this flag, across devices and contexts. Preparing an executable with
+  // the same contents, format, constants and layout interface as one already
+  // prepared by another cache returns the same loaded executable instead of
+  // loading, relocating and mapping it again.
+  //
+  // Shared executables are kept alive until every cache that prepared them has
+  // been destroyed. They are allocated from the host allocator of the first
+  // cache that prepared them, loaded by one of its loaders, and so must not
+  // depend on state that is specific to a single device or tenant.
+  IREE_HAL_LOCAL_EXECUTABLE_CACHE_FLAG_SHARED = 1u << 0,
+
+  // Returns executables immediately and prepares them asynchronously on the
+  // cache scheduler so that all executables of a module are loaded in
+  // parallel. Dispatching an executable that is still pending prepares it on
+  // the calling thread or waits for the in-flight preparation to complete.
+  // Without a scheduler this behaves as
+  // IREE_HAL_LOCAL_EXECUTABLE_CACHE_FLAG_LAZY.
+  IREE_HAL_LOCAL_EXECUTABLE_CACHE_FLAG_ASYNC = 1u << 1,
+
+  // Returns executables immediately and prepares them when they are first
+  // dispatched. Executables that are never used are never loaded. Preparation
+  // errors are reported when recording the first dispatch.
+  IREE_HAL_LOCAL_EXECUTABLE_CACHE_FLAG_LAZY = 1u << 2,
+};
+typedef uint32_t iree_hal_local_executable_cache_flags_t;
+
+// Function run by an iree_hal_local_executable_cache_scheduler_t.
+typedef void(IREE_API_PTR* iree_hal_local_executable_cache_work_fn_t)(
+    void* user_data);
+
+// Schedules background work on behalf of an executable cache, such as the task
+// executor of the device owning the cache.
+typedef struct iree_hal_local_executable_cache_scheduler_t {
+  // Opaque pointer passed to |schedule|.
+  void* self;
+  // Schedules |fn| to be called exactly once with |user_data| from any thread.
+  // If scheduling fails an error is returned and |fn| is never called.
+  iree_status_t(IREE_API_PTR* schedule)(
+      void* self, iree_hal_local_executable_cache_work_fn_t fn,
+      void* user_data);
+} iree_hal_local_executable_cache_scheduler_t;
+
+// Returns a scheduler that does not schedule anything.
+static inline iree_hal_local_executable_cache_scheduler_t
+iree_hal_local_executable_cache_scheduler_null(void) {
+  iree_hal_local_executable_cache_scheduler_t scheduler = {NULL, NULL};
+  return scheduler;
+}
+
+// Creates a local executable cache preparing executables with the first of
+// |loaders| supporting them.
+//
+// |scheduler| is used with IREE_HAL_LOCAL_EXECUTABLE_CACHE_FLAG_ASYNC and must
+// remain valid until all executables prepared by the cache have completed
+// preparation. The owner of the scheduler is responsible for waiting for any
+// scheduled work before it is destroyed.
 iree_status_t iree_hal_local_executable_cache_create(
-    iree_string_view_t identifier, iree_host_size_t worker_capacity,
-    iree_host_size_t loader_count, iree_hal_executable_loader_t** loaders,
-    iree_allocator_t host_allocator,
+    iree_string_view_t identifier,
+    iree_hal_local_executable_cache_flags_t flags,
+    iree_hal_local_executable_cache_scheduler_t scheduler,
+    iree_host_size_t worker_capacity, iree_host_size_t loader_count,
+    iree_hal_executable_loader_t** loaders, iree_allocator_t host_allocator,
     iree_hal_executable_cache_t** out_executable_cache);
 
 #ifdef __cplusplus
@@ -0,0 +1,105 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/local/local_executable.h"
+
+#include <cstring>
+
+#include "iree/base/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+// Normal factors whose product is denormal. Volatile so that the product is
+// computed at runtime instead of being folded by the compiler.
+static volatile float lhs_factor = 1e-20f;
+static volatile float rhs_factor = 1e-19f;
+
+// Returns a denormal product computed with the current FPU state of the
+// thread: 0.0f when denormals are flushed to zero.
+static float MultiplyIntoDenormal() { return lhs_factor * rhs_factor; }
+
+// Executable recording the result of MultiplyIntoDenormal within each call.
+struct TestExecutable {
+  iree_hal_local_executable_t base;
+  int call_count = 0;
+  float observed[4] = {0.0f};
+};
+
+static void TestExecutableDestroy(iree_hal_executable_t* base_executable) {}
+
+static iree_status_t TestExecutableIssueCall(
+    iree_hal_local_executable_t* base_executable, iree_host_size_t ordinal,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
+    uint32_t worker_id) {
+  TestExecutable* executable = (TestExecutable*)base_executable;
+  if (executable->call_count >= (int)IREE_ARRAYSIZE(executable->observed)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE, "too many calls");
+  }
+  executable->observed[executable->call_count++] = MultiplyIntoDenormal();
+  return iree_ok_status();
+}
+
+class LocalExecutableTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    vtable_.base.destroy = TestExecutableDestroy;
+    vtable_.issue_call = TestExecutableIssueCall;
+    iree_hal_local_executable_initialize(
+        &vtable_, /*pipeline_layout_count=*/0,
+        /*source_pipeline_layouts=*/NULL, /*target_pipeline_layouts=*/NULL,
+        iree_allocator_system(), &executable_.base);
+  }
+
+  void TearDown() override {
+    iree_hal_local_executable_deinitialize(&executable_.base);
+  }
+
+  // Issues a dispatch of |workgroup_count| workgroups along X inline on the
+  // calling thread.
+  iree_status_t DispatchInline(uint32_t workgroup_count) {
+    iree_hal_executable_dispatch_state_v0_t dispatch_state;
+    memset(&dispatch_state, 0, sizeof(dispatch_state));
+    dispatch_state.workgroup_size_x = 1;
+    dispatch_state.workgroup_size_y = 1;
+    dispatch_state.workgroup_size_z = 1;
+    dispatch_state.workgroup_count_x = workgroup_count;
+    dispatch_state.workgroup_count_y = 1;
+    dispatch_state.workgroup_count_z = 1;
+    return iree_hal_local_executable_issue_dispatch_inline(
+        &executable_.base, /*ordinal=*/0, &dispatch_state,
+        /*processor_id=*/0, iree_byte_span_empty());
+  }
+
+  iree_hal_local_executable_vtable_t vtable_ = {};
+  TestExecutable executable_;
+};
+
+// Libraries declaring the feature run with denormals flushed and the FPU state
+// of the calling thread is restored once each call returns.
+TEST_F(LocalExecutableTest, FlushDenormalsFeatureAppliesFPUState) {
+  executable_.base.library_features =
+      IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_FLUSH_DENORMALS_TO_ZERO;
+  const float before = MultiplyIntoDenormal();
+  IREE_ASSERT_OK(DispatchInline(/*workgroup_count=*/2));
+  ASSERT_EQ(2, executable_.call_count);
+  EXPECT_EQ(0.0f, executable_.observed[0]);
+  EXPECT_EQ(0.0f, executable_.observed[1]);
+  EXPECT_EQ(before, MultiplyIntoDenormal());
+}
+
+// Libraries without the feature run with the FPU state of the calling thread.
+TEST_F(LocalExecutableTest, NoFeaturesKeepsFPUState) {
+  const float before = MultiplyIntoDenormal();
+  IREE_ASSERT_OK(DispatchInline(/*workgroup_count=*/1));
+  ASSERT_EQ(1, executable_.call_count);
+  EXPECT_EQ(before, executable_.observed[0]);
+  EXPECT_EQ(before, MultiplyIntoDenormal());
+}
+
+}  // namespace
@@ -75,8 +75,10 @@ IREE_API_EXPORT iree_status_t iree_hal_semaphore_wait(
   IREE_ASSERT_ARGUMENT(semaphore);
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_VALUE(z0, value);
+  iree_hal_record_wait_begin(1, timeout);
   iree_status_t status =
       _VTABLE_DISPATCH(semaphore, wait)(semaphore, value, timeout);
+  iree_hal_record_wait_end(status, timeout);
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
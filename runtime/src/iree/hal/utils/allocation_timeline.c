@@ -0,0 +1,594 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/allocation_timeline.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/tracing.h"
+
+// Maximum number of memory heaps queried from the underlying allocator.
+// Allocations in memory types not covered by a heap are assigned to an
+// additional catch-all heap.
+#define IREE_HAL_ALLOCATION_TIMELINE_MAX_HEAP_COUNT 8
+
+void iree_hal_allocation_timeline_params_initialize(
+    iree_hal_allocation_timeline_params_t* out_params) {
+  IREE_ASSERT_ARGUMENT(out_params);
+  memset(out_params, 0, sizeof(*out_params));
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_allocation_timeline_allocator_t
+//===----------------------------------------------------------------------===//
+
+// A single allocation made through the allocator.
+typedef struct iree_hal_allocation_timeline_record_t {
+  iree_device_size_t allocation_size;
+  iree_hal_memory_type_t memory_type;
+  iree_hal_buffer_usage_t allowed_usage;
+  iree_hal_queue_affinity_t queue_affinity;
+  // Index of the heap in the allocator heap list.
+  iree_host_size_t heap_index;
+  // Time relative to allocator creation the buffer was allocated.
+  iree_duration_t allocate_ns;
+  // Time relative to allocator creation the buffer was deallocated or
+  // IREE_DURATION_INFINITE if still live.
+  iree_duration_t deallocate_ns;
+} iree_hal_allocation_timeline_record_t;
+
+// A live allocation that will be returned to |allocator| when deallocated.
+typedef struct iree_hal_allocation_timeline_live_t {
+  iree_hal_buffer_t* buffer;
+  // Allocator the buffer pointed to before it was redirected to the timeline.
+  iree_hal_allocator_t* allocator;
+  iree_host_size_t record_index;
+} iree_hal_allocation_timeline_live_t;
+
+typedef struct iree_hal_allocation_timeline_allocator_t {
+  iree_hal_resource_t resource;
+  iree_allocator_t host_allocator;
+
+  // Underlying device allocator that services all requests.
+  iree_hal_allocator_t* device_allocator;
+
+  // Optional file path the timeline is written to on destruction.
+  char* file_path;
+
+  // Time the allocator was created; all times are relative to this.
+  iree_time_t base_time_ns;
+
+  // Heaps reported by the underlying allocator at creation.
+  iree_host_size_t heap_count;
+  iree_hal_allocator_memory_heap_t
+      heaps[IREE_HAL_ALLOCATION_TIMELINE_MAX_HEAP_COUNT];
+
+  // Guards the timeline.
+  iree_slim_mutex_t mutex;
+
+  iree_host_size_t record_count;
+  iree_host_size_t record_capacity;
+  iree_hal_allocation_timeline_record_t* records;
+
+  // Unordered list of live allocations. Searched from the end as transient
+  // allocations are generally released in the reverse order they were made.
+  iree_host_size_t live_count;
+  iree_host_size_t live_capacity;
+  iree_hal_allocation_timeline_live_t* live;
+
+  iree_device_size_t live_bytes;
+  iree_device_size_t peak_bytes;
+} iree_hal_allocation_timeline_allocator_t;
+
+static const iree_hal_allocator_vtable_t
+    iree_hal_allocation_timeline_allocator_vtable;
+
+static iree_hal_allocation_timeline_allocator_t*
+iree_hal_allocation_timeline_allocator_cast(iree_hal_allocator_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value,
+                       &iree_hal_allocation_timeline_allocator_vtable);
+  return (iree_hal_allocation_timeline_allocator_t*)base_value;
+}
+
+iree_status_t iree_hal_allocation_timeline_allocator_create(
+    const iree_hal_allocation_timeline_params_t* params,
+    iree_hal_allocator_t* device_allocator, iree_allocator_t host_allocator,
+    iree_hal_allocator_t** out_allocator) {
+  IREE_ASSERT_ARGUMENT(params);
+  IREE_ASSERT_ARGUMENT(device_allocator);
+  IREE_ASSERT_ARGUMENT(out_allocator);
+  *out_allocator = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_allocation_timeline_allocator_t* allocator = NULL;
+  iree_host_size_t total_size = sizeof(*allocator) + params->file_path.size + 1;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0,
+      iree_allocator_malloc(host_allocator, total_size, (void**)&allocator));
+  memset(allocator, 0, sizeof(*allocator));
+  iree_hal_resource_initialize(&iree_hal_allocation_timeline_allocator_vtable,
+                               &allocator->resource);
+  allocator->host_allocator = host_allocator;
+  allocator->device_allocator = device_allocator;
+  iree_hal_allocator_retain(allocator->device_allocator);
+  allocator->file_path = (char*)allocator + sizeof(*allocator);
+  memcpy(allocator->file_path, params->file_path.data, params->file_path.size);
+  allocator->file_path[params->file_path.size] = 0;
+  allocator->base_time_ns = iree_time_now();
+  iree_slim_mutex_initialize(&allocator->mutex);
+
+  // Heaps are only used to group allocations; if the underlying allocator
+  // has more heaps than we can track the remainder land in the catch-all.
+  iree_status_t status = iree_hal_allocator_query_memory_heaps(
+      device_allocator, IREE_ARRAYSIZE(allocator->heaps), allocator->heaps,
+      &allocator->heap_count);
+  if (iree_status_is_out_of_range(status)) {
+    status = iree_status_ignore(status);
+    allocator->heap_count = IREE_ARRAYSIZE(allocator->heaps);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_allocator = (iree_hal_allocator_t*)allocator;
+  } else {
+    iree_hal_allocator_release((iree_hal_allocator_t*)allocator);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+bool iree_hal_allocation_timeline_allocator_isa(
+    iree_hal_allocator_t* allocator) {
+  return iree_hal_resource_is(allocator,
+                              &iree_hal_allocation_timeline_allocator_vtable);
+}
+
+static void iree_hal_allocation_timeline_allocator_destroy(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_allocation_timeline_allocator_t* allocator =
+      iree_hal_allocation_timeline_allocator_cast(base_allocator);
+  iree_allocator_t host_allocator = allocator->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  if (allocator->file_path[0] != 0) {
+    FILE* file = fopen(allocator->file_path, "wb");
+    if (file) {
+      IREE_IGNORE_ERROR(
+          iree_hal_allocation_timeline_allocator_fwrite(base_allocator, file));
+      fclose(file);
+    } else {
+      fprintf(stderr, "failed to open allocation timeline file '%s'\n",
+              allocator->file_path);
+    }
+  }
+
+  IREE_ASSERT_EQ(allocator->live_count, 0,
+                 "must have released all allocations prior to destruction");
+  iree_allocator_free(host_allocator, allocator->live);
+  iree_allocator_free(host_allocator, allocator->records);
+  iree_slim_mutex_deinitialize(&allocator->mutex);
+  iree_hal_allocator_release(allocator->device_allocator);
+  iree_allocator_free(host_allocator, allocator);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static iree_allocator_t iree_hal_allocation_timeline_allocator_host_allocator(
+    const iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_allocation_timeline_allocator_t* allocator =
+      (iree_hal_allocation_timeline_allocator_t*)base_allocator;
+  return allocator->host_allocator;
+}
+
+static iree_status_t iree_hal_allocation_timeline_allocator_trim(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_allocation_timeline_allocator_t* allocator =
+      iree_hal_allocation_timeline_allocator_cast(base_allocator);
+  return iree_hal_allocator_trim(allocator->device_allocator);
+}
+
+static void iree_hal_allocation_timeline_allocator_query_statistics(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_allocator_statistics_t* IREE_RESTRICT out_statistics) {
+  iree_hal_allocation_timeline_allocator_t* allocator =
+      iree_hal_allocation_timeline_allocator_cast(base_allocator);
+  iree_hal_allocator_query_statistics(allocator->device_allocator,
+                                      out_statistics);
+}
+
+static iree_status_t iree_hal_allocation_timeline_allocator_query_memory_heaps(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_host_size_t capacity,
+    iree_hal_allocator_memory_heap_t* IREE_RESTRICT heaps,
+    iree_host_size_t* IREE_RESTRICT out_count) {
+  iree_hal_allocation_timeline_allocator_t* allocator =
+      iree_hal_allocation_timeline_allocator_cast(base_allocator);
+  return iree_hal_allocator_query_memory_heaps(allocator->device_allocator,
+                                               capacity, heaps, out_count);
+}
+
+static iree_hal_buffer_compatibility_t
+iree_hal_allocation_timeline_allocator_query_buffer_compatibility(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t* IREE_RESTRICT allocation_size) {
+  iree_hal_allocation_timeline_allocator_t* allocator =
+      iree_hal_allocation_timeline_allocator_cast(base_allocator);
+  return iree_hal_allocator_query_buffer_compatibility(
+      allocator->device_allocator, *params, *allocation_size, params,
+      allocation_size);
+}
+
+// Returns the index of the first heap that can hold |memory_type| or
+// heap_count for the catch-all heap.
+static iree_host_size_t iree_hal_allocation_timeline_allocator_find_heap(
+    iree_hal_allocation_timeline_allocator_t* allocator,
+    iree_hal_memory_type_t memory_type) {
+  for (iree_host_size_t i = 0; i < allocator->heap_count; ++i) {
+    if (iree_all_bits_set(allocator->heaps[i].type, memory_type)) return i;
+  }
+  return allocator->heap_count;
+}
+
+// Records the allocation of |buffer| originally owned by |buffer_allocator|.
+//
+// Must be called with the allocator mutex held.
+static iree_status_t iree_hal_allocation_timeline_allocator_record_locked(
+    iree_hal_allocation_timeline_allocator_t* allocator,
+    const iree_hal_buffer_params_t* params, iree_hal_buffer_t* buffer,
+    iree_hal_allocator_t* buffer_allocator) {
+  if (allocator->record_count == allocator->record_capacity) {
+    iree_host_size_t new_capacity =
+        iree_max(256, allocator->record_capacity * 2);
+    IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+        allocator->host_allocator, new_capacity * sizeof(*allocator->records),
+        (void**)&allocator->records));
+    allocator->record_capacity = new_capacity;
+  }
+  if (allocator->live_count == allocator->live_capacity) {
+    iree_host_size_t new_capacity = iree_max(64, allocator->live_capacity * 2);
+    IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+        allocator->host_allocator, new_capacity * sizeof(*allocator->live),
+        (void**)&allocator->live));
+    allocator->live_capacity = new_capacity;
+  }
+
+  const iree_device_size_t allocation_size =
+      iree_hal_buffer_allocation_size(buffer);
+  iree_hal_allocation_timeline_record_t* record =
+      &allocator->records[allocator->record_count];
+  record->allocation_size = allocation_size;
+  record->memory_type = iree_hal_buffer_memory_type(buffer);
+  record->allowed_usage = iree_hal_buffer_allowed_usage(buffer);
+  record->queue_affinity = params->queue_affinity;
+  record->heap_index = iree_hal_allocation_timeline_allocator_find_heap(
+      allocator, record->memory_type);
+  record->allocate_ns = iree_time_now() - allocator->base_time_ns;
+  record->deallocate_ns = IREE_DURATION_INFINITE;
+
+  iree_hal_allocation_timeline_live_t* live =
+      &allocator->live[allocator->live_count++];
+  live->buffer = buffer;
+  live->allocator = buffer_allocator;
+  live->record_index = allocator->record_count++;
+
+  allocator->live_bytes += allocation_size;
+  allocator->peak_bytes =
+      iree_max(allocator->peak_bytes, allocator->live_bytes);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_allocation_timeline_allocator_allocate_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t allocation_size, iree_const_byte_span_t initial_data,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  iree_hal_allocation_timeline_allocator_t* allocator =
+      iree_hal_allocation_timeline_allocator_cast(base_allocator);
+
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
+      allocator->device_allocator, *params, allocation_size, initial_data,
+      &buffer));
+
+  iree_slim_mutex_lock(&allocator->mutex);
+  iree_status_t status = iree_hal_allocation_timeline_allocator_record_locked(
+      allocator, params, buffer, buffer->device_allocator);
+  if (iree_status_is_ok(status)) {
+    // Point the buffer back to us for deallocation.
+    buffer->device_allocator = base_allocator;
+  }
+  iree_slim_mutex_unlock(&allocator->mutex);
+
+  if (iree_status_is_ok(status)) {
+    *out_buffer = buffer;
+  } else {
+    iree_hal_buffer_release(buffer);
+  }
+  return status;
+}
+
+static void iree_hal_allocation_timeline_allocator_deallocate_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_buffer_t* IREE_RESTRICT buffer) {
+  iree_hal_allocation_timeline_allocator_t* allocator =
+      iree_hal_allocation_timeline_allocator_cast(base_allocator);
+
+  iree_hal_allocator_t* buffer_allocator = NULL;
+  iree_slim_mutex_lock(&allocator->mutex);
+  for (iree_host_size_t i = allocator->live_count; i > 0; --i) {
+    iree_hal_allocation_timeline_live_t* live = &allocator->live[i - 1];
+    if (live->buffer != buffer) continue;
+    iree_hal_allocation_timeline_record_t* record =
+        &allocator->records[live->record_index];
+    record->deallocate_ns = iree_time_now() - allocator->base_time_ns;
+    allocator->live_bytes -= record->allocation_size;
+    buffer_allocator = live->allocator;
+    *live = allocator->live[--allocator->live_count];
+    break;
+  }
+  iree_slim_mutex_unlock(&allocator->mutex);
+  IREE_ASSERT(buffer_allocator, "deallocated buffer not found in timeline");
+  if (!buffer_allocator) buffer_allocator = allocator->device_allocator;
+
+  // Return the buffer to the allocator that produced it.
+  buffer->device_allocator = buffer_allocator;
+  iree_hal_allocator_deallocate_buffer(buffer_allocator, buffer);
+}
+
+static iree_status_t iree_hal_allocation_timeline_allocator_import_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_hal_external_buffer_t* IREE_RESTRICT external_buffer,
+    iree_hal_buffer_release_callback_t release_callback,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  iree_hal_allocation_timeline_allocator_t* allocator =
+      iree_hal_allocation_timeline_allocator_cast(base_allocator);
+  return iree_hal_allocator_import_buffer(allocator->device_allocator, *params,
+                                          external_buffer, release_callback,
+                                          out_buffer);
+}
+
+static iree_status_t iree_hal_allocation_timeline_allocator_export_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_buffer_t* IREE_RESTRICT buffer,
+    iree_hal_external_buffer_type_t requested_type,
+    iree_hal_external_buffer_flags_t requested_flags,
+    iree_hal_external_buffer_t* IREE_RESTRICT out_external_buffer) {
+  iree_hal_allocation_timeline_allocator_t* allocator =
+      iree_hal_allocation_timeline_allocator_cast(base_allocator);
+  return iree_hal_allocator_export_buffer(allocator->device_allocator, buffer,
+                                          requested_type, requested_flags,
+                                          out_external_buffer);
+}
+
+iree_device_size_t iree_hal_allocation_timeline_allocator_peak_bytes(
+    iree_hal_allocator_t* base_allocator) {
+  iree_hal_allocation_timeline_allocator_t* allocator =
+      iree_hal_allocation_timeline_allocator_cast(base_allocator);
+  iree_slim_mutex_lock(&allocator->mutex);
+  iree_device_size_t peak_bytes = allocator->peak_bytes;
+  iree_slim_mutex_unlock(&allocator->mutex);
+  return peak_bytes;
+}
+
+//===----------------------------------------------------------------------===//
+// Chrome trace JSON export
+//===----------------------------------------------------------------------===//
+
+// An allocation or deallocation changing the live bytes of a heap.
+typedef struct iree_hal_allocation_timeline_event_t {
+  iree_duration_t time_ns;
+  iree_host_size_t heap_index;
+  // Positive for allocations and negative for deallocations.
+  int64_t delta;
+} iree_hal_allocation_timeline_event_t;
+
+static int iree_hal_allocation_timeline_event_compare(const void* a,
+                                                      const void* b) {
+  const iree_hal_allocation_timeline_event_t* a_event =
+      (const iree_hal_allocation_timeline_event_t*)a;
+  const iree_hal_allocation_timeline_event_t* b_event =
+      (const iree_hal_allocation_timeline_event_t*)b;
+  if (a_event->time_ns != b_event->time_ns) {
+    return a_event->time_ns < b_event->time_ns ? -1 : 1;
+  }
+  // Process deallocations first so that back-to-back reuse doesn't inflate
+  // the peak.
+  return a_event->delta < b_event->delta ? -1
+                                         : (a_event->delta > b_event->delta);
+}
+
+// Packs allocations into lanes (trace threads) per heap such that no two
+// allocations in a lane overlap and writes them as complete events.
+//
+// Must be called with the allocator mutex held.
+static iree_status_t iree_hal_allocation_timeline_allocator_write_slices(
+    iree_hal_allocation_timeline_allocator_t* allocator, iree_duration_t end_ns,
+    FILE* file) {
+  // End time of the last allocation in each lane and the heap it belongs to.
+  typedef struct {
+    iree_host_size_t heap_index;
+    iree_duration_t end_ns;
+  } lane_t;
+  iree_host_size_t lane_count = 0;
+  iree_host_size_t lane_capacity = 0;
+  lane_t* lanes = NULL;
+
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < allocator->record_count; ++i) {
+    const iree_hal_allocation_timeline_record_t* record =
+        &allocator->records[i];
+    const bool is_live = record->deallocate_ns == IREE_DURATION_INFINITE;
+    const iree_duration_t deallocate_ns =
+        is_live ? end_ns : record->deallocate_ns;
+
+    // Records are in allocation order so the first free lane is the oldest.
+    iree_host_size_t lane_index = 0;
+    for (; lane_index < lane_count; ++lane_index) {
+      if (lanes[lane_index].heap_index == record->heap_index &&
+          lanes[lane_index].end_ns <= record->allocate_ns) {
+        break;
+      }
+    }
+    if (lane_index == lane_count) {
+      if (lane_count == lane_capacity) {
+        lane_capacity = iree_max(64, lane_capacity * 2);
+        status = iree_allocator_realloc(allocator->host_allocator,
+                                        lane_capacity * sizeof(*lanes),
+                                        (void**)&lanes);
+        if (!iree_status_is_ok(status)) break;
+      }
+      lanes[lane_count++].heap_index = record->heap_index;
+    }
+    lanes[lane_index].end_ns = deallocate_ns;
+
+    iree_bitfield_string_temp_t memory_type_temp;
+    iree_string_view_t memory_type_str =
+        iree_hal_memory_type_format(record->memory_type, &memory_type_temp);
+    iree_bitfield_string_temp_t usage_temp;
+    iree_string_view_t usage_str =
+        iree_hal_buffer_usage_format(record->allowed_usage, &usage_temp);
+    fprintf(file,
+            ",\n{\"name\":\"%" PRIdsz " B\",\"cat\":\"allocation\","
+            "\"ph\":\"X\",\"pid\":%" PRIhsz ",\"tid\":%" PRIhsz
+            ",\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"id\":%" PRIhsz
+            ",\"size\":%" PRIdsz
+            ",\"memory_type\":\"%.*s\",\"usage\":\"%.*s\""
+            ",\"queue_affinity\":\"0x%016" PRIx64 "\",\"live\":%s}}",
+            record->allocation_size, record->heap_index, lane_index,
+            (double)record->allocate_ns / 1e3,
+            (double)(deallocate_ns - record->allocate_ns) / 1e3, i,
+            record->allocation_size, (int)memory_type_str.size,
+            memory_type_str.data, (int)usage_str.size, usage_str.data,
+            (uint64_t)record->queue_affinity, is_live ? "true" : "false");
+  }
+
+  iree_allocator_free(allocator->host_allocator, lanes);
+  return status;
+}
+
+// Writes a counter event per heap with the live bytes after each change and
+// returns the peak live bytes of each heap in |out_heap_peaks|.
+//
+// Must be called with the allocator mutex held.
+static iree_status_t iree_hal_allocation_timeline_allocator_write_counters(
+    iree_hal_allocation_timeline_allocator_t* allocator, FILE* file,
+    iree_device_size_t* out_heap_peaks) {
+  iree_host_size_t event_count = 0;
+  iree_hal_allocation_timeline_event_t* events = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      allocator->host_allocator,
+      iree_max(1, allocator->record_count) * 2 * sizeof(*events),
+      (void**)&events));
+  for (iree_host_size_t i = 0; i < allocator->record_count; ++i) {
+    const iree_hal_allocation_timeline_record_t* record =
+        &allocator->records[i];
+    events[event_count++] = (iree_hal_allocation_timeline_event_t){
+        .time_ns = record->allocate_ns,
+        .heap_index = record->heap_index,
+        .delta = (int64_t)record->allocation_size,
+    };
+    if (record->deallocate_ns != IREE_DURATION_INFINITE) {
+      events[event_count++] = (iree_hal_allocation_timeline_event_t){
+          .time_ns = record->deallocate_ns,
+          .heap_index = record->heap_index,
+          .delta = -(int64_t)record->allocation_size,
+      };
+    }
+  }
+  qsort(events, event_count, sizeof(*events),
+        iree_hal_allocation_timeline_event_compare);
+
+  int64_t heap_bytes[IREE_HAL_ALLOCATION_TIMELINE_MAX_HEAP_COUNT + 1] = {0};
+  for (iree_host_size_t i = 0; i < event_count; ++i) {
+    const iree_hal_allocation_timeline_event_t* event = &events[i];
+    heap_bytes[event->heap_index] += event->delta;
+    out_heap_peaks[event->heap_index] =
+        iree_max(out_heap_peaks[event->heap_index],
+                 (iree_device_size_t)heap_bytes[event->heap_index]);
+    fprintf(file,
+            ",\n{\"name\":\"live bytes\",\"ph\":\"C\",\"pid\":%" PRIhsz
+            ",\"ts\":%.3f,\"args\":{\"bytes\":%" PRId64 "}}",
+            event->heap_index, (double)event->time_ns / 1e3,
+            heap_bytes[event->heap_index]);
+  }
+
+  iree_allocator_free(allocator->host_allocator, events);
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_allocation_timeline_allocator_fwrite(
+    iree_hal_allocator_t* base_allocator, FILE* file) {
+  IREE_ASSERT_ARGUMENT(base_allocator);
+  IREE_ASSERT_ARGUMENT(file);
+  iree_hal_allocation_timeline_allocator_t* allocator =
+      iree_hal_allocation_timeline_allocator_cast(base_allocator);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_slim_mutex_lock(&allocator->mutex);
+  const iree_duration_t end_ns = iree_time_now() - allocator->base_time_ns;
+
+  // Name each heap track after its memory type; the catch-all heap is last.
+  fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+  for (iree_host_size_t i = 0; i <= allocator->heap_count; ++i) {
+    iree_bitfield_string_temp_t temp;
+    iree_string_view_t type_str =
+        i < allocator->heap_count
+            ? iree_hal_memory_type_format(allocator->heaps[i].type, &temp)
+            : IREE_SV("other");
+    fprintf(file,
+            "%s{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%" PRIhsz
+            ",\"args\":{\"name\":\"heap[%" PRIhsz "] %.*s\"}}",
+            i > 0 ? ",\n" : "", i, i, (int)type_str.size, type_str.data);
+  }
+
+  iree_status_t status = iree_hal_allocation_timeline_allocator_write_slices(
+      allocator, end_ns, file);
+  iree_device_size_t
+      heap_peaks[IREE_HAL_ALLOCATION_TIMELINE_MAX_HEAP_COUNT + 1] = {0};
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_allocation_timeline_allocator_write_counters(
+        allocator, file, heap_peaks);
+  }
+
+  if (iree_status_is_ok(status)) {
+    fprintf(file,
+            "\n],\"otherData\":{\"allocation_count\":\"%" PRIhsz
+            "\",\"peak_bytes\":\"%" PRIdsz "\"",
+            allocator->record_count, allocator->peak_bytes);
+    for (iree_host_size_t i = 0; i <= allocator->heap_count; ++i) {
+      fprintf(file, ",\"heap[%" PRIhsz "]_peak_bytes\":\"%" PRIdsz "\"", i,
+              heap_peaks[i]);
+    }
+    fprintf(file, "}}\n");
+  }
+  iree_slim_mutex_unlock(&allocator->mutex);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static const iree_hal_allocator_vtable_t
+    iree_hal_allocation_timeline_allocator_vtable = {
+        .destroy = iree_hal_allocation_timeline_allocator_destroy,
+        .host_allocator = iree_hal_allocation_timeline_allocator_host_allocator,
+        .trim = iree_hal_allocation_timeline_allocator_trim,
+        .query_statistics =
+            iree_hal_allocation_timeline_allocator_query_statistics,
+        .query_memory_heaps =
+            iree_hal_allocation_timeline_allocator_query_memory_heaps,
+        .query_buffer_compatibility =
+            iree_hal_allocation_timeline_allocator_query_buffer_compatibility,
+        .allocate_buffer =
+            iree_hal_allocation_timeline_allocator_allocate_buffer,
+        .deallocate_buffer =
+            iree_hal_allocation_timeline_allocator_deallocate_buffer,
+        .import_buffer = iree_hal_allocation_timeline_allocator_import_buffer,
+        .export_buffer = iree_hal_allocation_timeline_allocator_export_buffer,
+};
@@ -0,0 +1,68 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_UTILS_ALLOCATION_TIMELINE_H_
+#define IREE_HAL_UTILS_ALLOCATION_TIMELINE_H_
+
+#include <stdio.h>
+
+#include "iree/base/api.h"
+#include "iree/hal/allocator.h"
+#include "iree/hal/buffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Parameters used to configure an allocation timeline allocator.
+typedef struct iree_hal_allocation_timeline_params_t {
+  // Optional file path the timeline is written to as Chrome trace JSON when
+  // the allocator is destroyed. The string is copied.
+  iree_string_view_t file_path;
+} iree_hal_allocation_timeline_params_t;
+
+// Initializes |out_params| to the default values.
+void iree_hal_allocation_timeline_params_initialize(
+    iree_hal_allocation_timeline_params_t* out_params);
+
+// Creates an allocator that forwards all requests to |device_allocator| and
+// records the size, memory heap, queue affinity, and lifetime of each buffer
+// allocated through it.
+//
+// The recorded timeline can be written in the Chrome trace event JSON format
+// (loadable in chrome://tracing or https://ui.perfetto.dev) with one track per
+// memory heap showing each allocation as a slice spanning its lifetime and a
+// counter of live bytes per heap whose maximum is the high-watermark. Imported
+// buffers are not owned by the allocator and are not recorded.
+//
+// Every allocation is retained in the timeline until the allocator is
+// destroyed and memory usage grows with the total allocation count.
+//
+// Thread-safe: the timeline is guarded by an internal lock.
+iree_status_t iree_hal_allocation_timeline_allocator_create(
+    const iree_hal_allocation_timeline_params_t* params,
+    iree_hal_allocator_t* device_allocator, iree_allocator_t host_allocator,
+    iree_hal_allocator_t** out_allocator);
+
+// Returns true if |allocator| was created by
+// iree_hal_allocation_timeline_allocator_create.
+bool iree_hal_allocation_timeline_allocator_isa(
+    iree_hal_allocator_t* allocator);
+
+// Returns the peak number of bytes live at any one time across all heaps.
+iree_device_size_t iree_hal_allocation_timeline_allocator_peak_bytes(
+    iree_hal_allocator_t* allocator);
+
+// Writes the timeline recorded by |allocator| to |file| as Chrome trace JSON.
+// Allocations still live are shown as ending at the time of the call.
+iree_status_t iree_hal_allocation_timeline_allocator_fwrite(
+    iree_hal_allocator_t* allocator, FILE* file);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_UTILS_ALLOCATION_TIMELINE_H_
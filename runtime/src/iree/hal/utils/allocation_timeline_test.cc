@@ -0,0 +1,131 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/allocation_timeline.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/utils/caching_allocator.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+class AllocationTimelineTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        iree_make_cstring_view("heap"), iree_allocator_system(),
+        iree_allocator_system(), &heap_allocator_));
+  }
+
+  void TearDown() override { iree_hal_allocator_release(heap_allocator_); }
+
+  void CreateTimeline(iree_hal_allocator_t* device_allocator) {
+    iree_hal_allocation_timeline_params_t params;
+    iree_hal_allocation_timeline_params_initialize(&params);
+    IREE_ASSERT_OK(iree_hal_allocation_timeline_allocator_create(
+        &params, device_allocator, iree_allocator_system(), &allocator_));
+  }
+
+  iree_hal_buffer_t* Allocate(iree_device_size_t byte_length) {
+    iree_hal_buffer_params_t params = {0};
+    params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+    params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+    iree_hal_buffer_t* buffer = nullptr;
+    IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(
+        allocator_, params, byte_length, iree_const_byte_span_empty(),
+        &buffer));
+    return buffer;
+  }
+
+  std::string WriteTimeline() {
+    FILE* file = tmpfile();
+    IREE_CHECK_OK(iree_hal_allocation_timeline_allocator_fwrite(allocator_,
+                                                                file));
+    std::string result;
+    rewind(file);
+    char chunk[256];
+    size_t length = 0;
+    while ((length = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+      result.append(chunk, length);
+    }
+    fclose(file);
+    return result;
+  }
+
+  iree_hal_allocator_t* heap_allocator_ = nullptr;
+  iree_hal_allocator_t* allocator_ = nullptr;
+};
+
+// The peak tracks the maximum bytes live at once and not the total allocated.
+TEST_F(AllocationTimelineTest, TracksPeakBytes) {
+  CreateTimeline(heap_allocator_);
+  EXPECT_TRUE(iree_hal_allocation_timeline_allocator_isa(allocator_));
+  EXPECT_FALSE(iree_hal_allocation_timeline_allocator_isa(heap_allocator_));
+
+  iree_hal_buffer_t* buffer0 = Allocate(1024);
+  iree_hal_buffer_t* buffer1 = Allocate(2048);
+  EXPECT_EQ(3072,
+            iree_hal_allocation_timeline_allocator_peak_bytes(allocator_));
+  iree_hal_buffer_release(buffer0);
+  iree_hal_buffer_release(buffer1);
+  iree_hal_buffer_t* buffer2 = Allocate(512);
+  iree_hal_buffer_release(buffer2);
+  EXPECT_EQ(3072,
+            iree_hal_allocation_timeline_allocator_peak_bytes(allocator_));
+
+  iree_hal_allocator_release(allocator_);
+}
+
+// Each allocation is written as a slice with its size and the live bytes as a
+// counter.
+TEST_F(AllocationTimelineTest, WritesChromeTrace) {
+  CreateTimeline(heap_allocator_);
+  iree_hal_buffer_t* buffer0 = Allocate(1024);
+  iree_hal_buffer_t* buffer1 = Allocate(2048);
+  iree_hal_buffer_release(buffer0);
+
+  std::string json = WriteTimeline();
+  EXPECT_EQ(0, json.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["));
+  EXPECT_NE(std::string::npos, json.find("\"name\":\"1024 B\""));
+  EXPECT_NE(std::string::npos, json.find("\"name\":\"2048 B\""));
+  EXPECT_NE(std::string::npos, json.find("\"live\":true"));
+  EXPECT_NE(std::string::npos, json.find("\"args\":{\"bytes\":3072}"));
+  EXPECT_NE(std::string::npos, json.find("\"peak_bytes\":\"3072\""));
+
+  iree_hal_buffer_release(buffer1);
+  iree_hal_allocator_release(allocator_);
+}
+
+// Buffers are returned to the allocator that produced them so that wrapped
+// allocators that intercept deallocation keep working.
+TEST_F(AllocationTimelineTest, ForwardsDeallocation) {
+  iree_hal_allocator_t* caching_allocator = nullptr;
+  IREE_ASSERT_OK(iree_hal_caching_allocator_create_unbounded(
+      heap_allocator_, iree_allocator_system(), &caching_allocator));
+  CreateTimeline(caching_allocator);
+  iree_hal_allocator_release(caching_allocator);
+
+  iree_hal_buffer_t* buffer0 = Allocate(1024);
+  iree_hal_buffer_release(buffer0);
+  iree_hal_buffer_t* buffer1 = Allocate(1024);
+  EXPECT_EQ(buffer0, buffer1);
+  iree_hal_buffer_release(buffer1);
+
+  iree_hal_allocator_release(allocator_);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -0,0 +1,391 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/arena_allocator.h"
+
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/tracing.h"
+
+// Default size of the slab when not specified by the user.
+#define IREE_HAL_ARENA_ALLOCATOR_DEFAULT_SLAB_SIZE (64 * 1024 * 1024)
+
+// Default minimum alignment of each suballocation.
+#define IREE_HAL_ARENA_ALLOCATOR_DEFAULT_MIN_ALIGNMENT 64
+
+void iree_hal_arena_allocator_params_initialize(
+    iree_hal_arena_allocator_params_t* out_params) {
+  IREE_ASSERT_ARGUMENT(out_params);
+  memset(out_params, 0, sizeof(*out_params));
+  out_params->slab_size = IREE_HAL_ARENA_ALLOCATOR_DEFAULT_SLAB_SIZE;
+  out_params->max_allocation_size = IREE_HAL_ARENA_ALLOCATOR_DEFAULT_SLAB_SIZE;
+  out_params->min_alignment = IREE_HAL_ARENA_ALLOCATOR_DEFAULT_MIN_ALIGNMENT;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_arena_allocator_t
+//===----------------------------------------------------------------------===//
+
+// Storage for a subspan buffer referencing a range of the slab.
+// Recycled on a free list when released so that steady state suballocation
+// does not touch the host allocator.
+typedef struct iree_hal_arena_allocator_buffer_t {
+  iree_hal_buffer_t base;
+  struct iree_hal_arena_allocator_buffer_t* next;
+} iree_hal_arena_allocator_buffer_t;
+
+typedef struct iree_hal_arena_allocator_t {
+  iree_hal_resource_t resource;
+  iree_allocator_t host_allocator;
+
+  // Underlying device allocator used to allocate the slab.
+  // We also route down to it for things we don't support (import/export/etc).
+  iree_hal_allocator_t* device_allocator;
+
+  // Parameters the allocator was created with.
+  iree_hal_arena_allocator_params_t params;
+
+  // Guards the slab state and the buffer free list.
+  iree_slim_mutex_t mutex;
+
+  // Slab all suballocations are made from or NULL if not yet allocated (or
+  // trimmed). Retained by the allocator and each live suballocation.
+  iree_hal_buffer_t* slab;
+
+  // Offset in bytes of the next suballocation in the slab.
+  iree_device_size_t slab_offset;
+
+  // Total number of live suballocations. When this reaches zero the slab is
+  // reset and the entire slab is available again.
+  iree_host_size_t live_count;
+
+  // Singly-linked list of released suballocation buffer storage.
+  iree_hal_arena_allocator_buffer_t* free_buffers;
+} iree_hal_arena_allocator_t;
+
+static const iree_hal_allocator_vtable_t iree_hal_arena_allocator_vtable;
+
+static iree_hal_arena_allocator_t* iree_hal_arena_allocator_cast(
+    iree_hal_allocator_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_arena_allocator_vtable);
+  return (iree_hal_arena_allocator_t*)base_value;
+}
+
+iree_status_t iree_hal_arena_allocator_create(
+    const iree_hal_arena_allocator_params_t* params,
+    iree_hal_allocator_t* device_allocator, iree_allocator_t host_allocator,
+    iree_hal_allocator_t** out_allocator) {
+  IREE_ASSERT_ARGUMENT(params);
+  IREE_ASSERT_ARGUMENT(device_allocator);
+  IREE_ASSERT_ARGUMENT(out_allocator);
+  *out_allocator = NULL;
+  if (params->min_alignment == 0 ||
+      (params->min_alignment & (params->min_alignment - 1)) != 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "minimum alignment must be a power of two; have "
+                            "%" PRIdsz,
+                            params->min_alignment);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_arena_allocator_t* allocator = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*allocator),
+                                (void**)&allocator));
+  iree_hal_resource_initialize(&iree_hal_arena_allocator_vtable,
+                               &allocator->resource);
+  allocator->host_allocator = host_allocator;
+  allocator->device_allocator = device_allocator;
+  iree_hal_allocator_retain(allocator->device_allocator);
+  allocator->params = *params;
+  iree_slim_mutex_initialize(&allocator->mutex);
+  allocator->slab = NULL;
+  allocator->slab_offset = 0;
+  allocator->live_count = 0;
+  allocator->free_buffers = NULL;
+
+  *out_allocator = (iree_hal_allocator_t*)allocator;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+// Releases the slab and the buffer free list if there are no live
+// suballocations.
+//
+// Must be called with the allocator mutex held.
+static void iree_hal_arena_allocator_trim_locked(
+    iree_hal_arena_allocator_t* allocator) {
+  if (allocator->live_count > 0) return;
+  iree_hal_buffer_release(allocator->slab);
+  allocator->slab = NULL;
+  allocator->slab_offset = 0;
+  while (allocator->free_buffers) {
+    iree_hal_arena_allocator_buffer_t* buffer = allocator->free_buffers;
+    allocator->free_buffers = buffer->next;
+    iree_allocator_free(allocator->host_allocator, buffer);
+  }
+}
+
+static void iree_hal_arena_allocator_destroy(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_arena_allocator_t* allocator =
+      iree_hal_arena_allocator_cast(base_allocator);
+  iree_allocator_t host_allocator = allocator->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  IREE_ASSERT_EQ(allocator->live_count, 0,
+                 "must have released all allocations prior to destruction");
+  iree_hal_arena_allocator_trim_locked(allocator);
+  iree_slim_mutex_deinitialize(&allocator->mutex);
+
+  iree_hal_allocator_release(allocator->device_allocator);
+  iree_allocator_free(host_allocator, allocator);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static iree_allocator_t iree_hal_arena_allocator_host_allocator(
+    const iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_arena_allocator_t* allocator =
+      (iree_hal_arena_allocator_t*)base_allocator;
+  return allocator->host_allocator;
+}
+
+static iree_status_t iree_hal_arena_allocator_trim(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_arena_allocator_t* allocator =
+      iree_hal_arena_allocator_cast(base_allocator);
+  iree_slim_mutex_lock(&allocator->mutex);
+  iree_hal_arena_allocator_trim_locked(allocator);
+  iree_slim_mutex_unlock(&allocator->mutex);
+  return iree_hal_allocator_trim(allocator->device_allocator);
+}
+
+static void iree_hal_arena_allocator_query_statistics(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_allocator_statistics_t* IREE_RESTRICT out_statistics) {
+  iree_hal_arena_allocator_t* allocator =
+      iree_hal_arena_allocator_cast(base_allocator);
+  iree_hal_allocator_query_statistics(allocator->device_allocator,
+                                      out_statistics);
+}
+
+static iree_status_t iree_hal_arena_allocator_query_memory_heaps(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_host_size_t capacity,
+    iree_hal_allocator_memory_heap_t* IREE_RESTRICT heaps,
+    iree_host_size_t* IREE_RESTRICT out_count) {
+  iree_hal_arena_allocator_t* allocator =
+      iree_hal_arena_allocator_cast(base_allocator);
+  return iree_hal_allocator_query_memory_heaps(allocator->device_allocator,
+                                               capacity, heaps, out_count);
+}
+
+static iree_hal_buffer_compatibility_t
+iree_hal_arena_allocator_query_buffer_compatibility(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t* IREE_RESTRICT allocation_size) {
+  iree_hal_arena_allocator_t* allocator =
+      iree_hal_arena_allocator_cast(base_allocator);
+  return iree_hal_allocator_query_buffer_compatibility(
+      allocator->device_allocator, *params, *allocation_size, params,
+      allocation_size);
+}
+
+// Suballocates |allocation_size| bytes from the slab, allocating the slab with
+// |params| if needed. Sets |out_buffer| to NULL if the request cannot be
+// serviced by the slab and must be routed to the underlying allocator.
+//
+// Must be called with the allocator mutex held.
+static iree_status_t iree_hal_arena_allocator_suballocate_locked(
+    iree_hal_arena_allocator_t* allocator,
+    const iree_hal_buffer_params_t* params, iree_device_size_t allocation_size,
+    iree_hal_arena_allocator_buffer_t** out_buffer,
+    iree_device_size_t* out_offset) {
+  *out_buffer = NULL;
+  *out_offset = 0;
+
+  // Allocate the slab on first use (or first use after a trim) with the
+  // parameters of the request. Requests that are incompatible with the slab
+  // will go to the underlying allocator.
+  if (!allocator->slab) {
+    IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
+        allocator->device_allocator, *params, allocator->params.slab_size,
+        iree_const_byte_span_empty(), &allocator->slab));
+    allocator->slab_offset = 0;
+  }
+  if (!iree_all_bits_set(iree_hal_buffer_memory_type(allocator->slab),
+                         params->type) ||
+      !iree_all_bits_set(iree_hal_buffer_allowed_usage(allocator->slab),
+                         params->usage)) {
+    return iree_ok_status();
+  }
+
+  // Bump the slab offset if there's space remaining.
+  const iree_device_size_t alignment =
+      iree_max(allocator->params.min_alignment, params->min_alignment);
+  const iree_device_size_t offset =
+      iree_device_align(allocator->slab_offset, alignment);
+  if (offset > allocator->params.slab_size ||
+      allocation_size > allocator->params.slab_size - offset) {
+    return iree_ok_status();
+  }
+
+  // Reuse buffer storage if available.
+  iree_hal_arena_allocator_buffer_t* buffer = allocator->free_buffers;
+  if (buffer) {
+    allocator->free_buffers = buffer->next;
+  } else {
+    IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+        allocator->host_allocator, sizeof(*buffer), (void**)&buffer));
+  }
+  buffer->next = NULL;
+
+  allocator->slab_offset = offset + allocation_size;
+  ++allocator->live_count;
+  *out_buffer = buffer;
+  *out_offset = offset;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_arena_allocator_allocate_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t allocation_size, iree_const_byte_span_t initial_data,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  iree_hal_arena_allocator_t* allocator =
+      iree_hal_arena_allocator_cast(base_allocator);
+
+  // Buffers that may outlive the program or be shared with other devices are
+  // never suballocated as they would hold the slab indefinitely. See
+  // iree_hal_caching_allocator_allocate_buffer for the initial data handling.
+  bool can_suballocate = allocation_size <=
+                         allocator->params.max_allocation_size;
+  if (iree_any_bit_set(params->usage,
+                       IREE_HAL_BUFFER_USAGE_SHARING_EXPORT |
+                           IREE_HAL_BUFFER_USAGE_SHARING_IMMUTABLE |
+                           IREE_HAL_BUFFER_USAGE_SHARING_REPLICATE)) {
+    can_suballocate = false;
+  }
+  if (!iree_const_byte_span_is_empty(initial_data) &&
+      !iree_all_bits_set(params->usage, IREE_HAL_BUFFER_USAGE_MAPPING)) {
+    can_suballocate = false;
+  }
+  if (!can_suballocate) {
+    return iree_hal_allocator_allocate_buffer(allocator->device_allocator,
+                                              *params, allocation_size,
+                                              initial_data, out_buffer);
+  }
+
+  // Resolve the parameters the underlying allocator would use so that the
+  // slab is allocated with the broadest compatible set.
+  iree_hal_buffer_params_t compat_params;
+  if (!iree_all_bits_set(iree_hal_allocator_query_buffer_compatibility(
+                             allocator->device_allocator, *params,
+                             allocation_size, &compat_params, &allocation_size),
+                         IREE_HAL_BUFFER_COMPATIBILITY_ALLOCATABLE)) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "allocator cannot allocate a buffer with the given parameters");
+  }
+
+  iree_slim_mutex_lock(&allocator->mutex);
+  iree_hal_arena_allocator_buffer_t* buffer = NULL;
+  iree_device_size_t offset = 0;
+  iree_status_t status = iree_hal_arena_allocator_suballocate_locked(
+      allocator, &compat_params, allocation_size, &buffer, &offset);
+  iree_hal_buffer_t* slab = allocator->slab;
+  iree_slim_mutex_unlock(&allocator->mutex);
+  IREE_RETURN_IF_ERROR(status);
+  if (!buffer) {
+    // Doesn't fit or isn't compatible with the slab.
+    return iree_hal_allocator_allocate_buffer(allocator->device_allocator,
+                                              compat_params, allocation_size,
+                                              initial_data, out_buffer);
+  }
+
+  // Point the buffer back to us for deallocation. The subspan retains the slab
+  // for as long as it is live.
+  iree_hal_subspan_buffer_initialize(slab, offset, allocation_size,
+                                     base_allocator, allocator->host_allocator,
+                                     &buffer->base);
+  if (!iree_const_byte_span_is_empty(initial_data)) {
+    status = iree_hal_buffer_map_write(&buffer->base, 0, initial_data.data,
+                                       initial_data.data_length);
+  }
+  if (iree_status_is_ok(status)) {
+    *out_buffer = &buffer->base;
+  } else {
+    iree_hal_buffer_release(&buffer->base);
+  }
+  return status;
+}
+
+static void iree_hal_arena_allocator_deallocate_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_buffer_t* IREE_RESTRICT base_buffer) {
+  iree_hal_arena_allocator_t* allocator =
+      iree_hal_arena_allocator_cast(base_allocator);
+  iree_hal_arena_allocator_buffer_t* buffer =
+      (iree_hal_arena_allocator_buffer_t*)base_buffer;
+
+  // Drop the slab reference held by the subspan. The allocator retains its own
+  // reference so this never releases the slab itself.
+  iree_hal_subspan_buffer_deinitialize(base_buffer);
+
+  // Recycle the storage and reset the slab if this was the last live
+  // suballocation.
+  iree_slim_mutex_lock(&allocator->mutex);
+  buffer->next = allocator->free_buffers;
+  allocator->free_buffers = buffer;
+  IREE_ASSERT_GT(allocator->live_count, 0);
+  if (--allocator->live_count == 0) {
+    allocator->slab_offset = 0;
+  }
+  iree_slim_mutex_unlock(&allocator->mutex);
+}
+
+static iree_status_t iree_hal_arena_allocator_import_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_hal_external_buffer_t* IREE_RESTRICT external_buffer,
+    iree_hal_buffer_release_callback_t release_callback,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  // Bypass the arena and directly ask the backing implementation.
+  iree_hal_arena_allocator_t* allocator =
+      iree_hal_arena_allocator_cast(base_allocator);
+  return iree_hal_allocator_import_buffer(allocator->device_allocator, *params,
+                                          external_buffer, release_callback,
+                                          out_buffer);
+}
+
+static iree_status_t iree_hal_arena_allocator_export_buffer(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator,
+    iree_hal_buffer_t* IREE_RESTRICT buffer,
+    iree_hal_external_buffer_type_t requested_type,
+    iree_hal_external_buffer_flags_t requested_flags,
+    iree_hal_external_buffer_t* IREE_RESTRICT out_external_buffer) {
+  // Bypass the arena and directly ask the backing implementation.
+  iree_hal_arena_allocator_t* allocator =
+      iree_hal_arena_allocator_cast(base_allocator);
+  return iree_hal_allocator_export_buffer(allocator->device_allocator, buffer,
+                                          requested_type, requested_flags,
+                                          out_external_buffer);
+}
+
+static const iree_hal_allocator_vtable_t iree_hal_arena_allocator_vtable = {
+    .destroy = iree_hal_arena_allocator_destroy,
+    .host_allocator = iree_hal_arena_allocator_host_allocator,
+    .trim = iree_hal_arena_allocator_trim,
+    .query_statistics = iree_hal_arena_allocator_query_statistics,
+    .query_memory_heaps = iree_hal_arena_allocator_query_memory_heaps,
+    .query_buffer_compatibility =
+        iree_hal_arena_allocator_query_buffer_compatibility,
+    .allocate_buffer = iree_hal_arena_allocator_allocate_buffer,
+    .deallocate_buffer = iree_hal_arena_allocator_deallocate_buffer,
+    .import_buffer = iree_hal_arena_allocator_import_buffer,
+    .export_buffer = iree_hal_arena_allocator_export_buffer,
+};
@@ -0,0 +1,66 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_UTILS_ARENA_ALLOCATOR_H_
+#define IREE_HAL_UTILS_ARENA_ALLOCATOR_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/allocator.h"
+#include "iree/hal/buffer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Parameters used to configure an arena allocator.
+// These cannot be changed once the allocator has been created.
+typedef struct iree_hal_arena_allocator_params_t {
+  // Size in bytes of the slab allocated from the underlying allocator that
+  // allocations are suballocated from.
+  iree_device_size_t slab_size;
+
+  // Maximum size of an allocation in bytes that will be suballocated from the
+  // slab; larger allocations will be sent directly through to the underlying
+  // allocator.
+  iree_device_size_t max_allocation_size;
+
+  // Minimum alignment in bytes of each suballocation. Larger alignments
+  // requested by the buffer params are honored.
+  iree_device_size_t min_alignment;
+} iree_hal_arena_allocator_params_t;
+
+// Initializes |out_params| to the default values.
+void iree_hal_arena_allocator_params_initialize(
+    iree_hal_arena_allocator_params_t* out_params);
+
+// Creates an allocator that linearly suballocates buffers from a single slab
+// allocated from |device_allocator| on first use.
+//
+// This is intended for the transient buffers of an invocation (such as those
+// from iree_hal_device_queue_alloca): each allocation is a bump of the slab
+// offset and when the last live suballocation is released the entire slab is
+// reset in O(1) for reuse by the next invocation. Suballocated buffer handles
+// are recycled to avoid host allocations in the steady state.
+//
+// Allocations that do not fit in the remaining slab space, that exceed the
+// maximum suballocation size, that request memory types or usage the slab does
+// not support, or that are shared outside of the program (exported, immutable,
+// etc) are routed to the underlying |device_allocator| as are buffer import
+// and export. Long-lived allocations made through the arena prevent the slab
+// from being reset and programs should only route transients through it.
+//
+// Thread-safe: internal synchronization allows multiple threads to allocate and
+// free buffers.
+iree_status_t iree_hal_arena_allocator_create(
+    const iree_hal_arena_allocator_params_t* params,
+    iree_hal_allocator_t* device_allocator, iree_allocator_t host_allocator,
+    iree_hal_allocator_t** out_allocator);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_UTILS_ARENA_ALLOCATOR_H_
@@ -0,0 +1,124 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/arena_allocator.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+class ArenaAllocatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        iree_make_cstring_view("heap"), iree_allocator_system(),
+        iree_allocator_system(), &heap_allocator_));
+    iree_hal_arena_allocator_params_t params;
+    iree_hal_arena_allocator_params_initialize(&params);
+    params.slab_size = 4096;
+    params.max_allocation_size = 2048;
+    params.min_alignment = 64;
+    IREE_ASSERT_OK(iree_hal_arena_allocator_create(
+        &params, heap_allocator_, iree_allocator_system(), &allocator_));
+  }
+
+  void TearDown() override {
+    iree_hal_allocator_release(allocator_);
+    iree_hal_allocator_release(heap_allocator_);
+  }
+
+  iree_hal_buffer_t* Allocate(iree_device_size_t byte_length) {
+    iree_hal_buffer_params_t params = {0};
+    params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+    params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+    iree_hal_buffer_t* buffer = nullptr;
+    IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(
+        allocator_, params, byte_length, iree_const_byte_span_empty(),
+        &buffer));
+    return buffer;
+  }
+
+  iree_hal_allocator_t* heap_allocator_ = nullptr;
+  iree_hal_allocator_t* allocator_ = nullptr;
+};
+
+// Allocations are bumped out of the same slab with the minimum alignment.
+TEST_F(ArenaAllocatorTest, SuballocatesFromSlab) {
+  iree_hal_buffer_t* buffer0 = Allocate(100);
+  iree_hal_buffer_t* buffer1 = Allocate(100);
+  EXPECT_EQ(iree_hal_buffer_allocated_buffer(buffer0),
+            iree_hal_buffer_allocated_buffer(buffer1));
+  EXPECT_EQ(0, iree_hal_buffer_byte_offset(buffer0));
+  EXPECT_EQ(128, iree_hal_buffer_byte_offset(buffer1));
+  EXPECT_EQ(100, iree_hal_buffer_byte_length(buffer1));
+
+  // Data written through one suballocation lands in its range of the slab.
+  uint32_t value = 0xCAFEF00Du;
+  IREE_ASSERT_OK(iree_hal_buffer_map_write(buffer1, 0, &value, sizeof(value)));
+  uint32_t readback = 0;
+  IREE_ASSERT_OK(iree_hal_buffer_map_read(
+      iree_hal_buffer_allocated_buffer(buffer1), 128, &readback,
+      sizeof(readback)));
+  EXPECT_EQ(value, readback);
+
+  iree_hal_buffer_release(buffer0);
+  iree_hal_buffer_release(buffer1);
+}
+
+// Releasing the last live suballocation resets the slab for reuse.
+TEST_F(ArenaAllocatorTest, ResetsWhenEmpty) {
+  iree_hal_buffer_t* buffer0 = Allocate(1000);
+  iree_hal_buffer_t* buffer1 = Allocate(1000);
+  EXPECT_EQ(1024, iree_hal_buffer_byte_offset(buffer1));
+  iree_hal_buffer_release(buffer0);
+
+  // A live suballocation keeps the slab offset from resetting.
+  iree_hal_buffer_t* buffer2 = Allocate(1000);
+  EXPECT_EQ(2048, iree_hal_buffer_byte_offset(buffer2));
+  iree_hal_buffer_release(buffer1);
+  iree_hal_buffer_release(buffer2);
+
+  // Buffer handles are recycled and the slab starts over.
+  iree_hal_buffer_t* buffer3 = Allocate(1000);
+  EXPECT_TRUE(buffer3 == buffer0 || buffer3 == buffer1 || buffer3 == buffer2);
+  EXPECT_EQ(0, iree_hal_buffer_byte_offset(buffer3));
+  iree_hal_buffer_release(buffer3);
+}
+
+// Allocations that are too large or don't fit go to the underlying allocator.
+TEST_F(ArenaAllocatorTest, FallsBackWhenFull) {
+  iree_hal_buffer_t* buffer0 = Allocate(1024);
+  iree_hal_buffer_t* slab = iree_hal_buffer_allocated_buffer(buffer0);
+
+  // Larger than the max suballocation size.
+  iree_hal_buffer_t* buffer1 = Allocate(3000);
+  EXPECT_NE(slab, iree_hal_buffer_allocated_buffer(buffer1));
+  EXPECT_EQ(buffer1, iree_hal_buffer_allocated_buffer(buffer1));
+
+  // Fills the remaining slab space and then overflows.
+  iree_hal_buffer_t* buffer2 = Allocate(2048);
+  iree_hal_buffer_t* buffer3 = Allocate(2048);
+  EXPECT_EQ(slab, iree_hal_buffer_allocated_buffer(buffer2));
+  EXPECT_NE(slab, iree_hal_buffer_allocated_buffer(buffer3));
+
+  iree_hal_buffer_release(buffer0);
+  iree_hal_buffer_release(buffer1);
+  iree_hal_buffer_release(buffer2);
+  iree_hal_buffer_release(buffer3);
+  IREE_ASSERT_OK(iree_hal_allocator_trim(allocator_));
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
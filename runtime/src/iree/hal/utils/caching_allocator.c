@@ -6,12 +6,17 @@
 
 #include "iree/hal/utils/caching_allocator.h"
 
+#include "iree/base/internal/math.h"
 #include "iree/base/internal/synchronization.h"
 #include "iree/base/tracing.h"
 
 // Default capacity of a pool free list when not specified by the user.
 #define IREE_HAL_CACHING_ALLOCATOR_DEFAULT_FREE_LIST_CAPACITY 64
 
+// Default number of size classes per power-of-two size range.
+// 4 bounds the waste of rounding to 25% of each allocation.
+#define IREE_HAL_CACHING_ALLOCATOR_DEFAULT_SIZE_CLASS_COUNT 4
+
 //===----------------------------------------------------------------------===//
 // iree_hal_caching_allocator_pool_t
 //===----------------------------------------------------------------------===//
@@ -29,6 +34,8 @@ void iree_hal_caching_allocator_pool_params_initialize(
   out_params->max_allocation_capacity = IREE_DEVICE_SIZE_MAX;
   out_params->max_free_allocation_count =
       IREE_HAL_CACHING_ALLOCATOR_DEFAULT_FREE_LIST_CAPACITY;
+  out_params->size_class_count =
+      IREE_HAL_CACHING_ALLOCATOR_DEFAULT_SIZE_CLASS_COUNT;
 }
 
 // Pool of arbitrarily-sized device allocations for a particular heap.
@@ -64,6 +71,10 @@ typedef iree_alignas(
   // Total size, in bytes, of all free buffers currently in this pool.
   iree_device_size_t free_allocated_size;
 
+  // Peak size, in bytes, of all allocations in use at the same time since the
+  // pool was last trimmed. Used to trim to the working set of the program.
+  iree_device_size_t high_water_mark_size;
+
   // Flat MRU list of available buffers with max_free_allocation_count slots.
   // Sorted by ascending recency (the higher the index the more recent).
   // If we really cared about optimizing the interior removal then we'd want
@@ -89,6 +100,7 @@ static void iree_hal_caching_allocator_pool_initialize(
   iree_slim_mutex_initialize(&out_pool->mutex);
   out_pool->total_allocated_size = 0;
   out_pool->free_allocated_size = 0;
+  out_pool->high_water_mark_size = 0;
   out_pool->free_count = 0;
 
   IREE_TRACE_SET_PLOT_TYPE(IREE_HAL_CACHING_ALLOCATOR_ID,
@@ -200,8 +212,7 @@ static void iree_hal_caching_allocator_pool_trim_to_size(
   while (pool->free_count > 0 && pool->total_allocated_size > target_size) {
     // Take the oldest buffer in the list.
     iree_hal_buffer_t* dead_buffer =
-        iree_hal_caching_allocator_pool_take_buffer_at(pool,
-                                                       pool->free_count - 1);
+        iree_hal_caching_allocator_pool_take_buffer_at(pool, 0);
 
     // NOTE: we've removed the buffer but have not subtracted the size from
     // the total yet - we want to do that only after releasing the buffer.
@@ -231,19 +242,72 @@ static void iree_hal_caching_allocator_pool_trim_to_size(
 static void iree_hal_caching_allocator_pool_trim(
     iree_hal_caching_allocator_pool_t* pool) {
   iree_hal_caching_allocator_pool_trim_to_size(pool, 0);
+  iree_slim_mutex_lock(&pool->mutex);
+  pool->high_water_mark_size =
+      pool->total_allocated_size - pool->free_allocated_size;
+  iree_slim_mutex_unlock(&pool->mutex);
 }
 
-// Acquires a buffer of |allocation_size| from the |pool|.
+// Releases unused buffers in |pool| beyond the peak usage since the last trim
+// and resets the peak to the current usage.
+//
+// The pool mutex must not be held by the caller.
+static void iree_hal_caching_allocator_pool_trim_to_high_water_mark(
+    iree_hal_caching_allocator_pool_t* pool) {
+  iree_slim_mutex_lock(&pool->mutex);
+  const iree_device_size_t target_size = pool->high_water_mark_size;
+  iree_slim_mutex_unlock(&pool->mutex);
+  iree_hal_caching_allocator_pool_trim_to_size(pool, target_size);
+  iree_slim_mutex_lock(&pool->mutex);
+  pool->high_water_mark_size =
+      pool->total_allocated_size - pool->free_allocated_size;
+  iree_slim_mutex_unlock(&pool->mutex);
+}
+
+// Returns |allocation_size| rounded up to the size class of |pool|.
+// Size classes divide each power-of-two range [2^n, 2^(n+1)) into
+// size_class_count equal steps. Sizes too small to divide or whose size class
+// would exceed the pool maximum allocation size are returned unmodified.
+static iree_device_size_t iree_hal_caching_allocator_pool_size_class(
+    const iree_hal_caching_allocator_pool_t* pool,
+    iree_device_size_t allocation_size) {
+  const iree_host_size_t size_class_count = pool->params.size_class_count;
+  if (size_class_count <= 1 || allocation_size == 0) return allocation_size;
+  const iree_device_size_t range_base =
+      1ull << (63 - iree_math_count_leading_zeros_u64(allocation_size));
+  const iree_device_size_t step = range_base / size_class_count;
+  if (step == 0) return allocation_size;
+  const iree_device_size_t size_class =
+      ((allocation_size + step - 1) / step) * step;
+  return size_class <= pool->params.max_allocation_size ? size_class
+                                                        : allocation_size;
+}
+
+// Updates the |pool| high water mark with the current usage.
+//
+// Must be called with the pool mutex held.
+static void iree_hal_caching_allocator_pool_update_high_water_mark(
+    iree_hal_caching_allocator_pool_t* pool) {
+  pool->high_water_mark_size =
+      iree_max(pool->high_water_mark_size,
+               pool->total_allocated_size - pool->free_allocated_size);
+}
+
+// Acquires a buffer of |byte_length| from the |pool|.
 // The buffer will have a memory type and usage compatible with the given types.
+// The underlying allocation is rounded up to the pool size class and may be
+// larger than |byte_length|.
 // Fails if the pool is empty and the underlying device fails the allocation.
 //
 // Thread-safe; multiple threads may concurrently access the |pool|.
 static iree_status_t iree_hal_caching_allocator_pool_acquire(
     iree_hal_caching_allocator_pool_t* pool,
-    const iree_hal_buffer_params_t* params, iree_device_size_t allocation_size,
+    const iree_hal_buffer_params_t* params, iree_device_size_t byte_length,
     iree_const_byte_span_t initial_data, iree_hal_buffer_t** out_buffer) {
   IREE_TRACE_ZONE_BEGIN(z0);
-  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)allocation_size);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)byte_length);
+  const iree_device_size_t allocation_size =
+      iree_hal_caching_allocator_pool_size_class(pool, byte_length);
 
   // Scan the free list to find an appropriate block.
   // If found we pop it off the list and return it without needing to allocate.
@@ -256,12 +320,24 @@ static iree_status_t iree_hal_caching_allocator_pool_acquire(
     // for by other threads allocating at the same time.
     pool->total_allocated_size += allocation_size;
   }
+  iree_hal_caching_allocator_pool_update_high_water_mark(pool);
   iree_slim_mutex_unlock(&pool->mutex);
   if (existing_buffer) {
-    // Found a buffer - return it.
-    *out_buffer = existing_buffer;
+    // Found a buffer - return it with the requested length.
+    existing_buffer->byte_length = byte_length;
+    iree_status_t status = iree_ok_status();
+    if (!iree_const_byte_span_is_empty(initial_data)) {
+      status = iree_hal_buffer_map_write(existing_buffer, 0, initial_data.data,
+                                         initial_data.data_length);
+    }
+    if (iree_status_is_ok(status)) {
+      *out_buffer = existing_buffer;
+    } else {
+      // Returns the buffer to the pool via the caching allocator.
+      iree_hal_buffer_release(existing_buffer);
+    }
     IREE_TRACE_ZONE_END(z0);
-    return iree_ok_status();
+    return status;
   }
 
   // Trim first before allocating so that we don't go over peak.
@@ -287,6 +363,7 @@ static iree_status_t iree_hal_caching_allocator_pool_acquire(
 
   // If the allocation failed then remove the size from the total.
   if (iree_status_is_ok(status)) {
+    buffer->byte_length = byte_length;
     *out_buffer = buffer;
   } else {
     if (buffer) iree_hal_buffer_release(buffer);
@@ -487,6 +564,19 @@ static iree_status_t iree_hal_caching_allocator_trim(
   return iree_ok_status();
 }
 
+iree_status_t iree_hal_caching_allocator_trim_to_high_water_mark(
+    iree_hal_allocator_t* base_allocator) {
+  iree_hal_caching_allocator_t* allocator =
+      iree_hal_caching_allocator_cast(base_allocator);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  for (iree_host_size_t i = 0; i < allocator->pool_count; ++i) {
+    iree_hal_caching_allocator_pool_trim_to_high_water_mark(
+        allocator->pools[i]);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 static void iree_hal_caching_allocator_query_statistics(
     iree_hal_allocator_t* IREE_RESTRICT base_allocator,
     iree_hal_allocator_statistics_t* IREE_RESTRICT out_statistics) {
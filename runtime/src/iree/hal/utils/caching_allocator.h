@@ -50,6 +50,13 @@ typedef struct iree_hal_caching_allocator_pool_params_t {
   // This is used to allocate storage for the free list and should be reasonably
   // bounded (~64-1024).
   iree_host_size_t max_free_allocation_count;
+
+  // Number of size classes each power-of-two size range is divided into.
+  // Allocation sizes are rounded up to the next size class so that requests of
+  // similar but not identical sizes (such as from dynamically shaped programs)
+  // can reuse the same cached buffers. At most 1/size_class_count of each
+  // allocation is wasted. 0 disables binning and only exact sizes are reused.
+  iree_host_size_t size_class_count;
 } iree_hal_caching_allocator_pool_params_t;
 
 // Initializes |out_params| to the default values using |heap| for storage.
@@ -91,6 +98,15 @@ iree_status_t iree_hal_caching_allocator_create_with_pools(
     iree_hal_allocator_t* device_allocator, iree_allocator_t host_allocator,
     iree_hal_allocator_t** out_allocator);
 
+// Trims each pool of the caching |allocator| down to the peak number of bytes
+// that were in use at any one time since the last trim. Unlike
+// iree_hal_allocator_trim, which releases all unused buffers, this retains
+// enough cached buffers to service the observed working set again without
+// allocating while releasing anything cached beyond it. Oldest buffers are
+// released first.
+iree_status_t iree_hal_caching_allocator_trim_to_high_water_mark(
+    iree_hal_allocator_t* allocator);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
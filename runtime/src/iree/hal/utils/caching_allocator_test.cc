@@ -0,0 +1,111 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/caching_allocator.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+class CachingAllocatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        iree_make_cstring_view("heap"), iree_allocator_system(),
+        iree_allocator_system(), &heap_allocator_));
+
+    iree_hal_allocator_memory_heap_t heaps[8];
+    iree_host_size_t heap_count = 0;
+    IREE_ASSERT_OK(iree_hal_allocator_query_memory_heaps(
+        heap_allocator_, IREE_ARRAYSIZE(heaps), heaps, &heap_count));
+    ASSERT_GE(heap_count, 1);
+    iree_hal_caching_allocator_pool_params_t pool_params;
+    heap_ = heaps[0];
+    iree_hal_caching_allocator_pool_params_initialize(heap_, &pool_params);
+    pool_params.size_class_count = 4;
+    IREE_ASSERT_OK(iree_hal_caching_allocator_create_with_pools(
+        1, &pool_params, heap_allocator_, iree_allocator_system(),
+        &allocator_));
+  }
+
+  void TearDown() override {
+    iree_hal_allocator_release(allocator_);
+    iree_hal_allocator_release(heap_allocator_);
+  }
+
+  iree_hal_buffer_t* Allocate(iree_device_size_t byte_length) {
+    iree_hal_buffer_params_t params = {0};
+    params.type = heap_.type;
+    params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+    iree_hal_buffer_t* buffer = nullptr;
+    IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(
+        allocator_, params, byte_length, iree_const_byte_span_empty(),
+        &buffer));
+    return buffer;
+  }
+
+  iree_hal_allocator_memory_heap_t heap_;
+  iree_hal_allocator_t* heap_allocator_ = nullptr;
+  iree_hal_allocator_t* allocator_ = nullptr;
+};
+
+// Sizes within the same size class reuse the same cached buffer.
+TEST_F(CachingAllocatorTest, SizeClassReuse) {
+  iree_hal_buffer_t* buffer0 = Allocate(1000);
+  EXPECT_EQ(1000, iree_hal_buffer_byte_length(buffer0));
+  EXPECT_EQ(1024, iree_hal_buffer_allocation_size(buffer0));
+  iree_hal_buffer_release(buffer0);
+
+  iree_hal_buffer_t* buffer1 = Allocate(900);
+  EXPECT_EQ(buffer0, buffer1);
+  EXPECT_EQ(900, iree_hal_buffer_byte_length(buffer1));
+  iree_hal_buffer_release(buffer1);
+
+  // 1100 rounds up to the next size class (1280) and misses the cache.
+  iree_hal_buffer_t* buffer2 = Allocate(1100);
+  EXPECT_EQ(1280, iree_hal_buffer_allocation_size(buffer2));
+  iree_hal_buffer_release(buffer2);
+}
+
+// Trimming to the high water mark retains the peak working set.
+TEST_F(CachingAllocatorTest, TrimToHighWaterMark) {
+  iree_hal_buffer_t* buffer0 = Allocate(1024);
+  iree_hal_buffer_t* buffer1 = Allocate(1024);
+  iree_hal_buffer_release(buffer0);
+  iree_hal_buffer_release(buffer1);
+
+  // Both buffers were in use at the same time and remain cached.
+  IREE_ASSERT_OK(
+      iree_hal_caching_allocator_trim_to_high_water_mark(allocator_));
+  iree_hal_buffer_t* buffer2 = Allocate(1024);
+  iree_hal_buffer_t* buffer3 = Allocate(1024);
+  EXPECT_TRUE(buffer2 == buffer0 || buffer2 == buffer1);
+  EXPECT_TRUE(buffer3 == buffer0 || buffer3 == buffer1);
+  iree_hal_buffer_release(buffer3);
+  IREE_ASSERT_OK(
+      iree_hal_caching_allocator_trim_to_high_water_mark(allocator_));
+
+  // Only one buffer was in use since the last trim so trimming releases the
+  // oldest cached buffer.
+  iree_hal_buffer_release(buffer2);
+  IREE_ASSERT_OK(
+      iree_hal_caching_allocator_trim_to_high_water_mark(allocator_));
+  iree_hal_buffer_t* buffer4 = Allocate(1024);
+  EXPECT_EQ(buffer2, buffer4);
+  iree_hal_buffer_release(buffer4);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -723,15 +723,10 @@ static iree_status_t iree_hal_deferred_command_buffer_push_descriptor_set(
   cmd->pipeline_layout = pipeline_layout;
   cmd->set = set;
   cmd->binding_count = binding_count;
-  for (iree_host_size_t i = 0; i < binding_count; ++i) {
-    iree_hal_descriptor_set_binding_t binding = bindings[i];
-    cmd->bindings[i] = binding;
-    if (binding.buffer) {
-      IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
-          command_buffer->resource_set, 1, &binding.buffer));
-    }
-  }
-  return iree_ok_status();
+  memcpy(cmd->bindings, bindings, sizeof(cmd->bindings[0]) * binding_count);
+  return iree_hal_resource_set_insert_strided(
+      command_buffer->resource_set, binding_count, &bindings[0].buffer,
+      sizeof(bindings[0]));
 }
 
 static iree_status_t iree_hal_deferred_command_buffer_apply_push_descriptor_set(
@@ -0,0 +1,1218 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/dispatch_statistics.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/api.h"
+
+// Maximum push constant storage in bytes shadowed for re-recording.
+#define IREE_HAL_DISPATCH_STATISTICS_MAX_PUSH_CONSTANT_SIZE (64 * 4)
+
+// Maximum descriptor set count shadowed for re-recording.
+#define IREE_HAL_DISPATCH_STATISTICS_MAX_DESCRIPTOR_SET_COUNT 4
+
+// Maximum bindings in a single descriptor set shadowed for re-recording.
+#define IREE_HAL_DISPATCH_STATISTICS_MAX_BINDING_COUNT 32
+
+//===----------------------------------------------------------------------===//
+// iree_hal_dispatch_statistics_device_t
+//===----------------------------------------------------------------------===//
+
+// An executable prepared on the device.
+typedef struct iree_hal_dispatch_statistics_executable_t {
+  // Retained for the lifetime of the device so that the pointer is not reused.
+  iree_hal_executable_t* executable;
+  // Format string, allocated from the host allocator.
+  char* format;
+} iree_hal_dispatch_statistics_executable_t;
+
+// Accumulated statistics for a single executable export.
+typedef struct iree_hal_dispatch_statistics_entry_t {
+  // Index into the device executables list.
+  iree_host_size_t executable_index;
+  int32_t entry_point;
+  uint64_t dispatch_count;
+  uint64_t workgroup_count;
+  iree_duration_t total_ns;
+  iree_duration_t min_ns;
+  iree_duration_t max_ns;
+} iree_hal_dispatch_statistics_entry_t;
+
+typedef struct iree_hal_dispatch_statistics_device_t {
+  iree_hal_resource_t resource;
+  iree_allocator_t host_allocator;
+  iree_hal_device_t* base_device;
+
+  // Private timeline used to wait on each segment submission.
+  // Guarded by submit_mutex.
+  iree_slim_mutex_t submit_mutex;
+  iree_hal_semaphore_t* timeline;
+  uint64_t timeline_value;
+
+  // Guards the executable and entry lists.
+  iree_slim_mutex_t mutex;
+  iree_host_size_t executable_count;
+  iree_host_size_t executable_capacity;
+  iree_hal_dispatch_statistics_executable_t* executables;
+  iree_host_size_t entry_count;
+  iree_host_size_t entry_capacity;
+  iree_hal_dispatch_statistics_entry_t* entries;
+} iree_hal_dispatch_statistics_device_t;
+
+static const iree_hal_device_vtable_t
+    iree_hal_dispatch_statistics_device_vtable;
+
+static iree_hal_dispatch_statistics_device_t*
+iree_hal_dispatch_statistics_device_cast(iree_hal_device_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_dispatch_statistics_device_vtable);
+  return (iree_hal_dispatch_statistics_device_t*)base_value;
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_dispatch_statistics_device_create(
+    iree_hal_device_t* base_device, iree_allocator_t host_allocator,
+    iree_hal_device_t** out_device) {
+  IREE_ASSERT_ARGUMENT(base_device);
+  IREE_ASSERT_ARGUMENT(out_device);
+  *out_device = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_dispatch_statistics_device_t* device = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0,
+      iree_allocator_malloc(host_allocator, sizeof(*device), (void**)&device));
+  memset(device, 0, sizeof(*device));
+  iree_hal_resource_initialize(&iree_hal_dispatch_statistics_device_vtable,
+                               &device->resource);
+  device->host_allocator = host_allocator;
+  device->base_device = base_device;
+  iree_hal_device_retain(base_device);
+  iree_slim_mutex_initialize(&device->submit_mutex);
+  iree_slim_mutex_initialize(&device->mutex);
+
+  iree_status_t status =
+      iree_hal_semaphore_create(base_device, 0ull, &device->timeline);
+
+  if (iree_status_is_ok(status)) {
+    *out_device = (iree_hal_device_t*)device;
+  } else {
+    iree_hal_device_release((iree_hal_device_t*)device);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT bool iree_hal_dispatch_statistics_device_isa(
+    iree_hal_device_t* device) {
+  return iree_hal_resource_is(device,
+                              &iree_hal_dispatch_statistics_device_vtable);
+}
+
+static void iree_hal_dispatch_statistics_device_destroy(
+    iree_hal_device_t* base_device) {
+  iree_hal_dispatch_statistics_device_t* device =
+      iree_hal_dispatch_statistics_device_cast(base_device);
+  iree_allocator_t host_allocator = device->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  for (iree_host_size_t i = 0; i < device->executable_count; ++i) {
+    iree_hal_executable_release(device->executables[i].executable);
+    iree_allocator_free(host_allocator, device->executables[i].format);
+  }
+  iree_allocator_free(host_allocator, device->executables);
+  iree_allocator_free(host_allocator, device->entries);
+  iree_hal_semaphore_release(device->timeline);
+  iree_slim_mutex_deinitialize(&device->mutex);
+  iree_slim_mutex_deinitialize(&device->submit_mutex);
+  iree_hal_device_release(device->base_device);
+  iree_allocator_free(host_allocator, device);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Registers |executable| with the device and returns its index.
+// Must be called with the device mutex held.
+static iree_status_t iree_hal_dispatch_statistics_device_register_executable(
+    iree_hal_dispatch_statistics_device_t* device,
+    iree_hal_executable_t* executable, iree_string_view_t format,
+    iree_host_size_t* out_index) {
+  for (iree_host_size_t i = 0; i < device->executable_count; ++i) {
+    if (device->executables[i].executable == executable) {
+      *out_index = i;
+      return iree_ok_status();
+    }
+  }
+  if (device->executable_count == device->executable_capacity) {
+    iree_host_size_t new_capacity =
+        iree_max(16, device->executable_capacity * 2);
+    IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+        device->host_allocator, new_capacity * sizeof(*device->executables),
+        (void**)&device->executables));
+    device->executable_capacity = new_capacity;
+  }
+  char* format_cstring = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      device->host_allocator, format.size + 1, (void**)&format_cstring));
+  memcpy(format_cstring, format.data, format.size);
+  format_cstring[format.size] = 0;
+  iree_hal_dispatch_statistics_executable_t* entry =
+      &device->executables[device->executable_count];
+  entry->executable = executable;
+  iree_hal_executable_retain(executable);
+  entry->format = format_cstring;
+  *out_index = device->executable_count++;
+  return iree_ok_status();
+}
+
+// Records a dispatch of |executable| |entry_point| taking |duration_ns|.
+static iree_status_t iree_hal_dispatch_statistics_device_record(
+    iree_hal_dispatch_statistics_device_t* device,
+    iree_hal_executable_t* executable, int32_t entry_point,
+    uint64_t workgroup_count, iree_duration_t duration_ns) {
+  iree_slim_mutex_lock(&device->mutex);
+
+  iree_host_size_t executable_index = 0;
+  iree_status_t status =
+      iree_hal_dispatch_statistics_device_register_executable(
+          device, executable, IREE_SV("unknown"), &executable_index);
+
+  iree_hal_dispatch_statistics_entry_t* entry = NULL;
+  for (iree_host_size_t i = 0; iree_status_is_ok(status) &&
+                               i < device->entry_count;
+       ++i) {
+    if (device->entries[i].executable_index == executable_index &&
+        device->entries[i].entry_point == entry_point) {
+      entry = &device->entries[i];
+      break;
+    }
+  }
+  if (iree_status_is_ok(status) && !entry) {
+    if (device->entry_count == device->entry_capacity) {
+      iree_host_size_t new_capacity = iree_max(64, device->entry_capacity * 2);
+      status = iree_allocator_realloc(device->host_allocator,
+                                      new_capacity * sizeof(*device->entries),
+                                      (void**)&device->entries);
+      if (iree_status_is_ok(status)) device->entry_capacity = new_capacity;
+    }
+    if (iree_status_is_ok(status)) {
+      entry = &device->entries[device->entry_count++];
+      memset(entry, 0, sizeof(*entry));
+      entry->executable_index = executable_index;
+      entry->entry_point = entry_point;
+      entry->min_ns = IREE_DURATION_INFINITE;
+    }
+  }
+  if (entry) {
+    ++entry->dispatch_count;
+    entry->workgroup_count += workgroup_count;
+    entry->total_ns += duration_ns;
+    entry->min_ns = iree_min(entry->min_ns, duration_ns);
+    entry->max_ns = iree_max(entry->max_ns, duration_ns);
+  }
+
+  iree_slim_mutex_unlock(&device->mutex);
+  return status;
+}
+
+static int iree_hal_dispatch_statistics_entry_compare(const void* a,
+                                                      const void* b) {
+  const iree_hal_dispatch_statistics_entry_t* a_entry =
+      (const iree_hal_dispatch_statistics_entry_t*)a;
+  const iree_hal_dispatch_statistics_entry_t* b_entry =
+      (const iree_hal_dispatch_statistics_entry_t*)b;
+  iree_duration_t a_ns = a_entry->total_ns;
+  iree_duration_t b_ns = b_entry->total_ns;
+  return a_ns < b_ns ? 1 : (a_ns > b_ns ? -1 : 0);
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_dispatch_statistics_device_fprint(
+    FILE* file, iree_hal_device_t* base_device) {
+  IREE_ASSERT_ARGUMENT(file);
+  IREE_ASSERT_ARGUMENT(base_device);
+  if (!iree_hal_dispatch_statistics_device_isa(base_device)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "device was not created with dispatch statistics");
+  }
+  iree_hal_dispatch_statistics_device_t* device =
+      iree_hal_dispatch_statistics_device_cast(base_device);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_slim_mutex_lock(&device->mutex);
+
+  qsort(device->entries, device->entry_count, sizeof(*device->entries),
+        iree_hal_dispatch_statistics_entry_compare);
+  iree_duration_t total_ns = 0;
+  uint64_t total_count = 0;
+  for (iree_host_size_t i = 0; i < device->entry_count; ++i) {
+    total_ns += device->entries[i].total_ns;
+    total_count += device->entries[i].dispatch_count;
+  }
+
+  fprintf(file,
+          "[[ iree_hal_dispatch_statistics ]] %" PRIu64
+          " dispatches, %.3f ms total (serialized)\n",
+          total_count, (double)total_ns / 1e6);
+  fprintf(file, "%12s %7s %9s %11s %11s %11s  %s\n", "total ms", "%",
+          "count", "avg us", "min us", "max us", "executable:export");
+  for (iree_host_size_t i = 0; i < device->entry_count; ++i) {
+    const iree_hal_dispatch_statistics_entry_t* entry = &device->entries[i];
+    const iree_hal_dispatch_statistics_executable_t* executable =
+        &device->executables[entry->executable_index];
+    double percent =
+        total_ns > 0 ? 100.0 * (double)entry->total_ns / (double)total_ns : 0.0;
+    fprintf(file,
+            "%12.3f %6.2f%% %9" PRIu64 " %11.3f %11.3f %11.3f  "
+            "executable[%" PRIhsz "](%s):%d\n",
+            (double)entry->total_ns / 1e6, percent, entry->dispatch_count,
+            (double)entry->total_ns / (double)entry->dispatch_count / 1e3,
+            (double)entry->min_ns / 1e3, (double)entry->max_ns / 1e3,
+            entry->executable_index, executable->format, entry->entry_point);
+  }
+
+  iree_slim_mutex_unlock(&device->mutex);
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_dispatch_statistics_executable_cache_t
+//===----------------------------------------------------------------------===//
+
+// Forwards to a base executable cache and registers each prepared executable
+// with the device so that it can be identified in the statistics.
+typedef struct iree_hal_dispatch_statistics_executable_cache_t {
+  iree_hal_resource_t resource;
+  iree_hal_dispatch_statistics_device_t* device;
+  iree_hal_executable_cache_t* base_cache;
+} iree_hal_dispatch_statistics_executable_cache_t;
+
+static const iree_hal_executable_cache_vtable_t
+    iree_hal_dispatch_statistics_executable_cache_vtable;
+
+static iree_hal_dispatch_statistics_executable_cache_t*
+iree_hal_dispatch_statistics_executable_cache_cast(
+    iree_hal_executable_cache_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value,
+                       &iree_hal_dispatch_statistics_executable_cache_vtable);
+  return (iree_hal_dispatch_statistics_executable_cache_t*)base_value;
+}
+
+static iree_status_t iree_hal_dispatch_statistics_executable_cache_create(
+    iree_hal_dispatch_statistics_device_t* device,
+    iree_hal_executable_cache_t* base_cache,
+    iree_hal_executable_cache_t** out_executable_cache) {
+  iree_hal_dispatch_statistics_executable_cache_t* executable_cache = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(device->host_allocator,
+                                             sizeof(*executable_cache),
+                                             (void**)&executable_cache));
+  iree_hal_resource_initialize(
+      &iree_hal_dispatch_statistics_executable_cache_vtable,
+      &executable_cache->resource);
+  executable_cache->device = device;
+  iree_hal_device_retain((iree_hal_device_t*)device);
+  executable_cache->base_cache = base_cache;
+  iree_hal_executable_cache_retain(base_cache);
+  *out_executable_cache = (iree_hal_executable_cache_t*)executable_cache;
+  return iree_ok_status();
+}
+
+static void iree_hal_dispatch_statistics_executable_cache_destroy(
+    iree_hal_executable_cache_t* base_executable_cache) {
+  iree_hal_dispatch_statistics_executable_cache_t* executable_cache =
+      iree_hal_dispatch_statistics_executable_cache_cast(base_executable_cache);
+  iree_hal_dispatch_statistics_device_t* device = executable_cache->device;
+  iree_hal_executable_cache_release(executable_cache->base_cache);
+  iree_allocator_free(device->host_allocator, executable_cache);
+  iree_hal_device_release((iree_hal_device_t*)device);
+}
+
+static bool iree_hal_dispatch_statistics_executable_cache_can_prepare_format(
+    iree_hal_executable_cache_t* base_executable_cache,
+    iree_hal_executable_caching_mode_t caching_mode,
+    iree_string_view_t executable_format) {
+  iree_hal_dispatch_statistics_executable_cache_t* executable_cache =
+      iree_hal_dispatch_statistics_executable_cache_cast(base_executable_cache);
+  return iree_hal_executable_cache_can_prepare_format(
+      executable_cache->base_cache, caching_mode, executable_format);
+}
+
+static iree_status_t
+iree_hal_dispatch_statistics_executable_cache_prepare_executable(
+    iree_hal_executable_cache_t* base_executable_cache,
+    const iree_hal_executable_params_t* executable_params,
+    iree_hal_executable_t** out_executable) {
+  iree_hal_dispatch_statistics_executable_cache_t* executable_cache =
+      iree_hal_dispatch_statistics_executable_cache_cast(base_executable_cache);
+  iree_hal_dispatch_statistics_device_t* device = executable_cache->device;
+  IREE_RETURN_IF_ERROR(iree_hal_executable_cache_prepare_executable(
+      executable_cache->base_cache, executable_params, out_executable));
+  iree_slim_mutex_lock(&device->mutex);
+  iree_host_size_t executable_index = 0;
+  iree_status_t status =
+      iree_hal_dispatch_statistics_device_register_executable(
+          device, *out_executable, executable_params->executable_format,
+          &executable_index);
+  iree_slim_mutex_unlock(&device->mutex);
+  if (!iree_status_is_ok(status)) {
+    iree_hal_executable_release(*out_executable);
+    *out_executable = NULL;
+  }
+  return status;
+}
+
+static const iree_hal_executable_cache_vtable_t
+    iree_hal_dispatch_statistics_executable_cache_vtable = {
+        .destroy = iree_hal_dispatch_statistics_executable_cache_destroy,
+        .can_prepare_format =
+            iree_hal_dispatch_statistics_executable_cache_can_prepare_format,
+        .prepare_executable =
+            iree_hal_dispatch_statistics_executable_cache_prepare_executable,
+};
+
+//===----------------------------------------------------------------------===//
+// iree_hal_dispatch_statistics_command_buffer_t
+//===----------------------------------------------------------------------===//
+
+// A base command buffer containing at most one dispatch as its last command.
+typedef struct iree_hal_dispatch_statistics_segment_t {
+  iree_hal_command_buffer_t* command_buffer;
+  // Unretained; the segment command buffer retains it.
+  iree_hal_executable_t* executable;
+  int32_t entry_point;
+  uint64_t workgroup_count;
+} iree_hal_dispatch_statistics_segment_t;
+
+// State that must be re-recorded at the start of each segment as command
+// buffer state does not carry across command buffers.
+typedef struct iree_hal_dispatch_statistics_descriptor_set_t {
+  iree_hal_pipeline_layout_t* pipeline_layout;
+  iree_host_size_t binding_count;
+  iree_hal_descriptor_set_binding_t
+      bindings[IREE_HAL_DISPATCH_STATISTICS_MAX_BINDING_COUNT];
+} iree_hal_dispatch_statistics_descriptor_set_t;
+
+typedef struct iree_hal_dispatch_statistics_command_buffer_t {
+  iree_hal_command_buffer_t base;
+  iree_hal_dispatch_statistics_device_t* device;
+
+  // Segment command buffer parameters.
+  iree_hal_command_buffer_mode_t mode;
+  iree_hal_command_category_t command_categories;
+  iree_hal_queue_affinity_t queue_affinity;
+  iree_host_size_t binding_capacity;
+
+  iree_host_size_t segment_count;
+  iree_host_size_t segment_capacity;
+  iree_hal_dispatch_statistics_segment_t* segments;
+  // True if the last segment is still being recorded.
+  bool segment_open;
+
+  // Shadowed push constants (retained layout).
+  iree_hal_pipeline_layout_t* constants_layout;
+  iree_host_size_t constants_length;
+  uint8_t constants[IREE_HAL_DISPATCH_STATISTICS_MAX_PUSH_CONSTANT_SIZE];
+
+  // Shadowed push descriptor sets (retained layouts and buffers).
+  iree_hal_dispatch_statistics_descriptor_set_t
+      sets[IREE_HAL_DISPATCH_STATISTICS_MAX_DESCRIPTOR_SET_COUNT];
+} iree_hal_dispatch_statistics_command_buffer_t;
+
+static const iree_hal_command_buffer_vtable_t
+    iree_hal_dispatch_statistics_command_buffer_vtable;
+
+static iree_hal_dispatch_statistics_command_buffer_t*
+iree_hal_dispatch_statistics_command_buffer_cast(
+    iree_hal_command_buffer_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value,
+                       &iree_hal_dispatch_statistics_command_buffer_vtable);
+  return (iree_hal_dispatch_statistics_command_buffer_t*)base_value;
+}
+
+static iree_status_t iree_hal_dispatch_statistics_command_buffer_create(
+    iree_hal_dispatch_statistics_device_t* device,
+    iree_hal_command_buffer_mode_t mode,
+    iree_hal_command_category_t command_categories,
+    iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
+    iree_hal_command_buffer_t** out_command_buffer) {
+  iree_hal_dispatch_statistics_command_buffer_t* command_buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(device->host_allocator,
+                                             sizeof(*command_buffer),
+                                             (void**)&command_buffer));
+  memset(command_buffer, 0, sizeof(*command_buffer));
+  iree_hal_command_buffer_initialize(
+      (iree_hal_device_t*)device, mode, command_categories, queue_affinity,
+      binding_capacity, &iree_hal_dispatch_statistics_command_buffer_vtable,
+      &command_buffer->base);
+  command_buffer->device = device;
+  iree_hal_device_retain((iree_hal_device_t*)device);
+  // Segments are only executed when submitted so that they can be timed.
+  command_buffer->mode =
+      mode & ~IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION;
+  command_buffer->command_categories = command_categories;
+  command_buffer->queue_affinity = queue_affinity;
+  command_buffer->binding_capacity = binding_capacity;
+  *out_command_buffer = &command_buffer->base;
+  return iree_ok_status();
+}
+
+static void iree_hal_dispatch_statistics_command_buffer_reset_state(
+    iree_hal_dispatch_statistics_command_buffer_t* command_buffer) {
+  iree_hal_pipeline_layout_release(command_buffer->constants_layout);
+  command_buffer->constants_layout = NULL;
+  command_buffer->constants_length = 0;
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(command_buffer->sets); ++i) {
+    iree_hal_dispatch_statistics_descriptor_set_t* set =
+        &command_buffer->sets[i];
+    for (iree_host_size_t j = 0; j < set->binding_count; ++j) {
+      iree_hal_buffer_release(set->bindings[j].buffer);
+    }
+    iree_hal_pipeline_layout_release(set->pipeline_layout);
+    set->pipeline_layout = NULL;
+    set->binding_count = 0;
+  }
+}
+
+static void iree_hal_dispatch_statistics_command_buffer_destroy(
+    iree_hal_command_buffer_t* base_command_buffer) {
+  iree_hal_dispatch_statistics_command_buffer_t* command_buffer =
+      iree_hal_dispatch_statistics_command_buffer_cast(base_command_buffer);
+  iree_hal_dispatch_statistics_device_t* device = command_buffer->device;
+  iree_hal_dispatch_statistics_command_buffer_reset_state(command_buffer);
+  for (iree_host_size_t i = 0; i < command_buffer->segment_count; ++i) {
+    iree_hal_command_buffer_release(command_buffer->segments[i].command_buffer);
+  }
+  iree_allocator_free(device->host_allocator, command_buffer->segments);
+  iree_allocator_free(device->host_allocator, command_buffer);
+  iree_hal_device_release((iree_hal_device_t*)device);
+}
+
+static void* iree_hal_dispatch_statistics_command_buffer_dyn_cast(
+    iree_hal_command_buffer_t* command_buffer, const void* vtable) {
+  if (vtable == &iree_hal_dispatch_statistics_command_buffer_vtable) {
+    IREE_HAL_ASSERT_TYPE(command_buffer, vtable);
+    return command_buffer;
+  }
+  return NULL;
+}
+
+// Re-records the shadowed push constants and descriptor sets into |target|.
+static iree_status_t iree_hal_dispatch_statistics_command_buffer_replay_state(
+    iree_hal_dispatch_statistics_command_buffer_t* command_buffer,
+    iree_hal_command_buffer_t* target) {
+  if (command_buffer->constants_layout) {
+    IREE_RETURN_IF_ERROR(iree_hal_command_buffer_push_constants(
+        target, command_buffer->constants_layout, 0, command_buffer->constants,
+        command_buffer->constants_length));
+  }
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(command_buffer->sets); ++i) {
+    iree_hal_dispatch_statistics_descriptor_set_t* set =
+        &command_buffer->sets[i];
+    if (!set->pipeline_layout) continue;
+    IREE_RETURN_IF_ERROR(iree_hal_command_buffer_push_descriptor_set(
+        target, set->pipeline_layout, (uint32_t)i, set->binding_count,
+        set->bindings));
+  }
+  return iree_ok_status();
+}
+
+// Returns the segment currently being recorded, starting a new one if needed.
+static iree_status_t iree_hal_dispatch_statistics_command_buffer_segment(
+    iree_hal_dispatch_statistics_command_buffer_t* command_buffer,
+    iree_hal_command_buffer_t** out_target) {
+  if (command_buffer->segment_open) {
+    *out_target =
+        command_buffer->segments[command_buffer->segment_count - 1]
+            .command_buffer;
+    return iree_ok_status();
+  }
+
+  iree_hal_dispatch_statistics_device_t* device = command_buffer->device;
+  if (command_buffer->segment_count == command_buffer->segment_capacity) {
+    iree_host_size_t new_capacity =
+        iree_max(8, command_buffer->segment_capacity * 2);
+    IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+        device->host_allocator,
+        new_capacity * sizeof(*command_buffer->segments),
+        (void**)&command_buffer->segments));
+    command_buffer->segment_capacity = new_capacity;
+  }
+
+  iree_hal_command_buffer_t* target = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_command_buffer_create(
+      device->base_device, command_buffer->mode,
+      command_buffer->command_categories, command_buffer->queue_affinity,
+      command_buffer->binding_capacity, &target));
+  iree_status_t status = iree_hal_command_buffer_begin(target);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_dispatch_statistics_command_buffer_replay_state(
+        command_buffer, target);
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_hal_command_buffer_release(target);
+    return status;
+  }
+
+  iree_hal_dispatch_statistics_segment_t* segment =
+      &command_buffer->segments[command_buffer->segment_count++];
+  memset(segment, 0, sizeof(*segment));
+  segment->command_buffer = target;
+  command_buffer->segment_open = true;
+  *out_target = target;
+  return iree_ok_status();
+}
+
+// Ends the segment currently being recorded, if any.
+static iree_status_t iree_hal_dispatch_statistics_command_buffer_end_segment(
+    iree_hal_dispatch_statistics_command_buffer_t* command_buffer) {
+  if (!command_buffer->segment_open) return iree_ok_status();
+  command_buffer->segment_open = false;
+  return iree_hal_command_buffer_end(
+      command_buffer->segments[command_buffer->segment_count - 1]
+          .command_buffer);
+}
+
+static iree_status_t iree_hal_dispatch_statistics_command_buffer_begin(
+    iree_hal_command_buffer_t* base_command_buffer) {
+  iree_hal_dispatch_statistics_command_buffer_t* command_buffer =
+      iree_hal_dispatch_statistics_command_buffer_cast(base_command_buffer);
+  if (command_buffer->segment_count > 0) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "command buffer cannot be re-recorded");
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_dispatch_statistics_command_buffer_end(
+    iree_hal_command_buffer_t* base_command_buffer) {
+  iree_hal_dispatch_statistics_command_buffer_t* command_buffer =
+      iree_hal_dispatch_statistics_command_buffer_cast(base_command_buffer);
+  IREE_RETURN_IF_ERROR(
+      iree_hal_dispatch_statistics_command_buffer_end_segment(command_buffer));
+  iree_hal_dispatch_statistics_command_buffer_reset_state(command_buffer);
+  return iree_ok_status();
+}
+
+// Debug groups would need to be balanced within each segment and are dropped.
+static void iree_hal_dispatch_statistics_command_buffer_begin_debug_group(
+    iree_hal_command_buffer_t* base_command_buffer, iree_string_view_t label,
+    iree_hal_label_color_t label_color,
+    const iree_hal_label_location_t* location) {}
+
+static void iree_hal_dispatch_statistics_command_buffer_end_debug_group(
+    iree_hal_command_buffer_t* base_command_buffer) {}
+
+static iree_status_t
+iree_hal_dispatch_statistics_command_buffer_execution_barrier(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_execution_stage_t source_stage_mask,
+    iree_hal_execution_stage_t target_stage_mask,
+    iree_hal_execution_barrier_flags_t flags,
+    iree_host_size_t memory_barrier_count,
+    const iree_hal_memory_barrier_t* memory_barriers,
+    iree_host_size_t buffer_barrier_count,
+    const iree_hal_buffer_barrier_t* buffer_barriers) {
+  iree_hal_dispatch_statistics_command_buffer_t* command_buffer =
+      iree_hal_dispatch_statistics_command_buffer_cast(base_command_buffer);
+  // Segments are executed in order so barriers between them are implicit.
+  if (!command_buffer->segment_open) return iree_ok_status();
+  iree_hal_command_buffer_t* target = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_dispatch_statistics_command_buffer_segment(
+      command_buffer, &target));
+  return iree_hal_command_buffer_execution_barrier(
+      target, source_stage_mask, target_stage_mask, flags,
+      memory_barrier_count, memory_barriers, buffer_barrier_count,
+      buffer_barriers);
+}
+
+static iree_status_t iree_hal_dispatch_statistics_command_buffer_signal_event(
+    iree_hal_command_buffer_t* base_command_buffer, iree_hal_event_t* event,
+    iree_hal_execution_stage_t source_stage_mask) {
+  iree_hal_dispatch_statistics_command_buffer_t* command_buffer =
+      iree_hal_dispatch_statistics_command_buffer_cast(base_command_buffer);
+  iree_hal_command_buffer_t* target = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_dispatch_statistics_command_buffer_segment(
+      command_buffer, &target));
+  return iree_hal_command_buffer_signal_event(target, event, source_stage_mask);
+}
+
+static iree_status_t iree_hal_dispatch_statistics_command_buffer_reset_event(
+    iree_hal_command_buffer_t* base_command_buffer, iree_hal_event_t* event,
+    iree_hal_execution_stage_t source_stage_mask) {
+  iree_hal_dispatch_statistics_command_buffer_t* command_buffer =
+      iree_hal_dispatch_statistics_command_buffer_cast(base_command_buffer);
+  iree_hal_command_buffer_t* target = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_dispatch_statistics_command_buffer_segment(
+      command_buffer, &target));
+  return iree_hal_command_buffer_reset_event(target, event, source_stage_mask);
+}
+
+static iree_status_t iree_hal_dispatch_statistics_command_buffer_wait_events(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_host_size_t event_count, const iree_hal_event_t** events,
+    iree_hal_execution_stage_t source_stage_mask,
+    iree_hal_execution_stage_t target_stage_mask,
+    iree_host_size_t memory_barrier_count,
+    const iree_hal_memory_barrier_t* memory_barriers,
+    iree_host_size_t buffer_barrier_count,
+    const iree_hal_buffer_barrier_t* buffer_barriers) {
+  iree_hal_dispatch_statistics_command_buffer_t* command_buffer =
+      iree_hal_dispatch_statistics_command_buffer_cast(base_command_buffer);
+  iree_hal_command_buffer_t* target = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_dispatch_statistics_command_buffer_segment(
+      command_buffer, &target));
+  return iree_hal_command_buffer_wait_events(
+      target, event_count, events, source_stage_mask, target_stage_mask,
+      memory_barrier_count, memory_barriers, buffer_barrier_count,
+      buffer_barriers);
+}
+
+static iree_status_t iree_hal_dispatch_statistics_command_buffer_discard_buffer(
+    iree_hal_command_buffer_t* base_command_buffer, iree_hal_buffer_t* buffer) {
+  iree_hal_dispatch_statistics_command_buffer_t* command_buffer =
+      iree_hal_dispatch_statistics_command_buffer_cast(base_command_buffer);
+  iree_hal_command_buffer_t* target = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_dispatch_statistics_command_buffer_segment(
+      command_buffer, &target));
+  return iree_hal_command_buffer_discard_buffer(target, buffer);
+}
+
+static iree_status_t iree_hal_dispatch_statistics_command_buffer_fill_buffer(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_buffer_t* target_buffer, iree_device_size_t target_offset,
+    iree_device_size_t length, const void* pattern,
+    iree_host_size_t pattern_length) {
+  iree_hal_dispatch_statistics_command_buffer_t* command_buffer =
+      iree_hal_dispatch_statistics_command_buffer_cast(base_command_buffer);
+  iree_hal_command_buffer_t* target = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_dispatch_statistics_command_buffer_segment(
+      command_buffer, &target));
+  return iree_hal_command_buffer_fill_buffer(target, target_buffer,
+                                             target_offset, length, pattern,
+                                             pattern_length);
+}
+
+static iree_status_t iree_hal_dispatch_statistics_command_buffer_update_buffer(
+    iree_hal_command_buffer_t* base_command_buffer, const void* source_buffer,
+    iree_host_size_t source_offset, iree_hal_buffer_t* target_buffer,
+    iree_device_size_t target_offset, iree_device_size_t length) {
+  iree_hal_dispatch_statistics_command_buffer_t* command_buffer =
+      iree_hal_dispatch_statistics_command_buffer_cast(base_command_buffer);
+  iree_hal_command_buffer_t* target = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_dispatch_statistics_command_buffer_segment(
+      command_buffer, &target));
+  return iree_hal_command_buffer_update_buffer(
+      target, source_buffer, source_offset, target_buffer, target_offset,
+      length);
+}
+
+static iree_status_t iree_hal_dispatch_statistics_command_buffer_copy_buffer(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_buffer_t* source_buffer, iree_device_size_t source_offset,
+    iree_hal_buffer_t* target_buffer, iree_device_size_t target_offset,
+    iree_device_size_t length) {
+  iree_hal_dispatch_statistics_command_buffer_t* command_buffer =
+      iree_hal_dispatch_statistics_command_buffer_cast(base_command_buffer);
+  iree_hal_command_buffer_t* target = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_dispatch_statistics_command_buffer_segment(
+      command_buffer, &target));
+  return iree_hal_command_buffer_copy_buffer(target, source_buffer,
+                                             source_offset, target_buffer,
+                                             target_offset, length);
+}
+
+static iree_status_t iree_hal_dispatch_statistics_command_buffer_collective(
+    iree_hal_command_buffer_t* base_command_buffer, iree_hal_channel_t* channel,
+    iree_hal_collective_op_t op, uint32_t param,
+    iree_hal_buffer_binding_t send_binding,
+    iree_hal_buffer_binding_t recv_binding, iree_device_size_t element_count) {
+  iree_hal_dispatch_statistics_command_buffer_t* command_buffer =
+      iree_hal_dispatch_statistics_command_buffer_cast(base_command_buffer);
+  iree_hal_command_buffer_t* target = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_dispatch_statistics_command_buffer_segment(
+      command_buffer, &target));
+  return iree_hal_command_buffer_collective(target, channel, op, param,
+                                            send_binding, recv_binding,
+                                            element_count);
+}
+
+static iree_status_t iree_hal_dispatch_statistics_command_buffer_push_constants(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_pipeline_layout_t* pipeline_layout, iree_host_size_t offset,
+    const void* values, iree_host_size_t values_length) {
+  iree_hal_dispatch_statistics_command_buffer_t* command_buffer =
+      iree_hal_dispatch_statistics_command_buffer_cast(base_command_buffer);
+  if (offset + values_length > sizeof(command_buffer->constants)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "push constant range [%" PRIhsz ", %" PRIhsz
+                            ") exceeds the shadowed maximum of %" PRIhsz,
+                            offset, offset + values_length,
+                            sizeof(command_buffer->constants));
+  }
+  if (command_buffer->constants_layout != pipeline_layout) {
+    iree_hal_pipeline_layout_retain(pipeline_layout);
+    iree_hal_pipeline_layout_release(command_buffer->constants_layout);
+    command_buffer->constants_layout = pipeline_layout;
+  }
+  memcpy(command_buffer->constants + offset, values, values_length);
+  command_buffer->constants_length =
+      iree_max(command_buffer->constants_length, offset + values_length);
+
+  // Segments replay the shadow state when they start so only forward to an
+  // already open one.
+  if (!command_buffer->segment_open) return iree_ok_status();
+  iree_hal_command_buffer_t* target = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_dispatch_statistics_command_buffer_segment(
+      command_buffer, &target));
+  return iree_hal_command_buffer_push_constants(target, pipeline_layout, offset,
+                                                values, values_length);
+}
+
+static iree_status_t
+iree_hal_dispatch_statistics_command_buffer_push_descriptor_set(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_pipeline_layout_t* pipeline_layout, uint32_t set,
+    iree_host_size_t binding_count,
+    const iree_hal_descriptor_set_binding_t* bindings) {
+  iree_hal_dispatch_statistics_command_buffer_t* command_buffer =
+      iree_hal_dispatch_statistics_command_buffer_cast(base_command_buffer);
+  if (set >= IREE_ARRAYSIZE(command_buffer->sets) ||
+      binding_count > IREE_HAL_DISPATCH_STATISTICS_MAX_BINDING_COUNT) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "descriptor set %u with %" PRIhsz
+                            " bindings exceeds the shadowed maximum",
+                            set, binding_count);
+  }
+  iree_hal_dispatch_statistics_descriptor_set_t* shadow =
+      &command_buffer->sets[set];
+  iree_hal_pipeline_layout_retain(pipeline_layout);
+  for (iree_host_size_t i = 0; i < binding_count; ++i) {
+    iree_hal_buffer_retain(bindings[i].buffer);
+  }
+  for (iree_host_size_t i = 0; i < shadow->binding_count; ++i) {
+    iree_hal_buffer_release(shadow->bindings[i].buffer);
+  }
+  iree_hal_pipeline_layout_release(shadow->pipeline_layout);
+  shadow->pipeline_layout = pipeline_layout;
+  shadow->binding_count = binding_count;
+  memcpy(shadow->bindings, bindings, binding_count * sizeof(*bindings));
+
+  if (!command_buffer->segment_open) return iree_ok_status();
+  iree_hal_command_buffer_t* target = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_dispatch_statistics_command_buffer_segment(
+      command_buffer, &target));
+  return iree_hal_command_buffer_push_descriptor_set(
+      target, pipeline_layout, set, binding_count, bindings);
+}
+
+// Records the dispatch in the current segment and ends the segment.
+static iree_status_t iree_hal_dispatch_statistics_command_buffer_end_dispatch(
+    iree_hal_dispatch_statistics_command_buffer_t* command_buffer,
+    iree_hal_executable_t* executable, int32_t entry_point,
+    uint64_t workgroup_count) {
+  iree_hal_dispatch_statistics_segment_t* segment =
+      &command_buffer->segments[command_buffer->segment_count - 1];
+  segment->executable = executable;
+  segment->entry_point = entry_point;
+  segment->workgroup_count = workgroup_count;
+  return iree_hal_dispatch_statistics_command_buffer_end_segment(
+      command_buffer);
+}
+
+static iree_status_t iree_hal_dispatch_statistics_command_buffer_dispatch(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_executable_t* executable, int32_t entry_point,
+    uint32_t workgroup_x, uint32_t workgroup_y, uint32_t workgroup_z) {
+  iree_hal_dispatch_statistics_command_buffer_t* command_buffer =
+      iree_hal_dispatch_statistics_command_buffer_cast(base_command_buffer);
+  iree_hal_command_buffer_t* target = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_dispatch_statistics_command_buffer_segment(
+      command_buffer, &target));
+  IREE_RETURN_IF_ERROR(iree_hal_command_buffer_dispatch(
+      target, executable, entry_point, workgroup_x, workgroup_y, workgroup_z));
+  return iree_hal_dispatch_statistics_command_buffer_end_dispatch(
+      command_buffer, executable, entry_point,
+      (uint64_t)workgroup_x * workgroup_y * workgroup_z);
+}
+
+static iree_status_t
+iree_hal_dispatch_statistics_command_buffer_dispatch_indirect(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_executable_t* executable, int32_t entry_point,
+    iree_hal_buffer_t* workgroups_buffer,
+    iree_device_size_t workgroups_offset) {
+  iree_hal_dispatch_statistics_command_buffer_t* command_buffer =
+      iree_hal_dispatch_statistics_command_buffer_cast(base_command_buffer);
+  iree_hal_command_buffer_t* target = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_dispatch_statistics_command_buffer_segment(
+      command_buffer, &target));
+  IREE_RETURN_IF_ERROR(iree_hal_command_buffer_dispatch_indirect(
+      target, executable, entry_point, workgroups_buffer, workgroups_offset));
+  // Workgroup counts are not known until execution.
+  return iree_hal_dispatch_statistics_command_buffer_end_dispatch(
+      command_buffer, executable, entry_point, /*workgroup_count=*/0);
+}
+
+static iree_status_t
+iree_hal_dispatch_statistics_command_buffer_execute_commands(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_command_buffer_t* base_commands,
+    iree_hal_buffer_binding_table_t binding_table) {
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "nested command buffers are not supported when "
+                          "collecting dispatch statistics");
+}
+
+static const iree_hal_command_buffer_vtable_t
+    iree_hal_dispatch_statistics_command_buffer_vtable = {
+        .destroy = iree_hal_dispatch_statistics_command_buffer_destroy,
+        .dyn_cast = iree_hal_dispatch_statistics_command_buffer_dyn_cast,
+        .begin = iree_hal_dispatch_statistics_command_buffer_begin,
+        .end = iree_hal_dispatch_statistics_command_buffer_end,
+        .begin_debug_group =
+            iree_hal_dispatch_statistics_command_buffer_begin_debug_group,
+        .end_debug_group =
+            iree_hal_dispatch_statistics_command_buffer_end_debug_group,
+        .execution_barrier =
+            iree_hal_dispatch_statistics_command_buffer_execution_barrier,
+        .signal_event =
+            iree_hal_dispatch_statistics_command_buffer_signal_event,
+        .reset_event = iree_hal_dispatch_statistics_command_buffer_reset_event,
+        .wait_events = iree_hal_dispatch_statistics_command_buffer_wait_events,
+        .discard_buffer =
+            iree_hal_dispatch_statistics_command_buffer_discard_buffer,
+        .fill_buffer = iree_hal_dispatch_statistics_command_buffer_fill_buffer,
+        .update_buffer =
+            iree_hal_dispatch_statistics_command_buffer_update_buffer,
+        .copy_buffer = iree_hal_dispatch_statistics_command_buffer_copy_buffer,
+        .collective = iree_hal_dispatch_statistics_command_buffer_collective,
+        .push_constants =
+            iree_hal_dispatch_statistics_command_buffer_push_constants,
+        .push_descriptor_set =
+            iree_hal_dispatch_statistics_command_buffer_push_descriptor_set,
+        .dispatch = iree_hal_dispatch_statistics_command_buffer_dispatch,
+        .dispatch_indirect =
+            iree_hal_dispatch_statistics_command_buffer_dispatch_indirect,
+        .execute_commands =
+            iree_hal_dispatch_statistics_command_buffer_execute_commands,
+};
+
+//===----------------------------------------------------------------------===//
+// iree_hal_dispatch_statistics_device_t forwarding
+//===----------------------------------------------------------------------===//
+
+static iree_string_view_t iree_hal_dispatch_statistics_device_id(
+    iree_hal_device_t* base_device) {
+  iree_hal_dispatch_statistics_device_t* device =
+      iree_hal_dispatch_statistics_device_cast(base_device);
+  return iree_hal_device_id(device->base_device);
+}
+
+static iree_allocator_t iree_hal_dispatch_statistics_device_host_allocator(
+    iree_hal_device_t* base_device) {
+  iree_hal_dispatch_statistics_device_t* device =
+      iree_hal_dispatch_statistics_device_cast(base_device);
+  return device->host_allocator;
+}
+
+static iree_hal_allocator_t* iree_hal_dispatch_statistics_device_allocator(
+    iree_hal_device_t* base_device) {
+  iree_hal_dispatch_statistics_device_t* device =
+      iree_hal_dispatch_statistics_device_cast(base_device);
+  return iree_hal_device_allocator(device->base_device);
+}
+
+static void iree_hal_dispatch_statistics_replace_device_allocator(
+    iree_hal_device_t* base_device, iree_hal_allocator_t* new_allocator) {
+  iree_hal_dispatch_statistics_device_t* device =
+      iree_hal_dispatch_statistics_device_cast(base_device);
+  iree_hal_device_replace_allocator(device->base_device, new_allocator);
+}
+
+static iree_status_t iree_hal_dispatch_statistics_device_trim(
+    iree_hal_device_t* base_device) {
+  iree_hal_dispatch_statistics_device_t* device =
+      iree_hal_dispatch_statistics_device_cast(base_device);
+  return iree_hal_device_trim(device->base_device);
+}
+
+static iree_status_t iree_hal_dispatch_statistics_device_query_i64(
+    iree_hal_device_t* base_device, iree_string_view_t category,
+    iree_string_view_t key, int64_t* out_value) {
+  iree_hal_dispatch_statistics_device_t* device =
+      iree_hal_dispatch_statistics_device_cast(base_device);
+  return iree_hal_device_query_i64(device->base_device, category, key,
+                                   out_value);
+}
+
+static iree_status_t iree_hal_dispatch_statistics_device_create_channel(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    iree_hal_channel_params_t params, iree_hal_channel_t** out_channel) {
+  iree_hal_dispatch_statistics_device_t* device =
+      iree_hal_dispatch_statistics_device_cast(base_device);
+  return iree_hal_channel_create(device->base_device, queue_affinity, params,
+                                 out_channel);
+}
+
+static iree_status_t iree_hal_dispatch_statistics_device_create_command_buffer(
+    iree_hal_device_t* base_device, iree_hal_command_buffer_mode_t mode,
+    iree_hal_command_category_t command_categories,
+    iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
+    iree_hal_command_buffer_t** out_command_buffer) {
+  iree_hal_dispatch_statistics_device_t* device =
+      iree_hal_dispatch_statistics_device_cast(base_device);
+  return iree_hal_dispatch_statistics_command_buffer_create(
+      device, mode, command_categories, queue_affinity, binding_capacity,
+      out_command_buffer);
+}
+
+static iree_status_t
+iree_hal_dispatch_statistics_device_create_descriptor_set_layout(
+    iree_hal_device_t* base_device,
+    iree_hal_descriptor_set_layout_flags_t flags,
+    iree_host_size_t binding_count,
+    const iree_hal_descriptor_set_layout_binding_t* bindings,
+    iree_hal_descriptor_set_layout_t** out_descriptor_set_layout) {
+  iree_hal_dispatch_statistics_device_t* device =
+      iree_hal_dispatch_statistics_device_cast(base_device);
+  return iree_hal_descriptor_set_layout_create(device->base_device, flags,
+                                               binding_count, bindings,
+                                               out_descriptor_set_layout);
+}
+
+static iree_status_t iree_hal_dispatch_statistics_device_create_event(
+    iree_hal_device_t* base_device, iree_hal_event_t** out_event) {
+  iree_hal_dispatch_statistics_device_t* device =
+      iree_hal_dispatch_statistics_device_cast(base_device);
+  return iree_hal_event_create(device->base_device, out_event);
+}
+
+static iree_status_t
+iree_hal_dispatch_statistics_device_create_executable_cache(
+    iree_hal_device_t* base_device, iree_string_view_t identifier,
+    iree_loop_t loop, iree_hal_executable_cache_t** out_executable_cache) {
+  iree_hal_dispatch_statistics_device_t* device =
+      iree_hal_dispatch_statistics_device_cast(base_device);
+  iree_hal_executable_cache_t* base_cache = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_executable_cache_create(
+      device->base_device, identifier, loop, &base_cache));
+  iree_status_t status = iree_hal_dispatch_statistics_executable_cache_create(
+      device, base_cache, out_executable_cache);
+  iree_hal_executable_cache_release(base_cache);
+  return status;
+}
+
+static iree_status_t iree_hal_dispatch_statistics_device_create_pipeline_layout(
+    iree_hal_device_t* base_device, iree_host_size_t push_constants,
+    iree_host_size_t set_layout_count,
+    iree_hal_descriptor_set_layout_t* const* set_layouts,
+    iree_hal_pipeline_layout_t** out_pipeline_layout) {
+  iree_hal_dispatch_statistics_device_t* device =
+      iree_hal_dispatch_statistics_device_cast(base_device);
+  return iree_hal_pipeline_layout_create(device->base_device, push_constants,
+                                         set_layout_count, set_layouts,
+                                         out_pipeline_layout);
+}
+
+static iree_status_t iree_hal_dispatch_statistics_device_create_semaphore(
+    iree_hal_device_t* base_device, uint64_t initial_value,
+    iree_hal_semaphore_t** out_semaphore) {
+  iree_hal_dispatch_statistics_device_t* device =
+      iree_hal_dispatch_statistics_device_cast(base_device);
+  return iree_hal_semaphore_create(device->base_device, initial_value,
+                                   out_semaphore);
+}
+
+static iree_hal_semaphore_compatibility_t
+iree_hal_dispatch_statistics_device_query_semaphore_compatibility(
+    iree_hal_device_t* base_device, iree_hal_semaphore_t* semaphore) {
+  iree_hal_dispatch_statistics_device_t* device =
+      iree_hal_dispatch_statistics_device_cast(base_device);
+  return iree_hal_device_query_semaphore_compatibility(device->base_device,
+                                                       semaphore);
+}
+
+static iree_status_t iree_hal_dispatch_statistics_device_transfer_range(
+    iree_hal_device_t* base_device, iree_hal_transfer_buffer_t source,
+    iree_device_size_t source_offset, iree_hal_transfer_buffer_t target,
+    iree_device_size_t target_offset, iree_device_size_t data_length,
+    iree_hal_transfer_buffer_flags_t flags, iree_timeout_t timeout) {
+  iree_hal_dispatch_statistics_device_t* device =
+      iree_hal_dispatch_statistics_device_cast(base_device);
+  return iree_hal_device_transfer_range(device->base_device, source,
+                                        source_offset, target, target_offset,
+                                        data_length, flags, timeout);
+}
+
+static iree_status_t iree_hal_dispatch_statistics_device_queue_alloca(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_allocator_pool_t pool, iree_hal_buffer_params_t params,
+    iree_device_size_t allocation_size,
+    iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
+  iree_hal_dispatch_statistics_device_t* device =
+      iree_hal_dispatch_statistics_device_cast(base_device);
+  return iree_hal_device_queue_alloca(
+      device->base_device, queue_affinity, wait_semaphore_list,
+      signal_semaphore_list, pool, params, allocation_size, out_buffer);
+}
+
+static iree_status_t iree_hal_dispatch_statistics_device_queue_dealloca(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_buffer_t* buffer) {
+  iree_hal_dispatch_statistics_device_t* device =
+      iree_hal_dispatch_statistics_device_cast(base_device);
+  return iree_hal_device_queue_dealloca(device->base_device, queue_affinity,
+                                        wait_semaphore_list,
+                                        signal_semaphore_list, buffer);
+}
+
+// Submits |segment| to the base device and blocks until it completes.
+// Must be called with the submit mutex held.
+static iree_status_t iree_hal_dispatch_statistics_device_execute_segment(
+    iree_hal_dispatch_statistics_device_t* device,
+    iree_hal_queue_affinity_t queue_affinity,
+    iree_hal_dispatch_statistics_segment_t* segment) {
+  uint64_t signal_value = ++device->timeline_value;
+  iree_hal_semaphore_list_t signal_semaphore_list = {
+      .count = 1,
+      .semaphores = &device->timeline,
+      .payload_values = &signal_value,
+  };
+  iree_time_t start_ns = iree_time_now();
+  IREE_RETURN_IF_ERROR(iree_hal_device_queue_execute(
+      device->base_device, queue_affinity, iree_hal_semaphore_list_empty(),
+      signal_semaphore_list, 1, &segment->command_buffer));
+  IREE_RETURN_IF_ERROR(iree_hal_semaphore_wait(device->timeline, signal_value,
+                                               iree_infinite_timeout()));
+  iree_duration_t duration_ns = iree_time_now() - start_ns;
+  if (!segment->executable) return iree_ok_status();
+  return iree_hal_dispatch_statistics_device_record(
+      device, segment->executable, segment->entry_point,
+      segment->workgroup_count, duration_ns);
+}
+
+static iree_status_t iree_hal_dispatch_statistics_device_queue_execute(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_host_size_t command_buffer_count,
+    iree_hal_command_buffer_t* const* command_buffers) {
+  iree_hal_dispatch_statistics_device_t* device =
+      iree_hal_dispatch_statistics_device_cast(base_device);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Wait for dependencies outside of the submission lock so that a submission
+  // waiting on another thread's work can't deadlock it.
+  iree_status_t status = iree_hal_semaphore_list_wait(wait_semaphore_list,
+                                                      iree_infinite_timeout());
+
+  if (iree_status_is_ok(status)) {
+    iree_slim_mutex_lock(&device->submit_mutex);
+    for (iree_host_size_t i = 0;
+         i < command_buffer_count && iree_status_is_ok(status); ++i) {
+      iree_hal_dispatch_statistics_command_buffer_t* command_buffer =
+          (iree_hal_dispatch_statistics_command_buffer_t*)
+              iree_hal_command_buffer_dyn_cast(
+                  command_buffers[i],
+                  &iree_hal_dispatch_statistics_command_buffer_vtable);
+      if (!command_buffer) {
+        status = iree_make_status(
+            IREE_STATUS_INVALID_ARGUMENT,
+            "command buffer was not created from the statistics device");
+        break;
+      }
+      for (iree_host_size_t j = 0;
+           j < command_buffer->segment_count && iree_status_is_ok(status);
+           ++j) {
+        status = iree_hal_dispatch_statistics_device_execute_segment(
+            device, queue_affinity, &command_buffer->segments[j]);
+      }
+    }
+    iree_slim_mutex_unlock(&device->submit_mutex);
+  }
+
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_semaphore_list_signal(signal_semaphore_list);
+  } else {
+    iree_hal_semaphore_list_fail(signal_semaphore_list,
+                                 iree_status_clone(status));
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static iree_status_t iree_hal_dispatch_statistics_device_queue_flush(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity) {
+  iree_hal_dispatch_statistics_device_t* device =
+      iree_hal_dispatch_statistics_device_cast(base_device);
+  return iree_hal_device_queue_flush(device->base_device, queue_affinity);
+}
+
+static iree_status_t iree_hal_dispatch_statistics_device_wait_semaphores(
+    iree_hal_device_t* base_device, iree_hal_wait_mode_t wait_mode,
+    const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout) {
+  iree_hal_dispatch_statistics_device_t* device =
+      iree_hal_dispatch_statistics_device_cast(base_device);
+  return iree_hal_device_wait_semaphores(device->base_device, wait_mode,
+                                         semaphore_list, timeout);
+}
+
+static iree_status_t iree_hal_dispatch_statistics_device_profiling_begin(
+    iree_hal_device_t* base_device,
+    const iree_hal_device_profiling_options_t* options) {
+  iree_hal_dispatch_statistics_device_t* device =
+      iree_hal_dispatch_statistics_device_cast(base_device);
+  return iree_hal_device_profiling_begin(device->base_device, options);
+}
+
+static iree_status_t iree_hal_dispatch_statistics_device_profiling_end(
+    iree_hal_device_t* base_device) {
+  iree_hal_dispatch_statistics_device_t* device =
+      iree_hal_dispatch_statistics_device_cast(base_device);
+  return iree_hal_device_profiling_end(device->base_device);
+}
+
+static const iree_hal_device_vtable_t
+    iree_hal_dispatch_statistics_device_vtable = {
+        .destroy = iree_hal_dispatch_statistics_device_destroy,
+        .id = iree_hal_dispatch_statistics_device_id,
+        .host_allocator = iree_hal_dispatch_statistics_device_host_allocator,
+        .device_allocator = iree_hal_dispatch_statistics_device_allocator,
+        .replace_device_allocator =
+            iree_hal_dispatch_statistics_replace_device_allocator,
+        .trim = iree_hal_dispatch_statistics_device_trim,
+        .query_i64 = iree_hal_dispatch_statistics_device_query_i64,
+        .create_channel = iree_hal_dispatch_statistics_device_create_channel,
+        .create_command_buffer =
+            iree_hal_dispatch_statistics_device_create_command_buffer,
+        .create_descriptor_set_layout =
+            iree_hal_dispatch_statistics_device_create_descriptor_set_layout,
+        .create_event = iree_hal_dispatch_statistics_device_create_event,
+        .create_executable_cache =
+            iree_hal_dispatch_statistics_device_create_executable_cache,
+        .create_pipeline_layout =
+            iree_hal_dispatch_statistics_device_create_pipeline_layout,
+        .create_semaphore =
+            iree_hal_dispatch_statistics_device_create_semaphore,
+        .query_semaphore_compatibility =
+            iree_hal_dispatch_statistics_device_query_semaphore_compatibility,
+        .transfer_range = iree_hal_dispatch_statistics_device_transfer_range,
+        .queue_alloca = iree_hal_dispatch_statistics_device_queue_alloca,
+        .queue_dealloca = iree_hal_dispatch_statistics_device_queue_dealloca,
+        .queue_execute = iree_hal_dispatch_statistics_device_queue_execute,
+        .queue_flush = iree_hal_dispatch_statistics_device_queue_flush,
+        .wait_semaphores = iree_hal_dispatch_statistics_device_wait_semaphores,
+        .profiling_begin = iree_hal_dispatch_statistics_device_profiling_begin,
+        .profiling_end = iree_hal_dispatch_statistics_device_profiling_end,
+};
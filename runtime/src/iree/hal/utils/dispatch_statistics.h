@@ -0,0 +1,57 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_UTILS_DISPATCH_STATISTICS_H_
+#define IREE_HAL_UTILS_DISPATCH_STATISTICS_H_
+
+#include <stdio.h>
+
+#include "iree/base/api.h"
+#include "iree/hal/device.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Wraps |base_device| in a device that measures the time taken by each
+// dispatch submitted to it and accumulates the results per executable export.
+//
+// Command buffers created from the device are split into one segment per
+// dispatch (with push constants and descriptor sets re-recorded at the start
+// of each segment) and each queue_execute submits the segments to the base
+// device one at a time and waits for each to complete. The measured time is
+// the wall time between submitting a segment and observing its completion and
+// includes any submission overhead of the base device. Because execution is
+// serialized the numbers are useful for finding which dispatches dominate but
+// end-to-end latency will not be representative.
+//
+// Executables are identified by the order in which they were prepared on the
+// device (which matches the order the compiler declared them in when loaded
+// by the HAL module) and their format.
+//
+// Debug groups are dropped and command buffers containing nested command
+// buffers (execute_commands) are not supported.
+//
+// Thread-safe: submissions are serialized internally.
+IREE_API_EXPORT iree_status_t iree_hal_dispatch_statistics_device_create(
+    iree_hal_device_t* base_device, iree_allocator_t host_allocator,
+    iree_hal_device_t** out_device);
+
+// Returns true if |device| was created by
+// iree_hal_dispatch_statistics_device_create.
+IREE_API_EXPORT bool iree_hal_dispatch_statistics_device_isa(
+    iree_hal_device_t* device);
+
+// Prints a table of all dispatch statistics accumulated by |device| to |file|
+// sorted by total time spent in each executable export.
+IREE_API_EXPORT iree_status_t iree_hal_dispatch_statistics_device_fprint(
+    FILE* file, iree_hal_device_t* device);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_UTILS_DISPATCH_STATISTICS_H_
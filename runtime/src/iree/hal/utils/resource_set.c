@@ -6,8 +6,15 @@
 
 #include "iree/hal/utils/resource_set.h"
 
+#include "iree/base/internal/math.h"
 #include "iree/base/tracing.h"
 
+#if defined(IREE_ARCH_X86_64)
+#include <emmintrin.h>
+#elif defined(IREE_ARCH_ARM_64)
+#include <arm_neon.h>
+#endif  // IREE_ARCH_*
+
 // Inlines the first chunk into the block using all of the remaining space.
 // This is a special case chunk that is released back to the pool with the
 // resource set and lets us avoid an additional allocation.
@@ -28,6 +35,13 @@ static void iree_hal_resource_set_setup_inline_chunk(
 
 IREE_API_EXPORT iree_status_t iree_hal_resource_set_allocate(
     iree_arena_block_pool_t* block_pool, iree_hal_resource_set_t** out_set) {
+  return iree_hal_resource_set_allocate_with_flags(
+      block_pool, IREE_HAL_RESOURCE_SET_FLAG_NONE, out_set);
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_resource_set_allocate_with_flags(
+    iree_arena_block_pool_t* block_pool, iree_hal_resource_set_flags_t flags,
+    iree_hal_resource_set_t** out_set) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
   // We could allow larger sizes (would require widening the capacity/count
@@ -41,8 +55,9 @@ IREE_API_EXPORT iree_status_t iree_hal_resource_set_allocate(
       z0, iree_arena_block_pool_acquire(block_pool, &block));
   uint8_t* block_ptr = (uint8_t*)block - block_pool->usable_block_size;
   iree_hal_resource_set_t* set = (iree_hal_resource_set_t*)block_ptr;
-  memset(set, 0, sizeof(*set));
+  memset(set->mru, 0, sizeof(set->mru));
   set->block_pool = block_pool;
+  set->flags = flags;
   iree_hal_resource_set_setup_inline_chunk(set);
 
   *out_set = set;
@@ -107,34 +122,156 @@ IREE_API_EXPORT void iree_hal_resource_set_free(iree_hal_resource_set_t* set) {
   IREE_TRACE_ZONE_END(z0);
 }
 
+// Acquires a new chunk from the block pool and links it into the |set| list.
+static iree_status_t iree_hal_resource_set_grow(iree_hal_resource_set_t* set) {
+  iree_arena_block_t* block = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_block_pool_acquire(set->block_pool, &block));
+  iree_hal_resource_set_chunk_t* chunk =
+      (iree_hal_resource_set_chunk_t*)((uint8_t*)block -
+                                       set->block_pool->usable_block_size);
+  chunk->next_chunk = set->chunk_head;
+  set->chunk_head = chunk;
+  chunk->capacity = (set->block_pool->total_block_size - sizeof(*chunk)) /
+                    sizeof(iree_hal_resource_t*);
+  chunk->capacity =
+      iree_min(chunk->capacity, IREE_HAL_RESOURCE_SET_CHUNK_MAX_CAPACITY);
+  chunk->count = 0;
+  return iree_ok_status();
+}
+
 // Retains |resource| and adds it to the main |set| list.
 static iree_status_t iree_hal_resource_set_insert_retain(
     iree_hal_resource_set_t* set, iree_hal_resource_t* resource) {
-  iree_hal_resource_set_chunk_t* chunk = set->chunk_head;
-  if (IREE_UNLIKELY(chunk->count + 1 > chunk->capacity)) {
+  if (IREE_UNLIKELY(set->chunk_head->count + 1 > set->chunk_head->capacity)) {
     // Ran out of room in the current chunk - acquire a new one and link it into
     // the list of chunks.
-    iree_arena_block_t* block = NULL;
-    IREE_RETURN_IF_ERROR(
-        iree_arena_block_pool_acquire(set->block_pool, &block));
-    chunk =
-        (iree_hal_resource_set_chunk_t*)((uint8_t*)block -
-                                         set->block_pool->usable_block_size);
-    chunk->next_chunk = set->chunk_head;
-    set->chunk_head = chunk;
-    chunk->capacity = (set->block_pool->total_block_size - sizeof(*chunk)) /
-                      sizeof(iree_hal_resource_t*);
-    chunk->capacity =
-        iree_min(chunk->capacity, IREE_HAL_RESOURCE_SET_CHUNK_MAX_CAPACITY);
-    chunk->count = 0;
+    IREE_RETURN_IF_ERROR(iree_hal_resource_set_grow(set));
   }
 
   // Retain and insert into the chunk.
+  iree_hal_resource_set_chunk_t* chunk = set->chunk_head;
   chunk->resources[chunk->count++] = resource;
   iree_hal_resource_retain(resource);
   return iree_ok_status();
 }
 
+//===----------------------------------------------------------------------===//
+// MRU SIMD utilities
+//===----------------------------------------------------------------------===//
+
+// On 64-bit x86 and ARM the MRU is a single cache line of 8 pointers that we
+// load into 4 128-bit registers holding 2 pointers each. Both the scan and the
+// reordering happen in registers and the MRU is stored back with the same
+// 128-bit stores it is loaded with so that subsequent insertions can forward
+// from the store buffer instead of stalling on partially overlapping writes.
+#if defined(IREE_ARCH_X86_64) || defined(IREE_ARCH_ARM_64)
+#define IREE_HAL_RESOURCE_SET_MRU_SIMD 1
+static_assert(sizeof(uintptr_t) == sizeof(uint64_t), "expect 64-bit pointers");
+static_assert(IREE_HAL_RESOURCE_SET_MRU_SIZE == 8,
+              "MRU is expected to fit in 4 registers");
+#endif  // IREE_ARCH_X86_64 || IREE_ARCH_ARM_64
+
+#if defined(IREE_ARCH_X86_64)
+
+typedef __m128i iree_hal_resource_set_mru_vec_t;
+
+static inline iree_hal_resource_set_mru_vec_t iree_hal_resource_set_mru_splat(
+    const iree_hal_resource_t* resource) {
+  return _mm_set1_epi64x((long long)(uintptr_t)resource);
+}
+
+static inline iree_hal_resource_set_mru_vec_t iree_hal_resource_set_mru_load(
+    iree_hal_resource_t* const* ptr) {
+  return _mm_loadu_si128((const __m128i*)ptr);
+}
+
+static inline void iree_hal_resource_set_mru_store(
+    iree_hal_resource_t** ptr, iree_hal_resource_set_mru_vec_t value) {
+  _mm_storeu_si128((__m128i*)ptr, value);
+}
+
+// Returns a 2-bit mask of the lanes in |value| equal to those in |needle|.
+static inline uint32_t iree_hal_resource_set_mru_compare(
+    iree_hal_resource_set_mru_vec_t value,
+    iree_hal_resource_set_mru_vec_t needle) {
+  // SSE2 has no 64-bit compare so we compare 32-bit halves and AND each half
+  // with its swapped neighbor so that a lane is all 1s only if both match.
+  __m128i eq = _mm_cmpeq_epi32(value, needle);
+  eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+  return (uint32_t)_mm_movemask_pd(_mm_castsi128_pd(eq));
+}
+
+// Returns {prev[1], value[0]}: the register shifted down by one entry.
+static inline iree_hal_resource_set_mru_vec_t iree_hal_resource_set_mru_shift(
+    iree_hal_resource_set_mru_vec_t prev,
+    iree_hal_resource_set_mru_vec_t value) {
+  return _mm_castpd_si128(
+      _mm_shuffle_pd(_mm_castsi128_pd(prev), _mm_castsi128_pd(value), 1));
+}
+
+// Selects |shifted| lanes for MRU indices <= |limit| and |value| otherwise.
+// |base| is the MRU index of lane 0.
+static inline iree_hal_resource_set_mru_vec_t iree_hal_resource_set_mru_select(
+    iree_hal_resource_set_mru_vec_t value,
+    iree_hal_resource_set_mru_vec_t shifted, int base, int limit) {
+  const __m128i keep = _mm_cmpgt_epi32(
+      _mm_set_epi32(base + 1, base + 1, base, base), _mm_set1_epi32(limit));
+  return _mm_or_si128(_mm_and_si128(keep, value),
+                      _mm_andnot_si128(keep, shifted));
+}
+
+#elif defined(IREE_ARCH_ARM_64)
+
+typedef uint64x2_t iree_hal_resource_set_mru_vec_t;
+
+static inline iree_hal_resource_set_mru_vec_t iree_hal_resource_set_mru_splat(
+    const iree_hal_resource_t* resource) {
+  return vdupq_n_u64((uint64_t)(uintptr_t)resource);
+}
+
+static inline iree_hal_resource_set_mru_vec_t iree_hal_resource_set_mru_load(
+    iree_hal_resource_t* const* ptr) {
+  return vld1q_u64((const uint64_t*)ptr);
+}
+
+static inline void iree_hal_resource_set_mru_store(
+    iree_hal_resource_t** ptr, iree_hal_resource_set_mru_vec_t value) {
+  vst1q_u64((uint64_t*)ptr, value);
+}
+
+// Returns a 2-bit mask of the lanes in |value| equal to those in |needle|.
+static inline uint32_t iree_hal_resource_set_mru_compare(
+    iree_hal_resource_set_mru_vec_t value,
+    iree_hal_resource_set_mru_vec_t needle) {
+  const uint64x2_t eq = vceqq_u64(value, needle);
+  return (uint32_t)(vgetq_lane_u64(eq, 0) & 1) |
+         (uint32_t)(vgetq_lane_u64(eq, 1) & 2);
+}
+
+// Returns {prev[1], value[0]}: the register shifted down by one entry.
+static inline iree_hal_resource_set_mru_vec_t iree_hal_resource_set_mru_shift(
+    iree_hal_resource_set_mru_vec_t prev,
+    iree_hal_resource_set_mru_vec_t value) {
+  return vextq_u64(prev, value, 1);
+}
+
+// Selects |shifted| lanes for MRU indices <= |limit| and |value| otherwise.
+// |base| is the MRU index of lane 0.
+static inline iree_hal_resource_set_mru_vec_t iree_hal_resource_set_mru_select(
+    iree_hal_resource_set_mru_vec_t value,
+    iree_hal_resource_set_mru_vec_t shifted, int base, int limit) {
+  const uint64x2_t lanes =
+      vcombine_u64(vdup_n_u64((uint64_t)base), vdup_n_u64((uint64_t)base + 1));
+  const uint64x2_t keep = vcgtq_u64(lanes, vdupq_n_u64((uint64_t)limit));
+  return vbslq_u64(keep, value, shifted);
+}
+
+#endif  // IREE_ARCH_*
+
+//===----------------------------------------------------------------------===//
+// Insertion
+//===----------------------------------------------------------------------===//
+
 // Scans the lookaside for the resource pointer and updates the order if found.
 // If the resource was not found then it will be inserted into the main list as
 // well as the MRU.
@@ -173,62 +310,82 @@ static iree_status_t iree_hal_resource_set_insert_retain(
 //     +----+----+----+----+
 //   insert resource into main list
 //
-// The intent here is that we can model this behavior with SIMD ops to perform
-// both the scan and update using comparison, extraction, and permutation. The
-// best and worst case flows will load the entire MRU into registers from a
-// single cache line, do all the scanning and shifting in registers, and then
-// store back to the single cache line.
-//
-// Today, though, we leave this as an exercise to whoever comes across this :)
-// Notes:
-//   As the MRU is a fixed size we can unroll it entirely and avoid any looping.
-//   On a 32-bit system with uint32x4_t we only need 4 registers.
-//   On a 64-bit system with uint64x2_t we also only need 4 registers - though
-//   the MRU has half as many entries and we may want to go >1 cache line.
-//
-//   If we wanted to process more than one resource at a time we can specialize
-//   the code paths to handle 1/2/4/etc resources and process in batches with
-//   an optional remainder. This would increase the ratio of work performed on
-//   the loaded MRU registers before we do the shift/store.
-//
-//   The tree sequence we likely want is something like:
-//    https://developer.arm.com/architectures/instruction-sets/intrinsics/vdupq_n_u32
-//    https://developer.arm.com/architectures/instruction-sets/intrinsics/vceqq_u32
-//    https://developer.arm.com/architectures/instruction-sets/intrinsics/vorrq_u32
-//    https://developer.arm.com/architectures/instruction-sets/intrinsics/vmaxvq_u32
-//    or
-//    https://developer.arm.com/architectures/instruction-sets/intrinsics/vdupq_n_u64
-//    https://developer.arm.com/architectures/instruction-sets/intrinsics/vceqq_u64
-//    https://developer.arm.com/architectures/instruction-sets/intrinsics/vorrq_u64
-//    https://developer.arm.com/architectures/instruction-sets/intrinsics/vreinterpretq_u64_u32
-//    https://developer.arm.com/architectures/instruction-sets/intrinsics/vmaxvq_u32
-//   This would yield whether the pointer was found, but instead of maxing at
-//   the end we can use the produced mask to extract out a single register with
-//   which positions are hits and use that to then permute the registers into
-//   the proper order. At the end we could use a table instruction to remap and
-//   extract out a byte/bitmap of the indices that we need to insert into the
-//   main set.
-//
-//   The shifting can be performed with
-//    https://developer.arm.com/architectures/instruction-sets/intrinsics/vextq_u32
-//    https://developer.arm.com/architectures/instruction-sets/intrinsics/vextq_u64
-//   This takes n low elements of LHS and rest from RHS and we can cascade them
-//   to shift down the whole MRU.
-//
-//   We can use SIMDE as a rosetta stone for getting neon/avx/wasm/etc:
-//   https://github.com/simd-everywhere/simde/blob/master/simde/arm/neon/ceq.h#L591
-static iree_status_t iree_hal_resource_set_insert_1(
+// On architectures with SIMD support the scan and both the hit and miss
+// shuffles are performed entirely in registers: we compare all entries at once
+// to produce a hit mask, compute the MRU shifted down by one entry, and select
+// the shifted entries up to and including the hit index (or all entries on a
+// miss) before storing it back. No loops or branches depend on the position of
+// the resource within the MRU.
+static iree_status_t iree_hal_resource_set_insert_1_slow(
     iree_hal_resource_set_t* set, iree_hal_resource_t* resource) {
+  // The caller has guaranteed the lifetime of all resources. Unretained sets
+  // never populate the MRU and all insertions end up here; keeping the check
+  // off the fast path avoids touching the flags on a separate cache line.
+  if (iree_all_bits_set(set->flags, IREE_HAL_RESOURCE_SET_FLAG_UNRETAINED)) {
+    return iree_ok_status();
+  }
+
+#if defined(IREE_HAL_RESOURCE_SET_MRU_SIMD)
   // Scan and hope for a hit.
-  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(set->mru); ++i) {
+  const iree_hal_resource_set_mru_vec_t needle =
+      iree_hal_resource_set_mru_splat(resource);
+  const iree_hal_resource_set_mru_vec_t v0 =
+      iree_hal_resource_set_mru_load(&set->mru[0]);
+  const iree_hal_resource_set_mru_vec_t v1 =
+      iree_hal_resource_set_mru_load(&set->mru[2]);
+  const iree_hal_resource_set_mru_vec_t v2 =
+      iree_hal_resource_set_mru_load(&set->mru[4]);
+  const iree_hal_resource_set_mru_vec_t v3 =
+      iree_hal_resource_set_mru_load(&set->mru[6]);
+  const uint32_t hit_mask = iree_hal_resource_set_mru_compare(v0, needle) |
+                            iree_hal_resource_set_mru_compare(v1, needle) << 2 |
+                            iree_hal_resource_set_mru_compare(v2, needle) << 4 |
+                            iree_hal_resource_set_mru_compare(v3, needle) << 6;
+
+  // Compute the MRU shifted down by one with the resource at the head.
+  const iree_hal_resource_set_mru_vec_t s0 =
+      iree_hal_resource_set_mru_shift(needle, v0);
+  const iree_hal_resource_set_mru_vec_t s1 =
+      iree_hal_resource_set_mru_shift(v0, v1);
+  const iree_hal_resource_set_mru_vec_t s2 =
+      iree_hal_resource_set_mru_shift(v1, v2);
+  const iree_hal_resource_set_mru_vec_t s3 =
+      iree_hal_resource_set_mru_shift(v2, v3);
+
+  if (IREE_LIKELY(hit_mask)) {
+    // Hit - keep the list sorted by most->least recently used.
+    // Only the entries more recently used than the hit are shifted down.
+    const int limit = iree_math_count_trailing_zeros_u32(hit_mask);
+    iree_hal_resource_set_mru_store(
+        &set->mru[0], iree_hal_resource_set_mru_select(v0, s0, 0, limit));
+    iree_hal_resource_set_mru_store(
+        &set->mru[2], iree_hal_resource_set_mru_select(v1, s1, 2, limit));
+    iree_hal_resource_set_mru_store(
+        &set->mru[4], iree_hal_resource_set_mru_select(v2, s2, 4, limit));
+    iree_hal_resource_set_mru_store(
+        &set->mru[6], iree_hal_resource_set_mru_select(v3, s3, 6, limit));
+    return iree_ok_status();
+  }
+
+  // Miss - insert into the main list (slow path).
+  // Note that we do this before updating the MRU in case allocation fails - we
+  // don't want to keep the pointer around unless we've really retained it.
+  IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert_retain(set, resource));
+
+  // Shift the entire MRU down, dropping the least recently used entry.
+  iree_hal_resource_set_mru_store(&set->mru[0], s0);
+  iree_hal_resource_set_mru_store(&set->mru[2], s1);
+  iree_hal_resource_set_mru_store(&set->mru[4], s2);
+  iree_hal_resource_set_mru_store(&set->mru[6], s3);
+#else
+  // Scan and hope for a hit.
+  for (iree_host_size_t i = 1; i < IREE_ARRAYSIZE(set->mru); ++i) {
     if (set->mru[i] != resource) continue;
     // Hit - keep the list sorted by most->least recently used.
     // We shift the MRU down to make room at index 0 and store the
     // resource there.
-    if (i > 0) {
-      memmove(&set->mru[1], &set->mru[0], sizeof(set->mru[0]) * i);
-      set->mru[0] = resource;
-    }
+    memmove(&set->mru[1], &set->mru[0], sizeof(set->mru[0]) * i);
+    set->mru[0] = resource;
     return iree_ok_status();
   }
 
@@ -241,18 +398,23 @@ static iree_status_t iree_hal_resource_set_insert_1(
   memmove(&set->mru[1], &set->mru[0],
           sizeof(set->mru[0]) * (IREE_ARRAYSIZE(set->mru) - 1));
   set->mru[0] = resource;
+#endif  // IREE_HAL_RESOURCE_SET_MRU_SIMD
 
   return iree_ok_status();
 }
 
+static inline IREE_ATTRIBUTE_ALWAYS_INLINE iree_status_t
+iree_hal_resource_set_insert_1(iree_hal_resource_set_t* set,
+                               iree_hal_resource_t* resource) {
+  // Repeated insertion of the most recently used resource (such as the same
+  // executable across dispatches) is extremely common and needs no reordering.
+  if (IREE_LIKELY(set->mru[0] == resource)) return iree_ok_status();
+  return iree_hal_resource_set_insert_1_slow(set, resource);
+}
+
 IREE_API_EXPORT iree_status_t
 iree_hal_resource_set_insert(iree_hal_resource_set_t* set,
                              iree_host_size_t count, const void* resources) {
-  // For now we process one at a time. We should have a stride that lets us
-  // amortize the cost of doing the MRU update and insertion allocation by
-  // say slicing off 4/8/16/32 resources at a time etc. Today each miss that
-  // requires a full insertion goes down the whole path of checking chunk
-  // capacity and such.
   iree_hal_resource_t* const* typed_resources =
       (iree_hal_resource_t* const*)resources;
   for (iree_host_size_t i = 0; i < count; ++i) {
@@ -261,3 +423,16 @@ iree_hal_resource_set_insert(iree_hal_resource_set_t* set,
   }
   return iree_ok_status();
 }
+
+IREE_API_EXPORT iree_status_t iree_hal_resource_set_insert_strided(
+    iree_hal_resource_set_t* set, iree_host_size_t count, const void* base,
+    iree_host_size_t stride) {
+
+  const uint8_t* ptr = (const uint8_t*)base;
+  for (iree_host_size_t i = 0; i < count; ++i, ptr += stride) {
+    iree_hal_resource_t* resource = *(iree_hal_resource_t* const*)ptr;
+    if (!resource) continue;
+    IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert_1(set, resource));
+  }
+  return iree_ok_status();
+}
@@ -51,6 +51,18 @@ typedef struct iree_hal_resource_set_chunk_t {
   (((chunk)->flags & IREE_HAL_RESOURCE_SET_CHUNK_FLAG_INLINE) == \
    IREE_HAL_RESOURCE_SET_CHUNK_FLAG_INLINE)
 
+// Controls resource set behavior.
+enum iree_hal_resource_set_flag_bits_t {
+  IREE_HAL_RESOURCE_SET_FLAG_NONE = 0u,
+
+  // Resources inserted into the set are not retained. The caller guarantees
+  // that all resources outlive the set (such as when the program holds them
+  // for the lifetime of a one-shot command buffer) and insertions become
+  // no-ops. This avoids all MRU maintenance and ref counting overhead.
+  IREE_HAL_RESOURCE_SET_FLAG_UNRETAINED = 1u << 0,
+};
+typedef uint32_t iree_hal_resource_set_flags_t;
+
 // Number of elements in the most-recently-used resource list of a set.
 // The larger the number the greater the chance of having a hit but the more
 // expensive every miss will be.
@@ -111,6 +123,9 @@ typedef struct iree_hal_resource_set_t {
 
   // Linked list of storage chunks.
   iree_hal_resource_set_chunk_t* chunk_head;
+
+  // Flags controlling set behavior.
+  iree_hal_resource_set_flags_t flags;
 } iree_hal_resource_set_t;
 
 // TODO(benvanik): add an allocation method that allows for placement; in many
@@ -122,6 +137,12 @@ typedef struct iree_hal_resource_set_t {
 IREE_API_EXPORT iree_status_t iree_hal_resource_set_allocate(
     iree_arena_block_pool_t* block_pool, iree_hal_resource_set_t** out_set);
 
+// Allocates a new resource set from the given |block_pool| with |flags|.
+// See iree_hal_resource_set_flag_bits_t for the available behaviors.
+IREE_API_EXPORT iree_status_t iree_hal_resource_set_allocate_with_flags(
+    iree_arena_block_pool_t* block_pool, iree_hal_resource_set_flags_t flags,
+    iree_hal_resource_set_t** out_set);
+
 // Frees a resource set and releases all inserted resources.
 // The |set| itself will be returned back to the block pool it was allocated
 // from.
@@ -133,6 +154,15 @@ IREE_API_EXPORT iree_status_t
 iree_hal_resource_set_insert(iree_hal_resource_set_t* set,
                              iree_host_size_t count, const void* resources);
 
+// Inserts zero or more resources into the set from a strided array.
+// The resource pointer of element i is read from |base| + i * |stride| bytes
+// which allows inserting resources directly from arrays of structs such as
+// iree_hal_descriptor_set_binding_t without first gathering them. NULL
+// resources are ignored.
+IREE_API_EXPORT iree_status_t iree_hal_resource_set_insert_strided(
+    iree_hal_resource_set_t* set, iree_host_size_t count, const void* base,
+    iree_host_size_t stride);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -252,6 +252,61 @@ TEST_F(ResourceSetTest, RedundantInsertion) {
   EXPECT_EQ(live_bitmap, 0u);
 }
 
+// Tests inserting resources from a strided array of structs.
+TEST_F(ResourceSetTest, InsertStrided) {
+  auto resource_set = make_resource_set(&block_pool);
+
+  struct binding_t {
+    uint32_t ordinal;
+    iree_hal_resource_t* resource;
+    uint64_t offset;
+  } bindings[5] = {};
+  uint32_t live_bitmap = 0u;
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(bindings); ++i) {
+    bindings[i].ordinal = (uint32_t)i;
+    // Leave one binding empty; NULL resources are skipped.
+    if (i == 2) continue;
+    IREE_ASSERT_OK(iree_hal_test_resource_create(
+        i, &live_bitmap, host_allocator, &bindings[i].resource));
+  }
+  EXPECT_EQ(live_bitmap, 0x1Bu);
+
+  // Transfer ownership of the resources to the set.
+  IREE_ASSERT_OK(iree_hal_resource_set_insert_strided(
+      resource_set.get(), IREE_ARRAYSIZE(bindings), &bindings[0].resource,
+      sizeof(bindings[0])));
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(bindings); ++i) {
+    iree_hal_resource_release(bindings[i].resource);
+  }
+  EXPECT_EQ(live_bitmap, 0x1Bu);
+  EXPECT_EQ(resource_set->mru[0], bindings[4].resource);
+  EXPECT_EQ(resource_set->mru[1], bindings[3].resource);
+  EXPECT_EQ(resource_set->mru[2], bindings[1].resource);
+
+  // Ensure the set releases the resources.
+  resource_set.reset();
+  EXPECT_EQ(live_bitmap, 0u);
+}
+
+// Tests that unretained sets do not take references.
+TEST_F(ResourceSetTest, Unretained) {
+  iree_hal_resource_set_t* set = NULL;
+  IREE_ASSERT_OK(iree_hal_resource_set_allocate_with_flags(
+      &block_pool, IREE_HAL_RESOURCE_SET_FLAG_UNRETAINED, &set));
+
+  iree_hal_resource_t* resource = NULL;
+  uint32_t live_bitmap = 0u;
+  IREE_ASSERT_OK(iree_hal_test_resource_create(0, &live_bitmap, host_allocator,
+                                               &resource));
+  IREE_ASSERT_OK(iree_hal_resource_set_insert(set, 1, &resource));
+
+  // The caller owns the only reference.
+  iree_hal_resource_release(resource);
+  EXPECT_EQ(live_bitmap, 0u);
+
+  iree_hal_resource_set_free(set);
+}
+
 }  // namespace
 }  // namespace hal
 }  // namespace iree
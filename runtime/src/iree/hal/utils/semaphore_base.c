@@ -20,21 +20,42 @@ static inline bool iree_hal_semaphore_timepoint_list_is_empty(
   return list->head == NULL;
 }
 
-// Pushes |timepoint| on to the end of the given timepoint |list|.
-static void iree_hal_semaphore_timepoint_list_push_back(
+// Inserts |timepoint| into the value-ordered |list| after all timepoints with
+// a lesser or equal minimum value. The insertion point is searched for from
+// both ends at once: new timepoints are usually either beyond all pending
+// values (another step in a pipeline) or before all of them (a near-term wait
+// among long-lived waiters) and both are found in constant time.
+static void iree_hal_semaphore_timepoint_list_insert(
     iree_hal_semaphore_timepoint_list_t* list,
     iree_hal_semaphore_timepoint_t* timepoint) {
-  if (list->tail) {
-    list->tail->next = timepoint;
+  const uint64_t value = timepoint->minimum_value;
+  iree_hal_semaphore_timepoint_t* prev = list->tail;
+  iree_hal_semaphore_timepoint_t* next = list->head;
+  while (prev && prev->minimum_value > value) {
+    if (next->minimum_value > value) {
+      // |next| is the first timepoint beyond the value.
+      prev = next->prev;
+      break;
+    }
+    prev = prev->prev;
+    next = next->next;
+  }
+  next = prev ? prev->next : list->head;
+  timepoint->prev = prev;
+  timepoint->next = next;
+  if (prev) {
+    prev->next = timepoint;
   } else {
     list->head = timepoint;
   }
-  timepoint->next = NULL;
-  timepoint->prev = list->tail;
-  list->tail = timepoint;
+  if (next) {
+    next->prev = timepoint;
+  } else {
+    list->tail = timepoint;
+  }
 }
 
-// Erases |timepoint| from |list|.
+// Erases |timepoint| from the value-ordered |list|.
 static void iree_hal_semaphore_timepoint_list_erase(
     iree_hal_semaphore_timepoint_list_t* list,
     iree_hal_semaphore_timepoint_t* timepoint) {
@@ -54,59 +75,160 @@ static void iree_hal_semaphore_timepoint_list_erase(
   }
 }
 
-// Takes all timepoints from |available_list| and moves them into |ready_list|.
-static void iree_hal_semaphore_timepoint_list_take_all(
-    iree_hal_semaphore_timepoint_list_t* available_list,
-    iree_hal_semaphore_timepoint_list_t* ready_list) {
-  IREE_ASSERT(available_list != ready_list);
-  ready_list->head = available_list->head;
-  ready_list->tail = available_list->tail;
-  available_list->head = NULL;
-  available_list->tail = NULL;
+// Inserts |timepoint| into the deadline-ordered |list| after all timepoints
+// with a lesser or equal deadline. Like the value-ordered insertion the
+// insertion point is searched for from both ends at once.
+static void iree_hal_semaphore_deadline_list_insert(
+    iree_hal_semaphore_timepoint_list_t* list,
+    iree_hal_semaphore_timepoint_t* timepoint) {
+  const iree_time_t deadline_ns = timepoint->deadline_ns;
+  iree_hal_semaphore_timepoint_t* prev = list->tail;
+  iree_hal_semaphore_timepoint_t* next = list->head;
+  while (prev && prev->deadline_ns > deadline_ns) {
+    if (next->deadline_ns > deadline_ns) {
+      // |next| is the first timepoint beyond the deadline.
+      prev = next->deadline_prev;
+      break;
+    }
+    prev = prev->deadline_prev;
+    next = next->deadline_next;
+  }
+  next = prev ? prev->deadline_next : list->head;
+  timepoint->deadline_prev = prev;
+  timepoint->deadline_next = next;
+  if (prev) {
+    prev->deadline_next = timepoint;
+  } else {
+    list->head = timepoint;
+  }
+  if (next) {
+    next->deadline_prev = timepoint;
+  } else {
+    list->tail = timepoint;
+  }
 }
 
-// Issues the callback for the given |timepoint| and resets it.
-static void iree_hal_semaphore_issue_timepoint_callback(
-    iree_hal_semaphore_t* semaphore, uint64_t new_value,
-    iree_status_code_t new_status_code,
+// Erases |timepoint| from the deadline-ordered |list|.
+static void iree_hal_semaphore_deadline_list_erase(
+    iree_hal_semaphore_timepoint_list_t* list,
     iree_hal_semaphore_timepoint_t* timepoint) {
-  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_semaphore_timepoint_t* next = timepoint->deadline_next;
+  iree_hal_semaphore_timepoint_t* prev = timepoint->deadline_prev;
+  if (prev) {
+    prev->deadline_next = next;
+    timepoint->deadline_prev = NULL;
+  } else {
+    list->head = next;
+  }
+  if (next) {
+    next->deadline_prev = prev;
+    timepoint->deadline_next = NULL;
+  } else {
+    list->tail = prev;
+  }
+}
 
-  // Clean up the timepoint.
-  // We do this before the callback so that the handler can reuse the
-  // timepoint storage if it wants. After this we can't rely on it being
-  // valid.
-  iree_hal_semaphore_callback_t callback = timepoint->callback;
+// Maximum number of timepoints resolved under a single lock acquisition.
+// Callbacks are copied out of the timepoints into a stack batch of this size
+// and issued after the lock has been released.
+#define IREE_HAL_SEMAPHORE_NOTIFY_BATCH_CAPACITY 32
+
+// A batch of timepoint callbacks to issue outside of the timepoint lock.
+typedef struct iree_hal_semaphore_notify_batch_t {
+  iree_host_size_t count;
+  struct {
+    iree_hal_semaphore_callback_t callback;
+    iree_status_code_t status_code;
+  } entries[IREE_HAL_SEMAPHORE_NOTIFY_BATCH_CAPACITY];
+} iree_hal_semaphore_notify_batch_t;
+
+// Removes |timepoint| from the semaphore and moves its callback into |batch|.
+// The timepoint is reset and the storage may be reused by its owner as soon as
+// the lock is released.
+// NOTE: semaphore timepoint lock must be held.
+static void iree_hal_semaphore_claim_timepoint(
+    iree_hal_semaphore_t* semaphore, iree_hal_semaphore_timepoint_t* timepoint,
+    iree_status_code_t status_code, iree_hal_semaphore_notify_batch_t* batch) {
+  IREE_ASSERT_LT(batch->count, IREE_HAL_SEMAPHORE_NOTIFY_BATCH_CAPACITY);
+  iree_hal_semaphore_timepoint_list_erase(&semaphore->timepoint_list,
+                                          timepoint);
+  if (timepoint->deadline_ns != IREE_TIME_INFINITE_FUTURE) {
+    iree_hal_semaphore_deadline_list_erase(&semaphore->deadline_list,
+                                           timepoint);
+  }
+  batch->entries[batch->count].callback = timepoint->callback;
+  batch->entries[batch->count].status_code = status_code;
+  ++batch->count;
   memset(timepoint, 0, sizeof(*timepoint));
+}
 
-  // Issue the callback.
-  iree_status_ignore(
-      callback.fn(callback.user_data, semaphore, new_value, new_status_code));
+// Issues the callbacks in |batch| and releases the semaphore references that
+// were held by the claimed timepoints.
+// NOTE: semaphore timepoint lock must not be held.
+static void iree_hal_semaphore_issue_batch(
+    iree_hal_semaphore_t* semaphore, uint64_t new_value,
+    iree_hal_semaphore_notify_batch_t* batch) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)batch->count);
 
-  // Release semaphore that was retained by the timepoint.
+  for (iree_host_size_t i = 0; i < batch->count; ++i) {
+    iree_hal_semaphore_callback_t callback = batch->entries[i].callback;
+    iree_status_ignore(callback.fn(callback.user_data, semaphore, new_value,
+                                   batch->entries[i].status_code));
+  }
+
+  // Release semaphore that was retained by each timepoint.
   // This _shouldn't_ be the last owner as the caller has to have a reference.
-  iree_hal_semaphore_release(semaphore);
+  for (iree_host_size_t i = 0; i < batch->count; ++i) {
+    iree_hal_semaphore_release(semaphore);
+  }
+  batch->count = 0;
+
+  // Wake any cancellations that raced with the callbacks.
+  if (iree_atomic_fetch_sub_int32(&semaphore->notify_count, 1,
+                                  iree_memory_order_acq_rel) == 1) {
+    iree_notification_post(&semaphore->notify_notification, IREE_ALL_WAITERS);
+  }
 
   IREE_TRACE_ZONE_END(z0);
 }
 
-// Issues callbacks for all timepoints in the |list|.
-// Timepoints are released and the list is emptied upon return.
-static void iree_hal_semaphore_issue_timepoint_callbacks(
-    iree_hal_semaphore_t* semaphore, uint64_t new_value,
-    iree_status_code_t new_status_code,
-    iree_hal_semaphore_timepoint_list_t* list) {
-  if (iree_hal_semaphore_timepoint_list_is_empty(list)) return;
-  for (iree_hal_semaphore_timepoint_t* timepoint = list->head;
-       timepoint != NULL;) {
-    list->head = timepoint->next;
-    timepoint->next = NULL;
-    timepoint->prev = NULL;
-    iree_hal_semaphore_issue_timepoint_callback(semaphore, new_value,
-                                                new_status_code, timepoint);
-    timepoint = list->head;
+// Claims up to a batch worth of timepoints that have been reached by
+// |new_value| or have expired by |now_ns|. |now_ns| is queried on first use.
+// Returns true if any timepoints were claimed.
+// NOTE: semaphore timepoint lock must be held.
+static bool iree_hal_semaphore_claim_resolved_timepoints(
+    iree_hal_semaphore_t* semaphore, uint64_t new_value, iree_time_t* now_ns,
+    iree_hal_semaphore_notify_batch_t* batch) {
+  // Reached timepoints form a prefix of the value-ordered list. Even if the
+  // deadline has been reached we'll still consider these a hit.
+  while (batch->count < IREE_HAL_SEMAPHORE_NOTIFY_BATCH_CAPACITY) {
+    iree_hal_semaphore_timepoint_t* timepoint = semaphore->timepoint_list.head;
+    if (!timepoint || timepoint->minimum_value > new_value) break;
+    iree_hal_semaphore_claim_timepoint(semaphore, timepoint, IREE_STATUS_OK,
+                                       batch);
   }
-  list->tail = NULL;
+
+  // Expired timepoints form a prefix of the deadline-ordered list. Only once
+  // all reached timepoints have been claimed are the remaining ones known to
+  // be unreached.
+  if (batch->count < IREE_HAL_SEMAPHORE_NOTIFY_BATCH_CAPACITY &&
+      !iree_hal_semaphore_timepoint_list_is_empty(&semaphore->deadline_list)) {
+    if (*now_ns == IREE_TIME_INFINITE_PAST) *now_ns = iree_time_now();
+    while (batch->count < IREE_HAL_SEMAPHORE_NOTIFY_BATCH_CAPACITY) {
+      iree_hal_semaphore_timepoint_t* timepoint =
+          semaphore->deadline_list.head;
+      if (!timepoint || timepoint->deadline_ns > *now_ns) break;
+      iree_hal_semaphore_claim_timepoint(
+          semaphore, timepoint, IREE_STATUS_DEADLINE_EXCEEDED, batch);
+    }
+  }
+
+  if (batch->count > 0) {
+    iree_atomic_fetch_add_int32(&semaphore->notify_count, 1,
+                                iree_memory_order_acq_rel);
+  }
+  return batch->count > 0;
 }
 
 // NOTE: semaphore timepoint lock must not be held.
@@ -114,53 +236,20 @@ static void iree_hal_semaphore_resolve_timepoints(
     iree_hal_semaphore_t* semaphore, uint64_t new_value) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  iree_hal_semaphore_timepoint_list_t pending_list = {NULL, NULL};
-  iree_hal_semaphore_timepoint_list_t ready_list = {NULL, NULL};
-  iree_hal_semaphore_timepoint_list_t expired_list = {NULL, NULL};
-
-  iree_slim_mutex_lock(&semaphore->timepoint_mutex);
-
-  if (iree_hal_semaphore_timepoint_list_is_empty(&semaphore->timepoint_list)) {
+  // Resolve a batch at a time so that the lock is only held while unlinking
+  // timepoints and never while issuing callbacks.
+  iree_hal_semaphore_notify_batch_t batch;
+  batch.count = 0;
+  iree_time_t now_ns = IREE_TIME_INFINITE_PAST;
+  while (true) {
+    iree_slim_mutex_lock(&semaphore->timepoint_mutex);
+    const bool has_batch = iree_hal_semaphore_claim_resolved_timepoints(
+        semaphore, new_value, &now_ns, &batch);
     iree_slim_mutex_unlock(&semaphore->timepoint_mutex);
-    IREE_TRACE_ZONE_END(z0);
-    return;
-  }
-
-  // Scan through the list and divvy up timepoints into still-pending, ready to
-  // resolve, and expired buckets.
-  iree_time_t now_ns = iree_time_now();
-  for (iree_hal_semaphore_timepoint_t* timepoint =
-           semaphore->timepoint_list.head;
-       timepoint != NULL;) {
-    iree_hal_semaphore_timepoint_t* next_timepoint = timepoint->next;
-    timepoint->next = NULL;
-
-    if (timepoint->minimum_value <= new_value) {
-      // Reached the timepoint; even if the deadline has been reached we'll
-      // still consider this a hit.
-      iree_hal_semaphore_timepoint_list_push_back(&ready_list, timepoint);
-    } else if (timepoint->deadline_ns <= now_ns) {
-      // Deadline expired before the timepoint was reached.
-      iree_hal_semaphore_timepoint_list_push_back(&expired_list, timepoint);
-    } else {
-      // Still pending.
-      iree_hal_semaphore_timepoint_list_push_back(&pending_list, timepoint);
-    }
-
-    timepoint = next_timepoint;
+    if (!has_batch) break;
+    iree_hal_semaphore_issue_batch(semaphore, new_value, &batch);
   }
 
-  // Preserve pending timepoints.
-  semaphore->timepoint_list = pending_list;
-
-  // Issue callbacks for all successes and failures.
-  iree_hal_semaphore_issue_timepoint_callbacks(semaphore, new_value,
-                                               IREE_STATUS_OK, &ready_list);
-  iree_hal_semaphore_issue_timepoint_callbacks(
-      semaphore, new_value, IREE_STATUS_DEADLINE_EXCEEDED, &expired_list);
-
-  iree_slim_mutex_unlock(&semaphore->timepoint_mutex);
-
   IREE_TRACE_ZONE_END(z0);
 }
 
@@ -169,22 +258,38 @@ static void iree_hal_semaphore_reject_timepoints(
     iree_hal_semaphore_t* semaphore, iree_status_code_t new_status_code) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  iree_slim_mutex_lock(&semaphore->timepoint_mutex);
-
-  // Take the entire timepoint list from the semaphore.
-  iree_hal_semaphore_timepoint_list_t failed_list = {NULL, NULL};
-  iree_hal_semaphore_timepoint_list_take_all(&semaphore->timepoint_list,
-                                             &failed_list);
-
-  // Issue failure callbacks for all timepoints.
-  iree_hal_semaphore_issue_timepoint_callbacks(semaphore, UINT64_MAX,
-                                               new_status_code, &failed_list);
-
-  iree_slim_mutex_unlock(&semaphore->timepoint_mutex);
+  // Issue failure callbacks for all timepoints a batch at a time.
+  iree_hal_semaphore_notify_batch_t batch;
+  batch.count = 0;
+  while (true) {
+    iree_slim_mutex_lock(&semaphore->timepoint_mutex);
+    while (batch.count < IREE_HAL_SEMAPHORE_NOTIFY_BATCH_CAPACITY &&
+           !iree_hal_semaphore_timepoint_list_is_empty(
+               &semaphore->timepoint_list)) {
+      iree_hal_semaphore_claim_timepoint(semaphore,
+                                         semaphore->timepoint_list.head,
+                                         new_status_code, &batch);
+    }
+    const bool has_batch = batch.count > 0;
+    if (has_batch) {
+      iree_atomic_fetch_add_int32(&semaphore->notify_count, 1,
+                                  iree_memory_order_acq_rel);
+    }
+    iree_slim_mutex_unlock(&semaphore->timepoint_mutex);
+    if (!has_batch) break;
+    iree_hal_semaphore_issue_batch(semaphore, UINT64_MAX, &batch);
+  }
 
   IREE_TRACE_ZONE_END(z0);
 }
 
+// Returns true if no notifications are issuing callbacks.
+static bool iree_hal_semaphore_is_notify_idle(void* user_data) {
+  iree_hal_semaphore_t* semaphore = (iree_hal_semaphore_t*)user_data;
+  return iree_atomic_load_int32(&semaphore->notify_count,
+                                iree_memory_order_acquire) == 0;
+}
+
 //===----------------------------------------------------------------------===//
 // iree_hal_semaphore_t
 //===----------------------------------------------------------------------===//
@@ -197,11 +302,17 @@ IREE_API_EXPORT void iree_hal_semaphore_initialize(
   iree_slim_mutex_initialize(&out_semaphore->timepoint_mutex);
   memset(&out_semaphore->timepoint_list, 0,
          sizeof(out_semaphore->timepoint_list));
+  memset(&out_semaphore->deadline_list, 0,
+         sizeof(out_semaphore->deadline_list));
+  iree_atomic_store_int32(&out_semaphore->notify_count, 0,
+                          iree_memory_order_relaxed);
+  iree_notification_initialize(&out_semaphore->notify_notification);
 }
 
 IREE_API_EXPORT void iree_hal_semaphore_deinitialize(
     iree_hal_semaphore_t* semaphore) {
   IREE_ASSERT_ARGUMENT(semaphore);
+  iree_notification_deinitialize(&semaphore->notify_notification);
   iree_slim_mutex_deinitialize(&semaphore->timepoint_mutex);
 }
 
@@ -218,18 +329,24 @@ IREE_API_EXPORT void iree_hal_semaphore_acquire_timepoint(
   // how long it'll take to acquire the lock and how long it'll be pending.
   out_timepoint->next = NULL;
   out_timepoint->prev = NULL;
+  out_timepoint->deadline_next = NULL;
+  out_timepoint->deadline_prev = NULL;
   out_timepoint->semaphore = semaphore;
   iree_hal_semaphore_retain(semaphore);
   out_timepoint->minimum_value = minimum_value;
   out_timepoint->deadline_ns = iree_timeout_as_deadline_ns(timeout);
   out_timepoint->callback = callback;
 
-  // Insert into timepoint list.
+  // Insert into timepoint lists.
   // After we release the lock the callback may be issued immediately as another
   // thread may be waiting to signal the timepoint.
   iree_slim_mutex_lock(&semaphore->timepoint_mutex);
-  iree_hal_semaphore_timepoint_list_push_back(&semaphore->timepoint_list,
-                                              out_timepoint);
+  iree_hal_semaphore_timepoint_list_insert(&semaphore->timepoint_list,
+                                           out_timepoint);
+  if (out_timepoint->deadline_ns != IREE_TIME_INFINITE_FUTURE) {
+    iree_hal_semaphore_deadline_list_insert(&semaphore->deadline_list,
+                                            out_timepoint);
+  }
   iree_slim_mutex_unlock(&semaphore->timepoint_mutex);
 
   IREE_TRACE_ZONE_END(z0);
@@ -248,10 +365,14 @@ IREE_API_EXPORT void iree_hal_semaphore_cancel_timepoint(
   // even if such a race is possible.
   const bool needs_release = timepoint->semaphore != NULL;
   if (needs_release) {
-    // Remove the timepoint from the list to ensure no other code can issue its
-    // callback.
+    // Remove the timepoint from the lists to ensure no other code can issue
+    // its callback.
     iree_hal_semaphore_timepoint_list_erase(&semaphore->timepoint_list,
                                             timepoint);
+    if (timepoint->deadline_ns != IREE_TIME_INFINITE_FUTURE) {
+      iree_hal_semaphore_deadline_list_erase(&semaphore->deadline_list,
+                                             timepoint);
+    }
 
     // Neuter the timepoint so that it is never called.
     // Other threads may be sitting and waiting for the lock and we need to
@@ -262,10 +383,17 @@ IREE_API_EXPORT void iree_hal_semaphore_cancel_timepoint(
 
   iree_slim_mutex_unlock(&semaphore->timepoint_mutex);
 
-  // Release the semaphore outside of the lock as it may recursively release
-  // resources.
   if (needs_release) {
+    // Release the semaphore outside of the lock as it may recursively release
+    // resources.
     iree_hal_semaphore_release(semaphore);
+  } else {
+    // The timepoint may have been claimed by a notification that is still
+    // issuing its callback outside of the lock. Wait for it to complete so
+    // that the caller can safely tear down whatever the callback touches.
+    iree_notification_await(&semaphore->notify_notification,
+                            iree_hal_semaphore_is_notify_idle, semaphore,
+                            iree_infinite_timeout());
   }
 
   IREE_TRACE_ZONE_END(z0);
@@ -11,6 +11,7 @@
 #include <stdint.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
 #include "iree/base/internal/synchronization.h"
 #include "iree/hal/api.h"
 
@@ -25,7 +26,7 @@ extern "C" {
 // In error cases handlers can query the status of the |semaphore| to receive
 // the full status if desired.
 //
-// Handlers run outside the semaphore lock but under the timepoint list lock
+// Handlers run outside of both the semaphore lock and the timepoint list lock
 // and may re-entrantly use the semaphore to query but not manage timepoints.
 typedef iree_status_t(IREE_API_PTR* iree_hal_semaphore_callback_fn_t)(
     void* user_data, iree_hal_semaphore_t* semaphore, uint64_t value,
@@ -42,13 +43,21 @@ typedef struct iree_hal_semaphore_callback_t {
 // Each semaphore manages a list of active timepoints and issues their specified
 // callback when the semaphore is signaled to or beyond a given value.
 typedef struct iree_hal_semaphore_timepoint_t {
-  // Intrusive doubly-linked list next entry pointer.
+  // Intrusive doubly-linked value-ordered list next entry pointer.
   // Guarded by the semaphore mutex.
   struct iree_hal_semaphore_timepoint_t* next;
-  // Intrusive doubly-linked list previous entry pointer.
+  // Intrusive doubly-linked value-ordered list previous entry pointer.
   // Guarded by the semaphore mutex.
   struct iree_hal_semaphore_timepoint_t* prev;
 
+  // Intrusive doubly-linked deadline-ordered list next entry pointer.
+  // Only timepoints with a finite deadline are linked into the list.
+  // Guarded by the semaphore mutex.
+  struct iree_hal_semaphore_timepoint_t* deadline_next;
+  // Intrusive doubly-linked deadline-ordered list previous entry pointer.
+  // Guarded by the semaphore mutex.
+  struct iree_hal_semaphore_timepoint_t* deadline_prev;
+
   // Retained semaphore; this ensures the semaphore remains valid for the
   // lifetime of the timepoint. The semaphore must be released by the underlying
   // implementation or by the user with iree_hal_semaphore_release_timepoint.
@@ -66,9 +75,9 @@ typedef struct iree_hal_semaphore_timepoint_t {
   iree_hal_semaphore_callback_t callback;
 } iree_hal_semaphore_timepoint_t;
 
-// A doubly-linked FIFO list of timepoints.
-// The order of the timepoints does *not* match increasing payload values but
-// instead the order they were added to the list.
+// A doubly-linked list of timepoints.
+// Lists are kept sorted by either increasing minimum payload value or
+// increasing deadline with ties in the order the timepoints were added.
 //
 // Note that the timepoints are not owned by the list - this just nicely
 // stitches together timepoints for easier management.
@@ -88,21 +97,34 @@ typedef struct iree_hal_semaphore_timepoint_list_t {
 // Semaphore implementations need to notify the tracking semaphore of signal and
 // failure events using the iree_hal_semaphore_notify method. Any satisfied
 // timepoints will have their callback made immediately from the notifying
-// thread.
+// thread. Satisfied timepoints are removed from the lists in batches and their
+// callbacks are issued with the lock released so that other threads may
+// continue to acquire and cancel timepoints.
 struct iree_hal_semaphore_t {
   iree_hal_resource_t resource;  // must be at 0
 
   // Non-recursive mutex guarding access to the timepoint list.
   iree_slim_mutex_t timepoint_mutex;
 
-  // Timepoint list in insertion order.
-  // There are probably better orderings we could use here that allow us to
-  // walk the entire list less frequently, though target payload value is not
-  // enough as deadlines still require the scan. We could sort by non-infinite
-  // deadlines first and then infinite ones last but given the common timepoint
-  // counts (0..1) it's not worth the complexity today.
+  // All pending timepoints sorted by increasing minimum_value.
+  // Signals only need to visit the timepoints they satisfy as those form a
+  // prefix of the list. Insertion walks back from the tail as waits are
+  // usually acquired on increasing values.
   iree_hal_semaphore_timepoint_list_t timepoint_list
       IREE_GUARDED_BY(timepoint_mutex);
+
+  // Pending timepoints with finite deadlines sorted by increasing deadline_ns.
+  // Timepoints waiting infinitely (the common case) are not in this list and
+  // an empty list avoids querying the time during resolution.
+  iree_hal_semaphore_timepoint_list_t deadline_list
+      IREE_GUARDED_BY(timepoint_mutex);
+
+  // Total number of notifications currently issuing callbacks outside of the
+  // lock. Cancellation waits for this to drain when it races with a callback
+  // so that the timepoint storage and callback state can be reused.
+  iree_atomic_int32_t notify_count;
+  // Posted whenever notify_count drops to zero.
+  iree_notification_t notify_notification;
 };
 
 // Initializes the base |out_semaphore| resource.
@@ -143,7 +165,8 @@ IREE_API_EXPORT void iree_hal_semaphore_acquire_timepoint(
 // Cancels a |timepoint| and prevents any future callbacks.
 // The timepoint is only considered cancelled once execution returns
 // to the caller; due to races it's possible for a callback to be made with
-// a different status code while releasing.
+// a different status code while releasing. If the callback is being issued
+// concurrently this waits until it has completed.
 //
 // Only the owner of the timepoint (whatever is listening for the callback)
 // should use this as otherwise the program may become desynchronized.
@@ -0,0 +1,243 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/utils/semaphore_base.h"
+#include "iree/testing/benchmark.h"
+
+// Minimal semaphore that tracks its current value and notifies the base
+// timepoint tracking on signal. No waiting is performed as the benchmarks are
+// single-threaded.
+typedef struct iree_hal_test_semaphore_t {
+  iree_hal_semaphore_t base;
+  iree_allocator_t host_allocator;
+  uint64_t current_value;
+} iree_hal_test_semaphore_t;
+
+static const iree_hal_semaphore_vtable_t iree_hal_test_semaphore_vtable;
+
+static iree_hal_test_semaphore_t* iree_hal_test_semaphore_cast(
+    iree_hal_semaphore_t* base_value) {
+  return (iree_hal_test_semaphore_t*)base_value;
+}
+
+static iree_status_t iree_hal_test_semaphore_create(
+    iree_allocator_t host_allocator, iree_hal_semaphore_t** out_semaphore) {
+  iree_hal_test_semaphore_t* semaphore = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(host_allocator, sizeof(*semaphore),
+                                             (void**)&semaphore));
+  iree_hal_semaphore_initialize(&iree_hal_test_semaphore_vtable,
+                                &semaphore->base);
+  semaphore->host_allocator = host_allocator;
+  semaphore->current_value = 0;
+  *out_semaphore = &semaphore->base;
+  return iree_ok_status();
+}
+
+static void iree_hal_test_semaphore_destroy(
+    iree_hal_semaphore_t* base_semaphore) {
+  iree_hal_test_semaphore_t* semaphore =
+      iree_hal_test_semaphore_cast(base_semaphore);
+  iree_allocator_t host_allocator = semaphore->host_allocator;
+  iree_hal_semaphore_deinitialize(&semaphore->base);
+  iree_allocator_free(host_allocator, semaphore);
+}
+
+static iree_status_t iree_hal_test_semaphore_query(
+    iree_hal_semaphore_t* base_semaphore, uint64_t* out_value) {
+  *out_value = iree_hal_test_semaphore_cast(base_semaphore)->current_value;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_test_semaphore_signal(
+    iree_hal_semaphore_t* base_semaphore, uint64_t new_value) {
+  iree_hal_test_semaphore_cast(base_semaphore)->current_value = new_value;
+  iree_hal_semaphore_notify(base_semaphore, new_value, IREE_STATUS_OK);
+  return iree_ok_status();
+}
+
+static void iree_hal_test_semaphore_fail(iree_hal_semaphore_t* base_semaphore,
+                                         iree_status_t status) {
+  iree_hal_semaphore_notify(base_semaphore, 0, iree_status_code(status));
+  iree_status_ignore(status);
+}
+
+static iree_status_t iree_hal_test_semaphore_wait(
+    iree_hal_semaphore_t* base_semaphore, uint64_t value,
+    iree_timeout_t timeout) {
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED);
+}
+
+static const iree_hal_semaphore_vtable_t iree_hal_test_semaphore_vtable = {
+    .destroy = iree_hal_test_semaphore_destroy,
+    .query = iree_hal_test_semaphore_query,
+    .signal = iree_hal_test_semaphore_signal,
+    .fail = iree_hal_test_semaphore_fail,
+    .wait = iree_hal_test_semaphore_wait,
+};
+
+static iree_status_t iree_hal_semaphore_benchmark_callback(
+    void* user_data, iree_hal_semaphore_t* semaphore, uint64_t value,
+    iree_status_code_t status_code) {
+  ++*(uint32_t*)user_data;
+  return iree_ok_status();
+}
+
+// Tests the acquire and resolve performance of N timepoints acquired on
+// increasing values that are all resolved by a single signal, such as waiters
+// on each step of a pipeline that completes at once.
+//
+// user_data is a count of timepoints to resolve per signal.
+static iree_status_t iree_hal_semaphore_benchmark_resolve_all_n(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_allocator_t host_allocator = benchmark_state->host_allocator;
+
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_CHECK_OK(iree_hal_test_semaphore_create(host_allocator, &semaphore));
+
+  uint32_t count = (uint32_t)(uintptr_t)benchmark_def->user_data;
+  iree_hal_semaphore_timepoint_t* timepoints = NULL;
+  IREE_CHECK_OK(iree_allocator_malloc(host_allocator,
+                                      sizeof(*timepoints) * count,
+                                      (void**)&timepoints));
+  uint32_t callback_count = 0;
+  iree_hal_semaphore_callback_t callback = {
+      iree_hal_semaphore_benchmark_callback,
+      &callback_count,
+  };
+
+  uint64_t value = 0;
+  while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/count)) {
+    for (uint32_t i = 0; i < count; ++i) {
+      iree_hal_semaphore_acquire_timepoint(semaphore, value + i + 1,
+                                           iree_infinite_timeout(), callback,
+                                           &timepoints[i]);
+    }
+    value += count;
+    IREE_CHECK_OK(iree_hal_semaphore_signal(semaphore, value));
+  }
+  IREE_ASSERT_EQ(callback_count, (uint32_t)value);
+
+  iree_allocator_free(host_allocator, timepoints);
+  iree_hal_semaphore_release(semaphore);
+
+  return iree_ok_status();
+}
+
+// Tests the performance of signaling a semaphore with N-1 waiters parked on
+// values that are never reached, such as a server with many clients waiting
+// on a shared timeline. Each signal resolves a single new timepoint and should
+// not scale with the number of parked waiters.
+//
+// user_data is a count of timepoints pending on the semaphore.
+static iree_status_t iree_hal_semaphore_benchmark_resolve_one_of_n(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_allocator_t host_allocator = benchmark_state->host_allocator;
+
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_CHECK_OK(iree_hal_test_semaphore_create(host_allocator, &semaphore));
+
+  uint32_t count = (uint32_t)(uintptr_t)benchmark_def->user_data;
+  iree_hal_semaphore_timepoint_t* timepoints = NULL;
+  IREE_CHECK_OK(iree_allocator_malloc(host_allocator,
+                                      sizeof(*timepoints) * count,
+                                      (void**)&timepoints));
+  uint32_t callback_count = 0;
+  iree_hal_semaphore_callback_t callback = {
+      iree_hal_semaphore_benchmark_callback,
+      &callback_count,
+  };
+
+  // Park the waiters. Half have deadlines far in the future so that they are
+  // tracked for expiration as well.
+  for (uint32_t i = 1; i < count; ++i) {
+    iree_timeout_t timeout = (i % 2) ? iree_infinite_timeout()
+                                     : iree_make_timeout_ms(60 * 60 * 1000);
+    iree_hal_semaphore_acquire_timepoint(semaphore, UINT64_MAX - i, timeout,
+                                         callback, &timepoints[i]);
+  }
+
+  uint64_t value = 0;
+  while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    iree_hal_semaphore_acquire_timepoint(semaphore, ++value,
+                                         iree_infinite_timeout(), callback,
+                                         &timepoints[0]);
+    IREE_CHECK_OK(iree_hal_semaphore_signal(semaphore, value));
+  }
+  IREE_ASSERT_EQ(callback_count, (uint32_t)value);
+
+  // Cleanup.
+  for (uint32_t i = 1; i < count; ++i) {
+    iree_hal_semaphore_cancel_timepoint(semaphore, &timepoints[i]);
+  }
+  iree_allocator_free(host_allocator, timepoints);
+  iree_hal_semaphore_release(semaphore);
+
+  return iree_ok_status();
+}
+
+int main(int argc, char** argv) {
+  iree_benchmark_initialize(&argc, argv);
+
+  // iree_hal_semaphore_benchmark_resolve_all_n
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_NANOSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_hal_semaphore_benchmark_resolve_all_n,
+    };
+    benchmark_def.user_data = (void*)1u;
+    iree_benchmark_register(iree_make_cstring_view("resolve_all_1"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)16u;
+    iree_benchmark_register(iree_make_cstring_view("resolve_all_16"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)256u;
+    iree_benchmark_register(iree_make_cstring_view("resolve_all_256"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)1024u;
+    iree_benchmark_register(iree_make_cstring_view("resolve_all_1024"),
+                            &benchmark_def);
+  }
+
+  // iree_hal_semaphore_benchmark_resolve_one_of_n
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_NANOSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_hal_semaphore_benchmark_resolve_one_of_n,
+    };
+    benchmark_def.user_data = (void*)1u;
+    iree_benchmark_register(iree_make_cstring_view("resolve_one_of_1"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)16u;
+    iree_benchmark_register(iree_make_cstring_view("resolve_one_of_16"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)256u;
+    iree_benchmark_register(iree_make_cstring_view("resolve_one_of_256"),
+                            &benchmark_def);
+    benchmark_def.user_data = (void*)1024u;
+    iree_benchmark_register(iree_make_cstring_view("resolve_one_of_1024"),
+                            &benchmark_def);
+  }
+
+  iree_benchmark_run_specified();
+  return 0;
+}
@@ -11,6 +11,7 @@
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "iree/base/api.h"
 #include "iree/base/internal/wait_handle.h"
@@ -374,6 +375,105 @@ TEST_F(TrackingSemaphoreTest, CancelResolvedTimepoint) {
   iree_hal_semaphore_release(*semaphore);
 }
 
+// Tests that signals only resolve the timepoints they reach regardless of the
+// order in which the timepoints were acquired.
+TEST_F(TrackingSemaphoreTest, ResolveOutOfOrderTimepoints) {
+  auto* semaphore = TestSemaphore::Create(0ull, host_allocator);
+
+  CallbackState states[4];
+  iree_hal_semaphore_timepoint_t timepoints[4];
+  const uint64_t values[4] = {3ull, 1ull, 4ull, 2ull};
+  for (int i = 0; i < 4; ++i) {
+    iree_hal_semaphore_acquire_timepoint(*semaphore, values[i],
+                                         iree_infinite_timeout(),
+                                         MakeCallback(&states[i]),
+                                         &timepoints[i]);
+  }
+
+  // Callbacks happen here for the timepoints at 1 and 2 only:
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(*semaphore, 2ull));
+  ASSERT_EQ(states[0].callback_count, 0);
+  ASSERT_EQ(states[1].callback_count, 1);
+  ASSERT_EQ(states[2].callback_count, 0);
+  ASSERT_EQ(states[3].callback_count, 1);
+  ASSERT_EQ(states[3].value, 2ull);
+
+  // Cancel one of the pending timepoints and resolve the rest:
+  iree_hal_semaphore_cancel_timepoint(*semaphore, &timepoints[2]);
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(*semaphore, 4ull));
+  ASSERT_EQ(states[0].callback_count, 1);
+  ASSERT_EQ(states[0].status_code, IREE_STATUS_OK);
+  ASSERT_EQ(states[0].value, 4ull);
+  ASSERT_EQ(states[1].callback_count, 1);
+  ASSERT_EQ(states[2].callback_count, 0);
+  ASSERT_EQ(states[3].callback_count, 1);
+
+  iree_hal_semaphore_release(*semaphore);
+}
+
+// Tests that timepoints whose deadline has passed expire on the next notify
+// while those waiting infinitely remain pending.
+TEST_F(TrackingSemaphoreTest, ExpireTimepoint) {
+  auto* semaphore = TestSemaphore::Create(0ull, host_allocator);
+
+  CallbackState expired_state;
+  iree_hal_semaphore_timepoint_t expired_timepoint;
+  iree_hal_semaphore_acquire_timepoint(
+      *semaphore, 2ull, iree_immediate_timeout(),
+      MakeCallback(&expired_state), &expired_timepoint);
+  CallbackState pending_state;
+  iree_hal_semaphore_timepoint_t pending_timepoint;
+  iree_hal_semaphore_acquire_timepoint(
+      *semaphore, 2ull, iree_infinite_timeout(), MakeCallback(&pending_state),
+      &pending_timepoint);
+
+  // Expiration happens here:
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(*semaphore, 1ull));
+  ASSERT_EQ(expired_state.callback_count, 1);
+  ASSERT_EQ(expired_state.status_code, IREE_STATUS_DEADLINE_EXCEEDED);
+  ASSERT_EQ(pending_state.callback_count, 0);
+
+  // Callback happens here:
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(*semaphore, 2ull));
+  ASSERT_EQ(expired_state.callback_count, 1);
+  ASSERT_EQ(pending_state.callback_count, 1);
+  ASSERT_EQ(pending_state.status_code, IREE_STATUS_OK);
+
+  iree_hal_semaphore_release(*semaphore);
+}
+
+// Tests resolving and rejecting more timepoints than are issued in a single
+// notification batch.
+TEST_F(TrackingSemaphoreTest, ResolveManyTimepoints) {
+  auto* semaphore = TestSemaphore::Create(0ull, host_allocator);
+
+  static constexpr int kTimepointCount = 200;
+  std::vector<CallbackState> states(kTimepointCount);
+  std::vector<iree_hal_semaphore_timepoint_t> timepoints(kTimepointCount);
+  for (int i = 0; i < kTimepointCount; ++i) {
+    iree_hal_semaphore_acquire_timepoint(
+        *semaphore, (uint64_t)(i % 2 ? i : kTimepointCount + i),
+        iree_infinite_timeout(), MakeCallback(&states[i]), &timepoints[i]);
+  }
+
+  // Callbacks happen here for all odd timepoints:
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(*semaphore, kTimepointCount));
+  for (int i = 0; i < kTimepointCount; ++i) {
+    ASSERT_EQ(states[i].callback_count, i % 2 ? 1 : 0);
+  }
+
+  // Callbacks happen here for all even timepoints:
+  iree_hal_semaphore_fail(*semaphore,
+                          iree_make_status(IREE_STATUS_DATA_LOSS, "whoops"));
+  for (int i = 0; i < kTimepointCount; ++i) {
+    ASSERT_EQ(states[i].callback_count, 1);
+    ASSERT_EQ(states[i].status_code,
+              i % 2 ? IREE_STATUS_OK : IREE_STATUS_DATA_LOSS);
+  }
+
+  iree_hal_semaphore_release(*semaphore);
+}
+
 }  // namespace
 }  // namespace hal
 }  // namespace iree
@@ -0,0 +1,373 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/io/parameter_archive.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/file_io.h"
+#include "iree/base/tracing.h"
+
+struct iree_io_parameter_archive_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+  // Archive contents freed with |contents_deallocator| on destruction.
+  iree_const_byte_span_t contents;
+  iree_allocator_t contents_deallocator;
+  // Validated pointers into |contents|.
+  iree_host_size_t entry_count;
+  const iree_io_parameter_archive_entry_t* entries;
+  const char* names;
+  const uint8_t* data;
+};
+
+static iree_string_view_t iree_io_parameter_archive_entry_name(
+    const iree_io_parameter_archive_t* archive,
+    const iree_io_parameter_archive_entry_t* entry) {
+  return iree_make_string_view(archive->names + entry->name_offset,
+                               (iree_host_size_t)entry->name_length);
+}
+
+// Returns true if [offset, offset+length) lies within [0, limit).
+static bool iree_io_parameter_archive_range_is_valid(uint64_t offset,
+                                                     uint64_t length,
+                                                     uint64_t limit) {
+  return offset <= limit && length <= limit - offset;
+}
+
+// Verifies the archive header and entry table in |archive->contents| and
+// populates the table pointers.
+static iree_status_t iree_io_parameter_archive_verify(
+    iree_io_parameter_archive_t* archive) {
+#if !defined(IREE_ENDIANNESS_LITTLE)
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "parameter archives require a little-endian host");
+#else
+  const iree_const_byte_span_t contents = archive->contents;
+  if (contents.data_length < sizeof(iree_io_parameter_archive_header_t)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "archive too small for header (%zu bytes)",
+                            contents.data_length);
+  }
+  const iree_io_parameter_archive_header_t* header =
+      (const iree_io_parameter_archive_header_t*)contents.data;
+  if (header->magic != IREE_IO_PARAMETER_ARCHIVE_MAGIC) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "archive magic mismatch; not a parameter archive");
+  }
+  if (header->version != IREE_IO_PARAMETER_ARCHIVE_VERSION_0) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "unsupported archive version %u", header->version);
+  }
+
+  const uint64_t limit = contents.data_length;
+  if (header->entry_count > limit / sizeof(iree_io_parameter_archive_entry_t) ||
+      header->entry_table_offset % sizeof(uint64_t) != 0 ||
+      !iree_io_parameter_archive_range_is_valid(
+          header->entry_table_offset,
+          header->entry_count * sizeof(iree_io_parameter_archive_entry_t),
+          limit) ||
+      !iree_io_parameter_archive_range_is_valid(
+          header->name_table_offset, header->name_table_length, limit) ||
+      !iree_io_parameter_archive_range_is_valid(header->data_offset,
+                                                header->data_length, limit)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "archive tables out of bounds");
+  }
+  archive->entry_count = (iree_host_size_t)header->entry_count;
+  archive->entries =
+      (const iree_io_parameter_archive_entry_t*)(contents.data +
+                                                 header->entry_table_offset);
+  archive->names = (const char*)contents.data + header->name_table_offset;
+  archive->data = contents.data + header->data_offset;
+
+  // Verify each entry is in bounds and the table is sorted so lookups can
+  // binary search.
+  for (iree_host_size_t i = 0; i < archive->entry_count; ++i) {
+    const iree_io_parameter_archive_entry_t* entry = &archive->entries[i];
+    if (!iree_io_parameter_archive_range_is_valid(entry->name_offset,
+                                                  entry->name_length,
+                                                  header->name_table_length) ||
+        !iree_io_parameter_archive_range_is_valid(
+            entry->data_offset, entry->data_length, header->data_length)) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "archive entry %zu out of bounds", i);
+    }
+    if (i > 0 &&
+        iree_string_view_compare(
+            iree_io_parameter_archive_entry_name(archive, entry - 1),
+            iree_io_parameter_archive_entry_name(archive, entry)) >= 0) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "archive entries must be sorted and unique");
+    }
+  }
+  return iree_ok_status();
+#endif  // IREE_ENDIANNESS_LITTLE
+}
+
+iree_status_t iree_io_parameter_archive_create_from_memory(
+    iree_const_byte_span_t contents, iree_allocator_t contents_deallocator,
+    iree_allocator_t host_allocator,
+    iree_io_parameter_archive_t** out_archive) {
+  IREE_ASSERT_ARGUMENT(out_archive);
+  *out_archive = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_io_parameter_archive_t* archive = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*archive),
+                                (void**)&archive));
+  memset(archive, 0, sizeof(*archive));
+  iree_atomic_ref_count_init(&archive->ref_count);
+  archive->host_allocator = host_allocator;
+  archive->contents = contents;
+
+  iree_status_t status = iree_io_parameter_archive_verify(archive);
+  if (iree_status_is_ok(status)) {
+    // Only take ownership of the contents on success.
+    archive->contents_deallocator = contents_deallocator;
+    *out_archive = archive;
+  } else {
+    iree_allocator_free(host_allocator, archive);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_io_parameter_archive_open_file(
+    const char* path, iree_allocator_t host_allocator,
+    iree_io_parameter_archive_t** out_archive) {
+  IREE_ASSERT_ARGUMENT(path);
+  IREE_ASSERT_ARGUMENT(out_archive);
+  *out_archive = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_file_contents_t* file_contents = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_file_map_contents(path, host_allocator, &file_contents));
+  iree_status_t status = iree_io_parameter_archive_create_from_memory(
+      file_contents->const_buffer,
+      iree_file_contents_deallocator(file_contents), host_allocator,
+      out_archive);
+  if (!iree_status_is_ok(status)) {
+    iree_file_contents_free(file_contents);
+    status = iree_status_annotate_f(status, "opening archive '%s'", path);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_io_parameter_archive_destroy(
+    iree_io_parameter_archive_t* archive) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t host_allocator = archive->host_allocator;
+  iree_allocator_free(archive->contents_deallocator,
+                      (void*)archive->contents.data);
+  iree_allocator_free(host_allocator, archive);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+void iree_io_parameter_archive_retain(iree_io_parameter_archive_t* archive) {
+  if (IREE_LIKELY(archive)) {
+    iree_atomic_ref_count_inc(&archive->ref_count);
+  }
+}
+
+void iree_io_parameter_archive_release(iree_io_parameter_archive_t* archive) {
+  if (IREE_LIKELY(archive) &&
+      iree_atomic_ref_count_dec(&archive->ref_count) == 1) {
+    iree_io_parameter_archive_destroy(archive);
+  }
+}
+
+iree_host_size_t iree_io_parameter_archive_entry_count(
+    const iree_io_parameter_archive_t* archive) {
+  IREE_ASSERT_ARGUMENT(archive);
+  return archive->entry_count;
+}
+
+iree_status_t iree_io_parameter_archive_lookup(
+    const iree_io_parameter_archive_t* archive, iree_string_view_t name,
+    iree_const_byte_span_t* out_data) {
+  IREE_ASSERT_ARGUMENT(archive);
+  IREE_ASSERT_ARGUMENT(out_data);
+  *out_data = iree_const_byte_span_empty();
+  iree_host_size_t low = 0;
+  iree_host_size_t high = archive->entry_count;
+  while (low < high) {
+    iree_host_size_t mid = low + (high - low) / 2;
+    const iree_io_parameter_archive_entry_t* entry = &archive->entries[mid];
+    int cmp = iree_string_view_compare(
+        iree_io_parameter_archive_entry_name(archive, entry), name);
+    if (cmp == 0) {
+      *out_data = iree_make_const_byte_span(
+          archive->data + entry->data_offset,
+          (iree_host_size_t)entry->data_length);
+      return iree_ok_status();
+    } else if (cmp < 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return iree_make_status(IREE_STATUS_NOT_FOUND,
+                          "parameter '%.*s' not found in archive",
+                          (int)name.size, name.data);
+}
+
+//===----------------------------------------------------------------------===//
+// Archive writing
+//===----------------------------------------------------------------------===//
+
+#if IREE_FILE_IO_ENABLE
+
+static int iree_io_parameter_compare_names(const void* lhs, const void* rhs) {
+  return iree_string_view_compare((*(const iree_io_parameter_t**)lhs)->name,
+                                  (*(const iree_io_parameter_t**)rhs)->name);
+}
+
+// Writes |length| zero bytes to |file|.
+static bool iree_io_parameter_archive_write_padding(FILE* file,
+                                                    uint64_t length) {
+  static const uint8_t zeros[256] = {0};
+  while (length > 0) {
+    size_t chunk = (size_t)iree_min(length, (uint64_t)sizeof(zeros));
+    if (fwrite(zeros, 1, chunk, file) != chunk) return false;
+    length -= chunk;
+  }
+  return true;
+}
+
+static iree_status_t iree_io_parameter_archive_write_sorted(
+    FILE* file, iree_host_size_t parameter_count,
+    const iree_io_parameter_t** sorted_parameters,
+    iree_io_parameter_archive_entry_t* entries) {
+  // Lay out the archive.
+  iree_io_parameter_archive_header_t header;
+  memset(&header, 0, sizeof(header));
+  header.magic = IREE_IO_PARAMETER_ARCHIVE_MAGIC;
+  header.version = IREE_IO_PARAMETER_ARCHIVE_VERSION_0;
+  header.entry_count = parameter_count;
+  header.entry_table_offset = sizeof(header);
+  header.name_table_offset =
+      header.entry_table_offset + parameter_count * sizeof(*entries);
+  uint64_t data_length = 0;
+  for (iree_host_size_t i = 0; i < parameter_count; ++i) {
+    const iree_io_parameter_t* parameter = sorted_parameters[i];
+    if (i > 0 && iree_string_view_equal(sorted_parameters[i - 1]->name,
+                                        parameter->name)) {
+      return iree_make_status(IREE_STATUS_ALREADY_EXISTS,
+                              "duplicate parameter '%.*s'",
+                              (int)parameter->name.size, parameter->name.data);
+    }
+    entries[i].name_offset = header.name_table_length;
+    entries[i].name_length = parameter->name.size;
+    header.name_table_length += parameter->name.size;
+    data_length =
+        iree_host_align(data_length, IREE_IO_PARAMETER_ARCHIVE_DATA_ALIGNMENT);
+    entries[i].data_offset = data_length;
+    entries[i].data_length = parameter->data.data_length;
+    data_length += parameter->data.data_length;
+  }
+  header.data_offset =
+      iree_host_align(header.name_table_offset + header.name_table_length,
+                      IREE_IO_PARAMETER_ARCHIVE_DATA_ALIGNMENT);
+  header.data_length = data_length;
+
+  // Write the header and tables.
+  bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+  if (ok && parameter_count > 0) {
+    ok = fwrite(entries, sizeof(*entries), parameter_count, file) ==
+         parameter_count;
+  }
+  for (iree_host_size_t i = 0; ok && i < parameter_count; ++i) {
+    const iree_string_view_t name = sorted_parameters[i]->name;
+    ok = fwrite(name.data, 1, name.size, file) == name.size;
+  }
+  if (ok) {
+    ok = iree_io_parameter_archive_write_padding(
+        file, header.data_offset -
+                  (header.name_table_offset + header.name_table_length));
+  }
+
+  // Write the data with each entry aligned.
+  uint64_t data_offset = 0;
+  for (iree_host_size_t i = 0; ok && i < parameter_count; ++i) {
+    ok = iree_io_parameter_archive_write_padding(
+        file, entries[i].data_offset - data_offset);
+    const iree_const_byte_span_t data = sorted_parameters[i]->data;
+    if (ok && data.data_length > 0) {
+      ok = fwrite(data.data, data.data_length, 1, file) == 1;
+    }
+    data_offset = entries[i].data_offset + entries[i].data_length;
+  }
+  if (!ok) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to write archive contents");
+  }
+  return iree_ok_status();
+}
+
+iree_status_t iree_io_parameter_archive_write_file(
+    const char* path, iree_host_size_t parameter_count,
+    const iree_io_parameter_t* parameters, iree_allocator_t host_allocator) {
+  IREE_ASSERT_ARGUMENT(path);
+  IREE_ASSERT_ARGUMENT(!parameter_count || parameters);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Entries are sorted by name; sort pointers to avoid copying the caller's
+  // list. Scratch holds [sorted pointers | entry table].
+  const iree_io_parameter_t** sorted_parameters = NULL;
+  iree_host_size_t scratch_size =
+      parameter_count * (sizeof(*sorted_parameters) +
+                         sizeof(iree_io_parameter_archive_entry_t));
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0,
+      iree_allocator_malloc(host_allocator, iree_max(scratch_size, 1),
+                            (void**)&sorted_parameters));
+  iree_io_parameter_archive_entry_t* entries =
+      (iree_io_parameter_archive_entry_t*)(sorted_parameters +
+                                           parameter_count);
+  for (iree_host_size_t i = 0; i < parameter_count; ++i) {
+    sorted_parameters[i] = &parameters[i];
+  }
+  qsort(sorted_parameters, parameter_count, sizeof(*sorted_parameters),
+        iree_io_parameter_compare_names);
+
+  iree_status_t status = iree_ok_status();
+  FILE* file = fopen(path, "wb");
+  if (file == NULL) {
+    status = iree_make_status(iree_status_code_from_errno(errno),
+                              "failed to open file '%s'", path);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_io_parameter_archive_write_sorted(file, parameter_count,
+                                                    sorted_parameters, entries);
+  }
+  if (file && fclose(file) != 0 && iree_status_is_ok(status)) {
+    status = iree_make_status(iree_status_code_from_errno(errno),
+                              "failed to close file '%s'", path);
+  }
+
+  iree_allocator_free(host_allocator, (void*)sorted_parameters);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+#else
+
+iree_status_t iree_io_parameter_archive_write_file(
+    const char* path, iree_host_size_t parameter_count,
+    const iree_io_parameter_t* parameters, iree_allocator_t host_allocator) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE, "File I/O is disabled");
+}
+
+#endif  // IREE_FILE_IO_ENABLE
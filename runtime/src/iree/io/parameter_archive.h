@@ -0,0 +1,123 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_IO_PARAMETER_ARCHIVE_H_
+#define IREE_IO_PARAMETER_ARCHIVE_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// Parameter archive format
+//===----------------------------------------------------------------------===//
+//
+// Parameter archives store named blobs (usually model weights) outside of
+// compiled modules so that they can be versioned and swapped independently and
+// shared across processes via the OS page cache. Archives are designed to be
+// mapped into memory: all fields are little-endian and the data of each entry
+// is aligned to IREE_IO_PARAMETER_ARCHIVE_DATA_ALIGNMENT relative to the start
+// of the file such that it can be imported directly into devices.
+//
+// Layout:
+//   iree_io_parameter_archive_header_t
+//   iree_io_parameter_archive_entry_t[entry_count] (sorted by name)
+//   char names[name_table_length]
+//   <padding>
+//   uint8_t data[data_length] (at data_offset)
+
+#define IREE_IO_PARAMETER_ARCHIVE_MAGIC 0x41505249u  // 'IRPA'
+#define IREE_IO_PARAMETER_ARCHIVE_VERSION_0 0u
+
+// Alignment of each entry's data relative to the start of the archive.
+#define IREE_IO_PARAMETER_ARCHIVE_DATA_ALIGNMENT 4096
+
+typedef struct iree_io_parameter_archive_header_t {
+  // IREE_IO_PARAMETER_ARCHIVE_MAGIC.
+  uint32_t magic;
+  // IREE_IO_PARAMETER_ARCHIVE_VERSION_*.
+  uint32_t version;
+  // Total number of entries in the entry table.
+  uint64_t entry_count;
+  // Byte offset of the entry table from the start of the archive.
+  uint64_t entry_table_offset;
+  // Byte offset and length of the packed entry name table.
+  uint64_t name_table_offset;
+  uint64_t name_table_length;
+  // Byte offset and length of the data segment containing all entry data.
+  uint64_t data_offset;
+  uint64_t data_length;
+  uint64_t reserved;
+} iree_io_parameter_archive_header_t;
+
+typedef struct iree_io_parameter_archive_entry_t {
+  // Byte range of the entry name within the name table.
+  uint64_t name_offset;
+  uint64_t name_length;
+  // Byte range of the entry data within the data segment.
+  uint64_t data_offset;
+  uint64_t data_length;
+} iree_io_parameter_archive_entry_t;
+
+//===----------------------------------------------------------------------===//
+// iree_io_parameter_archive_t
+//===----------------------------------------------------------------------===//
+
+// A read-only parameter archive backed by memory (usually a file mapping).
+// Thread-safe; lookups may be performed concurrently.
+typedef struct iree_io_parameter_archive_t iree_io_parameter_archive_t;
+
+// Wraps archive |contents| in memory. |contents| must remain valid until the
+// archive is destroyed, at which point it is freed with |contents_deallocator|
+// (use iree_allocator_null if not owned).
+iree_status_t iree_io_parameter_archive_create_from_memory(
+    iree_const_byte_span_t contents, iree_allocator_t contents_deallocator,
+    iree_allocator_t host_allocator, iree_io_parameter_archive_t** out_archive);
+
+// Opens the archive file at |path| by mapping it into memory.
+// Parameter data is paged in from the file on first access.
+iree_status_t iree_io_parameter_archive_open_file(
+    const char* path, iree_allocator_t host_allocator,
+    iree_io_parameter_archive_t** out_archive);
+
+// Retains the given |archive| for the caller.
+void iree_io_parameter_archive_retain(iree_io_parameter_archive_t* archive);
+
+// Releases the given |archive| from the caller.
+void iree_io_parameter_archive_release(iree_io_parameter_archive_t* archive);
+
+// Returns the total number of entries in the archive.
+iree_host_size_t iree_io_parameter_archive_entry_count(
+    const iree_io_parameter_archive_t* archive);
+
+// Looks up the entry with the given |name| and returns its data in |out_data|.
+// The data remains valid for the lifetime of the archive.
+// Returns IREE_STATUS_NOT_FOUND if no entry matches.
+iree_status_t iree_io_parameter_archive_lookup(
+    const iree_io_parameter_archive_t* archive, iree_string_view_t name,
+    iree_const_byte_span_t* out_data);
+
+// A named parameter passed to iree_io_parameter_archive_write_file.
+typedef struct iree_io_parameter_t {
+  iree_string_view_t name;
+  iree_const_byte_span_t data;
+} iree_io_parameter_t;
+
+// Writes an archive containing |parameters| to the file at |path|.
+// Existing contents are overwritten. Names must be unique.
+iree_status_t iree_io_parameter_archive_write_file(
+    const char* path, iree_host_size_t parameter_count,
+    const iree_io_parameter_t* parameters, iree_allocator_t host_allocator);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_IO_PARAMETER_ARCHIVE_H_
@@ -0,0 +1,122 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/io/parameter_archive.h"
+
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace io {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+std::string GetUniquePath(const char* unique_name) {
+  char* test_tmpdir = getenv("TEST_TMPDIR");
+  if (!test_tmpdir) {
+    test_tmpdir = getenv("TMPDIR");
+  }
+  if (!test_tmpdir) {
+    test_tmpdir = getenv("TEMP");
+  }
+  if (!test_tmpdir) {
+    std::cerr << "TEST_TMPDIR/TMPDIR/TEMP not defined\n";
+    exit(1);
+  }
+  std::random_device d;
+  std::uint64_t random = (static_cast<std::uint64_t>(d()) << 32) | d();
+  char unique_path[256];
+  snprintf(unique_path, sizeof unique_path, "%s/iree_test_%" PRIx64 "_%s",
+           test_tmpdir, random, unique_name);
+  return unique_path;
+}
+
+iree_io_parameter_t MakeParameter(const char* name, const std::string& data) {
+  iree_io_parameter_t parameter;
+  parameter.name = iree_make_cstring_view(name);
+  parameter.data = iree_make_const_byte_span(data.data(), data.size());
+  return parameter;
+}
+
+TEST(ParameterArchiveTest, WriteOpenLookup) {
+  std::string path = GetUniquePath("WriteOpenLookup.irpa");
+  std::string data_a(5000, 'a');
+  std::string data_b = "hello";
+  std::string data_c;  // empty parameters are allowed
+  // Intentionally unsorted to exercise the writer sorting.
+  iree_io_parameter_t parameters[] = {
+      MakeParameter("weights.b", data_b),
+      MakeParameter("weights.a", data_a),
+      MakeParameter("weights.c", data_c),
+  };
+  IREE_ASSERT_OK(iree_io_parameter_archive_write_file(
+      path.c_str(), IREE_ARRAYSIZE(parameters), parameters,
+      iree_allocator_system()));
+
+  iree_io_parameter_archive_t* archive = NULL;
+  IREE_ASSERT_OK(iree_io_parameter_archive_open_file(
+      path.c_str(), iree_allocator_system(), &archive));
+  EXPECT_EQ(3, iree_io_parameter_archive_entry_count(archive));
+
+  for (const auto& parameter : parameters) {
+    iree_const_byte_span_t data = iree_const_byte_span_empty();
+    IREE_ASSERT_OK(
+        iree_io_parameter_archive_lookup(archive, parameter.name, &data));
+    ASSERT_EQ(parameter.data.data_length, data.data_length);
+    EXPECT_EQ(0, memcmp(parameter.data.data, data.data, data.data_length));
+    if (data.data_length) {
+      // Data must be aligned for direct device import.
+      EXPECT_EQ(0, reinterpret_cast<uintptr_t>(data.data) %
+                       IREE_IO_PARAMETER_ARCHIVE_DATA_ALIGNMENT);
+    }
+  }
+
+  iree_const_byte_span_t data = iree_const_byte_span_empty();
+  EXPECT_THAT(Status(iree_io_parameter_archive_lookup(
+                  archive, IREE_SV("weights.d"), &data)),
+              StatusIs(StatusCode::kNotFound));
+
+  iree_io_parameter_archive_release(archive);
+  remove(path.c_str());
+}
+
+TEST(ParameterArchiveTest, RejectsInvalidContents) {
+  std::vector<uint8_t> contents(sizeof(iree_io_parameter_archive_header_t));
+  iree_io_parameter_archive_t* archive = NULL;
+  EXPECT_THAT(Status(iree_io_parameter_archive_create_from_memory(
+                  iree_make_const_byte_span(contents.data(), contents.size()),
+                  iree_allocator_null(), iree_allocator_system(), &archive)),
+              StatusIs(StatusCode::kInvalidArgument));
+  EXPECT_EQ(NULL, archive);
+
+  // A valid header referencing an out-of-bounds entry table.
+  iree_io_parameter_archive_header_t header;
+  memset(&header, 0, sizeof(header));
+  header.magic = IREE_IO_PARAMETER_ARCHIVE_MAGIC;
+  header.version = IREE_IO_PARAMETER_ARCHIVE_VERSION_0;
+  header.entry_count = 1;
+  header.entry_table_offset = sizeof(header);
+  memcpy(contents.data(), &header, sizeof(header));
+  EXPECT_THAT(Status(iree_io_parameter_archive_create_from_memory(
+                  iree_make_const_byte_span(contents.data(), contents.size()),
+                  iree_allocator_null(), iree_allocator_system(), &archive)),
+              StatusIs(StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace iree
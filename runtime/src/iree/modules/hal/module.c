@@ -32,6 +32,10 @@
 // provided.
 #define IREE_HAL_MODULE_MAX_COMMAND_BUFFER_BINDING_COUNT ((iree_host_size_t)256)
 
+// Limit the number of push constants in a single inline command. Matches the
+// limits of the HAL drivers we have today.
+#define IREE_HAL_MODULE_MAX_PUSH_CONSTANT_COUNT ((iree_host_size_t)64)
+
 //===----------------------------------------------------------------------===//
 // Module type definitions
 //===----------------------------------------------------------------------===//
@@ -69,8 +73,42 @@ typedef struct iree_hal_module_state_t {
   // executables like ones for training vs inference in the same model, or just
   // always use this.
   iree_hal_executable_cache_t* executable_cache;
+
+  // Counters collected when IREE_HAL_MODULE_FLAG_STATISTICS is set.
+  iree_hal_module_statistics_t statistics;
+  // Time the wait of a fence await yielded to the scheduler began at.
+  // Only one wait may be pending at a time as the context is
+  // thread-compatible and invocations block on their waits.
+  iree_time_t wait_start_time;
 } iree_hal_module_state_t;
 
+static bool iree_hal_module_state_collects_statistics(
+    const iree_hal_module_state_t* state) {
+  return iree_all_bits_set(state->flags, IREE_HAL_MODULE_FLAG_STATISTICS);
+}
+
+// Returns the time a queue operation begins at for
+// iree_hal_module_state_end_submit or 0 if statistics are not collected.
+static iree_time_t iree_hal_module_state_begin_submit(
+    const iree_hal_module_state_t* state) {
+  return iree_hal_module_state_collects_statistics(state) ? iree_time_now()
+                                                          : 0;
+}
+
+// Records a queue operation that began at |start_time|.
+static void iree_hal_module_state_end_submit(iree_hal_module_state_t* state,
+                                             iree_time_t start_time) {
+  if (!iree_hal_module_state_collects_statistics(state)) return;
+  ++state->statistics.submit_count;
+  state->statistics.submit_duration += iree_time_now() - start_time;
+}
+
+static void iree_hal_module_state_record_transfer(
+    iree_hal_module_state_t* state, iree_device_size_t length) {
+  if (!iree_hal_module_state_collects_statistics(state)) return;
+  state->statistics.transfer_bytes += (uint64_t)length;
+}
+
 static void IREE_API_PTR iree_hal_module_destroy(void* base_module) {
   iree_hal_module_t* module = IREE_HAL_MODULE_CAST(base_module);
   iree_hal_device_release(module->shared_device);
@@ -219,6 +257,7 @@ IREE_VM_ABI_EXPORT(iree_hal_module_allocator_allocate_initialized,  //
           iree_make_const_byte_span(source->data.data + offset, length),
           &buffer),
       "failed to allocate buffer of length %" PRIdsz, length);
+  iree_hal_module_state_record_transfer(state, length);
 
   rets->r0 = iree_hal_buffer_move_ref(buffer);
   return iree_ok_status();
@@ -383,6 +422,7 @@ IREE_VM_ABI_EXPORT(iree_hal_module_buffer_load,  //
   IREE_RETURN_IF_ERROR(iree_hal_device_transfer_d2h(
       state->shared_device, source_buffer, source_offset, &target_buffer,
       length, IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout()));
+  iree_hal_module_state_record_transfer(state, length);
 
   rets->i0 = target_buffer;
   return iree_ok_status();
@@ -409,6 +449,7 @@ IREE_VM_ABI_EXPORT(iree_hal_module_buffer_store,  //
                             iree_hal_buffer_byte_length(target_buffer));
   }
 
+  iree_hal_module_state_record_transfer(state, length);
   return iree_hal_device_transfer_h2d(
       state->shared_device, &value, target_buffer, target_offset, length,
       IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout());
@@ -708,6 +749,7 @@ IREE_VM_ABI_EXPORT(iree_hal_module_command_buffer_copy_buffer,  //
   iree_device_size_t target_offset = iree_hal_cast_device_size(args->i4);
   iree_device_size_t length = iree_hal_cast_device_size(args->i5);
 
+  iree_hal_module_state_record_transfer(state, length);
   return iree_hal_command_buffer_copy_buffer(command_buffer, source_buffer,
                                              source_offset, target_buffer,
                                              target_offset, length);
@@ -864,6 +906,239 @@ IREE_VM_ABI_EXPORT(iree_hal_module_command_buffer_execute_commands,  //
                                                   binding_table);
 }
 
+// Opcodes of the packed command stream recorded by
+// hal.command_buffer.execute_commands_inline. Must match InlineCommand in
+// compiler/src/iree/compiler/Dialect/HAL/Transforms/
+// BatchCommandBufferCommands.cpp.
+typedef enum iree_hal_module_inline_command_e {
+  IREE_HAL_MODULE_INLINE_COMMAND_DISPATCH = 1,
+  IREE_HAL_MODULE_INLINE_COMMAND_PUSH_CONSTANTS = 2,
+  IREE_HAL_MODULE_INLINE_COMMAND_PUSH_DESCRIPTOR_SET = 3,
+  IREE_HAL_MODULE_INLINE_COMMAND_EXECUTION_BARRIER = 4,
+} iree_hal_module_inline_command_t;
+
+// Cursor over a packed command stream and the operand slots it references.
+typedef struct iree_hal_module_command_stream_t {
+  const uint32_t* words;
+  iree_host_size_t word_count;
+  iree_host_size_t word_offset;
+  const iree_vm_abi_rrrI_t* operands;
+  iree_host_size_t operand_count;
+} iree_hal_module_command_stream_t;
+
+// Reads the next |count| words from |stream|.
+static iree_status_t iree_hal_module_command_stream_read(
+    iree_hal_module_command_stream_t* stream, iree_host_size_t count,
+    const uint32_t** out_words) {
+  if (IREE_UNLIKELY(count > stream->word_count - stream->word_offset)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "command stream truncated at word %" PRIhsz,
+                            stream->word_offset);
+  }
+  *out_words = stream->words + stream->word_offset;
+  stream->word_offset += count;
+  return iree_ok_status();
+}
+
+// Returns the operands at |slot| referenced from the command stream.
+static iree_status_t iree_hal_module_command_stream_operand(
+    const iree_hal_module_command_stream_t* stream, uint32_t slot,
+    const iree_vm_abi_rrrI_t** out_operand) {
+  if (IREE_UNLIKELY(slot >= stream->operand_count)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "command operand slot %u >= %" PRIhsz, slot,
+                            stream->operand_count);
+  }
+  *out_operand = &stream->operands[slot];
+  return iree_ok_status();
+}
+
+// Returns the value at |slot| referenced from the command stream.
+static iree_status_t iree_hal_module_command_stream_value(
+    const iree_hal_module_command_stream_t* stream, uint32_t slot,
+    int64_t* out_value) {
+  const iree_vm_abi_rrrI_t* operand = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_module_command_stream_operand(stream, slot, &operand));
+  *out_value = operand->i3;
+  return iree_ok_status();
+}
+
+// Returns the pipeline layout at |slot| referenced from the command stream.
+static iree_status_t iree_hal_module_command_stream_pipeline_layout(
+    const iree_hal_module_command_stream_t* stream, uint32_t slot,
+    iree_hal_pipeline_layout_t** out_pipeline_layout) {
+  const iree_vm_abi_rrrI_t* operand = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_module_command_stream_operand(stream, slot, &operand));
+  return iree_hal_pipeline_layout_check_deref(operand->r1, out_pipeline_layout);
+}
+
+// DISPATCH: executable slot, entry point, workgroup x/y/z value slots.
+static iree_status_t iree_hal_module_command_stream_dispatch(
+    iree_hal_command_buffer_t* command_buffer,
+    iree_hal_module_command_stream_t* stream) {
+  const uint32_t* words = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_module_command_stream_read(stream, 5, &words));
+  const iree_vm_abi_rrrI_t* operand = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_module_command_stream_operand(stream, words[0], &operand));
+  iree_hal_executable_t* executable = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_executable_check_deref(operand->r0, &executable));
+  uint32_t entry_point = words[1];
+  int64_t workgroup_count[3] = {0};
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(workgroup_count); ++i) {
+    IREE_RETURN_IF_ERROR(iree_hal_module_command_stream_value(
+        stream, words[2 + i], &workgroup_count[i]));
+  }
+  return iree_hal_command_buffer_dispatch(
+      command_buffer, executable, entry_point, (uint32_t)workgroup_count[0],
+      (uint32_t)workgroup_count[1], (uint32_t)workgroup_count[2]);
+}
+
+// PUSH_CONSTANTS: layout slot, offset, count, one value slot per constant.
+static iree_status_t iree_hal_module_command_stream_push_constants(
+    iree_hal_command_buffer_t* command_buffer,
+    iree_hal_module_command_stream_t* stream) {
+  const uint32_t* words = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_module_command_stream_read(stream, 3, &words));
+  iree_hal_pipeline_layout_t* pipeline_layout = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_module_command_stream_pipeline_layout(
+      stream, words[0], &pipeline_layout));
+  iree_host_size_t offset = words[1];
+  iree_host_size_t value_count = words[2];
+  if (IREE_UNLIKELY(value_count > IREE_HAL_MODULE_MAX_PUSH_CONSTANT_COUNT)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "push constant count %" PRIhsz " > %" PRIhsz,
+                            value_count,
+                            IREE_HAL_MODULE_MAX_PUSH_CONSTANT_COUNT);
+  }
+  const uint32_t* value_slots = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_module_command_stream_read(stream, value_count, &value_slots));
+  uint32_t values[IREE_HAL_MODULE_MAX_PUSH_CONSTANT_COUNT];
+  for (iree_host_size_t i = 0; i < value_count; ++i) {
+    int64_t value = 0;
+    IREE_RETURN_IF_ERROR(
+        iree_hal_module_command_stream_value(stream, value_slots[i], &value));
+    values[i] = (uint32_t)value;
+  }
+  return iree_hal_command_buffer_push_constants(
+      command_buffer, pipeline_layout, offset * sizeof(uint32_t), values,
+      value_count * sizeof(uint32_t));
+}
+
+// PUSH_DESCRIPTOR_SET: layout slot, set, count, and per binding its ordinal,
+// buffer slot, and offset/length value slots.
+static iree_status_t iree_hal_module_command_stream_push_descriptor_set(
+    iree_hal_command_buffer_t* command_buffer,
+    iree_hal_module_command_stream_t* stream) {
+  const uint32_t* words = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_module_command_stream_read(stream, 3, &words));
+  iree_hal_pipeline_layout_t* pipeline_layout = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_module_command_stream_pipeline_layout(
+      stream, words[0], &pipeline_layout));
+  uint32_t set = words[1];
+  iree_host_size_t binding_count = words[2];
+  if (IREE_UNLIKELY(binding_count >
+                    IREE_HAL_MODULE_MAX_DESCRIPTOR_BINDING_COUNT)) {
+    return iree_make_status(
+        IREE_STATUS_OUT_OF_RANGE, "binding count %" PRIhsz " > %" PRIhsz,
+        binding_count, IREE_HAL_MODULE_MAX_DESCRIPTOR_BINDING_COUNT);
+  }
+  iree_hal_descriptor_set_binding_t
+      bindings[IREE_HAL_MODULE_MAX_DESCRIPTOR_BINDING_COUNT];
+  for (iree_host_size_t i = 0; i < binding_count; ++i) {
+    const uint32_t* binding_words = NULL;
+    IREE_RETURN_IF_ERROR(
+        iree_hal_module_command_stream_read(stream, 4, &binding_words));
+    const iree_vm_abi_rrrI_t* operand = NULL;
+    IREE_RETURN_IF_ERROR(iree_hal_module_command_stream_operand(
+        stream, binding_words[1], &operand));
+    int64_t offset = 0;
+    IREE_RETURN_IF_ERROR(iree_hal_module_command_stream_value(
+        stream, binding_words[2], &offset));
+    int64_t length = 0;
+    IREE_RETURN_IF_ERROR(iree_hal_module_command_stream_value(
+        stream, binding_words[3], &length));
+    bindings[i].binding = binding_words[0];
+    bindings[i].buffer_slot = 0;
+    IREE_RETURN_IF_ERROR(
+        iree_hal_buffer_check_deref(operand->r2, &bindings[i].buffer));
+    bindings[i].offset = iree_hal_cast_device_size(offset);
+    bindings[i].length = iree_hal_cast_device_size(length);
+  }
+  return iree_hal_command_buffer_push_descriptor_set(
+      command_buffer, pipeline_layout, set, binding_count, bindings);
+}
+
+// EXECUTION_BARRIER: source stage mask, target stage mask, flags.
+static iree_status_t iree_hal_module_command_stream_execution_barrier(
+    iree_hal_command_buffer_t* command_buffer,
+    iree_hal_module_command_stream_t* stream) {
+  const uint32_t* words = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_module_command_stream_read(stream, 3, &words));
+  iree_hal_memory_barrier_t global_barrier;
+  global_barrier.source_scope = IREE_HAL_ACCESS_SCOPE_DISPATCH_WRITE;
+  global_barrier.target_scope = IREE_HAL_ACCESS_SCOPE_DISPATCH_READ;
+  return iree_hal_command_buffer_execution_barrier(
+      command_buffer, (iree_hal_execution_stage_t)words[0],
+      (iree_hal_execution_stage_t)words[1],
+      (iree_hal_execution_barrier_flags_t)words[2], 1, &global_barrier, 0,
+      NULL);
+}
+
+IREE_VM_ABI_EXPORT(iree_hal_module_command_buffer_execute_commands_inline,  //
+                   iree_hal_module_state_t,                                 //
+                   rrCrrrID, v) {
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_command_buffer_check_deref(args->r0, &command_buffer));
+  iree_vm_buffer_t* commands = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_buffer_check_deref(args->r1, &commands));
+  iree_const_byte_span_t commands_span = iree_const_byte_span_empty();
+  IREE_RETURN_IF_ERROR(iree_vm_buffer_map_ro(
+      commands, 0, iree_vm_buffer_length(commands), sizeof(uint32_t),
+      &commands_span));
+
+  iree_hal_module_command_stream_t stream = {
+      .words = (const uint32_t*)commands_span.data,
+      .word_count = commands_span.data_length / sizeof(uint32_t),
+      .word_offset = 0,
+      .operands = args->a2,
+      .operand_count = args->a2_count,
+  };
+  while (stream.word_offset < stream.word_count) {
+    const uint32_t* opcode = NULL;
+    IREE_RETURN_IF_ERROR(
+        iree_hal_module_command_stream_read(&stream, 1, &opcode));
+    switch (*opcode) {
+      case IREE_HAL_MODULE_INLINE_COMMAND_DISPATCH:
+        IREE_RETURN_IF_ERROR(
+            iree_hal_module_command_stream_dispatch(command_buffer, &stream));
+        break;
+      case IREE_HAL_MODULE_INLINE_COMMAND_PUSH_CONSTANTS:
+        IREE_RETURN_IF_ERROR(iree_hal_module_command_stream_push_constants(
+            command_buffer, &stream));
+        break;
+      case IREE_HAL_MODULE_INLINE_COMMAND_PUSH_DESCRIPTOR_SET:
+        IREE_RETURN_IF_ERROR(iree_hal_module_command_stream_push_descriptor_set(
+            command_buffer, &stream));
+        break;
+      case IREE_HAL_MODULE_INLINE_COMMAND_EXECUTION_BARRIER:
+        IREE_RETURN_IF_ERROR(iree_hal_module_command_stream_execution_barrier(
+            command_buffer, &stream));
+        break;
+      default:
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "unknown inline command %u at word %" PRIhsz,
+                                *opcode, stream.word_offset - 1);
+    }
+  }
+  return iree_ok_status();
+}
+
 //===----------------------------------------------------------------------===//
 // iree_hal_descriptor_set_layout
 //===----------------------------------------------------------------------===//
@@ -951,10 +1226,12 @@ IREE_VM_ABI_EXPORT(iree_hal_module_device_queue_alloca,  //
       .usage = buffer_usage,
   };
   iree_hal_buffer_t* buffer = NULL;
+  iree_time_t start_time = iree_hal_module_state_begin_submit(state);
   IREE_RETURN_IF_ERROR(iree_hal_device_queue_alloca(
       device, queue_affinity, iree_hal_fence_semaphore_list(wait_fence),
       iree_hal_fence_semaphore_list(signal_fence), pool, params,
       allocation_size, &buffer));
+  iree_hal_module_state_end_submit(state, start_time);
 
   rets->r0 = iree_hal_buffer_move_ref(buffer);
   return iree_ok_status();
@@ -971,9 +1248,12 @@ IREE_VM_ABI_EXPORT(iree_hal_module_device_queue_dealloca,  //
   iree_hal_fence_t* signal_fence = iree_hal_fence_deref(args->r3);
   iree_hal_buffer_t* buffer = NULL;
   IREE_RETURN_IF_ERROR(iree_hal_buffer_check_deref(args->r4, &buffer));
-  return iree_hal_device_queue_dealloca(
+  iree_time_t start_time = iree_hal_module_state_begin_submit(state);
+  iree_status_t status = iree_hal_device_queue_dealloca(
       device, queue_affinity, iree_hal_fence_semaphore_list(wait_fence),
       iree_hal_fence_semaphore_list(signal_fence), buffer);
+  iree_hal_module_state_end_submit(state, start_time);
+  return status;
 }
 
 IREE_VM_ABI_EXPORT(iree_hal_module_device_queue_execute,  //
@@ -989,10 +1269,13 @@ IREE_VM_ABI_EXPORT(iree_hal_module_device_queue_execute,  //
   iree_hal_command_buffer_t** command_buffers = NULL;
   IREE_VM_ABI_VLA_STACK_DEREF(args, a4_count, a4, iree_hal_command_buffer, 32,
                               &command_buffer_count, &command_buffers);
-  return iree_hal_device_queue_execute(
+  iree_time_t start_time = iree_hal_module_state_begin_submit(state);
+  iree_status_t status = iree_hal_device_queue_execute(
       device, queue_affinity, iree_hal_fence_semaphore_list(wait_fence),
       iree_hal_fence_semaphore_list(signal_fence), command_buffer_count,
       command_buffers);
+  iree_hal_module_state_end_submit(state, start_time);
+  return status;
 }
 
 IREE_VM_ABI_EXPORT(iree_hal_module_device_queue_flush,  //
@@ -1002,7 +1285,10 @@ IREE_VM_ABI_EXPORT(iree_hal_module_device_queue_flush,  //
   IREE_RETURN_IF_ERROR(iree_hal_device_check_deref(args->r0, &device));
   iree_hal_queue_affinity_t queue_affinity =
       (iree_hal_queue_affinity_t)args->i1;
-  return iree_hal_device_queue_flush(device, queue_affinity);
+  iree_time_t start_time = iree_hal_module_state_begin_submit(state);
+  iree_status_t status = iree_hal_device_queue_flush(device, queue_affinity);
+  iree_hal_module_state_end_submit(state, start_time);
+  return status;
 }
 
 //===--------------------------------------------------------------------===//
@@ -1306,6 +1592,9 @@ IREE_VM_ABI_EXPORT(iree_hal_module_fence_await,  //
     // If all fences have been reached we can exit early as if we waited
     // successfully.
     if (fence_count > 0) {
+      if (iree_hal_module_state_collects_statistics(state)) {
+        state->wait_start_time = iree_time_now();
+      }
       if (iree_all_bits_set(state->flags, IREE_HAL_MODULE_FLAG_SYNCHRONOUS)) {
         // Block the native thread until the fence is reached or the deadline is
         // exceeded.
@@ -1332,6 +1621,13 @@ IREE_VM_ABI_EXPORT(iree_hal_module_fence_await,  //
     IREE_TRACE(zone_id = wait_result.trace_zone);
   }
 
+  // The wait either completed inline or the invocation resumed after the
+  // scheduler resolved it.
+  if (state->wait_start_time && !iree_status_is_deferred(wait_status)) {
+    state->statistics.wait_duration += iree_time_now() - state->wait_start_time;
+    state->wait_start_time = 0;
+  }
+
   iree_status_t status = iree_ok_status();
   if (iree_status_is_ok(wait_status)) {
     // Successful wait.
@@ -1477,3 +1773,12 @@ IREE_API_EXPORT iree_hal_device_t* iree_hal_module_state_device(
   iree_hal_module_state_t* state = (iree_hal_module_state_t*)module_state;
   return state->shared_device;
 }
+
+IREE_API_EXPORT void iree_hal_module_state_query_statistics(
+    iree_vm_module_state_t* module_state,
+    iree_hal_module_statistics_t* out_statistics) {
+  IREE_ASSERT_ARGUMENT(module_state);
+  IREE_ASSERT_ARGUMENT(out_statistics);
+  iree_hal_module_state_t* state = (iree_hal_module_state_t*)module_state;
+  *out_statistics = state->statistics;
+}
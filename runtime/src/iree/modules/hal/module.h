@@ -23,9 +23,31 @@ enum iree_hal_module_flag_bits_t {
 
   // Forces HAL methods to block instead of yielding as a coroutine.
   IREE_HAL_MODULE_FLAG_SYNCHRONOUS = 1u << 0,
+
+  // Collects the counters returned by iree_hal_module_state_query_statistics.
+  // Adds a clock read around every queue operation and fence wait.
+  IREE_HAL_MODULE_FLAG_STATISTICS = 1u << 1,
 };
 typedef uint32_t iree_hal_module_flags_t;
 
+// Cumulative counters of the work issued through a HAL module state.
+// Only collected when the module is created with
+// IREE_HAL_MODULE_FLAG_STATISTICS; callers interested in a single call should
+// compute the difference of the values queried before and after it.
+typedef struct iree_hal_module_statistics_t {
+  // Number of queue operations (allocas, deallocas, executes and flushes).
+  uint64_t submit_count;
+  // Host time spent issuing queue operations.
+  iree_duration_t submit_duration;
+  // Host time spent waiting on fences, including time the invocation was
+  // suspended while yielding a wait to the scheduler.
+  iree_duration_t wait_duration;
+  // Bytes uploaded with initialized allocations, moved by host loads and
+  // stores and copied by commands recorded into command buffers. Recorded
+  // commands are counted once regardless of how many times they execute.
+  uint64_t transfer_bytes;
+} iree_hal_module_statistics_t;
+
 // Creates the HAL module initialized to use a specific |device|.
 // Each context using this module will share the device and have compatible
 // allocations.
@@ -39,6 +61,13 @@ IREE_API_EXPORT iree_status_t iree_hal_module_create(
 IREE_API_EXPORT iree_hal_device_t* iree_hal_module_state_device(
     iree_vm_module_state_t* module_state);
 
+// Returns the cumulative counters of |module_state| in |out_statistics|.
+// All counters are zero unless the module was created with
+// IREE_HAL_MODULE_FLAG_STATISTICS.
+IREE_API_EXPORT void iree_hal_module_state_query_statistics(
+    iree_vm_module_state_t* module_state,
+    iree_hal_module_statistics_t* out_statistics);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -0,0 +1,267 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/modules/io/parameters/module.h"
+
+#include <string.h>
+
+#include "iree/base/api.h"
+#include "iree/base/tracing.h"
+#include "iree/vm/api.h"
+
+#define IREE_IO_PARAMETERS_MODULE_VERSION_0_0 0x00000000u
+#define IREE_IO_PARAMETERS_MODULE_VERSION_LATEST \
+  IREE_IO_PARAMETERS_MODULE_VERSION_0_0
+
+//===----------------------------------------------------------------------===//
+// Module type definitions
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_io_parameters_module_t {
+  iree_allocator_t host_allocator;
+  iree_host_size_t archive_count;
+  iree_io_parameter_archive_t* archives[];
+} iree_io_parameters_module_t;
+
+#define IREE_IO_PARAMETERS_MODULE_CAST(module)        \
+  (iree_io_parameters_module_t*)((uint8_t*)(module) + \
+                                 iree_vm_native_module_size());
+
+typedef struct iree_io_parameters_module_state_t {
+  iree_allocator_t host_allocator;
+  const iree_io_parameters_module_t* module;
+} iree_io_parameters_module_state_t;
+
+static void IREE_API_PTR iree_io_parameters_module_destroy(void* base_module) {
+  iree_io_parameters_module_t* module =
+      IREE_IO_PARAMETERS_MODULE_CAST(base_module);
+  for (iree_host_size_t i = 0; i < module->archive_count; ++i) {
+    iree_io_parameter_archive_release(module->archives[i]);
+  }
+}
+
+static iree_status_t IREE_API_PTR iree_io_parameters_module_alloc_state(
+    void* self, iree_allocator_t host_allocator,
+    iree_vm_module_state_t** out_module_state) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_io_parameters_module_state_t* state = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0,
+      iree_allocator_malloc(host_allocator, sizeof(*state), (void**)&state));
+  memset(state, 0, sizeof(*state));
+  state->host_allocator = host_allocator;
+  state->module = IREE_IO_PARAMETERS_MODULE_CAST(self);
+
+  *out_module_state = (iree_vm_module_state_t*)state;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static void IREE_API_PTR iree_io_parameters_module_free_state(
+    void* self, iree_vm_module_state_t* module_state) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_io_parameters_module_state_t* state =
+      (iree_io_parameters_module_state_t*)module_state;
+  iree_allocator_free(state->host_allocator, state);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+//===----------------------------------------------------------------------===//
+// Parameter buffers
+//===----------------------------------------------------------------------===//
+
+// A VM buffer referencing parameter data in an archive. The archive is kept
+// alive for as long as the buffer is referenced.
+typedef struct iree_io_parameter_buffer_t {
+  // Must be first: the VM frees the buffer pointer with its allocator.
+  iree_vm_buffer_t buffer;
+  iree_allocator_t host_allocator;
+  iree_io_parameter_archive_t* archive;
+} iree_io_parameter_buffer_t;
+
+static iree_status_t iree_io_parameter_buffer_allocator_ctl(
+    void* self, iree_allocator_command_t command, const void* params,
+    void** inout_ptr) {
+  if (command != IREE_ALLOCATOR_COMMAND_FREE) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "parameter buffer allocator must only be used to "
+                            "free parameter buffers");
+  }
+  iree_io_parameter_buffer_t* parameter_buffer =
+      (iree_io_parameter_buffer_t*)self;
+  iree_io_parameter_archive_release(parameter_buffer->archive);
+  iree_allocator_free(parameter_buffer->host_allocator, parameter_buffer);
+  return iree_ok_status();
+}
+
+// Wraps |data| from |archive| in a read-only VM buffer retaining the archive.
+static iree_status_t iree_io_parameter_buffer_create(
+    iree_io_parameter_archive_t* archive, iree_const_byte_span_t data,
+    iree_allocator_t host_allocator, iree_vm_buffer_t** out_buffer) {
+  iree_io_parameter_buffer_t* parameter_buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(host_allocator,
+                                             sizeof(*parameter_buffer),
+                                             (void**)&parameter_buffer));
+  parameter_buffer->host_allocator = host_allocator;
+  parameter_buffer->archive = archive;
+  iree_io_parameter_archive_retain(archive);
+  const iree_allocator_t deallocator = {
+      .self = parameter_buffer,
+      .ctl = iree_io_parameter_buffer_allocator_ctl,
+  };
+  iree_vm_buffer_initialize(
+      IREE_VM_BUFFER_ACCESS_ORIGIN_HOST,
+      iree_make_byte_span((void*)data.data, data.data_length), deallocator,
+      &parameter_buffer->buffer);
+  *out_buffer = &parameter_buffer->buffer;
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// Exported functions
+//===----------------------------------------------------------------------===//
+
+IREE_VM_ABI_EXPORT(iree_io_parameters_module_lookup,  //
+                   iree_io_parameters_module_state_t, r, r) {
+  iree_vm_buffer_t* name_buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_buffer_check_deref(args->r0, &name_buffer));
+  iree_string_view_t name = iree_vm_buffer_as_string(name_buffer);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, name.data, name.size);
+
+  const iree_io_parameters_module_t* parameters_module = state->module;
+  for (iree_host_size_t i = 0; i < parameters_module->archive_count; ++i) {
+    iree_io_parameter_archive_t* archive = parameters_module->archives[i];
+    iree_const_byte_span_t data = iree_const_byte_span_empty();
+    iree_status_t status =
+        iree_io_parameter_archive_lookup(archive, name, &data);
+    if (iree_status_is_not_found(status)) {
+      iree_status_ignore(status);
+      continue;
+    }
+    iree_vm_buffer_t* buffer = NULL;
+    if (iree_status_is_ok(status)) {
+      status = iree_io_parameter_buffer_create(archive, data,
+                                               state->host_allocator, &buffer);
+    }
+    if (iree_status_is_ok(status)) {
+      rets->r0 = iree_vm_buffer_move_ref(buffer);
+    }
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_make_status(IREE_STATUS_NOT_FOUND,
+                          "parameter '%.*s' not found in any of the %zu "
+                          "provided archives",
+                          (int)name.size, name.data,
+                          parameters_module->archive_count);
+}
+
+//===----------------------------------------------------------------------===//
+// VM module interface implementation
+//===----------------------------------------------------------------------===//
+
+// NOTE: this must match the ordering of the iree_io_parameters_module_exports_
+// table.
+static const iree_vm_native_function_ptr_t iree_io_parameters_module_funcs_[] =
+    {
+#define EXPORT_FN(name, target_fn, arg_types, ret_types)       \
+  {                                                            \
+      .shim = (iree_vm_native_function_shim_t)                 \
+          iree_vm_shim_##arg_types##_##ret_types,              \
+      .target = (iree_vm_native_function_target_t)(target_fn), \
+  },
+#include "iree/modules/io/parameters/exports.inl"  // IWYU pragma: keep
+#undef EXPORT_FN
+};
+
+// NOTE: 0 length, but can't express that in C.
+static const iree_vm_native_import_descriptor_t
+    iree_io_parameters_module_imports_[1];
+
+static const iree_vm_native_export_descriptor_t
+    iree_io_parameters_module_exports_[] = {
+#define EXPORT_FN(name, target_fn, arg_types, ret_types)           \
+  {                                                                \
+      .local_name = iree_string_view_literal(name),                \
+      .calling_convention =                                        \
+          iree_string_view_literal("0" #arg_types "_" #ret_types), \
+      .attr_count = 0,                                             \
+      .attrs = NULL,                                               \
+  },
+#include "iree/modules/io/parameters/exports.inl"  // IWYU pragma: keep
+#undef EXPORT_FN
+};
+static_assert(IREE_ARRAYSIZE(iree_io_parameters_module_funcs_) ==
+                  IREE_ARRAYSIZE(iree_io_parameters_module_exports_),
+              "function pointer table must be 1:1 with exports");
+
+static const iree_vm_native_module_descriptor_t
+    iree_io_parameters_module_descriptor_ = {
+        .name = iree_string_view_literal("io_parameters"),
+        .version = IREE_IO_PARAMETERS_MODULE_VERSION_LATEST,
+        .attr_count = 0,
+        .attrs = NULL,
+        .dependency_count = 0,
+        .dependencies = NULL,
+        .import_count = 0,  // workaround for 0-length C struct
+        .imports = iree_io_parameters_module_imports_,
+        .export_count = IREE_ARRAYSIZE(iree_io_parameters_module_exports_),
+        .exports = iree_io_parameters_module_exports_,
+        .function_count = IREE_ARRAYSIZE(iree_io_parameters_module_funcs_),
+        .functions = iree_io_parameters_module_funcs_,
+};
+
+IREE_API_EXPORT iree_status_t iree_io_parameters_module_create(
+    iree_vm_instance_t* instance, iree_host_size_t archive_count,
+    iree_io_parameter_archive_t* const* archives,
+    iree_allocator_t host_allocator, iree_vm_module_t** out_module) {
+  IREE_ASSERT_ARGUMENT(instance);
+  IREE_ASSERT_ARGUMENT(!archive_count || archives);
+  IREE_ASSERT_ARGUMENT(out_module);
+  *out_module = NULL;
+
+  // Setup the interface with the functions we implement ourselves. Any function
+  // we omit will be handled by the base native module.
+  static const iree_vm_module_t interface = {
+      .destroy = iree_io_parameters_module_destroy,
+      .alloc_state = iree_io_parameters_module_alloc_state,
+      .free_state = iree_io_parameters_module_free_state,
+  };
+
+  // Allocate shared module state.
+  iree_host_size_t total_size =
+      iree_vm_native_module_size() + sizeof(iree_io_parameters_module_t) +
+      archive_count * sizeof(iree_io_parameter_archive_t*);
+  iree_vm_module_t* base_module = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_malloc(host_allocator, total_size, (void**)&base_module));
+  memset(base_module, 0, total_size);
+  iree_status_t status = iree_vm_native_module_initialize(
+      &interface, &iree_io_parameters_module_descriptor_, instance,
+      host_allocator, base_module);
+  if (!iree_status_is_ok(status)) {
+    iree_allocator_free(host_allocator, base_module);
+    return status;
+  }
+
+  iree_io_parameters_module_t* module =
+      IREE_IO_PARAMETERS_MODULE_CAST(base_module);
+  module->host_allocator = host_allocator;
+  module->archive_count = archive_count;
+  for (iree_host_size_t i = 0; i < archive_count; ++i) {
+    module->archives[i] = archives[i];
+    iree_io_parameter_archive_retain(archives[i]);
+  }
+
+  *out_module = base_module;
+  return iree_ok_status();
+}
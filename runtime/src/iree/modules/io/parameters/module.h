@@ -0,0 +1,39 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_MODULES_IO_PARAMETERS_MODULE_H_
+#define IREE_MODULES_IO_PARAMETERS_MODULE_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/io/parameter_archive.h"
+#include "iree/vm/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Creates the `io_parameters` module resolving named parameters from
+// |archives|. Archives are searched in order and the first containing a
+// parameter wins so that later archives can provide defaults. Each archive is
+// retained by the module.
+//
+// Programs look up parameters with `io_parameters.lookup(!vm.buffer name) ->
+// !vm.buffer` and receive a read-only buffer referencing the archive contents
+// directly. The buffer can be imported into devices without copies with
+// `hal.allocator.map.byte_buffer` (falling back to allocate+copy when the
+// device cannot import host memory) in the same way as embedded rodata.
+IREE_API_EXPORT iree_status_t iree_io_parameters_module_create(
+    iree_vm_instance_t* instance, iree_host_size_t archive_count,
+    iree_io_parameter_archive_t* const* archives,
+    iree_allocator_t host_allocator, iree_vm_module_t** out_module);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_MODULES_IO_PARAMETERS_MODULE_H_
@@ -42,6 +42,8 @@ EXPORT_FN("floor.2d.f32", iree_uk_x32u_floorf_2d, ukernel_x32u_2d, rIIIrIIIII, v
 EXPORT_FN("log.2d.f32", iree_uk_x32u_logf_2d, ukernel_x32u_2d, rIIIrIIIII, v)
 EXPORT_FN("matmul.f32f32f32", iree_vmvx_matmul_f32f32f32, matmul, rIIrIIrIIIIIi, v)
 EXPORT_FN("matmul.i8i8i32", iree_vmvx_matmul_i8i8i32, matmul, rIIrIIrIIIIIi, v)
+EXPORT_FN("max.2d.f32", iree_uk_x32b_maxf_2d, ukernel_x32b_2d, rIIIrIIIrIIIII, v)
+EXPORT_FN("min.2d.f32", iree_uk_x32b_minf_2d, ukernel_x32b_2d, rIIIrIIIrIIIII, v)
 EXPORT_FN("mmt4d.f32f32f32", iree_vmvx_mmt4d_f32f32f32, mmt4d, rIIrIIrIIIIIiiii, v)
 EXPORT_FN("mmt4d.i8i8i32", iree_vmvx_mmt4d_i8i8i32, mmt4d, rIIrIIrIIIIIiiii, v)
 EXPORT_FN("mul.2d.f32", iree_uk_x32b_mulf_2d, ukernel_x32b_2d, rIIIrIIIrIIIII, v)
@@ -58,6 +60,7 @@ EXPORT_FN("shrs.2d.i32", iree_uk_x32b_shrsi_2d, ukernel_x32b_2d, rIIIrIIIrIIIII,
 EXPORT_FN("shru.2d.i32", iree_uk_x32b_shrui_2d, ukernel_x32b_2d, rIIIrIIIrIIIII, v)
 EXPORT_FN("sub.2d.f32", iree_uk_x32b_subf_2d, ukernel_x32b_2d, rIIIrIIIrIIIII, v)
 EXPORT_FN("sub.2d.i32", iree_uk_x32b_subi_2d, ukernel_x32b_2d, rIIIrIIIrIIIII, v)
+EXPORT_FN("tanh.2d.f32", iree_uk_x32u_tanhf_2d, ukernel_x32u_2d, rIIIrIIIII, v)
 EXPORT_FN("unpack.f32f32", iree_vmvx_unpack_f32f32, unpack, rIIrIIIIIIIIi, v)
 EXPORT_FN("unpack.i32i32", iree_vmvx_unpack_i32i32, unpack, rIIrIIIIIIIIi, v)
 EXPORT_FN("unpack.i8i8", iree_vmvx_unpack_i8i8, unpack, rIIrIIIIIIIIi, v)
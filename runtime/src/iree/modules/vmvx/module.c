@@ -281,7 +281,9 @@ static iree_status_t iree_vm_shim_ukernel_x32b_2d_v(
       // OUT
       out, out_offset, out_stride0, out_stride1,
       // SIZE
-      out_size0, out_size1);
+      out_size0, out_size1,
+      // CPU DATA
+      (const iree_uk_uint64_t*)iree_cpu_data_fields());
 
   IREE_TRACE_ZONE_END(z0);
   return ret == 0
@@ -341,7 +343,9 @@ static iree_status_t iree_vm_shim_ukernel_x32u_2d_v(
       // OUT
       out, out_offset, out_stride0, out_stride1,
       // SIZE
-      out_size0, out_size1);
+      out_size0, out_size1,
+      // CPU DATA
+      (const iree_uk_uint64_t*)iree_cpu_data_fields());
 
   IREE_TRACE_ZONE_END(z0);
   return ret == 0
@@ -13,6 +13,7 @@
 #include "iree/vm/api.h"    // IWYU pragma: export
 
 // Runtime API:
+#include "iree/runtime/batcher.h"   // IWYU pragma: export
 #include "iree/runtime/call.h"      // IWYU pragma: export
 #include "iree/runtime/instance.h"  // IWYU pragma: export
 #include "iree/runtime/session.h"   // IWYU pragma: export
@@ -0,0 +1,683 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/runtime/batcher.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/threading.h"
+#include "iree/base/tracing.h"
+#include "iree/modules/hal/types.h"
+#include "iree/runtime/session.h"
+
+//===----------------------------------------------------------------------===//
+// iree_runtime_batcher_options_t
+//===----------------------------------------------------------------------===//
+
+IREE_API_EXPORT void iree_runtime_batcher_options_initialize(
+    iree_runtime_batcher_options_t* out_options) {
+  memset(out_options, 0, sizeof(*out_options));
+  out_options->max_batch_size = 16;
+  out_options->max_latency = 1000000;  // 1ms
+  out_options->pad_to_max_batch_size = false;
+}
+
+//===----------------------------------------------------------------------===//
+// Utilities
+//===----------------------------------------------------------------------===//
+
+static iree_status_t iree_runtime_batcher_input_at(
+    iree_vm_list_t* inputs, iree_host_size_t i,
+    iree_hal_buffer_view_t** out_buffer_view) {
+  iree_vm_ref_t value = {0};
+  IREE_RETURN_IF_ERROR(iree_vm_list_get_ref_assign(inputs, i, &value));
+  return iree_hal_buffer_view_check_deref(value, out_buffer_view);
+}
+
+// Appends |value| to |list|, retaining it if it is a ref.
+static iree_status_t iree_runtime_batcher_push_variant(
+    iree_vm_list_t* list, const iree_vm_variant_t* value) {
+  if (iree_vm_variant_is_value(*value)) {
+    iree_vm_value_t primitive;
+    primitive.type = value->type.value_type;
+    memcpy(primitive.value_storage, value->value_storage,
+           sizeof(primitive.value_storage));
+    return iree_vm_list_push_value(list, &primitive);
+  } else if (iree_vm_variant_is_ref(*value)) {
+    return iree_vm_list_push_ref_retain(list, &value->ref);
+  }
+  return iree_vm_list_resize(list, iree_vm_list_size(list) + 1);
+}
+
+// Returns the number of bytes in each row of the outer dimension.
+static iree_device_size_t iree_runtime_batcher_row_length(
+    iree_hal_buffer_view_t* buffer_view) {
+  iree_hal_dim_t rows = iree_hal_buffer_view_shape_dims(buffer_view)[0];
+  if (rows == 0) return 0;
+  return iree_hal_buffer_view_byte_length(buffer_view) / rows;
+}
+
+// Returns true if the inputs of |a| and |b| can be concatenated.
+static bool iree_runtime_batcher_inputs_compatible(iree_vm_list_t* a,
+                                                   iree_vm_list_t* b) {
+  iree_host_size_t input_count = iree_vm_list_size(a);
+  if (iree_vm_list_size(b) != input_count) return false;
+  for (iree_host_size_t i = 0; i < input_count; ++i) {
+    iree_hal_buffer_view_t* a_view = NULL;
+    iree_hal_buffer_view_t* b_view = NULL;
+    if (!iree_status_is_ok(iree_runtime_batcher_input_at(a, i, &a_view)) ||
+        !iree_status_is_ok(iree_runtime_batcher_input_at(b, i, &b_view))) {
+      return false;
+    }
+    iree_host_size_t rank = iree_hal_buffer_view_shape_rank(a_view);
+    if (iree_hal_buffer_view_shape_rank(b_view) != rank ||
+        iree_hal_buffer_view_element_type(a_view) !=
+            iree_hal_buffer_view_element_type(b_view) ||
+        iree_hal_buffer_view_encoding_type(a_view) !=
+            iree_hal_buffer_view_encoding_type(b_view)) {
+      return false;
+    }
+    const iree_hal_dim_t* a_dims = iree_hal_buffer_view_shape_dims(a_view);
+    const iree_hal_dim_t* b_dims = iree_hal_buffer_view_shape_dims(b_view);
+    for (iree_host_size_t j = 1; j < rank; ++j) {
+      if (a_dims[j] != b_dims[j]) return false;
+    }
+  }
+  return true;
+}
+
+// Verifies that all |inputs| are buffer views with the same outer dimension
+// and returns that dimension in |out_rows|.
+static iree_status_t iree_runtime_batcher_verify_inputs(
+    iree_vm_list_t* inputs, iree_host_size_t* out_rows) {
+  *out_rows = 0;
+  iree_host_size_t input_count = inputs ? iree_vm_list_size(inputs) : 0;
+  if (input_count == 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "batched requests require at least one input");
+  }
+  for (iree_host_size_t i = 0; i < input_count; ++i) {
+    iree_hal_buffer_view_t* buffer_view = NULL;
+    IREE_RETURN_IF_ERROR(
+        iree_runtime_batcher_input_at(inputs, i, &buffer_view),
+        "batched request input %" PRIhsz " must be a buffer view", i);
+    if (iree_hal_buffer_view_shape_rank(buffer_view) == 0) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "batched request input %" PRIhsz
+                              " must have an outer batch dimension",
+                              i);
+    }
+    iree_host_size_t rows =
+        (iree_host_size_t)iree_hal_buffer_view_shape_dims(buffer_view)[0];
+    if (i == 0) {
+      *out_rows = rows;
+    } else if (rows != *out_rows) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "batched request input %" PRIhsz
+                              " has %" PRIhsz " rows but input 0 has %" PRIhsz,
+                              i, rows, *out_rows);
+    }
+  }
+  if (*out_rows == 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "batched requests must have at least one row");
+  }
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// iree_runtime_batcher_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_runtime_batcher_request_t {
+  struct iree_runtime_batcher_request_t* next;
+  // Retained input list; every element is a buffer view.
+  iree_vm_list_t* inputs;
+  // Outer dimension shared by all inputs.
+  iree_host_size_t rows;
+  // Time the request was submitted used to compute its batching deadline.
+  iree_time_t submit_time_ns;
+  iree_runtime_batcher_callback_t callback;
+} iree_runtime_batcher_request_t;
+
+struct iree_runtime_batcher_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+  iree_runtime_session_t* session;
+  iree_vm_function_t function;
+  iree_runtime_batcher_options_t options;
+
+  // Thread issuing all batched calls.
+  iree_thread_t* thread;
+
+  // Posted whenever a request is enqueued or the batcher begins exiting.
+  iree_notification_t notification;
+
+  // Guards the pending request FIFO.
+  iree_slim_mutex_t mutex;
+  iree_runtime_batcher_request_t* head IREE_GUARDED_BY(mutex);
+  iree_runtime_batcher_request_t* tail IREE_GUARDED_BY(mutex);
+  // Total rows of all pending requests.
+  iree_host_size_t pending_rows IREE_GUARDED_BY(mutex);
+  // Set when the last reference is released; pending requests are drained.
+  bool exiting IREE_GUARDED_BY(mutex);
+  // Set by the thread once it has drained all requests and no longer touches
+  // the batcher.
+  bool exited IREE_GUARDED_BY(mutex);
+};
+
+static void iree_runtime_batcher_request_free(
+    iree_allocator_t host_allocator, iree_runtime_batcher_request_t* request) {
+  iree_vm_list_release(request->inputs);
+  iree_allocator_free(host_allocator, request);
+}
+
+// Waits for requests to arrive and pops the next batch from the FIFO.
+// Returns true if the batcher is exiting.
+static bool iree_runtime_batcher_wait_for_batch(
+    iree_runtime_batcher_t* batcher,
+    iree_runtime_batcher_request_t** out_batch, iree_host_size_t* out_rows) {
+  *out_batch = NULL;
+  *out_rows = 0;
+  iree_slim_mutex_lock(&batcher->mutex);
+
+  // Wait for the first request.
+  while (!batcher->head && !batcher->exiting) {
+    iree_wait_token_t wait_token =
+        iree_notification_prepare_wait(&batcher->notification);
+    iree_slim_mutex_unlock(&batcher->mutex);
+    iree_notification_commit_wait(&batcher->notification, wait_token,
+                                  IREE_DURATION_ZERO,
+                                  IREE_TIME_INFINITE_FUTURE);
+    iree_slim_mutex_lock(&batcher->mutex);
+  }
+
+  // Wait for the batch to fill or the oldest request to reach its deadline.
+  if (batcher->head) {
+    iree_time_t deadline_ns =
+        batcher->options.max_latency == IREE_DURATION_INFINITE
+            ? IREE_TIME_INFINITE_FUTURE
+            : batcher->head->submit_time_ns + batcher->options.max_latency;
+    while (batcher->pending_rows < batcher->options.max_batch_size &&
+           !batcher->exiting) {
+      iree_wait_token_t wait_token =
+          iree_notification_prepare_wait(&batcher->notification);
+      iree_slim_mutex_unlock(&batcher->mutex);
+      bool notified = iree_notification_commit_wait(
+          &batcher->notification, wait_token, IREE_DURATION_ZERO, deadline_ns);
+      iree_slim_mutex_lock(&batcher->mutex);
+      if (!notified) break;
+    }
+  }
+
+  // Pop requests in order while they fit and are compatible with the first.
+  iree_runtime_batcher_request_t* first = batcher->head;
+  iree_runtime_batcher_request_t** batch_tail = out_batch;
+  while (batcher->head &&
+         *out_rows + batcher->head->rows <= batcher->options.max_batch_size &&
+         (batcher->head == first ||
+          iree_runtime_batcher_inputs_compatible(first->inputs,
+                                                 batcher->head->inputs))) {
+    iree_runtime_batcher_request_t* request = batcher->head;
+    batcher->head = request->next;
+    batcher->pending_rows -= request->rows;
+    *out_rows += request->rows;
+    request->next = NULL;
+    *batch_tail = request;
+    batch_tail = &request->next;
+  }
+  if (!batcher->head) batcher->tail = NULL;
+
+  bool exiting = batcher->exiting;
+  iree_slim_mutex_unlock(&batcher->mutex);
+  return exiting;
+}
+
+// Allocates a device buffer view shaped like |template_view| with its outer
+// dimension replaced by |rows|.
+static iree_status_t iree_runtime_batcher_allocate_view(
+    iree_hal_allocator_t* device_allocator,
+    iree_hal_buffer_view_t* template_view, iree_host_size_t rows,
+    iree_hal_buffer_view_t** out_buffer_view) {
+  iree_host_size_t shape_rank = iree_hal_buffer_view_shape_rank(template_view);
+  iree_hal_dim_t* shape =
+      (iree_hal_dim_t*)iree_alloca(shape_rank * sizeof(iree_hal_dim_t));
+  memcpy(shape, iree_hal_buffer_view_shape_dims(template_view),
+         shape_rank * sizeof(iree_hal_dim_t));
+  shape[0] = (iree_hal_dim_t)rows;
+  iree_hal_buffer_params_t buffer_params = {
+      .type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
+      .usage = IREE_HAL_BUFFER_USAGE_DEFAULT,
+  };
+  return iree_hal_buffer_view_allocate_buffer(
+      device_allocator, shape_rank, shape,
+      iree_hal_buffer_view_element_type(template_view),
+      iree_hal_buffer_view_encoding_type(template_view), buffer_params,
+      iree_const_byte_span_empty(), out_buffer_view);
+}
+
+// Concatenates input |i| of every request in |batch| into |batched_view| and
+// zero-fills any remaining padding rows.
+static iree_status_t iree_runtime_batcher_gather_input(
+    iree_runtime_batcher_t* batcher, iree_runtime_batcher_request_t* batch,
+    iree_host_size_t i, iree_hal_buffer_view_t* batched_view) {
+  iree_hal_device_t* device = iree_runtime_session_device(batcher->session);
+  iree_hal_buffer_t* batched_buffer = iree_hal_buffer_view_buffer(batched_view);
+  iree_device_size_t row_length =
+      iree_runtime_batcher_row_length(batched_view);
+
+  iree_device_size_t offset = 0;
+  for (iree_runtime_batcher_request_t* request = batch; request;
+       request = request->next) {
+    iree_hal_buffer_view_t* request_view = NULL;
+    IREE_RETURN_IF_ERROR(
+        iree_runtime_batcher_input_at(request->inputs, i, &request_view));
+    iree_device_size_t length = request->rows * row_length;
+    IREE_RETURN_IF_ERROR(iree_hal_device_transfer_range(
+        device,
+        iree_hal_make_device_transfer_buffer(
+            iree_hal_buffer_view_buffer(request_view)),
+        0, iree_hal_make_device_transfer_buffer(batched_buffer), offset,
+        length, IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT,
+        iree_infinite_timeout()));
+    offset += length;
+  }
+
+  iree_device_size_t total_length =
+      iree_hal_buffer_view_byte_length(batched_view);
+  if (offset >= total_length) return iree_ok_status();
+  iree_device_size_t padding_length = total_length - offset;
+  void* zeros = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      batcher->host_allocator, (iree_host_size_t)padding_length, &zeros));
+  iree_status_t status = iree_hal_device_transfer_h2d(
+      device, zeros, batched_buffer, offset, padding_length,
+      IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout());
+  iree_allocator_free(batcher->host_allocator, zeros);
+  return status;
+}
+
+// Builds the list of batched inputs for the requests in |batch|.
+static iree_status_t iree_runtime_batcher_gather(
+    iree_runtime_batcher_t* batcher, iree_runtime_batcher_request_t* batch,
+    iree_host_size_t batch_size, iree_vm_list_t** out_inputs) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_host_size_t input_count = iree_vm_list_size(batch->inputs);
+  iree_vm_list_t* inputs = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_list_create(/*element_type=*/NULL, input_count,
+                              batcher->host_allocator, &inputs));
+
+  iree_hal_allocator_t* device_allocator =
+      iree_runtime_session_device_allocator(batcher->session);
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < input_count && iree_status_is_ok(status);
+       ++i) {
+    iree_hal_buffer_view_t* template_view = NULL;
+    status = iree_runtime_batcher_input_at(batch->inputs, i, &template_view);
+    iree_hal_buffer_view_t* batched_view = NULL;
+    if (iree_status_is_ok(status)) {
+      status = iree_runtime_batcher_allocate_view(
+          device_allocator, template_view, batch_size, &batched_view);
+    }
+    if (iree_status_is_ok(status)) {
+      status =
+          iree_runtime_batcher_gather_input(batcher, batch, i, batched_view);
+    }
+    if (iree_status_is_ok(status)) {
+      iree_vm_ref_t batched_ref = iree_hal_buffer_view_move_ref(batched_view);
+      status = iree_vm_list_push_ref_move(inputs, &batched_ref);
+      iree_vm_ref_release(&batched_ref);
+    } else {
+      iree_hal_buffer_view_release(batched_view);
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_inputs = inputs;
+  } else {
+    iree_vm_list_release(inputs);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Creates a view of |rows| rows of |buffer_view| starting at |row_offset|
+// that aliases the same device memory.
+static iree_status_t iree_runtime_batcher_slice_view(
+    iree_hal_buffer_view_t* buffer_view, iree_host_size_t row_offset,
+    iree_host_size_t rows, iree_allocator_t host_allocator,
+    iree_hal_buffer_view_t** out_buffer_view) {
+  iree_device_size_t row_length = iree_runtime_batcher_row_length(buffer_view);
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_buffer_subspan(
+      iree_hal_buffer_view_buffer(buffer_view), row_offset * row_length,
+      rows * row_length, &buffer));
+  iree_host_size_t shape_rank = iree_hal_buffer_view_shape_rank(buffer_view);
+  iree_hal_dim_t* shape =
+      (iree_hal_dim_t*)iree_alloca(shape_rank * sizeof(iree_hal_dim_t));
+  memcpy(shape, iree_hal_buffer_view_shape_dims(buffer_view),
+         shape_rank * sizeof(iree_hal_dim_t));
+  shape[0] = (iree_hal_dim_t)rows;
+  iree_status_t status = iree_hal_buffer_view_create(
+      buffer, shape_rank, shape, iree_hal_buffer_view_element_type(buffer_view),
+      iree_hal_buffer_view_encoding_type(buffer_view), host_allocator,
+      out_buffer_view);
+  iree_hal_buffer_release(buffer);
+  return status;
+}
+
+// Builds the outputs of a single request from the batched |outputs|.
+// Buffer views with an outer dimension of |batch_size| are sliced and all
+// other values are shared by every request.
+static iree_status_t iree_runtime_batcher_scatter(
+    iree_runtime_batcher_t* batcher, iree_vm_list_t* outputs,
+    iree_host_size_t batch_size, iree_host_size_t row_offset,
+    iree_host_size_t rows, iree_vm_list_t** out_outputs) {
+  iree_host_size_t output_count = iree_vm_list_size(outputs);
+  iree_vm_list_t* request_outputs = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_list_create(/*element_type=*/NULL,
+                                           output_count,
+                                           batcher->host_allocator,
+                                           &request_outputs));
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < output_count && iree_status_is_ok(status);
+       ++i) {
+    iree_vm_variant_t value = iree_vm_variant_empty();
+    status = iree_vm_list_get_variant(outputs, i, &value);
+    if (!iree_status_is_ok(status)) break;
+    iree_hal_buffer_view_t* buffer_view =
+        iree_vm_variant_is_ref(value) && iree_hal_buffer_view_isa(value.ref)
+            ? iree_hal_buffer_view_deref(value.ref)
+            : NULL;
+    if (buffer_view && iree_hal_buffer_view_shape_rank(buffer_view) > 0 &&
+        iree_hal_buffer_view_shape_dims(buffer_view)[0] == batch_size) {
+      iree_hal_buffer_view_t* slice_view = NULL;
+      status = iree_runtime_batcher_slice_view(buffer_view, row_offset, rows,
+                                               batcher->host_allocator,
+                                               &slice_view);
+      if (iree_status_is_ok(status)) {
+        iree_vm_ref_t slice_ref = iree_hal_buffer_view_move_ref(slice_view);
+        status = iree_vm_list_push_ref_move(request_outputs, &slice_ref);
+        iree_vm_ref_release(&slice_ref);
+      }
+    } else {
+      status = iree_runtime_batcher_push_variant(request_outputs, &value);
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_outputs = request_outputs;
+  } else {
+    iree_vm_list_release(request_outputs);
+  }
+  return status;
+}
+
+// Issues one batched call for the requests in |batch| and completes them.
+static void iree_runtime_batcher_issue(iree_runtime_batcher_t* batcher,
+                                       iree_runtime_batcher_request_t* batch,
+                                       iree_host_size_t rows) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, rows);
+
+  iree_host_size_t batch_size = batcher->options.pad_to_max_batch_size
+                                    ? batcher->options.max_batch_size
+                                    : rows;
+  iree_vm_list_t* inputs = NULL;
+  iree_vm_list_t* outputs = NULL;
+  iree_status_t status =
+      iree_runtime_batcher_gather(batcher, batch, batch_size, &inputs);
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_list_create(/*element_type=*/NULL, 4,
+                                 batcher->host_allocator, &outputs);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_runtime_session_call(batcher->session, &batcher->function,
+                                       inputs, outputs);
+  }
+  iree_vm_list_release(inputs);
+
+  iree_host_size_t row_offset = 0;
+  iree_runtime_batcher_request_t* request = batch;
+  while (request) {
+    iree_runtime_batcher_request_t* next_request = request->next;
+    iree_vm_list_t* request_outputs = NULL;
+    iree_status_t request_status =
+        iree_status_is_ok(status)
+            ? iree_runtime_batcher_scatter(batcher, outputs, batch_size,
+                                           row_offset, request->rows,
+                                           &request_outputs)
+            : iree_status_clone(status);
+    row_offset += request->rows;
+    request->callback.fn(request->callback.user_data, request_status,
+                         request_outputs);
+    iree_vm_list_release(request_outputs);
+    iree_runtime_batcher_request_free(batcher->host_allocator, request);
+    request = next_request;
+  }
+
+  iree_vm_list_release(outputs);
+  iree_status_ignore(status);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static int iree_runtime_batcher_main(void* entry_arg) {
+  iree_runtime_batcher_t* batcher = (iree_runtime_batcher_t*)entry_arg;
+  for (;;) {
+    iree_runtime_batcher_request_t* batch = NULL;
+    iree_host_size_t rows = 0;
+    bool exiting = iree_runtime_batcher_wait_for_batch(batcher, &batch, &rows);
+    if (batch) {
+      iree_runtime_batcher_issue(batcher, batch, rows);
+    } else if (exiting) {
+      break;
+    }
+  }
+  iree_slim_mutex_lock(&batcher->mutex);
+  batcher->exited = true;
+  iree_slim_mutex_unlock(&batcher->mutex);
+  iree_notification_post(&batcher->notification, IREE_ALL_WAITERS);
+  return 0;
+}
+
+IREE_API_EXPORT iree_status_t iree_runtime_batcher_create(
+    iree_runtime_session_t* session, iree_vm_function_t function,
+    const iree_runtime_batcher_options_t* options,
+    iree_allocator_t host_allocator, iree_runtime_batcher_t** out_batcher) {
+  IREE_ASSERT_ARGUMENT(session);
+  IREE_ASSERT_ARGUMENT(options);
+  IREE_ASSERT_ARGUMENT(out_batcher);
+  *out_batcher = NULL;
+  if (options->max_batch_size == 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "max_batch_size must be at least 1");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_runtime_batcher_t* batcher = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*batcher),
+                                (void**)&batcher));
+  iree_atomic_ref_count_init(&batcher->ref_count);
+  batcher->host_allocator = host_allocator;
+  batcher->session = session;
+  iree_runtime_session_retain(session);
+  batcher->function = function;
+  batcher->options = *options;
+  iree_notification_initialize(&batcher->notification);
+  iree_slim_mutex_initialize(&batcher->mutex);
+
+  iree_thread_create_params_t params;
+  memset(&params, 0, sizeof(params));
+  params.name = IREE_SV("iree-batcher");
+  iree_status_t status =
+      iree_thread_create(iree_runtime_batcher_main, batcher, params,
+                         host_allocator, &batcher->thread);
+
+  if (iree_status_is_ok(status)) {
+    *out_batcher = batcher;
+  } else {
+    iree_runtime_batcher_release(batcher);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_runtime_batcher_destroy(iree_runtime_batcher_t* batcher) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Drain all pending requests and join the thread. Releasing the thread only
+  // joins it once it has started and dropped its own reference so wait for it
+  // to exit first.
+  if (batcher->thread) {
+    iree_slim_mutex_lock(&batcher->mutex);
+    batcher->exiting = true;
+    iree_notification_post(&batcher->notification, IREE_ALL_WAITERS);
+    while (!batcher->exited) {
+      iree_wait_token_t wait_token =
+          iree_notification_prepare_wait(&batcher->notification);
+      iree_slim_mutex_unlock(&batcher->mutex);
+      iree_notification_commit_wait(&batcher->notification, wait_token,
+                                    IREE_DURATION_ZERO,
+                                    IREE_TIME_INFINITE_FUTURE);
+      iree_slim_mutex_lock(&batcher->mutex);
+    }
+    iree_slim_mutex_unlock(&batcher->mutex);
+    iree_thread_release(batcher->thread);
+  }
+
+  iree_slim_mutex_deinitialize(&batcher->mutex);
+  iree_notification_deinitialize(&batcher->notification);
+  iree_runtime_session_release(batcher->session);
+  iree_allocator_free(batcher->host_allocator, batcher);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT void iree_runtime_batcher_retain(
+    iree_runtime_batcher_t* batcher) {
+  if (batcher) {
+    iree_atomic_ref_count_inc(&batcher->ref_count);
+  }
+}
+
+IREE_API_EXPORT void iree_runtime_batcher_release(
+    iree_runtime_batcher_t* batcher) {
+  if (batcher && iree_atomic_ref_count_dec(&batcher->ref_count) == 1) {
+    iree_runtime_batcher_destroy(batcher);
+  }
+}
+
+IREE_API_EXPORT iree_status_t iree_runtime_batcher_submit(
+    iree_runtime_batcher_t* batcher, iree_vm_list_t* inputs,
+    iree_runtime_batcher_callback_t callback) {
+  IREE_ASSERT_ARGUMENT(batcher);
+  IREE_ASSERT_ARGUMENT(callback.fn);
+
+  iree_host_size_t rows = 0;
+  IREE_RETURN_IF_ERROR(iree_runtime_batcher_verify_inputs(inputs, &rows));
+  if (rows > batcher->options.max_batch_size) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "request has %" PRIhsz
+                            " rows but the maximum batch size is %" PRIhsz,
+                            rows, batcher->options.max_batch_size);
+  }
+
+  iree_runtime_batcher_request_t* request = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      batcher->host_allocator, sizeof(*request), (void**)&request));
+  request->inputs = inputs;
+  iree_vm_list_retain(inputs);
+  request->rows = rows;
+  request->submit_time_ns = iree_time_now();
+  request->callback = callback;
+
+  iree_slim_mutex_lock(&batcher->mutex);
+  if (batcher->tail) {
+    batcher->tail->next = request;
+  } else {
+    batcher->head = request;
+  }
+  batcher->tail = request;
+  batcher->pending_rows += rows;
+  iree_slim_mutex_unlock(&batcher->mutex);
+  iree_notification_post(&batcher->notification, IREE_ALL_WAITERS);
+  return iree_ok_status();
+}
+
+typedef struct iree_runtime_batcher_call_state_t {
+  // Held by the callback while signaling so the waiter can tell when the
+  // state is no longer referenced.
+  iree_slim_mutex_t mutex;
+  iree_notification_t notification;
+  iree_atomic_int32_t done;
+  iree_status_t status;
+  iree_vm_list_t* outputs;
+} iree_runtime_batcher_call_state_t;
+
+static void iree_runtime_batcher_call_callback(void* user_data,
+                                               iree_status_t status,
+                                               iree_vm_list_t* outputs) {
+  iree_runtime_batcher_call_state_t* state =
+      (iree_runtime_batcher_call_state_t*)user_data;
+  iree_host_size_t output_count = outputs ? iree_vm_list_size(outputs) : 0;
+  for (iree_host_size_t i = 0;
+       i < output_count && iree_status_is_ok(status) && state->outputs; ++i) {
+    iree_vm_variant_t value = iree_vm_variant_empty();
+    status = iree_vm_list_get_variant(outputs, i, &value);
+    if (iree_status_is_ok(status)) {
+      status = iree_runtime_batcher_push_variant(state->outputs, &value);
+    }
+  }
+  iree_slim_mutex_lock(&state->mutex);
+  state->status = status;
+  iree_atomic_store_int32(&state->done, 1, iree_memory_order_release);
+  iree_notification_post(&state->notification, IREE_ALL_WAITERS);
+  iree_slim_mutex_unlock(&state->mutex);
+}
+
+static bool iree_runtime_batcher_call_is_done(void* arg) {
+  iree_runtime_batcher_call_state_t* state =
+      (iree_runtime_batcher_call_state_t*)arg;
+  return iree_atomic_load_int32(&state->done, iree_memory_order_acquire) != 0;
+}
+
+IREE_API_EXPORT iree_status_t iree_runtime_batcher_call(
+    iree_runtime_batcher_t* batcher, iree_vm_list_t* inputs,
+    iree_vm_list_t* outputs) {
+  IREE_ASSERT_ARGUMENT(batcher);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_runtime_batcher_call_state_t state;
+  memset(&state, 0, sizeof(state));
+  iree_slim_mutex_initialize(&state.mutex);
+  iree_notification_initialize(&state.notification);
+  state.outputs = outputs;
+
+  iree_runtime_batcher_callback_t callback = {
+      .fn = iree_runtime_batcher_call_callback,
+      .user_data = &state,
+  };
+  iree_status_t status = iree_runtime_batcher_submit(batcher, inputs, callback);
+  if (iree_status_is_ok(status)) {
+    iree_notification_await(&state.notification,
+                            iree_runtime_batcher_call_is_done, &state,
+                            iree_infinite_timeout());
+    // Wait for the callback to finish signaling before tearing down.
+    iree_slim_mutex_lock(&state.mutex);
+    status = state.status;
+    iree_slim_mutex_unlock(&state.mutex);
+  }
+
+  iree_notification_deinitialize(&state.notification);
+  iree_slim_mutex_deinitialize(&state.mutex);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
@@ -0,0 +1,122 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_RUNTIME_BATCHER_H_
+#define IREE_RUNTIME_BATCHER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/vm/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+typedef struct iree_runtime_session_t iree_runtime_session_t;
+
+//===----------------------------------------------------------------------===//
+// iree_runtime_batcher_options_t
+//===----------------------------------------------------------------------===//
+
+// Options used to configure batcher creation.
+typedef struct iree_runtime_batcher_options_t {
+  // Maximum number of rows (the sum of the outer dimensions of all requests)
+  // in a single batched call. A batch is issued as soon as it is full.
+  iree_host_size_t max_batch_size;
+
+  // Maximum time a request will wait for other requests to join its batch.
+  // IREE_DURATION_ZERO issues whatever has been queued as soon as the batcher
+  // thread wakes.
+  iree_duration_t max_latency;
+
+  // Pads every batch to |max_batch_size| rows with zeros for functions
+  // compiled with a static batch dimension. When false the batch dimension of
+  // the function must be dynamic.
+  bool pad_to_max_batch_size;
+} iree_runtime_batcher_options_t;
+
+// Initializes |out_options| to its default values.
+IREE_API_EXPORT void iree_runtime_batcher_options_initialize(
+    iree_runtime_batcher_options_t* out_options);
+
+//===----------------------------------------------------------------------===//
+// iree_runtime_batcher_t
+//===----------------------------------------------------------------------===//
+
+// Called once a request completes with the |status| of the batched call and
+// the |outputs| belonging to the request. Ownership of |status| transfers to
+// the callback. |outputs| is only valid for the duration of the callback; the
+// callback must retain any values it wants to keep. Called from the batcher
+// thread; callbacks must not block for long as that delays all subsequent
+// batches and must not release the last reference to the batcher.
+typedef void(IREE_API_PTR* iree_runtime_batcher_callback_fn_t)(
+    void* user_data, iree_status_t status, iree_vm_list_t* outputs);
+
+typedef struct iree_runtime_batcher_callback_t {
+  iree_runtime_batcher_callback_fn_t fn;
+  void* user_data;
+} iree_runtime_batcher_callback_t;
+
+// A request-level dynamic batching scheduler for a single function.
+//
+// Servers submit independent requests from any thread and the batcher
+// concatenates compatible requests along their outermost dimension into one
+// call of a function compiled for a batch dimension. A batch is issued once it
+// holds |max_batch_size| rows or its oldest request has waited |max_latency|.
+// Each output with an outer dimension matching the batch is scattered back to
+// the requests as zero-copy subspans of the batched result and any other
+// outputs (such as scalars) are passed to every request.
+//
+// Every input of a request must be a buffer view with the same outer dimension
+// (the number of rows the request contributes). Requests are batched together
+// when all of their inputs have the same element type, encoding, and inner
+// dimensions; batches are always formed in submission order.
+//
+// Batched calls are issued from a dedicated thread owned by the batcher. As
+// sessions are thread-compatible the session must not be used by any other
+// thread while a batcher for it exists.
+//
+// Thread-safe; requests may be submitted concurrently from any thread.
+typedef struct iree_runtime_batcher_t iree_runtime_batcher_t;
+
+// Creates a batcher issuing calls to |function| within |session|.
+// |out_batcher| must be released by the caller.
+IREE_API_EXPORT iree_status_t iree_runtime_batcher_create(
+    iree_runtime_session_t* session, iree_vm_function_t function,
+    const iree_runtime_batcher_options_t* options,
+    iree_allocator_t host_allocator, iree_runtime_batcher_t** out_batcher);
+
+// Retains the given |batcher| for the caller.
+IREE_API_EXPORT void iree_runtime_batcher_retain(
+    iree_runtime_batcher_t* batcher);
+
+// Releases the given |batcher| from the caller. When the last reference is
+// released all pending requests are issued and completed before the batcher
+// thread exits.
+IREE_API_EXPORT void iree_runtime_batcher_release(
+    iree_runtime_batcher_t* batcher);
+
+// Enqueues a request with |inputs| and returns immediately. |callback| will
+// be called exactly once if this returns OK. The input list and its buffer
+// views are retained until the request completes and must not be modified.
+IREE_API_EXPORT iree_status_t iree_runtime_batcher_submit(
+    iree_runtime_batcher_t* batcher, iree_vm_list_t* inputs,
+    iree_runtime_batcher_callback_t callback);
+
+// Enqueues a request with |inputs| and blocks the caller until it completes.
+// The outputs belonging to the request are appended to |outputs|.
+IREE_API_EXPORT iree_status_t iree_runtime_batcher_call(
+    iree_runtime_batcher_t* batcher, iree_vm_list_t* inputs,
+    iree_vm_list_t* outputs);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_RUNTIME_BATCHER_H_
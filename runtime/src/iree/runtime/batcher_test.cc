@@ -0,0 +1,312 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/runtime/batcher.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/modules/hal/types.h"
+#include "iree/runtime/instance.h"
+#include "iree/runtime/session.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/api.h"
+#include "iree/vm/native_module_cc.h"
+
+namespace iree {
+namespace {
+
+// Module with a single `batch.run` function standing in for a model compiled
+// with a dynamic batch dimension. It returns its input unchanged along with
+// the number of rows and the sum of all elements it was called with so tests
+// can observe how requests were batched and padded.
+class BatchModuleState final {
+ public:
+  StatusOr<std::tuple<vm::ref<iree_hal_buffer_view_t>, int32_t, int32_t>> Run(
+      vm::ref<iree_hal_buffer_view_t> input) {
+    iree_hal_buffer_view_t* view = input.get();
+    std::vector<int32_t> contents(iree_hal_buffer_view_element_count(view));
+    IREE_RETURN_IF_ERROR(iree_hal_buffer_map_read(
+        iree_hal_buffer_view_buffer(view), 0, contents.data(),
+        contents.size() * sizeof(int32_t)));
+    int32_t sum = 0;
+    for (int32_t element : contents) sum += element;
+    int32_t rows = (int32_t)iree_hal_buffer_view_shape_dims(view)[0];
+    return std::make_tuple(std::move(input), rows, sum);
+  }
+};
+
+static const vm::NativeFunction<BatchModuleState> kBatchModuleFunctions[] = {
+    vm::MakeNativeFunction("run", &BatchModuleState::Run),
+};
+
+class BatchModule final : public vm::NativeModule<BatchModuleState> {
+ public:
+  using vm::NativeModule<BatchModuleState>::NativeModule;
+
+  StatusOr<std::unique_ptr<BatchModuleState>> CreateState(
+      iree_allocator_t allocator) override {
+    return std::make_unique<BatchModuleState>();
+  }
+};
+
+// Outputs received by a single request.
+struct Result {
+  iree_status_code_t status_code = IREE_STATUS_OK;
+  // Rows and element sum of the batched call the request was part of.
+  int32_t batch_rows = 0;
+  int32_t batch_sum = 0;
+  // Rows and first element of the slice of the output for the request.
+  iree_hal_dim_t rows = 0;
+  int32_t value = 0;
+};
+
+// Collects the results of requests completed on the batcher thread.
+class Collector {
+ public:
+  iree_runtime_batcher_callback_t callback() {
+    iree_runtime_batcher_callback_t callback;
+    callback.fn = Collector::Callback;
+    callback.user_data = this;
+    return callback;
+  }
+
+  // Waits until |count| requests have completed and returns their results in
+  // completion order.
+  std::vector<Result> Wait(size_t count) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [&] { return results_.size() >= count; });
+    return results_;
+  }
+
+  std::vector<Result> results() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return results_;
+  }
+
+ private:
+  static void Callback(void* user_data, iree_status_t status,
+                       iree_vm_list_t* outputs) {
+    auto* collector = reinterpret_cast<Collector*>(user_data);
+    Result result;
+    result.status_code = iree_status_code(status);
+    if (iree_status_is_ok(status)) status = ReadOutputs(outputs, &result);
+    iree_status_ignore(status);
+    std::lock_guard<std::mutex> lock(collector->mutex_);
+    collector->results_.push_back(result);
+    collector->cond_.notify_all();
+  }
+
+  static iree_status_t ReadOutputs(iree_vm_list_t* outputs, Result* result) {
+    iree_hal_buffer_view_t* view =
+        iree_vm_list_get_buffer_view_assign(outputs, 0);
+    if (!view) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT, "no output view");
+    }
+    result->rows = iree_hal_buffer_view_shape_dims(view)[0];
+    IREE_RETURN_IF_ERROR(iree_hal_buffer_map_read(
+        iree_hal_buffer_view_buffer(view), 0, &result->value,
+        sizeof(result->value)));
+    iree_vm_value_t value;
+    IREE_RETURN_IF_ERROR(iree_vm_list_get_value(outputs, 1, &value));
+    result->batch_rows = value.i32;
+    IREE_RETURN_IF_ERROR(iree_vm_list_get_value(outputs, 2, &value));
+    result->batch_sum = value.i32;
+    return iree_ok_status();
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::vector<Result> results_;
+};
+
+class BatcherTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    iree_runtime_instance_options_t instance_options;
+    iree_runtime_instance_options_initialize(&instance_options);
+    iree_runtime_instance_options_use_all_available_drivers(&instance_options);
+    IREE_ASSERT_OK(iree_runtime_instance_create(
+        &instance_options, iree_allocator_system(), &instance_));
+    iree_status_t status = iree_runtime_instance_try_create_default_device(
+        instance_, IREE_SV("local-sync"), &device_);
+    if (iree_status_is_not_found(status)) {
+      fprintf(stderr, "Skipping test as 'local-sync' driver was not found:\n");
+      iree_status_fprint(stderr, status);
+      iree_status_free(status);
+      GTEST_SKIP();
+    }
+    IREE_ASSERT_OK(status);
+
+    iree_runtime_session_options_t session_options;
+    iree_runtime_session_options_initialize(&session_options);
+    IREE_ASSERT_OK(iree_runtime_session_create_with_device(
+        instance_, &session_options, device_, iree_allocator_system(),
+        &session_));
+
+    auto module = std::make_unique<BatchModule>(
+        "batch", /*version=*/0, iree_runtime_instance_vm_instance(instance_),
+        iree_allocator_system(),
+        iree::span<const vm::NativeFunction<BatchModuleState>>(
+            kBatchModuleFunctions));
+    iree_vm_module_t* module_ptr = module.release()->interface();
+    status = iree_runtime_session_append_module(session_, module_ptr);
+    iree_vm_module_release(module_ptr);
+    IREE_ASSERT_OK(status);
+    IREE_ASSERT_OK(iree_runtime_session_lookup_function(
+        session_, IREE_SV("batch.run"), &function_));
+  }
+
+  virtual void TearDown() {
+    iree_runtime_batcher_release(batcher_);
+    iree_runtime_session_release(session_);
+    iree_hal_device_release(device_);
+    iree_runtime_instance_release(instance_);
+  }
+
+  void CreateBatcher(iree_host_size_t max_batch_size,
+                     iree_duration_t max_latency, bool pad) {
+    iree_runtime_batcher_options_t options;
+    iree_runtime_batcher_options_initialize(&options);
+    options.max_batch_size = max_batch_size;
+    options.max_latency = max_latency;
+    options.pad_to_max_batch_size = pad;
+    IREE_ASSERT_OK(iree_runtime_batcher_create(
+        session_, function_, &options, iree_allocator_system(), &batcher_));
+  }
+
+  // Creates a request input list with a |rows|x2xi32 buffer view whose
+  // elements are all |value|.
+  vm::ref<iree_vm_list_t> CreateInputs(iree_hal_dim_t rows, int32_t value) {
+    std::vector<int32_t> contents(rows * 2, value);
+    iree_hal_dim_t shape[2] = {rows, 2};
+    iree_hal_buffer_params_t params;
+    memset(&params, 0, sizeof(params));
+    params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+    params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+    iree_hal_buffer_view_t* buffer_view = NULL;
+    IREE_CHECK_OK(iree_hal_buffer_view_allocate_buffer(
+        iree_hal_device_allocator(device_), IREE_ARRAYSIZE(shape), shape,
+        IREE_HAL_ELEMENT_TYPE_INT_32, IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR,
+        params,
+        iree_make_const_byte_span(contents.data(),
+                                  contents.size() * sizeof(int32_t)),
+        &buffer_view));
+    vm::ref<iree_vm_list_t> inputs;
+    IREE_CHECK_OK(iree_vm_list_create(/*element_type=*/NULL, 1,
+                                      iree_allocator_system(), &inputs));
+    iree_vm_ref_t buffer_view_ref = iree_hal_buffer_view_move_ref(buffer_view);
+    IREE_CHECK_OK(iree_vm_list_push_ref_move(inputs.get(), &buffer_view_ref));
+    return inputs;
+  }
+
+  iree_runtime_instance_t* instance_ = nullptr;
+  iree_hal_device_t* device_ = nullptr;
+  iree_runtime_session_t* session_ = nullptr;
+  iree_vm_function_t function_;
+  iree_runtime_batcher_t* batcher_ = nullptr;
+};
+
+TEST_F(BatcherTest, DispatchesFullBatch) {
+  // With no deadline only a full batch can be issued.
+  CreateBatcher(/*max_batch_size=*/4, IREE_DURATION_INFINITE, /*pad=*/false);
+  Collector collector;
+  for (int32_t i = 1; i <= 4; ++i) {
+    IREE_ASSERT_OK(iree_runtime_batcher_submit(
+        batcher_, CreateInputs(1, i).get(), collector.callback()));
+  }
+  std::vector<Result> results = collector.Wait(4);
+  ASSERT_EQ(results.size(), 4);
+  for (size_t i = 0; i < results.size(); ++i) {
+    EXPECT_EQ(results[i].status_code, IREE_STATUS_OK);
+    EXPECT_EQ(results[i].batch_rows, 4);
+    EXPECT_EQ(results[i].batch_sum, 2 * (1 + 2 + 3 + 4));
+    // Requests complete in submission order with their own rows.
+    EXPECT_EQ(results[i].rows, 1);
+    EXPECT_EQ(results[i].value, (int32_t)i + 1);
+  }
+}
+
+TEST_F(BatcherTest, DispatchesPartialBatchAtDeadline) {
+  CreateBatcher(/*max_batch_size=*/8, /*max_latency=*/10000000ll,  // 10ms
+                /*pad=*/false);
+  vm::ref<iree_vm_list_t> outputs;
+  IREE_ASSERT_OK(iree_vm_list_create(/*element_type=*/NULL, 3,
+                                     iree_allocator_system(), &outputs));
+  iree_time_t start_ns = iree_time_now();
+  IREE_ASSERT_OK(iree_runtime_batcher_call(batcher_, CreateInputs(2, 3).get(),
+                                           outputs.get()));
+  EXPECT_GE(iree_time_now() - start_ns, 10000000ll);
+
+  iree_hal_buffer_view_t* view =
+      iree_vm_list_get_buffer_view_assign(outputs.get(), 0);
+  ASSERT_NE(view, nullptr);
+  EXPECT_EQ(iree_hal_buffer_view_shape_dims(view)[0], 2);
+  iree_vm_value_t batch_rows;
+  IREE_ASSERT_OK(iree_vm_list_get_value(outputs.get(), 1, &batch_rows));
+  EXPECT_EQ(batch_rows.i32, 2);
+}
+
+TEST_F(BatcherTest, PadsShortBatches) {
+  CreateBatcher(/*max_batch_size=*/4, IREE_DURATION_ZERO, /*pad=*/true);
+  vm::ref<iree_vm_list_t> outputs;
+  IREE_ASSERT_OK(iree_vm_list_create(/*element_type=*/NULL, 3,
+                                     iree_allocator_system(), &outputs));
+  IREE_ASSERT_OK(iree_runtime_batcher_call(batcher_, CreateInputs(1, 7).get(),
+                                           outputs.get()));
+
+  // The function sees the full batch with zeros in the padding rows while the
+  // request only receives its own row.
+  iree_vm_value_t batch_rows, batch_sum;
+  IREE_ASSERT_OK(iree_vm_list_get_value(outputs.get(), 1, &batch_rows));
+  IREE_ASSERT_OK(iree_vm_list_get_value(outputs.get(), 2, &batch_sum));
+  EXPECT_EQ(batch_rows.i32, 4);
+  EXPECT_EQ(batch_sum.i32, 2 * 7);
+  iree_hal_buffer_view_t* view =
+      iree_vm_list_get_buffer_view_assign(outputs.get(), 0);
+  ASSERT_NE(view, nullptr);
+  EXPECT_EQ(iree_hal_buffer_view_shape_dims(view)[0], 1);
+  int32_t contents[2] = {0};
+  IREE_ASSERT_OK(iree_hal_buffer_map_read(iree_hal_buffer_view_buffer(view), 0,
+                                          contents, sizeof(contents)));
+  EXPECT_EQ(contents[0], 7);
+  EXPECT_EQ(contents[1], 7);
+}
+
+TEST_F(BatcherTest, ShutdownCompletesPendingRequests) {
+  // The batch never fills and has no deadline so the requests are only
+  // issued when the batcher is released.
+  CreateBatcher(/*max_batch_size=*/16, IREE_DURATION_INFINITE, /*pad=*/false);
+  Collector collector;
+  for (int32_t i = 1; i <= 3; ++i) {
+    IREE_ASSERT_OK(iree_runtime_batcher_submit(
+        batcher_, CreateInputs(1, i).get(), collector.callback()));
+  }
+  EXPECT_TRUE(collector.results().empty());
+
+  iree_runtime_batcher_release(batcher_);
+  batcher_ = nullptr;
+
+  std::vector<Result> results = collector.results();
+  ASSERT_EQ(results.size(), 3);
+  for (size_t i = 0; i < results.size(); ++i) {
+    EXPECT_EQ(results[i].status_code, IREE_STATUS_OK);
+    EXPECT_EQ(results[i].batch_rows, 3);
+    EXPECT_EQ(results[i].value, (int32_t)i + 1);
+  }
+}
+
+}  // namespace
+}  // namespace iree
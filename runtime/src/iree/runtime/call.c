@@ -93,6 +93,11 @@ IREE_API_EXPORT iree_vm_list_t* iree_runtime_call_outputs(
 
 IREE_API_EXPORT iree_status_t iree_runtime_call_invoke(
     iree_runtime_call_t* call, iree_runtime_call_flags_t flags) {
+  if (iree_all_bits_set(flags, IREE_RUNTIME_CALL_FLAG_MEMOIZE)) {
+    return iree_runtime_session_call_memoized(
+        call->session, &call->function, iree_const_byte_span_empty(),
+        call->inputs, call->outputs);
+  }
   return iree_runtime_session_call(call->session, &call->function, call->inputs,
                                    call->outputs);
 }
@@ -111,6 +116,17 @@ IREE_API_EXPORT iree_status_t iree_runtime_call_inputs_push_back_buffer_view(
   return iree_vm_list_push_ref_retain(call->inputs, &value);
 }
 
+IREE_API_EXPORT iree_status_t
+iree_runtime_call_inputs_push_back_donated_buffer_view(
+    iree_runtime_call_t* call, iree_hal_buffer_view_t* buffer_view) {
+  IREE_ASSERT_ARGUMENT(call);
+  IREE_ASSERT_ARGUMENT(buffer_view);
+  iree_vm_ref_t value = {0};
+  IREE_RETURN_IF_ERROR(iree_vm_ref_wrap_assign(
+      buffer_view, iree_hal_buffer_view_type_id(), &value));
+  return iree_vm_list_push_ref_move(call->inputs, &value);
+}
+
 // Pops a buffer view from the front of the call outputs list.
 // Ownership of the buffer view transfers to the caller.
 IREE_API_EXPORT iree_status_t iree_runtime_call_outputs_pop_front_buffer_view(
@@ -29,6 +29,10 @@ typedef struct iree_runtime_session_t iree_runtime_session_t;
 // without having to pollute this interface.
 enum iree_runtime_call_flag_bits_t {
   IREE_RUNTIME_CALL_FLAG_RESERVED = 0u,
+  // The function is pure and deterministic and its results may be served from
+  // the session result cache keyed on the input contents.
+  // See iree_runtime_session_call_memoized for details.
+  IREE_RUNTIME_CALL_FLAG_MEMOIZE = 1u << 0,
 };
 typedef uint32_t iree_runtime_call_flags_t;
 
@@ -106,6 +110,15 @@ IREE_API_EXPORT iree_status_t iree_runtime_call_invoke(
 IREE_API_EXPORT iree_status_t iree_runtime_call_inputs_push_back_buffer_view(
     iree_runtime_call_t* call, iree_hal_buffer_view_t* buffer_view);
 
+// Pushes |buffer_view| to the call inputs list and donates it to the call.
+// Ownership of the caller's reference transfers to the list and the caller
+// must not use the buffer view after the call. Functions compiled with the
+// argument marked `iree.abi.donate` reuse its storage for the associated
+// result instead of allocating new output storage.
+IREE_API_EXPORT iree_status_t
+iree_runtime_call_inputs_push_back_donated_buffer_view(
+    iree_runtime_call_t* call, iree_hal_buffer_view_t* buffer_view);
+
 // Pops a buffer view from the front of the call outputs list.
 // Ownership of the buffer view transfers to the caller.
 IREE_API_EXPORT iree_status_t iree_runtime_call_outputs_pop_front_buffer_view(
@@ -168,3 +168,33 @@ IREE_API_EXPORT iree_status_t iree_runtime_instance_try_create_default_device(
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
+
+IREE_API_EXPORT iree_status_t iree_runtime_instance_try_create_preferred_device(
+    iree_runtime_instance_t* instance, iree_string_view_t driver_names,
+    iree_hal_device_t** out_device) {
+  IREE_ASSERT_ARGUMENT(instance);
+  IREE_ASSERT_ARGUMENT(out_device);
+  *out_device = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, driver_names.data, driver_names.size);
+
+  iree_status_t status = iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                          "no driver names provided");
+  iree_string_view_t remaining = driver_names;
+  while (!iree_string_view_is_empty(remaining)) {
+    iree_string_view_t driver_name = iree_string_view_empty();
+    iree_string_view_split(remaining, ',', &driver_name, &remaining);
+    driver_name = iree_string_view_trim(driver_name);
+    if (iree_string_view_is_empty(driver_name)) continue;
+
+    // Drivers that are not registered or have no available devices fall
+    // through to the next preference.
+    iree_status_ignore(status);
+    status = iree_runtime_instance_try_create_default_device(
+        instance, driver_name, out_device);
+    if (iree_status_is_ok(status)) break;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
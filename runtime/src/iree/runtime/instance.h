@@ -116,6 +116,17 @@ IREE_API_EXPORT iree_status_t iree_runtime_instance_try_create_default_device(
     iree_runtime_instance_t* instance, iree_string_view_t driver_name,
     iree_hal_device_t** out_device);
 
+// Creates the default device of the first driver in |driver_names| that is
+// available on the host. |driver_names| is a comma-separated list in order of
+// preference such as `PIM,local-task`. Modules compiled for several targets
+// (such as `--iree-hal-target-backends=pim,llvm-cpu`) select the executables
+// and synchronization behavior of whichever device is created so that one
+// module runs on hosts with and without PIM. Returns the failure of the last
+// driver if none are available.
+IREE_API_EXPORT iree_status_t iree_runtime_instance_try_create_preferred_device(
+    iree_runtime_instance_t* instance, iree_string_view_t driver_names,
+    iree_hal_device_t** out_device);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
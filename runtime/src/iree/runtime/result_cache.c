@@ -0,0 +1,477 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/runtime/result_cache.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "iree/base/tracing.h"
+#include "iree/modules/hal/types.h"
+
+//===----------------------------------------------------------------------===//
+// iree_runtime_result_cache_key_t
+//===----------------------------------------------------------------------===//
+
+// 64-bit FNV-1a.
+static uint64_t iree_runtime_result_cache_hash(const void* data,
+                                               iree_host_size_t data_length) {
+  const uint8_t* bytes = (const uint8_t*)data;
+  uint64_t hash = 0xCBF29CE484222325ull;
+  for (iree_host_size_t i = 0; i < data_length; ++i) {
+    hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+  }
+  return hash;
+}
+
+static void iree_runtime_result_cache_key_initialize(
+    iree_allocator_t host_allocator, iree_runtime_result_cache_key_t* out_key) {
+  memset(out_key, 0, sizeof(*out_key));
+  out_key->host_allocator = host_allocator;
+}
+
+void iree_runtime_result_cache_key_deinitialize(
+    iree_runtime_result_cache_key_t* key) {
+  if (!key) return;
+  iree_allocator_free(key->host_allocator, key->data.data);
+  memset(key, 0, sizeof(*key));
+}
+
+// Appends |data_length| bytes from |data| to |key|, growing it as needed.
+static iree_status_t iree_runtime_result_cache_key_append(
+    iree_runtime_result_cache_key_t* key, const void* data,
+    iree_host_size_t data_length) {
+  if (data_length == 0) return iree_ok_status();
+  iree_host_size_t required_length = key->data.data_length + data_length;
+  if (required_length > key->capacity) {
+    iree_host_size_t new_capacity = iree_max(64, key->capacity * 2);
+    while (new_capacity < required_length) new_capacity *= 2;
+    IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+        key->host_allocator, new_capacity, (void**)&key->data.data));
+    key->capacity = new_capacity;
+  }
+  memcpy(key->data.data + key->data.data_length, data, data_length);
+  key->data.data_length = required_length;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_runtime_result_cache_key_append_string(
+    iree_runtime_result_cache_key_t* key, iree_string_view_t value) {
+  IREE_RETURN_IF_ERROR(iree_runtime_result_cache_key_append(
+      key, &value.size, sizeof(value.size)));
+  return iree_runtime_result_cache_key_append(key, value.data, value.size);
+}
+
+static iree_status_t iree_runtime_result_cache_key_append_function(
+    iree_runtime_result_cache_key_t* key, const iree_vm_function_t* function) {
+  IREE_RETURN_IF_ERROR(iree_runtime_result_cache_key_append_string(
+      key, iree_vm_module_name(function->module)));
+  IREE_RETURN_IF_ERROR(iree_runtime_result_cache_key_append_string(
+      key, iree_vm_function_name(function)));
+  return iree_runtime_result_cache_key_append(key, &function->ordinal,
+                                              sizeof(function->ordinal));
+}
+
+static void iree_runtime_result_cache_key_finalize(
+    iree_runtime_result_cache_key_t* key) {
+  key->hash =
+      iree_runtime_result_cache_hash(key->data.data, key->data.data_length);
+}
+
+iree_status_t iree_runtime_result_cache_key_initialize_from_bytes(
+    const iree_vm_function_t* function, iree_const_byte_span_t user_key,
+    iree_allocator_t host_allocator, iree_runtime_result_cache_key_t* out_key) {
+  IREE_ASSERT_ARGUMENT(function);
+  IREE_ASSERT_ARGUMENT(out_key);
+  iree_runtime_result_cache_key_initialize(host_allocator, out_key);
+  iree_status_t status =
+      iree_runtime_result_cache_key_append_function(out_key, function);
+  if (iree_status_is_ok(status)) {
+    status = iree_runtime_result_cache_key_append(
+        out_key, &user_key.data_length, sizeof(user_key.data_length));
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_runtime_result_cache_key_append(out_key, user_key.data,
+                                                  user_key.data_length);
+  }
+  if (iree_status_is_ok(status)) {
+    iree_runtime_result_cache_key_finalize(out_key);
+  } else {
+    iree_runtime_result_cache_key_deinitialize(out_key);
+  }
+  return status;
+}
+
+// Appends the metadata and contents of |buffer_view| to |key|.
+// Sets |out_cacheable| to false if the contents cannot be read by the host.
+static iree_status_t iree_runtime_result_cache_key_append_buffer_view(
+    iree_runtime_result_cache_key_t* key, iree_hal_buffer_view_t* buffer_view,
+    bool* out_cacheable) {
+  iree_hal_element_type_t element_type =
+      iree_hal_buffer_view_element_type(buffer_view);
+  iree_hal_encoding_type_t encoding_type =
+      iree_hal_buffer_view_encoding_type(buffer_view);
+  iree_host_size_t shape_rank = iree_hal_buffer_view_shape_rank(buffer_view);
+  IREE_RETURN_IF_ERROR(iree_runtime_result_cache_key_append(
+      key, &element_type, sizeof(element_type)));
+  IREE_RETURN_IF_ERROR(iree_runtime_result_cache_key_append(
+      key, &encoding_type, sizeof(encoding_type)));
+  IREE_RETURN_IF_ERROR(iree_runtime_result_cache_key_append(
+      key, &shape_rank, sizeof(shape_rank)));
+  IREE_RETURN_IF_ERROR(iree_runtime_result_cache_key_append(
+      key, iree_hal_buffer_view_shape_dims(buffer_view),
+      shape_rank * sizeof(iree_hal_dim_t)));
+
+  iree_hal_buffer_t* buffer = iree_hal_buffer_view_buffer(buffer_view);
+  if (!iree_all_bits_set(iree_hal_buffer_memory_type(buffer),
+                         IREE_HAL_MEMORY_TYPE_HOST_VISIBLE) ||
+      !iree_all_bits_set(iree_hal_buffer_allowed_usage(buffer),
+                         IREE_HAL_BUFFER_USAGE_MAPPING_SCOPED)) {
+    *out_cacheable = false;
+    return iree_ok_status();
+  }
+
+  iree_device_size_t byte_length =
+      iree_hal_buffer_view_byte_length(buffer_view);
+  if (byte_length == 0) return iree_ok_status();
+  iree_hal_buffer_mapping_t mapping;
+  IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
+      buffer, IREE_HAL_MAPPING_MODE_SCOPED, IREE_HAL_MEMORY_ACCESS_READ, 0,
+      byte_length, &mapping));
+  iree_status_t status = iree_runtime_result_cache_key_append(
+      key, mapping.contents.data, mapping.contents.data_length);
+  return iree_status_join(status, iree_hal_buffer_unmap_range(&mapping));
+}
+
+iree_status_t iree_runtime_result_cache_key_initialize_from_inputs(
+    const iree_vm_function_t* function, iree_vm_list_t* input_list,
+    iree_allocator_t host_allocator, bool* out_cacheable,
+    iree_runtime_result_cache_key_t* out_key) {
+  IREE_ASSERT_ARGUMENT(function);
+  IREE_ASSERT_ARGUMENT(out_cacheable);
+  IREE_ASSERT_ARGUMENT(out_key);
+  *out_cacheable = true;
+  iree_runtime_result_cache_key_initialize(host_allocator, out_key);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_host_size_t input_count = input_list ? iree_vm_list_size(input_list) : 0;
+  iree_status_t status =
+      iree_runtime_result_cache_key_append_function(out_key, function);
+  if (iree_status_is_ok(status)) {
+    status = iree_runtime_result_cache_key_append(out_key, &input_count,
+                                                  sizeof(input_count));
+  }
+  for (iree_host_size_t i = 0;
+       i < input_count && *out_cacheable && iree_status_is_ok(status); ++i) {
+    iree_vm_variant_t value = iree_vm_variant_empty();
+    status = iree_vm_list_get_variant(input_list, i, &value);
+    if (!iree_status_is_ok(status)) break;
+    status = iree_runtime_result_cache_key_append(out_key, &value.type,
+                                                  sizeof(value.type));
+    if (!iree_status_is_ok(status)) break;
+    if (iree_vm_variant_is_value(value)) {
+      status = iree_runtime_result_cache_key_append(
+          out_key, value.value_storage, sizeof(value.value_storage));
+    } else if (iree_hal_buffer_view_isa(value.ref)) {
+      status = iree_runtime_result_cache_key_append_buffer_view(
+          out_key, iree_hal_buffer_view_deref(value.ref), out_cacheable);
+    } else if (!iree_vm_variant_is_empty(value)) {
+      // Other refs (lists, fences, etc) have identity we can't serialize.
+      *out_cacheable = false;
+    }
+  }
+  if (iree_status_is_ok(status)) {
+    iree_runtime_result_cache_key_finalize(out_key);
+  } else {
+    iree_runtime_result_cache_key_deinitialize(out_key);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+//===----------------------------------------------------------------------===//
+// Output copies
+//===----------------------------------------------------------------------===//
+
+// Copies the contents of |source_view| into a new buffer allocated from
+// |device| with the same memory type and usage.
+static iree_status_t iree_runtime_result_cache_copy_buffer_view(
+    iree_hal_device_t* device, iree_hal_buffer_view_t* source_view,
+    iree_allocator_t host_allocator, iree_hal_buffer_view_t** out_view) {
+  iree_hal_buffer_t* source_buffer = iree_hal_buffer_view_buffer(source_view);
+  iree_device_size_t byte_length =
+      iree_hal_buffer_view_byte_length(source_view);
+  iree_hal_buffer_params_t params;
+  memset(&params, 0, sizeof(params));
+  params.type = iree_hal_buffer_memory_type(source_buffer);
+  params.usage = iree_hal_buffer_allowed_usage(source_buffer);
+  params.access = IREE_HAL_MEMORY_ACCESS_ALL;
+  iree_hal_buffer_t* target_buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
+      iree_hal_device_allocator(device), params, byte_length,
+      iree_const_byte_span_empty(), &target_buffer));
+  iree_status_t status = iree_ok_status();
+  if (byte_length > 0) {
+    status = iree_hal_device_transfer_d2d(
+        device, source_buffer, 0, target_buffer, 0, byte_length,
+        IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout());
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_buffer_view_create_like(target_buffer, source_view,
+                                              host_allocator, out_view);
+  }
+  iree_hal_buffer_release(target_buffer);
+  return status;
+}
+
+// Appends all values in |source_list| to |target_list|. Buffer views are
+// copied if |device| is provided and otherwise retained.
+static iree_status_t iree_runtime_result_cache_append_outputs(
+    iree_vm_list_t* source_list, iree_hal_device_t* device,
+    iree_allocator_t host_allocator, iree_vm_list_t* target_list) {
+  iree_host_size_t count = iree_vm_list_size(source_list);
+  IREE_RETURN_IF_ERROR(iree_vm_list_reserve(
+      target_list, iree_vm_list_size(target_list) + count));
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    iree_vm_variant_t value = iree_vm_variant_empty();
+    IREE_RETURN_IF_ERROR(iree_vm_list_get_variant(source_list, i, &value));
+    if (iree_vm_variant_is_value(value)) {
+      iree_vm_value_t primitive;
+      primitive.type = value.type.value_type;
+      memcpy(primitive.value_storage, value.value_storage,
+             sizeof(primitive.value_storage));
+      IREE_RETURN_IF_ERROR(iree_vm_list_push_value(target_list, &primitive));
+    } else if (device && iree_hal_buffer_view_isa(value.ref)) {
+      iree_hal_buffer_view_t* buffer_view = NULL;
+      IREE_RETURN_IF_ERROR(iree_runtime_result_cache_copy_buffer_view(
+          device, iree_hal_buffer_view_deref(value.ref), host_allocator,
+          &buffer_view));
+      iree_vm_ref_t buffer_view_ref =
+          iree_hal_buffer_view_move_ref(buffer_view);
+      iree_status_t status =
+          iree_vm_list_push_ref_move(target_list, &buffer_view_ref);
+      if (!iree_status_is_ok(status)) {
+        iree_vm_ref_release(&buffer_view_ref);
+        return status;
+      }
+    } else {
+      IREE_RETURN_IF_ERROR(
+          iree_vm_list_push_ref_retain(target_list, &value.ref));
+    }
+  }
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// iree_runtime_result_cache_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_runtime_result_cache_entry_t {
+  // Doubly-linked LRU list; the cache head is the most-recently used entry.
+  struct iree_runtime_result_cache_entry_t* prev;
+  struct iree_runtime_result_cache_entry_t* next;
+  // Hash and bytes of the key; the bytes are stored inline after the entry.
+  uint64_t key_hash;
+  iree_const_byte_span_t key_data;
+  // Total byte length of all buffers retained by |outputs| and the key.
+  iree_device_size_t byte_size;
+  // Outputs retaining all values.
+  iree_vm_list_t* outputs;
+} iree_runtime_result_cache_entry_t;
+
+struct iree_runtime_result_cache_t {
+  iree_allocator_t host_allocator;
+  iree_device_size_t capacity;
+  iree_device_size_t byte_size;
+  iree_runtime_result_cache_entry_t* head;
+  iree_runtime_result_cache_entry_t* tail;
+};
+
+iree_status_t iree_runtime_result_cache_create(
+    iree_device_size_t capacity, iree_allocator_t host_allocator,
+    iree_runtime_result_cache_t** out_cache) {
+  IREE_ASSERT_ARGUMENT(out_cache);
+  *out_cache = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_runtime_result_cache_t* cache = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0,
+      iree_allocator_malloc(host_allocator, sizeof(*cache), (void**)&cache));
+  memset(cache, 0, sizeof(*cache));
+  cache->host_allocator = host_allocator;
+  cache->capacity = capacity;
+  *out_cache = cache;
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+void iree_runtime_result_cache_free(iree_runtime_result_cache_t* cache) {
+  if (!cache) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_runtime_result_cache_clear(cache);
+  iree_allocator_free(cache->host_allocator, cache);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static void iree_runtime_result_cache_unlink(
+    iree_runtime_result_cache_t* cache,
+    iree_runtime_result_cache_entry_t* entry) {
+  if (entry->prev) {
+    entry->prev->next = entry->next;
+  } else {
+    cache->head = entry->next;
+  }
+  if (entry->next) {
+    entry->next->prev = entry->prev;
+  } else {
+    cache->tail = entry->prev;
+  }
+  entry->prev = entry->next = NULL;
+}
+
+static void iree_runtime_result_cache_link_head(
+    iree_runtime_result_cache_t* cache,
+    iree_runtime_result_cache_entry_t* entry) {
+  entry->prev = NULL;
+  entry->next = cache->head;
+  if (cache->head) cache->head->prev = entry;
+  cache->head = entry;
+  if (!cache->tail) cache->tail = entry;
+}
+
+static void iree_runtime_result_cache_evict(
+    iree_runtime_result_cache_t* cache,
+    iree_runtime_result_cache_entry_t* entry) {
+  iree_runtime_result_cache_unlink(cache, entry);
+  cache->byte_size -= entry->byte_size;
+  iree_vm_list_release(entry->outputs);
+  iree_allocator_free(cache->host_allocator, entry);
+}
+
+void iree_runtime_result_cache_clear(iree_runtime_result_cache_t* cache) {
+  IREE_ASSERT_ARGUMENT(cache);
+  while (cache->head) {
+    iree_runtime_result_cache_evict(cache, cache->head);
+  }
+}
+
+static iree_runtime_result_cache_entry_t* iree_runtime_result_cache_find(
+    iree_runtime_result_cache_t* cache,
+    const iree_runtime_result_cache_key_t* key) {
+  for (iree_runtime_result_cache_entry_t* entry = cache->head; entry;
+       entry = entry->next) {
+    if (entry->key_hash == key->hash &&
+        entry->key_data.data_length == key->data.data_length &&
+        memcmp(entry->key_data.data, key->data.data, key->data.data_length) ==
+            0) {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+iree_status_t iree_runtime_result_cache_lookup(
+    iree_runtime_result_cache_t* cache,
+    const iree_runtime_result_cache_key_t* key, iree_hal_device_t* device,
+    iree_vm_list_t* output_list, bool* out_hit) {
+  IREE_ASSERT_ARGUMENT(cache);
+  IREE_ASSERT_ARGUMENT(key);
+  IREE_ASSERT_ARGUMENT(out_hit);
+  *out_hit = false;
+
+  iree_runtime_result_cache_entry_t* entry =
+      iree_runtime_result_cache_find(cache, key);
+  if (!entry) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_runtime_result_cache_unlink(cache, entry);
+  iree_runtime_result_cache_link_head(cache, entry);
+
+  iree_status_t status = iree_ok_status();
+  if (output_list) {
+    status = iree_runtime_result_cache_append_outputs(
+        entry->outputs, device, cache->host_allocator, output_list);
+  }
+  *out_hit = iree_status_is_ok(status);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_runtime_result_cache_insert(
+    iree_runtime_result_cache_t* cache,
+    const iree_runtime_result_cache_key_t* key, iree_hal_device_t* device,
+    iree_vm_list_t* output_list) {
+  IREE_ASSERT_ARGUMENT(cache);
+  IREE_ASSERT_ARGUMENT(key);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Tally the device memory the entry would keep alive. Outputs we don't know
+  // how to account for (or that may be mutated in-place like lists) are not
+  // cached.
+  iree_host_size_t output_count =
+      output_list ? iree_vm_list_size(output_list) : 0;
+  iree_device_size_t byte_size = key->data.data_length;
+  for (iree_host_size_t i = 0; i < output_count; ++i) {
+    iree_vm_variant_t value = iree_vm_variant_empty();
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_vm_list_get_variant(output_list, i, &value));
+    if (iree_vm_variant_is_value(value)) continue;
+    if (!iree_hal_buffer_view_isa(value.ref)) {
+      IREE_TRACE_ZONE_END(z0);
+      return iree_ok_status();
+    }
+    byte_size +=
+        iree_hal_buffer_view_byte_length(iree_hal_buffer_view_deref(value.ref));
+  }
+  if (byte_size > cache->capacity) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
+  }
+
+  // Replace any existing entry (possible if a caller raced two misses on the
+  // same key) and evict the least-recently used entries to make room.
+  iree_runtime_result_cache_entry_t* existing =
+      iree_runtime_result_cache_find(cache, key);
+  if (existing) iree_runtime_result_cache_evict(cache, existing);
+  while (cache->tail && cache->byte_size + byte_size > cache->capacity) {
+    iree_runtime_result_cache_evict(cache, cache->tail);
+  }
+
+  iree_runtime_result_cache_entry_t* entry = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(cache->host_allocator,
+                                sizeof(*entry) + key->data.data_length,
+                                (void**)&entry));
+  memset(entry, 0, sizeof(*entry));
+  uint8_t* key_data = (uint8_t*)entry + sizeof(*entry);
+  if (key->data.data_length > 0) {
+    memcpy(key_data, key->data.data, key->data.data_length);
+  }
+  entry->key_hash = key->hash;
+  entry->key_data = iree_make_const_byte_span(key_data, key->data.data_length);
+  entry->byte_size = byte_size;
+  iree_status_t status =
+      iree_vm_list_create(/*element_type=*/NULL, output_count,
+                          cache->host_allocator, &entry->outputs);
+  if (iree_status_is_ok(status) && output_list) {
+    status = iree_runtime_result_cache_append_outputs(
+        output_list, device, cache->host_allocator, entry->outputs);
+  }
+  if (iree_status_is_ok(status)) {
+    iree_runtime_result_cache_link_head(cache, entry);
+    cache->byte_size += byte_size;
+  } else {
+    iree_vm_list_release(entry->outputs);
+    iree_allocator_free(cache->host_allocator, entry);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
@@ -0,0 +1,113 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_RUNTIME_RESULT_CACHE_H_
+#define IREE_RUNTIME_RESULT_CACHE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/vm/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_runtime_result_cache_key_t
+//===----------------------------------------------------------------------===//
+
+// Identifies a call in the result cache by the exact bytes describing it.
+// The |hash| is only used to quickly reject mismatches and lookups compare the
+// full |data| so distinct calls never share an entry.
+typedef struct iree_runtime_result_cache_key_t {
+  // Hash of |data|.
+  uint64_t hash;
+  // Serialized function identity followed by the user key or the types,
+  // shapes, and contents of all inputs.
+  iree_byte_span_t data;
+  // Allocated capacity of |data|.
+  iree_host_size_t capacity;
+  iree_allocator_t host_allocator;
+} iree_runtime_result_cache_key_t;
+
+// Initializes |out_key| for a call to |function| with a caller-provided
+// |user_key|. The key must be deinitialized by the caller.
+iree_status_t iree_runtime_result_cache_key_initialize_from_bytes(
+    const iree_vm_function_t* function, iree_const_byte_span_t user_key,
+    iree_allocator_t host_allocator, iree_runtime_result_cache_key_t* out_key);
+
+// Initializes |out_key| for a call to |function| from the types, shapes, and
+// contents of all values in |input_list|. |out_cacheable| is set to false if
+// the inputs contain anything the cache cannot serialize such as non-mappable
+// buffers or non-buffer-view refs, in which case the call should not be
+// memoized. The key must be deinitialized by the caller in all cases.
+iree_status_t iree_runtime_result_cache_key_initialize_from_inputs(
+    const iree_vm_function_t* function, iree_vm_list_t* input_list,
+    iree_allocator_t host_allocator, bool* out_cacheable,
+    iree_runtime_result_cache_key_t* out_key);
+
+// Deinitializes |key| and frees its data.
+void iree_runtime_result_cache_key_deinitialize(
+    iree_runtime_result_cache_key_t* key);
+
+//===----------------------------------------------------------------------===//
+// iree_runtime_result_cache_t
+//===----------------------------------------------------------------------===//
+
+// A memoization cache mapping call keys to the outputs they produced.
+// Used by iree_runtime_session_call_memoized; see that for details.
+//
+// Entries retain their output buffer views (and therefore the device memory
+// backing them) along with a copy of their key until evicted. The
+// least-recently-used entries are evicted whenever inserting would exceed the
+// byte capacity of the cache.
+//
+// When a |device| is provided to insert and lookup the cache holds private
+// copies of the output buffers and each hit receives fresh copies so callers
+// may write to or donate the outputs they receive. Without a device buffer
+// views are shared between the inserting call and all hits and must be
+// treated as read-only.
+//
+// Thread-compatible; owned by a session and used under its synchronization.
+typedef struct iree_runtime_result_cache_t iree_runtime_result_cache_t;
+
+// Creates a cache retaining up to |capacity| bytes of output buffers and keys.
+iree_status_t iree_runtime_result_cache_create(
+    iree_device_size_t capacity, iree_allocator_t host_allocator,
+    iree_runtime_result_cache_t** out_cache);
+
+// Frees |cache| and releases all of its entries.
+void iree_runtime_result_cache_free(iree_runtime_result_cache_t* cache);
+
+// Releases all entries in |cache|.
+void iree_runtime_result_cache_clear(iree_runtime_result_cache_t* cache);
+
+// Appends the cached outputs for |key| to |output_list| if present and marks
+// the entry as most-recently used. |out_hit| indicates whether the outputs were
+// found. Buffer views are copied using |device| if provided and otherwise
+// shared with the cache.
+iree_status_t iree_runtime_result_cache_lookup(
+    iree_runtime_result_cache_t* cache,
+    const iree_runtime_result_cache_key_t* key, iree_hal_device_t* device,
+    iree_vm_list_t* output_list, bool* out_hit);
+
+// Inserts the contents of |output_list| for |key|. Buffer views are copied
+// using |device| if provided and otherwise retained. Outputs that are not
+// values or buffer views or that are larger than the cache capacity are not
+// inserted.
+iree_status_t iree_runtime_result_cache_insert(
+    iree_runtime_result_cache_t* cache,
+    const iree_runtime_result_cache_key_t* key, iree_hal_device_t* device,
+    iree_vm_list_t* output_list);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_RUNTIME_RESULT_CACHE_H_
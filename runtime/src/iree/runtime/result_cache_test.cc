@@ -0,0 +1,286 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/runtime/result_cache.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/modules/hal/types.h"
+#include "iree/runtime/instance.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/api.h"
+
+namespace {
+
+static iree_string_view_t TestModuleName(void* self) {
+  return IREE_SV("test");
+}
+
+static iree_status_t TestModuleGetFunction(
+    void* self, iree_vm_function_linkage_t linkage, iree_host_size_t ordinal,
+    iree_vm_function_t* out_function, iree_string_view_t* out_name,
+    iree_vm_function_signature_t* out_signature) {
+  if (out_name) *out_name = ordinal == 0 ? IREE_SV("f0") : IREE_SV("f1");
+  return iree_ok_status();
+}
+
+class ResultCacheTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    iree_runtime_instance_options_t options;
+    iree_runtime_instance_options_initialize(&options);
+    iree_runtime_instance_options_use_all_available_drivers(&options);
+    IREE_ASSERT_OK(iree_runtime_instance_create(
+        &options, iree_allocator_system(), &instance_));
+    iree_status_t status = iree_runtime_instance_try_create_default_device(
+        instance_, IREE_SV("local-sync"), &device_);
+    if (iree_status_is_not_found(status)) {
+      fprintf(stderr, "Skipping test as 'local-sync' driver was not found:\n");
+      iree_status_fprint(stderr, status);
+      iree_status_free(status);
+      GTEST_SKIP();
+    }
+    IREE_ASSERT_OK(status);
+
+    memset(&module_, 0, sizeof(module_));
+    module_.name = TestModuleName;
+    module_.get_function = TestModuleGetFunction;
+    for (iree_host_size_t i = 0; i < 2; ++i) {
+      functions_[i].module = &module_;
+      functions_[i].linkage = IREE_VM_FUNCTION_LINKAGE_EXPORT;
+      functions_[i].ordinal = (uint16_t)i;
+    }
+  }
+
+  virtual void TearDown() {
+    iree_runtime_result_cache_free(cache_);
+    iree_hal_device_release(device_);
+    iree_runtime_instance_release(instance_);
+  }
+
+  void CreateCache(iree_device_size_t capacity) {
+    IREE_ASSERT_OK(iree_runtime_result_cache_create(
+        capacity, iree_allocator_system(), &cache_));
+  }
+
+  void InitializeKey(const char* user_key,
+                     iree_runtime_result_cache_key_t* out_key) {
+    IREE_ASSERT_OK(iree_runtime_result_cache_key_initialize_from_bytes(
+        &functions_[0], iree_make_const_byte_span(user_key, strlen(user_key)),
+        iree_allocator_system(), out_key));
+  }
+
+  // Creates a list holding |value| as an i32 and a buffer view of
+  // |element_count| i32 elements all set to |value|.
+  iree_vm_list_t* CreateOutputs(int32_t value, iree_host_size_t element_count) {
+    iree_vm_list_t* list = NULL;
+    IREE_CHECK_OK(iree_vm_list_create(/*element_type=*/NULL, 2,
+                                      iree_allocator_system(), &list));
+    iree_vm_value_t primitive = iree_vm_value_make_i32(value);
+    IREE_CHECK_OK(iree_vm_list_push_value(list, &primitive));
+    std::vector<int32_t> contents(element_count, value);
+    iree_hal_dim_t shape[1] = {(iree_hal_dim_t)element_count};
+    iree_hal_buffer_params_t params;
+    memset(&params, 0, sizeof(params));
+    params.type =
+        IREE_HAL_MEMORY_TYPE_HOST_LOCAL | IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE;
+    params.usage =
+        IREE_HAL_BUFFER_USAGE_DEFAULT | IREE_HAL_BUFFER_USAGE_MAPPING;
+    iree_hal_buffer_view_t* buffer_view = NULL;
+    IREE_CHECK_OK(iree_hal_buffer_view_allocate_buffer(
+        iree_hal_device_allocator(device_), IREE_ARRAYSIZE(shape), shape,
+        IREE_HAL_ELEMENT_TYPE_INT_32, IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR,
+        params,
+        iree_make_const_byte_span(contents.data(),
+                                  contents.size() * sizeof(int32_t)),
+        &buffer_view));
+    iree_vm_ref_t buffer_view_ref = iree_hal_buffer_view_move_ref(buffer_view);
+    IREE_CHECK_OK(iree_vm_list_push_ref_move(list, &buffer_view_ref));
+    return list;
+  }
+
+  // Looks up |key| and returns the i32 output value or -1 on a miss.
+  int32_t Lookup(const iree_runtime_result_cache_key_t* key,
+                 iree_hal_device_t* device = NULL) {
+    iree_vm_list_t* list = NULL;
+    IREE_CHECK_OK(iree_vm_list_create(/*element_type=*/NULL, 2,
+                                      iree_allocator_system(), &list));
+    bool hit = false;
+    IREE_CHECK_OK(
+        iree_runtime_result_cache_lookup(cache_, key, device, list, &hit));
+    int32_t result = -1;
+    if (hit) {
+      EXPECT_EQ(iree_vm_list_size(list), 2);
+      iree_vm_value_t value;
+      IREE_CHECK_OK(iree_vm_list_get_value(list, 0, &value));
+      result = value.i32;
+    } else {
+      EXPECT_EQ(iree_vm_list_size(list), 0);
+    }
+    iree_vm_list_release(list);
+    return result;
+  }
+
+  void Insert(const iree_runtime_result_cache_key_t* key, int32_t value,
+              iree_host_size_t element_count) {
+    iree_vm_list_t* outputs = CreateOutputs(value, element_count);
+    IREE_ASSERT_OK(iree_runtime_result_cache_insert(cache_, key,
+                                                    /*device=*/NULL, outputs));
+    iree_vm_list_release(outputs);
+  }
+
+  iree_runtime_instance_t* instance_ = nullptr;
+  iree_hal_device_t* device_ = nullptr;
+  iree_vm_module_t module_;
+  iree_vm_function_t functions_[2];
+  iree_runtime_result_cache_t* cache_ = nullptr;
+};
+
+TEST_F(ResultCacheTest, MissThenHit) {
+  CreateCache(4096);
+  iree_runtime_result_cache_key_t key;
+  InitializeKey("a", &key);
+  EXPECT_EQ(Lookup(&key), -1);
+  Insert(&key, 42, 4);
+  EXPECT_EQ(Lookup(&key), 42);
+  EXPECT_EQ(Lookup(&key), 42);
+  iree_runtime_result_cache_key_deinitialize(&key);
+}
+
+TEST_F(ResultCacheTest, DistinctKeysMiss) {
+  CreateCache(4096);
+  iree_runtime_result_cache_key_t key_a, key_b, key_f1;
+  InitializeKey("a", &key_a);
+  InitializeKey("b", &key_b);
+  IREE_ASSERT_OK(iree_runtime_result_cache_key_initialize_from_bytes(
+      &functions_[1], iree_make_const_byte_span("a", 1),
+      iree_allocator_system(), &key_f1));
+  Insert(&key_a, 1, 4);
+  EXPECT_EQ(Lookup(&key_b), -1);
+  EXPECT_EQ(Lookup(&key_f1), -1);
+  EXPECT_EQ(Lookup(&key_a), 1);
+  iree_runtime_result_cache_key_deinitialize(&key_a);
+  iree_runtime_result_cache_key_deinitialize(&key_b);
+  iree_runtime_result_cache_key_deinitialize(&key_f1);
+}
+
+TEST_F(ResultCacheTest, KeyFromInputs) {
+  CreateCache(4096);
+  iree_vm_list_t* inputs_a = CreateOutputs(7, 4);
+  iree_vm_list_t* inputs_b = CreateOutputs(7, 4);
+  iree_vm_list_t* inputs_c = CreateOutputs(8, 4);
+  bool cacheable = false;
+  iree_runtime_result_cache_key_t key_a, key_b, key_c;
+  IREE_ASSERT_OK(iree_runtime_result_cache_key_initialize_from_inputs(
+      &functions_[0], inputs_a, iree_allocator_system(), &cacheable, &key_a));
+  EXPECT_TRUE(cacheable);
+  IREE_ASSERT_OK(iree_runtime_result_cache_key_initialize_from_inputs(
+      &functions_[0], inputs_b, iree_allocator_system(), &cacheable, &key_b));
+  EXPECT_TRUE(cacheable);
+  IREE_ASSERT_OK(iree_runtime_result_cache_key_initialize_from_inputs(
+      &functions_[0], inputs_c, iree_allocator_system(), &cacheable, &key_c));
+  EXPECT_TRUE(cacheable);
+
+  // Equal contents in distinct buffers produce the same key.
+  Insert(&key_a, 1, 4);
+  EXPECT_EQ(Lookup(&key_b), 1);
+  EXPECT_EQ(Lookup(&key_c), -1);
+
+  iree_runtime_result_cache_key_deinitialize(&key_a);
+  iree_runtime_result_cache_key_deinitialize(&key_b);
+  iree_runtime_result_cache_key_deinitialize(&key_c);
+  iree_vm_list_release(inputs_a);
+  iree_vm_list_release(inputs_b);
+  iree_vm_list_release(inputs_c);
+}
+
+TEST_F(ResultCacheTest, EvictsLeastRecentlyUsed) {
+  iree_runtime_result_cache_key_t key_a, key_b, key_c;
+  InitializeKey("a", &key_a);
+  InitializeKey("b", &key_b);
+  InitializeKey("c", &key_c);
+  // Room for exactly two entries of 16 i32 elements each.
+  CreateCache(2 * (key_a.data.data_length + 16 * sizeof(int32_t)));
+
+  Insert(&key_a, 1, 16);
+  Insert(&key_b, 2, 16);
+  EXPECT_EQ(Lookup(&key_a), 1);  // a is now most-recently used
+  Insert(&key_c, 3, 16);
+  EXPECT_EQ(Lookup(&key_a), 1);
+  EXPECT_EQ(Lookup(&key_b), -1);
+  EXPECT_EQ(Lookup(&key_c), 3);
+
+  // Entries larger than the entire cache are never inserted.
+  iree_runtime_result_cache_key_t key_d;
+  InitializeKey("d", &key_d);
+  Insert(&key_d, 4, 64);
+  EXPECT_EQ(Lookup(&key_d), -1);
+  EXPECT_EQ(Lookup(&key_c), 3);
+
+  iree_runtime_result_cache_key_deinitialize(&key_a);
+  iree_runtime_result_cache_key_deinitialize(&key_b);
+  iree_runtime_result_cache_key_deinitialize(&key_c);
+  iree_runtime_result_cache_key_deinitialize(&key_d);
+}
+
+TEST_F(ResultCacheTest, HashCollisionMisses) {
+  CreateCache(4096);
+  iree_runtime_result_cache_key_t key_a, key_b;
+  InitializeKey("a", &key_a);
+  InitializeKey("b", &key_b);
+  // Force a collision: lookups must compare the full key and not the hash.
+  key_b.hash = key_a.hash;
+  Insert(&key_a, 1, 4);
+  EXPECT_EQ(Lookup(&key_b), -1);
+  Insert(&key_b, 2, 4);
+  EXPECT_EQ(Lookup(&key_a), 1);
+  EXPECT_EQ(Lookup(&key_b), 2);
+  iree_runtime_result_cache_key_deinitialize(&key_a);
+  iree_runtime_result_cache_key_deinitialize(&key_b);
+}
+
+TEST_F(ResultCacheTest, DeviceCopiesOutputs) {
+  CreateCache(4096);
+  iree_runtime_result_cache_key_t key;
+  InitializeKey("a", &key);
+  iree_vm_list_t* outputs = CreateOutputs(5, 4);
+  IREE_ASSERT_OK(
+      iree_runtime_result_cache_insert(cache_, &key, device_, outputs));
+
+  // Writes to the inserted outputs must not be observed by hits.
+  iree_hal_buffer_view_t* inserted_view =
+      iree_vm_list_get_buffer_view_assign(outputs, 1);
+  int32_t zero = 0;
+  IREE_ASSERT_OK(iree_hal_buffer_map_fill(
+      iree_hal_buffer_view_buffer(inserted_view), 0, IREE_WHOLE_BUFFER, &zero,
+      sizeof(zero)));
+
+  iree_vm_list_t* hit_outputs = NULL;
+  IREE_ASSERT_OK(iree_vm_list_create(/*element_type=*/NULL, 2,
+                                     iree_allocator_system(), &hit_outputs));
+  bool hit = false;
+  IREE_ASSERT_OK(iree_runtime_result_cache_lookup(cache_, &key, device_,
+                                                  hit_outputs, &hit));
+  ASSERT_TRUE(hit);
+  iree_hal_buffer_view_t* hit_view =
+      iree_vm_list_get_buffer_view_assign(hit_outputs, 1);
+  EXPECT_NE(hit_view, inserted_view);
+  int32_t contents[4] = {0};
+  IREE_ASSERT_OK(iree_hal_buffer_map_read(iree_hal_buffer_view_buffer(hit_view),
+                                          0, contents, sizeof(contents)));
+  for (int32_t element : contents) EXPECT_EQ(element, 5);
+
+  iree_vm_list_release(hit_outputs);
+  iree_vm_list_release(outputs);
+  iree_runtime_result_cache_key_deinitialize(&key);
+}
+
+}  // namespace
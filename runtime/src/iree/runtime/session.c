@@ -15,6 +15,7 @@
 #include "iree/hal/api.h"
 #include "iree/modules/hal/module.h"
 #include "iree/runtime/instance.h"
+#include "iree/runtime/result_cache.h"
 #include "iree/vm/api.h"
 #include "iree/vm/bytecode_module.h"
 
@@ -61,8 +62,98 @@ struct iree_runtime_session_t {
   // lookup. An application directly using the API may never need this, or could
   // perform VM calls into HAL module exports to gain more portability.
   iree_vm_module_state_t* hal_module_state;
+
+  // Optional cache of outputs for iree_runtime_session_call_memoized.
+  // NULL if the result cache is disabled.
+  iree_runtime_result_cache_t* result_cache;
+
+  // Whether calls are profiled and the profile of the most recent call.
+  bool enable_call_profiling;
+  iree_runtime_call_profile_t last_call_profile;
 };
 
+//===----------------------------------------------------------------------===//
+// Call profiling
+//===----------------------------------------------------------------------===//
+
+// Counters sampled at the start of a call.
+typedef struct iree_runtime_call_profile_snapshot_t {
+  iree_time_t time;
+  iree_hal_module_statistics_t module_statistics;
+  iree_hal_allocator_statistics_t allocator_statistics;
+} iree_runtime_call_profile_snapshot_t;
+
+static void iree_runtime_session_sample_profile(
+    iree_runtime_session_t* session,
+    iree_runtime_call_profile_snapshot_t* out_snapshot) {
+  memset(out_snapshot, 0, sizeof(*out_snapshot));
+  iree_hal_module_state_query_statistics(session->hal_module_state,
+                                         &out_snapshot->module_statistics);
+  // The device is only available once initialized by a user module.
+  iree_hal_allocator_t* device_allocator =
+      iree_runtime_session_device_allocator(session);
+  if (device_allocator) {
+    iree_hal_allocator_query_statistics(device_allocator,
+                                        &out_snapshot->allocator_statistics);
+  }
+  out_snapshot->time = iree_time_now();
+}
+
+// Begins profiling a call. Leaves |out_snapshot| zeroed if profiling is
+// disabled for the session.
+static void iree_runtime_session_begin_call_profile(
+    iree_runtime_session_t* session,
+    iree_runtime_call_profile_snapshot_t* out_snapshot) {
+  if (!session->enable_call_profiling) {
+    memset(out_snapshot, 0, sizeof(*out_snapshot));
+    return;
+  }
+  iree_runtime_session_sample_profile(session, out_snapshot);
+}
+
+// Ends profiling of a call that began with |start| and stores the difference
+// as the profile of the most recent call.
+static void iree_runtime_session_end_call_profile(
+    iree_runtime_session_t* session,
+    const iree_runtime_call_profile_snapshot_t* start) {
+  if (!session->enable_call_profiling) return;
+  iree_runtime_call_profile_snapshot_t end;
+  iree_runtime_session_sample_profile(session, &end);
+
+  iree_runtime_call_profile_t* profile = &session->last_call_profile;
+  memset(profile, 0, sizeof(*profile));
+  profile->total_duration = end.time - start->time;
+  profile->submit_count = end.module_statistics.submit_count -
+                          start->module_statistics.submit_count;
+  profile->submit_duration = end.module_statistics.submit_duration -
+                             start->module_statistics.submit_duration;
+  profile->wait_duration = end.module_statistics.wait_duration -
+                           start->module_statistics.wait_duration;
+  profile->transfer_bytes = end.module_statistics.transfer_bytes -
+                            start->module_statistics.transfer_bytes;
+  profile->host_duration = iree_max(
+      0, profile->total_duration - profile->submit_duration -
+             profile->wait_duration);
+#if IREE_STATISTICS_ENABLE
+  // The device allocator may have been created during the call in which case
+  // the start statistics are zero.
+  profile->host_bytes_allocated =
+      end.allocator_statistics.host_bytes_allocated -
+      start->allocator_statistics.host_bytes_allocated;
+  profile->host_bytes_freed = end.allocator_statistics.host_bytes_freed -
+                              start->allocator_statistics.host_bytes_freed;
+  profile->device_bytes_allocated =
+      end.allocator_statistics.device_bytes_allocated -
+      start->allocator_statistics.device_bytes_allocated;
+  profile->device_bytes_freed = end.allocator_statistics.device_bytes_freed -
+                                start->allocator_statistics.device_bytes_freed;
+#endif  // IREE_STATISTICS_ENABLE
+}
+
+//===----------------------------------------------------------------------===//
+// iree_runtime_session_t
+//===----------------------------------------------------------------------===//
+
 IREE_API_EXPORT iree_status_t iree_runtime_session_create_with_device(
     iree_runtime_instance_t* instance,
     const iree_runtime_session_options_t* options, iree_hal_device_t* device,
@@ -84,19 +175,29 @@ IREE_API_EXPORT iree_status_t iree_runtime_session_create_with_device(
 
   session->instance = instance;
   iree_runtime_instance_retain(session->instance);
+  session->enable_call_profiling = options->enable_call_profiling;
 
   // Create the context empty so that we can add our modules to it.
   iree_status_t status = iree_vm_context_create(
       iree_runtime_instance_vm_instance(instance), options->context_flags,
       host_allocator, &session->context);
 
+  if (iree_status_is_ok(status) && options->result_cache_capacity > 0) {
+    status = iree_runtime_result_cache_create(options->result_cache_capacity,
+                                              host_allocator,
+                                              &session->result_cache);
+  }
+
   // Add the HAL module; it is always required when using the runtime API.
   // Lower-level usage of the VM can avoid the HAL if it's not required.
   iree_vm_module_t* hal_module = NULL;
   if (iree_status_is_ok(status)) {
+    iree_hal_module_flags_t hal_module_flags =
+        options->enable_call_profiling ? IREE_HAL_MODULE_FLAG_STATISTICS
+                                       : IREE_HAL_MODULE_FLAG_NONE;
     status = iree_hal_module_create(iree_runtime_instance_vm_instance(instance),
-                                    device, IREE_HAL_MODULE_FLAG_NONE,
-                                    host_allocator, &hal_module);
+                                    device, hal_module_flags, host_allocator,
+                                    &hal_module);
   }
   if (iree_status_is_ok(status)) {
     status = iree_vm_context_register_modules(
@@ -121,6 +222,8 @@ static void iree_runtime_session_destroy(iree_runtime_session_t* session) {
   IREE_ASSERT_ARGUMENT(session);
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  // Cached outputs may reference device resources owned by the context.
+  iree_runtime_result_cache_free(session->result_cache);
   iree_vm_context_release(session->context);
   iree_runtime_instance_release(session->instance);
 
@@ -174,10 +277,27 @@ IREE_API_EXPORT iree_hal_allocator_t* iree_runtime_session_device_allocator(
   return iree_hal_device_allocator(device);
 }
 
+IREE_API_EXPORT iree_status_t iree_runtime_session_query_call_profile(
+    const iree_runtime_session_t* session,
+    iree_runtime_call_profile_t* out_profile) {
+  IREE_ASSERT_ARGUMENT(session);
+  IREE_ASSERT_ARGUMENT(out_profile);
+  memset(out_profile, 0, sizeof(*out_profile));
+  if (!session->enable_call_profiling) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "call profiling is not enabled for the session");
+  }
+  *out_profile = session->last_call_profile;
+  return iree_ok_status();
+}
+
 IREE_API_EXPORT iree_status_t
 iree_runtime_session_trim(iree_runtime_session_t* session) {
   IREE_ASSERT_ARGUMENT(session);
   IREE_TRACE_ZONE_BEGIN(z0);
+  if (session->result_cache) {
+    iree_runtime_result_cache_clear(session->result_cache);
+  }
   iree_status_t status = iree_vm_context_notify(
       iree_runtime_session_context(session), IREE_VM_SIGNAL_LOW_MEMORY);
   IREE_TRACE_ZONE_END(z0);
@@ -285,6 +405,16 @@ IREE_API_EXPORT iree_status_t iree_runtime_session_lookup_function(
   return status;
 }
 
+// Invokes |function| synchronously without profiling the call.
+static iree_status_t iree_runtime_session_invoke(
+    iree_runtime_session_t* session, const iree_vm_function_t* function,
+    iree_vm_list_t* input_list, iree_vm_list_t* output_list) {
+  return iree_vm_invoke(iree_runtime_session_context(session), *function,
+                        IREE_VM_INVOCATION_FLAG_NONE,
+                        /*policy=*/NULL, input_list, output_list,
+                        iree_runtime_session_host_allocator(session));
+}
+
 IREE_API_EXPORT iree_status_t iree_runtime_session_call(
     iree_runtime_session_t* session, const iree_vm_function_t* function,
     iree_vm_list_t* input_list, iree_vm_list_t* output_list) {
@@ -292,16 +422,135 @@ IREE_API_EXPORT iree_status_t iree_runtime_session_call(
   IREE_ASSERT_ARGUMENT(function);
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  iree_runtime_call_profile_snapshot_t profile_start;
+  iree_runtime_session_begin_call_profile(session, &profile_start);
   iree_status_t status =
-      iree_vm_invoke(iree_runtime_session_context(session), *function,
-                     IREE_VM_INVOCATION_FLAG_NONE,
-                     /*policy=*/NULL, input_list, output_list,
-                     iree_runtime_session_host_allocator(session));
+      iree_runtime_session_invoke(session, function, input_list, output_list);
+  iree_runtime_session_end_call_profile(session, &profile_start);
 
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
 
+IREE_API_EXPORT iree_status_t iree_runtime_session_call_memoized(
+    iree_runtime_session_t* session, const iree_vm_function_t* function,
+    iree_const_byte_span_t key, iree_vm_list_t* input_list,
+    iree_vm_list_t* output_list) {
+  IREE_ASSERT_ARGUMENT(session);
+  IREE_ASSERT_ARGUMENT(function);
+  if (!session->result_cache) {
+    return iree_runtime_session_call(session, function, input_list,
+                                     output_list);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_runtime_call_profile_snapshot_t profile_start;
+  iree_runtime_session_begin_call_profile(session, &profile_start);
+
+  // Outputs are copied in and out of the cache on the session device so that
+  // callers own the buffers they receive and may write to or donate them.
+  iree_hal_device_t* device = iree_runtime_session_device(session);
+  bool cacheable = true;
+  iree_runtime_result_cache_key_t cache_key;
+  iree_status_t status = iree_ok_status();
+  if (iree_const_byte_span_is_empty(key)) {
+    status = iree_runtime_result_cache_key_initialize_from_inputs(
+        function, input_list, session->host_allocator, &cacheable, &cache_key);
+  } else {
+    status = iree_runtime_result_cache_key_initialize_from_bytes(
+        function, key, session->host_allocator, &cache_key);
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_runtime_session_end_call_profile(session, &profile_start);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  bool hit = false;
+  if (cacheable) {
+    status = iree_runtime_result_cache_lookup(
+        session->result_cache, &cache_key, device, output_list, &hit);
+  }
+  if (iree_status_is_ok(status) && !hit) {
+    status = iree_runtime_session_invoke(session, function, input_list,
+                                         output_list);
+    if (iree_status_is_ok(status) && cacheable) {
+      status = iree_runtime_result_cache_insert(
+          session->result_cache, &cache_key, device, output_list);
+    }
+  }
+  iree_runtime_result_cache_key_deinitialize(&cache_key);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, hit ? "hit" : "miss");
+  iree_runtime_session_end_call_profile(session, &profile_start);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_runtime_session_call_async(
+    iree_runtime_session_t* session, const iree_vm_function_t* function,
+    iree_hal_fence_t* wait_fence, iree_vm_list_t* input_list,
+    iree_hal_fence_t* signal_fence, iree_vm_list_t* output_list) {
+  IREE_ASSERT_ARGUMENT(session);
+  IREE_ASSERT_ARGUMENT(function);
+  IREE_ASSERT_ARGUMENT(signal_fence);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_string_view_t model =
+      iree_vm_function_lookup_attr_by_name(function, IREE_SV("iree.abi.model"));
+  if (!iree_string_view_equal(model, IREE_SV("coarse-fences"))) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "function does not use the coarse-fences ABI model (has '%.*s'); "
+        "compile with --iree-execution-model=async-external",
+        (int)model.size, model.data);
+  }
+
+  iree_allocator_t host_allocator =
+      iree_runtime_session_host_allocator(session);
+  iree_runtime_call_profile_snapshot_t profile_start;
+  iree_runtime_session_begin_call_profile(session, &profile_start);
+
+  // Append (wait, signal) fences to a clone of the inputs. Calls that don't
+  // need to wait get an empty fence as the ABI requires one.
+  iree_vm_list_t* call_inputs = NULL;
+  iree_status_t status = iree_ok_status();
+  if (input_list) {
+    status = iree_vm_list_clone(input_list, host_allocator, &call_inputs);
+  } else {
+    status = iree_vm_list_create(/*element_type=*/NULL, 2, host_allocator,
+                                 &call_inputs);
+  }
+  iree_hal_fence_t* empty_fence = NULL;
+  if (iree_status_is_ok(status) && !wait_fence) {
+    status = iree_hal_fence_create(0, host_allocator, &empty_fence);
+    wait_fence = empty_fence;
+  }
+  if (iree_status_is_ok(status)) {
+    iree_vm_ref_t wait_fence_ref = iree_hal_fence_retain_ref(wait_fence);
+    status = iree_vm_list_push_ref_move(call_inputs, &wait_fence_ref);
+    iree_vm_ref_release(&wait_fence_ref);
+  }
+  if (iree_status_is_ok(status)) {
+    iree_vm_ref_t signal_fence_ref = iree_hal_fence_retain_ref(signal_fence);
+    status = iree_vm_list_push_ref_move(call_inputs, &signal_fence_ref);
+    iree_vm_ref_release(&signal_fence_ref);
+  }
+
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_invoke(iree_runtime_session_context(session), *function,
+                            IREE_VM_INVOCATION_FLAG_NONE,
+                            /*policy=*/NULL, call_inputs, output_list,
+                            host_allocator);
+  }
+
+  iree_hal_fence_release(empty_fence);
+  iree_vm_list_release(call_inputs);
+  iree_runtime_session_end_call_profile(session, &profile_start);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 IREE_API_EXPORT iree_status_t iree_runtime_session_call_by_name(
     iree_runtime_session_t* session, iree_string_view_t full_name,
     iree_vm_list_t* input_list, iree_vm_list_t* output_list) {
@@ -324,8 +573,11 @@ IREE_API_EXPORT iree_status_t iree_runtime_session_call_direct(
                                   iree_runtime_session_host_allocator(session));
 
   // Issue the call.
+  iree_runtime_call_profile_snapshot_t profile_start;
+  iree_runtime_session_begin_call_profile(session, &profile_start);
   iree_status_t status =
       call.function.module->begin_call(call.function.module->self, stack, call);
+  iree_runtime_session_end_call_profile(session, &profile_start);
 
   // Cleanup the stack.
   iree_vm_stack_deinitialize(stack);
@@ -333,3 +585,39 @@ IREE_API_EXPORT iree_status_t iree_runtime_session_call_direct(
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
+
+IREE_API_EXPORT iree_status_t iree_runtime_session_copy_buffer_view(
+    iree_runtime_session_t* session, iree_hal_buffer_view_t* source_view,
+    iree_hal_buffer_view_t** out_target_view) {
+  IREE_ASSERT_ARGUMENT(session);
+  IREE_ASSERT_ARGUMENT(source_view);
+  IREE_ASSERT_ARGUMENT(out_target_view);
+  *out_target_view = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_buffer_mapping_t source_mapping;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_buffer_map_range(
+              iree_hal_buffer_view_buffer(source_view),
+              IREE_HAL_MAPPING_MODE_SCOPED, IREE_HAL_MEMORY_ACCESS_READ, 0,
+              iree_hal_buffer_view_byte_length(source_view), &source_mapping));
+
+  iree_hal_buffer_params_t buffer_params = {
+      .type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
+      .usage = IREE_HAL_BUFFER_USAGE_DEFAULT,
+  };
+  iree_status_t status = iree_hal_buffer_view_allocate_buffer(
+      iree_runtime_session_device_allocator(session),
+      iree_hal_buffer_view_shape_rank(source_view),
+      iree_hal_buffer_view_shape_dims(source_view),
+      iree_hal_buffer_view_element_type(source_view),
+      iree_hal_buffer_view_encoding_type(source_view), buffer_params,
+      iree_make_const_byte_span(source_mapping.contents.data,
+                                source_mapping.contents.data_length),
+      out_target_view);
+
+  status =
+      iree_status_join(status, iree_hal_buffer_unmap_range(&source_mapping));
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
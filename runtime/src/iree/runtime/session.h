@@ -61,6 +61,16 @@ typedef struct iree_runtime_session_options_t {
   // Session creation will fail if a requested module is not built into the
   // runtime binary.
   iree_runtime_session_builtins_t builtin_modules;
+
+  // Maximum total byte length of output buffers and keys retained by the
+  // result cache used by iree_runtime_session_call_memoized. 0 disables the
+  // cache.
+  iree_device_size_t result_cache_capacity;
+
+  // Records the phase timings and memory usage of every call for
+  // iree_runtime_session_query_call_profile. Adds a few clock reads per call
+  // and per queue operation.
+  bool enable_call_profiling;
 } iree_runtime_session_options_t;
 
 // Initializes |out_options| to its default values.
@@ -128,10 +138,47 @@ IREE_API_EXPORT iree_hal_device_t* iree_runtime_session_device(
 IREE_API_EXPORT iree_hal_allocator_t* iree_runtime_session_device_allocator(
     const iree_runtime_session_t* session);
 
+// Performance counters of a single call issued through the session.
+// Tokens-per-second and similar rates are derived by the caller from the
+// durations and the work it knows the call performed.
+typedef struct iree_runtime_call_profile_t {
+  // Host wall time of the entire call.
+  iree_duration_t total_duration;
+  // Time spent executing VM code and host glue: the total duration minus the
+  // submit and wait durations.
+  iree_duration_t host_duration;
+  // Time spent issuing queue operations to the device and their count.
+  iree_duration_t submit_duration;
+  uint64_t submit_count;
+  // Time spent waiting on the device (or other sessions) to reach fences.
+  iree_duration_t wait_duration;
+  // Bytes moved between the host and device or copied on the device by the
+  // call; see iree_hal_module_statistics_t.
+  uint64_t transfer_bytes;
+  // Bytes allocated and freed from the device allocator during the call.
+  // Only available when the runtime is built with IREE_STATISTICS_ENABLE.
+  iree_device_size_t host_bytes_allocated;
+  iree_device_size_t host_bytes_freed;
+  iree_device_size_t device_bytes_allocated;
+  iree_device_size_t device_bytes_freed;
+} iree_runtime_call_profile_t;
+
+// Returns the profile of the most recent call issued through
+// iree_runtime_session_call (and its by-name, memoized, async and direct
+// variants) in |out_profile|. Async calls only cover the time taken to
+// schedule their work. Memoized calls served from the result cache have no
+// device activity.
+//
+// Returns IREE_STATUS_FAILED_PRECONDITION if the session was created without
+// iree_runtime_session_options_t::enable_call_profiling.
+IREE_API_EXPORT iree_status_t iree_runtime_session_query_call_profile(
+    const iree_runtime_session_t* session,
+    iree_runtime_call_profile_t* out_profile);
+
 // Trims transient/cached resources used by the session.
 // Upon resuming these resources may be expensive to rematerialize/reload and
 // as such this should only be called when it is known the resources will not
-// be needed soon.
+// be needed soon. This releases all outputs held by the result cache.
 IREE_API_EXPORT iree_status_t
 iree_runtime_session_trim(iree_runtime_session_t* session);
 
@@ -207,6 +254,54 @@ IREE_API_EXPORT iree_status_t iree_runtime_session_call(
     iree_runtime_session_t* session, const iree_vm_function_t* function,
     iree_vm_list_t* input_list, iree_vm_list_t* output_list);
 
+// Synchronously issues a function call whose results may be served from the
+// session result cache (see iree_runtime_session_options_t
+// result_cache_capacity). The caller asserts that |function| is pure and
+// deterministic: that its outputs depend only on its inputs and that it has no
+// side effects that must be observed on each call.
+//
+// The call is identified by |function| and |key| if provided. If |key| is
+// empty the call is identified by the types, shapes, and contents of the
+// values in |input_list| which requires that all buffers are mappable by the
+// host; calls with inputs that cannot be hashed are never memoized. Hashing
+// reads every input byte on the host so callers that already have a cheap
+// identity for their inputs (a request id, a prompt hash) should pass it as
+// |key|.
+//
+// On a cache hit the previously produced outputs are appended to
+// |output_list| without invoking the function. Cached buffers are copied on the
+// session device when inserted and again for each hit so the caller owns the
+// outputs it receives and may write to or donate them. Only outputs
+// consisting entirely of primitive values and buffer views are cached and the
+// least-recently used entries are evicted when the total byte length of cached
+// buffers and their keys would exceed the cache capacity.
+//
+// Behaves exactly like iree_runtime_session_call if the cache is disabled.
+IREE_API_EXPORT iree_status_t iree_runtime_session_call_memoized(
+    iree_runtime_session_t* session, const iree_vm_function_t* function,
+    iree_const_byte_span_t key, iree_vm_list_t* input_list,
+    iree_vm_list_t* output_list);
+
+// Asynchronously issues a function compiled with the `coarse-fences` ABI
+// model (`iree.abi.model` reflection attribute, see -iree-execution-model).
+// The call returns once device work has been scheduled: |wait_fence| gates
+// the start of the device work and |signal_fence| is signaled once all
+// outputs are ready. Outputs in |output_list| may only be accessed on the host
+// after |signal_fence| is reached.
+//
+// |wait_fence| may be NULL to start immediately. |signal_fence| is required
+// and may use semaphores of any device, allowing sessions on different
+// devices to be chained without host round-trips: a draft model on a
+// `local-task` session can signal the fence that a verifying call on a PIM
+// session waits on while the host keeps drafting the next tokens.
+//
+// |input_list| must not contain the fences; they are appended to a shallow
+// clone so the caller's list is left untouched.
+IREE_API_EXPORT iree_status_t iree_runtime_session_call_async(
+    iree_runtime_session_t* session, const iree_vm_function_t* function,
+    iree_hal_fence_t* wait_fence, iree_vm_list_t* input_list,
+    iree_hal_fence_t* signal_fence, iree_vm_list_t* output_list);
+
 // Synchronously issues a generic function call by fully-qualified name.
 // This is equivalent to performing a iree_runtime_session_lookup_function
 // followed by a iree_runtime_session_call. When calling the same function
@@ -227,6 +322,17 @@ IREE_API_EXPORT iree_status_t iree_runtime_session_call_by_name(
 IREE_API_EXPORT iree_status_t iree_runtime_session_call_direct(
     iree_runtime_session_t* session, const iree_vm_function_call_t call);
 
+// Copies |source_view| (possibly owned by another session's device) into a
+// new buffer view allocated from the device allocator of |session|.
+// |source_view| must be mappable by the host and any work producing it must
+// have completed, such as after waiting on the signal fence of a
+// iree_runtime_session_call_async. This is intended for small hand-offs
+// between sessions like the drafted token ids that a verifying session
+// consumes. |out_target_view| must be released by the caller.
+IREE_API_EXPORT iree_status_t iree_runtime_session_copy_buffer_view(
+    iree_runtime_session_t* session, iree_hal_buffer_view_t* source_view,
+    iree_hal_buffer_view_t** out_target_view);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
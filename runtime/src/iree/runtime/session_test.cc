@@ -0,0 +1,268 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/runtime/session.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/modules/hal/types.h"
+#include "iree/runtime/instance.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/api.h"
+#include "iree/vm/native_module_cc.h"
+
+namespace iree {
+namespace {
+
+// Module standing in for a program compiled with
+// --iree-execution-model=async-external: each function takes the (wait,
+// signal) fences appended by iree_runtime_session_call_async.
+class AsyncModuleState final {
+ public:
+  // Returns |input| unchanged once |wait_fence| is reached.
+  StatusOr<vm::ref<iree_hal_buffer_view_t>> Echo(
+      vm::ref<iree_hal_buffer_view_t> input, vm::ref<iree_hal_fence_t> wait,
+      vm::ref<iree_hal_fence_t> signal) {
+    IREE_RETURN_IF_ERROR(iree_hal_fence_wait(wait.get(),
+                                             iree_infinite_timeout()));
+    IREE_RETURN_IF_ERROR(iree_hal_fence_signal(signal.get()));
+    return std::move(input);
+  }
+
+  // Fails |signal| as a program does when its queued work fails after the
+  // call has returned.
+  Status Fail(vm::ref<iree_hal_buffer_view_t> input,
+              vm::ref<iree_hal_fence_t> wait,
+              vm::ref<iree_hal_fence_t> signal) {
+    iree_hal_fence_fail(signal.get(), iree_make_status(IREE_STATUS_DATA_LOSS,
+                                                       "device lost"));
+    return OkStatus();
+  }
+};
+
+static const vm::NativeFunction<AsyncModuleState> kAsyncModuleFunctions[] = {
+    vm::MakeNativeFunction("echo", &AsyncModuleState::Echo),
+    vm::MakeNativeFunction("fail", &AsyncModuleState::Fail),
+    // Same as echo but without the coarse-fences ABI model attribute.
+    vm::MakeNativeFunction("sync_echo", &AsyncModuleState::Echo),
+};
+
+class AsyncModule final : public vm::NativeModule<AsyncModuleState> {
+ public:
+  using vm::NativeModule<AsyncModuleState>::NativeModule;
+
+  StatusOr<std::unique_ptr<AsyncModuleState>> CreateState(
+      iree_allocator_t allocator) override {
+    return std::make_unique<AsyncModuleState>();
+  }
+
+  // Reports the ABI model of the exports in kAsyncModuleFunctions as the
+  // compiler would; NativeModule has no function reflection of its own.
+  static iree_status_t GetFunctionAttr(void* self,
+                                       iree_vm_function_linkage_t linkage,
+                                       iree_host_size_t ordinal,
+                                       iree_host_size_t index,
+                                       iree_string_pair_t* out_attr) {
+    if (linkage != IREE_VM_FUNCTION_LINKAGE_EXPORT || ordinal >= 2 ||
+        index > 0) {
+      return iree_status_from_code(IREE_STATUS_OUT_OF_RANGE);
+    }
+    *out_attr = iree_make_string_pair(IREE_SV("iree.abi.model"),
+                                      IREE_SV("coarse-fences"));
+    return iree_ok_status();
+  }
+};
+
+class SessionTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    iree_runtime_instance_options_t instance_options;
+    iree_runtime_instance_options_initialize(&instance_options);
+    iree_runtime_instance_options_use_all_available_drivers(&instance_options);
+    IREE_ASSERT_OK(iree_runtime_instance_create(
+        &instance_options, iree_allocator_system(), &instance_));
+    iree_status_t status = iree_runtime_instance_try_create_default_device(
+        instance_, IREE_SV("local-sync"), &device_);
+    if (iree_status_is_not_found(status)) {
+      fprintf(stderr, "Skipping test as 'local-sync' driver was not found:\n");
+      iree_status_fprint(stderr, status);
+      iree_status_free(status);
+      GTEST_SKIP();
+    }
+    IREE_ASSERT_OK(status);
+
+    iree_runtime_session_options_t session_options;
+    iree_runtime_session_options_initialize(&session_options);
+    IREE_ASSERT_OK(iree_runtime_session_create_with_device(
+        instance_, &session_options, device_, iree_allocator_system(),
+        &session_));
+
+    auto module = std::make_unique<AsyncModule>(
+        "async", /*version=*/0, iree_runtime_instance_vm_instance(instance_),
+        iree_allocator_system(),
+        iree::span<const vm::NativeFunction<AsyncModuleState>>(
+            kAsyncModuleFunctions));
+    iree_vm_module_t* module_ptr = module.release()->interface();
+    module_ptr->get_function_attr = AsyncModule::GetFunctionAttr;
+    status = iree_runtime_session_append_module(session_, module_ptr);
+    iree_vm_module_release(module_ptr);
+    IREE_ASSERT_OK(status);
+
+    IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore_));
+    IREE_ASSERT_OK(iree_hal_fence_create_at(
+        semaphore_, 1ull, iree_allocator_system(), &signal_fence_));
+  }
+
+  virtual void TearDown() {
+    iree_hal_fence_release(signal_fence_);
+    iree_hal_semaphore_release(semaphore_);
+    iree_runtime_session_release(session_);
+    iree_hal_device_release(device_);
+    iree_runtime_instance_release(instance_);
+  }
+
+  // Creates a 2x2xi32 buffer view with |contents| from |allocator|.
+  vm::ref<iree_hal_buffer_view_t> CreateView(iree_hal_allocator_t* allocator,
+                                             const int32_t (&contents)[4]) {
+    iree_hal_dim_t shape[2] = {2, 2};
+    iree_hal_buffer_params_t params;
+    memset(&params, 0, sizeof(params));
+    params.type =
+        IREE_HAL_MEMORY_TYPE_HOST_LOCAL | IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE;
+    params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
+    vm::ref<iree_hal_buffer_view_t> buffer_view;
+    IREE_CHECK_OK(iree_hal_buffer_view_allocate_buffer(
+        allocator, IREE_ARRAYSIZE(shape), shape, IREE_HAL_ELEMENT_TYPE_INT_32,
+        IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR, params,
+        iree_make_const_byte_span(contents, sizeof(contents)), &buffer_view));
+    return buffer_view;
+  }
+
+  // Calls async.|name| with |input| and no wait fence.
+  iree_status_t CallAsync(iree_string_view_t name,
+                          iree_hal_buffer_view_t* input,
+                          iree_vm_list_t* outputs) {
+    iree_vm_function_t function;
+    IREE_RETURN_IF_ERROR(
+        iree_runtime_session_lookup_function(session_, name, &function));
+    vm::ref<iree_vm_list_t> inputs;
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(
+        /*element_type=*/NULL, 1, iree_allocator_system(), &inputs));
+    iree_vm_ref_t input_ref = iree_hal_buffer_view_retain_ref(input);
+    IREE_RETURN_IF_ERROR(iree_vm_list_push_ref_move(inputs.get(), &input_ref));
+    iree_status_t status = iree_runtime_session_call_async(
+        session_, &function, /*wait_fence=*/NULL, inputs.get(), signal_fence_,
+        outputs);
+    // The fences are appended to a clone; the caller's list is untouched.
+    EXPECT_EQ(iree_vm_list_size(inputs.get()), 1);
+    return status;
+  }
+
+  iree_runtime_instance_t* instance_ = nullptr;
+  iree_hal_device_t* device_ = nullptr;
+  iree_runtime_session_t* session_ = nullptr;
+  iree_hal_semaphore_t* semaphore_ = nullptr;
+  iree_hal_fence_t* signal_fence_ = nullptr;
+};
+
+TEST_F(SessionTest, CallAsyncSignalsFence) {
+  vm::ref<iree_hal_buffer_view_t> input =
+      CreateView(iree_runtime_session_device_allocator(session_), {1, 2, 3, 4});
+  vm::ref<iree_vm_list_t> outputs;
+  IREE_ASSERT_OK(iree_vm_list_create(/*element_type=*/NULL, 1,
+                                     iree_allocator_system(), &outputs));
+  IREE_ASSERT_OK(CallAsync(IREE_SV("async.echo"), input.get(), outputs.get()));
+
+  IREE_ASSERT_OK(iree_hal_fence_wait(signal_fence_, iree_infinite_timeout()));
+  uint64_t value = 0;
+  IREE_ASSERT_OK(iree_hal_semaphore_query(semaphore_, &value));
+  EXPECT_EQ(value, 1ull);
+  ASSERT_EQ(iree_vm_list_size(outputs.get()), 1);
+  EXPECT_EQ(iree_vm_list_get_buffer_view_assign(outputs.get(), 0),
+            input.get());
+}
+
+TEST_F(SessionTest, CallAsyncFailsFence) {
+  // The call itself succeeds; the failure is only observable on the fence.
+  vm::ref<iree_hal_buffer_view_t> input =
+      CreateView(iree_runtime_session_device_allocator(session_), {1, 2, 3, 4});
+  vm::ref<iree_vm_list_t> outputs;
+  IREE_ASSERT_OK(iree_vm_list_create(/*element_type=*/NULL, 0,
+                                     iree_allocator_system(), &outputs));
+  IREE_ASSERT_OK(CallAsync(IREE_SV("async.fail"), input.get(), outputs.get()));
+
+  iree_status_t status =
+      iree_hal_fence_wait(signal_fence_, iree_infinite_timeout());
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_ABORTED, status);
+  iree_status_free(status);
+  status = iree_hal_fence_query(signal_fence_);
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_DATA_LOSS, status);
+  iree_status_free(status);
+}
+
+TEST_F(SessionTest, CallAsyncRejectsSyncFunction) {
+  vm::ref<iree_hal_buffer_view_t> input =
+      CreateView(iree_runtime_session_device_allocator(session_), {1, 2, 3, 4});
+  vm::ref<iree_vm_list_t> outputs;
+  IREE_ASSERT_OK(iree_vm_list_create(/*element_type=*/NULL, 1,
+                                     iree_allocator_system(), &outputs));
+  iree_status_t status =
+      CallAsync(IREE_SV("async.sync_echo"), input.get(), outputs.get());
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_INVALID_ARGUMENT, status);
+  iree_status_free(status);
+
+  // The function was never invoked so the fence was not signaled.
+  uint64_t value = 0;
+  IREE_ASSERT_OK(iree_hal_semaphore_query(semaphore_, &value));
+  EXPECT_EQ(value, 0ull);
+}
+
+TEST_F(SessionTest, CopyBufferView) {
+  // The source comes from an allocator other than the session's as it would
+  // when handed off from another session's device.
+  iree_hal_allocator_t* source_allocator = NULL;
+  IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+      IREE_SV("source"), iree_allocator_system(), iree_allocator_system(),
+      &source_allocator));
+  vm::ref<iree_hal_buffer_view_t> source =
+      CreateView(source_allocator, {5, 6, 7, 8});
+
+  iree_hal_buffer_view_t* target = NULL;
+  IREE_ASSERT_OK(
+      iree_runtime_session_copy_buffer_view(session_, source.get(), &target));
+  ASSERT_NE(target, nullptr);
+  EXPECT_NE(iree_hal_buffer_view_buffer(target),
+            iree_hal_buffer_view_buffer(source.get()));
+  EXPECT_EQ(iree_hal_buffer_view_element_type(target),
+            IREE_HAL_ELEMENT_TYPE_INT_32);
+  ASSERT_EQ(iree_hal_buffer_view_shape_rank(target), 2);
+  EXPECT_EQ(iree_hal_buffer_view_shape_dim(target, 0), 2);
+  EXPECT_EQ(iree_hal_buffer_view_shape_dim(target, 1), 2);
+
+  // Later writes to the source do not reach the copy.
+  const int32_t zeros[4] = {0, 0, 0, 0};
+  IREE_ASSERT_OK(iree_hal_buffer_map_write(
+      iree_hal_buffer_view_buffer(source.get()), 0, zeros, sizeof(zeros)));
+  std::vector<int32_t> contents(4);
+  IREE_ASSERT_OK(iree_hal_buffer_map_read(iree_hal_buffer_view_buffer(target),
+                                          0, contents.data(),
+                                          contents.size() * sizeof(int32_t)));
+  EXPECT_EQ(contents, (std::vector<int32_t>{5, 6, 7, 8}));
+
+  iree_hal_buffer_view_release(target);
+  source.reset();
+  iree_hal_allocator_release(source_allocator);
+}
+
+}  // namespace
+}  // namespace iree
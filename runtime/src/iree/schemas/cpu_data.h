@@ -73,6 +73,77 @@ enum iree_cpu_data_field_0_e {
   // Canonical key: "i8mm"
   IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_I8MM = 1ull << 1,
 
+  // Indicates support for half-precision multiply-add-long instructions
+  // accumulating into single-precision.
+  //
+  // FMLAL, FMLAL2, FMLSL and FMLSL2 instructions are implemented.
+  //
+  // Source: ID_AA64ISAR0_EL1.FHM [51:48] == 0b0001 / HWCAP_ASIMDFHM
+  // Canonical key: "fp16fml"
+  IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_FP16FML = 1ull << 2,
+
+  // Indicates support for BFloat16 instructions.
+  //
+  // BFCVT, BFDOT, BFMLAL and BFMMLA instructions are implemented.
+  //
+  // Source: ID_AA64ISAR1_EL1.BF16 [47:44] >= 0b0001 / HWCAP2_BF16
+  // Canonical key: "bf16"
+  IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_BF16 = 1ull << 3,
+
+  //===--------------------------------------------------------------------===//
+  // IREE_ARCH_X86_64 / x86-64
+  //===--------------------------------------------------------------------===//
+
+  // Indicates support for AVX2 and FMA3 instructions and that the OS saves the
+  // YMM register state.
+  //
+  // Source: CPUID.(EAX=7,ECX=0):EBX.AVX2[5] + CPUID.(EAX=1):ECX.FMA[12] +
+  //         XCR0[2:1] == 0b11
+  // Canonical key: "avx2_fma"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2_FMA = 1ull << 0,
+  // Indicates support for the AVX-512 F, CD, VL, DQ and BW subsets (as found on
+  // Skylake-SP and newer) and that the OS saves the ZMM and opmask state.
+  //
+  // Source: CPUID.(EAX=7,ECX=0):EBX[16,17,28,30,31] + XCR0[7:5] == 0b111
+  // Canonical key: "avx512_base"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE = 1ull << 1,
+  // Indicates support for AVX-512 Vector Neural Network Instructions on top of
+  // IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE.
+  //
+  // VPDPBUSD(S) and VPDPWSSD(S) instructions are implemented.
+  //
+  // Source: CPUID.(EAX=7,ECX=0):ECX.AVX512_VNNI[11]
+  // Canonical key: "avx512_vnni"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_VNNI = 1ull << 2,
+  // Indicates support for AVX-512 BFloat16 instructions on top of
+  // IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BASE.
+  //
+  // VCVTNE2PS2BF16, VCVTNEPS2BF16 and VDPBF16PS instructions are implemented.
+  //
+  // Source: CPUID.(EAX=7,ECX=1):EAX.AVX512_BF16[5]
+  // Canonical key: "avx512_bf16"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512_BF16 = 1ull << 3,
+
+};
+
+// Shifts and masks for processor data field 1, which holds cache sizes.
+//
+// Each size is stored in KiB in a 20-bit slot (so up to 1 GiB per level) and
+// describes the cache local to a single core for L1D and the cache reachable
+// from a single core for L2 and L3, whether private or shared. A size of zero
+// means the level is unknown or absent and consumers must fall back to their
+// own defaults.
+//
+// Example: l2_cache_kb = (fields[1] >> IREE_CPU_DATA_FIELD_1_L2_CACHE_KB_SHIFT)
+//                        & IREE_CPU_DATA_FIELD_1_CACHE_KB_MASK;
+enum iree_cpu_data_field_1_e {
+  // Source: sysconf(_SC_LEVEL1_DCACHE_SIZE) / sysctl(hw.l1dcachesize)
+  IREE_CPU_DATA_FIELD_1_L1D_CACHE_KB_SHIFT = 0,
+  // Source: sysconf(_SC_LEVEL2_CACHE_SIZE) / sysctl(hw.l2cachesize)
+  IREE_CPU_DATA_FIELD_1_L2_CACHE_KB_SHIFT = 20,
+  // Source: sysconf(_SC_LEVEL3_CACHE_SIZE) / sysctl(hw.l3cachesize)
+  IREE_CPU_DATA_FIELD_1_L3_CACHE_KB_SHIFT = 40,
 };
+#define IREE_CPU_DATA_FIELD_1_CACHE_KB_MASK 0xFFFFFull
 
 #endif  // IREE_SCHEMAS_CPU_DATA_H_
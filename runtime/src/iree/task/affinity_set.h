@@ -7,6 +7,10 @@
 #ifndef IREE_TASK_AFFINITY_SET_H_
 #define IREE_TASK_AFFINITY_SET_H_
 
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "iree/base/api.h"
 #include "iree/base/internal/atomics.h"
 #include "iree/base/internal/math.h"
 #include "iree/task/tuning.h"
@@ -25,59 +29,223 @@ extern "C" {
 // iree_task_affinity_set_t
 //===----------------------------------------------------------------------===//
 
-typedef uint64_t iree_task_affinity_set_t;
+// Number of workers tracked by each word of an affinity set.
+#define IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT 64
+
+// Number of words in an affinity set. With the default worker count limit of
+// 64 the sets are a single word and compile down to plain bit operations.
+#define IREE_TASK_AFFINITY_SET_WORD_COUNT                  \
+  ((IREE_TASK_EXECUTOR_MAX_WORKER_COUNT +                 \
+    IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT - 1) /          \
+   IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT)
+
+// A set of workers within an executor indexed by their local worker index.
+// Sets are small values passed by value and manipulated with the functions
+// below; bit |i| of word |i / 64| represents worker |i|.
+typedef struct iree_task_affinity_set_t {
+  uint64_t words[IREE_TASK_AFFINITY_SET_WORD_COUNT];
+} iree_task_affinity_set_t;
+
+// Returns a set with no workers selected.
+static inline iree_task_affinity_set_t iree_task_affinity_set_empty(void) {
+  iree_task_affinity_set_t set;
+  for (int i = 0; i < IREE_TASK_AFFINITY_SET_WORD_COUNT; ++i) set.words[i] = 0;
+  return set;
+}
 
 // Allows for only a specific worker to be selected.
 static inline iree_task_affinity_set_t iree_task_affinity_for_worker(
-    uint8_t worker_index) {
-  return 1ull << worker_index;
+    iree_host_size_t worker_index) {
+  iree_task_affinity_set_t set = iree_task_affinity_set_empty();
+  set.words[worker_index / IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT] =
+      1ull << (worker_index % IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT);
+  return set;
 }
 
-// Allows for a range of workers to be selected.
+// Allows for the workers in [worker_start, worker_end) to be selected.
 static inline iree_task_affinity_set_t iree_task_affinity_for_worker_range(
-    uint8_t worker_start, uint8_t worker_end) {
-  return ((1ull << (worker_start - 1)) - 1) ^ ((1ull << worker_end) - 1);
+    iree_host_size_t worker_start, iree_host_size_t worker_end) {
+  iree_task_affinity_set_t set = iree_task_affinity_set_empty();
+  for (iree_host_size_t i = worker_start; i < worker_end; ++i) {
+    set.words[i / IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT] |=
+        1ull << (i % IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT);
+  }
+  return set;
 }
 
 // Allows for any worker to be selected.
 static inline iree_task_affinity_set_t iree_task_affinity_for_any_worker(void) {
-  return UINT64_MAX;
+  iree_task_affinity_set_t set;
+  for (int i = 0; i < IREE_TASK_AFFINITY_SET_WORD_COUNT; ++i) {
+    set.words[i] = UINT64_MAX;
+  }
+  return set;
+}
+
+// Returns true if no workers are selected in |set|.
+static inline bool iree_task_affinity_set_is_empty(
+    iree_task_affinity_set_t set) {
+  uint64_t any = 0;
+  for (int i = 0; i < IREE_TASK_AFFINITY_SET_WORD_COUNT; ++i) {
+    any |= set.words[i];
+  }
+  return any == 0;
+}
+
+// Returns true if |lhs| and |rhs| select the same workers.
+static inline bool iree_task_affinity_set_equal(iree_task_affinity_set_t lhs,
+                                                iree_task_affinity_set_t rhs) {
+  for (int i = 0; i < IREE_TASK_AFFINITY_SET_WORD_COUNT; ++i) {
+    if (lhs.words[i] != rhs.words[i]) return false;
+  }
+  return true;
+}
+
+// Returns true if |worker_index| is selected in |set|.
+static inline bool iree_task_affinity_set_test(iree_task_affinity_set_t set,
+                                               iree_host_size_t worker_index) {
+  return (set.words[worker_index / IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT] >>
+          (worker_index % IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT)) &
+         1;
+}
+
+// Adds |worker_index| to |set|.
+static inline void iree_task_affinity_set_insert(
+    iree_task_affinity_set_t* set, iree_host_size_t worker_index) {
+  set->words[worker_index / IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT] |=
+      1ull << (worker_index % IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT);
+}
+
+// Removes |worker_index| from |set|.
+static inline void iree_task_affinity_set_erase(
+    iree_task_affinity_set_t* set, iree_host_size_t worker_index) {
+  set->words[worker_index / IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT] &=
+      ~(1ull << (worker_index % IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT));
+}
+
+// Returns the workers selected in both |lhs| and |rhs|.
+static inline iree_task_affinity_set_t iree_task_affinity_set_and(
+    iree_task_affinity_set_t lhs, iree_task_affinity_set_t rhs) {
+  for (int i = 0; i < IREE_TASK_AFFINITY_SET_WORD_COUNT; ++i) {
+    lhs.words[i] &= rhs.words[i];
+  }
+  return lhs;
+}
+
+// Returns the workers selected in either |lhs| or |rhs|.
+static inline iree_task_affinity_set_t iree_task_affinity_set_or(
+    iree_task_affinity_set_t lhs, iree_task_affinity_set_t rhs) {
+  for (int i = 0; i < IREE_TASK_AFFINITY_SET_WORD_COUNT; ++i) {
+    lhs.words[i] |= rhs.words[i];
+  }
+  return lhs;
+}
+
+// Returns the workers selected in |lhs| but not in |rhs|.
+static inline iree_task_affinity_set_t iree_task_affinity_set_and_not(
+    iree_task_affinity_set_t lhs, iree_task_affinity_set_t rhs) {
+  for (int i = 0; i < IREE_TASK_AFFINITY_SET_WORD_COUNT; ++i) {
+    lhs.words[i] &= ~rhs.words[i];
+  }
+  return lhs;
+}
+
+// Returns the workers not selected in |set|.
+static inline iree_task_affinity_set_t iree_task_affinity_set_not(
+    iree_task_affinity_set_t set) {
+  for (int i = 0; i < IREE_TASK_AFFINITY_SET_WORD_COUNT; ++i) {
+    set.words[i] = ~set.words[i];
+  }
+  return set;
+}
+
+// Returns the number of workers selected in |set|.
+static inline int iree_task_affinity_set_count_ones(
+    iree_task_affinity_set_t set) {
+  int count = 0;
+  for (int i = 0; i < IREE_TASK_AFFINITY_SET_WORD_COUNT; ++i) {
+    count += iree_math_count_ones_u64(set.words[i]);
+  }
+  return count;
+}
+
+// Returns the lowest worker index selected in |set| at or after
+// |worker_index| or -1 if there is none.
+static inline int iree_task_affinity_set_find_next(
+    iree_task_affinity_set_t set, iree_host_size_t worker_index) {
+  iree_host_size_t word_index =
+      worker_index / IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT;
+  if (word_index >= IREE_TASK_AFFINITY_SET_WORD_COUNT) return -1;
+  uint64_t word = set.words[word_index] &
+                  (UINT64_MAX << (worker_index %
+                                  IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT));
+  while (!word) {
+    if (++word_index >= IREE_TASK_AFFINITY_SET_WORD_COUNT) return -1;
+    word = set.words[word_index];
+  }
+  return (int)(word_index * IREE_TASK_AFFINITY_SET_WORD_BIT_COUNT +
+               iree_math_count_trailing_zeros_u64(word));
+}
+
+// Returns the lowest worker index selected in |set| or -1 if it is empty.
+static inline int iree_task_affinity_set_find_first(
+    iree_task_affinity_set_t set) {
+  return iree_task_affinity_set_find_next(set, 0);
 }
 
-#define iree_task_affinity_set_count_leading_zeros \
-  iree_math_count_leading_zeros_u64
-#define iree_task_affinity_set_count_trailing_zeros \
-  iree_math_count_trailing_zeros_u64
-#define iree_task_affinity_set_count_ones iree_math_count_ones_u64
-#define iree_task_affinity_set_rotr iree_math_rotr_u64
+// Iterates over the workers selected in |set| in increasing order.
+#define IREE_TASK_AFFINITY_SET_FOR_EACH(worker_index, set)              \
+  for (int worker_index = iree_task_affinity_set_find_first(set);       \
+       worker_index >= 0;                                               \
+       worker_index = iree_task_affinity_set_find_next(set, worker_index + 1))
 
 //===----------------------------------------------------------------------===//
 // iree_atomic_task_affinity_set_t
 //===----------------------------------------------------------------------===//
 
-typedef iree_atomic_int64_t iree_atomic_task_affinity_set_t;
+// An affinity set shared across threads. Each word is updated atomically but
+// multi-word sets are not read or written as a single atomic unit; they are
+// only used for the scheduling hints that tolerate stale bits.
+typedef struct iree_atomic_task_affinity_set_t {
+  iree_atomic_int64_t words[IREE_TASK_AFFINITY_SET_WORD_COUNT];
+} iree_atomic_task_affinity_set_t;
 
 static inline iree_task_affinity_set_t iree_atomic_task_affinity_set_load(
     iree_atomic_task_affinity_set_t* set, iree_memory_order_t order) {
-  return iree_atomic_load_int64(set, order);
+  iree_task_affinity_set_t value;
+  for (int i = 0; i < IREE_TASK_AFFINITY_SET_WORD_COUNT; ++i) {
+    value.words[i] = (uint64_t)iree_atomic_load_int64(&set->words[i], order);
+  }
+  return value;
 }
 
 static inline void iree_atomic_task_affinity_set_store(
     iree_atomic_task_affinity_set_t* set, iree_task_affinity_set_t value,
     iree_memory_order_t order) {
-  iree_atomic_store_int64(set, value, order);
+  for (int i = 0; i < IREE_TASK_AFFINITY_SET_WORD_COUNT; ++i) {
+    iree_atomic_store_int64(&set->words[i], (int64_t)value.words[i], order);
+  }
 }
 
-static inline iree_task_affinity_set_t iree_atomic_task_affinity_set_fetch_and(
+// Clears all workers not in |value|. Words that are unchanged are skipped.
+static inline void iree_atomic_task_affinity_set_fetch_and(
     iree_atomic_task_affinity_set_t* set, iree_task_affinity_set_t value,
     iree_memory_order_t order) {
-  return iree_atomic_fetch_and_int64(set, value, order);
+  for (int i = 0; i < IREE_TASK_AFFINITY_SET_WORD_COUNT; ++i) {
+    if (value.words[i] == UINT64_MAX) continue;
+    iree_atomic_fetch_and_int64(&set->words[i], (int64_t)value.words[i],
+                                order);
+  }
 }
 
-static inline iree_task_affinity_set_t iree_atomic_task_affinity_set_fetch_or(
+// Sets all workers in |value|. Words that are unchanged are skipped.
+static inline void iree_atomic_task_affinity_set_fetch_or(
     iree_atomic_task_affinity_set_t* set, iree_task_affinity_set_t value,
     iree_memory_order_t order) {
-  return iree_atomic_fetch_or_int64(set, value, order);
+  for (int i = 0; i < IREE_TASK_AFFINITY_SET_WORD_COUNT; ++i) {
+    if (value.words[i] == 0) continue;
+    iree_atomic_fetch_or_int64(&set->words[i], (int64_t)value.words[i], order);
+  }
 }
 
 #ifdef __cplusplus
@@ -0,0 +1,105 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/task/affinity_set.h"
+
+#include <vector>
+
+#include "iree/testing/gtest.h"
+
+namespace {
+
+// Returns the worker indices selected in |set| in iteration order.
+static std::vector<int> Workers(iree_task_affinity_set_t set) {
+  std::vector<int> workers;
+  IREE_TASK_AFFINITY_SET_FOR_EACH(worker_index, set) {
+    workers.push_back(worker_index);
+  }
+  return workers;
+}
+
+TEST(AffinitySetTest, Empty) {
+  iree_task_affinity_set_t set = iree_task_affinity_set_empty();
+  EXPECT_TRUE(iree_task_affinity_set_is_empty(set));
+  EXPECT_EQ(0, iree_task_affinity_set_count_ones(set));
+  EXPECT_EQ(-1, iree_task_affinity_set_find_first(set));
+  EXPECT_TRUE(Workers(set).empty());
+}
+
+TEST(AffinitySetTest, AnyWorker) {
+  iree_task_affinity_set_t set = iree_task_affinity_for_any_worker();
+  EXPECT_EQ(IREE_TASK_EXECUTOR_MAX_WORKER_COUNT,
+            iree_task_affinity_set_count_ones(set));
+  EXPECT_TRUE(iree_task_affinity_set_test(
+      set, IREE_TASK_EXECUTOR_MAX_WORKER_COUNT - 1));
+}
+
+TEST(AffinitySetTest, InsertErase) {
+  iree_task_affinity_set_t set = iree_task_affinity_set_empty();
+  iree_task_affinity_set_insert(&set, 3);
+  iree_task_affinity_set_insert(&set, IREE_TASK_EXECUTOR_MAX_WORKER_COUNT - 1);
+  EXPECT_EQ(2, iree_task_affinity_set_count_ones(set));
+  EXPECT_TRUE(iree_task_affinity_set_test(set, 3));
+  EXPECT_FALSE(iree_task_affinity_set_test(set, 4));
+  EXPECT_EQ((std::vector<int>{3, IREE_TASK_EXECUTOR_MAX_WORKER_COUNT - 1}),
+            Workers(set));
+  iree_task_affinity_set_erase(&set, 3);
+  EXPECT_EQ(IREE_TASK_EXECUTOR_MAX_WORKER_COUNT - 1,
+            iree_task_affinity_set_find_first(set));
+}
+
+TEST(AffinitySetTest, Range) {
+  iree_task_affinity_set_t set = iree_task_affinity_for_worker_range(2, 5);
+  EXPECT_EQ((std::vector<int>{2, 3, 4}), Workers(set));
+  EXPECT_TRUE(iree_task_affinity_set_is_empty(
+      iree_task_affinity_for_worker_range(4, 4)));
+}
+
+TEST(AffinitySetTest, FindNext) {
+  iree_task_affinity_set_t set = iree_task_affinity_for_worker(1);
+  iree_task_affinity_set_insert(&set, 6);
+  EXPECT_EQ(1, iree_task_affinity_set_find_next(set, 0));
+  EXPECT_EQ(1, iree_task_affinity_set_find_next(set, 1));
+  EXPECT_EQ(6, iree_task_affinity_set_find_next(set, 2));
+  EXPECT_EQ(-1, iree_task_affinity_set_find_next(set, 7));
+  EXPECT_EQ(-1, iree_task_affinity_set_find_next(
+                    set, IREE_TASK_EXECUTOR_MAX_WORKER_COUNT));
+}
+
+TEST(AffinitySetTest, SetOperations) {
+  iree_task_affinity_set_t lhs = iree_task_affinity_for_worker_range(0, 4);
+  iree_task_affinity_set_t rhs = iree_task_affinity_for_worker_range(2, 6);
+  EXPECT_EQ((std::vector<int>{2, 3}),
+            Workers(iree_task_affinity_set_and(lhs, rhs)));
+  EXPECT_EQ((std::vector<int>{0, 1, 2, 3, 4, 5}),
+            Workers(iree_task_affinity_set_or(lhs, rhs)));
+  EXPECT_EQ((std::vector<int>{0, 1}),
+            Workers(iree_task_affinity_set_and_not(lhs, rhs)));
+  EXPECT_TRUE(iree_task_affinity_set_equal(
+      iree_task_affinity_set_not(iree_task_affinity_set_not(lhs)), lhs));
+  EXPECT_FALSE(iree_task_affinity_set_equal(lhs, rhs));
+}
+
+TEST(AffinitySetTest, Atomic) {
+  iree_atomic_task_affinity_set_t atomic_set;
+  iree_atomic_task_affinity_set_store(&atomic_set,
+                                      iree_task_affinity_for_worker_range(0, 4),
+                                      iree_memory_order_relaxed);
+  iree_atomic_task_affinity_set_fetch_and(
+      &atomic_set,
+      iree_task_affinity_set_not(iree_task_affinity_for_worker(1)),
+      iree_memory_order_relaxed);
+  iree_atomic_task_affinity_set_fetch_or(
+      &atomic_set,
+      iree_task_affinity_for_worker(IREE_TASK_EXECUTOR_MAX_WORKER_COUNT - 1),
+      iree_memory_order_relaxed);
+  EXPECT_EQ((std::vector<int>{0, 2, 3,
+                              IREE_TASK_EXECUTOR_MAX_WORKER_COUNT - 1}),
+            Workers(iree_atomic_task_affinity_set_load(
+                &atomic_set, iree_memory_order_relaxed)));
+}
+
+}  // namespace
@@ -9,7 +9,9 @@
 #include <stdbool.h>
 #include <string.h>
 
+#include "iree/base/internal/call_once.h"
 #include "iree/base/internal/flags.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/base/tracing.h"
 #include "iree/task/topology.h"
 
@@ -39,12 +41,20 @@ IREE_FLAG(
 IREE_FLAG(
     int32_t, task_worker_local_memory, 0,  // 64 * 1024,
     "Specifies the bytes of per-worker local memory allocated for use by\n"
-    "dispatched tiles. Tiles may use less than this but will fail to dispatch\n"
-    "if they require more. Conceptually it is like a stack reservation and\n"
+    "dispatched tiles. Tiles may use less than this and workers will grow\n"
+    "their local memory up to --task_worker_local_memory_limit for tiles\n"
+    "requiring more. Conceptually it is like a stack reservation and\n"
     "should be treated the same way: the source programs must be built to\n"
     "only use a specific maximum amount of local memory and the runtime must\n"
     "be configured to make at least that amount of local memory available.");
 
+IREE_FLAG(
+    int32_t, task_worker_local_memory_limit, 16 * 1024 * 1024,
+    "Specifies the maximum bytes of per-worker local memory each worker may\n"
+    "grow to on demand when a dispatched tile requires more than\n"
+    "--task_worker_local_memory. Grown memory is allocated by the worker on\n"
+    "its own NUMA node and retained for reuse. 0 disables growth.");
+
 iree_status_t iree_task_executor_options_initialize_from_flags(
     iree_task_executor_options_t* out_options) {
   IREE_ASSERT_ARGUMENT(out_options);
@@ -55,6 +65,8 @@ iree_status_t iree_task_executor_options_initialize_from_flags(
       (iree_host_size_t)FLAG_task_worker_stack_size;
   out_options->worker_local_memory_size =
       (iree_host_size_t)FLAG_task_worker_local_memory;
+  out_options->worker_local_memory_limit =
+      (iree_host_size_t)FLAG_task_worker_local_memory_limit;
   return iree_ok_status();
 }
 
@@ -94,6 +106,14 @@ IREE_FLAG(
     "detected and used when --task_topology_group_count=0 and is ignored\n"
     "otherwise.");
 
+IREE_FLAG(
+    int32_t, task_topology_partition_count, 1,
+    "Splits the workers in each topology into the given number of disjoint\n"
+    "partitions with one executor created per partition. Devices expose one\n"
+    "queue per executor such that independent work submitted to different\n"
+    "queue affinities runs concurrently on separate workers instead of\n"
+    "contending for the same ones.");
+
 // Builds a bitmask of NUMA nodes that topologies should be created for.
 //
 // NOTE: because of the mask being 64-bits we have a 64-node limit.
@@ -193,8 +213,7 @@ static iree_status_t iree_task_flags_dump_task_topologies(
   uint64_t node_mask_bits = node_mask;
   iree_task_topology_node_id_t node_base_id = 0;
   for (iree_host_size_t i = 0; i < topology_count; ++i) {
-    int node_offset =
-        iree_task_affinity_set_count_trailing_zeros(node_mask_bits);
+    int node_offset = iree_math_count_trailing_zeros_u64(node_mask_bits);
     iree_task_topology_node_id_t node_id = node_base_id + node_offset;
     node_base_id += node_offset + 1;
     node_mask_bits = iree_shr(node_mask_bits, node_offset + 1);
@@ -227,21 +246,21 @@ static iree_status_t iree_task_flags_dump_task_topologies(
       }
       fprintf(stdout, "\n");
       fprintf(stdout, "#  cache sharing: ");
-      if (group->constructive_sharing_mask == 0) {
+      if (iree_task_affinity_set_is_empty(group->constructive_sharing_mask)) {
         fprintf(stdout, "(none)\n");
-      } else if (group->constructive_sharing_mask ==
-                 IREE_TASK_TOPOLOGY_GROUP_MASK_ALL) {
+      } else if (iree_task_affinity_set_equal(
+                     group->constructive_sharing_mask,
+                     IREE_TASK_TOPOLOGY_GROUP_MASK_ALL)) {
         fprintf(stdout, "(all/undefined)\n");
       } else {
         fprintf(stdout, "%d group(s): ",
-                iree_math_count_ones_u64(group->constructive_sharing_mask));
-        for (iree_host_size_t ic = 0, jc = 0;
-             ic < IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT; ++ic) {
-          if ((group->constructive_sharing_mask >> ic) & 1) {
-            if (jc > 0) fprintf(stdout, ", ");
-            fprintf(stdout, "%" PRIhsz, ic);
-            ++jc;
-          }
+                iree_task_affinity_set_count_ones(
+                    group->constructive_sharing_mask));
+        int jc = 0;
+        IREE_TASK_AFFINITY_SET_FOR_EACH(ic, group->constructive_sharing_mask) {
+          if (jc > 0) fprintf(stdout, ", ");
+          fprintf(stdout, "%d", ic);
+          ++jc;
         }
         fprintf(stdout, "\n");
       }
@@ -258,6 +277,152 @@ IREE_FLAG_CALLBACK(
     NULL, dump_task_topologies,
     "Dumps the flag-specified topology used for creating task executors.");
 
+//===----------------------------------------------------------------------===//
+// Process-wide shared executors
+//===----------------------------------------------------------------------===//
+
+IREE_FLAG(
+    bool, task_share_executors, false,
+    "Shares executors process-wide: executors created from flags with the\n"
+    "same options and topology reuse the same workers instead of each\n"
+    "driver instance creating its own threads. This prevents multiple\n"
+    "drivers (such as one per hosted model) from oversubscribing cores.");
+
+typedef struct iree_task_shared_executor_t {
+  struct iree_task_shared_executor_t* next;
+  uint64_t key;
+  iree_task_executor_t* executor;  // retained
+} iree_task_shared_executor_t;
+
+typedef struct iree_task_shared_executor_registry_t {
+  // Guards the entry list.
+  iree_slim_mutex_t mutex;
+  iree_task_shared_executor_t* head;
+} iree_task_shared_executor_registry_t;
+
+static iree_task_shared_executor_registry_t iree_task_shared_executor_registry_;
+static iree_once_flag iree_task_shared_executor_registry_flag_ =
+    IREE_ONCE_FLAG_INIT;
+static void iree_task_shared_executor_registry_initialize(void) {
+  memset(&iree_task_shared_executor_registry_, 0,
+         sizeof(iree_task_shared_executor_registry_));
+  iree_slim_mutex_initialize(&iree_task_shared_executor_registry_.mutex);
+}
+
+static iree_task_shared_executor_registry_t* iree_task_shared_executor_registry(
+    void) {
+  iree_call_once(&iree_task_shared_executor_registry_flag_,
+                 iree_task_shared_executor_registry_initialize);
+  return &iree_task_shared_executor_registry_;
+}
+
+// Mixes |value| into a 64-bit FNV-1a |hash|.
+static uint64_t iree_task_shared_executor_hash(uint64_t hash, uint64_t value) {
+  for (int i = 0; i < 8; ++i) {
+    hash = (hash ^ (value & 0xFF)) * 0x100000001B3ull;
+    value >>= 8;
+  }
+  return hash;
+}
+
+// Returns a key identifying executors created with |options| and |topology|.
+// Only fields that affect executor behavior are included (names are not).
+static uint64_t iree_task_shared_executor_key(
+    const iree_task_executor_options_t* options,
+    const iree_task_topology_t* topology) {
+  uint64_t hash = 0xCBF29CE484222325ull;
+  hash = iree_task_shared_executor_hash(hash, options->scheduling_mode);
+  hash = iree_task_shared_executor_hash(hash, options->worker_base_index);
+  hash = iree_task_shared_executor_hash(hash, options->worker_spin_ns);
+  hash = iree_task_shared_executor_hash(hash, options->worker_stack_size);
+  hash =
+      iree_task_shared_executor_hash(hash, options->worker_local_memory_size);
+  hash =
+      iree_task_shared_executor_hash(hash, options->worker_local_memory_limit);
+  hash = iree_task_shared_executor_hash(hash, topology->group_count);
+  for (iree_host_size_t i = 0; i < topology->group_count; ++i) {
+    const iree_task_topology_group_t* group = &topology->groups[i];
+    const iree_thread_affinity_t affinity = group->ideal_thread_affinity;
+    hash = iree_task_shared_executor_hash(hash, group->processor_index);
+    hash = iree_task_shared_executor_hash(hash, group->node_id);
+    hash = iree_task_shared_executor_hash(
+        hash, ((uint64_t)affinity.specified << 0) |
+                  ((uint64_t)affinity.smt << 1) |
+                  ((uint64_t)affinity.group << 2) |
+                  ((uint64_t)affinity.id << 9));
+    for (iree_host_size_t j = 0; j < IREE_TASK_AFFINITY_SET_WORD_COUNT; ++j) {
+      hash = iree_task_shared_executor_hash(
+          hash, group->constructive_sharing_mask.words[j]);
+    }
+  }
+  return hash;
+}
+
+// Returns a retained executor matching |options| and |topology|, creating it
+// if no matching executor exists. When sharing is disabled by flags this
+// always creates a new executor.
+static iree_status_t iree_task_executor_create_or_share(
+    iree_task_executor_options_t options, const iree_task_topology_t* topology,
+    iree_allocator_t host_allocator, iree_task_executor_t** out_executor) {
+  if (!FLAG_task_share_executors) {
+    return iree_task_executor_create(options, topology, host_allocator,
+                                     out_executor);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_task_shared_executor_registry_t* registry =
+      iree_task_shared_executor_registry();
+  const uint64_t key = iree_task_shared_executor_key(&options, topology);
+
+  iree_slim_mutex_lock(&registry->mutex);
+  iree_task_shared_executor_t* entry = registry->head;
+  while (entry && entry->key != key) entry = entry->next;
+  iree_status_t status = iree_ok_status();
+  if (!entry) {
+    // Entries outlive the caller and are freed by
+    // iree_task_executors_release_shared so use the system allocator.
+    status = iree_allocator_malloc(iree_allocator_system(), sizeof(*entry),
+                                   (void**)&entry);
+    if (iree_status_is_ok(status)) {
+      entry->key = key;
+      status = iree_task_executor_create(options, topology, host_allocator,
+                                         &entry->executor);
+      if (iree_status_is_ok(status)) {
+        entry->next = registry->head;
+        registry->head = entry;
+      } else {
+        iree_allocator_free(iree_allocator_system(), entry);
+        entry = NULL;
+      }
+    }
+  }
+  if (iree_status_is_ok(status)) {
+    iree_task_executor_retain(entry->executor);
+    *out_executor = entry->executor;
+  }
+  iree_slim_mutex_unlock(&registry->mutex);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+void iree_task_executors_release_shared(void) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_task_shared_executor_registry_t* registry =
+      iree_task_shared_executor_registry();
+  iree_slim_mutex_lock(&registry->mutex);
+  iree_task_shared_executor_t* entry = registry->head;
+  registry->head = NULL;
+  iree_slim_mutex_unlock(&registry->mutex);
+  while (entry) {
+    iree_task_shared_executor_t* next = entry->next;
+    iree_task_executor_release(entry->executor);
+    iree_allocator_free(iree_allocator_system(), entry);
+    entry = next;
+  }
+  IREE_TRACE_ZONE_END(z0);
+}
+
 //===----------------------------------------------------------------------===//
 // Task system factory functions
 //===----------------------------------------------------------------------===//
@@ -282,14 +447,21 @@ iree_status_t iree_task_executors_create_from_flags(
   IREE_RETURN_IF_ERROR(
       iree_task_topologies_select_nodes_from_flags(&node_mask));
   const iree_host_size_t topology_count = iree_math_count_ones_u64(node_mask);
+  if (FLAG_task_topology_partition_count < 1) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "--task_topology_partition_count= must be >= 1");
+  }
+  const iree_host_size_t partition_count =
+      (iree_host_size_t)FLAG_task_topology_partition_count;
+  const iree_host_size_t executor_count = topology_count * partition_count;
 
-  // Since this utility function creates one executor per topology returned by
-  // the query we can check the executor capacity immediately.
-  if (topology_count > executor_capacity || !executors) {
+  // Since this utility function creates one executor per topology partition
+  // returned by the query we can check the executor capacity immediately.
+  if (executor_count > executor_capacity || !executors) {
     // Need more capacity.
-    *out_executor_count = topology_count;
+    *out_executor_count = executor_count;
     return iree_status_from_code(IREE_STATUS_OUT_OF_RANGE);
-  } else if (topology_count == 0) {
+  } else if (executor_count == 0) {
     // No executors required, early-exit.
     *out_executor_count = 0;
     return iree_ok_status();
@@ -317,8 +489,7 @@ iree_status_t iree_task_executors_create_from_flags(
   uint64_t node_mask_bits = node_mask;
   iree_task_topology_node_id_t node_base_id = 0;
   for (iree_host_size_t i = 0; i < topology_count; ++i) {
-    int node_offset =
-        iree_task_affinity_set_count_trailing_zeros(node_mask_bits);
+    int node_offset = iree_math_count_trailing_zeros_u64(node_mask_bits);
     iree_task_topology_node_id_t node_id = node_base_id + node_offset;
     node_base_id += node_offset + 1;
     node_mask_bits = iree_shr(node_mask_bits, node_offset + 1);
@@ -332,9 +503,22 @@ iree_status_t iree_task_executors_create_from_flags(
     // the executor creation will fail with 0 groups so the program won't get in
     // a weird state but it's probably not what a user would expect.
 
-    // Create executor with the given topology.
-    status = iree_task_executor_create(options, &topology, host_allocator,
-                                       &executors[i]);
+    // Create one executor per partition of the topology (usually just one).
+    if (partition_count == 1) {
+      status = iree_task_executor_create_or_share(
+          options, &topology, host_allocator, &executors[i]);
+    } else {
+      for (iree_host_size_t j = 0; j < partition_count; ++j) {
+        iree_task_topology_t partition;
+        iree_task_topology_initialize_from_partition(
+            &topology, j, partition_count, &partition);
+        status = iree_task_executor_create_or_share(
+            options, &partition, host_allocator,
+            &executors[i * partition_count + j]);
+        iree_task_topology_deinitialize(&partition);
+        if (!iree_status_is_ok(status)) break;
+      }
+    }
 
     // Executor has consumed the topology and it can be dropped now.
     iree_task_topology_deinitialize(&topology);
@@ -342,10 +526,10 @@ iree_status_t iree_task_executors_create_from_flags(
   }
 
   if (iree_status_is_ok(status)) {
-    *out_executor_count = topology_count;
+    *out_executor_count = executor_count;
   } else {
     // Release executors for the caller in case we partially initialized them.
-    for (iree_host_size_t i = 0; i < topology_count; ++i) {
+    for (iree_host_size_t i = 0; i < executor_count; ++i) {
       iree_task_executor_release(executors[i]);
     }
   }
@@ -35,7 +35,8 @@ iree_status_t iree_task_topology_initialize_from_flags(
 //===----------------------------------------------------------------------===//
 
 // Creates zero or more task executors from the current command line flags.
-// This creates one executor per topology selected using the same executor
+// This creates one executor per topology selected (or per partition of each
+// topology with --task_topology_partition_count=) using the same executor
 // parameters as specified by flags. |executors| is populated with retained
 // executor instances and callers must reserve the |executors| memory before
 // calling and release all executors using iree_task_executor_release when done
@@ -46,6 +47,12 @@ iree_status_t iree_task_topology_initialize_from_flags(
 // or programmatic configuration is needed use the iree_task_executor_create
 // method directly.
 //
+// When --task_share_executors is set executors are shared process-wide:
+// callers requesting the same executor options and topology receive the same
+// executors (and worker threads) such that multiple drivers hosted in the same
+// process don't oversubscribe the machine. Shared executors remain alive until
+// iree_task_executors_release_shared is called.
+//
 // Returns the total number of executors in |out_executor_count|.
 // Returns IREE_STATUS_OUT_OF_RANGE if |executor_capacity| is insufficient and
 // the caller needs to provide more storage in |executors|.
@@ -53,6 +60,12 @@ iree_status_t iree_task_executors_create_from_flags(
     iree_allocator_t host_allocator, iree_host_size_t executor_capacity,
     iree_task_executor_t** executors, iree_host_size_t* out_executor_count);
 
+// Releases the process-wide references to executors shared by
+// iree_task_executors_create_from_flags. Executors still retained by drivers
+// or devices remain alive until those are released and subsequent requests
+// will create new executors.
+void iree_task_executors_release_shared(void);
+
 //===----------------------------------------------------------------------===//
 // Task system simple invocation utilities
 //===----------------------------------------------------------------------===//
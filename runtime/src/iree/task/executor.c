@@ -73,11 +73,13 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
   iree_task_executor_t* executor = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
       z0, iree_allocator_malloc(allocator, executor_size, (void**)&executor));
-  memset(executor, 0, executor_size);
+  // Worker local memory is zeroed by each worker on its own NUMA node.
+  memset(executor, 0, executor_base_size + worker_list_size);
   iree_atomic_ref_count_init(&executor->ref_count);
   executor->allocator = allocator;
   executor->scheduling_mode = options.scheduling_mode;
   executor->worker_spin_ns = options.worker_spin_ns;
+  executor->worker_local_memory_limit = options.worker_local_memory_limit;
   iree_atomic_task_slist_initialize(&executor->incoming_ready_slist);
   iree_slim_mutex_initialize(&executor->coordinator_mutex);
 
@@ -135,16 +137,15 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
     uint8_t* worker_local_memory =
         (uint8_t*)executor->workers + worker_list_size;
 
-    iree_task_affinity_set_t worker_idle_mask = 0;
-    iree_task_affinity_set_t worker_live_mask = 0;
+    iree_task_affinity_set_t worker_idle_mask =
+        iree_task_affinity_for_worker_range(0, worker_count);
+    iree_task_affinity_set_t worker_live_mask = worker_idle_mask;
     for (iree_host_size_t i = 0; i < worker_count; ++i) {
-      iree_task_affinity_set_t worker_bit = iree_task_affinity_for_worker(i);
-      worker_idle_mask |= worker_bit;
-      worker_live_mask |= worker_bit;
 
       iree_task_worker_t* worker = &executor->workers[i];
       status = iree_task_worker_initialize(
           executor, i, iree_task_topology_get_group(topology, i),
+          iree_task_topology_calculate_node_sharing_mask(topology, i),
           options.worker_stack_size,
           iree_make_byte_span(worker_local_memory,
                               options.worker_local_memory_size),
@@ -235,6 +236,10 @@ void iree_task_executor_trim(iree_task_executor_t* executor) {
   // on submit - or rework pools to not have this limitation.
   // iree_task_pool_trim(&executor->fence_task_pool);
   // iree_task_pool_trim(&executor->transient_task_pool);
+
+  // The event pool can be trimmed at any time as only available events are
+  // destroyed.
+  iree_event_pool_trim(executor->event_pool);
 }
 
 iree_host_size_t iree_task_executor_worker_count(
@@ -242,6 +247,21 @@ iree_host_size_t iree_task_executor_worker_count(
   return executor->worker_count;
 }
 
+void iree_task_executor_query_idle_statistics(
+    iree_task_executor_t* executor,
+    iree_task_executor_idle_statistics_t* out_statistics) {
+  memset(out_statistics, 0, sizeof(*out_statistics));
+  for (iree_host_size_t i = 0; i < executor->worker_count; ++i) {
+    iree_task_worker_t* worker = &executor->workers[i];
+    out_statistics->spin_wake_count += iree_atomic_load_int64(
+        &worker->spin_wake_count, iree_memory_order_relaxed);
+    out_statistics->park_count +=
+        iree_atomic_load_int64(&worker->park_count, iree_memory_order_relaxed);
+    out_statistics->spin_ns +=
+        iree_atomic_load_int64(&worker->spin_ns, iree_memory_order_relaxed);
+  }
+}
+
 iree_event_pool_t* iree_task_executor_event_pool(
     iree_task_executor_t* executor) {
   return executor->event_pool;
@@ -453,8 +473,7 @@ void iree_task_executor_coordinate(iree_task_executor_t* executor,
     // coordinator is random it's better to ensure that these bytes never incur
     // a cache miss by making them live here in the stack of the chosen thread.
     iree_task_post_batch_t* post_batch =
-        iree_alloca(sizeof(iree_task_post_batch_t) +
-                    executor->worker_count * sizeof(iree_task_list_t));
+        iree_alloca(iree_task_post_batch_size(executor->worker_count));
     iree_task_post_batch_initialize(executor, current_worker, post_batch);
 
     // Schedule all ready tasks in this batch. Some may complete inline (such
@@ -482,30 +501,27 @@ static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
     iree_task_executor_t* executor, iree_task_affinity_set_t victim_mask,
     uint32_t max_theft_attempts, int rotation_offset,
     iree_task_queue_t* local_task_queue) {
-  if (!victim_mask) return NULL;
+  if (iree_task_affinity_set_is_empty(victim_mask)) return NULL;
   max_theft_attempts = iree_min(max_theft_attempts,
                                 iree_task_affinity_set_count_ones(victim_mask));
-  victim_mask = iree_task_affinity_set_rotr(victim_mask, rotation_offset);
 
-  int worker_index = rotation_offset;
-  iree_task_affinity_set_t mask =
-      iree_task_affinity_set_rotr(victim_mask, worker_index);
+  // Walk the set bits in order starting at |rotation_offset| and wrapping
+  // around to the first worker. Each step skips directly to the next set bit
+  // (O(popcnt) * O(words)) instead of scanning every worker.
+  //
+  // Example: victim mask = 0b01010101
+  //          rotation_offset = 3 (randomly selected)
+  //          victims tried = 4, 6, 0, 2
+  iree_host_size_t worker_index = (iree_host_size_t)rotation_offset;
   for (uint32_t i = 0; i < max_theft_attempts; ++i) {
-    // Find the last set bit and skip to it. This avoids the need for doing
-    // a full O(n) scan and instead gets us at O(popcnt) * O(ctz).
-    //
-    // Example: sharing mask = 0b01010101
-    //          mask_rotation = 3 (randomly selected)
-    //          mask = 0b01010101 rotr 3 = 0b10101010
-    //          for (i = 0; i < 4; ++i)
-    //            offset = ctz(0b10101010) = 1
-    //            mask_rotation += 1 = 4
-    //            mask >>= 1 = 0b01010101
-    //            victim_index = 4 % 64 = 4
-    int offset = iree_task_affinity_set_count_trailing_zeros(mask);
-    int victim_index = (worker_index + offset) % executor->worker_count;
-    worker_index += offset + 1;
-    mask = iree_shr(mask, offset + 1);
+    int victim_index =
+        iree_task_affinity_set_find_next(victim_mask, worker_index);
+    if (victim_index < 0) {
+      victim_index = iree_task_affinity_set_find_first(victim_mask);
+    }
+    if (victim_index < 0) break;
+    iree_task_affinity_set_erase(&victim_mask, victim_index);
+    worker_index = victim_index + 1;
     iree_task_worker_t* victim_worker = &executor->workers[victim_index];
     if (iree_atomic_load_int32(&victim_worker->state,
                                iree_memory_order_acquire) !=
@@ -536,7 +552,11 @@ static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
 // We do a scan through ideal victims indicated by the
 // |constructive_sharing_mask|; these are the workers most likely to have some
 // cache benefits to taking their work as they share some level of the cache
-// hierarchy and should be better to steal from than any random worker.
+// hierarchy and should be better to steal from than any random worker. After
+// that we try the rest of the workers on the same NUMA node indicated by
+// |node_sharing_mask| and only cross to remote nodes if all local theft fails:
+// remote tasks likely touch memory on the remote node and pay the
+// interconnect latency for every access.
 //
 // To prevent biasing any particular victim we use a fast prng function to
 // select where in the set of potential victims defined by the topology
@@ -546,7 +566,8 @@ static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
 iree_task_t* iree_task_executor_try_steal_task(
     iree_task_executor_t* executor,
     iree_task_affinity_set_t constructive_sharing_mask,
-    uint32_t max_theft_attempts, iree_prng_minilcg128_state_t* theft_prng,
+    iree_task_affinity_set_t node_sharing_mask, uint32_t max_theft_attempts,
+    iree_prng_minilcg128_state_t* theft_prng,
     iree_task_queue_t* local_task_queue) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
@@ -559,31 +580,50 @@ iree_task_t* iree_task_executor_try_steal_task(
                                          iree_memory_order_relaxed);
   // Limit the workers we will steal from to the ones that are currently live
   // and not idle.
-  iree_task_affinity_set_t victim_mask = worker_live_mask & ~worker_idle_mask;
+  iree_task_affinity_set_t victim_mask =
+      iree_task_affinity_set_and_not(worker_live_mask, worker_idle_mask);
 
   // TODO(benvanik): it may be possible to rework this such that we better
   // use the prng; for example, instead of all this rotating stuff we could just
   // generate an 8-bit number (or even split it into two 4-bit numbers) per
   // theft attempt. The current rotation strategy is biased toward the same try
   // ordering vs. what we may really want with an unbiased random selection.
-  int rotation_offset = iree_prng_minilcg128_next_uint8(theft_prng) &
-                        (8 * sizeof(iree_task_affinity_set_t) - 1);
+  int rotation_offset =
+      (int)(iree_prng_minilcg128_next_uint8(theft_prng) %
+            executor->worker_count);
 
   // Try first with the workers we may have some caches shared with. This
   // helps to prevent cache invalidations/availability updates as it's likely
   // that we won't need to go back to main memory (or higher cache tiers) in the
   // event that the thief and victim are running close to each other in time.
   iree_task_t* task = iree_task_executor_try_steal_task_from_affinity_set(
-      executor, victim_mask & constructive_sharing_mask, max_theft_attempts,
-      rotation_offset, local_task_queue);
+      executor,
+      iree_task_affinity_set_and(victim_mask, constructive_sharing_mask),
+      max_theft_attempts, rotation_offset, local_task_queue);
   if (task) {
     IREE_TRACE_ZONE_APPEND_TEXT(z0, "local");
   } else {
     task = iree_task_executor_try_steal_task_from_affinity_set(
-        executor, victim_mask & ~constructive_sharing_mask, max_theft_attempts,
-        rotation_offset, local_task_queue);
+        executor,
+        iree_task_affinity_set_and(
+            iree_task_affinity_set_and_not(victim_mask,
+                                           constructive_sharing_mask),
+            node_sharing_mask),
+        max_theft_attempts, rotation_offset, local_task_queue);
+    if (task) {
+      IREE_TRACE_ZONE_APPEND_TEXT(z0, "node-local");
+    }
+  }
+  if (!task) {
+    task = iree_task_executor_try_steal_task_from_affinity_set(
+        executor,
+        iree_task_affinity_set_and_not(
+            victim_mask,
+            iree_task_affinity_set_or(constructive_sharing_mask,
+                                      node_sharing_mask)),
+        max_theft_attempts, rotation_offset, local_task_queue);
     if (task) {
-      IREE_TRACE_ZONE_APPEND_TEXT(z0, "non-local");
+      IREE_TRACE_ZONE_APPEND_TEXT(z0, "remote");
     }
   }
 
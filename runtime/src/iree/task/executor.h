@@ -64,6 +64,7 @@ extern "C" {
 //   - heterogenous microarchitectures in big.LITTLE/etc compute complexes
 //   - task isolation between multiple active requests or users
 //   - latency prioritization by partitioning workloads by priority
+//     (see iree_task_scope_set_priority_class)
 // - scheduling overhead tradeoffs by varying:
 //   - coordination/flush frequency to reduce cross-thread communication
 //   - by statically inserting dispatch shards to avoid dynamic fan-out
@@ -127,26 +128,29 @@ extern "C" {
 //      in LIFO order.
 //
 //   c. iree_task_post_batch_submit: per-worker tasks are pushed to their
-//      respective iree_task_worker_t mailbox_slist and the workers with new
-//      tasks are notified to wake up (if not already awake).
+//      respective iree_task_worker_t mailbox_slists (one per priority class of
+//      the task scopes) and the workers with new tasks are notified to wake up
+//      (if not already awake).
 //
 // 4. iree_task_worker_main_pump_once (LIFO mailbox -> FIFO thread-local list)
 //    When either woken or after completing all available thread-local work
-//    each worker will check its mailbox_slist to see if any tasks have been
+//    each worker will check its mailbox_slists to see if any tasks have been
 //    posted.
 //
-//    a. Tasks are flushed from the LIFO mailbox into the local_task_queue FIFO
-//       for the particular worker.
+//    a. Tasks are flushed from the LIFO mailboxes into the local_task_queue
+//       FIFO of the same priority class for the particular worker. High
+//       priority mailboxes are flushed before each task is executed.
 //
 //    b. If the mailbox is empty the worker *may* attempt to steal work from
 //       another nearby worker in the topology.
 //
-//    c. Any tasks in the local_task_queue are executed until empty.
-//       Tasks are retired and dependent tasks (via completion_task or barriers)
-//       are made ready and placed in the executor incoming_ready_slist as with
+//    c. Any tasks in the local_task_queue are executed until empty, highest
+//       priority class first (with starvation protection). Tasks are retired
+//       and dependent tasks (via completion_task or barriers) are made ready
+//       and placed in the executor incoming_ready_slist as with
 //       iree_task_executor_submit.
 //
-//    d. If no more thread-local work is available and the mailbox_slist is
+//    d. If no more thread-local work is available and the mailbox_slists are
 //       empty the worker will self-nominate for coordination and attempt to don
 //       the coordinator hat with iree_task_executor_coordinate. If new work
 //       becomes available after coordination step 5 repeats.
@@ -286,6 +290,11 @@ typedef struct iree_task_executor_options_t {
   // spinning is often extremely harmful to system health. Only set to non-zero
   // values when latency is the #1 priority (over thermals, system-wide
   // scheduling, and the environment).
+  //
+  // Spinning workers are not registered as waiters and work posted to them
+  // during the spin avoids the kernel wake entirely. Workers that exhaust the
+  // budget park in the kernel as usual. Use
+  // iree_task_executor_query_idle_statistics to tune the budget.
   iree_duration_t worker_spin_ns;
 
   // Minimum size in bytes of each worker thread stack.
@@ -302,6 +311,13 @@ typedef struct iree_task_executor_options_t {
   // for their invocations and no more. May be 0 if no worker local memory is
   // required.
   iree_host_size_t worker_local_memory_size;
+
+  // Maximum bytes each worker may grow its local memory to when executing a
+  // dispatch that requires more than worker_local_memory_size. Memory is grown
+  // by the worker thread itself so that the new pages are placed on the NUMA
+  // node of the worker and is retained for subsequent dispatches. Dispatches
+  // requiring more than the limit will fail. May be 0 to disable growth.
+  iree_host_size_t worker_local_memory_limit;
 } iree_task_executor_options_t;
 
 // Initializes |out_options| to default values.
@@ -335,6 +351,25 @@ void iree_task_executor_trim(iree_task_executor_t* executor);
 iree_host_size_t iree_task_executor_worker_count(
     iree_task_executor_t* executor);
 
+// Idle behavior aggregated across all workers of an executor.
+typedef struct iree_task_executor_idle_statistics_t {
+  // Number of times a spinning worker received new work and avoided parking.
+  int64_t spin_wake_count;
+  // Number of times a worker parked itself in the kernel to wait for work.
+  int64_t park_count;
+  // Total time workers spent spinning, including spins that ended in a park.
+  iree_duration_t spin_ns;
+} iree_task_executor_idle_statistics_t;
+
+// Queries the idle statistics accumulated since the executor was created.
+// Counters are updated by workers without synchronization and the result may
+// be slightly stale. A high park_count relative to spin_wake_count indicates
+// the worker_spin_ns budget is too short to cover the gaps between work while
+// high spin_ns with few spin wakes is wasted power.
+void iree_task_executor_query_idle_statistics(
+    iree_task_executor_t* executor,
+    iree_task_executor_idle_statistics_t* out_statistics);
+
 // Returns an iree_event_t pool managed by the executor.
 // Users of the task system should acquire their transient events from this.
 // Long-lived events should be allocated on their own in order to avoid
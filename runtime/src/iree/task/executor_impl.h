@@ -38,6 +38,9 @@ struct iree_task_executor_t {
   // IREE_DURATION_ZERO is used to disable spinning.
   iree_duration_t worker_spin_ns;
 
+  // Maximum size each worker may grow its local memory to on demand.
+  iree_host_size_t worker_local_memory_limit;
+
   // State used by the work-stealing operations performed by donated threads.
   // This is **NOT SYNCHRONIZED** and relies on the fact that we actually don't
   // much care about the precise selection of workers enough to mind any tears
@@ -151,12 +154,15 @@ void iree_task_executor_coordinate(iree_task_executor_t* executor,
                                    iree_task_worker_t* current_worker);
 
 // Tries to steal an entire task from a sibling worker (based on topology).
+// Workers sharing caches are tried first, then the other workers on the same
+// NUMA node and only then workers on remote nodes.
 // Returns a task that is available (has not yet begun processing at all).
 // May steal multiple tasks and add them to the |local_task_queue|.
 iree_task_t* iree_task_executor_try_steal_task(
     iree_task_executor_t* executor,
     iree_task_affinity_set_t constructive_sharing_mask,
-    uint32_t max_theft_attempts, iree_prng_minilcg128_state_t* theft_prng,
+    iree_task_affinity_set_t node_sharing_mask, uint32_t max_theft_attempts,
+    iree_prng_minilcg128_state_t* theft_prng,
     iree_task_queue_t* local_task_queue);
 
 #ifdef __cplusplus
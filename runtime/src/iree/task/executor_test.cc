@@ -6,7 +6,9 @@
 
 #include "iree/task/executor.h"
 
+#include <atomic>
 #include <cstddef>
+#include <cstring>
 
 #include "iree/testing/gtest.h"
 #include "iree/testing/status_matchers.h"
@@ -133,4 +135,208 @@ TEST(ExecutorTest, SubmissionStress) {
   iree_task_topology_deinitialize(&topology);
 }
 
+// Tests that the spin budget is honored and reported in the idle statistics.
+TEST(ExecutorTest, IdleStatistics) {
+  const iree_duration_t spin_budgets_ns[] = {IREE_DURATION_ZERO, 100 * 1000};
+  for (iree_duration_t spin_ns : spin_budgets_ns) {
+    iree_task_executor_options_t options;
+    iree_task_executor_options_initialize(&options);
+    options.worker_spin_ns = spin_ns;
+    iree_task_topology_t topology;
+    iree_task_topology_initialize_from_group_count(/*group_count=*/2,
+                                                   &topology);
+    iree_task_executor_t* executor = NULL;
+    IREE_ASSERT_OK(iree_task_executor_create(
+        options, &topology, iree_allocator_system(), &executor));
+    iree_task_scope_t scope;
+    iree_task_scope_initialize(iree_make_cstring_view("scope"), &scope);
+
+    for (int i = 0; i < 100; ++i) {
+      iree_task_call_t call;
+      iree_task_call_initialize(
+          &scope,
+          iree_task_make_call_closure(
+              [](void* user_context, iree_task_t* task,
+                 iree_task_submission_t* pending_submission) {
+                return iree_ok_status();
+              },
+              NULL),
+          &call);
+      iree_task_fence_t* fence = NULL;
+      IREE_ASSERT_OK(
+          iree_task_executor_acquire_fence(executor, &scope, &fence));
+      iree_task_set_completion_task(&call.header, &fence->header);
+      iree_task_submission_t submission;
+      iree_task_submission_initialize(&submission);
+      iree_task_submission_enqueue(&submission, &call.header);
+      iree_task_executor_submit(executor, &submission);
+      iree_task_executor_flush(executor);
+      IREE_ASSERT_OK(
+          iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+    }
+
+    // Give the workers time to exhaust their spin budget and park.
+    iree_wait_until(iree_time_now() + 10 * 1000000ll);
+
+    iree_task_executor_idle_statistics_t statistics;
+    iree_task_executor_query_idle_statistics(executor, &statistics);
+    EXPECT_GT(statistics.park_count, 0);
+    if (spin_ns == IREE_DURATION_ZERO) {
+      EXPECT_EQ(statistics.spin_wake_count, 0);
+      EXPECT_EQ(statistics.spin_ns, 0);
+    } else {
+      EXPECT_GE(statistics.spin_ns, spin_ns);
+    }
+
+    iree_task_scope_deinitialize(&scope);
+    iree_task_executor_release(executor);
+    iree_task_topology_deinitialize(&topology);
+  }
+}
+
+// Tests that a high priority task submitted while a long normal priority
+// dispatch is executing runs before the dispatch completes.
+TEST(ExecutorTest, DispatchYieldsToHighPriority) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/1, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_scope_t normal_scope;
+  iree_task_scope_initialize(iree_make_cstring_view("normal"), &normal_scope);
+  iree_task_scope_t high_scope;
+  iree_task_scope_initialize(iree_make_cstring_view("high"), &high_scope);
+  iree_task_scope_set_priority_class(&high_scope,
+                                     IREE_TASK_PRIORITY_CLASS_HIGH);
+
+  // Each tile spins briefly so that the dispatch is still executing when the
+  // high priority call arrives.
+  static std::atomic<uint32_t> executed_tile_count = {0};
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count[3] = {1024, 1, 1};
+  iree_task_dispatch_t dispatch;
+  iree_task_dispatch_initialize(
+      &normal_scope,
+      iree_task_make_dispatch_closure(
+          [](void* user_context, const iree_task_tile_context_t* tile_context,
+             iree_task_submission_t* pending_submission) {
+            iree_time_t deadline_ns = iree_time_now() + 50 * 1000;
+            while (iree_time_now() < deadline_ns) {
+            }
+            ++executed_tile_count;
+            return iree_ok_status();
+          },
+          NULL),
+      workgroup_size, workgroup_count, &dispatch);
+  iree_task_fence_t* normal_fence = NULL;
+  IREE_ASSERT_OK(
+      iree_task_executor_acquire_fence(executor, &normal_scope, &normal_fence));
+  iree_task_set_completion_task(&dispatch.header, &normal_fence->header);
+  iree_task_submission_t normal_submission;
+  iree_task_submission_initialize(&normal_submission);
+  iree_task_submission_enqueue(&normal_submission, &dispatch.header);
+  iree_task_executor_submit(executor, &normal_submission);
+  iree_task_executor_flush(executor);
+
+  // Wait for the dispatch to start before submitting the urgent work.
+  while (executed_tile_count == 0) {
+    iree_thread_yield();
+  }
+
+  static std::atomic<uint32_t> observed_tile_count = {0};
+  iree_task_call_t call;
+  iree_task_call_initialize(
+      &high_scope,
+      iree_task_make_call_closure(
+          [](void* user_context, iree_task_t* task,
+             iree_task_submission_t* pending_submission) {
+            observed_tile_count = executed_tile_count.load();
+            return iree_ok_status();
+          },
+          NULL),
+      &call);
+  iree_task_fence_t* high_fence = NULL;
+  IREE_ASSERT_OK(
+      iree_task_executor_acquire_fence(executor, &high_scope, &high_fence));
+  iree_task_set_completion_task(&call.header, &high_fence->header);
+  iree_task_submission_t high_submission;
+  iree_task_submission_initialize(&high_submission);
+  iree_task_submission_enqueue(&high_submission, &call.header);
+  iree_task_executor_submit(executor, &high_submission);
+  iree_task_executor_flush(executor);
+
+  IREE_ASSERT_OK(
+      iree_task_scope_wait_idle(&high_scope, IREE_TIME_INFINITE_FUTURE));
+  IREE_ASSERT_OK(
+      iree_task_scope_wait_idle(&normal_scope, IREE_TIME_INFINITE_FUTURE));
+  EXPECT_LT(observed_tile_count, 1024u);
+  EXPECT_EQ(executed_tile_count, 1024u);
+
+  iree_task_scope_deinitialize(&high_scope);
+  iree_task_scope_deinitialize(&normal_scope);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
+// Tests that workers grow their local memory for dispatches requiring more
+// than the executor reserved up front.
+TEST(ExecutorTest, LocalMemoryGrowth) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.worker_local_memory_size = 4 * 1024;
+  options.worker_local_memory_limit = 256 * 1024;
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/2, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"), &scope);
+
+  const iree_host_size_t local_memory_sizes[] = {1024, 64 * 1024, 256 * 1024};
+  for (iree_host_size_t local_memory_size : local_memory_sizes) {
+    static std::atomic<iree_host_size_t> min_tile_local_memory_size;
+    min_tile_local_memory_size = IREE_HOST_SIZE_MAX;
+    const uint32_t workgroup_size[3] = {1, 1, 1};
+    const uint32_t workgroup_count[3] = {64, 1, 1};
+    iree_task_dispatch_t dispatch;
+    iree_task_dispatch_initialize(
+        &scope,
+        iree_task_make_dispatch_closure(
+            [](void* user_context, const iree_task_tile_context_t* tile_context,
+               iree_task_submission_t* pending_submission) {
+              // Write all of the memory to catch undersized spans under ASAN.
+              memset(tile_context->local_memory.data, 0xCD,
+                     tile_context->local_memory.data_length);
+              iree_host_size_t size = tile_context->local_memory.data_length;
+              iree_host_size_t current = min_tile_local_memory_size.load();
+              while (size < current &&
+                     !min_tile_local_memory_size.compare_exchange_weak(current,
+                                                                       size)) {
+              }
+              return iree_ok_status();
+            },
+            NULL),
+        workgroup_size, workgroup_count, &dispatch);
+    dispatch.local_memory_size = (uint32_t)local_memory_size;
+    iree_task_fence_t* fence = NULL;
+    IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+    iree_task_set_completion_task(&dispatch.header, &fence->header);
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    iree_task_submission_enqueue(&submission, &dispatch.header);
+    iree_task_executor_submit(executor, &submission);
+    iree_task_executor_flush(executor);
+    IREE_ASSERT_OK(
+        iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+    EXPECT_EQ(min_tile_local_memory_size, local_memory_size);
+  }
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
 }  // namespace
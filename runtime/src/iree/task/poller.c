@@ -42,10 +42,11 @@ iree_status_t iree_task_poller_initialize(
       &out_poller->wake_event);
 
   // Wait set used to batch syscalls for polling/waiting on wait handles.
-  // This is currently limited to a relatively small max to make bad behavior
-  // clearer with nice RESOURCE_EXHAUSTED errors. If we start to hit that limit
-  // (~63+ simultaneous system waits) we'll need to shard out the wait sets -
-  // possibly with multiple wait threads (one per set).
+  // Handles are registered incrementally as waits are prepared and erased as
+  // they retire. On platforms with scalable wait sets (epoll) the capacity is
+  // only the initial reservation and the set grows to support thousands of
+  // outstanding waits; elsewhere hitting the limit (~63+ simultaneous system
+  // waits) results in RESOURCE_EXHAUSTED errors.
   if (iree_status_is_ok(status)) {
     status = iree_wait_set_allocate(IREE_TASK_EXECUTOR_MAX_OUTSTANDING_WAITS,
                                     executor->allocator, &out_poller->wait_set);
@@ -278,12 +279,19 @@ static iree_task_poller_prepare_result_t iree_task_poller_prepare_task(
       // before ever needing to export them for a full system wait. This query
       // can also avoid making a syscall to check the state of the source such
       // as when the source is a process-local type.
-      wait_status_code = IREE_STATUS_OK;
-      status = iree_wait_source_query(task->wait_source, &wait_status_code);
-
-      // TODO(benvanik): avoid this query for wait handles: we don't want to
-      // make one syscall per handle and could rely on the completed bit being
-      // set to retire these.
+      //
+      // Wait handles already registered with the wait set are not queried:
+      // that would be one syscall per handle per pump and instead the wait set
+      // reports them when signaled and iree_task_poller_wake_task sets the
+      // completed bit that retires them.
+      if (iree_all_bits_set(task->header.flags,
+                            IREE_TASK_FLAG_WAIT_EXPORTED) &&
+          iree_wait_handle_from_source(&task->wait_source)) {
+        wait_status_code = IREE_STATUS_DEFERRED;
+      } else {
+        wait_status_code = IREE_STATUS_OK;
+        status = iree_wait_source_query(task->wait_source, &wait_status_code);
+      }
     }
 
     // If the wait has not been resolved then we need to ensure there's an
@@ -408,19 +416,31 @@ static void iree_task_poller_prepare_wait(
 }
 
 // Finds tasks in |poller| using the given wait handle and marks them as
-// completed.
+// completed. They will be retired on the next scan without needing to query
+// their wait sources.
 static void iree_task_poller_wake_task(iree_task_poller_t* poller,
                                        iree_wait_handle_t wake_handle) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  // TODO(benvanik): scan the list. We need a way to map wake_handle back to
-  // the zero or more tasks that match it but don't currently store the
-  // handle. Ideally we'd have the wait set tell us precisely which things
-  // woke - possibly by having a bitmap of original insertions that match the
-  // handle - but for now we just eat the extra query syscall.
+  // Multiple tasks may be waiting on the same handle (the wait set tracks them
+  // as duplicates) so we mark all of them. This is a walk over the wait list
+  // in memory and avoids one query syscall per registered handle.
   int woken_tasks = 0;
+  for (iree_task_t* task = iree_task_list_front(&poller->wait_list);
+       task != NULL; task = task->next_task) {
+    if (!iree_all_bits_set(task->flags, IREE_TASK_FLAG_WAIT_EXPORTED)) {
+      continue;
+    }
+    iree_wait_handle_t* wait_handle =
+        iree_wait_handle_from_source(&((iree_task_wait_t*)task)->wait_source);
+    if (wait_handle && wait_handle->type == wake_handle.type &&
+        memcmp(&wait_handle->value, &wake_handle.value,
+               sizeof(wake_handle.value)) == 0) {
+      task->flags |= IREE_TASK_FLAG_WAIT_COMPLETED;
+      ++woken_tasks;
+    }
+  }
 
-  (void)woken_tasks;
   IREE_TRACE_ZONE_APPEND_VALUE(z0, woken_tasks);
   IREE_TRACE_ZONE_END(z0);
 }
@@ -39,10 +39,17 @@ typedef struct iree_task_post_batch_t {
   // Used to quickly scan the lists and perform the posts only when required.
   iree_task_affinity_set_t worker_pending_mask;
 
-  // A per-worker LIFO task list waiting to be posted.
+  // A per-worker and per-priority class LIFO task list waiting to be posted.
+  // Indexed by worker_index * IREE_TASK_PRIORITY_CLASS_COUNT + priority_class.
   iree_task_list_t worker_pending_lifos[0];
 } iree_task_post_batch_t;
 
+// Returns the total size in bytes of an iree_task_post_batch_t for
+// |worker_count| workers.
+#define iree_task_post_batch_size(worker_count) \
+  (sizeof(iree_task_post_batch_t) +             \
+   sizeof(iree_task_list_t) * IREE_TASK_PRIORITY_CLASS_COUNT * (worker_count))
+
 void iree_task_post_batch_initialize(iree_task_executor_t* executor,
                                      iree_task_worker_t* current_worker,
                                      iree_task_post_batch_t* out_post_batch);
@@ -55,9 +62,9 @@ iree_host_size_t iree_task_post_batch_worker_count(
 iree_host_size_t iree_task_post_batch_select_worker(
     iree_task_post_batch_t* post_batch, iree_task_affinity_set_t affinity_set);
 
-// Enqueues a task to the given worker. Note that the pending work lists for
-// each work is kept in LIFO order so that we can easily concatenate it with the
-// worker mailbox slist that's in LIFO order.
+// Enqueues a task to the given worker in the priority class of its scope. Note
+// that the pending work lists for each work is kept in LIFO order so that we
+// can easily concatenate it with the worker mailbox slist that's in LIFO order.
 void iree_task_post_batch_enqueue(iree_task_post_batch_t* post_batch,
                                   iree_host_size_t worker_index,
                                   iree_task_t* task);
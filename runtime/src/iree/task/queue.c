@@ -9,41 +9,82 @@
 #include <stddef.h>
 #include <string.h>
 
+#include "iree/task/tuning.h"
+
+// Pops the next task from the per-priority class |lists| of a queue and
+// updates its |priority_streak|. The queue lock must be held.
+static iree_task_t* iree_task_queue_select_next(iree_task_list_t* lists,
+                                                uint32_t* priority_streak) {
+  // Find the highest class with tasks and whether any lower class is waiting.
+  int highest_class = IREE_TASK_PRIORITY_CLASS_COUNT - 1;
+  while (highest_class >= 0 && iree_task_list_is_empty(&lists[highest_class])) {
+    --highest_class;
+  }
+  if (highest_class < 0) return NULL;
+  int waiting_class = highest_class - 1;
+  while (waiting_class >= 0 && iree_task_list_is_empty(&lists[waiting_class])) {
+    --waiting_class;
+  }
+  if (waiting_class < 0) {
+    // Nothing is being starved.
+    *priority_streak = 0;
+    return iree_task_list_pop_front(&lists[highest_class]);
+  }
+  if (*priority_streak >= IREE_TASK_WORKER_MAX_PRIORITY_STREAK) {
+    // Give the lower class a turn.
+    *priority_streak = 0;
+    return iree_task_list_pop_front(&lists[waiting_class]);
+  }
+  ++*priority_streak;
+  return iree_task_list_pop_front(&lists[highest_class]);
+}
+
 void iree_task_queue_initialize(iree_task_queue_t* out_queue) {
   memset(out_queue, 0, sizeof(*out_queue));
   iree_slim_mutex_initialize(&out_queue->mutex);
-  iree_task_list_initialize(&out_queue->list);
+  for (int i = 0; i < IREE_TASK_PRIORITY_CLASS_COUNT; ++i) {
+    iree_task_list_initialize(&out_queue->lists[i]);
+  }
 }
 
 void iree_task_queue_deinitialize(iree_task_queue_t* queue) {
-  iree_task_list_discard(&queue->list);
+  for (int i = 0; i < IREE_TASK_PRIORITY_CLASS_COUNT; ++i) {
+    iree_task_list_discard(&queue->lists[i]);
+  }
   iree_slim_mutex_deinitialize(&queue->mutex);
 }
 
 bool iree_task_queue_is_empty(iree_task_queue_t* queue) {
   iree_slim_mutex_lock(&queue->mutex);
-  bool is_empty = iree_task_list_is_empty(&queue->list);
+  bool is_empty = true;
+  for (int i = 0; i < IREE_TASK_PRIORITY_CLASS_COUNT && is_empty; ++i) {
+    is_empty = iree_task_list_is_empty(&queue->lists[i]);
+  }
   iree_slim_mutex_unlock(&queue->mutex);
   return is_empty;
 }
 
-void iree_task_queue_push_front(iree_task_queue_t* queue, iree_task_t* task) {
+void iree_task_queue_push_front(iree_task_queue_t* queue,
+                                iree_task_priority_class_t priority_class,
+                                iree_task_t* task) {
   iree_slim_mutex_lock(&queue->mutex);
-  iree_task_list_push_front(&queue->list, task);
+  iree_task_list_push_front(&queue->lists[priority_class], task);
   iree_slim_mutex_unlock(&queue->mutex);
 }
 
-void iree_task_queue_append_from_lifo_list_unsafe(iree_task_queue_t* queue,
-                                                  iree_task_list_t* list) {
+void iree_task_queue_append_from_lifo_list_unsafe(
+    iree_task_queue_t* queue, iree_task_priority_class_t priority_class,
+    iree_task_list_t* list) {
   // NOTE: reversing the list outside of the lock.
   iree_task_list_reverse(list);
   iree_slim_mutex_lock(&queue->mutex);
-  iree_task_list_append(&queue->list, list);
+  iree_task_list_append(&queue->lists[priority_class], list);
   iree_slim_mutex_unlock(&queue->mutex);
 }
 
 iree_task_t* iree_task_queue_flush_from_lifo_slist(
-    iree_task_queue_t* queue, iree_atomic_task_slist_t* source_slist) {
+    iree_task_queue_t* queue, iree_task_priority_class_t priority_class,
+    iree_atomic_task_slist_t* source_slist) {
   // Perform the flush and swap outside of the lock; acquiring the list is
   // atomic and then we own it exclusively.
   iree_task_list_t suffix;
@@ -54,8 +95,9 @@ iree_task_t* iree_task_queue_flush_from_lifo_slist(
 
   // Append the tasks and pop off the front for return.
   iree_slim_mutex_lock(&queue->mutex);
-  if (did_flush) iree_task_list_append(&queue->list, &suffix);
-  iree_task_t* next_task = iree_task_list_pop_front(&queue->list);
+  if (did_flush) iree_task_list_append(&queue->lists[priority_class], &suffix);
+  iree_task_t* next_task =
+      iree_task_queue_select_next(queue->lists, &queue->priority_streak);
   iree_slim_mutex_unlock(&queue->mutex);
 
   return next_task;
@@ -63,7 +105,8 @@ iree_task_t* iree_task_queue_flush_from_lifo_slist(
 
 iree_task_t* iree_task_queue_pop_front(iree_task_queue_t* queue) {
   iree_slim_mutex_lock(&queue->mutex);
-  iree_task_t* next_task = iree_task_list_pop_front(&queue->list);
+  iree_task_t* next_task =
+      iree_task_queue_select_next(queue->lists, &queue->priority_streak);
   iree_slim_mutex_unlock(&queue->mutex);
   return next_task;
 }
@@ -71,11 +114,20 @@ iree_task_t* iree_task_queue_pop_front(iree_task_queue_t* queue) {
 iree_task_t* iree_task_queue_try_steal(iree_task_queue_t* source_queue,
                                        iree_task_queue_t* target_queue,
                                        iree_host_size_t max_tasks) {
-  // First attempt to steal up to max_tasks from the source queue.
+  // First attempt to steal up to max_tasks from the highest priority class
+  // list in the source queue that has any.
   iree_task_list_t stolen_tasks;
   iree_task_list_initialize(&stolen_tasks);
+  int stolen_class = IREE_TASK_PRIORITY_CLASS_COUNT - 1;
   if (iree_slim_mutex_try_lock(&source_queue->mutex)) {
-    iree_task_list_split(&source_queue->list, max_tasks, &stolen_tasks);
+    while (stolen_class >= 0 &&
+           iree_task_list_is_empty(&source_queue->lists[stolen_class])) {
+      --stolen_class;
+    }
+    if (stolen_class >= 0) {
+      iree_task_list_split(&source_queue->lists[stolen_class], max_tasks,
+                           &stolen_tasks);
+    }
     iree_slim_mutex_unlock(&source_queue->mutex);
   }
 
@@ -83,8 +135,9 @@ iree_task_t* iree_task_queue_try_steal(iree_task_queue_t* source_queue,
   iree_task_t* next_task = NULL;
   if (!iree_task_list_is_empty(&stolen_tasks)) {
     iree_slim_mutex_lock(&target_queue->mutex);
-    iree_task_list_append(&target_queue->list, &stolen_tasks);
-    next_task = iree_task_list_pop_front(&target_queue->list);
+    iree_task_list_append(&target_queue->lists[stolen_class], &stolen_tasks);
+    next_task = iree_task_queue_select_next(target_queue->lists,
+                                            &target_queue->priority_streak);
     iree_slim_mutex_unlock(&target_queue->mutex);
   }
   return next_task;
@@ -96,6 +96,14 @@ extern "C" {
 // implementation compatible with classic atomic work-stealing queues. I'm
 // hopeful this will not need to be revisted for awhile, though!
 //
+// Tasks are kept in one FIFO per priority class (see
+// iree_task_priority_class_t). Pops always come from the highest class with
+// tasks available unless IREE_TASK_WORKER_MAX_PRIORITY_STREAK consecutive
+// tasks have been popped from higher classes while lower ones were waiting, in
+// which case one task from the highest waiting lower class is popped to
+// prevent starvation. Thieves also prefer higher classes so that idle workers
+// help with latency-sensitive work first.
+//
 // Future improvement idea: have the owner of the queue maintain a theft point
 // skip list that makes it possible for thieves to quickly come in and slice
 // off batches of tasks at the tail of the queue. Since we are a singly-linked
@@ -106,8 +114,12 @@ typedef struct iree_task_queue_t {
   // Must be held when manipulating the queue. >90% accesses are by the owner.
   iree_slim_mutex_t mutex;
 
-  // FIFO task list.
-  iree_task_list_t list IREE_GUARDED_BY(mutex);
+  // FIFO task lists indexed by iree_task_priority_class_t.
+  iree_task_list_t lists[IREE_TASK_PRIORITY_CLASS_COUNT] IREE_GUARDED_BY(mutex);
+
+  // Number of consecutive tasks popped from a higher priority class list while
+  // lower priority class lists had tasks waiting.
+  uint32_t priority_streak IREE_GUARDED_BY(mutex);
 } iree_task_queue_t;
 
 // Initializes a work-stealing task queue in-place.
@@ -121,37 +133,45 @@ void iree_task_queue_deinitialize(iree_task_queue_t* queue);
 // Note that due to races this may return both false-positives and -negatives.
 bool iree_task_queue_is_empty(iree_task_queue_t* queue);
 
-// Pushes a task to the front of the queue.
+// Pushes a task to the front of the |priority_class| list of the queue.
 // Always prefer the multi-push variants (prepend/append) when adding more than
 // one task to the queue. This is mostly useful for exceptional cases such as
 // when a task may yield and need to be reprocessed after the worker resumes.
 //
 // Must only be called from the owning worker's thread.
-void iree_task_queue_push_front(iree_task_queue_t* queue, iree_task_t* task);
+void iree_task_queue_push_front(iree_task_queue_t* queue,
+                                iree_task_priority_class_t priority_class,
+                                iree_task_t* task);
 
-// Appends a LIFO |list| of tasks to the queue.
+// Appends a LIFO |list| of tasks to the |priority_class| list of the queue.
 //
 // Must only be called from the owning worker's thread.
-void iree_task_queue_append_from_lifo_list_unsafe(iree_task_queue_t* queue,
-                                                  iree_task_list_t* list);
-
-// Flushes the |source_slist| LIFO mailbox into the task queue in FIFO order.
-// Returns the first task in the queue upon success; the task may be
-// pre-existing or from the newly flushed tasks.
+void iree_task_queue_append_from_lifo_list_unsafe(
+    iree_task_queue_t* queue, iree_task_priority_class_t priority_class,
+    iree_task_list_t* list);
+
+// Flushes the |source_slist| LIFO mailbox into the |priority_class| list of the
+// task queue in FIFO order. Returns the next task in the queue upon success;
+// the task may be pre-existing or from the newly flushed tasks and may be from
+// any priority class.
 //
 // Must only be called from the owning worker's thread.
 iree_task_t* iree_task_queue_flush_from_lifo_slist(
-    iree_task_queue_t* queue, iree_atomic_task_slist_t* source_slist);
+    iree_task_queue_t* queue, iree_task_priority_class_t priority_class,
+    iree_atomic_task_slist_t* source_slist);
 
-// Pops a task from the front of the queue if any are available.
+// Pops the next task from the queue if any are available.
+// The task is taken from the front of the highest priority class list with
+// tasks available unless doing so would starve lower priority classes.
 //
 // Must only be called from the owning worker's thread.
 iree_task_t* iree_task_queue_pop_front(iree_task_queue_t* queue);
 
 // Tries to steal up to |max_tasks| from the back of the queue.
 // Returns NULL if no tasks are available and otherwise up to |max_tasks| tasks
-// that were at the tail of the |source_queue| will be moved to the
-// |target_queue| and the first of the stolen tasks is returned.
+// that were at the tail of the highest priority class list with tasks in the
+// |source_queue| will be moved to the same class list in the |target_queue| and
+// the next task in the |target_queue| is returned.
 //
 // It's expected this is not called from the queue's owning worker, though it's
 // valid to do so.
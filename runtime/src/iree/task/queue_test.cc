@@ -6,6 +6,7 @@
 
 #include "iree/task/queue.h"
 
+#include "iree/task/tuning.h"
 #include "iree/testing/gtest.h"
 
 namespace {
@@ -32,12 +33,14 @@ TEST(QueueTest, PushPop) {
   EXPECT_FALSE(iree_task_queue_pop_front(&queue));
 
   iree_task_t task_a = {0};
-  iree_task_queue_push_front(&queue, &task_a);
+  iree_task_queue_push_front(&queue, IREE_TASK_PRIORITY_CLASS_NORMAL,
+                             &task_a);
 
   EXPECT_FALSE(iree_task_queue_is_empty(&queue));
 
   iree_task_t task_b = {0};
-  iree_task_queue_push_front(&queue, &task_b);
+  iree_task_queue_push_front(&queue, IREE_TASK_PRIORITY_CLASS_NORMAL,
+                             &task_b);
 
   EXPECT_FALSE(iree_task_queue_is_empty(&queue));
   EXPECT_EQ(&task_b, iree_task_queue_pop_front(&queue));
@@ -58,7 +61,8 @@ TEST(QueueTest, AppendListEmpty) {
   iree_task_list_t list = {0};
 
   EXPECT_TRUE(iree_task_queue_is_empty(&queue));
-  iree_task_queue_append_from_lifo_list_unsafe(&queue, &list);
+  iree_task_queue_append_from_lifo_list_unsafe(
+      &queue, IREE_TASK_PRIORITY_CLASS_NORMAL, &list);
   EXPECT_TRUE(iree_task_queue_is_empty(&queue));
   EXPECT_TRUE(iree_task_list_is_empty(&list));
 
@@ -74,7 +78,8 @@ TEST(QueueTest, AppendList1) {
   iree_task_list_push_front(&list, &task_a);
 
   EXPECT_TRUE(iree_task_queue_is_empty(&queue));
-  iree_task_queue_append_from_lifo_list_unsafe(&queue, &list);
+  iree_task_queue_append_from_lifo_list_unsafe(
+      &queue, IREE_TASK_PRIORITY_CLASS_NORMAL, &list);
   EXPECT_FALSE(iree_task_queue_is_empty(&queue));
   EXPECT_TRUE(iree_task_list_is_empty(&list));
 
@@ -97,7 +102,8 @@ TEST(QueueTest, AppendListOrdered) {
 
   // Append the list to the queue; it should swap LIFO->FIFO.
   EXPECT_TRUE(iree_task_queue_is_empty(&queue));
-  iree_task_queue_append_from_lifo_list_unsafe(&queue, &list);
+  iree_task_queue_append_from_lifo_list_unsafe(
+      &queue, IREE_TASK_PRIORITY_CLASS_NORMAL, &list);
   EXPECT_FALSE(iree_task_queue_is_empty(&queue));
   EXPECT_TRUE(iree_task_list_is_empty(&list));
 
@@ -117,7 +123,8 @@ TEST(QueueTest, FlushSlistEmpty) {
   iree_atomic_task_slist_initialize(&slist);
 
   EXPECT_TRUE(iree_task_queue_is_empty(&queue));
-  EXPECT_FALSE(iree_task_queue_flush_from_lifo_slist(&queue, &slist));
+  EXPECT_FALSE(iree_task_queue_flush_from_lifo_slist(
+      &queue, IREE_TASK_PRIORITY_CLASS_NORMAL, &slist));
   EXPECT_TRUE(iree_task_queue_is_empty(&queue));
 
   iree_atomic_task_slist_deinitialize(&slist);
@@ -135,7 +142,8 @@ TEST(QueueTest, FlushSlist1) {
   iree_atomic_task_slist_push(&slist, &task_a);
 
   EXPECT_TRUE(iree_task_queue_is_empty(&queue));
-  EXPECT_EQ(&task_a, iree_task_queue_flush_from_lifo_slist(&queue, &slist));
+  EXPECT_EQ(&task_a, iree_task_queue_flush_from_lifo_slist(
+                         &queue, IREE_TASK_PRIORITY_CLASS_NORMAL, &slist));
   EXPECT_TRUE(iree_task_queue_is_empty(&queue));
 
   iree_atomic_task_slist_deinitialize(&slist);
@@ -160,7 +168,8 @@ TEST(QueueTest, FlushSlistOrdered) {
   // Flush the list to the queue; it should swap LIFO->FIFO and return the
   // first task in the queue.
   EXPECT_TRUE(iree_task_queue_is_empty(&queue));
-  EXPECT_EQ(&task_a, iree_task_queue_flush_from_lifo_slist(&queue, &slist));
+  EXPECT_EQ(&task_a, iree_task_queue_flush_from_lifo_slist(
+                         &queue, IREE_TASK_PRIORITY_CLASS_NORMAL, &slist));
   EXPECT_FALSE(iree_task_queue_is_empty(&queue));
 
   // Pop list and ensure order: [a->]b->c.
@@ -180,11 +189,14 @@ TEST(QueueTest, TryStealEmpty) {
   iree_task_queue_initialize(&target_queue);
 
   iree_task_t task_a = {0};
-  iree_task_queue_push_front(&source_queue, &task_a);
+  iree_task_queue_push_front(&source_queue, IREE_TASK_PRIORITY_CLASS_NORMAL,
+                             &task_a);
   iree_task_t task_b = {0};
-  iree_task_queue_push_front(&source_queue, &task_b);
+  iree_task_queue_push_front(&source_queue, IREE_TASK_PRIORITY_CLASS_NORMAL,
+                             &task_b);
   iree_task_t task_c = {0};
-  iree_task_queue_push_front(&source_queue, &task_c);
+  iree_task_queue_push_front(&source_queue, IREE_TASK_PRIORITY_CLASS_NORMAL,
+                             &task_c);
 
   EXPECT_EQ(&task_a,
             iree_task_queue_try_steal(&source_queue, &target_queue, 1));
@@ -200,7 +212,8 @@ TEST(QueueTest, TryStealLast) {
   iree_task_queue_initialize(&target_queue);
 
   iree_task_t task_a = {0};
-  iree_task_queue_push_front(&source_queue, &task_a);
+  iree_task_queue_push_front(&source_queue, IREE_TASK_PRIORITY_CLASS_NORMAL,
+                             &task_a);
 
   EXPECT_EQ(&task_a,
             iree_task_queue_try_steal(&source_queue, &target_queue, 100));
@@ -220,9 +233,12 @@ TEST(QueueTest, TrySteal1) {
   iree_task_t task_a = {0};
   iree_task_t task_b = {0};
   iree_task_t task_c = {0};
-  iree_task_queue_push_front(&source_queue, &task_c);
-  iree_task_queue_push_front(&source_queue, &task_b);
-  iree_task_queue_push_front(&source_queue, &task_a);
+  iree_task_queue_push_front(&source_queue, IREE_TASK_PRIORITY_CLASS_NORMAL,
+                             &task_c);
+  iree_task_queue_push_front(&source_queue, IREE_TASK_PRIORITY_CLASS_NORMAL,
+                             &task_b);
+  iree_task_queue_push_front(&source_queue, IREE_TASK_PRIORITY_CLASS_NORMAL,
+                             &task_a);
 
   EXPECT_EQ(&task_c,
             iree_task_queue_try_steal(&source_queue, &target_queue, 1));
@@ -244,11 +260,14 @@ TEST(QueueTest, TryStealIntoExisting) {
 
   iree_task_t task_a = {0};
   iree_task_t task_b = {0};
-  iree_task_queue_push_front(&source_queue, &task_b);
-  iree_task_queue_push_front(&source_queue, &task_a);
+  iree_task_queue_push_front(&source_queue, IREE_TASK_PRIORITY_CLASS_NORMAL,
+                             &task_b);
+  iree_task_queue_push_front(&source_queue, IREE_TASK_PRIORITY_CLASS_NORMAL,
+                             &task_a);
 
   iree_task_t task_existing = {0};
-  iree_task_queue_push_front(&target_queue, &task_existing);
+  iree_task_queue_push_front(&target_queue, IREE_TASK_PRIORITY_CLASS_NORMAL,
+                             &task_existing);
 
   EXPECT_EQ(&task_existing,
             iree_task_queue_try_steal(&source_queue, &target_queue, 1));
@@ -273,10 +292,14 @@ TEST(QueueTest, TryStealMany) {
   iree_task_t task_b = {0};
   iree_task_t task_c = {0};
   iree_task_t task_d = {0};
-  iree_task_queue_push_front(&source_queue, &task_d);
-  iree_task_queue_push_front(&source_queue, &task_c);
-  iree_task_queue_push_front(&source_queue, &task_b);
-  iree_task_queue_push_front(&source_queue, &task_a);
+  iree_task_queue_push_front(&source_queue, IREE_TASK_PRIORITY_CLASS_NORMAL,
+                             &task_d);
+  iree_task_queue_push_front(&source_queue, IREE_TASK_PRIORITY_CLASS_NORMAL,
+                             &task_c);
+  iree_task_queue_push_front(&source_queue, IREE_TASK_PRIORITY_CLASS_NORMAL,
+                             &task_b);
+  iree_task_queue_push_front(&source_queue, IREE_TASK_PRIORITY_CLASS_NORMAL,
+                             &task_a);
 
   EXPECT_EQ(&task_c,
             iree_task_queue_try_steal(&source_queue, &target_queue, 2));
@@ -301,10 +324,14 @@ TEST(QueueTest, TryStealAll) {
   iree_task_t task_b = {0};
   iree_task_t task_c = {0};
   iree_task_t task_d = {0};
-  iree_task_queue_push_front(&source_queue, &task_d);
-  iree_task_queue_push_front(&source_queue, &task_c);
-  iree_task_queue_push_front(&source_queue, &task_b);
-  iree_task_queue_push_front(&source_queue, &task_a);
+  iree_task_queue_push_front(&source_queue, IREE_TASK_PRIORITY_CLASS_NORMAL,
+                             &task_d);
+  iree_task_queue_push_front(&source_queue, IREE_TASK_PRIORITY_CLASS_NORMAL,
+                             &task_c);
+  iree_task_queue_push_front(&source_queue, IREE_TASK_PRIORITY_CLASS_NORMAL,
+                             &task_b);
+  iree_task_queue_push_front(&source_queue, IREE_TASK_PRIORITY_CLASS_NORMAL,
+                             &task_a);
 
   EXPECT_EQ(&task_c,
             iree_task_queue_try_steal(&source_queue, &target_queue, 1000));
@@ -319,4 +346,77 @@ TEST(QueueTest, TryStealAll) {
   iree_task_queue_deinitialize(&target_queue);
 }
 
+TEST(QueueTest, PopHighPriorityFirst) {
+  iree_task_queue_t queue;
+  iree_task_queue_initialize(&queue);
+
+  iree_task_t task_a = {0};
+  iree_task_queue_push_front(&queue, IREE_TASK_PRIORITY_CLASS_NORMAL,
+                             &task_a);
+  iree_task_t task_b = {0};
+  iree_task_queue_push_front(&queue, IREE_TASK_PRIORITY_CLASS_HIGH, &task_b);
+
+  // Even though the normal task was queued first the high priority task runs.
+  EXPECT_EQ(&task_b, iree_task_queue_pop_front(&queue));
+  EXPECT_EQ(&task_a, iree_task_queue_pop_front(&queue));
+  EXPECT_TRUE(iree_task_queue_is_empty(&queue));
+
+  iree_task_queue_deinitialize(&queue);
+}
+
+TEST(QueueTest, PopNormalPriorityNotStarved) {
+  iree_task_queue_t queue;
+  iree_task_queue_initialize(&queue);
+
+  iree_task_t task_normal = {0};
+  iree_task_queue_push_front(&queue, IREE_TASK_PRIORITY_CLASS_NORMAL,
+                             &task_normal);
+  iree_task_t high_tasks[IREE_TASK_WORKER_MAX_PRIORITY_STREAK + 1] = {{0}};
+  for (size_t i = 0; i < IREE_ARRAYSIZE(high_tasks); ++i) {
+    iree_task_queue_push_front(&queue, IREE_TASK_PRIORITY_CLASS_HIGH,
+                               &high_tasks[i]);
+  }
+
+  // After the maximum streak of high priority tasks the normal task must be
+  // scheduled before any more high priority tasks.
+  for (size_t i = 0; i < IREE_TASK_WORKER_MAX_PRIORITY_STREAK; ++i) {
+    iree_task_t* task = iree_task_queue_pop_front(&queue);
+    EXPECT_NE(&task_normal, task);
+  }
+  EXPECT_EQ(&task_normal, iree_task_queue_pop_front(&queue));
+  EXPECT_NE(nullptr, iree_task_queue_pop_front(&queue));
+  EXPECT_TRUE(iree_task_queue_is_empty(&queue));
+
+  iree_task_queue_deinitialize(&queue);
+}
+
+TEST(QueueTest, TryStealHighPriorityFirst) {
+  iree_task_queue_t source_queue;
+  iree_task_queue_initialize(&source_queue);
+  iree_task_queue_t target_queue;
+  iree_task_queue_initialize(&target_queue);
+
+  iree_task_t task_a = {0};
+  iree_task_t task_b = {0};
+  iree_task_t task_c = {0};
+  iree_task_queue_push_front(&source_queue, IREE_TASK_PRIORITY_CLASS_NORMAL,
+                             &task_a);
+  iree_task_queue_push_front(&source_queue, IREE_TASK_PRIORITY_CLASS_HIGH,
+                             &task_c);
+  iree_task_queue_push_front(&source_queue, IREE_TASK_PRIORITY_CLASS_HIGH,
+                             &task_b);
+
+  // Only the high priority tasks are considered by the thief.
+  EXPECT_EQ(&task_c,
+            iree_task_queue_try_steal(&source_queue, &target_queue, 1000));
+  EXPECT_TRUE(iree_task_queue_is_empty(&target_queue));
+
+  EXPECT_EQ(&task_b, iree_task_queue_pop_front(&source_queue));
+  EXPECT_EQ(&task_a, iree_task_queue_pop_front(&source_queue));
+  EXPECT_TRUE(iree_task_queue_is_empty(&source_queue));
+
+  iree_task_queue_deinitialize(&source_queue);
+  iree_task_queue_deinitialize(&target_queue);
+}
+
 }  // namespace
@@ -63,6 +63,15 @@ iree_string_view_t iree_task_scope_name(iree_task_scope_t* scope) {
   return iree_make_cstring_view(scope->name);
 }
 
+void iree_task_scope_set_priority_class(
+    iree_task_scope_t* scope, iree_task_priority_class_t priority_class) {
+  IREE_ASSERT(priority_class < IREE_TASK_PRIORITY_CLASS_COUNT,
+              "priority class out of range");
+  IREE_ASSERT(iree_task_scope_is_idle(scope),
+              "priority class must only be changed while idle");
+  scope->priority_class = priority_class;
+}
+
 iree_task_dispatch_statistics_t iree_task_scope_consume_statistics(
     iree_task_scope_t* scope) {
   iree_task_dispatch_statistics_t result = scope->dispatch_statistics;
@@ -170,3 +179,46 @@ iree_status_t iree_task_scope_wait_idle(iree_task_scope_t* scope,
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
+
+static iree_status_t iree_task_scope_wait_source_ctl(
+    iree_wait_source_t wait_source, iree_wait_source_command_t command,
+    const void* params, void** inout_ptr) {
+  iree_task_scope_t* scope = (iree_task_scope_t*)wait_source.self;
+  switch (command) {
+    case IREE_WAIT_SOURCE_COMMAND_QUERY: {
+      iree_status_code_t* out_wait_status_code = (iree_status_code_t*)inout_ptr;
+      *out_wait_status_code = iree_task_scope_is_idle(scope)
+                                  ? IREE_STATUS_OK
+                                  : IREE_STATUS_DEFERRED;
+      return iree_ok_status();
+    }
+    case IREE_WAIT_SOURCE_COMMAND_WAIT_ONE: {
+      const iree_timeout_t timeout =
+          ((const iree_wait_source_wait_params_t*)params)->timeout;
+      return iree_task_scope_wait_idle(scope,
+                                       iree_timeout_as_deadline_ns(timeout));
+    }
+    case IREE_WAIT_SOURCE_COMMAND_EXPORT: {
+      const iree_wait_primitive_type_t target_type =
+          ((const iree_wait_source_export_params_t*)params)->target_type;
+      iree_wait_primitive_t* out_wait_primitive =
+          (iree_wait_primitive_t*)inout_ptr;
+      memset(out_wait_primitive, 0, sizeof(*out_wait_primitive));
+      return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                              "requested wait primitive type %d is unavailable",
+                              (int)target_type);
+    }
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unimplemented wait_source command");
+  }
+}
+
+iree_wait_source_t iree_task_scope_await_idle(iree_task_scope_t* scope) {
+  IREE_ASSERT_ARGUMENT(scope);
+  return (iree_wait_source_t){
+      .self = scope,
+      .data = 0,
+      .ctl = iree_task_scope_wait_source_ctl,
+  };
+}
@@ -38,6 +38,10 @@ extern "C" {
 // the scope that allows for an efficient roll-up of activity over specific
 // durations.
 //
+// Scopes also carry the priority class of their tasks. Producers with mixed
+// workloads (interactive requests and background batch jobs, for example) can
+// use one scope per class to have workers prefer the latency-sensitive tasks.
+//
 // Task producers can decide whether to create new scopes for each batch of
 // tasks they submit or reuse scopes for the lifetime of their subprocess. Scope
 // overhead is low and the only advantage of reusing them is that lifetime can
@@ -49,6 +53,9 @@ typedef struct iree_task_scope_t {
   // Name used for logging and tracing.
   char name[16];
 
+  // Priority class of all tasks within the scope.
+  iree_task_priority_class_t priority_class;
+
   // Base color used for tasks in this scope.
   // The color will be modulated based on task type.
   IREE_TRACE(uint32_t task_trace_color;)
@@ -89,6 +96,19 @@ void iree_task_scope_deinitialize(iree_task_scope_t* scope);
 // string.
 iree_string_view_t iree_task_scope_name(iree_task_scope_t* scope);
 
+// Sets the priority class of all tasks within the scope. Scopes default to
+// IREE_TASK_PRIORITY_CLASS_NORMAL.
+// Must only be called while the scope is idle as in-flight tasks would be
+// scheduled inconsistently.
+void iree_task_scope_set_priority_class(
+    iree_task_scope_t* scope, iree_task_priority_class_t priority_class);
+
+// Returns the priority class of all tasks within the scope.
+static inline iree_task_priority_class_t iree_task_scope_priority_class(
+    const iree_task_scope_t* scope) {
+  return scope->priority_class;
+}
+
 // Returns and resets the statistics for the scope.
 // Statistics may experience tearing (non-atomic update across fields) if this
 // is performed while tasks are in-flight.
@@ -156,6 +176,12 @@ bool iree_task_scope_is_idle(iree_task_scope_t* scope);
 iree_status_t iree_task_scope_wait_idle(iree_task_scope_t* scope,
                                         iree_time_t deadline_ns);
 
+// Returns a wait source that resolves when |scope| becomes idle.
+// This allows scopes to be used with APIs taking wait sources such as
+// iree_task_executor_donate_caller. The scope must remain live for as long as
+// the wait source may be used.
+iree_wait_source_t iree_task_scope_await_idle(iree_task_scope_t* scope);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -12,6 +12,7 @@
 #include "iree/task/submission.h"
 #include "iree/task/task_impl.h"
 #include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
 
 namespace {
 
@@ -197,6 +198,39 @@ TEST(ScopeTest, WaitIdleSuccess) {
   iree_task_scope_deinitialize(&scope);
 }
 
+TEST(ScopeTest, AwaitIdleWaitSource) {
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope_a"), &scope);
+  iree_wait_source_t wait_source = iree_task_scope_await_idle(&scope);
+
+  // Idle scopes resolve immediately.
+  iree_status_code_t wait_status_code = IREE_STATUS_DEFERRED;
+  IREE_ASSERT_OK(iree_wait_source_query(wait_source, &wait_status_code));
+  EXPECT_EQ(IREE_STATUS_OK, wait_status_code);
+
+  // Enqueue a task to the scope so it is no longer idle.
+  iree_task_fence_t fence_task;
+  iree_task_fence_initialize(&scope, iree_wait_primitive_immediate(),
+                             &fence_task);
+  IREE_ASSERT_OK(iree_wait_source_query(wait_source, &wait_status_code));
+  EXPECT_EQ(IREE_STATUS_DEFERRED, wait_status_code);
+  iree_status_t wait_status =
+      iree_wait_source_wait_one(wait_source, iree_immediate_timeout());
+  EXPECT_TRUE(iree_status_is_deadline_exceeded(wait_status));
+  iree_status_ignore(wait_status);
+
+  // Complete the task and ensure the wait source resolves.
+  iree_task_submission_t pending_submission;
+  iree_task_submission_initialize(&pending_submission);
+  iree_task_fence_retire(&fence_task, &pending_submission);
+  IREE_ASSERT_OK(
+      iree_wait_source_wait_one(wait_source, iree_infinite_timeout()));
+  IREE_ASSERT_OK(iree_wait_source_query(wait_source, &wait_status_code));
+  EXPECT_EQ(IREE_STATUS_OK, wait_status_code);
+
+  iree_task_scope_deinitialize(&scope);
+}
+
 TEST(ScopeTest, WaitIdleFailure) {
   iree_task_scope_t scope;
   iree_task_scope_initialize(iree_make_cstring_view("scope_a"), &scope);
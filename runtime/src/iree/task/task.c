@@ -9,6 +9,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "iree/base/internal/flight_recorder.h"
 #include "iree/base/tracing.h"
 #include "iree/task/list.h"
 #include "iree/task/pool.h"
@@ -519,6 +520,57 @@ void iree_task_dispatch_statistics_merge(
   // TODO(benvanik): statistics.
 }
 
+//==============================================================================
+// Dispatch tile cost feedback
+//==============================================================================
+
+// An entry of the process-wide table of measured per-tile costs.
+// Entries are updated with relaxed atomics: a torn key/cost pair only yields
+// a poor reservation size for one dispatch and is corrected when it retires.
+typedef struct iree_task_dispatch_cost_entry_t {
+  iree_atomic_int64_t key;
+  iree_atomic_int64_t tile_ns;
+} iree_task_dispatch_cost_entry_t;
+
+static iree_task_dispatch_cost_entry_t
+    iree_task_dispatch_cost_cache[IREE_TASK_DISPATCH_COST_CACHE_CAPACITY];
+
+static iree_task_dispatch_cost_entry_t* iree_task_dispatch_cost_entry(
+    uint64_t cost_key) {
+  uint64_t hash = (cost_key ^ (cost_key >> 29)) * 0x9E3779B97F4A7C15ull;
+  uint64_t slot = (hash >> 32) & (IREE_TASK_DISPATCH_COST_CACHE_CAPACITY - 1);
+  return &iree_task_dispatch_cost_cache[slot];
+}
+
+iree_time_t iree_task_dispatch_query_tile_cost(uint64_t cost_key) {
+  if (!cost_key) return 0;
+  iree_task_dispatch_cost_entry_t* entry =
+      iree_task_dispatch_cost_entry(cost_key);
+  if ((uint64_t)iree_atomic_load_int64(&entry->key,
+                                       iree_memory_order_relaxed) != cost_key) {
+    return 0;
+  }
+  return iree_atomic_load_int64(&entry->tile_ns, iree_memory_order_relaxed);
+}
+
+// Folds |tile_ns| measured for a dispatch with |cost_key| into its history
+// with an exponential moving average so that one slow run (page faults,
+// preemption) doesn't swing the next reservation size.
+static void iree_task_dispatch_record_tile_cost(uint64_t cost_key,
+                                                iree_time_t tile_ns) {
+  iree_task_dispatch_cost_entry_t* entry =
+      iree_task_dispatch_cost_entry(cost_key);
+  iree_time_t previous_ns = iree_task_dispatch_query_tile_cost(cost_key);
+  if (previous_ns > 0) {
+    tile_ns = (previous_ns * 3 + tile_ns) / 4;
+  } else {
+    iree_atomic_store_int64(&entry->key, (int64_t)cost_key,
+                            iree_memory_order_relaxed);
+  }
+  iree_atomic_store_int64(&entry->tile_ns, iree_max(tile_ns, 1),
+                          iree_memory_order_relaxed);
+}
+
 //==============================================================================
 // IREE_TASK_TYPE_DISPATCH
 //==============================================================================
@@ -533,6 +585,7 @@ static void iree_task_dispatch_initialize_base(
   out_task->local_memory_size = 0;
   iree_atomic_store_intptr(&out_task->status, 0, iree_memory_order_release);
   memset(&out_task->statistics, 0, sizeof(out_task->statistics));
+  out_task->cost_key = 0;
 
   IREE_TRACE({
     static iree_atomic_int64_t next_dispatch_id = IREE_ATOMIC_VAR_INIT(0);
@@ -560,6 +613,51 @@ void iree_task_dispatch_initialize_indirect(
   out_task->workgroup_count.ptr = workgroup_count_ptr;
 }
 
+// Sets the tiles_per_reservation of |dispatch_task| and returns the number of
+// shards to execute it with on |worker_count| workers.
+static iree_host_size_t iree_task_dispatch_select_sharding(
+    iree_task_dispatch_t* dispatch_task, iree_host_size_t worker_count) {
+  const uint32_t tile_count = dispatch_task->tile_count;
+#if IREE_TASK_DISPATCH_ADAPTIVE_SHARDING
+  const iree_time_t tile_ns =
+      iree_task_dispatch_query_tile_cost(dispatch_task->cost_key);
+  if (tile_ns > 0) {
+    // Reserve enough tiles to amortize the shared counter but no more than an
+    // even split so that all shards get work.
+    uint64_t tiles_per_reservation = iree_min(
+        (uint64_t)(IREE_TASK_DISPATCH_TARGET_RESERVATION_NS / tile_ns),
+        (uint64_t)(tile_count / worker_count));
+    tiles_per_reservation = iree_max(
+        1, iree_min(tiles_per_reservation,
+                    IREE_TASK_DISPATCH_MAX_ADAPTIVE_TILES_PER_RESERVATION));
+    dispatch_task->tiles_per_reservation = (uint32_t)tiles_per_reservation;
+    // Only wake as many shards as there is work worth splitting.
+    const uint64_t reservation_count =
+        (tile_count + tiles_per_reservation - 1) / tiles_per_reservation;
+    const uint64_t useful_shard_count = iree_max(
+        1, (uint64_t)tile_ns * tile_count / IREE_TASK_DISPATCH_MIN_SHARD_NS);
+    return (iree_host_size_t)iree_min(
+        iree_min(reservation_count, useful_shard_count), worker_count);
+  }
+#endif  // IREE_TASK_DISPATCH_ADAPTIVE_SHARDING
+
+  // A higher number reduces overhead and improves locality while a lower
+  // number reduces maximum worst-case latency (coarser work stealing).
+  // Grids with fewer than the maximum tiles per worker are sliced up
+  // proportionally so that every worker gets some while wide executors don't
+  // all contend on single-tile reservations.
+  dispatch_task->tiles_per_reservation = (uint32_t)iree_max(
+      1, iree_min(tile_count / worker_count,
+                  IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION));
+
+  // Almost always worker_count unless we are a small dispatch (1x1x1, etc)
+  // with fewer reservations than workers.
+  iree_host_size_t reservation_count =
+      (tile_count + dispatch_task->tiles_per_reservation - 1) /
+      dispatch_task->tiles_per_reservation;
+  return iree_min(reservation_count, worker_count);
+}
+
 void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
                               iree_task_pool_t* shard_task_pool,
                               iree_task_submission_t* pending_submission,
@@ -602,24 +700,19 @@ void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
                           iree_memory_order_relaxed);
   dispatch_task->tile_count =
       workgroup_count[0] * workgroup_count[1] * workgroup_count[2];
+  iree_flight_recorder_record(IREE_FLIGHT_RECORDER_EVENT_DISPATCH_BEGIN,
+                              (uint64_t)(uintptr_t)dispatch_task,
+                              dispatch_task->tile_count);
 
-  // Compute shard count - almost always worker_count unless we are a very small
-  // dispatch (1x1x1, etc).
+  // Compute how many tiles we want each shard to reserve at a time from the
+  // larger grid and how many shards to spread them over.
   iree_host_size_t worker_count = iree_task_post_batch_worker_count(post_batch);
   iree_host_size_t shard_count =
-      iree_min(dispatch_task->tile_count, worker_count);
-
-  // Compute how many tiles we want each shard to reserve at a time from the
-  // larger grid. A higher number reduces overhead and improves locality while
-  // a lower number reduces maximum worst-case latency (coarser work stealing).
-  if (dispatch_task->tile_count <
-      worker_count * IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION) {
-    // Grid is small - allow it to be eagerly sliced up.
-    dispatch_task->tiles_per_reservation = 1;
-  } else {
-    dispatch_task->tiles_per_reservation =
-        IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION;
-  }
+      iree_task_dispatch_select_sharding(dispatch_task, worker_count);
+  iree_atomic_store_int64(&dispatch_task->measured_ns, 0,
+                          iree_memory_order_relaxed);
+  iree_atomic_store_int32(&dispatch_task->measured_tile_count, 0,
+                          iree_memory_order_relaxed);
 
   // Randomize starting worker.
   iree_host_size_t worker_offset = iree_task_post_batch_select_worker(
@@ -655,9 +748,26 @@ void iree_task_dispatch_retire(iree_task_dispatch_t* dispatch_task,
                                iree_task_submission_t* pending_submission) {
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_VALUE(z0, dispatch_task->dispatch_id);
+  iree_flight_recorder_record(IREE_FLIGHT_RECORDER_EVENT_DISPATCH_END,
+                              (uint64_t)(uintptr_t)dispatch_task, 0);
 
   // TODO(benvanik): attach statistics to the tracy zone.
 
+  // Remember the per-tile cost for the next dispatch with the same key. All
+  // shards have retired (with acq_rel ordering) so their measurements are
+  // visible here.
+  if (dispatch_task->cost_key) {
+    const int32_t measured_tile_count = iree_atomic_load_int32(
+        &dispatch_task->measured_tile_count, iree_memory_order_relaxed);
+    if (measured_tile_count > 0) {
+      iree_task_dispatch_record_tile_cost(
+          dispatch_task->cost_key,
+          iree_atomic_load_int64(&dispatch_task->measured_ns,
+                                 iree_memory_order_relaxed) /
+              measured_tile_count);
+    }
+  }
+
   // Merge the statistics from the dispatch into the scope so we can track all
   // of the work without tracking all the dispatches at a global level.
   iree_task_dispatch_statistics_merge(
@@ -710,9 +820,10 @@ iree_task_dispatch_shard_t* iree_task_dispatch_shard_allocate(
   return shard_task;
 }
 
-void iree_task_dispatch_shard_execute(
+bool iree_task_dispatch_shard_execute(
     iree_task_dispatch_shard_t* task, iree_cpu_processor_id_t processor_id,
     uint32_t worker_id, iree_byte_span_t worker_local_memory,
+    iree_atomic_int32_t* yield_request,
     iree_task_submission_t* pending_submission) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
@@ -735,7 +846,7 @@ void iree_task_dispatch_shard_execute(
                          worker_local_memory.data_length));
     iree_task_retire(&task->header, pending_submission, iree_ok_status());
     IREE_TRACE_ZONE_END(z0);
-    return;
+    return false;
   }
   iree_byte_span_t local_memory = iree_make_byte_span(
       worker_local_memory.data, dispatch_task->local_memory_size);
@@ -761,9 +872,19 @@ void iree_task_dispatch_shard_execute(
   // Hint as to which processor we are running on.
   tile_context.processor_id = processor_id;
 
+  // Dispatches with a cost key measure the shard so the next execution can
+  // size its reservations.
+  const bool measure_cost = dispatch_task->cost_key != 0;
+  const iree_time_t start_ns = measure_cost ? iree_time_now() : 0;
+  uint32_t executed_tile_count = 0;
+  bool yielded = false;
+
   // Loop over all tiles until they are all processed.
   const uint32_t tile_count = dispatch_task->tile_count;
   const uint32_t tiles_per_reservation = dispatch_task->tiles_per_reservation;
+  // Closures executing tile ranges are called once per reservation.
+  const bool tile_ranges = iree_all_bits_set(
+      dispatch_task->header.flags, IREE_TASK_FLAG_DISPATCH_TILE_RANGES);
   // relaxed order because we only care about atomic increments, not about
   // ordering of tile_index accesses w.r.t. other memory accesses.
   uint32_t tile_base = iree_atomic_fetch_add_int32(&dispatch_task->tile_index,
@@ -772,8 +893,9 @@ void iree_task_dispatch_shard_execute(
   while (tile_base < tile_count) {
     const uint32_t tile_range =
         iree_min(tile_base + tiles_per_reservation, tile_count);
+    tile_context.tile_count = tile_ranges ? tile_range - tile_base : 1;
     for (uint32_t tile_index = tile_base; tile_index < tile_range;
-         ++tile_index) {
+         tile_index += tile_context.tile_count) {
       // TODO(benvanik): faster math here, especially knowing we pull off N
       // sequential indices per reservation.
       uint32_t tile_i = tile_index;
@@ -814,6 +936,17 @@ void iree_task_dispatch_shard_execute(
         goto abort_shard;  // out of the while-for nest
       }
     }
+    executed_tile_count += tile_range - tile_base;
+
+    // Reservation boundaries are the only points at which the shard can be
+    // preempted: the remaining tiles stay in the grid for this shard to
+    // resume (or for other shards to pick up) after the urgent work runs.
+    if (yield_request &&
+        IREE_UNLIKELY(iree_atomic_load_int32(yield_request,
+                                             iree_memory_order_relaxed))) {
+      yielded = true;
+      break;
+    }
 
     // Try to grab the next slice of tiles.
     tile_base = iree_atomic_fetch_add_int32(&dispatch_task->tile_index,
@@ -822,14 +955,32 @@ void iree_task_dispatch_shard_execute(
   }
 abort_shard:
 
+  if (measure_cost && executed_tile_count > 0) {
+    iree_atomic_fetch_add_int64(&dispatch_task->measured_ns,
+                                iree_time_now() - start_ns,
+                                iree_memory_order_relaxed);
+    iree_atomic_fetch_add_int32(&dispatch_task->measured_tile_count,
+                                (int32_t)executed_tile_count,
+                                iree_memory_order_relaxed);
+  }
+
   // Push aggregate statistics up to the dispatch.
   // Note that we may have partial information here if we errored out of the
   // loop but that's still useful to know.
   iree_task_dispatch_statistics_merge(&shard_statistics,
                                       &dispatch_task->statistics);
 
+  // A yielded shard must not retire as the dispatch isn't complete until it
+  // has resumed and found no more tiles remaining.
+  if (yielded) {
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "yielded");
+    IREE_TRACE_ZONE_END(z0);
+    return true;
+  }
+
   // NOTE: even if an error was hit we retire OK - the error has already been
   // propagated to the dispatch and it'll clean up after all shards are joined.
   iree_task_retire(&task->header, pending_submission, iree_ok_status());
   IREE_TRACE_ZONE_END(z0);
+  return false;
 }
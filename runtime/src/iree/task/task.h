@@ -117,9 +117,31 @@ enum iree_task_flag_bits_t {
   // happens and may be available for querying before all tasks have been
   // cleaned up.
   IREE_TASK_FLAG_ABORTED = 1u << 5,
+
+  // The dispatch closure executes a range of tiles per invocation: it is
+  // called once per tile reservation with the number of tiles in the range
+  // specified by iree_task_tile_context_t::tile_count. Avoids the per-tile
+  // call overhead when the closure can loop over the tiles itself.
+  IREE_TASK_FLAG_DISPATCH_TILE_RANGES = 1u << 6,
 };
 typedef uint16_t iree_task_flags_t;
 
+// Scheduling priority class of a task, inherited from its scope.
+// Workers keep a FIFO of ready tasks per class and always select the next task
+// from the highest class with tasks available, bounded by
+// IREE_TASK_WORKER_MAX_PRIORITY_STREAK so that lower classes aren't starved.
+enum iree_task_priority_class_e {
+  // Throughput-oriented work such as background batch jobs.
+  IREE_TASK_PRIORITY_CLASS_NORMAL = 0u,
+  // Latency-sensitive work such as interactive requests that should bypass
+  // any queued normal priority work.
+  IREE_TASK_PRIORITY_CLASS_HIGH = 1u,
+};
+typedef uint8_t iree_task_priority_class_t;
+
+// Total number of priority classes.
+#define IREE_TASK_PRIORITY_CLASS_COUNT 2
+
 typedef struct iree_task_t iree_task_t;
 
 // A function called to cleanup tasks.
@@ -183,7 +205,12 @@ struct iree_alignas(iree_max_align_t) iree_task_t {
 };
 static_assert(offsetof(iree_task_t, next_task) == 0,
               "next_task intrusive pointer must be at offset 0");
-static_assert(sizeof(iree_task_t) <= 64,
+// Affinity sets wider than one word (IREE_TASK_EXECUTOR_MAX_WORKER_COUNT > 64)
+// grow the header by their extra words rounded up to the task alignment.
+static_assert(sizeof(iree_task_t) <=
+                  64 + (sizeof(iree_task_affinity_set_t) -
+                        sizeof(uint64_t) + iree_max_align_t - 1) /
+                           iree_max_align_t * iree_max_align_t,
               "the task header greatly influences pool sizes due to alignment "
               "requirements and should be kept tiny");
 
@@ -522,7 +549,9 @@ typedef struct iree_task_tile_storage_t {
 // coroutine state will be stored within the tile context until the tile is
 // resumed.
 typedef iree_alignas(iree_max_align_t) struct {
-  // Workgroup ID for the current invocation.
+  // Workgroup ID for the current invocation. When the dispatch has the
+  // IREE_TASK_FLAG_DISPATCH_TILE_RANGES flag set this is the first tile in the
+  // range of |tile_count| tiles.
   uint32_t workgroup_xyz[3];
   // Workgroup size for each invocation.
   uint32_t workgroup_size[3];
@@ -532,6 +561,12 @@ typedef iree_alignas(iree_max_align_t) struct {
   // TODO(benvanik): workgroup index to amortize calculating linear offsets.
   // (like gl_GlobalInvocationID)
 
+  // Number of tiles to execute starting at |workgroup_xyz| in x-fastest
+  // linear order. Always 1 unless the dispatch has the
+  // IREE_TASK_FLAG_DISPATCH_TILE_RANGES flag set. Ranges may span rows and
+  // slices of the grid.
+  uint32_t tile_count;
+
   // Opaque ID of the processor executing the tile.
   // May be slightly out of date or 0 if the processor could not be queried.
   iree_cpu_processor_id_t processor_id;
@@ -646,6 +681,17 @@ typedef iree_alignas(iree_max_align_t) struct iree_task_dispatch_t {
   // reasonable number chosen based on the tile and shard counts.
   uint32_t tiles_per_reservation;
 
+  // Optional key identifying the work performed by each tile (such as the
+  // executable and entry point) or 0 if unknown. Dispatches sharing a key have
+  // their per-tile cost measured and reuse it to size tile reservations and
+  // shard counts in later executions.
+  uint64_t cost_key;
+
+  // Total time spent and tiles executed by shards of a dispatch with a
+  // cost_key, accumulated as shards complete.
+  iree_atomic_int64_t measured_ns;
+  iree_atomic_int32_t measured_tile_count;
+
   // The tail tile index; the next reservation will start from here.
   // This is used by shards to slice off the work to perform in their inner
   // loop. Ideally we'd have no destructive interference with other shared data
@@ -668,6 +714,10 @@ void iree_task_dispatch_initialize_indirect(
     const uint32_t workgroup_size[3], const uint32_t* workgroup_count_ptr,
     iree_task_dispatch_t* out_task);
 
+// Returns the per-tile cost in nanoseconds measured for dispatches issued with
+// |cost_key| or 0 if none have completed (or their history was evicted).
+iree_time_t iree_task_dispatch_query_tile_cost(uint64_t cost_key);
+
 //==============================================================================
 // IREE_TASK_TYPE_DISPATCH_SHARD
 //==============================================================================
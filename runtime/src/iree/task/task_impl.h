@@ -118,11 +118,18 @@ iree_task_dispatch_shard_t* iree_task_dispatch_shard_allocate(
 // |worker_local_memory| is a block of memory exclusively available to the shard
 // during execution. Contents are undefined both before and after execution.
 //
+// |yield_request| is an optional flag checked between tile reservations. When
+// it is set the shard stops pulling tiles from the grid and returns true
+// without retiring so that the caller can run more urgent work and then
+// reschedule the shard to resume the grid where it left off. Returns false if
+// the shard was retired.
+//
 // Errors are propagated to the parent scope and the dispatch will fail once
 // all shards have completed.
-void iree_task_dispatch_shard_execute(
+bool iree_task_dispatch_shard_execute(
     iree_task_dispatch_shard_t* task, iree_cpu_processor_id_t processor_id,
     uint32_t worker_id, iree_byte_span_t worker_local_memory,
+    iree_atomic_int32_t* yield_request,
     iree_task_submission_t* pending_submission);
 
 #ifdef __cplusplus
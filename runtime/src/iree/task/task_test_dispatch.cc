@@ -52,8 +52,10 @@ class GridCoverage {
                                           tile_context->workgroup_count[0]) +
         tile_context->workgroup_xyz[1] * tile_context->workgroup_count[0] +
         tile_context->workgroup_xyz[0];
-    iree_atomic_fetch_add_int32(&coverage->storage_[slot], 1,
-                                iree_memory_order_seq_cst);
+    for (uint32_t i = 0; i < tile_context->tile_count; ++i) {
+      iree_atomic_fetch_add_int32(&coverage->storage_[slot + i], 1,
+                                  iree_memory_order_seq_cst);
+    }
 
     // Useful when testing large grids:
     // printf("%u, %u, %u\n", tile_context->workgroup_xyz[0],
@@ -113,6 +115,45 @@ TEST_F(TaskDispatchTest, Issue345) {
   DispatchAndVerifyGrid(kWorkgroupSize, kWorkgroupCount, IREE_TASK_FLAG_NONE);
 }
 
+TEST_F(TaskDispatchTest, Issue345TileRanges) {
+  IREE_TRACE_SCOPE();
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {3, 4, 5};
+  DispatchAndVerifyGrid(kWorkgroupSize, kWorkgroupCount,
+                        IREE_TASK_FLAG_DISPATCH_TILE_RANGES);
+}
+
+TEST_F(TaskDispatchTest, IssueLargeTileRanges) {
+  IREE_TRACE_SCOPE();
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {1023, 7, 3};
+  DispatchAndVerifyGrid(kWorkgroupSize, kWorkgroupCount,
+                        IREE_TASK_FLAG_DISPATCH_TILE_RANGES);
+}
+
+TEST_F(TaskDispatchTest, IssueWithCostFeedback) {
+  IREE_TRACE_SCOPE();
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {1024, 3, 1};
+  const uint64_t kCostKey = 0xC057u;
+  EXPECT_EQ(0, iree_task_dispatch_query_tile_cost(kCostKey));
+
+  // The first dispatch measures the tiles and the second is sharded based on
+  // that; both must still cover the whole grid exactly once.
+  for (int i = 0; i < 2; ++i) {
+    GridCoverage coverage(kWorkgroupCount);
+    iree_task_dispatch_t task;
+    iree_task_dispatch_initialize(
+        &scope_,
+        iree_task_make_dispatch_closure(GridCoverage::Tile, (void*)&coverage),
+        kWorkgroupSize, kWorkgroupCount, &task);
+    task.cost_key = kCostKey;
+    IREE_ASSERT_OK(SubmitTasksAndWaitIdle(&task.header, &task.header));
+    EXPECT_TRUE(coverage.Verify());
+    EXPECT_GT(iree_task_dispatch_query_tile_cost(kCostKey), 0);
+  }
+}
+
 TEST_F(TaskDispatchTest, IssueIndirect) {
   IREE_TRACE_SCOPE();
 
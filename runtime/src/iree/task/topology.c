@@ -78,6 +78,22 @@ iree_status_t iree_task_topology_push_group(
   return iree_ok_status();
 }
 
+iree_task_topology_group_mask_t iree_task_topology_calculate_node_sharing_mask(
+    const iree_task_topology_t* topology, iree_host_size_t group_index) {
+  if (group_index >= topology->group_count) {
+    return iree_task_affinity_set_empty();
+  }
+  const iree_task_topology_node_id_t node_id =
+      topology->groups[group_index].node_id;
+  iree_task_topology_group_mask_t mask = iree_task_affinity_set_empty();
+  for (iree_host_size_t i = 0; i < topology->group_count; ++i) {
+    if (topology->groups[i].node_id == node_id) {
+      iree_task_affinity_set_insert(&mask, i);
+    }
+  }
+  return mask;
+}
+
 void iree_task_topology_initialize_from_group_count(
     iree_host_size_t group_count, iree_task_topology_t* out_topology) {
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -92,3 +108,46 @@ void iree_task_topology_initialize_from_group_count(
 
   IREE_TRACE_ZONE_END(z0);
 }
+
+void iree_task_topology_initialize_from_partition(
+    const iree_task_topology_t* topology, iree_host_size_t partition_index,
+    iree_host_size_t partition_count, iree_task_topology_t* out_topology) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, partition_index);
+
+  iree_task_topology_initialize(out_topology);
+  if (partition_count == 0 || partition_index >= partition_count) {
+    IREE_TRACE_ZONE_END(z0);
+    return;
+  }
+
+  // Distribute the remainder across the leading partitions.
+  const iree_host_size_t group_count = topology->group_count;
+  const iree_host_size_t base_size = group_count / partition_count;
+  const iree_host_size_t remainder = group_count % partition_count;
+  const iree_host_size_t group_begin =
+      partition_index * base_size + iree_min(partition_index, remainder);
+  const iree_host_size_t group_end =
+      group_begin + base_size + (partition_index < remainder ? 1 : 0);
+
+  for (iree_host_size_t i = group_begin; i < group_end; ++i) {
+    const iree_task_topology_group_t* src_group = &topology->groups[i];
+    iree_task_topology_group_t* dst_group =
+        &out_topology->groups[out_topology->group_count];
+    memcpy(dst_group, src_group, sizeof(*dst_group));
+    dst_group->group_index = (uint8_t)out_topology->group_count++;
+    if (!iree_task_affinity_set_equal(src_group->constructive_sharing_mask,
+                                      IREE_TASK_TOPOLOGY_GROUP_MASK_ALL)) {
+      dst_group->constructive_sharing_mask = iree_task_affinity_set_empty();
+      IREE_TASK_AFFINITY_SET_FOR_EACH(j, src_group->constructive_sharing_mask) {
+        const iree_host_size_t j_index = (iree_host_size_t)j;
+        if (j_index >= group_begin && j_index < group_end) {
+          iree_task_affinity_set_insert(&dst_group->constructive_sharing_mask,
+                                        j_index - group_begin);
+        }
+      }
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+}
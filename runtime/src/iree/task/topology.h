@@ -13,6 +13,7 @@
 
 #include "iree/base/api.h"
 #include "iree/base/internal/threading.h"
+#include "iree/task/affinity_set.h"
 #include "iree/task/tuning.h"
 
 #ifdef __cplusplus
@@ -43,11 +44,15 @@ iree_task_topology_node_id_t iree_task_topology_query_current_node(void);
 
 // A bitmask indicating which other groups from 0 to N may constructively share
 // caches. For example, a value of 0b1100 indicates that group 2 and 3 share.
-typedef uint64_t iree_task_topology_group_mask_t;
+// Groups map 1:1 to executor workers so this uses the worker affinity sets.
+typedef iree_task_affinity_set_t iree_task_topology_group_mask_t;
 
-#define IREE_TASK_TOPOLOGY_GROUP_MASK_ALL UINT64_MAX
-#define IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT \
-  (sizeof(iree_task_topology_group_mask_t) * 8)
+#define IREE_TASK_TOPOLOGY_GROUP_MASK_ALL iree_task_affinity_for_any_worker()
+#define IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT IREE_TASK_EXECUTOR_MAX_WORKER_COUNT
+
+// Group indices are stored in 8 bits.
+static_assert(IREE_TASK_EXECUTOR_MAX_WORKER_COUNT <= 256,
+              "topology group indices must fit in uint8_t");
 
 // Information about a particular group within the topology.
 // Groups may be of varying levels of granularity even within the same topology
@@ -63,6 +68,10 @@ typedef struct iree_task_topology_group_t {
   // Processor index in the cpuinfo set.
   uint32_t processor_index;
 
+  // NUMA node the processor belongs to. Workers prefer stealing work from
+  // other workers on the same node before crossing to remote nodes.
+  iree_task_topology_node_id_t node_id;
+
   // Ideal thread affinity for threads within this group.
   // All threads within the group share the same affinity and this is what
   // allows us to model Simultaneous Multi-Threading (SMT) (aka hyperthreading).
@@ -139,6 +148,11 @@ const iree_task_topology_group_t* iree_task_topology_get_group(
 iree_status_t iree_task_topology_push_group(
     iree_task_topology_t* topology, const iree_task_topology_group_t* group);
 
+// Returns a bitmask of the groups in |topology| on the same NUMA node as the
+// group at |group_index|, including the group itself.
+iree_task_topology_group_mask_t iree_task_topology_calculate_node_sharing_mask(
+    const iree_task_topology_t* topology, iree_host_size_t group_index);
+
 //===----------------------------------------------------------------------===//
 // Topology initialization helpers
 //===----------------------------------------------------------------------===//
@@ -152,6 +166,16 @@ iree_status_t iree_task_topology_push_group(
 void iree_task_topology_initialize_from_group_count(
     iree_host_size_t group_count, iree_task_topology_t* out_topology);
 
+// Initializes |out_topology| with the subset of groups from |topology| in
+// partition |partition_index| of |partition_count|. Groups are divided into
+// contiguous ranges of near-equal size and renumbered from 0 such that each
+// partition can be used to create an executor with a disjoint set of workers.
+// Constructive sharing masks are remapped to the partition and any sharing
+// with groups outside of it is dropped.
+void iree_task_topology_initialize_from_partition(
+    const iree_task_topology_t* topology, iree_host_size_t partition_index,
+    iree_host_size_t partition_count, iree_task_topology_t* out_topology);
+
 // Initializes a topology with one group for each physical core with the given
 // NUMA node ID (usually package or cluster). Up to |max_core_count| physical
 // cores will be selected from the node.
@@ -133,33 +133,28 @@ static void iree_task_topology_set_affinity_from_processor(
 #endif  // cpuinfo-like platform field
 }
 
-// Returns a bitset with all *processors* that share the same |cache|.
-static uint64_t iree_task_topology_calculate_cache_bits(
-    const struct cpuinfo_cache* cache) {
-  if (!cache) return 0;
-  uint64_t mask = 0;
-  for (uint32_t processor_i = 0; processor_i < cache->processor_count;
-       ++processor_i) {
-    uint32_t i = cache->processor_start + processor_i;
-    if (i < IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT) {
-      mask |= 1ull << i;
-    }
-  }
-  return mask;
+// Returns true if |processor_index| is one of the processors sharing |cache|.
+static bool iree_task_topology_cache_contains(const struct cpuinfo_cache* cache,
+                                              uint32_t processor_index) {
+  if (!cache) return false;
+  return processor_index >= cache->processor_start &&
+         processor_index < cache->processor_start + cache->processor_count;
 }
 
-// Constructs a constructive sharing mask for all *processors* that share the
-// same cache as the specified |processor|.
-static uint64_t iree_task_topology_calculate_constructive_sharing_mask(
-    const struct cpuinfo_processor* processor) {
-  uint64_t mask = 0;
-  mask |= iree_task_topology_calculate_cache_bits(processor->cache.l1i);
-  mask |= iree_task_topology_calculate_cache_bits(processor->cache.l1d);
-  mask |= iree_task_topology_calculate_cache_bits(processor->cache.l2);
+// Returns true if |processor| shares a cache with the processor at
+// |other_processor_index|. Compares the cache ranges instead of building
+// processor bitmasks so that any processor index is supported.
+static bool iree_task_topology_shares_cache(
+    const struct cpuinfo_processor* processor, uint32_t other_processor_index) {
   // TODO(benvanik): include L3 here too (for systems that have it)? Or use L3
   // info purely for distribution and focus the group mask on lower-latency
   // caches?
-  return mask;
+  return iree_task_topology_cache_contains(processor->cache.l1i,
+                                           other_processor_index) ||
+         iree_task_topology_cache_contains(processor->cache.l1d,
+                                           other_processor_index) ||
+         iree_task_topology_cache_contains(processor->cache.l2,
+                                           other_processor_index);
 }
 
 // Populates |our_group| with the information from |core|.
@@ -173,6 +168,7 @@ static void iree_task_topology_group_initialize_from_core(
   // and use all threads anyway so this alignment is just helpful for debugging.
   uint32_t processor_i = core->processor_start;
   out_group->processor_index = processor_i;
+  out_group->node_id = core->cluster->cluster_id;
 
   const struct cpuinfo_processor* processor =
       cpuinfo_get_processor(processor_i);
@@ -186,23 +182,22 @@ static void iree_task_topology_group_initialize_from_core(
 // processor IDs a particular group is mapped to.
 static void iree_task_topology_fixup_constructive_sharing_masks(
     iree_task_topology_t* topology) {
-  // O(n^2), but n is always <= 64 (and often <= 8).
+  // O(n^2), but n is always <= IREE_TASK_EXECUTOR_MAX_WORKER_COUNT (and
+  // often <= 8).
   for (iree_host_size_t i = 0; i < topology->group_count; ++i) {
     iree_task_topology_group_t* group = &topology->groups[i];
+    const struct cpuinfo_processor* processor =
+        cpuinfo_get_processor(group->processor_index);
 
-    // Compute the processors that we can constructively share with.
-    uint64_t constructive_sharing_mask =
-        iree_task_topology_calculate_constructive_sharing_mask(
-            cpuinfo_get_processor(group->processor_index));
-
-    iree_task_topology_group_mask_t group_mask = 0;
+    // Collect the groups whose processors we can constructively share with.
+    iree_task_topology_group_mask_t group_mask =
+        iree_task_affinity_set_empty();
     for (iree_host_size_t j = 0; j < topology->group_count; ++j) {
       if (i == j) continue;
       const iree_task_topology_group_t* other_group = &topology->groups[j];
-      uint64_t group_processor_bits =
-          iree_math_rotl_u64(1ull, other_group->processor_index);
-      if (constructive_sharing_mask & group_processor_bits) {
-        group_mask |= iree_math_rotl_u64(1ull, other_group->group_index);
+      if (iree_task_topology_shares_cache(processor,
+                                          other_group->processor_index)) {
+        iree_task_affinity_set_insert(&group_mask, other_group->group_index);
       }
     }
 
@@ -99,6 +99,32 @@ TEST(TopologyTest, MaxCapacity) {
   iree_task_topology_deinitialize(&topology);
 }
 
+TEST(TopologyTest, NodeSharingMask) {
+  iree_task_topology_t topology;
+  iree_task_topology_initialize(&topology);
+
+  // Groups 0, 2, 4 on node 0 and groups 1, 3 on node 1.
+  for (iree_host_size_t i = 0; i < 5; ++i) {
+    iree_task_topology_group_t group;
+    iree_task_topology_group_initialize(i, &group);
+    group.node_id = i % 2;
+    IREE_EXPECT_OK(iree_task_topology_push_group(&topology, &group));
+  }
+  EXPECT_EQ(
+      0b10101u,
+      iree_task_topology_calculate_node_sharing_mask(&topology, 0).words[0]);
+  EXPECT_EQ(
+      0b10101u,
+      iree_task_topology_calculate_node_sharing_mask(&topology, 4).words[0]);
+  EXPECT_EQ(
+      0b01010u,
+      iree_task_topology_calculate_node_sharing_mask(&topology, 3).words[0]);
+  EXPECT_TRUE(iree_task_affinity_set_is_empty(
+      iree_task_topology_calculate_node_sharing_mask(&topology, 5)));
+
+  iree_task_topology_deinitialize(&topology);
+}
+
 TEST(TopologyTest, FromGroupCount) {
   static constexpr iree_host_size_t kGroupCount = 4;
   iree_task_topology_t topology;
@@ -117,6 +143,52 @@ TEST(TopologyTest, FromGroupCount) {
   iree_task_topology_deinitialize(&topology);
 }
 
+TEST(TopologyTest, FromPartition) {
+  iree_task_topology_t topology;
+  iree_task_topology_initialize(&topology);
+
+  // Groups 0-1 and 2-4 share caches.
+  for (iree_host_size_t i = 0; i < 5; ++i) {
+    iree_task_topology_group_t group;
+    iree_task_topology_group_initialize(i, &group);
+    group.processor_index = 100 + i;
+    group.constructive_sharing_mask =
+        i < 2 ? iree_task_affinity_for_worker_range(0, 2)
+              : iree_task_affinity_for_worker_range(2, 5);
+    IREE_EXPECT_OK(iree_task_topology_push_group(&topology, &group));
+  }
+
+  // The leading partition receives the remainder.
+  iree_task_topology_t partition0;
+  iree_task_topology_initialize_from_partition(&topology, 0, 2, &partition0);
+  ASSERT_EQ(3, iree_task_topology_group_count(&partition0));
+  for (iree_host_size_t i = 0; i < 3; ++i) {
+    const iree_task_topology_group_t* group =
+        iree_task_topology_get_group(&partition0, i);
+    EXPECT_EQ(i, group->group_index);
+    EXPECT_EQ(100 + i, group->processor_index);
+  }
+  EXPECT_EQ(0b011u, partition0.groups[0].constructive_sharing_mask.words[0]);
+  EXPECT_EQ(0b100u, partition0.groups[2].constructive_sharing_mask.words[0]);
+
+  iree_task_topology_t partition1;
+  iree_task_topology_initialize_from_partition(&topology, 1, 2, &partition1);
+  ASSERT_EQ(2, iree_task_topology_group_count(&partition1));
+  EXPECT_EQ(0, partition1.groups[0].group_index);
+  EXPECT_EQ(103, partition1.groups[0].processor_index);
+  EXPECT_EQ(0b11u, partition1.groups[1].constructive_sharing_mask.words[0]);
+
+  // Out of range partitions are empty.
+  iree_task_topology_t partition2;
+  iree_task_topology_initialize_from_partition(&topology, 2, 2, &partition2);
+  EXPECT_EQ(0, iree_task_topology_group_count(&partition2));
+
+  iree_task_topology_deinitialize(&partition0);
+  iree_task_topology_deinitialize(&partition1);
+  iree_task_topology_deinitialize(&partition2);
+  iree_task_topology_deinitialize(&topology);
+}
+
 // Verifies only that the |topology| is usable.
 // If we actually checked the contents here then we'd just be validating that
 // cpuinfo was working and the tests would become machine-dependent.
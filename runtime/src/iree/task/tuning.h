@@ -12,10 +12,14 @@ extern "C" {
 #endif  // __cplusplus
 
 // Maximum number of workers that an executor can manage.
-// A 64 worker hard limit is based on us using uint64_t as a bitmask to select
-// workers. It's easy to go smaller (just use fewer bits) if it's known that
-// only <64 will ever be used (such as for devices with 2 cores).
+// Workers are selected with iree_task_affinity_set_t bitmasks of one 64-bit
+// word per 64 workers. The default of 64 keeps the sets (and the task headers
+// carrying them) to a single word; builds targeting large servers can define
+// this up to 256 (such as -DIREE_TASK_EXECUTOR_MAX_WORKER_COUNT=256) to run
+// all hardware threads in a single executor.
+#if !defined(IREE_TASK_EXECUTOR_MAX_WORKER_COUNT)
 #define IREE_TASK_EXECUTOR_MAX_WORKER_COUNT (64)
+#endif  // !IREE_TASK_EXECUTOR_MAX_WORKER_COUNT
 
 // Initial number of shard tasks that are allocated in the executor pool.
 // Increasing this number will decrease initial allocation storms in cases of
@@ -23,7 +27,8 @@ extern "C" {
 // at the cost of a higher minimum memory consumption.
 #define IREE_TASK_EXECUTOR_INITIAL_SHARD_RESERVATION_PER_WORKER (4)
 
-// Maximum number of events retained by the executor event pool.
+// Number of events initially allocated by the executor event pool. The pool
+// grows to the peak number of events used and is trimmed with the executor.
 #define IREE_TASK_EXECUTOR_EVENT_POOL_CAPACITY 64
 
 // Maximum number of simultaneous waits an executor may perform as part of a
@@ -38,8 +43,8 @@ extern "C" {
 // progress and indicates a possible error in task assignment.
 //
 // Also, the underlying iree_wait_set_t may not support more than 64 handles on
-// certain platforms without emulation. Trying to keep us on the fast-path
-// with a reasonable number seems fine for now until we have a need for more.
+// certain platforms without emulation. Where the wait set is scalable (epoll)
+// this is only the initial capacity and the poller grows beyond it as needed.
 //
 // NOTE: we reserve 1 wait handle for our own internal use. This allows us to
 // wake the coordination worker when new work is submitted from external
@@ -77,12 +82,12 @@ extern "C" {
 // In real-time systems too few tasks is better (slightly more work for much
 // lower variance in execution) while in batch mode systems too many tasks is
 // better (as latencies don't matter so long as throughput is maximized).
-#define IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT \
-  IREE_TASK_EXECUTOR_MAX_WORKER_COUNT
+#define IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT (64)
 
 // Number of tiles that will be batched into a single reservation from the grid.
-// This is a maximum; if there are fewer tiles that would otherwise allow for
-// maximum parallelism then this may be ignored.
+// This is a maximum; grids with fewer than this many tiles per worker reserve
+// proportionally fewer tiles at a time so that all workers get a share while
+// wide executors don't contend on single-tile reservations.
 //
 // The more tiles reserved at a time the higher the chance for latency to
 // increase as many reserved tiles are held up on one worker while another may
@@ -94,6 +99,47 @@ extern "C" {
 // memory).
 #define IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION (8)
 
+// Whether dispatches with a cost key (iree_task_dispatch_t::cost_key) choose
+// their tile reservations and shard counts from the per-tile cost measured in
+// previous executions. Dispatches without a key or history use the static
+// IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION heuristic.
+#define IREE_TASK_DISPATCH_ADAPTIVE_SHARDING 1
+
+// Work each tile reservation should cover when the per-tile cost is known.
+// Reservations are an atomic increment on a counter shared by all shards so
+// they should be long enough for the contention to be noise.
+#define IREE_TASK_DISPATCH_TARGET_RESERVATION_NS (10 * 1000)
+
+// Minimum work worth waking an additional shard for. Dispatches measured to be
+// cheaper than this per worker are spread across fewer workers.
+#define IREE_TASK_DISPATCH_MIN_SHARD_NS (20 * 1000)
+
+// Maximum number of tiles reserved at a time when the per-tile cost is known.
+#define IREE_TASK_DISPATCH_MAX_ADAPTIVE_TILES_PER_RESERVATION (64)
+
+// Number of distinct cost keys whose per-tile cost is remembered. Must be a
+// power of two. Keys hashing to the same slot evict each other.
+#define IREE_TASK_DISPATCH_COST_CACHE_CAPACITY (256)
+
+// Number of times an idle worker polls its wake notification between clock
+// queries while spinning (see iree_task_executor_options_t::worker_spin_ns).
+// Each poll is preceded by a processor pause/yield hint so this also bounds
+// how far past the spin budget a worker may run.
+#define IREE_TASK_WORKER_SPIN_POLLS_PER_CLOCK (16)
+
+// Maximum number of consecutive higher priority class tasks a worker will
+// execute while lower priority class tasks are waiting in its queue. Once
+// reached the worker executes one task from the highest waiting lower class
+// before resuming. Higher values favor latency of high priority work at the
+// cost of throughput of everything else.
+#define IREE_TASK_WORKER_MAX_PRIORITY_STREAK (16)
+
+// Alignment of worker local memory grown on demand at or beyond this size.
+// Aligning to the huge page size allows transparent huge pages to back the
+// memory and avoid TLB misses on large tiled scratch buffers. Smaller growth
+// is aligned to the destructive interference size.
+#define IREE_TASK_WORKER_LOCAL_MEMORY_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
 // Whether to enable per-tile colors for each tile tracing zone based on the
 // tile grid xyz. Not cheap and can be disabled to reduce tracing overhead.
 // TODO(#4017): make per-tile color tracing fast enough to always have on.
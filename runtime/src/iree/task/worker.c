@@ -14,6 +14,7 @@
 #include "iree/base/tracing.h"
 #include "iree/task/executor_impl.h"
 #include "iree/task/post_batch.h"
+#include "iree/task/scope.h"
 #include "iree/task/submission.h"
 #include "iree/task/task_impl.h"
 #include "iree/task/tuning.h"
@@ -25,8 +26,9 @@ static int iree_task_worker_main(iree_task_worker_t* worker);
 iree_status_t iree_task_worker_initialize(
     iree_task_executor_t* executor, iree_host_size_t worker_index,
     const iree_task_topology_group_t* topology_group,
-    iree_host_size_t stack_size, iree_byte_span_t local_memory,
-    iree_prng_splitmix64_state_t* seed_prng, iree_task_worker_t* out_worker) {
+    iree_task_affinity_set_t node_sharing_mask, iree_host_size_t stack_size,
+    iree_byte_span_t local_memory, iree_prng_splitmix64_state_t* seed_prng,
+    iree_task_worker_t* out_worker) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
   out_worker->executor = executor;
@@ -35,20 +37,31 @@ iree_status_t iree_task_worker_initialize(
   out_worker->ideal_thread_affinity = topology_group->ideal_thread_affinity;
   out_worker->constructive_sharing_mask =
       topology_group->constructive_sharing_mask;
+  out_worker->node_sharing_mask = node_sharing_mask;
   out_worker->max_theft_attempts =
       executor->worker_count / IREE_TASK_EXECUTOR_MAX_THEFT_ATTEMPTS_DIVISOR;
   iree_prng_minilcg128_initialize(iree_prng_splitmix64_next(seed_prng),
                                   &out_worker->theft_prng);
   out_worker->local_memory = local_memory;
+  out_worker->grown_local_memory = NULL;
   out_worker->processor_id = 0;
   out_worker->processor_tag = 0;
+  iree_atomic_store_int64(&out_worker->spin_wake_count, 0,
+                          iree_memory_order_relaxed);
+  iree_atomic_store_int64(&out_worker->park_count, 0,
+                          iree_memory_order_relaxed);
+  iree_atomic_store_int64(&out_worker->spin_ns, 0, iree_memory_order_relaxed);
 
   iree_notification_initialize(&out_worker->wake_notification);
   iree_notification_initialize(&out_worker->state_notification);
-  iree_atomic_task_slist_initialize(&out_worker->mailbox_slist);
+  for (int i = 0; i < IREE_TASK_PRIORITY_CLASS_COUNT; ++i) {
+    iree_atomic_task_slist_initialize(&out_worker->mailbox_slists[i]);
+  }
   iree_task_queue_initialize(&out_worker->local_task_queue);
 
   iree_task_worker_state_t initial_state = IREE_TASK_WORKER_STATE_RUNNING;
+  iree_atomic_store_int32(&out_worker->yield_requested, 0,
+                          iree_memory_order_relaxed);
   iree_atomic_store_int32(&out_worker->state, initial_state,
                           iree_memory_order_release);
 
@@ -130,23 +143,42 @@ void iree_task_worker_deinitialize(iree_task_worker_t* worker) {
   // Release unfinished tasks by flushing the mailbox (which if we're here can't
   // get anything more posted to it) and then discarding everything we still
   // have a reference to.
-  iree_atomic_task_slist_discard(&worker->mailbox_slist);
-  iree_task_list_discard(&worker->local_task_queue.list);
+  for (int i = 0; i < IREE_TASK_PRIORITY_CLASS_COUNT; ++i) {
+    iree_atomic_task_slist_discard(&worker->mailbox_slists[i]);
+    iree_task_list_discard(&worker->local_task_queue.lists[i]);
+  }
 
   iree_notification_deinitialize(&worker->wake_notification);
   iree_notification_deinitialize(&worker->state_notification);
-  iree_atomic_task_slist_deinitialize(&worker->mailbox_slist);
+  for (int i = 0; i < IREE_TASK_PRIORITY_CLASS_COUNT; ++i) {
+    iree_atomic_task_slist_deinitialize(&worker->mailbox_slists[i]);
+  }
   iree_task_queue_deinitialize(&worker->local_task_queue);
 
+  if (worker->grown_local_memory) {
+    iree_allocator_free_aligned(worker->executor->allocator,
+                                worker->grown_local_memory);
+    worker->grown_local_memory = NULL;
+  }
+
   IREE_TRACE_ZONE_END(z0);
 }
 
 void iree_task_worker_post_tasks(iree_task_worker_t* worker,
+                                 iree_task_priority_class_t priority_class,
                                  iree_task_list_t* list) {
   // Move the list into the mailbox. Note that the mailbox is LIFO and this list
   // is concatenated with its current order preserved (which should be LIFO).
-  iree_atomic_task_slist_concat(&worker->mailbox_slist, list->head, list->tail);
+  iree_atomic_task_slist_concat(&worker->mailbox_slists[priority_class],
+                                list->head, list->tail);
   memset(list, 0, sizeof(*list));
+
+  // Ask any lower priority dispatch shard the worker is executing to yield at
+  // its next tile reservation boundary.
+  if (priority_class > IREE_TASK_PRIORITY_CLASS_NORMAL) {
+    iree_atomic_store_int32(&worker->yield_requested, 1,
+                            iree_memory_order_release);
+  }
 }
 
 iree_task_t* iree_task_worker_try_steal_task(iree_task_worker_t* worker,
@@ -158,13 +190,58 @@ iree_task_t* iree_task_worker_try_steal_task(iree_task_worker_t* worker,
                                                 target_queue, max_tasks);
   if (task) return task;
 
-  // If we still didn't steal any tasks then let's try the slist instead.
-  task = iree_atomic_task_slist_pop(&worker->mailbox_slist);
-  if (task) return task;
+  // If we still didn't steal any tasks then let's try the slists instead.
+  for (int i = IREE_TASK_PRIORITY_CLASS_COUNT - 1; i >= 0; --i) {
+    task = iree_atomic_task_slist_pop(&worker->mailbox_slists[i]);
+    if (task) return task;
+  }
 
   return NULL;
 }
 
+// Grows the worker local memory to at least |required_size| bytes if needed and
+// allowed by the executor limit. Must be called from the worker thread so that
+// the memory is first touched (and placed) on the NUMA node of the worker.
+// Failures leave the existing local memory in place and are reported by the
+// dispatch when it finds the memory insufficient.
+static void iree_task_worker_reserve_local_memory(
+    iree_task_worker_t* worker, iree_host_size_t required_size) {
+  if (IREE_LIKELY(required_size <= worker->local_memory.data_length)) return;
+  if (required_size > worker->executor->worker_local_memory_limit) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)required_size);
+
+  // Grow geometrically to avoid repeated reallocation as executables with
+  // increasing requirements are dispatched.
+  iree_host_size_t new_size = iree_min(
+      iree_max(required_size, worker->local_memory.data_length * 2),
+      worker->executor->worker_local_memory_limit);
+  const iree_host_size_t alignment =
+      new_size >= IREE_TASK_WORKER_LOCAL_MEMORY_HUGE_PAGE_SIZE
+          ? IREE_TASK_WORKER_LOCAL_MEMORY_HUGE_PAGE_SIZE
+          : iree_hardware_destructive_interference_size;
+  new_size = iree_host_align(new_size, alignment);
+
+  // NOTE: the returned memory is zeroed which touches every page from this
+  // thread.
+  void* new_memory = NULL;
+  iree_status_t status =
+      iree_allocator_malloc_aligned(worker->executor->allocator, new_size,
+                                    alignment, /*offset=*/0, &new_memory);
+  if (iree_status_is_ok(status)) {
+    if (worker->grown_local_memory) {
+      iree_allocator_free_aligned(worker->executor->allocator,
+                                  worker->grown_local_memory);
+    }
+    worker->grown_local_memory = new_memory;
+    worker->local_memory = iree_make_byte_span(new_memory, new_size);
+  } else {
+    iree_status_ignore(status);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
 // Executes a task on a worker.
 // Only task types that are scheduled to workers are handled; all others must be
 // handled by the coordinator during scheduling.
@@ -178,16 +255,33 @@ static void iree_task_worker_execute(
   // TODO(benvanik): think a bit more about this timing; this ensures we have
   // BFS behavior at the cost of the additional merge overhead - it's probably
   // worth it?
-  // TODO(benvanik): handle partial tasks and re-queuing.
   switch (task->type) {
     case IREE_TASK_TYPE_CALL: {
       iree_task_call_execute((iree_task_call_t*)task, pending_submission);
       break;
     }
     case IREE_TASK_TYPE_DISPATCH_SHARD: {
-      iree_task_dispatch_shard_execute(
-          (iree_task_dispatch_shard_t*)task, worker->processor_id,
-          worker->worker_index, worker->local_memory, pending_submission);
+      // NOTE: the parent dispatch of a shard is its completion task.
+      iree_task_worker_reserve_local_memory(
+          worker,
+          ((iree_task_dispatch_t*)task->completion_task)->local_memory_size);
+      // Only shards that can be outranked by pending work are preemptible.
+      iree_task_priority_class_t priority_class =
+          iree_task_scope_priority_class(task->scope);
+      iree_atomic_int32_t* yield_request =
+          priority_class < IREE_TASK_PRIORITY_CLASS_COUNT - 1
+              ? &worker->yield_requested
+              : NULL;
+      if (iree_task_dispatch_shard_execute(
+              (iree_task_dispatch_shard_t*)task, worker->processor_id,
+              worker->worker_index, worker->local_memory, yield_request,
+              pending_submission)) {
+        // Yielded: resume the shard as soon as the urgent work has run. The
+        // higher priority tasks are selected ahead of it when the mailbox is
+        // flushed on the next pump.
+        iree_task_queue_push_front(&worker->local_task_queue, priority_class,
+                                   task);
+      }
       break;
     }
     default:
@@ -208,8 +302,17 @@ static bool iree_task_worker_pump_once(
 
   // Check the local work queue for any work we know we should start
   // processing immediately. Other workers may try to steal some of this work
-  // if we take too long.
-  iree_task_t* task = iree_task_queue_pop_front(&worker->local_task_queue);
+  // if we take too long. Any latency-sensitive work posted since the last task
+  // is moved into the local queue first so that it is selected ahead of
+  // already queued lower priority tasks; this is a single atomic exchange when
+  // nothing has been posted.
+  // The yield request is cleared first so that any posts racing with the flush
+  // will request another yield.
+  iree_atomic_store_int32(&worker->yield_requested, 0,
+                          iree_memory_order_relaxed);
+  iree_task_t* task = iree_task_queue_flush_from_lifo_slist(
+      &worker->local_task_queue, IREE_TASK_PRIORITY_CLASS_HIGH,
+      &worker->mailbox_slists[IREE_TASK_PRIORITY_CLASS_HIGH]);
 
   // Check the mailbox to see if we have incoming work that has been posted.
   // We try to greedily move it to our local work list so that we can work
@@ -221,8 +324,9 @@ static bool iree_task_worker_pump_once(
     // first place (large uneven workloads for various workers, bad distribution
     // in the face of heterogenous multi-core architectures where some workers
     // complete tasks faster than others, etc).
-    task = iree_task_queue_flush_from_lifo_slist(&worker->local_task_queue,
-                                                 &worker->mailbox_slist);
+    task = iree_task_queue_flush_from_lifo_slist(
+        &worker->local_task_queue, IREE_TASK_PRIORITY_CLASS_NORMAL,
+        &worker->mailbox_slists[IREE_TASK_PRIORITY_CLASS_NORMAL]);
   }
 
 #if IREE_TASK_EXECUTOR_MAX_THEFT_ATTEMPTS_DIVISOR > 0
@@ -233,8 +337,8 @@ static bool iree_task_worker_pump_once(
   if (!task) {
     task = iree_task_executor_try_steal_task(
         worker->executor, worker->constructive_sharing_mask,
-        worker->max_theft_attempts, &worker->theft_prng,
-        &worker->local_task_queue);
+        worker->node_sharing_mask, worker->max_theft_attempts,
+        &worker->theft_prng, &worker->local_task_queue);
   }
 #endif  // IREE_TASK_EXECUTOR_MAX_THEFT_ATTEMPTS_DIVISOR > 0
 
@@ -257,6 +361,44 @@ static void iree_task_worker_update_processor_id(iree_task_worker_t* worker) {
   iree_cpu_requery_processor_id(&worker->processor_tag, &worker->processor_id);
 }
 
+// Spins for up to the executor worker_spin_ns budget waiting for a post to
+// the wake notification after |wait_token| was captured. The worker must not
+// be registered as a waiter while spinning so that coordinators posting work
+// only bump the notification epoch instead of paying for a futex wake.
+// Returns true if the worker was posted to and should look for work again.
+static bool iree_task_worker_spin_for_work(iree_task_worker_t* worker,
+                                           iree_wait_token_t wait_token) {
+  const iree_duration_t spin_budget_ns = worker->executor->worker_spin_ns;
+  if (spin_budget_ns == IREE_DURATION_ZERO) return false;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Spin against an absolute deadline as we may be descheduled while spinning.
+  const iree_time_t spin_start_ns = iree_time_now();
+  const iree_time_t spin_deadline_ns = spin_start_ns + spin_budget_ns;
+  bool posted = false;
+  iree_time_t now_ns = spin_start_ns;
+  do {
+    // Check the cheap notification epoch a few times between clock queries
+    // and use pause/yield instructions to be nice to SMT siblings.
+    for (int i = 0; i < IREE_TASK_WORKER_SPIN_POLLS_PER_CLOCK && !posted; ++i) {
+      iree_processor_yield();
+      posted = iree_notification_poll(&worker->wake_notification, wait_token);
+    }
+    now_ns = iree_time_now();
+  } while (!posted && now_ns < spin_deadline_ns);
+
+  iree_atomic_fetch_add_int64(&worker->spin_ns, now_ns - spin_start_ns,
+                              iree_memory_order_relaxed);
+  if (posted) {
+    iree_atomic_fetch_add_int64(&worker->spin_wake_count, 1,
+                                iree_memory_order_relaxed);
+  }
+
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, posted ? 1 : 0);
+  IREE_TRACE_ZONE_END(z0);
+  return posted;
+}
+
 // Alternates between pumping ready tasks in the worker queue and waiting
 // for more tasks to arrive. Only returns when the worker has been asked by
 // the executor to exit.
@@ -276,9 +418,10 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
     iree_wait_token_t wait_token =
         iree_notification_prepare_wait(&worker->wake_notification);
     // The masks are accessed with 'relaxed' order because they are just hints.
-    iree_atomic_task_affinity_set_fetch_and(&worker->executor->worker_idle_mask,
-                                            ~worker->worker_bit,
-                                            iree_memory_order_relaxed);
+    iree_atomic_task_affinity_set_fetch_and(
+        &worker->executor->worker_idle_mask,
+        iree_task_affinity_set_not(worker->worker_bit),
+        iree_memory_order_relaxed);
 
     // Check state to see if we've been asked to exit.
     if (iree_atomic_load_int32(&worker->state, iree_memory_order_acquire) ==
@@ -331,14 +474,30 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
       // Have more work to do; loop around to try another pump.
       iree_notification_cancel_wait(&worker->wake_notification);
     } else {
-      // Spin/wait in the kernel. We don't care if the condition fails as we're
+      // Spin first (if enabled) without being registered as a waiter; any
+      // post since wait_token was captured means new work or an exit request.
+      if (worker->executor->worker_spin_ns != IREE_DURATION_ZERO) {
+        iree_notification_cancel_wait(&worker->wake_notification);
+        if (iree_task_worker_spin_for_work(worker, wait_token)) continue;
+        // Re-register as a waiter. If we were posted to in the window between
+        // the spin and now the new token won't match and we loop around.
+        iree_wait_token_t park_token =
+            iree_notification_prepare_wait(&worker->wake_notification);
+        if (park_token != wait_token) {
+          iree_notification_cancel_wait(&worker->wake_notification);
+          continue;
+        }
+      }
+
+      // Park in the kernel. We don't care if the condition fails as we're
       // just using it as a pulse.
+      iree_atomic_fetch_add_int64(&worker->park_count, 1,
+                                  iree_memory_order_relaxed);
       IREE_TRACE_ZONE_BEGIN_NAMED(z_wait,
                                   "iree_task_worker_main_pump_wake_wait");
-      iree_notification_commit_wait(
-          &worker->wake_notification, wait_token,
-          /*spin_ns=*/worker->executor->worker_spin_ns,
-          /*deadline_ns=*/IREE_TIME_INFINITE_FUTURE);
+      iree_notification_commit_wait(&worker->wake_notification, wait_token,
+                                    /*spin_ns=*/IREE_DURATION_ZERO,
+                                    /*deadline_ns=*/IREE_TIME_INFINITE_FUTURE);
       IREE_TRACE_ZONE_END(z_wait);
 
       // Woke from a wait - query the processor ID in case we migrated during
@@ -364,6 +523,12 @@ static int iree_task_worker_main(iree_task_worker_t* worker) {
   // TODO(benvanik): call this after waking in case CPU hotplugging happens.
   iree_thread_request_affinity(worker->thread, worker->ideal_thread_affinity);
 
+  // Touch the local memory first from the pinned thread so that its pages are
+  // placed on the NUMA node of the worker.
+  if (worker->local_memory.data_length > 0) {
+    memset(worker->local_memory.data, 0, worker->local_memory.data_length);
+  }
+
   // Enter the running state immediately. Note that we could have been requested
   // to exit while suspended/still starting up, so check that here before we
   // mess with any data structures.
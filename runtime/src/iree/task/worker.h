@@ -55,23 +55,34 @@ typedef enum iree_task_worker_state_e {
 // alignment and padding between particular fields is carefully (though perhaps
 // not yet correctly) selected; see the 'LAYOUT' comments below.
 typedef struct iree_task_worker_t {
-  // A LIFO mailbox used by coordinators to post tasks to this worker.
+  // LIFO mailboxes used by coordinators to post tasks to this worker, indexed
+  // by iree_task_priority_class_t.
   // As workers self-nominate to be coordinators and fan out dispatch shards
   // they can directly emplace those shards into the workers that should execute
   // them based on the work distribution policy. When workers go to look for
-  // more work after their local queue empties they will flush this list and
+  // more work after their local queue empties they will flush these lists and
   // move all of the tasks into their local queue and restart processing.
+  // Mailboxes of priority classes above IREE_TASK_PRIORITY_CLASS_NORMAL are
+  // also flushed prior to executing each task so that latency-sensitive work
+  // doesn't wait for the local queue to drain.
   // LAYOUT: must be 64b away from local_task_queue.
-  iree_atomic_task_slist_t mailbox_slist;
+  iree_atomic_task_slist_t mailbox_slists[IREE_TASK_PRIORITY_CLASS_COUNT];
 
   // Current state of the worker (iree_task_worker_state_t).
   // LAYOUT: frequent access; next to wake_notification as they are always
   //         accessed together.
   iree_atomic_int32_t state;
 
+  // Set when tasks are posted to a mailbox of a priority class above
+  // IREE_TASK_PRIORITY_CLASS_NORMAL and cleared when the worker flushes them.
+  // Normal priority dispatch shards check this between tile reservations and
+  // yield so that the urgent work runs before the rest of the grid.
+  // LAYOUT: written by posters along with mailbox_slists.
+  iree_atomic_int32_t yield_requested;
+
   // Notification signaled when the worker should wake (if it is idle).
   // LAYOUT: next to state for similar access patterns; when posting other
-  //         threads will touch mailbox_slist and then send a wake
+  //         threads will touch mailbox_slists and then send a wake
   //         notification.
   iree_notification_t wake_notification;
 
@@ -99,6 +110,10 @@ typedef struct iree_task_worker_t {
   // all share the same L3 cache.
   iree_task_affinity_set_t constructive_sharing_mask;
 
+  // A bitmask of other workers on the same NUMA node. Work is stolen from
+  // these before crossing to workers on remote nodes.
+  iree_task_affinity_set_t node_sharing_mask;
+
   // Maximum number of attempts to make when trying to steal tasks from other
   // workers. This could be 64 (try stealing from all workers) or just a handful
   // (try stealing from these 3 other cores that share your L3 cache).
@@ -121,6 +136,15 @@ typedef struct iree_task_worker_t {
   // An opaque tag used to reduce the cost of processor ID queries.
   iree_cpu_processor_tag_t processor_tag;
 
+  // Idle telemetry written by the worker thread as it runs out of work and
+  // aggregated by iree_task_executor_query_idle_statistics.
+  // Number of times new work arrived while spinning.
+  iree_atomic_int64_t spin_wake_count;
+  // Number of times the worker parked itself in the kernel.
+  iree_atomic_int64_t park_count;
+  // Total time spent spinning, including spins that ended in a park.
+  iree_atomic_int64_t spin_ns;
+
   // Destructive interference padding between the mailbox and local task queue
   // to ensure that the worker - who is pounding on local_task_queue - doesn't
   // contend with submissions or coordinators dropping new tasks in the mailbox.
@@ -135,33 +159,44 @@ typedef struct iree_task_worker_t {
 
   // Pointer to local memory available for use exclusively by the worker.
   // The base address should be aligned to avoid false sharing with other
-  // workers.
+  // workers. Initially the reservation made by the executor and replaced with
+  // grown_local_memory if a dispatch requires more.
   iree_byte_span_t local_memory;
 
+  // Local memory allocated by the worker when growing beyond the executor
+  // reservation, or NULL if not yet grown. Owned by the worker.
+  void* grown_local_memory;
+
   // Worker-local FIFO queue containing the tasks that will be processed by the
   // worker. This queue supports work-stealing by other workers if they run out
   // of work of their own.
-  // LAYOUT: must be 64b away from mailbox_slist.
+  // LAYOUT: must be 64b away from mailbox_slists.
   iree_task_queue_t local_task_queue;
 } iree_task_worker_t;
-static_assert(offsetof(iree_task_worker_t, mailbox_slist) +
-                      sizeof(iree_atomic_task_slist_t) <
+static_assert(offsetof(iree_task_worker_t, mailbox_slists) +
+                      sizeof(iree_atomic_task_slist_t) *
+                          IREE_TASK_PRIORITY_CLASS_COUNT <
                   iree_hardware_constructive_interference_size,
-              "mailbox_slist must be in the first cache line");
+              "mailbox_slists must be in the first cache line");
 static_assert(offsetof(iree_task_worker_t, local_task_queue) >=
                   iree_hardware_constructive_interference_size,
-              "local_task_queue must be separated from mailbox_slist by "
+              "local_task_queue must be separated from mailbox_slists by "
               "at least a cache line");
 
 // Initializes a worker by creating its thread and configuring it for receiving
 // tasks. Where supported the worker will be created in a suspended state so
 // that we aren't creating a thundering herd on startup:
 // https://en.wikipedia.org/wiki/Thundering_herd_problem
+//
+// |local_memory| is zeroed by the worker thread itself once it is running with
+// its ideal affinity so that (with first-touch page placement) it is backed by
+// memory on the worker's NUMA node.
 iree_status_t iree_task_worker_initialize(
     iree_task_executor_t* executor, iree_host_size_t worker_index,
     const iree_task_topology_group_t* topology_group,
-    iree_host_size_t stack_size, iree_byte_span_t local_memory,
-    iree_prng_splitmix64_state_t* seed_prng, iree_task_worker_t* out_worker);
+    iree_task_affinity_set_t node_sharing_mask, iree_host_size_t stack_size,
+    iree_byte_span_t local_memory, iree_prng_splitmix64_state_t* seed_prng,
+    iree_task_worker_t* out_worker);
 
 // Requests that the worker begin exiting (if it hasn't already).
 // If the worker is actively processing tasks it will wait until it has
@@ -184,18 +219,20 @@ void iree_task_worker_await_exit(iree_task_worker_t* worker);
 //  - deinitialize all workers
 void iree_task_worker_deinitialize(iree_task_worker_t* worker);
 
-// Posts a FIFO list of tasks to the worker mailbox. The target worker takes
-// ownership of the tasks and will be woken if it is currently idle.
+// Posts a FIFO list of tasks to the worker mailbox of |priority_class|. The
+// target worker takes ownership of the tasks and will be woken if it is
+// currently idle.
 //
 // May be called from any thread (including the worker thread).
 void iree_task_worker_post_tasks(iree_task_worker_t* worker,
+                                 iree_task_priority_class_t priority_class,
                                  iree_task_list_t* list);
 
 // Tries to steal up to |max_tasks| from the back of the queue.
 // Returns NULL if no tasks are available and otherwise up to |max_tasks| tasks
 // that were at the tail of the worker FIFO will be moved to the |target_queue|
-// and the first of the stolen tasks is returned. While tasks from the FIFO
-// are preferred this may also steal tasks from the mailbox.
+// and the next task in the |target_queue| is returned. While tasks from the
+// FIFO are preferred this may also steal tasks from the mailboxes.
 iree_task_t* iree_task_worker_try_steal_task(iree_task_worker_t* worker,
                                              iree_task_queue_t* target_queue,
                                              iree_host_size_t max_tasks);
@@ -14,11 +14,14 @@
 #include "iree/base/internal/flags.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/local/loaders/registration/init.h"
+#include "iree/io/parameter_archive.h"
 #include "iree/modules/hal/inline/module.h"
 #include "iree/modules/hal/loader/module.h"
 #include "iree/modules/hal/module.h"
+#include "iree/modules/io/parameters/module.h"
 #include "iree/tooling/device_util.h"
 #include "iree/vm/bytecode_module.h"
+#include "iree/vm/dynamic/module.h"
 
 #if defined(IREE_HAVE_VMVX_MODULE)
 #include "iree/modules/vmvx/module.h"
@@ -33,7 +36,15 @@
 // support multiple types of dynamically loadable modules (lua/etc) we could
 // also allow mixes and use file ID snooping to choose a loader.
 IREE_FLAG(string, module, "-",
-          "File containing the module to load. Defaults to stdin (`-`).");
+          "File containing the module to load. Defaults to stdin (`-`).\n"
+          "Shared libraries (.so/.dylib/.dll) are loaded as natively compiled\n"
+          "dynamic modules (see iree/vm/dynamic/module.h).");
+IREE_FLAG(bool, module_mmap, true,
+          "Maps the module file into memory instead of reading it so that\n"
+          "embedded constants are paged in as devices upload them.");
+IREE_FLAG(bool, module_direct_io, false,
+          "When not mapping the module file, reads it with direct I/O\n"
+          "(bypassing the page cache) where supported.");
 
 iree_status_t iree_tooling_load_module_from_flags(
     iree_vm_instance_t* instance, iree_allocator_t host_allocator,
@@ -44,9 +55,20 @@ iree_status_t iree_tooling_load_module_from_flags(
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_TEXT(z0, FLAG_module);
 
-  // Fetch the file contents into memory.
-  // We could map the memory here if we wanted to and were coming from a file
-  // on disk.
+  // Natively compiled modules (such as EmitC modules built as shared
+  // libraries) are loaded directly instead of being interpreted.
+  if (iree_vm_dynamic_module_is_library_path(
+          iree_make_cstring_view(FLAG_module))) {
+    iree_status_t status = iree_vm_dynamic_module_load_from_file(
+        instance, iree_make_cstring_view(FLAG_module), iree_string_view_empty(),
+        /*param_count=*/0, /*params=*/NULL, host_allocator, out_module);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  // Fetch the file contents into memory. Files on disk are mapped so that
+  // large modules don't need a host copy of their rodata on top of the device
+  // copies made from it.
   iree_file_contents_t* file_contents = NULL;
   if (strcmp(FLAG_module, "-") == 0) {
     // Reading from stdin. We print it out here because people often get
@@ -54,10 +76,21 @@ iree_status_t iree_tooling_load_module_from_flags(
     fprintf(stderr, "Reading module contents from stdin...\n");
     IREE_RETURN_AND_END_ZONE_IF_ERROR(
         z0, iree_stdin_read_contents(host_allocator, &file_contents));
-  } else {
+  } else if (FLAG_module_mmap) {
     IREE_RETURN_AND_END_ZONE_IF_ERROR(
         z0,
-        iree_file_read_contents(FLAG_module, host_allocator, &file_contents));
+        iree_file_map_contents(FLAG_module, host_allocator, &file_contents));
+  } else {
+    // Reads are issued in parallel chunks so that large modules saturate
+    // storage bandwidth.
+    iree_file_read_params_t read_params;
+    iree_file_read_params_initialize(&read_params);
+    if (FLAG_module_direct_io) {
+      read_params.flags |= IREE_FILE_READ_FLAG_DIRECT;
+    }
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_file_read_contents_parallel(FLAG_module, &read_params,
+                                             host_allocator, &file_contents));
   }
 
   // Try to load the module as bytecode (all we have today that we can use).
@@ -235,6 +268,71 @@ static iree_status_t iree_tooling_load_hal_loader_module(
   return status;
 }
 
+IREE_FLAG_LIST(
+    string, parameters,
+    "Parameter archive files (.irpa) providing externalized module\n"
+    "parameters. Archives are memory mapped and searched in the order\n"
+    "specified.");
+
+static iree_status_t iree_tooling_load_io_parameters_module(
+    iree_vm_instance_t* instance, iree_allocator_t host_allocator,
+    iree_vm_module_t** out_module) {
+  IREE_ASSERT_ARGUMENT(instance);
+  IREE_ASSERT_ARGUMENT(out_module);
+  *out_module = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  const iree_flag_string_list_t paths = FLAG_parameters_list();
+  iree_io_parameter_archive_t** archives = NULL;
+  if (paths.count > 0) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_allocator_malloc(host_allocator,
+                                  paths.count * sizeof(*archives),
+                                  (void**)&archives));
+    memset(archives, 0, paths.count * sizeof(*archives));
+  }
+
+  // Open (map) each archive; parameter data is paged in on first use.
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < paths.count; ++i) {
+    char path[2048];
+    if (paths.values[i].size >= sizeof(path)) {
+      status = iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                                "parameter archive path too long");
+      break;
+    }
+    memcpy(path, paths.values[i].data, paths.values[i].size);
+    path[paths.values[i].size] = 0;
+    status =
+        iree_io_parameter_archive_open_file(path, host_allocator, &archives[i]);
+    if (!iree_status_is_ok(status)) {
+      status = iree_status_annotate_f(status, "opening parameter archive '%s'",
+                                      path);
+      break;
+    }
+  }
+
+  // Create the module; it retains the archives for its lifetime.
+  iree_vm_module_t* module = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_io_parameters_module_create(instance, paths.count, archives,
+                                              host_allocator, &module);
+  }
+
+  for (iree_host_size_t i = 0; i < paths.count; ++i) {
+    if (archives[i]) iree_io_parameter_archive_release(archives[i]);
+  }
+  iree_allocator_free(host_allocator, archives);
+
+  if (iree_status_is_ok(status)) {
+    *out_module = module;
+  } else {
+    iree_vm_module_release(module);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 //===----------------------------------------------------------------------===//
 // Module management
 //===----------------------------------------------------------------------===//
@@ -322,6 +420,10 @@ static iree_status_t iree_tooling_resolve_module_dependency(
   } else if (iree_string_view_equal(dependency->name, IREE_SV("hal_loader"))) {
     IREE_RETURN_IF_ERROR(iree_tooling_load_hal_loader_module(
         state->instance, state->host_allocator, &module));
+  } else if (iree_string_view_equal(dependency->name,
+                                    IREE_SV("io_parameters"))) {
+    IREE_RETURN_IF_ERROR(iree_tooling_load_io_parameters_module(
+        state->instance, state->host_allocator, &module));
   } else if (iree_string_view_equal(dependency->name, IREE_SV("vmvx"))) {
     IREE_RETURN_IF_ERROR(iree_vmvx_module_create(
         state->instance, state->host_allocator, &module));
@@ -6,11 +6,18 @@
 
 #include "iree/tooling/device_util.h"
 
+#include <signal.h>
+#include <stdlib.h>
+
 #include "iree/base/internal/call_once.h"
 #include "iree/base/internal/flags.h"
+#include "iree/base/internal/flight_recorder.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/drivers/init.h"
+#include "iree/hal/utils/allocation_timeline.h"
+#include "iree/hal/utils/arena_allocator.h"
 #include "iree/hal/utils/caching_allocator.h"
+#include "iree/hal/utils/dispatch_statistics.h"
 
 //===----------------------------------------------------------------------===//
 // Shared driver registry
@@ -389,6 +396,7 @@ static iree_status_t iree_hal_parse_device_size(iree_string_view_t size_str,
 //
 // Expected form:
 //   heap_key=max_allocation_size;max_allocation_capacity;max_free_allocation_count
+//            [;size_class_count]
 // Example:
 //   device_local=1gib;1gib;8
 //   host_local=*;*;32
@@ -448,12 +456,15 @@ static iree_status_t iree_hal_configure_caching_allocator(
     iree_string_view_t max_allocation_size_str = iree_string_view_empty();
     iree_string_view_t max_allocation_capacity_str = iree_string_view_empty();
     iree_string_view_t max_free_allocation_count_str = iree_string_view_empty();
+    iree_string_view_t size_class_count_str = iree_string_view_empty();
     iree_string_view_split(pool_config, ';', &max_allocation_size_str,
                            &pool_config);
     iree_string_view_split(pool_config, ';', &max_allocation_capacity_str,
                            &pool_config);
     iree_string_view_split(pool_config, ';', &max_free_allocation_count_str,
                            &pool_config);
+    iree_string_view_split(pool_config, ';', &size_class_count_str,
+                           &pool_config);
     max_allocation_size_str = iree_string_view_trim(max_allocation_size_str);
     if (!iree_string_view_is_empty(max_allocation_size_str) &&
         !iree_string_view_equal(max_allocation_size_str, IREE_SV("*"))) {
@@ -485,12 +496,114 @@ static iree_status_t iree_hal_configure_caching_allocator(
       }
       pool_params->max_free_allocation_count = max_free_allocation_count;
     }
+    size_class_count_str = iree_string_view_trim(size_class_count_str);
+    if (!iree_string_view_is_empty(size_class_count_str) &&
+        !iree_string_view_equal(size_class_count_str, IREE_SV("*"))) {
+      uint32_t size_class_count = 0;
+      if (!iree_string_view_atoi_uint32(size_class_count_str,
+                                        &size_class_count)) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "invalid size class count '%.*s'",
+                                (int)size_class_count_str.size,
+                                size_class_count_str.data);
+      }
+      pool_params->size_class_count = size_class_count;
+    }
   } while (!iree_string_view_is_empty(config_pairs));
   return iree_hal_caching_allocator_create_with_pools(
       pool_count, pool_params_storage, base_allocator,
       iree_hal_allocator_host_allocator(base_allocator), out_wrapped_allocator);
 }
 
+// Configures a new arena allocator with the given key-value |config_pairs|.
+// When no |config_pairs| are provided the default arena parameters are used.
+// Sizes accept the same suffixes as iree_hal_parse_device_size.
+//
+// Expected form:
+//   slab_size=size,max_allocation_size=size,min_alignment=size
+// Example:
+//   slab_size=256mib,max_allocation_size=16mib
+static iree_status_t iree_hal_configure_arena_allocator(
+    iree_string_view_t config_pairs, iree_hal_device_t* device,
+    iree_hal_allocator_t* base_allocator,
+    iree_hal_allocator_t** out_wrapped_allocator) {
+  iree_hal_arena_allocator_params_t params;
+  iree_hal_arena_allocator_params_initialize(&params);
+  bool has_max_allocation_size = false;
+  while (!iree_string_view_is_empty(config_pairs)) {
+    // Pop the key=value config pair from the list.
+    iree_string_view_t config_pair = iree_string_view_empty();
+    iree_string_view_split(config_pairs, ',', &config_pair, &config_pairs);
+    iree_string_view_t key = iree_string_view_empty();
+    iree_string_view_t value = iree_string_view_empty();
+    iree_string_view_split(config_pair, '=', &key, &value);
+    key = iree_string_view_trim(key);
+    value = iree_string_view_trim(value);
+    if (iree_string_view_equal(key, IREE_SV("slab_size"))) {
+      IREE_RETURN_IF_ERROR(iree_hal_parse_device_size(value, &params.slab_size),
+                           "parsing slab_size");
+    } else if (iree_string_view_equal(key, IREE_SV("max_allocation_size"))) {
+      IREE_RETURN_IF_ERROR(
+          iree_hal_parse_device_size(value, &params.max_allocation_size),
+          "parsing max_allocation_size");
+      has_max_allocation_size = true;
+    } else if (iree_string_view_equal(key, IREE_SV("min_alignment"))) {
+      IREE_RETURN_IF_ERROR(
+          iree_hal_parse_device_size(value, &params.min_alignment),
+          "parsing min_alignment");
+    } else {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "unrecognized arena allocator key '%.*s'",
+                              (int)key.size, key.data);
+    }
+  }
+  // Default to allowing any allocation that fits in the slab.
+  if (!has_max_allocation_size) params.max_allocation_size = params.slab_size;
+  return iree_hal_arena_allocator_create(
+      &params, base_allocator,
+      iree_hal_allocator_host_allocator(base_allocator), out_wrapped_allocator);
+}
+
+// Configures a new allocation timeline allocator with the given key-value
+// |config_pairs|. The timeline is written as Chrome trace JSON to the given
+// file when the device allocator is destroyed.
+//
+// Expected form:
+//   file=path
+// Example:
+//   file=/tmp/allocations.json
+static iree_status_t iree_hal_configure_allocation_timeline(
+    iree_string_view_t config_pairs, iree_hal_device_t* device,
+    iree_hal_allocator_t* base_allocator,
+    iree_hal_allocator_t** out_wrapped_allocator) {
+  iree_hal_allocation_timeline_params_t params;
+  iree_hal_allocation_timeline_params_initialize(&params);
+  while (!iree_string_view_is_empty(config_pairs)) {
+    // Pop the key=value config pair from the list.
+    iree_string_view_t config_pair = iree_string_view_empty();
+    iree_string_view_split(config_pairs, ',', &config_pair, &config_pairs);
+    iree_string_view_t key = iree_string_view_empty();
+    iree_string_view_t value = iree_string_view_empty();
+    iree_string_view_split(config_pair, '=', &key, &value);
+    key = iree_string_view_trim(key);
+    value = iree_string_view_trim(value);
+    if (iree_string_view_equal(key, IREE_SV("file"))) {
+      params.file_path = value;
+    } else {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "unrecognized timeline allocator key '%.*s'",
+                              (int)key.size, key.data);
+    }
+  }
+  if (iree_string_view_is_empty(params.file_path)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "timeline allocator requires a file= path");
+  }
+  return iree_hal_allocation_timeline_allocator_create(
+      &params, base_allocator,
+      iree_hal_allocator_host_allocator(base_allocator), out_wrapped_allocator);
+}
+
 // Parses a single flag and wraps |base_allocator|.
 // Flag values are specifications and may include configuration values.
 // Examples:
@@ -508,6 +621,12 @@ static iree_status_t iree_hal_configure_allocator_from_spec(
   if (iree_string_view_equal(allocator_name, IREE_SV("caching"))) {
     status = iree_hal_configure_caching_allocator(
         config_pairs, device, base_allocator, out_wrapped_allocator);
+  } else if (iree_string_view_equal(allocator_name, IREE_SV("arena"))) {
+    status = iree_hal_configure_arena_allocator(
+        config_pairs, device, base_allocator, out_wrapped_allocator);
+  } else if (iree_string_view_equal(allocator_name, IREE_SV("timeline"))) {
+    status = iree_hal_configure_allocation_timeline(
+        config_pairs, device, base_allocator, out_wrapped_allocator);
   } else {
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "unrecognized allocator '%.*s'",
@@ -567,6 +686,49 @@ IREE_FLAG_LIST(
     "Use --list_devices/--dump_devices to see available devices and their\n"
     "canonical URI used with this flag.");
 
+IREE_FLAG(
+    bool, print_dispatch_statistics, false,
+    "Times each dispatch and prints a table of per-executable export timings\n"
+    "to stderr at exit. Dispatches are serialized and end-to-end timings are\n"
+    "not representative when enabled.");
+
+IREE_FLAG(
+    int32_t, flight_recorder_events, 0,
+    "Records the most recent N queue submissions, semaphore waits, and\n"
+    "dispatches in a low-overhead ring buffer. 0 disables recording.");
+IREE_FLAG(
+    string, flight_recorder_file, "",
+    "File the flight recorder events are written to as Chrome trace JSON at\n"
+    "exit and (on POSIX platforms) each time the process receives SIGUSR1.");
+
+static void iree_hal_flight_recorder_dump_at_exit(void) {
+  iree_status_t status =
+      iree_flight_recorder_dump_to_file(FLAG_flight_recorder_file);
+  if (!iree_status_is_ok(status)) {
+    iree_status_fprint(stderr, status);
+    iree_status_free(status);
+  }
+}
+
+static iree_status_t iree_hal_configure_flight_recorder_from_flags(void) {
+  if (FLAG_flight_recorder_events <= 0) return iree_ok_status();
+  IREE_RETURN_IF_ERROR(iree_flight_recorder_enable(
+      (iree_host_size_t)FLAG_flight_recorder_events));
+  if (strlen(FLAG_flight_recorder_file) == 0) return iree_ok_status();
+
+  // Devices may be created more than once per process but the dump hooks must
+  // only be installed once.
+  static bool installed = false;
+  if (installed) return iree_ok_status();
+  installed = true;
+#if defined(SIGUSR1)
+  IREE_RETURN_IF_ERROR(iree_flight_recorder_install_signal_handler(
+      SIGUSR1, FLAG_flight_recorder_file));
+#endif  // SIGUSR1
+  atexit(iree_hal_flight_recorder_dump_at_exit);
+  return iree_ok_status();
+}
+
 // TODO(#5724): remove this and replace with an iree_hal_device_set_t.
 void iree_hal_get_devices_flag_list(iree_host_size_t* out_count,
                                     const iree_string_view_t** out_list) {
@@ -600,6 +762,11 @@ iree_status_t iree_hal_create_device_from_flags(
 
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  // Start recording before the device exists so its first submissions are
+  // captured.
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_configure_flight_recorder_from_flags());
+
   // Create the device, which may be slow and dynamically load big dependencies
   // (CUDA, Vulkan, etc).
   iree_hal_device_t* device = NULL;
@@ -613,6 +780,18 @@ iree_status_t iree_hal_create_device_from_flags(
   // more easily break the rules.
   iree_status_t status = iree_hal_configure_allocator_from_flags(device);
 
+  // Optionally interpose on the device to time each dispatch. This must be
+  // the outermost device so that all command buffers are routed through it.
+  if (iree_status_is_ok(status) && FLAG_print_dispatch_statistics) {
+    iree_hal_device_t* statistics_device = NULL;
+    status = iree_hal_dispatch_statistics_device_create(
+        device, host_allocator, &statistics_device);
+    if (iree_status_is_ok(status)) {
+      iree_hal_device_release(device);
+      device = statistics_device;
+    }
+  }
+
   if (iree_status_is_ok(status)) {
     *out_device = device;
   } else {
@@ -668,3 +847,10 @@ iree_status_t iree_hal_end_profiling_from_flags(iree_hal_device_t* device) {
   if (strlen(FLAG_device_profiling_mode) == 0) return iree_ok_status();
   return iree_hal_device_profiling_end(device);
 }
+
+iree_status_t iree_hal_print_dispatch_statistics_from_flags(
+    FILE* file, iree_hal_device_t* device) {
+  if (!device || !FLAG_print_dispatch_statistics) return iree_ok_status();
+  if (!iree_hal_dispatch_statistics_device_isa(device)) return iree_ok_status();
+  return iree_hal_dispatch_statistics_device_fprint(file, device);
+}
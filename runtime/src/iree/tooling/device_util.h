@@ -7,6 +7,8 @@
 #ifndef IREE_TOOLING_DEVICE_UTIL_H_
 #define IREE_TOOLING_DEVICE_UTIL_H_
 
+#include <stdio.h>
+
 #include "iree/base/api.h"
 #include "iree/hal/api.h"
 
@@ -29,6 +31,8 @@ void iree_hal_get_devices_flag_list(iree_host_size_t* out_count,
 // Creates a single device from the --device= flag.
 // Uses the |default_device| if no flags were specified.
 // Fails if more than one device was specified.
+// The device is wrapped to collect per-dispatch timings if
+// --print_dispatch_statistics is set.
 iree_status_t iree_hal_create_device_from_flags(
     iree_string_view_t default_device, iree_allocator_t host_allocator,
     iree_hal_device_t** out_device);
@@ -42,6 +46,11 @@ iree_status_t iree_hal_begin_profiling_from_flags(iree_hal_device_t* device);
 // command line flags. No-op if profiling is not enabled.
 iree_status_t iree_hal_end_profiling_from_flags(iree_hal_device_t* device);
 
+// Prints the per-dispatch timing table collected by |device| to |file| when
+// --print_dispatch_statistics is set. No-op if statistics are not enabled.
+iree_status_t iree_hal_print_dispatch_statistics_from_flags(
+    FILE* file, iree_hal_device_t* device);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
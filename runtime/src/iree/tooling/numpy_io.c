@@ -6,8 +6,23 @@
 
 #include "iree/tooling/numpy_io.h"
 
+#include "iree/base/target_platform.h"
 #include "iree/base/tracing.h"
 
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_APPLE) || \
+    defined(IREE_PLATFORM_LINUX)
+#define IREE_NUMPY_NPY_MAP_ENABLE 1
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#define IREE_NUMPY_NPY_MAP_ENABLE 0
+#endif  // IREE_PLATFORM_*
+
+// Maximum number of bytes mapped from a HAL buffer at a time when saving.
+// Keeps the host footprint bounded for devices that stage mappings through
+// host memory and lets the OS start writing back pages while we continue.
+#define IREE_NUMPY_NPY_WRITE_CHUNK_SIZE (64 * 1024 * 1024)
+
 //===----------------------------------------------------------------------===//
 // .npy (multiple values concatenated)
 //===----------------------------------------------------------------------===//
@@ -136,6 +151,112 @@ static iree_status_t iree_numpy_npy_read_into_mapping(
   return iree_ok_status();
 }
 
+#if IREE_NUMPY_NPY_MAP_ENABLE
+
+// A file range mapped into the host process and imported into a HAL buffer.
+// Freed when the buffer is released.
+typedef struct {
+  iree_allocator_t host_allocator;
+  void* base;
+  size_t length;
+} iree_numpy_npy_mapping_t;
+
+static void iree_numpy_npy_mapping_release(void* user_data,
+                                           iree_hal_buffer_t* buffer) {
+  iree_numpy_npy_mapping_t* mapping = (iree_numpy_npy_mapping_t*)user_data;
+  munmap(mapping->base, mapping->length);
+  iree_allocator_free(mapping->host_allocator, mapping);
+}
+
+// Tries to map |byte_length| bytes of |stream| at the current position and
+// import them into a HAL buffer from |device_allocator|. The mapping is
+// private copy-on-write so programs writing into their inputs only fault in
+// (and copy) the pages they touch and never modify the file.
+//
+// Returns true and positions |stream| after the contents if |out_buffer| was
+// imported. Returns false if mapping is not possible (pipes, unaligned
+// contents, allocators that can't use host memory, etc) and the caller should
+// fall back to reading the contents; |stream| is left unchanged.
+static bool iree_numpy_npy_try_map_contents(
+    FILE* stream, iree_device_size_t byte_length,
+    iree_hal_buffer_params_t buffer_params,
+    iree_hal_allocator_t* device_allocator, iree_hal_buffer_t** out_buffer) {
+  *out_buffer = NULL;
+  if (byte_length == 0 || byte_length > SIZE_MAX) return false;
+  int fd = fileno(stream);
+  off_t data_offset = ftello(stream);
+  if (fd < 0 || data_offset < 0) return false;
+
+  // Imported host allocations must meet the alignment of heap buffers so that
+  // devices can use them the same as any other allocation. npy headers are
+  // padded to 64b so the first array in a file always qualifies but arrays
+  // following one with an odd length may not.
+  long page_size = sysconf(_SC_PAGESIZE);
+  if (page_size <= 0) return false;
+  if (data_offset % IREE_HAL_HEAP_BUFFER_ALIGNMENT != 0) return false;
+  off_t map_offset = data_offset - (data_offset % page_size);
+  size_t map_length = (size_t)(data_offset - map_offset) + (size_t)byte_length;
+
+  iree_allocator_t host_allocator =
+      iree_hal_allocator_host_allocator(device_allocator);
+  iree_numpy_npy_mapping_t* mapping = NULL;
+  if (!iree_status_is_ok(iree_allocator_malloc(
+          host_allocator, sizeof(*mapping), (void**)&mapping))) {
+    return false;
+  }
+  mapping->host_allocator = host_allocator;
+  mapping->length = map_length;
+  mapping->base = mmap(NULL, map_length, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                       fd, map_offset);
+  if (mapping->base == MAP_FAILED) {
+    iree_allocator_free(host_allocator, mapping);
+    return false;
+  }
+
+  iree_hal_external_buffer_t external_buffer = {
+      .type = IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION,
+      .flags = 0,
+      .size = byte_length,
+      .handle.host_allocation.ptr =
+          (uint8_t*)mapping->base + (data_offset - map_offset),
+  };
+  iree_hal_buffer_release_callback_t release_callback = {
+      .fn = iree_numpy_npy_mapping_release,
+      .user_data = mapping,
+  };
+  iree_hal_buffer_t* buffer = NULL;
+  iree_status_t status = iree_hal_allocator_import_buffer(
+      device_allocator, buffer_params, &external_buffer, release_callback,
+      &buffer);
+  if (!iree_status_is_ok(status)) {
+    iree_status_ignore(status);
+    iree_numpy_npy_mapping_release(mapping, NULL);
+    return false;
+  }
+
+  // Skip the stream past the contents we mapped.
+  if (fseeko(stream, data_offset + (off_t)byte_length, SEEK_SET) != 0) {
+    iree_hal_buffer_release(buffer);
+    fseeko(stream, data_offset, SEEK_SET);
+    return false;
+  }
+
+  *out_buffer = buffer;
+  return true;
+}
+
+#else
+
+static bool iree_numpy_npy_try_map_contents(
+    FILE* stream, iree_device_size_t byte_length,
+    iree_hal_buffer_params_t buffer_params,
+    iree_hal_allocator_t* device_allocator, iree_hal_buffer_t** out_buffer) {
+  *out_buffer = NULL;
+  return false;
+}
+
+#endif  // IREE_NUMPY_NPY_MAP_ENABLE
+
 // Scans for the next key: value pair in |dict|.
 // |dict| will be set to the remaining |dict| string after the key and value.
 static iree_status_t iree_numpy_consume_dict_key_value(
@@ -370,10 +491,30 @@ iree_numpy_npy_load_ndarray(FILE* stream, iree_numpy_npy_load_options_t options,
     if (!iree_status_is_ok(status)) break;
   }
 
+  // If requested try to map the file contents and use them directly. This
+  // avoids both the read and the additional host copy of the contents and lets
+  // the OS page in only what is used.
+  bool did_map = false;
+  if (iree_status_is_ok(status) &&
+      iree_all_bits_set(options, IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE)) {
+    iree_device_size_t byte_length = 0;
+    iree_hal_buffer_t* buffer = NULL;
+    if (iree_status_is_ok(iree_hal_buffer_compute_view_size(
+            shape_rank, shape, element_type, encoding_type, &byte_length)) &&
+        iree_numpy_npy_try_map_contents(stream, byte_length, buffer_params,
+                                        device_allocator, &buffer)) {
+      did_map = true;
+      status = iree_hal_buffer_view_create(buffer, shape_rank, shape,
+                                           element_type, encoding_type,
+                                           host_allocator, out_buffer_view);
+      iree_hal_buffer_release(buffer);
+    }
+  }
+
   // Allocate the buffer view and directly read into the allocated memory.
   // On targets where we can perform host mapping this will be zero-copy; on
   // others it'll at least be _somewhat_ efficient.
-  if (iree_status_is_ok(status)) {
+  if (iree_status_is_ok(status) && !did_map) {
     iree_numpy_npy_read_params_t read_params = {
         .stream = stream,
     };
@@ -577,24 +718,37 @@ static iree_status_t iree_numpy_npy_write_header(
 }
 
 // Writes |buffer_view| contents to |stream|.
+// Contents are mapped and written in chunks so that large buffers on devices
+// that stage mappings through host memory don't need a full host copy.
 static iree_status_t iree_numpy_npy_write_bytes(
     FILE* stream, iree_hal_buffer_view_t* buffer_view) {
   iree_hal_buffer_t* buffer = iree_hal_buffer_view_buffer(buffer_view);
   iree_device_size_t write_length =
       iree_hal_buffer_view_byte_length(buffer_view);
 
-  iree_hal_buffer_mapping_t mapping;
-  IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
-      buffer, IREE_HAL_MAPPING_MODE_SCOPED, IREE_HAL_MEMORY_ACCESS_READ, 0,
-      write_length, &mapping));
-
-  bool write_ok =
-      fwrite(mapping.contents.data, 1, write_length, stream) == write_length;
+  iree_status_t status = iree_ok_status();
+  for (iree_device_size_t offset = 0;
+       offset < write_length && iree_status_is_ok(status);) {
+    iree_device_size_t chunk_length =
+        iree_min(write_length - offset, IREE_NUMPY_NPY_WRITE_CHUNK_SIZE);
+
+    iree_hal_buffer_mapping_t mapping;
+    IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
+        buffer, IREE_HAL_MAPPING_MODE_SCOPED, IREE_HAL_MEMORY_ACCESS_READ,
+        offset, chunk_length, &mapping));
+
+    if (fwrite(mapping.contents.data, 1, mapping.contents.data_length,
+               stream) != mapping.contents.data_length) {
+      status = iree_make_status(IREE_STATUS_DATA_LOSS,
+                                "failed to write buffer contents at offset "
+                                "%" PRIdsz,
+                                offset);
+    }
 
-  IREE_RETURN_IF_ERROR(iree_hal_buffer_unmap_range(&mapping));
-  return write_ok ? iree_ok_status()
-                  : iree_make_status(IREE_STATUS_DATA_LOSS,
-                                     "failed to write buffer contents");
+    status = iree_status_join(status, iree_hal_buffer_unmap_range(&mapping));
+    offset += chunk_length;
+  }
+  return status;
 }
 
 IREE_API_EXPORT iree_status_t iree_numpy_npy_save_ndarray(
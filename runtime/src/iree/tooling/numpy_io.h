@@ -16,17 +16,18 @@
 // Pickled objects are not supported (similar to using `allow_pickle=False`) and
 // not all dtypes are supported.
 //
-// .npy and uncompressed .npz files can be mapped into host memory with
+// .npy files can be mapped into host memory with
 // IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE if the HAL device allocator
-// supports using such memory. On devices with discrete memory the contents will
-// be loaded into host memory and copied to the device.
+// supports importing such memory and the array contents are suitably aligned.
+// On devices with discrete memory the contents will be read directly into the
+// device buffer mapping. Saving streams buffer contents in fixed-size chunks so
+// that large outputs never need to be mapped all at once.
 //
 // This current implementation is very basic; in the future it'd be nice to
 // support an iree_io_stream_t to allow for externalizing the file access.
 //
-// NOTE: this implementation is optimized for code size and is not intended to
-// be used in performance-sensitive situations. If you are wanting to run
-// through thousands of arrays and GB of data then you're going to want
+// NOTE: this implementation is optimized for code size. If you are wanting to
+// run through thousands of arrays and GB of data then you're going to want
 // something more sophisticated (delay loading with async IO, etc).
 //
 // TODO(benvanik): conditionally enable compression when zlib is present. For
@@ -73,8 +74,11 @@ typedef uint32_t iree_numpy_npy_save_options_t;
 // in the npy file allocated from the given |device_allocator|.
 //
 // If IREE_NUMPY_NPY_LOAD_OPTION_MAP_FILE is set and the
-// |device_allocator| supports mapping then the file will be mapped into the
-// host process. Otherwise the file will be loaded into a new allocation.
+// |device_allocator| supports importing host allocations then the file will be
+// mapped into the host process copy-on-write and the mapping used directly as
+// the buffer storage. Otherwise (or if |stream| cannot be mapped or the
+// contents are not aligned to IREE_HAL_HEAP_BUFFER_ALIGNMENT) the contents
+// will be read into a new allocation.
 //
 // Upon return the |stream| will be positioned immediately following the
 // ndarray contents, which may be end-of-stream.
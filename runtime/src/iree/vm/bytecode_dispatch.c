@@ -45,6 +45,26 @@ static void iree_vm_bytecode_dispatch_remap_branch_registers(
   }
 }
 
+// Decodes the remainder of a vm.cond_br following its condition operand at
+// |pc|, remaps the registers of the taken edge, and returns the new pc.
+static inline iree_vm_source_offset_t iree_vm_bytecode_dispatch_cond_branch(
+    const uint8_t* IREE_RESTRICT bytecode_data, iree_vm_source_offset_t pc,
+    const iree_vm_registers_t regs, int32_t condition) {
+  int32_t true_block_pc = VM_DecBranchTarget("true_dest");
+  const iree_vm_register_remap_list_t* true_remap_list =
+      VM_DecBranchOperands("true_operands");
+  int32_t false_block_pc = VM_DecBranchTarget("false_dest");
+  const iree_vm_register_remap_list_t* false_remap_list =
+      VM_DecBranchOperands("false_operands");
+  if (condition) {
+    iree_vm_bytecode_dispatch_remap_branch_registers(regs, true_remap_list);
+    return true_block_pc;
+  } else {
+    iree_vm_bytecode_dispatch_remap_branch_registers(regs, false_remap_list);
+    return false_block_pc;
+  }
+}
+
 // Discards ref registers in the list if they are marked move.
 // This can be used to eagerly release resources we don't need and reduces
 // memory consumption if used effectively prior to yields/waits.
@@ -1582,11 +1602,38 @@ static iree_status_t iree_vm_bytecode_dispatch(
     // Comparison ops
     //===------------------------------------------------------------------===//
 
-    DISPATCH_OP_CORE_BINARY_I32(CmpEQI32, vm_cmp_eq_i32);
-    DISPATCH_OP_CORE_BINARY_I32(CmpNEI32, vm_cmp_ne_i32);
-    DISPATCH_OP_CORE_BINARY_I32(CmpLTI32S, vm_cmp_lt_i32s);
-    DISPATCH_OP_CORE_BINARY_I32(CmpLTI32U, vm_cmp_lt_i32u);
-    DISPATCH_OP_CORE_UNARY_I32(CmpNZI32, vm_cmp_nz_i32);
+    // Nearly all compares are consumed by a vm.cond_br immediately following
+    // them. When that is the case the branch is executed as part of the
+    // compare (a superinstruction) so that the pair only pays for a single
+    // dispatch. The result register is still written as other blocks may use
+    // it.
+#define DISPATCH_FUSED_COND_BRANCH(result)                       \
+  if (bytecode_data[pc] == IREE_VM_OP_CORE_CondBranch &&         \
+      &regs.i32[OP_I16(1) & regs.i32_mask] == (result)) {        \
+    IREE_DISPATCH_TRACE_INSTRUCTION(0, "CondBranch");            \
+    pc = iree_vm_bytecode_dispatch_cond_branch(                  \
+        bytecode_data, pc + 1 + kRegSize, regs, *(result));      \
+  }
+
+#define DISPATCH_OP_CORE_CMP_I32(op_name, op_func)  \
+  DISPATCH_OP(CORE, op_name, {                      \
+    int32_t lhs = VM_DecOperandRegI32("lhs");       \
+    int32_t rhs = VM_DecOperandRegI32("rhs");       \
+    int32_t* result = VM_DecResultRegI32("result"); \
+    *result = op_func(lhs, rhs);                    \
+    DISPATCH_FUSED_COND_BRANCH(result);             \
+  });
+
+    DISPATCH_OP_CORE_CMP_I32(CmpEQI32, vm_cmp_eq_i32);
+    DISPATCH_OP_CORE_CMP_I32(CmpNEI32, vm_cmp_ne_i32);
+    DISPATCH_OP_CORE_CMP_I32(CmpLTI32S, vm_cmp_lt_i32s);
+    DISPATCH_OP_CORE_CMP_I32(CmpLTI32U, vm_cmp_lt_i32u);
+    DISPATCH_OP(CORE, CmpNZI32, {
+      int32_t operand = VM_DecOperandRegI32("operand");
+      int32_t* result = VM_DecResultRegI32("result");
+      *result = vm_cmp_nz_i32(operand);
+      DISPATCH_FUSED_COND_BRANCH(result);
+    });
 
 #define DISPATCH_OP_CORE_CMP_I64(op_name, op_func)  \
   DISPATCH_OP(CORE, op_name, {                      \
@@ -1594,6 +1641,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
     int64_t rhs = VM_DecOperandRegI64("rhs");       \
     int32_t* result = VM_DecResultRegI32("result"); \
     *result = op_func(lhs, rhs);                    \
+    DISPATCH_FUSED_COND_BRANCH(result);             \
   });
 
     DISPATCH_OP_CORE_CMP_I64(CmpEQI64, vm_cmp_eq_i64);
@@ -1604,6 +1652,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
       int64_t operand = VM_DecOperandRegI64("operand");
       int32_t* result = VM_DecResultRegI32("result");
       *result = vm_cmp_nz_i64(operand);
+      DISPATCH_FUSED_COND_BRANCH(result);
     });
 
     DISPATCH_OP(CORE, CmpEQRef, {
@@ -1648,20 +1697,8 @@ static iree_status_t iree_vm_bytecode_dispatch(
 
     DISPATCH_OP(CORE, CondBranch, {
       int32_t condition = VM_DecOperandRegI32("condition");
-      int32_t true_block_pc = VM_DecBranchTarget("true_dest");
-      const iree_vm_register_remap_list_t* true_remap_list =
-          VM_DecBranchOperands("true_operands");
-      int32_t false_block_pc = VM_DecBranchTarget("false_dest");
-      const iree_vm_register_remap_list_t* false_remap_list =
-          VM_DecBranchOperands("false_operands");
-      if (condition) {
-        pc = true_block_pc;
-        iree_vm_bytecode_dispatch_remap_branch_registers(regs, true_remap_list);
-      } else {
-        pc = false_block_pc;
-        iree_vm_bytecode_dispatch_remap_branch_registers(regs,
-                                                         false_remap_list);
-      }
+      pc = iree_vm_bytecode_dispatch_cond_branch(bytecode_data, pc, regs,
+                                                 condition);
     });
 
     DISPATCH_OP(CORE, Call, {
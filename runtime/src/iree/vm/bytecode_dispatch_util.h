@@ -140,7 +140,7 @@ static inline const iree_vm_type_def_t* iree_vm_map_type(
 #define IREE_DISPATCH_TRACE_INSTRUCTION(...)
 #endif  // IREE_VM_EXECUTION_TRACING_ENABLE
 
-#if defined(IREE_COMPILER_CLANG) && \
+#if defined(IREE_COMPILER_GCC_COMPAT) && \
     IREE_VM_BYTECODE_DISPATCH_COMPUTED_GOTO_ENABLE
 #define IREE_DISPATCH_MODE_COMPUTED_GOTO 1
 #else
@@ -236,6 +236,57 @@ static iree_status_t iree_vm_bytecode_module_resolve_types(
   return status;
 }
 
+// Verifies the LZ4 block parameters of rodata segment |i| against the
+// |compressed_length| of its stored contents.
+static iree_status_t iree_vm_bytecode_module_verify_lz4_data(
+    iree_vm_LZ4DataDef_table_t lz4_def, uint64_t compressed_length,
+    size_t i) {
+  uint64_t uncompressed_length =
+      iree_vm_LZ4DataDef_uncompressed_length(lz4_def);
+  uint64_t block_length = iree_vm_LZ4DataDef_block_length(lz4_def);
+  if (uncompressed_length > IREE_HOST_SIZE_MAX) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "rodata[%zu] uncompressed length %" PRIu64
+                            " exceeds the host address space",
+                            i, uncompressed_length);
+  }
+  if (uncompressed_length > 0 && block_length == 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "rodata[%zu] LZ4 block length must be non-zero", i);
+  }
+  uint64_t block_count = 0;
+  if (block_length) {
+    block_count = uncompressed_length / block_length +
+                  (uncompressed_length % block_length ? 1 : 0);
+  }
+  flatbuffers_uint64_vec_t block_offsets =
+      iree_vm_LZ4DataDef_block_offsets(lz4_def);
+  if (flatbuffers_uint64_vec_len(block_offsets) != block_count + 1) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "rodata[%zu] expected %" PRIu64
+                            " LZ4 block offsets but has %zu",
+                            i, block_count + 1,
+                            flatbuffers_uint64_vec_len(block_offsets));
+  }
+  uint64_t last_offset = 0;
+  for (size_t j = 0; j <= block_count; ++j) {
+    uint64_t offset = flatbuffers_uint64_vec_at(block_offsets, j);
+    if (offset < last_offset || offset > compressed_length) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "rodata[%zu] LZ4 block offset %zu out of range",
+                              i, j);
+    }
+    last_offset = offset;
+  }
+  if (last_offset != compressed_length) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "rodata[%zu] LZ4 blocks do not cover the "
+                            "compressed data",
+                            i);
+  }
+  return iree_ok_status();
+}
+
 // Verifies the structure of the FlatBuffer so that we can avoid doing so during
 // runtime. There are still some conditions we must be aware of (such as omitted
 // names on functions with internal linkage), however we shouldn't need to
@@ -284,18 +335,38 @@ static iree_status_t iree_vm_bytecode_module_flatbuffer_verify(
        ++i) {
     iree_vm_RodataSegmentDef_table_t segment =
         iree_vm_RodataSegmentDef_vec_at(rodata_segments, i);
+    uint64_t segment_length = 0;
     if (iree_vm_RodataSegmentDef_embedded_data_is_present(segment)) {
-      continue;  // embedded data is verified by FlatBuffers
+      // Embedded data is verified by FlatBuffers.
+      segment_length = flatbuffers_uint8_vec_len(
+          iree_vm_RodataSegmentDef_embedded_data(segment));
+    } else {
+      uint64_t segment_offset =
+          iree_vm_RodataSegmentDef_external_data_offset(segment);
+      segment_length = iree_vm_RodataSegmentDef_external_data_length(segment);
+      uint64_t segment_end =
+          archive_rodata_offset + segment_offset + segment_length;
+      if (segment_end > archive_contents.data_length) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "rodata[%zu] external reference out of range",
+                                i);
+      }
     }
-    uint64_t segment_offset =
-        iree_vm_RodataSegmentDef_external_data_offset(segment);
-    uint64_t segment_length =
-        iree_vm_RodataSegmentDef_external_data_length(segment);
-    uint64_t segment_end =
-        archive_rodata_offset + segment_offset + segment_length;
-    if (segment_end > archive_contents.data_length) {
-      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                              "rodata[%zu] external reference out of range", i);
+    switch (iree_vm_RodataSegmentDef_compression_type_type(segment)) {
+      case iree_vm_CompressionTypeDef_NONE:
+      case iree_vm_CompressionTypeDef_UncompressedDataDef:
+        break;
+      case iree_vm_CompressionTypeDef_LZ4DataDef:
+        IREE_RETURN_IF_ERROR(iree_vm_bytecode_module_verify_lz4_data(
+            (iree_vm_LZ4DataDef_table_t)
+                iree_vm_RodataSegmentDef_compression_type(segment),
+            segment_length, i));
+        break;
+      default:
+        return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                                "rodata[%zu] has an unsupported compression "
+                                "type",
+                                i);
     }
   }
 
@@ -448,10 +519,216 @@ static iree_status_t iree_vm_bytecode_map_internal_ordinal(
   return iree_ok_status();
 }
 
+static iree_status_t iree_vm_bytecode_module_lz4_corrupt(void) {
+  return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                          "corrupt LZ4 block in compressed rodata");
+}
+
+// Decodes a single LZ4 block (without frame headers) from |source| into
+// |target|. The block must decompress to exactly the length of |target|.
+// https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+static iree_status_t iree_vm_bytecode_module_decompress_lz4_block(
+    iree_const_byte_span_t source, iree_byte_span_t target) {
+  const uint8_t* ip = source.data;
+  const uint8_t* ip_end = source.data + source.data_length;
+  uint8_t* op = target.data;
+  uint8_t* op_end = target.data + target.data_length;
+  while (ip < ip_end) {
+    const uint8_t token = *ip++;
+
+    // Literal run (possibly extended with 255-byte runs).
+    iree_host_size_t literal_length = token >> 4;
+    if (literal_length == 15) {
+      uint8_t extension = 0;
+      do {
+        if (ip >= ip_end) return iree_vm_bytecode_module_lz4_corrupt();
+        extension = *ip++;
+        literal_length += extension;
+      } while (extension == 255);
+    }
+    if (literal_length > (iree_host_size_t)(ip_end - ip) ||
+        literal_length > (iree_host_size_t)(op_end - op)) {
+      return iree_vm_bytecode_module_lz4_corrupt();
+    }
+    memcpy(op, ip, literal_length);
+    ip += literal_length;
+    op += literal_length;
+    if (ip == ip_end) break;  // last sequence has no match
+
+    // Match copy from earlier in the output (may overlap).
+    if (ip_end - ip < 2) return iree_vm_bytecode_module_lz4_corrupt();
+    const iree_host_size_t offset = (iree_host_size_t)ip[0] | (ip[1] << 8);
+    ip += 2;
+    if (offset == 0 || offset > (iree_host_size_t)(op - target.data)) {
+      return iree_vm_bytecode_module_lz4_corrupt();
+    }
+    iree_host_size_t match_length = (token & 0xF) + 4;
+    if ((token & 0xF) == 15) {
+      uint8_t extension = 0;
+      do {
+        if (ip >= ip_end) return iree_vm_bytecode_module_lz4_corrupt();
+        extension = *ip++;
+        match_length += extension;
+      } while (extension == 255);
+    }
+    if (match_length > (iree_host_size_t)(op_end - op)) {
+      return iree_vm_bytecode_module_lz4_corrupt();
+    }
+    const uint8_t* match = op - offset;
+    for (iree_host_size_t i = 0; i < match_length; ++i) op[i] = match[i];
+    op += match_length;
+  }
+  if (op != op_end) return iree_vm_bytecode_module_lz4_corrupt();
+  return iree_ok_status();
+}
+
+// Returns the contents of |segment| as stored in the module archive. These are
+// the compressed bytes if the segment is compressed.
+static iree_const_byte_span_t iree_vm_bytecode_module_rodata_segment_contents(
+    iree_vm_bytecode_module_t* module,
+    iree_vm_RodataSegmentDef_table_t segment) {
+  if (iree_vm_RodataSegmentDef_embedded_data_is_present(segment)) {
+    // Data is embedded in the FlatBuffer.
+    flatbuffers_uint8_vec_t embedded_data =
+        iree_vm_RodataSegmentDef_embedded_data(segment);
+    return iree_make_const_byte_span(embedded_data,
+                                     flatbuffers_uint8_vec_len(embedded_data));
+  }
+  // Data is concatenated with the FlatBuffer at some relative offset.
+  // Note that we've already verified the referenced range is in bounds.
+  return iree_make_const_byte_span(
+      module->archive_contents.data + module->archive_rodata_offset +
+          iree_vm_RodataSegmentDef_external_data_offset(segment),
+      iree_vm_RodataSegmentDef_external_data_length(segment));
+}
+
+// Decompresses an LZ4 rodata |segment| into a newly allocated |out_span|.
+// Blocks are independent and could be decoded concurrently; the VM has no
+// threading dependency so they are decoded in order here.
+static iree_status_t iree_vm_bytecode_module_decompress_lz4_segment(
+    iree_vm_bytecode_module_t* module,
+    iree_vm_RodataSegmentDef_table_t segment, iree_byte_span_t* out_span) {
+  iree_vm_LZ4DataDef_table_t lz4_def =
+      (iree_vm_LZ4DataDef_table_t)iree_vm_RodataSegmentDef_compression_type(
+          segment);
+  iree_host_size_t uncompressed_length =
+      (iree_host_size_t)iree_vm_LZ4DataDef_uncompressed_length(lz4_def);
+  iree_host_size_t block_length =
+      (iree_host_size_t)iree_vm_LZ4DataDef_block_length(lz4_def);
+  flatbuffers_uint64_vec_t block_offsets =
+      iree_vm_LZ4DataDef_block_offsets(lz4_def);
+  iree_const_byte_span_t contents =
+      iree_vm_bytecode_module_rodata_segment_contents(module, segment);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)uncompressed_length);
+
+  uint8_t* data = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc_aligned(
+              module->allocator, iree_max(1, uncompressed_length),
+              IREE_VM_ARCHIVE_SEGMENT_ALIGNMENT, 0, (void**)&data));
+
+  // Block offsets and counts were checked during verification.
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t j = 0;
+       j + 1 < flatbuffers_uint64_vec_len(block_offsets) &&
+       iree_status_is_ok(status);
+       ++j) {
+    iree_host_size_t source_offset =
+        (iree_host_size_t)flatbuffers_uint64_vec_at(block_offsets, j);
+    iree_host_size_t source_end =
+        (iree_host_size_t)flatbuffers_uint64_vec_at(block_offsets, j + 1);
+    iree_host_size_t target_offset = j * block_length;
+    status = iree_vm_bytecode_module_decompress_lz4_block(
+        iree_make_const_byte_span(contents.data + source_offset,
+                                  source_end - source_offset),
+        iree_make_byte_span(
+            data + target_offset,
+            iree_min(block_length, uncompressed_length - target_offset)));
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_span = iree_make_byte_span(data, uncompressed_length);
+  } else {
+    iree_allocator_free_aligned(module->allocator, data);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Releases all rodata segments decompressed by
+// iree_vm_bytecode_module_decompress_rodata.
+static void iree_vm_bytecode_module_free_rodata(
+    iree_vm_bytecode_module_t* module) {
+  if (!module->decompressed_rodata_spans) return;
+  for (iree_host_size_t i = 0; i < module->decompressed_rodata_count; ++i) {
+    if (module->decompressed_rodata_spans[i].data) {
+      iree_allocator_free_aligned(module->allocator,
+                                  module->decompressed_rodata_spans[i].data);
+    }
+  }
+  iree_allocator_free(module->allocator, module->decompressed_rodata_spans);
+  module->decompressed_rodata_spans = NULL;
+  module->decompressed_rodata_count = 0;
+}
+
+// Decompresses all compressed rodata segments into module-owned memory so that
+// they can be shared across all module states.
+static iree_status_t iree_vm_bytecode_module_decompress_rodata(
+    iree_vm_bytecode_module_t* module) {
+  iree_vm_RodataSegmentDef_vec_t rodata_segments =
+      iree_vm_BytecodeModuleDef_rodata_segments(module->def);
+  iree_host_size_t segment_count =
+      iree_vm_RodataSegmentDef_vec_len(rodata_segments);
+  bool any_compressed = false;
+  for (iree_host_size_t i = 0; i < segment_count; ++i) {
+    if (iree_vm_RodataSegmentDef_compression_type_type(
+            iree_vm_RodataSegmentDef_vec_at(rodata_segments, i)) ==
+        iree_vm_CompressionTypeDef_LZ4DataDef) {
+      any_compressed = true;
+      break;
+    }
+  }
+  if (!any_compressed) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(
+              module->allocator,
+              segment_count * sizeof(*module->decompressed_rodata_spans),
+              (void**)&module->decompressed_rodata_spans));
+  memset(module->decompressed_rodata_spans, 0,
+         segment_count * sizeof(*module->decompressed_rodata_spans));
+  module->decompressed_rodata_count = segment_count;
+
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < segment_count && iree_status_is_ok(status);
+       ++i) {
+    iree_vm_RodataSegmentDef_table_t segment =
+        iree_vm_RodataSegmentDef_vec_at(rodata_segments, i);
+    if (iree_vm_RodataSegmentDef_compression_type_type(segment) !=
+        iree_vm_CompressionTypeDef_LZ4DataDef) {
+      continue;
+    }
+    status = iree_vm_bytecode_module_decompress_lz4_segment(
+        module, segment, &module->decompressed_rodata_spans[i]);
+    if (!iree_status_is_ok(status)) {
+      status = iree_status_annotate_f(status,
+                                      "decompressing rodata[%" PRIhsz "]", i);
+    }
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_vm_bytecode_module_free_rodata(module);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 static void iree_vm_bytecode_module_destroy(void* self) {
   iree_vm_bytecode_module_t* module = (iree_vm_bytecode_module_t*)self;
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  iree_vm_bytecode_module_free_rodata(module);
   module->def = NULL;
   iree_allocator_free(module->archive_allocator,
                       (void*)module->archive_contents.data);
@@ -967,20 +1244,15 @@ static iree_status_t iree_vm_bytecode_module_alloc_state(
     iree_vm_RodataSegmentDef_table_t segment =
         iree_vm_RodataSegmentDef_vec_at(rodata_segments, i);
     iree_byte_span_t byte_span = iree_byte_span_empty();
-    if (iree_vm_RodataSegmentDef_embedded_data_is_present(segment)) {
-      // Data is embedded in the FlatBuffer.
-      byte_span = iree_make_byte_span(
-          (uint8_t*)iree_vm_RodataSegmentDef_embedded_data(segment),
-          flatbuffers_uint8_vec_len(
-              iree_vm_RodataSegmentDef_embedded_data(segment)));
+    if (module->decompressed_rodata_spans &&
+        module->decompressed_rodata_spans[i].data) {
+      // Data was decompressed into module memory when the module was loaded.
+      byte_span = module->decompressed_rodata_spans[i];
     } else {
-      // Data is concatenated with the FlatBuffer at some relative offset.
-      // Note that we've already verified the referenced range is in bounds.
-      byte_span = iree_make_byte_span(
-          (uint8_t*)module->archive_contents.data +
-              module->archive_rodata_offset +
-              iree_vm_RodataSegmentDef_external_data_offset(segment),
-          iree_vm_RodataSegmentDef_external_data_length(segment));
+      iree_const_byte_span_t contents =
+          iree_vm_bytecode_module_rodata_segment_contents(module, segment);
+      byte_span =
+          iree_make_byte_span((uint8_t*)contents.data, contents.data_length);
     }
     iree_vm_buffer_t* ref = &state->rodata_ref_table[i];
     iree_vm_buffer_initialize(IREE_VM_BUFFER_ACCESS_ORIGIN_MODULE, byte_span,
@@ -1188,6 +1460,16 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
     return resolve_status;
   }
 
+  module->decompressed_rodata_count = 0;
+  module->decompressed_rodata_spans = NULL;
+  iree_status_t decompress_status =
+      iree_vm_bytecode_module_decompress_rodata(module);
+  if (!iree_status_is_ok(decompress_status)) {
+    iree_allocator_free(allocator, module);
+    IREE_TRACE_ZONE_END(z0);
+    return decompress_status;
+  }
+
   iree_vm_module_initialize(&module->interface, module);
   module->interface.destroy = iree_vm_bytecode_module_destroy;
   module->interface.name = iree_vm_bytecode_module_name;
@@ -83,6 +83,12 @@ typedef struct iree_vm_bytecode_module_t {
   // Loaded FlatBuffer module pointing into the archive contents.
   iree_vm_BytecodeModuleDef_table_t def;
 
+  // Decompressed contents of compressed rodata segments indexed by segment
+  // ordinal. Entries for uncompressed segments are empty and the table is NULL
+  // if no segments are compressed.
+  iree_host_size_t decompressed_rodata_count;
+  iree_byte_span_t* decompressed_rodata_spans;
+
   // Type table mapping module type IDs to registered VM types.
   iree_host_size_t type_count;
   iree_vm_type_def_t type_table[];
@@ -0,0 +1,255 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/vm/dynamic/module.h"
+
+#include <string.h>
+
+#include "iree/base/internal/dynamic_library.h"
+#include "iree/base/tracing.h"
+
+//===----------------------------------------------------------------------===//
+// iree_vm_dynamic_module_t
+//===----------------------------------------------------------------------===//
+
+// Wraps a module created by a dynamic library and keeps the library loaded
+// until the module is destroyed. All calls are forwarded to the user module
+// but functions are reported as belonging to the wrapper so that module state
+// resolution in contexts (which only know about the wrapper) works.
+typedef struct iree_vm_dynamic_module_t {
+  iree_vm_module_t interface;
+  iree_allocator_t host_allocator;
+  iree_dynamic_library_t* library;
+  iree_vm_module_t* user_module;
+} iree_vm_dynamic_module_t;
+
+static void IREE_API_PTR iree_vm_dynamic_module_destroy(void* self) {
+  iree_vm_dynamic_module_t* module = (iree_vm_dynamic_module_t*)self;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // The user module must be destroyed before its code is unloaded.
+  iree_vm_module_release(module->user_module);
+  iree_dynamic_library_release(module->library);
+  iree_allocator_free(module->host_allocator, module);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static iree_string_view_t IREE_API_PTR iree_vm_dynamic_module_name(void* self) {
+  iree_vm_dynamic_module_t* module = (iree_vm_dynamic_module_t*)self;
+  return iree_vm_module_name(module->user_module);
+}
+
+static iree_vm_module_signature_t IREE_API_PTR
+iree_vm_dynamic_module_signature(void* self) {
+  iree_vm_dynamic_module_t* module = (iree_vm_dynamic_module_t*)self;
+  return iree_vm_module_signature(module->user_module);
+}
+
+static iree_status_t IREE_API_PTR iree_vm_dynamic_module_get_module_attr(
+    void* self, iree_host_size_t index, iree_string_pair_t* out_attr) {
+  iree_vm_dynamic_module_t* module = (iree_vm_dynamic_module_t*)self;
+  if (!module->user_module->get_module_attr) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "module has no reflection attributes");
+  }
+  return module->user_module->get_module_attr(module->user_module->self, index,
+                                              out_attr);
+}
+
+static iree_status_t IREE_API_PTR iree_vm_dynamic_module_enumerate_dependencies(
+    void* self, iree_vm_module_dependency_callback_t callback,
+    void* user_data) {
+  iree_vm_dynamic_module_t* module = (iree_vm_dynamic_module_t*)self;
+  if (!module->user_module->enumerate_dependencies) return iree_ok_status();
+  return module->user_module->enumerate_dependencies(module->user_module->self,
+                                                     callback, user_data);
+}
+
+static iree_status_t IREE_API_PTR iree_vm_dynamic_module_lookup_function(
+    void* self, iree_vm_function_linkage_t linkage, iree_string_view_t name,
+    iree_vm_function_t* out_function) {
+  iree_vm_dynamic_module_t* module = (iree_vm_dynamic_module_t*)self;
+  IREE_RETURN_IF_ERROR(module->user_module->lookup_function(
+      module->user_module->self, linkage, name, out_function));
+  out_function->module = &module->interface;
+  return iree_ok_status();
+}
+
+static iree_status_t IREE_API_PTR iree_vm_dynamic_module_get_function(
+    void* self, iree_vm_function_linkage_t linkage, iree_host_size_t ordinal,
+    iree_vm_function_t* out_function, iree_string_view_t* out_name,
+    iree_vm_function_signature_t* out_signature) {
+  iree_vm_dynamic_module_t* module = (iree_vm_dynamic_module_t*)self;
+  IREE_RETURN_IF_ERROR(module->user_module->get_function(
+      module->user_module->self, linkage, ordinal, out_function, out_name,
+      out_signature));
+  if (out_function) out_function->module = &module->interface;
+  return iree_ok_status();
+}
+
+static iree_status_t IREE_API_PTR iree_vm_dynamic_module_get_function_attr(
+    void* self, iree_vm_function_linkage_t linkage, iree_host_size_t ordinal,
+    iree_host_size_t index, iree_string_pair_t* out_attr) {
+  iree_vm_dynamic_module_t* module = (iree_vm_dynamic_module_t*)self;
+  if (!module->user_module->get_function_attr) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "module has no function reflection attributes");
+  }
+  return module->user_module->get_function_attr(
+      module->user_module->self, linkage, ordinal, index, out_attr);
+}
+
+static iree_status_t IREE_API_PTR
+iree_vm_dynamic_module_resolve_source_location(
+    void* self, iree_vm_stack_frame_t* frame,
+    iree_vm_source_location_t* out_source_location) {
+  iree_vm_dynamic_module_t* module = (iree_vm_dynamic_module_t*)self;
+  if (!module->user_module->resolve_source_location) {
+    return iree_status_from_code(IREE_STATUS_UNAVAILABLE);
+  }
+  return module->user_module->resolve_source_location(
+      module->user_module->self, frame, out_source_location);
+}
+
+static iree_status_t IREE_API_PTR iree_vm_dynamic_module_alloc_state(
+    void* self, iree_allocator_t allocator,
+    iree_vm_module_state_t** out_module_state) {
+  iree_vm_dynamic_module_t* module = (iree_vm_dynamic_module_t*)self;
+  return module->user_module->alloc_state(module->user_module->self, allocator,
+                                          out_module_state);
+}
+
+static void IREE_API_PTR iree_vm_dynamic_module_free_state(
+    void* self, iree_vm_module_state_t* module_state) {
+  iree_vm_dynamic_module_t* module = (iree_vm_dynamic_module_t*)self;
+  module->user_module->free_state(module->user_module->self, module_state);
+}
+
+static iree_status_t IREE_API_PTR iree_vm_dynamic_module_resolve_import(
+    void* self, iree_vm_module_state_t* module_state, iree_host_size_t ordinal,
+    const iree_vm_function_t* function,
+    const iree_vm_function_signature_t* signature) {
+  iree_vm_dynamic_module_t* module = (iree_vm_dynamic_module_t*)self;
+  return module->user_module->resolve_import(
+      module->user_module->self, module_state, ordinal, function, signature);
+}
+
+static iree_status_t IREE_API_PTR iree_vm_dynamic_module_notify(
+    void* self, iree_vm_module_state_t* module_state, iree_vm_signal_t signal) {
+  iree_vm_dynamic_module_t* module = (iree_vm_dynamic_module_t*)self;
+  if (!module->user_module->notify) return iree_ok_status();
+  return module->user_module->notify(module->user_module->self, module_state,
+                                     signal);
+}
+
+static iree_status_t IREE_API_PTR iree_vm_dynamic_module_begin_call(
+    void* self, iree_vm_stack_t* stack, iree_vm_function_call_t call) {
+  iree_vm_dynamic_module_t* module = (iree_vm_dynamic_module_t*)self;
+  return module->user_module->begin_call(module->user_module->self, stack,
+                                         call);
+}
+
+static iree_status_t IREE_API_PTR iree_vm_dynamic_module_resume_call(
+    void* self, iree_vm_stack_t* stack, iree_byte_span_t call_results) {
+  iree_vm_dynamic_module_t* module = (iree_vm_dynamic_module_t*)self;
+  return module->user_module->resume_call(module->user_module->self, stack,
+                                          call_results);
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_dynamic_module_load_from_file(
+    iree_vm_instance_t* instance, iree_string_view_t path,
+    iree_string_view_t export_name, iree_host_size_t param_count,
+    const iree_string_pair_t* params, iree_allocator_t host_allocator,
+    iree_vm_module_t** out_module) {
+  IREE_ASSERT_ARGUMENT(instance);
+  IREE_ASSERT_ARGUMENT(!param_count || params);
+  IREE_ASSERT_ARGUMENT(out_module);
+  *out_module = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, path.data, path.size);
+
+  if (iree_string_view_is_empty(export_name)) {
+    export_name = iree_make_cstring_view(IREE_VM_DYNAMIC_MODULE_EXPORT_NAME);
+  }
+
+  // The dynamic library APIs require NUL-terminated strings.
+  char* path_str = (char*)iree_alloca(path.size + 1);
+  memcpy(path_str, path.data, path.size);
+  path_str[path.size] = 0;
+  char* export_name_str = (char*)iree_alloca(export_name.size + 1);
+  memcpy(export_name_str, export_name.data, export_name.size);
+  export_name_str[export_name.size] = 0;
+
+  iree_dynamic_library_t* library = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_dynamic_library_load_from_file(
+              path_str, IREE_DYNAMIC_LIBRARY_FLAG_NONE, host_allocator,
+              &library));
+
+  iree_vm_dynamic_module_create_fn_t create_fn = NULL;
+  iree_status_t status = iree_dynamic_library_lookup_symbol(
+      library, export_name_str, (void**)&create_fn);
+  if (!iree_status_is_ok(status)) {
+    status = iree_status_annotate_f(
+        status, "dynamic module library '%.*s' does not export '%s'",
+        (int)path.size, path.data, export_name_str);
+  }
+
+  iree_vm_module_t* user_module = NULL;
+  if (iree_status_is_ok(status)) {
+    status = create_fn(IREE_VM_DYNAMIC_MODULE_VERSION_LATEST, instance,
+                       param_count, params, host_allocator, &user_module);
+  }
+
+  iree_vm_dynamic_module_t* module = NULL;
+  if (iree_status_is_ok(status)) {
+    status =
+        iree_allocator_malloc(host_allocator, sizeof(*module), (void**)&module);
+  }
+  if (iree_status_is_ok(status)) {
+    module->host_allocator = host_allocator;
+    module->library = library;
+    module->user_module = user_module;
+    status = iree_vm_module_initialize(&module->interface, module);
+  }
+
+  if (iree_status_is_ok(status)) {
+    module->interface.destroy = iree_vm_dynamic_module_destroy;
+    module->interface.name = iree_vm_dynamic_module_name;
+    module->interface.signature = iree_vm_dynamic_module_signature;
+    module->interface.get_module_attr = iree_vm_dynamic_module_get_module_attr;
+    module->interface.enumerate_dependencies =
+        iree_vm_dynamic_module_enumerate_dependencies;
+    module->interface.lookup_function = iree_vm_dynamic_module_lookup_function;
+    module->interface.get_function = iree_vm_dynamic_module_get_function;
+    module->interface.get_function_attr =
+        iree_vm_dynamic_module_get_function_attr;
+    module->interface.resolve_source_location =
+        iree_vm_dynamic_module_resolve_source_location;
+    module->interface.alloc_state = iree_vm_dynamic_module_alloc_state;
+    module->interface.free_state = iree_vm_dynamic_module_free_state;
+    module->interface.resolve_import = iree_vm_dynamic_module_resolve_import;
+    module->interface.notify = iree_vm_dynamic_module_notify;
+    module->interface.begin_call = iree_vm_dynamic_module_begin_call;
+    module->interface.resume_call = iree_vm_dynamic_module_resume_call;
+    *out_module = &module->interface;
+  } else {
+    iree_allocator_free(host_allocator, module);
+    iree_vm_module_release(user_module);
+    iree_dynamic_library_release(library);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT bool iree_vm_dynamic_module_is_library_path(
+    iree_string_view_t path) {
+  return iree_string_view_ends_with(path, IREE_SV(".so")) ||
+         iree_string_view_ends_with(path, IREE_SV(".dylib")) ||
+         iree_string_view_ends_with(path, IREE_SV(".dll"));
+}
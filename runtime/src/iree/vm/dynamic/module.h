@@ -0,0 +1,87 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_VM_DYNAMIC_MODULE_H_
+#define IREE_VM_DYNAMIC_MODULE_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/vm/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// Dynamic module interface
+//===----------------------------------------------------------------------===//
+
+// Version of the dynamic module interface. Libraries receive the maximum
+// version the runtime supports and must fail creation if they require a newer
+// one.
+typedef uint32_t iree_vm_dynamic_module_version_t;
+
+#define IREE_VM_DYNAMIC_MODULE_VERSION_0 0u
+#define IREE_VM_DYNAMIC_MODULE_VERSION_LATEST IREE_VM_DYNAMIC_MODULE_VERSION_0
+
+// Default name of the exported module creation function.
+#define IREE_VM_DYNAMIC_MODULE_EXPORT_NAME "iree_vm_dynamic_module_create"
+
+// Creates a module from a dynamic library.
+// |params| are optional key-value pairs passed to the module for
+// configuration and are only valid for the duration of the call.
+//
+// Libraries export a function with this signature, usually wrapping the
+// `*_create` function of a module produced by the VM-to-EmitC conversion:
+//   IREE_VM_DYNAMIC_MODULE_EXPORT iree_status_t iree_vm_dynamic_module_create(
+//       iree_vm_dynamic_module_version_t max_version,
+//       iree_vm_instance_t* instance, iree_host_size_t param_count,
+//       const iree_string_pair_t* params, iree_allocator_t host_allocator,
+//       iree_vm_module_t** out_module) {
+//     return my_module_create(instance, host_allocator, out_module);
+//   }
+//
+// The library must be built against the same runtime version as the hosting
+// process as the module interface and the VM types are shared across the
+// boundary.
+typedef iree_status_t(IREE_API_PTR* iree_vm_dynamic_module_create_fn_t)(
+    iree_vm_dynamic_module_version_t max_version, iree_vm_instance_t* instance,
+    iree_host_size_t param_count, const iree_string_pair_t* params,
+    iree_allocator_t host_allocator, iree_vm_module_t** out_module);
+
+#if defined(_WIN32)
+#define IREE_VM_DYNAMIC_MODULE_EXPORT __declspec(dllexport)
+#else
+#define IREE_VM_DYNAMIC_MODULE_EXPORT __attribute__((visibility("default")))
+#endif  // _WIN32
+
+//===----------------------------------------------------------------------===//
+// Dynamic module loading
+//===----------------------------------------------------------------------===//
+
+// Loads a module from the dynamic library at |path|, such as an AOT-compiled
+// EmitC module built as a shared object. The library is kept loaded for as
+// long as the returned module is live.
+//
+// |export_name| is the name of the exported iree_vm_dynamic_module_create_fn_t
+// and defaults to IREE_VM_DYNAMIC_MODULE_EXPORT_NAME when empty.
+IREE_API_EXPORT iree_status_t iree_vm_dynamic_module_load_from_file(
+    iree_vm_instance_t* instance, iree_string_view_t path,
+    iree_string_view_t export_name, iree_host_size_t param_count,
+    const iree_string_pair_t* params, iree_allocator_t host_allocator,
+    iree_vm_module_t** out_module);
+
+// Returns true if |path| has a file extension used for dynamic libraries on
+// any platform (.so, .dylib, .dll).
+IREE_API_EXPORT bool iree_vm_dynamic_module_is_library_path(
+    iree_string_view_t path);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_VM_DYNAMIC_MODULE_H_
@@ -0,0 +1,176 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/vm/dynamic/module.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/file_io.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/api.h"
+#include "iree/vm/dynamic/module_test_library_embed.h"
+
+namespace iree {
+namespace {
+
+static const char* kUnknownName = "library_that_does_not_exist.so";
+
+class VMDynamicModuleTest : public ::testing::Test {
+ public:
+  static std::string GetTempFilename(const char* suffix) {
+    static int unique_id = 0;
+    char* test_tmpdir = getenv("TEST_TMPDIR");
+    if (!test_tmpdir) {
+      test_tmpdir = getenv("TMPDIR");
+    }
+    if (!test_tmpdir) {
+      test_tmpdir = getenv("TEMP");
+    }
+    if (!test_tmpdir) {
+      std::cerr << "TEST_TMPDIR/TMPDIR/TEMP not defined\n";
+      exit(1);
+    }
+    return test_tmpdir + std::string("/iree_test_") +
+           std::to_string(unique_id++) + suffix;
+  }
+
+  static void SetUpTestCase() {
+    // The test library is embedded with c_embed_data and written out to a
+    // temp file as the system loaders require a real file on disk.
+#if defined(IREE_PLATFORM_WINDOWS)
+    static constexpr const char* ext = ".dll";
+#else
+    static constexpr const char* ext = ".so";
+#endif
+    library_temp_path_ = GetTempFilename(ext);
+
+    const struct iree_file_toc_t* file_toc = module_test_library_create();
+    IREE_ASSERT_OK(iree_file_write_contents(
+        library_temp_path_.c_str(),
+        iree_make_const_byte_span(file_toc->data, file_toc->size)));
+  }
+
+ protected:
+  virtual void SetUp() {
+    IREE_ASSERT_OK(
+        iree_vm_instance_create(iree_allocator_system(), &instance_));
+  }
+
+  virtual void TearDown() { iree_vm_instance_release(instance_); }
+
+  iree_status_t LoadModule(iree_string_view_t export_name,
+                           iree_vm_module_t** out_module) {
+    return iree_vm_dynamic_module_load_from_file(
+        instance_, iree_make_cstring_view(library_temp_path_.c_str()),
+        export_name, /*param_count=*/0, /*params=*/NULL,
+        iree_allocator_system(), out_module);
+  }
+
+  static std::string library_temp_path_;
+  iree_vm_instance_t* instance_ = nullptr;
+};
+
+std::string VMDynamicModuleTest::library_temp_path_;
+
+TEST_F(VMDynamicModuleTest, LoadAndCall) {
+  iree_vm_module_t* module = NULL;
+  IREE_ASSERT_OK(LoadModule(iree_string_view_empty(), &module));
+  EXPECT_TRUE(iree_string_view_equal(iree_vm_module_name(module),
+                                     IREE_SV("dynamic_test")));
+
+  // Functions must report the wrapper as their module so that contexts, which
+  // only know about the wrapper, can resolve their state.
+  iree_vm_function_t function;
+  IREE_ASSERT_OK(iree_vm_module_lookup_function_by_name(
+      module, IREE_VM_FUNCTION_LINKAGE_EXPORT, IREE_SV("add_1"), &function));
+  EXPECT_EQ(module, function.module);
+
+  iree_vm_context_t* context = NULL;
+  IREE_ASSERT_OK(iree_vm_context_create_with_modules(
+      instance_, IREE_VM_CONTEXT_FLAG_NONE, 1, &module,
+      iree_allocator_system(), &context));
+
+  iree_vm_list_t* inputs = NULL;
+  IREE_ASSERT_OK(iree_vm_list_create(/*element_type=*/nullptr, 1,
+                                     iree_allocator_system(), &inputs));
+  iree_vm_value_t arg0 = iree_vm_value_make_i32(41);
+  IREE_ASSERT_OK(iree_vm_list_push_value(inputs, &arg0));
+  iree_vm_list_t* outputs = NULL;
+  IREE_ASSERT_OK(iree_vm_list_create(/*element_type=*/nullptr, 1,
+                                     iree_allocator_system(), &outputs));
+  IREE_ASSERT_OK(iree_vm_invoke(context, function,
+                                IREE_VM_INVOCATION_FLAG_NONE,
+                                /*policy=*/nullptr, inputs, outputs,
+                                iree_allocator_system()));
+  iree_vm_value_t ret0;
+  IREE_ASSERT_OK(iree_vm_list_get_value(outputs, 0, &ret0));
+  EXPECT_EQ(42, ret0.i32);
+
+  iree_vm_list_release(inputs);
+  iree_vm_list_release(outputs);
+  iree_vm_context_release(context);
+  iree_vm_module_release(module);
+}
+
+TEST_F(VMDynamicModuleTest, UnloadAndReload) {
+  // Releasing the last module reference unloads the library; loading it again
+  // must map a fresh copy.
+  iree_vm_module_t* module = NULL;
+  IREE_ASSERT_OK(LoadModule(iree_string_view_empty(), &module));
+  iree_vm_module_release(module);
+
+  module = NULL;
+  IREE_ASSERT_OK(LoadModule(
+      IREE_SV(IREE_VM_DYNAMIC_MODULE_EXPORT_NAME), &module));
+  EXPECT_TRUE(iree_string_view_equal(iree_vm_module_name(module),
+                                     IREE_SV("dynamic_test")));
+  iree_vm_module_release(module);
+}
+
+TEST_F(VMDynamicModuleTest, MissingLibrary) {
+  iree_vm_module_t* module = NULL;
+  iree_status_t status = iree_vm_dynamic_module_load_from_file(
+      instance_, iree_make_cstring_view(kUnknownName), iree_string_view_empty(),
+      /*param_count=*/0, /*params=*/NULL, iree_allocator_system(), &module);
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_NOT_FOUND, status);
+  iree_status_free(status);
+  EXPECT_EQ(nullptr, module);
+}
+
+TEST_F(VMDynamicModuleTest, MissingSymbol) {
+  iree_vm_module_t* module = NULL;
+  iree_status_t status = LoadModule(IREE_SV("unknown"), &module);
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_NOT_FOUND, status);
+  iree_status_free(status);
+  EXPECT_EQ(nullptr, module);
+}
+
+TEST_F(VMDynamicModuleTest, CreateFailure) {
+  // The library rejects the version offered by the loader; the failure must be
+  // propagated without leaking the library or a partially created module.
+  iree_vm_module_t* module = NULL;
+  iree_status_t status =
+      LoadModule(IREE_SV("iree_vm_dynamic_module_create_future"), &module);
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_UNIMPLEMENTED, status);
+  iree_status_free(status);
+  EXPECT_EQ(nullptr, module);
+}
+
+TEST(VMDynamicModulePathTest, IsLibraryPath) {
+  EXPECT_TRUE(iree_vm_dynamic_module_is_library_path(IREE_SV("a/module.so")));
+  EXPECT_TRUE(iree_vm_dynamic_module_is_library_path(IREE_SV("module.dylib")));
+  EXPECT_TRUE(iree_vm_dynamic_module_is_library_path(IREE_SV("module.dll")));
+  EXPECT_FALSE(
+      iree_vm_dynamic_module_is_library_path(IREE_SV("module.vmfb")));
+  EXPECT_FALSE(iree_vm_dynamic_module_is_library_path(IREE_SV("so")));
+}
+
+}  // namespace
+}  // namespace iree
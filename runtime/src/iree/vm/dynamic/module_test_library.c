@@ -0,0 +1,93 @@
+// Copyright 2023 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// A tiny native module exported for loading by module_test.cc. Real dynamic
+// modules are usually produced by the VM-to-EmitC conversion but the loader
+// only cares about the exported creation function.
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/vm/api.h"
+#include "iree/vm/dynamic/module.h"
+
+typedef iree_status_t (*call_i32_i32_t)(iree_vm_stack_t* stack,
+                                        void* module_ptr, void* module_state,
+                                        int32_t arg0, int32_t* out_ret0);
+
+static iree_status_t call_shim_i32_i32(iree_vm_stack_t* stack,
+                                       iree_vm_native_function_flags_t flags,
+                                       iree_byte_span_t args_storage,
+                                       iree_byte_span_t rets_storage,
+                                       call_i32_i32_t target_fn, void* module,
+                                       void* module_state) {
+  const int32_t* args = (const int32_t*)args_storage.data;
+  int32_t* results = (int32_t*)rets_storage.data;
+  return target_fn(stack, module, module_state, args[0], &results[0]);
+}
+
+// vm.import @dynamic_test.add_1(%arg0 : i32) -> i32
+static iree_status_t dynamic_test_add_1(iree_vm_stack_t* stack, void* module,
+                                        void* module_state, int32_t arg0,
+                                        int32_t* out_ret0) {
+  *out_ret0 = arg0 + 1;
+  return iree_ok_status();
+}
+
+static const iree_vm_native_export_descriptor_t dynamic_test_exports_[] = {
+    {
+        .local_name = iree_string_view_literal("add_1"),
+        .calling_convention = iree_string_view_literal("0i_i"),
+        .attr_count = 0,
+        .attrs = NULL,
+    },
+};
+static const iree_vm_native_function_ptr_t dynamic_test_funcs_[] = {
+    {
+        .shim = (iree_vm_native_function_shim_t)call_shim_i32_i32,
+        .target = (iree_vm_native_function_target_t)dynamic_test_add_1,
+    },
+};
+static const iree_vm_native_module_descriptor_t dynamic_test_descriptor_ = {
+    .name = iree_string_view_literal("dynamic_test"),
+    .version = 0,
+    .attr_count = 0,
+    .attrs = NULL,
+    .dependency_count = 0,
+    .dependencies = NULL,
+    .import_count = 0,
+    .imports = NULL,
+    .export_count = IREE_ARRAYSIZE(dynamic_test_exports_),
+    .exports = dynamic_test_exports_,
+    .function_count = IREE_ARRAYSIZE(dynamic_test_funcs_),
+    .functions = dynamic_test_funcs_,
+};
+
+IREE_VM_DYNAMIC_MODULE_EXPORT iree_status_t iree_vm_dynamic_module_create(
+    iree_vm_dynamic_module_version_t max_version, iree_vm_instance_t* instance,
+    iree_host_size_t param_count, const iree_string_pair_t* params,
+    iree_allocator_t host_allocator, iree_vm_module_t** out_module) {
+  iree_vm_module_t interface;
+  IREE_RETURN_IF_ERROR(iree_vm_module_initialize(&interface, NULL));
+  return iree_vm_native_module_create(&interface, &dynamic_test_descriptor_,
+                                      instance, host_allocator, out_module);
+}
+
+// Mimics a library built against a newer runtime that requires an interface
+// version the loader does not provide.
+IREE_VM_DYNAMIC_MODULE_EXPORT iree_status_t
+iree_vm_dynamic_module_create_future(
+    iree_vm_dynamic_module_version_t max_version, iree_vm_instance_t* instance,
+    iree_host_size_t param_count, const iree_string_pair_t* params,
+    iree_allocator_t host_allocator, iree_vm_module_t** out_module) {
+  if (max_version < IREE_VM_DYNAMIC_MODULE_VERSION_LATEST + 1) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "dynamic module interface version %u required",
+                            IREE_VM_DYNAMIC_MODULE_VERSION_LATEST + 1);
+  }
+  return iree_vm_dynamic_module_create(max_version, instance, param_count,
+                                       params, host_allocator, out_module);
+}
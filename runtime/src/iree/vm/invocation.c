@@ -11,7 +11,9 @@
 #include <string.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/arena.h"
 #include "iree/base/internal/debugging.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/base/tracing.h"
 #include "iree/vm/ref.h"
 #include "iree/vm/stack.h"
@@ -519,23 +521,22 @@ IREE_API_EXPORT iree_status_t iree_vm_begin_invoke(
   return iree_ok_status();
 }
 
-// WARNING: this function cannot have any trace markers that span the resume
-// call; the resume may yield with zones still open.
-IREE_API_EXPORT iree_status_t
-iree_vm_resume_invoke(iree_vm_invoke_state_t* state) {
-  IREE_ASSERT_ARGUMENT(state);
-
+// Resumes execution of |stack| storing the invocation status in |inout_status|.
+// See iree_vm_resume_invoke.
+static iree_status_t iree_vm_invoke_resume_stack(iree_vm_stack_t* stack,
+                                                 iree_byte_span_t results,
+                                                 iree_status_t* inout_status) {
   // In a stackless world resuming may pop a stack frame that needs to be
   // executed inline. We run here until either all stack frames have been popped
   // (indicating the invocation has completed) or we yield/error and want to
   // return to the scheduler.
   do {
-    if (iree_status_is_deferred(state->status)) {
+    if (iree_status_is_deferred(*inout_status)) {
       // Wait required; top of the stack should be a wait frame.
-      IREE_ASSERT_EQ(iree_vm_stack_current_frame(state->stack)->type,
+      IREE_ASSERT_EQ(iree_vm_stack_current_frame(stack)->type,
                      IREE_VM_STACK_FRAME_WAIT);
       return iree_status_from_code(IREE_STATUS_DEFERRED);
-    } else if (!iree_status_is_ok(state->status)) {
+    } else if (!iree_status_is_ok(*inout_status)) {
       // Invocation previously failed so return immediately. The user should
       // then call end() to get the result. By returning OK here we are telling
       // the user the resume operation succeeded.
@@ -543,7 +544,7 @@ iree_vm_resume_invoke(iree_vm_invoke_state_t* state) {
     }
 
     // Get the top execution frame of the stack where we will resume execution.
-    iree_vm_stack_frame_t* resume_frame = iree_vm_stack_top(state->stack);
+    iree_vm_stack_frame_t* resume_frame = iree_vm_stack_top(stack);
     if (IREE_UNLIKELY(!resume_frame)) {
       return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
                               "resume called with no parent frame");
@@ -552,11 +553,11 @@ iree_vm_resume_invoke(iree_vm_invoke_state_t* state) {
     // Call into the VM to resume the function. It may complete (returning OK),
     // defer to be waited/resumed later, or fail.
     iree_vm_function_t resume_function = resume_frame->function;
-    state->status = resume_function.module->resume_call(
-        resume_function.module->self, state->stack, state->results);
+    *inout_status = resume_function.module->resume_call(
+        resume_function.module->self, stack, results);
 
     // If the call yielded then return that so the user knows to resume again.
-    if (iree_status_is_deferred(state->status)) {
+    if (iree_status_is_deferred(*inout_status)) {
       return iree_status_from_code(IREE_STATUS_DEFERRED);
     }
 
@@ -567,27 +568,27 @@ iree_vm_resume_invoke(iree_vm_invoke_state_t* state) {
     // got to continue running. To keep the trace cleaner and reduce overhead we
     // jump back up and pop the next frame, which also helps us avoid
     // introducing latency between pops where otherwise there should be none.
-  } while (iree_status_is_ok(state->status) &&
-           iree_vm_stack_current_frame(state->stack) != NULL);
+  } while (iree_status_is_ok(*inout_status) &&
+           iree_vm_stack_current_frame(stack) != NULL);
 
   // We're indicating the resume operation was successful, not the result of the
   // VM call; the user will call end() to get that.
   return iree_ok_status();
 }
 
+// WARNING: this function cannot have any trace markers that span the resume
+// call; the resume may yield with zones still open.
 IREE_API_EXPORT iree_status_t
-iree_vm_wait_invoke(iree_vm_invoke_state_t* state,
-                    iree_vm_wait_frame_t* wait_frame, iree_time_t deadline_ns) {
+iree_vm_resume_invoke(iree_vm_invoke_state_t* state) {
   IREE_ASSERT_ARGUMENT(state);
-  if (IREE_UNLIKELY(!iree_status_is_deferred(state->status))) {
-    // Can only wait if the invocation is actually waiting.
-    // We could make this OK and act as a no-op but it can be useful for
-    // ensuring scheduler implementations don't do extraneous work.
-    return iree_make_status(
-        IREE_STATUS_FAILED_PRECONDITION,
-        "wait-invoke attempted on a non-waiting invocation");
-  }
+  return iree_vm_invoke_resume_stack(state->stack, state->results,
+                                     &state->status);
+}
 
+// Synchronously performs the wait operation described by |wait_frame| and
+// stores the result in the frame. See iree_vm_wait_invoke.
+static iree_status_t iree_vm_invoke_wait_frame(iree_vm_wait_frame_t* wait_frame,
+                                               iree_time_t deadline_ns) {
   // Combine the wait-invoke deadline with the one specified by the wait
   // operation itself. This allows schedulers to timeslice waits without
   // worrying whether user programs request to wait forever.
@@ -610,6 +611,22 @@ iree_vm_wait_invoke(iree_vm_invoke_state_t* state,
         IREE_STATUS_UNIMPLEMENTED,
         "multi-wait in synchronous invocations not yet implemented");
   }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t
+iree_vm_wait_invoke(iree_vm_invoke_state_t* state,
+                    iree_vm_wait_frame_t* wait_frame, iree_time_t deadline_ns) {
+  IREE_ASSERT_ARGUMENT(state);
+  if (IREE_UNLIKELY(!iree_status_is_deferred(state->status))) {
+    // Can only wait if the invocation is actually waiting.
+    // We could make this OK and act as a no-op but it can be useful for
+    // ensuring scheduler implementations don't do extraneous work.
+    return iree_make_status(
+        IREE_STATUS_FAILED_PRECONDITION,
+        "wait-invoke attempted on a non-waiting invocation");
+  }
+  IREE_RETURN_IF_ERROR(iree_vm_invoke_wait_frame(wait_frame, deadline_ns));
 
   // Reset status to OK - the next resume will pick back up in the waiter.
   iree_status_free(state->status);
@@ -699,6 +716,213 @@ IREE_API_EXPORT void iree_vm_abort_invoke(iree_vm_invoke_state_t* state) {
   IREE_TRACE_ZONE_END(z0);
 }
 
+//===----------------------------------------------------------------------===//
+// Reusable synchronous invocation
+//===----------------------------------------------------------------------===//
+
+#if !defined(IREE_VM_INVOKE_CONTEXT_BLOCK_SIZE)
+// Size of the arena blocks used by invoke contexts. Each invocation uses one
+// block for its initial stack and I/O storage so this must be large enough to
+// hold IREE_VM_STACK_DEFAULT_SIZE plus the marshaled arguments and results.
+#define IREE_VM_INVOKE_CONTEXT_BLOCK_SIZE (32 * 1024)
+#endif  // !IREE_VM_INVOKE_CONTEXT_BLOCK_SIZE
+
+struct iree_vm_invoke_context_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+  // Pool retaining blocks across invocations.
+  iree_arena_block_pool_t block_pool;
+  // Arena reset after each invocation.
+  iree_arena_allocator_t arena;
+};
+
+IREE_API_EXPORT iree_status_t iree_vm_invoke_context_create(
+    iree_allocator_t host_allocator,
+    iree_vm_invoke_context_t** out_invoke_context) {
+  IREE_ASSERT_ARGUMENT(out_invoke_context);
+  *out_invoke_context = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_vm_invoke_context_t* invoke_context = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*invoke_context),
+                                (void**)&invoke_context));
+  iree_atomic_ref_count_init(&invoke_context->ref_count);
+  invoke_context->host_allocator = host_allocator;
+  iree_arena_block_pool_initialize(IREE_VM_INVOKE_CONTEXT_BLOCK_SIZE,
+                                   host_allocator, &invoke_context->block_pool);
+  iree_arena_initialize(&invoke_context->block_pool, &invoke_context->arena);
+
+  *out_invoke_context = invoke_context;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static void iree_vm_invoke_context_destroy(
+    iree_vm_invoke_context_t* invoke_context) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t host_allocator = invoke_context->host_allocator;
+  iree_arena_deinitialize(&invoke_context->arena);
+  iree_arena_block_pool_deinitialize(&invoke_context->block_pool);
+  iree_allocator_free(host_allocator, invoke_context);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT void iree_vm_invoke_context_retain(
+    iree_vm_invoke_context_t* invoke_context) {
+  if (IREE_LIKELY(invoke_context)) {
+    iree_atomic_ref_count_inc(&invoke_context->ref_count);
+  }
+}
+
+IREE_API_EXPORT void iree_vm_invoke_context_release(
+    iree_vm_invoke_context_t* invoke_context) {
+  if (IREE_LIKELY(invoke_context) &&
+      iree_atomic_ref_count_dec(&invoke_context->ref_count) == 1) {
+    iree_vm_invoke_context_destroy(invoke_context);
+  }
+}
+
+// Runs |function| to completion on a stack allocated from the invoke context
+// arena. The caller must reset the arena after consuming |results|.
+static iree_status_t iree_vm_invoke_context_run(
+    iree_vm_invoke_context_t* invoke_context, iree_vm_context_t* context,
+    iree_vm_function_t function, iree_vm_invocation_flags_t flags,
+    iree_byte_span_t arguments, iree_byte_span_t results) {
+  // Force tracing if specified on the context.
+  if (iree_vm_context_flags(context) & IREE_VM_CONTEXT_FLAG_TRACE_EXECUTION) {
+    flags |= IREE_VM_INVOCATION_FLAG_TRACE_EXECUTION;
+  }
+
+  // Growth beyond the initial storage is rare and handled by the host
+  // allocator as arenas cannot reallocate.
+  uint8_t* stack_storage = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(&invoke_context->arena,
+                                           IREE_VM_STACK_DEFAULT_SIZE,
+                                           (void**)&stack_storage));
+  iree_vm_stack_t* stack = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_stack_initialize(
+      iree_make_byte_span(stack_storage, IREE_VM_STACK_DEFAULT_SIZE), flags,
+      iree_vm_context_state_resolver(context), invoke_context->host_allocator,
+      &stack));
+
+  // Run until complete, synchronously performing any waits. |status| tracks
+  // the invocation mechanics and |invoke_status| the result of the function.
+  iree_vm_function_call_t call = {
+      .function = function,
+      .arguments = arguments,
+      .results = results,
+  };
+  iree_status_t invoke_status =
+      function.module->begin_call(function.module->self, stack, call);
+  iree_status_t status = iree_ok_status();
+  while (iree_status_is_ok(status) && iree_status_is_deferred(invoke_status)) {
+    iree_vm_stack_frame_t* current_frame = iree_vm_stack_current_frame(stack);
+    if (IREE_UNLIKELY(!current_frame)) {
+      status = iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                                "unbalanced stack after yield");
+      break;
+    } else if (current_frame->type == IREE_VM_STACK_FRAME_WAIT) {
+      status = iree_vm_invoke_wait_frame(
+          (iree_vm_wait_frame_t*)iree_vm_stack_frame_storage(current_frame),
+          IREE_TIME_INFINITE_FUTURE);
+      if (!iree_status_is_ok(status)) break;
+      iree_status_free(invoke_status);
+      invoke_status = iree_ok_status();
+    }
+    status = iree_vm_invoke_resume_stack(stack, results, &invoke_status);
+  }
+
+  if (iree_status_is_ok(status) && !iree_status_is_ok(invoke_status)) {
+    // Annotate failures with the stack trace (if compiled in).
+    invoke_status =
+        IREE_VM_STACK_ANNOTATE_BACKTRACE_IF_ENABLED(stack, invoke_status);
+  }
+
+  // See iree_vm_end_invoke: frames of failed invocations may still have open
+  // trace zones.
+  iree_vm_stack_suspend_trace_zones(stack);
+  iree_vm_stack_deinitialize(stack);
+
+  if (!iree_status_is_ok(status)) {
+    iree_status_ignore(invoke_status);
+    return status;
+  }
+  return invoke_status;
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_invoke_with_context(
+    iree_vm_invoke_context_t* invoke_context, iree_vm_context_t* context,
+    iree_vm_function_t function, iree_vm_invocation_flags_t flags,
+    const iree_vm_invocation_policy_t* policy, const iree_vm_list_t* inputs,
+    iree_vm_list_t* outputs) {
+  IREE_ASSERT_ARGUMENT(invoke_context);
+  IREE_ASSERT_ARGUMENT(context);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Grab function metadata used for marshaling inputs/outputs.
+  iree_vm_function_signature_t signature =
+      iree_vm_function_signature(&function);
+  iree_string_view_t cconv_arguments = iree_string_view_empty();
+  iree_string_view_t cconv_results = iree_string_view_empty();
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_function_call_get_cconv_fragments(
+              &signature, &cconv_arguments, &cconv_results));
+  iree_byte_span_t arguments = iree_make_byte_span(NULL, 0);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0,
+      iree_vm_function_call_compute_cconv_fragment_size(
+          cconv_arguments, /*segment_size_list=*/NULL, &arguments.data_length));
+  iree_byte_span_t results = iree_make_byte_span(NULL, 0);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_function_call_compute_cconv_fragment_size(
+              cconv_results, /*segment_size_list=*/NULL, &results.data_length));
+
+  // Carve the I/O storage out of the arena. Both are zeroed so that partially
+  // marshaled or unwritten refs can be released safely.
+  iree_status_t status = iree_arena_allocate(
+      &invoke_context->arena, arguments.data_length, (void**)&arguments.data);
+  if (iree_status_is_ok(status)) {
+    status = iree_arena_allocate(&invoke_context->arena, results.data_length,
+                                 (void**)&results.data);
+  }
+  if (iree_status_is_ok(status)) {
+    memset(arguments.data, 0, arguments.data_length);
+    memset(results.data, 0, results.data_length);
+    status = iree_vm_invoke_marshal_inputs(cconv_arguments, inputs, arguments);
+  }
+
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_invoke_context_run(invoke_context, context, function,
+                                        flags, arguments, results);
+  }
+  iree_vm_invoke_release_io_refs(cconv_arguments, arguments);
+
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_invoke_marshal_outputs(cconv_results, results, outputs);
+  }
+  iree_vm_invoke_release_io_refs(cconv_results, results);
+
+  iree_arena_reset(&invoke_context->arena);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_invoke_raw(
+    iree_vm_invoke_context_t* invoke_context, iree_vm_context_t* context,
+    iree_vm_function_t function, iree_vm_invocation_flags_t flags,
+    const iree_vm_invocation_policy_t* policy, iree_byte_span_t arguments,
+    iree_byte_span_t results) {
+  IREE_ASSERT_ARGUMENT(invoke_context);
+  IREE_ASSERT_ARGUMENT(context);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status = iree_vm_invoke_context_run(
+      invoke_context, context, function, flags, arguments, results);
+  iree_arena_reset(&invoke_context->arena);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 //===----------------------------------------------------------------------===//
 // Loop-based asynchronous invocation
 //===----------------------------------------------------------------------===//
@@ -995,3 +1219,172 @@ static iree_status_t iree_vm_async_complete_invoke(
   iree_vm_list_t* outputs = state->outputs;
   return state->callback(state->user_data, loop, status, outputs);
 }
+
+//===----------------------------------------------------------------------===//
+// Asynchronous stateful invocation
+//===----------------------------------------------------------------------===//
+
+struct iree_vm_invocation_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t allocator;
+  // Posted when the invocation completes.
+  iree_notification_t notification;
+  // Nonzero once |status| and |outputs| have been set by the completion
+  // callback. Neither may be accessed by other threads until this is set.
+  iree_atomic_int32_t completed;
+  // Final status of the invocation. Owned by the invocation.
+  iree_status_t status;
+  // Output list receiving the results of the invocation.
+  iree_vm_list_t* outputs;
+  // Async invocation state; must remain live until the completion callback.
+  iree_vm_async_invoke_state_t state;
+};
+
+static void iree_vm_invocation_destroy(iree_vm_invocation_t* invocation) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t allocator = invocation->allocator;
+  iree_status_ignore(invocation->status);
+  iree_vm_list_release(invocation->outputs);
+  iree_notification_deinitialize(&invocation->notification);
+  iree_allocator_free(allocator, invocation);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static iree_status_t iree_vm_invocation_complete(void* user_data,
+                                                 iree_loop_t loop,
+                                                 iree_status_t status,
+                                                 iree_vm_list_t* outputs) {
+  iree_vm_invocation_t* invocation = (iree_vm_invocation_t*)user_data;
+
+  // The async invocation passes back the output list it retained. We already
+  // hold our own reference so the one passed back can be dropped.
+  iree_vm_list_release(outputs);
+
+  // Publish the result and wake any waiters. The status is owned by the
+  // invocation and not propagated to the loop: it is an error for the
+  // invocation and not for the loop scope.
+  invocation->status = status;
+  iree_atomic_store_int32(&invocation->completed, 1,
+                          iree_memory_order_release);
+  iree_notification_post(&invocation->notification, IREE_ALL_WAITERS);
+
+  // Drop the reference held by the in-flight invocation.
+  iree_vm_invocation_release(invocation);
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_invocation_create(
+    iree_loop_t loop, iree_vm_context_t* context, iree_vm_function_t function,
+    iree_vm_invocation_flags_t flags, const iree_vm_invocation_policy_t* policy,
+    iree_vm_list_t* inputs, iree_allocator_t allocator,
+    iree_vm_invocation_t** out_invocation) {
+  IREE_ASSERT_ARGUMENT(context);
+  IREE_ASSERT_ARGUMENT(out_invocation);
+  *out_invocation = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_vm_invocation_t* invocation = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(allocator, sizeof(*invocation),
+                                (void**)&invocation));
+  memset(invocation, 0, sizeof(*invocation));
+  iree_atomic_ref_count_init(&invocation->ref_count);
+  invocation->allocator = allocator;
+  iree_notification_initialize(&invocation->notification);
+  iree_atomic_store_int32(&invocation->completed, 0, iree_memory_order_relaxed);
+  invocation->status = iree_ok_status();
+
+  // Output storage sized to the function signature to avoid growth.
+  iree_vm_function_signature_t signature =
+      iree_vm_function_signature(&function);
+  iree_host_size_t argument_count = 0;
+  iree_host_size_t result_count = 0;
+  iree_status_t status = iree_vm_function_call_count_arguments_and_results(
+      &signature, &argument_count, &result_count);
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_list_create(/*element_type=*/NULL, result_count,
+                                 allocator, &invocation->outputs);
+  }
+
+  // Begin the invocation. The in-flight invocation holds a reference that is
+  // released by the completion callback, which may be issued inline.
+  if (iree_status_is_ok(status)) {
+    iree_vm_invocation_retain(invocation);
+    status = iree_vm_async_invoke(
+        loop, &invocation->state, context, function, flags, policy, inputs,
+        invocation->outputs, allocator, iree_vm_invocation_complete,
+        invocation);
+    if (!iree_status_is_ok(status)) {
+      // The callback is not issued if the invocation failed to enqueue.
+      iree_atomic_ref_count_dec(&invocation->ref_count);
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_invocation = invocation;
+  } else {
+    iree_vm_invocation_destroy(invocation);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT void iree_vm_invocation_retain(
+    iree_vm_invocation_t* invocation) {
+  if (invocation) {
+    iree_atomic_ref_count_inc(&invocation->ref_count);
+  }
+}
+
+IREE_API_EXPORT void iree_vm_invocation_release(
+    iree_vm_invocation_t* invocation) {
+  if (invocation && iree_atomic_ref_count_dec(&invocation->ref_count) == 1) {
+    iree_vm_invocation_destroy(invocation);
+  }
+}
+
+static bool iree_vm_invocation_is_completed(void* arg) {
+  iree_vm_invocation_t* invocation = (iree_vm_invocation_t*)arg;
+  return iree_atomic_load_int32(&invocation->completed,
+                                iree_memory_order_acquire) != 0;
+}
+
+IREE_API_EXPORT iree_status_t
+iree_vm_invocation_query_status(iree_vm_invocation_t* invocation) {
+  IREE_ASSERT_ARGUMENT(invocation);
+  if (!iree_vm_invocation_is_completed(invocation)) {
+    return iree_status_from_code(IREE_STATUS_DEFERRED);
+  }
+  return iree_status_clone(invocation->status);
+}
+
+IREE_API_EXPORT const iree_vm_list_t* iree_vm_invocation_outputs(
+    iree_vm_invocation_t* invocation) {
+  IREE_ASSERT_ARGUMENT(invocation);
+  if (!iree_vm_invocation_is_completed(invocation) ||
+      !iree_status_is_ok(invocation->status)) {
+    return NULL;
+  }
+  return invocation->outputs;
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_invocation_await(
+    iree_vm_invocation_t* invocation, iree_time_t deadline) {
+  IREE_ASSERT_ARGUMENT(invocation);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  if (!iree_notification_await(&invocation->notification,
+                               iree_vm_invocation_is_completed, invocation,
+                               iree_make_deadline(deadline))) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return iree_vm_invocation_query_status(invocation);
+}
+
+IREE_API_EXPORT void iree_vm_invocation_cancel(
+    iree_vm_invocation_t* invocation) {
+  IREE_ASSERT_ARGUMENT(invocation);
+  // The async invoke state has no abort point yet and cancellation is only a
+  // hint: invocations run to completion or until their waits time out.
+}
@@ -48,6 +48,56 @@ IREE_API_EXPORT iree_status_t iree_vm_invoke(
     const iree_vm_list_t* inputs, iree_vm_list_t* outputs,
     iree_allocator_t host_allocator);
 
+//===----------------------------------------------------------------------===//
+// Reusable synchronous invocation
+//===----------------------------------------------------------------------===//
+
+// Reusable storage for issuing many synchronous invocations.
+// The VM stack, marshaled arguments, and results are carved out of an arena
+// whose blocks are recycled across invocations such that steady state
+// invocations make no heap allocations. Stacks that grow beyond the default
+// size (deep recursion, etc) and I/O exceeding the arena block size fall back
+// to the host allocator.
+//
+// Thread-compatible: an invoke context may only be used by one thread at a time
+// but can be used to invoke functions in any VM context.
+typedef struct iree_vm_invoke_context_t iree_vm_invoke_context_t;
+
+// Creates a reusable invoke context allocated from |host_allocator|.
+IREE_API_EXPORT iree_status_t iree_vm_invoke_context_create(
+    iree_allocator_t host_allocator,
+    iree_vm_invoke_context_t** out_invoke_context);
+
+// Retains the given |invoke_context| for the caller.
+IREE_API_EXPORT void iree_vm_invoke_context_retain(
+    iree_vm_invoke_context_t* invoke_context);
+
+// Releases the given |invoke_context| from the caller.
+IREE_API_EXPORT void iree_vm_invoke_context_release(
+    iree_vm_invoke_context_t* invoke_context);
+
+// Synchronously invokes a function in the VM as with iree_vm_invoke using
+// storage from |invoke_context|. Callers reusing their |inputs| and |outputs|
+// lists across invocations avoid all per-invocation heap allocations.
+IREE_API_EXPORT iree_status_t iree_vm_invoke_with_context(
+    iree_vm_invoke_context_t* invoke_context, iree_vm_context_t* context,
+    iree_vm_function_t function, iree_vm_invocation_flags_t flags,
+    const iree_vm_invocation_policy_t* policy, const iree_vm_list_t* inputs,
+    iree_vm_list_t* outputs);
+
+// Synchronously invokes a function in the VM with caller-owned |arguments| and
+// |results| storage already laid out in the calling convention of the function
+// (see iree_vm_function_call_t), bypassing variant list marshaling entirely.
+//
+// Ownership of refs in |arguments| remains with the caller. |results| must be
+// zero-initialized and upon success the caller takes ownership of any refs
+// written to it and must release them.
+IREE_API_EXPORT iree_status_t iree_vm_invoke_raw(
+    iree_vm_invoke_context_t* invoke_context, iree_vm_context_t* context,
+    iree_vm_function_t function, iree_vm_invocation_flags_t flags,
+    const iree_vm_invocation_policy_t* policy, iree_byte_span_t arguments,
+    iree_byte_span_t results);
+
 //===----------------------------------------------------------------------===//
 // Asynchronous invocation
 //===----------------------------------------------------------------------===//
@@ -294,20 +344,33 @@ IREE_API_EXPORT iree_status_t iree_vm_async_invoke(
 // Asynchronous stateful invocation
 //===----------------------------------------------------------------------===//
 
-// TODO(benvanik): document and implement.
+// Creates an invocation of |function| in |context| and begins it on |loop|.
+// This wraps iree_vm_async_invoke with reference-counted state storage and a
+// completion status that can be polled or awaited from any thread. The
+// invocation suspends on the loop whenever the target function waits (such as
+// on hal.fence.await in asynchronous HAL modules) and no thread is blocked
+// while device work is pending, allowing many invocations to be in-flight at
+// once on loops backed by only a few threads.
+//
+// The invocation retains itself until it completes and callers may release
+// their reference at any time. Outputs are available from
+// iree_vm_invocation_outputs once the invocation has completed successfully.
+//
+// Note that based on the loop type the invocation may complete before this
+// function returns.
 IREE_API_EXPORT iree_status_t iree_vm_invocation_create(
-    iree_vm_context_t* context, iree_vm_function_t function,
+    iree_loop_t loop, iree_vm_context_t* context, iree_vm_function_t function,
     iree_vm_invocation_flags_t flags, const iree_vm_invocation_policy_t* policy,
-    const iree_vm_list_t* inputs, iree_allocator_t allocator,
+    iree_vm_list_t* inputs, iree_allocator_t allocator,
     iree_vm_invocation_t** out_invocation);
 
 // Retains the given |invocation| for the caller.
-IREE_API_EXPORT iree_status_t
-iree_vm_invocation_retain(iree_vm_invocation_t* invocation);
+IREE_API_EXPORT void iree_vm_invocation_retain(
+    iree_vm_invocation_t* invocation);
 
 // Releases the given |invocation| from the caller.
-IREE_API_EXPORT iree_status_t
-iree_vm_invocation_release(iree_vm_invocation_t* invocation);
+IREE_API_EXPORT void iree_vm_invocation_release(
+    iree_vm_invocation_t* invocation);
 
 // Queries the completion status of the invocation.
 // Returns one of the following:
@@ -329,6 +392,8 @@ IREE_API_EXPORT const iree_vm_list_t* iree_vm_invocation_outputs(
     iree_vm_invocation_t* invocation);
 
 // Blocks the caller until the invocation completes (successfully or otherwise).
+// The loop the invocation was created on must be making progress on another
+// thread or the call will block until |deadline| elapses.
 //
 // Returns IREE_STATUS_DEADLINE_EXCEEDED if |deadline| elapses before the
 // invocation completes and otherwise returns iree_vm_invocation_query_status.
@@ -791,6 +791,64 @@ iree_vm_list_push_value(iree_vm_list_t* list, const iree_vm_value_t* value) {
   return iree_vm_list_set_value(list, i, value);
 }
 
+// Verifies that [i, i + count) is within the bounds of |list|.
+static iree_status_t iree_vm_list_check_range(const iree_vm_list_t* list,
+                                              iree_host_size_t i,
+                                              iree_host_size_t count) {
+  if (i > list->count || count > list->count - i) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "range [%zu, %zu) out of bounds (%zu)", i,
+                            i + count, list->count);
+  }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_get_values(
+    const iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_vm_value_type_t value_type, void* out_values) {
+  IREE_RETURN_IF_ERROR(iree_vm_list_check_range(list, i, count));
+  iree_host_size_t value_size = iree_vm_value_type_size(value_type);
+  if (list->storage_mode == IREE_VM_LIST_STORAGE_MODE_VALUE &&
+      list->element_type.value_type == value_type) {
+    // Dense storage of the requested type; no per-element work required.
+    memcpy(out_values,
+           (const uint8_t*)list->storage + i * list->element_size,
+           count * value_size);
+    return iree_ok_status();
+  }
+  uint8_t* out_ptr = (uint8_t*)out_values;
+  for (iree_host_size_t j = 0; j < count; ++j) {
+    iree_vm_value_t value;
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_get_value_as(list, i + j, value_type, &value));
+    memcpy(out_ptr + j * value_size, value.value_storage, value_size);
+  }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_set_values(
+    iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_vm_value_type_t value_type, const void* values) {
+  IREE_RETURN_IF_ERROR(iree_vm_list_check_range(list, i, count));
+  iree_host_size_t value_size = iree_vm_value_type_size(value_type);
+  if (list->storage_mode == IREE_VM_LIST_STORAGE_MODE_VALUE &&
+      list->element_type.value_type == value_type) {
+    // Dense storage of the provided type; no per-element work required.
+    memcpy((uint8_t*)list->storage + i * list->element_size, values,
+           count * value_size);
+    return iree_ok_status();
+  }
+  const uint8_t* values_ptr = (const uint8_t*)values;
+  for (iree_host_size_t j = 0; j < count; ++j) {
+    iree_vm_value_t value;
+    memset(&value, 0, sizeof(value));
+    value.type = value_type;
+    memcpy(value.value_storage, values_ptr + j * value_size, value_size);
+    IREE_RETURN_IF_ERROR(iree_vm_list_set_value(list, i + j, &value));
+  }
+  return iree_ok_status();
+}
+
 IREE_API_EXPORT void* iree_vm_list_get_ref_deref(
     const iree_vm_list_t* list, iree_host_size_t i,
     const iree_vm_ref_type_descriptor_t* type_descriptor) {
@@ -853,6 +911,25 @@ IREE_API_EXPORT iree_status_t iree_vm_list_get_ref_retain(
                                                out_value);
 }
 
+IREE_API_EXPORT iree_status_t iree_vm_list_get_refs_retain(
+    const iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_vm_ref_t* out_values) {
+  IREE_RETURN_IF_ERROR(iree_vm_list_check_range(list, i, count));
+  if (list->storage_mode == IREE_VM_LIST_STORAGE_MODE_REF) {
+    // Dense ref storage; skip the per-element bounds and mode checks.
+    iree_vm_ref_t* element_refs = (iree_vm_ref_t*)list->storage + i;
+    for (iree_host_size_t j = 0; j < count; ++j) {
+      iree_vm_ref_retain(&element_refs[j], &out_values[j]);
+    }
+    return iree_ok_status();
+  }
+  for (iree_host_size_t j = 0; j < count; ++j) {
+    IREE_RETURN_IF_ERROR(iree_vm_list_get_ref_assign_or_retain(
+        list, i + j, /*is_retain=*/true, &out_values[j]));
+  }
+  return iree_ok_status();
+}
+
 static iree_status_t iree_vm_list_set_ref(iree_vm_list_t* list,
                                           iree_host_size_t i, bool is_move,
                                           iree_vm_ref_t* value) {
@@ -891,6 +968,17 @@ IREE_API_EXPORT iree_status_t iree_vm_list_set_ref_retain(
                               (iree_vm_ref_t*)value);
 }
 
+IREE_API_EXPORT iree_status_t iree_vm_list_set_refs_retain(
+    iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    const iree_vm_ref_t* values) {
+  IREE_RETURN_IF_ERROR(iree_vm_list_check_range(list, i, count));
+  for (iree_host_size_t j = 0; j < count; ++j) {
+    IREE_RETURN_IF_ERROR(iree_vm_list_set_ref(list, i + j, /*is_move=*/false,
+                                              (iree_vm_ref_t*)&values[j]));
+  }
+  return iree_ok_status();
+}
+
 IREE_API_EXPORT iree_status_t
 iree_vm_list_push_ref_retain(iree_vm_list_t* list, const iree_vm_ref_t* value) {
   iree_host_size_t i = iree_vm_list_size(list);
@@ -156,6 +156,23 @@ IREE_API_EXPORT iree_status_t iree_vm_list_set_value(
 IREE_API_EXPORT iree_status_t
 iree_vm_list_push_value(iree_vm_list_t* list, const iree_vm_value_t* value);
 
+// Copies |count| elements starting at index |i| into the dense |out_values|
+// array of |value_type| elements (such as an int32_t[] for I32). Lists storing
+// the same primitive type are copied directly and otherwise each element is
+// converted as with iree_vm_list_get_value_as.
+IREE_API_EXPORT iree_status_t iree_vm_list_get_values(
+    const iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_vm_value_type_t value_type, void* out_values);
+
+// Sets |count| elements starting at index |i| from the dense |values| array of
+// |value_type| elements. Lists storing the same primitive type are copied
+// directly and otherwise each element is converted as with
+// iree_vm_list_set_value. The list must already have enough elements; use
+// iree_vm_list_resize to grow it first.
+IREE_API_EXPORT iree_status_t iree_vm_list_set_values(
+    iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_vm_value_type_t value_type, const void* values);
+
 // Returns a dereferenced pointer to the given type if the element at the given
 // index matches the type. Returns NULL on error.
 IREE_API_EXPORT void* iree_vm_list_get_ref_deref(
@@ -173,11 +190,25 @@ IREE_API_EXPORT iree_status_t iree_vm_list_get_ref_assign(
 IREE_API_EXPORT iree_status_t iree_vm_list_get_ref_retain(
     const iree_vm_list_t* list, iree_host_size_t i, iree_vm_ref_t* out_value);
 
+// Returns the ref values of |count| elements starting at index |i| in
+// |out_values|. Each ref will be retained and must be released by the caller.
+// Existing refs in |out_values| are released.
+IREE_API_EXPORT iree_status_t iree_vm_list_get_refs_retain(
+    const iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_vm_ref_t* out_values);
+
 // Sets the ref value of the element at the given index, retaining a reference
 // in the list until the element is cleared or the list is disposed.
 IREE_API_EXPORT iree_status_t iree_vm_list_set_ref_retain(
     iree_vm_list_t* list, iree_host_size_t i, const iree_vm_ref_t* value);
 
+// Sets the ref values of |count| elements starting at index |i| from |values|,
+// retaining a reference to each in the list. The list must already have enough
+// elements; use iree_vm_list_resize to grow it first.
+IREE_API_EXPORT iree_status_t iree_vm_list_set_refs_retain(
+    iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    const iree_vm_ref_t* values);
+
 // Pushes the ref value of the element to the end of the list, retaining a
 // reference in the list until the element is cleared or the list is disposed.
 IREE_API_EXPORT iree_status_t
@@ -202,6 +202,100 @@ TEST_F(VMListTest, UsageI32) {
   iree_vm_list_release(list);
 }
 
+// Tests bulk get/set of values on dense lists of the same type.
+TEST_F(VMListTest, BulkValuesI32) {
+  iree_vm_type_def_t element_type =
+      iree_vm_type_def_make_value_type(IREE_VM_VALUE_TYPE_I32);
+  iree_vm_list_t* list = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_list_create(&element_type, 8, iree_allocator_system(), &list));
+  IREE_ASSERT_OK(iree_vm_list_resize(list, 6));
+
+  const int32_t values[4] = {10, 11, 12, 13};
+  IREE_ASSERT_OK(iree_vm_list_set_values(list, 1, IREE_ARRAYSIZE(values),
+                                         IREE_VM_VALUE_TYPE_I32, values));
+
+  int32_t out_values[6] = {-1, -1, -1, -1, -1, -1};
+  IREE_ASSERT_OK(
+      iree_vm_list_get_values(list, 0, 6, IREE_VM_VALUE_TYPE_I32, out_values));
+  EXPECT_EQ(0, out_values[0]);
+  EXPECT_EQ(10, out_values[1]);
+  EXPECT_EQ(13, out_values[4]);
+  EXPECT_EQ(0, out_values[5]);
+
+  // Reads using a different type convert each element.
+  int64_t out_values_i64[4] = {0};
+  IREE_ASSERT_OK(iree_vm_list_get_values(list, 1, 4, IREE_VM_VALUE_TYPE_I64,
+                                         out_values_i64));
+  EXPECT_EQ(10, out_values_i64[0]);
+  EXPECT_EQ(13, out_values_i64[3]);
+
+  // Ranges must be entirely in bounds.
+  EXPECT_THAT(Status(iree_vm_list_get_values(
+                  list, 4, 3, IREE_VM_VALUE_TYPE_I32, out_values)),
+              StatusIs(StatusCode::kOutOfRange));
+  EXPECT_THAT(Status(iree_vm_list_set_values(list, 7, 0,
+                                             IREE_VM_VALUE_TYPE_I32, values)),
+              StatusIs(StatusCode::kOutOfRange));
+
+  iree_vm_list_release(list);
+}
+
+// Tests bulk get/set of values on variant lists.
+TEST_F(VMListTest, BulkValuesVariant) {
+  iree_vm_type_def_t element_type = iree_vm_type_def_make_variant_type();
+  iree_vm_list_t* list = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_list_create(&element_type, 4, iree_allocator_system(), &list));
+  IREE_ASSERT_OK(iree_vm_list_resize(list, 3));
+
+  const float values[3] = {1.5f, 2.5f, 3.5f};
+  IREE_ASSERT_OK(iree_vm_list_set_values(list, 0, IREE_ARRAYSIZE(values),
+                                         IREE_VM_VALUE_TYPE_F32, values));
+  EXPECT_THAT(GetValuesList(list), Eq(MakeValuesList(values)));
+
+  float out_values[3] = {0.0f};
+  IREE_ASSERT_OK(
+      iree_vm_list_get_values(list, 0, 3, IREE_VM_VALUE_TYPE_F32, out_values));
+  EXPECT_EQ(1.5f, out_values[0]);
+  EXPECT_EQ(3.5f, out_values[2]);
+
+  iree_vm_list_release(list);
+}
+
+// Tests bulk get/set of refs on dense ref lists.
+TEST_F(VMListTest, BulkRefs) {
+  iree_vm_type_def_t element_type =
+      iree_vm_type_def_make_ref_type(test_a_type_id());
+  iree_vm_list_t* list = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_list_create(&element_type, 4, iree_allocator_system(), &list));
+  IREE_ASSERT_OK(iree_vm_list_resize(list, 4));
+
+  iree_vm_ref_t refs[3] = {MakeRef<A>(1.0f), MakeRef<A>(2.0f),
+                           MakeRef<A>(3.0f)};
+  IREE_ASSERT_OK(
+      iree_vm_list_set_refs_retain(list, 1, IREE_ARRAYSIZE(refs), refs));
+  for (auto& ref : refs) iree_vm_ref_release(&ref);
+
+  iree_vm_ref_t out_refs[4] = {{0}};
+  IREE_ASSERT_OK(iree_vm_list_get_refs_retain(list, 0, 4, out_refs));
+  EXPECT_EQ(nullptr, out_refs[0].ptr);
+  for (int i = 1; i < 4; ++i) {
+    ASSERT_TRUE(test_a_isa(out_refs[i]));
+    EXPECT_EQ((float)i, test_a_deref(out_refs[i])->data());
+  }
+  for (auto& ref : out_refs) iree_vm_ref_release(&ref);
+
+  // Refs of the wrong type are rejected.
+  iree_vm_ref_t ref_b = MakeRef<B>(1);
+  EXPECT_THAT(Status(iree_vm_list_set_refs_retain(list, 0, 1, &ref_b)),
+              StatusIs(StatusCode::kInvalidArgument));
+  iree_vm_ref_release(&ref_b);
+
+  iree_vm_list_release(list);
+}
+
 // Tests simple ref object list usage, mainly just for demonstration.
 // Stores ref object type A elements only, equivalent to `!vm.list<!vm.ref<A>>`.
 TEST_F(VMListTest, UsageRef) {
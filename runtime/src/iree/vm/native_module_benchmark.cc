@@ -4,15 +4,66 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <cstddef>
+
 #include "benchmark/benchmark.h"
 #include "iree/base/api.h"
 #include "iree/vm/module.h"
 #include "iree/vm/native_module.h"
 #include "iree/vm/native_module_test.h"
+#include "iree/vm/ref.h"
 #include "iree/vm/stack.h"
 
 namespace {
 
 // TODO(benvanik): native module benchmarks.
 
+struct ref_object_benchmark_t {
+  iree_vm_ref_object_t ref_object = {1};
+};
+
+// Registers a type whose objects are owned by the benchmarks themselves.
+static iree_vm_ref_type_t RegisterBenchmarkRefType() {
+  static iree_vm_ref_type_descriptor_t descriptor = {0};
+  if (descriptor.type == IREE_VM_REF_TYPE_NULL) {
+    descriptor.type_name = iree_make_cstring_view("BenchmarkType");
+    descriptor.offsetof_counter =
+        offsetof(ref_object_benchmark_t, ref_object.counter);
+    descriptor.destroy = NULL;
+    IREE_CHECK_OK(iree_vm_ref_register_type(&descriptor));
+  }
+  return descriptor.type;
+}
+
+// Retains and releases a shared reference; both are atomic RMWs.
+static void BM_RefRetainRelease(benchmark::State& state) {
+  ref_object_benchmark_t object;
+  iree_vm_ref_t ref = {0};
+  IREE_CHECK_OK(
+      iree_vm_ref_wrap_assign(&object, RegisterBenchmarkRefType(), &ref));
+  for (auto _ : state) {
+    iree_vm_ref_t retained_ref = {0};
+    iree_vm_ref_retain(&ref, &retained_ref);
+    benchmark::DoNotOptimize(retained_ref);
+    iree_vm_ref_release(&retained_ref);
+  }
+  iree_vm_ref_release(&ref);
+}
+BENCHMARK(BM_RefRetainRelease);
+
+// Wraps and drops a reference held by a single owner, as with per-invocation
+// objects. The release takes the sole-owner path without an atomic RMW.
+static void BM_RefSoleOwnerRelease(benchmark::State& state) {
+  iree_vm_ref_type_t type = RegisterBenchmarkRefType();
+  ref_object_benchmark_t object;
+  for (auto _ : state) {
+    iree_atomic_ref_count_init(&object.ref_object.counter);
+    iree_vm_ref_t ref = {0};
+    IREE_CHECK_OK(iree_vm_ref_wrap_assign(&object, type, &ref));
+    benchmark::DoNotOptimize(ref);
+    iree_vm_ref_release(&ref);
+  }
+}
+BENCHMARK(BM_RefSoleOwnerRelease);
+
 }  // namespace
@@ -91,6 +91,96 @@ class VMNativeModuleTest : public ::testing::Test {
     return ret0_value.i32;
   }
 
+  // Runs the entry function |count| times with the same reusable storage.
+  StatusOr<int32_t> RunFunctionRepeated(int32_t arg0, int count) {
+    iree_vm_function_t function;
+    IREE_RETURN_IF_ERROR(iree_vm_context_resolve_function(
+        context_, iree_make_cstring_view("module_b.entry"), &function));
+
+    iree_vm_invoke_context_t* invoke_context = nullptr;
+    IREE_RETURN_IF_ERROR(iree_vm_invoke_context_create(iree_allocator_system(),
+                                                       &invoke_context));
+    vm::ref<iree_vm_list_t> input_list;
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(
+        /*element_type=*/nullptr, 1, iree_allocator_system(), &input_list));
+    auto arg0_value = iree_vm_value_make_i32(arg0);
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_push_value(input_list.get(), &arg0_value));
+    vm::ref<iree_vm_list_t> output_list;
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(
+        /*element_type=*/nullptr, 1, iree_allocator_system(), &output_list));
+
+    iree_status_t status = iree_ok_status();
+    for (int i = 0; i < count && iree_status_is_ok(status); ++i) {
+      status = iree_vm_invoke_with_context(
+          invoke_context, context_, function, IREE_VM_INVOCATION_FLAG_NONE,
+          /*policy=*/nullptr, input_list.get(), output_list.get());
+    }
+    iree_vm_invoke_context_release(invoke_context);
+    IREE_RETURN_IF_ERROR(status);
+
+    iree_vm_value_t ret0_value;
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_get_value(output_list.get(), 0, &ret0_value));
+    return ret0_value.i32;
+  }
+
+  // Runs the entry function with caller-owned ABI storage.
+  StatusOr<int32_t> RunFunctionRaw(int32_t arg0) {
+    iree_vm_function_t function;
+    IREE_RETURN_IF_ERROR(iree_vm_context_resolve_function(
+        context_, iree_make_cstring_view("module_b.entry"), &function));
+
+    iree_vm_invoke_context_t* invoke_context = nullptr;
+    IREE_RETURN_IF_ERROR(iree_vm_invoke_context_create(iree_allocator_system(),
+                                                       &invoke_context));
+    int32_t ret0 = 0;
+    iree_status_t status = iree_vm_invoke_raw(
+        invoke_context, context_, function, IREE_VM_INVOCATION_FLAG_NONE,
+        /*policy=*/nullptr,
+        iree_make_byte_span((uint8_t*)&arg0, sizeof(arg0)),
+        iree_make_byte_span((uint8_t*)&ret0, sizeof(ret0)));
+    iree_vm_invoke_context_release(invoke_context);
+    IREE_RETURN_IF_ERROR(status);
+    return ret0;
+  }
+
+  // Runs the entry function as a stateful invocation on an inline loop.
+  StatusOr<int32_t> RunFunctionInvocation(int32_t arg0) {
+    iree_vm_function_t function;
+    IREE_RETURN_IF_ERROR(iree_vm_context_resolve_function(
+        context_, iree_make_cstring_view("module_b.entry"), &function));
+
+    vm::ref<iree_vm_list_t> input_list;
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(
+        /*element_type=*/nullptr, 1, iree_allocator_system(), &input_list));
+    auto arg0_value = iree_vm_value_make_i32(arg0);
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_push_value(input_list.get(), &arg0_value));
+
+    iree_status_t loop_status = iree_ok_status();
+    iree_vm_invocation_t* invocation = nullptr;
+    IREE_RETURN_IF_ERROR(iree_vm_invocation_create(
+        iree_loop_inline(&loop_status), context_, function,
+        IREE_VM_INVOCATION_FLAG_NONE, /*policy=*/nullptr, input_list.get(),
+        iree_allocator_system(), &invocation));
+    IREE_RETURN_IF_ERROR(loop_status);
+
+    // Inline loops complete the invocation before returning.
+    iree_status_t status = iree_vm_invocation_query_status(invocation);
+    if (iree_status_is_ok(status)) {
+      status = iree_vm_invocation_await(invocation, IREE_TIME_INFINITE_FUTURE);
+    }
+    iree_vm_value_t ret0_value;
+    if (iree_status_is_ok(status)) {
+      status = iree_vm_list_get_value(iree_vm_invocation_outputs(invocation),
+                                      0, &ret0_value);
+    }
+    iree_vm_invocation_release(invocation);
+    IREE_RETURN_IF_ERROR(status);
+    return ret0_value.i32;
+  }
+
  private:
   iree_vm_instance_t* instance_ = nullptr;
   iree_vm_context_t* context_ = nullptr;
@@ -108,5 +198,21 @@ TEST_F(VMNativeModuleTest, Example) {
   ASSERT_EQ(v2, 8);
 }
 
+TEST_F(VMNativeModuleTest, InvokeWithContext) {
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v0, RunFunctionRepeated(3, 16));
+  // Each call adds arg0 + 1 to the per-context counter and returns it - 1.
+  ASSERT_EQ(v0, 16 * 4 - 1);
+}
+
+TEST_F(VMNativeModuleTest, InvokeRaw) {
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v0, RunFunctionRaw(2));
+  ASSERT_EQ(v0, 2);
+}
+
+TEST_F(VMNativeModuleTest, Invocation) {
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v0, RunFunctionInvocation(3));
+  ASSERT_EQ(v0, 3);
+}
+
 }  // namespace
 }  // namespace iree
@@ -29,6 +29,26 @@ static inline volatile iree_atomic_ref_count_t* iree_vm_get_ref_counter_ptr(
                                              ref->offsetof_counter);
 }
 
+// Drops a reference from |counter| and returns true if it was the last one.
+//
+// A caller observing a count of 1 holds the only reference and no other thread
+// can legally retain or release the object concurrently (that would require a
+// reference of its own) so the common case of the sole owner dropping an
+// object, such as per-invocation buffer views, skips the atomic RMW entirely.
+// The acquire load pairs with the acq_rel decrements of any prior owners.
+//
+// Retains can't take a similar shortcut: other threads may retain through a
+// pointer borrowed from the owner while the owner itself retains.
+static inline bool iree_vm_ref_counter_release(
+    volatile iree_atomic_ref_count_t* counter) {
+  iree_atomic_ref_count_t* sole_counter = (iree_atomic_ref_count_t*)counter;
+  if (iree_atomic_ref_count_load(sole_counter) == 1) {
+    iree_atomic_store_int32(sole_counter, 0, iree_memory_order_relaxed);
+    return true;
+  }
+  return iree_atomic_ref_count_dec(counter) == 1;
+}
+
 IREE_API_EXPORT void iree_vm_ref_object_retain(
     void* ptr, const iree_vm_ref_type_descriptor_t* type_descriptor) {
   if (!ptr) return;
@@ -42,7 +62,7 @@ IREE_API_EXPORT void iree_vm_ref_object_release(
   if (!ptr) return;
   volatile iree_atomic_ref_count_t* counter =
       iree_vm_get_raw_counter_ptr(ptr, type_descriptor);
-  if (iree_atomic_ref_count_dec(counter) == 1) {
+  if (iree_vm_ref_counter_release(counter)) {
     if (type_descriptor->destroy) {
       // NOTE: this makes us not re-entrant, but I think that's OK.
       type_descriptor->destroy(ptr);
@@ -223,7 +243,7 @@ IREE_API_EXPORT void iree_vm_ref_release(iree_vm_ref_t* ref) {
 
   iree_vm_ref_trace("RELEASE", ref);
   volatile iree_atomic_ref_count_t* counter = iree_vm_get_ref_counter_ptr(ref);
-  if (iree_atomic_ref_count_dec(counter) == 1) {
+  if (iree_vm_ref_counter_release(counter)) {
     const iree_vm_ref_type_descriptor_t* type_descriptor =
         iree_vm_ref_get_type_descriptor(ref->type);
     if (type_descriptor->destroy) {
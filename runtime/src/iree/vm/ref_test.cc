@@ -6,7 +6,10 @@
 
 #include "iree/vm/ref.h"
 
+#include <atomic>
 #include <cstddef>
+#include <thread>
+#include <vector>
 
 #include "iree/base/api.h"
 #include "iree/testing/gtest.h"
@@ -449,4 +452,73 @@ TEST(VMRefTest, EqualityDifferentTypes) {
   iree_vm_ref_release(&a_ref);
 }
 
+// Counts destructions so that tests can verify objects die exactly once.
+static std::atomic<int> g_counted_destroy_count{0};
+struct ref_object_counted_t {
+  iree_vm_ref_object_t ref_object = {1};
+};
+static iree_vm_ref_type_t kCountedTypeID = IREE_VM_REF_TYPE_NULL;
+static void RegisterTypeCounted() {
+  static iree_vm_ref_type_descriptor_t descriptor = {0};
+  if (descriptor.type == IREE_VM_REF_TYPE_NULL) {
+    descriptor.type_name = iree_make_cstring_view("CountedType");
+    descriptor.offsetof_counter =
+        offsetof(ref_object_counted_t, ref_object.counter);
+    descriptor.destroy = +[](void* ptr) {
+      ++g_counted_destroy_count;
+      delete reinterpret_cast<ref_object_counted_t*>(ptr);
+    };
+    IREE_CHECK_OK(iree_vm_ref_register_type(&descriptor));
+    kCountedTypeID = descriptor.type;
+  }
+}
+
+// Tests that releasing the sole reference destroys the object.
+TEST(VMRefTest, ReleaseSoleReference) {
+  RegisterTypeCounted();
+  int base_count = g_counted_destroy_count;
+  iree_vm_ref_t ref = {0};
+  IREE_EXPECT_OK(iree_vm_ref_wrap_assign(new ref_object_counted_t(),
+                                         kCountedTypeID, &ref));
+  iree_vm_ref_t ref2 = {0};
+  iree_vm_ref_retain(&ref, &ref2);
+  EXPECT_EQ(2, ReadCounter(&ref));
+  iree_vm_ref_release(&ref);
+  EXPECT_EQ(1, ReadCounter(&ref2));
+  EXPECT_EQ(base_count, g_counted_destroy_count);
+  iree_vm_ref_release(&ref2);
+  EXPECT_EQ(base_count + 1, g_counted_destroy_count);
+}
+
+// Tests that references shared across threads destroy the object exactly once
+// regardless of which thread drops the last reference.
+TEST(VMRefTest, ReleaseAcrossThreads) {
+  RegisterTypeCounted();
+  static constexpr int kThreadCount = 4;
+  static constexpr int kIterationCount = 1000;
+  int base_count = g_counted_destroy_count;
+  for (int i = 0; i < kIterationCount; ++i) {
+    iree_vm_ref_t ref = {0};
+    IREE_EXPECT_OK(iree_vm_ref_wrap_assign(new ref_object_counted_t(),
+                                           kCountedTypeID, &ref));
+    std::vector<iree_vm_ref_t> thread_refs(kThreadCount);
+    for (auto& thread_ref : thread_refs) {
+      thread_ref = {0};
+      iree_vm_ref_retain(&ref, &thread_ref);
+    }
+    std::vector<std::thread> threads;
+    for (auto& thread_ref : thread_refs) {
+      threads.emplace_back([&thread_ref]() {
+        iree_vm_ref_t local_ref = {0};
+        iree_vm_ref_retain(&thread_ref, &local_ref);
+        iree_vm_ref_release(&thread_ref);
+        iree_vm_ref_release(&local_ref);
+      });
+    }
+    iree_vm_ref_release(&ref);
+    for (auto& thread : threads) thread.join();
+  }
+  EXPECT_EQ(base_count + kIterationCount, g_counted_destroy_count);
+}
+
 }  // namespace
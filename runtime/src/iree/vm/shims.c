@@ -53,6 +53,7 @@ IREE_VM_ABI_DEFINE_SHIM(rr, iI);
 IREE_VM_ABI_DEFINE_SHIM(rrr, iI);
 IREE_VM_ABI_DEFINE_SHIM(rrr, r);
 IREE_VM_ABI_DEFINE_SHIM(rrCrIID, v);
+IREE_VM_ABI_DEFINE_SHIM(rrCrrrID, v);
 IREE_VM_ABI_DEFINE_SHIM(rriCiD, v);
 IREE_VM_ABI_DEFINE_SHIM(rriiCID, v);
 IREE_VM_ABI_DEFINE_SHIM(rriCiirIID, v);
@@ -402,6 +402,13 @@ IREE_VM_ABI_FIXED_STRUCT(rrIii, {
   int32_t i4;
 });
 
+IREE_VM_ABI_FIXED_STRUCT(rrrI, {
+  iree_vm_ref_t r0;
+  iree_vm_ref_t r1;
+  iree_vm_ref_t r2;
+  int64_t i3;
+});
+
 IREE_VM_ABI_FIXED_STRUCT(rrrIii, {
   iree_vm_ref_t r0;
   iree_vm_ref_t r1;
@@ -540,6 +547,13 @@ IREE_VM_ABI_VLA_STRUCT(rrCrIID, a2_count, a2, {
   iree_vm_abi_rII_t a2[0];
 });
 
+IREE_VM_ABI_VLA_STRUCT(rrCrrrID, a2_count, a2, {
+  iree_vm_ref_t r0;
+  iree_vm_ref_t r1;
+  iree_vm_size_t a2_count;
+  iree_vm_abi_rrrI_t a2[0];
+});
+
 IREE_VM_ABI_VLA_STRUCT(rriCiirIID, a3_count, a3, {
   iree_vm_ref_t r0;
   iree_vm_ref_t r1;
@@ -619,6 +633,7 @@ IREE_VM_ABI_DECLARE_SHIM(rr, iI);
 IREE_VM_ABI_DECLARE_SHIM(rrr, iI);
 IREE_VM_ABI_DECLARE_SHIM(rrr, r);
 IREE_VM_ABI_DECLARE_SHIM(rrCrIID, v);
+IREE_VM_ABI_DECLARE_SHIM(rrCrrrID, v);
 IREE_VM_ABI_DECLARE_SHIM(rriCiD, v);
 IREE_VM_ABI_DECLARE_SHIM(rriiCID, v);
 IREE_VM_ABI_DECLARE_SHIM(rriCiirIID, v);
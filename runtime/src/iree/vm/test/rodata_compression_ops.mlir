@@ -0,0 +1,56 @@
+// Compiled with --iree-vm-bytecode-module-compress-rodata so that large rodata
+// is stored LZ4 compressed and decompressed when the module is loaded.
+vm.module @rodata_compression_ops {
+
+  // Large enough to be stored external to the FlatBuffer and compressed.
+  vm.rodata private @rodata_2048xi32_a dense<7> : tensor<2048xi32>
+  vm.rodata private @rodata_2048xi32_b dense<-1> : tensor<2048xi32>
+  // Small enough to remain embedded and uncompressed.
+  vm.rodata private @rodata_3xi32 dense<[1, 2, 3]> : tensor<3xi32>
+
+  vm.export @test_compressed_length
+  vm.func @test_compressed_length() {
+    %rodata = vm.const.ref.rodata @rodata_2048xi32_a : !vm.buffer
+    %rodata_dno = util.optimization_barrier %rodata : !vm.buffer
+    %length = vm.buffer.length %rodata_dno : !vm.buffer -> i64
+    %c8192 = vm.const.i64 8192
+    vm.check.eq %length, %c8192, "decompressed length" : i64
+    vm.return
+  }
+
+  vm.export @test_compressed_contents
+  vm.func @test_compressed_contents() {
+    %rodata_a = vm.const.ref.rodata @rodata_2048xi32_a : !vm.buffer
+    %rodata_b = vm.const.ref.rodata @rodata_2048xi32_b : !vm.buffer
+    %rodata_a_dno = util.optimization_barrier %rodata_a : !vm.buffer
+    %rodata_b_dno = util.optimization_barrier %rodata_b : !vm.buffer
+    %c0 = vm.const.i64 0
+    %c1024 = vm.const.i64 1024
+    %c2047 = vm.const.i64 2047
+    %c7 = vm.const.i32 7
+    %cn1 = vm.const.i32 -1
+    %a0 = vm.buffer.load.i32 %rodata_a_dno[%c0] : !vm.buffer -> i32
+    vm.check.eq %a0, %c7, "a[0]" : i32
+    %a1024 = vm.buffer.load.i32 %rodata_a_dno[%c1024] : !vm.buffer -> i32
+    vm.check.eq %a1024, %c7, "a[1024]" : i32
+    %a2047 = vm.buffer.load.i32 %rodata_a_dno[%c2047] : !vm.buffer -> i32
+    vm.check.eq %a2047, %c7, "a[2047]" : i32
+    %b0 = vm.buffer.load.i32 %rodata_b_dno[%c0] : !vm.buffer -> i32
+    vm.check.eq %b0, %cn1, "b[0]" : i32
+    %b2047 = vm.buffer.load.i32 %rodata_b_dno[%c2047] : !vm.buffer -> i32
+    vm.check.eq %b2047, %cn1, "b[2047]" : i32
+    vm.return
+  }
+
+  vm.export @test_uncompressed_contents
+  vm.func @test_uncompressed_contents() {
+    %rodata = vm.const.ref.rodata @rodata_3xi32 : !vm.buffer
+    %rodata_dno = util.optimization_barrier %rodata : !vm.buffer
+    %c2 = vm.const.i64 2
+    %v2 = vm.buffer.load.i32 %rodata_dno[%c2] : !vm.buffer -> i32
+    %c3 = vm.const.i32 3
+    vm.check.eq %v2, %c3, "embedded[2]" : i32
+    vm.return
+  }
+
+}
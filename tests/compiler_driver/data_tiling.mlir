@@ -0,0 +1,42 @@
+// RUN: iree-compile --compile-to=flow --iree-hal-target-backends=llvm-cpu %s \
+// RUN:   | FileCheck %s --check-prefix=ENCODE
+// RUN: iree-compile --compile-to=flow --iree-hal-target-backends=llvm-cpu \
+// RUN:   --iree-opt-data-tiling=false %s | FileCheck %s --check-prefix=PLAIN
+// RUN: iree-compile --compile-to=flow --iree-hal-target-backends=vulkan-spirv %s \
+// RUN:   | FileCheck %s --check-prefix=PLAIN
+// RUN: iree-compile --compile-to=flow --iree-hal-target-backends=pim %s \
+// RUN:   | FileCheck %s --check-prefix=PLAIN
+// RUN: iree-compile --compile-to=flow --iree-hal-target-backends=llvm-cpu \
+// RUN:   --iree-opt-const-expr-hoisting %s | FileCheck %s --check-prefix=HOIST
+
+// Data tiling is on by default but only applies when every target backend
+// materializes encodings.
+
+func.func @matmul_weights(%lhs : tensor<16x16xf32>) -> tensor<16x16xf32> {
+  %rhs = arith.constant dense<5.000000e-01> : tensor<16x16xf32>
+  %zero = arith.constant 0.000000e+00 : f32
+  %empty = tensor.empty() : tensor<16x16xf32>
+  %fill = linalg.fill ins(%zero : f32) outs(%empty : tensor<16x16xf32>) -> tensor<16x16xf32>
+  %0 = linalg.matmul ins(%lhs, %rhs : tensor<16x16xf32>, tensor<16x16xf32>)
+      outs(%fill : tensor<16x16xf32>) -> tensor<16x16xf32>
+  return %0 : tensor<16x16xf32>
+}
+
+// ENCODE-DAG: iree_linalg_ext.set_encoding {{.+}}encoding<MATMUL_F32F32F32_LHS>
+// ENCODE-DAG: iree_linalg_ext.set_encoding {{.+}}encoding<MATMUL_F32F32F32_RHS_TRANSPOSE>
+// ENCODE-DAG: iree_linalg_ext.unset_encoding {{.+}}encoding<MATMUL_F32F32F32_RESULT>
+
+// PLAIN-NOT: iree_linalg_ext.set_encoding
+// PLAIN-NOT: iree_linalg_ext.encoding
+// PLAIN: linalg.matmul
+// PLAIN-NOT: iree_linalg_ext.set_encoding
+// PLAIN-NOT: iree_linalg_ext.encoding
+
+// The encoded constant weights are packed once in an initializer.
+// HOIST: util.global private @[[RHS:[a-zA-Z0-9_]+]] : tensor<16x16xf32, #iree_linalg_ext.encoding<MATMUL_F32F32F32_RHS_TRANSPOSE>>
+// HOIST: util.initializer
+// HOIST: %[[PACKED:.+]] = flow.dispatch
+// HOIST: util.global.store %[[PACKED]], @[[RHS]]
+// HOIST-LABEL: func.func @matmul_weights(
+// HOIST: util.global.load @[[RHS]]
+// HOIST: flow.dispatch
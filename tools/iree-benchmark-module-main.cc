@@ -51,11 +51,30 @@
 // how the full program will run, though, and YMMV. Always verify timings with
 // an appropriate device-specific tool before trusting the more generic and
 // higher-level numbers from this tool.
-
+//
+// Passing --load_concurrency=N switches from Google Benchmark to a load
+// generator that invokes --function from N concurrent callers for
+// --load_duration_ms and reports throughput and latency percentiles. With
+// --load_arrival=closed (the default) each caller issues its next request as
+// soon as the previous one completes, which measures throughput at saturation.
+// With --load_arrival=fixed or --load_arrival=poisson requests arrive at
+// --load_rate requests/second independent of completion (open-loop) and the
+// latency of each request is measured from its scheduled arrival time so that
+// queueing delay is included when the callers can't keep up. This is what
+// should be compared against serving SLOs. The program must support concurrent
+// invocation (all programs produced by the compiler do).
+
+#include <algorithm>
 #include <array>
+#include <condition_variable>
 #include <cstdio>
+#include <deque>
 #include <iterator>
+#include <memory>
+#include <mutex>
+#include <random>
 #include <string>
+#include <thread>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -106,6 +125,24 @@ IREE_FLAG_LIST(
     "Each occurrence of the flag indicates an input in the order they were\n"
     "specified on the command line.");
 
+IREE_FLAG(int32_t, load_concurrency, 0,
+          "Enables load generation mode with the given number of concurrent "
+          "callers invoking --function. 0 runs the normal benchmarks.");
+IREE_FLAG(string, load_arrival, "closed",
+          "Request arrival process in load generation mode:\n"
+          "  'closed': each caller issues a new request as soon as its "
+          "previous one completes (throughput at saturation).\n"
+          "  'fixed': requests arrive at a constant --load_rate.\n"
+          "  'poisson': requests arrive with exponentially distributed "
+          "interarrival times averaging --load_rate.");
+IREE_FLAG(double, load_rate, 0.0,
+          "Open-loop request arrival rate in requests/second used with "
+          "--load_arrival=fixed|poisson.");
+IREE_FLAG(int32_t, load_duration_ms, 10000,
+          "Duration in milliseconds over which load is generated.");
+IREE_FLAG(int64_t, load_seed, 0,
+          "Random seed used to generate poisson arrival times.");
+
 static iree_status_t parse_time_unit(iree_string_view_t flag_name,
                                      void* storage, iree_string_view_t value) {
   auto* unit = (std::pair<bool, benchmark::TimeUnit>*)storage;
@@ -403,6 +440,339 @@ void RegisterDispatchBenchmark(const std::string& function_name,
                                   : benchmark::kMicrosecond);
 }
 
+//===----------------------------------------------------------------------===//
+// Load generation
+//===----------------------------------------------------------------------===//
+
+enum class LoadArrival {
+  // Each caller issues its next request when the previous one completes.
+  kClosed,
+  // Requests arrive at a fixed interval.
+  kFixed,
+  // Requests arrive with exponentially distributed interarrival times.
+  kPoisson,
+};
+
+// A queue of pending request arrival times shared between the open-loop
+// dispatcher and the callers.
+class LoadQueue {
+ public:
+  void Push(iree_time_t arrival_time_ns) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      arrivals_.push_back(arrival_time_ns);
+    }
+    cond_.notify_one();
+  }
+
+  // Marks the queue as closed; callers drain any pending arrivals and exit.
+  void Close() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+    }
+    cond_.notify_all();
+  }
+
+  // Pops the next arrival time, blocking until one is available.
+  // Returns false if the queue has been closed and drained.
+  bool Pop(iree_time_t* out_arrival_time_ns) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this] { return closed_ || !arrivals_.empty(); });
+    if (arrivals_.empty()) return false;
+    *out_arrival_time_ns = arrivals_.front();
+    arrivals_.pop_front();
+    return true;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::deque<iree_time_t> arrivals_;
+  bool closed_ = false;
+};
+
+// A single caller issuing requests to |function|.
+// Each caller owns its own output list and (for async functions) timeline.
+class LoadCaller {
+ public:
+  LoadCaller(iree_hal_device_t* device, iree_vm_context_t* context,
+             iree_vm_function_t function, iree_vm_list_t* common_inputs,
+             bool is_async)
+      : device_(device),
+        context_(context),
+        function_(function),
+        common_inputs_(common_inputs),
+        is_async_(is_async) {}
+
+  iree_status_t Initialize() {
+    iree_allocator_t host_allocator = iree_allocator_system();
+    if (is_async_) {
+      IREE_RETURN_IF_ERROR(
+          iree_hal_semaphore_create(device_, 0ull, &timeline_semaphore_));
+    }
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(/*element_type=*/nullptr, 16,
+                                             host_allocator, &outputs_));
+    // If the function takes no inputs we still need a list to append fences.
+    if (!common_inputs_) {
+      IREE_RETURN_IF_ERROR(iree_vm_list_create(/*element_type=*/nullptr, 2,
+                                               host_allocator, &inputs_));
+    }
+    return iree_ok_status();
+  }
+
+  // Issues a single request and blocks until it has completed.
+  iree_status_t Invoke() {
+    IREE_TRACE_SCOPE0("LoadCaller::Invoke");
+    iree_allocator_t host_allocator = iree_allocator_system();
+    if (!is_async_) {
+      IREE_RETURN_IF_ERROR(iree_vm_invoke(
+          context_, function_, IREE_VM_INVOCATION_FLAG_NONE,
+          /*policy=*/nullptr, common_inputs_, outputs_.get(), host_allocator));
+      return iree_vm_list_resize(outputs_.get(), 0);
+    }
+
+    // Clone common inputs and add the request-specific fences. We wait on
+    // nothing and signal the next value on our timeline.
+    vm::ref<iree_vm_list_t> inputs;
+    if (common_inputs_) {
+      IREE_RETURN_IF_ERROR(
+          iree_vm_list_clone(common_inputs_, host_allocator, &inputs));
+    } else {
+      IREE_RETURN_IF_ERROR(iree_vm_list_resize(inputs_.get(), 0));
+      inputs = vm::retain_ref(inputs_.get());
+    }
+    vm::ref<iree_hal_fence_t> wait_fence;
+    vm::ref<iree_hal_fence_t> signal_fence;
+    IREE_RETURN_IF_ERROR(iree_hal_fence_create_at(timeline_semaphore_.get(),
+                                                  ++timeline_value_,
+                                                  host_allocator,
+                                                  &signal_fence));
+    IREE_RETURN_IF_ERROR(iree_vm_list_push_ref_move(inputs.get(), wait_fence));
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_push_ref_retain(inputs.get(), signal_fence));
+    IREE_RETURN_IF_ERROR(iree_vm_invoke(
+        context_, function_, IREE_VM_INVOCATION_FLAG_NONE,
+        /*policy=*/nullptr, inputs.get(), outputs_.get(), host_allocator));
+    IREE_RETURN_IF_ERROR(
+        iree_hal_fence_wait(signal_fence.get(), iree_infinite_timeout()));
+    return iree_vm_list_resize(outputs_.get(), 0);
+  }
+
+  // Per-request latencies recorded by this caller.
+  std::vector<iree_duration_t>& latencies() { return latencies_; }
+
+ private:
+  iree_hal_device_t* device_;
+  iree_vm_context_t* context_;
+  iree_vm_function_t function_;
+  iree_vm_list_t* common_inputs_;
+  bool is_async_;
+  vm::ref<iree_hal_semaphore_t> timeline_semaphore_;
+  uint64_t timeline_value_ = 0;
+  vm::ref<iree_vm_list_t> inputs_;
+  vm::ref<iree_vm_list_t> outputs_;
+  std::vector<iree_duration_t> latencies_;
+};
+
+static iree_status_t ParseLoadArrival(iree_string_view_t value,
+                                      LoadArrival* out_arrival) {
+  if (iree_string_view_equal(value, IREE_SV("closed"))) {
+    *out_arrival = LoadArrival::kClosed;
+  } else if (iree_string_view_equal(value, IREE_SV("fixed"))) {
+    *out_arrival = LoadArrival::kFixed;
+  } else if (iree_string_view_equal(value, IREE_SV("poisson"))) {
+    *out_arrival = LoadArrival::kPoisson;
+  } else {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "unsupported --load_arrival='%.*s'; expected "
+                            "'closed', 'fixed', or 'poisson'",
+                            (int)value.size, value.data);
+  }
+  return iree_ok_status();
+}
+
+// Returns the |percentile| (0-100) of the sorted |latencies|.
+static iree_duration_t LatencyPercentile(
+    const std::vector<iree_duration_t>& latencies, double percentile) {
+  if (latencies.empty()) return 0;
+  size_t index = (size_t)(percentile / 100.0 * (double)latencies.size());
+  return latencies[std::min(index, latencies.size() - 1)];
+}
+
+static void PrintLoadReport(const std::string& function_name,
+                            LoadArrival arrival, int32_t concurrency,
+                            iree_duration_t elapsed_ns, int64_t offered_count,
+                            std::vector<iree_duration_t>& latencies) {
+  std::sort(latencies.begin(), latencies.end());
+
+  double unit_scale = 1e-6;
+  const char* unit_string = kMillisecondsUnitString;
+  if (FLAG_time_unit.first) {
+    switch (FLAG_time_unit.second) {
+      case benchmark::kMicrosecond:
+        unit_scale = 1e-3;
+        unit_string = kMicrosecondsUnitString;
+        break;
+      case benchmark::kNanosecond:
+        unit_scale = 1.0;
+        unit_string = kNanosecondsUnitString;
+        break;
+      default:
+        break;
+    }
+  }
+
+  double mean_ns = 0.0;
+  for (iree_duration_t latency : latencies) mean_ns += (double)latency;
+  if (!latencies.empty()) mean_ns /= (double)latencies.size();
+  double elapsed_s = (double)elapsed_ns / 1e9;
+
+  fprintf(stdout, "Load: %s\n", function_name.c_str());
+  switch (arrival) {
+    case LoadArrival::kClosed:
+      fprintf(stdout, "  arrival:     closed x%d\n", concurrency);
+      break;
+    case LoadArrival::kFixed:
+      fprintf(stdout, "  arrival:     fixed %g req/s x%d\n", FLAG_load_rate,
+              concurrency);
+      break;
+    case LoadArrival::kPoisson:
+      fprintf(stdout, "  arrival:     poisson %g req/s x%d\n",
+              FLAG_load_rate, concurrency);
+      break;
+  }
+  fprintf(stdout, "  requests:    %zu completed / %" PRId64 " offered\n",
+          latencies.size(), offered_count);
+  fprintf(stdout, "  elapsed:     %.3f s\n", elapsed_s);
+  fprintf(stdout, "  throughput:  %.3f req/s\n",
+          elapsed_s > 0.0 ? (double)latencies.size() / elapsed_s : 0.0);
+  fprintf(stdout, "  latency (%s):\n", unit_string);
+  fprintf(stdout, "    mean  %12.3f\n", mean_ns * unit_scale);
+  static const std::array<std::pair<const char*, double>, 5> kPercentiles = {{
+      {"p50", 50.0},
+      {"p90", 90.0},
+      {"p99", 99.0},
+      {"p999", 99.9},
+      {"max", 100.0},
+  }};
+  for (const auto& percentile : kPercentiles) {
+    fprintf(stdout, "    %-5s %12.3f\n", percentile.first,
+            (double)LatencyPercentile(latencies, percentile.second) *
+                unit_scale);
+  }
+  fflush(stdout);
+}
+
+// Generates load against |function| from FLAG_load_concurrency callers and
+// prints a throughput/latency report.
+static iree_status_t RunLoadGenerator(const std::string& function_name,
+                                      iree_hal_device_t* device,
+                                      iree_vm_context_t* context,
+                                      iree_vm_function_t function,
+                                      iree_vm_list_t* inputs, bool is_async) {
+  IREE_TRACE_SCOPE0("RunLoadGenerator");
+
+  LoadArrival arrival = LoadArrival::kClosed;
+  IREE_RETURN_IF_ERROR(
+      ParseLoadArrival(iree_make_cstring_view(FLAG_load_arrival), &arrival));
+  if (arrival != LoadArrival::kClosed && FLAG_load_rate <= 0.0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "--load_rate must be > 0 for open-loop arrival");
+  }
+  if (FLAG_load_duration_ms <= 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "--load_duration_ms must be > 0");
+  }
+  int32_t concurrency = FLAG_load_concurrency;
+
+  std::vector<std::unique_ptr<LoadCaller>> callers;
+  for (int32_t i = 0; i < concurrency; ++i) {
+    auto caller = std::make_unique<LoadCaller>(device, context, function,
+                                               inputs, is_async);
+    IREE_RETURN_IF_ERROR(caller->Initialize());
+    callers.push_back(std::move(caller));
+  }
+
+  // Warm up with a single untimed request so that one-time initialization
+  // (lazy executable loading, pool growth, etc) doesn't skew the results.
+  IREE_RETURN_IF_ERROR(callers.front()->Invoke());
+
+  iree_time_t start_time_ns = iree_time_now();
+  iree_time_t end_time_ns =
+      start_time_ns + (iree_duration_t)FLAG_load_duration_ms * 1000000ll;
+
+  LoadQueue queue;
+  std::mutex status_mutex;
+  iree_status_t status = iree_ok_status();
+  auto record_status = [&](iree_status_t caller_status) {
+    std::lock_guard<std::mutex> lock(status_mutex);
+    status = iree_status_join(status, caller_status);
+  };
+
+  std::vector<std::thread> threads;
+  for (int32_t i = 0; i < concurrency; ++i) {
+    LoadCaller* caller = callers[i].get();
+    threads.emplace_back([&, caller]() {
+      IREE_TRACE_SCOPE0("LoadCallerThread");
+      iree_time_t arrival_time_ns = 0;
+      while (true) {
+        if (arrival == LoadArrival::kClosed) {
+          arrival_time_ns = iree_time_now();
+          if (arrival_time_ns >= end_time_ns) break;
+        } else if (!queue.Pop(&arrival_time_ns)) {
+          break;
+        }
+        iree_status_t caller_status = caller->Invoke();
+        if (!iree_status_is_ok(caller_status)) {
+          record_status(caller_status);
+          queue.Close();
+          break;
+        }
+        caller->latencies().push_back(iree_time_now() - arrival_time_ns);
+      }
+    });
+  }
+
+  // Open-loop dispatch: schedule arrivals independent of completion. Requests
+  // not yet started when the duration ends are still drained so that the
+  // reported latencies include the full backlog.
+  int64_t offered_count = 0;
+  if (arrival != LoadArrival::kClosed) {
+    std::mt19937_64 rng((uint64_t)FLAG_load_seed);
+    std::exponential_distribution<double> interarrival(FLAG_load_rate);
+    double fixed_interval_ns = 1e9 / FLAG_load_rate;
+    double next_time_ns = (double)start_time_ns;
+    while (true) {
+      next_time_ns += arrival == LoadArrival::kFixed
+                          ? fixed_interval_ns
+                          : interarrival(rng) * 1e9;
+      iree_time_t arrival_time_ns = (iree_time_t)next_time_ns;
+      if (arrival_time_ns >= end_time_ns) break;
+      iree_wait_until(arrival_time_ns);
+      queue.Push(arrival_time_ns);
+      ++offered_count;
+    }
+    queue.Close();
+  }
+
+  for (auto& thread : threads) thread.join();
+  iree_duration_t elapsed_ns = iree_time_now() - start_time_ns;
+  IREE_RETURN_IF_ERROR(status);
+
+  std::vector<iree_duration_t> latencies;
+  for (auto& caller : callers) {
+    latencies.insert(latencies.end(), caller->latencies().begin(),
+                     caller->latencies().end());
+  }
+  if (arrival == LoadArrival::kClosed) {
+    offered_count = (int64_t)latencies.size();
+  }
+  PrintLoadReport(function_name, arrival, concurrency, elapsed_ns,
+                  offered_count, latencies);
+  return iree_ok_status();
+}
+
 // The lifetime of IREEBenchmark should be as long as
 // ::benchmark::RunSpecifiedBenchmarks() where the resources are used during
 // benchmarking.
@@ -430,6 +800,44 @@ class IREEBenchmark {
 
   iree_hal_device_t* device() const { return device_.get(); }
 
+  // Runs the load generator against --function instead of registering
+  // benchmarks.
+  iree_status_t RunLoad() {
+    IREE_TRACE_SCOPE0("IREEBenchmark::RunLoad");
+
+    if (!instance_ || !device_allocator_ || !context_ || !main_module_) {
+      IREE_RETURN_IF_ERROR(Init());
+    }
+
+    auto function_name = std::string(FLAG_function);
+    if (function_name.empty()) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "--function= must be specified when using "
+                              "--load_concurrency=");
+    }
+    iree_vm_function_t function;
+    IREE_RETURN_IF_ERROR(iree_vm_module_lookup_function_by_name(
+        main_module_.get(), IREE_VM_FUNCTION_LINKAGE_EXPORT,
+        iree_string_view_t{function_name.data(), function_name.size()},
+        &function));
+
+    IREE_RETURN_IF_ERROR(iree_tooling_parse_to_variant_list(
+        device_allocator_.get(), FLAG_input_list().values,
+        FLAG_input_list().count, iree_vm_instance_allocator(instance_.get()),
+        &inputs_));
+
+    iree_string_view_t invocation_model = iree_vm_function_lookup_attr_by_name(
+        &function, IREE_SV("iree.abi.model"));
+    bool is_async =
+        iree_string_view_equal(invocation_model, IREE_SV("coarse-fences"));
+    IREE_RETURN_IF_ERROR(iree_hal_begin_profiling_from_flags(device_.get()));
+    iree_status_t status =
+        iree::RunLoadGenerator(function_name, device_.get(), context_.get(),
+                               function, inputs_.get(), is_async);
+    return iree_status_join(
+        status, iree_hal_end_profiling_from_flags(device_.get()));
+  }
+
   iree_status_t Register() {
     IREE_TRACE_SCOPE0("IREEBenchmark::Register");
 
@@ -585,6 +993,15 @@ int main(int argc, char** argv) {
   ::benchmark::Initialize(&argc, argv);
 
   iree::IREEBenchmark iree_benchmark;
+  if (FLAG_load_concurrency > 0) {
+    iree_status_t status = iree_benchmark.RunLoad();
+    if (!iree_status_is_ok(status)) {
+      int ret = static_cast<int>(iree_status_code(status));
+      printf("%s\n", iree::Status(std::move(status)).ToString().c_str());
+      return ret;
+    }
+    return 0;
+  }
   iree_status_t status = iree_benchmark.Register();
   if (!iree_status_is_ok(status)) {
     int ret = static_cast<int>(iree_status_code(status));
@@ -4,28 +4,77 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <inttypes.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "iree/base/api.h"
 #include "iree/base/internal/file_io.h"
+#include "iree/hal/drivers/pim/util/pim_executable_dump.h"
+#include "iree/hal/drivers/pim/util/pim_module_executables.h"
 #include "iree/schemas/bytecode_module_def_json_printer.h"
 #include "iree/vm/bytecode_module.h"
 
+// Prints the listing of the PIM executable |data| stored in rodata segment
+// |rodata_ordinal| of the module (or -1 for a bare executable).
+static iree_status_t iree_dump_pim_executable(void* user_data,
+                                              int64_t rodata_ordinal,
+                                              iree_const_byte_span_t data) {
+  iree_hal_pim_executable_stats_t stats;
+  IREE_RETURN_IF_ERROR(iree_hal_pim_executable_compute_stats(data, &stats));
+  iree_string_builder_t builder;
+  iree_string_builder_initialize(iree_allocator_system(), &builder);
+  iree_status_t status = iree_ok_status();
+  if (rodata_ordinal >= 0) {
+    status = iree_string_builder_append_format(
+        &builder, "rodata[%" PRId64 "]: ", rodata_ordinal);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_string_builder_append_format(
+        &builder,
+        "PIM executable, %" PRIhsz " bytes, %" PRIhsz
+        " instructions, %" PRIhsz " sync points\n",
+        stats.byte_length, stats.instruction_count, stats.sync_count);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_pim_executable_disassemble(data, &builder);
+  }
+  if (iree_status_is_ok(status)) {
+    fwrite(iree_string_builder_buffer(&builder), 1,
+           iree_string_builder_size(&builder), stdout);
+  }
+  iree_string_builder_deinitialize(&builder);
+  return status;
+}
+
 // Today we just print to JSON. We could do something more useful (size
-// analysis, etc), but JSON should be enough.
+// analysis, etc), but JSON should be enough. With --pim the PIM executables
+// of the module are decoded into an instruction listing instead.
 //
 // We could also move all of this into iree-compile (mlir -> vmfb -> json),
 // though having a tiny little tool not reliant on LLVM is nice (can run this
 // on a device).
 int main(int argc, char** argv) {
-  if (argc < 2) {
-    fprintf(stderr, "Syntax: iree-dump-module module.vmfb > module.json\n");
+  bool dump_pim = argc >= 2 && strcmp(argv[1], "--pim") == 0;
+  if (argc < (dump_pim ? 3 : 2)) {
+    fprintf(stderr,
+            "Syntax: iree-dump-module module.vmfb > module.json\n"
+            "        iree-dump-module --pim module.vmfb > module.txt\n");
     return 1;
   }
+  const char* path = argv[dump_pim ? 2 : 1];
 
   iree_file_contents_t* file_contents = NULL;
-  IREE_CHECK_OK(iree_file_read_contents(argv[1], iree_allocator_system(),
-                                        &file_contents));
+  IREE_CHECK_OK(
+      iree_file_read_contents(path, iree_allocator_system(), &file_contents));
+
+  if (dump_pim) {
+    IREE_CHECK_OK(iree_hal_pim_module_enumerate_executables(
+        file_contents->const_buffer, iree_dump_pim_executable,
+        /*user_data=*/NULL));
+    iree_file_contents_free(file_contents);
+    return 0;
+  }
 
   iree_const_byte_span_t flatbuffer_contents = iree_const_byte_span_empty();
   IREE_CHECK_OK(iree_vm_bytecode_module_parse_header(
@@ -198,6 +198,8 @@ iree_status_t Run(int* out_exit_code) {
     IREE_IGNORE_ERROR(
         iree_hal_allocator_statistics_fprint(stderr, device_allocator.get()));
   }
+  IREE_IGNORE_ERROR(
+      iree_hal_print_dispatch_statistics_from_flags(stderr, device.get()));
 
   device_allocator.reset();
   device.reset();
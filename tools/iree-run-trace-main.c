@@ -4,13 +4,33 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+// Replays one or more trace files. Each trace file is replayed in its own
+// context and by default files are replayed sequentially with the results of
+// each call printed to stdout.
+//
+// --replay_threads=N replays up to N trace files concurrently, each on its own
+// thread and context, and --replay_repeat=N replays each trace file N times.
+// When more than one thread is used call results are not printed so that the
+// replay runs as fast as possible; combined with --print_statistics this acts
+// as a throughput benchmark of captured traffic.
+//
+// --replay_timing honors the optional `time` key on call events: a call with
+// `time: 1.5` will not be issued until 1.5 seconds after the replay of its
+// trace file began. Calls that fall behind schedule are issued immediately.
+// When --replay_threads is at least the number of files all traces start
+// together such that the concurrency between them matches the capture.
+
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
 #include "iree/base/internal/flags.h"
 #include "iree/base/internal/path.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/threading.h"
 #include "iree/hal/api.h"
 #include "iree/tooling/device_util.h"
 #include "iree/tooling/trace_replay.h"
@@ -22,10 +42,75 @@ IREE_FLAG(bool, trace_execution, false, "Traces VM execution to stderr.");
 IREE_FLAG(bool, print_statistics, false,
           "Prints runtime statistics to stderr on exit.");
 
+IREE_FLAG(int32_t, replay_threads, 1,
+          "Number of threads used to replay trace files concurrently. Each "
+          "trace file is replayed in its own context. When more than 1 call "
+          "results are not printed.");
+IREE_FLAG(int32_t, replay_repeat, 1,
+          "Number of times each trace file is replayed.");
+IREE_FLAG(bool, replay_timing, false,
+          "Honors the `time` key (seconds from the start of the trace) on "
+          "call events by waiting until the recorded time before issuing "
+          "each call.");
+
+// Process-wide replay counters used when reporting statistics.
+static iree_atomic_int64_t iree_run_trace_call_count = IREE_ATOMIC_VAR_INIT(0);
+
+// Waits until the time recorded in |event_node|, if any, relative to
+// |start_time_ns|.
+static iree_status_t iree_run_trace_wait_for_event_time(
+    iree_time_t start_time_ns, yaml_document_t* document,
+    yaml_node_t* event_node) {
+  yaml_node_t* time_node = NULL;
+  IREE_RETURN_IF_ERROR(iree_yaml_mapping_try_find(
+      document, event_node, iree_make_cstring_view("time"), &time_node));
+  if (!time_node) return iree_ok_status();
+  double time_s = 0.0;
+  if (!iree_string_view_atod(iree_yaml_node_as_string(time_node), &time_s) ||
+      time_s < 0.0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "(%zu): invalid event time",
+                            time_node->start_mark.line);
+  }
+  iree_wait_until(start_time_ns + (iree_duration_t)(time_s * 1e9));
+  return iree_ok_status();
+}
+
+// Replays a single trace event. Calls are printed to stdout if |print_calls|
+// and otherwise issued with their results discarded.
+static iree_status_t iree_run_trace_event(iree_trace_replay_t* replay,
+                                          iree_time_t start_time_ns,
+                                          bool print_calls,
+                                          yaml_document_t* document,
+                                          yaml_node_t* event_node) {
+  if (event_node->type != YAML_MAPPING_NODE) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "(%zu): expected mapping node",
+                            event_node->start_mark.line);
+  }
+  yaml_node_t* type_node = NULL;
+  IREE_RETURN_IF_ERROR(iree_yaml_mapping_find(
+      document, event_node, iree_make_cstring_view("type"), &type_node));
+  if (!iree_yaml_string_equal(type_node, iree_make_cstring_view("call"))) {
+    return iree_trace_replay_event(replay, document, event_node);
+  }
+  if (FLAG_replay_timing) {
+    IREE_RETURN_IF_ERROR(iree_run_trace_wait_for_event_time(
+        start_time_ns, document, event_node));
+  }
+  iree_atomic_fetch_add_int64(&iree_run_trace_call_count, 1,
+                              iree_memory_order_relaxed);
+  if (print_calls) {
+    return iree_trace_replay_event(replay, document, event_node);
+  }
+  return iree_trace_replay_event_call(replay, document, event_node,
+                                      /*out_output_list=*/NULL);
+}
+
 // Runs the trace in |file| using |root_path| as the base for any path lookups
 // required for external files referenced in |file|.
 static iree_status_t iree_run_trace_file(iree_string_view_t root_path,
-                                         FILE* file,
+                                         FILE* file, bool print_calls,
                                          iree_vm_instance_t* instance) {
   iree_trace_replay_t replay;
   IREE_RETURN_IF_ERROR(iree_trace_replay_initialize(
@@ -51,6 +136,7 @@ static iree_status_t iree_run_trace_file(iree_string_view_t root_path,
   }
   yaml_parser_set_input_file(&parser, file);
 
+  iree_time_t start_time_ns = iree_time_now();
   iree_status_t status = iree_ok_status();
   for (bool document_eof = false; !document_eof;) {
     yaml_document_t document;
@@ -60,7 +146,8 @@ static iree_status_t iree_run_trace_file(iree_string_view_t root_path,
     }
     yaml_node_t* event_node = yaml_document_get_root_node(&document);
     if (event_node) {
-      status = iree_trace_replay_event(&replay, &document, event_node);
+      status = iree_run_trace_event(&replay, start_time_ns, print_calls,
+                                    &document, event_node);
     } else {
       document_eof = true;
     }
@@ -76,24 +163,144 @@ static iree_status_t iree_run_trace_file(iree_string_view_t root_path,
   return status;
 }
 
-// Runs each of the given traces files sequentially in isolated contexts.
+// Opens and runs the trace file at |file_path| in an isolated context.
+static iree_status_t iree_run_trace_file_path(const char* file_path_cstring,
+                                              bool print_calls,
+                                              iree_vm_instance_t* instance) {
+  iree_string_view_t file_path = iree_make_cstring_view(file_path_cstring);
+  iree_string_view_t root_path = iree_file_path_dirname(file_path);
+  FILE* file = fopen(file_path_cstring, "rb");
+  if (!file) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to open trace file '%.*s'",
+                            (int)file_path.size, file_path.data);
+  }
+  iree_status_t status =
+      iree_run_trace_file(root_path, file, print_calls, instance);
+  fclose(file);
+  IREE_RETURN_IF_ERROR(status, "replaying trace file '%.*s'",
+                       (int)file_path.size, file_path.data);
+  return iree_ok_status();
+}
+
+// Shared state for worker threads replaying trace files concurrently.
+typedef struct iree_run_trace_workers_t {
+  int file_count;
+  char** file_paths;
+  iree_vm_instance_t* instance;
+  // Total number of file replays (file_count * repeat count).
+  int32_t replay_count;
+  // Index of the next file replay to be claimed by a worker.
+  iree_atomic_int32_t next_replay;
+  // Guards |status|.
+  iree_slim_mutex_t status_mutex;
+  // First failure from any worker; once set remaining replays are skipped.
+  iree_status_t status;
+} iree_run_trace_workers_t;
+
+static int iree_run_trace_worker_main(void* entry_arg) {
+  iree_run_trace_workers_t* workers = (iree_run_trace_workers_t*)entry_arg;
+  while (true) {
+    int32_t replay_index = iree_atomic_fetch_add_int32(
+        &workers->next_replay, 1, iree_memory_order_relaxed);
+    if (replay_index >= workers->replay_count) break;
+    iree_status_t status = iree_run_trace_file_path(
+        workers->file_paths[replay_index % workers->file_count],
+        /*print_calls=*/false, workers->instance);
+    if (!iree_status_is_ok(status)) {
+      // Stop handing out replays; other workers will exit after their current
+      // file completes.
+      iree_atomic_store_int32(&workers->next_replay, workers->replay_count,
+                              iree_memory_order_relaxed);
+      iree_slim_mutex_lock(&workers->status_mutex);
+      workers->status = iree_status_join(workers->status, status);
+      iree_slim_mutex_unlock(&workers->status_mutex);
+      break;
+    }
+  }
+  return 0;
+}
+
+// Runs the given trace files concurrently on |thread_count| threads.
+static iree_status_t iree_run_trace_files_concurrently(
+    int file_count, char** file_paths, int32_t thread_count,
+    iree_vm_instance_t* instance) {
+  iree_allocator_t host_allocator = iree_allocator_system();
+  iree_run_trace_workers_t workers = {
+      .file_count = file_count,
+      .file_paths = file_paths,
+      .instance = instance,
+      .replay_count = file_count * FLAG_replay_repeat,
+      .status = iree_ok_status(),
+  };
+  iree_atomic_store_int32(&workers.next_replay, 0, iree_memory_order_relaxed);
+  iree_slim_mutex_initialize(&workers.status_mutex);
+  thread_count = iree_min(thread_count, workers.replay_count);
+
+  iree_thread_t** threads = NULL;
+  iree_status_t status = iree_allocator_malloc(
+      host_allocator, thread_count * sizeof(*threads), (void**)&threads);
+  int32_t created_count = 0;
+  if (iree_status_is_ok(status)) {
+    iree_thread_create_params_t params;
+    memset(&params, 0, sizeof(params));
+    params.name = iree_make_cstring_view("iree-run-trace");
+    for (; created_count < thread_count; ++created_count) {
+      status = iree_thread_create(iree_run_trace_worker_main, &workers, params,
+                                  host_allocator, &threads[created_count]);
+      if (!iree_status_is_ok(status)) {
+        iree_atomic_store_int32(&workers.next_replay, workers.replay_count,
+                                iree_memory_order_relaxed);
+        break;
+      }
+    }
+  }
+
+  // Releasing the threads joins them.
+  for (int32_t i = 0; i < created_count; ++i) {
+    iree_thread_release(threads[i]);
+  }
+  iree_allocator_free(host_allocator, threads);
+  iree_slim_mutex_deinitialize(&workers.status_mutex);
+  return iree_status_join(status, workers.status);
+}
+
+// Runs each of the given traces files in isolated contexts.
 static iree_status_t iree_run_trace_files(int file_count, char** file_paths,
                                           iree_vm_instance_t* instance) {
-  for (int i = 0; i < file_count; ++i) {
-    iree_string_view_t file_path = iree_make_cstring_view(file_paths[i]);
-    iree_string_view_t root_path = iree_file_path_dirname(file_path);
-    FILE* file = fopen(file_paths[i], "rb");
-    if (!file) {
-      return iree_make_status(iree_status_code_from_errno(errno),
-                              "failed to open trace file '%.*s'",
-                              (int)file_path.size, file_path.data);
+  if (FLAG_replay_threads < 1 || FLAG_replay_repeat < 1) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "--replay_threads and --replay_repeat must be >= 1");
+  }
+
+  iree_time_t start_time_ns = iree_time_now();
+  iree_status_t status = iree_ok_status();
+  if (FLAG_replay_threads > 1) {
+    status = iree_run_trace_files_concurrently(file_count, file_paths,
+                                               FLAG_replay_threads, instance);
+  } else {
+    for (int32_t r = 0; r < FLAG_replay_repeat && iree_status_is_ok(status);
+         ++r) {
+      for (int i = 0; i < file_count && iree_status_is_ok(status); ++i) {
+        status = iree_run_trace_file_path(file_paths[i], /*print_calls=*/true,
+                                          instance);
+      }
     }
-    iree_status_t status = iree_run_trace_file(root_path, file, instance);
-    fclose(file);
-    IREE_RETURN_IF_ERROR(status, "replaying trace file '%.*s'",
-                         (int)file_path.size, file_path.data);
   }
-  return iree_ok_status();
+  iree_duration_t elapsed_ns = iree_time_now() - start_time_ns;
+
+  if (iree_status_is_ok(status) && FLAG_print_statistics) {
+    int64_t call_count = iree_atomic_load_int64(&iree_run_trace_call_count,
+                                                iree_memory_order_relaxed);
+    double elapsed_s = (double)elapsed_ns / 1e9;
+    fprintf(stderr,
+            "replayed %" PRId64 " calls from %d trace files x%d on %d "
+            "threads in %.3fs (%.3f calls/s)\n",
+            call_count, file_count, FLAG_replay_repeat, FLAG_replay_threads,
+            elapsed_s, elapsed_s > 0.0 ? (double)call_count / elapsed_s : 0.0);
+  }
+  return status;
 }
 
 int main(int argc, char** argv) {